@@ -132,6 +132,11 @@ absl::Status LoadSavedModel(const SessionOptions& session_options,
 ///
 /// This overload creates a SavedModelBundleLite, which consumes less RAM than
 /// an equivalent SavedModelBundle.
+///
+/// To serve variables straight from the memory-mapped checkpoint, which pages
+/// them in on first access and shares the pages between processes loading the
+/// same SavedModel, set
+/// `session_options.config.experimental.lazy_variable_restore`.
 absl::Status LoadSavedModel(const SessionOptions& session_options,
                             const RunOptions& run_options,
                             const string& export_dir,
@@ -92,7 +92,8 @@ class DeviceCompiler : public ResourceBase {
   // and `out_executable`.  If `compile_mode` is `kStrict` then the compilation
   // cache always attempts the compilation on a cache miss. If compilation mode
   // is 'kAsync' compilation of the cluster happens in the background while the
-  // fallback path executes.
+  // fallback path executes, and the fallback path keeps being used if that
+  // compilation fails.
   //
   // The result of compilation is written to `*out_compilation_result`, which
   // must be non-null. If `out_executable` is non-null, also builds an
@@ -386,10 +387,15 @@ absl::Status DeviceCompiler<ExecutableType, ClientType>::CompileAsynchronous(
     VLOG(2) << "Finished asynchronous compililation of cluster "
             << function_name << '.';
     profiler->DecrementOngoingAsyncCompilations();
-    // Update compilation status in cache.
+    // Update compilation status in cache. A failed compilation is recorded as
+    // finished so that it is no longer reported as ongoing; CompileImpl keeps
+    // taking the fallback path for it.
     if (!s.ok()) {
-      cache_->Store(signature, std::nullopt, s.status(), std::nullopt,
-                    std::nullopt);
+      LOG(WARNING) << "Asynchronous compilation of cluster " << function_name
+                   << " failed: " << s.status()
+                   << ". Falling back to TF function call.";
+      cache_->Store(signature, DeviceCompileState::kCompiled, s.status(),
+                    std::nullopt, std::nullopt);
     }
   });
   return absl::OkStatus();
@@ -491,6 +497,12 @@ absl::Status DeviceCompiler<ExecutableType, ClientType>::CompileImpl(
     return absl::OkStatus();
   } else if (state == DeviceCompileState::kCompiled) {
     VLOG(2) << "Already Compiled for signature: " << human_signature;
+    if (compile_mode == DeviceCompileMode::kAsync &&
+        !cache_value.compilation_status.ok()) {
+      VLOG(2) << "Asynchronous compilation failed for signature: "
+              << human_signature << "; using the fallback path.";
+      return absl::OkStatus();
+    }
   }
 
   TF_RETURN_IF_ERROR(cache_value.compilation_status);
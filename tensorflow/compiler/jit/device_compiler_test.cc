@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/notification.h"
 #include "tensorflow/core/platform/status.h"
@@ -318,6 +319,56 @@ TEST_F(DeviceCompilerTest, CompileAsyncSuccess) {
   EXPECT_TRUE(cache_value->compilation_status.ok());
 }
 
+TEST_F(DeviceCompilerTest, CompileAsyncFailureUsesFallback) {
+  const XlaCompiler::CompilationResult* compilation_result = nullptr;
+  xla::LocalExecutable* xla_executable = nullptr;
+
+  XlaCompiler::Options options = GetDefaultXlaOptions();
+
+  // "bar" is not in the function library, so compiling it fails.
+  NameAttrList fn;
+  fn.set_name("bar");
+
+  EXPECT_CALL(*mock_profiler_,
+              ShouldCompileCluster(_, DeviceCompileMode::kAsync, 1))
+      .WillOnce(Return(true));
+
+  auto args = SampleArgsForAddXY();
+  TF_EXPECT_OK(xla_device_compiler_->CompileIfNeeded(
+      options, fn, args, XlaCompiler::CompileOptions{},
+      DeviceCompileMode::kAsync, mock_profiler_, &compilation_result,
+      &xla_executable));
+  EXPECT_TRUE(xla_executable == nullptr);
+
+  // Wait for the async compilation to fail.
+  auto xla_cache = xla_device_compiler_->cache();
+  TF_ASSERT_OK_AND_ASSIGN(auto signature, Signature::Build(fn, args));
+  auto cache_value = xla_cache->Lookup(signature);
+  while (cache_value &&
+         cache_value->compile_state != DeviceCompileState::kCompiled) {
+    Env::Default()->SleepForMicroseconds(1000);
+    cache_value = xla_cache->Lookup(signature);
+  }
+  ASSERT_TRUE(cache_value);
+  EXPECT_FALSE(cache_value->compilation_status.ok());
+
+  // Subsequent asynchronous requests keep using the fallback path instead of
+  // failing, while strict requests surface the compilation error.
+  TF_EXPECT_OK(xla_device_compiler_->CompileIfNeeded(
+      options, fn, args, XlaCompiler::CompileOptions{},
+      DeviceCompileMode::kAsync, mock_profiler_, &compilation_result,
+      &xla_executable));
+  EXPECT_TRUE(compilation_result == nullptr);
+  EXPECT_TRUE(xla_executable == nullptr);
+
+  EXPECT_FALSE(xla_device_compiler_
+                   ->CompileIfNeeded(options, fn, args,
+                                     XlaCompiler::CompileOptions{},
+                                     DeviceCompileMode::kStrict, mock_profiler_,
+                                     &compilation_result, &xla_executable)
+                   .ok());
+}
+
 TEST_F(DeviceCompilerTest, CompilePersistentCacheEnabled) {
   auto xla_device_compiler =
       CreateXlaDeviceCompiler(/*enable_persistence=*/true);
@@ -18,6 +18,7 @@ limitations under the License.
 #include <string>
 
 #include "absl/strings/str_cat.h"
+#include "tensorflow/core/platform/fingerprint.h"
 
 namespace tensorflow {
 
@@ -31,6 +32,14 @@ std::string XlaSerializedCacheKeyToFileName(const XlaSerializedCacheKey& key) {
       key.compiled_using_pjrt()
           ? absl::StrCat(kXlaSerializedCacheKeySeparator, "pjrt")
           : "",
+      key.compiler_flags_fingerprint() == 0
+          ? ""
+          : absl::StrCat(kXlaSerializedCacheKeySeparator,
+                         key.compiler_flags_fingerprint()),
+      key.device_fingerprint().empty()
+          ? ""
+          : absl::StrCat(kXlaSerializedCacheKeySeparator,
+                         Fingerprint64(key.device_fingerprint())),
       ".pb");
 }
 
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/device_compiler_client.h"
 #include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
 #include "tensorflow/compiler/jit/xla_device_compiler_client.h"
+#include "tensorflow/compiler/jit/xla_serialized_cache_store.h"
 #include "tensorflow/compiler/tf2xla/xla_compiler.h"
 #include "xla/pjrt/pjrt_client.h"
 #include "xla/service/hlo.pb.h"
@@ -46,7 +47,9 @@ std::string XlaSerializedCacheKeyToFileName(const XlaSerializedCacheKey& key);
 
 // Offers a way to persist and/or load compiled `ExecutableType`s along with the
 // corresponding HLO (`CompilationResult`) to/from `persistent_cache_directory`
-// (if one was provided during construction) on disk  using `ClientType`.
+// (if one was provided during construction) on disk  using `ClientType`, and
+// to/from a `shared_store` shared between processes (if one was provided). The
+// directory is checked first and is populated with entries found in the store.
 template <typename ExecutableType, typename ClientType>
 class DeviceExecutablePersistor {
  public:
@@ -83,6 +86,17 @@ class DeviceExecutablePersistor {
 
     // Cache is read-only if set to true.
     bool persistent_cache_directory_read_only = false;
+
+    // Fingerprint of the compiler flags, made part of the cache key.
+    uint64 compiler_flags_fingerprint = 0;
+
+    // Identifies the device executables are built for, made part of the cache
+    // key.
+    std::string device_fingerprint;
+
+    // If non-null, serialized executables are also looked up in, and saved
+    // to, this store. Not owned.
+    XlaSerializedCacheStore* shared_store = nullptr;
   };
 
   DeviceExecutablePersistor(const Config& config,
@@ -90,9 +104,9 @@ class DeviceExecutablePersistor {
   virtual ~DeviceExecutablePersistor() = default;
 
   // Returns std::nullopt if persistence is not enabled (i.e.
-  // `persistent_cache_directory_` is empty) or if the serialized entry is not
-  // found on disk. Otherwise, loads and returns the serialized executable
-  // (or returns a status).
+  // `persistent_cache_directory_` is empty and there is no `shared_store_`) or
+  // if the serialized entry is not found. Otherwise, loads and returns the
+  // serialized executable (or returns a status).
   // TODO(b/255826209): Take in Signature instead of hash and string once cache
   // is refactored.
   std::optional<StatusOr<std::unique_ptr<ExecutableType>>> TryToLoadExecutable(
@@ -101,9 +115,9 @@ class DeviceExecutablePersistor {
       const XlaCompiler::CompilationResult& compilation_result,
       DeviceCompilerClient<ExecutableType, ClientType>* client) const;
 
-  // Tries to serialize an already built `executable` and persist it on disk. If
-  // unable to do so, tries to build a serialized executable using the AOT
-  // pipeline and persists that to disk.
+  // Tries to serialize an already built `executable` and persist it on disk
+  // and in the shared store. If unable to do so, tries to build a serialized
+  // executable using the AOT pipeline and persists that instead.
   // TODO(b/255826209): Take in Signature instead hash and string once cache
   // is refactored.
   virtual absl::Status TryToPersistExecutable(
@@ -146,6 +160,11 @@ class DeviceExecutablePersistor {
   absl::StatusOr<std::optional<XlaSerializedCacheEntry>>
   TryToReadSerializedEntry(const XlaSerializedCacheKey& key) const;
 
+  // Looks `key` up in `shared_store_`. Returns std::nullopt if there is no
+  // store, no entry or the lookup fails.
+  std::optional<XlaSerializedCacheEntry> TryToReadSharedEntry(
+      const XlaSerializedCacheKey& key, const std::string& signature_str) const;
+
   // Checks if the loaded `entry` matches the expected `key` and `hlo_module`.
   absl::Status VerifyLoadedCacheEntry(
       const XlaSerializedCacheKey& key, const xla::HloModuleProto& hlo_module,
@@ -164,6 +183,12 @@ class DeviceExecutablePersistor {
   // Cache is read-only if set to true.
   const bool persistent_cache_directory_read_only_;
 
+  const uint64 compiler_flags_fingerprint_;
+  const std::string device_fingerprint_;
+
+  // Store shared with other processes, or nullptr. Not owned.
+  XlaSerializedCacheStore* const shared_store_;
+
   DeviceExecutablePersistor(const DeviceExecutablePersistor&) = delete;
   void operator=(const DeviceExecutablePersistor&) = delete;
 };
@@ -177,7 +202,10 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::
       persistence_prefix_(config.persistence_prefix),
       persistent_cache_directory_(config.persistent_cache_directory),
       persistent_cache_directory_read_only_(
-          config.persistent_cache_directory_read_only) {}
+          config.persistent_cache_directory_read_only),
+      compiler_flags_fingerprint_(config.compiler_flags_fingerprint),
+      device_fingerprint_(config.device_fingerprint),
+      shared_store_(config.shared_store) {}
 
 template <typename ExecutableType, typename ClientType>
 std::string DeviceExecutablePersistor<ExecutableType, ClientType>::GetFilePath(
@@ -197,6 +225,8 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::BuildSerializedCacheKey(
   key.set_device_type(device_type().type_string());
   key.set_prefix(persistence_prefix());
   key.set_compiled_using_pjrt(compiled_using_pjrt);
+  key.set_compiler_flags_fingerprint(compiler_flags_fingerprint_);
+  key.set_device_fingerprint(device_fingerprint_);
   return key;
 }
 
@@ -232,6 +262,28 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToReadSerializedEntry(
   return std::optional<XlaSerializedCacheEntry>(entry);
 }
 
+template <typename ExecutableType, typename ClientType>
+std::optional<XlaSerializedCacheEntry>
+DeviceExecutablePersistor<ExecutableType, ClientType>::TryToReadSharedEntry(
+    const XlaSerializedCacheKey& key, const std::string& signature_str) const {
+  if (shared_store_ == nullptr) {
+    return std::nullopt;
+  }
+
+  absl::StatusOr<std::optional<XlaSerializedCacheEntry>> entry;
+  {
+    XLA_SCOPED_LOGGING_TIMER(
+        absl::StrCat("Try loading shared cache entry:", signature_str));
+    entry = shared_store_->Lookup(key);
+  }
+  if (!entry.ok()) {
+    LOG(WARNING) << "Failed to look up " << signature_str
+                 << " in the shared XLA executable store: " << entry.status();
+    return std::nullopt;
+  }
+  return *std::move(entry);
+}
+
 template <typename ExecutableType, typename ClientType>
 absl::Status
 DeviceExecutablePersistor<ExecutableType, ClientType>::VerifyLoadedCacheEntry(
@@ -344,7 +396,7 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToLoadExecutable(
     const XlaCompiler::Options& options,
     const XlaCompiler::CompilationResult& compilation_result,
     DeviceCompilerClient<ExecutableType, ClientType>* compiler_client) const {
-  if (persistent_cache_directory_.empty()) {
+  if (persistent_cache_directory_.empty() && shared_store_ == nullptr) {
     return std::nullopt;
   }
 
@@ -355,18 +407,44 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToLoadExecutable(
       BuildSerializedCacheKey(signature_hash, hlo_module);
 
   std::optional<XlaSerializedCacheEntry> serialized_entry;
-  {
+  if (!persistent_cache_directory_.empty()) {
     XLA_SCOPED_LOGGING_TIMER(
         absl::StrCat("Try loading serialized cache entry:", signature_str));
     TF_ASSIGN_OR_RETURN(serialized_entry, TryToReadSerializedEntry(cache_key));
   }
 
+  bool from_shared_store = false;
+  if (!serialized_entry.has_value()) {
+    serialized_entry = TryToReadSharedEntry(cache_key, signature_str);
+    from_shared_store = serialized_entry.has_value();
+  }
+
   if (!serialized_entry.has_value()) {
     return std::nullopt;
   }
 
-  TF_RETURN_IF_ERROR(
-      VerifyLoadedCacheEntry(cache_key, hlo_module, *serialized_entry));
+  absl::Status verified =
+      VerifyLoadedCacheEntry(cache_key, hlo_module, *serialized_entry);
+  if (from_shared_store) {
+    // Entries of the shared store are not under our control; treat bad ones as
+    // misses rather than failing the compilation.
+    if (!verified.ok()) {
+      LOG(WARNING) << "Ignoring shared XLA executable store entry for "
+                   << signature_str << ": " << verified;
+      return std::nullopt;
+    }
+    // Populate the local tier so that later loads don't go to the store.
+    if (!persistent_cache_directory_.empty() &&
+        !persistent_cache_directory_read_only_) {
+      absl::Status saved = SaveSerializedEntry(*serialized_entry);
+      if (!saved.ok()) {
+        LOG(WARNING) << "Failed to save shared XLA executable store entry for "
+                     << signature_str << " to " << persistent_cache_directory_
+                     << ": " << saved;
+      }
+    }
+  }
+  TF_RETURN_IF_ERROR(verified);
 
   VLOG(1) << "Loading cached entry for: " << signature_str;
   return compiler_client->LoadExecutable(options, compilation_result,
@@ -381,8 +459,9 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToPersistExecutable(
     const XlaCompiler::CompilationResult& compilation_result,
     const ExecutableType& executable,
     DeviceCompilerClient<ExecutableType, ClientType>* client) const {
-  if (persistent_cache_directory_.empty() ||
-      persistent_cache_directory_read_only_) {
+  const bool persist_to_directory = !persistent_cache_directory_.empty() &&
+                                    !persistent_cache_directory_read_only_;
+  if (!persist_to_directory && shared_store_ == nullptr) {
     VLOG(1) << "Not persisting executable. No `persistent_cache_directory` "
                "provided or cache is read-only.";
     return absl::OkStatus();
@@ -393,7 +472,16 @@ DeviceExecutablePersistor<ExecutableType, ClientType>::TryToPersistExecutable(
   TF_ASSIGN_OR_RETURN(XlaSerializedCacheEntry serialized_entry,
                       SerializeEntry(signature_hash, options,
                                      compilation_result, executable, client));
-  TF_RETURN_IF_ERROR(SaveSerializedEntry(std::move(serialized_entry)));
+  if (shared_store_ != nullptr) {
+    absl::Status inserted = shared_store_->Insert(serialized_entry);
+    if (!inserted.ok()) {
+      LOG(WARNING) << "Failed to insert " << signature_str
+                   << " into the shared XLA executable store: " << inserted;
+    }
+  }
+  if (persist_to_directory) {
+    TF_RETURN_IF_ERROR(SaveSerializedEntry(std::move(serialized_entry)));
+  }
   VLOG(2) << "XlaSerializedCacheEntry saved for signature: [" << signature_str
           << "] with signature hash: " << signature_hash;
   return absl::OkStatus();
@@ -17,7 +17,9 @@ limitations under the License.
 
 #include <stdlib.h>
 
+#include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -31,6 +33,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/pjrt_device_compiler_client.h"
 #include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
 #include "tensorflow/compiler/jit/xla_device_compiler_client.h"
+#include "tensorflow/compiler/jit/xla_serialized_cache_store.h"
 #include "xla/client/client_library.h"
 #include "xla/client/executable_build_options.h"
 #include "xla/client/local_client.h"
@@ -194,6 +197,29 @@ class MockPjRtCompilerClient : public PjRtDeviceCompilerClient {
               (override));
 };
 
+// An in-process stand-in for a store shared between processes.
+class InMemoryCacheStore : public XlaSerializedCacheStore {
+ public:
+  absl::StatusOr<std::optional<XlaSerializedCacheEntry>> Lookup(
+      const XlaSerializedCacheKey& key) override {
+    auto it = entries_.find(XlaSerializedCacheKeyToFileName(key));
+    if (it == entries_.end()) {
+      return std::optional<XlaSerializedCacheEntry>();
+    }
+    return std::optional<XlaSerializedCacheEntry>(it->second);
+  }
+
+  absl::Status Insert(const XlaSerializedCacheEntry& entry) override {
+    entries_[XlaSerializedCacheKeyToFileName(entry.key())] = entry;
+    return absl::OkStatus();
+  }
+
+  int size() const { return entries_.size(); }
+
+ private:
+  std::map<std::string, XlaSerializedCacheEntry> entries_;
+};
+
 std::string GetFilePath(XlaSerializedCacheKey key,
                         const std::string& persistent_cache_dir) {
   static constexpr char kXlaSerializedCacheKeySeparator[] = "__";
@@ -580,6 +606,69 @@ TEST_F(DeviceExecutionPersistorTest, LoadSerializedExecutableEmpty) {
               testing::StatusIs(error::INVALID_ARGUMENT));
 }
 
+TEST_F(DeviceExecutionPersistorTest, PersistAndLoadFromSharedStore) {
+  InMemoryCacheStore store;
+
+  // A process without a local directory compiles and publishes to the store.
+  XlaDeviceExecutablePersistor::Config publisher_config(
+      /*persistent_cache_directory=*/"",
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"shared");
+  publisher_config.device_fingerprint = "test_device";
+  publisher_config.shared_store = &store;
+  XlaDeviceExecutablePersistor publisher(publisher_config,
+                                         DefaultXlaOptions().device_type);
+
+  MockXlaCompilerClient mock_client;
+  EXPECT_CALL(mock_client, SerializeExecutable(_))
+      .WillOnce(Return(serialized_xla_executable_));
+  TF_ASSERT_OK_AND_ASSIGN(auto executable, BuildSampleExecutable());
+  TF_EXPECT_OK(publisher.TryToPersistExecutable(
+      /*signature_hash=*/123, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, *executable, &mock_client));
+  EXPECT_EQ(store.size(), 1);
+
+  // Another process misses in its local directory and loads from the store.
+  XlaDeviceExecutablePersistor::Config consumer_config(
+      /*persistent_cache_directory=*/cache_dir_,
+      /*disable_strict_signature_checks=*/false,
+      /*persistence_prefix=*/"shared");
+  consumer_config.device_fingerprint = "test_device";
+  consumer_config.shared_store = &store;
+  XlaDeviceExecutablePersistor consumer(consumer_config,
+                                        DefaultXlaOptions().device_type);
+  EXPECT_CALL(mock_client, LoadExecutable(_, _, serialized_xla_executable_))
+      .WillOnce(Return(ByMove(BuildSampleExecutable())))
+      .WillOnce(Return(ByMove(BuildSampleExecutable())));
+  auto loaded_executable = consumer.TryToLoadExecutable(
+      /*signature_hash=*/123, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, &mock_client);
+  ASSERT_TRUE(loaded_executable.has_value());
+  TF_EXPECT_OK(loaded_executable->status());
+
+  // The entry loaded from the store was saved to the local directory.
+  consumer_config.shared_store = nullptr;
+  XlaDeviceExecutablePersistor local_only(consumer_config,
+                                          DefaultXlaOptions().device_type);
+  loaded_executable = local_only.TryToLoadExecutable(
+      /*signature_hash=*/123, "signature_string", DefaultXlaOptions(),
+      compilation_result_add_, &mock_client);
+  ASSERT_TRUE(loaded_executable.has_value());
+  TF_EXPECT_OK(loaded_executable->status());
+
+  // Executables built for a different device are not shared.
+  consumer_config.device_fingerprint = "other_device";
+  consumer_config.shared_store = &store;
+  XlaDeviceExecutablePersistor other_device(consumer_config,
+                                            DefaultXlaOptions().device_type);
+  EXPECT_FALSE(other_device
+                   .TryToLoadExecutable(
+                       /*signature_hash=*/123, "signature_string",
+                       DefaultXlaOptions(), compilation_result_add_,
+                       &mock_client)
+                   .has_value());
+}
+
 TEST_F(DeviceExecutionPersistorTest, PersistPjRtAndXlaExecutables) {
   // Persist PJRT executable.
   PjRtDeviceExecutablePersistor::Config pjrt_config(
@@ -108,6 +108,14 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
       Flag("tf_xla_max_cluster_size",
            &mark_for_compilation_flags->tf_xla_max_cluster_size,
            "Maximum number of operators in an XLA compilation."),
+      Flag("tf_xla_cost_model_clustering",
+           &mark_for_compilation_flags->tf_xla_cost_model_clustering,
+           "(experimental) "
+           "Use grappler's cost model to reject auto-clusters predicted to be "
+           "slower under XLA than in TensorFlow, and to split a dominating "
+           "GEMM or convolution off the cluster boundary.  Measured op "
+           "profiles can be supplied through "
+           "TF_GRAPPLER_OP_COST_CALIBRATION."),
       Flag(
           "tf_xla_ops_to_cluster",
           &mark_for_compilation_flags->tf_xla_ops_to_cluster,
@@ -175,6 +183,12 @@ void AppendMarkForCompilationPassFlagsInternal(std::vector<Flag>* flag_list) {
            &mark_for_compilation_flags->tf_xla_persistent_cache_prefix,
            "Specifies the persistance cache prefix. Default is "
            "\"xla_compile_cache\""),
+      Flag("tf_xla_shape_buckets",
+           &mark_for_compilation_flags->tf_xla_shape_buckets,
+           "(experimental) If non-empty, pads the unknown leading dimension "
+           "of auto-clustered computations up to a bucket and slices the "
+           "outputs back, so that one executable is compiled per bucket. "
+           "Either \"pow2\" or a comma separated list of bucket sizes."),
       Flag("tf_xla_sparse_core_disable_table_stacking",
            &sparse_core_flags->tf_xla_sparse_core_disable_table_stacking,
            "Disable table stacking for all the tables passed to the SparseCore"
@@ -230,6 +244,7 @@ void AllocateAndParseFlags() {
   mark_for_compilation_flags->tf_xla_min_cluster_size = 4;
   mark_for_compilation_flags->tf_xla_max_cluster_size =
       std::numeric_limits<int32>::max();
+  mark_for_compilation_flags->tf_xla_cost_model_clustering = false;
   mark_for_compilation_flags->tf_xla_clustering_debug = false;
   mark_for_compilation_flags->tf_xla_cpu_global_jit = false;
   mark_for_compilation_flags->tf_xla_clustering_fuel =
@@ -245,6 +260,7 @@ void AllocateAndParseFlags() {
   mark_for_compilation_flags->tf_xla_disable_strict_signature_checks = false;
   mark_for_compilation_flags->tf_xla_persistent_cache_prefix =
       "xla_compile_cache";
+  mark_for_compilation_flags->tf_xla_shape_buckets = "";
 
   device_flags = new XlaDeviceFlags;
   device_flags->tf_xla_compile_on_demand = false;
@@ -333,7 +349,8 @@ void AllocateAndParseFlags() {
        Flag("tf_xla_async_compilation", &ops_flags->tf_xla_async_compilation,
             "When lazy compilation is enabled, asynchronous compilation starts "
             "the cluster compilation in the background, and the fallback path "
-            "is executed until the compilation has finished."),
+            "is executed until the compilation has finished. Clusters that "
+            "fail to compile keep using the fallback path."),
        Flag("tf_xla_use_device_api_for_xla_launch",
             &ops_flags->tf_xla_use_device_api.enabled_for_xla_launch_,
             "If true, uses Device API (PjRt) for single device compilation and "
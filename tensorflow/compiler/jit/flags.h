@@ -62,6 +62,12 @@ struct MarkForCompilationPassFlags {
   // Maximum number of operators in an XLA compilation.
   int32 tf_xla_max_cluster_size;
 
+  // If true, use grappler's analytical cost model to reject auto-clusters that
+  // are predicted to run slower under XLA, and to split off a GEMM or
+  // convolution that dominates a cluster at the cluster's boundary.  Ignored
+  // for operators explicitly marked for compilation.
+  bool tf_xla_cost_model_clustering;
+
   // If non-empty, limit XLA clustering to the following TF operations.
   string tf_xla_ops_to_cluster;
 
@@ -111,6 +117,12 @@ struct MarkForCompilationPassFlags {
 
   // Specifies the persistance cache prefix. Default is "xla_compile_cache"
   string tf_xla_persistent_cache_prefix;
+
+  // If non-empty, the unknown leading dimension of auto-clustered computations
+  // is padded up to a bucket so that one executable is compiled per bucket
+  // instead of per batch size.  Either "pow2" or a comma separated list of
+  // bucket sizes.  Empty (disabled) by default.
+  string tf_xla_shape_buckets;
 };
 
 // Flags associated with XLA Sparse Core.
@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/force_xla_constants_on_host_pass.h"
 #include "tensorflow/compiler/jit/increase_dynamism_for_auto_jit_pass.h"
 #include "tensorflow/compiler/jit/mark_for_compilation_pass.h"
+#include "tensorflow/compiler/jit/pad_dynamic_batch_for_auto_jit_pass.h"
 #include "tensorflow/compiler/jit/partially_decluster_pass.h"
 #include "tensorflow/compiler/jit/report_clustering_info_pass.h"
 #include "tensorflow/core/common_runtime/optimization_registry.h"
@@ -63,6 +64,11 @@ REGISTER_OPTIMIZATION(OptimizationPassRegistry::POST_REWRITE_FOR_EXEC, 20,
 REGISTER_OPTIMIZATION(OptimizationPassRegistry::POST_REWRITE_FOR_EXEC, 30,
                       PartiallyDeclusterPass);
 
+// Runs after PartiallyDeclusterPass so that the cluster boundaries it pads
+// and slices are final.
+REGISTER_OPTIMIZATION(OptimizationPassRegistry::POST_REWRITE_FOR_EXEC, 35,
+                      PadDynamicBatchForAutoJitPass);
+
 // ReportClusteringInfoPass pass needs to run after all of the auto-clustering
 // passes have run but before encapsulation has run.  This way it can easily
 // compute a summary of the clustering decisions we made and broadcast it via
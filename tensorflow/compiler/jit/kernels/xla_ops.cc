@@ -30,6 +30,7 @@ limitations under the License.
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/types/optional.h"
+#include "absl/types/span.h"
 #include "tensorflow/compiler/jit/device_compilation_profiler.h"
 #include "tensorflow/compiler/jit/device_compiler.h"
 #include "tensorflow/compiler/jit/encapsulate_subgraphs_pass.h"
@@ -123,6 +124,9 @@ class ExecutableClosure {
   const ResourceVarsSnapshot& resource_var_snapshots() const {
     return resource_var_snapshots_;
   }
+  ResourceVarsSnapshot* mutable_resource_var_snapshots() {
+    return &resource_var_snapshots_;
+  }
   int num_constant_args() const { return num_constant_args_; }
 
  private:
@@ -187,6 +191,63 @@ using PjRtExecutableClosure =
 using PjRtExecutableClosureStore =
     ExecutableClosureStore<xla::PjRtLoadedExecutable, xla::PjRtClient>;
 
+// Returns pointers to the values of the resource variables in `snapshots`, as
+// expected by the XLA launch utilities.
+//
+// The variables in `locked_variables`, which must be the variables updated by
+// the cluster, are locked by the caller.  If such a variable still holds the
+// value it held when it was snapshotted then the returned pointer refers to
+// the variable itself and the snapshot is dropped.  Writers copy the buffer of
+// a variable before updating it whenever someone else holds a reference to it,
+// so sharing the snapshot's buffer means holding the snapshotted value.
+//
+// Dropping the snapshot's reference lets the executable be donated the
+// variable's buffer and update the variable in place, instead of keeping the
+// old and the new value alive at once.  The buffer is still only donated if no
+// concurrent reader holds a reference to it, and the lock keeps out readers
+// that access the variable without taking one.
+template <typename MapT>
+MapT GetResourceVarPtrs(absl::Span<const VariableInfo> locked_variables,
+                        int num_constant_args,
+                        ResourceVarsSnapshot* snapshots) {
+  absl::flat_hash_map<int, Tensor*> current_values;
+  for (const VariableInfo& variable : locked_variables) {
+    // Variable indices are _XlaRun input indices, while the snapshots are
+    // keyed by _XlaCompile input indices, which include the constants.
+    current_values.emplace(variable.index() + num_constant_args,
+                           variable.var()->tensor());
+  }
+
+  MapT ptrs;
+  for (auto& [variable_index, snapshot] : *snapshots) {
+    if (!snapshot.has_value()) {
+      ptrs.emplace(variable_index, nullptr);
+      continue;
+    }
+    auto it = current_values.find(variable_index);
+    if (it != current_values.end() &&
+        it->second->dtype() == snapshot->dtype() &&
+        it->second->IsSameSize(*snapshot) &&
+        it->second->SharesBufferWith(*snapshot) &&
+        it->second->tensor_data().data() == snapshot->tensor_data().data()) {
+      VLOG(3) << "Variable at input " << variable_index
+              << " is unchanged since it was snapshotted";
+      snapshot.reset();
+      ptrs.emplace(variable_index, it->second);
+    } else {
+      ptrs.emplace(variable_index, &snapshot.value());
+    }
+  }
+  return ptrs;
+}
+
+// Returns true if the compiled cluster sends data to or receives data from the
+// host while it runs.
+bool HasHostTransfers(const XlaCompiler::CompilationResult& result) {
+  return result.host_compute_metadata.device_to_host_size() > 0 ||
+         result.host_compute_metadata.host_to_device_size() > 0;
+}
+
 se::Stream* GetStream(OpKernelContext* ctx) {
   return ctx->op_device_context() ? ctx->op_device_context()->stream()
                                   : nullptr;
@@ -775,20 +836,22 @@ void XlaCompileOp::Compute(OpKernelContext* ctx) {
         args_and_variables_snapshot->first;
     variables_snapshot = std::move(args_and_variables_snapshot->second);
 
-    // Do not alias resource updates as locking variables in XlaCompile and
-    // unlocking them in XlaRun may lead to deadlocks.
+    // Resource updates may alias their inputs: XlaRun locks the updated
+    // variables itself and only donates their buffers if they're unchanged
+    // since this snapshot and nothing else references them.  Variables are
+    // never kept locked from XlaCompile to XlaRun, which could deadlock.
     absl::Status status;
     if (use_pjrt) {
       VLOG(2) << "Using PJRT for compilation. Function name: "
               << function_.name();
       status = CompileToPjRtLoadedExecutable(
           *ctx, platform_info_, function_, args, compile_mode, has_ref_vars_,
-          /*may_alias_resource_update=*/false, &kernel, &pjrt_client,
+          /*may_alias_resource_update=*/true, &kernel, &pjrt_client,
           &pjrt_executable);
     } else {
       status = CompileToLocalExecutable(
           ctx, function_, has_ref_vars_, platform_info_, args, compile_mode,
-          /*may_alias_resource_update=*/false, &client, &kernel, &executable);
+          /*may_alias_resource_update=*/true, &client, &kernel, &executable);
     }
     if (compile_mode != DeviceCompileMode::kLazy ||
         status.code() != error::UNIMPLEMENTED) {
@@ -876,13 +939,6 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
     // last input. So the inputs look like: input tensors, resource variables,
     // closure key tensor.
     std::vector<const Tensor*> inputs = InputsFromContext(ctx);
-    absl::flat_hash_map<int, const Tensor*> variable_snapshots;
-    for (const auto& [variable_index, variable_tensor] :
-         closure.resource_var_snapshots()) {
-      variable_snapshots.emplace(variable_index, variable_tensor.has_value()
-                                                     ? &variable_tensor.value()
-                                                     : nullptr);
-    }
 
     {
       absl::StatusOr<std::vector<VariableInfo>> updated_variables =
@@ -890,6 +946,10 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
                              closure.num_constant_args());
       OP_REQUIRES_OK(ctx, updated_variables.status());
       OP_REQUIRES_OK(ctx, LockVariables(absl::MakeSpan(*updated_variables)));
+      absl::flat_hash_map<int, const Tensor*> variable_snapshots =
+          GetResourceVarPtrs<absl::flat_hash_map<int, const Tensor*>>(
+              *updated_variables, closure.num_constant_args(),
+              closure.mutable_resource_var_snapshots());
       OP_REQUIRES_OK(
           ctx, RunPjRtExecutable(closure.num_constant_args(), inputs,
                                  variable_snapshots, *updated_variables,
@@ -915,6 +975,20 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
   // already been baked into the compiled kernel.
   const xla::HloInputOutputAliasConfig& input_output_alias =
       closure.executable()->executable()->module().input_output_alias_config();
+
+  // Keep the variables the cluster updates locked while it runs, so that it
+  // can update them in place.  Clusters that transfer data from or to the host
+  // may wait on ops that need the variables, so they only lock the variables
+  // to write the results back.
+  absl::StatusOr<std::vector<VariableInfo>> variable_infos = GatherVariableInfo(
+      ctx, *closure.compilation_result(), closure.num_constant_args());
+  OP_REQUIRES_OK(ctx, variable_infos.status());
+  const bool update_variables_in_place =
+      !HasHostTransfers(*closure.compilation_result());
+  if (update_variables_in_place) {
+    OP_REQUIRES_OK(ctx, LockVariables(absl::MakeSpan(*variable_infos)));
+  }
+
   absl::StatusOr<std::vector<xla::ExecutionInput>> execution_inputs;
   std::map<int, const Tensor*> snapshot_ptrs;
   {
@@ -926,12 +1000,11 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
         },
         tsl::profiler::TraceMeLevel::kInfo);
 
-    for (const auto& [variable_index, variable_tensor] :
-         closure.resource_var_snapshots()) {
-      snapshot_ptrs.emplace(variable_index, variable_tensor.has_value()
-                                                ? &variable_tensor.value()
-                                                : nullptr);
-    }
+    snapshot_ptrs = GetResourceVarPtrs<std::map<int, const Tensor*>>(
+        update_variables_in_place ? absl::Span<const VariableInfo>(
+                                        *variable_infos)
+                                  : absl::Span<const VariableInfo>(),
+        closure.num_constant_args(), closure.mutable_resource_var_snapshots());
     execution_inputs = launch_context.PopulateInputs(
         ctx, closure.compilation_result(), snapshot_ptrs,
         /*missing_ctx_input_prefix=*/closure.num_constant_args(),
@@ -960,10 +1033,9 @@ void XlaRunOp::Compute(OpKernelContext* ctx) {
       },
       tsl::profiler::TraceMeLevel::kInfo);
 
-  absl::StatusOr<std::vector<VariableInfo>> variable_infos = GatherVariableInfo(
-      ctx, *closure.compilation_result(), closure.num_constant_args());
-  OP_REQUIRES_OK(ctx, variable_infos.status());
-  OP_REQUIRES_OK(ctx, LockVariables(absl::MakeSpan(*variable_infos)));
+  if (!update_variables_in_place) {
+    OP_REQUIRES_OK(ctx, LockVariables(absl::MakeSpan(*variable_infos)));
+  }
   OP_REQUIRES_OK(
       ctx,
       launch_context.PopulateOutputs(
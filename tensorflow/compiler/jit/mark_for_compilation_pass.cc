@@ -41,6 +41,7 @@ limitations under the License.
 #include "tensorflow/compiler/jit/device_util.h"
 #include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/resource_operation_safety_analysis.h"
+#include "tensorflow/compiler/jit/shape_inference.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
 #include "tensorflow/compiler/tf2xla/const_analysis.h"
 #include "tensorflow/compiler/tf2xla/resource_operation_table.h"
@@ -59,6 +60,9 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/control_flow.h"
+#include "tensorflow/core/grappler/clusters/utils.h"
+#include "tensorflow/core/grappler/costs/op_context.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
@@ -67,6 +71,7 @@ limitations under the License.
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/dump_graph.h"
 
 namespace tensorflow {
@@ -112,6 +117,10 @@ class MarkForCompilationPassImpl {
     int max_cluster_size;
     int min_cluster_size;
 
+    // If true, consult grappler's cost model to reject clusters that are
+    // predicted to be slower under XLA.
+    bool use_cost_model;
+
     // Compiler fuel for the auto-clustering algorithm.
     //
     // We decrement this value by one on every time we choose a compilation
@@ -306,6 +315,16 @@ class MarkForCompilationPassImpl {
   // This function removes "obviously bad" cases like these.
   absl::Status DeclusterNodes();
 
+  // Declusters the clusters that grappler's cost model predicts to run slower
+  // as one XLA computation than op by op in TensorFlow.
+  //
+  // Before giving up on a cluster we try to split off a GEMM or convolution
+  // that dominates its predicted run time, if that op sits on the boundary of
+  // the cluster.  Such ops are library calls both in TensorFlow and in XLA, so
+  // they gain nothing from fusion; clustering them only shares XLA's overheads
+  // with the rest of the cluster.
+  absl::Status DeclusterUnprofitableClusters();
+
   // Manifests the clustering decisions into the TF graph by tagging nodes with
   // an `_XlaCluster` attribute.  Also some basic filter logic, like
   // tf_xla_min_cluster_size, are applied here.
@@ -928,6 +947,295 @@ absl::Status MarkForCompilationPassImpl::DeclusterNodes() {
   return absl::OkStatus();
 }
 
+// Rough cost of dispatching one op through the TensorFlow executor, including
+// the kernel launch on GPUs.
+constexpr double kCpuOpOverheadNs = 1000;
+constexpr double kGpuOpOverheadNs = 5000;
+
+// Fixed cost of running a cluster, in multiples of the op overhead: the
+// _XlaCompile and _XlaRun ops, the executable cache lookup and the argument
+// marshalling around the XLA executable.
+constexpr double kXlaClusterOverheadInOps = 4;
+
+// A library call dominates a cluster if it accounts for at least this fraction
+// of the cluster's predicted TensorFlow run time.
+constexpr double kDominantLibraryCallFraction = 0.9;
+
+// Returns true for ops that both TensorFlow and XLA lower to a library call
+// (GEMM or convolution) instead of to fusible code.
+bool IsLibraryCall(const Node& n) {
+  static const auto* const kLibraryCalls = new absl::flat_hash_set<string>({
+      "BatchMatMul",
+      "BatchMatMulV2",
+      "BatchMatMulV3",
+      "Conv2D",
+      "Conv2DBackpropFilter",
+      "Conv2DBackpropInput",
+      "Conv3D",
+      "Conv3DBackpropFilterV2",
+      "Conv3DBackpropInputV2",
+      "DepthwiseConv2dNative",
+      "DepthwiseConv2dNativeBackpropFilter",
+      "DepthwiseConv2dNativeBackpropInput",
+      "MatMul",
+  });
+  return kLibraryCalls->contains(n.type_string());
+}
+
+// The cost model's view of a single node.
+struct NodeCost {
+  double compute_ns = 0;
+  double memory_ns = 0;
+
+  // The cost of dispatching the node as a TensorFlow op.
+  double op_overhead_ns = 0;
+
+  // The memory bandwidth of the node's device.
+  double bytes_per_ns = 0;
+
+  bool is_library_call = false;
+
+  // The sizes of the node's inputs and outputs.
+  std::vector<int64_t> input_bytes;
+  std::vector<int64_t> output_bytes;
+};
+
+// Predicts the cost of running `n` on `device` from the shapes inferred for
+// the graph.  Returns nullopt if the prediction would be meaningless, e.g.
+// because some shape is not fully known or the op isn't modelled.
+std::optional<NodeCost> EstimateNodeCost(
+    const Node& n, const GraphShapeInfo& shape_info,
+    const DeviceProperties& device,
+    const grappler::OpLevelCostEstimator& estimator) {
+  auto output_shapes = shape_info.find(n.name());
+  if (output_shapes == shape_info.end() ||
+      output_shapes->second.size() != n.num_outputs()) {
+    return std::nullopt;
+  }
+
+  grappler::DeviceInfo device_info = estimator.GetDeviceInfo(device);
+  if (device_info.gigaops <= 0 || device_info.gb_per_sec <= 0) {
+    return std::nullopt;
+  }
+
+  NodeCost cost;
+  grappler::OpContext op_context;
+  op_context.name = n.name();
+  op_context.device_name = n.assigned_device_name();
+  OpInfo& op_info = op_context.op_info;
+  op_info.set_op(n.type_string());
+  *op_info.mutable_attr() = n.def().attr();
+  *op_info.mutable_device() = device;
+
+  auto add_tensor = [](const PartialTensorShape& shape, DataType dtype,
+                       OpInfo::TensorProperties* tensor,
+                       std::vector<int64_t>* bytes) {
+    if (!shape.IsFullyDefined()) {
+      return false;
+    }
+    tensor->set_dtype(dtype);
+    shape.AsProto(tensor->mutable_shape());
+    bytes->push_back(shape.num_elements() * DataTypeSize(dtype));
+    return true;
+  };
+
+  std::vector<const Edge*> input_edges;
+  if (!n.input_edges(&input_edges).ok()) {
+    return std::nullopt;
+  }
+  for (const Edge* e : input_edges) {
+    auto input_shapes = shape_info.find(e->src()->name());
+    if (input_shapes == shape_info.end() ||
+        e->src_output() >= input_shapes->second.size() ||
+        !add_tensor(input_shapes->second[e->src_output()].shape,
+                    BaseType(n.input_type(e->dst_input())),
+                    op_info.add_inputs(), &cost.input_bytes)) {
+      return std::nullopt;
+    }
+  }
+  for (int i = 0; i < n.num_outputs(); ++i) {
+    if (!add_tensor(output_shapes->second[i].shape, BaseType(n.output_type(i)),
+                    op_info.add_outputs(), &cost.output_bytes)) {
+      return std::nullopt;
+    }
+  }
+
+  grappler::Costs costs = estimator.PredictCosts(op_context);
+  if (costs.inaccurate) {
+    return std::nullopt;
+  }
+  cost.compute_ns = costs.compute_time.count();
+  cost.memory_ns = costs.memory_time.count();
+  cost.op_overhead_ns =
+      device.type() == DEVICE_GPU ? kGpuOpOverheadNs : kCpuOpOverheadNs;
+  cost.bytes_per_ns = device_info.gb_per_sec;
+  cost.is_library_call = IsLibraryCall(n);
+  return cost;
+}
+
+// The predicted run times of a cluster.
+struct ClusterRunTimes {
+  // Running the nodes one by one as TensorFlow ops.
+  double tf_ns = 0;
+
+  // Running the nodes as one XLA computation.  Everything but the library
+  // calls is assumed to fuse, so besides the library calls only the tensors
+  // crossing the cluster's boundary go through memory.
+  double xla_ns = 0;
+};
+
+ClusterRunTimes EstimateClusterRunTimes(
+    absl::Span<Node* const> nodes,
+    const absl::flat_hash_map<const Node*, NodeCost>& node_costs) {
+  absl::flat_hash_set<const Node*> in_cluster(nodes.begin(), nodes.end());
+  absl::flat_hash_set<std::pair<const Node*, int>> boundary_tensors;
+  ClusterRunTimes times;
+  double op_overhead_ns = 0;
+  int num_kernels = 1;
+  for (Node* n : nodes) {
+    const NodeCost& cost = node_costs.at(n);
+    op_overhead_ns = std::max(op_overhead_ns, cost.op_overhead_ns);
+    times.tf_ns += cost.compute_ns + cost.memory_ns;
+    if (!n->IsIdentity() && !n->IsConstant()) {
+      times.tf_ns += cost.op_overhead_ns;
+    }
+
+    times.xla_ns += cost.compute_ns;
+    if (cost.is_library_call) {
+      times.xla_ns += cost.memory_ns;
+      num_kernels++;
+      continue;
+    }
+
+    int64_t boundary_bytes = 0;
+    for (const Edge* e : n->in_edges()) {
+      if (!e->IsControlEdge() && !in_cluster.contains(e->src()) &&
+          boundary_tensors.insert({e->src(), e->src_output()}).second) {
+        boundary_bytes += cost.input_bytes[e->dst_input()];
+      }
+    }
+    for (const Edge* e : n->out_edges()) {
+      if (!e->IsControlEdge() && !in_cluster.contains(e->dst()) &&
+          boundary_tensors.insert({n, e->src_output()}).second) {
+        boundary_bytes += cost.output_bytes[e->src_output()];
+      }
+    }
+    times.xla_ns += boundary_bytes / cost.bytes_per_ns;
+  }
+  times.xla_ns += (kXlaClusterOverheadInOps + num_kernels) * op_overhead_ns;
+  return times;
+}
+
+// Returns true if all the predecessors or all the successors of `n` are
+// outside `cluster`.  Removing such a node from a cluster can't create a cycle
+// through it: that would need a path from the cluster to itself through the
+// node's other side, which the original clustering would not have allowed.
+bool IsOnClusterBoundary(const Node& n,
+                         const absl::flat_hash_set<const Node*>& cluster) {
+  auto outside_cluster = [&](const Node* m) { return !cluster.contains(m); };
+  return absl::c_all_of(n.in_nodes(), outside_cluster) ||
+         absl::c_all_of(n.out_nodes(), outside_cluster);
+}
+
+absl::Status MarkForCompilationPassImpl::DeclusterUnprofitableClusters() {
+  // Clusters that must be compiled are left alone, as are clusters with
+  // functional control flow whose bodies the cost model can't see.  We keep
+  // track of all the members of a cluster, including the ones already
+  // declustered, to decide whether a node is on its boundary.
+  std::map<int, absl::flat_hash_set<const Node*>> cluster_members;
+  std::map<int, std::vector<Node*>> cluster_nodes;
+  for (Node* n : compilation_candidates_) {
+    Cluster* cluster = GetClusterForNode(n);
+    if (cluster == nullptr || cluster->has_functional_control_flow() ||
+        cluster->is_xla_compile_attr_true()) {
+      continue;
+    }
+    cluster_members[cluster->cycles_graph_node_id()].insert(n);
+    if (!declustered_nodes_.contains(n)) {
+      cluster_nodes[cluster->cycles_graph_node_id()].push_back(n);
+    }
+  }
+  if (cluster_nodes.empty()) {
+    return absl::OkStatus();
+  }
+
+  GraphShapeInfo shape_info;
+  absl::Status status =
+      InferShapes(graph_, /*arg_shapes=*/{}, flib_def_, &shape_info);
+  if (!status.ok()) {
+    VLOG(2) << "Not using the cost model for clustering: " << status;
+    return absl::OkStatus();
+  }
+
+  // The cost model is only calibrated for CPUs and GPUs.
+  absl::flat_hash_map<string, std::optional<DeviceProperties>> devices;
+  auto get_device = [&](const string& device_name)
+      -> const std::optional<DeviceProperties>& {
+    auto [it, inserted] = devices.try_emplace(device_name);
+    DeviceNameUtils::ParsedName parsed_name;
+    if (inserted &&
+        DeviceNameUtils::ParseFullName(device_name, &parsed_name) &&
+        (parsed_name.type == DEVICE_CPU || parsed_name.type == DEVICE_GPU)) {
+      DeviceProperties device = grappler::GetDeviceInfo(parsed_name);
+      if (device.type() == parsed_name.type) {
+        it->second = std::move(device);
+      }
+    }
+    return it->second;
+  };
+
+  grappler::OpLevelCostEstimator estimator;
+  absl::flat_hash_map<const Node*, NodeCost> node_costs;
+  for (auto& [cluster_id, nodes] : cluster_nodes) {
+    bool all_costs_known = true;
+    for (Node* n : nodes) {
+      const std::optional<DeviceProperties>& device =
+          get_device(n->assigned_device_name());
+      std::optional<NodeCost> cost =
+          device.has_value()
+              ? EstimateNodeCost(*n, shape_info, *device, estimator)
+              : std::nullopt;
+      if (!cost.has_value()) {
+        VLOG(3) << "No cost model prediction for " << n->name() << " ("
+                << n->type_string() << "), keeping its cluster as is";
+        all_costs_known = false;
+        break;
+      }
+      node_costs[n] = *std::move(cost);
+    }
+    if (!all_costs_known) {
+      continue;
+    }
+
+    ClusterRunTimes times = EstimateClusterRunTimes(nodes, node_costs);
+    auto dominant = absl::c_find_if(nodes, [&](Node* n) {
+      const NodeCost& cost = node_costs[n];
+      return cost.is_library_call &&
+             cost.compute_ns + cost.memory_ns >=
+                 kDominantLibraryCallFraction * times.tf_ns;
+    });
+    if (dominant != nodes.end() &&
+        IsOnClusterBoundary(**dominant, cluster_members[cluster_id])) {
+      VLOG(2) << "Splitting " << (*dominant)->name()
+              << " off its cluster, it dominates the cluster's predicted "
+                 "run time";
+      declustered_nodes_.insert(*dominant);
+      nodes.erase(dominant);
+      times = EstimateClusterRunTimes(nodes, node_costs);
+    }
+
+    if (!nodes.empty() && times.xla_ns >= times.tf_ns) {
+      VLOG(2) << "Declustering "
+              << GetClusterForNode(nodes.front())->DebugString(*graph_)
+              << ", predicted to take " << times.xla_ns
+              << "ns under XLA and " << times.tf_ns << "ns in TensorFlow";
+      declustered_nodes_.insert(nodes.begin(), nodes.end());
+    }
+  }
+
+  return absl::OkStatus();
+}
+
 // Tracks monotonic sequence numbers for graphs.
 class ClusterSequenceNumberGenerator {
  public:
@@ -1604,6 +1912,9 @@ absl::Status MarkForCompilationPassImpl::Run() {
 
   TF_RETURN_IF_ERROR(RunEdgeContractionLoop());
   TF_RETURN_IF_ERROR(DeclusterNodes());
+  if (debug_options_.use_cost_model) {
+    TF_RETURN_IF_ERROR(DeclusterUnprofitableClusters());
+  }
   TF_RETURN_IF_ERROR(CreateClusters());
   TF_RETURN_IF_ERROR(DumpDebugInfo());
 
@@ -1922,6 +2233,7 @@ absl::Status MarkForCompilationPass::Run(
       flags->tf_xla_deterministic_cluster_names;
   debug_options.max_cluster_size = flags->tf_xla_max_cluster_size;
   debug_options.min_cluster_size = flags->tf_xla_min_cluster_size;
+  debug_options.use_cost_model = flags->tf_xla_cost_model_clustering;
   debug_options.fuel = GetPointerToFuel(flags->tf_xla_clustering_fuel);
   debug_options.dump_graphs = flags->tf_xla_clustering_debug;
 
@@ -1941,6 +2253,7 @@ absl::Status MarkForCompilationPass::RunForTest(
   debug_options.deterministic_cluster_names = deterministic_cluster_names;
   debug_options.max_cluster_size = flags->tf_xla_max_cluster_size;
   debug_options.min_cluster_size = flags->tf_xla_min_cluster_size;
+  debug_options.use_cost_model = flags->tf_xla_cost_model_clustering;
   debug_options.fuel = GetPointerToFuel(flags->tf_xla_clustering_fuel);
   debug_options.dump_graphs = flags->tf_xla_clustering_debug;
 
@@ -39,6 +39,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/sendrecv_ops.h"
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/compiler/jit/defs.h"
+#include "tensorflow/compiler/jit/flags.h"
 #include "tensorflow/compiler/jit/mark_for_compilation_pass_test_helper.h"
 #include "tensorflow/compiler/jit/node_matchers.h"
 #include "tensorflow/compiler/jit/xla_cluster_util.h"
@@ -50,6 +51,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/graph_def_builder.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/test.h"
@@ -1479,6 +1481,84 @@ TEST(XlaCompilationTest, DontCreateCombinedCpuUnknownClusters) {
   EXPECT_EQ(clusters["test/y"], "");
 }
 
+// Builds a graph of four scalar ops, each of which costs much less than the
+// overhead of running a cluster.
+std::unique_ptr<Graph> BuildScalarChainGraph() {
+  Scope root = Scope::NewRootScope().ExitOnError();
+  Output a = ops::Placeholder(root.WithOpName("test/a"), DT_FLOAT,
+                              ops::Placeholder::Shape({}));
+  Output b = ops::Placeholder(root.WithOpName("test/b"), DT_FLOAT,
+                              ops::Placeholder::Shape({}));
+
+  Output x = ops::Add(root.WithOpName("test/x"), a, b);
+  Output y = ops::Mul(root.WithOpName("test/y"), x, b);
+  Output z = ops::Sub(root.WithOpName("test/z"), y, a);
+  ops::Neg(root.WithOpName("test/w"), z);
+
+  std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
+  TF_CHECK_OK(root.ToGraph(graph.get()));
+  for (Node* n : graph->nodes()) {
+    n->set_assigned_device_name(kCPU0);
+  }
+  return graph;
+}
+
+TEST(XlaCompilationTest, CostModelRejectsUnprofitableCluster) {
+  MarkForCompilationPassFlags* flags = GetMarkForCompilationPassFlags();
+  bool old_cost_model_clustering = flags->tf_xla_cost_model_clustering;
+  auto restore_flags = gtl::MakeCleanup([&] {
+    flags->tf_xla_cost_model_clustering = old_cost_model_clustering;
+  });
+
+  flags->tf_xla_cost_model_clustering = false;
+  std::unique_ptr<Graph> graph = BuildScalarChainGraph();
+  TF_ASSERT_OK(MarkForCompilationPassTestHelper::MarkForCompilation(&graph));
+  std::unordered_map<string, string> clusters = GetClusters(*graph);
+  EXPECT_NE(clusters["test/x"], "");
+  EXPECT_EQ(clusters["test/x"], clusters["test/w"]);
+
+  flags->tf_xla_cost_model_clustering = true;
+  graph = BuildScalarChainGraph();
+  TF_ASSERT_OK(MarkForCompilationPassTestHelper::MarkForCompilation(&graph));
+  EXPECT_TRUE(GetClusters(*graph).empty());
+}
+
+TEST(XlaCompilationTest, CostModelSplitsOffDominantMatMul) {
+  MarkForCompilationPassFlags* flags = GetMarkForCompilationPassFlags();
+  bool old_cost_model_clustering = flags->tf_xla_cost_model_clustering;
+  auto restore_flags = gtl::MakeCleanup([&] {
+    flags->tf_xla_cost_model_clustering = old_cost_model_clustering;
+  });
+  flags->tf_xla_cost_model_clustering = true;
+
+  Scope root = Scope::NewRootScope().ExitOnError();
+  Output a = ops::Placeholder(root.WithOpName("test/a"), DT_FLOAT,
+                              ops::Placeholder::Shape({2048, 2048}));
+  Output b = ops::Placeholder(root.WithOpName("test/b"), DT_FLOAT,
+                              ops::Placeholder::Shape({2048, 2048}));
+
+  Output m = ops::MatMul(root.WithOpName("test/m"), a, b);
+  Output x = ops::Relu(root.WithOpName("test/x"), m);
+  Output y = ops::Tanh(root.WithOpName("test/y"), x);
+  ops::Sigmoid(root.WithOpName("test/z"), y);
+
+  std::unique_ptr<Graph> graph(new Graph(OpRegistry::Global()));
+  TF_ASSERT_OK(root.ToGraph(graph.get()));
+  for (Node* n : graph->nodes()) {
+    n->set_assigned_device_name(kCPU0);
+  }
+
+  TF_ASSERT_OK(MarkForCompilationPassTestHelper::MarkForCompilation(&graph));
+
+  // The element-wise ops still benefit from fusion once the MatMul, which
+  // dominates the cluster, is split off.
+  std::unordered_map<string, string> clusters = GetClusters(*graph);
+  EXPECT_EQ(clusters["test/m"], "");
+  EXPECT_NE(clusters["test/x"], "");
+  EXPECT_EQ(clusters["test/x"], clusters["test/y"]);
+  EXPECT_EQ(clusters["test/x"], clusters["test/z"]);
+}
+
 TEST(XlaCompilationTest, ClusterResourceOpsWhenSafe) {
   Scope root = Scope::NewRootScope().ExitOnError();
   Output a = ops::Placeholder(root.WithOpName("test/a"), DT_FLOAT);
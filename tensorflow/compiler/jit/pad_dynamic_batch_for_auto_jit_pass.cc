@@ -0,0 +1,589 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/pad_dynamic_batch_for_auto_jit_pass.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "tensorflow/cc/framework/ops.h"
+#include "tensorflow/cc/framework/scope.h"
+#include "tensorflow/cc/framework/scope_internal.h"
+#include "tensorflow/cc/ops/array_ops.h"
+#include "tensorflow/cc/ops/const_op.h"
+#include "tensorflow/cc/ops/math_ops.h"
+#include "tensorflow/compiler/jit/flags.h"
+#include "tensorflow/compiler/jit/shape_inference.h"
+#include "tensorflow/compiler/jit/xla_cluster_util.h"
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/dump_graph.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/statusor.h"
+
+namespace tensorflow {
+namespace {
+
+// The largest bucket used by the "pow2" policy is 2^kMaxPow2BucketLog2.
+constexpr int kMaxPow2BucketLog2 = 40;
+
+absl::StatusOr<std::vector<int64_t>> ParseShapeBuckets(absl::string_view spec) {
+  std::vector<int64_t> buckets;
+  if (spec == "pow2") {
+    for (int i = 0; i <= kMaxPow2BucketLog2; ++i) {
+      buckets.push_back(int64_t{1} << i);
+    }
+    return buckets;
+  }
+
+  for (absl::string_view piece :
+       absl::StrSplit(spec, ',', absl::SkipWhitespace())) {
+    int64_t bucket;
+    if (!absl::SimpleAtoi(piece, &bucket) || bucket <= 0) {
+      return errors::InvalidArgument(
+          "Invalid --tf_xla_shape_buckets value \"", spec,
+          "\": expected \"pow2\" or a comma separated list of positive "
+          "integers");
+    }
+    buckets.push_back(bucket);
+  }
+  if (buckets.empty()) {
+    return errors::InvalidArgument("Invalid --tf_xla_shape_buckets value \"",
+                                   spec, "\"");
+  }
+
+  std::sort(buckets.begin(), buckets.end());
+  buckets.erase(std::unique(buckets.begin(), buckets.end()), buckets.end());
+  return buckets;
+}
+
+const PartialTensorShape* GetInferredShape(const GraphShapeInfo& shape_info,
+                                           const Node* n, int output) {
+  auto it = shape_info.find(n->name());
+  if (it == shape_info.end() || output >= it->second.size()) {
+    return nullptr;
+  }
+  return &it->second[output].shape;
+}
+
+// Returns true if `dtype` and `shape` describe a tensor we can pad along an
+// unknown leading dimension.
+bool IsPaddableBatchedTensor(DataType dtype, const PartialTensorShape* shape) {
+  dtype = BaseType(dtype);
+  if (!DataTypeIsFloating(dtype) && !DataTypeIsInteger(dtype) &&
+      !DataTypeIsComplex(dtype) && dtype != DT_BOOL) {
+    return false;
+  }
+  return shape != nullptr && shape->dims() >= 1 && shape->dim_size(0) < 0;
+}
+
+// Returns the value of the int32 or int64 Const feeding input `index` of `n`.
+std::optional<std::vector<int64_t>> GetConstantIntInput(const Node* n,
+                                                        int index) {
+  const Node* src;
+  if (!n->input_node(index, &src).ok() || !src->IsConstant()) {
+    return std::nullopt;
+  }
+
+  const TensorProto* proto = nullptr;
+  Tensor tensor;
+  if (!GetNodeAttr(src->def(), "value", &proto).ok() ||
+      !tensor.FromProto(*proto)) {
+    return std::nullopt;
+  }
+
+  std::vector<int64_t> result;
+  if (tensor.dtype() == DT_INT32) {
+    auto flat = tensor.flat<int32>();
+    result.assign(flat.data(), flat.data() + flat.size());
+  } else if (tensor.dtype() == DT_INT64) {
+    auto flat = tensor.flat<int64_t>();
+    result.assign(flat.data(), flat.data() + flat.size());
+  } else {
+    return std::nullopt;
+  }
+  return result;
+}
+
+// Returns true if any of `axes` refers to dimension 0 of a rank `rank` tensor.
+bool ContainsBatchAxis(absl::Span<const int64_t> axes, int rank) {
+  return absl::c_any_of(axes, [&](int64_t axis) {
+    return axis == 0 || axis + rank == 0;
+  });
+}
+
+bool IsRowWiseUnaryOp(absl::string_view op) {
+  static const auto* const kOps = new absl::flat_hash_set<absl::string_view>{
+      "Abs", "Cast", "Ceil", "Cos", "Elu", "Erf", "Exp", "Floor", "Identity",
+      "IsFinite", "IsNan", "LeakyRelu", "Log", "Log1p", "LogicalNot", "Neg",
+      "Reciprocal", "Relu", "Relu6", "Round", "Rsqrt", "Selu", "Sigmoid",
+      "Sign", "Sin", "Snapshot", "Softplus", "Softsign", "Sqrt", "Square",
+      "StopGradient", "Tanh"};
+  return kOps->contains(op);
+}
+
+bool IsBroadcastingElementwiseOp(absl::string_view op) {
+  static const auto* const kOps = new absl::flat_hash_set<absl::string_view>{
+      "Add", "AddV2", "Div", "DivNoNan", "Equal", "FloorDiv", "FloorMod",
+      "Greater", "GreaterEqual", "Less", "LessEqual", "LogicalAnd", "LogicalOr",
+      "Maximum", "Minimum", "Mul", "NotEqual", "Pow", "RealDiv", "SelectV2",
+      "SquaredDifference", "Sub"};
+  return kOps->contains(op);
+}
+
+bool IsReductionOp(absl::string_view op) {
+  static const auto* const kOps = new absl::flat_hash_set<absl::string_view>{
+      "All", "Any", "ArgMax", "ArgMin", "Max", "Mean", "Min", "Prod", "Sum"};
+  return kOps->contains(op);
+}
+
+// Returns true if, given that the inputs of `n` marked in `batched` have a
+// leading batch dimension, every output of `n` has the same leading batch
+// dimension and row i of each output only depends on row i of the batched
+// inputs.  `input_shapes` holds the inferred shape of each data input (or
+// nullptr if unknown).
+bool IsRowIndependent(
+    const Node* n, const std::vector<bool>& batched,
+    absl::Span<const PartialTensorShape* const> input_shapes) {
+  auto rank = [&](int i) {
+    return input_shapes[i] == nullptr ? -1 : input_shapes[i]->dims();
+  };
+
+  const string& op = n->type_string();
+  if (IsRowWiseUnaryOp(op)) {
+    return true;
+  }
+
+  if (op == "BiasAdd") {
+    return batched[0] && !batched[1];
+  }
+
+  // Broadcasting must not replicate a non-batched operand along the batch
+  // dimension in a way that depends on it: batched operands have to define
+  // the output rank and non-batched operands must broadcast along dim 0.
+  auto broadcasts_row_wise = [&](int min_batched_rank) {
+    int max_rank = 0;
+    for (int i = 0; i < batched.size(); ++i) {
+      if (rank(i) < 0) return false;
+      max_rank = std::max(max_rank, rank(i));
+    }
+    for (int i = 0; i < batched.size(); ++i) {
+      if (batched[i]) {
+        if (rank(i) != max_rank || rank(i) < min_batched_rank) return false;
+      } else if (rank(i) == max_rank && input_shapes[i]->dim_size(0) != 1) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  if (IsBroadcastingElementwiseOp(op)) {
+    return broadcasts_row_wise(/*min_batched_rank=*/1);
+  }
+
+  if (op == "BatchMatMulV2" || op == "BatchMatMulV3") {
+    return broadcasts_row_wise(/*min_batched_rank=*/3);
+  }
+
+  if (op == "MatMul") {
+    bool transpose_a = false;
+    return batched[0] && !batched[1] &&
+           TryGetNodeAttr(n->attrs(), "transpose_a", &transpose_a) &&
+           !transpose_a;
+  }
+
+  if (op == "Softmax" || op == "LogSoftmax") {
+    return rank(0) >= 2;
+  }
+
+  if (IsReductionOp(op)) {
+    std::optional<std::vector<int64_t>> axes = GetConstantIntInput(n, 1);
+    return batched[0] && !batched[1] && rank(0) >= 1 && axes.has_value() &&
+           !ContainsBatchAxis(*axes, rank(0));
+  }
+
+  if (op == "ConcatV2") {
+    int axis_index = batched.size() - 1;
+    std::optional<std::vector<int64_t>> axis =
+        GetConstantIntInput(n, axis_index);
+    return !batched[axis_index] &&
+           std::all_of(batched.begin(), batched.begin() + axis_index,
+                       [](bool b) { return b; }) &&
+           rank(0) >= 1 && axis.has_value() && axis->size() == 1 &&
+           !ContainsBatchAxis(*axis, rank(0));
+  }
+
+  if (op == "Transpose") {
+    std::optional<std::vector<int64_t>> perm = GetConstantIntInput(n, 1);
+    return batched[0] && !batched[1] && perm.has_value() && !perm->empty() &&
+           (*perm)[0] == 0;
+  }
+
+  if (op == "ExpandDims") {
+    std::optional<std::vector<int64_t>> axis = GetConstantIntInput(n, 1);
+    return batched[0] && !batched[1] && rank(0) >= 1 && axis.has_value() &&
+           axis->size() == 1 && !ContainsBatchAxis(*axis, rank(0) + 1);
+  }
+
+  if (op == "Squeeze") {
+    std::vector<int32> squeeze_dims;
+    return TryGetNodeAttr(n->attrs(), "squeeze_dims", &squeeze_dims) &&
+           !squeeze_dims.empty() && rank(0) >= 1 &&
+           !ContainsBatchAxis(std::vector<int64_t>(squeeze_dims.begin(),
+                                                   squeeze_dims.end()),
+                              rank(0));
+  }
+
+  if (op == "Reshape") {
+    // Only reshapes of the form [B, ...] -> [-1, ...] that keep the number of
+    // elements per row preserve the batch dimension.
+    std::optional<std::vector<int64_t>> shape = GetConstantIntInput(n, 1);
+    if (!batched[0] || batched[1] || !shape.has_value() || shape->empty() ||
+        (*shape)[0] != -1 || rank(0) < 1) {
+      return false;
+    }
+    int64_t input_row_size = 1;
+    for (int i = 1; i < rank(0); ++i) {
+      if (input_shapes[0]->dim_size(i) < 0) return false;
+      input_row_size *= input_shapes[0]->dim_size(i);
+    }
+    int64_t output_row_size = 1;
+    for (int i = 1; i < shape->size(); ++i) {
+      if ((*shape)[i] < 0) return false;
+      output_row_size *= (*shape)[i];
+    }
+    return input_row_size > 0 && input_row_size == output_row_size;
+  }
+
+  if (op == "GatherV2") {
+    int batch_dims = 0;
+    std::optional<std::vector<int64_t>> axis = GetConstantIntInput(n, 2);
+    if (batched[2] || !axis.has_value() || axis->size() != 1 ||
+        (TryGetNodeAttr(n->attrs(), "batch_dims", &batch_dims) &&
+         batch_dims != 0) ||
+        rank(0) < 1) {
+      return false;
+    }
+    bool gathers_along_batch = ContainsBatchAxis(*axis, rank(0));
+    // Either the params are batched and we gather along another axis, or the
+    // indices are batched and select rows of the params.
+    return batched[0] != batched[1] &&
+           (batched[0] ? !gathers_along_batch : gathers_along_batch);
+  }
+
+  return false;
+}
+
+// A tensor with a leading batch dimension that crosses a cluster boundary,
+// together with the edges through which it crosses.
+struct BatchedTensor {
+  Node* node;
+  int index;
+  int rank;
+  std::vector<const Edge*> edges;
+};
+
+struct ClusterInfo {
+  bool eligible = true;
+  std::vector<Node*> nodes;
+  std::vector<BatchedTensor> inputs;
+};
+
+void AddBatchedEdge(const Edge* e, int rank,
+                    std::vector<BatchedTensor>* tensors) {
+  for (BatchedTensor& t : *tensors) {
+    if (t.node == e->src() && t.index == e->src_output()) {
+      t.edges.push_back(e);
+      return;
+    }
+  }
+  tensors->push_back({e->src(), e->src_output(), rank, {e}});
+}
+
+// Finds the clusters whose computation is row independent along the unknown
+// leading dimension of their inputs.
+std::map<string, ClusterInfo> AnalyzeClusters(
+    const Graph& g, const GraphShapeInfo& shape_info,
+    absl::flat_hash_set<std::pair<const Node*, int>>* batched_tensors) {
+  std::map<string, ClusterInfo> clusters;
+  absl::flat_hash_set<const Node*> visited;
+
+  std::vector<Node*> order;
+  GetReversePostOrder(g, &order);
+  for (Node* n : order) {
+    std::optional<absl::string_view> cluster_name = GetXlaClusterForNode(*n);
+    if (!cluster_name.has_value()) {
+      continue;
+    }
+    visited.insert(n);
+
+    ClusterInfo& cluster = clusters[string(*cluster_name)];
+    cluster.nodes.push_back(n);
+    if (!cluster.eligible) {
+      continue;
+    }
+
+    std::vector<bool> batched(n->num_inputs(), false);
+    std::vector<const PartialTensorShape*> input_shapes(n->num_inputs());
+    std::vector<std::pair<const Edge*, int>> batched_input_edges;
+    for (const Edge* e : n->in_edges()) {
+      if (e->IsControlEdge()) {
+        continue;
+      }
+      const Node* src = e->src();
+      const PartialTensorShape* shape =
+          GetInferredShape(shape_info, src, e->src_output());
+      input_shapes[e->dst_input()] = shape;
+      if (GetXlaClusterForNode(*src) == cluster_name) {
+        if (!visited.contains(src)) {
+          // A back edge; we cannot tell whether it carries batched rows.
+          cluster.eligible = false;
+          break;
+        }
+        batched[e->dst_input()] =
+            batched_tensors->contains({src, e->src_output()});
+      } else if (!GetXlaClusterForNode(*src).has_value() &&
+                 IsPaddableBatchedTensor(src->output_type(e->src_output()),
+                                         shape)) {
+        // Outputs of other clusters are left alone; they already get sliced
+        // if that cluster is padded.
+        batched[e->dst_input()] = true;
+        batched_input_edges.push_back({e, shape->dims()});
+      }
+    }
+    if (!cluster.eligible || absl::c_none_of(batched, [](bool b) {
+          return b;
+        })) {
+      continue;
+    }
+
+    if (!IsRowIndependent(n, batched, input_shapes)) {
+      VLOG(2) << "Not padding cluster " << *cluster_name << ": "
+              << n->name() << " (" << n->type_string()
+              << ") is not row independent along the batch dimension";
+      cluster.eligible = false;
+      continue;
+    }
+
+    for (const auto& [e, rank] : batched_input_edges) {
+      AddBatchedEdge(e, rank, &cluster.inputs);
+    }
+    for (int i = 0; i < n->num_outputs(); ++i) {
+      batched_tensors->insert({n, i});
+    }
+  }
+  return clusters;
+}
+
+absl::Status PadCluster(Graph* g, absl::string_view cluster_name,
+                        absl::Span<const int64_t> buckets,
+                        const std::vector<BatchedTensor>& inputs,
+                        const std::vector<BatchedTensor>& outputs) {
+  VLOG(3) << "Padding the batch dimension of cluster " << cluster_name;
+
+  string host_name;
+  TF_RETURN_IF_ERROR(DeviceNameUtils::DeviceNameToCpuDeviceName(
+      inputs[0].edges[0]->dst()->assigned_device_name(), &host_name));
+
+  absl::Status status;
+  Scope main_scope = NewInternalScope(g, &status, /*refiner=*/nullptr)
+                         .NewSubScope(absl::StrCat(cluster_name,
+                                                   "/shape_bucketing"));
+  Scope host_scope = main_scope.WithAssignedDevice(host_name);
+
+  auto leading_dim = [&](const BatchedTensor& t) {
+    Output shape = ops::Shape(main_scope.WithOpName(t.node->name(), "_shape")
+                                  .WithAssignedDevice(
+                                      t.node->assigned_device_name()),
+                              Output(t.node, t.index),
+                              ops::Shape::OutType(DT_INT64));
+    return ops::Slice(host_scope.WithOpName(t.node->name(), "_dim0"), shape,
+                      {0}, {1});
+  };
+
+  // bucket = the smallest bucket >= batch_size, or batch_size if none.
+  Output batch_size = leading_dim(inputs[0]);
+  Tensor buckets_tensor(DT_INT64,
+                        TensorShape({static_cast<int64_t>(buckets.size())}));
+  absl::c_copy(buckets, buckets_tensor.flat<int64_t>().data());
+  Output sorted_buckets =
+      ops::Const(host_scope.WithOpName("buckets"), buckets_tensor);
+  Output bucket_index = ops::LowerBound(
+      host_scope.WithOpName("bucket_index"),
+      ops::Reshape(host_scope.WithOpName("sorted_buckets"), sorted_buckets,
+                   {1, -1}),
+      ops::Reshape(host_scope.WithOpName("batch_size_2d"), batch_size,
+                   {1, 1}));
+  Output candidates = ops::Concat(host_scope.WithOpName("candidates"),
+                                  {sorted_buckets, batch_size}, 0);
+  Output bucket =
+      ops::GatherV2(host_scope.WithOpName("bucket"), candidates,
+                    ops::Reshape(host_scope.WithOpName("bucket_index_1d"),
+                                 bucket_index, {1}),
+                    0);
+  Output pad = ops::Sub(host_scope.WithOpName("pad"), bucket, batch_size);
+
+  // Padding rows is only sound if all batched inputs agree on the batch size;
+  // otherwise fall back to the unpadded computation.
+  if (inputs.size() > 1) {
+    Output all_equal;
+    for (int i = 1; i < inputs.size(); ++i) {
+      Output equal = ops::Equal(host_scope.WithOpName("same_batch_size_", i),
+                                leading_dim(inputs[i]), batch_size);
+      all_equal = i == 1 ? equal
+                         : ops::LogicalAnd(
+                               host_scope.WithOpName("all_same_batch_size_", i),
+                               all_equal, equal);
+    }
+    pad = ops::SelectV2(host_scope.WithOpName("checked_pad"), all_equal, pad,
+                        ops::ZerosLike(host_scope.WithOpName("no_pad"), pad));
+  }
+
+  for (const BatchedTensor& t : inputs) {
+    Tensor mask(DT_INT64, TensorShape({t.rank, 2}));
+    mask.flat<int64_t>().setZero();
+    mask.matrix<int64_t>()(0, 1) = 1;
+    Output paddings = ops::Mul(
+        host_scope.WithOpName(t.node->name(), "_paddings"),
+        ops::Const(host_scope.WithOpName(t.node->name(), "_padding_mask"),
+                   mask),
+        pad);
+    Output padded = ops::Pad(
+        main_scope.WithOpName(t.node->name(), "_padded")
+            .WithAssignedDevice(t.edges[0]->dst()->assigned_device_name()),
+        Output(t.node, t.index), paddings);
+    TF_RETURN_IF_ERROR(main_scope.status());
+    for (const Edge* e : t.edges) {
+      TF_RETURN_IF_ERROR(
+          g->UpdateEdge(padded.node(), 0, e->dst(), e->dst_input()));
+    }
+  }
+
+  for (const BatchedTensor& t : outputs) {
+    Output end = ops::Sub(host_scope.WithOpName(t.node->name(), "_slice_end"),
+                          leading_dim(t), pad);
+    Output sliced = ops::StridedSlice(
+        main_scope.WithOpName(t.node->name(), "_sliced")
+            .WithAssignedDevice(t.node->assigned_device_name()),
+        Output(t.node, t.index),
+        ops::Const(host_scope.WithOpName(t.node->name(), "_slice_begin"),
+                   {int64_t{0}}),
+        end,
+        ops::Const(host_scope.WithOpName(t.node->name(), "_slice_strides"),
+                   {int64_t{1}}));
+    TF_RETURN_IF_ERROR(main_scope.status());
+    for (const Edge* e : t.edges) {
+      TF_RETURN_IF_ERROR(
+          g->UpdateEdge(sliced.node(), 0, e->dst(), e->dst_input()));
+    }
+  }
+
+  TF_RETURN_IF_ERROR(main_scope.status());
+  return status;
+}
+
+absl::Status FindAndPadClusters(Graph* g,
+                                const FunctionLibraryDefinition* flib_def,
+                                absl::Span<const int64_t> buckets,
+                                bool* changed) {
+  *changed = false;
+
+  GraphShapeInfo shape_info;
+  TF_RETURN_IF_ERROR(
+      InferShapes(g, /*arg_shapes=*/{}, flib_def, &shape_info));
+
+  absl::flat_hash_set<std::pair<const Node*, int>> batched_tensors;
+  std::map<string, ClusterInfo> clusters =
+      AnalyzeClusters(*g, shape_info, &batched_tensors);
+
+  for (auto& [cluster_name, cluster] : clusters) {
+    if (!cluster.eligible || cluster.inputs.empty()) {
+      continue;
+    }
+
+    std::vector<BatchedTensor> outputs;
+    for (Node* n : cluster.nodes) {
+      for (const Edge* e : n->out_edges()) {
+        if (e->IsControlEdge() ||
+            GetXlaClusterForNode(*e->dst()) == cluster_name ||
+            !batched_tensors.contains({n, e->src_output()})) {
+          continue;
+        }
+        const PartialTensorShape* shape =
+            GetInferredShape(shape_info, n, e->src_output());
+        AddBatchedEdge(e, shape == nullptr ? -1 : shape->dims(), &outputs);
+      }
+    }
+
+    TF_RETURN_IF_ERROR(
+        PadCluster(g, cluster_name, buckets, cluster.inputs, outputs));
+    *changed = true;
+  }
+
+  if (*changed) {
+    // We've added constants to the graph; hook them up to _SOURCE.
+    FixupSourceAndSinkEdges(g);
+  }
+  return absl::OkStatus();
+}
+}  // namespace
+
+absl::Status PadDynamicBatchForAutoJitPass::Run(
+    const GraphOptimizationPassOptions& options) {
+  MarkForCompilationPassFlags* flags = GetMarkForCompilationPassFlags();
+  if (flags->tf_xla_shape_buckets.empty()) {
+    return absl::OkStatus();
+  }
+  TF_ASSIGN_OR_RETURN(std::vector<int64_t> buckets,
+                      ParseShapeBuckets(flags->tf_xla_shape_buckets));
+
+  if (flags->tf_xla_clustering_debug) {
+    DumpGraphToFile("before_pad_dynamic_batch_for_auto_jit_pass",
+                    **options.graph, options.flib_def);
+  }
+
+  bool changed;
+  TF_RETURN_IF_ERROR(FindAndPadClusters(options.graph->get(), options.flib_def,
+                                        buckets, &changed));
+  if (changed && flags->tf_xla_clustering_debug) {
+    DumpGraphToFile("pad_dynamic_batch_for_auto_jit_pass", **options.graph,
+                    options.flib_def);
+  }
+
+  return absl::OkStatus();
+}
+
+}  // namespace tensorflow
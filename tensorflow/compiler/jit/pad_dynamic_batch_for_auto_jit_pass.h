@@ -0,0 +1,55 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_PAD_DYNAMIC_BATCH_FOR_AUTO_JIT_PASS_H_
+#define TENSORFLOW_COMPILER_JIT_PAD_DYNAMIC_BATCH_FOR_AUTO_JIT_PASS_H_
+
+#include "absl/status/status.h"
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+
+namespace tensorflow {
+
+// Bounds the number of recompilations of auto-clustered computations whose
+// inputs have an unknown leading ("batch") dimension.  The compilation cache
+// keys executables by exact argument shapes, so every distinct batch size
+// otherwise triggers a new compilation.  When --tf_xla_shape_buckets is set
+// this pass rewrites
+//
+//   y = cluster(x)    x: [B, ...]
+//
+// into
+//
+//   y' = cluster(Pad(x, [[0, bucket(B) - B], [0, 0], ...]))
+//   y  = StridedSlice(y', [0], [dim0(y') - (bucket(B) - B)], [1])
+//
+// where bucket(B) is the smallest configured bucket that is >= B (or B itself
+// if there is none), so that one executable is compiled per bucket.
+//
+// The rewrite is only applied to clusters in which every operation that
+// consumes a batched tensor provably computes each row of its output from the
+// corresponding rows of its batched inputs (element-wise ops, MatMul on the
+// left operand, reductions over non-batch axes, ...).  The padded rows are
+// then never observed by the rows we keep.  Clusters that mix rows (e.g. a
+// reduction over the batch dimension) or inspect the batch size (e.g. Shape)
+// are left untouched.  If the batched inputs of a cluster do not all have the
+// same leading dimension at runtime no padding is applied.
+class PadDynamicBatchForAutoJitPass : public GraphOptimizationPass {
+ public:
+  absl::Status Run(const GraphOptimizationPassOptions& options) override;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_PAD_DYNAMIC_BATCH_FOR_AUTO_JIT_PASS_H_
@@ -0,0 +1,212 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/pad_dynamic_batch_for_auto_jit_pass.h"
+
+#include <memory>
+#include <string>
+
+#include <gmock/gmock.h>
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/cc/framework/ops.h"
+#include "tensorflow/cc/framework/scope.h"
+#include "tensorflow/cc/ops/array_ops.h"
+#include "tensorflow/cc/ops/const_op.h"
+#include "tensorflow/cc/ops/math_ops.h"
+#include "tensorflow/cc/ops/nn_ops.h"
+#include "tensorflow/compiler/jit/flags.h"
+#include "tensorflow/compiler/jit/node_matchers.h"
+#include "xla/tsl/lib/core/status_test_util.h"
+#include "tensorflow/core/common_runtime/device_set.h"
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/device.h"
+#include "tensorflow/core/framework/device_attributes.pb.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tsl/platform/errors.h"
+
+namespace tensorflow {
+namespace {
+
+using ::testing::_;
+using testing::matchers::AssignedDevice;
+using testing::matchers::Inputs;
+using testing::matchers::Name;
+using testing::matchers::NodeWith;
+using testing::matchers::Op;
+using testing::matchers::Out;
+
+// A fake device used to populate a DeviceSet.
+class FakeDevice : public Device {
+ public:
+  explicit FakeDevice(const DeviceAttributes& device_attributes)
+      : Device(nullptr, device_attributes) {}
+
+  absl::Status Sync() override {
+    return errors::Unimplemented("FakeDevice::Sync()");
+  }
+
+  Allocator* GetAllocator(AllocatorAttributes attr) override { return nullptr; }
+
+  static std::unique_ptr<Device> Make(const string& name, const string& type) {
+    DeviceAttributes device_attributes;
+    device_attributes.set_name(name);
+    device_attributes.set_device_type(DeviceType(type).type());
+    return std::make_unique<FakeDevice>(device_attributes);
+  }
+};
+
+const char* kHostName = "/job:worker/replica:0/task:0/device:CPU:0";
+const char* kDeviceName = "/job:worker/replica:0/task:0/device:GPU:0";
+
+absl::Status PadDynamicBatchForAutoJit(const Scope& s,
+                                       absl::string_view shape_buckets,
+                                       std::unique_ptr<Graph>* result) {
+  std::vector<std::unique_ptr<Device>> devices;
+  devices.push_back(FakeDevice::Make(kDeviceName, DEVICE_GPU));
+  devices.push_back(FakeDevice::Make(kHostName, DEVICE_CPU));
+
+  std::unique_ptr<DeviceSet> device_set(new DeviceSet());
+  for (auto& device : devices) {
+    device_set->AddDevice(device.get());
+  }
+
+  auto graph = std::make_unique<Graph>(OpRegistry::Global());
+  SessionOptions session_options;
+  session_options.config.mutable_graph_options()
+      ->mutable_optimizer_options()
+      ->set_global_jit_level(OptimizerOptions::ON_2);
+  GraphOptimizationPassOptions options;
+  options.graph = &graph;
+  options.device_set = device_set.get();
+  options.session_options = &session_options;
+
+  // Scope::ToGraph seems to drop assigned devices, probably because it goes
+  // through a GraphDef.  So explicitly maintain the device assignment.
+  std::unordered_map<string, string> assigned_device_names;
+  for (Node* n : s.graph()->nodes()) {
+    assigned_device_names[n->name()] = n->assigned_device_name();
+  }
+  TF_RETURN_IF_ERROR(s.ToGraph(graph.get()));
+  for (Node* n : graph->nodes()) {
+    n->set_assigned_device_name(assigned_device_names[n->name()]);
+  }
+
+  MarkForCompilationPassFlags* flags = GetMarkForCompilationPassFlags();
+  string old_shape_buckets = flags->tf_xla_shape_buckets;
+  flags->tf_xla_shape_buckets = string(shape_buckets);
+  PadDynamicBatchForAutoJitPass rewriter;
+  absl::Status status = rewriter.Run(options);
+  flags->tf_xla_shape_buckets = old_shape_buckets;
+  TF_RETURN_IF_ERROR(status);
+
+  *result = std::move(graph);
+  return absl::OkStatus();
+}
+
+// Builds input[?, 4] -> cluster_0{MatMul -> Relu -> `reduce_axis` Sum?} ->
+// Identity.
+Scope BuildDenseModel(int reduce_axis) {
+  Scope root = Scope::NewRootScope().ExitOnError().WithAssignedDevice(
+      kDeviceName);
+  Scope cluster = root.WithXlaCluster("cluster_0");
+
+  Output input = ops::Placeholder(root.WithOpName("input"), DT_FLOAT,
+                                  ops::Placeholder::Shape({-1, 4}));
+  Output weights =
+      ops::Const(cluster.WithOpName("weights"), 1.0f, TensorShape({4, 3}));
+  Output matmul = ops::MatMul(cluster.WithOpName("matmul"), input, weights);
+  Output relu = ops::Relu(cluster.WithOpName("relu"), matmul);
+  Output result = relu;
+  if (reduce_axis >= 0) {
+    result = ops::Sum(cluster.WithOpName("sum"), relu, reduce_axis);
+  }
+  ops::Identity(root.WithOpName("out"), result);
+  return root;
+}
+
+TEST(PadDynamicBatchForAutoJitPassTest, PadsInputsAndSlicesOutputs) {
+  Scope root = BuildDenseModel(/*reduce_axis=*/-1);
+
+  std::unique_ptr<Graph> result;
+  TF_ASSERT_OK(PadDynamicBatchForAutoJit(root, "pow2", &result));
+
+  auto m_input = Out(NodeWith(Op("Placeholder"), Name("input")));
+  auto m_padded_input =
+      Out(NodeWith(Op("Pad"), AssignedDevice(kDeviceName),
+                   Inputs(m_input, Out(NodeWith(Op("Mul"),
+                                                AssignedDevice(kHostName))))));
+  auto m_relu = Out(NodeWith(Op("Relu"), Name("relu")));
+
+  Node* matmul = testing::FindNodeByName(result.get(), "matmul");
+  ASSERT_NE(matmul, nullptr);
+  EXPECT_THAT(matmul, NodeWith(Inputs(m_padded_input, _)));
+
+  Node* out = testing::FindNodeByName(result.get(), "out");
+  ASSERT_NE(out, nullptr);
+  EXPECT_THAT(out,
+              NodeWith(Inputs(Out(NodeWith(
+                  Op("StridedSlice"), AssignedDevice(kDeviceName),
+                  Inputs(m_relu, _,
+                         Out(NodeWith(Op("Sub"), AssignedDevice(kHostName))),
+                         _))))));
+}
+
+TEST(PadDynamicBatchForAutoJitPassTest, ReductionOverBatchIsNotPadded) {
+  Scope root = BuildDenseModel(/*reduce_axis=*/0);
+
+  std::unique_ptr<Graph> result;
+  TF_ASSERT_OK(PadDynamicBatchForAutoJit(root, "pow2", &result));
+
+  EXPECT_THAT(result->nodes(), Not(Contains(NodeWith(Op("Pad")))));
+}
+
+TEST(PadDynamicBatchForAutoJitPassTest, ReductionOverFeaturesIsPadded) {
+  Scope root = BuildDenseModel(/*reduce_axis=*/1);
+
+  std::unique_ptr<Graph> result;
+  TF_ASSERT_OK(PadDynamicBatchForAutoJit(root, "8,32,128", &result));
+
+  Node* out = testing::FindNodeByName(result.get(), "out");
+  ASSERT_NE(out, nullptr);
+  EXPECT_THAT(out, NodeWith(Inputs(Out(NodeWith(Op("StridedSlice"))))));
+}
+
+TEST(PadDynamicBatchForAutoJitPassTest, DisabledByDefault) {
+  Scope root = BuildDenseModel(/*reduce_axis=*/-1);
+
+  std::unique_ptr<Graph> result;
+  TF_ASSERT_OK(PadDynamicBatchForAutoJit(root, "", &result));
+
+  EXPECT_THAT(result->nodes(), Not(Contains(NodeWith(Op("Pad")))));
+}
+
+TEST(PadDynamicBatchForAutoJitPassTest, InvalidBuckets) {
+  Scope root = BuildDenseModel(/*reduce_axis=*/-1);
+
+  std::unique_ptr<Graph> result;
+  absl::Status status = PadDynamicBatchForAutoJit(root, "8,big", &result);
+  EXPECT_EQ(status.code(), absl::StatusCode::kInvalidArgument);
+}
+
+}  // namespace
+}  // namespace tensorflow
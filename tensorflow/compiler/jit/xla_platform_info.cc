@@ -24,6 +24,7 @@ limitations under the License.
 
 #include "absl/algorithm/container.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/compiler/jit/device_executable_persistor.h"
@@ -31,16 +32,21 @@ limitations under the License.
 #include "tensorflow/compiler/jit/pjrt_device_compiler_client.h"
 #include "tensorflow/compiler/jit/xla_compile_util.h"
 #include "tensorflow/compiler/jit/xla_device_compiler_client.h"
+#include "tensorflow/compiler/jit/xla_serialized_cache_store.h"
 #include "xla/client/client_library.h"
 #include "xla/client/local_client.h"
+#include "xla/debug_options_flags.h"
 #include "xla/pjrt/pjrt_client.h"
 #include "xla/service/compiler.h"
+#include "xla/stream_executor/device_description.h"
 #include "xla/stream_executor/platform_manager.h"
 #include "xla/tsl/framework/device_type.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/tfrt/common/create_pjrt_client_util.h"
@@ -59,9 +65,44 @@ using XlaDeviceExecutablePersistor =
 using PjRtDeviceExecutablePersistor =
     DeviceExecutablePersistor<xla::PjRtLoadedExecutable, xla::PjRtClient>;
 
+// Returns a fingerprint of the XLA compiler flags, which affect the executables
+// stored in the persistent caches.
+uint64 GetCompilerFlagsFingerprint() {
+  return DeterministicProtoHash64(xla::GetDebugOptionsFromFlags());
+}
+
+std::string GetHostFingerprint() {
+  return absl::StrCat(port::CPUVendorIDString(), "-", port::CPUFamily(), "-",
+                      port::CPUModelNum());
+}
+
+// Identifies the hardware executables built by `local_client` run on, so that
+// entries of the persistent caches are not loaded on incompatible devices.
+std::string GetDeviceFingerprint(xla::LocalClient* local_client) {
+  if (local_client == nullptr) {
+    return GetHostFingerprint();
+  }
+  const se::DeviceDescription& description =
+      local_client->backend().default_stream_executor()->GetDeviceDescription();
+  return absl::StrCat(GetHostFingerprint(), "/", description.name(), "/",
+                      description.model_str(), "/",
+                      description.platform_version());
+}
+
+std::string GetDeviceFingerprint(xla::PjRtClient* pjrt_client) {
+  if (pjrt_client == nullptr || pjrt_client->addressable_devices().empty()) {
+    return GetHostFingerprint();
+  }
+  return absl::StrCat(GetHostFingerprint(), "/", pjrt_client->platform_name(),
+                      "/",
+                      pjrt_client->addressable_devices()[0]->device_kind(),
+                      "/", pjrt_client->platform_version());
+}
+
 XlaDeviceCompiler* CreateXlaDeviceCompiler(
-    const XlaDeviceExecutablePersistor::Config& persistor_config,
+    XlaDeviceExecutablePersistor::Config persistor_config,
     DeviceType compilation_device_type, xla::LocalClient* local_client) {
+  persistor_config.device_fingerprint = GetDeviceFingerprint(local_client);
   return new XlaDeviceCompiler(
       std::make_unique<XlaDeviceExecutablePersistor>(
           std::move(persistor_config), compilation_device_type),
@@ -78,6 +119,9 @@ PjRtDeviceCompiler* CreatePjRtDeviceCompiler(DeviceType compilation_device_type,
       GetMarkForCompilationPassFlags()->tf_xla_disable_strict_signature_checks,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_prefix,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_read_only);
+  persistor_config.compiler_flags_fingerprint = GetCompilerFlagsFingerprint();
+  persistor_config.device_fingerprint = GetDeviceFingerprint(pjrt_client);
+  persistor_config.shared_store = GetXlaSerializedCacheStore();
 
   return new PjRtDeviceCompiler(
       std::make_unique<PjRtDeviceExecutablePersistor>(
@@ -226,6 +270,8 @@ absl::Status BuildXlaDeviceCompiler(DeviceBase* device,
       GetMarkForCompilationPassFlags()->tf_xla_disable_strict_signature_checks,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_prefix,
       GetMarkForCompilationPassFlags()->tf_xla_persistent_cache_read_only);
+  persistor_config.compiler_flags_fingerprint = GetCompilerFlagsFingerprint();
+  persistor_config.shared_store = GetXlaSerializedCacheStore();
 
   if (platform_info.xla_device_metadata()) {
     *xla_device_compiler = CreateXlaDeviceCompiler(
@@ -0,0 +1,47 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/compiler/jit/xla_serialized_cache_store.h"
+
+#include <memory>
+#include <utility>
+
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+namespace {
+
+mutex store_mu(LINKER_INITIALIZED);
+
+std::unique_ptr<XlaSerializedCacheStore>& RegisteredStore()
+    TF_EXCLUSIVE_LOCKS_REQUIRED(store_mu) {
+  static auto* store = new std::unique_ptr<XlaSerializedCacheStore>();
+  return *store;
+}
+
+}  // namespace
+
+void SetXlaSerializedCacheStore(
+    std::unique_ptr<XlaSerializedCacheStore> store) {
+  mutex_lock lock(store_mu);
+  RegisteredStore() = std::move(store);
+}
+
+XlaSerializedCacheStore* GetXlaSerializedCacheStore() {
+  mutex_lock lock(store_mu);
+  return RegisteredStore().get();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,61 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_COMPILER_JIT_XLA_SERIALIZED_CACHE_STORE_H_
+#define TENSORFLOW_COMPILER_JIT_XLA_SERIALIZED_CACHE_STORE_H_
+
+#include <memory>
+#include <optional>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "tensorflow/compiler/jit/xla_compilation_cache.pb.h"
+
+namespace tensorflow {
+
+// A store of serialized XLA executables that is shared between processes, e.g.
+// a remote key-value service used by all the replicas of a job.  When one is
+// registered, DeviceExecutablePersistor looks up executables in it after
+// missing in the local persistent cache directory (which then acts as a second
+// tier in front of the store), and inserts the executables it builds into it.
+//
+// Entries are keyed by `XlaSerializedCacheKey`, which covers the cluster
+// signature, the HLO, the compiler flags and the device the executable was
+// built for.  Implementations must be thread safe.  Errors returned by a store
+// are logged and otherwise treated as cache misses; they never fail a
+// compilation.
+class XlaSerializedCacheStore {
+ public:
+  virtual ~XlaSerializedCacheStore() = default;
+
+  // Returns the entry stored for `key`, or std::nullopt if there is none.
+  virtual absl::StatusOr<std::optional<XlaSerializedCacheEntry>> Lookup(
+      const XlaSerializedCacheKey& key) = 0;
+
+  // Stores `entry` under `entry.key()`, overwriting any existing entry.
+  virtual absl::Status Insert(const XlaSerializedCacheEntry& entry) = 0;
+};
+
+// Registers the process-wide store used by the JIT compilation caches created
+// after this call.  Passing nullptr unregisters the current store; the caller
+// must make sure no compilation cache still uses it.
+void SetXlaSerializedCacheStore(std::unique_ptr<XlaSerializedCacheStore> store);
+
+// Returns the registered store, or nullptr if there is none.
+XlaSerializedCacheStore* GetXlaSerializedCacheStore();
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_COMPILER_JIT_XLA_SERIALIZED_CACHE_STORE_H_
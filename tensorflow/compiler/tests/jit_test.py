@@ -33,6 +33,7 @@ from tensorflow.python.ops import control_flow_ops
 from tensorflow.python.ops import gradients_impl
 from tensorflow.python.ops import math_ops
 from tensorflow.python.ops import nn_ops
+from tensorflow.python.ops import resource_variable_ops
 from tensorflow.python.ops import while_loop
 from tensorflow.python.platform import test
 
@@ -473,6 +474,40 @@ class XlaCompilationTest(test.TestCase):
     self.assertTrue(InLabels(labels, "XlaCompile"))
     self.assertTrue(InLabels(labels, "XlaRun"))
 
+  def testVariableUpdates(self):
+    """Tests clusters updating variables, which may happen in place."""
+    with session_lib.Session(config=NoRewriteSessionConfig()) as sess:
+      v = resource_variable_ops.ResourceVariable(
+          np.ones([2, 2], dtype=np.float32))
+      delta = array_ops.placeholder(dtypes.float32, [2, 2])
+      with jit_scope():
+        update = v.assign_add(delta, read_value=False)
+      # A value read before the update is still referenced while the cluster
+      # runs, so the cluster must not clobber its buffer.
+      old_value = array_ops.identity(v.read_value())
+      with ops.control_dependencies([old_value]):
+        with jit_scope():
+          update_after_read = v.assign_add(delta, read_value=False)
+
+      sess.run(v.initializer)
+      expected = np.ones([2, 2], dtype=np.float32)
+      for i in range(3):
+        step = np.full([2, 2], i, dtype=np.float32)
+        run_metadata = config_pb2.RunMetadata()
+        sess.run(
+            update, {delta: step},
+            run_metadata=run_metadata,
+            options=config_pb2.RunOptions(
+                trace_level=config_pb2.RunOptions.FULL_TRACE))
+        self.assertTrue(MetadataHasXlaRunOp(run_metadata))
+        expected += step
+        self.assertAllClose(sess.run(v.read_value()), expected)
+
+        old, _ = sess.run([old_value, update_after_read], {delta: step})
+        self.assertAllClose(old, expected)
+        expected += step
+        self.assertAllClose(sess.run(v.read_value()), expected)
+
 
 class ElementWiseFusionTest(test.TestCase):
 
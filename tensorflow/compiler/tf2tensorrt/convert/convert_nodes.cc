@@ -1365,6 +1365,7 @@ Status Converter::BuildCudaEngine(
   }
 
   std::unique_ptr<TimingCacheRegistry::TimingCache> timing_cache = nullptr;
+  const string timing_cache_name = GetTimingCacheName();
   // We only use a timing cache if the algorithm selector is not used. If we
   // are using TRT version >= 8.0, then we can try to deserialize an existing
   // cache.
@@ -1372,7 +1373,7 @@ Status Converter::BuildCudaEngine(
 #if IS_TRT_VERSION_GE(8, 0, 0, 0)
     TimingCacheRegistry* registry = GetTimingCacheRegistry();
 
-    auto cache = registry->LookUp("default_cache", builder_config.get());
+    auto cache = registry->LookUp(timing_cache_name, builder_config.get());
     if (!cache.ok()) {
       LOG(WARNING) << "failed to create a timing cache: "
                    << cache.status().message();
@@ -1452,7 +1453,8 @@ Status Converter::BuildCudaEngine(
 
   // Write back the new timing cache results to the registry.
   if (timing_cache) {
-    GetTimingCacheRegistry()->Upsert("default_cache", timing_cache.get());
+    GetTimingCacheRegistry()->Upsert(timing_cache_name, timing_cache.get(),
+                                     builder_config.get());
   }
 
   return OkStatus();
@@ -18,19 +18,86 @@ limitations under the License.
 
 #include <unordered_map>
 
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "tensorflow/compiler/tf2tensorrt/common/utils.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/util/env_var.h"
+#include "third_party/gpus/cuda/include/cuda_runtime_api.h"
 #include "third_party/tensorrt/NvInfer.h"
 
 namespace tensorflow {
 namespace tensorrt {
 namespace convert {
 
+namespace {
+
+#if IS_TRT_VERSION_GE(8, 0, 0, 0)
+// Returns the file the timing cache with the given name is persisted to, or the
+// empty string if persistence is disabled.
+string GetTimingCachePath(const string& name) {
+  string dir;
+  TF_CHECK_OK(ReadStringFromEnvVar("TF_TRT_TIMING_CACHE_DIR",
+                                   /*default_val=*/"", &dir));
+  if (dir.empty()) return "";
+  return io::JoinPath(dir, absl::StrCat(name, ".bin"));
+}
+
+// Writes the serialized timing cache to path. The data is written to a
+// temporary file first so that other processes never read a partial cache.
+void WriteTimingCacheFile(const string& path,
+                          const std::vector<uint8_t>& data) {
+  Env* env = Env::Default();
+  Status status = env->RecursivelyCreateDir(string(io::Dirname(path)));
+  const string tmp_path =
+      absl::StrCat(path, ".tmp.", env->GetCurrentThreadId(), ".",
+                   env->NowMicros());
+  if (status.ok()) {
+    status = WriteStringToFile(
+        env, tmp_path,
+        absl::string_view(reinterpret_cast<const char*>(data.data()),
+                          data.size()));
+  }
+  if (status.ok()) status = env->RenameFile(tmp_path, path);
+  if (!status.ok()) {
+    LOG(WARNING) << "Failed to persist the TensorRT timing cache to " << path
+                 << ": " << status;
+  }
+}
+
+// Adds the timings of the serialized timing cache to cache.
+void CombineTimingCache(const void* data, size_t size,
+                        nvinfer1::ITimingCache* cache,
+                        nvinfer1::IBuilderConfig* builder_config) {
+  std::unique_ptr<nvinfer1::ITimingCache> other(
+      builder_config->createTimingCache(data, size));
+  if (other == nullptr || !cache->combine(*other, /*ignoreMismatch=*/false)) {
+    LOG(WARNING) << "Failed to merge TensorRT timing caches";
+  }
+}
+#endif  // IS_TRT_VERSION_GE(8, 0, 0, 0)
+
+}  // namespace
+
 StatusOr<TimingCacheRegistry::TimingCachePtr> TimingCacheRegistry::LookUp(
     const string& name, nvinfer1::IBuilderConfig* builder_config) {
 #if IS_TRT_VERSION_GE(8, 0, 0, 0)
   TRT_ENSURE(builder_config != nullptr);
   mutex_lock scoped_lock(mu_);
+  if (map_.find(name) == map_.end()) {
+    // Load the timing cache persisted by an earlier or concurrent process.
+    const string path = GetTimingCachePath(name);
+    string file_data;
+    if (!path.empty() &&
+        ReadFileToString(Env::Default(), path, &file_data).ok()) {
+      VLOG(1) << "Loaded the TensorRT timing cache from " << path;
+      map_.emplace(name, std::vector<uint8_t>(file_data.begin(),
+                                              file_data.end()));
+    }
+  }
   if (map_.find(name) != map_.end()) {
     const std::vector<uint8_t>& data = map_[name];
     return std::unique_ptr<nvinfer1::ITimingCache>(
@@ -45,32 +112,40 @@ StatusOr<TimingCacheRegistry::TimingCachePtr> TimingCacheRegistry::LookUp(
       "serializable timing cache does not exist in TensorRT versions < 8.0");
 }
 
-void TimingCacheRegistry::Upsert(const string& name, TimingCache* cache) {
+void TimingCacheRegistry::Upsert(const string& name, TimingCache* cache,
+                                 nvinfer1::IBuilderConfig* builder_config) {
 #if IS_TRT_VERSION_GE(8, 0, 0, 0)
+  mutex_lock scoped_lock(mu_);
+  // Other engines may have registered timings since the cache was looked up,
+  // and other processes may have persisted theirs. Merge them so that none of
+  // them get lost by overwriting.
+  if (builder_config != nullptr) {
+    if (map_.find(name) != map_.end()) {
+      const std::vector<uint8_t>& data = map_[name];
+      CombineTimingCache(data.data(), data.size(), cache, builder_config);
+    }
+    const string path = GetTimingCachePath(name);
+    string file_data;
+    if (!path.empty() &&
+        ReadFileToString(Env::Default(), path, &file_data).ok()) {
+      CombineTimingCache(file_data.data(), file_data.size(), cache,
+                         builder_config);
+    }
+  }
+
   nvinfer1::IHostMemory* memory = cache->serialize();
   if (memory == nullptr) {
     return;
   }
 
-  if (map_.find(name) == map_.end()) {
-    // If the timing cache with the given name does not exist, emplace the
-    // serialized buffer.
-    std::vector<uint8_t> mem(memory->size());
-    std::copy_n(static_cast<uint8_t*>(memory->data()), memory->size(),
-                mem.begin());
-    {
-      mutex_lock scoped_lock(mu_);
-      map_.emplace(name, std::move(mem));
-    }
-  } else {
-    // If the timing cache does exist, use the existing buffer.
-    mutex_lock scoped_lock(mu_);
-    std::vector<uint8_t>& mem = map_[name];
-    mem.resize(memory->size());
-    std::copy_n(static_cast<uint8_t*>(memory->data()), memory->size(),
-                mem.begin());
-  }
+  std::vector<uint8_t>& mem = map_[name];
+  mem.resize(memory->size());
+  std::copy_n(static_cast<uint8_t*>(memory->data()), memory->size(),
+              mem.begin());
   memory->destroy();
+
+  const string path = GetTimingCachePath(name);
+  if (!path.empty()) WriteTimingCacheFile(path, mem);
 #endif  // IS_TRT_VERSION_GE(8, 0, 0, 0)
 }
 
@@ -79,6 +154,25 @@ TimingCacheRegistry* GetTimingCacheRegistry() {
   return registry;
 }
 
+string GetTimingCacheName() {
+  string gpu = "unknown_gpu";
+  int device_id;
+  cudaDeviceProp properties;
+  if (cudaGetDevice(&device_id) == cudaSuccess &&
+      cudaGetDeviceProperties(&properties, device_id) == cudaSuccess) {
+    gpu = absl::StrCat(properties.name, "_sm", properties.major,
+                       properties.minor);
+  }
+  string name =
+      absl::StrCat("timing_cache_", gpu, "_trt",
+                   absl::StrJoin(GetLoadedTensorRTVersion(), "."));
+  // Keep the name usable as a file name.
+  for (char& c : name) {
+    if (!absl::ascii_isalnum(c) && c != '.' && c != '_') c = '_';
+  }
+  return name;
+}
+
 }  // namespace convert
 }  // namespace tensorrt
 }  // namespace tensorflow
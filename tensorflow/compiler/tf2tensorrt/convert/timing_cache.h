@@ -30,6 +30,10 @@ namespace convert {
 // A registry for holding serialized TensorRT autotuner timing caches.
 // For TensorRT versions < 8.0, the timing cache is not serializable, so these
 // operations become no-ops.
+//
+// If the environment variable TF_TRT_TIMING_CACHE_DIR is set, the caches are
+// also persisted to that directory, one file per cache name, so that they are
+// shared between processes and survive restarts.
 class TimingCacheRegistry {
  public:
   TimingCacheRegistry() = default;
@@ -43,13 +47,16 @@ class TimingCacheRegistry {
   using TimingCachePtr = std::unique_ptr<TimingCache>;
 #endif
 
-  // Insert or update a registry into the map using the given name. The cache
-  // will be serialized before being placed into the map.
-  void Upsert(const string& name, TimingCache* cache);
+  // Insert or update a registry into the map using the given name. The timings
+  // already registered or persisted under that name are merged into the cache,
+  // which will be serialized before being placed into the map. The provided
+  // BuilderConfig is used to deserialize the caches to merge.
+  void Upsert(const string& name, TimingCache* cache,
+              nvinfer1::IBuilderConfig* builder_config);
 
   // Find a timing cache using the given name. The provided BuilderConfig is
-  // used to deserialize the cache. If no timing cache is found, a new timing
-  // cache is returned.
+  // used to deserialize the cache. If no timing cache is found either in the
+  // map or in the persistence directory, a new timing cache is returned.
   StatusOr<TimingCachePtr> LookUp(const string& name,
                                   nvinfer1::IBuilderConfig* builder_config);
 
@@ -62,6 +69,11 @@ class TimingCacheRegistry {
 
 TimingCacheRegistry* GetTimingCacheRegistry();
 
+// Returns the name of the timing cache for the current GPU model and the loaded
+// TensorRT version, since timings are only valid for the setup that measured
+// them.
+string GetTimingCacheName();
+
 }  // namespace convert
 }  // namespace tensorrt
 }  // namespace tensorflow
@@ -40,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/clusters/utils.h"
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
 #include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
@@ -188,6 +189,18 @@ class TRTEngineOp : public AsyncOpKernel {
       const std::vector<TensorShape>& input_concrete_shapes,
       OpKernelContext* ctx, TRTEngineCacheResource* cache_resource);
 
+  // Implements GetEngine, without the extra execution contexts.
+  StatusOr<std::pair<EngineContext*, int>> FindOrBuildEngine(
+      const std::vector<TensorShape>& input_concrete_shapes,
+      OpKernelContext* ctx, TRTEngineCacheResource* cache_resource)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(engine_mutex_);
+
+  // Gives the engine num_execution_contexts_ sets of execution contexts, so
+  // that concurrent inference calls of the engine can run in parallel.
+  void AddReplicas(EngineContext* engine_context,
+                   TrtShapeOptimizationProfile* profiles)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(engine_mutex_);
+
   // Builds and returns a cuda engine for the input shapes. If building the
   // engine fails, enters a dummy entry into the cache_resource cache so we
   // don't continually try to build the same failing engine.
@@ -196,6 +209,36 @@ class TRTEngineOp : public AsyncOpKernel {
       bool use_calibration, TRTInt8Calibrator* calibrator,
       TRTEngineCacheResource* cache_resource, OpKernelContext* ctx);
 
+  // Converts the segment to a cuda engine for the input shapes and the
+  // optimization profiles on the device device_name. ctx is only needed to
+  // read resource inputs and may be null if the segment has none.
+  StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> ConvertSegmentToEngine(
+      const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
+      bool use_calibration, TRTInt8Calibrator* calibrator,
+      TRTEngineCacheResource* cache_resource,
+      TrtShapeOptimizationProfile* profiles, const string& device_name,
+      OpKernelContext* ctx);
+
+  // Returns whether an engine for new input shapes may be built in the
+  // background while the native segment serves the requests.
+  bool CanBuildEngineAsynchronously() const;
+
+  // Starts building an engine for the input shapes on engine_build_thread_,
+  // and adds it to the cache of cache_resource once it is ready.
+  void BuildEngineAsynchronously(
+      const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
+      TRTEngineCacheResource* cache_resource, const string& device_name)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(engine_mutex_);
+
+  // Records the input shapes of an explicit batch mode inference call. Every
+  // traffic_profile_interval_ calls, starts rebuilding the engine in the
+  // background with optimization profiles that follow the recorded shapes. The
+  // new engine replaces the cached one once it is ready.
+  void MaybeRebuildEngineFromTraffic(
+      const std::vector<TensorShape>& input_concrete_shapes,
+      TRTEngineCacheResource* cache_resource, const string& device_name)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(engine_mutex_);
+
   // Verify that the input shapes are consistent and can be handled by this op.
   Status VerifyInputShapes(const std::vector<TensorShape>& shapes);
 
@@ -276,6 +319,20 @@ class TRTEngineOp : public AsyncOpKernel {
 
   // Whether to use explicit precision (QDQ) mode.
   bool use_explicit_precision_;
+
+  // Number of inference calls after which the engine is rebuilt with profiles
+  // from the observed input shapes, 0 if disabled.
+  int64_t traffic_profile_interval_;
+
+  // Number of sets of execution contexts per engine, the number of inference
+  // calls of an engine that can be enqueued concurrently.
+  int64_t num_execution_contexts_;
+
+  // Runs the engine builds started by BuildEngineAsynchronously and
+  // MaybeRebuildEngineFromTraffic. Declared last so that it waits for the
+  // running builds before the other members go away.
+  std::unique_ptr<thread::ThreadPool> engine_build_thread_
+      TF_GUARDED_BY(engine_mutex_);
 };
 
 #define TYPECASE(dt, X)                                       \
@@ -491,6 +548,13 @@ TRTEngineOp::TRTEngineOp(OpKernelConstruction* context)
   }
   OP_REQUIRES_OK(context, context->GetAttr("max_cached_engines_count",
                                            &max_cached_engines_));
+  OP_REQUIRES_OK(context,
+                 ReadInt64FromEnvVar("TF_TRT_TRAFFIC_PROFILE_INTERVAL",
+                                     /*default_val=*/0,
+                                     &traffic_profile_interval_));
+  OP_REQUIRES_OK(context, ReadInt64FromEnvVar("TF_TRT_NUM_EXECUTION_CONTEXTS",
+                                              /*default_val=*/1,
+                                              &num_execution_contexts_));
 
   status = context->GetAttr("_use_implicit_batch", &use_implicit_batch_);
   if (status.code() == tensorflow::error::NOT_FOUND) {
@@ -811,6 +875,20 @@ static bool AllowEngineNativeSegmentExecution() {
   return value;
 }
 
+// Maximum number of optimization profiles of an engine rebuilt from the
+// observed traffic.
+constexpr int kMaxTrafficProfiles = 4;
+
+static bool BuildEnginesAsynchronously() {
+  bool value;
+  Status status = ReadBoolFromEnvVar("TF_TRT_BUILD_ENGINES_ASYNCHRONOUSLY",
+                                     /*default_val=*/false, &value);
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+  }
+  return value;
+}
+
 void TRTEngineOp::ComputeAsync(OpKernelContext* ctx,
                                AsyncOpKernel::DoneCallback done) {
   tensorflow::profiler::TraceMe activity(
@@ -1018,14 +1096,16 @@ Status TRTEngineOp::ExecuteTrtEngine(
 
   // nvinfer1::IExecutionContext::enqueue is not thread safe and we need a mutex
   // for it.
-  mutex_lock lock(engine_context->mu);
+  int replica;
+  mutex_lock lock = engine_context->LockReplica(&replica);
   nvinfer1::IExecutionContext* execution_context;
   bool has_device_memory;
   TF_RETURN_IF_ERROR(engine_context->GetExecutionContext(
-      trt_context_idx, &execution_context, &has_device_memory));
+      replica, trt_context_idx, &execution_context, &has_device_memory));
 
   if (VLOG_IS_ON(2)) {
-    VLOG(2) << "Selected execution context: " << trt_context_idx;
+    VLOG(2) << "Selected execution context: " << trt_context_idx
+            << " of replica " << replica;
   }
   const int num_batch =
       use_implicit_batch_ ? ctx->input(0).shape().dim_size(0) : 0;
@@ -1088,14 +1168,33 @@ StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
     const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
     bool use_calibration, TRTInt8Calibrator* calibrator,
     TRTEngineCacheResource* cache_resource, OpKernelContext* ctx) {
-  tensorflow::profiler::TraceMe activity(
-      "TRTEngineOp::BuildEngine", tensorflow::profiler::TraceMeLevel::kInfo);
   TRT_ENSURE(cache_resource);
   TRT_ENSURE(ctx);
+  auto result = ConvertSegmentToEngine(
+      input_concrete_shapes, batch_size, use_calibration, calibrator,
+      cache_resource, &cache_resource->profiles_, ctx->device()->name(), ctx);
+  if (!result.ok()) {
+    // Store an empty engine in the cache for these input shapes so we don't try
+    // to build the same failing engine again.
+    cache_resource->cache_.emplace(input_concrete_shapes,
+                                   std::make_unique<EngineContext>());
+  }
+  return result;
+}
+
+StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>>
+TRTEngineOp::ConvertSegmentToEngine(
+    const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
+    bool use_calibration, TRTInt8Calibrator* calibrator,
+    TRTEngineCacheResource* cache_resource,
+    TrtShapeOptimizationProfile* profiles, const string& device_name,
+    OpKernelContext* ctx) {
+  tensorflow::profiler::TraceMe activity(
+      "TRTEngineOp::BuildEngine", tensorflow::profiler::TraceMeLevel::kInfo);
   // Use concrete shapes for implicit batch mode and partial shapes for
   // explicit batch mode.
   bool use_concrete_shapes =
-      use_implicit_batch_ || cache_resource->profiles_.IsStaticCompatible();
+      use_implicit_batch_ || profiles->IsStaticCompatible();
   const std::vector<PartialTensorShape>& conversion_input_shapes =
       use_concrete_shapes
           ? std::vector<PartialTensorShape>(input_concrete_shapes.begin(),
@@ -1107,9 +1206,8 @@ StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
 
   std::unordered_map<string, tensorflow::DeviceProperties> device_map;
   DeviceNameUtils::ParsedName full_parsed_name;
-  DeviceNameUtils::ParseFullName(ctx->device()->name(), &full_parsed_name);
-  device_map.emplace(ctx->device()->name(),
-                     grappler::GetDeviceInfo(full_parsed_name));
+  DeviceNameUtils::ParseFullName(device_name, &full_parsed_name);
+  device_map.emplace(device_name, grappler::GetDeviceInfo(full_parsed_name));
   tensorflow::grappler::VirtualCluster cluster(device_map);
 
   TrtUniquePtrType<nvinfer1::ICudaEngine> engine;
@@ -1117,29 +1215,179 @@ StatusOr<TrtUniquePtrType<nvinfer1::ICudaEngine>> TRTEngineOp::BuildEngine(
       segment_graph_def_, ctx, precision_mode_, batch_size, workspace_size_,
       conversion_input_shapes, &logger, cache_resource->allocator_.get(),
       calibrator, &engine, use_calibration, use_implicit_batch_, nullptr,
-      &cache_resource->profiles_, name(), use_explicit_precision_, &cluster,
-      ctx->device()->name());
+      profiles, name(), use_explicit_precision_, &cluster, device_name);
   if (!status.ok()) {
     LOG_FIRST_FEW_WARNING_WITH_PREFIX
         << "Engine creation for " << name() << " failed. "
         << "The native segment will be used instead. "
         << "Reason: " << status;
-    // Store an empty engine in the cache for these input shapes so we don't try
-    // to build the same failing engine again.
-    cache_resource->cache_.emplace(input_concrete_shapes,
-                                   std::make_unique<EngineContext>());
     return status;
   }
   return engine;
 }
 
+bool TRTEngineOp::CanBuildEngineAsynchronously() const {
+  // Requests are served by the native segment until the engine is ready.
+  // Building without an OpKernelContext rules out resource inputs, and the
+  // optimization profiles of explicit batch mode are shared with the running
+  // requests, so only implicit batch engines are built in the background.
+  return BuildEnginesAsynchronously() && use_implicit_batch_ &&
+         !native_segment_absent_ && AllowEngineNativeSegmentExecution() &&
+         absl::c_all_of(input_mask_, [](bool is_input) { return is_input; });
+}
+
+void TRTEngineOp::BuildEngineAsynchronously(
+    const std::vector<TensorShape>& input_concrete_shapes, int batch_size,
+    TRTEngineCacheResource* cache_resource, const string& device_name) {
+  if (!cache_resource->StartEngineBuild(input_concrete_shapes)) return;
+  VLOG(1) << "Building the engine for " << name() << " in the background";
+  if (!engine_build_thread_) {
+    engine_build_thread_ = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "trt_engine_build", /*num_threads=*/1);
+  }
+  cache_resource->Ref();
+  engine_build_thread_->Schedule([this, input_concrete_shapes, batch_size,
+                                  cache_resource, device_name]() {
+    core::ScopedUnref unref_cache_resource(cache_resource);
+    auto result = ConvertSegmentToEngine(
+        input_concrete_shapes, batch_size, use_calibration_, calibrator_.get(),
+        cache_resource, &cache_resource->profiles_, device_name,
+        /*ctx=*/nullptr);
+    mutex_lock lock(engine_mutex_);
+    std::unique_ptr<EngineContext> engine_context;
+    if (result.ok()) {
+      TrtUniquePtrType<nvinfer1::ICudaEngine> engine =
+          std::move(result.value());
+      std::vector<ExecutionContext> exec_contexts;
+      Status status = cache_resource->profiles_.CreateExecutionContexts(
+          engine.get(), &exec_contexts);
+      if (status.ok()) {
+        engine_context = std::make_unique<EngineContext>(
+            std::move(engine), std::move(exec_contexts));
+      } else {
+        LOG_FIRST_FEW_WARNING_WITH_PREFIX
+            << "Failed to create execution contexts for " << name()
+            << ": " << status;
+      }
+    }
+    // As in BuildEngine, a failed build leaves an empty engine in the cache
+    // so we don't try to build it again.
+    if (!engine_context) engine_context = std::make_unique<EngineContext>();
+    cache_resource->cache_.emplace(input_concrete_shapes,
+                                   std::move(engine_context));
+    VLOG(1) << "Added new engine to cache of " << name()
+            << ". Cache size: " << cache_resource->cache_.size();
+    cache_resource->FinishEngineBuild(input_concrete_shapes);
+  });
+}
+
+void TRTEngineOp::MaybeRebuildEngineFromTraffic(
+    const std::vector<TensorShape>& input_concrete_shapes,
+    TRTEngineCacheResource* cache_resource, const string& device_name) {
+  // Explicit batch mode caches a single engine, the one to rebuild.
+  auto& cache = cache_resource->cache_;
+  if (cache.size() != 1 || !cache.begin()->second->GetCudaEngine()) return;
+  TrtShapeOptimizationProfile& profiles = cache_resource->profiles_;
+  profiles.RecordTrafficShapes(input_concrete_shapes);
+  if (profiles.NumTrafficSamples() < traffic_profile_interval_) return;
+  // The rebuild is tracked with an empty key since the cache key of explicit
+  // batch engines doesn't cover the shapes they handle.
+  const std::vector<TensorShape> rebuild_key;
+  if (!cache_resource->StartEngineBuild(rebuild_key)) return;
+
+  // Build with a copy of the profiles, as the current ones keep serving the
+  // requests until the new engine is ready.
+  auto new_profiles = std::make_shared<TrtShapeOptimizationProfile>(profiles);
+  bool changed = new_profiles->InitProfilesFromTraffic(input_partial_shapes_,
+                                                       kMaxTrafficProfiles);
+  profiles.ClearTraffic();
+  if (!changed) {
+    cache_resource->FinishEngineBuild(rebuild_key);
+    return;
+  }
+  VLOG(1) << "Rebuilding the engine for " << name()
+          << " with profiles from the observed traffic";
+  if (!engine_build_thread_) {
+    engine_build_thread_ = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "trt_engine_build", /*num_threads=*/1);
+  }
+  cache_resource->Ref();
+  engine_build_thread_->Schedule([this, input_concrete_shapes, cache_resource,
+                                  device_name, new_profiles,
+                                  rebuild_key]() {
+    core::ScopedUnref unref_cache_resource(cache_resource);
+    auto result = ConvertSegmentToEngine(
+        input_concrete_shapes, /*batch_size=*/1, use_calibration_,
+        calibrator_.get(), cache_resource, new_profiles.get(), device_name,
+        /*ctx=*/nullptr);
+    mutex_lock lock(engine_mutex_);
+    std::vector<ExecutionContext> exec_contexts;
+    Status status = result.status();
+    if (status.ok()) {
+      status = new_profiles->CreateExecutionContexts(result.value().get(),
+                                                     &exec_contexts);
+    }
+    auto& cache = cache_resource->cache_;
+    if (status.ok() && cache.size() == 1) {
+      // Requests may still be running the replaced engine, so keep it alive.
+      std::unique_ptr<EngineContext>& engine_context = cache.begin()->second;
+      cache_resource->retired_engine_contexts_.push_back(
+          std::move(engine_context));
+      engine_context = std::make_unique<EngineContext>(
+          std::move(result.value()), std::move(exec_contexts));
+      cache_resource->profiles_.UpdateProfiles(*new_profiles);
+      VLOG(1) << "Replaced the engine of " << name() << " with one built for "
+              << cache_resource->profiles_.GetNumProfiles() << " profiles";
+    } else if (!status.ok()) {
+      LOG_FIRST_FEW_WARNING_WITH_PREFIX
+          << "Rebuilding the engine for " << name()
+          << " failed, keeping the current one. Reason: " << status;
+    }
+    cache_resource->FinishEngineBuild(rebuild_key);
+  });
+}
+
+void TRTEngineOp::AddReplicas(EngineContext* engine_context,
+                              TrtShapeOptimizationProfile* profiles) {
+  // Engines are only executed after they were returned by GetEngine, so the
+  // replicas are added before any inference call uses the engine.
+  if (engine_context->replicas_added) return;
+  engine_context->replicas_added = true;
+  for (int i = 1; i < num_execution_contexts_; i++) {
+    std::vector<ExecutionContext> exec_contexts;
+    Status status = profiles->CreateExecutionContexts(
+        engine_context->GetCudaEngine(), &exec_contexts);
+    if (!status.ok()) {
+      LOG_FIRST_FEW_WARNING_WITH_PREFIX
+          << "Failed to create additional execution contexts for " << name()
+          << ": " << status;
+      return;
+    }
+    engine_context->AddReplica(std::move(exec_contexts));
+  }
+  VLOG(1) << "Using " << engine_context->GetNumReplicas()
+          << " sets of execution contexts for " << name();
+}
+
 StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
     const std::vector<TensorShape>& input_concrete_shapes, OpKernelContext* ctx,
     TRTEngineCacheResource* cache_res) {
   tensorflow::profiler::TraceMe activity(
       "TRTEngineOp::GetEngine", tensorflow::profiler::TraceMeLevel::kInfo);
-  static EngineContext empty_context;
   mutex_lock lock(engine_mutex_);
+  StatusOr<std::pair<EngineContext*, int>> result =
+      FindOrBuildEngine(input_concrete_shapes, ctx, cache_res);
+  if (num_execution_contexts_ > 1 && result.ok() &&
+      result.value().first->GetCudaEngine()) {
+    AddReplicas(result.value().first, &cache_res->profiles_);
+  }
+  return result;
+}
+
+StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::FindOrBuildEngine(
+    const std::vector<TensorShape>& input_concrete_shapes, OpKernelContext* ctx,
+    TRTEngineCacheResource* cache_res) {
+  static EngineContext empty_context;
   // Using first input to get batch size is reliable - VerifyInputShapes()
   // guarantees that the first input is not a scalar. As such we can always use
   // the first input to get the batch size for implicit batch mode. For explicit
@@ -1261,6 +1509,14 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
 
   int profile_id = -1;
   if (!use_implicit_batch_) {
+    // The background rebuild doesn't have the OpKernelContext needed to read
+    // resource inputs, and it only handles networks without shape tensors.
+    if (traffic_profile_interval_ > 0 && allow_build_at_runtime_ &&
+        !calibration_mode_ && !cache_res->profiles_.HasShapeTensor() &&
+        absl::c_all_of(input_mask_, [](bool is_input) { return is_input; })) {
+      MaybeRebuildEngineFromTraffic(input_concrete_shapes, cache_res,
+                                    ctx->device()->name());
+    }
     profile_id = cache_res->profiles_.GetProfileNumber(input_concrete_shapes);
     // Since all profiles are already created at this point, finding no
     // compatible profiles results in falling back to native TF.
@@ -1290,6 +1546,12 @@ StatusOr<std::pair<EngineContext*, int>> TRTEngineOp::GetEngine(
       return std::pair<EngineContext*, int>(&empty_context, 0);
     }
 
+    if (CanBuildEngineAsynchronously()) {
+      BuildEngineAsynchronously(input_concrete_shapes, batch_size, cache_res,
+                                ctx->device()->name());
+      return std::pair<EngineContext*, int>(&empty_context, 0);
+    }
+
     // Up to this point, calibrator_ can never be empty, since otherwise it
     // means calibration_mode_ is true and this path won't get executed.
     auto result =
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <cstdlib>
 #include <memory>
 #include <numeric>
 #include <utility>
@@ -283,6 +284,35 @@ TEST_F(TRTEngineOpTestBase, AllowBuildAtRuntime) {
   EXPECT_EQ(ectx->GetCudaEngine(), nullptr);
 }
 
+TEST_F(TRTEngineOpTestBase, BuildEnginesAsynchronously) {
+  setenv("TF_TRT_BUILD_ENGINES_ASYNCHRONOUSLY", "1", /*overwrite=*/1);
+  TRTEngineOpTestBase::AddSimpleTrtOp(DT_FLOAT, /*max_cached_engines_count=*/4);
+
+  // The first execution runs the native segment while the engine is built.
+  TensorShape input_shape({2, 2});
+  TRTEngineOpTestBase::AddSimpleInput<float>(input_shape);
+  TF_ASSERT_OK(OpsTestBase::RunOpKernel());
+
+  // Get the engine cache.
+  TRTEngineCacheResource* cache_resource = nullptr;
+  TF_ASSERT_OK(device_->resource_manager()->Lookup(
+      std::string(kTfTrtContainerName), std::string(kOpName), &cache_resource));
+  core::ScopedUnref sc(cache_resource);
+
+  // Once the build finishes the engine is in the cache and used from then on.
+  cache_resource->WaitForEngineBuilds();
+  auto cache = &cache_resource->cache_;
+  EXPECT_EQ(1, cache->size());
+  ASSERT_EQ(1, cache->count({input_shape}));
+  EXPECT_NE(cache->at({input_shape})->GetCudaEngine(), nullptr);
+
+  ResetInputs();
+  TRTEngineOpTestBase::AddSimpleInput<float>(TensorShape({1, 2}));
+  TF_ASSERT_OK(OpsTestBase::RunOpKernel());
+  EXPECT_EQ(1, cache->size());
+  unsetenv("TF_TRT_BUILD_ENGINES_ASYNCHRONOUSLY");
+}
+
 TEST_P(TRTEngineOpTestWithParam, ExplicitBatch) {
   // Test inference in explicit batch mode with static input shapes. Static
   // shapes in this context means that the TensorRT knows all the input shapes
@@ -216,6 +216,9 @@ class SerializeTRTResource : public OpKernel {
     // Terminate the calibration if any.
     if (resource->calib_ctx_) resource->calib_ctx_->TerminateCalibration();
 
+    // Wait for the engines being built in the background so they get saved.
+    resource->WaitForEngineBuilds();
+
     // Serialize the engines and write them to file.
     std::unique_ptr<WritableFile> file;
     OP_REQUIRES_OK(ctx, ctx->env()->NewWritableFile(filename, &file));
@@ -119,6 +119,26 @@ EngineContext* TRTEngineCacheResource::GetEngineContext(
   return engine_context;
 }
 
+bool TRTEngineCacheResource::StartEngineBuild(
+    const std::vector<TensorShape>& input_shapes) {
+  mutex_lock lock(engine_builds_mu_);
+  return pending_engine_builds_.insert(input_shapes).second;
+}
+
+void TRTEngineCacheResource::FinishEngineBuild(
+    const std::vector<TensorShape>& input_shapes) {
+  mutex_lock lock(engine_builds_mu_);
+  pending_engine_builds_.erase(input_shapes);
+  engine_builds_cv_.notify_all();
+}
+
+void TRTEngineCacheResource::WaitForEngineBuilds() {
+  mutex_lock lock(engine_builds_mu_);
+  while (!pending_engine_builds_.empty()) {
+    engine_builds_cv_.wait(lock);
+  }
+}
+
 EngineContext* TRTEngineCacheResource::GetEngineContext(const int profile_id) {
   if (profiles_.NeedProfiles() && profile_id >= profiles_.GetNumProfiles()) {
     LOG(ERROR) << "Out of range: profile_id " << profile_id
@@ -16,9 +16,12 @@ limitations under the License.
 #ifndef TENSORFLOW_COMPILER_TF2TENSORRT_UTILS_TRT_LRU_CACHE_H_
 #define TENSORFLOW_COMPILER_TF2TENSORRT_UTILS_TRT_LRU_CACHE_H_
 
+#include <atomic>
 #include <list>
+#include <memory>
 #include <thread>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "tensorflow/compiler/tf2tensorrt/convert/utils.h"
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_allocator.h"
@@ -152,11 +155,63 @@ struct EngineContext {
     return OkStatus();
   }
 
+  // Returns context idx of the given replica of the execution contexts. The
+  // caller must hold the lock returned by LockReplica for that replica.
+  Status GetExecutionContext(int replica, int idx,
+                             nvinfer1::IExecutionContext** exec_ctx,
+                             bool* has_device_memory)
+      TF_NO_THREAD_SAFETY_ANALYSIS {
+    if (replica == 0) {
+      return GetExecutionContext(idx, exec_ctx, has_device_memory);
+    }
+    std::vector<ExecutionContext>& contexts =
+        replicas_.at(replica - 1)->execution_contexts;
+    if (idx >= contexts.size()) {
+      return errors::Internal("Requested engine context with index ", idx,
+                              ", but only ", contexts.size(),
+                              "contexts are present.");
+    }
+    *exec_ctx = contexts[idx].get();
+    *has_device_memory = contexts[idx].HasDeviceMemory();
+    return OkStatus();
+  }
+
   int GetNumContexts() {
     mutex_lock lock(mu);
     return execution_contexts.size();
   }
 
+  // Adds another set of execution contexts with one context per profile, like
+  // execution_contexts. Must be called before the engine is first executed.
+  void AddReplica(std::vector<ExecutionContext>&& contexts) {
+    replicas_.push_back(std::make_unique<Replica>());
+    replicas_.back()->execution_contexts = std::move(contexts);
+  }
+
+  // Returns the number of sets of execution contexts, including
+  // execution_contexts.
+  int GetNumReplicas() const { return 1 + replicas_.size(); }
+
+  // Locks a set of execution contexts for an inference call and stores its
+  // index in replica. Prefers a set that no other inference call is using, so
+  // that concurrent calls don't wait for each other to enqueue their work.
+  mutex_lock LockReplica(int* replica) TF_NO_THREAD_SAFETY_ANALYSIS {
+    const int num_replicas = GetNumReplicas();
+    for (int i = 0; i < num_replicas; i++) {
+      mutex_lock lock(ReplicaMutex(i), std::try_to_lock);
+      if (lock) {
+        *replica = i;
+        return lock;
+      }
+    }
+    // All sets are busy, spread the waiting calls over them.
+    *replica = next_replica_.fetch_add(1) % num_replicas;
+    return mutex_lock{ReplicaMutex(*replica)};
+  }
+
+  // Whether the replicas were added, see TRTEngineOp::AddReplicas.
+  bool replicas_added = false;
+
   size_t GetDeviceMemorySize() { return device_memory_size_; }
 
  private:
@@ -184,6 +239,21 @@ struct EngineContext {
   // Until TRT 8.4 ICudaEngine::getDeviceMemorySize() has a non-negligible
   // latency. Since its value remains constant, we can cache it.
   size_t device_memory_size_;
+
+  struct Replica {
+    mutex mu;
+    std::vector<ExecutionContext> execution_contexts TF_GUARDED_BY(mu);
+  };
+
+  mutex& ReplicaMutex(int replica) {
+    return replica == 0 ? mu : replicas_[replica - 1]->mu;
+  }
+
+  // Additional sets of execution contexts. Like execution_contexts they only
+  // hold device memory during an inference call, which is allocated through
+  // the TRTDeviceAllocator of the cache.
+  std::vector<std::unique_ptr<Replica>> replicas_;
+  std::atomic<int> next_replica_{0};
 };
 // Contains the context required to build the calibration data.
 class CalibrationContext {
@@ -235,6 +305,17 @@ class TRTEngineCacheResource : public ResourceBase {
   // Returns nullptr if no compatible EngineContexts is found in cache.
   EngineContext* GetEngineContext(const int profile_id);
 
+  // Records that an engine for input_shapes is being built in the background.
+  // Returns false if such a build is already in progress.
+  bool StartEngineBuild(const std::vector<TensorShape>& input_shapes);
+
+  // Records that the background build for input_shapes has finished and its
+  // result was entered into cache_.
+  void FinishEngineBuild(const std::vector<TensorShape>& input_shapes);
+
+  // Blocks until all background engine builds have finished.
+  void WaitForEngineBuilds();
+
   // Keep device allocator for TRT.
   std::unique_ptr<TRTBaseAllocator> allocator_;
 
@@ -251,6 +332,17 @@ class TRTEngineCacheResource : public ResourceBase {
   // generation and engine build. During runtime the list of profiles is used to
   // look up a matching profile for the input data.
   TrtShapeOptimizationProfile profiles_;
+
+  // Engines replaced by ones rebuilt with new optimization profiles. They are
+  // kept alive because requests may still be executing them.
+  std::vector<std::unique_ptr<EngineContext>> retired_engine_contexts_;
+
+ private:
+  mutex engine_builds_mu_;
+  condition_variable engine_builds_cv_;
+  // Input shapes of the engines being built in the background.
+  std::unordered_set<std::vector<TensorShape>, VectorTensorShapeHasher>
+      pending_engine_builds_ TF_GUARDED_BY(engine_builds_mu_);
 };
 
 #endif  // GOOGLE_CUDA && GOOGLE_TENSORRT
@@ -53,5 +53,26 @@ TEST(LRUCacheTest, Basic) {
   EXPECT_EQ(cache.count(40), 1);
 }
 
+#if GOOGLE_CUDA && GOOGLE_TENSORRT
+TEST(EngineContextTest, LockReplica) {
+  EngineContext engine_context;
+  engine_context.AddReplica({});
+  EXPECT_EQ(engine_context.GetNumReplicas(), 2);
+
+  int replica = -1;
+  {
+    mutex_lock lock = engine_context.LockReplica(&replica);
+    EXPECT_EQ(replica, 0);
+    // The first set is busy, so a concurrent call gets the second one.
+    int other_replica = -1;
+    mutex_lock other_lock = engine_context.LockReplica(&other_replica);
+    EXPECT_EQ(other_replica, 1);
+  }
+  // Both sets are free again.
+  mutex_lock lock = engine_context.LockReplica(&replica);
+  EXPECT_EQ(replica, 0);
+}
+#endif  // GOOGLE_CUDA && GOOGLE_TENSORRT
+
 }  // namespace tensorrt
 }  // namespace tensorflow
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/compiler/tf2tensorrt/utils/trt_shape_optimization_profiles.h"
 
 #include <algorithm>
+#include <cstdlib>
 #include <functional>
 
 #include "absl/algorithm/container.h"
@@ -481,6 +482,92 @@ void TrtShapeOptimizationProfile::SetShapeTensorMask(
       absl::c_any_of(is_shape_tensor_, [](bool b) { return b; });
 }
 
+// Returns the L1 distance between two shape vectors, or -1 if they have
+// different ranks and can't share a profile.
+int64_t ShapeDistance(const std::vector<nvinfer1::Dims>& x,
+                      const std::vector<nvinfer1::Dims>& y) {
+  if (x.size() != y.size()) return -1;
+  int64_t distance = 0;
+  for (int i = 0; i < x.size(); i++) {
+    if (x[i].nbDims != y[i].nbDims) return -1;
+    for (int j = 0; j < x[i].nbDims; j++) {
+      distance += std::abs(x[i].d[j] - y[i].d[j]);
+    }
+  }
+  return distance;
+}
+
+bool TrtShapeOptimizationProfile::InitProfilesFromTraffic(
+    const std::vector<PartialTensorShape>& input_partial_shapes,
+    int max_profiles) {
+  if (traffic_histogram_.empty() || HasShapeTensor()) return false;
+  std::vector<std::pair<std::vector<TensorShape>, int64_t>> traffic(
+      traffic_histogram_.begin(), traffic_histogram_.end());
+  std::stable_sort(traffic.begin(), traffic.end(),
+                   [](const auto& a, const auto& b) {
+                     return a.second > b.second;
+                   });
+
+  // The most frequent shapes become the optima of the profiles, the other
+  // shapes widen the range of the closest one. Shapes that can't share a
+  // profile with any of them are left to the native segment.
+  std::vector<OptimizationProfileConfig> profiles;
+  for (const auto& entry : traffic) {
+    std::vector<nvinfer1::Dims> dimvec = GetDimVec(entry.first);
+    if (profiles.size() < max_profiles) {
+      profiles.push_back(OptimizationProfileConfig{dimvec, dimvec, dimvec});
+      continue;
+    }
+    int closest = -1;
+    int64_t closest_distance = 0;
+    for (int i = 0; i < profiles.size(); i++) {
+      int64_t distance = ShapeDistance(profiles[i].opt, dimvec);
+      if (distance >= 0 && (closest == -1 || distance < closest_distance)) {
+        closest = i;
+        closest_distance = distance;
+      }
+    }
+    if (closest == -1) continue;
+    TF_CHECK_OK(
+        ShapeProfileBinaryOp(&profiles[closest].min, dimvec,
+                             [](int a, int b) { return std::min(a, b); }));
+    TF_CHECK_OK(
+        ShapeProfileBinaryOp(&profiles[closest].max, dimvec,
+                             [](int a, int b) { return std::max(a, b); }));
+  }
+  const int n_inputs = traffic.front().first.size();
+  for (OptimizationProfileConfig& prof : profiles) {
+    // There are no shape tensors, so the shape values are empty.
+    for (auto* dims : {&prof.min, &prof.opt, &prof.max}) {
+      dims->resize(2 * n_inputs, nvinfer1::Dims{0, {}});
+    }
+    for (int i = 0; i < input_partial_shapes.size(); i++) {
+      EnforceCompatibility(&prof.min[i], input_partial_shapes[i]);
+      EnforceCompatibility(&prof.opt[i], input_partial_shapes[i]);
+      EnforceCompatibility(&prof.max[i], input_partial_shapes[i]);
+    }
+    VLOG(2) << "Initializing optimization profile config from traffic with "
+            << prof.DebugString();
+  }
+
+  auto same_profile = [](const OptimizationProfileConfig& a,
+                         const OptimizationProfileConfig& b) {
+    return ShapeDistance(a.min, b.min) == 0 &&
+           ShapeDistance(a.opt, b.opt) == 0 && ShapeDistance(a.max, b.max) == 0;
+  };
+  if (profiles.size() == profiles_.size() &&
+      std::equal(profiles.begin(), profiles.end(), profiles_.begin(),
+                 same_profile)) {
+    return false;
+  }
+  VLOG(1) << "Creating " << profiles.size() << " profiles from "
+          << num_traffic_samples_ << " recorded inference calls";
+  profiles_ = std::move(profiles);
+  // Like kRangeOptimal, the profiles are ranges optimized for a seen shape.
+  strategy_ = ProfileStrategy::kRangeOptimal;
+  return true;
+}
+
 int TrtShapeOptimizationProfile::GetProfileNumber(
     const std::vector<TensorShape>& shapes) {
   tensorflow::profiler::TraceMe activity(
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <list>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -254,6 +255,38 @@ class TrtShapeOptimizationProfile {
 
   void InitCalibProfile(const std::vector<TensorShape>& shapes);
 
+  // Records the input shapes of an inference call, used to create profiles
+  // that follow the observed traffic (see InitProfilesFromTraffic).
+  void RecordTrafficShapes(const std::vector<TensorShape>& shapes) {
+    traffic_histogram_[shapes]++;
+    num_traffic_samples_++;
+  }
+
+  // Returns the number of inference calls recorded since the last ClearTraffic.
+  int64_t NumTrafficSamples() const { return num_traffic_samples_; }
+
+  void ClearTraffic() {
+    traffic_histogram_.clear();
+    num_traffic_samples_ = 0;
+  }
+
+  // Replaces profiles_ with at most max_profiles profiles clustered around the
+  // most frequent recorded input shapes. Each of those shapes is the opt value
+  // of a profile whose [min, max] range is widened to include the less
+  // frequent shapes that are closest to it. Only supported for networks
+  // without shape tensors. Returns whether the profiles changed.
+  bool InitProfilesFromTraffic(
+      const std::vector<PartialTensorShape>& input_partial_shapes,
+      int max_profiles);
+
+  // Takes over the profiles of other, which were used to build the engine that
+  // replaces the current one.
+  void UpdateProfiles(const TrtShapeOptimizationProfile& other) {
+    profiles_ = other.profiles_;
+    need_profiles_ = other.need_profiles_;
+    strategy_ = other.strategy_;
+  }
+
   // Returns number of created profiles.
   int GetNumProfiles() const;
 
@@ -324,6 +357,13 @@ class TrtShapeOptimizationProfile {
   // Optimization profile generation strategy.
   ProfileStrategy strategy_;
 
+  // Number of inference calls per input shapes, recorded for
+  // InitProfilesFromTraffic.
+  std::unordered_map<std::vector<TensorShape>, int64_t,
+                     VectorTensorShapeHasher>
+      traffic_histogram_;
+  int64_t num_traffic_samples_ = 0;
+
   // Adds optimization profiles to the builder config.
   Status AddProfiles(nvinfer1::IBuilder* builder,
                      nvinfer1::IBuilderConfig* config,
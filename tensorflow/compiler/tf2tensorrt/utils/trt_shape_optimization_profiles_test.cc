@@ -250,6 +250,60 @@ TEST_P(TrtShapeOptimizationProfileTest, Dynamic) {
   CheckProfile(unseen_shapes, &profile, has_prof, false);
 }
 
+TEST_P(TrtShapeOptimizationProfileTest, FromTraffic) {
+  // Profiles from traffic do not depend on strategies, we test only once.
+  if (strategy_ != ProfileStrategy::kRange) return;
+
+  nvinfer1::Dims3 dims(-1, -1, 10);
+  DefineNetwork(network_.get(), dims);
+
+  TrtShapeOptimizationProfile profile;
+  profile.SetInputMask(std::vector<bool>(2, true));
+  profile.SetShapeTensorMask(network_.get());
+
+  // Two frequent shapes and a few rare ones close to the second.
+  auto record = [&profile](nvinfer1::Dims3 dims, int count) {
+    std::vector<nvinfer1::Dims3> dim_vec(2, dims);
+    for (int i = 0; i < count; i++) {
+      profile.RecordTrafficShapes(DimVecToShapeVec(dim_vec));
+    }
+  };
+  record(nvinfer1::Dims3(2, 2, 10), 10);
+  record(nvinfer1::Dims3(16, 16, 10), 8);
+  record(nvinfer1::Dims3(12, 12, 10), 1);
+  record(nvinfer1::Dims3(20, 20, 10), 1);
+  EXPECT_EQ(20, profile.NumTrafficSamples());
+
+  std::vector<PartialTensorShape> input_partial_shapes;
+  TF_CHECK_OK(GetNetworkInputShapes(network_.get(), &input_partial_shapes));
+  EXPECT_TRUE(profile.InitProfilesFromTraffic(input_partial_shapes,
+                                              /*max_profiles=*/2));
+  EXPECT_EQ(2, profile.GetNumProfiles());
+  // The same traffic yields the same profiles.
+  EXPECT_FALSE(profile.InitProfilesFromTraffic(input_partial_shapes,
+                                               /*max_profiles=*/2));
+  profile.ClearTraffic();
+  EXPECT_EQ(0, profile.NumTrafficSamples());
+
+  TF_CHECK_OK(profile.ConfigureBuilder(builder_.get(), builder_config_.get(),
+                                       network_.get()));
+  engine = TrtUniquePtrType<nvinfer1::ICudaEngine>(
+      builder_->buildEngineWithConfig(*network_.get(), *builder_config_.get()));
+  ASSERT_NE(nullptr, engine);
+  TF_CHECK_OK(profile.CreateExecutionContexts(engine.get(), &exec_contexts_));
+  EXPECT_EQ(exec_contexts_.size(), 2);
+
+  // The frequent shapes are optimal, the rare ones are covered by a range.
+  CheckProfile({nvinfer1::Dims3(2, 2, 10), nvinfer1::Dims3(2, 2, 10)},
+               &profile, true, true);
+  CheckProfile({nvinfer1::Dims3(16, 16, 10), nvinfer1::Dims3(16, 16, 10)},
+               &profile, true, true);
+  CheckProfile({nvinfer1::Dims3(14, 14, 10), nvinfer1::Dims3(14, 14, 10)},
+               &profile, true, false);
+  CheckProfile({nvinfer1::Dims3(30, 30, 10), nvinfer1::Dims3(30, 30, 10)},
+               &profile, false, false);
+}
+
 }  // namespace tensorrt
 }  // namespace tensorflow
 
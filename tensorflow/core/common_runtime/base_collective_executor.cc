@@ -17,7 +17,9 @@ limitations under the License.
 #include <algorithm>
 #include <functional>
 #include <utility>
+#include <vector>
 
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
 #include "tensorflow/core/common_runtime/copy_tensor.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
@@ -49,6 +51,35 @@ bool IsCancelled(CancellationManager* cancel_mgr) {
   return cancel_mgr != nullptr &&
          (cancel_mgr->IsCancelled() || cancel_mgr->IsCancelling());
 }
+
+string OpType(const OpKernel* op) {
+  return op == nullptr ? "" : op->type_string();
+}
+
+// Returns a tensor with `shape` which aliases `buffer` from element `offset`.
+Tensor BufferAlias(const Tensor& buffer, int64_t offset,
+                   const TensorShape& shape) {
+  Tensor alias;
+  CHECK(alias.CopyFrom(buffer.Slice(offset, offset + shape.num_elements()),
+                       shape));
+  return alias;
+}
+
+// Copies `src` to `dst` on the device of `ctx` and waits for the copy.
+absl::Status CopyTensorSync(OpKernelContext* ctx, Device* device,
+                            const Tensor* src, Tensor* dst) {
+  Notification note;
+  absl::Status status;
+  CollectiveRemoteAccessLocal::MemCpyAsync(
+      ctx->op_device_context(), ctx->op_device_context(), device, device,
+      ctx->output_alloc_attr(0), ctx->output_alloc_attr(0), src, dst,
+      0 /*dev_to_dev_stream_index*/, [&note, &status](const absl::Status& s) {
+        status.Update(s);
+        note.Notify();
+      });
+  note.WaitForNotification();
+  return status;
+}
 }  // namespace
 
 /*static*/
@@ -246,6 +277,16 @@ void BaseCollectiveExecutor::StartAbort(const absl::Status& s) {
     status = status_;
   }
   LOG(ERROR) << "BaseCollectiveExecutor::StartAbort " << s;
+  std::unordered_map<string, std::vector<BucketMember>> buckets;
+  {
+    mutex_lock l(bucket_mu_);
+    buckets.swap(buckets_);
+  }
+  for (auto& bucket : buckets) {
+    for (BucketMember& member : bucket.second) {
+      member.done(status);
+    }
+  }
   cem_->GetParamResolver()->StartAbort(status);
   remote_access_->StartAbort(status);
   if (cem_->GetNcclCommunicator() != nullptr) {
@@ -302,6 +343,12 @@ void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
         });
   }
 
+  if (col_params->instance.type == REDUCTION_COLLECTIVE &&
+      col_params->instance.impl_details.bucket_size > 1) {
+    AddToBucket(ctx, col_params, exec_key, std::move(done_safe));
+    return;
+  }
+
   Tensor* output = ctx->mutable_output(0);
   const Tensor* input =
       (col_params->instance.type == REDUCTION_COLLECTIVE ||
@@ -313,10 +360,18 @@ void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
         col_params->is_source))
           ? &ctx->input(0)
           : nullptr;
+  ExecuteCollective(ctx, col_params, exec_key, input, output,
+                    std::move(done_safe));
+}
+
+void BaseCollectiveExecutor::ExecuteCollective(
+    OpKernelContext* ctx, const CollectiveParams* col_params,
+    const string& exec_key, const Tensor* input, Tensor* output,
+    StatusCallback done) {
   CollectiveImplementationInterface* col_impl = nullptr;
   absl::Status status = CreateCollective(*col_params, &col_impl);
   if (!status.ok()) {
-    done_safe(status);
+    done(status);
     DCHECK_EQ(nullptr, col_impl);
     return;
   }
@@ -326,7 +381,7 @@ void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
       col_params, exec_key, step_id_, input, output);
   status = col_impl->InitializeCollectiveContext(col_ctx);
   if (!status.ok()) {
-    done_safe(status);
+    done(status);
     return;
   }
   // Run on an unbounded work queue that can handle blocking work so as to not
@@ -334,7 +389,7 @@ void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
   col_impl->Ref();
   tsl::profiler::TraceMeProducer producer(
       "BaseCollectiveExecutor::ExecuteAsync");
-  RunClosure([col_impl, col_ctx, done_safe, ctx,
+  RunClosure([col_impl, col_ctx, done = std::move(done), ctx,
               context_id = producer.GetContextId()]() {
     core::ScopedUnref unref(col_impl);
     tsl::profiler::TraceMeConsumer consumer(
@@ -353,13 +408,175 @@ void BaseCollectiveExecutor::ExecuteAsync(OpKernelContext* ctx,
         },
         context_id);
     col_impl->Ref();
-    col_impl->Run([col_impl, col_ctx, done_safe](const absl::Status& s) {
+    col_impl->Run([col_impl, col_ctx, done](const absl::Status& s) {
       core::ScopedUnref unref(col_impl);
-      done_safe(s);
+      done(s);
     });
   });
 }
 
+void BaseCollectiveExecutor::AddToBucket(OpKernelContext* ctx,
+                                         const CollectiveParams* col_params,
+                                         const string& exec_key,
+                                         StatusCallback done) {
+  const CollImplDetails& impl_details = col_params->instance.impl_details;
+  // Each iteration of a loop fills its own buckets.
+  const string bucket = strings::StrCat(
+      ctx->device()->name(), ":", col_params->group.group_key, ":",
+      impl_details.bucket_key, ":", ctx->frame_iter().frame_id, ":",
+      ctx->frame_iter().iter_id);
+  std::vector<BucketMember> members;
+  absl::Status status;
+  {
+    mutex_lock l(bucket_mu_);
+    {
+      // StartAbort fails the pending buckets after setting status_, so a
+      // reduction which is added once status_ is set would never run.
+      mutex_lock status_lock(status_mu_);
+      status = status_;
+    }
+    if (status.ok()) {
+      std::vector<BucketMember>& pending = buckets_[bucket];
+      pending.push_back({ctx, col_params, exec_key, std::move(done)});
+      VLOG(1) << "Collective " << col_params->name << " added to bucket "
+              << bucket << " (" << pending.size() << " of "
+              << impl_details.bucket_size << ")";
+      if (pending.size() < static_cast<size_t>(impl_details.bucket_size)) {
+        return;
+      }
+      members = std::move(pending);
+      buckets_.erase(bucket);
+    }
+  }
+  if (!status.ok()) {
+    done(status);
+    return;
+  }
+  RunClosure([this, members = std::move(members)]() mutable {
+    RunBucket(std::move(members));
+  });
+}
+
+void BaseCollectiveExecutor::RunBucket(std::vector<BucketMember> members) {
+  // Every participant packs the bucket in the same order.
+  std::sort(members.begin(), members.end(),
+            [](const BucketMember& a, const BucketMember& b) {
+              return a.col_params->instance.instance_key <
+                     b.col_params->instance.instance_key;
+            });
+  auto done_all = [members](const absl::Status& s) {
+    for (const BucketMember& member : members) {
+      member.done(s);
+    }
+  };
+  const CollectiveParams& first = *members[0].col_params;
+  OpKernelContext* ctx = members[0].ctx;
+  const DataType dtype = first.instance.data_type;
+  for (const BucketMember& member : members) {
+    const CollectiveParams& col_params = *member.col_params;
+    if (col_params.instance.data_type != dtype ||
+        col_params.instance.impl_details.bucket_size !=
+            first.instance.impl_details.bucket_size ||
+        col_params.instance.impl_details.collective_name !=
+            first.instance.impl_details.collective_name ||
+        col_params.instance.impl_details.wire_dtype !=
+            first.instance.impl_details.wire_dtype ||
+        col_params.group.group_size != first.group.group_size ||
+        col_params.default_rank != first.default_rank ||
+        OpType(col_params.merge_op) != OpType(first.merge_op) ||
+        OpType(col_params.final_op) != OpType(first.final_op)) {
+      done_all(errors::InvalidArgument(
+          "Collective reductions ", first.name, " and ", col_params.name,
+          " cannot share bucket ", first.instance.impl_details.bucket_key,
+          " of group ", first.group.group_key));
+      return;
+    }
+  }
+  Device* device = nullptr;
+  absl::Status status = dev_mgr_->LookupDevice(ctx->device()->name(), &device);
+  if (!status.ok()) {
+    done_all(status);
+    return;
+  }
+
+  // Start each input on an alignment boundary so that its alias in the
+  // buffer is aligned.
+  const int64_t align_elts =
+      EIGEN_MAX_ALIGN_BYTES == 0
+          ? 1
+          : std::max<int64_t>(1, EIGEN_MAX_ALIGN_BYTES / DataTypeSize(dtype));
+  std::vector<int64_t> offsets;
+  offsets.reserve(members.size());
+  int64_t num_elements = 0;
+  for (const BucketMember& member : members) {
+    offsets.push_back(num_elements);
+    const int64_t n = member.ctx->input(0).NumElements();
+    num_elements += (n + align_elts - 1) / align_elts * align_elts;
+  }
+  Tensor buffer;
+  status = ctx->allocate_temp(dtype, TensorShape({num_elements}), &buffer,
+                              ctx->output_alloc_attr(0));
+  if (!status.ok()) {
+    done_all(status);
+    return;
+  }
+  for (int i = 0; i < members.size() && status.ok(); ++i) {
+    const Tensor& input = members[i].ctx->input(0);
+    if (input.NumElements() == 0) continue;
+    Tensor alias = BufferAlias(buffer, offsets[i], input.shape());
+    status = CopyTensorSync(ctx, device, &input, &alias);
+  }
+  if (!status.ok()) {
+    done_all(status);
+    return;
+  }
+
+  // The bucket is reduced as the reduction with the lowest instance key.
+  CollectiveParams* fused = new CollectiveParams();
+  fused->group = first.group;
+  fused->instance = first.instance;
+  fused->instance.step_id = first.instance.step_id;
+  fused->instance.impl_details = first.instance.impl_details;
+  fused->instance.shape = TensorShape({num_elements});
+  fused->name = strings::StrCat(first.name, " (bucket of ", members.size(),
+                                " reductions)");
+  fused->default_rank = first.default_rank;
+  fused->subdiv_rank = first.subdiv_rank;
+  fused->merge_op = first.merge_op;
+  fused->final_op = first.final_op;
+  fused->run_group_initialization = first.run_group_initialization;
+  fused->is_stateless = first.is_stateless;
+  // The other reductions are considered launched with the bucket.
+  for (int i = 1; i < members.size(); ++i) {
+    UnblockDependencies(*members[i].col_params);
+  }
+  VLOG(1) << "Running " << fused->name << " with " << num_elements
+          << " elements";
+  ExecuteCollective(
+      ctx, fused, members[0].exec_key, &buffer, &buffer,
+      [this, members, done_all, offsets, buffer, fused,
+       device](const absl::Status& s) {
+        fused->Unref();
+        if (!s.ok()) {
+          done_all(s);
+          return;
+        }
+        // The copies block, so they must not run on the thread completing
+        // the collective.
+        RunClosure([members, done_all, offsets, buffer, device]() {
+          absl::Status status;
+          for (int i = 0; i < members.size() && status.ok(); ++i) {
+            Tensor* output = members[i].ctx->mutable_output(0);
+            if (output->NumElements() == 0) continue;
+            const Tensor alias =
+                BufferAlias(buffer, offsets[i], output->shape());
+            status = CopyTensorSync(members[i].ctx, device, &alias, output);
+          }
+          done_all(status);
+        });
+      });
+}
+
 void BaseCollectiveExecutor::CompleteParamsAsync(
     const DeviceAttributes& device, CollectiveParams* cp,
     CancellationManager* cancel_mgr, StatusCallback done) {
@@ -17,6 +17,8 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "tensorflow/core/common_runtime/buf_rendezvous.h"
 #include "tensorflow/core/framework/collective.h"
@@ -150,14 +152,41 @@ class BaseCollectiveExecutor : public CollectiveExecutor {
   absl::Status status_ TF_GUARDED_BY(status_mu_);
 
  private:
+  // A reduction which waits for the other reductions in its bucket (see
+  // CollImplDetails::bucket_size).
+  struct BucketMember {
+    OpKernelContext* ctx;
+    const CollectiveParams* col_params;
+    string exec_key;
+    StatusCallback done;
+  };
+
   absl::Status CreateCollective(const CollectiveParams& col_params,
                                 CollectiveImplementationInterface** col_impl);
+  // Runs the collective for `col_params` from `input` to `output` on the work
+  // queue.
+  void ExecuteCollective(OpKernelContext* ctx,
+                         const CollectiveParams* col_params,
+                         const string& exec_key, const Tensor* input,
+                         Tensor* output, StatusCallback done);
+  // Adds a reduction to its bucket, and runs the bucket once it is full.
+  void AddToBucket(OpKernelContext* ctx, const CollectiveParams* col_params,
+                   const string& exec_key, StatusCallback done)
+      TF_LOCKS_EXCLUDED(bucket_mu_, status_mu_);
+  // Runs the reductions in `members` as a single reduction of a flat buffer
+  // holding all their inputs, then copies the results to their outputs.
+  void RunBucket(std::vector<BucketMember> members);
   // Check if all ops on which this collective depends on have launched.
   bool CheckDependencies(const CollectiveParams& col_params)
       TF_EXCLUSIVE_LOCKS_REQUIRED(launch_mu_);
   // Tries to return the status that is the original error. It returns the
   // aborted status if the collective executor is aborted.
   absl::Status GetStatus(const absl::Status& s) TF_LOCKS_EXCLUDED(status_mu_);
+
+  mutex bucket_mu_;
+  // Bucket -> reductions which wait for the rest of the bucket to be issued.
+  std::unordered_map<string, std::vector<BucketMember>> buckets_
+      TF_GUARDED_BY(bucket_mu_);
 };
 
 }  // namespace tensorflow
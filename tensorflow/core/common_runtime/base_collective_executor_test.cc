@@ -0,0 +1,184 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_test_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/framework/cancellation.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+std::unique_ptr<OpKernel> GetKernel(const string& op, DataType dtype,
+                                    Device* device) {
+  NodeDef node_def;
+  TF_CHECK_OK(NodeDefBuilder(strings::StrCat(op, "_node"), op)
+                  .Attr("T", dtype)
+                  .Input(FakeInput(dtype))
+                  .Input(FakeInput(dtype))
+                  .Finalize(&node_def));
+  absl::Status status;
+  std::unique_ptr<OpKernel> k = CreateOpKernel(
+      DEVICE_CPU, device, device->GetAllocator(AllocatorAttributes()),
+      node_def, TF_GRAPH_DEF_VERSION, &status);
+  TF_CHECK_OK(status);
+  return k;
+}
+
+// A mean reduction of `input` on CPU device `rank`, in bucket 1 of size
+// `bucket_size`.
+class BucketedReduction {
+ public:
+  BucketedReduction(CollectiveTestEnv* test_env, int rank, int32 instance_key,
+                    int bucket_size, const Tensor& input)
+      : test_env_(test_env),
+        input_(input),
+        output_(input.dtype(), input.shape()) {
+    TF_CHECK_OK(test_env->device_mgr->LookupDevice(
+        strings::StrCat("/job:worker/replica:0/task:0/device:CPU:", rank),
+        &device_));
+    col_params_ = CreateCollectiveParams(*test_env, rank, "RingReduce",
+                                         REDUCTION_COLLECTIVE, input.dtype(),
+                                         input.shape());
+    col_params_->instance.instance_key = instance_key;
+    col_params_->instance.impl_details.bucket_key = 1;
+    col_params_->instance.impl_details.bucket_size = bucket_size;
+    merge_op_ = GetKernel("Add", input.dtype(), device_);
+    final_op_ = GetKernel("Div", input.dtype(), device_);
+    col_params_->merge_op = merge_op_.get();
+    col_params_->final_op = final_op_.get();
+    CollectiveImplementationInterface* col_impl = nullptr;
+    TF_CHECK_OK(CollectiveRegistry::Lookup("RingReduce", &col_impl));
+    core::ScopedUnref unref(col_impl);
+    TF_CHECK_OK(col_impl->InitializeCollectiveParams(col_params_.get()));
+
+    inputs_.push_back(TensorValue(&input_));
+    op_params_.device = device_;
+    op_params_.op_kernel = merge_op_.get();
+    op_params_.cancellation_manager = &cancellation_manager_;
+    op_params_.inputs = inputs_;
+    op_params_.input_alloc_attrs = input_alloc_attrs_;
+    op_params_.output_attr_array = &output_alloc_attr_;
+    op_params_.op_device_context = device_context_.get();
+    ctx_ = std::make_unique<OpKernelContext>(&op_params_, 1);
+    ctx_->set_output(0, output_);
+  }
+
+  void Start(BlockingCounter* counter) {
+    test_env_->col_exec->ExecuteAsync(
+        ctx_.get(), col_params_.get(),
+        strings::StrCat(col_params_->instance.instance_key, ":0:0"),
+        [this, counter](const absl::Status& s) {
+          status_ = s;
+          counter->DecrementCount();
+        });
+  }
+
+  const absl::Status& status() const { return status_; }
+  const Tensor& output() const { return output_; }
+
+ private:
+  CollectiveTestEnv* test_env_;
+  Device* device_ = nullptr;
+  Tensor input_;
+  Tensor output_;
+  core::RefCountPtr<CollectiveParams> col_params_;
+  std::unique_ptr<OpKernel> merge_op_;
+  std::unique_ptr<OpKernel> final_op_;
+  CancellationManager cancellation_manager_;
+  core::RefCountPtr<DeviceContext> device_context_{new DeviceContext};
+  absl::InlinedVector<TensorValue, 4> inputs_;
+  absl::InlinedVector<AllocatorAttributes, 4> input_alloc_attrs_{
+      AllocatorAttributes()};
+  AllocatorAttributes output_alloc_attr_;
+  OpKernelContext::Params op_params_;
+  std::unique_ptr<OpKernelContext> ctx_;
+  absl::Status status_;
+};
+
+TEST(BaseCollectiveExecutorTest, BucketedReductions) {
+  auto test_env =
+      CreateCollectiveTestEnv(/*num_workers=*/1, /*num_devices_per_worker=*/2,
+                              DEVICE_CPU);
+  std::vector<std::unique_ptr<BucketedReduction>> reductions;
+  for (int rank = 0; rank < 2; ++rank) {
+    const float scale = rank == 0 ? 1 : 3;
+    // Issue the reductions of the bucket in a different order on each device.
+    Tensor a = test::AsTensor<float>({1 * scale, 2 * scale, 3 * scale});
+    Tensor b = test::AsTensor<float>(
+        {4 * scale, 5 * scale, 6 * scale, 7 * scale}, {2, 2});
+    if (rank == 0) {
+      reductions.push_back(std::make_unique<BucketedReduction>(
+          test_env.get(), rank, /*instance_key=*/17, /*bucket_size=*/2, a));
+      reductions.push_back(std::make_unique<BucketedReduction>(
+          test_env.get(), rank, /*instance_key=*/18, /*bucket_size=*/2, b));
+    } else {
+      reductions.push_back(std::make_unique<BucketedReduction>(
+          test_env.get(), rank, /*instance_key=*/18, /*bucket_size=*/2, b));
+      reductions.push_back(std::make_unique<BucketedReduction>(
+          test_env.get(), rank, /*instance_key=*/17, /*bucket_size=*/2, a));
+    }
+  }
+  BlockingCounter counter(reductions.size());
+  for (auto& reduction : reductions) {
+    reduction->Start(&counter);
+  }
+  counter.Wait();
+
+  const Tensor expected_a = test::AsTensor<float>({2, 4, 6});
+  const Tensor expected_b = test::AsTensor<float>({8, 10, 12, 14}, {2, 2});
+  for (int i = 0; i < reductions.size(); ++i) {
+    TF_ASSERT_OK(reductions[i]->status());
+    // Reductions 0 and 3 are `a`, 1 and 2 are `b`.
+    test::ExpectTensorEqual<float>(i == 0 || i == 3 ? expected_a : expected_b,
+                                   reductions[i]->output());
+  }
+}
+
+TEST(BaseCollectiveExecutorTest, IncompatibleBucketedReductions) {
+  auto test_env =
+      CreateCollectiveTestEnv(/*num_workers=*/1, /*num_devices_per_worker=*/2,
+                              DEVICE_CPU);
+  BucketedReduction a(test_env.get(), /*rank=*/0, /*instance_key=*/17,
+                      /*bucket_size=*/2, test::AsTensor<float>({1, 2}));
+  BucketedReduction b(test_env.get(), /*rank=*/0, /*instance_key=*/18,
+                      /*bucket_size=*/2, test::AsTensor<double>({1, 2}));
+  BlockingCounter counter(2);
+  a.Start(&counter);
+  b.Start(&counter);
+  counter.Wait();
+  EXPECT_TRUE(absl::IsInvalidArgument(a.status())) << a.status();
+  EXPECT_TRUE(absl::IsInvalidArgument(b.status())) << b.status();
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -700,6 +700,15 @@ void CollectiveParamResolverLocal::AssignCollectiveType(CollectiveParams* cp) {
       CollectiveRegistry::LookupParamResolverInstance("NcclReduce", &col_impl)
           .ok();
   cp->instance.impl_details.collective_name = GetCollectiveName(cp, use_nccl);
+  // CPU reductions over several devices on each of several tasks reduce
+  // within each task first, so that only one device per task takes part in
+  // the reduction across tasks.
+  if (!use_nccl && cp->instance.type == REDUCTION_COLLECTIVE &&
+      cp->group.device_type == DEVICE_CPU &&
+      cp->instance.impl_details.communication_hint != "ring" &&
+      cp->group.num_tasks > 1 && cp->group.group_size > cp->group.num_tasks) {
+    cp->instance.impl_details.collective_name = "HierarchicalReduce";
+  }
   VLOG(1) << "AssignCollectiveType "
           << cp->instance.impl_details.collective_name;
 }
@@ -21,6 +21,8 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/types.h"
@@ -112,5 +114,40 @@ absl::Status ComputeBinOp(OpKernelContext* op_ctx,
   return sub_ctx->sub_ctx_->status();
 }
 
+bool UseWireDataType(const CollectiveParams& col_params, const Device* device) {
+  const DataType wire_dtype = col_params.instance.impl_details.wire_dtype;
+  return col_params.instance.type == REDUCTION_COLLECTIVE &&
+         col_params.instance.data_type == DT_FLOAT &&
+         (wire_dtype == DT_HALF || wire_dtype == DT_BFLOAT16) &&
+         device->tensorflow_accelerator_device_info() == nullptr;
+}
+
+Tensor ToWireTensor(const Tensor& value, DataType wire_dtype) {
+  DCHECK_EQ(value.dtype(), DT_FLOAT);
+  Tensor wire_value(wire_dtype, value.shape());
+  if (wire_dtype == DT_HALF) {
+    wire_value.unaligned_flat<Eigen::half>() =
+        value.unaligned_flat<float>().cast<Eigen::half>();
+  } else {
+    DCHECK_EQ(wire_dtype, DT_BFLOAT16);
+    wire_value.unaligned_flat<bfloat16>() =
+        value.unaligned_flat<float>().cast<bfloat16>();
+  }
+  return wire_value;
+}
+
+void FromWireTensor(const Tensor& wire_value, Tensor* value) {
+  DCHECK_EQ(value->dtype(), DT_FLOAT);
+  DCHECK_EQ(wire_value.NumElements(), value->NumElements());
+  if (wire_value.dtype() == DT_HALF) {
+    value->unaligned_flat<float>() =
+        wire_value.unaligned_flat<Eigen::half>().cast<float>();
+  } else {
+    DCHECK_EQ(wire_value.dtype(), DT_BFLOAT16);
+    value->unaligned_flat<float>() =
+        wire_value.unaligned_flat<bfloat16>().cast<float>();
+  }
+}
+
 }  // namespace collective_util
 }  // namespace tensorflow
@@ -54,6 +54,17 @@ absl::Status ComputeBinOp(OpKernelContext* op_ctx,
                           OpKernelContext::Params* params, Device* device,
                           OpKernel* op, Tensor* output, Tensor* input);
 
+// Returns true if the values of the collective `col_params` on `device` are
+// sent to other devices as CollImplDetails::wire_dtype.
+bool UseWireDataType(const CollectiveParams& col_params, const Device* device);
+
+// Converts `value` to a new tensor of type `wire_dtype` for sending.
+Tensor ToWireTensor(const Tensor& value, DataType wire_dtype);
+
+// Converts the received `wire_value` back into `value`, which has its
+// original type and shape.
+void FromWireTensor(const Tensor& wire_value, Tensor* value);
+
 }  // namespace collective_util
 }  // namespace tensorflow
 
@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <functional>
 #include <memory>
+#include <thread>  // NOLINT
 #include <utility>
 
 #include "tensorflow/core/platform/stacktrace.h"
@@ -33,6 +34,11 @@ namespace {
 //  - Should EventMgrs be shared between devices on a machine with multiple
 //  devices of the same type?
 static const int kNumThreads = 2;
+
+// In hybrid polling mode, the longest the polling loop blocks before it polls
+// again. Bounds the delay of a callback if no host callback could be enqueued
+// behind its event.
+static const int64_t kMaxBlockingPollMsecs = 1;
 }  // namespace
 
 namespace device_event_mgr {
@@ -100,6 +106,12 @@ EventMgr::EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options)
       polling_active_delay_usecs_(gpu_options.polling_active_delay_usecs()
                                       ? gpu_options.polling_active_delay_usecs()
                                       : 10),
+      hybrid_polling_(gpu_options.experimental().event_polling_mode() ==
+                      GPUOptions::Experimental::EVENT_POLLING_HYBRID),
+      polling_spin_usecs_(
+          gpu_options.experimental().event_polling_spin_usecs()
+              ? gpu_options.experimental().event_polling_spin_usecs()
+              : 50),
       threadpool_(Env::Default(), "Device_Event_Manager", kNumThreads) {
   device_event_mgr::InitThreadpoolLabels(&threadpool_);
   StartPollingLoop();
@@ -108,6 +120,14 @@ EventMgr::EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options)
 EventMgr::~EventMgr() {
   StopPollingLoop();
 
+  {
+    // The host callbacks refer to this object.
+    mutex_lock l(mu_);
+    while (pending_host_callbacks_ > 0) {
+      events_pending_.wait(l);
+    }
+  }
+
   for (auto& [stream, stream_callbacks] : callbacks_) {
     for (auto& [event, callback] : stream_callbacks) {
       threadpool_.Schedule(std::move(callback));
@@ -143,8 +163,13 @@ void EventMgr::StopPollingLoop() {
 //
 // While one or more events is outstanding, poll for completed events.  When no
 // events are outstanding, we sleep until one is enqueued.
+//
+// In hybrid mode, the loop polls without sleeping for up to
+// polling_spin_usecs_ after an event was enqueued or completed, and then
+// blocks until a host callback signals that a stream has reached an event.
 void EventMgr::PollLoop() {
   ToFreeVector to_free;
+  uint64 spin_deadline_usecs = 0;
   while (true) {
     bool events_still_pending;
     {
@@ -154,15 +179,27 @@ void EventMgr::PollLoop() {
       }
       if (callbacks_.empty()) {
         events_pending_.wait(l);
+        spin_deadline_usecs = Env::Default()->NowMicros() + polling_spin_usecs_;
+      } else if (hybrid_polling_ && !completion_signaled_ &&
+                 Env::Default()->NowMicros() >= spin_deadline_usecs) {
+        WaitForMilliseconds(&l, &events_pending_, kMaxBlockingPollMsecs);
       }
+      completion_signaled_ = false;
       PollEvents(nullptr, &to_free);  // poll all streams
       events_still_pending = !callbacks_.empty();
     }
-    FreeMemory(to_free);
+    if (hybrid_polling_ && !to_free.empty()) {
+      spin_deadline_usecs = Env::Default()->NowMicros() + polling_spin_usecs_;
+    }
+    FreeMemory(std::move(to_free));
     to_free.clear();
 
     if (events_still_pending) {
-      Env::Default()->SleepForMicroseconds(polling_active_delay_usecs_);
+      if (hybrid_polling_) {
+        std::this_thread::yield();
+      } else {
+        Env::Default()->SleepForMicroseconds(polling_active_delay_usecs_);
+      }
     }
   }
   polling_stopped_->Notify();
@@ -181,6 +218,20 @@ void EventMgr::EnqueueCallback(se::Stream* stream, std::function<void()> func) {
   std::unique_ptr<se::Event> e = std::move(free_events_.back());
   free_events_.pop_back();
   stream->RecordEvent(e.get()).IgnoreError();
+  if (hybrid_polling_) {
+    // Wakes up the polling loop once the stream has reached the event.
+    absl::Status s = stream->DoHostCallback([this]() {
+      mutex_lock l(mu_);
+      completion_signaled_ = true;
+      --pending_host_callbacks_;
+      events_pending_.notify_all();
+    });
+    if (s.ok()) {
+      ++pending_host_callbacks_;
+    } else {
+      VLOG(1) << "Failed to enqueue the host callback of an event: " << s;
+    }
+  }
 
   bool was_empty = callbacks_.empty();
   callbacks_[stream].push_back({std::move(e), std::move(func)});
@@ -283,7 +334,7 @@ EventMgr* EventMgrFactory::GetEventMgr(se::StreamExecutor* se,
   // TODO(laigd): consider making gpu_options part of the key. It's not
   // currently since EventMgr depends only rely on field deferred_deletion_bytes
   // and polling_active_delay_usecs from gpu_options which are not used or
-  // rarely used.
+  // rarely used. The same holds for the experimental event polling options.
   auto itr = event_mgr_map_.find(se);
   if (itr == event_mgr_map_.end()) {
     auto event_mgr = new EventMgr(se, gpu_options);
@@ -74,7 +74,7 @@ class EventMgr {
       EnqueueCallback(stream, std::move(func));
       PollEvents(stream, &to_free);
     }
-    FreeMemory(to_free);
+    FreeMemory(std::move(to_free));
   }
 
  private:
@@ -84,8 +84,18 @@ class EventMgr {
 
   se::StreamExecutor* const exec_;
   const int32 polling_active_delay_usecs_;
+  // Whether the polling loop runs in GPUOptions.Experimental's
+  // EVENT_POLLING_HYBRID mode.
+  const bool hybrid_polling_;
+  // In hybrid mode, how long the polling loop keeps polling before it blocks.
+  const int32 polling_spin_usecs_;
   mutex mu_;
   condition_variable events_pending_ TF_GUARDED_BY(mu_);
+  // In hybrid mode, set by the host callbacks when a stream has reached one of
+  // its events, and cleared by the polling loop.
+  bool completion_signaled_ TF_GUARDED_BY(mu_) = false;
+  // In hybrid mode, the number of host callbacks that have not run yet.
+  int64_t pending_host_callbacks_ TF_GUARDED_BY(mu_) = 0;
 
   struct InUse {
     se::Event* event;
@@ -96,7 +106,17 @@ class EventMgr {
 
   EventMgr(se::StreamExecutor* se, const GPUOptions& gpu_options);
 
-  void FreeMemory(const ToFreeVector& to_free) {
+  void FreeMemory(ToFreeVector to_free) {
+    if (hybrid_polling_ && to_free.size() > 1) {
+      // Hand the callbacks over as one batch, which saves a round trip
+      // through the threadpool per callback.
+      threadpool_.Schedule([to_free = std::move(to_free)]() {
+        for (const auto& iu : to_free) {
+          if (iu.func != nullptr) iu.func();
+        }
+      });
+      return;
+    }
     for (const auto& iu : to_free) {
       // The function must be called in another thread.
       if (iu.func != nullptr) threadpool_.Schedule(iu.func);
@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/stream_executor.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
@@ -75,7 +76,7 @@ class TEST_EventMgrHelper {
         mutex_lock l(em_->mu_);
         em_->PollEvents(nullptr, &to_free);
       }
-      em_->FreeMemory(to_free);
+      em_->FreeMemory(std::move(to_free));
     }
   }
 
@@ -138,6 +139,28 @@ TEST(EventMgr, WarnIfInCallback) {
   note.WaitForNotification();
   EXPECT_TRUE(hit);
 }
+
+// Tests that all callbacks run in hybrid polling mode, in which the polling
+// loop blocks until a host callback wakes it up.
+TEST(EventMgr, HybridPolling) {
+  auto stream_exec = se::GPUMachineManager()->ExecutorForDevice(0).value();
+  GPUOptions gpu_options;
+  gpu_options.mutable_experimental()->set_event_polling_mode(
+      GPUOptions::Experimental::EVENT_POLLING_HYBRID);
+  gpu_options.mutable_experimental()->set_event_polling_spin_usecs(1);
+  TEST_EventMgr em(stream_exec, gpu_options);
+  TF_ASSERT_OK_AND_ASSIGN(auto stream, stream_exec->CreateStream());
+  constexpr int kNumCallbacks = 100;
+  BlockingCounter counter(kNumCallbacks);
+  for (int i = 0; i < kNumCallbacks; ++i) {
+    em.ThenExecute(stream.get(), [&counter]() { counter.DecrementCount(); });
+    if (i % 10 == 0) {
+      // Gives the polling loop a chance to block.
+      Env::Default()->SleepForMicroseconds(100);
+    }
+  }
+  counter.Wait();
+}
 }  // namespace
 
 // Provides access to private resources of BaseGPUDevice.
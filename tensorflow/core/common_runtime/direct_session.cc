@@ -20,6 +20,7 @@ limitations under the License.
 #include <string>
 #include <vector>
 
+#include "absl/cleanup/cleanup.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
@@ -40,6 +41,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/common_runtime/scoped_allocator_mgr.h"
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/graph.pb.h"
@@ -48,6 +50,7 @@ limitations under the License.
 #include "tensorflow/core/framework/logging.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/op_segment.h"
 #include "tensorflow/core/framework/run_handler.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/versions.pb.h"
@@ -80,6 +83,7 @@ limitations under the License.
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/util/device_name_utils.h"
 #include "tensorflow/core/util/env_var.h"
+#include "xla/tsl/profiler/backends/cpu/traceme_recorder.h"
 
 namespace tensorflow {
 
@@ -364,6 +368,12 @@ DirectSession::DirectSession(const SessionOptions& options,
   if (!status.ok()) {
     LOG(ERROR) << status.message();
   }
+  const Status critical_path_status =
+      ReadInt64FromEnvVar("TF_STEP_CRITICAL_PATH_EVERY_N_STEPS", 0,
+                          &critical_path_every_n_steps_);
+  if (!critical_path_status.ok()) {
+    LOG(ERROR) << critical_path_status.message();
+  }
   session_handle_ =
       strings::StrCat("direct", strings::FpToString(random::New64()));
   if (options.config.log_device_placement()) {
@@ -512,6 +522,13 @@ Status DirectSession::RunInternal(
     RunMetadata* run_metadata,
     const thread::ThreadPoolOptions& threadpool_options) {
   const uint64 start_time_usecs = options_.env->NowMicros();
+  const bool flight_recorder_sampled =
+      tsl::profiler::TraceMeRecorder::FlightRecorderStepStarted();
+  absl::Cleanup flight_recorder_step_ended = [&] {
+    tsl::profiler::TraceMeRecorder::FlightRecorderStepEnded(
+        flight_recorder_sampled,
+        (options_.env->NowMicros() - start_time_usecs) * 1000);
+  };
   const int64_t executor_step_count =
       executors_and_keys->step_count.fetch_add(1);
   RunState run_state(step_id, &devices_);
@@ -688,12 +705,22 @@ Status DirectSession::RunInternal(
           ((measure_step_count + 1) % build_cost_model_every == 0);
     }
   }
+  const bool analyze_critical_path =
+      critical_path_every_n_steps_ > 0 &&
+      (executor_step_count + 1) % critical_path_every_n_steps_ == 0;
+  StepStats critical_path_step_stats;
   if (run_metadata != nullptr &&
       (do_trace || update_cost_model ||
        run_options.report_tensor_allocations_upon_oom())) {
     run_state.collector.reset(
         new StepStatsCollector(run_metadata->mutable_step_stats()));
     args.stats_collector = run_state.collector.get();
+  } else if (analyze_critical_path) {
+    run_state.collector.reset(
+        new StepStatsCollector(run_metadata != nullptr
+                                   ? run_metadata->mutable_step_stats()
+                                   : &critical_path_step_stats));
+    args.stats_collector = run_state.collector.get();
   }
 
   std::unique_ptr<DeviceProfilerSession> device_profiler_session;
@@ -711,6 +738,20 @@ Status DirectSession::RunInternal(
 
   Status run_status;
 
+  // One arena per CPU partition, released when the last tensor allocated from
+  // it is gone.
+  std::vector<core::RefCountPtr<StepArenaAllocator>> step_arenas(
+      executors_and_keys->items.size());
+  if (options_.config.experimental().enable_step_arena_allocator()) {
+    for (size_t i = 0; i < executors_and_keys->items.size(); ++i) {
+      Device* device = executors_and_keys->items[i].device;
+      if (device->device_type() == DEVICE_CPU) {
+        step_arenas[i].reset(
+            new StepArenaAllocator(device->GetAllocator(AllocatorAttributes())));
+      }
+    }
+  }
+
   auto set_threadpool_args_for_item =
       [&default_runner, &handler](const PerPartitionExecutorsAndLib& item,
                                   Executor::Args* args) {
@@ -741,6 +782,7 @@ Status DirectSession::RunInternal(
 
     const auto& item = executors_and_keys->items[0];
     set_threadpool_args_for_item(item, &args);
+    args.step_arena_allocator = step_arenas[0].get();
     run_status = item.executor->Run(args);
   } else {
     core::RefCountPtr<RefCountedIntraProcessRendezvous> rendezvous(
@@ -759,8 +801,10 @@ Status DirectSession::RunInternal(
                               executors_done.Notify();
                             });
 
-    for (const auto& item : executors_and_keys->items) {
+    for (size_t i = 0; i < executors_and_keys->items.size(); ++i) {
+      const auto& item = executors_and_keys->items[i];
       set_threadpool_args_for_item(item, &args);
+      args.step_arena_allocator = step_arenas[i].get();
       item.executor->RunAsync(args, barrier->Get());
     }
 
@@ -792,20 +836,34 @@ Status DirectSession::RunInternal(
   }
 
   if (run_state.collector) {
+    for (size_t i = 0; i < step_arenas.size(); ++i) {
+      if (step_arenas[i]) {
+        step_arenas[i]->SaveStats(executors_and_keys->items[i].device->name(),
+                                  run_state.collector.get());
+      }
+    }
     run_state.collector->Finalize();
   }
 
-  // Build and return the cost model as instructed.
-  if (update_cost_model) {
-    // Build the cost model
-    std::unordered_map<string, const Graph*> device_to_graph;
+  std::unordered_map<string, const Graph*> device_to_graph;
+  if (update_cost_model || analyze_critical_path) {
     for (const PerPartitionExecutorsAndLib& partition :
          executors_and_keys->items) {
       const Graph* graph = partition.graph.get();
       const string& device = partition.flib->device()->name();
       device_to_graph[device] = graph;
     }
+  }
+
+  if (analyze_critical_path) {
+    StepCriticalPath critical_path;
+    run_state.collector->AnalyzeCriticalPath(
+        device_to_graph, /*max_slack_nodes=*/8, &critical_path);
+    RecordStepCriticalPath(critical_path);
+  }
 
+  // Build and return the cost model as instructed.
+  if (update_cost_model) {
     mutex_lock l(executor_lock_);
     run_state.collector->BuildCostModel(&cost_model_manager_, device_to_graph);
 
@@ -908,26 +966,42 @@ Status DirectSession::Run(const RunOptions& run_options,
     return s;
   }
 
-  const int64_t step_id = step_id_counter_.fetch_add(1);
-
-  if (LogMemory::IsEnabled()) {
-    LogMemory::RecordStep(step_id, run_state_args.handle);
+  // Stateless graphs may be served from the result cache, unless the caller
+  // wants to observe the execution.
+  RunResultCache* result_cache = executors_and_keys->result_cache.get();
+  const bool use_result_cache =
+      result_cache != nullptr &&
+      run_options.trace_level() == RunOptions::NO_TRACE &&
+      !run_options.output_partition_graphs() &&
+      RunResultCache::IsCacheable(feed_args);
+  std::vector<Tensor> sorted_outputs;
+  if (!use_result_cache || !result_cache->Lookup(feed_args, &sorted_outputs)) {
+    const int64_t step_id = step_id_counter_.fetch_add(1);
+
+    if (LogMemory::IsEnabled()) {
+      LogMemory::RecordStep(step_id, run_state_args.handle);
+    }
+
+    TF_RETURN_IF_ERROR(RunInternal(step_id, run_options, &call_frame,
+                                   executors_and_keys, run_metadata,
+                                   threadpool_options));
+
+    if (outputs || use_result_cache) {
+      const Status s = call_frame.ConsumeRetvals(
+          &sorted_outputs, /* allow_dead_tensors = */ false);
+      if (errors::IsInternal(s)) {
+        return errors::InvalidArgument(s.message());
+      } else if (!s.ok()) {
+        return s;
+      }
+    }
+    if (use_result_cache) {
+      result_cache->Insert(feed_args, sorted_outputs);
+    }
   }
 
-  TF_RETURN_IF_ERROR(RunInternal(step_id, run_options, &call_frame,
-                                 executors_and_keys, run_metadata,
-                                 threadpool_options));
-
   // Receive outputs.
   if (outputs) {
-    std::vector<Tensor> sorted_outputs;
-    const Status s = call_frame.ConsumeRetvals(
-        &sorted_outputs, /* allow_dead_tensors = */ false);
-    if (errors::IsInternal(s)) {
-      return errors::InvalidArgument(s.message());
-    } else if (!s.ok()) {
-      return s;
-    }
     const bool unique_outputs =
         output_names.size() == executors_and_keys->output_name_to_index.size();
     // first_indices[i] = j implies that j is the smallest value for which
@@ -1378,6 +1452,9 @@ Status DirectSession::CreateExecutors(
         return absl::OkStatus();
       }}));
 
+  // True iff no partition contains a stateful op, apart from the ops that
+  // implement feeds, fetches and cross-device transfers.
+  bool is_stateless = true;
   GraphOptimizer optimizer(optimizer_opts);
   for (auto iter = graphs.begin(); iter != graphs.end(); ++iter) {
     const string& partition_name = iter->first;
@@ -1399,14 +1476,25 @@ Status DirectSession::CreateExecutors(
     params.session_metadata = session_metadata;
     params.function_library = lib;
     auto opseg = device->op_segment();
+    const bool share_kernels =
+        options_.config.experimental().share_stateless_kernels();
     params.create_kernel =
-        [this, lib, opseg](const std::shared_ptr<const NodeProperties>& props,
-                           OpKernel** kernel) {
+        [this, lib, opseg, device, share_kernels](
+            const std::shared_ptr<const NodeProperties>& props,
+            OpKernel** kernel) {
           // NOTE(mrry): We must not share function kernels (implemented
           // using `CallOp`) between subgraphs, because `CallOp::handle_`
           // is tied to a particular subgraph. Even if the function itself
           // is stateful, the `CallOp` that invokes it is not.
           if (!OpSegment::ShouldOwnKernel(lib, props->node_def.op())) {
+            if (share_kernels &&
+                SharedKernelCache::ShouldShareKernel(lib, props->node_def)) {
+              return SharedKernelCache::Global()->FindOrCreate(
+                  device, lib->graph_def_version(), props->node_def, kernel,
+                  [lib, &props](OpKernel** kernel) {
+                    return lib->CreateKernel(props, kernel);
+                  });
+            }
             return lib->CreateKernel(props, kernel);
           }
           auto create_fn = [lib, &props](OpKernel** kernel) {
@@ -1418,8 +1506,9 @@ Status DirectSession::CreateExecutors(
           return opseg->FindOrCreate(session_handle_, props->node_def.name(),
                                      kernel, create_fn);
         };
-    params.delete_kernel = [lib](OpKernel* kernel) {
-      if (kernel && !OpSegment::ShouldOwnKernel(lib, kernel->type_string()))
+    params.delete_kernel = [lib, share_kernels](OpKernel* kernel) {
+      if (kernel && !OpSegment::ShouldOwnKernel(lib, kernel->type_string()) &&
+          !(share_kernels && SharedKernelCache::Global()->Release(kernel)))
         delete kernel;
     };
 
@@ -1438,6 +1527,14 @@ Status DirectSession::CreateExecutors(
                                          device->name(),
                                          partition_graph.get()));
 
+    for (const Node* n : partition_graph->op_nodes()) {
+      if (n->op_def().is_stateful() && !n->IsArg() && !n->IsRetval() &&
+          !n->IsSend() && !n->IsRecv()) {
+        is_stateless = false;
+        break;
+      }
+    }
+
     item->executor = nullptr;
     item->device = device;
     auto executor_type = options_.config.experimental().executor_type();
@@ -1482,6 +1579,17 @@ Status DirectSession::CreateExecutors(
     }
   }
 
+  const int64_t result_cache_size =
+      options_.config.experimental().stateless_run_result_cache_size();
+  if (result_cache_size > 0 && is_stateless &&
+      !run_state_args->is_partial_run &&
+      options.callable_options.run_options()
+          .debug_options()
+          .debug_tensor_watch_opts()
+          .empty()) {
+    ek->result_cache = std::make_unique<RunResultCache>(result_cache_size);
+  }
+
   *out_executors_and_keys = std::move(ek);
   *out_func_info = std::move(func_info);
   return absl::OkStatus();
@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/graph_execution_state.h"
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
+#include "tensorflow/core/common_runtime/run_result_cache.h"
 #include "tensorflow/core/common_runtime/session_factory.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
@@ -175,6 +176,11 @@ class DirectSession : public Session {
     CallableOptions callable_options;
 
     int64_t collective_graph_key = BuildGraphOptions::kNoCollectiveGraphKey;
+
+    // Caches the outputs of `Run()` for previously seen feeds, if the graph
+    // is stateless and ConfigProto.Experimental.stateless_run_result_cache_size
+    // is positive. Null otherwise.
+    std::unique_ptr<RunResultCache> result_cache;
   };
 
   // A FunctionInfo object is created for every unique set of feeds/fetches.
@@ -353,6 +359,10 @@ class DirectSession : public Session {
   // If true, blocks until device has finished all queued operations in a step.
   bool sync_on_finish_ = true;
 
+  // If positive, every Nth step of an executor is timed and its critical path
+  // is exported through monitoring metrics.
+  int64_t critical_path_every_n_steps_ = 0;
+
   std::vector<std::unique_ptr<FunctionInfo>> functions_
       TF_GUARDED_BY(executor_lock_);
 
@@ -516,6 +516,42 @@ TEST_F(DirectSessionMinusAXTest, TestFeed) {
   EXPECT_FLOAT_EQ(39.0, mat(1, 0));
 }
 
+TEST_F(DirectSessionMinusAXTest, TestFeedWithResultCache) {
+  Initialize({1, 2, 3, 4});
+  SessionOptions options = DefaultSessionOptions();
+  options.config.mutable_experimental()->set_stateless_run_result_cache_size(
+      2);
+  std::unique_ptr<Session> session(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+
+  TF_ASSERT_OK(session->Create(def_));
+
+  auto run = [&](float x0, float x1, std::vector<Tensor>* outputs) {
+    Tensor t(DT_FLOAT, TensorShape({2, 1}));
+    t.matrix<float>()(0, 0) = x0;
+    t.matrix<float>()(1, 0) = x1;
+    TF_ASSERT_OK(session->Run({{x_, t}}, {y_ + ":0"}, {}, outputs));
+    ASSERT_EQ(1, outputs->size());
+  };
+
+  std::vector<Tensor> outputs1;
+  run(5, 6, &outputs1);
+  EXPECT_FLOAT_EQ(17.0, outputs1[0].matrix<float>()(0, 0));
+  EXPECT_FLOAT_EQ(39.0, outputs1[0].matrix<float>()(1, 0));
+
+  // The same feed values are served from the cache.
+  std::vector<Tensor> outputs2;
+  run(5, 6, &outputs2);
+  EXPECT_EQ(outputs1[0].tensor_data().data(),
+            outputs2[0].tensor_data().data());
+
+  // Different feed values run the graph.
+  std::vector<Tensor> outputs3;
+  run(1, 1, &outputs3);
+  EXPECT_FLOAT_EQ(3.0, outputs3[0].matrix<float>()(0, 0));
+  EXPECT_FLOAT_EQ(7.0, outputs3[0].matrix<float>()(1, 0));
+}
+
 TEST_F(DirectSessionMinusAXTest, TestFeed_Callable) {
   Initialize({1, 2, 3, 4});
   auto session = CreateSession();
@@ -32,12 +32,28 @@ bool IsAsyncWaitForRemoteFunctionEnabled() {
                                  true, &enabled));
   return enabled;
 }
+
+int64_t MaxParallelNodesFromEnv() {
+  int64_t max_parallel_nodes = 0;
+  TF_CHECK_OK(ReadInt64FromEnvVar("TF_EAGER_ASYNC_MAX_PARALLEL_NODES", 0,
+                                  &max_parallel_nodes));
+  return max_parallel_nodes;
+}
 }  // namespace
 
 EagerExecutor::EagerExecutor(bool async, bool enable_streaming_enqueue,
-                             int in_flight_nodes_limit)
+                             int in_flight_nodes_limit, int max_parallel_nodes)
     : next_node_id_(0),
       ok_(true),
+      max_parallel_nodes_(!async                   ? 0
+                          : max_parallel_nodes > 0 ? max_parallel_nodes
+                                                   : MaxParallelNodesFromEnv()),
+      parallel_thread_pool_(
+          max_parallel_nodes_ > 0
+              ? std::make_unique<thread::ThreadPool>(
+                    tensorflow::Env::Default(), "eager_parallel_executor",
+                    max_parallel_nodes_)
+              : nullptr),
       thread_(async ? tensorflow::Env::Default()->StartThread(
                           tensorflow::ThreadOptions(), "eager_async_executor",
                           std::bind(&EagerExecutor::Run, this))
@@ -51,12 +67,17 @@ EagerExecutor::EagerExecutor(bool async, bool enable_streaming_enqueue,
     VLOG(4) << "EagerExecutor InFlightNodes limit is set to "
             << in_flight_nodes_limit_;
   }
+  if (max_parallel_nodes_ > 0) {
+    VLOG(4) << "EagerExecutor runs up to " << max_parallel_nodes_
+            << " nodes in parallel";
+  }
 }
 
 EagerExecutor::~EagerExecutor() {
   tensorflow::mutex_lock l(node_queue_mutex_);
   state_ = ExecutorState::kShutDown;
   nodes_pending_.notify_all();
+  nodes_done_.notify_all();
   for (const auto& cleanups_for_key : cleanups_) {
     for (const std::function<void()>& cleanup : cleanups_for_key.second) {
       cleanup();
@@ -85,6 +106,7 @@ absl::Status EagerExecutor::ShutDown() {
       status = status_;
       if (has_thread) {
         nodes_pending_.notify_all();
+        nodes_done_.notify_all();
       }
     }
     if (!has_thread) {
@@ -236,9 +258,11 @@ void EagerExecutor::NodeDone(const core::RefCountPtr<NodeItem>& item,
   DVLOG(3) << "Node Done: [id " << item->id << "] " << item->node->DebugString()
            << " with status: " << status;
   DCHECK(item->state != NodeState::kDONE);
+  // Nodes run in parallel are tracked in `unfinished_nodes_` like async ones.
+  bool async = item->node->AsAsync() != nullptr ||
+               item->state == NodeState::kSCHEDULED;
   item->state = NodeState::kDONE;
 
-  bool async = item->node->AsAsync() != nullptr;
   // If executing synchronously we don't need to notify if status is OK since
   // the node  was never added to the unfinished_nodes_ list and nobody should
   // ever be waiting for it.
@@ -348,6 +372,7 @@ void EagerExecutor::Run() {
       gtl::MakeCleanup([this] { thread_exited_notification_.Notify(); });
   while (true) {
     core::RefCountPtr<NodeItem> curr_item;
+    bool run_in_parallel = false;
     {
       tensorflow::mutex_lock l(node_queue_mutex_);
       while (node_queue_.empty() || !status_.ok()) {
@@ -363,6 +388,21 @@ void EagerExecutor::Run() {
       // and register a notification for its completion.
       curr_item.reset(node_queue_.front().get());
       curr_item->Ref();
+      if (parallel_thread_pool_ != nullptr) {
+        run_in_parallel = curr_item->node->Parallelizable();
+        while (status_.ok() && state_ != ExecutorState::kShutDown &&
+               !CanStartLocked(*curr_item, run_in_parallel)) {
+          nodes_done_.wait(l);
+        }
+        if (state_ == ExecutorState::kShutDown) return;
+        // On error the queue, including `curr_item`, has been aborted.
+        if (!status_.ok()) continue;
+        if (run_in_parallel) ++num_parallel_nodes_;
+      }
+    }
+    if (run_in_parallel) {
+      RunItemInParallel(std::move(curr_item));
+      continue;
     }
     absl::Status status = RunItem(std::move(curr_item), /*from_queue=*/true);
     if (!status.ok()) {
@@ -443,6 +483,46 @@ absl::Status EagerExecutor::MoveToUnfinished(core::RefCountPtr<NodeItem> item,
   return absl::OkStatus();
 }
 
+bool EagerExecutor::CanStartLocked(const NodeItem& item,
+                                   bool run_in_parallel) {
+  if (!run_in_parallel) {
+    // Keep program order with respect to all earlier parallel nodes.
+    return num_parallel_nodes_ == 0;
+  }
+  if (num_parallel_nodes_ >= max_parallel_nodes_) return false;
+  // An input might be produced outside this executor, in which case no node
+  // completion here signals it. Only wait for inputs while some node of this
+  // executor is still in flight; otherwise the node waits for them itself.
+  return unfinished_nodes_.empty() || item.node->InputsReady();
+}
+
+void EagerExecutor::RunItemInParallel(core::RefCountPtr<NodeItem> item) {
+  DVLOG(3) << "Running Node in parallel: [id " << item->id << "] "
+           << item->node->DebugString();
+  item->state = NodeState::kSCHEDULED;
+  NodeItem* parallel_ref = item.get();
+  parallel_ref->Ref();
+  auto parallel_node_done = [this]() {
+    tensorflow::mutex_lock l(node_queue_mutex_);
+    --num_parallel_nodes_;
+    nodes_done_.notify_all();
+  };
+
+  if (!MoveToUnfinished(std::move(item), /*from_queue=*/true).ok()) {
+    // The executor failed meanwhile and has aborted the node.
+    parallel_node_done();
+    parallel_ref->Unref();
+    return;
+  }
+
+  parallel_thread_pool_->Schedule([this, parallel_ref, parallel_node_done]() {
+    core::RefCountPtr<NodeItem> parallel_item(parallel_ref);
+    absl::Status status = parallel_item->node->Run();
+    parallel_node_done();
+    NodeDone(parallel_item, status, /*from_queue=*/false);
+  });
+}
+
 void EagerExecutor::AddCleanup(intptr_t key, std::function<void()> callback) {
   cleanups_[key].push_back(callback);
 }
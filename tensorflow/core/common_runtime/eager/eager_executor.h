@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/framework/rendezvous.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -79,6 +80,15 @@ class EagerNode {
 
   // Indicates whether a node failure should make the executor unusable.
   virtual bool Fatal() const { return true; }
+
+  // Returns true if the node has no effects that depend on program order, so
+  // an executor running nodes in parallel may overlap it with other such nodes
+  // once `InputsReady()`. Other nodes only run after all earlier nodes.
+  virtual bool Parallelizable() const { return false; }
+
+  // Returns true if all inputs of the node are ready. Only called on nodes
+  // that are `Parallelizable()`.
+  virtual bool InputsReady() const { return true; }
 };
 
 class AsyncEagerNode : public EagerNode {
@@ -110,13 +120,17 @@ class AsyncRemoteExecuteNode : public AsyncEagerNode {
 // TODO(agarwal): TFE_OpAddInput may currently block if it tries to access the
 // device of the input handle. Fix that.
 // TODO(agarwal): Implement support for control dependencies.
-// TODO(agarwal): Support out-of-order execution and dispatching multiple
-// EagerNode in parallel.
 // TODO(agarwal): Implement optimizations over EagerNode traces.
 class EagerExecutor {
  public:
+  // If `max_parallel_nodes` is positive, or is zero and the
+  // TF_EAGER_ASYNC_MAX_PARALLEL_NODES environment variable is positive, an
+  // async executor runs up to that many `Parallelizable()` nodes at a time on
+  // its own threads, starting each once its inputs are ready. Nodes are still
+  // started in the order they are added.
   explicit EagerExecutor(bool async, bool enable_streaming_enqueue = true,
-                         int in_flight_nodes_limit = 0);
+                         int in_flight_nodes_limit = 0,
+                         int max_parallel_nodes = 0);
 
   ~EagerExecutor();
 
@@ -214,6 +228,13 @@ class EagerExecutor {
   absl::Status MoveToUnfinished(core::RefCountPtr<NodeItem> item,
                                 bool from_queue);
 
+  // Returns true if the front of `node_queue_`, which is `item`, can start.
+  bool CanStartLocked(const NodeItem& item, bool run_in_parallel)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(node_queue_mutex_);
+  // Pops `item` from the front of `node_queue_` and runs it on
+  // `parallel_thread_pool_`.
+  void RunItemInParallel(core::RefCountPtr<NodeItem> item);
+
   // The impl of WaitForAllPendingNodes
   // `lock` is the lock that holds node_queue_mutex_.
   absl::Status WaitForAllPendingNodesLocked(mutex_lock* lock)
@@ -259,6 +280,13 @@ class EagerExecutor {
   ExecutorState state_ TF_GUARDED_BY(node_queue_mutex_) =
       ExecutorState::kActive;
 
+  // The maximum and current number of nodes run by `parallel_thread_pool_`.
+  // The pool is `nullptr` unless running nodes in parallel is enabled. It is
+  // declared before `thread_` so that it outlives the thread scheduling on it.
+  const int max_parallel_nodes_;
+  int num_parallel_nodes_ TF_GUARDED_BY(node_queue_mutex_) = 0;
+  const std::unique_ptr<thread::ThreadPool> parallel_thread_pool_;
+
   // Thread object that calls the `Run` method in async mode.This thread runs
   // until state_ is set to kShuttingDown. It is `nullptr` in sync mode.
   const std::unique_ptr<Thread> thread_;
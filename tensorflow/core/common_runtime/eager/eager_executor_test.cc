@@ -14,11 +14,14 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/eager/eager_executor.h"
 
+#include <atomic>
+#include <chrono>  // NOLINT(build/c++11)
 #include <memory>
 #include <utility>
 
 #include "xla/tsl/lib/core/status_test_util.h"
 #include "xla/tsl/protobuf/error_codes.pb.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/status_matchers.h"
 #include "tensorflow/core/platform/test.h"
@@ -102,6 +105,49 @@ class TestAsyncEagerNode : public AsyncEagerNode {
   absl::Status run_return_status_;
 };
 
+// Waits until all nodes sharing `started` have started running.
+class TestParallelEagerNode : public EagerNode {
+ public:
+  TestParallelEagerNode(BlockingCounter* started, std::atomic<int>* num_done)
+      : started_(started), num_done_(num_done) {}
+
+  absl::Status Run() override {
+    started_->DecrementCount();
+    if (!started_->WaitFor(std::chrono::seconds(60))) {
+      return errors::DeadlineExceeded("Nodes did not run in parallel.");
+    }
+    ++*num_done_;
+    return absl::OkStatus();
+  }
+
+  void Abort(absl::Status status) override {}
+  bool Parallelizable() const override { return true; }
+  string DebugString() const override { return "testParallelEagerNode"; }
+
+ private:
+  BlockingCounter* started_;
+  std::atomic<int>* num_done_;
+};
+
+// Records how many parallel nodes were done when this node ran.
+class TestBarrierEagerNode : public EagerNode {
+ public:
+  TestBarrierEagerNode(const std::atomic<int>* num_done, int* num_done_seen)
+      : num_done_(num_done), num_done_seen_(num_done_seen) {}
+
+  absl::Status Run() override {
+    *num_done_seen_ = *num_done_;
+    return absl::OkStatus();
+  }
+
+  void Abort(absl::Status status) override {}
+  string DebugString() const override { return "testBarrierEagerNode"; }
+
+ private:
+  const std::atomic<int>* num_done_;
+  int* num_done_seen_;
+};
+
 TEST(EagerExecutorTest, TestSyncExecutorWithEagerNode) {
   auto sync_executor = std::make_unique<EagerExecutor>(
       /*async=*/false, /*enable_streaming_enqueue=*/true);
@@ -269,6 +315,29 @@ TEST(EagerExecutorTest, TestAsyncExecutorFailRunWithAsyncNode) {
   ASSERT_EQ(state->read_state(), TestState::State::kFailure);
 }
 
+TEST(EagerExecutorTest, TestAsyncExecutorRunsNodesInParallel) {
+  constexpr int kNumParallelNodes = 3;
+  auto async_executor = std::make_unique<EagerExecutor>(
+      /*async=*/true, /*enable_streaming_enqueue=*/true,
+      /*in_flight_nodes_limit=*/0, /*max_parallel_nodes=*/kNumParallelNodes);
+
+  BlockingCounter started(kNumParallelNodes);
+  std::atomic<int> num_done = 0;
+  int num_done_seen = -1;
+  for (int i = 0; i < kNumParallelNodes; ++i) {
+    TF_ASSERT_OK(async_executor->AddOrExecute(
+        std::make_unique<TestParallelEagerNode>(&started, &num_done)));
+  }
+  TF_ASSERT_OK(async_executor->AddOrExecute(
+      std::make_unique<TestBarrierEagerNode>(&num_done, &num_done_seen)));
+  TF_ASSERT_OK(async_executor->WaitForAllPendingNodes());
+
+  EXPECT_EQ(num_done, kNumParallelNodes);
+  // The node that is not parallelizable still runs after all earlier nodes.
+  EXPECT_EQ(num_done_seen, kNumParallelNodes);
+  TF_ASSERT_OK(async_executor->ShutDown());
+}
+
 TEST(EagerExecutorTest, TestAsyncExecutorAddNodesAfterShutdown) {
   auto async_executor = std::make_unique<EagerExecutor>(
       /*async=*/true, /*enable_streaming_enqueue=*/true);
@@ -1311,8 +1311,10 @@ absl::Status GetOrCreateKernelAndDevice(
   absl::flat_hash_map<string, const std::vector<string>*> composite_devices;
   std::unordered_map<int, DtypeAndPartialTensorShape>
       input_resource_variable_dtypes_and_shapes;
+  // The kernel def only feeds into wrapping the op in a function, so plain op
+  // dispatches, which mostly hit the kernel cache, skip the registry lookup.
   const KernelDef* kernel_def = nullptr;
-  if (!op->is_function()) {
+  if (!op->is_function() && ctx.RunEagerOpAsFunction()) {
     const NodeDef& node_def = op->MutableAttrs()->BuildNodeDef();
     auto get_kernel_def = [](const EagerOperation& op, const NodeDef& node_def,
                              const Device* op_device) -> const KernelDef* {
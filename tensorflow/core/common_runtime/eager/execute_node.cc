@@ -16,6 +16,9 @@ limitations under the License.
 
 #include "xla/tsl/util/env_var.h"
 #include "tensorflow/core/common_runtime/eager/context.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_def.pb.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/core/errors.h"
 
 namespace tensorflow {
@@ -147,4 +150,33 @@ absl::Status ExecuteNodeArgs::GetLocalArg(const FunctionArgIndex& index,
   }
 }
 
+bool AsyncExecuteNode::Parallelizable() const {
+  // Functions, stateful ops, ops on accelerators and ops touching resources
+  // keep program order, as do ops whose graphs get collected.
+  if (graph_collector_ != nullptr || kernel_->IsFunction() ||
+      kernel_->IsCrossProcess() || kernel_->kernel() == nullptr ||
+      kernel_->device() == nullptr ||
+      kernel_->device()->device_type() != DEVICE_CPU) {
+    return false;
+  }
+  const OpDef* op_def = nullptr;
+  if (!OpRegistry::Global()
+           ->LookUpOpDef(kernel_->kernel()->type_string(), &op_def)
+           .ok() ||
+      op_def->is_stateful()) {
+    return false;
+  }
+  for (const TensorHandle* handle : inputs_) {
+    if (handle->dtype == DT_RESOURCE) return false;
+  }
+  return true;
+}
+
+bool AsyncExecuteNode::InputsReady() const {
+  for (const TensorHandle* handle : inputs_) {
+    if (!handle->IsReady()) return false;
+  }
+  return true;
+}
+
 }  // namespace tensorflow
@@ -188,9 +188,7 @@ class AsyncExecuteNode : public EagerNode {
       handle->Unref();
     }
 
-    for (auto handle : inputs_) {
-      handle->Unref();
-    }
+    ReleaseInputs();
   }
 
   absl::Status Run() override {
@@ -208,6 +206,11 @@ class AsyncExecuteNode : public EagerNode {
     absl::Status status = EagerKernelExecute(
         ctx_, inputs_, eager_func_params_, kernel_, graph_collector_,
         cancellation_manager_, absl::MakeSpan(retvals_), stack_trace_);
+    // The kernel was the last consumer this node knows of. Drop the input
+    // references now so that intermediates only kept alive by the queue are
+    // freed before the executor moves on, rather than when the node is
+    // destroyed.
+    ReleaseInputs();
     if (!status.ok()) {
       if (stack_trace_.has_value()) {
         errors::SetStackTrace(
@@ -230,6 +233,9 @@ class AsyncExecuteNode : public EagerNode {
     }
   }
 
+  bool Parallelizable() const override;
+  bool InputsReady() const override;
+
   std::string DebugString() const override {
     std::string out = "[AsyncExecuteNode]";
     strings::StrAppend(&out, " kernel: ", kernel_->name());
@@ -237,6 +243,13 @@ class AsyncExecuteNode : public EagerNode {
   }
 
  private:
+  void ReleaseInputs() {
+    for (auto handle : inputs_) {
+      handle->Unref();
+    }
+    inputs_.clear();
+  }
+
   EagerContext* ctx_;
   absl::InlinedVector<TensorHandle*, 4> inputs_;
   const absl::optional<EagerFunctionParams> eager_func_params_;
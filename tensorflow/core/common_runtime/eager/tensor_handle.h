@@ -286,6 +286,7 @@ class TensorHandle : public ImmediateExecutionTensorHandle {
   void SetFullType(FullTypeDef& full_type) { full_type_ = full_type; }
 
  private:
+  friend class AsyncExecuteNode;  // For IsReady().
   friend class PackedTensorHandleTest;
 
   TensorHandle(std::vector<TensorHandle*>&& handles, Device* device,
@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/renamed_device.h"
 #include "tensorflow/core/common_runtime/simple_propagator_state.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/common_runtime/work_stealing_ready_queue.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
@@ -62,6 +63,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/manual_constructor.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
@@ -79,6 +81,7 @@ limitations under the License.
 #include "tensorflow/core/profiler/lib/traceme_encode.h"
 #include "tensorflow/core/protobuf/error_codes.pb.h"
 #include "tensorflow/core/util/determinism.h"
+#include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/managed_stack_trace.h"
 #include "tensorflow/core/util/tensor_slice_reader_cache.h"
 #include "tsl/platform/tracing.h"
@@ -141,17 +144,54 @@ struct KernelTimer {
   }
 };
 
+// If true, the executor learns from measured kernel execution times whether
+// each synchronous kernel should run inline or be dispatched to the inter-op
+// threadpool, instead of only re-evaluating kernels that report
+// OpKernel::IsExpensive(). Enabled with TF_EXECUTOR_ADAPTIVE_INLINING=1.
+bool UseAdaptiveInlining() {
+  bool value;
+  TF_CHECK_OK(ReadBoolFromEnvVar("TF_EXECUTOR_ADAPTIVE_INLINING",
+                                 /*default_val=*/false, &value));
+  return value;
+}
+
+// If true, successful completions of asynchronous kernels are queued on the
+// ExecutorState, and whichever callback thread finds the queue idle propagates
+// the outputs of all queued completions and schedules the resulting ready
+// nodes in one batch. Enabled with TF_EXECUTOR_BATCH_ASYNC_COMPLETIONS=1.
+bool UseBatchedAsyncCompletions() {
+  bool value;
+  TF_CHECK_OK(ReadBoolFromEnvVar("TF_EXECUTOR_BATCH_ASYNC_COMPLETIONS",
+                                 /*default_val=*/false, &value));
+  return value;
+}
+
 // TODO(b/152925936): Re-evaluate these constants with current usage patterns.
 typedef absl::InlinedVector<TensorValue, 4UL> TensorValueVec;
 typedef absl::InlinedVector<AllocatorAttributes, 4UL> AllocatorAttributeVec;
 
+// The maximum number of idle `ExecutorState::ProcessScratch` objects that a
+// thread keeps for reuse. Deeper nesting of `ProcessInline()` calls allocates.
+constexpr size_t kMaxFreeProcessScratch = 8;
+
+// Returns the calling thread's idle `ExecutorState::ProcessScratch` objects.
+template <typename Scratch>
+std::vector<std::unique_ptr<Scratch>>& ProcessScratchFreeList() {
+  static thread_local std::vector<std::unique_ptr<Scratch>> free_list;
+  return free_list;
+}
+
 class ExecutorImpl : public Executor {
  public:
-  explicit ExecutorImpl(const LocalExecutorParams& p) : immutable_state_(p) {}
+  explicit ExecutorImpl(const LocalExecutorParams& p,
+                        bool use_work_stealing = false)
+      : immutable_state_(p), use_work_stealing_(use_work_stealing) {}
 
   Status Initialize(const Graph& graph) {
     TF_RETURN_IF_ERROR(immutable_state_.Initialize(graph));
-    kernel_stats_.Initialize(immutable_state_.graph_view());
+    kernel_stats_.Initialize(immutable_state_.graph_view(),
+                             UseAdaptiveInlining());
+    batch_async_completions_ = UseBatchedAsyncCompletions();
     return absl::OkStatus();
   }
 
@@ -166,15 +206,27 @@ class ExecutorImpl : public Executor {
    public:
     KernelStats() = default;
 
-    void Initialize(const GraphView& gview) {
-      is_expensive_.resize(gview.num_nodes());
+    // If `adaptive` is true, the cost of every synchronous kernel is tracked,
+    // and kernels start out "inexpensive" unless kernel->IsExpensive() is
+    // true. Otherwise only kernels for which IsExpensive() returns true are
+    // tracked, and all other kernels are always inlined.
+    void Initialize(const GraphView& gview, bool adaptive) {
+      tracks_cost_.resize(gview.num_nodes());
       cost_estimates_ =
           std::make_unique<std::atomic_uint_fast64_t[]>(gview.num_nodes());
       for (int32_t i = 0; i < gview.num_nodes(); ++i) {
-        if (gview.node(i)) {
-          is_expensive_[i] =
-              gview.node(i)->kernel && gview.node(i)->kernel->IsExpensive();
-          cost_estimates_[i] = kInitialCostEstimateCycles;
+        const NodeItem* item = gview.node(i);
+        if (item) {
+          const bool has_expensive_marker =
+              item->kernel && item->kernel->IsExpensive();
+          if (adaptive && item->kernel && !item->kernel_is_async) {
+            tracks_cost_[i] = true;
+            cost_estimates_[i] =
+                has_expensive_marker ? kInitialCostEstimateCycles : 0;
+          } else {
+            tracks_cost_[i] = has_expensive_marker;
+            cost_estimates_[i] = kInitialCostEstimateCycles;
+          }
         }
       }
     }
@@ -183,20 +235,21 @@ class ExecutorImpl : public Executor {
     // executor uses this flag to optimize graph execution, for example
     // by "inlining" inexpensive kernels.
     bool IsExpensive(const NodeItem& node) const {
-      return is_expensive_[node.node_id] &&
+      return tracks_cost_[node.node_id] &&
              (cost_estimates_[node.node_id].load(std::memory_order_relaxed) >
               kOpIsExpensiveThresholdCycles);
     }
 
-    // Returns the value of kernel->IsExpensive().
-    bool HasExpensiveMarker(const NodeItem& node) const {
-      return is_expensive_[node.node_id];
+    // Returns true iff the executor should measure the given node's execution
+    // time and pass it to UpdateCostEstimate().
+    bool TracksCost(const NodeItem& node) const {
+      return tracks_cost_[node.node_id];
     }
 
     // Updates the dynamic cost estimate, which is used to determine whether the
     // given node is expensive. The new cost estimate is a weighted average of
     // the old cost estimate and the latest cost. We only update cost estimates
-    // for kernels for which IsExpensive() return true.
+    // for kernels for which TracksCost() returns true.
     void UpdateCostEstimate(const NodeItem& node, uint64 elapsed_cycles) {
       // N.B. Updates to `cost_estimate` are atomic but unlocked.  Simultaneous
       // updates may result in one or more updates being ignored.  This does not
@@ -218,13 +271,16 @@ class ExecutorImpl : public Executor {
     static constexpr uint64 kOpIsExpensiveThresholdCycles = 8000;
     static constexpr uint64 kCostDecay = 10;
 
-    std::vector<bool> is_expensive_;
-    // std::unique_ptr<std::atomic<bool>[]> is_expensive_;
+    std::vector<bool> tracks_cost_;
     std::unique_ptr<std::atomic_uint_fast64_t[]> cost_estimates_;
   };
 
   ImmutableExecutorState immutable_state_;
   KernelStats kernel_stats_;
+  // If true, ready nodes are dispatched through a per-step
+  // `WorkStealingReadyQueue` instead of one `runner` closure per node.
+  const bool use_work_stealing_;
+  bool batch_async_completions_ = false;
 
   ExecutorImpl(const ExecutorImpl&) = delete;
   void operator=(const ExecutorImpl&) = delete;
@@ -284,7 +340,9 @@ class ExecutorState {
  public:
   ExecutorState(const Executor::Args& args,
                 const ImmutableExecutorState& immutable_state_,
-                ExecutorImpl::KernelStats* kernel_stats_);
+                ExecutorImpl::KernelStats* kernel_stats_,
+                bool use_work_stealing = false,
+                bool batch_async_completions = false);
   ~ExecutorState();
 
   void RunAsync(Executor::DoneCallback done);
@@ -298,6 +356,36 @@ class ExecutorState {
 
   struct AsyncState;
 
+  // An asynchronous node that completed successfully, and whose outputs have
+  // not been propagated yet.
+  struct AsyncCompletion {
+    TaggedNode tagged_node;
+    EntryVector outputs;
+  };
+
+  // A ready node waiting in `work_stealing_queue_`.
+  struct ReadyNode {
+    TaggedNode tagged_node;
+    int64_t scheduled_nsec;
+  };
+
+  // Buffers that `ProcessInline()` reuses across calls on the same thread, so
+  // that dispatching a node does not allocate in the steady state. Calls can
+  // nest (e.g. through an inline runner), so each thread keeps a free list.
+  struct ProcessScratch {
+    TaggedNodeSeq ready;
+    TensorValueVec inputs;
+    AllocatorAttributeVec input_alloc_attrs;
+    EntryVector outputs;
+    OpKernelContext::Params params;
+  };
+
+  // Returns a `ProcessScratch` with empty buffers and default `params`, taking
+  // it from the calling thread's free list if possible.
+  static std::unique_ptr<ProcessScratch> AcquireProcessScratch();
+  // Returns `scratch` to the calling thread's free list.
+  static void ReleaseProcessScratch(std::unique_ptr<ProcessScratch> scratch);
+
   // Process a ready node in current thread.
   void Process(const TaggedNode& node, int64_t scheduled_nsec);
 
@@ -312,6 +400,12 @@ class ExecutorState {
                     NodeExecStatsInterface* stats,
                     activity_watcher::ActivityId activity_id);
   void ProcessNoop(NodeExecStatsInterface* stats);
+  void RecordForwardedInputBytes(const OpKernelContext& ctx) {
+    const int64_t num_bytes = ctx.forwarded_input_bytes();
+    if (num_bytes > 0) {
+      forwarded_input_bytes_.fetch_add(num_bytes, std::memory_order_relaxed);
+    }
+  }
   void ProcessConstTensor(const NodeItem& item, EntryVector* outputs,
                           NodeExecStatsInterface* stats);
 
@@ -341,12 +435,28 @@ class ExecutorState {
   // REQUIRES: `!ready->empty()`.
   void ScheduleReady(TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready);
 
+  // Like NodeDone() for `num_nodes` nodes that completed successfully, whose
+  // stats have already been recorded, and which together made the nodes in
+  // `*ready` ready. Schedules all of `*ready` on other threads.
+  bool NodesDone(int64_t num_nodes, TaggedNodeSeq* ready);
+
+  // Queues the outputs of a successfully completed asynchronous node. If no
+  // other thread is propagating queued completions, propagates them, and any
+  // that are queued in the meantime, in batches.
+  void EnqueueAsyncCompletion(const TaggedNode& tagged_node,
+                              EntryVector outputs);
+
   // A wrapper for runner_ to keep track of the pending queue length. Op
   // execution should dispatch work using this function instead of using runner_
   // directly.
   template <typename Closure>
   void RunTask(Closure&& c, int sample_rate = 0);
 
+  // Dispatches each node in `[begin, end)` to another thread, either through
+  // `work_stealing_queue_` if it is enabled, or with one RunTask() per node.
+  template <typename Iterator>
+  void RunNodes(Iterator begin, Iterator end, int64_t scheduled_nsec);
+
   // Clean up when this executor is done.
   void Finish();
   void ScheduleFinish();
@@ -381,6 +491,8 @@ class ExecutorState {
   TensorStore* tensor_store_;
   // Step-local container.
   ScopedStepContainer* step_container_;
+  Allocator* const step_arena_allocator_;
+  Allocator* const device_allocator_;
   StepStatsCollectorInterface* const stats_collector_;
   const tsl::tracing::EventCollector* const event_collector_;
   Context context_;
@@ -402,11 +514,29 @@ class ExecutorState {
 
   PropagatorStateType propagator_;
 
+  // If not null, expensive ready nodes are pushed onto per-worker deques and
+  // drained by at most one worker per inter-op thread, which steal from each
+  // other when they run dry.
+  std::shared_ptr<WorkStealingReadyQueue<ReadyNode>> work_stealing_queue_;
+
   // Invoked when the execution finishes.
   Executor::DoneCallback done_cb_;
 
+  // If true, completions of asynchronous kernels go through
+  // EnqueueAsyncCompletion().
+  const bool batch_async_completions_;
+  mutex async_completions_mu_;
+  std::vector<AsyncCompletion> async_completions_
+      TF_GUARDED_BY(async_completions_mu_);
+  bool draining_async_completions_ TF_GUARDED_BY(async_completions_mu_) =
+      false;
+
   std::atomic_int_fast32_t num_outstanding_ops_;
 
+  // Bytes of input buffers that the kernels of this step forwarded to their
+  // outputs.
+  std::atomic<int64_t> forwarded_input_bytes_{0};
+
   // Available via OpKernelContext to every OpKernel invocation.
   mutex num_deferred_ops_mu_;
   int64_t num_deferred_ops_ TF_GUARDED_BY(num_deferred_ops_mu_) = 0;
@@ -420,7 +550,8 @@ class ExecutorState {
 template <class PropagatorStateType>
 ExecutorState<PropagatorStateType>::ExecutorState(
     const Executor::Args& args, const ImmutableExecutorState& immutable_state,
-    ExecutorImpl::KernelStats* kernel_stats)
+    ExecutorImpl::KernelStats* kernel_stats, bool use_work_stealing,
+    bool batch_async_completions)
     : vlog_(VLOG_IS_ON(1)),
       log_memory_(LogMemory::IsEnabled()),
       step_id_(args.step_id),
@@ -435,6 +566,8 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       session_metadata_(immutable_state.params().session_metadata),
       tensor_store_(args.tensor_store),
       step_container_(args.step_container),
+      step_arena_allocator_(args.step_arena_allocator),
+      device_allocator_(args.device_allocator),
       stats_collector_(args.stats_collector),
       event_collector_(tsl::tracing::GetEventCollector(
           tsl::tracing::EventCategory::kCompute)),
@@ -450,12 +583,24 @@ ExecutorState<PropagatorStateType>::ExecutorState(
       sync_on_finish_(args.sync_on_finish),
       run_all_kernels_inline_(args.run_all_kernels_inline),
       propagator_(immutable_state, step_id_, vlog_),
+      batch_async_completions_(batch_async_completions),
       num_outstanding_ops_(0) {
   if (args.user_intra_op_threadpool != nullptr) {
     Device* device = immutable_state_.params().device;
     user_device_ = RenamedDevice::NewRenamedDevice(
         device->name(), device, false, false, args.user_intra_op_threadpool);
   }
+  if (use_work_stealing && !run_all_kernels_inline_) {
+    int num_workers = port::MaxParallelism();
+    if (session_config_ != nullptr &&
+        session_config_->inter_op_parallelism_threads() > 0) {
+      num_workers = session_config_->inter_op_parallelism_threads();
+    }
+    work_stealing_queue_ = WorkStealingReadyQueue<ReadyNode>::Create(
+        num_workers, runner_, [this](ReadyNode node) {
+          Process(node.tagged_node, node.scheduled_nsec);
+        });
+  }
 }
 
 template <class PropagatorStateType>
@@ -490,6 +635,26 @@ void ExecutorState<PropagatorStateType>::RunTask(Closure&& c, int sample_rate) {
   });
 }
 
+template <class PropagatorStateType>
+template <typename Iterator>
+void ExecutorState<PropagatorStateType>::RunNodes(Iterator begin, Iterator end,
+                                                  int64_t scheduled_nsec) {
+  if (work_stealing_queue_) {
+    absl::InlinedVector<ReadyNode, 8> nodes;
+    nodes.reserve(std::distance(begin, end));
+    for (auto it = begin; it != end; ++it) {
+      nodes.push_back(ReadyNode{*it, scheduled_nsec});
+    }
+    work_stealing_queue_->Push(nodes);
+    return;
+  }
+  const int sample_rate = std::distance(begin, end);
+  for (auto it = begin; it != end; ++it) {
+    RunTask(std::bind(&ExecutorState::Process, this, *it, scheduled_nsec),
+            sample_rate);
+  }
+}
+
 template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::RunAsync(Executor::DoneCallback done) {
   TaggedNodeSeq ready;
@@ -605,12 +770,14 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
         },
         tsl::profiler::GetTFTraceMeLevel(is_expensive));
     device->Compute(op_kernel, &ctx);
-  } else if (kernel_stats_->HasExpensiveMarker(item)) {
+  } else if (kernel_stats_->TracksCost(item)) {
     KernelTimer timer;
     device->Compute(op_kernel, &ctx);
     // For expensive kernels, always update the cost estimate. For inexpensive
     // kernels, update the cost estimate with ~1/16 probability. This assumes
     // that the last 4 bits of the CPU cycle count is uniformly distributed.
+    // In adaptive mode, the sampled updates are what lets an inlined kernel
+    // that turns out to be costly move back to the inter-op threadpool.
     constexpr int kKernelExecutionTrackingInvocationSkipCount = 16;
     if (is_expensive ||
         timer.start_cycles % kKernelExecutionTrackingInvocationSkipCount == 0) {
@@ -623,6 +790,7 @@ Status ExecutorState<PropagatorStateType>::ProcessSync(
   if (outputs->size() < item.num_outputs) outputs->resize(item.num_outputs);
   s = ProcessOutputs(item, &ctx, outputs->data(), stats);
   nodestats::SetMemory(stats, &ctx);
+  RecordForwardedInputBytes(ctx);
   return s;
 }
 
@@ -679,6 +847,7 @@ void ExecutorState<PropagatorStateType>::ProcessAsync(
       Status s =
           ProcessOutputs(*state->item, &state->ctx, outputs.data(), stats);
       nodestats::SetMemory(stats, &state->ctx);
+      RecordForwardedInputBytes(state->ctx);
       if (vlog_) {
         VLOG(2) << "Async kernel done: " << state->item->node_id << " step "
                 << step_id_ << " "
@@ -694,6 +863,17 @@ void ExecutorState<PropagatorStateType>::ProcessAsync(
       }
       propagator_.MaybeMarkCompleted(state->tagged_node);
       activity_watcher::ActivityEnd(activity_id);
+      if (batch_async_completions_ && s.ok()) {
+        if (stats) {
+          nodestats::SetAllEnd(stats);
+          DCHECK_NE(stats_collector_, nullptr);
+          stats->Done(device->name());
+        }
+        const TaggedNode tagged_node = state->tagged_node;
+        delete state;
+        EnqueueAsyncCompletion(tagged_node, std::move(outputs));
+        return;
+      }
       TaggedNodeSeq ready;
       if (s.ok()) {
         propagator_.PropagateOutputs(state->tagged_node, &outputs, &ready);
@@ -741,14 +921,15 @@ template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::ProcessInline(
     TaggedNodeReadyQueue* inline_ready, int64_t scheduled_nsec) {
   WithContext wc(context_);
-  auto ready = std::make_unique<TaggedNodeSeq>();
+  std::unique_ptr<ProcessScratch> scratch = AcquireProcessScratch();
+  TaggedNodeSeq* ready = &scratch->ready;
 
   // Parameters passed to OpKernel::Compute.
-  auto inputs = std::make_unique<TensorValueVec>();
+  TensorValueVec* inputs = &scratch->inputs;
 
-  AllocatorAttributeVec input_alloc_attrs;
+  AllocatorAttributeVec& input_alloc_attrs = scratch->input_alloc_attrs;
 
-  auto params = std::make_unique<OpKernelContext::Params>();
+  OpKernelContext::Params* params = &scratch->params;
 
   params->step_id = step_id_;
   // Override device's threadpool if user provides an intra_op_threadpool
@@ -775,6 +956,7 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
   params->function_library = immutable_state_.params().function_library;
   params->resource_manager = device->resource_manager();
   params->step_container = step_container_;
+  params->device_allocator = device_allocator_;
   params->slice_reader_cache = slice_reader_cache_;
   params->runner = &runner_;
   params->run_all_kernels_inline = run_all_kernels_inline_;
@@ -804,7 +986,7 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
   Status s;
   NodeExecStatsInterface* stats = nullptr;
 
-  EntryVector outputs(1);
+  EntryVector& outputs = scratch->outputs;
 
   bool completed = false;
   int64_t last_iter_num = -1;
@@ -897,7 +1079,7 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
     } else {
       // Prepares inputs.
       bool is_input_dead = false;
-      s = PrepareInputs(item, first_input, inputs.get(), &input_alloc_attrs,
+      s = PrepareInputs(item, first_input, inputs, &input_alloc_attrs,
                         &is_input_dead);
       if (!s.ok()) {
         // Clear inputs.
@@ -908,16 +1090,23 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
         propagator_.MaybeMarkCompleted(tagged_node);
         activity_watcher::ActivityEnd(activity_id);
         // Continue to process the nodes in 'inline_ready'.
-        completed = NodeDone(s, ready.get(), stats, inline_ready);
+        completed = NodeDone(s, ready, stats, inline_ready);
         continue;
       }
 
       // Set up compute params.
       params->op_kernel = item.kernel;
+      DeviceContext* node_device_context =
+          immutable_state_.device_context(item.node_id);
+      params->op_device_context = node_device_context != nullptr
+                                      ? node_device_context
+                                      : device_context_;
       params->frame_iter = propagator_.GetFrameAndIter(tagged_node);
       params->is_input_dead = is_input_dead;
       params->output_attr_array = item.output_attrs();
       params->forward_from_array = item.forward_from();
+      params->step_allocator =
+          item.may_use_step_arena ? step_arena_allocator_ : nullptr;
       params->outputs_required_array = item.outputs_required.get();
       params->inputs = *inputs;
       params->input_alloc_attrs = input_alloc_attrs;
@@ -927,7 +1116,7 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
                      activity_id);
         launched_asynchronously = true;
       } else {
-        s = ProcessSync(item, params.get(), &outputs, stats);
+        s = ProcessSync(item, params, &outputs, stats);
       }
     }
 
@@ -949,7 +1138,7 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
       activity_watcher::ActivityEnd(activity_id);
       // Propagates outputs.
       if (s.ok()) {
-        propagator_.PropagateOutputs(tagged_node, &outputs, ready.get());
+        propagator_.PropagateOutputs(tagged_node, &outputs, ready);
       }
 
       // Clear outputs without deallocating the `outputs` vector.
@@ -962,14 +1151,49 @@ void ExecutorState<PropagatorStateType>::ProcessInline(
         scheduled_nsec = nodestats::NowInNsec();
       }
       // Postprocess.
-      completed = NodeDone(s, ready.get(), stats, inline_ready);
+      completed = NodeDone(s, ready, stats, inline_ready);
     }
   }  // while !inline_ready.empty()
 
+  ReleaseProcessScratch(std::move(scratch));
+
   // This thread of computation is done if completed = true.
   if (completed) ScheduleFinish();
 }
 
+template <class PropagatorStateType>
+std::unique_ptr<typename ExecutorState<PropagatorStateType>::ProcessScratch>
+ExecutorState<PropagatorStateType>::AcquireProcessScratch() {
+  auto& free_list = ProcessScratchFreeList<ProcessScratch>();
+  if (free_list.empty()) {
+    auto scratch = std::make_unique<ProcessScratch>();
+    // `ProcessConstTensor()` writes the first output without resizing.
+    scratch->outputs.resize(1);
+    return scratch;
+  }
+  std::unique_ptr<ProcessScratch> scratch = std::move(free_list.back());
+  free_list.pop_back();
+  scratch->params = OpKernelContext::Params();
+  return scratch;
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::ReleaseProcessScratch(
+    std::unique_ptr<ProcessScratch> scratch) {
+  scratch->ready.clear();
+  scratch->inputs.clear();
+  scratch->input_alloc_attrs.clear();
+  for (Entry& output : scratch->outputs) output.ClearVal();
+  // The GPU device wrapper is bound to the device of this call, so it is not
+  // reused by a later call, which may run on another device.
+  delete scratch->params.eigen_gpu_device;
+  scratch->params.eigen_gpu_device = nullptr;
+  auto& free_list = ProcessScratchFreeList<ProcessScratch>();
+  if (free_list.size() < kMaxFreeProcessScratch) {
+    free_list.push_back(std::move(scratch));
+  }
+}
+
 template <class PropagatorStateType>
 Status ExecutorState<PropagatorStateType>::PrepareInputs(
     const NodeItem& item, Entry* first_input, TensorValueVec* inputs,
@@ -1264,6 +1488,67 @@ bool ExecutorState<PropagatorStateType>::NodeDone(
   }
 }
 
+template <class PropagatorStateType>
+bool ExecutorState<PropagatorStateType>::NodesDone(int64_t num_nodes,
+                                                   TaggedNodeSeq* ready) {
+  const int64_t ready_size = ready->size();
+  if (ready_size == 0) {
+    return num_outstanding_ops_.fetch_sub(num_nodes) == num_nodes;
+  }
+  // The ready nodes are outstanding, so the counter cannot reach zero here.
+  if (ready_size > num_nodes) {
+    num_outstanding_ops_.fetch_add(ready_size - num_nodes,
+                                   std::memory_order_relaxed);
+  } else if (ready_size < num_nodes) {
+    num_outstanding_ops_.fetch_sub(num_nodes - ready_size,
+                                   std::memory_order_relaxed);
+  }
+  ScheduleReady(ready, nullptr);
+  return false;
+}
+
+template <class PropagatorStateType>
+void ExecutorState<PropagatorStateType>::EnqueueAsyncCompletion(
+    const TaggedNode& tagged_node, EntryVector outputs) {
+  {
+    mutex_lock l(async_completions_mu_);
+    async_completions_.push_back({tagged_node, std::move(outputs)});
+    // The draining thread will pick this completion up.
+    if (draining_async_completions_) return;
+    draining_async_completions_ = true;
+  }
+  std::vector<AsyncCompletion> batch;
+  TaggedNodeSeq ready;
+  bool completed = false;
+  while (true) {
+    {
+      mutex_lock l(async_completions_mu_);
+      if (async_completions_.empty()) {
+        draining_async_completions_ = false;
+        break;
+      }
+      batch.swap(async_completions_);
+    }
+    tsl::profiler::TraceMe activity(
+        [&]() {
+          return strings::StrCat("ExecutorState::EnqueueAsyncCompletion#",
+                                 "batch_size=", batch.size(), "#");
+        },
+        tsl::profiler::GetTFTraceMeLevel(/*is_expensive=*/false));
+    for (AsyncCompletion& completion : batch) {
+      propagator_.PropagateOutputs(completion.tagged_node, &completion.outputs,
+                                   &ready);
+      completion.outputs.clear();
+    }
+    const int64_t num_nodes = batch.size();
+    batch.clear();
+    // If this is the last batch of the step, no further completions can be
+    // queued, and the next iteration exits the loop.
+    completed = NodesDone(num_nodes, &ready);
+  }
+  if (completed) ScheduleFinish();
+}
+
 template <class PropagatorStateType>
 void ExecutorState<PropagatorStateType>::ScheduleReady(
     TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready) {
@@ -1304,10 +1589,7 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
     TaggedNodeSeq expensive_nodes;
     if (inline_ready == nullptr) {
       // Schedule to run all the ready ops in thread pool.
-      for (auto& tagged_node : *ready) {
-        RunTask([=]() { Process(tagged_node, scheduled_nsec); },
-                /*sample_rate=*/ready->size());
-      }
+      RunNodes(ready->begin(), ready->end(), scheduled_nsec);
     } else {
       for (auto& tagged_node : *ready) {
         const NodeItem& item = *tagged_node.node_item;
@@ -1332,12 +1614,13 @@ void ExecutorState<PropagatorStateType>::ScheduleReady(
       }
     }
     if (!expensive_nodes.empty()) {
-      if (expensive_nodes.size() < kInlineScheduleReadyThreshold) {
-        for (auto& tagged_node : expensive_nodes) {
-          RunTask(std::bind(&ExecutorState::Process, this, tagged_node,
-                            scheduled_nsec),
-                  /*sample_rate=*/expensive_nodes.size());
-        }
+      if (work_stealing_queue_ ||
+          expensive_nodes.size() < kInlineScheduleReadyThreshold) {
+        // NOTE: The work-stealing queue enqueues all nodes with a single
+        // push, and spreads them across workers by stealing, so it does not
+        // need to split large batches.
+        RunNodes(expensive_nodes.begin(), expensive_nodes.end(),
+                 scheduled_nsec);
       } else {
         // There are too many ready expensive nodes. Schedule them in child
         // threads.
@@ -1403,11 +1686,29 @@ void ExecutorState<PropagatorStateType>::Finish() {
   auto done_cb = std::move(done_cb_);
   auto runner = std::move(runner_);
   mu_.unlock();
+  const int64_t forwarded_input_bytes =
+      forwarded_input_bytes_.load(std::memory_order_relaxed);
+  if (forwarded_input_bytes > 0) {
+    metrics::RecordGraphForwardedInputBytes(forwarded_input_bytes);
+  }
   int64_t trace_id = trace_id_;
   int64_t step_id = step_id_;
   CHECK(done_cb != nullptr);
   Device* device = immutable_state_.params().device;
 
+  // Sample the fragmentation of the device allocator on every 256 steps. This
+  // amortizes the cost of locking the allocator across steps.
+  alignas(64) static std::atomic<int64_t> num_finished_steps{0};
+  if (num_finished_steps.fetch_add(1, std::memory_order_relaxed) % 256 == 0) {
+    Allocator* allocator = device->GetAllocator(AllocatorAttributes());
+    std::optional<AllocatorStats> stats = allocator->GetStats();
+    if (stats && stats->pool_bytes) {
+      metrics::UpdateAllocatorFragmentation(
+          allocator->Name(), *stats->pool_bytes - stats->bytes_in_use,
+          stats->largest_free_block_bytes);
+    }
+  }
+
   if (vlog_ && !status.ok() && VLOG_IS_ON(1)) {
     // Logs verbose information about the current state of active and pending
     // nodes in the propagator.
@@ -1518,11 +1819,21 @@ void ExecutorImpl::RunAsyncInternal(const Args& args, DoneCallback done) {
                                                &kernel_stats_))
         ->RunAsync(std::move(done));
   } else if (immutable_state_.requires_control_flow_support()) {
-    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_))
+    (new ExecutorState<PropagatorState>(args, immutable_state_, &kernel_stats_,
+                                        use_work_stealing_,
+                                        batch_async_completions_))
+        ->RunAsync(std::move(done));
+  } else if (args.run_all_kernels_inline &&
+             !immutable_state_.straight_line_plan().empty()) {
+    // All kernels run one at a time on the same thread, so walk the
+    // precomputed topological order instead of tracking pending counts.
+    (new ExecutorState<StraightLinePropagatorState>(args, immutable_state_,
+                                                    &kernel_stats_))
         ->RunAsync(std::move(done));
   } else {
-    (new ExecutorState<SimplePropagatorState>(args, immutable_state_,
-                                              &kernel_stats_))
+    (new ExecutorState<SimplePropagatorState>(
+         args, immutable_state_, &kernel_stats_, use_work_stealing_,
+         batch_async_completions_))
         ->RunAsync(std::move(done));
   }
 }
@@ -1576,6 +1887,29 @@ class DefaultExecutorRegistrar {
 };
 static DefaultExecutorRegistrar registrar;
 
+// Registers an executor that dispatches expensive ready nodes through
+// per-worker deques with work stealing. Enabled by setting
+// `ConfigProto.experimental.executor_type` to "WORK_STEALING".
+class WorkStealingExecutorRegistrar {
+ public:
+  WorkStealingExecutorRegistrar() {
+    ExecutorFactory::Register("WORK_STEALING", new Factory);
+  }
+
+ private:
+  class Factory : public ExecutorFactory {
+    Status NewExecutor(const LocalExecutorParams& params, const Graph& graph,
+                       std::unique_ptr<Executor>* out_executor) override {
+      auto impl =
+          std::make_unique<ExecutorImpl>(params, /*use_work_stealing=*/true);
+      TF_RETURN_IF_ERROR(impl->Initialize(graph));
+      *out_executor = std::move(impl);
+      return absl::OkStatus();
+    }
+  };
+};
+static WorkStealingExecutorRegistrar work_stealing_registrar;
+
 }  // namespace
 
 }  // namespace tensorflow
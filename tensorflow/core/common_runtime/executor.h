@@ -107,6 +107,12 @@ class Executor {
     string session_handle;
     TensorStore* tensor_store = nullptr;
     ScopedStepContainer* step_container = nullptr;
+    // If not null, serves the host allocations of kernels whose outputs are
+    // not expected to escape the step. Must outlive the step.
+    Allocator* step_arena_allocator = nullptr;
+    // If not null, serves the device memory allocations of all kernels in
+    // place of the device's allocator. Must outlive the step.
+    Allocator* device_allocator = nullptr;
     CollectiveExecutor* collective_executor = nullptr;
     thread::ThreadPoolInterface* user_intra_op_threadpool = nullptr;
     tsl::CoordinationServiceAgent* coordination_service_agent = nullptr;
@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/executor.h"
 
 #include <algorithm>
+#include <atomic>
 
 #include "tensorflow/cc/framework/ops.h"
 #include "tensorflow/cc/ops/array_ops.h"
@@ -25,11 +26,13 @@ limitations under the License.
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
 #include "tensorflow/core/common_runtime/lower_functional_ops.h"
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/local_rendezvous.h"
 #include "tensorflow/core/framework/op.h"
@@ -76,8 +79,11 @@ class ExecutorTest : public ::testing::Test {
     delete exec_;
   }
 
-  // Resets executor_ with a new executor based on a graph 'gdef'.
-  void Create(std::unique_ptr<const Graph> graph) {
+  // Resets executor_ with a new executor based on a graph 'gdef'. If
+  // `executor_type` is not empty, the executor is created through the
+  // ExecutorFactory registered under that name.
+  void Create(std::unique_ptr<const Graph> graph,
+              const string& executor_type = "") {
     const int version = graph->versions().producer();
     LocalExecutorParams params;
     params.device = device_.get();
@@ -92,7 +98,13 @@ class ExecutorTest : public ::testing::Test {
     };
     rendez_ = NewLocalRendezvous();
     delete exec_;
-    TF_CHECK_OK(NewLocalExecutor(params, *graph, &exec_));
+    if (executor_type.empty()) {
+      TF_CHECK_OK(NewLocalExecutor(params, *graph, &exec_));
+    } else {
+      std::unique_ptr<Executor> executor;
+      TF_CHECK_OK(NewExecutor(executor_type, params, *graph, &executor));
+      exec_ = executor.release();
+    }
     runner_ = [this](std::function<void()> fn) { thread_pool_->Schedule(fn); };
   }
 
@@ -215,6 +227,55 @@ TEST_F(ExecutorTest, SelfAdd) {
   EXPECT_EQ(1024.0, V(out));  // b=v10=2*v9=4*v8=...=1024*a=1024.0
 }
 
+// Counts the allocations that are passed through to the wrapped allocator.
+class CountingAllocator : public AllocatorWrapper {
+ public:
+  explicit CountingAllocator(Allocator* wrapped) : AllocatorWrapper(wrapped) {}
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++num_allocations_;
+    return AllocatorWrapper::AllocateRaw(alignment, num_bytes);
+  }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override {
+    ++num_allocations_;
+    return AllocatorWrapper::AllocateRaw(alignment, num_bytes,
+                                         allocation_attr);
+  }
+
+  int num_allocations() const { return num_allocations_; }
+
+ private:
+  std::atomic<int> num_allocations_{0};
+};
+
+TEST_F(ExecutorTest, DeviceAllocator) {
+  // b <- (a + a) + (a + a)
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto v = test::graph::Recv(g.get(), "a", "float", ALICE, 1, BOB);
+  v = test::graph::Add(g.get(), v, v);
+  v = test::graph::Add(g.get(), v, v);
+  test::graph::Send(g.get(), v, "b", BOB, 1, ALICE);
+  Create(std::move(g));
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  CountingAllocator allocator(device_->GetAllocator(AllocatorAttributes()));
+  Executor::Args exec_args;
+  exec_args.rendezvous = rendez_;
+  exec_args.runner = runner_;
+  exec_args.device_allocator = &allocator;
+  TF_ASSERT_OK(exec_->Run(exec_args));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(4.0, V(out));
+  // Neither addition can forward its input, which it reads twice.
+  EXPECT_EQ(2, allocator.num_allocations());
+}
+
 // Builds a graph which adds N copies of one variable "in". I.e.,
 //     a + a + a + ... + a
 // The returned graph is parenthesized ramdonly. I.e.,
@@ -265,6 +326,115 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+TEST_F(ExecutorTest, RandomTreeRunAllKernelsInline) {
+  // A loop-free graph with only synchronous kernels is run from the
+  // executor's straight-line plan when all kernels are run inline.
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  auto in = test::graph::Constant(g.get(), V(1.0));
+  std::vector<Node*> nodes;
+  for (int i = 0; i < 256; ++i) {
+    nodes.push_back(test::graph::Identity(g.get(), in, 0));
+  }
+  while (nodes.size() > 1) {
+    std::vector<Node*> sums;
+    for (int i = 0; i + 1 < nodes.size(); i += 2) {
+      sums.push_back(test::graph::Add(g.get(), nodes[i], nodes[i + 1]));
+    }
+    nodes = std::move(sums);
+  }
+  test::graph::Send(g.get(), nodes[0], "b", BOB, 1, ALICE);
+  Create(std::move(g));
+  Rendezvous::Args args;
+  for (int i = 0; i < 3; ++i) {
+    Executor::Args exec_args;
+    exec_args.rendezvous = rendez_;
+    exec_args.runner = runner_;
+    exec_args.run_all_kernels_inline = true;
+    TF_ASSERT_OK(exec_->Run(exec_args));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out,
+                               &is_dead));
+    EXPECT_EQ(256.0, V(out));
+  }
+}
+
+TEST_F(ExecutorTest, RandomTreeWorkStealing) {
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g), "WORK_STEALING");
+  Rendezvous::Args args;
+  for (int i = 0; i < 3; ++i) {
+    TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args,
+                               V(1.0), false));
+    TF_ASSERT_OK(Run(rendez_));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out,
+                               &is_dead));
+    EXPECT_EQ(4096.0, V(out));
+  }
+}
+
+TEST_F(ExecutorTest, RandomTreeAdaptiveInlining) {
+  setenv("TF_EXECUTOR_ADAPTIVE_INLINING", "1", /*overwrite=*/1);
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g));
+  unsetenv("TF_EXECUTOR_ADAPTIVE_INLINING");
+  Rendezvous::Args args;
+  // Run enough steps for the sampled cost estimates to be updated.
+  for (int i = 0; i < 20; ++i) {
+    TF_ASSERT_OK(rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args,
+                               V(1.0), false));
+    TF_ASSERT_OK(Run(rendez_));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out,
+                               &is_dead));
+    EXPECT_EQ(4096.0, V(out));
+  }
+}
+
+TEST_F(ExecutorTest, ManyRecvsBatchedAsyncCompletions) {
+  setenv("TF_EXECUTOR_BATCH_ASYNC_COMPLETIONS", "1", /*overwrite=*/1);
+  constexpr int kNumRecvs = 256;
+  auto g = std::make_unique<Graph>(OpRegistry::Global());
+  std::vector<Node*> nodes;
+  for (int i = 0; i < kNumRecvs; ++i) {
+    nodes.push_back(test::graph::Recv(g.get(), strings::StrCat("a", i),
+                                      "float", ALICE, 1, BOB));
+  }
+  while (nodes.size() > 1) {
+    std::vector<Node*> sums;
+    for (int i = 0; i + 1 < nodes.size(); i += 2) {
+      sums.push_back(test::graph::Add(g.get(), nodes[i], nodes[i + 1]));
+    }
+    nodes = std::move(sums);
+  }
+  test::graph::Send(g.get(), nodes[0], "b", BOB, 1, ALICE);
+  Create(std::move(g));
+  unsetenv("TF_EXECUTOR_BATCH_ASYNC_COMPLETIONS");
+  Rendezvous::Args args;
+  for (int step = 0; step < 3; ++step) {
+    // Complete the Recvs concurrently from the threads of the pool, so that
+    // completions are queued while others are being propagated.
+    for (int i = 0; i < kNumRecvs; ++i) {
+      thread_pool_->Schedule([this, i]() {
+        TF_CHECK_OK(rendez_->Send(
+            Key(ALICE, kIncarnation, BOB, strings::StrCat("a", i)),
+            Rendezvous::Args(), V(i), false));
+      });
+    }
+    TF_ASSERT_OK(Run(rendez_));
+    Tensor out = V(-1);
+    bool is_dead = false;
+    TF_ASSERT_OK(rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out,
+                               &is_dead));
+    EXPECT_EQ(kNumRecvs * (kNumRecvs - 1) / 2, V(out));
+  }
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
@@ -442,7 +612,8 @@ TEST_F(ExecutorTest, NoInputTensors) {
 // Create a graph that is 'depth' deep. At each level, fan-in and fan-out a
 // maximum of 'width' nodes. All nodes are no-ops and all dependencies are
 // control dependencies.
-static void BM_executor(::testing::benchmark::State& state) {
+static void BM_executor_helper(::testing::benchmark::State& state,
+                               const char* executor_type) {
   const int width = state.range(0);
   const int depth = state.range(1);
 
@@ -476,22 +647,39 @@ static void BM_executor(::testing::benchmark::State& state) {
   }
 
   FixupSourceAndSinkEdges(g);
-  test::Benchmark("cpu", g, /*old_benchmark_api=*/false).Run(state);
+  test::Benchmark("cpu", g, /*options=*/nullptr, /*init=*/nullptr,
+                  /*rendez=*/nullptr, executor_type,
+                  /*old_benchmark_api=*/false)
+      .Run(state);
 
   state.SetLabel(strings::StrCat("Nodes = ", cur));
   state.SetItemsProcessed(cur * static_cast<int64_t>(state.iterations()));
 }
 
+static void BM_executor(::testing::benchmark::State& state) {
+  BM_executor_helper(state, "");
+}
+
+// Same graphs as BM_executor, run with the work-stealing ready queue.
+static void BM_executor_work_stealing(::testing::benchmark::State& state) {
+  BM_executor_helper(state, "WORK_STEALING");
+}
+
 // Tall skinny graphs
 BENCHMARK(BM_executor)->UseRealTime()->ArgPair(16, 1024);
 BENCHMARK(BM_executor)->UseRealTime()->ArgPair(32, 8192);
+BENCHMARK(BM_executor_work_stealing)->UseRealTime()->ArgPair(16, 1024);
+BENCHMARK(BM_executor_work_stealing)->UseRealTime()->ArgPair(32, 8192);
 
 // Short fat graphs
 BENCHMARK(BM_executor)->UseRealTime()->ArgPair(1024, 16);
 BENCHMARK(BM_executor)->UseRealTime()->ArgPair(8192, 32);
+BENCHMARK(BM_executor_work_stealing)->UseRealTime()->ArgPair(1024, 16);
+BENCHMARK(BM_executor_work_stealing)->UseRealTime()->ArgPair(8192, 32);
 
 // Tall fat graph
 BENCHMARK(BM_executor)->UseRealTime()->ArgPair(1024, 1024);
+BENCHMARK(BM_executor_work_stealing)->UseRealTime()->ArgPair(1024, 1024);
 
 static void BM_const_identity(::testing::benchmark::State& state) {
   const int width = state.range(0);
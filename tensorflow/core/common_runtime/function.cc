@@ -44,6 +44,7 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/op_segment.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/graph/algorithm.h"
 #include "tensorflow/core/graph/control_flow.h"
@@ -936,9 +937,30 @@ Status FunctionLibraryRuntimeImpl::CreateItem(Item** item) {
           return CreateKernel(props, flr, kernel);
         };
   }
-  params.delete_kernel = [](OpKernel* kernel) {
-    DeleteNonCachedKernel(kernel);
-  };
+  if (config_ != nullptr && config_->experimental().share_stateless_kernels()) {
+    params.create_kernel =
+        [this, flr, create_kernel = std::move(params.create_kernel)](
+            const std::shared_ptr<const NodeProperties>& props,
+            OpKernel** kernel) {
+          if (!SharedKernelCache::ShouldShareKernel(flr, props->node_def)) {
+            return create_kernel(props, kernel);
+          }
+          return SharedKernelCache::Global()->FindOrCreate(
+              device_, graph_def_version_, props->node_def, kernel,
+              [&create_kernel, &props](OpKernel** kernel) {
+                return create_kernel(props, kernel);
+              });
+        };
+    params.delete_kernel = [](OpKernel* kernel) {
+      if (!SharedKernelCache::Global()->Release(kernel)) {
+        DeleteNonCachedKernel(kernel);
+      }
+    };
+  } else {
+    params.delete_kernel = [](OpKernel* kernel) {
+      DeleteNonCachedKernel(kernel);
+    };
+  }
   params.session_metadata = session_metadata_;
   std::unique_ptr<Executor> exec;
 
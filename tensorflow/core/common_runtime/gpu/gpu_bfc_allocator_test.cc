@@ -221,6 +221,27 @@ TEST_P(GPUBFCAllocatorTest, AllocatedVsRequested) {
   a.DeallocateRaw(t1);
 }
 
+TEST_P(GPUBFCAllocatorTest, LargestFreeBlock) {
+  GPUBFCAllocator a(GetParam()(1ull << 32), 1 << 30, "GPU_0_bfc", {});
+  void* p1 = a.AllocateRaw(1, 1 << 20);
+  void* p2 = a.AllocateRaw(1, 1 << 20);
+  void* p3 = a.AllocateRaw(1, 1 << 20);
+  a.DeallocateRaw(p2);
+  std::optional<AllocatorStats> stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  ASSERT_TRUE(stats->pool_bytes);
+  // The free chunk between p1 and p3 is at least 1MB.
+  EXPECT_GE(stats->largest_free_block_bytes, 1 << 20);
+  EXPECT_LE(stats->largest_free_block_bytes,
+            *stats->pool_bytes - stats->bytes_in_use);
+  a.DeallocateRaw(p1);
+  a.DeallocateRaw(p3);
+  stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  // All the memory coalesces into a single free chunk.
+  EXPECT_EQ(stats->largest_free_block_bytes, *stats->pool_bytes);
+}
+
 TEST_P(GPUBFCAllocatorTest, TestCustomMemoryLimit) {
   // Configure a 2MiB byte limit
   GPUBFCAllocator a(GetParam()(1ull << 32), 2 << 20, "GPU_0_bfc", {});
@@ -34,6 +34,7 @@ limitations under the License.
 #include <string.h>
 
 #include <algorithm>
+#include <atomic>
 #include <list>
 #include <map>
 #include <memory>
@@ -55,6 +56,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_device.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id_manager.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_process_state.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_util.h"
 #include "tensorflow/core/common_runtime/gpu_device_context.h"
 #include "tensorflow/core/common_runtime/local_device.h"
@@ -442,6 +444,71 @@ class BaseGPUDevice::StreamGroupFactory {
   void operator=(const StreamGroupFactory&) = delete;
 };
 
+// Holds on to the buffers freed on a device with several compute streams until
+// all compute streams have completed the work enqueued before the buffers were
+// freed. The wrapped allocator hands freed memory to the next allocation right
+// away, which is only safe if all kernels using the memory run on one stream.
+class BaseGPUDevice::StreamSafeAllocator : public AllocatorWrapper {
+ public:
+  StreamSafeAllocator(Allocator* wrapped, EventMgr* em,
+                      std::vector<se::Stream*> streams)
+      : AllocatorWrapper(wrapped), em_(em), streams_(std::move(streams)) {}
+
+  ~StreamSafeAllocator() override { Flush(); }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    Flush();
+    return wrapped()->AllocateRaw(alignment, num_bytes);
+  }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override {
+    // The wrapped allocator waits for deallocations when it runs out of
+    // memory, so hand the pending ones over first.
+    Flush();
+    return wrapped()->AllocateRaw(alignment, num_bytes, allocation_attr);
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    mutex_lock l(mu_);
+    pending_.push_back(ptr);
+  }
+
+  absl::optional<AllocatorStats> GetStats() override {
+    return wrapped()->GetStats();
+  }
+
+  bool ClearStats() override { return wrapped()->ClearStats(); }
+
+  // Returns the pending buffers to the wrapped allocator once all compute
+  // streams have completed the work enqueued so far.
+  void Flush() {
+    auto buffers = std::make_shared<std::vector<void*>>();
+    {
+      mutex_lock l(mu_);
+      if (pending_.empty()) return;
+      buffers->swap(pending_);
+    }
+    // The callbacks may run after the device is gone, so they must not refer
+    // to `this`.
+    Allocator* wrapped = this->wrapped();
+    auto remaining = std::make_shared<std::atomic<int>>(streams_.size());
+    for (se::Stream* stream : streams_) {
+      em_->ThenExecute(stream, [wrapped, buffers, remaining]() {
+        if (remaining->fetch_sub(1) == 1) {
+          for (void* ptr : *buffers) wrapped->DeallocateRaw(ptr);
+        }
+      });
+    }
+  }
+
+ private:
+  EventMgr* const em_;  // not owned
+  const std::vector<se::Stream*> streams_;
+  mutex mu_;
+  std::vector<void*> pending_ TF_GUARDED_BY(mu_);
+};
+
 BaseGPUDevice::BaseGPUDevice(const SessionOptions& options, const string& name,
                              Bytes memory_limit, const DeviceLocality& locality,
                              tsl::TfDeviceId tf_device_id,
@@ -476,14 +543,16 @@ BaseGPUDevice::BaseGPUDevice(const SessionOptions& options, const string& name,
 
 BaseGPUDevice::~BaseGPUDevice() {
   delete accelerator_device_info_;
-  if (scratch_) gpu_allocator_->DeallocateRaw(scratch_);
+  for (char* scratch : scratch_) gpu_allocator_->DeallocateRaw(scratch);
   device_context_->Unref();
+  mutex_lock l(context_map_mu_);
+  for (auto& item : stream_contexts_) item.second->Unref();
 }
 
 // This should be idempotent if already initialized.
 Status BaseGPUDevice::InitScratchBuffers() {
   mutex_lock l(scratch_init_mutex_);
-  if (!scratch_) {
+  while (scratch_.size() < streams_.size()) {
     DCHECK(stream_);
     size_t scratch_buffer_size = Eigen::kGpuScratchSize + sizeof(unsigned int);
     profiler::ScopedMemoryDebugAnnotation op_annotation("ScratchBuffer");
@@ -498,7 +567,7 @@ Status BaseGPUDevice::InitScratchBuffers() {
         se::DeviceMemoryBase(scratch_buffer, scratch_buffer_size));
     TF_RETURN_IF_ERROR(executor_->SynchronousMemZero(
         &mem, Eigen::kGpuScratchSize + sizeof(unsigned int)));
-    scratch_ = static_cast<char*>(scratch_buffer);
+    scratch_.push_back(static_cast<char*>(scratch_buffer));
   }
   return OkStatus();
 }
@@ -546,6 +615,7 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
   stream_ = StreamGroupFactory::Global().GetOrCreate(
       tf_device_id_, 0, executor_, options.config.gpu_options());
 #endif  // TF_GPU_USE_PJRT
+  streams_.push_back(stream_);
 
   // Get an allocator that allocates pinned memory on host.
   AllocatorAttributes attr;
@@ -589,6 +659,39 @@ Status BaseGPUDevice::Init(const SessionOptions& options) {
         timestamped_allocator_ ? gpu_allocator_ : nullptr, em_));
   }
 
+  int num_compute_streams =
+      options.config.gpu_options().experimental().num_compute_streams();
+#ifdef TF_GPU_USE_PJRT
+  if (num_compute_streams > 1) {
+    LOG(WARNING) << "Ignoring GPUOptions.experimental.num_compute_streams="
+                 << num_compute_streams << " because the streams are managed "
+                 << "by PJRT.";
+    num_compute_streams = 1;
+  }
+#endif  // TF_GPU_USE_PJRT
+  if (num_compute_streams > 1 && kernel_tracker_) {
+    LOG(WARNING) << "Ignoring GPUOptions.experimental.num_compute_streams="
+                 << num_compute_streams << " because the kernel tracker only "
+                 << "follows a single compute stream.";
+    num_compute_streams = 1;
+  }
+  if (num_compute_streams > 1) {
+    std::vector<se::Stream*> compute_streams = {stream_->compute};
+    for (int i = 1; i < num_compute_streams; ++i) {
+      StreamGroup* group = StreamGroupFactory::Global().GetOrCreate(
+          tf_device_id_, i, executor_, options.config.gpu_options());
+      if (group->compute == nullptr) {
+        return errors::Internal("Failed to create compute stream ", i,
+                                " for device ", tf_device_id_.value());
+      }
+      streams_.push_back(group);
+      compute_streams.push_back(group->compute);
+    }
+    stream_safe_allocator_ = std::make_unique<StreamSafeAllocator>(
+        gpu_allocator_, em_, std::move(compute_streams));
+    gpu_allocator_ = stream_safe_allocator_.get();
+  }
+
   accelerator_device_info_ = new DeviceBase::AcceleratorDeviceInfo;
   accelerator_device_info_->stream = stream_->compute;
   accelerator_device_info_->default_context = device_context_;
@@ -698,6 +801,15 @@ bool ShouldLogInputsAndOutputs(OpKernel* op_kernel) {
       *GetOpsToLogFromEnv();
   return ops_to_log.count(op_kernel->type_string());
 }
+
+// Makes the compute stream of `context` wait for the compute streams that
+// produce the inputs of its kernel.
+Status WaitForInputStreams(const GPUDeviceContext& context) {
+  for (se::Stream* wait_stream : context.wait_streams()) {
+    TF_RETURN_IF_ERROR(context.stream()->WaitFor(wait_stream));
+  }
+  return OkStatus();
+}
 }  // namespace
 
 Tensor BaseGPUDevice::CopyGpuTensorToHostDebugOnly(const Tensor& gpu_tensor) {
@@ -788,6 +900,11 @@ void BaseGPUDevice::Compute(OpKernel* op_kernel, OpKernelContext* context) {
   }
   std::unique_ptr<stream_executor::ActivateContext> scoped_activation =
       stream->parent()->Activate();
+  Status wait_status = WaitForInputStreams(*gpu_device_context);
+  if (!wait_status.ok()) {
+    context->SetStatus(wait_status);
+    return;
+  }
   profiler::ScopedMemoryDebugAnnotation op_annotation(
       op_kernel->name_view().data(), context->step_id());
   bool should_log_inputs_and_outputs = ShouldLogInputsAndOutputs(op_kernel);
@@ -840,6 +957,9 @@ void BaseGPUDevice::Compute(OpKernel* op_kernel, OpKernelContext* context) {
               << ComputeOpKernelDebugString(*op_kernel, stream_id);
     }
   }
+  if (stream_safe_allocator_) {
+    stream_safe_allocator_->Flush();
+  }
 }
 
 Status BaseGPUDevice::Sync() {
@@ -851,7 +971,13 @@ Status BaseGPUDevice::Sync() {
   // enqueued the operation has completed.  We do use other streams for copies
   // and collectives, but in those cases the (Async)OpKernels themselves block
   // until the queued operation has finished.
-  return stream_->compute->BlockHostUntilDone();
+  if (stream_safe_allocator_) {
+    stream_safe_allocator_->Flush();
+  }
+  for (StreamGroup* group : streams_) {
+    TF_RETURN_IF_ERROR(group->compute->BlockHostUntilDone());
+  }
+  return OkStatus();
 }
 
 void BaseGPUDevice::ComputeAsync(AsyncOpKernel* op_kernel,
@@ -883,9 +1009,68 @@ void BaseGPUDevice::ComputeAsync(AsyncOpKernel* op_kernel,
 
   std::unique_ptr<stream_executor::ActivateContext> scoped_activation =
       stream->parent()->Activate();
+  Status wait_status = WaitForInputStreams(*gpu_device_context);
+  if (!wait_status.ok()) {
+    context->SetStatus(wait_status);
+    done();
+    return;
+  }
   op_kernel->ComputeAsync(context, std::move(done));
 }
 
+Status BaseGPUDevice::FillContextMap(
+    const Graph* graph, std::vector<DeviceContext*>* device_context_map) {
+  if (streams_.size() <= 1) {
+    return OkStatus();
+  }
+  gpu_stream_util::AssignStreamsOpts opts;
+  opts.num_streams = streams_.size();
+  std::vector<int> node_to_stream_id;
+  TF_RETURN_IF_ERROR(
+      gpu_stream_util::AssignStreams(graph, opts, &node_to_stream_id));
+
+  AllocatorAttributes attr;
+  attr.set_on_host(true);
+  attr.set_gpu_compatible(true);
+  Allocator* host_memory_allocator = GetAllocator(attr);
+
+  device_context_map->assign(graph->num_node_ids(), nullptr);
+  mutex_lock l(context_map_mu_);
+  for (const Node* n : graph->nodes()) {
+    std::vector<int> key = {node_to_stream_id[n->id()]};
+    for (int stream_id :
+         gpu_stream_util::StreamsToWaitFor(n, node_to_stream_id)) {
+      key.push_back(stream_id);
+    }
+    GPUDeviceContext* context = device_context_;
+    if (key.size() > 1 || key[0] != 0) {
+      GPUDeviceContext*& cached = stream_contexts_[key];
+      if (cached == nullptr) {
+        const StreamGroup* group = streams_[key[0]];
+        cached = new GPUDeviceContext(key[0], group->compute,
+#if TENSORFLOW_USE_ROCM
+                                      group->nccl,
+#endif
+                                      group->host_to_device,
+                                      group->device_to_host,
+                                      group->device_to_device,
+                                      host_memory_allocator);
+        absl::InlinedVector<se::Stream*, 2UL> wait_streams;
+        for (size_t i = 1; i < key.size(); ++i) {
+          wait_streams.push_back(streams_[key[i]]->compute);
+        }
+        cached->set_wait_streams(std::move(wait_streams));
+        VLOG(2) << "Created context for stream[" << key[0] << "] waiting for "
+                << key.size() - 1 << " streams";
+      }
+      context = cached;
+    }
+    context->Ref();
+    (*device_context_map)[n->id()] = context;
+  }
+  return OkStatus();
+}
+
 Status BaseGPUDevice::MaybeCopyTensorToGPU(
     const AllocatorAttributes& alloc_attrs, const Tensor& from, Tensor* to,
     StatusCallback done) {
@@ -1287,11 +1472,11 @@ void BaseGPUDevice::ReinitializeDevice(OpKernelContext* context,
   ConcretePerOpGpuDevice* concrete_device =
       static_cast<ConcretePerOpGpuDevice*>(device);
   DCHECK(concrete_device);
-  DCHECK_EQ(stream_id, 0);
+  DCHECK_LT(stream_id, static_cast<int>(streams_.size()));
   const gpuStream_t gpu_stream = reinterpret_cast<gpuStream_t>(
-      stream_->compute->platform_specific_handle().stream);
+      streams_[stream_id]->compute->platform_specific_handle().stream);
   concrete_device->Reinitialize(context, gpu_stream, tf_device_id_, allocator,
-                                scratch_);
+                                scratch_[stream_id]);
 }
 
 PerOpGpuDevice* BaseGPUDevice::MakeGpuDevice() {
@@ -1308,7 +1493,7 @@ Status BaseGPUDevice::ReinitializeGpuDevice(OpKernelContext* context,
     const int stream_id = gpu_dc->stream_id();
     VLOG(1) << "  eigen_gpu_device(" << dc << ") => stream[" << stream_id
             << "]";
-    CHECK_EQ(stream_id, 0);
+    CHECK_LT(stream_id, static_cast<int>(streams_.size()));
     ReinitializeDevice(context, device, stream_id, allocator);
   } else {
     ReinitializeDevice(context, device, 0, allocator);
@@ -27,6 +27,7 @@ limitations under the License.
 #endif  // PLATFORM_GOOGLE && TF_PLATFORM_LINUX_X86_64
 
 #include <functional>
+#include <map>
 #include <memory>
 #include <optional>
 #include <set>
@@ -55,6 +56,7 @@ limitations under the License.
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -124,6 +126,13 @@ class BaseGPUDevice : public LocalDevice {
   void ComputeAsync(AsyncOpKernel* op_kernel, OpKernelContext* context,
                     AsyncOpKernel::DoneCallback done) override;
 
+  // Assigns the nodes of `graph` to the compute streams of the device if
+  // GPUOptions.Experimental.num_compute_streams > 1, and leaves
+  // `device_context_map` empty otherwise.
+  Status FillContextMap(
+      const Graph* graph,
+      std::vector<DeviceContext*>* device_context_map) override;
+
   Status MakeTensorFromProto(const TensorProto& tensor_proto,
                              AllocatorAttributes alloc_attrs,
                              Tensor* tensor) override;
@@ -203,12 +212,25 @@ class BaseGPUDevice : public LocalDevice {
  private:
   friend class GPUDeviceTestHelper;
   class StreamGroupFactory;
+  class StreamSafeAllocator;
 
   core::RefCountPtr<DeviceContext> pjrt_device_context_;
   StreamGroup* stream_;
+  // The stream groups whose compute streams run kernels; streams_[0] is
+  // stream_.
+  std::vector<StreamGroup*> streams_;
   mutex scratch_init_mutex_;
-  char* scratch_ = nullptr;
+  // The scratch buffers used by Eigen, one per compute stream.
+  std::vector<char*> scratch_;
   GPUDeviceContext* device_context_;
+  // Wraps the allocator passed to the constructor if the device has more
+  // than one compute stream.
+  std::unique_ptr<StreamSafeAllocator> stream_safe_allocator_;
+  mutex context_map_mu_;
+  // The device contexts returned by FillContextMap(), keyed by the id of the
+  // compute stream followed by the ids of the streams it waits for.
+  std::map<std::vector<int>, GPUDeviceContext*> stream_contexts_
+      TF_GUARDED_BY(context_map_mu_);
   DeviceBase::AcceleratorDeviceInfo* accelerator_device_info_ = nullptr;
   mutex trace_mu_;
   tsl::TfDeviceId tf_device_id_;
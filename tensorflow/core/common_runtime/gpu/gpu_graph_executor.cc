@@ -0,0 +1,632 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_graph_executor.h"
+
+#if (defined(GOOGLE_CUDA) && GOOGLE_CUDA) || \
+    (defined(TENSORFLOW_USE_ROCM) && TENSORFLOW_USE_ROCM)
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "xla/stream_executor/command_buffer.h"
+#include "xla/stream_executor/device_memory.h"
+#include "xla/stream_executor/stream.h"
+#include "xla/stream_executor/trace_command_buffer_factory.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/executor_factory.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/memory_types.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/resource_handle.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/resource_var.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/refcount.h"
+
+namespace tensorflow {
+namespace {
+
+// Captured graphs kept per executor. Calls with further signatures run on
+// the default executor.
+constexpr int kMaxSignatures = 8;
+
+// Times a signature is captured again after its variables moved before it is
+// given up on.
+constexpr int kMaxRecaptures = 3;
+
+// Largest host memory argument whose value is made part of the signature.
+constexpr int64_t kMaxHostArgBytes = 1024;
+
+// Returns true if the kernel of `n` only has to run on the host once: all
+// it does on later calls is the device work recorded in the graph.
+bool IsCapturable(const Node& n) {
+  if (n.IsArg() || n.IsRetval()) {
+    return true;
+  }
+  if (n.IsControlFlow() || n.IsSend() || n.IsRecv() || n.IsFunctionCall() ||
+      n.IsIfNode() || n.IsWhileNode() || n.IsCaseNode() ||
+      n.IsCollective() || n.IsScopedAllocator() || n.op_def().is_stateful()) {
+    return false;
+  }
+  for (const auto& attr : n.attrs()) {
+    if (attr.second.has_func() || attr.second.list().func_size() > 0) {
+      return false;
+    }
+  }
+  // Variable reads keep reading the variable buffer that was captured, which
+  // `VariablesUnchanged()` checks before every replay.
+  const bool is_variable_read = n.type_string() == "ReadVariableOp" ||
+                                n.type_string() == "VariableShape";
+  for (DataType dtype : n.input_types()) {
+    if (IsRefType(dtype) || dtype == DT_STRING || dtype == DT_VARIANT ||
+        (dtype == DT_RESOURCE && !is_variable_read)) {
+      return false;
+    }
+  }
+  for (DataType dtype : n.output_types()) {
+    if (IsRefType(dtype) || dtype == DT_STRING || dtype == DT_VARIANT ||
+        dtype == DT_RESOURCE) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Looks up the variable behind the resource handle in `arg`.
+absl::StatusOr<core::RefCountPtr<Var>> LookupVariable(Device* device,
+                                                      const Tensor& arg) {
+  if (arg.dtype() != DT_RESOURCE || arg.NumElements() != 1) {
+    return errors::InvalidArgument("Expected a scalar resource handle.");
+  }
+  const ResourceHandle& handle = arg.flat<ResourceHandle>()(0);
+  if (handle.IsRefCounting()) {
+    TF_ASSIGN_OR_RETURN(Var * var, handle.GetResource<Var>());
+    var->Ref();
+    return core::RefCountPtr<Var>(var);
+  }
+  Var* var;
+  TF_RETURN_IF_ERROR(device->resource_manager()->Lookup<Var>(
+      handle.container(), handle.name(), &var));
+  return core::RefCountPtr<Var>(var);
+}
+
+// Passes through all allocations to the device allocator but holds on to
+// the buffers freed while the graph is captured until the graph is dropped:
+// replays keep reading and writing the addresses recorded in the graph.
+class PinningAllocator : public AllocatorWrapper {
+ public:
+  explicit PinningAllocator(Allocator* wrapped) : AllocatorWrapper(wrapped) {}
+
+  ~PinningAllocator() override {
+    for (void* ptr : pinned_) {
+      wrapped()->DeallocateRaw(ptr);
+    }
+  }
+
+  void DeallocateRaw(void* ptr) override {
+    mutex_lock l(mu_);
+    pinned_.push_back(ptr);
+  }
+
+ private:
+  mutex mu_;
+  std::vector<void*> pinned_ TF_GUARDED_BY(mu_);
+};
+
+// Keeps captures exclusive with the runs and replays of all GPU graph
+// executors: work that other functions enqueue on the compute stream while
+// it is captured would be recorded into the graph instead of executed.
+class CaptureGate {
+ public:
+  static CaptureGate* Global() {
+    static CaptureGate* gate = new CaptureGate;
+    return gate;
+  }
+
+  void BeginRun() {
+    mutex_lock l(mu_);
+    while (capturing_ || pending_captures_ > 0) cv_.wait(l);
+    ++active_runs_;
+  }
+
+  void EndRun() {
+    mutex_lock l(mu_);
+    if (--active_runs_ == 0) cv_.notify_all();
+  }
+
+  void BeginCapture() {
+    mutex_lock l(mu_);
+    ++pending_captures_;
+    while (capturing_ || active_runs_ > 0) cv_.wait(l);
+    --pending_captures_;
+    capturing_ = true;
+  }
+
+  void EndCapture() {
+    mutex_lock l(mu_);
+    capturing_ = false;
+    cv_.notify_all();
+  }
+
+ private:
+  mutex mu_;
+  condition_variable cv_;
+  int64_t active_runs_ TF_GUARDED_BY(mu_) = 0;
+  int64_t pending_captures_ TF_GUARDED_BY(mu_) = 0;
+  bool capturing_ TF_GUARDED_BY(mu_) = false;
+};
+
+// The call frame the function is captured with: device memory arguments are
+// replaced by the persistent buffers replays copy the arguments into.
+class CaptureCallFrame : public CallFrameInterface {
+ public:
+  CaptureCallFrame(std::vector<Tensor> args, size_t num_retvals)
+      : args_(std::move(args)), retvals_(num_retvals) {}
+
+  size_t num_args() const override { return args_.size(); }
+  size_t num_retvals() const override { return retvals_.size(); }
+
+  absl::Status GetArg(int index, const Tensor** val) override {
+    if (index < 0 || index >= args_.size()) {
+      return errors::InvalidArgument("Argument ", index, " is out of range.");
+    }
+    *val = &args_[index];
+    return absl::OkStatus();
+  }
+
+  absl::Status SetRetval(int index, const Tensor& val) override {
+    if (index < 0 || index >= retvals_.size()) {
+      return errors::InvalidArgument("Retval ", index, " is out of range.");
+    }
+    retvals_[index] = val;
+    return absl::OkStatus();
+  }
+
+  std::vector<Tensor> ConsumeRetvals() { return std::move(retvals_); }
+
+ private:
+  const std::vector<Tensor> args_;
+  std::vector<Tensor> retvals_;
+};
+
+class GpuGraphExecutor : public Executor {
+ public:
+  explicit GpuGraphExecutor(const LocalExecutorParams& params)
+      : params_(params), stream_(nullptr) {}
+
+  absl::Status Initialize(const Graph& graph);
+
+ private:
+  // The variable a resource argument refers to and the buffer it had when
+  // the graph was captured.
+  struct VariableSnapshot {
+    int arg_index;
+    core::RefCountPtr<Var> var;
+    const void* data;
+    TensorShape shape;
+  };
+
+  struct CapturedGraph {
+    explicit CapturedGraph(Allocator* device_allocator)
+        : allocator(device_allocator) {}
+
+    // Declared first so that it is destroyed last: all other members may
+    // hold buffers allocated from it.
+    PinningAllocator allocator;
+    // The captured call frame arguments. Device memory arguments are copied
+    // into these buffers before every replay.
+    std::vector<Tensor> args;
+    std::vector<Tensor> retvals;
+    std::vector<VariableSnapshot> variables;
+    std::unique_ptr<se::CommandBuffer> command_buffer;
+  };
+
+  struct Signature {
+    int runs = 0;
+    int captures = 0;
+    bool capturing = false;
+    bool uncapturable = false;
+    std::unique_ptr<CapturedGraph> graph;
+  };
+
+  void RunAsyncInternal(const Args& args, DoneCallback done) override;
+
+  // Runs the function on the default executor.
+  void RunDefault(const Args& args, DoneCallback done);
+
+  // Computes the key the captured graphs of the arguments in `frame` are
+  // kept under. Returns false if the arguments cannot be captured.
+  bool ComputeSignature(CallFrameInterface* frame, std::string* key) const;
+
+  // Runs the function into a new graph.
+  absl::Status Capture(const Args& args,
+                       std::unique_ptr<CapturedGraph>* graph);
+
+  // Replays `graph` on the call frame of `args`.
+  absl::Status Launch(const CapturedGraph& graph, const Args& args)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Enqueues the argument copies, the graph and the result copies.
+  absl::Status Replay(const CapturedGraph& graph, CallFrameInterface* frame);
+
+  // Returns true if the variables passed to the function still have the
+  // buffers `graph` was captured with.
+  bool VariablesUnchanged(const CapturedGraph& graph,
+                          CallFrameInterface* frame) const;
+
+  const LocalExecutorParams params_;
+  std::unique_ptr<Executor> inner_;
+  se::Stream* stream_;
+  Allocator* device_allocator_ = nullptr;
+  // Cleared at initialization if the graph or one of its kernels cannot be
+  // replayed.
+  std::atomic<bool> capturable_{true};
+  // Memory types of the function arguments and results.
+  MemoryTypeVector arg_memory_types_;
+  MemoryTypeVector retval_memory_types_;
+
+  mutex mu_;
+  absl::flat_hash_map<std::string, std::unique_ptr<Signature>> signatures_
+      TF_GUARDED_BY(mu_);
+};
+
+absl::Status GpuGraphExecutor::Initialize(const Graph& graph) {
+  Device* device = params_.device;
+  const DeviceBase::AcceleratorDeviceInfo* device_info =
+      device->tensorflow_accelerator_device_info();
+  if (device->device_type() != DEVICE_GPU || device_info == nullptr ||
+      device_info->stream == nullptr) {
+    capturable_ = false;
+  } else {
+    stream_ = device_info->stream;
+    device_allocator_ = device->GetAllocator(AllocatorAttributes());
+  }
+
+  for (const Node* n : graph.op_nodes()) {
+    if (!IsCapturable(*n)) {
+      VLOG(1) << "Not capturing the GPU graph of a function with node "
+              << n->name() << " (" << n->type_string() << ")";
+      capturable_ = false;
+    }
+    if (!n->IsArg() && !n->IsRetval()) continue;
+    int index;
+    TF_RETURN_IF_ERROR(GetNodeAttr(n->attrs(), "index", &index));
+    MemoryTypeVector input_memory_types, output_memory_types;
+    TF_RETURN_IF_ERROR(MemoryTypesForNode(
+        OpRegistry::Global(), DeviceType(device->device_type()), n->def(),
+        &input_memory_types, &output_memory_types));
+    MemoryTypeVector& memory_types =
+        n->IsArg() ? arg_memory_types_ : retval_memory_types_;
+    if (index < 0) {
+      return errors::InvalidArgument("Invalid index for node ", n->name());
+    }
+    if (index >= memory_types.size()) memory_types.resize(index + 1);
+    memory_types[index] =
+        n->IsArg() ? output_memory_types[0] : input_memory_types[0];
+  }
+
+  LocalExecutorParams inner_params = params_;
+  inner_params.create_kernel =
+      [this, create_kernel = params_.create_kernel](
+          const std::shared_ptr<const NodeProperties>& props,
+          OpKernel** kernel) -> absl::Status {
+    TF_RETURN_IF_ERROR(create_kernel(props, kernel));
+    // Asynchronous kernels wait for device work on the host, which a capture
+    // does not execute.
+    if ((*kernel)->AsAsync() != nullptr) {
+      capturable_ = false;
+    }
+    return absl::OkStatus();
+  };
+  Executor* inner;
+  TF_RETURN_IF_ERROR(NewLocalExecutor(inner_params, graph, &inner));
+  inner_.reset(inner);
+  return absl::OkStatus();
+}
+
+void GpuGraphExecutor::RunAsyncInternal(const Args& args, DoneCallback done) {
+  std::string key;
+  if (!capturable_ || args.call_frame == nullptr ||
+      !ComputeSignature(args.call_frame, &key)) {
+    inner_->RunAsync(args, std::move(done));
+    return;
+  }
+
+  enum class Action { kRunDefault, kReplay, kCapture };
+  Action action = Action::kRunDefault;
+  Signature* signature = nullptr;
+  absl::Status s;
+  {
+    mutex_lock l(mu_);
+    auto it = signatures_.find(key);
+    if (it == signatures_.end() && signatures_.size() < kMaxSignatures) {
+      it = signatures_.emplace(key, std::make_unique<Signature>()).first;
+    }
+    if (it != signatures_.end()) {
+      signature = it->second.get();
+      if (signature->graph != nullptr &&
+          !VariablesUnchanged(*signature->graph, args.call_frame)) {
+        VLOG(1) << "Dropping the GPU graph of a function whose variables "
+                << "moved";
+        signature->graph.reset();
+        signature->uncapturable = signature->captures >= kMaxRecaptures;
+      }
+      if (signature->graph != nullptr) {
+        // Replays are enqueued under `mu_`: they share the argument buffers
+        // of the graph.
+        s = Launch(*signature->graph, args);
+        action = Action::kReplay;
+      } else if (!signature->uncapturable && !signature->capturing &&
+                 signature->runs++ > 0) {
+        // The first run of a signature warms up the kernels.
+        signature->capturing = true;
+        ++signature->captures;
+        action = Action::kCapture;
+      }
+    }
+  }
+
+  if (action == Action::kCapture) {
+    std::unique_ptr<CapturedGraph> graph;
+    CaptureGate::Global()->BeginCapture();
+    s = Capture(args, &graph);
+    CaptureGate::Global()->EndCapture();
+
+    mutex_lock l(mu_);
+    signature->capturing = false;
+    if (s.ok()) {
+      // The capture ran the kernels on the host, but did not execute their
+      // device work.
+      signature->graph = std::move(graph);
+      s = Launch(*signature->graph, args);
+      action = Action::kReplay;
+    } else {
+      VLOG(1) << "Failed to capture the GPU graph of a function: " << s;
+      signature->uncapturable = true;
+      action = Action::kRunDefault;
+    }
+  }
+
+  if (action == Action::kReplay) {
+    done(s);
+  } else {
+    RunDefault(args, std::move(done));
+  }
+}
+
+absl::Status GpuGraphExecutor::Launch(const CapturedGraph& graph,
+                                      const Args& args) {
+  CaptureGate::Global()->BeginRun();
+  absl::Status s = Replay(graph, args.call_frame);
+  CaptureGate::Global()->EndRun();
+  if (s.ok() && args.sync_on_finish) {
+    s = stream_->BlockHostUntilDone();
+  }
+  return s;
+}
+
+void GpuGraphExecutor::RunDefault(const Args& args, DoneCallback done) {
+  CaptureGate::Global()->BeginRun();
+  inner_->RunAsync(args, [done = std::move(done)](const absl::Status& s) {
+    CaptureGate::Global()->EndRun();
+    done(s);
+  });
+}
+
+bool GpuGraphExecutor::ComputeSignature(CallFrameInterface* frame,
+                                        std::string* key) const {
+  if (frame->num_args() != arg_memory_types_.size() ||
+      frame->num_retvals() != retval_memory_types_.size()) {
+    return false;
+  }
+  for (int i = 0; i < frame->num_args(); ++i) {
+    const Tensor* arg;
+    if (!frame->GetArg(i, &arg).ok() || !arg->IsInitialized()) {
+      return false;
+    }
+    absl::StrAppend(key, arg->dtype(), arg->shape().DebugString());
+    if (arg->dtype() == DT_RESOURCE) {
+      if (arg->NumElements() != 1) return false;
+      const ResourceHandle& handle = arg->flat<ResourceHandle>()(0);
+      absl::StrAppend(key, handle.container(), "/", handle.name(), "/",
+                      reinterpret_cast<uintptr_t>(handle.resource().get()));
+    } else if (arg_memory_types_[i] == HOST_MEMORY) {
+      // Kernels read host memory arguments when they are captured.
+      if (!DataTypeCanUseMemcpy(arg->dtype()) ||
+          arg->TotalBytes() > kMaxHostArgBytes) {
+        return false;
+      }
+      absl::StrAppend(key, arg->tensor_data());
+    }
+    absl::StrAppend(key, ";");
+  }
+  return true;
+}
+
+absl::Status GpuGraphExecutor::Capture(
+    const Args& args, std::unique_ptr<CapturedGraph>* graph) {
+  auto captured = std::make_unique<CapturedGraph>(device_allocator_);
+  CallFrameInterface* frame = args.call_frame;
+  for (int i = 0; i < frame->num_args(); ++i) {
+    const Tensor* arg;
+    TF_RETURN_IF_ERROR(frame->GetArg(i, &arg));
+    if (arg->dtype() == DT_RESOURCE) {
+      TF_ASSIGN_OR_RETURN(core::RefCountPtr<Var> var,
+                          LookupVariable(params_.device, *arg));
+      VariableSnapshot snapshot{i, std::move(var), nullptr, TensorShape()};
+      {
+        tf_shared_lock l(*snapshot.var->mu());
+        const Tensor* value = snapshot.var->tensor();
+        if (value->IsInitialized()) snapshot.data = value->data();
+        snapshot.shape = value->shape();
+      }
+      captured->variables.push_back(std::move(snapshot));
+      captured->args.push_back(*arg);
+    } else if (arg_memory_types_[i] == HOST_MEMORY) {
+      captured->args.push_back(*arg);
+    } else {
+      captured->args.emplace_back(device_allocator_, arg->dtype(),
+                                  arg->shape());
+      if (!captured->args.back().IsInitialized()) {
+        return errors::ResourceExhausted(
+            "Failed to allocate the argument buffers of a GPU graph.");
+      }
+    }
+  }
+
+  CaptureCallFrame capture_frame(captured->args, frame->num_retvals());
+  Args capture_args = args;
+  capture_args.call_frame = &capture_frame;
+  capture_args.device_allocator = &captured->allocator;
+  capture_args.stats_collector = nullptr;
+  capture_args.sync_on_finish = false;
+  TF_ASSIGN_OR_RETURN(
+      captured->command_buffer,
+      se::TraceCommandBufferFactory::Create(
+          stream_->parent(), stream_,
+          [&](se::Stream*) { return inner_->Run(capture_args); },
+          se::CommandBuffer::Mode::kPrimary));
+  captured->retvals = capture_frame.ConsumeRetvals();
+  for (const Tensor& retval : captured->retvals) {
+    if (!retval.IsInitialized()) {
+      return errors::Internal("A GPU graph did not produce all retvals.");
+    }
+  }
+  *graph = std::move(captured);
+  return absl::OkStatus();
+}
+
+absl::Status GpuGraphExecutor::Replay(const CapturedGraph& graph,
+                                      CallFrameInterface* frame) {
+  for (int i = 0; i < frame->num_args(); ++i) {
+    if (arg_memory_types_[i] == HOST_MEMORY ||
+        graph.args[i].dtype() == DT_RESOURCE ||
+        graph.args[i].TotalBytes() == 0) {
+      continue;
+    }
+    const Tensor* arg;
+    TF_RETURN_IF_ERROR(frame->GetArg(i, &arg));
+    se::DeviceMemoryBase src(const_cast<char*>(arg->tensor_data().data()),
+                             arg->TotalBytes());
+    se::DeviceMemoryBase dst(
+        const_cast<char*>(graph.args[i].tensor_data().data()),
+        graph.args[i].TotalBytes());
+    TF_RETURN_IF_ERROR(stream_->MemcpyD2D(&dst, src, arg->TotalBytes()));
+  }
+
+  TF_RETURN_IF_ERROR(graph.command_buffer->Submit(stream_));
+
+  for (int i = 0; i < graph.retvals.size(); ++i) {
+    const Tensor& retval = graph.retvals[i];
+    if (retval_memory_types_[i] == HOST_MEMORY || retval.TotalBytes() == 0) {
+      // Host memory results were computed on the host during the capture
+      // and only depend on the signature.
+      TF_RETURN_IF_ERROR(frame->SetRetval(i, retval));
+      continue;
+    }
+    // The results of the graph are overwritten by the next replay.
+    Tensor output(device_allocator_, retval.dtype(), retval.shape());
+    if (!output.IsInitialized()) {
+      return errors::ResourceExhausted(
+          "Failed to allocate the result of a GPU graph.");
+    }
+    se::DeviceMemoryBase src(const_cast<char*>(retval.tensor_data().data()),
+                             retval.TotalBytes());
+    se::DeviceMemoryBase dst(const_cast<char*>(output.tensor_data().data()),
+                             output.TotalBytes());
+    TF_RETURN_IF_ERROR(stream_->MemcpyD2D(&dst, src, retval.TotalBytes()));
+    TF_RETURN_IF_ERROR(frame->SetRetval(i, output));
+  }
+  return absl::OkStatus();
+}
+
+bool GpuGraphExecutor::VariablesUnchanged(const CapturedGraph& graph,
+                                          CallFrameInterface* frame) const {
+  for (const VariableSnapshot& snapshot : graph.variables) {
+    const Tensor* arg;
+    if (!frame->GetArg(snapshot.arg_index, &arg).ok()) return false;
+    absl::StatusOr<core::RefCountPtr<Var>> var =
+        LookupVariable(params_.device, *arg);
+    if (!var.ok() || var->get() != snapshot.var.get()) return false;
+    tf_shared_lock l(*(*var)->mu());
+    const Tensor* value = (*var)->tensor();
+    if (!value->IsInitialized() || value->data() != snapshot.data ||
+        value->shape() != snapshot.shape) {
+      return false;
+    }
+  }
+  return true;
+}
+
+class GpuGraphExecutorRegistrar {
+ public:
+  GpuGraphExecutorRegistrar() {
+    ExecutorFactory::Register(kGpuGraphExecutor, new Factory());
+  }
+
+ private:
+  class Factory : public ExecutorFactory {
+    absl::Status NewExecutor(const LocalExecutorParams& params,
+                             const Graph& graph,
+                             std::unique_ptr<Executor>* out_executor) override {
+      Executor* ret;
+      TF_RETURN_IF_ERROR(NewGpuGraphExecutor(params, graph, &ret));
+      out_executor->reset(ret);
+      return absl::OkStatus();
+    }
+  };
+};
+static GpuGraphExecutorRegistrar registrar;
+
+}  // namespace
+
+absl::Status NewGpuGraphExecutor(const LocalExecutorParams& params,
+                                 const Graph& graph, Executor** executor) {
+  auto impl = std::make_unique<GpuGraphExecutor>(params);
+  TF_RETURN_IF_ERROR(impl->Initialize(graph));
+  *executor = impl.release();
+  return absl::OkStatus();
+}
+
+}  // namespace tensorflow
+
+#else
+
+namespace tensorflow {
+
+absl::Status NewGpuGraphExecutor(const LocalExecutorParams& params,
+                                 const Graph& graph, Executor** executor) {
+  return absl::UnimplementedError(
+      "GPU graph capture requires a CUDA or ROCm build.");
+}
+
+}  // namespace tensorflow
+
+#endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
@@ -0,0 +1,59 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_GRAPH_EXECUTOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_GRAPH_EXECUTOR_H_
+
+#include "absl/status/status.h"
+#include "tensorflow/core/common_runtime/executor.h"
+#include "tensorflow/core/common_runtime/local_executor_params.h"
+#include "tensorflow/core/graph/graph.h"
+
+namespace tensorflow {
+
+// The executor type under which `NewGpuGraphExecutor()` is registered.
+// Functions opt in through `InstantiateOptions::executor_type` or the
+// "_executor" function attribute.
+inline constexpr char kGpuGraphExecutor[] = "GPU_GRAPH_EXECUTOR";
+
+// Creates a new `Executor` for a function running on a GPU that records the
+// device work of the function into a CUDA graph and replays it when the
+// function is called again with the same argument signature (dtypes, shapes,
+// the values of host memory arguments and the variables behind resource
+// arguments).
+//
+// The first call with a new signature runs on the default executor, which
+// also gives kernels a chance to autotune and initialize lazily. The second
+// call captures the compute stream while running the default executor into
+// persistent argument buffers; later calls only copy the arguments in, launch
+// the graph and copy the results out.
+//
+// Graphs that cannot be replayed fall back to the default executor for good:
+// graphs with control flow, Send/Recv, function calls, reference, string or
+// variant tensors, stateful ops, resource inputs other than variable reads,
+// or asynchronous kernels, and signatures whose capture failed. A captured
+// graph is dropped when a variable passed to the function no longer has the
+// buffer it was captured with.
+//
+// Capture requires that nothing but the captured function enqueues work on
+// the device's compute stream, which the executor only guarantees among the
+// functions that run on it. It is meant for serving and training loops that
+// run the same static-shape functions over and over again.
+absl::Status NewGpuGraphExecutor(const LocalExecutorParams& params,
+                                 const Graph& graph, Executor** executor);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_GRAPH_EXECUTOR_H_
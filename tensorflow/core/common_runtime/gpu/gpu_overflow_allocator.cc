@@ -0,0 +1,125 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/common_runtime/gpu/gpu_overflow_allocator.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "tsl/platform/logging.h"
+
+namespace tensorflow {
+
+GPUOverflowAllocator::GPUOverflowAllocator(
+    std::unique_ptr<tsl::Allocator> device_allocator,
+    std::unique_ptr<tsl::Allocator> overflow_allocator,
+    OverflowCallback on_overflow)
+    : device_allocator_(std::move(device_allocator)),
+      overflow_allocator_(std::move(overflow_allocator)),
+      on_overflow_(std::move(on_overflow)) {}
+
+void* GPUOverflowAllocator::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const tsl::AllocationAttributes& allocation_attr) {
+  // Do not wait for device memory to be freed when it can overflow instead.
+  tsl::AllocationAttributes device_attr(
+      /*retry_on_failure=*/false, allocation_attr.allocation_will_be_logged,
+      allocation_attr.freed_by_func);
+  void* ptr = device_allocator_->AllocateRaw(alignment, num_bytes, device_attr);
+  if (ptr != nullptr) return ptr;
+
+  ptr = overflow_allocator_->AllocateRaw(alignment, num_bytes,
+                                         allocation_attr);
+  if (ptr == nullptr) return nullptr;
+  VLOG(1) << "Allocated " << num_bytes << " bytes from "
+          << overflow_allocator_->Name() << " because "
+          << device_allocator_->Name() << " is out of memory";
+  {
+    tsl::mutex_lock l(mu_);
+    overflow_buffers_.insert(ptr);
+  }
+  num_overflow_buffers_.fetch_add(1, std::memory_order_relaxed);
+  if (on_overflow_) on_overflow_(ptr, num_bytes);
+  return ptr;
+}
+
+tsl::Allocator* GPUOverflowAllocator::Owner(const void* ptr) const {
+  if (num_overflow_buffers_.load(std::memory_order_relaxed) == 0) {
+    return device_allocator_.get();
+  }
+  tsl::mutex_lock l(mu_);
+  return overflow_buffers_.contains(ptr) ? overflow_allocator_.get()
+                                         : device_allocator_.get();
+}
+
+void GPUOverflowAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) return;
+  if (num_overflow_buffers_.load(std::memory_order_relaxed) > 0) {
+    bool overflowed;
+    {
+      tsl::mutex_lock l(mu_);
+      overflowed = overflow_buffers_.erase(ptr) > 0;
+    }
+    if (overflowed) {
+      num_overflow_buffers_.fetch_sub(1, std::memory_order_relaxed);
+      overflow_allocator_->DeallocateRaw(ptr);
+      return;
+    }
+  }
+  device_allocator_->DeallocateRaw(ptr);
+}
+
+bool GPUOverflowAllocator::TracksAllocationSizes() const {
+  return device_allocator_->TracksAllocationSizes() &&
+         overflow_allocator_->TracksAllocationSizes();
+}
+
+size_t GPUOverflowAllocator::RequestedSize(const void* ptr) const {
+  return Owner(ptr)->RequestedSize(ptr);
+}
+
+size_t GPUOverflowAllocator::AllocatedSize(const void* ptr) const {
+  return Owner(ptr)->AllocatedSize(ptr);
+}
+
+int64_t GPUOverflowAllocator::AllocationId(const void* ptr) const {
+  return Owner(ptr)->AllocationId(ptr);
+}
+
+std::optional<tsl::AllocatorStats> GPUOverflowAllocator::GetStats() {
+  std::optional<tsl::AllocatorStats> stats = device_allocator_->GetStats();
+  std::optional<tsl::AllocatorStats> overflow_stats =
+      overflow_allocator_->GetStats();
+  if (!stats || !overflow_stats) return stats;
+  stats->num_allocs += overflow_stats->num_allocs;
+  stats->bytes_in_use += overflow_stats->bytes_in_use;
+  stats->peak_bytes_in_use += overflow_stats->peak_bytes_in_use;
+  stats->largest_alloc_size =
+      std::max(stats->largest_alloc_size, overflow_stats->largest_alloc_size);
+  if (stats->bytes_limit && overflow_stats->bytes_limit) {
+    *stats->bytes_limit += *overflow_stats->bytes_limit;
+  }
+  stats->bytes_reserved += overflow_stats->bytes_reserved;
+  stats->peak_bytes_reserved += overflow_stats->peak_bytes_reserved;
+  return stats;
+}
+
+bool GPUOverflowAllocator::ClearStats() {
+  const bool cleared = device_allocator_->ClearStats();
+  return overflow_allocator_->ClearStats() && cleared;
+}
+
+}  // namespace tensorflow
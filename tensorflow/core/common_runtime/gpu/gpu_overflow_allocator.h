@@ -0,0 +1,98 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_OVERFLOW_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_OVERFLOW_ALLOCATOR_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "absl/container/flat_hash_set.h"
+#include "xla/tsl/framework/allocator.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// An allocator that serves allocations from a device memory allocator, and
+// falls back to an allocator of CUDA unified memory when the device memory is
+// exhausted.
+//
+// The CUDA driver migrates unified memory pages to host memory when the
+// device is oversubscribed, and back to the device when they are accessed, so
+// under memory pressure the pages of buffers that have not been touched
+// recently are swapped out to the host instead of the allocation failing.
+// Device pointers stay valid throughout, so kernels need no changes.
+class GPUOverflowAllocator : public tsl::Allocator {
+ public:
+  // Called with every buffer allocated from the overflow allocator, e.g. to
+  // advise the driver to prefer device memory for it.
+  using OverflowCallback = std::function<void(void* ptr, size_t num_bytes)>;
+
+  GPUOverflowAllocator(std::unique_ptr<tsl::Allocator> device_allocator,
+                       std::unique_ptr<tsl::Allocator> overflow_allocator,
+                       OverflowCallback on_overflow = nullptr);
+
+  std::string Name() override { return device_allocator_->Name(); }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, tsl::AllocationAttributes());
+  }
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const tsl::AllocationAttributes& allocation_attr) override;
+  void DeallocateRaw(void* ptr) override;
+
+  bool TracksAllocationSizes() const override;
+  size_t RequestedSize(const void* ptr) const override;
+  size_t AllocatedSize(const void* ptr) const override;
+  int64_t AllocationId(const void* ptr) const override;
+  // Sums the stats of the device and overflow allocators.
+  std::optional<tsl::AllocatorStats> GetStats() override;
+  bool ClearStats() override;
+  tsl::AllocatorMemoryType GetMemoryType() const override {
+    return device_allocator_->GetMemoryType();
+  }
+
+  // Returns the number of live buffers allocated from the overflow allocator.
+  int64_t NumOverflowBuffers() const {
+    return num_overflow_buffers_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  // Returns the allocator that allocated `ptr`.
+  tsl::Allocator* Owner(const void* ptr) const;
+
+  const std::unique_ptr<tsl::Allocator> device_allocator_;
+  const std::unique_ptr<tsl::Allocator> overflow_allocator_;
+  const OverflowCallback on_overflow_;
+
+  // Lets Owner() skip the lookup while no buffer has overflowed.
+  std::atomic<int64_t> num_overflow_buffers_{0};
+  mutable tsl::mutex mu_;
+  absl::flat_hash_set<const void*> overflow_buffers_ TF_GUARDED_BY(mu_);
+
+  GPUOverflowAllocator(const GPUOverflowAllocator&) = delete;
+  void operator=(const GPUOverflowAllocator&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_OVERFLOW_ALLOCATOR_H_
@@ -0,0 +1,106 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/common_runtime/gpu/gpu_overflow_allocator.h"
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "xla/tsl/framework/allocator.h"
+#include "xla/tsl/framework/bfc_allocator.h"
+#include "tensorflow/core/common_runtime/pool_allocator.h"
+#include "tsl/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr size_t kMiB = 1 << 20;
+
+// Returns a BFC allocator of host memory that holds at most `total_bytes`.
+std::unique_ptr<tsl::Allocator> BoundedAllocator(size_t total_bytes,
+                                                 const char* name) {
+  tsl::BFCAllocator::Options options;
+  options.allow_retry_on_failure = false;
+  return std::make_unique<tsl::BFCAllocator>(
+      std::make_unique<BasicCPUAllocator>(/*numa_node=*/0,
+                                          std::vector<SubAllocator::Visitor>(),
+                                          std::vector<SubAllocator::Visitor>()),
+      total_bytes, name, options);
+}
+
+TEST(GPUOverflowAllocatorTest, OverflowsWhenDeviceIsFull) {
+  std::vector<void*> overflowed;
+  GPUOverflowAllocator a(BoundedAllocator(2 * kMiB, "device"),
+                         BoundedAllocator(4 * kMiB, "overflow"),
+                         [&](void* ptr, size_t num_bytes) {
+                           EXPECT_EQ(num_bytes, kMiB);
+                           overflowed.push_back(ptr);
+                         });
+  EXPECT_EQ(a.Name(), "device");
+
+  void* d0 = a.AllocateRaw(64, kMiB);
+  void* d1 = a.AllocateRaw(64, kMiB);
+  ASSERT_NE(d0, nullptr);
+  ASSERT_NE(d1, nullptr);
+  EXPECT_EQ(a.NumOverflowBuffers(), 0);
+  EXPECT_TRUE(overflowed.empty());
+
+  void* o0 = a.AllocateRaw(64, kMiB);
+  ASSERT_NE(o0, nullptr);
+  EXPECT_EQ(a.NumOverflowBuffers(), 1);
+  EXPECT_EQ(overflowed, std::vector<void*>({o0}));
+  EXPECT_EQ(a.RequestedSize(o0), kMiB);
+  EXPECT_EQ(a.RequestedSize(d0), kMiB);
+
+  std::optional<tsl::AllocatorStats> stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(stats->num_allocs, 3);
+  EXPECT_EQ(stats->bytes_in_use, 3 * kMiB);
+
+  // Freeing device memory makes room for the next allocation on the device.
+  a.DeallocateRaw(d1);
+  void* d2 = a.AllocateRaw(64, kMiB);
+  ASSERT_NE(d2, nullptr);
+  EXPECT_EQ(a.NumOverflowBuffers(), 1);
+
+  a.DeallocateRaw(o0);
+  EXPECT_EQ(a.NumOverflowBuffers(), 0);
+  a.DeallocateRaw(d0);
+  a.DeallocateRaw(d2);
+  stats = a.GetStats();
+  ASSERT_TRUE(stats);
+  EXPECT_EQ(stats->bytes_in_use, 0);
+}
+
+TEST(GPUOverflowAllocatorTest, FailsWhenBothAreFull) {
+  GPUOverflowAllocator a(BoundedAllocator(kMiB, "device"),
+                         BoundedAllocator(kMiB, "overflow"));
+  void* d = a.AllocateRaw(64, kMiB);
+  void* o = a.AllocateRaw(64, kMiB);
+  ASSERT_NE(d, nullptr);
+  ASSERT_NE(o, nullptr);
+  tsl::AllocationAttributes attr;
+  attr.retry_on_failure = false;
+  EXPECT_EQ(a.AllocateRaw(64, kMiB, attr), nullptr);
+  EXPECT_EQ(a.NumOverflowBuffers(), 1);
+  a.DeallocateRaw(o);
+  a.DeallocateRaw(d);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -42,6 +42,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_cudamalloc_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_debug_allocator.h"
 #include "tensorflow/core/common_runtime/gpu/gpu_id_manager.h"
+#include "tensorflow/core/common_runtime/gpu/gpu_overflow_allocator.h"
 #include "tensorflow/core/common_runtime/pool_allocator.h"
 #include "tensorflow/core/common_runtime/shared_counter.h"
 #include "tensorflow/core/framework/log_memory.h"
@@ -52,6 +53,7 @@ limitations under the License.
 #include "tsl/platform/types.h"
 
 #if GOOGLE_CUDA
+#include "third_party/gpus/cuda/include/cuda.h"
 #include "xla/stream_executor/gpu/gpu_cudamallocasync_allocator.h"
 #endif  // GOOGLE_CUDA
 
@@ -127,6 +129,52 @@ static std::unique_ptr<SubAllocator> CreateSubAllocator(
       alloc_visitors, {}));
 }
 
+// Returns an allocator that serves allocations from `device_allocator`, and
+// from unified memory once the device memory is exhausted. Takes ownership of
+// `device_allocator`.
+// NOLINTNEXTLINE: clang-tidy complains this is unused because of build flags.
+static Allocator* CreateOverflowAllocator(
+    const GPUOptions& options, tsl::PlatformDeviceId platform_device_id,
+    tsl::TfDeviceId tf_device_id,
+    const std::vector<SubAllocator::Visitor>& alloc_visitors,
+    Allocator* device_allocator) {
+  auto executor = se::GPUMachineManager()
+                      ->ExecutorForDevice(platform_device_id.value())
+                      .value();
+  const size_t overflow_bytes =
+      options.experimental().unified_memory_overflow_mb() * (1LL << 20);
+  LOG(INFO) << "Allowing GPU " << tf_device_id.value() << " to overflow "
+            << overflow_bytes << " bytes into unified memory.";
+  GPUBFCAllocator::Options overflow_options;
+  overflow_options.allow_growth = true;
+  overflow_options.allow_retry_on_failure =
+      !options.experimental().disallow_retry_on_allocation_failure();
+  auto overflow_allocator = std::make_unique<GPUBFCAllocator>(
+      absl::WrapUnique(new se::DeviceMemAllocator(
+          executor, platform_device_id, stream_executor::MemoryType::kUnified,
+          alloc_visitors, {})),
+      overflow_bytes,
+      strings::StrCat("GPU_", tf_device_id.value(), "_overflow_bfc"),
+      overflow_options);
+  GPUOverflowAllocator::OverflowCallback on_overflow;
+#if GOOGLE_CUDA
+  // Keep the pages on the device while it has room for them, so that only the
+  // pages of idle buffers are evicted to the host.
+  on_overflow = [device = platform_device_id.value()](void* ptr,
+                                                       size_t num_bytes) {
+    CUresult result = cuMemAdvise(reinterpret_cast<CUdeviceptr>(ptr),
+                                  num_bytes,
+                                  CU_MEM_ADVISE_SET_PREFERRED_LOCATION, device);
+    if (result != CUDA_SUCCESS) {
+      VLOG(1) << "cuMemAdvise failed: " << result;
+    }
+  };
+#endif  // GOOGLE_CUDA
+  return new GPUOverflowAllocator(absl::WrapUnique(device_allocator),
+                                  std::move(overflow_allocator),
+                                  std::move(on_overflow));
+}
+
 Allocator* GPUProcessState::GetGPUAllocator(
     const GPUOptions& options, tsl::TfDeviceId tf_device_id, size_t total_bytes,
     const std::vector<tsl::TfDeviceId>& peer_gpu_ids) {
@@ -209,6 +257,10 @@ Allocator* GPUProcessState::GetGPUAllocator(
       gpu_allocator =
           new se::GpuCudaMallocAsyncAllocator(platform_device_id, total_bytes);
 #endif
+    } else if (options.experimental().unified_memory_overflow_mb() > 0) {
+      gpu_allocator =
+          CreateOverflowAllocator(options, platform_device_id, tf_device_id,
+                                  gpu_visitors_[bus_id], gpu_allocator);
     }
 
     Allocator* recording_allocator = nullptr;
@@ -351,6 +403,15 @@ Allocator* GPUProcessState::GetGpuHostAllocator(const GPUOptions& options,
     mem_limit_bytes = limit_mb * (1LL << 20);
   }
 
+  // If positive, pinned host memory is served from a PoolAllocator that
+  // initially keeps this many freed buffers.
+  int64_t pool_size_limit = 0;
+  absl::Status pool_status = tsl::ReadInt64FromEnvVar(
+      "TF_GPU_HOST_POOL_SIZE_LIMIT", 0, &pool_size_limit);
+  if (!pool_status.ok()) {
+    LOG(ERROR) << "GetGpuHostAllocator: " << pool_status.message();
+  }
+
   while (static_cast<int>(gpu_host_allocators_.size()) <= numa_node) {
     while (gpu_host_alloc_visitors_.size() <= numa_node) {
       gpu_host_alloc_visitors_.push_back({});
@@ -362,12 +423,21 @@ Allocator* GPUProcessState::GetGpuHostAllocator(const GPUOptions& options,
         se, numa_node, gpu_host_alloc_visitors_[numa_node],
         gpu_host_free_visitors_[numa_node]);
 
-    tsl::BFCAllocator::Options allocator_opts;
-    allocator_opts.allow_growth =
-        !options.experimental().gpu_host_mem_disallow_growth();
-    tsl::Allocator* allocator =
-        new tsl::BFCAllocator(absl::WrapUnique(sub_allocator), mem_limit_bytes,
-                              /*name=*/"gpu_host_bfc", allocator_opts);
+    tsl::Allocator* allocator = nullptr;
+    if (pool_size_limit > 0) {
+      // Pools freed buffers by size class, which suits varying copy sizes
+      // better than the BFC allocator, but does not enforce mem_limit_bytes.
+      allocator = new PoolAllocator(pool_size_limit, /*auto_resize=*/true,
+                                    sub_allocator, new SizeClassRounder,
+                                    "gpu_host_pool");
+    } else {
+      tsl::BFCAllocator::Options allocator_opts;
+      allocator_opts.allow_growth =
+          !options.experimental().gpu_host_mem_disallow_growth();
+      allocator = new tsl::BFCAllocator(
+          absl::WrapUnique(sub_allocator), mem_limit_bytes,
+          /*name=*/"gpu_host_bfc", allocator_opts);
+    }
 
     if (LogMemory::IsEnabled() && !allocator->TracksAllocationSizes()) {
       // Wrap the allocator to track allocation ids for better logging
@@ -15,8 +15,10 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/gpu/gpu_serving_device_selector.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <memory>
+#include <string>
 #include <utility>
 
 #include "absl/base/attributes.h"
@@ -36,28 +38,71 @@ namespace gpu {
 // empty queues it still affects the decision) until we have better way to
 // estimate this, as this penalty is chip-dependent and program-dependent.
 constexpr int64_t kDefaultEstimateNs = 1;
+// The weight of the latest execution time in the recent execution time of a
+// program.
+constexpr double kRecentTimeWeight = 0.25;
 ABSL_CONST_INIT int64_t (*NowNs)() = +[]() -> int64_t {
   return absl::GetCurrentTimeNanos();
 };
 
 using DeviceStates = GpuServingDeviceSelector::DeviceStates;
 
+void GpuExecutionInfo::AddRecentTime(int64_t value) {
+  DCHECK_GE(value, 0);
+  recent_time_ns_ = recent_time_ns_.has_value()
+                        ? *recent_time_ns_ +
+                              kRecentTimeWeight * (value - *recent_time_ns_)
+                        : value;
+}
+
+int64_t GpuExecutionInfo::MaybeGetValidTime(int result) const {
+  return recent_time_ns_.has_value() ? std::llround(*recent_time_ns_)
+                                     : GetTime(result);
+}
+
 GpuServingDeviceSelector::GpuServingDeviceSelector(
     const int num_devices,
     std::unique_ptr<ServingDeviceSelector::Policy> device_selector_policy)
     : device_states_(num_devices),
       device_selector_policy_(std::move(device_selector_policy)),
-      req_id_counter_(0) {}
+      req_id_counter_(0),
+      free_memory_bytes_(num_devices, -1) {}
 
 tsl::DeviceReservation GpuServingDeviceSelector::ReserveDevice(
     absl::string_view program_fingerprint) {
+  return ReserveDevice(program_fingerprint, /*affinity_key=*/"");
+}
+
+tsl::DeviceReservation GpuServingDeviceSelector::ReserveDevice(
+    absl::string_view program_fingerprint, absl::string_view affinity_key) {
   absl::MutexLock lock(&mu_);
-  DeviceStates device_states;
-  device_states.states = absl::Span<const DeviceState>(device_states_);
   auto [it, emplaced] =
-      execution_info_.try_emplace(program_fingerprint, ExecutionInfo());
-  const int device_index =
-      device_selector_policy_->SelectDevice(program_fingerprint, device_states);
+      execution_info_.try_emplace(program_fingerprint, GpuExecutionInfo());
+
+  int device_index = -1;
+  auto affinity_it = affinity_key.empty()
+                         ? affinity_devices_.end()
+                         : affinity_devices_.find(affinity_key);
+  if (affinity_it != affinity_devices_.end()) {
+    device_index = affinity_it->second;
+  } else {
+    const int64_t now_ns = NowNs();
+    absl::FixedArray<int64_t, 8> estimated_ns_till_idle(device_states_.size());
+    for (int i = 0; i < device_states_.size(); ++i) {
+      estimated_ns_till_idle[i] = ServingDeviceSelector::EstimateTimeTillIdleNs(
+          device_states_[i], 0, min_exec_time_.value_or(kDefaultEstimateNs),
+          now_ns);
+    }
+    DeviceStates device_states;
+    device_states.states = absl::Span<const DeviceState>(device_states_);
+    device_states.estimated_ns_till_idle = estimated_ns_till_idle;
+    device_states.free_memory_bytes = free_memory_bytes_;
+    device_index = device_selector_policy_->SelectDevice(program_fingerprint,
+                                                         device_states);
+    if (!affinity_key.empty()) {
+      affinity_devices_.emplace(affinity_key, device_index);
+    }
+  }
 
   ServingDeviceSelector::EnqueueHelper(
       device_states_.at(device_index), device_index, it->second,
@@ -67,6 +112,18 @@ tsl::DeviceReservation GpuServingDeviceSelector::ReserveDevice(
   return tsl::DeviceReservation(device_index, this);
 }
 
+void GpuServingDeviceSelector::ReleaseAffinity(
+    absl::string_view affinity_key) {
+  absl::MutexLock lock(&mu_);
+  affinity_devices_.erase(affinity_key);
+}
+
+void GpuServingDeviceSelector::SetFreeMemoryBytes(int32_t index_on_host,
+                                                  int64_t free_bytes) {
+  absl::MutexLock lock(&mu_);
+  free_memory_bytes_.at(index_on_host) = free_bytes;
+}
+
 void GpuServingDeviceSelector::FreeDeviceReservation(
     const tsl::DeviceReservation& reservation) {
   Completed(reservation.device_index(), /*had_error=*/false);
@@ -81,7 +138,7 @@ void GpuServingDeviceSelector::Enqueue(int32_t index_on_host,
 
   absl::MutexLock lock(&mu_);
   auto [it, emplaced] =
-      execution_info_.try_emplace(fingerprint, ExecutionInfo());
+      execution_info_.try_emplace(fingerprint, GpuExecutionInfo());
 
   DeviceState& device_state = device_states_.at(index_on_host);
   ServingDeviceSelector::EnqueueHelper(device_state, index_on_host, it->second,
@@ -99,8 +156,10 @@ void GpuServingDeviceSelector::Completed(int32_t index_on_host,
                                          bool had_error) {
   absl::MutexLock lock(&mu_);
   DeviceState& device_state = device_states_.at(index_on_host);
+  const int64_t now_ns = NowNs();
+  RecordRecentTime(device_state, had_error, now_ns);
   ServingDeviceSelector::CompletedHelper(device_state, index_on_host, 0,
-                                         min_exec_time_, had_error, NowNs());
+                                         min_exec_time_, had_error, now_ns);
 
   int64_t total_estimated_time_ns = TotalEstimatedTimeTillIdleNs();
   GpuSchedulingMetricsStorage::GetGlobalStorage().TotalGpuLoadNs().Set(
@@ -116,6 +175,23 @@ int64_t GpuServingDeviceSelector::TotalEstimatedTimeTillIdleNs() {
   return total_gpu_load_ns;
 }
 
+void GpuServingDeviceSelector::RecordRecentTime(const DeviceState& device_state,
+                                                bool had_error,
+                                                int64_t now_ns) {
+  // Like CompletedHelper(), only trust the time of programs that ran
+  // back-to-back without a host round trip.
+  if (device_state.timer_reset || had_error ||
+      device_state.enqueued_programs[0].empty()) {
+    return;
+  }
+  const std::string& fingerprint =
+      device_state.enqueued_programs[0].front().fingerprint;
+  auto it = execution_info_.find(fingerprint);
+  if (it != execution_info_.end()) {
+    it->second.AddRecentTime(now_ns - device_state.last_started_ns);
+  }
+}
+
 /*static*/ void GpuServingDeviceSelector::OverwriteNowNsFunctionForTest(
     int64_t (*now_ns)()) {
   NowNs = now_ns;
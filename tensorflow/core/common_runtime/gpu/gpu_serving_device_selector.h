@@ -17,10 +17,12 @@ limitations under the License.
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <string>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/container/fixed_array.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/node_hash_map.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
@@ -51,6 +53,20 @@ class GpuServingDeviceSelectorResource : public ResourceBase {
   std::unique_ptr<GpuServingDeviceSelector> selector_;
 };
 
+// Estimates the execution time of a program with an exponentially weighted
+// moving average of its recent execution times, which follows changes in the
+// execution time, e.g. because of contention between the devices, far more
+// quickly than the average of all executions.
+class GpuExecutionInfo : public tsl::ServingDeviceSelector::ExecutionInfo {
+ public:
+  void AddRecentTime(int64_t value);
+
+  int64_t MaybeGetValidTime(int result) const override;
+
+ private:
+  std::optional<double> recent_time_ns_;
+};
+
 class GpuServingDeviceSelector : public tsl::ServingDeviceSelector {
  public:
   GpuServingDeviceSelector(
@@ -60,6 +76,19 @@ class GpuServingDeviceSelector : public tsl::ServingDeviceSelector {
   tsl::DeviceReservation ReserveDevice(
       absl::string_view program_fingerprint) override;
 
+  // Like ReserveDevice() above, but requests with the same non-empty
+  // `affinity_key`, e.g. the requests of a session of a stateful model, are
+  // routed to the same device until ReleaseAffinity() is called for the key.
+  tsl::DeviceReservation ReserveDevice(absl::string_view program_fingerprint,
+                                       absl::string_view affinity_key);
+
+  // Lets the requests with `affinity_key` be routed to any device again.
+  void ReleaseAffinity(absl::string_view affinity_key);
+
+  // Reports the free memory of the device of index `index_on_host`, which
+  // the device selector policy takes into account. Negative if unknown.
+  void SetFreeMemoryBytes(int32_t index_on_host, int64_t free_bytes);
+
   // Enqueues the program on the stream of index `index_on_host`.
   void Enqueue(int32_t index_on_host, absl::string_view fingerprint) override;
 
@@ -78,14 +107,23 @@ class GpuServingDeviceSelector : public tsl::ServingDeviceSelector {
   // Only for metrics reporting purposes.
   int64_t TotalEstimatedTimeTillIdleNs() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Updates the recent execution time of the program at the front of
+  // `device_state` that completes at `now_ns`.
+  void RecordRecentTime(const DeviceState& device_state, bool had_error,
+                        int64_t now_ns) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   absl::Mutex mu_;
   absl::FixedArray<DeviceState, 8> device_states_ ABSL_GUARDED_BY(mu_);
   std::unique_ptr<ServingDeviceSelector::Policy> device_selector_policy_;
   int64_t req_id_counter_ ABSL_GUARDED_BY(mu_);
   // Map from program fingerprint to execution info.
-  absl::node_hash_map<std::string, ExecutionInfo> execution_info_
+  absl::node_hash_map<std::string, GpuExecutionInfo> execution_info_
       ABSL_GUARDED_BY(mu_);
   std::optional<int64_t> min_exec_time_ ABSL_GUARDED_BY(mu_);
+  // The free memory of each device reported by SetFreeMemoryBytes().
+  absl::FixedArray<int64_t, 8> free_memory_bytes_ ABSL_GUARDED_BY(mu_);
+  // Map from affinity key to the device its requests are routed to.
+  absl::flat_hash_map<std::string, int> affinity_devices_ ABSL_GUARDED_BY(mu_);
 };
 
 }  // namespace gpu
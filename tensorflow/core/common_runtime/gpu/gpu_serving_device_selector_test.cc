@@ -20,6 +20,7 @@ limitations under the License.
 #include <utility>
 
 #include <gtest/gtest.h>
+#include "absl/strings/string_view.h"
 #include "absl/time/clock.h"
 #include "xla/tsl/framework/serving_device_selector.h"
 #include "xla/tsl/framework/serving_device_selector_policies.h"
@@ -135,6 +136,81 @@ TEST(GpuServingDeviceSelector, DefaultPolicyOnlyEnqueueCall) {
       0e6);
 }
 
+// Runs `num_runs` back-to-back executions of `fingerprint` taking `ns` each
+// on device `index_on_host`.
+void RunBackToBack(GpuServingDeviceSelector& selector,
+                   ServingDeviceSelectorTestHelper& helper, int index_on_host,
+                   absl::string_view fingerprint, int num_runs, int64_t ns) {
+  // The first execution only starts the timer.
+  for (int i = 0; i <= num_runs; ++i) {
+    selector.Enqueue(index_on_host, fingerprint);
+  }
+  for (int i = 0; i <= num_runs; ++i) {
+    helper.ElapseNs(ns);
+    selector.Completed(index_on_host, false);
+  }
+}
+
+TEST(GpuServingDeviceSelector, RecentExecutionTime) {
+  ServingDeviceSelectorTestHelper helper;
+  GpuServingDeviceSelector selector(/*num_devices=*/1,
+                                    std::make_unique<tsl::RoundRobinPolicy>());
+  RunBackToBack(selector, helper, 0, "A", /*num_runs=*/4, /*ns=*/1e6);
+  RunBackToBack(selector, helper, 0, "A", /*num_runs=*/1, /*ns=*/9e6);
+
+  // The estimate moves a quarter of the way towards the latest time, while
+  // the average of all runs would be 2.6ms.
+  selector.Enqueue(0, "A");
+  EXPECT_EQ(
+      GpuSchedulingMetricsStorage::GetGlobalStorage().TotalGpuLoadNs().Get(),
+      3e6);
+  selector.Completed(0, false);
+}
+
+TEST(GpuServingDeviceSelector, LeastLoadedPolicy) {
+  ServingDeviceSelectorTestHelper helper;
+  GpuServingDeviceSelector selector(
+      /*num_devices=*/2, std::make_unique<tsl::LeastLoadedPolicy>());
+  RunBackToBack(selector, helper, 0, "A", /*num_runs=*/1, /*ns=*/1e6);
+
+  selector.Enqueue(0, "A");
+  tsl::DeviceReservation reservation = selector.ReserveDevice("A");
+  EXPECT_EQ(reservation.device_index(), 1);
+  selector.Completed(0, false);
+}
+
+TEST(GpuServingDeviceSelector, LeastLoadedPolicyAvoidsFullDevices) {
+  ServingDeviceSelectorTestHelper helper;
+  GpuServingDeviceSelector selector(
+      /*num_devices=*/2,
+      std::make_unique<tsl::LeastLoadedPolicy>(/*min_free_memory_bytes=*/1000));
+  RunBackToBack(selector, helper, 0, "A", /*num_runs=*/1, /*ns=*/1e6);
+  selector.SetFreeMemoryBytes(0, 100);
+  selector.SetFreeMemoryBytes(1, 1 << 20);
+
+  // Device 1 is busier, but device 0 is short of memory.
+  selector.Enqueue(1, "A");
+  tsl::DeviceReservation reservation = selector.ReserveDevice("A");
+  EXPECT_EQ(reservation.device_index(), 1);
+  selector.Completed(1, false);
+}
+
+TEST(GpuServingDeviceSelector, Affinity) {
+  ServingDeviceSelectorTestHelper helper;
+  GpuServingDeviceSelector selector(
+      /*num_devices=*/2, std::make_unique<tsl::LeastLoadedPolicy>());
+  RunBackToBack(selector, helper, 0, "A", /*num_runs=*/1, /*ns=*/1e6);
+
+  tsl::DeviceReservation first = selector.ReserveDevice("A", "session");
+  // The requests of the session stay on the device although it is busier.
+  tsl::DeviceReservation second = selector.ReserveDevice("A", "session");
+  EXPECT_EQ(second.device_index(), first.device_index());
+
+  selector.ReleaseAffinity("session");
+  tsl::DeviceReservation third = selector.ReserveDevice("A", "session");
+  EXPECT_NE(third.device_index(), first.device_index());
+}
+
 }  // namespace
 }  // namespace gpu
 }  // namespace tensorflow
@@ -0,0 +1,108 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace gpu_stream_util {
+namespace {
+
+// Returns true if `node` has no consumers other than the sink node.
+bool IsTerminal(const Node* node) {
+  for (const Edge* e : node->out_edges()) {
+    if (e->dst()->IsOp()) return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+absl::Status AssignStreams(const Graph* graph, const AssignStreamsOpts& opts,
+                           std::vector<int>* node_to_stream_id) {
+  if (opts.num_streams < 1) {
+    return errors::InvalidArgument("Invalid number of streams: ",
+                                   opts.num_streams);
+  }
+  node_to_stream_id->assign(graph->num_node_ids(), 0);
+  if (opts.num_streams == 1) {
+    return absl::OkStatus();
+  }
+  for (const Node* n : graph->op_nodes()) {
+    if (n->IsControlFlow()) {
+      return absl::OkStatus();
+    }
+  }
+
+  std::vector<Node*> order;
+  GetReversePostOrder(*graph, &order, NodeComparatorID());
+  // Whether a node's stream has already been continued by a consumer.
+  std::vector<bool> continued(graph->num_node_ids(), false);
+  int next_stream = 1;
+  for (const Node* n : order) {
+    if (!n->IsOp()) continue;
+    int stream = 0;
+    if (!n->IsArg() && !n->IsRetval() && !n->IsSend() && !n->IsRecv() &&
+        !IsTerminal(n)) {
+      stream = -1;
+      std::vector<const Edge*> input_edges;
+      TF_RETURN_IF_ERROR(n->input_edges(&input_edges));
+      for (const Edge* e : input_edges) {
+        if (!e->src()->IsOp() || continued[e->src()->id()]) continue;
+        continued[e->src()->id()] = true;
+        stream = (*node_to_stream_id)[e->src()->id()];
+        break;
+      }
+      if (stream < 0) {
+        stream = next_stream;
+        next_stream = (next_stream + 1) % opts.num_streams;
+      }
+    }
+    (*node_to_stream_id)[n->id()] = stream;
+  }
+  return absl::OkStatus();
+}
+
+std::vector<int> StreamsToWaitFor(const Node* node,
+                                  const std::vector<int>& node_to_stream_id) {
+  const int stream = node_to_stream_id[node->id()];
+  std::vector<int> streams;
+  bool has_producers = false;
+  for (const Edge* e : node->in_edges()) {
+    if (!e->src()->IsOp()) continue;
+    has_producers = true;
+    const int src_stream = node_to_stream_id[e->src()->id()];
+    if (src_stream != stream &&
+        std::find(streams.begin(), streams.end(), src_stream) ==
+            streams.end()) {
+      streams.push_back(src_stream);
+    }
+  }
+  if (!has_producers && stream != 0) {
+    streams.push_back(0);
+  }
+  std::sort(streams.begin(), streams.end());
+  return streams;
+}
+
+}  // namespace gpu_stream_util
+}  // namespace tensorflow
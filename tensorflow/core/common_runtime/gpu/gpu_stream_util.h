@@ -0,0 +1,55 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_UTIL_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_UTIL_H_
+
+#include <vector>
+
+#include "absl/status/status.h"
+#include "tensorflow/core/graph/graph.h"
+
+namespace tensorflow {
+namespace gpu_stream_util {
+
+struct AssignStreamsOpts {
+  // The number of compute streams to spread the nodes over.
+  int num_streams = 1;
+};
+
+// Assigns every node of `graph` to a compute stream in
+// [0, opts.num_streams), and sets `node_to_stream_id` to the assignment
+// indexed by node id.
+//
+// A node continues the stream of its first data input whose producer has not
+// been continued by another node, so that chains of dependent nodes do not
+// wait across streams. Nodes that start a new chain, such as the branches of
+// a fan-out, are spread across the streams round-robin. Arguments, return
+// values, sends, receives and nodes without consumers run on stream 0, which
+// thereby joins the other streams at the end of the step. Graphs with
+// control flow run on stream 0 only.
+absl::Status AssignStreams(const Graph* graph, const AssignStreamsOpts& opts,
+                           std::vector<int>* node_to_stream_id);
+
+// Returns the streams other than its own that `node` waits for before it
+// runs: the streams of the producers of its inputs, or stream 0 for a node
+// without producers, which orders it after the previous steps.
+std::vector<int> StreamsToWaitFor(const Node* node,
+                                  const std::vector<int>& node_to_stream_id);
+
+}  // namespace gpu_stream_util
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_GPU_GPU_STREAM_UTIL_H_
@@ -0,0 +1,121 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/gpu/gpu_stream_util.h"
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace gpu_stream_util {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+class GpuStreamUtilTest : public ::testing::Test {
+ protected:
+  GpuStreamUtilTest() : graph_(std::make_unique<Graph>(OpRegistry::Global())) {}
+
+  std::vector<int> Assign(int num_streams) {
+    AssignStreamsOpts opts;
+    opts.num_streams = num_streams;
+    std::vector<int> node_to_stream_id;
+    TF_CHECK_OK(AssignStreams(graph_.get(), opts, &node_to_stream_id));
+    return node_to_stream_id;
+  }
+
+  std::unique_ptr<Graph> graph_;
+};
+
+TEST_F(GpuStreamUtilTest, TwoTowers) {
+  // ret <- (square(square(a)) + square(square(a)))
+  Node* a = test::graph::Arg(graph_.get(), 0, DT_FLOAT);
+  Node* x0 = test::graph::Unary(graph_.get(), "Square", a);
+  Node* x1 = test::graph::Unary(graph_.get(), "Square", a);
+  Node* y0 = test::graph::Unary(graph_.get(), "Square", x0);
+  Node* y1 = test::graph::Unary(graph_.get(), "Square", x1);
+  Node* sum = test::graph::Add(graph_.get(), y0, y1);
+  Node* ret = test::graph::Retval(graph_.get(), 0, sum);
+
+  const std::vector<int> streams = Assign(4);
+  EXPECT_EQ(streams[a->id()], 0);
+  EXPECT_EQ(streams[ret->id()], 0);
+  // Each tower runs on a stream of its own, and the sum continues the stream
+  // of its first input.
+  EXPECT_EQ(streams[x0->id()], streams[y0->id()]);
+  EXPECT_EQ(streams[x1->id()], streams[y1->id()]);
+  EXPECT_NE(streams[x0->id()], streams[x1->id()]);
+  EXPECT_EQ(streams[sum->id()], streams[y0->id()]);
+
+  EXPECT_THAT(StreamsToWaitFor(y0, streams), IsEmpty());
+  EXPECT_THAT(StreamsToWaitFor(sum, streams), ElementsAre(streams[y1->id()]));
+}
+
+TEST_F(GpuStreamUtilTest, OneStream) {
+  Node* a = test::graph::Arg(graph_.get(), 0, DT_FLOAT);
+  Node* x0 = test::graph::Unary(graph_.get(), "Square", a);
+  Node* x1 = test::graph::Unary(graph_.get(), "Square", a);
+  test::graph::Retval(graph_.get(), 0, test::graph::Add(graph_.get(), x0, x1));
+
+  for (int stream : Assign(1)) {
+    EXPECT_EQ(stream, 0);
+  }
+}
+
+TEST_F(GpuStreamUtilTest, RootsWaitForStreamZero) {
+  Tensor one(DT_FLOAT, TensorShape({}));
+  one.scalar<float>()() = 1.0;
+  Node* c = test::graph::Constant(graph_.get(), one);
+  Node* x = test::graph::Unary(graph_.get(), "Square", c);
+  test::graph::Retval(graph_.get(), 0, x);
+
+  const std::vector<int> streams = Assign(2);
+  EXPECT_EQ(streams[c->id()], 1);
+  EXPECT_THAT(StreamsToWaitFor(c, streams), ElementsAre(0));
+  EXPECT_THAT(StreamsToWaitFor(x, streams), IsEmpty());
+}
+
+TEST_F(GpuStreamUtilTest, ControlFlowRunsOnOneStream) {
+  Node* a = test::graph::Arg(graph_.get(), 0, DT_FLOAT);
+  Node* pred = test::graph::Arg(graph_.get(), 1, DT_BOOL);
+  Node* sw = test::graph::Switch(graph_.get(), a, pred);
+  Node* x0 = test::graph::Unary(graph_.get(), "Square", sw, 0);
+  Node* x1 = test::graph::Unary(graph_.get(), "Square", sw, 1);
+  Node* merge = test::graph::Merge(graph_.get(), x0, x1);
+  test::graph::Retval(graph_.get(), 0, merge);
+
+  for (int stream : Assign(4)) {
+    EXPECT_EQ(stream, 0);
+  }
+}
+
+TEST_F(GpuStreamUtilTest, InvalidNumStreams) {
+  AssignStreamsOpts opts;
+  opts.num_streams = 0;
+  std::vector<int> node_to_stream_id;
+  EXPECT_FALSE(AssignStreams(graph_.get(), opts, &node_to_stream_id).ok());
+}
+
+}  // namespace
+}  // namespace gpu_stream_util
+}  // namespace tensorflow
@@ -236,6 +236,42 @@ TEST(PoolAllocatorTest, Pow2Rounder) {
   EXPECT_EQ(65536, rounder.RoundUp(65536));
 }
 
+TEST(PoolAllocatorTest, SizeClassRounder) {
+  SizeClassRounder rounder;
+  EXPECT_EQ(1, rounder.RoundUp(1));
+  EXPECT_EQ(7, rounder.RoundUp(7));
+  EXPECT_EQ(10, rounder.RoundUp(9));
+  EXPECT_EQ(16, rounder.RoundUp(15));
+  EXPECT_EQ(49152, rounder.RoundUp(41234));
+  EXPECT_EQ(65536, rounder.RoundUp(65535));
+  EXPECT_EQ(65536, rounder.RoundUp(65536));
+  EXPECT_EQ(81920, rounder.RoundUp(65537));
+}
+
+TEST(PoolAllocatorTest, SizeClassReuse) {
+  se::Platform* platform =
+      se::PlatformManager::PlatformWithName(se::GpuPlatformName()).value();
+  PoolAllocator pool(2 /*pool_size_limit*/, false /*auto_resize*/,
+                     new DeviceHostAllocator(
+                         platform->ExecutorForDevice(/*ordinal=*/0).value(),
+                         0 /*numa_node*/, {}, {}),
+                     new SizeClassRounder, "pool");
+  // Requests of slightly different sizes share a size class.
+  void* p1 = pool.AllocateRaw(4, 40000);
+  pool.DeallocateRaw(p1);
+  void* p2 = pool.AllocateRaw(4, 41000);
+  EXPECT_EQ(p1, p2);
+  pool.DeallocateRaw(p2);
+  EXPECT_EQ(1, pool.get_from_pool_count());
+  EXPECT_EQ(1, pool.allocated_count());
+  EXPECT_DOUBLE_EQ(0.5, pool.hit_rate());
+  // Each request includes a 16B ChunkPrefix and is rounded up to 49152.
+  EXPECT_EQ((49152 - 40016) + (49152 - 41016), pool.rounding_waste_bytes());
+
+  pool.Clear();
+  EXPECT_EQ(0, pool.rounding_waste_bytes());
+}
+
 TEST(PoolAllocatorTest, Name) {
   se::Platform* platform =
       se::PlatformManager::PlatformWithName(se::GpuPlatformName()).value();
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_GPU_DEVICE_CONTEXT_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_GPU_DEVICE_CONTEXT_H_
 
+#include <utility>
+
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
@@ -60,6 +62,14 @@ class GPUDeviceContext : public DeviceContext {
     return device_to_device_stream_[index % device_to_device_stream_.size()];
   }
   int stream_id() const { return stream_id_; }
+  // The other compute streams of the device that `stream()` waits for before
+  // the kernel using this context is launched.
+  const absl::InlinedVector<se::Stream*, 2UL>& wait_streams() const {
+    return wait_streams_;
+  }
+  void set_wait_streams(absl::InlinedVector<se::Stream*, 2UL> wait_streams) {
+    wait_streams_ = std::move(wait_streams);
+  }
   Allocator* host_memory_allocator() const override {
     return host_memory_allocator_;
   }
@@ -97,6 +107,8 @@ class GPUDeviceContext : public DeviceContext {
   se::Stream* device_to_host_stream_;
   // Streams to use for copying data between GPUs.
   absl::InlinedVector<se::Stream*, 4UL> device_to_device_stream_;
+  // Compute streams that `stream_` waits for.
+  absl::InlinedVector<se::Stream*, 2UL> wait_streams_;
   // The allocator to use for allocating pinned host memory.
   // Not owned.
   Allocator* host_memory_allocator_;
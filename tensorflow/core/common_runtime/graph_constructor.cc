@@ -45,6 +45,7 @@ limitations under the License.
 #include "tensorflow/core/graph/graph_debug_info_builder.h"
 #include "tensorflow/core/graph/tensor_id.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
@@ -107,7 +108,8 @@ class GraphConstructor {
           importing(false),
           validate_nodes(in.validate_nodes),
           validate_colocation_constraints(false),
-          add_default_attributes(in.add_default_attributes) {}
+          add_default_attributes(in.add_default_attributes),
+          thread_pool(in.thread_pool) {}
     Options(const ImportGraphDefOptions& in)  // NOLINT(runtime/explicit)
         : allow_internal_ops(false),
           expect_device_spec(false),
@@ -162,6 +164,9 @@ class GraphConstructor {
     bool add_default_attributes = true;
 
     string default_device;
+
+    // Not owned. May be null.
+    thread::ThreadPool* thread_pool = nullptr;
   };
 
   typedef absl::Span<const NodeDef* const> NodeDefSlice;
@@ -248,6 +253,12 @@ class GraphConstructor {
                         int input_index);
   absl::Status ValidateShape(Node* node);
   absl::Status ModifyNodeDefForImport(NodeDef* node_def);
+  // Looks up the op of `node_def`, and adds default attributes and validates
+  // it as requested by `opts_`.
+  absl::Status PrepareNodeDef(NodeDef* node_def) const;
+  // Calls PrepareNodeDef() for all nodes in parallel using
+  // `opts_.thread_pool`.
+  absl::Status PrepareNodeDefsInParallel();
   // Modifies node_def's inputs according to opts_.input_map.
   // input_already_exists is a pre-initialized vector of length
   // node_def->input_size(). This function will mark inputs that are remapped to
@@ -301,6 +312,9 @@ class GraphConstructor {
   // possible. After calling this method, the result of get_node_def(i) is
   // undefined.
   virtual NodeDef consume_node_def(int i) = 0;
+  // Returns the i^th node in the graph for in-place modification, or nullptr
+  // if the nodes are not owned. Must not be called after consume_node_def(i).
+  virtual NodeDef* mutable_node_def(int i) { return nullptr; }
   // Returns the version information for the graph, or nullptr if none is
   // available.
   virtual const VersionDef* versions() const = 0;
@@ -478,6 +492,11 @@ class NodeDefMovingGraphConstructor : public GraphConstructor {
     is_consumed_[i] = true;
     return std::move(*graph_def_.mutable_node(i));
   }
+  NodeDef* mutable_node_def(int i) override {
+    CHECK(!is_consumed_[i])
+        << "NodeDef " << i << " accessed after it was consumed.";
+    return graph_def_.mutable_node(i);
+  }
   const VersionDef* versions() const override { return &graph_def_.versions(); }
   std::optional<FunctionDefLibrary> consume_library() override {
     return std::move(*graph_def_.mutable_library());
@@ -864,6 +883,35 @@ absl::Status GraphConstructor::ValidateShape(Node* node) {
   return absl::OkStatus();
 }
 
+absl::Status GraphConstructor::PrepareNodeDef(NodeDef* node_def) const {
+  const OpDef* op_def;
+  TF_RETURN_IF_ERROR(g_->op_registry()->LookUpOpDef(node_def->op(), &op_def));
+  if (opts_.add_default_attributes) {
+    AddDefaultsToNodeDef(*op_def, node_def);
+  }
+  if (opts_.validate_nodes) {
+    TF_RETURN_IF_ERROR(ValidateNodeDef(*node_def, *op_def));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status GraphConstructor::PrepareNodeDefsInParallel() {
+  const int64_t num_nodes = node_def_count();
+  std::vector<absl::Status> statuses(num_nodes);
+  // Op lookup and validation cost a few microseconds per node.
+  constexpr int64_t kCostPerNode = 5000;
+  opts_.thread_pool->ParallelFor(
+      num_nodes, kCostPerNode, [this, &statuses](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          statuses[i] = PrepareNodeDef(mutable_node_def(i));
+        }
+      });
+  for (const absl::Status& s : statuses) {
+    TF_RETURN_IF_ERROR(s);
+  }
+  return absl::OkStatus();
+}
+
 absl::Status GraphConstructor::ModifyNodeDefForImport(NodeDef* node_def) {
   const OpDef* op_def;
   TF_RETURN_IF_ERROR(g_->op_registry()->LookUpOpDef(node_def->op(), &op_def));
@@ -1186,6 +1234,16 @@ absl::Status GraphConstructor::Convert() {
         g_->AddFunctionLibrary(*std::move(library), library_traces));
   }
 
+  // The preparation of each node only depends on the node itself, so it can
+  // be done ahead of the topological traversal below.
+  const bool node_defs_prepared = !opts_.importing &&
+                                  opts_.thread_pool != nullptr &&
+                                  node_def_count() > 0 &&
+                                  mutable_node_def(0) != nullptr;
+  if (node_defs_prepared) {
+    TF_RETURN_IF_ERROR(PrepareNodeDefsInParallel());
+  }
+
   std::vector<InputInfo> inputs;
   int processed = 0;
 
@@ -1298,16 +1356,8 @@ absl::Status GraphConstructor::Convert() {
 
     if (opts_.importing) {
       TF_RETURN_IF_ERROR(ModifyNodeDefForImport(&node_def));
-    } else {
-      const OpDef* op_def;
-      TF_RETURN_IF_ERROR(
-          g_->op_registry()->LookUpOpDef(node_def.op(), &op_def));
-      if (opts_.add_default_attributes) {
-        AddDefaultsToNodeDef(*op_def, &node_def);
-      }
-      if (opts_.validate_nodes) {
-        TF_RETURN_IF_ERROR(ValidateNodeDef(node_def, *op_def));
-      }
+    } else if (!node_defs_prepared) {
+      TF_RETURN_IF_ERROR(PrepareNodeDef(&node_def));
     }
 
     TF_RETURN_IF_ERROR(MakeNode(std::move(node_def), &node));
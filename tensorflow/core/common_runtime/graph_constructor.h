@@ -23,6 +23,9 @@ limitations under the License.
 
 namespace tensorflow {
 class ShapeRefiner;
+namespace thread {
+class ThreadPool;
+}  // namespace thread
 
 // Construct a Graph *g out of a GraphDef gdef. Returns non-OK on
 // error, in which case *g is left in an incomplete state.
@@ -52,6 +55,12 @@ struct GraphConstructorOptions {
   // If true, GraphConstructor will add attributes with their default
   // value to the Node when they are missing from the NodeDef.
   bool add_default_attributes = true;
+
+  // If not null, the per-node work that does not depend on other nodes (op
+  // lookup, adding default attributes and validation) is performed on this
+  // thread pool before the nodes are added to the graph. Only used by the
+  // ConvertGraphDefToGraph() overload that takes ownership of the GraphDef.
+  thread::ThreadPool* thread_pool = nullptr;
 };
 extern absl::Status ConvertGraphDefToGraph(const GraphConstructorOptions& opts,
                                            const GraphDef& gdef, Graph* g);
@@ -31,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/ops_util.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/logging.h"
@@ -917,6 +918,34 @@ TEST_F(GraphConstructorTest, SimpleModelWithControlEdges) {
   EXPECT_TRUE(HasControlEdge("t1", "t2"));
 }
 
+TEST_F(GraphConstructorTest, ConvertWithThreadPool) {
+  thread::ThreadPool pool(Env::Default(), "test", 2);
+  GraphConstructorOptions opts;
+  opts.thread_pool = &pool;
+  GraphDef gdef;
+  ASSERT_TRUE(protobuf::TextFormat::ParseFromString(
+      "node { name: 'W1' op: 'TestParams' }"
+      "node { name: 'input' op: 'TestInput' }"
+      "node { name: 't1' op: 'TestMul' input: [ 'W1', 'input:1' ] }"
+      "node { name: 'd' op: 'TestDefaultAttr' }",
+      &gdef));
+  TF_ASSERT_OK(ConvertGraphDefToGraph(opts, std::move(gdef), &graph_));
+  EXPECT_TRUE(HasEdge("W1", 0, "t1", 0));
+  EXPECT_TRUE(HasEdge("input", 1, "t1", 1));
+  int default_int;
+  TF_ASSERT_OK(
+      GetNodeAttr(FindNode("d")->attrs(), "default_int", &default_int));
+  EXPECT_EQ(31415, default_int);
+
+  // Errors found while preparing the nodes are reported.
+  GraphDef bad_gdef;
+  ASSERT_TRUE(protobuf::TextFormat::ParseFromString(
+      "node { name: 'x' op: 'UnknownOp' }", &bad_gdef));
+  Graph graph(OpRegistry::Global());
+  absl::Status s = ConvertGraphDefToGraph(opts, std::move(bad_gdef), &graph);
+  EXPECT_TRUE(absl::StrContains(s.message(), "UnknownOp")) << s;
+}
+
 TEST_F(GraphConstructorTest, Error_ControlEdgeBeforeRealInput) {
   ExpectError(
       "node { name: 'W1' op: 'TestParams' }"
@@ -27,9 +27,11 @@ limitations under the License.
 #include "absl/strings/str_join.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/graph_constructor.h"
+#include "tensorflow/core/common_runtime/optimized_graph_cache.h"
 #include "tensorflow/core/common_runtime/optimization_registry.h"
 #include "tensorflow/core/common_runtime/placer.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/device_factory.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/function.pb.h"
@@ -48,8 +50,11 @@ limitations under the License.
 #include "tensorflow/core/graph/validate.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/flatset.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/device_name_utils.h"
@@ -69,6 +74,23 @@ bool IsCollectiveV2(const string& op) {
          op == "CollectiveBcastRecvV2" || op == "CollectiveBcastSendV2" ||
          op == "ColectiveReduceScatterV2" || op == "ColectiveAllToAllV2";
 }
+
+// Graphs with at least this many nodes prepare their nodes on a temporary
+// thread pool during conversion to a Graph.
+constexpr int kMinNodesForParallelConversion = 4096;
+
+// Like ConvertGraphDefToGraph(), but uses multiple threads for large graphs.
+absl::Status ConvertLargeGraphDefToGraph(GraphConstructorOptions opts,
+                                         GraphDef&& gdef, Graph* g) {
+  std::unique_ptr<thread::ThreadPool> pool;
+  if (gdef.node_size() >= kMinNodesForParallelConversion &&
+      port::MaxParallelism() > 1) {
+    pool = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "graph_construction", port::MaxParallelism());
+    opts.thread_pool = pool.get();
+  }
+  return ConvertGraphDefToGraph(opts, std::move(gdef), g);
+}
 }  // namespace
 
 GraphExecutionState::GraphExecutionState(
@@ -122,8 +144,8 @@ GraphExecutionState::~GraphExecutionState() {
     auto ret = absl::WrapUnique(
         new GraphExecutionState(nullptr, std::move(flib_def), options));
     auto base_graph = std::make_unique<Graph>(OpRegistry::Global());
-    TF_RETURN_IF_ERROR(
-        ConvertGraphDefToGraph({}, std::move(graph_def), base_graph.get()));
+    TF_RETURN_IF_ERROR(ConvertLargeGraphDefToGraph({}, std::move(graph_def),
+                                                   base_graph.get()));
     TF_RETURN_IF_ERROR(ret->InitBaseGraph(std::move(base_graph)));
     *out_state = std::move(ret);
   }
@@ -168,7 +190,7 @@ GraphExecutionState::~GraphExecutionState() {
 
   auto base_graph = std::make_unique<Graph>(OpRegistry::Global());
   TF_RETURN_IF_ERROR(
-      ConvertGraphDefToGraph({}, std::move(temp), base_graph.get()));
+      ConvertLargeGraphDefToGraph({}, std::move(temp), base_graph.get()));
 
   // Rewrite the graph before placement.
   ret->rewrite_metadata_.reset(new subgraph::RewriteGraphMetadata);
@@ -814,11 +836,42 @@ absl::Status GraphExecutionState::OptimizeGraph(
       }
     }
 
+    // Reuse a previously optimized graph for the same inputs, if any.
+    std::unique_ptr<OptimizedGraphCache> graph_cache;
+    std::string graph_cache_key;
+    const string& graph_cache_dir =
+        session_options_->config.experimental().optimized_graph_cache_dir();
+    if (!graph_cache_dir.empty()) {
+      graph_cache = std::make_unique<OptimizedGraphCache>(Env::Default(),
+                                                          graph_cache_dir);
+      std::vector<DeviceAttributes> devices;
+      devices.reserve(device_set_->devices().size());
+      for (const Device* d : device_set_->devices()) {
+        devices.push_back(d->attributes());
+      }
+      std::vector<string> feeds;
+      feeds.reserve(item.feed.size());
+      for (const auto& feed : item.feed) {
+        feeds.push_back(feed.first);
+      }
+      graph_cache_key = OptimizedGraphCache::Key(
+          item.graph, devices, feeds, item.fetch, session_options_->config);
+    }
+
     // Now we can run the MetaOptimizer on the constructed GrapplerItem.
     GraphDef new_graph;
-    TF_RETURN_IF_ERROR(
-        grappler::RunMetaOptimizer(std::move(item), session_options_->config,
-                                   cpu_device, &cluster, &new_graph));
+    if (graph_cache == nullptr ||
+        !graph_cache->Lookup(graph_cache_key, &new_graph)) {
+      TF_RETURN_IF_ERROR(grappler::RunMetaOptimizer(
+          std::move(item), session_options_->config, cpu_device, &cluster,
+          &new_graph));
+      if (graph_cache != nullptr) {
+        absl::Status s = graph_cache->Insert(graph_cache_key, new_graph);
+        if (!s.ok()) {
+          LOG(WARNING) << "Failed to cache the optimized graph: " << s;
+        }
+      }
+    }
 
     // Merge optimized graph function library with an original library.
     // Optimized graph might have new functions specialized for it's
@@ -842,8 +895,8 @@ absl::Status GraphExecutionState::OptimizeGraph(
     // Convert the optimized GraphDef back to a Graph.
     GraphConstructorOptions opts;
     opts.allow_internal_ops = true;
-    TF_RETURN_IF_ERROR(ConvertGraphDefToGraph(opts, std::move(new_graph),
-                                              optimized_graph->get()));
+    TF_RETURN_IF_ERROR(ConvertLargeGraphDefToGraph(
+        opts, std::move(new_graph), optimized_graph->get()));
     // The graph conversion sets the requested device names but not the
     // assigned device names. However, since at this point the graph is placed
     // TF expects an assigned device name for every node. Therefore we copy
@@ -85,6 +85,9 @@ struct NodeItem {
                                     // node's input types.
   bool is_distributed_communication : 1;  // True iff the op is registered to
                                           // use distributed communication.
+  bool may_use_step_arena : 1;  // True iff the node and all consumers of its
+                                // data outputs are stateless, so its outputs
+                                // are unlikely to outlive the step.
 
   // The kernel for this node.
   OpKernel* kernel = nullptr;
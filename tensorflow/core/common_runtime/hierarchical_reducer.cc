@@ -0,0 +1,354 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_reducer.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_rma_local.h"
+#include "tensorflow/core/common_runtime/collective_util.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/dma_helper.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/profiler/lib/traceme.h"
+
+namespace tensorflow {
+
+namespace {
+// Key to be used for BufRendezvous by HierarchicalReducer.
+string ReduceBufKey(const string& exec_key, const char* phase, int step,
+                    int src_idx, int dst_idx) {
+  return strings::StrCat(exec_key, ":", phase, ":", step, ":", src_idx, ":",
+                         dst_idx);
+}
+
+// Waits for asynchronous operations and collects their statuses.
+class PendingOps {
+ public:
+  // Returns the callback of a new operation.
+  StatusCallback Add() {
+    {
+      mutex_lock l(mu_);
+      ++pending_;
+    }
+    return [this](const absl::Status& s) {
+      mutex_lock l(mu_);
+      status_.Update(s);
+      if (--pending_ == 0) all_done_.notify_all();
+    };
+  }
+
+  // Waits for all operations to complete.
+  absl::Status Wait() {
+    mutex_lock l(mu_);
+    while (pending_ > 0) all_done_.wait(l);
+    return status_;
+  }
+
+ private:
+  mutex mu_;
+  condition_variable all_done_;
+  int pending_ TF_GUARDED_BY(mu_) = 0;
+  absl::Status status_ TF_GUARDED_BY(mu_);
+};
+}  // namespace
+
+HierarchicalReducer::HierarchicalReducer()
+    : col_ctx_(nullptr), col_params_(nullptr) {}
+
+absl::Status HierarchicalReducer::InitializeCollectiveParams(
+    CollectiveParams* col_params) {
+  CHECK_EQ(col_params->instance.type, REDUCTION_COLLECTIVE);
+  CHECK_EQ(col_params->instance.impl_details.collective_name,
+           "HierarchicalReduce");
+  if (col_params->group.device_type != DEVICE_CPU) {
+    return errors::InvalidArgument(
+        "HierarchicalReduce only supports CPU devices, got ",
+        col_params->group.device_type.type_string());
+  }
+  // Precondition: device_names must be sorted so that all devices in
+  // the same task are adjacent.
+  auto& perms = col_params->instance.impl_details.subdiv_permutations;
+  perms.clear();
+  perms.emplace_back();
+  for (int di = 0; di < col_params->group.group_size; ++di) {
+    if (di == 0 || col_params->group.members[di].task !=
+                       col_params->group.members[di - 1].task) {
+      perms[0].push_back(di);
+      perms.emplace_back();
+    }
+    perms.back().push_back(di);
+  }
+  col_params->subdiv_rank.assign(perms.size(), -1);
+  for (int sdi = 0; sdi < perms.size(); ++sdi) {
+    for (int r = 0; r < perms[sdi].size(); ++r) {
+      if (perms[sdi][r] == col_params->default_rank) {
+        col_params->subdiv_rank[sdi] = r;
+      }
+    }
+  }
+  VLOG(2) << collective_util::SubdivPermDebugString(*col_params);
+  return absl::OkStatus();
+}
+
+absl::Status HierarchicalReducer::InitializeCollectiveContext(
+    std::shared_ptr<CollectiveContext> col_ctx) {
+  CHECK(col_ctx->dev_mgr);
+  col_ctx_ = col_ctx;
+  col_params_ = col_ctx->col_params.get();
+  return collective_util::InitializeDeviceAndLocality(
+      col_ctx->dev_mgr, col_ctx->device_name, &col_ctx->device,
+      &col_ctx->device_locality);
+}
+
+void HierarchicalReducer::Run(StatusCallback done) {
+  CHECK(col_ctx_);
+  CHECK(col_params_);
+  // Since `HierarchicalReducer` doesn't require non-overlapping collectives,
+  // unblock any collective that is blocked on this instance.
+  col_ctx_->col_exec->UnblockDependencies(*col_params_);
+
+  int local_subdiv = -1;
+  for (int sdi = 1; sdi < col_params_->subdiv_rank.size(); ++sdi) {
+    if (col_params_->subdiv_rank[sdi] >= 0) local_subdiv = sdi;
+  }
+  CHECK_GT(local_subdiv, 0);
+  const bool is_leader = col_params_->subdiv_rank[0] >= 0;
+
+  absl::Status status = ReduceLocal(local_subdiv);
+  if (status.ok() && is_leader) {
+    status = AllReduceLeaders();
+  }
+  if (status.ok() && is_leader && col_params_->final_op) {
+    status = ApplyFinalOp();
+  }
+  if (status.ok()) {
+    status = BroadcastLocal(local_subdiv);
+  }
+  VLOG(2) << "device=" << col_ctx_->device_name << " return status " << status;
+  done(status);
+}
+
+absl::Status HierarchicalReducer::ReduceLocal(int subdiv) {
+  tsl::profiler::TraceMe activity("ReduceLocal",
+                                  tsl::profiler::TraceMeLevel::kInfo);
+  const std::vector<int>& perm =
+      col_params_->instance.impl_details.subdiv_permutations[subdiv];
+  const int leader_idx = perm[0];
+  const int my_idx = col_params_->default_rank;
+  PendingOps pending;
+  if (my_idx != leader_idx) {
+    DispatchSend(ReduceBufKey(col_ctx_->exec_key, "local_reduce", 0, my_idx,
+                              leader_idx),
+                 leader_idx, col_ctx_->input, pending.Add());
+    return pending.Wait();
+  }
+
+  // The leader reduces into its output, so start by copying its input there
+  // unless the reduction is in-place.
+  if ((col_ctx_->input != col_ctx_->output) &&
+      (DMAHelper::base(col_ctx_->input) != DMAHelper::base(col_ctx_->output))) {
+    DeviceContext* op_dev_ctx = col_ctx_->op_ctx->op_device_context();
+    CollectiveRemoteAccessLocal::MemCpyAsync(
+        op_dev_ctx, op_dev_ctx, col_ctx_->device, col_ctx_->device,
+        col_ctx_->op_ctx->input_alloc_attr(0),
+        col_ctx_->op_ctx->output_alloc_attr(0), col_ctx_->input,
+        col_ctx_->output, 0 /*dev_to_dev_stream_index*/, pending.Add());
+  }
+  Allocator* allocator =
+      col_ctx_->device->GetAllocator(col_ctx_->op_ctx->output_alloc_attr(0));
+  std::vector<Tensor> peer_values;
+  peer_values.reserve(perm.size() - 1);
+  for (int r = 1; r < perm.size(); ++r) {
+    peer_values.emplace_back(allocator, col_ctx_->output->dtype(),
+                             col_ctx_->output->shape());
+    DispatchRecv(ReduceBufKey(col_ctx_->exec_key, "local_reduce", 0, perm[r],
+                              leader_idx),
+                 perm[r], &peer_values.back(), pending.Add());
+  }
+  TF_RETURN_IF_ERROR(pending.Wait());
+  for (Tensor& value : peer_values) {
+    TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+        col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+        col_params_->merge_op, col_ctx_->output, &value));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status HierarchicalReducer::AllReduceLeaders() {
+  tsl::profiler::TraceMe activity("AllReduceLeaders",
+                                  tsl::profiler::TraceMeLevel::kInfo);
+  const std::vector<int>& leaders =
+      col_params_->instance.impl_details.subdiv_permutations[0];
+  const int num_leaders = static_cast<int>(leaders.size());
+  if (num_leaders == 1) return absl::OkStatus();
+  const int rank = col_params_->subdiv_rank[0];
+  const int my_idx = leaders[rank];
+  const int next_idx = leaders[(rank + 1) % num_leaders];
+  const int prev_idx = leaders[(rank + num_leaders - 1) % num_leaders];
+  auto chunk_index = [num_leaders](int i) {
+    return ((i % num_leaders) + num_leaders) % num_leaders;
+  };
+  std::unique_ptr<CollectiveAdapter> ca(MakeCollectiveAdapter(
+      col_ctx_->output, num_leaders,
+      col_ctx_->device->GetAllocator(col_ctx_->op_ctx->output_alloc_attr(0))));
+  // Only the traffic between tasks is sent in the reduced precision wire
+  // type; the local phases and the accumulation use the full precision.
+  const bool use_wire =
+      collective_util::UseWireDataType(*col_params_, col_ctx_->device);
+  const DataType wire_dtype = col_params_->instance.impl_details.wire_dtype;
+  auto to_wire = [use_wire, wire_dtype](const Tensor& value) {
+    return use_wire ? collective_util::ToWireTensor(value, wire_dtype) : value;
+  };
+  auto wire_buffer = [use_wire, wire_dtype](const Tensor& value) {
+    return use_wire ? Tensor(wire_dtype, value.shape()) : value;
+  };
+
+  // Reduce-scatter: in step s each leader passes on chunk rank - s, to which
+  // the next leader adds its own value.  Afterwards this leader holds the
+  // reduced chunk rank + 1.  Empty chunks are neither sent nor received.
+  for (int step = 0; step < num_leaders - 1; ++step) {
+    const int send_chunk = chunk_index(rank - step);
+    const int recv_chunk = chunk_index(rank - step - 1);
+    PendingOps pending;
+    Tensor send_value = to_wire(ca->ChunkAlias(send_chunk));
+    if (send_value.NumElements() > 0) {
+      DispatchSend(ReduceBufKey(col_ctx_->exec_key, "reduce_scatter", step,
+                                my_idx, next_idx),
+                   next_idx, &send_value, pending.Add());
+    }
+    Tensor recv_value = ca->TempChunk(recv_chunk);
+    Tensor recv_wire_value = wire_buffer(recv_value);
+    if (recv_value.NumElements() > 0) {
+      DispatchRecv(ReduceBufKey(col_ctx_->exec_key, "reduce_scatter", step,
+                                prev_idx, my_idx),
+                   prev_idx, &recv_wire_value, pending.Add());
+    }
+    TF_RETURN_IF_ERROR(pending.Wait());
+    if (recv_value.NumElements() > 0) {
+      if (use_wire) {
+        collective_util::FromWireTensor(recv_wire_value, &recv_value);
+      }
+      Tensor value = ca->ChunkAlias(recv_chunk);
+      TF_RETURN_IF_ERROR(collective_util::ComputeBinOp(
+          col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+          col_params_->merge_op, &value, &recv_value));
+    }
+  }
+
+  // All-gather: in step s each leader passes on the reduced chunk
+  // rank + 1 - s.
+  for (int step = 0; step < num_leaders - 1; ++step) {
+    const int send_chunk = chunk_index(rank + 1 - step);
+    const int recv_chunk = chunk_index(rank - step);
+    PendingOps pending;
+    Tensor send_value = to_wire(ca->ChunkAlias(send_chunk));
+    if (send_value.NumElements() > 0) {
+      DispatchSend(ReduceBufKey(col_ctx_->exec_key, "all_gather", step, my_idx,
+                                next_idx),
+                   next_idx, &send_value, pending.Add());
+    }
+    Tensor recv_value = ca->ChunkAlias(recv_chunk);
+    Tensor recv_wire_value = wire_buffer(recv_value);
+    if (recv_value.NumElements() > 0) {
+      DispatchRecv(ReduceBufKey(col_ctx_->exec_key, "all_gather", step,
+                                prev_idx, my_idx),
+                   prev_idx, &recv_wire_value, pending.Add());
+    }
+    TF_RETURN_IF_ERROR(pending.Wait());
+    if (use_wire && recv_value.NumElements() > 0) {
+      collective_util::FromWireTensor(recv_wire_value, &recv_value);
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status HierarchicalReducer::ApplyFinalOp() {
+  std::unique_ptr<CollectiveAdapter> ca(MakeCollectiveAdapter(
+      col_ctx_->output, 1,
+      col_ctx_->device->GetAllocator(col_ctx_->op_ctx->output_alloc_attr(0))));
+  Tensor group_size = ca->Scalar(col_params_->group.group_size);
+  return collective_util::ComputeBinOp(
+      col_ctx_->op_ctx, col_ctx_->op_params, col_ctx_->device,
+      col_params_->final_op, col_ctx_->output, &group_size);
+}
+
+absl::Status HierarchicalReducer::BroadcastLocal(int subdiv) {
+  tsl::profiler::TraceMe activity("BroadcastLocal",
+                                  tsl::profiler::TraceMeLevel::kInfo);
+  const std::vector<int>& perm =
+      col_params_->instance.impl_details.subdiv_permutations[subdiv];
+  const int leader_idx = perm[0];
+  const int my_idx = col_params_->default_rank;
+  PendingOps pending;
+  if (my_idx == leader_idx) {
+    for (int r = 1; r < perm.size(); ++r) {
+      DispatchSend(ReduceBufKey(col_ctx_->exec_key, "local_broadcast", 0,
+                                leader_idx, perm[r]),
+                   perm[r], col_ctx_->output, pending.Add());
+    }
+  } else {
+    DispatchRecv(ReduceBufKey(col_ctx_->exec_key, "local_broadcast", 0,
+                              leader_idx, my_idx),
+                 leader_idx, col_ctx_->output, pending.Add());
+  }
+  return pending.Wait();
+}
+
+void HierarchicalReducer::DispatchSend(const string& key, int dst_idx,
+                                       const Tensor* src_tensor,
+                                       const StatusCallback& done) {
+  VLOG(3) << "DispatchSend " << key << " from_device "
+          << col_ctx_->device_name << " to_device "
+          << col_params_->group.members[dst_idx].device.name();
+  col_ctx_->col_exec->remote_access()->PostToPeer(
+      col_params_->group.members[dst_idx].device.name(),
+      col_params_->group.members[dst_idx].task, key, col_ctx_->device,
+      col_ctx_->op_ctx->op_device_context(),
+      col_ctx_->op_ctx->output_alloc_attr(0), src_tensor,
+      col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
+      done);
+}
+
+void HierarchicalReducer::DispatchRecv(const string& key, int src_idx,
+                                       Tensor* dst_tensor,
+                                       const StatusCallback& done) {
+  VLOG(3) << "DispatchRecv " << key << " from_device "
+          << col_params_->group.members[src_idx].device.name()
+          << " to_device " << col_ctx_->device_name;
+  col_ctx_->col_exec->remote_access()->RecvFromPeer(
+      col_params_->group.members[src_idx].device.name(),
+      col_params_->group.members[src_idx].task,
+      col_params_->group.members[src_idx].is_local, key, col_ctx_->device,
+      col_ctx_->op_ctx->op_device_context(),
+      col_ctx_->op_ctx->output_alloc_attr(0), dst_tensor,
+      col_ctx_->device_locality, 0 /*stream_index*/,
+      col_ctx_->op_ctx->cancellation_manager(), done);
+}
+
+namespace {
+REGISTER_COLLECTIVE(HierarchicalReduce, HierarchicalReducer);
+}  // namespace
+
+}  // namespace tensorflow
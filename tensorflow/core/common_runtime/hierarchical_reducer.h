@@ -0,0 +1,80 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
+
+#include <memory>
+#include <string>
+
+#include "tensorflow/core/common_runtime/base_collective_executor.h"
+#include "tensorflow/core/framework/collective.h"
+
+namespace tensorflow {
+
+// Two-level implementation of collective all-reduce for groups spanning
+// several tasks.  The devices of each task first reduce their values onto the
+// leader of the task, its first device.  The leaders then all-reduce across
+// tasks with a ring reduce-scatter and all-gather, and finally each leader
+// broadcasts the result to the other devices of its task.  Hence only one
+// device per task exchanges data with other tasks.
+class HierarchicalReducer : public CollectiveImplementationInterface {
+ public:
+  HierarchicalReducer();
+  ~HierarchicalReducer() override = default;
+
+  // Establishes the subdiv permutations of the reduction.  The first subdiv
+  // comprises the leaders of the tasks in task order.  Subdiv i+1 comprises
+  // the devices of task i, starting with its leader.
+  absl::Status InitializeCollectiveParams(
+      CollectiveParams* col_params) override;
+
+  // Initializes members of CollectiveContext not yet initialized, i.e. device
+  // and device_locality.  Also saves the CollectiveContext in this object.
+  absl::Status InitializeCollectiveContext(
+      std::shared_ptr<CollectiveContext> col_ctx) override;
+
+  // Executes the reduction.  Must be called in a blockable thread.
+  void Run(StatusCallback done) override;
+
+ private:
+  // Reduces the input of every device of the task in `subdiv` into the output
+  // of its leader.
+  absl::Status ReduceLocal(int subdiv);
+
+  // All-reduces the outputs of the leaders of the tasks.
+  absl::Status AllReduceLeaders();
+
+  // Applies the final op to the output of a leader.
+  absl::Status ApplyFinalOp();
+
+  // Broadcasts the output of the leader of the task in `subdiv` to the other
+  // devices of the task.
+  absl::Status BroadcastLocal(int subdiv);
+
+  // Sends `src_tensor` to the group member at `dst_idx` under `key`.
+  void DispatchSend(const string& key, int dst_idx, const Tensor* src_tensor,
+                    const StatusCallback& done);
+
+  // Receives the tensor sent under `key` by the group member at `src_idx`
+  // into `dst_tensor`.
+  void DispatchRecv(const string& key, int src_idx, Tensor* dst_tensor,
+                    const StatusCallback& done);
+
+  std::shared_ptr<CollectiveContext> col_ctx_;
+  const CollectiveParams* col_params_;  // Not owned
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HIERARCHICAL_REDUCER_H_
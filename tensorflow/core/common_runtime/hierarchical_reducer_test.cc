@@ -0,0 +1,165 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/common_runtime/hierarchical_reducer.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/collective_test_util.h"
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/common_runtime/process_util.h"
+#include "tensorflow/core/framework/collective.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/refcount.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+std::unique_ptr<OpKernel> GetKernel(const string& op, DataType dtype,
+                                    Device* device) {
+  NodeDef node_def;
+  TF_CHECK_OK(NodeDefBuilder(strings::StrCat(op, "_node"), op)
+                  .Attr("T", dtype)
+                  .Input(FakeInput(dtype))
+                  .Input(FakeInput(dtype))
+                  .Finalize(&node_def));
+  absl::Status status;
+  std::unique_ptr<OpKernel> k = CreateOpKernel(
+      DEVICE_CPU, device, device->GetAllocator(AllocatorAttributes()),
+      node_def, TF_GRAPH_DEF_VERSION, &status);
+  TF_CHECK_OK(status);
+  return k;
+}
+
+class HierarchicalReducerTest : public ::testing::Test {
+ protected:
+  class DeviceInstance {
+   public:
+    DeviceInstance(int rank, const Tensor& tensor, DataType wire_dtype,
+                   CollectiveTestEnv* test_env)
+        : test_env_(test_env), tensor_(tensor) {
+      col_params_ = CreateCollectiveParams(
+          *test_env_, rank, "HierarchicalReduce", REDUCTION_COLLECTIVE,
+          tensor.dtype(), tensor.shape());
+      col_params_->instance.impl_details.wire_dtype = wire_dtype;
+      const string& dev_name = col_params_->group.members[rank].device.name();
+      TF_CHECK_OK(test_env_->device_mgr->LookupDevice(dev_name, &device_));
+      merge_op_ = GetKernel("Add", tensor.dtype(), device_);
+      final_op_ = GetKernel("Div", tensor.dtype(), device_);
+      col_params_->merge_op = merge_op_.get();
+      col_params_->final_op = final_op_.get();
+    }
+
+    void DoReduce() {
+      status_ = RunCollective(test_env_, col_params_.get(), device_, &tensor_,
+                              &tensor_);
+    }
+
+    CollectiveTestEnv* test_env_;
+    Tensor tensor_;
+    Device* device_;
+    core::RefCountPtr<CollectiveParams> col_params_;
+    std::unique_ptr<OpKernel> merge_op_;
+    std::unique_ptr<OpKernel> final_op_;
+    absl::Status status_;
+  };
+
+  void RunTest(int num_workers, int num_devices, int tensor_len,
+               DataType wire_dtype = DT_INVALID) {
+    test_env_ = CreateCollectiveTestEnv(num_workers, num_devices, DEVICE_CPU);
+    const int group_size = num_workers * num_devices;
+    std::vector<float> expected(tensor_len);
+    for (int rank = 0; rank < group_size; ++rank) {
+      Tensor t(DT_FLOAT, TensorShape({tensor_len}));
+      for (int i = 0; i < tensor_len; ++i) {
+        t.flat<float>()(i) = (rank + 1) * i;
+        expected[i] += (rank + 1) * i;
+      }
+      instances_.push_back(
+          std::make_unique<DeviceInstance>(rank, t, wire_dtype,
+                                           test_env_.get()));
+    }
+    for (float& v : expected) v /= group_size;
+
+    std::atomic<int> done(0);
+    for (auto& di : instances_) {
+      SchedClosure([&di, &done] {
+        di->DoReduce();
+        ++done;
+      });
+    }
+    while (done < group_size) {
+      Env::Default()->SleepForMicroseconds(1000);
+    }
+    for (auto& di : instances_) {
+      TF_EXPECT_OK(di->status_);
+      if (wire_dtype == DT_INVALID) {
+        test::ExpectTensorNear<float>(test::AsTensor<float>(expected),
+                                      di->tensor_, 1e-5);
+      } else {
+        // Values sent between workers are rounded to the wire type.
+        test::ExpectClose(test::AsTensor<float>(expected), di->tensor_,
+                          /*atol=*/1e-2, /*rtol=*/2e-2);
+      }
+    }
+  }
+
+  std::unique_ptr<CollectiveTestEnv> test_env_;
+  std::vector<std::unique_ptr<DeviceInstance>> instances_;
+};
+
+TEST_F(HierarchicalReducerTest, InitializeParams) {
+  auto test_env = CreateCollectiveTestEnv(/*num_workers=*/2,
+                                          /*num_devices_per_worker=*/3,
+                                          DEVICE_CPU);
+  auto col_params = CreateCollectiveParams(
+      *test_env, /*rank=*/4, "HierarchicalReduce", REDUCTION_COLLECTIVE,
+      DT_FLOAT, TensorShape({5}));
+  HierarchicalReducer reducer;
+  TF_ASSERT_OK(reducer.InitializeCollectiveParams(col_params.get()));
+  const std::vector<std::vector<int>> expected_perms = {
+      {0, 3}, {0, 1, 2}, {3, 4, 5}};
+  EXPECT_EQ(expected_perms,
+            col_params->instance.impl_details.subdiv_permutations);
+  EXPECT_EQ(std::vector<int>({-1, -1, 1}), col_params->subdiv_rank);
+}
+
+TEST_F(HierarchicalReducerTest, TwoWorkersTwoDevices) { RunTest(2, 2, 1001); }
+
+TEST_F(HierarchicalReducerTest, ThreeWorkersTwoDevices) { RunTest(3, 2, 17); }
+
+TEST_F(HierarchicalReducerTest, TensorSmallerThanNumWorkers) {
+  RunTest(4, 2, 2);
+}
+
+TEST_F(HierarchicalReducerTest, OneDevicePerWorker) { RunTest(3, 1, 100); }
+
+TEST_F(HierarchicalReducerTest, HalfWireType) { RunTest(3, 2, 100, DT_HALF); }
+
+TEST_F(HierarchicalReducerTest, BFloat16WireType) {
+  RunTest(2, 2, 100, DT_BFLOAT16);
+}
+
+}  // namespace
+}  // namespace tensorflow
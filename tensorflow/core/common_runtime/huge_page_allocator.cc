@@ -0,0 +1,182 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/common_runtime/huge_page_allocator.h"
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/numa.h"
+#include "tsl/profiler/lib/traceme.h"
+
+namespace tensorflow {
+
+namespace {
+
+size_t RoundUp(size_t n, size_t multiple) {
+  return (n + multiple - 1) / multiple * multiple;
+}
+
+#if defined(__linux__)
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+// The memory policy of mbind(2) that only allocates from the given nodes.
+constexpr int kMpolBind = 2;
+
+// Returns the MAP_HUGE_* flag that selects huge pages of `page_bytes`.
+int HugePageSizeFlag(size_t page_bytes) {
+  int log2_page_bytes = 0;
+  while ((size_t{1} << log2_page_bytes) < page_bytes) ++log2_page_bytes;
+  return log2_page_bytes << MAP_HUGE_SHIFT;
+}
+
+// Binds the pages of `[ptr, ptr + num_bytes)` to `numa_node` before they are
+// first touched. Returns false on failure, in which case the pages are placed
+// by the default policy.
+bool BindToNUMANode(void* ptr, size_t num_bytes, int numa_node) {
+  constexpr int kBitsPerWord = 8 * sizeof(unsigned long);  // NOLINT
+  std::vector<unsigned long> node_mask(  // NOLINT
+      numa_node / kBitsPerWord + 1, 0);
+  node_mask[numa_node / kBitsPerWord] |= 1UL << (numa_node % kBitsPerWord);
+  return syscall(SYS_mbind, ptr, num_bytes, kMpolBind, node_mask.data(),
+                 node_mask.size() * kBitsPerWord, 0) == 0;
+}
+#endif  // defined(__linux__)
+
+}  // namespace
+
+HugePageCPUAllocator::HugePageCPUAllocator(
+    int numa_node, const Options& options,
+    const std::vector<Visitor>& alloc_visitors,
+    const std::vector<Visitor>& free_visitors)
+    : SubAllocator(alloc_visitors, free_visitors),
+      numa_node_(numa_node),
+      options_(options) {
+  CHECK_GT(options_.huge_page_bytes, 0);
+  CHECK_EQ(options_.huge_page_bytes & (options_.huge_page_bytes - 1), 0)
+      << "The huge page size must be a power of two";
+  if (!options_.use_explicit_huge_pages &&
+      options_.huge_page_bytes != (2 << 20)) {
+    LOG(WARNING) << "Transparent huge pages are 2MB, but a huge page size of "
+                 << options_.huge_page_bytes << " bytes was requested";
+  }
+}
+
+/*static*/ bool HugePageCPUAllocator::IsSupported() {
+#if defined(__linux__)
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool HugePageCPUAllocator::UsesHugePages(size_t num_bytes) const {
+  return IsSupported() && num_bytes >= options_.min_huge_page_allocation_bytes;
+}
+
+void* HugePageCPUAllocator::MapHugePages(size_t num_bytes) {
+#if defined(__linux__)
+  void* ptr = MAP_FAILED;
+  if (options_.use_explicit_huge_pages) {
+    ptr = mmap(nullptr, num_bytes, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB |
+                   HugePageSizeFlag(options_.huge_page_bytes),
+               -1, 0);
+    if (ptr == MAP_FAILED) {
+      VLOG(1) << "Failed to map " << num_bytes
+              << " bytes of explicit huge pages, falling back to transparent "
+                 "huge pages";
+    }
+  }
+  if (ptr == MAP_FAILED) {
+    // Over-map by one huge page, so that the mapping can be trimmed to start
+    // at a huge page boundary, which transparent huge pages require.
+    const size_t mapped_bytes = num_bytes + options_.huge_page_bytes;
+    void* mapped = mmap(nullptr, mapped_bytes, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapped == MAP_FAILED) return nullptr;
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(mapped);
+    const uintptr_t aligned = RoundUp(begin, options_.huge_page_bytes);
+    const uintptr_t end = begin + mapped_bytes;
+    if (aligned > begin) munmap(mapped, aligned - begin);
+    if (end > aligned + num_bytes) {
+      munmap(reinterpret_cast<void*>(aligned + num_bytes),
+             end - aligned - num_bytes);
+    }
+    ptr = reinterpret_cast<void*>(aligned);
+    if (madvise(ptr, num_bytes, MADV_HUGEPAGE) != 0) {
+      VLOG(1) << "madvise(MADV_HUGEPAGE) failed, transparent huge pages may "
+                 "be disabled";
+    }
+  }
+  if (numa_node_ != port::kNUMANoAffinity &&
+      !BindToNUMANode(ptr, num_bytes, numa_node_)) {
+    VLOG(1) << "Failed to bind " << num_bytes << " bytes to NUMA node "
+            << numa_node_;
+  }
+  return ptr;
+#else
+  return nullptr;
+#endif  // defined(__linux__)
+}
+
+void* HugePageCPUAllocator::Alloc(size_t alignment, size_t num_bytes,
+                                  size_t* bytes_received) {
+  tsl::profiler::TraceMe traceme("HugePageCPUAllocator::Alloc");
+
+  void* ptr = nullptr;
+  *bytes_received = num_bytes;
+  if (num_bytes == 0) return ptr;
+  if (UsesHugePages(num_bytes)) {
+    *bytes_received = RoundUp(num_bytes, options_.huge_page_bytes);
+    DCHECK_EQ(options_.huge_page_bytes % alignment, 0);
+    ptr = MapHugePages(*bytes_received);
+  } else if (numa_node_ == port::kNUMANoAffinity) {
+    ptr = port::AlignedMalloc(num_bytes, static_cast<int>(alignment));
+  } else {
+    ptr = port::NUMAMalloc(numa_node_, num_bytes, static_cast<int>(alignment));
+  }
+  if (ptr != nullptr) VisitAlloc(ptr, numa_node_, *bytes_received);
+  return ptr;
+}
+
+void HugePageCPUAllocator::Free(void* ptr, size_t num_bytes) {
+  tsl::profiler::TraceMe traceme("HugePageCPUAllocator::Free");
+
+  if (num_bytes == 0) return;
+  VisitFree(ptr, numa_node_, num_bytes);
+  if (UsesHugePages(num_bytes)) {
+#if defined(__linux__)
+    munmap(ptr, num_bytes);
+#endif
+  } else if (numa_node_ == port::kNUMANoAffinity) {
+    port::AlignedFree(ptr);
+  } else {
+    port::NUMAFree(ptr, num_bytes);
+  }
+}
+
+}  // namespace tensorflow
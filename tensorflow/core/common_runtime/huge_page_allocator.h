@@ -0,0 +1,93 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_HUGE_PAGE_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_HUGE_PAGE_ALLOCATOR_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+
+namespace tensorflow {
+
+// A SubAllocator for host memory that backs large allocations with huge
+// pages, to reduce the TLB misses of accesses spread over big buffers such as
+// embedding tables.
+//
+// Allocations of at least `Options::min_huge_page_allocation_bytes` are
+// rounded up to a multiple of the huge page size and mapped directly, aligned
+// to the huge page size, and bound to `numa_node` if it is not
+// port::kNUMANoAffinity. Smaller allocations, and all allocations on platforms
+// without huge page support, behave as in BasicCPUAllocator.
+//
+// Huge page mappings are identified in Free() by their size, so Free() must be
+// passed the `bytes_received` of the corresponding Alloc(), as BFCAllocator
+// and PoolAllocator do.
+class HugePageCPUAllocator : public SubAllocator {
+ public:
+  struct Options {
+    // Allocations of at least this many bytes are backed by huge pages.
+    size_t min_huge_page_allocation_bytes = 2 << 20;
+
+    // The size of the huge pages. Sizes other than 2MB, e.g. 1GB, require
+    // `use_explicit_huge_pages`.
+    size_t huge_page_bytes = 2 << 20;
+
+    // If true, large allocations are mapped from the pool of huge pages that
+    // the system administrator reserved (MAP_HUGETLB), and fall back to
+    // transparent huge pages if the pool is exhausted. Otherwise they only
+    // request transparent huge pages with madvise(MADV_HUGEPAGE).
+    bool use_explicit_huge_pages = false;
+  };
+
+  HugePageCPUAllocator(int numa_node, const Options& options,
+                       const std::vector<Visitor>& alloc_visitors,
+                       const std::vector<Visitor>& free_visitors);
+
+  ~HugePageCPUAllocator() override {}
+
+  // Returns true if this platform supports huge page mappings.
+  static bool IsSupported();
+
+  void* Alloc(size_t alignment, size_t num_bytes,
+              size_t* bytes_received) override;
+
+  void Free(void* ptr, size_t num_bytes) override;
+
+  bool SupportsCoalescing() const override { return false; }
+
+  AllocatorMemoryType GetMemoryType() const override {
+    return AllocatorMemoryType::kHostPageable;
+  }
+
+ private:
+  bool UsesHugePages(size_t num_bytes) const;
+
+  // Maps `num_bytes`, a multiple of the huge page size, and returns nullptr on
+  // failure.
+  void* MapHugePages(size_t num_bytes);
+
+  const int numa_node_;
+  const Options options_;
+
+  HugePageCPUAllocator(const HugePageCPUAllocator&) = delete;
+  void operator=(const HugePageCPUAllocator&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_HUGE_PAGE_ALLOCATOR_H_
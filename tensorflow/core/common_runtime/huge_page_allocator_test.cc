@@ -0,0 +1,109 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/common_runtime/huge_page_allocator.h"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/bfc_allocator.h"
+#include "tensorflow/core/platform/numa.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr size_t kHugePageBytes = 2 << 20;
+
+TEST(HugePageCPUAllocatorTest, SmallAllocationsUseRegularPages) {
+  HugePageCPUAllocator a(port::kNUMANoAffinity, {}, {}, {});
+  size_t bytes_received = 0;
+  void* p = a.Alloc(64, 1000, &bytes_received);
+  ASSERT_NE(p, nullptr);
+  EXPECT_EQ(1000, bytes_received);
+  std::memset(p, 1, bytes_received);
+  a.Free(p, bytes_received);
+}
+
+TEST(HugePageCPUAllocatorTest, LargeAllocationsAreRoundedToHugePages) {
+  if (!HugePageCPUAllocator::IsSupported()) {
+    GTEST_SKIP() << "Huge pages are not supported on this platform";
+  }
+  HugePageCPUAllocator a(port::kNUMANoAffinity, {}, {}, {});
+  size_t bytes_received = 0;
+  void* p = a.Alloc(64, 3 << 20, &bytes_received);
+  ASSERT_NE(p, nullptr);
+  EXPECT_EQ(2 * kHugePageBytes, bytes_received);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p) % kHugePageBytes);
+  std::memset(p, 1, bytes_received);
+  a.Free(p, bytes_received);
+}
+
+TEST(HugePageCPUAllocatorTest, ExplicitHugePagesFallBackToTransparent) {
+  if (!HugePageCPUAllocator::IsSupported()) {
+    GTEST_SKIP() << "Huge pages are not supported on this platform";
+  }
+  // Test machines usually reserve no huge pages, in which case this falls
+  // back to transparent huge pages.
+  HugePageCPUAllocator::Options options;
+  options.use_explicit_huge_pages = true;
+  HugePageCPUAllocator a(port::kNUMANoAffinity, options, {}, {});
+  size_t bytes_received = 0;
+  void* p = a.Alloc(64, kHugePageBytes, &bytes_received);
+  ASSERT_NE(p, nullptr);
+  EXPECT_EQ(kHugePageBytes, bytes_received);
+  std::memset(p, 1, bytes_received);
+  a.Free(p, bytes_received);
+}
+
+TEST(HugePageCPUAllocatorTest, VisitorsSeeReceivedBytes) {
+  size_t visited_alloc_bytes = 0;
+  size_t visited_free_bytes = 0;
+  HugePageCPUAllocator a(
+      port::kNUMANoAffinity, {},
+      {[&](void*, int, size_t n) { visited_alloc_bytes += n; }},
+      {[&](void*, int, size_t n) { visited_free_bytes += n; }});
+  size_t bytes_received = 0;
+  void* p = a.Alloc(64, kHugePageBytes + 1, &bytes_received);
+  ASSERT_NE(p, nullptr);
+  a.Free(p, bytes_received);
+  EXPECT_EQ(bytes_received, visited_alloc_bytes);
+  EXPECT_EQ(bytes_received, visited_free_bytes);
+}
+
+TEST(HugePageCPUAllocatorTest, BacksBFCAllocator) {
+  BFCAllocator::Options options;
+  options.allow_growth = true;
+  BFCAllocator bfc(std::make_unique<HugePageCPUAllocator>(
+                       port::kNUMANoAffinity,
+                       HugePageCPUAllocator::Options(),
+                       std::vector<SubAllocator::Visitor>(),
+                       std::vector<SubAllocator::Visitor>()),
+                   /*total_memory=*/1LL << 30, "huge_page_bfc", options);
+  std::vector<void*> ptrs;
+  for (size_t n : {size_t{100}, size_t{5} << 20, size_t{64} << 20}) {
+    void* p = bfc.AllocateRaw(Allocator::kAllocatorAlignment, n);
+    ASSERT_NE(p, nullptr);
+    std::memset(p, 1, n);
+    ptrs.push_back(p);
+  }
+  for (void* p : ptrs) bfc.DeallocateRaw(p);
+}
+
+}  // namespace
+}  // namespace tensorflow
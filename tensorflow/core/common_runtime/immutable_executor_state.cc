@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/immutable_executor_state.h"
 
 #include "absl/memory/memory.h"
+#include "tensorflow/core/framework/device.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/node_def_util.h"
@@ -24,6 +25,7 @@ limitations under the License.
 #include "tensorflow/core/graph/graph_node_util.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
 
@@ -31,6 +33,39 @@ namespace {
 bool IsInitializationOp(const Node* node) {
   return node->op_def().allows_uninitialized_input();
 }
+
+// If true, the pending counts of the consumers of each node are grouped into
+// cache lines, and per-iteration counts are allocated on the NUMA node of the
+// thread that starts the iteration. Enabled with
+// TF_PENDING_COUNTS_CACHE_LINE_LAYOUT=1.
+bool UseCacheLinePendingCountsLayout() {
+  static const bool use_cache_line_layout = [] {
+    bool value;
+    TF_CHECK_OK(ReadBoolFromEnvVar("TF_PENDING_COUNTS_CACHE_LINE_LAYOUT",
+                                   /*default_val=*/false, &value));
+    return value;
+  }();
+  return use_cache_line_layout;
+}
+
+// Returns true if `node` may serve its allocations from the step arena, i.e.
+// neither `node` nor any consumer of its outputs is stateful, a function call
+// or a control flow op that could carry a buffer beyond the step.
+bool MayUseStepArena(const Node* node) {
+  auto may_escape = [](const Node* n) {
+    return n->op_def().is_stateful() || n->IsControlFlow() ||
+           n->IsFunctionCall();
+  };
+  if (may_escape(node)) return false;
+  for (const DataType dt : node->output_types()) {
+    if (IsRefType(dt)) return false;
+  }
+  for (const Edge* e : node->out_edges()) {
+    if (e->IsControlEdge() || e->dst()->IsSink()) continue;
+    if (may_escape(e->dst())) return false;
+  }
+  return true;
+}
 }  // namespace
 
 ImmutableExecutorState::~ImmutableExecutorState() {
@@ -40,6 +75,9 @@ ImmutableExecutorState::~ImmutableExecutorState() {
       params_.delete_kernel(item->kernel);
     }
   }
+  for (DeviceContext* device_context : device_context_map_) {
+    if (device_context != nullptr) device_context->Unref();
+  }
 }
 
 namespace {
@@ -196,15 +234,18 @@ absl::Status ImmutableExecutorState::Initialize(const Graph& graph) {
     item->is_recv_or_switch = IsRecv(n) || IsSwitch(n);
     item->is_next_iteration = IsNextIteration(n);
     item->is_distributed_communication = IsDistributedCommunication(n);
+    item->may_use_step_arena = MayUseStepArena(n);
 
     // Compute the maximum values we'll store for this node in the
     // pending counts data structure, and allocate a handle in
     // that frame's pending counts data structure that has enough
     // space to store these maximal count values.
-    size_t max_pending, max_dead;
-    GetMaxPendingCounts(n, &max_pending, &max_dead);
-    pending_ids_[id] =
-        frame_info->pending_counts_layout.CreateHandle(max_pending, max_dead);
+    if (!UseCacheLinePendingCountsLayout()) {
+      size_t max_pending, max_dead;
+      GetMaxPendingCounts(n, &max_pending, &max_dead);
+      pending_ids_[id] =
+          frame_info->pending_counts_layout.CreateHandle(max_pending, max_dead);
+    }
 
     // See if this node is a root node, and if so, add item to root_nodes_.
     if (n->in_edges().empty()) {
@@ -256,9 +297,18 @@ absl::Status ImmutableExecutorState::Initialize(const Graph& graph) {
     }
   }
 
+  if (UseCacheLinePendingCountsLayout()) {
+    InitializeCacheLinePendingIds(&graph, cf_info);
+  }
+
   // Initialize PendingCounts only after pending_ids_[node.id] is initialized
   // for all nodes.
   InitializePending(&graph, cf_info);
+  if (!requires_control_flow_) {
+    InitializeStraightLinePlan();
+  }
+  TF_RETURN_IF_ERROR(
+      params_.device->FillContextMap(&graph, &device_context_map_));
   return gview_.SetAllocAttrs(&graph, params_.device);
 }
 
@@ -350,6 +400,60 @@ absl::Status ImmutableExecutorState::BuildControlFlowInfo(
   return absl::OkStatus();
 }
 
+void ImmutableExecutorState::InitializeCacheLinePendingIds(
+    const Graph* graph, const ControlFlowInfo& cf_info) {
+  // When a node completes, a single thread decrements the pending counts of
+  // all of its consumers in `PropagatorState::PropagateOutputs()`. Assign each
+  // node to the group of its first producer, and give every group its own
+  // cache line(s) where possible, so that threads completing different
+  // producers at the same time do not write to the same cache line.
+  std::vector<bool> assigned(graph->num_node_ids(), false);
+  auto assign_handle = [&](const Node* n) {
+    const int id = n->id();
+    assigned[id] = true;
+    size_t max_pending, max_dead;
+    GetMaxPendingCounts(n, &max_pending, &max_dead);
+    pending_ids_[id] = EnsureFrameInfo(cf_info.frame_names[id])
+                           ->pending_counts_layout.CreateHandle(max_pending,
+                                                                max_dead);
+  };
+
+  std::vector<const Node*> group;
+  for (const Node* n : graph->nodes()) {
+    if (IsSink(n)) continue;
+    if (n->in_edges().empty() && !assigned[n->id()]) {
+      // Root nodes are not activated by any producer.
+      assign_handle(n);
+    }
+    group.clear();
+    for (const Edge* e : n->out_edges()) {
+      const Node* dst = e->dst();
+      if (IsSink(dst) || assigned[dst->id()]) continue;
+      if ((*dst->in_edges().begin())->src() != n) continue;
+      group.push_back(dst);
+      // Mark the node now, in case it has several edges from `n`.
+      assigned[dst->id()] = true;
+    }
+    if (group.empty()) continue;
+    // Packed counts take one byte each. Consumers in other frames (e.g. of
+    // an Enter node) are appended to their frame's layout without alignment.
+    EnsureFrameInfo(cf_info.frame_names[group[0]->id()])
+        ->pending_counts_layout.BeginCacheLineGroup(group.size());
+    for (const Node* dst : group) {
+      assign_handle(dst);
+    }
+  }
+
+  for (const Node* n : graph->nodes()) {
+    if (IsSink(n) || assigned[n->id()]) continue;
+    assign_handle(n);
+  }
+
+  for (auto& it : cf_info.unique_frame_names) {
+    EnsureFrameInfo(it)->pending_counts_layout.set_numa_aware(true);
+  }
+}
+
 void ImmutableExecutorState::InitializePending(const Graph* graph,
                                                const ControlFlowInfo& cf_info) {
   for (auto& it : cf_info.unique_frame_names) {
@@ -378,4 +482,41 @@ void ImmutableExecutorState::InitializePending(const Graph* graph,
     }
   }
 }
+
+void ImmutableExecutorState::InitializeStraightLinePlan() {
+  DCHECK(!requires_control_flow_);
+  const int num_nodes = gview_.num_nodes();
+  std::vector<int32> pending(num_nodes);
+  int num_items = 0;
+  for (int32_t i = 0; i < num_nodes; ++i) {
+    pending[i] = atomic_pending_counts_[i].load(std::memory_order_relaxed);
+    // The sink node has an item but no kernel, and is never scheduled.
+    const NodeItem* item = gview_.node(i);
+    if (item != nullptr && item->kernel != nullptr) ++num_items;
+  }
+
+  // Kahn's algorithm, seeded with the root nodes in the order in which the
+  // executor would activate them.
+  std::vector<const NodeItem*> plan(root_nodes_.begin(), root_nodes_.end());
+  plan.reserve(num_items);
+  for (size_t i = 0; i < plan.size(); ++i) {
+    const NodeItem* item = plan[i];
+    // An asynchronous kernel may wait for another node in the same graph
+    // (e.g. a local Send/Recv pair), so it must not block the plan.
+    if (item->kernel_is_async) return;
+    for (const EdgeInfo& e : item->output_edges()) {
+      if (--pending[e.dst_id] == 0) plan.push_back(&gview_.node_ref(e.dst_id));
+    }
+    for (const ControlEdgeInfo& e : item->output_control_edges()) {
+      if (--pending[e.dst_id] == 0) plan.push_back(&gview_.node_ref(e.dst_id));
+    }
+  }
+  if (plan.size() != num_items) {
+    VLOG(1) << "Not building a straight-line plan: only " << plan.size()
+            << " of " << num_items << " nodes are reachable from the roots.";
+    return;
+  }
+  straight_line_plan_ = std::move(plan);
+}
+
 }  // namespace tensorflow
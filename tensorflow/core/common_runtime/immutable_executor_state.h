@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/graph_view.h"
 #include "tensorflow/core/common_runtime/local_executor_params.h"
 #include "tensorflow/core/common_runtime/pending_counts.h"
+#include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/flatmap.h"
@@ -101,6 +102,23 @@ class ImmutableExecutorState {
 
   bool requires_control_flow_support() const { return requires_control_flow_; }
 
+  // Returns the device context the node with `node_id` runs with, or nullptr
+  // if it runs with the default context of the step.
+  DeviceContext* device_context(int32_t node_id) const {
+    return static_cast<size_t>(node_id) < device_context_map_.size()
+               ? device_context_map_[node_id]
+               : nullptr;
+  }
+
+  // Returns a static topological order of all nodes in the graph, or an empty
+  // vector if the graph requires control flow support or contains
+  // asynchronous kernels. Running the nodes in this order on a single thread
+  // guarantees that every input of a node has been produced before the node
+  // runs, so no pending counts need to be maintained.
+  const std::vector<const NodeItem*>& straight_line_plan() const {
+    return straight_line_plan_;
+  }
+
   // Copies the pending counts for nodes in this graph to the given array.
   //
   // This method provides a more efficient way of initializing
@@ -125,6 +143,9 @@ class ImmutableExecutorState {
   static absl::Status BuildControlFlowInfo(const Graph* graph,
                                            ControlFlowInfo* cf_info);
   void InitializePending(const Graph* graph, const ControlFlowInfo& cf_info);
+  void InitializeCacheLinePendingIds(const Graph* graph,
+                                     const ControlFlowInfo& cf_info);
+  void InitializeStraightLinePlan();
 
   FrameInfo* EnsureFrameInfo(const string& fname);
 
@@ -152,9 +173,16 @@ class ImmutableExecutorState {
   // pending counts for the nodes in the graph, indexed by node ID.
   std::unique_ptr<std::atomic<int32>[]> atomic_pending_counts_;
 
+  // See `straight_line_plan()`.
+  std::vector<const NodeItem*> straight_line_plan_;
+
   // Shallow copies of the constant tensors used in the graph.
   std::vector<Tensor> const_tensors_;
 
+  // The device contexts filled in by `Device::FillContextMap()`, indexed by
+  // node id. Holds one reference on each non-null entry.
+  std::vector<DeviceContext*> device_context_map_;
+
   ImmutableExecutorState(const ImmutableExecutorState&) = delete;
   void operator=(const ImmutableExecutorState&) = delete;
 };
@@ -0,0 +1,199 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/common_runtime/memory_planner.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/common_runtime/shape_refiner.h"
+#include "tensorflow/core/framework/shape_inference.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+
+namespace {
+
+// A buffer produced by one node output, and shared by the outputs of the
+// identity-like ops that forward it.
+struct Buffer {
+  const Node* node;
+  int output;
+  int64_t bytes;
+  bool plannable;
+  // All nodes that read the buffer, through any of its aliases.
+  std::vector<const Node*> uses;
+};
+
+// Returns the input of `node` whose buffer is forwarded to output `output`,
+// or -1 if the output gets a new buffer.
+int ForwardedInput(const Node& node, int output) {
+  if (node.IsIdentity()) {
+    // "Identity", "IdentityN", "RefIdentity", ... forward input i to output i.
+    return output;
+  }
+  const string& op = node.type_string();
+  if (op == "Reshape" || op == "Squeeze" || op == "ExpandDims" ||
+      op == "StopGradient" || op == "PreventGradient") {
+    return output == 0 ? 0 : -1;
+  }
+  return -1;
+}
+
+int64_t RoundUp(int64_t bytes, int64_t alignment) {
+  return (bytes + alignment - 1) / alignment * alignment;
+}
+
+}  // namespace
+
+OutputBytesFn OutputBytesFromShapes(const ShapeRefiner& refiner) {
+  return [&refiner](const Node& node, int output) -> int64_t {
+    shape_inference::InferenceContext* c = refiner.GetContext(&node);
+    if (c == nullptr || output >= c->num_outputs()) return -1;
+    shape_inference::ShapeHandle shape = c->output(output);
+    if (!c->FullyDefined(shape)) return -1;
+    const int64_t type_size = DataTypeSize(BaseType(node.output_type(output)));
+    if (type_size == 0) return -1;
+    return c->Value(c->NumElements(shape)) * type_size;
+  };
+}
+
+absl::Status PlanStaticMemory(const Graph& graph,
+                              const OutputBytesFn& output_bytes,
+                              const MemoryPlannerOptions& options,
+                              MemoryPlan* plan) {
+  const int num_ids = graph.num_node_ids();
+  if (num_ids > options.max_nodes) {
+    return errors::InvalidArgument("Graph has ", num_ids,
+                                   " node ids, more than the maximum of ",
+                                   options.max_nodes, " for memory planning");
+  }
+  for (const Node* n : graph.op_nodes()) {
+    if (n->IsControlFlow()) {
+      return errors::Unimplemented(
+          "Memory planning does not support control flow, found ",
+          n->name());
+    }
+  }
+
+  std::vector<Node*> order;
+  GetReversePostOrder(graph, &order);
+
+  // ancestors[id * words + i] holds bits 64 * i ... 64 * i + 63 of the set of
+  // nodes from which node `id` is reachable.
+  const int words = (num_ids + 63) / 64;
+  std::vector<uint64> ancestors(static_cast<size_t>(num_ids) * words, 0);
+  auto reaches = [&](const Node* from, const Node* to) {
+    return (ancestors[to->id() * words + from->id() / 64] >>
+            (from->id() % 64)) &
+           1;
+  };
+  for (const Node* n : order) {
+    uint64* dst = &ancestors[n->id() * words];
+    for (const Edge* e : n->in_edges()) {
+      const uint64* src = &ancestors[e->src()->id() * words];
+      for (int i = 0; i < words; ++i) dst[i] |= src[i];
+      dst[e->src()->id() / 64] |= uint64{1} << (e->src()->id() % 64);
+    }
+  }
+
+  // Assign every node output to a buffer, in topological order so that the
+  // buffers of forwarded inputs exist.
+  std::vector<Buffer> buffers;
+  absl::flat_hash_map<std::pair<int, int>, int> buffer_of_output;
+  for (const Node* n : order) {
+    if (!n->IsOp()) continue;
+    std::vector<const Edge*> inputs(n->num_inputs(), nullptr);
+    for (const Edge* e : n->in_edges()) {
+      if (e->IsControlEdge()) continue;
+      inputs[e->dst_input()] = e;
+      const int b =
+          buffer_of_output.at({e->src()->id(), e->src_output()});
+      buffers[b].uses.push_back(n);
+      // The buffer may be used after the step.
+      if (n->IsSend() || n->IsRetval()) buffers[b].plannable = false;
+    }
+    for (int o = 0; o < n->num_outputs(); ++o) {
+      const int forwarded = ForwardedInput(*n, o);
+      if (forwarded >= 0 && forwarded < inputs.size() &&
+          inputs[forwarded] != nullptr) {
+        buffer_of_output[{n->id(), o}] = buffer_of_output.at(
+            {inputs[forwarded]->src()->id(), inputs[forwarded]->src_output()});
+        continue;
+      }
+      const int64_t bytes = output_bytes(*n, o);
+      const bool plannable = bytes > 0 && !n->IsConstant() && !n->IsArg() &&
+                             !n->op_def().is_stateful() &&
+                             !IsRefType(n->output_type(o));
+      buffer_of_output[{n->id(), o}] = buffers.size();
+      buffers.push_back({n, o, bytes, plannable, {}});
+    }
+  }
+
+  // Returns true if all uses of `a` finish before `b` is produced, in any
+  // schedule.
+  auto before = [&](const Buffer& a, const Buffer& b) {
+    if (a.uses.empty()) return a.node != b.node && reaches(a.node, b.node);
+    for (const Node* use : a.uses) {
+      if (use == b.node || !reaches(use, b.node)) return false;
+    }
+    return true;
+  };
+
+  std::vector<int> planned;
+  for (int i = 0; i < buffers.size(); ++i) {
+    if (buffers[i].plannable) planned.push_back(i);
+  }
+  // Greedy by size: place the largest buffers first, each at the lowest
+  // offset that does not overlap a conflicting buffer placed before it.
+  std::stable_sort(planned.begin(), planned.end(), [&](int a, int b) {
+    return buffers[a].bytes > buffers[b].bytes;
+  });
+  plan->tensors.clear();
+  plan->arena_bytes = 0;
+  plan->total_bytes = 0;
+  std::vector<int64_t> offsets(buffers.size(), -1);
+  std::vector<std::pair<int64_t, int64_t>> conflicts;
+  for (int i = 0; i < planned.size(); ++i) {
+    const Buffer& buffer = buffers[planned[i]];
+    const int64_t size = RoundUp(buffer.bytes, options.alignment);
+    conflicts.clear();
+    for (int j = 0; j < i; ++j) {
+      const Buffer& other = buffers[planned[j]];
+      if (!before(buffer, other) && !before(other, buffer)) {
+        const int64_t offset = offsets[planned[j]];
+        conflicts.emplace_back(offset,
+                               offset + RoundUp(other.bytes, options.alignment));
+      }
+    }
+    std::sort(conflicts.begin(), conflicts.end());
+    int64_t offset = 0;
+    for (const auto& conflict : conflicts) {
+      if (offset + size <= conflict.first) break;
+      offset = std::max(offset, conflict.second);
+    }
+    offsets[planned[i]] = offset;
+    plan->tensors.push_back({buffer.node, buffer.output, buffer.bytes, offset});
+    plan->arena_bytes = std::max(plan->arena_bytes, offset + size);
+    plan->total_bytes += size;
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace tensorflow
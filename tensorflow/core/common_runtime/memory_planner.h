@@ -0,0 +1,83 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_PLANNER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_PLANNER_H_
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "tensorflow/core/graph/graph.h"
+
+namespace tensorflow {
+
+class ShapeRefiner;
+
+// Ahead-of-time memory plan for the intermediate tensors of a graph, in the
+// style of the TFLite ArenaPlanner: every planned tensor gets a fixed offset
+// in an arena, and two tensors share arena memory only if, in every schedule
+// the executor may choose, all uses of one of them finish before the other is
+// produced.
+struct MemoryPlan {
+  struct Tensor {
+    const Node* node;
+    int output;
+    int64_t bytes;
+    int64_t offset;
+  };
+  // Planned tensors, in no particular order.
+  std::vector<Tensor> tensors;
+  // Size of the arena holding all planned tensors.
+  int64_t arena_bytes = 0;
+  // Sum of the sizes of the planned tensors, i.e. the arena size without any
+  // memory reuse.
+  int64_t total_bytes = 0;
+};
+
+struct MemoryPlannerOptions {
+  // Alignment of every planned offset, in bytes.
+  int64_t alignment = 256;
+  // Graphs with more nodes are rejected, because the planner keeps one
+  // reachability bit per pair of nodes.
+  int max_nodes = 16384;
+};
+
+// Returns the size in bytes of output `output` of `node`, or -1 if it is not
+// known statically.
+using OutputBytesFn = std::function<int64_t(const Node& node, int output)>;
+
+// Returns an OutputBytesFn using the fully defined output shapes inferred by
+// `refiner`, which must outlive the result.
+OutputBytesFn OutputBytesFromShapes(const ShapeRefiner& refiner);
+
+// Computes a memory plan for the outputs of `graph` whose size is known from
+// `output_bytes`. Outputs of constants, arguments and stateful ops, reference
+// outputs, and outputs that leave the graph through a Send or _Retval node are
+// not planned. Outputs forwarded by identity-like ops are planned for the
+// lifetime of all their aliases.
+//
+// The plan is only valid if kernels do not forward the buffers of planned
+// tensors to their own outputs. Graphs with control flow are not supported.
+absl::Status PlanStaticMemory(const Graph& graph,
+                              const OutputBytesFn& output_bytes,
+                              const MemoryPlannerOptions& options,
+                              MemoryPlan* plan);
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_MEMORY_PLANNER_H_
@@ -0,0 +1,126 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/common_runtime/memory_planner.h"
+
+#include <memory>
+
+#include "absl/status/status.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+constexpr int64_t kBytes = 1024;
+
+int64_t FixedBytes(const Node& node, int output) { return kBytes; }
+
+const MemoryPlan::Tensor* Find(const MemoryPlan& plan, const Node* node) {
+  for (const MemoryPlan::Tensor& tensor : plan.tensors) {
+    if (tensor.node == node) return &tensor;
+  }
+  return nullptr;
+}
+
+class MemoryPlannerTest : public ::testing::Test {
+ protected:
+  MemoryPlannerTest()
+      : graph_(std::make_unique<Graph>(OpRegistry::Global())),
+        input_(test::graph::Constant(graph_.get(),
+                                     test::AsTensor<float>({1, 2}))) {}
+
+  Node* Neg(Node* in) { return test::graph::Unary(graph_.get(), "Neg", in); }
+
+  std::unique_ptr<Graph> graph_;
+  Node* input_;
+};
+
+TEST_F(MemoryPlannerTest, ReusesMemoryAlongChain) {
+  Node* n1 = Neg(input_);
+  Node* n2 = Neg(n1);
+  Node* n3 = Neg(n2);
+  Node* n4 = Neg(n3);
+  test::graph::Send(graph_.get(), n4, "out", "/cpu:0", 1, "/cpu:0");
+
+  MemoryPlan plan;
+  TF_ASSERT_OK(PlanStaticMemory(*graph_, FixedBytes, {}, &plan));
+  // The constant and the sent tensor are not planned.
+  ASSERT_EQ(3, plan.tensors.size());
+  EXPECT_EQ(nullptr, Find(plan, input_));
+  EXPECT_EQ(nullptr, Find(plan, n4));
+  EXPECT_EQ(3 * kBytes, plan.total_bytes);
+  // `n1` is dead once `n2` finished, so `n3` can reuse its memory.
+  EXPECT_EQ(2 * kBytes, plan.arena_bytes);
+  EXPECT_EQ(Find(plan, n1)->offset, Find(plan, n3)->offset);
+  EXPECT_NE(Find(plan, n1)->offset, Find(plan, n2)->offset);
+}
+
+TEST_F(MemoryPlannerTest, ConcurrentTensorsDoNotOverlap) {
+  Node* a = Neg(input_);
+  Node* b = Neg(input_);
+  Node* sum = test::graph::Add(graph_.get(), a, b);
+  Node* out = Neg(sum);
+  test::graph::Send(graph_.get(), out, "out", "/cpu:0", 1, "/cpu:0");
+
+  MemoryPlan plan;
+  TF_ASSERT_OK(PlanStaticMemory(*graph_, FixedBytes, {}, &plan));
+  ASSERT_EQ(3, plan.tensors.size());
+  // `a` and `b` may be produced in any order, and `sum` reads both of them.
+  EXPECT_EQ(3 * kBytes, plan.arena_bytes);
+}
+
+TEST_F(MemoryPlannerTest, ForwardedBuffersLiveAsLongAsTheirAliases) {
+  Node* a = Neg(input_);
+  Node* alias = test::graph::Identity(graph_.get(), a);
+  Node* b = Neg(input_);
+  // `b` is produced after `a` is last read directly, but not after its alias
+  // is read.
+  graph_->AddControlEdge(alias, b);
+  Node* sum = test::graph::Add(graph_.get(), alias, b);
+  test::graph::Send(graph_.get(), sum, "out", "/cpu:0", 1, "/cpu:0");
+
+  MemoryPlan plan;
+  TF_ASSERT_OK(PlanStaticMemory(*graph_, FixedBytes, {}, &plan));
+  ASSERT_EQ(2, plan.tensors.size());
+  EXPECT_EQ(nullptr, Find(plan, alias));
+  EXPECT_NE(Find(plan, a)->offset, Find(plan, b)->offset);
+}
+
+TEST_F(MemoryPlannerTest, SkipsUnknownSizes) {
+  Node* n = Neg(input_);
+  test::graph::Send(graph_.get(), Neg(n), "out", "/cpu:0", 1, "/cpu:0");
+  MemoryPlan plan;
+  TF_ASSERT_OK(PlanStaticMemory(
+      *graph_, [](const Node&, int) -> int64_t { return -1; }, {}, &plan));
+  EXPECT_TRUE(plan.tensors.empty());
+  EXPECT_EQ(0, plan.arena_bytes);
+}
+
+TEST_F(MemoryPlannerTest, RejectsControlFlow) {
+  Node* pred = test::graph::Constant(graph_.get(), test::AsScalar<bool>(true));
+  test::graph::Switch(graph_.get(), input_, pred);
+  MemoryPlan plan;
+  EXPECT_TRUE(absl::IsUnimplemented(
+      PlanStaticMemory(*graph_, FixedBytes, {}, &plan)));
+}
+
+}  // namespace
+}  // namespace tensorflow
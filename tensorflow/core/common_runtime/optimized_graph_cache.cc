@@ -0,0 +1,103 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/common_runtime/optimized_graph_cache.h"
+
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+
+OptimizedGraphCache::OptimizedGraphCache(Env* env, std::string directory)
+    : env_(env), directory_(std::move(directory)) {}
+
+std::string OptimizedGraphCache::Key(
+    const GraphDef& graph, const std::vector<DeviceAttributes>& devices,
+    const std::vector<std::string>& feeds,
+    const std::vector<std::string>& fetches, const ConfigProto& config) {
+  std::string serialized;
+  std::string key_material = TF_VERSION_STRING;
+  // Length-prefix every component, so that different inputs cannot produce
+  // the same key material.
+  auto append = [&key_material](absl::string_view component) {
+    absl::StrAppend(&key_material, component.size(), ":", component);
+  };
+  SerializeToStringDeterministic(graph, &serialized);
+  append(serialized);
+  for (DeviceAttributes device : devices) {
+    // The incarnation is chosen randomly for each process.
+    device.clear_incarnation();
+    SerializeToStringDeterministic(device, &serialized);
+    append(serialized);
+  }
+  append("feeds");
+  for (const std::string& feed : feeds) append(feed);
+  append("fetches");
+  for (const std::string& fetch : fetches) append(fetch);
+  SerializeToStringDeterministic(config, &serialized);
+  append(serialized);
+
+  const Fprint128 fingerprint = Fingerprint128(key_material);
+  return absl::StrFormat("%016x%016x", fingerprint.high64, fingerprint.low64);
+}
+
+std::string OptimizedGraphCache::Filename(const std::string& key) const {
+  return io::JoinPath(directory_, absl::StrCat(key, ".pb"));
+}
+
+bool OptimizedGraphCache::Lookup(const std::string& key,
+                                 GraphDef* graph) const {
+  const std::string filename = Filename(key);
+  if (!env_->FileExists(filename).ok()) return false;
+  absl::Status s = ReadBinaryProto(env_, filename, graph);
+  if (!s.ok()) {
+    LOG(WARNING) << "Ignoring unreadable optimized graph " << filename << ": "
+                 << s;
+    return false;
+  }
+  VLOG(1) << "Loaded optimized graph from " << filename;
+  return true;
+}
+
+absl::Status OptimizedGraphCache::Insert(const std::string& key,
+                                         const GraphDef& graph) const {
+  TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(directory_));
+  // Write to a unique file first and rename it, so that readers never observe
+  // a partially written entry.
+  std::string tmp_filename = io::JoinPath(directory_, key);
+  if (!env_->CreateUniqueFileName(&tmp_filename, ".tmp")) {
+    return errors::Internal("Failed to create a temporary file name in ",
+                            directory_);
+  }
+  absl::Status s = WriteBinaryProto(env_, tmp_filename, graph);
+  if (s.ok()) s = env_->RenameFile(tmp_filename, Filename(key));
+  if (!s.ok()) {
+    env_->DeleteFile(tmp_filename).IgnoreError();
+    return s;
+  }
+  VLOG(1) << "Saved optimized graph to " << Filename(key);
+  return absl::OkStatus();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,66 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_OPTIMIZED_GRAPH_CACHE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_OPTIMIZED_GRAPH_CACHE_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "tensorflow/core/framework/device_attributes.pb.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+
+// A content-addressed cache of optimized graphs in a directory, which may be
+// shared by several processes.
+//
+// Entries are keyed by everything that determines the result of optimizing a
+// placed graph: the graph, the devices it may use, its feeds and fetches, the
+// session configuration and the version of TensorFlow. Entries are written
+// atomically, so concurrent writers of the same entry are safe.
+class OptimizedGraphCache {
+ public:
+  // Uses `directory` in `env`, creating it when the first entry is inserted.
+  OptimizedGraphCache(Env* env, std::string directory);
+
+  // Returns the cache key of optimizing `graph` with the given devices, feeds,
+  // fetches and configuration.
+  static std::string Key(const GraphDef& graph,
+                         const std::vector<DeviceAttributes>& devices,
+                         const std::vector<std::string>& feeds,
+                         const std::vector<std::string>& fetches,
+                         const ConfigProto& config);
+
+  // Returns true and sets `*graph` if there is an entry for `key`.
+  bool Lookup(const std::string& key, GraphDef* graph) const;
+
+  // Stores `graph` as the entry for `key`.
+  absl::Status Insert(const std::string& key, const GraphDef& graph) const;
+
+ private:
+  std::string Filename(const std::string& key) const;
+
+  Env* const env_;
+  const std::string directory_;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_OPTIMIZED_GRAPH_CACHE_H_
@@ -0,0 +1,98 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/common_runtime/optimized_graph_cache.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/device_attributes.pb.h"
+#include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/config.pb.h"
+
+namespace tensorflow {
+namespace {
+
+GraphDef MakeGraph(const std::string& op) {
+  GraphDef graph;
+  NodeDef* node = graph.add_node();
+  node->set_name("n");
+  node->set_op(op);
+  return graph;
+}
+
+DeviceAttributes MakeDevice(const std::string& name, int64_t incarnation) {
+  DeviceAttributes device;
+  device.set_name(name);
+  device.set_device_type("CPU");
+  device.set_incarnation(incarnation);
+  return device;
+}
+
+TEST(OptimizedGraphCacheTest, KeyDependsOnInputs) {
+  const GraphDef graph = MakeGraph("NoOp");
+  const std::vector<DeviceAttributes> devices = {
+      MakeDevice("/job:localhost/replica:0/task:0/device:CPU:0", 1)};
+  ConfigProto config;
+  const std::string key =
+      OptimizedGraphCache::Key(graph, devices, {"a:0"}, {"n"}, config);
+
+  EXPECT_EQ(key,
+            OptimizedGraphCache::Key(graph, devices, {"a:0"}, {"n"}, config));
+  // Device incarnations differ between processes and are ignored.
+  EXPECT_EQ(key, OptimizedGraphCache::Key(
+                     graph,
+                     {MakeDevice("/job:localhost/replica:0/task:0/device:CPU:0",
+                                 2)},
+                     {"a:0"}, {"n"}, config));
+
+  EXPECT_NE(key, OptimizedGraphCache::Key(MakeGraph("Identity"), devices,
+                                          {"a:0"}, {"n"}, config));
+  EXPECT_NE(key, OptimizedGraphCache::Key(graph, {}, {"a:0"}, {"n"}, config));
+  EXPECT_NE(key, OptimizedGraphCache::Key(graph, devices, {}, {"a:0", "n"},
+                                          config));
+  ConfigProto other_config;
+  other_config.mutable_graph_options()->set_build_cost_model(1);
+  EXPECT_NE(key, OptimizedGraphCache::Key(graph, devices, {"a:0"}, {"n"},
+                                          other_config));
+}
+
+TEST(OptimizedGraphCacheTest, InsertAndLookup) {
+  const std::string directory =
+      io::JoinPath(testing::TmpDir(), "optimized_graph_cache_test");
+  OptimizedGraphCache cache(Env::Default(), directory);
+  const std::string key = OptimizedGraphCache::Key(
+      MakeGraph("NoOp"), {}, {}, {"n"}, ConfigProto());
+
+  GraphDef graph;
+  EXPECT_FALSE(cache.Lookup(key, &graph));
+  TF_ASSERT_OK(cache.Insert(key, MakeGraph("Identity")));
+
+  // A second cache on the same directory, e.g. in another process, sees the
+  // entry.
+  OptimizedGraphCache other_cache(Env::Default(), directory);
+  ASSERT_TRUE(other_cache.Lookup(key, &graph));
+  ASSERT_EQ(1, graph.node_size());
+  EXPECT_EQ("Identity", graph.node(0).op());
+}
+
+}  // namespace
+}  // namespace tensorflow
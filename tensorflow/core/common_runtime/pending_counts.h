@@ -16,12 +16,15 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
 #include <atomic>
 
 #include "tensorflow/core/lib/gtl/flatmap.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/util/port.h"
 
 namespace tensorflow {
@@ -73,31 +76,62 @@ class PendingCounts {
    public:
     Handle CreateHandle(size_t max_pending_count, size_t max_dead_count);
 
+    // Starts a group of handles whose counts are expected to be updated by
+    // the same thread (e.g. the consumers of a single producer), and which
+    // will occupy about `num_bytes` bytes. If the group would straddle a
+    // cache line boundary, the next handle is aligned to the start of a new
+    // cache line, so that different groups updated by different threads are
+    // less likely to share a cache line. Counts for a layout that uses groups
+    // are allocated with cache line alignment.
+    void BeginCacheLineGroup(size_t num_bytes);
+
+    // If true, each PendingCounts with this layout is allocated on the NUMA
+    // node of the thread that creates it (when that thread has a NUMA node
+    // affinity), instead of on whichever node the allocator picks.
+    void set_numa_aware(bool numa_aware) { numa_aware_ = numa_aware; }
+
    private:
     friend class PendingCounts;
     int next_offset_ = 0;  // Next byte offset to allocate
+    bool cache_line_aligned_ = false;
+    bool numa_aware_ = false;
   };
 
   // Create a new PendingCounts object that can hold the state of
   // all the Handles allocated from "final_allocator".
   explicit PendingCounts(Layout layout)
-      : num_bytes_(layout.next_offset_), bytes_(new char[num_bytes_]()) {
-    if (num_bytes_ >= sizeof(LargeCounts)) {
-      CHECK_EQ(uintptr_t(bytes_) % alignof(LargeCounts), 0);
-    }
+      : num_bytes_(layout.next_offset_),
+        cache_line_aligned_(layout.cache_line_aligned_),
+        numa_aware_(layout.numa_aware_),
+        numa_node_(ChooseNUMANode(num_bytes_, numa_aware_)),
+        bytes_(Allocate()) {
+    memset(bytes_, 0, num_bytes_);
   }
 
   // Create a new PendingCounts object with the same layout and counts
   // as "other".
   explicit PendingCounts(const PendingCounts& other)
-      : num_bytes_(other.num_bytes_), bytes_(new char[num_bytes_]) {
-    if (num_bytes_ >= sizeof(LargeCounts)) {
-      CHECK_EQ(uintptr_t(bytes_) % alignof(LargeCounts), 0);
-    }
+      : num_bytes_(other.num_bytes_),
+        cache_line_aligned_(other.cache_line_aligned_),
+        numa_aware_(other.numa_aware_),
+        numa_node_(ChooseNUMANode(num_bytes_, numa_aware_)),
+        bytes_(Allocate()) {
     memcpy(bytes_, other.bytes_, other.num_bytes_);
   }
 
-  ~PendingCounts() { delete[] bytes_; }
+  ~PendingCounts() {
+    if (numa_node_ != port::kNUMANoAffinity) {
+      port::NUMAFree(bytes_, num_bytes_);
+    } else if (cache_line_aligned_) {
+      port::AlignedFree(bytes_);
+    } else {
+      delete[] bytes_;
+    }
+  }
+
+  // Returns the NUMA node on which the counts are allocated, or
+  // `port::kNUMANoAffinity` if they were allocated without an affinity.
+  int numa_node() const { return numa_node_; }
 
   void set_initial_count(Handle h, size_t pending_count) {
     if (h.is_large_) {
@@ -538,8 +572,43 @@ class PendingCounts {
                                                         h.byte_offset_);
   }
 
+  // Assumed size of a cache line, used to avoid false sharing.
+  static constexpr int kCacheLineSize = 64;
+
+  // NUMA allocations are page granular, so they are only used for counts that
+  // span several cache lines.
+  static constexpr int kMinNUMAAllocationBytes = 16 * kCacheLineSize;
+
+  static int ChooseNUMANode(int num_bytes, bool numa_aware) {
+    if (!numa_aware || num_bytes < kMinNUMAAllocationBytes ||
+        !port::NUMAEnabled()) {
+      return port::kNUMANoAffinity;
+    }
+    return port::NUMAGetThreadNodeAffinity();
+  }
+
+  char* Allocate() const {
+    char* bytes;
+    if (numa_node_ != port::kNUMANoAffinity) {
+      bytes = static_cast<char*>(
+          port::NUMAMalloc(numa_node_, num_bytes_, kCacheLineSize));
+    } else if (cache_line_aligned_) {
+      bytes = static_cast<char*>(
+          port::AlignedMalloc(std::max(num_bytes_, 1), kCacheLineSize));
+    } else {
+      bytes = new char[num_bytes_];
+    }
+    if (num_bytes_ >= sizeof(LargeCounts)) {
+      CHECK_EQ(uintptr_t(bytes) % alignof(LargeCounts), 0);
+    }
+    return bytes;
+  }
+
   const int num_bytes_;  // Just for bounds checking in debug mode
-  char* bytes_;          // Array of num_bytes_ bytes
+  const bool cache_line_aligned_;
+  const bool numa_aware_;
+  const int numa_node_;
+  char* bytes_;  // Array of num_bytes_ bytes
 
   void operator=(const PendingCounts&) = delete;
 };
@@ -568,6 +637,14 @@ inline PendingCounts::Handle PendingCounts::Layout::CreateHandle(
   return result;
 }
 
+inline void PendingCounts::Layout::BeginCacheLineGroup(size_t num_bytes) {
+  cache_line_aligned_ = true;
+  const int line_offset = next_offset_ % kCacheLineSize;
+  if (line_offset != 0 && line_offset + num_bytes > kCacheLineSize) {
+    next_offset_ += kCacheLineSize - line_offset;
+  }
+}
+
 }  // end namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_COMMON_RUNTIME_PENDING_COUNTS_H_
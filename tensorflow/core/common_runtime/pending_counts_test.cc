@@ -80,6 +80,52 @@ TEST(PendingCounts, CopyConstructor) {
   }
 }
 
+TEST(PendingCounts, CacheLineGroups) {
+  // Each group mixes one large handle with packed ones. The counts must stay
+  // independent regardless of the padding inserted between groups.
+  const int kNumGroups = 20;
+  const int kGroupSize = 10;
+  PendingCounts::Layout layout;
+  std::vector<PendingCounts::Handle> h;
+  for (int g = 0; g < kNumGroups; g++) {
+    layout.BeginCacheLineGroup(kGroupSize);
+    for (int i = 0; i < kGroupSize; i++) {
+      const int count = (i == 0) ? 100 + g : i % 8;
+      h.push_back(layout.CreateHandle(count, count));
+    }
+  }
+  layout.set_numa_aware(true);
+  PendingCounts c(layout);
+  for (int g = 0; g < kNumGroups; g++) {
+    for (int i = 0; i < kGroupSize; i++) {
+      c.set_initial_count(h[g * kGroupSize + i], (i == 0) ? 100 + g : i % 8);
+    }
+  }
+  PendingCounts c2(c);
+  for (int g = 0; g < kNumGroups; g++) {
+    for (int i = 0; i < kGroupSize; i++) {
+      const int expected = (i == 0) ? 100 + g : i % 8;
+      EXPECT_EQ(c.pending(h[g * kGroupSize + i]), expected);
+      EXPECT_EQ(c2.pending(h[g * kGroupSize + i]), expected);
+    }
+  }
+  // Decrementing one group's counts in one copy must not interfere with any
+  // other count.
+  for (int i = 1; i < kGroupSize; i++) {
+    c2.decrement_pending(h[kGroupSize + i], i % 8);
+  }
+  for (int i = 1; i < kGroupSize; i++) {
+    EXPECT_EQ(c2.pending(h[kGroupSize + i]), 0);
+    EXPECT_EQ(c2.pending(h[i]), i % 8);
+    EXPECT_EQ(c2.pending(h[2 * kGroupSize + i]), i % 8);
+    EXPECT_EQ(c.pending(h[kGroupSize + i]), i % 8);
+  }
+  // The calling thread has no NUMA affinity, so no node is chosen.
+  if (port::NUMAGetThreadNodeAffinity() == port::kNUMANoAffinity) {
+    EXPECT_EQ(c.numa_node(), port::kNUMANoAffinity);
+  }
+}
+
 TEST(PendingCounts, MarkLiveShowsUpAsCount) {
   PendingCounts::Layout layout;
   PendingCounts::Handle handles[2];
@@ -104,11 +104,13 @@ void* PoolAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
     num_bytes += alignment;
   }
   num_bytes += sizeof(ChunkPrefix);
+  const size_t unrounded_num_bytes = num_bytes;
   num_bytes = size_rounder_->RoundUp(num_bytes);
   PtrRecord* pr = nullptr;
   if (has_size_limit_) {
     {
       mutex_lock lock(mutex_);
+      rounding_waste_bytes_ += num_bytes - unrounded_num_bytes;
       auto iter = pool_.find(num_bytes);
       if (iter == pool_.end()) {
         allocated_count_++;
@@ -131,6 +133,7 @@ void* PoolAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
   } else {
     size_t bytes_received;
     void* ptr = allocator_->Alloc(kPoolAlignment, num_bytes, &bytes_received);
+    if (ptr == nullptr) return nullptr;
     return PrepareChunk(ptr, alignment, bytes_received);
   }
 }
@@ -168,6 +171,7 @@ void PoolAllocator::Clear() {
     put_count_ = 0;
     allocated_count_ = 0;
     evicted_count_ = 0;
+    rounding_waste_bytes_ = 0;
     lru_head_ = nullptr;
     lru_tail_ = nullptr;
   }
@@ -95,6 +95,16 @@ class PoolAllocator : public Allocator {
   int64_t evicted_count() const TF_NO_THREAD_SAFETY_ANALYSIS {
     return evicted_count_;
   }
+  // Fraction of Get() requests satisfied from pool.
+  double hit_rate() const TF_NO_THREAD_SAFETY_ANALYSIS {
+    const int64_t get_count = get_from_pool_count_ + allocated_count_;
+    if (get_count == 0) return 0.0;
+    return get_from_pool_count_ / static_cast<double>(get_count);
+  }
+  // Total number of bytes by which "size_rounder" enlarged Get() requests.
+  int64_t rounding_waste_bytes() const TF_NO_THREAD_SAFETY_ANALYSIS {
+    return rounding_waste_bytes_;
+  }
   // Current size limit.
   size_t size_limit() const TF_NO_THREAD_SAFETY_ANALYSIS {
     return pool_size_limit_;
@@ -135,6 +145,7 @@ class PoolAllocator : public Allocator {
   int64_t put_count_ TF_GUARDED_BY(mutex_) = 0;
   int64_t allocated_count_ TF_GUARDED_BY(mutex_) = 0;
   int64_t evicted_count_ TF_GUARDED_BY(mutex_) = 0;
+  int64_t rounding_waste_bytes_ TF_GUARDED_BY(mutex_) = 0;
 };
 
 // Do-nothing rounder. Passes through sizes unchanged.
@@ -151,6 +162,27 @@ class Pow2Rounder : public RoundUpInterface {
   }
 };
 
+// Size class rounder: rounds up to the nearest of 2^sub_buckets_log2 evenly
+// spaced sizes between consecutive powers of 2. Requests of slightly
+// different sizes share a size class and hence pooled buffers, while the
+// rounding wastes at most 1/2^sub_buckets_log2 of each request, instead of up
+// to half of it as with Pow2Rounder.
+class SizeClassRounder : public RoundUpInterface {
+ public:
+  explicit SizeClassRounder(int sub_buckets_log2 = 2)
+      : sub_buckets_log2_(sub_buckets_log2) {}
+
+  size_t RoundUp(size_t num_bytes) override {
+    const int step_log2 = Log2Ceiling64(num_bytes) - 1 - sub_buckets_log2_;
+    if (step_log2 <= 0) return num_bytes;
+    const size_t step_mask = (size_t{1} << step_log2) - 1;
+    return (num_bytes + step_mask) & ~step_mask;
+  }
+
+ private:
+  const int sub_buckets_log2_;
+};
+
 class BasicCPUAllocator : public SubAllocator {
  public:
   BasicCPUAllocator(int numa_node, const std::vector<Visitor>& alloc_visitors,
@@ -805,6 +805,13 @@ absl::Status ProcessFunctionLibraryRuntime::InstantiateMultiDevice(
   }
   TF_RETURN_IF_ERROR(group.as_summary_status());
 
+  for (auto& pair : data->glue_) {
+    pair.second.flr = GetFLR(pair.first);
+  }
+  for (const string& target : GetOrderedSubgraphs(data.get())) {
+    data->ordered_components_.push_back(&data->glue_.at(target));
+  }
+
   std::vector<core::RefCountPtr<FunctionRecord>> function_records;
   const bool should_publish_function_graphs =
       flags::Global().publish_function_graphs.value();
@@ -956,10 +963,11 @@ absl::Status ProcessFunctionLibraryRuntime::RunMultiDeviceSync(
   //
   // We assume that the partitioning has a valid deadlock-free ordering and the
   // safety of running synchronously has already been confirmed by this point.
-  std::vector<string> subgraph_keys = GetOrderedSubgraphs(data);
-
-  for (const string& target : subgraph_keys) {
-    const ComponentFunctionData& comp_data = data->glue_.at(target);
+  //
+  // The order is computed once at instantiation, see ordered_components_.
+  rets->resize(data->num_outputs_);
+  for (const ComponentFunctionData* comp : data->ordered_components_) {
+    const ComponentFunctionData& comp_data = *comp;
     FunctionLibraryRuntime::Handle comp_handle = comp_data.handle;
 
     opts_copy.args_alloc_attrs = comp_data.arg_alloc_attrs;
@@ -971,11 +979,10 @@ absl::Status ProcessFunctionLibraryRuntime::RunMultiDeviceSync(
       VLOG(2) << "Failed to get component function arguments: " << args_status;
       return args_status;
     }
-    rets->resize(data->num_outputs_);
 
-    VLOG(1) << "Running component function on device " << target << " from "
+    VLOG(1) << "Running component function " << comp_data.name << " from "
             << data->function_name_ << " with handle " << comp_handle;
-    FunctionLibraryRuntime* flr = GetFLR(target);
+    FunctionLibraryRuntime* flr = comp_data.flr;
     if (flr != nullptr) {
       opts_copy.remote_execution = false;
       // When target device has private thread pool, use the target device
@@ -1053,6 +1060,7 @@ void ProcessFunctionLibraryRuntime::RunMultiDeviceAsync(
   }
 
   FunctionLibraryRuntime::Options opts_copy = opts;
+  rets->resize(data->num_outputs_);
   for (const auto& pair : data->glue_) {
     const string& target = pair.first;
     const ComponentFunctionData& comp_data = pair.second;
@@ -1072,11 +1080,12 @@ void ProcessFunctionLibraryRuntime::RunMultiDeviceAsync(
       continue;
     }
     std::vector<FunctionRet>* comp_rets = new std::vector<FunctionRet>;
-    rets->resize(data->num_outputs_);
 
-    auto component_fn_callback = [comp_rets, rets, comp_data, refcounted_done,
+    // `data` outlives the call, so the callback refers to the component's
+    // data rather than copying it on every call.
+    auto component_fn_callback = [comp_rets, rets, &comp_data, refcounted_done,
                                   cm, local_cm, data, comp_handle,
-                                  target](const absl::Status& status) {
+                                  &target](const absl::Status& status) {
       if (!status.ok()) {
         VLOG(2) << "Component function execution on target " << target
                 << " from " << data->function_name_ << " with handle "
@@ -1101,7 +1110,7 @@ void ProcessFunctionLibraryRuntime::RunMultiDeviceAsync(
       refcounted_done->Unref();
     };
 
-    FunctionLibraryRuntime* flr = GetFLR(target);
+    FunctionLibraryRuntime* flr = comp_data.flr;
     if (flr != nullptr) {
       opts_copy.remote_execution = false;
       // When target device has private thread pool, use the target device
@@ -1330,6 +1339,7 @@ absl::Status ProcessFunctionLibraryRuntime::GetComponentArgs(
     const ProcessFunctionLibraryRuntime::ComponentFunctionData& comp_data,
     ProcessFunctionLibraryRuntime::InternalArgs* comp_args) {
   // "Index"s of _Arg nodes are unique when all arguments are local Tensors.
+  comp_args->args.reserve(comp_data.arg_indices.size());
   for (const auto& it : comp_data.arg_indices) {
     if (it.index >= args.size()) {
       return errors::InvalidArgument("index ", it.index,
@@ -282,6 +282,10 @@ class ProcessFunctionLibraryRuntime {
     // ret_alloc_attrs[i] are the allocator attributes of the i-th return value
     // of the component function.
     std::vector<AllocatorAttributes> ret_alloc_attrs;
+    // The runtime of the device the component function runs on, or nullptr
+    // if the device is in another process. Resolved at instantiation so that
+    // running the function does not look the device up by name.
+    FunctionLibraryRuntime* flr = nullptr;
 
     AsyncAttributes async_attributes;
   };
@@ -320,6 +324,9 @@ class ProcessFunctionLibraryRuntime {
     // Maps the device name to the information about the component function
     // be run on this device.
     std::unordered_map<string, ComponentFunctionData> glue_;
+    // The components of `glue_` in the order in which the synchronous
+    // execution path runs them, see GetOrderedSubgraphs().
+    std::vector<const ComponentFunctionData*> ordered_components_;
   };
 
   struct CleanUpItem {
@@ -21,7 +21,9 @@ limitations under the License.
 
 #include "absl/base/call_once.h"
 #include "tensorflow/core/common_runtime/bfc_allocator.h"
+#include "tensorflow/core/common_runtime/huge_page_allocator.h"
 #include "tensorflow/core/common_runtime/pool_allocator.h"
+#include "tensorflow/core/common_runtime/thread_caching_allocator.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/log_memory.h"
 #include "tensorflow/core/framework/tracking_allocator.h"
@@ -61,6 +63,37 @@ ProcessState::MemDesc ProcessState::PtrType(const void* ptr) {
   return MemDesc();
 }
 
+namespace {
+
+// Reads the options of the HugePageCPUAllocator of GetCPUAllocator() from the
+// environment.
+HugePageCPUAllocator::Options HugePageOptionsFromEnv() {
+  HugePageCPUAllocator::Options options;
+  int64_t threshold_in_kb = options.min_huge_page_allocation_bytes >> 10;
+  absl::Status status = ReadInt64FromEnvVar(
+      "TF_CPU_HUGE_PAGE_THRESHOLD_IN_KB", threshold_in_kb, &threshold_in_kb);
+  if (!status.ok()) {
+    LOG(ERROR) << "GetCPUAllocator: " << status.message();
+  }
+  options.min_huge_page_allocation_bytes = threshold_in_kb << 10;
+  int64_t page_size_in_kb = options.huge_page_bytes >> 10;
+  status = ReadInt64FromEnvVar("TF_CPU_HUGE_PAGE_SIZE_IN_KB", page_size_in_kb,
+                               &page_size_in_kb);
+  if (!status.ok()) {
+    LOG(ERROR) << "GetCPUAllocator: " << status.message();
+  }
+  options.huge_page_bytes = page_size_in_kb << 10;
+  status = ReadBoolFromEnvVar("TF_CPU_EXPLICIT_HUGE_PAGES",
+                              options.use_explicit_huge_pages,
+                              &options.use_explicit_huge_pages);
+  if (!status.ok()) {
+    LOG(ERROR) << "GetCPUAllocator: " << status.message();
+  }
+  return options;
+}
+
+}  // namespace
+
 Allocator* ProcessState::GetCPUAllocator(int numa_node) {
   if (!numa_enabled_ || numa_node == port::kNUMANoAffinity) numa_node = 0;
 
@@ -76,19 +109,39 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
     // depending on env var setting.
     const bool alloc_visitors_defined =
         (!cpu_alloc_visitors_.empty() || !cpu_free_visitors_.empty());
-    bool use_bfc_allocator = false;
+    // Huge pages are requested by the SubAllocator, so they are only used
+    // through a BFCAllocator or PoolAllocator, by default the former.
+    bool use_huge_pages = false;
     absl::Status status = ReadBoolFromEnvVar(
-        "TF_CPU_ALLOCATOR_USE_BFC", alloc_visitors_defined, &use_bfc_allocator);
+        "TF_CPU_ALLOCATOR_USE_HUGE_PAGES", false, &use_huge_pages);
+    if (!status.ok()) {
+      LOG(ERROR) << "GetCPUAllocator: " << status.message();
+    }
+    if (use_huge_pages && !HugePageCPUAllocator::IsSupported()) {
+      LOG(WARNING) << "TF_CPU_ALLOCATOR_USE_HUGE_PAGES is ignored because "
+                      "huge pages are not supported on this platform";
+      use_huge_pages = false;
+    }
+    bool use_bfc_allocator = false;
+    status = ReadBoolFromEnvVar("TF_CPU_ALLOCATOR_USE_BFC",
+                                alloc_visitors_defined || use_huge_pages,
+                                &use_bfc_allocator);
     if (!status.ok()) {
       LOG(ERROR) << "GetCPUAllocator: " << status.message();
     }
     Allocator* allocator = nullptr;
-    SubAllocator* sub_allocator =
-        (numa_enabled_ || alloc_visitors_defined || use_bfc_allocator)
-            ? new BasicCPUAllocator(
-                  numa_enabled_ ? numa_node : port::kNUMANoAffinity,
-                  cpu_alloc_visitors_, cpu_free_visitors_)
-            : nullptr;
+    const int sub_allocator_numa_node =
+        numa_enabled_ ? numa_node : port::kNUMANoAffinity;
+    SubAllocator* sub_allocator = nullptr;
+    if (use_huge_pages) {
+      sub_allocator = new HugePageCPUAllocator(
+          sub_allocator_numa_node, HugePageOptionsFromEnv(),
+          cpu_alloc_visitors_, cpu_free_visitors_);
+    } else if (numa_enabled_ || alloc_visitors_defined || use_bfc_allocator) {
+      sub_allocator =
+          new BasicCPUAllocator(sub_allocator_numa_node, cpu_alloc_visitors_,
+                                cpu_free_visitors_);
+    }
     if (use_bfc_allocator) {
       // TODO(reedwm): evaluate whether 64GB by default is the best choice.
       int64_t cpu_mem_limit_in_mb = -1;
@@ -107,6 +160,19 @@ Allocator* ProcessState::GetCPUAllocator(int numa_node) {
           absl::WrapUnique(sub_allocator), cpu_mem_limit,
           /*name=*/"bfc_cpu_allocator_for_gpu", allocator_opts);
 
+      bool use_thread_cache = false;
+      status = ReadBoolFromEnvVar("TF_CPU_BFC_THREAD_CACHE",
+                                  /*default_val=*/false, &use_thread_cache);
+      if (!status.ok()) {
+        LOG(ERROR) << "GetCPUAllocator: " << status.message();
+      }
+      if (use_thread_cache) {
+        // Serve small allocations from per-thread caches, so that they do
+        // not contend on the lock of the BFCAllocator.
+        allocator = new ThreadCachingAllocator(
+            absl::WrapUnique(allocator), ThreadCachingAllocator::Options());
+      }
+
       VLOG(2) << "Using BFCAllocator with memory limit of "
               << cpu_mem_limit_in_mb << " MB for ProcessState CPU allocator";
     } else if (sub_allocator) {
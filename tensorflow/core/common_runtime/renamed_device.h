@@ -139,6 +139,12 @@ class RenamedDevice : public Device {
     return underlying_device_->TryGetDeviceContext(out_context);
   }
 
+  absl::Status FillContextMap(
+      const Graph* graph,
+      std::vector<DeviceContext*>* device_context_map) override {
+    return underlying_device_->FillContextMap(graph, device_context_map);
+  }
+
   // Returns the resource manager associated w/ this device.
   ResourceMgr* resource_manager() override {
     if (isolate_session_state_) {
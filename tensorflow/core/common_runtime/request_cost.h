@@ -69,6 +69,9 @@ class RequestCost {
     int64_t padding_size = 0;
     // Costs for processing this batch.
     absl::flat_hash_map<std::string, absl::Duration> batch_costs;
+    // Time the input from this rpc request waited before this batch started
+    // processing.
+    absl::Duration queueing_delay = absl::ZeroDuration();
   };
 
   // Records the metrics of a batch.
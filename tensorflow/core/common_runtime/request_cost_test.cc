@@ -88,18 +88,21 @@ TEST(RequestCostTest, RecordBatchMetrics) {
       /*processed_size=*/4,
       /*input_size=*/2,
       /*padding_size=*/1,
-      {{"gcu", absl::Milliseconds(40)}, {"tpu", absl::Milliseconds(80)}}});
+      {{"gcu", absl::Milliseconds(40)}, {"tpu", absl::Milliseconds(80)}},
+      /*queueing_delay=*/absl::Milliseconds(5)});
 
   EXPECT_THAT(
       request_cost.GetBatchMetrics(),
       ElementsAre(
           FieldsAre(8, 8, 0,
                     UnorderedElementsAre(Pair("gcu", absl::Milliseconds(80)),
-                                         Pair("tpu", absl::Milliseconds(160)))),
+                                         Pair("tpu", absl::Milliseconds(160))),
+                    absl::ZeroDuration()),
           FieldsAre(
               4, 2, 1,
               UnorderedElementsAre(Pair("gcu", absl::Milliseconds(40)),
-                                   Pair("tpu", absl::Milliseconds(80))))));
+                                   Pair("tpu", absl::Milliseconds(80))),
+              absl::Milliseconds(5))));
 
   request_cost.ScaleBatchCosts(4);
   EXPECT_THAT(
@@ -107,11 +110,13 @@ TEST(RequestCostTest, RecordBatchMetrics) {
       ElementsAre(
           FieldsAre(8, 8, 0,
                     UnorderedElementsAre(Pair("gcu", absl::Milliseconds(320)),
-                                         Pair("tpu", absl::Milliseconds(640)))),
+                                         Pair("tpu", absl::Milliseconds(640))),
+                    absl::ZeroDuration()),
           FieldsAre(
               4, 2, 1,
               UnorderedElementsAre(Pair("gcu", absl::Milliseconds(160)),
-                                   Pair("tpu", absl::Milliseconds(320))))));
+                                   Pair("tpu", absl::Milliseconds(320))),
+              absl::Milliseconds(5))));
 }
 
 }  // namespace
@@ -404,13 +404,25 @@ void RingAlg::DispatchSend(RingField* rf, const StatusCallback& done) {
   int send_to_rank = (rf->rank + 1) % group_size_;
   int send_to_dev_idx = col_params_->instance.impl_details
                             .subdiv_permutations[rf->subdiv_idx][send_to_rank];
+  const Tensor* src_tensor = &rf->chunk;
+  StatusCallback send_done = done;
+  if (collective_util::UseWireDataType(*col_params_, col_ctx_->device)) {
+    // The converted value must live until the send is done.
+    Tensor* wire_value = new Tensor(collective_util::ToWireTensor(
+        rf->chunk, col_params_->instance.impl_details.wire_dtype));
+    src_tensor = wire_value;
+    send_done = [wire_value, done](const absl::Status& s) {
+      delete wire_value;
+      done(s);
+    };
+  }
   col_ctx_->col_exec->remote_access()->PostToPeer(
       col_params_->group.members[send_to_dev_idx].device.name(),
       col_params_->group.members[send_to_dev_idx].task, send_buf_key,
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
-      col_ctx_->op_ctx->output_alloc_attr(0), &rf->chunk,
+      col_ctx_->op_ctx->output_alloc_attr(0), src_tensor,
       col_ctx_->device_locality, col_ctx_->op_ctx->cancellation_manager(),
-      done);
+      send_done);
 }
 
 void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
@@ -424,6 +436,18 @@ void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
   Tensor* dst_tensor = (!rf->second_pass && (col_params_->merge_op != nullptr))
                            ? &rf->tmp_chunk
                            : &rf->chunk;
+  StatusCallback recv_done = done;
+  if (collective_util::UseWireDataType(*col_params_, col_ctx_->device)) {
+    Tensor* wire_value =
+        new Tensor(col_params_->instance.impl_details.wire_dtype,
+                   dst_tensor->shape());
+    recv_done = [wire_value, dst_tensor, done](const absl::Status& s) {
+      if (s.ok()) collective_util::FromWireTensor(*wire_value, dst_tensor);
+      delete wire_value;
+      done(s);
+    };
+    dst_tensor = wire_value;
+  }
   col_ctx_->col_exec->remote_access()->RecvFromPeer(
       col_params_->group.members[rf->recv_dev_idx].device.name(),
       col_params_->group.members[rf->recv_dev_idx].task,
@@ -431,7 +455,7 @@ void RingAlg::DispatchRecv(RingField* rf, const StatusCallback& done) {
       col_ctx_->device, col_ctx_->op_ctx->op_device_context(),
       col_ctx_->op_ctx->output_alloc_attr(0), dst_tensor,
       col_ctx_->device_locality, rf->subdiv_idx,
-      col_ctx_->op_ctx->cancellation_manager(), done);
+      col_ctx_->op_ctx->cancellation_manager(), recv_done);
 }
 
 string RingAlg::FieldState() {
@@ -0,0 +1,120 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/run_result_cache.h"
+
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/hash.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+
+RunResultCache::RunResultCache(int64_t capacity) : capacity_(capacity) {
+  DCHECK_GT(capacity_, 0);
+}
+
+bool RunResultCache::IsCacheable(absl::Span<const Tensor> feeds) {
+  for (const Tensor& t : feeds) {
+    if (!t.IsInitialized()) return false;
+    if (t.dtype() != DT_STRING && !DataTypeCanUseMemcpy(t.dtype())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint64 RunResultCache::Fingerprint(absl::Span<const Tensor> feeds) {
+  uint64 fingerprint = feeds.size();
+  for (const Tensor& t : feeds) {
+    fingerprint = Hash64Combine(fingerprint, t.dtype());
+    for (const int64_t dim : t.shape().dim_sizes()) {
+      fingerprint = Hash64Combine(fingerprint, dim);
+    }
+    if (t.dtype() == DT_STRING) {
+      auto flat = t.flat<tstring>();
+      for (int64_t i = 0; i < flat.size(); ++i) {
+        fingerprint = Hash64Combine(fingerprint, Hash64(flat(i)));
+      }
+    } else {
+      const StringPiece data = t.tensor_data();
+      fingerprint =
+          Hash64Combine(fingerprint, Hash64(data.data(), data.size()));
+    }
+  }
+  return fingerprint;
+}
+
+bool RunResultCache::Equal(absl::Span<const Tensor> a,
+                           absl::Span<const Tensor> b) {
+  if (a.size() != b.size()) return false;
+  for (int i = 0; i < a.size(); ++i) {
+    if (a[i].dtype() != b[i].dtype() || a[i].shape() != b[i].shape()) {
+      return false;
+    }
+    if (a[i].dtype() == DT_STRING) {
+      auto a_flat = a[i].flat<tstring>();
+      auto b_flat = b[i].flat<tstring>();
+      for (int64_t j = 0; j < a_flat.size(); ++j) {
+        if (a_flat(j) != b_flat(j)) return false;
+      }
+    } else if (a[i].tensor_data() != b[i].tensor_data()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool RunResultCache::Lookup(absl::Span<const Tensor> feeds,
+                            std::vector<Tensor>* outputs) {
+  const uint64 fingerprint = Fingerprint(feeds);
+  mutex_lock l(mu_);
+  auto it = index_.find(fingerprint);
+  if (it == index_.end() || !Equal(feeds, it->second->feeds)) return false;
+  lru_.splice(lru_.begin(), lru_, it->second);
+  *outputs = it->second->outputs;
+  return true;
+}
+
+void RunResultCache::Insert(absl::Span<const Tensor> feeds,
+                            const std::vector<Tensor>& outputs) {
+  // Copy the feeds, because the caller may reuse their buffers.
+  Entry entry;
+  entry.fingerprint = Fingerprint(feeds);
+  entry.feeds.reserve(feeds.size());
+  for (const Tensor& t : feeds) {
+    entry.feeds.push_back(tensor::DeepCopy(t));
+  }
+  entry.outputs = outputs;
+
+  mutex_lock l(mu_);
+  auto it = index_.find(entry.fingerprint);
+  if (it != index_.end()) {
+    lru_.erase(it->second);
+    index_.erase(it);
+  } else if (lru_.size() >= capacity_) {
+    index_.erase(lru_.back().fingerprint);
+    lru_.pop_back();
+  }
+  lru_.push_front(std::move(entry));
+  index_[lru_.front().fingerprint] = lru_.begin();
+}
+
+int64_t RunResultCache::size() const {
+  mutex_lock l(mu_);
+  return lru_.size();
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,88 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_RUN_RESULT_CACHE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_RUN_RESULT_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A bounded LRU cache from the values fed to a stateless graph to the values
+// it produced.
+//
+// Entries are keyed by a fingerprint of the fed tensors, and a lookup only
+// hits if the fed tensors are also equal to a private copy of the tensors that
+// produced the entry, so fingerprint collisions cannot return stale results.
+// The cached outputs are shared with the callers of Lookup(), which must not
+// modify their buffers.
+//
+// This class is thread safe.
+class RunResultCache {
+ public:
+  // `capacity` is the maximum number of cached entries, and must be positive.
+  explicit RunResultCache(int64_t capacity);
+
+  // Returns true if the fed tensors `feeds` can be used as a cache key, i.e.
+  // all of them have a type whose value can be compared bytewise or are
+  // strings.
+  static bool IsCacheable(absl::Span<const Tensor> feeds);
+
+  // If `feeds` hits the cache, sets `*outputs` to the cached outputs and
+  // returns true. `feeds` must be cacheable.
+  bool Lookup(absl::Span<const Tensor> feeds, std::vector<Tensor>* outputs)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Caches `outputs` as the result of `feeds`, evicting the least recently
+  // used entry if the cache is full. `feeds` must be cacheable.
+  void Insert(absl::Span<const Tensor> feeds,
+              const std::vector<Tensor>& outputs) TF_LOCKS_EXCLUDED(mu_);
+
+  int64_t size() const TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct Entry {
+    uint64 fingerprint;
+    std::vector<Tensor> feeds;
+    std::vector<Tensor> outputs;
+  };
+
+  static uint64 Fingerprint(absl::Span<const Tensor> feeds);
+  static bool Equal(absl::Span<const Tensor> a, absl::Span<const Tensor> b);
+
+  const int64_t capacity_;
+
+  mutable mutex mu_;
+  // Most recently used entries first.
+  std::list<Entry> lru_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<uint64, std::list<Entry>::iterator> index_
+      TF_GUARDED_BY(mu_);
+
+  RunResultCache(const RunResultCache&) = delete;
+  void operator=(const RunResultCache&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_RUN_RESULT_CACHE_H_
@@ -0,0 +1,85 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/run_result_cache.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(RunResultCacheTest, HitsOnEqualFeeds) {
+  RunResultCache cache(2);
+  std::vector<Tensor> feeds = {test::AsTensor<float>({1, 2, 3}),
+                               test::AsTensor<tstring>({"a", "b"})};
+  std::vector<Tensor> outputs;
+  EXPECT_FALSE(cache.Lookup(feeds, &outputs));
+  cache.Insert(feeds, {test::AsScalar<float>(6)});
+
+  // Equal feeds in different buffers hit the cache.
+  std::vector<Tensor> same_feeds = {test::AsTensor<float>({1, 2, 3}),
+                                    test::AsTensor<tstring>({"a", "b"})};
+  ASSERT_TRUE(cache.Lookup(same_feeds, &outputs));
+  ASSERT_EQ(1, outputs.size());
+  test::ExpectTensorEqual<float>(test::AsScalar<float>(6), outputs[0]);
+
+  std::vector<Tensor> other_feeds = {test::AsTensor<float>({1, 2, 4}),
+                                     test::AsTensor<tstring>({"a", "b"})};
+  EXPECT_FALSE(cache.Lookup(other_feeds, &outputs));
+}
+
+TEST(RunResultCacheTest, CopiesFeeds) {
+  RunResultCache cache(1);
+  Tensor feed = test::AsTensor<int32>({1, 2});
+  cache.Insert({feed}, {test::AsScalar<int32>(3)});
+  // Mutating the fed buffer in place must not change the cached key.
+  feed.flat<int32>()(1) = 5;
+  std::vector<Tensor> outputs;
+  EXPECT_FALSE(cache.Lookup({feed}, &outputs));
+  EXPECT_TRUE(cache.Lookup({test::AsTensor<int32>({1, 2})}, &outputs));
+}
+
+TEST(RunResultCacheTest, EvictsLeastRecentlyUsed) {
+  RunResultCache cache(2);
+  const Tensor a = test::AsScalar<int32>(1);
+  const Tensor b = test::AsScalar<int32>(2);
+  const Tensor c = test::AsScalar<int32>(3);
+  cache.Insert({a}, {a});
+  cache.Insert({b}, {b});
+  std::vector<Tensor> outputs;
+  // Touch `a`, so that `b` is evicted next.
+  EXPECT_TRUE(cache.Lookup({a}, &outputs));
+  cache.Insert({c}, {c});
+  EXPECT_EQ(2, cache.size());
+  EXPECT_TRUE(cache.Lookup({a}, &outputs));
+  EXPECT_FALSE(cache.Lookup({b}, &outputs));
+  EXPECT_TRUE(cache.Lookup({c}, &outputs));
+}
+
+TEST(RunResultCacheTest, IsCacheable) {
+  EXPECT_TRUE(RunResultCache::IsCacheable({}));
+  EXPECT_TRUE(RunResultCache::IsCacheable(
+      {test::AsScalar<float>(1), test::AsScalar<tstring>("x")}));
+  EXPECT_FALSE(RunResultCache::IsCacheable({Tensor(DT_RESOURCE, {})}));
+  EXPECT_FALSE(RunResultCache::IsCacheable({Tensor(DT_VARIANT, {})}));
+}
+
+}  // namespace
+}  // namespace tensorflow
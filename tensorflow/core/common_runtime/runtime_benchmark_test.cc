@@ -0,0 +1,262 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// Microbenchmarks for the hot paths of the core runtime: executor dispatch,
+// allocator churn, rendezvous Send/Recv, ResourceMgr lookup, function
+// instantiation, multi-device function calls and tf.data per-element
+// overhead.
+//
+// The workloads and their arguments are fixed so that results are comparable
+// from one run to the next. Run the whole suite with machine-readable output
+// with
+//
+//   bazel run -c opt //tensorflow/core/common_runtime:runtime_benchmark_test \
+//     -- --benchmark_filter=all --benchmark_format=json
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/device_factory.h"
+#include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/common_runtime/process_function_library_runtime.h"
+#include "tensorflow/core/common_runtime/rendezvous_mgr.h"
+#include "tensorflow/core/data/standalone.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/rendezvous.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/algorithm.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/public/version.h"
+
+namespace tensorflow {
+namespace {
+
+// Executor dispatch: a chain of `length` Identity nodes, which measures the
+// per-node cost of the executor rather than the cost of the kernels.
+void BM_ExecutorDispatch(::testing::benchmark::State& state) {
+  const int length = state.range(0);
+
+  Graph* g = new Graph(OpRegistry::Global());
+  Node* node = test::graph::Constant(g, test::AsScalar<float>(1.0));
+  for (int i = 0; i < length; ++i) {
+    node = test::graph::Identity(g, node);
+  }
+  FixupSourceAndSinkEdges(g);
+  test::Benchmark("cpu", g, /*old_benchmark_api=*/false).Run(state);
+  state.SetItemsProcessed((length + 1) *
+                          static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_ExecutorDispatch)->UseRealTime()->Arg(1)->Arg(64)->Arg(1024);
+
+// Allocator churn: allocates and frees batches of `size` byte buffers from
+// the CPU allocator, as kernels do for their outputs and temporaries.
+void BM_AllocatorChurn(::testing::benchmark::State& state) {
+  const size_t size = state.range(0);
+  constexpr int kBatch = 64;
+
+  Allocator* allocator = cpu_allocator();
+  std::vector<void*> buffers(kBatch);
+  for (auto s : state) {
+    for (int i = 0; i < kBatch; ++i) {
+      buffers[i] = allocator->AllocateRaw(Allocator::kAllocatorAlignment, size);
+    }
+    for (int i = 0; i < kBatch; ++i) {
+      allocator->DeallocateRaw(buffers[i]);
+    }
+  }
+  state.SetItemsProcessed(kBatch * static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_AllocatorChurn)->Arg(64)->Arg(4 << 10)->Arg(1 << 20);
+
+// Rendezvous Send/Recv: passes a float tensor of `num_elements` elements
+// through an intra-process rendezvous, as the executor does across devices.
+void BM_RendezvousSendRecv(::testing::benchmark::State& state) {
+  const int num_elements = state.range(0);
+
+  auto device_mgr = std::make_unique<StaticDeviceMgr>(
+      DeviceFactory::NewDevice("CPU", {}, "/job:localhost/replica:0/task:0"));
+  auto* rendez = new IntraProcessRendezvous(device_mgr.get());
+  Rendezvous::ParsedKey key;
+  TF_CHECK_OK(Rendezvous::ParseKey(
+      Rendezvous::CreateKey("/job:localhost/replica:0/task:0/cpu:0", 1,
+                            "/job:localhost/replica:0/task:0/cpu:0", "x",
+                            FrameAndIter(0, 0)),
+      &key));
+  Tensor orig(DT_FLOAT, TensorShape({num_elements}));
+  orig.flat<float>().setZero();
+  Tensor val;
+  bool is_dead = false;
+  Rendezvous::Args args;
+
+  for (auto s : state) {
+    TF_CHECK_OK(rendez->Send(key, args, orig, is_dead));
+    TF_CHECK_OK(rendez->Recv(key, args, &val, &is_dead));
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+
+  rendez->Unref();
+}
+BENCHMARK(BM_RendezvousSendRecv)->Arg(1)->Arg(1 << 16);
+
+class BenchmarkResource : public ResourceBase {
+ public:
+  std::string DebugString() const override { return "BenchmarkResource"; }
+};
+
+// ResourceMgr lookup: looks up one of `num_resources` resources of a
+// container by name, as variable and table ops do on every step.
+void BM_ResourceMgrLookup(::testing::benchmark::State& state) {
+  const int num_resources = state.range(0);
+
+  ResourceMgr rm;
+  for (int i = 0; i < num_resources; ++i) {
+    TF_CHECK_OK(rm.Create("container", strings::StrCat("resource", i),
+                          new BenchmarkResource));
+  }
+  const std::string name = strings::StrCat("resource", num_resources / 2);
+  for (auto s : state) {
+    BenchmarkResource* resource;
+    TF_CHECK_OK(rm.Lookup("container", name, &resource));
+    resource->Unref();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_ResourceMgrLookup)->Arg(1)->Arg(1024);
+
+// Function instantiation: instantiates and releases a small function, which
+// rebuilds its graph and executor every time.
+void BM_FunctionInstantiation(::testing::benchmark::State& state) {
+  SessionOptions options;
+  std::vector<std::unique_ptr<Device>> devices;
+  TF_CHECK_OK(DeviceFactory::AddDevices(
+      options, "/job:localhost/replica:0/task:0", &devices));
+  StaticDeviceMgr device_mgr(std::move(devices));
+  FunctionDefLibrary proto;
+  *proto.add_function() = test::function::XTimesTwo();
+  FunctionLibraryDefinition lib_def(OpRegistry::Global(), proto);
+  ProcessFunctionLibraryRuntime pflr(
+      &device_mgr, Env::Default(), /*config=*/nullptr, TF_GRAPH_DEF_VERSION,
+      &lib_def, OptimizerOptions());
+  FunctionLibraryRuntime* flr =
+      pflr.GetFLR("/job:localhost/replica:0/task:0/cpu:0");
+
+  for (auto s : state) {
+    FunctionLibraryRuntime::Handle handle;
+    TF_CHECK_OK(flr->Instantiate(
+        "XTimesTwo", test::function::Attrs({{"T", DT_FLOAT}}), &handle));
+    TF_CHECK_OK(flr->ReleaseHandle(handle));
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_FunctionInstantiation);
+
+// Multi-device function calls: runs a small function whose result is
+// returned on another device than it is computed on, which measures the
+// per-call bookkeeping of fanning out to the component functions.
+void BM_MultiDeviceFunctionRun(::testing::benchmark::State& state) {
+  SessionOptions options;
+  (*options.config.mutable_device_count())["CPU"] = 2;
+  std::vector<std::unique_ptr<Device>> devices;
+  TF_CHECK_OK(DeviceFactory::AddDevices(
+      options, "/job:localhost/replica:0/task:0", &devices));
+  StaticDeviceMgr device_mgr(std::move(devices));
+  FunctionDefLibrary proto;
+  *proto.add_function() = test::function::XTimesTwo();
+  FunctionLibraryDefinition lib_def(OpRegistry::Global(), proto);
+  thread::ThreadPool pool(Env::Default(), "multi_device_function", 4);
+  ProcessFunctionLibraryRuntime pflr(
+      &device_mgr, Env::Default(), /*config=*/nullptr, TF_GRAPH_DEF_VERSION,
+      &lib_def, OptimizerOptions(), &pool, /*parent=*/nullptr,
+      /*session_metadata=*/nullptr,
+      Rendezvous::Factory{[](const int64_t, const DeviceMgr* device_mgr,
+                             tsl::core::RefCountPtr<Rendezvous>* r) {
+        *r = tsl::core::RefCountPtr<Rendezvous>(
+            new IntraProcessRendezvous(device_mgr));
+        return absl::OkStatus();
+      }});
+
+  FunctionLibraryRuntime::InstantiateOptions inst_opts;
+  inst_opts.target = "/job:localhost/replica:0/task:0/device:CPU:0";
+  inst_opts.input_devices = {"/job:localhost/replica:0/task:0/device:CPU:0"};
+  inst_opts.output_devices = {"/job:localhost/replica:0/task:0/device:CPU:1"};
+  inst_opts.is_multi_device_function = true;
+  FunctionLibraryRuntime::Handle handle;
+  TF_CHECK_OK(pflr.Instantiate("XTimesTwo",
+                               test::function::Attrs({{"T", DT_FLOAT}}),
+                               inst_opts, &handle));
+
+  FunctionLibraryRuntime::Options opts;
+  const std::vector<Tensor> args = {test::AsScalar<float>(1.0)};
+  std::vector<Tensor> rets;
+  for (auto s : state) {
+    TF_CHECK_OK(pflr.RunSync(opts, handle, args, &rets));
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+  TF_CHECK_OK(pflr.ReleaseHandle(handle));
+}
+BENCHMARK(BM_MultiDeviceFunctionRun)->UseRealTime();
+
+// tf.data per-element overhead: iterates over `range(num_elements)`, which
+// does next to no work per element.
+void BM_DatasetGetNext(::testing::benchmark::State& state) {
+  const int64_t num_elements = state.range(0);
+
+  auto scalar = [](const std::string& name, int64_t value) {
+    return test::function::NDef(
+        name, "Const", {},
+        {{"dtype", DT_INT64}, {"value", test::AsScalar<int64_t>(value)}});
+  };
+  const GraphDef graph_def = test::function::GDef({
+      scalar("start", 0),
+      scalar("stop", num_elements),
+      scalar("step", 1),
+      test::function::NDef(
+          "range", "RangeDataset", {"start", "stop", "step"},
+          {{"output_shapes", absl::Span<const TensorShape>({TensorShape()})},
+           {"output_types", DataTypeSlice({DT_INT64})}}),
+      test::function::NDef("dataset", "_Retval", {"range"},
+                           {{"T", DT_VARIANT}, {"index", 0}}),
+  });
+  std::unique_ptr<data::standalone::Dataset> dataset;
+  TF_CHECK_OK(data::standalone::Dataset::FromGraph({}, graph_def, &dataset));
+
+  for (auto s : state) {
+    std::unique_ptr<data::standalone::Iterator> iterator;
+    TF_CHECK_OK(dataset->MakeIterator(&iterator));
+    std::vector<Tensor> outputs;
+    bool end_of_input = false;
+    while (!end_of_input) {
+      TF_CHECK_OK(iterator->GetNext(&outputs, &end_of_input));
+    }
+  }
+  state.SetItemsProcessed(num_elements *
+                          static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_DatasetGetNext)->UseRealTime()->Arg(1024);
+
+}  // namespace
+}  // namespace tensorflow
@@ -29,18 +29,23 @@ SimplePropagatorState::SimplePropagatorState(
 
 SimplePropagatorState::SimplePropagatorState(
     const ImmutableExecutorState& immutable_state, int64_t step_id,
-    const ImmutableExecutorState::FrameInfo& finfo, bool vlog)
+    const ImmutableExecutorState::FrameInfo& finfo, bool vlog,
+    bool track_pending)
     : immutable_state_(immutable_state),
       step_id_(step_id),
       vlog_(vlog || VLOG_IS_ON(1)),
       input_tensors_(finfo.total_inputs),
-      pending_(
-          new std::atomic<int32>[immutable_state.graph_view().num_nodes()]),
+      pending_(track_pending ? new std::atomic<int32>[immutable_state
+                                                          .graph_view()
+                                                          .num_nodes()]
+                             : nullptr),
       active_(vlog_ ? new std::vector<bool>(
                           immutable_state.graph_view().num_nodes())
                     : nullptr),
       nodes_(finfo.nodes.get()) {
-  immutable_state_.copy_pending_counts(pending_.get());
+  if (track_pending) {
+    immutable_state_.copy_pending_counts(pending_.get());
+  }
 }
 
 SimplePropagatorState::~SimplePropagatorState() {}
@@ -134,4 +139,69 @@ void SimplePropagatorState::DumpState() {
   LOG(WARNING) << "    Total bytes " << total_bytes;
 }
 
+StraightLinePropagatorState::StraightLinePropagatorState(
+    const ImmutableExecutorState& immutable_state, int64_t step_id, bool vlog)
+    : SimplePropagatorState(immutable_state, step_id,
+                            immutable_state.get_root_frame_info(), vlog,
+                            /*track_pending=*/false),
+      plan_(immutable_state.straight_line_plan()) {
+  DCHECK(!plan_.empty());
+}
+
+void StraightLinePropagatorState::ActivateRoots(
+    gtl::ArraySlice<const NodeItem*> roots, TaggedNodeSeq* ready) {
+  DCHECK_EQ(next_, 0);
+  if (roots.empty()) return;
+  DCHECK_EQ(plan_.front(), roots.front());
+  ready->push_back(TaggedNode{plan_[next_++]});
+}
+
+void StraightLinePropagatorState::PropagateOutputs(
+    const TaggedNode& tagged_node, EntryVector* outputs, TaggedNodeSeq* ready) {
+  tsl::profiler::TraceMe activity(
+      [&]() {
+        return strings::StrCat(
+            "ExecutorPropagateOutputs#", "id=", step_id_,
+            ",kernel_name=", tagged_node.node_item->kernel->name_view(),
+            ",num_output_edges=", tagged_node.node_item->num_output_edges,
+            ",num_output_control_edges=",
+            tagged_node.node_item->num_output_control_edges, "#");
+      },
+      tsl::profiler::GetTFTraceMeLevel(/*is_expensive=*/false));
+  DCHECK(ready->empty());
+  DCHECK_EQ(plan_[next_ - 1], tagged_node.node_item);
+
+  // Control edges are implied by the plan order, so only data edges need to
+  // be visited.
+  for (const EdgeInfo& e : tagged_node.node_item->output_edges()) {
+    if (e.is_last) {
+      input_tensors_[e.input_slot] = std::move((*outputs)[e.output_slot]);
+    } else {
+      input_tensors_[e.input_slot] = (*outputs)[e.output_slot];
+    }
+  }
+
+  if (next_ < plan_.size()) {
+    ready->push_back(TaggedNode{plan_[next_++]});
+  }
+}
+
+void StraightLinePropagatorState::DumpState() {
+  mutex_lock l(mu_);
+  LOG(WARNING) << "    Straight-line plan position " << next_ << " of "
+               << plan_.size();
+  // Dump the nodes that have not run yet and are holding on to tensors.
+  for (size_t i = next_; i < plan_.size(); ++i) {
+    DumpPendingNodeState(*plan_[i], input_tensors_.data(), false);
+  }
+  // Then the active nodes.
+  if (active_) {
+    for (const NodeItem* node : *nodes_) {
+      if ((*active_)[node->node_id]) {
+        DumpActiveNodeState(*node, input_tensors_.data());
+      }
+    }
+  }
+}
+
 }  // namespace tensorflow
@@ -155,11 +155,13 @@ class SimplePropagatorState {
     }
   }
 
- private:
+ protected:
+  // If `track_pending` is false, `pending_` is not allocated, and subclasses
+  // are responsible for deciding when nodes become ready.
   SimplePropagatorState(const ImmutableExecutorState& immutable_state_,
                         int64_t step_id,
                         const ImmutableExecutorState::FrameInfo& finfo,
-                        bool vlog);
+                        bool vlog, bool track_pending = true);
 
   const ImmutableExecutorState& immutable_state_;
   const int64_t step_id_;
@@ -185,6 +187,46 @@ class SimplePropagatorState {
   const std::vector<const NodeItem*>* const nodes_;
 };
 
+// A `SimplePropagatorState` that runs the nodes of a graph in the order given
+// by `ImmutableExecutorState::straight_line_plan()`, one at a time.
+//
+// `PropagateOutputs()` moves each output into its pre-resolved input slot and
+// then makes the next node in the plan ready, so no pending counts are copied
+// or decremented in each step.
+//
+// REQUIRES: `!immutable_state.straight_line_plan().empty()`, and the executor
+// must not process more than one node at a time (i.e. all kernels are run
+// inline).
+class StraightLinePropagatorState : public SimplePropagatorState {
+ public:
+  StraightLinePropagatorState(const ImmutableExecutorState& immutable_state,
+                              int64_t step_id, bool vlog);
+
+  // Adds the first node of the plan to `*ready`. The plan always starts with
+  // `roots`, so they are activated one at a time.
+  void ActivateRoots(gtl::ArraySlice<const NodeItem*> roots,
+                     TaggedNodeSeq* ready);
+
+  // Stores `*outputs` in the inputs of their dsts, and adds the next node in
+  // the plan (if any) to `*ready`.
+  void PropagateOutputs(const TaggedNode& tagged_node, EntryVector* outputs,
+                        TaggedNodeSeq* ready);
+
+  Entry* GetInputTensors(const TaggedNode& tagged_node) {
+    return input_tensors_.data() + tagged_node.node_item->input_start;
+  }
+
+  void DumpState();
+
+ private:
+  const std::vector<const NodeItem*>& plan_;
+
+  // The index in `plan_` of the next node to make ready. Only accessed by the
+  // thread running the current node, and the executor establishes a
+  // happens-before relation between consecutive nodes.
+  size_t next_ = 0;
+};
+
 }  // namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_COMMON_RUNTIME_SIMPLE_PROPAGATOR_STATE_H_
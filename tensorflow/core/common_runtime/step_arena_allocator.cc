@@ -0,0 +1,141 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/strcat.h"
+
+namespace tensorflow {
+
+StepArenaAllocator::StepArenaAllocator(Allocator* base, const Options& options)
+    : base_(base), options_(options) {
+  DCHECK(base_ != nullptr);
+  DCHECK_GE(options_.chunk_bytes, options_.max_allocation_bytes);
+}
+
+StepArenaAllocator::~StepArenaAllocator() {
+  for (const Chunk& chunk : chunks_) {
+    base_->DeallocateRaw(chunk.base);
+  }
+}
+
+void* StepArenaAllocator::AllocateRaw(size_t alignment, size_t num_bytes) {
+  alignment = std::max<size_t>(alignment, Allocator::kAllocatorAlignment);
+  // Rounding the size up keeps the arena pointer aligned for the common case
+  // of back-to-back requests with the default alignment.
+  const size_t rounded_bytes =
+      std::max<size_t>(1, (num_bytes + alignment - 1) & ~(alignment - 1));
+  if (rounded_bytes <= options_.max_allocation_bytes) {
+    mutex_lock l(mu_);
+    size_t offset = (offset_ + alignment - 1) & ~(alignment - 1);
+    if (chunks_.empty() || offset + rounded_bytes > chunks_.back().size) {
+      if (stats_.bytes_reserved + options_.chunk_bytes <=
+          options_.max_total_bytes) {
+        void* chunk = base_->AllocateRaw(Allocator::kAllocatorAlignment,
+                                         options_.chunk_bytes);
+        if (chunk != nullptr) {
+          chunks_.push_back({static_cast<char*>(chunk), options_.chunk_bytes});
+          stats_.bytes_reserved += options_.chunk_bytes;
+          stats_.peak_bytes_reserved =
+              std::max(stats_.peak_bytes_reserved, stats_.bytes_reserved);
+          offset = 0;
+        }
+      }
+    }
+    if (!chunks_.empty() && offset + rounded_bytes <= chunks_.back().size) {
+      offset_ = offset + rounded_bytes;
+      ++stats_.num_allocs;
+      stats_.bytes_in_use += rounded_bytes;
+      stats_.peak_bytes_in_use =
+          std::max(stats_.peak_bytes_in_use, stats_.bytes_in_use);
+      stats_.largest_alloc_size =
+          std::max<int64_t>(stats_.largest_alloc_size, rounded_bytes);
+      // Released in DeallocateRaw(), so that the chunks outlive any arena
+      // buffer that escapes the step.
+      Ref();
+      return chunks_.back().base + offset;
+    }
+    ++num_fallback_allocs_;
+  }
+  return base_->AllocateRaw(alignment, num_bytes);
+}
+
+void StepArenaAllocator::DeallocateRaw(void* ptr) {
+  if (ptr == nullptr) return;
+  if (!Owns(ptr)) {
+    base_->DeallocateRaw(ptr);
+    return;
+  }
+  // Arena memory is only reclaimed when the whole arena goes away.
+  Unref();
+}
+
+bool StepArenaAllocator::Owns(const void* ptr) const {
+  tf_shared_lock l(mu_);
+  return OwnsLocked(ptr);
+}
+
+bool StepArenaAllocator::OwnsLocked(const void* ptr) const {
+  const char* p = static_cast<const char*>(ptr);
+  // Steps rarely need more than a handful of chunks, and recent chunks are
+  // the most likely owners, so scan backwards.
+  for (auto it = chunks_.rbegin(); it != chunks_.rend(); ++it) {
+    if (p >= it->base && p < it->base + it->size) return true;
+  }
+  return false;
+}
+
+std::optional<AllocatorStats> StepArenaAllocator::GetStats() {
+  mutex_lock l(mu_);
+  AllocatorStats stats = stats_;
+  stats.bytes_limit = options_.max_total_bytes;
+  return stats;
+}
+
+int64_t StepArenaAllocator::num_fallback_allocs() const {
+  mutex_lock l(mu_);
+  return num_fallback_allocs_;
+}
+
+void StepArenaAllocator::SaveStats(const std::string& device,
+                                   StepStatsCollector* collector) {
+  if (collector == nullptr) return;
+  auto node_stats = std::make_unique<NodeExecStats>();
+  node_stats->set_node_name("_StepArena");
+  node_stats->set_all_start_micros(Env::Default()->NowMicros());
+  AllocatorMemoryUsed* memory = node_stats->add_memory();
+  {
+    mutex_lock l(mu_);
+    memory->set_allocator_name(Name());
+    memory->set_total_bytes(stats_.bytes_in_use);
+    memory->set_peak_bytes(stats_.peak_bytes_reserved);
+    memory->set_live_bytes(stats_.bytes_reserved);
+    memory->set_allocator_bytes_in_use(stats_.bytes_in_use);
+    node_stats->set_timeline_label(
+        strings::StrCat("allocs=", stats_.num_allocs,
+                        " fallback_allocs=", num_fallback_allocs_,
+                        " chunks=", chunks_.size()));
+  }
+  collector->Save(device, node_stats.release());
+}
+
+}  // namespace tensorflow
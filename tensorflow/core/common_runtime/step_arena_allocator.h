@@ -0,0 +1,110 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+class StepStatsCollector;
+
+// A bump allocator for short-lived host tensors whose lifetime is bounded by
+// a single step.
+//
+// Requests no larger than `Options::max_allocation_bytes` are carved out of
+// chunks obtained from `base`, and deallocating them is a no-op apart from
+// bookkeeping. Larger requests, and requests made once the arena holds
+// `Options::max_total_bytes`, are forwarded to `base`.
+//
+// Every live arena allocation holds a reference on the arena, and the step
+// that created the arena holds one more and drops it when the step ends. The
+// chunks are therefore returned to `base` in one shot once the step is over
+// and the last arena-backed tensor is gone, even if a tensor unexpectedly
+// outlives the step.
+class StepArenaAllocator : public Allocator, public core::RefCounted {
+ public:
+  struct Options {
+    // The size of each chunk requested from the base allocator.
+    size_t chunk_bytes = 1 << 20;
+    // Requests larger than this are forwarded to the base allocator.
+    size_t max_allocation_bytes = 64 << 10;
+    // The maximum number of bytes held in chunks.
+    size_t max_total_bytes = 64 << 20;
+  };
+
+  // Does not take ownership of `base`, which must outlive this allocator.
+  StepArenaAllocator(Allocator* base, const Options& options);
+  explicit StepArenaAllocator(Allocator* base)
+      : StepArenaAllocator(base, Options()) {}
+
+  std::string Name() override { return "step_arena"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override;
+  void DeallocateRaw(void* ptr) override;
+  // Individual arena allocations are never reclaimed, so `bytes_in_use` and
+  // `peak_bytes_in_use` are the total number of bytes served from the arena.
+  std::optional<AllocatorStats> GetStats() override;
+  AllocatorMemoryType GetMemoryType() const override {
+    return base_->GetMemoryType();
+  }
+
+  // Returns true iff `ptr` was allocated from one of the arena's chunks.
+  bool Owns(const void* ptr) const TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of requests small enough for the arena that were
+  // forwarded to the base allocator because the arena was full.
+  int64_t num_fallback_allocs() const TF_LOCKS_EXCLUDED(mu_);
+
+  // Saves the arena's memory high-water marks in `collector` as the memory
+  // stats of a "_StepArena" pseudo node on `device`.
+  void SaveStats(const std::string& device, StepStatsCollector* collector);
+
+ private:
+  ~StepArenaAllocator() override;
+
+  struct Chunk {
+    char* base;
+    size_t size;
+  };
+
+  bool OwnsLocked(const void* ptr) const TF_SHARED_LOCKS_REQUIRED(mu_);
+
+  Allocator* const base_;  // Not owned.
+  const Options options_;
+
+  mutable mutex mu_;
+  std::vector<Chunk> chunks_ TF_GUARDED_BY(mu_);
+  // Offset of the next free byte in `chunks_.back()`.
+  size_t offset_ TF_GUARDED_BY(mu_) = 0;
+  AllocatorStats stats_ TF_GUARDED_BY(mu_);
+  // The number of requests that were forwarded to `base_`.
+  int64_t num_fallback_allocs_ TF_GUARDED_BY(mu_) = 0;
+
+  StepArenaAllocator(const StepArenaAllocator&) = delete;
+  void operator=(const StepArenaAllocator&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STEP_ARENA_ALLOCATOR_H_
@@ -0,0 +1,123 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/step_stats_collector.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+StepArenaAllocator::Options SmallOptions() {
+  StepArenaAllocator::Options options;
+  options.chunk_bytes = 1024;
+  options.max_allocation_bytes = 256;
+  options.max_total_bytes = 2048;
+  return options;
+}
+
+TEST(StepArenaAllocatorTest, ServesSmallAllocationsFromChunks) {
+  core::RefCountPtr<StepArenaAllocator> arena(
+      new StepArenaAllocator(cpu_allocator(), SmallOptions()));
+  void* a = arena->AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  void* b = arena->AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  EXPECT_TRUE(arena->Owns(a));
+  EXPECT_TRUE(arena->Owns(b));
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(a) %
+                   Allocator::kAllocatorAlignment);
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(b) %
+                   Allocator::kAllocatorAlignment);
+  // The two buffers must not overlap.
+  memset(a, 1, 100);
+  memset(b, 2, 100);
+  EXPECT_EQ(1, static_cast<char*>(a)[99]);
+  arena->DeallocateRaw(a);
+  arena->DeallocateRaw(b);
+
+  auto stats = arena->GetStats();
+  ASSERT_TRUE(stats.has_value());
+  EXPECT_EQ(2, stats->num_allocs);
+  EXPECT_EQ(1024, stats->bytes_reserved);
+  EXPECT_GE(stats->peak_bytes_in_use, 200);
+}
+
+TEST(StepArenaAllocatorTest, FallsBackForLargeAllocations) {
+  core::RefCountPtr<StepArenaAllocator> arena(
+      new StepArenaAllocator(cpu_allocator(), SmallOptions()));
+  void* large = arena->AllocateRaw(Allocator::kAllocatorAlignment, 512);
+  EXPECT_FALSE(arena->Owns(large));
+  arena->DeallocateRaw(large);
+  EXPECT_EQ(0, arena->GetStats()->bytes_reserved);
+}
+
+TEST(StepArenaAllocatorTest, FallsBackWhenFull) {
+  core::RefCountPtr<StepArenaAllocator> arena(
+      new StepArenaAllocator(cpu_allocator(), SmallOptions()));
+  std::vector<void*> ptrs;
+  // 2048 bytes of arena hold eight 256-byte allocations.
+  for (int i = 0; i < 10; ++i) {
+    ptrs.push_back(arena->AllocateRaw(Allocator::kAllocatorAlignment, 256));
+  }
+  int num_owned = 0;
+  for (void* p : ptrs) {
+    if (arena->Owns(p)) ++num_owned;
+  }
+  EXPECT_EQ(8, num_owned);
+  EXPECT_EQ(2, arena->num_fallback_allocs());
+  EXPECT_EQ(2048, arena->GetStats()->peak_bytes_reserved);
+  for (void* p : ptrs) arena->DeallocateRaw(p);
+}
+
+TEST(StepArenaAllocatorTest, TensorMayOutliveStep) {
+  StepArenaAllocator* arena =
+      new StepArenaAllocator(cpu_allocator(), SmallOptions());
+  Tensor t(arena, DT_FLOAT, TensorShape({4}));
+  EXPECT_TRUE(arena->Owns(t.tensor_data().data()));
+  // Dropping the step's reference must keep the chunk alive until `t` goes
+  // away.
+  EXPECT_FALSE(arena->Unref());
+  t.flat<float>().setConstant(1.0f);
+  EXPECT_EQ(1.0f, t.flat<float>()(3));
+}
+
+TEST(StepArenaAllocatorTest, SavesStats) {
+  core::RefCountPtr<StepArenaAllocator> arena(
+      new StepArenaAllocator(cpu_allocator(), SmallOptions()));
+  arena->DeallocateRaw(arena->AllocateRaw(Allocator::kAllocatorAlignment, 64));
+  StepStats step_stats;
+  StepStatsCollector collector(&step_stats);
+  arena->SaveStats("/device:CPU:0", &collector);
+  collector.Finalize();
+  ASSERT_EQ(1, step_stats.dev_stats_size());
+  ASSERT_EQ(1, step_stats.dev_stats(0).node_stats_size());
+  const NodeExecStats& node_stats = step_stats.dev_stats(0).node_stats(0);
+  EXPECT_EQ("_StepArena", node_stats.node_name());
+  ASSERT_EQ(1, node_stats.memory_size());
+  EXPECT_EQ("step_arena", node_stats.memory(0).allocator_name());
+  EXPECT_EQ(1024, node_stats.memory(0).peak_bytes());
+  EXPECT_EQ(64, node_stats.memory(0).total_bytes());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -14,6 +14,7 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "tensorflow/core/common_runtime/costmodel_manager.h"
@@ -25,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/graph/costmodel.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
+#include "tensorflow/core/lib/monitoring/gauge.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/scanner.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
@@ -49,8 +51,67 @@ bool IsSend(const NodeDef* node) {
   return node->op() == "_Send" || node->op() == "_HostSend";
 }
 
+// Maximum number of nodes listed in the string valued critical path metrics.
+const int kMaxReportedCriticalPathNodes = 8;
+
+auto* step_usecs_gauge = monitoring::Gauge<int64_t, 0>::New(
+    "/tensorflow/core/step_stats/critical_path/step_usecs",
+    "Wall time of the most recently analyzed step.");
+
+auto* critical_path_compute_usecs_gauge = monitoring::Gauge<int64_t, 0>::New(
+    "/tensorflow/core/step_stats/critical_path/compute_usecs",
+    "Execution time of the nodes on the critical path of the most recently "
+    "analyzed step.");
+
+auto* device_idle_usecs_gauge = monitoring::Gauge<int64_t, 1>::New(
+    "/tensorflow/core/step_stats/critical_path/device_idle_usecs",
+    "Time during the most recently analyzed step in which no node was "
+    "running on the device.",
+    "device");
+
+auto* critical_path_nodes_gauge = monitoring::Gauge<string, 0>::New(
+    "/tensorflow/core/step_stats/critical_path/nodes",
+    "The longest running nodes on the critical path of the most recently "
+    "analyzed step, as comma separated name=usecs pairs.");
+
+auto* largest_slack_nodes_gauge = monitoring::Gauge<string, 0>::New(
+    "/tensorflow/core/step_stats/critical_path/largest_slack_nodes",
+    "The nodes with the largest slack in the most recently analyzed step, as "
+    "comma separated name=usecs pairs.");
+
+string FormatReportedNodes(std::vector<std::pair<string, int64_t>> nodes) {
+  std::stable_sort(nodes.begin(), nodes.end(),
+                   [](const std::pair<string, int64_t>& a,
+                      const std::pair<string, int64_t>& b) {
+                     return a.second > b.second;
+                   });
+  if (nodes.size() > kMaxReportedCriticalPathNodes) {
+    nodes.resize(kMaxReportedCriticalPathNodes);
+  }
+  string out;
+  for (const auto& node : nodes) {
+    strings::StrAppend(&out, out.empty() ? "" : ",", node.first, "=",
+                       node.second);
+  }
+  return out;
+}
+
 }  // namespace
 
+void RecordStepCriticalPath(const StepCriticalPath& critical_path) {
+  step_usecs_gauge->GetCell()->Set(critical_path.step_micros);
+  critical_path_compute_usecs_gauge->GetCell()->Set(
+      critical_path.critical_path_compute_micros);
+  for (const auto& device_idle : critical_path.device_idle_micros) {
+    device_idle_usecs_gauge->GetCell(device_idle.first)
+        ->Set(device_idle.second);
+  }
+  critical_path_nodes_gauge->GetCell()->Set(
+      FormatReportedNodes(critical_path.critical_path));
+  largest_slack_nodes_gauge->GetCell()->Set(
+      FormatReportedNodes(critical_path.largest_slack));
+}
+
 NodeExecStatsWrapper::NodeExecStatsWrapper(
     const NodeDef* node, StepStatsCollector* step_stats_collector)
     : NodeExecStatsWrapper(std::make_unique<NodeExecStats>(), node,
@@ -382,6 +443,167 @@ void StepStatsCollector::BuildCostModel(
   }
 }
 
+void StepStatsCollector::AnalyzeCriticalPath(
+    const std::unordered_map<string, const Graph*>& device_map,
+    int max_slack_nodes, StepCriticalPath* critical_path) {
+  *critical_path = StepCriticalPath();
+  mutex_lock lock(mu_);
+
+  if (!finalized_) {
+    FinalizeInternal();
+  }
+  if (!step_stats_) {
+    return;
+  }
+
+  struct ExecutedNode {
+    const Node* node;
+    const string* device;
+    int64_t start_micros;
+    int64_t end_micros;
+    std::vector<int> inputs;
+    int64_t first_consumer_start_micros;
+  };
+  std::vector<ExecutedNode> executed;
+  std::unordered_map<const Node*, int> node_index;
+
+  for (const DeviceStepStats& device_stats : step_stats_->dev_stats()) {
+    auto graph_it = device_map.find(device_stats.device());
+    if (graph_it == device_map.end()) {
+      continue;
+    }
+    std::unordered_map<StringPiece, const Node*, StringPieceHasher>
+        name_to_node;
+    for (const Node* n : graph_it->second->nodes()) {
+      name_to_node.emplace(n->name(), n);
+    }
+    for (const NodeExecStats& stats : device_stats.node_stats()) {
+      auto node_it = name_to_node.find(stats.node_name());
+      if (node_it == name_to_node.end()) {
+        continue;
+      }
+      const int64_t start = stats.all_start_micros();
+      const int64_t end = start + stats.all_end_rel_micros();
+      auto inserted = node_index.emplace(node_it->second, executed.size());
+      if (inserted.second) {
+        executed.push_back({node_it->second, &device_stats.device(), start,
+                            end, {}, kint64max});
+      } else {
+        // Nodes inside loops run once per iteration; cover all of them.
+        ExecutedNode& e = executed[inserted.first->second];
+        e.start_micros = std::min(e.start_micros, start);
+        e.end_micros = std::max(e.end_micros, end);
+      }
+    }
+  }
+  if (executed.empty()) {
+    return;
+  }
+
+  // Recv nodes depend on the Send with the same rendezvous key, which
+  // usually lives in the graph of another device.
+  std::unordered_map<string, int> send_index;
+  for (int i = 0; i < executed.size(); ++i) {
+    string tensor_name;
+    if (executed[i].node->IsSend() &&
+        TryGetNodeAttr(executed[i].node->attrs(), "tensor_name",
+                       &tensor_name)) {
+      send_index.emplace(tensor_name, i);
+    }
+  }
+
+  int64_t step_start = kint64max;
+  int64_t step_end = 0;
+  int last = 0;
+  for (int i = 0; i < executed.size(); ++i) {
+    ExecutedNode& e = executed[i];
+    for (const Edge* edge : e.node->in_edges()) {
+      auto it = node_index.find(edge->src());
+      if (it != node_index.end()) {
+        e.inputs.push_back(it->second);
+      }
+    }
+    string tensor_name;
+    if (e.node->IsRecv() &&
+        TryGetNodeAttr(e.node->attrs(), "tensor_name", &tensor_name)) {
+      auto it = send_index.find(tensor_name);
+      if (it != send_index.end()) {
+        e.inputs.push_back(it->second);
+      }
+    }
+    for (int input : e.inputs) {
+      executed[input].first_consumer_start_micros = std::min(
+          executed[input].first_consumer_start_micros, e.start_micros);
+    }
+    step_start = std::min(step_start, e.start_micros);
+    if (e.end_micros > step_end) {
+      step_end = e.end_micros;
+      last = i;
+    }
+  }
+  critical_path->step_micros = step_end - step_start;
+
+  // Walk back from the last node to finish, always following the input that
+  // became available last. The visited set guards against loop back edges.
+  std::vector<bool> visited(executed.size(), false);
+  for (int current = last; current >= 0;) {
+    visited[current] = true;
+    const ExecutedNode& e = executed[current];
+    const int64_t duration = e.end_micros - e.start_micros;
+    critical_path->critical_path.emplace_back(e.node->name(), duration);
+    critical_path->critical_path_compute_micros += duration;
+    int next = -1;
+    for (int input : e.inputs) {
+      if (visited[input]) {
+        continue;
+      }
+      if (next < 0 || executed[input].end_micros > executed[next].end_micros) {
+        next = input;
+      }
+    }
+    current = next;
+  }
+  std::reverse(critical_path->critical_path.begin(),
+               critical_path->critical_path.end());
+
+  std::unordered_map<const string*, std::vector<std::pair<int64_t, int64_t>>>
+      busy_intervals;
+  for (const ExecutedNode& e : executed) {
+    busy_intervals[e.device].emplace_back(e.start_micros, e.end_micros);
+    const int64_t consumed_micros = e.first_consumer_start_micros == kint64max
+                                        ? step_end
+                                        : e.first_consumer_start_micros;
+    critical_path->largest_slack.emplace_back(
+        e.node->name(), std::max<int64_t>(consumed_micros - e.end_micros, 0));
+  }
+  for (auto& device_intervals : busy_intervals) {
+    auto& intervals = device_intervals.second;
+    std::sort(intervals.begin(), intervals.end());
+    int64_t busy = 0;
+    int64_t covered_until = step_start;
+    for (const auto& interval : intervals) {
+      const int64_t begin = std::max(interval.first, covered_until);
+      if (interval.second > begin) {
+        busy += interval.second - begin;
+        covered_until = interval.second;
+      }
+    }
+    critical_path->device_idle_micros[*device_intervals.first] =
+        critical_path->step_micros - busy;
+  }
+
+  auto& slack = critical_path->largest_slack;
+  const int num_slack_nodes =
+      std::min<int>(std::max(max_slack_nodes, 0), slack.size());
+  std::partial_sort(slack.begin(), slack.begin() + num_slack_nodes,
+                    slack.end(),
+                    [](const std::pair<string, int64_t>& a,
+                       const std::pair<string, int64_t>& b) {
+                      return a.second > b.second;
+                    });
+  slack.resize(num_slack_nodes);
+}
+
 void StepStatsCollector::Save(const string& device,
                               NodeExecStats* node_stats_pb) {
   Save(device,
@@ -15,8 +15,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STEP_STATS_COLLECTOR_H_
 #define TENSORFLOW_CORE_COMMON_RUNTIME_STEP_STATS_COLLECTOR_H_
 
+#include <map>
 #include <memory>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/core/framework/allocator.h"
@@ -151,6 +153,28 @@ class StepStatsCollectorInterface {
   virtual string ReportAllocsOnResourceExhausted(absl::string_view err) = 0;
 };
 
+// Summary of what bounded a single step, as reconstructed from the collected
+// node timings and the executed graphs.
+struct StepCriticalPath {
+  // Wall time between the first node starting and the last node finishing.
+  int64_t step_micros = 0;
+  // Sum of the execution times of the nodes on the critical path. The rest of
+  // the critical path length is spent waiting (scheduling, queueing, etc.).
+  int64_t critical_path_compute_micros = 0;
+  // Names of the nodes on the critical path in execution order, each paired
+  // with its execution time.
+  std::vector<std::pair<string, int64_t>> critical_path;
+  // Time within the step during which no node was running on each device.
+  std::map<string, int64_t> device_idle_micros;
+  // Nodes that finished longest before any of their consumers started, in
+  // decreasing order of slack.
+  std::vector<std::pair<string, int64_t>> largest_slack;
+};
+
+// Exports `critical_path` through the
+// /tensorflow/core/step_stats/critical_path/* monitoring metrics.
+void RecordStepCriticalPath(const StepCriticalPath& critical_path);
+
 // StepStatsCollector manages the collection of a StepStats object.
 // The StepStats object holds multiple DeviceStats.
 // Each DeviceStats object holds multiple NodeExecStats.
@@ -166,6 +190,14 @@ class StepStatsCollector : public StepStatsCollectorInterface {
       CostModelManager* cost_model_manager,
       const std::unordered_map<string, const Graph*>& device_map);
 
+  // Reconstructs the dependency DAG of the nodes executed on the devices in
+  // device_map, including Send/Recv pairs across devices, and fills
+  // `critical_path` with the chain of nodes that determined when the step
+  // ended. At most `max_slack_nodes` nodes are reported in `largest_slack`.
+  void AnalyzeCriticalPath(
+      const std::unordered_map<string, const Graph*>& device_map,
+      int max_slack_nodes, StepCriticalPath* critical_path);
+
   // Saves node statistics to the DeviceStats object associated with device.
   // Should be called before Finalize.
   void Save(const string& device, NodeExecStats* node_stats_pb);
@@ -0,0 +1,89 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/step_stats_collector.h"
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+Node* AddNoOp(const string& name, Graph* graph) {
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(name, "NoOp").Finalize(graph, &node));
+  return node;
+}
+
+void SaveNodeStats(const string& device, const string& name,
+                   int64_t start_micros, int64_t end_micros,
+                   StepStatsCollector* collector) {
+  auto* stats = new NodeExecStats;
+  stats->set_node_name(name);
+  stats->set_all_start_micros(start_micros);
+  stats->set_all_end_rel_micros(end_micros - start_micros);
+  collector->Save(device, stats);
+}
+
+TEST(StepStatsCollectorTest, AnalyzeCriticalPath) {
+  const string device = "/job:localhost/replica:0/task:0/device:CPU:0";
+  Graph graph(OpRegistry::Global());
+  Node* a = AddNoOp("a", &graph);
+  Node* b = AddNoOp("b", &graph);
+  Node* c = AddNoOp("c", &graph);
+  graph.AddControlEdge(a, c);
+  graph.AddControlEdge(b, c);
+
+  StepStats step_stats;
+  StepStatsCollector collector(&step_stats);
+  SaveNodeStats(device, "a", 100, 110, &collector);
+  SaveNodeStats(device, "b", 100, 150, &collector);
+  SaveNodeStats(device, "c", 160, 170, &collector);
+
+  StepCriticalPath critical_path;
+  collector.AnalyzeCriticalPath({{device, &graph}}, /*max_slack_nodes=*/2,
+                                &critical_path);
+
+  EXPECT_EQ(critical_path.step_micros, 70);
+  // `c` waited for `b`, which finished last among its inputs.
+  ASSERT_EQ(critical_path.critical_path.size(), 2);
+  EXPECT_EQ(critical_path.critical_path[0],
+            std::make_pair(string("b"), int64_t{50}));
+  EXPECT_EQ(critical_path.critical_path[1],
+            std::make_pair(string("c"), int64_t{10}));
+  EXPECT_EQ(critical_path.critical_path_compute_micros, 60);
+  // Nothing ran between 150 and 160.
+  EXPECT_EQ(critical_path.device_idle_micros.at(device), 10);
+  ASSERT_EQ(critical_path.largest_slack.size(), 2);
+  EXPECT_EQ(critical_path.largest_slack[0],
+            std::make_pair(string("a"), int64_t{50}));
+  EXPECT_EQ(critical_path.largest_slack[1],
+            std::make_pair(string("b"), int64_t{10}));
+
+  // The step stats proto is still populated for the caller.
+  ASSERT_EQ(step_stats.dev_stats_size(), 1);
+  EXPECT_EQ(step_stats.dev_stats(0).node_stats_size(), 3);
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,189 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/common_runtime/thread_caching_allocator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+#include "tensorflow/core/lib/core/bits.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/macros.h"
+
+namespace tensorflow {
+
+namespace {
+
+std::atomic<int64_t> next_allocator_id{0};
+
+// A direct-mapped lookaside from allocator ids to the calling thread's cache,
+// which avoids taking the allocator's lock on every call. It is trivially
+// destructible, so that it remains usable while other thread-local objects
+// free their buffers during thread exit.
+struct CacheSlot {
+  int64_t allocator_id;
+  void* cache;
+};
+constexpr int kNumCacheSlots = 4;
+thread_local CacheSlot cache_slots[kNumCacheSlots] = {
+    {-1, nullptr}, {-1, nullptr}, {-1, nullptr}, {-1, nullptr}};
+
+}  // namespace
+
+ThreadCachingAllocator::ThreadCachingAllocator(std::unique_ptr<Allocator> base,
+                                               const Options& options)
+    : base_(std::move(base)),
+      max_cached_allocation_bytes_(
+          std::min(options.max_cached_allocation_bytes,
+                   SizeClassBytes(kNumSizeClasses - 1))),
+      max_thread_cache_bytes_(options.max_thread_cache_bytes),
+      scavenge_interval_(options.scavenge_interval),
+      id_(next_allocator_id.fetch_add(1, std::memory_order_relaxed)) {
+  DCHECK_GT(scavenge_interval_, 0);
+}
+
+ThreadCachingAllocator::~ThreadCachingAllocator() { Flush(); }
+
+int ThreadCachingAllocator::SizeClass(size_t num_bytes) {
+  if (num_bytes <= SizeClassBytes(0)) return 0;
+  return Log2Ceiling64(num_bytes) - kMinSizeClassBits;
+}
+
+ThreadCachingAllocator::ThreadCache* ThreadCachingAllocator::GetThreadCache() {
+  CacheSlot& slot = cache_slots[id_ % kNumCacheSlots];
+  if (TF_PREDICT_TRUE(slot.allocator_id == id_)) {
+    return static_cast<ThreadCache*>(slot.cache);
+  }
+  ThreadCache* cache;
+  {
+    mutex_lock l(mu_);
+    std::unique_ptr<ThreadCache>& entry =
+        thread_caches_[Env::Default()->GetCurrentThreadId()];
+    if (entry == nullptr) entry = std::make_unique<ThreadCache>();
+    cache = entry.get();
+  }
+  slot = {id_, cache};
+  return cache;
+}
+
+void* ThreadCachingAllocator::AllocateRaw(
+    size_t alignment, size_t num_bytes,
+    const AllocationAttributes& allocation_attr) {
+  if (!IsCacheable(alignment, num_bytes)) {
+    return base_->AllocateRaw(alignment, num_bytes, allocation_attr);
+  }
+  const int size_class = SizeClass(num_bytes);
+  ThreadCache* cache = GetThreadCache();
+  {
+    mutex_lock l(cache->mu);
+    std::vector<void*>& bucket = cache->buckets[size_class];
+    if (!bucket.empty()) {
+      void* ptr = bucket.back();
+      bucket.pop_back();
+      cache->cached_bytes -= SizeClassBytes(size_class);
+      cache->low_water[size_class] =
+          std::min(cache->low_water[size_class], bucket.size());
+      if (++cache->ops_since_scavenge >= scavenge_interval_) Scavenge(cache);
+      return ptr;
+    }
+  }
+  // Allocate the whole size class, so that the buffer can serve any request
+  // of the class once it is cached.
+  void* ptr = base_->AllocateRaw(alignment, SizeClassBytes(size_class),
+                                 allocation_attr);
+  if (ptr == nullptr) {
+    // The memory may be held in the caches.
+    Flush();
+    ptr = base_->AllocateRaw(alignment, SizeClassBytes(size_class),
+                             allocation_attr);
+  }
+  return ptr;
+}
+
+void ThreadCachingAllocator::DeallocateRaw(void* ptr) {
+  base_->DeallocateRaw(ptr);
+}
+
+void ThreadCachingAllocator::DeallocateRaw(void* ptr, size_t alignment,
+                                           size_t num_bytes) {
+  if (ptr == nullptr || !IsCacheable(alignment, num_bytes)) {
+    base_->DeallocateRaw(ptr);
+    return;
+  }
+  const int size_class = SizeClass(num_bytes);
+  ThreadCache* cache = GetThreadCache();
+  mutex_lock l(cache->mu);
+  std::vector<void*>& bucket = cache->buckets[size_class];
+  bucket.push_back(ptr);
+  cache->cached_bytes += SizeClassBytes(size_class);
+  if (cache->cached_bytes > max_thread_cache_bytes_) {
+    // Keep the more recently freed half of the bucket, which is more likely
+    // to still be in the CPU caches.
+    Release(cache, size_class, (bucket.size() + 1) / 2);
+  }
+  if (++cache->ops_since_scavenge >= scavenge_interval_) Scavenge(cache);
+}
+
+void ThreadCachingAllocator::Release(ThreadCache* cache, int size_class,
+                                     size_t count) {
+  std::vector<void*>& bucket = cache->buckets[size_class];
+  DCHECK_LE(count, bucket.size());
+  // The least recently freed buffers are at the front of the bucket.
+  for (size_t i = 0; i < count; ++i) {
+    base_->DeallocateRaw(bucket[i]);
+  }
+  bucket.erase(bucket.begin(), bucket.begin() + count);
+  cache->cached_bytes -= count * SizeClassBytes(size_class);
+  cache->low_water[size_class] =
+      std::min(cache->low_water[size_class], bucket.size());
+}
+
+void ThreadCachingAllocator::Scavenge(ThreadCache* cache) {
+  for (int size_class = 0; size_class < kNumSizeClasses; ++size_class) {
+    // The buffers below the low water mark were not needed during the last
+    // interval.
+    if (cache->low_water[size_class] > 0) {
+      Release(cache, size_class, cache->low_water[size_class]);
+    }
+    cache->low_water[size_class] = cache->buckets[size_class].size();
+  }
+  cache->ops_since_scavenge = 0;
+}
+
+void ThreadCachingAllocator::Flush() {
+  mutex_lock l(mu_);
+  for (auto& entry : thread_caches_) {
+    ThreadCache* cache = entry.second.get();
+    mutex_lock cache_lock(cache->mu);
+    for (int size_class = 0; size_class < kNumSizeClasses; ++size_class) {
+      Release(cache, size_class, cache->buckets[size_class].size());
+    }
+  }
+}
+
+int64_t ThreadCachingAllocator::CachedBytes() {
+  int64_t cached_bytes = 0;
+  mutex_lock l(mu_);
+  for (auto& entry : thread_caches_) {
+    mutex_lock cache_lock(entry.second->mu);
+    cached_bytes += entry.second->cached_bytes;
+  }
+  return cached_bytes;
+}
+
+}  // namespace tensorflow
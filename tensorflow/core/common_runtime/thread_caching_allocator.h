@@ -0,0 +1,158 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_THREAD_CACHING_ALLOCATOR_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_THREAD_CACHING_ALLOCATOR_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// A front-end for an allocator with a single lock, such as a CPU
+// BFCAllocator, that keeps recently freed small buffers in per-thread caches.
+//
+// Cached buffers are bucketed by the power-of-two size classes of the BFC
+// bins, and a small allocation is served from the calling thread's bucket for
+// its size class when possible, without taking the lock of the underlying
+// allocator. Buffers that stay unused for a while, and buffers in excess of
+// the per-thread limit, are returned to the underlying allocator.
+//
+// Only buffers freed through the sized DeallocateRaw() overload are cached,
+// because the size class of a buffer is derived from its requested size.
+class ThreadCachingAllocator : public Allocator {
+ public:
+  struct Options {
+    // Allocations of at most this many bytes are cached.
+    size_t max_cached_allocation_bytes = 64 << 10;
+
+    // The maximum number of bytes cached by one thread.
+    size_t max_thread_cache_bytes = 4 << 20;
+
+    // After this many allocations and deallocations by a thread, the buffers
+    // of its cache that were not needed since the last such point are
+    // returned to the underlying allocator.
+    int64_t scavenge_interval = 4096;
+  };
+
+  ThreadCachingAllocator(std::unique_ptr<Allocator> base,
+                         const Options& options);
+  ~ThreadCachingAllocator() override;
+
+  std::string Name() override { return base_->Name(); }
+
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    return AllocateRaw(alignment, num_bytes, AllocationAttributes());
+  }
+  void* AllocateRaw(size_t alignment, size_t num_bytes,
+                    const AllocationAttributes& allocation_attr) override;
+  void DeallocateRaw(void* ptr) override;
+  void DeallocateRaw(void* ptr, size_t alignment, size_t num_bytes) override;
+
+  bool TracksAllocationSizes() const override {
+    return base_->TracksAllocationSizes();
+  }
+  size_t RequestedSize(const void* ptr) const override {
+    return base_->RequestedSize(ptr);
+  }
+  size_t AllocatedSize(const void* ptr) const override {
+    return base_->AllocatedSize(ptr);
+  }
+  int64_t AllocationId(const void* ptr) const override {
+    return base_->AllocationId(ptr);
+  }
+  // Cached buffers are counted as in use by the underlying allocator.
+  std::optional<AllocatorStats> GetStats() override {
+    return base_->GetStats();
+  }
+  bool ClearStats() override { return base_->ClearStats(); }
+  AllocatorMemoryType GetMemoryType() const override {
+    return base_->GetMemoryType();
+  }
+
+  // Returns all cached buffers to the underlying allocator.
+  void Flush() TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of bytes currently held in the caches of all threads.
+  int64_t CachedBytes() TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  // The size classes are 256, 512, ..., 256 << (kNumSizeClasses - 1) bytes,
+  // matching the smallest bins of the BFCAllocator.
+  static constexpr int kMinSizeClassBits = 8;
+  static constexpr int kNumSizeClasses = 21;
+
+  struct ThreadCache {
+    // Only contended when another thread flushes all caches.
+    mutex mu;
+    std::array<std::vector<void*>, kNumSizeClasses> buckets TF_GUARDED_BY(mu);
+    // The smallest size of each bucket since the last scavenge.
+    std::array<size_t, kNumSizeClasses> low_water TF_GUARDED_BY(mu) = {};
+    size_t cached_bytes TF_GUARDED_BY(mu) = 0;
+    int64_t ops_since_scavenge TF_GUARDED_BY(mu) = 0;
+  };
+
+  static int SizeClass(size_t num_bytes);
+  static size_t SizeClassBytes(int size_class) {
+    return size_t{1} << (size_class + kMinSizeClassBits);
+  }
+  bool IsCacheable(size_t alignment, size_t num_bytes) const {
+    return num_bytes > 0 && num_bytes <= max_cached_allocation_bytes_ &&
+           alignment <= Allocator::kAllocatorAlignment;
+  }
+
+  // Returns the cache of the calling thread, creating it if needed.
+  ThreadCache* GetThreadCache() TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the last `count` buffers of `cache->buckets[size_class]` to the
+  // underlying allocator.
+  void Release(ThreadCache* cache, int size_class, size_t count)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(cache->mu);
+  // Returns the buffers of `cache` that were not used since the last call.
+  void Scavenge(ThreadCache* cache) TF_EXCLUSIVE_LOCKS_REQUIRED(cache->mu);
+
+  const std::unique_ptr<Allocator> base_;
+  const size_t max_cached_allocation_bytes_;
+  const size_t max_thread_cache_bytes_;
+  const int64_t scavenge_interval_;
+  // Unique among all ThreadCachingAllocators of the process, so that the
+  // per-thread lookaside of a destroyed allocator is never reused.
+  const int64_t id_;
+
+  mutex mu_;
+  // Keyed by Env::GetCurrentThreadId(). Caches outlive their threads, and are
+  // reused by new threads with the same identifier.
+  absl::flat_hash_map<int64_t, std::unique_ptr<ThreadCache>> thread_caches_
+      TF_GUARDED_BY(mu_);
+
+  ThreadCachingAllocator(const ThreadCachingAllocator&) = delete;
+  void operator=(const ThreadCachingAllocator&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_THREAD_CACHING_ALLOCATOR_H_
@@ -0,0 +1,188 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/common_runtime/thread_caching_allocator.h"
+
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/bfc_allocator.h"
+#include "tensorflow/core/common_runtime/pool_allocator.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/numa.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
+
+namespace tensorflow {
+namespace {
+
+std::unique_ptr<Allocator> NewCPUBFCAllocator() {
+  BFCAllocator::Options options;
+  options.allow_growth = true;
+  return std::make_unique<BFCAllocator>(
+      std::make_unique<BasicCPUAllocator>(port::kNUMANoAffinity,
+                                          std::vector<SubAllocator::Visitor>(),
+                                          std::vector<SubAllocator::Visitor>()),
+      /*total_memory=*/1LL << 30, "cpu_bfc", options);
+}
+
+int64_t BytesInUse(Allocator* allocator) {
+  return allocator->GetStats()->bytes_in_use;
+}
+
+TEST(ThreadCachingAllocatorTest, ReusesFreedBuffersOfSameSizeClass) {
+  ThreadCachingAllocator a(NewCPUBFCAllocator(), {});
+  void* p = a.AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  a.DeallocateRaw(p, Allocator::kAllocatorAlignment, 100);
+  EXPECT_EQ(256, a.CachedBytes());
+  void* q = a.AllocateRaw(Allocator::kAllocatorAlignment, 200);
+  EXPECT_EQ(p, q);
+  EXPECT_EQ(0, a.CachedBytes());
+  a.DeallocateRaw(q, Allocator::kAllocatorAlignment, 200);
+}
+
+TEST(ThreadCachingAllocatorTest, BypassesCacheForUnsizedAndLargeBuffers) {
+  ThreadCachingAllocator::Options options;
+  options.max_cached_allocation_bytes = 1024;
+  ThreadCachingAllocator a(NewCPUBFCAllocator(), options);
+  void* p = a.AllocateRaw(Allocator::kAllocatorAlignment, 100);
+  a.DeallocateRaw(p);
+  void* q = a.AllocateRaw(Allocator::kAllocatorAlignment, 4096);
+  a.DeallocateRaw(q, Allocator::kAllocatorAlignment, 4096);
+  EXPECT_EQ(0, a.CachedBytes());
+  EXPECT_EQ(0, BytesInUse(&a));
+}
+
+TEST(ThreadCachingAllocatorTest, LimitsBytesPerThread) {
+  ThreadCachingAllocator::Options options;
+  options.max_thread_cache_bytes = 1024;
+  ThreadCachingAllocator a(NewCPUBFCAllocator(), options);
+  std::vector<void*> buffers;
+  for (int i = 0; i < 16; ++i) {
+    buffers.push_back(a.AllocateRaw(Allocator::kAllocatorAlignment, 256));
+  }
+  for (void* p : buffers) {
+    a.DeallocateRaw(p, Allocator::kAllocatorAlignment, 256);
+    EXPECT_LE(a.CachedBytes(), 1024);
+  }
+  EXPECT_EQ(a.CachedBytes(), BytesInUse(&a));
+}
+
+TEST(ThreadCachingAllocatorTest, ScavengesUnusedBuffers) {
+  ThreadCachingAllocator::Options options;
+  options.scavenge_interval = 2;
+  ThreadCachingAllocator a(NewCPUBFCAllocator(), options);
+  void* p0 = a.AllocateRaw(Allocator::kAllocatorAlignment, 256);
+  void* p1 = a.AllocateRaw(Allocator::kAllocatorAlignment, 256);
+  a.DeallocateRaw(p0, Allocator::kAllocatorAlignment, 256);
+  a.DeallocateRaw(p1, Allocator::kAllocatorAlignment, 256);
+  EXPECT_EQ(512, a.CachedBytes());
+
+  // Only 1KB buffers are used during the next interval, so the 256B buffers
+  // are returned to the BFC allocator at its end.
+  void* q = a.AllocateRaw(Allocator::kAllocatorAlignment, 1024);
+  a.DeallocateRaw(q, Allocator::kAllocatorAlignment, 1024);
+  q = a.AllocateRaw(Allocator::kAllocatorAlignment, 1024);
+  EXPECT_EQ(0, a.CachedBytes());
+  EXPECT_EQ(1024, BytesInUse(&a));
+  a.DeallocateRaw(q, Allocator::kAllocatorAlignment, 1024);
+}
+
+TEST(ThreadCachingAllocatorTest, ConcurrentChurn) {
+  ThreadCachingAllocator a(NewCPUBFCAllocator(), {});
+  {
+    thread::ThreadPool pool(Env::Default(), "test", 8);
+    for (int t = 0; t < 8; ++t) {
+      pool.Schedule([&a, t]() {
+        std::vector<std::pair<void*, size_t>> live;
+        for (int i = 0; i < 10000; ++i) {
+          const size_t bytes = 16 + ((i * 7919 + t) % 8192);
+          void* p = a.AllocateRaw(Allocator::kAllocatorAlignment, bytes);
+          ASSERT_NE(p, nullptr);
+          std::memset(p, t, bytes);
+          live.emplace_back(p, bytes);
+          if (live.size() > 32) {
+            a.DeallocateRaw(live.front().first, Allocator::kAllocatorAlignment,
+                            live.front().second);
+            live.erase(live.begin());
+          }
+        }
+        for (const auto& buffer : live) {
+          a.DeallocateRaw(buffer.first, Allocator::kAllocatorAlignment,
+                          buffer.second);
+        }
+      });
+    }
+  }
+  EXPECT_EQ(a.CachedBytes(), BytesInUse(&a));
+  a.Flush();
+  EXPECT_EQ(0, a.CachedBytes());
+  EXPECT_EQ(0, BytesInUse(&a));
+}
+
+// Allocates and frees small buffers on `num_threads` threads concurrently,
+// through a CPU BFC allocator, with a thread cache if `use_cache`.
+void AllocationChurn(::testing::benchmark::State& state, int num_threads,
+                     bool use_cache) {
+  constexpr int kItersPerThread = 1000;
+  std::unique_ptr<Allocator> allocator = NewCPUBFCAllocator();
+  if (use_cache) {
+    allocator = std::make_unique<ThreadCachingAllocator>(
+        std::move(allocator), ThreadCachingAllocator::Options());
+  }
+  thread::ThreadPool pool(Env::Default(), "bench", num_threads);
+  for (auto s : state) {
+    BlockingCounter counter(num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+      pool.Schedule([&allocator, &counter]() {
+        static const size_t kSizes[] = {64, 256, 1000, 4096, 16384};
+        void* live[4] = {};
+        for (int i = 0; i < kItersPerThread; ++i) {
+          const size_t bytes = kSizes[i % 5];
+          void*& slot = live[i % 4];
+          if (slot != nullptr) {
+            allocator->DeallocateRaw(slot, Allocator::kAllocatorAlignment,
+                                     kSizes[(i - 4) % 5]);
+          }
+          slot = allocator->AllocateRaw(Allocator::kAllocatorAlignment, bytes);
+        }
+        for (int i = kItersPerThread - 4; i < kItersPerThread; ++i) {
+          allocator->DeallocateRaw(live[i % 4], Allocator::kAllocatorAlignment,
+                                   kSizes[i % 5]);
+        }
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+  }
+  state.SetItemsProcessed(state.iterations() * num_threads * kItersPerThread);
+}
+
+void BM_BFCAllocationChurn(::testing::benchmark::State& state) {
+  AllocationChurn(state, state.range(0), /*use_cache=*/false);
+}
+BENCHMARK(BM_BFCAllocationChurn)->Arg(1)->Arg(8)->Arg(32);
+
+void BM_ThreadCachingAllocationChurn(::testing::benchmark::State& state) {
+  AllocationChurn(state, state.range(0), /*use_cache=*/true);
+}
+BENCHMARK(BM_ThreadCachingAllocationChurn)->Arg(1)->Arg(8)->Arg(32);
+
+}  // namespace
+}  // namespace tensorflow
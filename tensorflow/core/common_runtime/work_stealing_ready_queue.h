@@ -0,0 +1,199 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_READY_QUEUE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_READY_QUEUE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "absl/types/span.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+
+// A set of per-worker deques of ready work items with work stealing.
+//
+// A `WorkStealingReadyQueue` dispatches items to at most `num_workers`
+// concurrently running worker loops, each of which is started by handing a
+// single closure to `runner`. A worker pops items from the back of its own
+// deque (so that recently produced, cache-warm work runs next) and, when its
+// own deque is empty, steals from the front of the other workers' deques.
+// Items pushed from inside a worker land on that worker's deque, so the
+// frontier of a computation tends to stay on the core that produced it, and
+// `runner` is only invoked when the number of active workers falls below
+// `num_workers` while work is pending.
+//
+// The queue must be owned through a `std::shared_ptr`, because worker loops
+// keep it alive after the last item has been handled. In particular,
+// `handler` is allowed to destroy the object that created the queue, as long
+// as it does so while handling the last pending item.
+template <typename T>
+class WorkStealingReadyQueue
+    : public std::enable_shared_from_this<WorkStealingReadyQueue<T>> {
+ public:
+  typedef std::function<void(std::function<void()>)> Runner;
+  typedef std::function<void(T)> Handler;
+
+  static std::shared_ptr<WorkStealingReadyQueue> Create(int num_workers,
+                                                        Runner runner,
+                                                        Handler handler) {
+    return std::shared_ptr<WorkStealingReadyQueue>(new WorkStealingReadyQueue(
+        num_workers, std::move(runner), std::move(handler)));
+  }
+
+  ~WorkStealingReadyQueue() { DCHECK_EQ(0, num_queued_.load()); }
+
+  // Adds `items` to the deque of the calling worker (or to a deque chosen
+  // round-robin if the caller is not a worker of this queue), and starts new
+  // workers if there is more pending work than active workers.
+  void Push(absl::Span<const T> items) {
+    if (items.empty()) return;
+    const int worker_id = CurrentWorkerId();
+    const int queue_id =
+        worker_id >= 0
+            ? worker_id
+            : next_queue_.fetch_add(1, std::memory_order_relaxed) %
+                  num_workers_;
+    {
+      WorkerQueue& q = queues_[queue_id];
+      mutex_lock l(q.mu);
+      q.items.insert(q.items.end(), items.begin(), items.end());
+    }
+    const int64_t queued = num_queued_.fetch_add(items.size()) + items.size();
+    // A worker calling `Push()` will drain its own deque when it returns to
+    // its loop, so only wake up helpers for the work it cannot run itself.
+    int64_t wanted = worker_id >= 0 ? queued - 1 : queued;
+    while (wanted > 0 && TryActivateWorker()) {
+      StartWorker();
+      --wanted;
+    }
+  }
+
+  int num_workers() const { return num_workers_; }
+
+ private:
+  struct alignas(64) WorkerQueue {
+    mutex mu;
+    std::deque<T> items TF_GUARDED_BY(mu);
+  };
+
+  // Identifies the queue and worker that the current thread is running for.
+  struct CurrentWorker {
+    const WorkStealingReadyQueue* queue = nullptr;
+    int id = -1;
+  };
+
+  WorkStealingReadyQueue(int num_workers, Runner runner, Handler handler)
+      : num_workers_(std::max(1, num_workers)),
+        runner_(std::move(runner)),
+        handler_(std::move(handler)),
+        queues_(new WorkerQueue[num_workers_]) {}
+
+  static CurrentWorker* current_worker() {
+    static thread_local CurrentWorker current;
+    return &current;
+  }
+
+  int CurrentWorkerId() const {
+    const CurrentWorker* current = current_worker();
+    return current->queue == this ? current->id : -1;
+  }
+
+  // Increments the number of active workers if it is below `num_workers_`.
+  bool TryActivateWorker() {
+    int active = num_active_.load();
+    while (active < num_workers_) {
+      if (num_active_.compare_exchange_weak(active, active + 1)) return true;
+    }
+    return false;
+  }
+
+  void StartWorker() {
+    const int id =
+        next_worker_.fetch_add(1, std::memory_order_relaxed) % num_workers_;
+    runner_([self = this->shared_from_this(), id]() { self->WorkerLoop(id); });
+  }
+
+  std::optional<T> PopOrSteal(int id) {
+    if (num_queued_.load() == 0) return std::nullopt;
+    {
+      WorkerQueue& q = queues_[id];
+      mutex_lock l(q.mu);
+      if (!q.items.empty()) {
+        std::optional<T> item(std::move(q.items.back()));
+        q.items.pop_back();
+        num_queued_.fetch_sub(1);
+        return item;
+      }
+    }
+    for (int i = 1; i < num_workers_; ++i) {
+      WorkerQueue& q = queues_[(id + i) % num_workers_];
+      mutex_lock l(q.mu);
+      if (!q.items.empty()) {
+        std::optional<T> item(std::move(q.items.front()));
+        q.items.pop_front();
+        num_queued_.fetch_sub(1);
+        return item;
+      }
+    }
+    return std::nullopt;
+  }
+
+  void WorkerLoop(int id) {
+    CurrentWorker* current = current_worker();
+    const CurrentWorker saved = *current;
+    current->queue = this;
+    current->id = id;
+    while (true) {
+      std::optional<T> item = PopOrSteal(id);
+      if (item.has_value()) {
+        handler_(*std::move(item));
+        continue;
+      }
+      // Run dry. The decrement of `num_active_` and the load of `num_queued_`
+      // below pair with the increment of `num_queued_` and the load of
+      // `num_active_` in `Push()`, so either this worker observes newly pushed
+      // items or the pusher observes a free worker slot and starts a worker.
+      num_active_.fetch_sub(1);
+      if (num_queued_.load() == 0 || !TryActivateWorker()) break;
+    }
+    *current = saved;
+  }
+
+  const int num_workers_;
+  const Runner runner_;
+  const Handler handler_;
+  std::unique_ptr<WorkerQueue[]> queues_;
+
+  std::atomic<int64_t> num_queued_{0};
+  std::atomic<int> num_active_{0};
+  std::atomic<int> next_queue_{0};
+  std::atomic<int> next_worker_{0};
+
+  WorkStealingReadyQueue(const WorkStealingReadyQueue&) = delete;
+  void operator=(const WorkStealingReadyQueue&) = delete;
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_WORK_STEALING_READY_QUEUE_H_
@@ -0,0 +1,118 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/common_runtime/work_stealing_ready_queue.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/lib/core/notification.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+TEST(WorkStealingReadyQueueTest, RunsAllItems) {
+  thread::ThreadPool pool(Env::Default(), "test", 4);
+  constexpr int kNumItems = 1000;
+  std::vector<std::atomic<int>> counts(kNumItems);
+  BlockingCounter done(kNumItems);
+  auto queue = WorkStealingReadyQueue<int>::Create(
+      4, [&pool](std::function<void()> fn) { pool.Schedule(std::move(fn)); },
+      [&](int i) {
+        counts[i].fetch_add(1);
+        done.DecrementCount();
+      });
+  std::vector<int> items(kNumItems);
+  for (int i = 0; i < kNumItems; ++i) items[i] = i;
+  queue->Push(items);
+  done.Wait();
+  for (int i = 0; i < kNumItems; ++i) {
+    EXPECT_EQ(1, counts[i].load()) << i;
+  }
+}
+
+TEST(WorkStealingReadyQueueTest, PushFromHandler) {
+  thread::ThreadPool pool(Env::Default(), "test", 4);
+  // Every item `i > 0` fans out into two items `i - 1`, which builds a
+  // binary tree of 2^(depth + 1) - 1 handler invocations.
+  constexpr int kDepth = 12;
+  constexpr int kNumItems = (1 << (kDepth + 1)) - 1;
+  std::atomic<int> num_handled{0};
+  BlockingCounter done(kNumItems);
+  std::shared_ptr<WorkStealingReadyQueue<int>> queue;
+  queue = WorkStealingReadyQueue<int>::Create(
+      4, [&pool](std::function<void()> fn) { pool.Schedule(std::move(fn)); },
+      [&](int i) {
+        num_handled.fetch_add(1);
+        if (i > 0) {
+          std::vector<int> children = {i - 1, i - 1};
+          queue->Push(children);
+        }
+        done.DecrementCount();
+      });
+  std::vector<int> root = {kDepth};
+  queue->Push(root);
+  done.Wait();
+  EXPECT_EQ(kNumItems, num_handled.load());
+}
+
+TEST(WorkStealingReadyQueueTest, RespectsWorkerLimit) {
+  thread::ThreadPool pool(Env::Default(), "test", 8);
+  constexpr int kNumWorkers = 2;
+  constexpr int kNumItems = 64;
+  std::atomic<int> running{0};
+  std::atomic<int> max_running{0};
+  BlockingCounter done(kNumItems);
+  auto queue = WorkStealingReadyQueue<int>::Create(
+      kNumWorkers,
+      [&pool](std::function<void()> fn) { pool.Schedule(std::move(fn)); },
+      [&](int) {
+        const int now = running.fetch_add(1) + 1;
+        int prev = max_running.load();
+        while (prev < now && !max_running.compare_exchange_weak(prev, now)) {
+        }
+        Env::Default()->SleepForMicroseconds(100);
+        running.fetch_sub(1);
+        done.DecrementCount();
+      });
+  std::vector<int> items(kNumItems);
+  queue->Push(items);
+  done.Wait();
+  EXPECT_LE(max_running.load(), kNumWorkers);
+  EXPECT_GE(max_running.load(), 1);
+}
+
+TEST(WorkStealingReadyQueueTest, HandlerMayReleaseQueue) {
+  thread::ThreadPool pool(Env::Default(), "test", 2);
+  Notification done;
+  auto queue = WorkStealingReadyQueue<int>::Create(
+      2, [&pool](std::function<void()> fn) { pool.Schedule(std::move(fn)); },
+      [&](int) { done.Notify(); });
+  std::vector<int> items = {0};
+  queue->Push(items);
+  // Dropping the last external reference must not invalidate the running
+  // worker.
+  queue.reset();
+  done.WaitForNotification();
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -14,7 +14,10 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/compression_utils.h"
 
+#include <cstdint>
+#include <cstring>
 #include <limits>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -34,7 +37,121 @@ namespace {
 // Increment this when making changes to the `CompressedElement` proto. The
 // `UncompressElement` function will determine what to read according to the
 // version.
-constexpr int kCompressedElementVersion = 0;
+//
+// - Version 0: the tensor data is compressed as is.
+// - Version 1: adds `CompressedComponentMetadata.codec`.
+constexpr int kCompressedElementVersion = 1;
+
+// Components with less tensor data are compressed as is, since transforming
+// them does not noticeably improve their compression.
+constexpr size_t kMinCodecBytes = 1024;
+
+// Returns the codec to apply to the tensor data of `memcpy`able `component`.
+//
+// Shuffling the bytes of numeric values groups their mostly equal exponent and
+// high-order bytes together, which Snappy compresses much better than
+// interleaved values. Delta encoding additionally turns sorted or clustered
+// integer ids into small differences.
+CompressedComponentMetadata::Codec ChooseCodec(const Tensor& component) {
+  if (component.TotalBytes() < kMinCodecBytes) {
+    return CompressedComponentMetadata::CODEC_NONE;
+  }
+  switch (component.dtype()) {
+    case DT_HALF:
+    case DT_BFLOAT16:
+    case DT_FLOAT:
+    case DT_DOUBLE:
+      return CompressedComponentMetadata::CODEC_BYTE_SHUFFLE;
+    case DT_INT32:
+    case DT_UINT32:
+    case DT_INT64:
+    case DT_UINT64:
+      return CompressedComponentMetadata::CODEC_DELTA_BYTE_SHUFFLE;
+    default:
+      return CompressedComponentMetadata::CODEC_NONE;
+  }
+}
+
+// Stores byte `b` of value `i` of `src` at `dst[b * num_values + i]`. If
+// `kDelta`, value `i` is first replaced by its difference from value `i - 1`,
+// with unsigned wrap-around.
+template <typename T, bool kDelta>
+void Encode(const char* src, size_t num_values, char* dst) {
+  T previous = 0;
+  for (size_t i = 0; i < num_values; ++i) {
+    T value;
+    std::memcpy(&value, src + i * sizeof(T), sizeof(T));
+    if (kDelta) {
+      const T delta = value - previous;
+      previous = value;
+      value = delta;
+    }
+    const char* bytes = reinterpret_cast<const char*>(&value);
+    for (size_t b = 0; b < sizeof(T); ++b) {
+      dst[b * num_values + i] = bytes[b];
+    }
+  }
+}
+
+// Inverts `Encode<T, kDelta>`.
+template <typename T, bool kDelta>
+void Decode(const char* src, size_t num_values, char* dst) {
+  T previous = 0;
+  for (size_t i = 0; i < num_values; ++i) {
+    T value;
+    char* bytes = reinterpret_cast<char*>(&value);
+    for (size_t b = 0; b < sizeof(T); ++b) {
+      bytes[b] = src[b * num_values + i];
+    }
+    if (kDelta) {
+      value += previous;
+      previous = value;
+    }
+    std::memcpy(dst + i * sizeof(T), &value, sizeof(T));
+  }
+}
+
+template <typename T>
+void ApplyCodec(bool delta, bool decode, const char* src, size_t num_values,
+                char* dst) {
+  if (decode && delta) {
+    Decode<T, true>(src, num_values, dst);
+  } else if (decode) {
+    Decode<T, false>(src, num_values, dst);
+  } else if (delta) {
+    Encode<T, true>(src, num_values, dst);
+  } else {
+    Encode<T, false>(src, num_values, dst);
+  }
+}
+
+// Applies `codec` to the `size` bytes of tensor data of type `dtype` in
+// `src`, writing the result to `dst`. If `decode`, inverts the codec instead.
+absl::Status ApplyCodec(CompressedComponentMetadata::Codec codec,
+                        DataType dtype, bool decode, const char* src,
+                        size_t size, char* dst) {
+  const size_t width = DataTypeSize(dtype);
+  if (width == 0 || size % width != 0) {
+    return errors::Internal("Invalid size ", size, " of a ",
+                            DataTypeString(dtype), " component.");
+  }
+  const bool delta =
+      codec == CompressedComponentMetadata::CODEC_DELTA_BYTE_SHUFFLE;
+  switch (width) {
+    case 2:
+      ApplyCodec<uint16_t>(delta, decode, src, size / width, dst);
+      return absl::OkStatus();
+    case 4:
+      ApplyCodec<uint32_t>(delta, decode, src, size / width, dst);
+      return absl::OkStatus();
+    case 8:
+      ApplyCodec<uint64_t>(delta, decode, src, size / width, dst);
+      return absl::OkStatus();
+    default:
+      return errors::Internal("Unsupported codec ", codec, " for a ",
+                              DataTypeString(dtype), " component.");
+  }
+}
 
 }  // namespace
 
@@ -81,7 +198,8 @@ absl::Status CompressElement(const std::vector<Tensor>& element,
   }
 
   // Second pass: build an iov array of the tensor data.
-  // - `memcpy`able tensors are pointed to directly from a single iovec.
+  // - `memcpy`able tensors are pointed to directly from a single iovec, unless
+  // a codec applies to them, in which case they are encoded into a buffer.
   // - String tensors are pointed to directly from multiple iovecs (one for each
   // string).
   // - All other tensors are serialized and copied into a string (a `tstring`
@@ -91,6 +209,7 @@ absl::Status CompressElement(const std::vector<Tensor>& element,
   nonmemcpyable.resize_uninitialized(total_nonmemcpyable_size);
   char* nonmemcpyable_pos = nonmemcpyable.mdata();
   int nonmemcpyable_component_index = 0;
+  std::vector<std::unique_ptr<char[]>> encoded_components;
   for (int i = 0; i < element.size(); ++i) {
     const auto& component = element[i];
     CompressedComponentMetadata* metadata =
@@ -100,7 +219,18 @@ absl::Status CompressElement(const std::vector<Tensor>& element,
     if (DataTypeCanUseMemcpy(component.dtype())) {
       const TensorBuffer* buffer = DMAHelper::buffer(&component);
       if (buffer) {
-        iov.Add(buffer->data(), buffer->size());
+        const CompressedComponentMetadata::Codec codec = ChooseCodec(component);
+        if (codec == CompressedComponentMetadata::CODEC_NONE) {
+          iov.Add(buffer->data(), buffer->size());
+        } else {
+          encoded_components.emplace_back(new char[buffer->size()]);
+          TF_RETURN_IF_ERROR(ApplyCodec(
+              codec, component.dtype(), /*decode=*/false,
+              static_cast<const char*>(buffer->data()), buffer->size(),
+              encoded_components.back().get()));
+          iov.Add(encoded_components.back().get(), buffer->size());
+          metadata->set_codec(codec);
+        }
         metadata->add_uncompressed_bytes(buffer->size());
       }
     } else if (component.dtype() == DT_STRING) {
@@ -137,7 +267,8 @@ absl::Status CompressElement(const std::vector<Tensor>& element,
 
 absl::Status UncompressElement(const CompressedElement& compressed,
                                std::vector<Tensor>* out) {
-  if (compressed.version() != kCompressedElementVersion) {
+  if (compressed.version() < 0 ||
+      compressed.version() > kCompressedElementVersion) {
     return errors::Internal("Unsupported compressed element version: ",
                             compressed.version());
   }
@@ -159,7 +290,9 @@ absl::Status UncompressElement(const CompressedElement& compressed,
   }
 
   // Second pass: prepare the memory to be uncompressed into.
-  // - `memcpy`able tensors are directly uncompressed into via a single iovec.
+  // - `memcpy`able tensors are directly uncompressed into via a single iovec,
+  // unless a codec was applied to them, in which case they are uncompressed
+  // into a buffer and decoded into the tensor.
   // - String tensors are directly uncompressed into via multiple iovecs (one
   // for each string).
   // - All other tensors are uncompressed into a string (a `tstring` for access
@@ -168,11 +301,18 @@ absl::Status UncompressElement(const CompressedElement& compressed,
   tstring nonmemcpyable;
   nonmemcpyable.resize_uninitialized(total_nonmemcpyable_size);
   char* nonmemcpyable_pos = nonmemcpyable.mdata();
+  std::vector<std::unique_ptr<char[]>> encoded_components;
   for (const auto& metadata : compressed.component_metadata()) {
     if (DataTypeCanUseMemcpy(metadata.dtype())) {
       out->emplace_back(metadata.dtype(), metadata.tensor_shape());
       TensorBuffer* buffer = DMAHelper::buffer(&out->back());
-      if (buffer) {
+      if (buffer &&
+          metadata.codec() != CompressedComponentMetadata::CODEC_NONE) {
+        encoded_components.emplace_back(
+            new char[metadata.uncompressed_bytes(0)]);
+        iov.Add(encoded_components.back().get(),
+                metadata.uncompressed_bytes(0));
+      } else if (buffer) {
         iov.Add(buffer->data(), metadata.uncompressed_bytes(0));
       }
     } else if (metadata.dtype() == DT_STRING) {
@@ -209,12 +349,21 @@ absl::Status UncompressElement(const CompressedElement& compressed,
     return errors::Internal("Failed to perform snappy decompression.");
   }
 
-  // Third pass: deserialize nonstring, non`memcpy`able tensors.
+  // Third pass: decode encoded tensors and deserialize nonstring,
+  // non`memcpy`able tensors.
   nonmemcpyable_pos = nonmemcpyable.mdata();
+  auto encoded_component = encoded_components.begin();
   for (int i = 0; i < num_components; ++i) {
     const CompressedComponentMetadata& metadata =
         compressed.component_metadata(i);
-    if (!DataTypeCanUseMemcpy(metadata.dtype()) &&
+    TensorBuffer* buffer = DMAHelper::buffer(&out->at(i));
+    if (DataTypeCanUseMemcpy(metadata.dtype()) && buffer &&
+        metadata.codec() != CompressedComponentMetadata::CODEC_NONE) {
+      TF_RETURN_IF_ERROR(ApplyCodec(
+          metadata.codec(), metadata.dtype(), /*decode=*/true,
+          (encoded_component++)->get(), metadata.uncompressed_bytes(0),
+          static_cast<char*>(buffer->data())));
+    } else if (!DataTypeCanUseMemcpy(metadata.dtype()) &&
         metadata.dtype() != DT_STRING) {
       TensorProto tp;
       if (!tp.ParseFromString(
@@ -60,6 +60,11 @@ std::vector<std::vector<Tensor>> TestCases() {
       // Larger int64.
       {CreateTensor<int64_t>(TensorShape{128, 128}),
        CreateTensor<int64_t>(TensorShape{64, 2})},
+      // Larger floating point and integer types.
+      {CreateTensor<float>(TensorShape{64, 64}),
+       CreateTensor<double>(TensorShape{256}),
+       CreateTensor<int32_t>(TensorShape{512}),
+       CreateTensor<uint64_t>(TensorShape{256})},
       // Variants.
       {
           DatasetOpsTestBase::CreateTestVariantTensor(
@@ -90,7 +95,7 @@ TEST_P(ParameterizedCompressionUtilsTest, CompressedElementVersion) {
   std::vector<Tensor> element = GetParam();
   CompressedElement compressed;
   TF_ASSERT_OK(CompressElement(element, &compressed));
-  EXPECT_EQ(0, compressed.version());
+  EXPECT_EQ(1, compressed.version());
 }
 
 TEST_P(ParameterizedCompressionUtilsTest, VersionMismatch) {
@@ -98,12 +103,51 @@ TEST_P(ParameterizedCompressionUtilsTest, VersionMismatch) {
   CompressedElement compressed;
   TF_ASSERT_OK(CompressElement(element, &compressed));
 
-  compressed.set_version(1);
+  compressed.set_version(2);
   std::vector<Tensor> round_trip_element;
   EXPECT_THAT(UncompressElement(compressed, &round_trip_element),
               StatusIs(error::INTERNAL));
 }
 
+TEST(CompressionUtilsTest, ComponentCodecs) {
+  Tensor floats(DT_FLOAT, TensorShape{1024});
+  test::FillFn<float>(&floats, [](int i) { return 0.5f * i; });
+  Tensor ids(DT_INT64, TensorShape{1024});
+  test::FillFn<int64_t>(&ids, [](int i) { return (int64_t{1} << 40) + 3 * i; });
+  Tensor small = test::AsTensor<int64_t>({5, 3, 1});
+  std::vector<Tensor> element = {floats, ids, small};
+
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, &compressed));
+  ASSERT_EQ(compressed.component_metadata_size(), 3);
+  EXPECT_EQ(compressed.component_metadata(0).codec(),
+            CompressedComponentMetadata::CODEC_BYTE_SHUFFLE);
+  EXPECT_EQ(compressed.component_metadata(1).codec(),
+            CompressedComponentMetadata::CODEC_DELTA_BYTE_SHUFFLE);
+  EXPECT_EQ(compressed.component_metadata(2).codec(),
+            CompressedComponentMetadata::CODEC_NONE);
+  // The delta encoded ids compress to almost nothing.
+  EXPECT_LT(compressed.data().size(), floats.TotalBytes());
+
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+  TF_EXPECT_OK(DatasetOpsTestBase::ExpectEqual(element, round_trip_element,
+                                               /*compare_order=*/true));
+}
+
+TEST(CompressionUtilsTest, UncompressVersion0) {
+  std::vector<Tensor> element = {test::AsTensor<int64_t>({1, 2, 3}),
+                                 test::AsTensor<tstring>({"a", "b"})};
+  CompressedElement compressed;
+  TF_ASSERT_OK(CompressElement(element, &compressed));
+  // Elements without codecs are laid out as in version 0.
+  compressed.set_version(0);
+  std::vector<Tensor> round_trip_element;
+  TF_ASSERT_OK(UncompressElement(compressed, &round_trip_element));
+  TF_EXPECT_OK(DatasetOpsTestBase::ExpectEqual(element, round_trip_element,
+                                               /*compare_order=*/true));
+}
+
 INSTANTIATE_TEST_SUITE_P(Instantiation, ParameterizedCompressionUtilsTest,
                          ::testing::ValuesIn(TestCases()));
 
@@ -60,6 +60,10 @@ namespace tensorflow {
 namespace data {
 namespace {
 
+// While nearer tasks still have data, topologically farther tasks are only
+// read in one out of this many rounds.
+constexpr int64_t kFarTaskReadInterval = 4;
+
 bool IsColocatedTask(const TaskInfo& task) {
   return absl::c_any_of(task.worker_tags(), [](std::string_view worker_tag) {
     return absl::AsciiStrToUpper(worker_tag) == kColocatedWorkerTag;
@@ -82,6 +86,7 @@ absl::StatusOr<DataTransferServerInfo> GetTransferServer(
 
 DataServiceClient::DataServiceClient(const DataServiceParams& params)
     : params_(params),
+      topology_tags_(GetClientTopologyTags()),
       max_outstanding_requests_(params.max_outstanding_requests) {}
 
 DataServiceClient::~DataServiceClient() {
@@ -423,6 +428,11 @@ absl::Status DataServiceClient::AddTask(const TaskInfo& task_info)
       worker->GetDataTransferProtocol(),
       /*user_specified=*/!params_.data_transfer_protocol.empty());
   tasks_.push_back(std::make_shared<Task>(task_info, std::move(worker)));
+  if (!topology_tags_.empty()) {
+    tasks_.back()->topology_distance = TopologyDistance(
+        topology_tags_, {task_info.worker_tags().begin(),
+                         task_info.worker_tags().end()});
+  }
   worker_thread_cv_.notify_one();
   if (IsCoordinatedRead()) {
     VLOG(1) << "Consumer " << params_.consumer_index.value() << " adding task "
@@ -714,6 +724,7 @@ std::shared_ptr<DataServiceClient::Task> DataServiceClient::GetTaskToProcess()
     return nullptr;
   }
 
+  const int64_t min_topology_distance = MinTopologyDistance();
   for (int i = 0; i < tasks_.size(); ++i) {
     std::shared_ptr<Task>& task = tasks_[next_task_index_];
     if (IsCoordinatedRead() &&
@@ -737,6 +748,15 @@ std::shared_ptr<DataServiceClient::Task> DataServiceClient::GetTaskToProcess()
       AdvanceTaskIndex();
       continue;
     }
+    if (!IsCoordinatedRead() &&
+        task->topology_distance > min_topology_distance &&
+        current_round_ % kFarTaskReadInterval != 0) {
+      VLOG(3) << "Skipping topologically far task " << next_task_index_
+              << ". topology distance: " << task->topology_distance
+              << ". current round: " << current_round_;
+      AdvanceTaskIndex();
+      continue;
+    }
     task->round = current_round_;
     AdvanceTaskIndex();
     return task;
@@ -744,6 +764,18 @@ std::shared_ptr<DataServiceClient::Task> DataServiceClient::GetTaskToProcess()
   return nullptr;
 }
 
+int64_t DataServiceClient::MinTopologyDistance() const
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  int64_t min_topology_distance = std::numeric_limits<int64_t>::max();
+  for (const std::shared_ptr<Task>& task : tasks_) {
+    if (!task->end_of_sequence && !task->removed) {
+      min_topology_distance =
+          std::min(min_topology_distance, task->topology_distance);
+    }
+  }
+  return min_topology_distance;
+}
+
 // Increments the next task index, starting over if all tasks have been
 // processed.
 void DataServiceClient::AdvanceTaskIndex() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
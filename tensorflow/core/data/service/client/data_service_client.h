@@ -115,6 +115,8 @@ class DataServiceClient {
     // Number of retries. The more it is retried, the longer it should wait
     // before the next retry.
     int64_t num_retries = 0;
+    // Topology distance between the client and the task's worker.
+    int64_t topology_distance = 0;
   };
 
   struct Result {
@@ -175,6 +177,8 @@ class DataServiceClient {
   // Searches for a task to process, visiting tasks in-order and giving every
   // task a chance to proceed.
   std::shared_ptr<Task> GetTaskToProcess();
+  // Returns the topology distance of the nearest tasks which still have data.
+  int64_t MinTopologyDistance() const;
   void AdvanceTaskIndex();
   absl::Status TryGetElement(const Task& task, bool allow_skip,
                              GetElementResult& result);
@@ -195,6 +199,8 @@ class DataServiceClient {
   std::string DebugString() const;
 
   const DataServiceParams params_;
+  // Topology tags of this client, see `kClientTopologyEnvVar`.
+  const std::vector<std::string> topology_tags_;
 
   mutable mutex mu_;
   condition_variable get_next_cv_ TF_GUARDED_BY(mu_);
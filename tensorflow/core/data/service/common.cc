@@ -14,8 +14,17 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/common.h"
 
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
 #include <string>
+#include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/framework/dataset_options.pb.h"
@@ -35,6 +44,9 @@ constexpr const char kLocal[] = "LOCAL";
 constexpr const char kColocated[] = "COLOCATED";
 constexpr const char kRemote[] = "REMOTE";
 constexpr const char kHybrid[] = "HYBRID";
+
+// Topology levels, from the nearest to the farthest.
+constexpr const char* kTopologyLevels[] = {"host", "rack", "zone"};
 }  // namespace
 
 bool IsNoShard(const ProcessingModeDef& processing_mode) {
@@ -135,5 +147,32 @@ bool IsPreemptedError(const absl::Status& status) {
   return errors::IsAborted(status) || errors::IsCancelled(status) ||
          errors::IsUnavailable(status);
 }
+
+std::vector<std::string> GetClientTopologyTags() {
+  const char* tags = std::getenv(kClientTopologyEnvVar);
+  if (tags == nullptr) {
+    return {};
+  }
+  std::vector<std::string> result;
+  for (absl::string_view tag :
+       absl::StrSplit(tags, ',', absl::SkipWhitespace())) {
+    result.emplace_back(absl::StripAsciiWhitespace(tag));
+  }
+  return result;
+}
+
+int64_t TopologyDistance(const std::vector<std::string>& client_tags,
+                         const std::vector<std::string>& worker_tags) {
+  for (int64_t level = 0; level < std::size(kTopologyLevels); ++level) {
+    const std::string prefix = absl::StrCat(kTopologyLevels[level], ":");
+    for (const std::string& client_tag : client_tags) {
+      if (absl::StartsWith(client_tag, prefix) &&
+          absl::c_linear_search(worker_tags, client_tag)) {
+        return level;
+      }
+    }
+  }
+  return std::size(kTopologyLevels);
+}
 }  // namespace data
 }  // namespace tensorflow
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_COMMON_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_COMMON_H_
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -39,6 +40,12 @@ constexpr int kDataServiceVersion = 9;
 // workers on other TF hosts when the host runs a local tf.data service worker.
 constexpr absl::string_view kColocatedWorkerTag = "COLOCATED";
 
+// Worker tags of the form "<level>:<name>", where <level> is "host", "rack" or
+// "zone", describe where a tf.data worker runs. A client lists its own
+// topology tags, separated by commas, in this environment variable, and reads
+// less from workers that are topologically farther than its nearest workers.
+constexpr char kClientTopologyEnvVar[] = "TF_DATA_SERVICE_CLIENT_TOPOLOGY";
+
 // Container to hold the result of a `GetNext` call.
 struct GetNextResult final {
   explicit GetNextResult() = default;
@@ -88,6 +95,15 @@ absl::StatusOr<DeploymentMode> ParseDeploymentMode(absl::string_view s);
 // Returns true if `status` is a retriable error that indicates preemption.
 bool IsPreemptedError(const absl::Status& status);
 
+// Returns the topology tags of this client, read from `kClientTopologyEnvVar`.
+std::vector<std::string> GetClientTopologyTags();
+
+// Returns the topology distance between a client with `client_tags` and a
+// worker with `worker_tags`: 0 if they share a host, 1 if they share a rack, 2
+// if they share a zone, and 3 otherwise.
+int64_t TopologyDistance(const std::vector<std::string>& client_tags,
+                         const std::vector<std::string>& worker_tags);
+
 // Base class for data service clients. Data service clients are
 // threadsafe.
 class DataServiceClientBase {
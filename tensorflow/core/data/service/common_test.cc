@@ -14,6 +14,8 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/data/service/common.h"
 
+#include <cstdlib>
+#include <string>
 #include <vector>
 
 #include "tensorflow/core/framework/dataset_options.pb.h"
@@ -33,7 +35,9 @@ namespace {
 
 using ::tensorflow::testing::IsOkAndHolds;
 using ::tensorflow::testing::StatusIs;
+using ::testing::ElementsAre;
 using ::testing::HasSubstr;
+using ::testing::IsEmpty;
 
 std::vector<ProcessingModeDef::ShardingPolicy> EnumerateShardingPolicies() {
   std::vector<ProcessingModeDef::ShardingPolicy> result;
@@ -186,6 +190,24 @@ TEST(CommonTest, IsPermanentError) {
   EXPECT_FALSE(IsPreemptedError(errors::OutOfRange("Out of range")));
   EXPECT_FALSE(IsPreemptedError(errors::Unknown("Unknown")));
 }
+
+TEST(CommonTest, GetClientTopologyTags) {
+  EXPECT_THAT(GetClientTopologyTags(), IsEmpty());
+  setenv(kClientTopologyEnvVar, "host:a, rack:r1,zone:z", 1);
+  EXPECT_THAT(GetClientTopologyTags(),
+              ElementsAre("host:a", "rack:r1", "zone:z"));
+  unsetenv(kClientTopologyEnvVar);
+}
+
+TEST(CommonTest, TopologyDistance) {
+  const std::vector<std::string> client = {"host:a", "rack:r1", "zone:z1"};
+  EXPECT_EQ(TopologyDistance(client, {"host:a", "rack:r1", "zone:z1"}), 0);
+  EXPECT_EQ(TopologyDistance(client, {"host:b", "rack:r1", "zone:z1"}), 1);
+  EXPECT_EQ(TopologyDistance(client, {"COLOCATED", "rack:r2", "zone:z1"}), 2);
+  EXPECT_EQ(TopologyDistance(client, {"host:b", "rack:r2", "zone:z2"}), 3);
+  EXPECT_EQ(TopologyDistance(client, {}), 3);
+  EXPECT_EQ(TopologyDistance({}, {"host:a"}), 3);
+}
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
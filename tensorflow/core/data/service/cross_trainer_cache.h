@@ -20,8 +20,10 @@ limitations under the License.
 #include <functional>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/data/service/byte_size.h"
@@ -91,6 +93,24 @@ class CachableSequence {
   virtual size_t GetElementSizeBytes(const ElementType&) const = 0;
 };
 
+// An optional second tier of a `CrossTrainerCache`, for example on local disk.
+// Elements evicted from memory are spilled to it, so trainers which fall behind
+// the in-memory sliding window can still read them. The spill tier has its own
+// size bound, and may drop the oldest spilled elements.
+template <class ElementType>
+class CacheSpillTier {
+ public:
+  virtual ~CacheSpillTier() = default;
+
+  // Stores the element with absolute index `index`. Spilled indices are
+  // consecutive.
+  virtual absl::Status Spill(size_t index, const ElementType& element) = 0;
+
+  // Reads the element with absolute index `index`. Returns NotFound if the
+  // element has not been spilled or has been dropped.
+  virtual StatusOr<ElementType> Read(size_t index) = 0;
+};
+
 // Sliding-window cache shared across concurrent trainers.
 template <class ElementType>
 class CrossTrainerCache {
@@ -98,9 +118,13 @@ class CrossTrainerCache {
   // Creates a `CrossTrainerCache` with `max_cache_size_bytes` of memory budget.
   // The cache should be able to hold at least one element, i.e.:
   // REQUIRES: `max_cache_size_bytes >= max(GetElementSizeBytes(*))`
+  //
+  // If `spill_tier` is not null, elements evicted from memory are spilled to
+  // it and served from there to trainers which fall behind.
   explicit CrossTrainerCache(
       size_t max_cache_size_bytes,
-      std::unique_ptr<CachableSequence<ElementType>> cachable_sequence);
+      std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+      std::unique_ptr<CacheSpillTier<ElementType>> spill_tier = nullptr);
   virtual ~CrossTrainerCache() = default;
   CrossTrainerCache(const CrossTrainerCache&) = delete;
   CrossTrainerCache& operator=(const CrossTrainerCache&) = delete;
@@ -129,6 +153,11 @@ class CrossTrainerCache {
   // Returns the next element and metrics about this query.
   StatusOr<CacheQueryResult> GetCacheQueryResult(const std::string& trainer_id);
 
+  // If the next element for `trainer_id` has been evicted from memory, reads it
+  // from `spill_tier_`. Returns nullopt if it is not in the spill tier either.
+  StatusOr<std::optional<CacheQueryResult>> GetSpilledElement(
+      const std::string& trainer_id);
+
   // Returns true if element is ready for `trainer_id`. An element is ready if
   // other trainers have read the data and the data remains in the cache. If the
   // data is not ready, one of the trainers need to extend the cache.
@@ -145,6 +174,11 @@ class CrossTrainerCache {
   // Reads a new element and writes it into the cache.
   absl::Status ExtendCache();
 
+  // Returns the elements which need to be freed to insert an element of
+  // `new_element_size_bytes`.
+  std::vector<std::shared_ptr<const ElementType>> ElementsToFree(
+      size_t new_element_size_bytes);
+
   // Frees old elements to keep the cache size below `max_cache_size_bytes_`.
   // `new_element_size_bytes` is the size of the new element being inserted.
   void FreeSpace(size_t new_element_size_bytes);
@@ -158,6 +192,9 @@ class CrossTrainerCache {
   // The element sequence over which the sliding window cache operates.
   std::unique_ptr<CachableSequence<ElementType>> cachable_sequence_;
 
+  // Optional second tier for elements evicted from `cache_`.
+  const std::unique_ptr<CacheSpillTier<ElementType>> spill_tier_;
+
   mutable mutex mu_;
   mutable condition_variable cv_;
 
@@ -183,9 +220,11 @@ class CrossTrainerCache {
 template <class ElementType>
 CrossTrainerCache<ElementType>::CrossTrainerCache(
     size_t max_cache_size_bytes,
-    std::unique_ptr<CachableSequence<ElementType>> cachable_sequence)
+    std::unique_ptr<CachableSequence<ElementType>> cachable_sequence,
+    std::unique_ptr<CacheSpillTier<ElementType>> spill_tier)
     : max_cache_size_bytes_(max_cache_size_bytes),
-      cachable_sequence_(std::move(cachable_sequence)) {
+      cachable_sequence_(std::move(cachable_sequence)),
+      spill_tier_(std::move(spill_tier)) {
   DCHECK_GT(max_cache_size_bytes, 0)
       << "CrossTrainerCache size must be greater than 0.";
   VLOG(2) << "Initialized tf.data service cross-trainer cache with "
@@ -210,6 +249,14 @@ template <class ElementType>
 StatusOr<typename CrossTrainerCache<ElementType>::CacheQueryResult>
 CrossTrainerCache<ElementType>::GetCacheQueryResult(
     const std::string& trainer_id) {
+  if (spill_tier_ != nullptr) {
+    TF_ASSIGN_OR_RETURN(std::optional<CacheQueryResult> spilled,
+                        GetSpilledElement(trainer_id));
+    if (spilled.has_value()) {
+      return *std::move(spilled);
+    }
+  }
+
   bool should_extend_cache = false;
   while (true) {
     {
@@ -244,6 +291,36 @@ CrossTrainerCache<ElementType>::GetCacheQueryResult(
   }
 }
 
+template <class ElementType>
+StatusOr<
+    std::optional<typename CrossTrainerCache<ElementType>::CacheQueryResult>>
+CrossTrainerCache<ElementType>::GetSpilledElement(const std::string& trainer_id)
+    TF_LOCKS_EXCLUDED(mu_) {
+  size_t element_index = 0;
+  {
+    mutex_lock l(mu_);
+    TF_RETURN_IF_ERROR(status_);
+    // New trainers start from the in-memory window, as without a spill tier.
+    auto it = trainer_to_element_index_map_.find(trainer_id);
+    if (it == trainer_to_element_index_map_.end() ||
+        it->second >= cache_start_index_) {
+      return std::nullopt;
+    }
+    element_index = it->second;
+  }
+
+  StatusOr<ElementType> element = spill_tier_->Read(element_index);
+  if (errors::IsNotFound(element.status())) {
+    return std::nullopt;
+  }
+  TF_RETURN_IF_ERROR(element.status());
+  mutex_lock l(mu_);
+  trainer_to_element_index_map_[trainer_id] = element_index + 1;
+  return CacheQueryResult{
+      std::make_shared<const ElementType>(*std::move(element)),
+      /*cache_hit=*/true};
+}
+
 template <class ElementType>
 bool CrossTrainerCache<ElementType>::IsElementReady(
     const std::string& trainer_id) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -290,6 +367,22 @@ absl::Status CrossTrainerCache<ElementType>::ExtendCache()
         " and cache size: ", max_cache_size_bytes_);
   }
 
+  if (spill_tier_ != nullptr) {
+    // Only the extending thread removes elements from `cache_`, so the
+    // elements to free do not change while they are spilled without `mu_`.
+    std::vector<std::shared_ptr<const ElementType>> elements_to_free;
+    size_t spill_start_index = 0;
+    {
+      mutex_lock l(mu_);
+      elements_to_free = ElementsToFree(new_element_size_bytes);
+      spill_start_index = cache_start_index_;
+    }
+    for (size_t i = 0; i < elements_to_free.size(); ++i) {
+      TF_RETURN_IF_ERROR(
+          spill_tier_->Spill(spill_start_index + i, *elements_to_free[i]));
+    }
+  }
+
   mutex_lock l(mu_);
   TF_RETURN_IF_ERROR(status_);
   FreeSpace(new_element_size_bytes);
@@ -298,6 +391,22 @@ absl::Status CrossTrainerCache<ElementType>::ExtendCache()
   return absl::OkStatus();
 }
 
+template <class ElementType>
+std::vector<std::shared_ptr<const ElementType>>
+CrossTrainerCache<ElementType>::ElementsToFree(size_t new_element_size_bytes)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  std::vector<std::shared_ptr<const ElementType>> elements_to_free;
+  size_t cache_size_bytes = cache_size_bytes_;
+  for (const std::shared_ptr<const ElementType>& element : cache_) {
+    if (cache_size_bytes + new_element_size_bytes <= max_cache_size_bytes_) {
+      break;
+    }
+    cache_size_bytes -= cachable_sequence_->GetElementSizeBytes(*element);
+    elements_to_free.push_back(element);
+  }
+  return elements_to_free;
+}
+
 template <class ElementType>
 void CrossTrainerCache<ElementType>::FreeSpace(size_t new_element_size_bytes)
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
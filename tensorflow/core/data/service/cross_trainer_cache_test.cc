@@ -86,6 +86,33 @@ class SlowDataset : public CachableSequence<Tensor> {
   absl::Duration delay_;
 };
 
+// Spill tier which stores up to `capacity` elements in memory.
+class InMemorySpillTier : public CacheSpillTier<int64_t> {
+ public:
+  explicit InMemorySpillTier(size_t capacity) : capacity_(capacity) {}
+
+  absl::Status Spill(size_t index, const int64_t& element) override {
+    mutex_lock l(mu_);
+    elements_[index] = element;
+    elements_.erase(index - std::min(index, capacity_));
+    return absl::OkStatus();
+  }
+
+  absl::StatusOr<int64_t> Read(size_t index) override {
+    mutex_lock l(mu_);
+    auto it = elements_.find(index);
+    if (it == elements_.end()) {
+      return errors::NotFound("Element ", index, " not found.");
+    }
+    return it->second;
+  }
+
+ private:
+  const size_t capacity_;
+  mutex mu_;
+  absl::flat_hash_map<size_t, int64_t> elements_ TF_GUARDED_BY(mu_);
+};
+
 template <class T>
 class ElementOrErrorDataset : public CachableSequence<T> {
  public:
@@ -190,6 +217,28 @@ TEST(CrossTrainerCacheTest, SlowTrainersSkipData) {
   EXPECT_THAT(cache.Get("Slow trainer 2"), IsOkAndHolds(Pointee(Gt(94))));
 }
 
+TEST(CrossTrainerCacheTest, SlowTrainersReadSpilledData) {
+  CrossTrainerCache<int64_t> cache(
+      /*max_cache_size_bytes=*/5 * sizeof(int64_t),
+      std::make_unique<InfiniteRange>(),
+      std::make_unique<InMemorySpillTier>(/*capacity=*/50));
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(0)));
+  for (int i = 0; i < 40; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+  // The slow trainer reads the evicted elements from the spill tier.
+  for (int i = 1; i < 40; ++i) {
+    EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(i)));
+  }
+
+  for (int i = 40; i < 100; ++i) {
+    EXPECT_THAT(cache.Get("Fast trainer"), IsOkAndHolds(Pointee(i)));
+  }
+  // Elements before 45 were dropped from the spill tier, so the slow trainer
+  // continues from the oldest element in memory.
+  EXPECT_THAT(cache.Get("Slow trainer"), IsOkAndHolds(Pointee(Gt(94))));
+}
+
 TEST(CrossTrainerCacheTest, NewTrainersStartLate) {
   CrossTrainerCache<int64_t> cache(
       /*max_cache_size_bytes=*/5 * sizeof(int64_t),
@@ -19,9 +19,12 @@ limitations under the License.
 #include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "absl/container/flat_hash_set.h"
+#include "absl/memory/memory.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "xla/tsl/protobuf/error_codes.pb.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/data_transfer.h"
@@ -333,6 +336,48 @@ TEST_F(DispatcherClientTest, EnableCrossTrainerCache) {
   EXPECT_TRUE(worker_heartbeat_response.new_tasks(0).use_cross_trainer_cache());
 }
 
+TEST_F(DispatcherClientTest, ConcurrentHeartbeats) {
+  TF_ASSERT_OK(SetUpTfDataService(/*num_workers=*/1));
+  DataServiceMetadata metadata = GetDefaultMetadata();
+  metadata.set_cardinality(kInfiniteCardinality);
+  TF_ASSERT_OK_AND_ASSIGN(const std::string dataset_id,
+                          RegisterDataset(InfiniteDataset(), metadata));
+  ProcessingModeDef processing_mode;
+  processing_mode.set_sharding_policy(ProcessingModeDef::OFF);
+  int64_t job_id;
+  TF_ASSERT_OK(dispatcher_client_->GetOrCreateJob(
+      dataset_id, processing_mode, /*job_name=*/std::nullopt,
+      /*num_consumers=*/std::nullopt,
+      /*use_cross_trainer_cache=*/false, TARGET_WORKERS_AUTO, job_id));
+  int64_t iteration_client_id;
+  TF_ASSERT_OK(dispatcher_client_->GetOrCreateIteration(
+      job_id, /*repetition=*/0, iteration_client_id));
+
+  // Heartbeats which don't update the dispatcher state run concurrently.
+  std::vector<std::unique_ptr<tsl::Thread>> threads;
+  for (int i = 0; i < 10; ++i) {
+    threads.push_back(absl::WrapUnique(tsl::Env::Default()->StartThread(
+        {}, absl::StrCat("heartbeat_", i), [&] {
+          for (int j = 0; j < 10; ++j) {
+            WorkerHeartbeatRequest worker_request;
+            worker_request.set_worker_address(test_cluster_->WorkerAddress(0));
+            absl::StatusOr<WorkerHeartbeatResponse> worker_response =
+                dispatcher_client_->WorkerHeartbeat(worker_request);
+            TF_ASSERT_OK(worker_response.status());
+            EXPECT_EQ(worker_response->new_tasks_size(), 1);
+
+            ClientHeartbeatRequest client_request;
+            client_request.set_iteration_client_id(iteration_client_id);
+            ClientHeartbeatResponse client_response;
+            TF_ASSERT_OK(dispatcher_client_->ClientHeartbeat(client_request,
+                                                             client_response));
+            EXPECT_EQ(client_response.task_info_size(), 1);
+            EXPECT_FALSE(client_response.iteration_finished());
+          }
+        })));
+  }
+}
+
 TEST_F(DispatcherClientTest, CreateNamedJob) {
   TF_ASSERT_OK(SetUpTfDataService(/*num_workers=*/1));
   DataServiceMetadata metadata = GetDefaultMetadata();
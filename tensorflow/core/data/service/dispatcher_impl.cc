@@ -104,6 +104,10 @@ constexpr absl::Duration kDefaultIterationGcCheckInterval = absl::Minutes(10);
 constexpr absl::Duration kDefaultIterationGcTimeout = absl::Minutes(5);
 constexpr absl::Duration kDefaultClientTimeout = absl::Minutes(5);
 constexpr absl::Duration kDefaultWorkerTimeout = absl::Minutes(10);
+constexpr double kDefaultWorkerScalingTolerance = 0.1;
+constexpr absl::Duration kDefaultWorkerScaleUpDelay = absl::Minutes(1);
+constexpr absl::Duration kDefaultWorkerScaleDownDelay = absl::Minutes(10);
+constexpr absl::Duration kDefaultWorkerDrainTimeout = absl::Minutes(30);
 
 constexpr std::array<const char*, 8> kNodeNameSharingOps = {
     "HashTable",
@@ -184,8 +188,34 @@ DispatcherConfig ApplyConfigDefaults(const DispatcherConfig& config) {
     new_config.set_worker_max_concurrent_snapshots(
         kDefaultWorkerMaxConcurrentSnapshots);
   }
+  if (new_config.worker_scaling_tolerance() == 0) {
+    new_config.set_worker_scaling_tolerance(kDefaultWorkerScalingTolerance);
+  }
+  if (new_config.worker_scale_up_delay_ms() == 0) {
+    new_config.set_worker_scale_up_delay_ms(
+        absl::ToInt64Milliseconds(kDefaultWorkerScaleUpDelay));
+  }
+  if (new_config.worker_scale_down_delay_ms() == 0) {
+    new_config.set_worker_scale_down_delay_ms(
+        absl::ToInt64Milliseconds(kDefaultWorkerScaleDownDelay));
+  }
+  if (new_config.worker_drain_timeout_ms() == 0) {
+    new_config.set_worker_drain_timeout_ms(
+        absl::ToInt64Milliseconds(kDefaultWorkerDrainTimeout));
+  }
   return new_config;
 }
+
+WorkerScalingController::Options WorkerScalingOptions(
+    const DispatcherConfig& config) {
+  WorkerScalingController::Options options;
+  options.tolerance = config.worker_scaling_tolerance();
+  options.scale_up_delay =
+      absl::Milliseconds(config.worker_scale_up_delay_ms());
+  options.scale_down_delay =
+      absl::Milliseconds(config.worker_scale_down_delay_ms());
+  return options;
+}
 }  // namespace
 
 DataServiceDispatcherImpl::DataServiceDispatcherImpl(
@@ -193,7 +223,8 @@ DataServiceDispatcherImpl::DataServiceDispatcherImpl(
     : config_(ApplyConfigDefaults(config)),
       env_(Env::Default()),
       snapshot_assignment_manager_(config_.worker_max_concurrent_snapshots()),
-      state_(config_) {
+      state_(config_),
+      worker_scaling_controller_(WorkerScalingOptions(config_)) {
   if (config_.work_dir().empty()) {
     dataset_store_ = std::make_unique<MemoryDatasetStore>();
   } else {
@@ -213,6 +244,15 @@ DataServiceDispatcherImpl::~DataServiceDispatcherImpl() {
 
 absl::Status DataServiceDispatcherImpl::Start() {
   mutex_lock l(mu_);
+  if (!config_.worker_scaler().empty()) {
+    if (config_.worker_addresses_size() > 0) {
+      return errors::InvalidArgument(
+          "worker_scaler is not supported if the dispatcher is configured "
+          "with a fixed list of worker_addresses.");
+    }
+    TF_RETURN_IF_ERROR(WorkerScaler::Build(config_.worker_scaler(), config_,
+                                           &worker_scaler_));
+  }
   if (config_.job_gc_timeout_ms() >= 0) {
     maintenance_thread_ = absl::WrapUnique(env_->StartThread(
         {}, "maintenance-thread", [&] { MaintenanceThread(); }));
@@ -259,6 +299,7 @@ absl::Status DataServiceDispatcherImpl::Start() {
           *iteration, split_providers_[iteration->iteration_id]));
     }
   }
+  mutex_lock heartbeats_lock(heartbeats_mu_);
   for (const auto& client_id : state_.ListActiveClientIds()) {
     // Conservatively pretend we just received a heartbeat from all clients, so
     // that we don't garbage collect iterations too early.
@@ -375,6 +416,9 @@ absl::Status DataServiceDispatcherImpl::FindNewTasks(
     assigned_iteration_ids.insert(task->iteration->iteration_id);
   }
   for (const auto& iteration : state_.ListIterations()) {
+    if (IsDraining(worker_address)) {
+      break;
+    }
     if (!assigned_iteration_ids.contains(iteration->iteration_id) &&
         iteration->IsRoundRobin() && !iteration->finished) {
       VLOG(1) << "Creating pending task for reconnected worker "
@@ -384,6 +428,13 @@ absl::Status DataServiceDispatcherImpl::FindNewTasks(
   }
   // Refresh assigned_tasks to include newly added pending tasks.
   TF_RETURN_IF_ERROR(state_.TasksForWorker(worker_address, assigned_tasks));
+  return AddNewTasks(current_tasks, assigned_tasks, response);
+}
+
+absl::Status DataServiceDispatcherImpl::AddNewTasks(
+    const absl::flat_hash_set<int64_t>& current_tasks,
+    const std::vector<std::shared_ptr<const Task>>& assigned_tasks,
+    WorkerHeartbeatResponse* response) const TF_SHARED_LOCKS_REQUIRED(mu_) {
   for (const auto& task : assigned_tasks) {
     if (current_tasks.contains(task->task_id)) {
       continue;
@@ -394,9 +445,29 @@ absl::Status DataServiceDispatcherImpl::FindNewTasks(
   return absl::OkStatus();
 }
 
+bool DataServiceDispatcherImpl::NeedsPendingTasks(
+    const std::string& worker_address,
+    const std::vector<std::shared_ptr<const Task>>& assigned_tasks) const
+    TF_SHARED_LOCKS_REQUIRED(mu_) {
+  if (IsDraining(worker_address)) {
+    return false;
+  }
+  absl::flat_hash_set<int64_t> assigned_iteration_ids;
+  for (const auto& task : assigned_tasks) {
+    assigned_iteration_ids.insert(task->iteration->iteration_id);
+  }
+  for (const auto& iteration : state_.ListIterations()) {
+    if (!assigned_iteration_ids.contains(iteration->iteration_id) &&
+        iteration->IsRoundRobin() && !iteration->finished) {
+      return true;
+    }
+  }
+  return false;
+}
+
 void DataServiceDispatcherImpl::ReportProcessingTimesFromActiveTasks(
     const std::vector<ActiveTask>& active_tasks,
-    const std::string& worker_address) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const std::string& worker_address) TF_SHARED_LOCKS_REQUIRED(mu_) {
   for (const ActiveTask& active_task : active_tasks) {
     const int64_t task_id = active_task.task_id();
     const double processing_time_nsec = active_task.processing_time_nsec();
@@ -430,10 +501,21 @@ absl::Status DataServiceDispatcherImpl::WorkerHeartbeat(
   VLOG(3) << "Received worker heartbeat request from worker "
           << request->worker_address();
   {
+    mutex_lock l(heartbeats_mu_);
+    latest_worker_heartbeats_time_[request->worker_address()] =
+        absl::FromUnixMicros(env_->NowMicros());
+  }
+  bool handled = false;
+  {
+    // Heartbeats from registered workers usually don't update the dispatcher
+    // state, so they are handled concurrently under a shared lock.
+    tf_shared_lock l(mu_);
+    TF_ASSIGN_OR_RETURN(handled,
+                        WorkerHeartbeatWithoutUpdates(*request, *response));
+  }
+  if (!handled) {
     mutex_lock l(mu_);
     const std::string& worker_address = request->worker_address();
-    latest_worker_heartbeats_time_[worker_address] =
-        absl::FromUnixMicros(env_->NowMicros());
     // Assigned tasks from the perspective of the dispatcher.
     std::vector<std::shared_ptr<const Task>> assigned_tasks;
     absl::Status s = state_.TasksForWorker(worker_address, assigned_tasks);
@@ -493,6 +575,31 @@ absl::Status DataServiceDispatcherImpl::WorkerHeartbeat(
   return absl::OkStatus();
 }
 
+absl::StatusOr<bool> DataServiceDispatcherImpl::WorkerHeartbeatWithoutUpdates(
+    const WorkerHeartbeatRequest& request, WorkerHeartbeatResponse& response)
+    TF_SHARED_LOCKS_REQUIRED(mu_) {
+  std::vector<std::shared_ptr<const Task>> assigned_tasks;
+  absl::Status s =
+      state_.TasksForWorker(request.worker_address(), assigned_tasks);
+  if (errors::IsNotFound(s)) {
+    return false;
+  }
+  TF_RETURN_IF_ERROR(s);
+  if (NeedsPendingTasks(request.worker_address(), assigned_tasks)) {
+    return false;
+  }
+  absl::flat_hash_set<int64_t> current_tasks;
+  current_tasks.insert(request.current_tasks().cbegin(),
+                       request.current_tasks().cend());
+  const std::vector<ActiveTask> active_tasks(request.active_tasks().begin(),
+                                             request.active_tasks().end());
+  ReportProcessingTimesFromActiveTasks(active_tasks, request.worker_address());
+  TF_RETURN_IF_ERROR(
+      FindTasksToDelete(current_tasks, assigned_tasks, &response));
+  TF_RETURN_IF_ERROR(AddNewTasks(current_tasks, assigned_tasks, &response));
+  return true;
+}
+
 absl::Status DataServiceDispatcherImpl::WorkerUpdate(
     const WorkerUpdateRequest* request, WorkerUpdateResponse* response) {
   TF_RETURN_IF_ERROR(CheckStarted());
@@ -934,6 +1041,7 @@ absl::Status DataServiceDispatcherImpl::AcquireIterationClientId(
   acquire_iteration_client->set_iteration_id(iteration->iteration_id);
   TF_RETURN_IF_ERROR(Apply(update));
   // Does not release clients before they start to read from the dataset.
+  mutex_lock l(heartbeats_mu_);
   latest_client_heartbeats_time_[iteration_client_id] = absl::InfiniteFuture();
   return absl::OkStatus();
 }
@@ -946,6 +1054,9 @@ absl::Status DataServiceDispatcherImpl::CreateTasksForIteration(
   tasks.clear();
   tasks.reserve(workers.size());
   for (const auto& worker : workers) {
+    if (IsDraining(worker->address)) {
+      continue;
+    }
     std::shared_ptr<const Task> task;
     TF_RETURN_IF_ERROR(CreateTask(iteration, worker->address, task));
     tasks.push_back(task);
@@ -1066,27 +1177,28 @@ absl::Status DataServiceDispatcherImpl::AssignTask(
 absl::Status DataServiceDispatcherImpl::ClientHeartbeat(
     const ClientHeartbeatRequest* request, ClientHeartbeatResponse* response) {
   TF_RETURN_IF_ERROR(CheckStarted());
-  mutex_lock l(mu_);
   VLOG(4) << "Received heartbeat from client id "
           << request->iteration_client_id();
-  latest_client_heartbeats_time_[request->iteration_client_id()] =
-      absl::FromUnixMicros(env_->NowMicros());
-  std::shared_ptr<const Iteration> iteration;
-  absl::Status s = state_.IterationForIterationClientId(
-      request->iteration_client_id(), iteration);
-  if (errors::IsNotFound(s) && !config_.fault_tolerant_mode()) {
-    return errors::NotFound(
-        "Unknown iteration client id ", request->iteration_client_id(),
-        ". The dispatcher is not configured to be fault tolerant, so this "
-        "could be caused by a dispatcher restart.");
+  {
+    mutex_lock l(heartbeats_mu_);
+    latest_client_heartbeats_time_[request->iteration_client_id()] =
+        absl::FromUnixMicros(env_->NowMicros());
   }
-  TF_RETURN_IF_ERROR(s);
-  if (iteration->garbage_collected) {
-    return errors::FailedPrecondition(
-        "The requested iteration has been garbage collected due to inactivity. "
-        "Consider configuring the dispatcher with a higher "
-        "`iteration_gc_timeout_ms`.");
+  {
+    // Only coordinated reads update the dispatcher state on heartbeats, so
+    // other heartbeats are handled concurrently under a shared lock.
+    tf_shared_lock l(mu_);
+    std::shared_ptr<const Iteration> iteration;
+    TF_RETURN_IF_ERROR(IterationForClientHeartbeat(*request, iteration));
+    if (iteration->pending_tasks.empty() &&
+        request->optional_current_round_case() !=
+            ClientHeartbeatRequest::kCurrentRound) {
+      return PopulateClientHeartbeatResponse(*request, *iteration, *response);
+    }
   }
+  mutex_lock l(mu_);
+  std::shared_ptr<const Iteration> iteration;
+  TF_RETURN_IF_ERROR(IterationForClientHeartbeat(*request, iteration));
   if (request->optional_current_round_case() ==
       ClientHeartbeatRequest::kCurrentRound) {
     round_robin_rounds_[request->iteration_client_id()] =
@@ -1131,43 +1243,71 @@ absl::Status DataServiceDispatcherImpl::ClientHeartbeat(
       TF_RETURN_IF_ERROR(Apply(update));
     }
   }
-  if (!iteration->pending_tasks.empty()) {
-    response->set_block_round(iteration->pending_tasks.front().target_round);
+  return PopulateClientHeartbeatResponse(*request, *iteration, *response);
+}
+
+absl::Status DataServiceDispatcherImpl::IterationForClientHeartbeat(
+    const ClientHeartbeatRequest& request,
+    std::shared_ptr<const Iteration>& iteration) const
+    TF_SHARED_LOCKS_REQUIRED(mu_) {
+  absl::Status s = state_.IterationForIterationClientId(
+      request.iteration_client_id(), iteration);
+  if (errors::IsNotFound(s) && !config_.fault_tolerant_mode()) {
+    return errors::NotFound(
+        "Unknown iteration client id ", request.iteration_client_id(),
+        ". The dispatcher is not configured to be fault tolerant, so this "
+        "could be caused by a dispatcher restart.");
+  }
+  TF_RETURN_IF_ERROR(s);
+  if (iteration->garbage_collected) {
+    return errors::FailedPrecondition(
+        "The requested iteration has been garbage collected due to inactivity. "
+        "Consider configuring the dispatcher with a higher "
+        "`iteration_gc_timeout_ms`.");
+  }
+  return absl::OkStatus();
+}
+
+absl::Status DataServiceDispatcherImpl::PopulateClientHeartbeatResponse(
+    const ClientHeartbeatRequest& request, const Iteration& iteration,
+    ClientHeartbeatResponse& response) TF_SHARED_LOCKS_REQUIRED(mu_) {
+  if (!iteration.pending_tasks.empty()) {
+    response.set_block_round(iteration.pending_tasks.front().target_round);
   }
 
   VLOG(3) << "Received target processing time for iteration "
-          << iteration->iteration_id << " from iteration_client_id "
-          << request->iteration_client_id() << ". Time in nanoseconds: "
-          << request->target_processing_time_nsec();
+          << iteration.iteration_id << " from iteration_client_id "
+          << request.iteration_client_id() << ". Time in nanoseconds: "
+          << request.target_processing_time_nsec();
   absl::Status auto_scaler_status = auto_scaler_.ReportTargetProcessingTime(
-      iteration->iteration_id, request->iteration_client_id(),
-      absl::Nanoseconds(request->target_processing_time_nsec()));
+      iteration.iteration_id, request.iteration_client_id(),
+      absl::Nanoseconds(request.target_processing_time_nsec()));
   if (!auto_scaler_status.ok()) {
     VLOG(1) << "Failed to report target processing time for Iteration "
-            << iteration->iteration_id << " and consumer ID "
-            << request->iteration_client_id()
+            << iteration.iteration_id << " and consumer ID "
+            << request.iteration_client_id()
             << " to tf.data service AutoScaler: " << auto_scaler_status;
   }
 
   std::vector<std::shared_ptr<const Task>> tasks;
-  TF_RETURN_IF_ERROR(state_.TasksForIteration(iteration->iteration_id, tasks));
+  TF_RETURN_IF_ERROR(state_.TasksForIteration(iteration.iteration_id, tasks));
   for (const auto& task : tasks) {
-    TaskInfo* task_info = response->mutable_task_info()->Add();
+    TaskInfo* task_info = response.mutable_task_info()->Add();
     task_info->set_worker_address(task->worker_address);
     *task_info->mutable_transfer_servers() = {task->transfer_servers.begin(),
                                               task->transfer_servers.end()};
     *task_info->mutable_worker_tags() = {task->worker_tags.begin(),
                                          task->worker_tags.end()};
     task_info->set_task_id(task->task_id);
-    task_info->set_iteration_id(iteration->iteration_id);
+    task_info->set_iteration_id(iteration.iteration_id);
     task_info->set_worker_uid(task->worker_uid);
     task_info->set_starting_round(task->starting_round);
   }
-  response->set_iteration_finished(iteration->finished);
-  response->set_deployment_mode(config_.deployment_mode());
-  VLOG(4) << "Found " << response->task_info_size()
+  response.set_iteration_finished(iteration.finished);
+  response.set_deployment_mode(config_.deployment_mode());
+  VLOG(4) << "Found " << response.task_info_size()
           << " tasks for iteration client id "
-          << request->iteration_client_id();
+          << request.iteration_client_id();
   return absl::OkStatus();
 }
 
@@ -1387,39 +1527,151 @@ absl::Status DataServiceDispatcherImpl::Apply(const Update& update)
 void DataServiceDispatcherImpl::MaintenanceThread() {
   int64_t next_check_micros = 0;
   while (true) {
-    mutex_lock l(mu_);
-    while (!cancelled_ && env_->NowMicros() < next_check_micros) {
-      int64_t remaining_micros = next_check_micros - env_->NowMicros();
-      maintenance_thread_cv_.wait_for(
-          l, std::chrono::microseconds(remaining_micros));
-    }
-    if (cancelled_) {
-      return;
-    }
+    WorkerScalingAction scaling_action;
     {
-      absl::Status s = ReleaseMissingClients();
-      if (!s.ok()) {
-        LOG(WARNING) << "Error releasing missing clients: " << s;
+      mutex_lock l(mu_);
+      while (!cancelled_ && env_->NowMicros() < next_check_micros) {
+        int64_t remaining_micros = next_check_micros - env_->NowMicros();
+        maintenance_thread_cv_.wait_for(
+            l, std::chrono::microseconds(remaining_micros));
+      }
+      if (cancelled_) {
+        return;
       }
+      {
+        absl::Status s = ReleaseMissingClients();
+        if (!s.ok()) {
+          LOG(WARNING) << "Error releasing missing clients: " << s;
+        }
+      }
+      {
+        absl::Status s = auto_scaler_.UpdateOptimalNumberOfWorkersMetric(
+            state_.GetNumberOfRegisteredWorkers());
+        if (!s.ok()) {
+          VLOG(1) << "Error updating the optimal number of workers metric "
+                     "in tf.data service AutoScaler: "
+                  << s;
+        }
+      }
+      {
+        absl::Status s = GcOldIterations();
+        if (!s.ok()) {
+          LOG(WARNING) << "Error garbage collecting old iterations: " << s;
+        }
+      }
+      DetectMissingWorkers();
+      if (worker_scaler_) {
+        scaling_action = ScaleWorkers();
+      }
+      next_check_micros =
+          env_->NowMicros() + (config_.job_gc_check_interval_ms() * 1000);
     }
-    {
-      absl::Status s = auto_scaler_.UpdateOptimalNumberOfWorkersMetric(
-          state_.GetNumberOfRegisteredWorkers());
-      if (!s.ok()) {
-        VLOG(1) << "Error updating the optimal number of workers metric "
-                   "in tf.data service AutoScaler: "
-                << s;
+    // The scaler may block on a cluster manager, so it is called without
+    // holding `mu_`.
+    ActuateWorkerScaling(scaling_action);
+  }
+}
+
+bool DataServiceDispatcherImpl::IsDraining(
+    const std::string& worker_address) const TF_SHARED_LOCKS_REQUIRED(mu_) {
+  return draining_workers_.contains(worker_address);
+}
+
+int64_t DataServiceDispatcherImpl::NumUnfinishedTasks(
+    const std::string& worker_address) const TF_SHARED_LOCKS_REQUIRED(mu_) {
+  std::vector<std::shared_ptr<const Task>> tasks;
+  if (!state_.TasksForWorker(worker_address, tasks).ok()) {
+    return 0;
+  }
+  int64_t num_unfinished_tasks = 0;
+  for (const auto& task : tasks) {
+    if (!task->finished && !task->removed && !task->iteration->finished) {
+      ++num_unfinished_tasks;
+    }
+  }
+  return num_unfinished_tasks;
+}
+
+DataServiceDispatcherImpl::WorkerScalingAction
+DataServiceDispatcherImpl::ScaleWorkers() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  WorkerScalingAction action;
+  const absl::Time now = absl::FromUnixMicros(env_->NowMicros());
+  for (auto& [address, draining_worker] : draining_workers_) {
+    if (draining_worker.released) {
+      continue;
+    }
+    if (NumUnfinishedTasks(address) == 0 ||
+        now > draining_worker.drain_start_time +
+                  absl::Milliseconds(config_.worker_drain_timeout_ms())) {
+      LOG(INFO) << "Releasing drained tf.data service worker " << address;
+      draining_worker.released = true;
+      action.workers_to_release.push_back(address);
+    }
+  }
+
+  std::vector<std::string> live_workers;
+  {
+    mutex_lock l(heartbeats_mu_);
+    for (const auto& [address, unused] : latest_worker_heartbeats_time_) {
+      if (!IsDraining(address)) {
+        live_workers.push_back(address);
       }
     }
-    {
-      absl::Status s = GcOldIterations();
-      if (!s.ok()) {
-        LOG(WARNING) << "Error garbage collecting old iterations: " << s;
+  }
+  const int64_t num_workers = live_workers.size();
+  std::optional<int64_t> target_num_workers = worker_scaling_controller_.Update(
+      num_workers, auto_scaler_.GetOptimalNumberOfWorkers(), now);
+  if (!target_num_workers.has_value()) {
+    return action;
+  }
+
+  if (*target_num_workers > num_workers) {
+    int64_t num_workers_to_add = *target_num_workers - num_workers;
+    // Prefer workers that are still draining, which are ready to take tasks.
+    for (auto it = draining_workers_.begin();
+         it != draining_workers_.end() && num_workers_to_add > 0;) {
+      if (it->second.released) {
+        ++it;
+        continue;
       }
+      LOG(INFO) << "Undraining tf.data service worker " << it->first;
+      draining_workers_.erase(it++);
+      --num_workers_to_add;
+    }
+    action.num_workers_to_add = num_workers_to_add;
+    return action;
+  }
+
+  // Drain the workers with the fewest unfinished tasks, which finish first.
+  std::vector<std::pair<int64_t, std::string>> candidates;
+  for (const std::string& address : live_workers) {
+    candidates.push_back({NumUnfinishedTasks(address), address});
+  }
+  std::sort(candidates.begin(), candidates.end());
+  const int64_t num_workers_to_drain = num_workers - *target_num_workers;
+  for (int64_t i = 0;
+       i < num_workers_to_drain && i < static_cast<int64_t>(candidates.size());
+       ++i) {
+    LOG(INFO) << "Draining tf.data service worker " << candidates[i].second;
+    draining_workers_[candidates[i].second] = DrainingWorker{now};
+  }
+  return action;
+}
+
+void DataServiceDispatcherImpl::ActuateWorkerScaling(
+    const WorkerScalingAction& action) TF_LOCKS_EXCLUDED(mu_) {
+  if (action.num_workers_to_add > 0) {
+    absl::Status s = worker_scaler_->AddWorkers(action.num_workers_to_add);
+    if (!s.ok()) {
+      LOG(WARNING) << "Error adding " << action.num_workers_to_add
+                   << " tf.data service workers: " << s;
+    }
+  }
+  if (!action.workers_to_release.empty()) {
+    absl::Status s = worker_scaler_->ReleaseWorkers(action.workers_to_release);
+    if (!s.ok()) {
+      LOG(WARNING) << "Error releasing tf.data service workers: " << s;
     }
-    DetectMissingWorkers();
-    next_check_micros =
-        env_->NowMicros() + (config_.job_gc_check_interval_ms() * 1000);
   }
 }
 
@@ -1445,8 +1697,13 @@ absl::Status DataServiceDispatcherImpl::ReleaseMissingClients()
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   int64_t now = env_->NowMicros();
   for (const auto& client_id : state_.ListActiveClientIds()) {
+    absl::Time latest_heartbeat_time;
+    {
+      mutex_lock l(heartbeats_mu_);
+      latest_heartbeat_time = latest_client_heartbeats_time_[client_id];
+    }
     if (absl::FromUnixMicros(now) >
-        latest_client_heartbeats_time_[client_id] +
+        latest_heartbeat_time +
             absl::Milliseconds(config_.client_timeout_ms())) {
       LOG(INFO) << "Releasing timed-out client with id " << client_id;
       RemoveClientFromAutoScaler(client_id);
@@ -1488,12 +1745,14 @@ void DataServiceDispatcherImpl::RemoveWorkerFromAutoScaler(
 void DataServiceDispatcherImpl::DetectMissingWorkers()
     TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
   int64_t now = env_->NowMicros();
+  mutex_lock l(heartbeats_mu_);
   for (auto it = latest_worker_heartbeats_time_.begin();
        it != latest_worker_heartbeats_time_.end();) {
     if (absl::FromUnixMicros(now) >
         it->second + absl::Milliseconds(config_.worker_timeout_ms())) {
       LOG(INFO) << "Lost worker " << it->first << " due to timeout";
       RemoveWorkerFromAutoScaler(it->first);
+      draining_workers_.erase(it->first);
 
       latest_worker_heartbeats_time_.erase(it++);
     } else {
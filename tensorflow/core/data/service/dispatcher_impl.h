@@ -35,6 +35,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/snapshot/snapshot_manager.h"
 #include "tensorflow/core/data/service/task_remover.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
+#include "tensorflow/core/data/service/worker_scaler.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/macros.h"
@@ -258,10 +259,40 @@ class DataServiceDispatcherImpl {
       const absl::flat_hash_set<int64_t>& current_tasks,
       std::vector<std::shared_ptr<const DispatcherState::Task>>& assigned_tasks,
       WorkerHeartbeatResponse* response);
+  // Adds the tasks in `assigned_tasks` that are not in `current_tasks` to the
+  // heartbeat response.
+  absl::Status AddNewTasks(
+      const absl::flat_hash_set<int64_t>& current_tasks,
+      const std::vector<std::shared_ptr<const DispatcherState::Task>>&
+          assigned_tasks,
+      WorkerHeartbeatResponse* response) const TF_SHARED_LOCKS_REQUIRED(mu_);
+  // Returns true if `FindNewTasks` needs to create pending tasks for a worker
+  // with `assigned_tasks`.
+  bool NeedsPendingTasks(
+      const std::string& worker_address,
+      const std::vector<std::shared_ptr<const DispatcherState::Task>>&
+          assigned_tasks) const TF_SHARED_LOCKS_REQUIRED(mu_);
+  // Handles a heartbeat from a registered worker if it does not need to update
+  // the dispatcher state. Returns false if the heartbeat must be handled under
+  // an exclusive lock instead.
+  absl::StatusOr<bool> WorkerHeartbeatWithoutUpdates(
+      const WorkerHeartbeatRequest& request, WorkerHeartbeatResponse& response)
+      TF_SHARED_LOCKS_REQUIRED(mu_);
   // Reports the processing time of each active task to `auto_scaler_`.
   void ReportProcessingTimesFromActiveTasks(
       const std::vector<ActiveTask>& active_tasks,
-      const std::string& worker_address) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+      const std::string& worker_address) TF_SHARED_LOCKS_REQUIRED(mu_);
+  // Looks up the iteration read by the client sending `request`.
+  absl::Status IterationForClientHeartbeat(
+      const ClientHeartbeatRequest& request,
+      std::shared_ptr<const DispatcherState::Iteration>& iteration) const
+      TF_SHARED_LOCKS_REQUIRED(mu_);
+  // Fills out the parts of a client heartbeat response that do not depend on
+  // round-robin coordination.
+  absl::Status PopulateClientHeartbeatResponse(
+      const ClientHeartbeatRequest& request,
+      const DispatcherState::Iteration& iteration,
+      ClientHeartbeatResponse& response) TF_SHARED_LOCKS_REQUIRED(mu_);
   // Acquires an iteration client id to read from the given iteration and sets
   // `iteration_client_id`.
   absl::Status AcquireIterationClientId(
@@ -310,7 +341,7 @@ class DataServiceDispatcherImpl {
   // Fills out a TaskDef with information about a task.
   absl::Status PopulateTaskDef(
       std::shared_ptr<const DispatcherState::Task> task,
-      TaskDef* task_def) const TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+      TaskDef* task_def) const TF_SHARED_LOCKS_REQUIRED(mu_);
   // Checks that the dispatcher has started, returning UNAVAILABLE if it hasn't.
   absl::Status CheckStarted() TF_LOCKS_EXCLUDED(mu_);
   // Restores ongoing tf.data snapshots.
@@ -337,6 +368,25 @@ class DataServiceDispatcherImpl {
   // Checks for workers that haven't heartbeated recently and alerts the
   // snapshot managers.
   void DetectMissingWorkers() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Workers to add or release, decided by `ScaleWorkers`.
+  struct WorkerScalingAction {
+    int64_t num_workers_to_add = 0;
+    std::vector<std::string> workers_to_release;
+  };
+  // Decides whether to add or drain workers based on the optimal number of
+  // workers estimated by `auto_scaler_`, and finds drained workers which can be
+  // released. The returned action is carried out by `ActuateWorkerScaling`.
+  WorkerScalingAction ScaleWorkers() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Calls `worker_scaler_` to carry out `action`.
+  void ActuateWorkerScaling(const WorkerScalingAction& action)
+      TF_LOCKS_EXCLUDED(mu_);
+  // Returns true if the worker is being drained, in which case it is not
+  // assigned new tasks.
+  bool IsDraining(const std::string& worker_address) const
+      TF_SHARED_LOCKS_REQUIRED(mu_);
+  // Returns the number of tasks of unfinished iterations on the worker.
+  int64_t NumUnfinishedTasks(const std::string& worker_address) const
+      TF_SHARED_LOCKS_REQUIRED(mu_);
   // Scans for old iterations and marks them as finished.
   absl::Status GcOldIterations() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   // Returns true if an iteration should be garbage collected.
@@ -378,12 +428,15 @@ class DataServiceDispatcherImpl {
   // Map from task id to a TaskRemover which determines when to remove the task.
   absl::flat_hash_map<int64_t, std::shared_ptr<TaskRemover>>
       remove_task_requests_ TF_GUARDED_BY(mu_);
+  // Guards the heartbeat times, so that heartbeats which don't update the
+  // dispatcher state only need a shared lock on `mu_`.
+  mutex heartbeats_mu_ TF_ACQUIRED_AFTER(mu_);
   // Map from client id to the time of the client's last heartbeat.
   absl::flat_hash_map<int64_t, absl::Time> latest_client_heartbeats_time_
-      TF_GUARDED_BY(mu_);
+      TF_GUARDED_BY(heartbeats_mu_);
   // Map from worker address to the time of the worker's last heartbeat.
   absl::flat_hash_map<std::string, absl::Time> latest_worker_heartbeats_time_
-      TF_GUARDED_BY(mu_);
+      TF_GUARDED_BY(heartbeats_mu_);
 
   // TODO(mpcallanan): Don't recover completed snapshots.
   // TODO(mpcallanan): Garbage collect completed snapshots.
@@ -402,6 +455,19 @@ class DataServiceDispatcherImpl {
   std::unique_ptr<Thread> maintenance_thread_;
   MultipleIterationsAutoScaler auto_scaler_;
 
+  // Set if `config_.worker_scaler` is configured.
+  std::unique_ptr<WorkerScaler> worker_scaler_;
+  WorkerScalingController worker_scaling_controller_ TF_GUARDED_BY(mu_);
+  // A worker being drained, which is not assigned new tasks.
+  struct DrainingWorker {
+    absl::Time drain_start_time;
+    // True once the worker has been passed to `worker_scaler_` for release.
+    bool released = false;
+  };
+  // Map from worker address to draining worker.
+  absl::flat_hash_map<std::string, DrainingWorker> draining_workers_
+      TF_GUARDED_BY(mu_);
+
   DataServiceDispatcherImpl(const DataServiceDispatcherImpl&) = delete;
   void operator=(const DataServiceDispatcherImpl&) = delete;
 };
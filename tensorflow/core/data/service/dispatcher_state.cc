@@ -394,12 +394,14 @@ int64_t DispatcherState::NextAvailableIterationId() const {
 }
 
 absl::Status DispatcherState::IterationForIterationClientId(
-    int64_t iteration_client_id, std::shared_ptr<const Iteration>& iteration) {
-  iteration = iterations_for_client_ids_[iteration_client_id];
-  if (!iteration) {
+    int64_t iteration_client_id,
+    std::shared_ptr<const Iteration>& iteration) const {
+  auto it = iterations_for_client_ids_.find(iteration_client_id);
+  if (it == iterations_for_client_ids_.end() || !it->second) {
     return errors::NotFound("Iteration client id not found: ",
                             iteration_client_id);
   }
+  iteration = it->second;
   return absl::OkStatus();
 }
 
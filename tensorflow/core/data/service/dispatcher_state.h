@@ -261,7 +261,8 @@ class DispatcherState {
   // Returns NOT_FOUND if the iteration_client_id is unknown or has been
   // released.
   absl::Status IterationForIterationClientId(
-      int64_t iteration_client_id, std::shared_ptr<const Iteration>& iteration);
+      int64_t iteration_client_id,
+      std::shared_ptr<const Iteration>& iteration) const;
   // Returns a list of all active client ids.
   std::vector<int64_t> ListActiveClientIds();
   // Returns the next available iteration client id.
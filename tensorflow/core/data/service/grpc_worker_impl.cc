@@ -15,12 +15,15 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/grpc_worker_impl.h"
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "grpcpp/server_builder.h"
 #include "grpcpp/server_context.h"
+#include "grpcpp/support/status.h"
+#include "grpcpp/support/sync_stream.h"
 #include "tensorflow/core/data/service/export.pb.h"
 #include "tensorflow/core/data/service/worker_impl.h"
 #include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
@@ -71,5 +74,41 @@ HANDLER(GetWorkerTasks);
 HANDLER(GetSnapshotTaskProgresses);
 #undef HANDLER
 
+::grpc::Status GrpcWorkerImpl::StreamElements(
+    ServerContext* context,
+    ::grpc::ServerReaderWriter<GetElementResponse, StreamElementsRequest>*
+        stream) {
+  StreamElementsRequest request;
+  while (stream->Read(&request)) {
+    if (request.element_request().optional_round_index_case() ==
+        GetElementRequest::kRoundIndex) {
+      return ToGrpcStatus(errors::InvalidArgument(
+          "Round-robin reads can not be streamed. Got request for task ",
+          request.element_request().task_id()));
+    }
+    for (int64_t i = 0; i < request.num_elements(); ++i) {
+      if (context->IsCancelled()) {
+        return ::grpc::Status(::grpc::StatusCode::CANCELLED,
+                              "Element stream was cancelled.");
+      }
+      GetElementResponse response;
+      absl::Status s = impl_->GetElement(&request.element_request(), &response);
+      if (!s.ok()) {
+        return ToGrpcStatus(s);
+      }
+      const bool end_of_window =
+          response.end_of_sequence() || response.skip_task();
+      if (!stream->Write(response)) {
+        return ::grpc::Status(::grpc::StatusCode::CANCELLED,
+                              "Element stream was closed by the client.");
+      }
+      if (end_of_window) {
+        break;
+      }
+    }
+  }
+  return ::grpc::Status::OK;
+}
+
 }  // namespace data
 }  // namespace tensorflow
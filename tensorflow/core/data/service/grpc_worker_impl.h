@@ -22,6 +22,7 @@ limitations under the License.
 #include <vector>
 
 #include "grpcpp/server_builder.h"
+#include "grpcpp/support/sync_stream.h"
 #include "tensorflow/core/data/service/export.pb.h"
 #include "tensorflow/core/data/service/worker.grpc.pb.h"
 #include "tensorflow/core/data/service/worker.pb.h"
@@ -65,6 +66,11 @@ class GrpcWorkerImpl : public WorkerService::Service {
   HANDLER(GetSnapshotTaskProgresses);
 #undef HANDLER
 
+  ::grpc::Status StreamElements(
+      ::grpc::ServerContext* context,
+      ::grpc::ServerReaderWriter<GetElementResponse, StreamElementsRequest>*
+          stream) override;
+
  private:
   std::string worker_address_;
   // A std::shared_ptr allows clients to access local servers and directly call
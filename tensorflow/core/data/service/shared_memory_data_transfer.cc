@@ -0,0 +1,431 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shared_memory_data_transfer.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "grpcpp/client_context.h"
+#include "grpcpp/create_channel.h"
+#include "grpcpp/security/credentials.h"
+#include "grpcpp/security/server_credentials.h"
+#include "grpcpp/server.h"
+#include "grpcpp/server_builder.h"
+#include "grpcpp/server_context.h"
+#include "grpcpp/support/channel_arguments.h"
+#include "grpcpp/support/status.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/grpc_util.h"
+#include "tensorflow/core/data/service/worker.grpc.pb.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/dataset.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/variant.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/file_system.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/random.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
+#include "tsl/platform/errors.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+constexpr char kSharedMemoryDir[] = "/dev/shm";
+constexpr char kSharedMemoryBufferName[] = "SharedMemoryTransfer";
+// Smaller elements are sent inline, because creating, mapping and deleting a
+// file costs more than serializing them.
+constexpr uint64 kMinSharedMemoryElementBytes = 64 << 10;  // 64KB
+// Component buffers are aligned in the file like allocated tensors.
+constexpr uint64 kComponentAlignment = Allocator::kAllocatorAlignment;
+
+// Returns true if the buffers of `components` can be written to shared memory.
+bool CanUseSharedMemory(const std::vector<Tensor>& components) {
+  uint64 total_bytes = 0;
+  for (const Tensor& component : components) {
+    if (!DataTypeCanUseMemcpy(component.dtype())) {
+      return false;
+    }
+    total_bytes += component.TotalBytes();
+  }
+  return total_bytes >= kMinSharedMemoryElementBytes;
+}
+
+// Moves `components` into `response`, like the gRPC transfer protocol does.
+absl::Status MoveElementToResponse(std::vector<Tensor>&& components,
+                                   GetElementResponse& response) {
+  if (components.size() != 1 || components[0].dtype() != DT_VARIANT ||
+      !TensorShapeUtils::IsScalar(components[0].shape())) {
+    for (const Tensor& component : components) {
+      component.AsProtoTensorContent(
+          response.mutable_uncompressed()->add_components());
+    }
+    return absl::OkStatus();
+  }
+  CompressedElement* compressed =
+      components[0].scalar<Variant>()().get<CompressedElement>();
+  if (compressed == nullptr) {
+    return errors::FailedPrecondition(
+        "Expected dataset to produce a CompressedElement variant tensor, but "
+        "it produced ",
+        components[0].scalar<Variant>()().TypeName());
+  }
+  *response.mutable_compressed() = std::move(*compressed);
+  return absl::OkStatus();
+}
+
+// A tensor buffer referencing a component buffer in a mapped shared memory
+// file. The mapping is released with the last tensor referencing it.
+class SharedMemoryBuffer : public TensorBuffer {
+ public:
+  SharedMemoryBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name(kSharedMemoryBufferName);
+  }
+  // The mapping is read-only, so the buffer must never be forwarded to an
+  // output that is modified in place.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
+// Serves GetElement requests, writing large elements to shared memory files
+// whose names start with `file_prefix`.
+class SharedMemoryElementService : public WorkerService::Service {
+ public:
+  SharedMemoryElementService(DataTransferServer::GetElementT get_element,
+                             std::string file_prefix)
+      : get_element_(std::move(get_element)),
+        file_prefix_(std::move(file_prefix)) {}
+
+  ::grpc::Status GetElement(::grpc::ServerContext* context,
+                            const GetElementRequest* request,
+                            GetElementResponse* response) override {
+    return ToGrpcStatus(GetElementInternal(*request, *response));
+  }
+
+ private:
+  absl::Status GetElementInternal(const GetElementRequest& request,
+                                  GetElementResponse& response) {
+    GetElementResult result;
+    TF_RETURN_IF_ERROR(get_element_(&request, &result));
+    response.set_element_index(result.element_index);
+    response.set_end_of_sequence(result.end_of_sequence);
+    response.set_skip_task(result.skip);
+    if (result.end_of_sequence || result.skip) {
+      return absl::OkStatus();
+    }
+    if (CanUseSharedMemory(result.components)) {
+      return WriteSharedMemoryElement(result.components,
+                                      *response.mutable_shared_memory());
+    }
+    return MoveElementToResponse(std::move(result.components), response);
+  }
+
+  absl::Status WriteSharedMemoryElement(const std::vector<Tensor>& components,
+                                        SharedMemoryElement& element) {
+    Env* env = Env::Default();
+    const std::string path = absl::StrCat(file_prefix_, "_", next_file_id_++);
+    std::unique_ptr<WritableFile> file;
+    TF_RETURN_IF_ERROR(env->NewWritableFile(path, &file));
+    auto delete_file = gtl::MakeCleanup(
+        [env, &path] { env->DeleteFile(path).IgnoreError(); });
+    static constexpr char kPadding[kComponentAlignment] = {};
+    uint64 offset = 0;
+    for (const Tensor& component : components) {
+      const uint64 padding =
+          (kComponentAlignment - offset % kComponentAlignment) %
+          kComponentAlignment;
+      TF_RETURN_IF_ERROR(file->Append(absl::string_view(kPadding, padding)));
+      offset += padding;
+      const absl::string_view data = component.tensor_data();
+      SharedMemoryElement::Component* metadata = element.add_components();
+      metadata->set_dtype(component.dtype());
+      component.shape().AsProto(metadata->mutable_shape());
+      metadata->set_offset(offset);
+      metadata->set_size(data.size());
+      TF_RETURN_IF_ERROR(file->Append(data));
+      offset += data.size();
+    }
+    TF_RETURN_IF_ERROR(file->Close());
+    element.set_path(path);
+    // From here on, the client is responsible for deleting the file.
+    delete_file.release();
+    return absl::OkStatus();
+  }
+
+  const DataTransferServer::GetElementT get_element_;
+  const std::string file_prefix_;
+  std::atomic<int64_t> next_file_id_ = 0;
+};
+
+class SharedMemoryTransferServer : public DataTransferServer {
+ public:
+  explicit SharedMemoryTransferServer(GetElementT get_element)
+      : get_element_(std::move(get_element)) {}
+
+  ~SharedMemoryTransferServer() override {
+    if (server_) {
+      server_->Shutdown();
+    }
+    if (!probe_path_.empty()) {
+      Env::Default()->DeleteFile(probe_path_).IgnoreError();
+    }
+  }
+
+  absl::Status Start(const experimental::WorkerConfig& config) override {
+    Env* env = Env::Default();
+    TF_RETURN_WITH_CONTEXT_IF_ERROR(env->IsDirectory(kSharedMemoryDir),
+                                    "shared memory is not available");
+    const std::string file_prefix = io::JoinPath(
+        kSharedMemoryDir, absl::StrCat("tf_data_service_", random::New64()));
+    probe_path_ = absl::StrCat(file_prefix, "_probe");
+    probe_token_ = absl::StrCat(random::New64());
+    TF_RETURN_IF_ERROR(WriteStringToFile(env, probe_path_, probe_token_));
+
+    service_ = std::make_unique<SharedMemoryElementService>(get_element_,
+                                                            file_prefix);
+    ::grpc::ServerBuilder builder;
+    // Clients share memory with the worker, so they are on the same host.
+    builder.AddListeningPort(
+        absl::StrCat("localhost:", config.data_transfer_port()),
+        ::grpc::InsecureServerCredentials(), &port_);
+    builder.RegisterService(service_.get());
+    server_ = builder.BuildAndStart();
+    if (!server_) {
+      return errors::Unavailable(
+          "Failed to start the shared memory data transfer server on port ",
+          config.data_transfer_port());
+    }
+    return absl::OkStatus();
+  }
+
+  int Port() const override { return port_; }
+
+  absl::StatusOr<std::string> GetCompatibilityInfo() const override {
+    return absl::StrCat(probe_path_, "\n", probe_token_);
+  }
+
+ private:
+  const GetElementT get_element_;
+  std::string probe_path_;
+  std::string probe_token_;
+  std::unique_ptr<SharedMemoryElementService> service_;
+  std::unique_ptr<::grpc::Server> server_;
+  int port_ = 0;
+};
+
+class SharedMemoryTransferClient : public DataTransferClient {
+ public:
+  SharedMemoryTransferClient(const std::string& address, Allocator* allocator)
+      : allocator_(allocator) {
+    VLOG(2) << "Create SharedMemoryTransferClient for worker " << address
+            << ".";
+    ::grpc::ChannelArguments args;
+    args.SetMaxReceiveMessageSize(-1);
+    stub_ = WorkerService::NewStub(::grpc::CreateCustomChannel(
+        address, ::grpc::InsecureChannelCredentials(), args));
+  }
+
+  absl::Status GetElement(const GetElementRequest& req,
+                          GetElementResult& result) override {
+    ::grpc::ClientContext ctx;
+    {
+      mutex_lock l(mu_);
+      if (cancelled_) {
+        return errors::Cancelled("Client was cancelled.");
+      }
+      active_contexts_.insert(&ctx);
+    }
+    auto cleanup = gtl::MakeCleanup([this, &ctx] {
+      mutex_lock l(mu_);
+      active_contexts_.erase(&ctx);
+    });
+    GetElementResponse resp;
+    ::grpc::Status s = stub_->GetElement(&ctx, req, &resp);
+    if (!s.ok()) {
+      return grpc_util::WrapError("Failed to get element", s);
+    }
+    result.element_index = resp.element_index();
+    result.end_of_sequence = resp.end_of_sequence();
+    result.skip = resp.skip_task();
+    switch (resp.element_case()) {
+      case GetElementResponse::kSharedMemory:
+        return ReadSharedMemoryElement(resp.shared_memory(), result);
+      case GetElementResponse::kCompressed: {
+        Tensor tensor(DT_VARIANT, TensorShape{});
+        tensor.scalar<Variant>()() = std::move(*resp.mutable_compressed());
+        result.components.push_back(std::move(tensor));
+        break;
+      }
+      case GetElementResponse::kUncompressed:
+        for (const auto& component : resp.uncompressed().components()) {
+          result.components.emplace_back();
+          bool success =
+              allocator_ != nullptr
+                  ? result.components.back().FromProto(allocator_, component)
+                  : result.components.back().FromProto(component);
+          if (!success) {
+            return errors::Internal("Failed to parse tensor.");
+          }
+        }
+        break;
+      case GetElementResponse::ELEMENT_NOT_SET:
+        break;
+    }
+    return absl::OkStatus();
+  }
+
+  void TryCancel() override {
+    VLOG(2) << "Cancel SharedMemoryTransferClient.";
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    for (const auto& ctx : active_contexts_) {
+      ctx->TryCancel();
+    }
+  }
+
+  absl::Status CheckCompatibility(
+      const std::string& server_compatibility_info) const override {
+    std::vector<std::string> probe =
+        absl::StrSplit(server_compatibility_info, '\n');
+    if (probe.size() != 2) {
+      return errors::InvalidArgument(
+          "Invalid shared memory transfer compatibility info: ",
+          server_compatibility_info);
+    }
+    std::string token;
+    absl::Status s = ReadFileToString(env_, probe[0], &token);
+    if (!s.ok() || token != probe[1]) {
+      return errors::FailedPrecondition(
+          "The tf.data service worker does not share memory with this client; "
+          "could not read the probe file ",
+          probe[0], ": ", s);
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  // Maps the file of `element` and deletes it. Unless an allocator was
+  // specified, the components reference the mapping instead of copying it.
+  absl::Status ReadSharedMemoryElement(const SharedMemoryElement& element,
+                                       GetElementResult& result) {
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    absl::Status s =
+        env_->NewReadOnlyMemoryRegionFromFile(element.path(), &region);
+    // The mapping stays valid after the file is deleted.
+    TF_RETURN_IF_ERROR(env_->DeleteFile(element.path()));
+    TF_RETURN_IF_ERROR(s);
+    std::shared_ptr<ReadOnlyMemoryRegion> shared_region = std::move(region);
+    const char* base = static_cast<const char*>(shared_region->data());
+    for (const SharedMemoryElement::Component& component :
+         element.components()) {
+      TensorShape shape;
+      TF_RETURN_IF_ERROR(
+          TensorShape::BuildTensorShape(component.shape(), &shape));
+      if (!DataTypeCanUseMemcpy(component.dtype()) ||
+          component.size() !=
+              shape.num_elements() * DataTypeSize(component.dtype()) ||
+          component.offset() > shared_region->length() ||
+          component.size() > shared_region->length() - component.offset()) {
+        return errors::DataLoss("Invalid component in shared memory file ",
+                                element.path());
+      }
+      const char* data = base + component.offset();
+      if (allocator_ != nullptr) {
+        Tensor tensor(allocator_, component.dtype(), shape);
+        std::memcpy(const_cast<char*>(tensor.tensor_data().data()), data,
+                    component.size());
+        result.components.push_back(std::move(tensor));
+        continue;
+      }
+      auto* buffer =
+          new SharedMemoryBuffer(shared_region, data, component.size());
+      result.components.emplace_back(component.dtype(), shape, buffer);
+      buffer->Unref();
+    }
+    return absl::OkStatus();
+  }
+
+  Allocator* const allocator_;
+  std::unique_ptr<WorkerService::Stub> stub_;
+  mutex mu_;
+  // Set of all currently active clients contexts. Used to support
+  // cancellation.
+  absl::flat_hash_set<::grpc::ClientContext*> active_contexts_
+      TF_GUARDED_BY(mu_);
+  // Indicates that the client has been cancelled, so no further requests should
+  // be accepted.
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+};
+
+class SharedMemoryTransferRegistrar {
+ public:
+  SharedMemoryTransferRegistrar() {
+    DataTransferServer::Register(
+        kSharedMemoryTransferProtocol,
+        [](DataTransferServer::GetElementT get_element,
+           std::shared_ptr<DataTransferServer>* server) {
+          *server = std::make_shared<SharedMemoryTransferServer>(
+              std::move(get_element));
+          return absl::OkStatus();
+        });
+    DataTransferClient::Register(
+        kSharedMemoryTransferProtocol,
+        [](DataTransferClient::Config config,
+           std::unique_ptr<DataTransferClient>* client) {
+          *client = std::make_unique<SharedMemoryTransferClient>(
+              config.address, config.allocator);
+          return absl::OkStatus();
+        });
+  }
+};
+static SharedMemoryTransferRegistrar shared_memory_transfer_registrar;
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -0,0 +1,34 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_SHARED_MEMORY_DATA_TRANSFER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_SHARED_MEMORY_DATA_TRANSFER_H_
+
+namespace tensorflow {
+namespace data {
+
+// Data transfer protocol for tf.data service workers and clients on the same
+// host. Requests go over a gRPC server bound to localhost, while the buffers
+// of large elements are handed over through files in /dev/shm, which the
+// client maps into its tensors without copying or deserializing them.
+//
+// The worker's compatibility info names a probe file in /dev/shm, so clients
+// that do not share memory with the worker fail `CheckCompatibility` and fall
+// back to gRPC.
+constexpr const char kSharedMemoryTransferProtocol[] = "shm";
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_SHARED_MEMORY_DATA_TRANSFER_H_
@@ -0,0 +1,111 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/shared_memory_data_transfer.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/data/service/data_transfer.h"
+#include "tensorflow/core/data/service/worker.pb.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/status_matchers.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::testing::HasSubstr;
+using ::tensorflow::testing::StatusIs;
+
+class SharedMemoryDataTransferTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    if (!Env::Default()->IsDirectory("/dev/shm").ok()) {
+      GTEST_SKIP() << "Shared memory is not available.";
+    }
+  }
+
+  // Starts a server producing `element`, and connects a client to it.
+  void Start(std::vector<Tensor> element) {
+    auto get_element = [element](const GetElementRequest* request,
+                                 GetElementResult* result) {
+      result->components = element;
+      result->element_index = request->task_id();
+      return absl::OkStatus();
+    };
+    TF_ASSERT_OK(DataTransferServer::Build(kSharedMemoryTransferProtocol,
+                                           get_element, &server_));
+    TF_ASSERT_OK(server_->Start(experimental::WorkerConfig()));
+    TF_ASSERT_OK(DataTransferClient::Build(
+        kSharedMemoryTransferProtocol,
+        {kSharedMemoryTransferProtocol,
+         absl::StrCat("localhost:", server_->Port())},
+        &client_));
+    TF_ASSERT_OK_AND_ASSIGN(std::string info, server_->GetCompatibilityInfo());
+    TF_ASSERT_OK(client_->CheckCompatibility(info));
+  }
+
+  std::shared_ptr<DataTransferServer> server_;
+  std::unique_ptr<DataTransferClient> client_;
+};
+
+TEST_F(SharedMemoryDataTransferTest, LargeElement) {
+  Tensor large(DT_FLOAT, TensorShape({256, 256}));
+  test::FillIota<float>(&large, 0.0f);
+  Tensor small = test::AsTensor<int64_t>({1, 2, 3});
+  Start({large, small});
+
+  GetElementRequest request;
+  request.set_task_id(7);
+  GetElementResult result;
+  TF_ASSERT_OK(client_->GetElement(request, result));
+  EXPECT_EQ(result.element_index, 7);
+  EXPECT_FALSE(result.end_of_sequence);
+  ASSERT_EQ(result.components.size(), 2);
+  test::ExpectTensorEqual<float>(result.components[0], large);
+  test::ExpectTensorEqual<int64_t>(result.components[1], small);
+}
+
+TEST_F(SharedMemoryDataTransferTest, StringElement) {
+  Tensor element = test::AsTensor<tstring>({"a", "b"});
+  Start({element});
+
+  GetElementResult result;
+  TF_ASSERT_OK(client_->GetElement(GetElementRequest(), result));
+  ASSERT_EQ(result.components.size(), 1);
+  test::ExpectTensorEqual<tstring>(result.components[0], element);
+}
+
+TEST_F(SharedMemoryDataTransferTest, IncompatibleWorker) {
+  Start({test::AsScalar<int64_t>(1)});
+  EXPECT_THAT(client_->CheckCompatibility("/dev/shm/nonexistent_probe\n0"),
+              StatusIs(error::FAILED_PRECONDITION,
+                       HasSubstr("does not share memory")));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
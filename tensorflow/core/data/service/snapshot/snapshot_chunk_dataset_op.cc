@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 #include <cstdint>
+#include <deque>
 #include <memory>
 #include <string>
 #include <utility>
@@ -29,6 +30,9 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/path.h"
 #include "tsl/platform/tstring.h"
@@ -46,6 +50,10 @@ constexpr const char* const kSnapshotChunkDataset = "SnapshotChunkDataset";
 
 constexpr int64_t kTFRecordReaderOutputBufferSize = 512 << 20;  // 512MB
 
+// Maximum total size of the elements read ahead of the consumer. The reader
+// always reads ahead at least one element.
+constexpr int64_t kReadaheadBufferSizeBytes = 64 << 20;  // 64MB
+
 absl::string_view GetSnapshotPath(absl::string_view chunk_file) {
   // Snapshot chunks are placed in snapshot_path/chunks/chunk_x.
   absl::string_view chunk_dir = tsl::io::Dirname(chunk_file);
@@ -125,7 +133,10 @@ class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
     explicit Iterator(const Params& params)
         : DatasetIterator<Dataset>(params) {}
 
-    ~Iterator() override { RecordBytesRead(); }
+    ~Iterator() override {
+      StopReadaheadThread();
+      RecordBytesRead();
+    }
 
     absl::Status Initialize(IteratorContext* ctx) override {
       reader_ = std::make_unique<snapshot_util::TFRecordReader>(
@@ -138,17 +149,25 @@ class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
     absl::Status GetNextInternal(IteratorContext* ctx,
                                  std::vector<Tensor>* out_tensors,
                                  bool* end_of_sequence) override {
-      *end_of_sequence = false;
-      absl::Status status = reader_->ReadTensors(out_tensors);
-      if (absl::IsOutOfRange(status)) {
-        *end_of_sequence = true;
+      mutex_lock l(mu_);
+      EnsureReadaheadThreadStarted(ctx);
+      while (buffer_.empty() && !end_of_file_ && status_.ok()) {
+        cond_var_.wait(l);
+      }
+      if (!buffer_.empty()) {
+        *out_tensors = std::move(buffer_.front());
+        buffer_.pop_front();
+        buffered_bytes_ -= ElementSizeBytes(*out_tensors);
+        cond_var_.notify_all();
+        *end_of_sequence = false;
+        ++start_index_;
         return absl::OkStatus();
       }
       TF_RETURN_WITH_CONTEXT_IF_ERROR(
-          status,
+          status_,
           " Failed to read tf.data snapshot file: ", dataset()->chunk_file_);
-      ++start_index_;
-      return status;
+      *end_of_sequence = true;
+      return absl::OkStatus();
     }
 
     absl::Status SaveInternal(SerializationContext* ctx,
@@ -160,6 +179,7 @@ class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
 
     absl::Status RestoreInternal(IteratorContext* ctx,
                                  IteratorStateReader* reader) override {
+      StopReadaheadThread();
       TF_RETURN_IF_ERROR(
           reader->ReadScalar(full_name(kStartIndex), &start_index_));
       TF_RETURN_IF_ERROR(Initialize(ctx));
@@ -167,6 +187,79 @@ class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
     }
 
    private:
+    // Starts a thread which reads and decompresses the chunk ahead of the
+    // consumer, so that file reads overlap with the downstream processing.
+    void EnsureReadaheadThreadStarted(IteratorContext* ctx)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (readahead_thread_ == nullptr && !end_of_file_ && status_.ok()) {
+        std::shared_ptr<IteratorContext> new_ctx =
+            std::make_shared<IteratorContext>(*ctx);
+        readahead_thread_ =
+            ctx->StartThread("tf_data_snapshot_chunk_readahead",
+                             [this, new_ctx]() { ReadaheadThread(new_ctx); });
+      }
+    }
+
+    void ReadaheadThread(const std::shared_ptr<IteratorContext>& ctx)
+        TF_LOCKS_EXCLUDED(mu_) {
+      RecordStart(ctx.get());
+      auto cleanup = gtl::MakeCleanup([this, ctx] { RecordStop(ctx.get()); });
+      while (true) {
+        {
+          mutex_lock l(mu_);
+          while (!cancelled_ && buffered_bytes_ >= kReadaheadBufferSizeBytes) {
+            RecordStop(ctx.get());
+            cond_var_.wait(l);
+            RecordStart(ctx.get());
+          }
+          if (cancelled_) {
+            return;
+          }
+        }
+
+        // `reader_` is only used by this thread while it is running.
+        std::vector<Tensor> element;
+        absl::Status status = reader_->ReadTensors(&element);
+        mutex_lock l(mu_);
+        if (absl::IsOutOfRange(status)) {
+          end_of_file_ = true;
+        } else if (!status.ok()) {
+          status_ = std::move(status);
+        } else {
+          buffered_bytes_ += ElementSizeBytes(element);
+          buffer_.push_back(std::move(element));
+        }
+        cond_var_.notify_all();
+        if (end_of_file_ || !status_.ok()) {
+          return;
+        }
+      }
+    }
+
+    // Stops the readahead thread and discards the elements read ahead.
+    void StopReadaheadThread() TF_LOCKS_EXCLUDED(mu_) {
+      {
+        mutex_lock l(mu_);
+        cancelled_ = true;
+        cond_var_.notify_all();
+      }
+      readahead_thread_.reset();
+      mutex_lock l(mu_);
+      cancelled_ = false;
+      end_of_file_ = false;
+      status_ = absl::OkStatus();
+      buffer_.clear();
+      buffered_bytes_ = 0;
+    }
+
+    static int64_t ElementSizeBytes(const std::vector<Tensor>& element) {
+      int64_t size_bytes = 0;
+      for (const Tensor& tensor : element) {
+        size_bytes += tensor.TotalBytes();
+      }
+      return size_bytes;
+    }
+
     // TODO(b/250921378): Optimize this to not parse every single element. We
     // may consider switching the data format to ArrayRecords so we can use the
     // index to jump straight to the starting record.
@@ -185,7 +278,19 @@ class SnapshotChunkDatasetOp::Dataset : public DatasetBase {
     }
 
     std::unique_ptr<snapshot_util::TFRecordReader> reader_;
+    // Number of elements returned to the consumer.
     int64_t start_index_ = 0;
+
+    mutex mu_;
+    condition_variable cond_var_;
+    // Elements read ahead of the consumer, in file order.
+    std::deque<std::vector<Tensor>> buffer_ TF_GUARDED_BY(mu_);
+    int64_t buffered_bytes_ TF_GUARDED_BY(mu_) = 0;
+    bool end_of_file_ TF_GUARDED_BY(mu_) = false;
+    // Status of the first failed read.
+    absl::Status status_ TF_GUARDED_BY(mu_);
+    bool cancelled_ TF_GUARDED_BY(mu_) = false;
+    std::unique_ptr<Thread> readahead_thread_;
   };
 
   const tstring chunk_file_;
@@ -142,9 +142,19 @@ absl::Status SnapshotStreamWriter::WriteSnapshot() TF_LOCKS_EXCLUDED(mu_) {
   // TODO(b/258691097): Write the "LEASE" file periodically.
   TF_RETURN_IF_ERROR(InitializeDirectories());
   TF_RETURN_IF_ERROR(Restore());
-  while (ShouldWriteChunks()) {
-    TF_RETURN_IF_ERROR(WriteChunks());
+  if (params_.max_pending_commits > 0) {
+    commit_thread_ = absl::WrapUnique(params_.env->StartThread(
+        /*thread_options=*/{}, /*name=*/"tf_data_service_snapshot_commit",
+        [this]() { CommitChunks(); }));
   }
+  absl::Status status = absl::OkStatus();
+  while (status.ok() && ShouldWriteChunks()) {
+    status = WriteChunks();
+  }
+  // The DONE file may only be written after all chunks are committed.
+  absl::Status commit_status = StopCommitThread();
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(commit_status);
   mutex_lock l(mu_);
   return completed_.status();
 }
@@ -182,12 +192,20 @@ absl::Status SnapshotStreamWriter::WriteChunks() {
   do {
     TF_RETURN_IF_ERROR(WriteRecord(writer));
   } while (ShouldWriteRecord());
-  TF_ASSIGN_OR_RETURN(const ParallelTFRecordWriter::FileToStatsMap file_stats,
-                      writer.Finalize());
+  PendingCommit commit;
+  TF_ASSIGN_OR_RETURN(commit.file_stats, writer.Finalize());
   TF_RETURN_IF_ERROR(Completed().status());
-  TF_RETURN_IF_ERROR(Commit(file_stats));
-  metrics::RecordTFDataServiceSnapshotBytesCommitted(
-      TotalBytes(file_stats).ToUnsignedBytes());
+  // The iterator checkpoint is taken here, at the chunk boundary, since the
+  // iterator continues producing the next chunk while this one is committed.
+  TF_ASSIGN_OR_RETURN(commit.serialized_iterator, iterator_->Save());
+  commit.chunk_index = chunk_index_;
+  chunk_index_ += commit.file_stats.size();
+  if (params_.max_pending_commits > 0) {
+    TF_RETURN_IF_ERROR(EnqueueCommit(std::move(commit)));
+  } else {
+    TF_RETURN_IF_ERROR(Commit(commit));
+  }
+  last_commit_time_ = absl::FromUnixMicros(params_.env->NowMicros());
   return absl::OkStatus();
 }
 
@@ -213,26 +231,93 @@ absl::Status SnapshotStreamWriter::WriteRecord(ParallelTFRecordWriter& writer) {
   return writer.Write(std::move(element));
 }
 
-absl::Status SnapshotStreamWriter::Commit(
-    const ParallelTFRecordWriter::FileToStatsMap& file_stats) {
+absl::Status SnapshotStreamWriter::Commit(const PendingCommit& commit) {
   // Writes the checkpoint before committing the chunks. Once the checkpoint is
   // written, the chunks before the checkpoint are considered done. If the
   // worker restarts before committing the files in `file_stats`, the restarted
   // worker should commit the uncommitted chunks (see SyncCheckpointWithChunks).
-  TF_RETURN_IF_ERROR(Save(file_stats));
+  TF_RETURN_IF_ERROR(Save(commit));
 
   // Commits all chunks since the last commit.
-  for (const auto& [file, stats] : file_stats) {
+  int64_t chunk_index = commit.chunk_index;
+  for (const auto& [file, stats] : commit.file_stats) {
     std::string committed_chunk_path =
         tsl::io::JoinPath(params_.CommittedChunksDirectory(),
                           absl::StrCat("chunk_", params_.stream_index, "_",
-                                       chunk_index_++, "_", stats.num_records));
+                                       chunk_index++, "_", stats.num_records));
     TF_RETURN_IF_ERROR(params_.env->RenameFile(file, committed_chunk_path));
   }
-  last_commit_time_ = absl::FromUnixMicros(params_.env->NowMicros());
+  metrics::RecordTFDataServiceSnapshotBytesCommitted(
+      TotalBytes(commit.file_stats).ToUnsignedBytes());
   return absl::OkStatus();
 }
 
+absl::Status SnapshotStreamWriter::EnqueueCommit(PendingCommit commit)
+    TF_LOCKS_EXCLUDED(mu_) {
+  mutex_lock l(mu_);
+  while (completed_.ok() && commit_status_.ok() &&
+         num_pending_commits_ >= params_.max_pending_commits) {
+    commit_cv_.wait(l);
+  }
+  TF_RETURN_IF_ERROR(completed_.status());
+  TF_RETURN_IF_ERROR(commit_status_);
+  pending_commits_.push_back(std::move(commit));
+  ++num_pending_commits_;
+  commit_cv_.notify_all();
+  return absl::OkStatus();
+}
+
+void SnapshotStreamWriter::CommitChunks() TF_LOCKS_EXCLUDED(mu_) {
+  while (true) {
+    PendingCommit commit;
+    {
+      mutex_lock l(mu_);
+      while (pending_commits_.empty() && !commits_finished_) {
+        commit_cv_.wait(l);
+      }
+      if (pending_commits_.empty()) {
+        return;
+      }
+      // Chunks written before a cancellation are not committed, as in the
+      // synchronous mode.
+      if (!completed_.ok()) {
+        pending_commits_.clear();
+        num_pending_commits_ = 0;
+        commit_cv_.notify_all();
+        return;
+      }
+      commit = std::move(pending_commits_.front());
+      pending_commits_.pop_front();
+    }
+
+    absl::Status status = Commit(commit);
+    mutex_lock l(mu_);
+    --num_pending_commits_;
+    commit_cv_.notify_all();
+    if (!status.ok()) {
+      // Later chunks cannot be committed without this one.
+      commit_status_ = std::move(status);
+      pending_commits_.clear();
+      num_pending_commits_ = 0;
+      return;
+    }
+  }
+}
+
+absl::Status SnapshotStreamWriter::StopCommitThread() TF_LOCKS_EXCLUDED(mu_) {
+  if (commit_thread_ == nullptr) {
+    return absl::OkStatus();
+  }
+  {
+    mutex_lock l(mu_);
+    commits_finished_ = true;
+    commit_cv_.notify_all();
+  }
+  commit_thread_.reset();
+  mutex_lock l(mu_);
+  return commit_status_;
+}
+
 absl::Status SnapshotStreamWriter::FinalizeStream(absl::Status status) {
   if (status.ok()) {
     status = WriteDoneFile();
@@ -279,15 +364,15 @@ void SnapshotStreamWriter::Cancel() TF_LOCKS_EXCLUDED(mu_) {
   mutex_lock l(mu_);
   completed_ = absl::CancelledError(
       "The tf.data service snapshot writer has been cancelled.");
+  commit_cv_.notify_all();
 }
 
-absl::Status SnapshotStreamWriter::Save(
-    const ParallelTFRecordWriter::FileToStatsMap& file_stats) {
-  const size_t num_elements = TotalNumElements(file_stats);
-  const ByteSize byte_size = TotalBytes(file_stats);
+absl::Status SnapshotStreamWriter::Save(const PendingCommit& commit) {
+  const size_t num_elements = TotalNumElements(commit.file_stats);
+  const ByteSize byte_size = TotalBytes(commit.file_stats);
   LOG(INFO) << "Checkpointing distributed tf.data snapshot writer for snapshot "
             << params_.DebugString() << ". Stream " << params_.stream_index
-            << ", chunk " << chunk_index_
+            << ", chunk " << commit.chunk_index
             << ", number of elements in chunk: " << num_elements
             << ", chunk size: " << byte_size << ".";
   tsl::profiler::TraceMe activity("SnapshotCheckpoint",
@@ -296,12 +381,11 @@ absl::Status SnapshotStreamWriter::Save(
   // The checkpoint index identifies the first chunk index after the checkpoint:
   // When a worker restarts, all the files before `checkpoint_index` should be
   // committed; all the files at/after `checkpoint_index` should be discarded.
-  int64_t checkpoint_index = chunk_index_ + file_stats.size();
+  int64_t checkpoint_index = commit.chunk_index + commit.file_stats.size();
   std::string checkpoint_path = CheckpointPath(checkpoint_index, num_elements);
-  TF_ASSIGN_OR_RETURN(std::vector<Tensor> serialized_iterator,
-                      iterator_->Save());
-  TF_RETURN_IF_ERROR(AtomicallyWriteTFRecords(
-      checkpoint_path, serialized_iterator, params_.compression, params_.env));
+  TF_RETURN_IF_ERROR(
+      AtomicallyWriteTFRecords(checkpoint_path, commit.serialized_iterator,
+                               params_.compression, params_.env));
   absl::Time end_time = absl::FromUnixMicros(params_.env->NowMicros());
   LOG(INFO) << "Wrote checkpoint file " << checkpoint_path << ". "
             << "Checkpointing distributed tf.data snapshot writer took "
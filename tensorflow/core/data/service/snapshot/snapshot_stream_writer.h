@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <cstddef>
 #include <cstdint>
+#include <deque>
 #include <memory>
 #include <optional>
 #include <string>
@@ -35,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/task_runner.h"
 #include "tensorflow/core/data/service/worker.pb.h"
 #include "tensorflow/core/data/snapshot_utils.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/protobuf/service_config.pb.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/mutex.h"
@@ -73,6 +75,13 @@ struct SnapshotWriterParams {
   // snapshot. Used only for unit testing.
   bool test_only_keep_temp_files = false;
 
+  // If positive, chunks are committed asynchronously: While the checkpoint of a
+  // chunk is written and its files are committed, the writer continues writing
+  // the next chunk. At most `max_pending_commits` chunks can wait to be
+  // committed, after which the writer blocks. If 0, chunks are committed
+  // synchronously.
+  int64_t max_pending_commits = 0;
+
   std::string StreamDirectory() const {
     return tensorflow::data::StreamDirectory(snapshot_path, stream_index);
   }
@@ -172,8 +181,29 @@ class SnapshotStreamWriter {
   // Writes the next record to the current chunks.
   absl::Status WriteRecord(ParallelTFRecordWriter& writer);
 
+  // Chunk files which have been written but not committed.
+  struct PendingCommit {
+    ParallelTFRecordWriter::FileToStatsMap file_stats;
+    // Index of the first chunk in `file_stats`.
+    int64_t chunk_index = 0;
+    // The iterator checkpoint after the last element in `file_stats`.
+    std::vector<Tensor> serialized_iterator;
+  };
+
   // Commits the chunks since the last commit.
-  absl::Status Commit(const ParallelTFRecordWriter::FileToStatsMap& file_stats);
+  absl::Status Commit(const PendingCommit& commit);
+
+  // Hands `commit` over to `commit_thread_`. Blocks if there are already
+  // `params_.max_pending_commits` pending commits. Returns an error if a
+  // previous commit has failed or the writer has been cancelled.
+  absl::Status EnqueueCommit(PendingCommit commit);
+
+  // Run by `commit_thread_` to commit the enqueued chunks in order.
+  void CommitChunks();
+
+  // Waits for the pending commits to finish and stops `commit_thread_`.
+  // Returns the status of the asynchronous commits.
+  absl::Status StopCommitThread();
 
   // Writes a DONE file when the stream is finished. Writes an ERROR file if it
   // failed.
@@ -181,8 +211,8 @@ class SnapshotStreamWriter {
   absl::Status WriteDoneFile();
   absl::Status WriteErrorFile(const absl::Status& status);
 
-  // Saves an iterator checkpoint.
-  absl::Status Save(const ParallelTFRecordWriter::FileToStatsMap& file_stats);
+  // Saves the iterator checkpoint of `commit`.
+  absl::Status Save(const PendingCommit& commit);
 
   // After committing a checkpoint, deletes the previous checkpoints.
   absl::Status DeleteOutdatedCheckpoints(int64_t checkpoint_index);
@@ -235,6 +265,19 @@ class SnapshotStreamWriter {
   // - If the snapshot has not finished, this is false.
   absl::StatusOr<bool> completed_ TF_GUARDED_BY(mu_) = false;
 
+  // Chunks waiting to be committed by `commit_thread_`, in chunk order.
+  std::deque<PendingCommit> pending_commits_ TF_GUARDED_BY(mu_);
+  // Number of enqueued commits which have not finished, including the one
+  // `commit_thread_` is processing.
+  int64_t num_pending_commits_ TF_GUARDED_BY(mu_) = 0;
+  // True if no more commits will be enqueued.
+  bool commits_finished_ TF_GUARDED_BY(mu_) = false;
+  // Status of the asynchronous commits.
+  absl::Status commit_status_ TF_GUARDED_BY(mu_);
+  condition_variable commit_cv_;
+
+  // Only started if `params_.max_pending_commits` is positive.
+  std::unique_ptr<Thread> commit_thread_;
   std::unique_ptr<Thread> snapshot_thread_;
 };
 
@@ -25,6 +25,7 @@ limitations under the License.
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
 #include "xla/tsl/lib/core/status_test_util.h"
 #include "xla/tsl/lib/io/compression.h"
 #include "xla/tsl/lib/monitoring/cell_reader.h"
@@ -222,6 +223,35 @@ TEST_P(SnapshotStreamWriterParameterizedTest, WriteSnapshotChunks) {
               IsOkAndHolds(UnorderedElementsAre(0, 1, 2, 3, 4, 5, 6, 7, 8, 9)));
 }
 
+TEST_P(SnapshotStreamWriterParameterizedTest, WriteSnapshotWithPendingCommits) {
+  int64_t range = 10;
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<StandaloneTaskIterator> iterator,
+                          TestIterator(testing::RangeDataset(range)));
+
+  TF_ASSERT_OK_AND_ASSIGN(std::string snapshot_path, CreateSnapshotDirectory());
+  SnapshotWriterParams writer_params{
+      snapshot_path,
+      /*stream_index=*/0,
+      Compression(),
+      Env::Default(),
+      /*max_chunk_size=*/ByteSize::Bytes(1),
+      /*checkpoint_interval=*/absl::ZeroDuration()};
+  writer_params.max_pending_commits = 2;
+  SnapshotStreamWriter snapshot_writer(writer_params, std::move(iterator));
+  EXPECT_THAT(snapshot_writer.Wait(), IsOkAndHolds(true));
+
+  // Every element is committed separately, while the writer continues writing
+  // the next elements.
+  EXPECT_THAT(
+      GetChildren(writer_params.CommittedChunksDirectory(), Env::Default()),
+      IsOkAndHolds(SizeIs(range)));
+  EXPECT_THAT(testing::ReadSnapshot<int64_t>(snapshot_path, Compression()),
+              IsOkAndHolds(UnorderedElementsAre(0, 1, 2, 3, 4, 5, 6, 7, 8, 9)));
+  EXPECT_THAT(
+      GetChildren(writer_params.UncommittedChunksDirectory(), Env::Default()),
+      IsOkAndHolds(IsEmpty()));
+}
+
 TEST_P(SnapshotStreamWriterParameterizedTest, WriteDoneFile) {
   int64_t range = 10;
   TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<StandaloneTaskIterator> iterator,
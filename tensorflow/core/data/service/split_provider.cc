@@ -15,11 +15,16 @@ limitations under the License.
 
 #include "tensorflow/core/data/service/split_provider.h"
 
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/dispatcher_client.h"
 #include "tensorflow/core/data/service/grpc_util.h"
@@ -82,6 +87,112 @@ absl::Status DataServiceSplitProvider::Restore(
       "Restore is not implemented for DataServiceSplitProvider");
 }
 
+PrefetchingSplitProvider::PrefetchingSplitProvider(
+    std::unique_ptr<SplitProvider> split_provider, int64_t buffer_size)
+    : buffer_size_(buffer_size), split_provider_(std::move(split_provider)) {
+  DCHECK_GT(buffer_size_, 0);
+}
+
+PrefetchingSplitProvider::~PrefetchingSplitProvider() {
+  std::unique_ptr<Thread> prefetch_thread;
+  {
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    cv_.notify_all();
+    prefetch_thread = std::move(prefetch_thread_);
+  }
+  // Joins the thread.
+  prefetch_thread.reset();
+}
+
+absl::Status PrefetchingSplitProvider::GetNext(Tensor* split,
+                                               bool* end_of_splits)
+    TF_LOCKS_EXCLUDED(mu_) {
+  mutex_lock l(mu_);
+  if (!prefetch_thread_) {
+    prefetch_thread_ = absl::WrapUnique(Env::Default()->StartThread(
+        /*thread_options=*/{}, /*name=*/"tf_data_service_split_prefetch",
+        [this]() { PrefetchThread(); }));
+  }
+  while (buffer_.empty() && !end_of_splits_ && status_.ok() && !cancelled_) {
+    cv_.wait(l);
+  }
+  if (!buffer_.empty()) {
+    *split = std::move(buffer_.front());
+    buffer_.pop_front();
+    *end_of_splits = false;
+    cv_.notify_all();
+    return absl::OkStatus();
+  }
+  TF_RETURN_IF_ERROR(status_);
+  if (cancelled_) {
+    return errors::Cancelled("The split provider has been cancelled.");
+  }
+  *end_of_splits = true;
+  return absl::OkStatus();
+}
+
+void PrefetchingSplitProvider::PrefetchThread() TF_LOCKS_EXCLUDED(mu_) {
+  while (true) {
+    {
+      mutex_lock l(mu_);
+      while (!cancelled_ &&
+             (buffer_.size() >= static_cast<size_t>(buffer_size_) ||
+              end_of_splits_ || !status_.ok())) {
+        cv_.wait(l);
+      }
+      if (cancelled_) {
+        return;
+      }
+    }
+
+    // A `Reset` before this point clears the buffer, so the split fetched
+    // below is always for the current repetition.
+    mutex_lock pl(provider_mu_);
+    Tensor split;
+    bool end_of_splits = false;
+    absl::Status status = split_provider_->GetNext(&split, &end_of_splits);
+    mutex_lock l(mu_);
+    if (!status.ok()) {
+      status_ = std::move(status);
+    } else if (end_of_splits) {
+      end_of_splits_ = true;
+    } else {
+      buffer_.push_back(std::move(split));
+    }
+    cv_.notify_all();
+  }
+}
+
+absl::Status PrefetchingSplitProvider::Reset() TF_LOCKS_EXCLUDED(mu_) {
+  mutex_lock pl(provider_mu_);
+  TF_RETURN_IF_ERROR(split_provider_->Reset());
+  mutex_lock l(mu_);
+  buffer_.clear();
+  end_of_splits_ = false;
+  status_ = absl::OkStatus();
+  cv_.notify_all();
+  return absl::OkStatus();
+}
+
+absl::Status PrefetchingSplitProvider::Save(
+    std::function<std::string(std::string)> full_name,
+    IteratorStateWriter* writer) {
+  return errors::Unimplemented(
+      "Save is not implemented for PrefetchingSplitProvider");
+}
+
+absl::Status PrefetchingSplitProvider::Restore(
+    std::function<std::string(std::string)> full_name,
+    IteratorStateReader* reader) {
+  return errors::Unimplemented(
+      "Restore is not implemented for PrefetchingSplitProvider");
+}
+
+int64_t PrefetchingSplitProvider::Cardinality() const {
+  return split_provider_->Cardinality();
+}
+
 absl::Status CreateSplitProviders(
     const DatasetDef& dataset_def,
     std::vector<std::unique_ptr<SplitProvider>>& split_providers) {
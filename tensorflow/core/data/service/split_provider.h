@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_SPLIT_PROVIDER_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_SPLIT_PROVIDER_H_
 
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <string>
@@ -25,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/dispatcher_client.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -63,6 +66,53 @@ class DataServiceSplitProvider : public SplitProvider {
   std::unique_ptr<DataServiceDispatcherClient> dispatcher_ TF_GUARDED_BY(mu_);
 };
 
+// SplitProvider which fetches up to `buffer_size` splits ahead of its consumer
+// from `split_provider` in a background thread, so that the consumer does not
+// wait for the dispatcher each time it finishes a split. Splits are returned in
+// the order `split_provider` produces them.
+//
+// Prefetched splits which have not been consumed when the provider is reset or
+// destroyed are dropped, like unprocessed splits of a failed task.
+//
+// This class is thread safe.
+class PrefetchingSplitProvider : public SplitProvider {
+ public:
+  PrefetchingSplitProvider(std::unique_ptr<SplitProvider> split_provider,
+                           int64_t buffer_size);
+  ~PrefetchingSplitProvider() override;
+  PrefetchingSplitProvider(const PrefetchingSplitProvider&) = delete;
+  PrefetchingSplitProvider& operator=(const PrefetchingSplitProvider&) =
+      delete;
+
+  absl::Status GetNext(Tensor* split, bool* end_of_splits) override;
+  absl::Status Reset() override;
+  absl::Status Save(std::function<std::string(std::string)> full_name,
+                    IteratorStateWriter* writer) override;
+  absl::Status Restore(std::function<std::string(std::string)> full_name,
+                       IteratorStateReader* reader) override;
+  int64_t Cardinality() const override;
+
+ private:
+  void PrefetchThread();
+
+  const int64_t buffer_size_;
+
+  // Serializes `GetNext` and `Reset` calls on `split_provider_`, so that a
+  // split fetched before a `Reset` is not mistaken for a split of the next
+  // repetition.
+  mutex provider_mu_ TF_ACQUIRED_BEFORE(mu_);
+  const std::unique_ptr<SplitProvider> split_provider_;
+
+  mutex mu_;
+  condition_variable cv_;
+  std::deque<Tensor> buffer_ TF_GUARDED_BY(mu_);
+  // True if `split_provider_` has produced all splits of this repetition.
+  bool end_of_splits_ TF_GUARDED_BY(mu_) = false;
+  absl::Status status_ TF_GUARDED_BY(mu_);
+  bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  std::unique_ptr<Thread> prefetch_thread_ TF_GUARDED_BY(mu_);
+};
+
 // Makes split providers for `dataset_def` and stores them in `split_providers`.
 absl::Status CreateSplitProviders(
     const DatasetDef& dataset_def,
@@ -18,13 +18,17 @@ limitations under the License.
 #include <cstdint>
 #include <memory>
 #include <tuple>
+#include <utility>
 #include <vector>
 
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "xla/tsl/lib/core/status_test_util.h"
 #include "tensorflow/core/data/service/common.pb.h"
 #include "tensorflow/core/data/service/test_util.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tsl/platform/status_matchers.h"
 #include "tsl/platform/statusor.h"
 #include "tsl/platform/test.h"
 
@@ -33,7 +37,9 @@ namespace data {
 namespace {
 
 using ::testing::ElementsAre;
+using ::testing::IsEmpty;
 using ::testing::UnorderedElementsAre;
+using ::tsl::testing::IsOkAndHolds;
 
 std::vector<int64_t> GetCardinalities(
     const std::vector<std::unique_ptr<SplitProvider>>& split_providers) {
@@ -44,6 +50,20 @@ std::vector<int64_t> GetCardinalities(
   return cardinalities;
 }
 
+// Reads all splits of the current repetition from `split_provider`.
+absl::StatusOr<std::vector<int64_t>> GetSplits(SplitProvider& split_provider) {
+  std::vector<int64_t> splits;
+  while (true) {
+    Tensor split;
+    bool end_of_splits = false;
+    TF_RETURN_IF_ERROR(split_provider.GetNext(&split, &end_of_splits));
+    if (end_of_splits) {
+      return splits;
+    }
+    splits.push_back(split.scalar<int64_t>()());
+  }
+}
+
 TEST(SplitProviderTest, RangeCardinality) {
   DatasetDef range_dataset = testing::RangeDataset(10);
   std::vector<std::unique_ptr<SplitProvider>> split_providers;
@@ -51,6 +71,41 @@ TEST(SplitProviderTest, RangeCardinality) {
   EXPECT_THAT(GetCardinalities(split_providers), UnorderedElementsAre(10));
 }
 
+TEST(PrefetchingSplitProviderTest, GetSplits) {
+  DatasetDef range_dataset = testing::RangeDataset(10);
+  std::vector<std::unique_ptr<SplitProvider>> split_providers;
+  TF_ASSERT_OK(CreateSplitProviders(range_dataset, split_providers));
+  ASSERT_EQ(split_providers.size(), 1);
+  PrefetchingSplitProvider split_provider(std::move(split_providers[0]),
+                                          /*buffer_size=*/3);
+  EXPECT_EQ(split_provider.Cardinality(), 10);
+  EXPECT_THAT(GetSplits(split_provider),
+              IsOkAndHolds(ElementsAre(0, 1, 2, 3, 4, 5, 6, 7, 8, 9)));
+  EXPECT_THAT(GetSplits(split_provider), IsOkAndHolds(IsEmpty()));
+
+  TF_ASSERT_OK(split_provider.Reset());
+  EXPECT_THAT(GetSplits(split_provider),
+              IsOkAndHolds(ElementsAre(0, 1, 2, 3, 4, 5, 6, 7, 8, 9)));
+}
+
+TEST(PrefetchingSplitProviderTest, ResetDropsPrefetchedSplits) {
+  DatasetDef range_dataset = testing::RangeDataset(10);
+  std::vector<std::unique_ptr<SplitProvider>> split_providers;
+  TF_ASSERT_OK(CreateSplitProviders(range_dataset, split_providers));
+  ASSERT_EQ(split_providers.size(), 1);
+  PrefetchingSplitProvider split_provider(std::move(split_providers[0]),
+                                          /*buffer_size=*/5);
+  Tensor split;
+  bool end_of_splits = false;
+  TF_ASSERT_OK(split_provider.GetNext(&split, &end_of_splits));
+  ASSERT_FALSE(end_of_splits);
+  EXPECT_EQ(split.scalar<int64_t>()(), 0);
+
+  TF_ASSERT_OK(split_provider.Reset());
+  EXPECT_THAT(GetSplits(split_provider),
+              IsOkAndHolds(ElementsAre(0, 1, 2, 3, 4, 5, 6, 7, 8, 9)));
+}
+
 class RepeatedSplitProviderTest
     : public ::testing::TestWithParam<std::tuple<int64_t, int64_t, int64_t>> {
  public:
@@ -15,11 +15,17 @@ limitations under the License.
 #include "tensorflow/core/data/service/task_runner.h"
 
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <optional>
+#include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+
 #include "tensorflow/core/data/service/byte_size.h"
 #include "tensorflow/core/data/service/common.h"
 #include "tensorflow/core/data/service/cross_trainer_cache.h"
@@ -33,9 +39,11 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
+#include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/random.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -48,6 +56,11 @@ namespace {
 constexpr int64_t kWaitBeforeSkipUs = 100 * 1000;  // 100ms.
 constexpr size_t kDefaultCrossTrainerCacheSizeBytes =
     10 * (size_t{1} << 30);  // 10GB
+constexpr size_t kDefaultCrossTrainerCacheSpillSizeBytes =
+    100 * (size_t{1} << 30);  // 100GB
+// The spill log is split into this many segments, so that at most this
+// fraction of the spilled elements is dropped at once.
+constexpr size_t kNumCrossTrainerCacheSpillSegments = 8;
 
 }  // namespace
 
@@ -100,8 +113,16 @@ absl::Status TaskRunner::Create(const experimental::WorkerConfig& worker_config,
         worker_config.cross_trainer_cache_size_bytes() > 0
             ? worker_config.cross_trainer_cache_size_bytes()
             : kDefaultCrossTrainerCacheSizeBytes;
-    out = std::make_unique<CachingTaskRunner>(std::move(iterator),
-                                              max_cache_size_bytes);
+    std::unique_ptr<CacheSpillTier<GetElementResult>> spill_tier;
+    if (!worker_config.cross_trainer_cache_spill_dir().empty()) {
+      spill_tier = std::make_unique<CrossTrainerCacheSpillLog>(
+          worker_config.cross_trainer_cache_spill_dir(),
+          worker_config.cross_trainer_cache_spill_size_bytes() > 0
+              ? worker_config.cross_trainer_cache_spill_size_bytes()
+              : kDefaultCrossTrainerCacheSpillSizeBytes);
+    }
+    out = std::make_unique<CachingTaskRunner>(
+        std::move(iterator), max_cache_size_bytes, std::move(spill_tier));
   } else {
     out = std::make_unique<FirstComeFirstServedTaskRunner>(std::move(iterator));
   }
@@ -177,11 +198,138 @@ std::shared_ptr<model::Model> FirstComeFirstServedTaskRunner::model() const {
   return model_;
 }
 
-CachingTaskRunner::CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
-                                     size_t max_cache_size_bytes)
+CrossTrainerCacheSpillLog::CrossTrainerCacheSpillLog(
+    const std::string& directory, size_t max_size_bytes)
+    : env_(Env::Default()),
+      directory_(directory),
+      file_prefix_(io::JoinPath(
+          directory, absl::StrCat("cross_trainer_cache_", random::New64()))),
+      max_size_bytes_(max_size_bytes),
+      max_segment_size_bytes_(max_size_bytes /
+                              kNumCrossTrainerCacheSpillSegments) {}
+
+CrossTrainerCacheSpillLog::~CrossTrainerCacheSpillLog() {
+  mutex_lock l(mu_);
+  for (const Segment& segment : segments_) {
+    env_->DeleteFile(segment.path).IgnoreError();
+  }
+}
+
+absl::Status CrossTrainerCacheSpillLog::Spill(size_t index,
+                                              const GetElementResult& element) {
+  GetElementResponse response;
+  for (const Tensor& component : element.components) {
+    component.AsProtoTensorContent(
+        response.mutable_uncompressed()->add_components());
+  }
+  response.set_element_index(element.element_index);
+  response.set_end_of_sequence(element.end_of_sequence);
+  response.set_skip_task(element.skip);
+  const std::string serialized = response.SerializeAsString();
+
+  mutex_lock l(mu_);
+  if (segments_.empty() || (!segments_.back().end_offsets.empty() &&
+                            segments_.back().end_offsets.back() >=
+                                max_segment_size_bytes_)) {
+    TF_RETURN_IF_ERROR(StartSegment(index));
+  }
+  Segment& segment = segments_.back();
+  if (index != segment.start_index + segment.end_offsets.size()) {
+    return errors::Internal(
+        "tf.data service cross-trainer cache spilled element ", index,
+        " out of order; expected element ",
+        segment.start_index + segment.end_offsets.size());
+  }
+  TF_RETURN_IF_ERROR(segment.writer->Append(serialized));
+  // Flushes so that the element can be read back before the segment is full.
+  TF_RETURN_IF_ERROR(segment.writer->Flush());
+  const uint64_t start_offset =
+      segment.end_offsets.empty() ? 0 : segment.end_offsets.back();
+  segment.end_offsets.push_back(start_offset + serialized.size());
+  size_bytes_ += serialized.size();
+  while (segments_.size() > 1 && size_bytes_ > max_size_bytes_) {
+    const Segment& oldest = segments_.front();
+    size_bytes_ -= oldest.end_offsets.back();
+    TF_RETURN_IF_ERROR(env_->DeleteFile(oldest.path));
+    segments_.pop_front();
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<GetElementResult> CrossTrainerCacheSpillLog::Read(size_t index) {
+  std::shared_ptr<RandomAccessFile> reader;
+  uint64_t start_offset = 0, end_offset = 0;
+  {
+    mutex_lock l(mu_);
+    for (const Segment& segment : segments_) {
+      if (index >= segment.start_index &&
+          index < segment.start_index + segment.end_offsets.size()) {
+        const size_t i = index - segment.start_index;
+        reader = segment.reader;
+        start_offset = i == 0 ? 0 : segment.end_offsets[i - 1];
+        end_offset = segment.end_offsets[i];
+        break;
+      }
+    }
+  }
+  if (reader == nullptr) {
+    return errors::NotFound("tf.data service cross-trainer cache element ",
+                            index, " has not been spilled.");
+  }
+
+  // The open file can still be read if its segment is dropped concurrently.
+  std::string scratch(end_offset - start_offset, '\0');
+  absl::string_view data;
+  TF_RETURN_IF_ERROR(
+      reader->Read(start_offset, scratch.size(), &data, scratch.data()));
+  GetElementResponse response;
+  if (!response.ParseFromArray(data.data(), data.size())) {
+    return errors::DataLoss(
+        "Failed to parse spilled tf.data service cross-trainer cache element ",
+        index);
+  }
+  GetElementResult result;
+  for (const TensorProto& proto : response.uncompressed().components()) {
+    result.components.emplace_back();
+    if (!result.components.back().FromProto(proto)) {
+      return errors::DataLoss(
+          "Failed to parse spilled tf.data service cross-trainer cache "
+          "element ",
+          index);
+    }
+  }
+  result.element_index = response.element_index();
+  result.end_of_sequence = response.end_of_sequence();
+  result.skip = response.skip_task();
+  return result;
+}
+
+absl::Status CrossTrainerCacheSpillLog::StartSegment(size_t start_index)
+    TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+  if (segments_.empty()) {
+    TF_RETURN_IF_ERROR(env_->RecursivelyCreateDir(directory_));
+  } else {
+    TF_RETURN_IF_ERROR(segments_.back().writer->Close());
+    segments_.back().writer.reset();
+  }
+  Segment segment;
+  segment.path = absl::StrCat(file_prefix_, "_", start_index);
+  segment.start_index = start_index;
+  TF_RETURN_IF_ERROR(env_->NewWritableFile(segment.path, &segment.writer));
+  std::unique_ptr<RandomAccessFile> reader;
+  TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(segment.path, &reader));
+  segment.reader = std::move(reader);
+  segments_.push_back(std::move(segment));
+  return absl::OkStatus();
+}
+
+CachingTaskRunner::CachingTaskRunner(
+    std::unique_ptr<TaskIterator> iterator, size_t max_cache_size_bytes,
+    std::unique_ptr<CacheSpillTier<GetElementResult>> spill_tier)
     : fcfs_task_runner_(std::move(iterator)),
       cache_(max_cache_size_bytes,
-             std::make_unique<GetElementResultSequence>(fcfs_task_runner_)) {
+             std::make_unique<GetElementResultSequence>(fcfs_task_runner_),
+             std::move(spill_tier)) {
   LOG(INFO) << "Initialized tf.data service cross-trainer cache with "
             << ByteSize::Bytes(max_cache_size_bytes) << " of memory.";
 }
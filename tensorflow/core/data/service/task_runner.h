@@ -15,8 +15,12 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_SERVICE_TASK_RUNNER_H_
 #define TENSORFLOW_CORE_DATA_SERVICE_TASK_RUNNER_H_
 
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <memory>
 #include <optional>
+#include <string>
 #include <vector>
 
 #include "tensorflow/core/data/service/common.pb.h"
@@ -26,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/worker.pb.h"
 #include "tensorflow/core/data/standalone.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -147,6 +152,45 @@ class FirstComeFirstServedTaskRunner : public TaskRunner {
   void operator=(const FirstComeFirstServedTaskRunner&) = delete;
 };
 
+// A `CrossTrainerCache` spill tier which appends evicted elements to log files
+// in a local directory, indexed in memory. The log is split into segments, and
+// the oldest segment is deleted when the spilled elements exceed
+// `max_size_bytes`. The files are deleted when the log is destroyed.
+class CrossTrainerCacheSpillLog : public CacheSpillTier<GetElementResult> {
+ public:
+  CrossTrainerCacheSpillLog(const std::string& directory,
+                            size_t max_size_bytes);
+  ~CrossTrainerCacheSpillLog() override;
+
+  absl::Status Spill(size_t index, const GetElementResult& element) override;
+  absl::StatusOr<GetElementResult> Read(size_t index) override;
+
+ private:
+  struct Segment {
+    std::string path;
+    // The index of the first element in the segment.
+    size_t start_index = 0;
+    // The end offset of each element in the segment file.
+    std::vector<uint64_t> end_offsets;
+    std::unique_ptr<WritableFile> writer;
+    std::shared_ptr<RandomAccessFile> reader;
+  };
+
+  // Starts a new segment whose first element has index `start_index`.
+  absl::Status StartSegment(size_t start_index)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Env* const env_;
+  const std::string directory_;
+  const std::string file_prefix_;
+  const size_t max_size_bytes_;
+  const size_t max_segment_size_bytes_;
+
+  mutex mu_;
+  std::deque<Segment> segments_ TF_GUARDED_BY(mu_);
+  size_t size_bytes_ TF_GUARDED_BY(mu_) = 0;
+};
+
 // A task runner which prefetches elements on a first-come first-served basis
 // and caches elements in a sliding-window `CrossTrainerCache`. The cache has a
 // bounded size and progresses when a trainer that has consumed all elements in
@@ -154,8 +198,11 @@ class FirstComeFirstServedTaskRunner : public TaskRunner {
 // read the full dataset.
 class CachingTaskRunner : public TaskRunner {
  public:
-  explicit CachingTaskRunner(std::unique_ptr<TaskIterator> iterator,
-                             size_t max_cache_size_bytes);
+  // If `spill_tier` is not null, elements evicted from memory are spilled to
+  // it and served from there to trainers which fall behind.
+  explicit CachingTaskRunner(
+      std::unique_ptr<TaskIterator> iterator, size_t max_cache_size_bytes,
+      std::unique_ptr<CacheSpillTier<GetElementResult>> spill_tier = nullptr);
   ~CachingTaskRunner() override;
 
   // Gets the next element from the cross-trainer cache, blocking if the data is
@@ -30,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
@@ -360,6 +361,60 @@ TEST(CachingTaskRunnerTest, SlowClientSkipsData) {
   EXPECT_THAT(slow_trainer_output[0], Gt(0));
 }
 
+TEST(CachingTaskRunnerTest, SlowClientReadsSpilledData) {
+  size_t range = 1000;
+  CachingTaskRunner runner(
+      std::make_unique<InfiniteRangeIterator>(),
+      /*max_cache_size_bytes=*/kSmallCache,
+      std::make_unique<CrossTrainerCacheSpillLog>(
+          io::JoinPath(::tensorflow::testing::TmpDir(), "spill_log"),
+          /*max_size_bytes=*/kLargeCache));
+
+  GetElementRequest request;
+  request.set_trainer_id("Slow trainer");
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::vector<int64_t> slow_trainer_output,
+      GetElementsFromTaskRunner<int64_t>(runner, request, /*num_elements=*/1));
+  request.set_trainer_id("Fast trainer");
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::vector<int64_t> fast_trainer_output,
+      GetElementsFromTaskRunner<int64_t>(runner, request, range));
+  EXPECT_THAT(fast_trainer_output, ElementsAreArray(GetRange(range)));
+
+  // The slow trainer reads the elements evicted from memory from the spill log.
+  request.set_trainer_id("Slow trainer");
+  TF_ASSERT_OK_AND_ASSIGN(
+      std::vector<int64_t> remaining_output,
+      GetElementsFromTaskRunner<int64_t>(runner, request, range - 1));
+  slow_trainer_output.insert(slow_trainer_output.end(),
+                             remaining_output.begin(), remaining_output.end());
+  EXPECT_THAT(slow_trainer_output, ElementsAreArray(GetRange(range)));
+}
+
+TEST(CrossTrainerCacheSpillLogTest, DropsOldestElements) {
+  CrossTrainerCacheSpillLog log(
+      io::JoinPath(::tensorflow::testing::TmpDir(), "spill_log_drop"),
+      /*max_size_bytes=*/1024);
+  for (int64_t i = 0; i < 1000; ++i) {
+    GetElementResult element;
+    element.components = {Tensor{i}};
+    element.element_index = i;
+    TF_ASSERT_OK(log.Spill(i, element));
+  }
+
+  EXPECT_THAT(log.Read(0), StatusIs(error::NOT_FOUND));
+  EXPECT_THAT(log.Read(1000), StatusIs(error::NOT_FOUND));
+  TF_ASSERT_OK_AND_ASSIGN(GetElementResult last, log.Read(999));
+  EXPECT_EQ(last.element_index, 999);
+  ASSERT_EQ(last.components.size(), 1);
+  test::ExpectEqual(last.components[0], Tensor{int64_t{999}});
+
+  GetElementResult element;
+  element.components = {Tensor{int64_t{0}}};
+  EXPECT_THAT(log.Spill(5, element),
+              StatusIs(error::INTERNAL, HasSubstr("out of order")));
+}
+
 TEST(CachingTaskRunnerTest, ConcurrentTrainers) {
   size_t range = 100;
   size_t num_readers = 10;
@@ -15,6 +15,7 @@ limitations under the License.
 #include "tensorflow/core/data/service/worker_client.h"
 
 #include <cstdint>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <string>
@@ -26,10 +27,14 @@ limitations under the License.
 #include "grpcpp/security/credentials.h"
 #include "grpcpp/support/channel_arguments.h"
 #include "grpcpp/support/status.h"
+#include "grpcpp/support/sync_stream.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/memory/memory.h"
+#include "absl/status/status.h"
 #include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
+#include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/service/credentials_factory.h"
 #include "tensorflow/core/data/service/data_transfer.h"
 #include "tensorflow/core/data/service/grpc_util.h"
@@ -104,7 +109,9 @@ class GrpcDataTransferClient : public DataTransferClient {
  public:
   GrpcDataTransferClient(std::shared_ptr<grpc::ChannelCredentials> credentials,
                          std::string address, Allocator* allocator)
-      : allocator_(allocator) {
+      : allocator_(allocator),
+        use_streaming_(
+            GetExperiments().contains("data_service_streaming_transfer")) {
     VLOG(2) << "Create GrpcDataTransferClient for worker " << address << ".";
     grpc::ChannelArguments args;
     args.SetMaxReceiveMessageSize(-1);
@@ -122,6 +129,31 @@ class GrpcDataTransferClient : public DataTransferClient {
         return errors::Cancelled("Client was cancelled.");
       }
     }
+    if (use_streaming_ && !req.has_round_index()) {
+      std::shared_ptr<ElementStream> stream;
+      {
+        mutex_lock l(mu_);
+        if (!streaming_unimplemented_) {
+          std::shared_ptr<ElementStream>& task_stream =
+              streams_[req.task_id()];
+          if (!task_stream) {
+            task_stream = std::make_shared<ElementStream>();
+          }
+          stream = task_stream;
+        }
+      }
+      if (stream) {
+        absl::Status s = StreamElement(req, *stream, result);
+        if (!absl::IsUnimplemented(s)) {
+          return s;
+        }
+        // The worker predates `StreamElements`.
+        VLOG(1) << "Falling back to unary GetElement requests: " << s;
+        mutex_lock l(mu_);
+        streaming_unimplemented_ = true;
+        streams_.clear();
+      }
+    }
     grpc::ClientContext ctx;
     gtl::Cleanup<std::function<void()>> cleanup;
     {
@@ -141,6 +173,118 @@ class GrpcDataTransferClient : public DataTransferClient {
     }
     metrics::RecordTFDataServiceGetElementDuration(kGrpcTransferProtocol,
                                                    end_time_us - start_time_us);
+    return ParseResponse(resp, result);
+  }
+
+  void TryCancel() override {
+    VLOG(2) << "Cancel GrpcDataTransferClient.";
+    mutex_lock l(mu_);
+    cancelled_ = true;
+    for (const auto& ctx : active_contexts_) {
+      ctx->TryCancel();
+    }
+    for (const auto& [task_id, stream] : streams_) {
+      stream->ctx.TryCancel();
+    }
+  }
+
+ private:
+  // The number of elements the worker may send per window, and the number of
+  // elements the client keeps requested ahead of its reads.
+  static constexpr int64_t kStreamWindowSize = 16;
+  static constexpr int64_t kMaxStreamedElements = 2 * kStreamWindowSize;
+
+  // A `StreamElements` call reading the elements of one task.
+  struct ElementStream {
+    ~ElementStream() {
+      mutex_lock l(mu);
+      Close();
+    }
+
+    // Cancels and finishes the call. Elements in flight are dropped.
+    void Close() TF_EXCLUSIVE_LOCKS_REQUIRED(mu) {
+      if (call && !closed) {
+        ctx.TryCancel();
+        call->Finish().IgnoreError();
+      }
+      closed = true;
+    }
+
+    mutex mu;
+    grpc::ClientContext ctx;
+    std::unique_ptr<
+        grpc::ClientReaderWriter<StreamElementsRequest, GetElementResponse>>
+        call TF_GUARDED_BY(mu);
+    // The number of elements still to be received in each window sent,
+    // oldest first.
+    std::deque<int64_t> windows TF_GUARDED_BY(mu);
+    int64_t num_requested TF_GUARDED_BY(mu) = 0;
+    bool closed TF_GUARDED_BY(mu) = false;
+  };
+
+  // Reads the next element of `req.task_id()` from its element stream,
+  // granting the worker another window of credits when the number of
+  // requested elements runs low.
+  absl::Status StreamElement(const GetElementRequest& req,
+                             ElementStream& stream, GetElementResult& result)
+      TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(stream.mu);
+    if (stream.closed) {
+      return errors::Cancelled("Client was cancelled.");
+    }
+    if (!stream.call) {
+      stream.call = stub_->StreamElements(&stream.ctx);
+    }
+    if (stream.num_requested <= kMaxStreamedElements - kStreamWindowSize) {
+      StreamElementsRequest window;
+      *window.mutable_element_request() = req;
+      window.set_num_elements(kStreamWindowSize);
+      if (stream.call->Write(window)) {
+        stream.windows.push_back(kStreamWindowSize);
+        stream.num_requested += kStreamWindowSize;
+      }
+    }
+    GetElementResponse resp;
+    int64_t start_time_us = env_->NowMicros();
+    const bool read = !stream.windows.empty() && stream.call->Read(&resp);
+    int64_t end_time_us = env_->NowMicros();
+    if (!read) {
+      grpc::Status s = stream.call->Finish();
+      stream.closed = true;
+      ResetStream(req.task_id());
+      if (s.ok()) {
+        s = grpc::Status(grpc::StatusCode::UNAVAILABLE,
+                         "Element stream ended unexpectedly.");
+      }
+      return grpc_util::WrapError("Failed to stream element", s);
+    }
+    metrics::RecordTFDataServiceGetElementDuration(kGrpcTransferProtocol,
+                                                   end_time_us - start_time_us);
+    --stream.windows.front();
+    --stream.num_requested;
+    if (resp.end_of_sequence() || resp.skip_task()) {
+      // The worker drops the rest of the window.
+      stream.num_requested -= stream.windows.front();
+      stream.windows.front() = 0;
+    }
+    if (stream.windows.front() == 0) {
+      stream.windows.pop_front();
+    }
+    if (resp.end_of_sequence()) {
+      stream.Close();
+      ResetStream(req.task_id());
+    }
+    return ParseResponse(resp, result);
+  }
+
+  // Drops the stream of `task_id`, so that the next read starts a new one.
+  void ResetStream(int64_t task_id) TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    streams_.erase(task_id);
+  }
+
+  absl::Status ParseResponse(GetElementResponse& resp,
+                             GetElementResult& result) {
     result.end_of_sequence = resp.end_of_sequence();
     result.skip = resp.skip_task();
     switch (resp.element_case()) {
@@ -162,23 +306,19 @@ class GrpcDataTransferClient : public DataTransferClient {
           }
         }
         break;
+      case GetElementResponse::kSharedMemory:
+        return errors::Internal(
+            "Received a shared memory element over the gRPC transfer "
+            "protocol.");
       case GetElementResponse::ELEMENT_NOT_SET:
         break;
     }
     return absl::OkStatus();
   }
 
-  void TryCancel() override {
-    VLOG(2) << "Cancel GrpcDataTransferClient.";
-    mutex_lock l(mu_);
-    cancelled_ = true;
-    for (const auto& ctx : active_contexts_) {
-      ctx->TryCancel();
-    }
-  }
-
- private:
   Allocator* const allocator_;
+  // Whether reads other than round-robin reads stream elements.
+  const bool use_streaming_;
   mutex mu_;
   std::unique_ptr<WorkerService::Stub> stub_;
   // Set of all currently active clients contexts. Used to support
@@ -188,6 +328,11 @@ class GrpcDataTransferClient : public DataTransferClient {
   // Indicates that the client has been cancelled, so no further requests should
   // be accepted.
   bool cancelled_ TF_GUARDED_BY(mu_) = false;
+  // The element streams of the tasks read from the worker.
+  absl::flat_hash_map<int64_t, std::shared_ptr<ElementStream>> streams_
+      TF_GUARDED_BY(mu_);
+  // Set when the worker does not implement `StreamElements`.
+  bool streaming_unimplemented_ TF_GUARDED_BY(mu_) = false;
 };
 
 class GrpcTransferClientRegistrar {
@@ -275,6 +275,37 @@ TEST_P(DataTransferProtocolWorkerClientTest, NetworkRead) {
   }
 }
 
+TEST_F(WorkerClientTest, StreamingNetworkRead) {
+  setenv("TF_JOB_NAME", "test_job", /*overwrite=*/1);
+  setenv("TF_TASK_ID", "0", /*overwrite=*/1);
+  setenv("TF_DATA_EXPERIMENT_OPT_IN", "data_service_streaming_transfer",
+         /*overwrite=*/1);
+  // Consider the worker to be remote so that local protocol isn't forced on.
+  LocalWorkers::Remove(GetWorkerAddress());
+
+  // More elements than fit in the stream windows requested at a time.
+  const int64_t range = 100;
+  TF_ASSERT_OK_AND_ASSIGN(const std::string dataset_id, RegisterDataset(range));
+  TF_ASSERT_OK_AND_ASSIGN(const int64_t iteration_client_id,
+                          CreateIteration(dataset_id));
+  TF_ASSERT_OK_AND_ASSIGN(const int64_t task_id,
+                          GetTaskToRead(iteration_client_id));
+  TF_ASSERT_OK_AND_ASSIGN(std::unique_ptr<DataServiceWorkerClient> client,
+                          GetWorkerClient(kGrpcTransferProtocol));
+  for (int64_t i = 0; i < range; ++i) {
+    TF_ASSERT_OK_AND_ASSIGN(GetElementResult result,
+                            GetElement(*client, task_id));
+    test::ExpectEqual(result.components[0], Tensor(int64_t{i * i}));
+    EXPECT_FALSE(result.end_of_sequence);
+  }
+  TF_ASSERT_OK_AND_ASSIGN(GetElementResult result,
+                          GetElement(*client, task_id));
+  EXPECT_TRUE(result.end_of_sequence);
+  unsetenv("TF_JOB_NAME");
+  unsetenv("TF_TASK_ID");
+  unsetenv("TF_DATA_EXPERIMENT_OPT_IN");
+}
+
 INSTANTIATE_TEST_SUITE_P(
     NetworkProtocols, DataTransferProtocolWorkerClientTest,
     ::testing::Values(kGrpcTransferProtocol, kAltTransferProtocol),
@@ -449,9 +449,15 @@ DataServiceWorkerImpl::MakeDatasetIterator(standalone::Dataset& dataset,
     std::vector<std::unique_ptr<SplitProvider>> split_providers;
     split_providers.reserve(task_def.num_split_providers());
     for (int i = 0; i < task_def.num_split_providers(); ++i) {
-      split_providers.push_back(std::make_unique<DataServiceSplitProvider>(
-          config_.dispatcher_address(), config_.protocol(),
-          task_def.iteration_id(), i, config_.dispatcher_timeout_ms()));
+      std::unique_ptr<SplitProvider> split_provider =
+          std::make_unique<DataServiceSplitProvider>(
+              config_.dispatcher_address(), config_.protocol(),
+              task_def.iteration_id(), i, config_.dispatcher_timeout_ms());
+      if (config_.split_prefetch_buffer_size() > 0) {
+        split_provider = std::make_unique<PrefetchingSplitProvider>(
+            std::move(split_provider), config_.split_prefetch_buffer_size());
+      }
+      split_providers.push_back(std::move(split_provider));
     }
     TF_RETURN_IF_ERROR(
         dataset.MakeIterator(std::move(split_providers), &iterator));
@@ -743,15 +749,15 @@ absl::Status DataServiceWorkerImpl::UpdateSnapshotWriters(
         &dataset_def));
     TF_ASSIGN_OR_RETURN(std::unique_ptr<StandaloneTaskIterator> iterator,
                         MakeSnapshotTaskIterator(snapshot_task, dataset_def));
+    SnapshotWriterParams writer_params{
+        snapshot_task.base_path(), snapshot_task.stream_index(),
+        snapshot_task.metadata().compression(), Env::Default(),
+        ByteSize::Bytes(config_.snapshot_max_chunk_size_bytes())};
+    writer_params.max_pending_commits = config_.snapshot_max_pending_commits();
     mutex_lock l(mu_);
-    snapshot_writers_.emplace(
-        snapshot_task_key,
-        std::make_unique<SnapshotStreamWriter>(
-            SnapshotWriterParams{
-                snapshot_task.base_path(), snapshot_task.stream_index(),
-                snapshot_task.metadata().compression(), Env::Default(),
-                ByteSize::Bytes(config_.snapshot_max_chunk_size_bytes())},
-            std::move(iterator)));
+    snapshot_writers_.emplace(snapshot_task_key,
+                              std::make_unique<SnapshotStreamWriter>(
+                                  writer_params, std::move(iterator)));
   }
 
   // Cancel writers for snapshots that are no longer assigned by the dispatcher.
@@ -0,0 +1,115 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/worker_scaler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_join.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+mutex* get_lock() {
+  static mutex lock(LINKER_INITIALIZED);
+  return &lock;
+}
+
+using WorkerScalerFactories =
+    std::unordered_map<std::string, WorkerScaler::FactoryT>;
+WorkerScalerFactories& worker_scaler_factories() {
+  static auto& factories = *new WorkerScalerFactories();
+  return factories;
+}
+}  // namespace
+
+void WorkerScaler::Register(std::string name, FactoryT factory) {
+  mutex_lock l(*get_lock());
+  if (!worker_scaler_factories().insert({name, factory}).second) {
+    LOG(ERROR) << "Two worker scaler factories are being registered with name "
+               << name << ". Which one gets used is undefined.";
+  }
+}
+
+absl::Status WorkerScaler::Build(std::string name,
+                                 const experimental::DispatcherConfig& config,
+                                 std::unique_ptr<WorkerScaler>* out) {
+  mutex_lock l(*get_lock());
+  auto it = worker_scaler_factories().find(name);
+  if (it != worker_scaler_factories().end()) {
+    return it->second(config, out);
+  }
+
+  std::vector<std::string> available_names;
+  for (const auto& factory : worker_scaler_factories()) {
+    available_names.push_back(factory.first);
+  }
+
+  return errors::NotFound(
+      "No worker scaler factory has been registered for name ", name,
+      ". The available names are: [ ", absl::StrJoin(available_names, ", "),
+      " ]");
+}
+
+std::optional<int64_t> WorkerScalingController::Update(
+    int64_t current_num_workers, std::optional<int64_t> optimal_num_workers,
+    absl::Time now) {
+  if (!optimal_num_workers.has_value() || current_num_workers <= 0) {
+    direction_ = 0;
+    return std::nullopt;
+  }
+
+  const int64_t target_num_workers =
+      std::max(*optimal_num_workers, options_.min_workers);
+  const double tolerance = options_.tolerance * current_num_workers;
+  int direction = 0;
+  if (target_num_workers > current_num_workers + tolerance) {
+    direction = 1;
+  } else if (target_num_workers < current_num_workers - tolerance) {
+    direction = -1;
+  }
+
+  if (direction == 0) {
+    direction_ = 0;
+    return std::nullopt;
+  }
+  if (direction != direction_) {
+    direction_ = direction;
+    direction_start_time_ = now;
+  }
+  const absl::Duration delay =
+      direction > 0 ? options_.scale_up_delay : options_.scale_down_delay;
+  if (now - direction_start_time_ < delay) {
+    return std::nullopt;
+  }
+  direction_ = 0;
+  return target_num_workers;
+}
+
+}  // namespace data
+}  // namespace tensorflow
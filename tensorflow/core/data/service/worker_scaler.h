@@ -0,0 +1,106 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_CORE_DATA_SERVICE_WORKER_SCALER_H_
+#define TENSORFLOW_CORE_DATA_SERVICE_WORKER_SCALER_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
+
+namespace tensorflow {
+namespace data {
+
+// Changes the number of tf.data service workers, e.g. by calling a cluster
+// manager. The dispatcher uses the WorkerScaler registered under
+// `DispatcherConfig.worker_scaler` to act on the number of workers estimated by
+// MultipleIterationsAutoScaler.
+//
+// Both methods are called from the dispatcher's maintenance thread, without
+// holding dispatcher locks.
+class WorkerScaler {
+ public:
+  using FactoryT = std::function<absl::Status(
+      const experimental::DispatcherConfig&, std::unique_ptr<WorkerScaler>*)>;
+  virtual ~WorkerScaler() = default;
+
+  // Requests `num_workers` additional workers. New workers register with the
+  // dispatcher as usual.
+  virtual absl::Status AddWorkers(int64_t num_workers) = 0;
+
+  // Releases the workers with `worker_addresses`. The dispatcher has stopped
+  // assigning tasks to them, and their tasks have finished or the drain has
+  // timed out.
+  virtual absl::Status ReleaseWorkers(
+      const std::vector<std::string>& worker_addresses) = 0;
+
+  // Registers a WorkerScaler factory under `name`.
+  static void Register(std::string name, FactoryT factory);
+
+  // Builds a WorkerScaler from the factory registered under `name`.
+  static absl::Status Build(std::string name,
+                            const experimental::DispatcherConfig& config,
+                            std::unique_ptr<WorkerScaler>* out);
+};
+
+// Decides when to resize the tf.data service cluster, with hysteresis.
+//
+// The cluster is only resized if the optimal number of workers differs from
+// the current number by more than `tolerance` (relative to the current number),
+// and it has consistently done so in the same direction for `scale_up_delay`
+// (`scale_down_delay` when shrinking). Scaling down is usually delayed longer,
+// since drained workers are slow to get back. Each decision restarts the delay,
+// which also rate-limits consecutive decisions.
+//
+// This class is not thread-safe.
+class WorkerScalingController {
+ public:
+  struct Options {
+    double tolerance = 0.1;
+    absl::Duration scale_up_delay = absl::Minutes(1);
+    absl::Duration scale_down_delay = absl::Minutes(10);
+    int64_t min_workers = 1;
+  };
+
+  explicit WorkerScalingController(const Options& options)
+      : options_(options) {}
+
+  // Updates the controller with the current and the estimated optimal number
+  // of workers at time `now`. Returns the number of workers the cluster should
+  // be resized to, or nullopt if it should not be resized now.
+  std::optional<int64_t> Update(int64_t current_num_workers,
+                                std::optional<int64_t> optimal_num_workers,
+                                absl::Time now);
+
+ private:
+  const Options options_;
+  // The direction of the pending decision: positive to scale up, negative to
+  // scale down, 0 if there is none.
+  int direction_ = 0;
+  // When the optimal number of workers left the tolerance band in
+  // `direction_`.
+  absl::Time direction_start_time_;
+};
+
+}  // namespace data
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_DATA_SERVICE_WORKER_SCALER_H_
@@ -0,0 +1,125 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/core/data/service/worker_scaler.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/protobuf/service_config.pb.h"
+#include "tsl/platform/status_matchers.h"
+
+namespace tensorflow {
+namespace data {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Optional;
+using ::tsl::testing::StatusIs;
+
+WorkerScalingController::Options TestOptions() {
+  WorkerScalingController::Options options;
+  options.tolerance = 0.1;
+  options.scale_up_delay = absl::Minutes(1);
+  options.scale_down_delay = absl::Minutes(10);
+  return options;
+}
+
+TEST(WorkerScalingControllerTest, ScalesUpAfterDelay) {
+  WorkerScalingController controller(TestOptions());
+  absl::Time now = absl::UnixEpoch();
+  EXPECT_EQ(controller.Update(10, 15, now), std::nullopt);
+  EXPECT_EQ(controller.Update(10, 15, now + absl::Seconds(30)), std::nullopt);
+  EXPECT_THAT(controller.Update(10, 15, now + absl::Minutes(1)), Optional(15));
+  // The decision restarts the delay.
+  EXPECT_EQ(controller.Update(10, 15, now + absl::Minutes(1)), std::nullopt);
+}
+
+TEST(WorkerScalingControllerTest, ScalesDownAfterLongerDelay) {
+  WorkerScalingController controller(TestOptions());
+  absl::Time now = absl::UnixEpoch();
+  EXPECT_EQ(controller.Update(10, 5, now), std::nullopt);
+  EXPECT_EQ(controller.Update(10, 5, now + absl::Minutes(1)), std::nullopt);
+  EXPECT_THAT(controller.Update(10, 5, now + absl::Minutes(10)), Optional(5));
+}
+
+TEST(WorkerScalingControllerTest, DoesNotScaleWithinTolerance) {
+  WorkerScalingController controller(TestOptions());
+  absl::Time now = absl::UnixEpoch();
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_EQ(controller.Update(10, i % 2 == 0 ? 9 : 11,
+                                now + absl::Minutes(i)),
+              std::nullopt);
+  }
+}
+
+TEST(WorkerScalingControllerTest, UnknownOptimalNumberRestartsDelay) {
+  WorkerScalingController controller(TestOptions());
+  absl::Time now = absl::UnixEpoch();
+  EXPECT_EQ(controller.Update(10, 15, now), std::nullopt);
+  EXPECT_EQ(controller.Update(10, std::nullopt, now + absl::Seconds(30)),
+            std::nullopt);
+  EXPECT_EQ(controller.Update(10, 15, now + absl::Minutes(1)), std::nullopt);
+  EXPECT_THAT(controller.Update(10, 15, now + absl::Minutes(2)), Optional(15));
+}
+
+TEST(WorkerScalingControllerTest, KeepsMinWorkers) {
+  WorkerScalingController controller(TestOptions());
+  absl::Time now = absl::UnixEpoch();
+  EXPECT_EQ(controller.Update(10, 0, now), std::nullopt);
+  EXPECT_THAT(controller.Update(10, 0, now + absl::Minutes(10)), Optional(1));
+}
+
+class TestWorkerScaler : public WorkerScaler {
+ public:
+  absl::Status AddWorkers(int64_t num_workers) override {
+    return absl::OkStatus();
+  }
+  absl::Status ReleaseWorkers(
+      const std::vector<std::string>& worker_addresses) override {
+    return absl::OkStatus();
+  }
+};
+
+TEST(WorkerScalerTest, BuildRegisteredScaler) {
+  WorkerScaler::Register(
+      "test_scaler", [](const experimental::DispatcherConfig& config,
+                        std::unique_ptr<WorkerScaler>* out) {
+        *out = std::make_unique<TestWorkerScaler>();
+        return absl::OkStatus();
+      });
+  std::unique_ptr<WorkerScaler> scaler;
+  TF_ASSERT_OK(WorkerScaler::Build("test_scaler",
+                                   experimental::DispatcherConfig(), &scaler));
+  EXPECT_NE(scaler, nullptr);
+}
+
+TEST(WorkerScalerTest, BuildUnregisteredScaler) {
+  std::unique_ptr<WorkerScaler> scaler;
+  EXPECT_THAT(WorkerScaler::Build("unregistered",
+                                  experimental::DispatcherConfig(), &scaler),
+              StatusIs(absl::StatusCode::kNotFound,
+                       HasSubstr("No worker scaler factory")));
+}
+
+}  // namespace
+}  // namespace data
+}  // namespace tensorflow
@@ -16,15 +16,21 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstdint>
+#include <list>
 #include <memory>
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/framework/summary.pb.h"
+#include "tensorflow/core/lib/histogram/histogram.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tsl/platform/thread_annotations.h"
@@ -95,16 +101,134 @@ absl::Duration ApproximateLatencyEstimator::GetAverageLatency(Duration duration)
   return absl::Duration(absl::Microseconds(interval_latency)) / interval_count;
 }
 
+ModelStatsSampler::ModelStatsSampler(const Env& env,
+                                     std::shared_ptr<model::Model> model)
+    : env_(env), model_(std::move(model)) {}
+
+void ModelStatsSampler::MaybeSample() {
+  if (!model_) {
+    return;
+  }
+  const int64_t now_usec = env_.NowMicros();
+  int64_t next_sample_time_usec = next_sample_time_usec_.load();
+  // Only the caller that advances the sample time takes the sample.
+  if (now_usec < next_sample_time_usec ||
+      !next_sample_time_usec_.compare_exchange_strong(
+          next_sample_time_usec, now_usec + kSamplingPeriodUsec)) {
+    return;
+  }
+  std::vector<NodeSample> sample = SampleNodes();
+  mutex_lock l(mu_);
+  samples_.push_back(std::move(sample));
+  if (samples_.size() > kMaxSamples) {
+    samples_.pop_front();
+  }
+}
+
+std::vector<ModelStatsSampler::NodeSample> ModelStatsSampler::SampleNodes()
+    const {
+  std::vector<NodeSample> sample;
+  std::shared_ptr<model::Node> root = model_->output();
+  if (!root) {
+    return sample;
+  }
+  // Depth-first traversal, so that each node follows its output.
+  std::vector<std::pair<std::shared_ptr<model::Node>, std::string>> stack;
+  stack.emplace_back(root, root->long_name());
+  while (!stack.empty()) {
+    auto [node, node_stack] = std::move(stack.back());
+    stack.pop_back();
+    NodeSample node_sample;
+    node_sample.id = node->id();
+    node_sample.processing_time_nsec = node->processing_time();
+    node_sample.buffered_elements = node->buffered_elements();
+    absl::StatusOr<double> parallelism =
+        node->ParameterValue(model::kParallelism);
+    if (parallelism.ok()) {
+      node_sample.parallelism = *parallelism;
+    }
+    std::list<std::shared_ptr<model::Node>> inputs = node->inputs();
+    for (auto it = inputs.rbegin(); it != inputs.rend(); ++it) {
+      stack.emplace_back(*it,
+                         absl::StrCat(node_stack, ";", (*it)->long_name()));
+    }
+    node_sample.stack = std::move(node_stack);
+    sample.push_back(std::move(node_sample));
+  }
+  return sample;
+}
+
+std::vector<ModelStatsSampler::NodeSummary>
+ModelStatsSampler::GetNodeSummaries() {
+  struct NodeStats {
+    std::string stack;
+    int64_t first_processing_time_nsec;
+    int64_t last_processing_time_nsec;
+    histogram::Histogram buffered_elements;
+    histogram::Histogram parallelism;
+  };
+  // The nodes in the order of their first sample.
+  std::vector<int64_t> ids;
+  absl::flat_hash_map<int64_t, std::unique_ptr<NodeStats>> stats;
+  {
+    mutex_lock l(mu_);
+    for (const auto& sample : samples_) {
+      for (const NodeSample& node_sample : sample) {
+        std::unique_ptr<NodeStats>& node_stats = stats[node_sample.id];
+        if (!node_stats) {
+          ids.push_back(node_sample.id);
+          node_stats = std::make_unique<NodeStats>();
+          node_stats->stack = node_sample.stack;
+          node_stats->first_processing_time_nsec =
+              node_sample.processing_time_nsec;
+        }
+        node_stats->last_processing_time_nsec =
+            node_sample.processing_time_nsec;
+        node_stats->buffered_elements.Add(node_sample.buffered_elements);
+        if (node_sample.parallelism.has_value()) {
+          node_stats->parallelism.Add(*node_sample.parallelism);
+        }
+      }
+    }
+  }
+  std::vector<NodeSummary> summaries(ids.size());
+  for (int i = 0; i < ids.size(); ++i) {
+    NodeStats& node_stats = *stats[ids[i]];
+    summaries[i].stack = std::move(node_stats.stack);
+    summaries[i].self_time =
+        absl::Nanoseconds(node_stats.last_processing_time_nsec -
+                          node_stats.first_processing_time_nsec);
+    node_stats.buffered_elements.EncodeToProto(
+        &summaries[i].buffered_elements, /*preserve_zero_buckets=*/false);
+    node_stats.parallelism.EncodeToProto(&summaries[i].parallelism,
+                                         /*preserve_zero_buckets=*/false);
+  }
+  return summaries;
+}
+
+std::string ModelStatsSampler::GetFlameProfile() {
+  std::string profile;
+  for (const NodeSummary& summary : GetNodeSummaries()) {
+    absl::StrAppend(&profile, summary.stack, " ",
+                    absl::ToInt64Microseconds(summary.self_time), "\n");
+  }
+  return profile;
+}
+
 TfDatazMetricsCollector::TfDatazMetricsCollector(
     const Env& env, DatasetBaseIterator* iterator,
     std::shared_ptr<model::Model> model)
-    : iterator_(iterator), model_(std::move(model)), latency_estimator_(env) {}
+    : iterator_(iterator),
+      model_(std::move(model)),
+      latency_estimator_(env),
+      model_stats_sampler_(env, model_) {}
 
 void TfDatazMetricsCollector::RecordGetNextLatency(
     int64_t get_next_latency_usec) {
   if (get_next_latency_usec > 0) {
     latency_estimator_.AddLatency(get_next_latency_usec);
   }
+  model_stats_sampler_.MaybeSample();
 }
 
 absl::Duration TfDatazMetricsCollector::GetAverageLatencyForLastOneMinute() {
@@ -138,6 +262,15 @@ std::shared_ptr<model::Model> TfDatazMetricsCollector::GetModel() {
   return model_;
 }
 
+std::vector<ModelStatsSampler::NodeSummary>
+TfDatazMetricsCollector::GetNodeSummaries() {
+  return model_stats_sampler_.GetNodeSummaries();
+}
+
+std::string TfDatazMetricsCollector::GetFlameProfile() {
+  return model_stats_sampler_.GetFlameProfile();
+}
+
 namespace {
 static mutex* get_tfdataz_metrics_registry_lock() {
   static mutex tfdataz_metrics_registry_lock(LINKER_INITIALIZED);
@@ -15,15 +15,19 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_TFDATAZ_METRICS_H_
 #define TENSORFLOW_CORE_DATA_TFDATAZ_METRICS_H_
 
+#include <atomic>
 #include <cstdint>
+#include <deque>
 #include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/model.h"
+#include "tensorflow/core/framework/summary.pb.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -88,6 +92,64 @@ class ApproximateLatencyEstimator {
   int64_t latency_count_[kSlots] TF_GUARDED_BY(mu_);
 };
 
+// Samples the per-node statistics of the model of an input pipeline at most
+// once per second and summarizes the samples of the past minute. Sampling does
+// not require profiling to be enabled, so it can stay on in production to
+// diagnose input-bound jobs.
+class ModelStatsSampler {
+ public:
+  // The statistics of one node over the samples of the past minute.
+  struct NodeSummary {
+    // The long names of the nodes from the root of the pipeline to this node,
+    // separated by ';' as in the folded stack format of flame graphs.
+    std::string stack;
+    // The processing time of the node itself, excluding its inputs.
+    absl::Duration self_time;
+    // The distribution of the number of elements buffered by the node.
+    HistogramProto buffered_elements;
+    // The distribution of the parallelism of the node. Empty if the node has
+    // no parallelism parameter.
+    HistogramProto parallelism;
+  };
+
+  ModelStatsSampler(const Env& env, std::shared_ptr<model::Model> model);
+
+  // Samples the model if at least a second has passed since the last sample.
+  void MaybeSample() TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the summaries of the nodes sampled in the past minute, with each
+  // node following its output.
+  std::vector<NodeSummary> GetNodeSummaries() TF_LOCKS_EXCLUDED(mu_);
+
+  // Returns the self time of the nodes in the folded stack format of flame
+  // graphs, i.e. one "<stack> <self time in microseconds>" line per node.
+  std::string GetFlameProfile() TF_LOCKS_EXCLUDED(mu_);
+
+ private:
+  static constexpr int64_t kSamplingPeriodUsec = 1000 * 1000;
+  static constexpr int64_t kMaxSamples = 60;
+
+  struct NodeSample {
+    int64_t id;
+    std::string stack;
+    // Cumulative processing time of the node.
+    int64_t processing_time_nsec;
+    int64_t buffered_elements;
+    std::optional<double> parallelism;
+  };
+
+  // Returns the samples of all nodes, each following its output.
+  std::vector<NodeSample> SampleNodes() const;
+
+  const Env& env_;
+  const std::shared_ptr<model::Model> model_;
+  std::atomic<int64_t> next_sample_time_usec_ = 0;
+
+  mutex mu_;
+  // The samples of the past minute, oldest first.
+  std::deque<std::vector<NodeSample>> samples_ TF_GUARDED_BY(mu_);
+};
+
 // Collects and exports the tf.data performance metrics to /tfdataz.
 class TfDatazMetricsCollector {
  public:
@@ -98,7 +160,8 @@ class TfDatazMetricsCollector {
   TfDatazMetricsCollector(const Env& env, DatasetBaseIterator* iterator,
                           std::shared_ptr<model::Model> model);
 
-  // Records `GetNext` call latency.
+  // Records `GetNext` call latency, and samples the per-node statistics of the
+  // model with the period of `ModelStatsSampler`.
   void RecordGetNextLatency(int64_t get_next_latency_usec);
 
   // Returns the average `GetNext` latency for past 1 minute.
@@ -120,10 +183,17 @@ class TfDatazMetricsCollector {
 
   std::shared_ptr<model::Model> GetModel();
 
+  // Returns the per-node statistics of the past minute.
+  std::vector<ModelStatsSampler::NodeSummary> GetNodeSummaries();
+
+  // Returns the per-node self time of the past minute as a flame profile.
+  std::string GetFlameProfile();
+
  private:
   DatasetBaseIterator* iterator_;  // not owned
   std::shared_ptr<model::Model> model_;
   ApproximateLatencyEstimator latency_estimator_;
+  ModelStatsSampler model_stats_sampler_;
 };
 
 // Thread-safe global registry for the /tfdataz metrics. All callers to
@@ -16,9 +16,11 @@ limitations under the License.
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "absl/time/time.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/util/fake_clock_env.h"
@@ -179,6 +181,52 @@ TEST_F(TfDatazMetricsTest, GetAverageLatencyWithZeroGetNextCalls) {
                   0);
 }
 
+TEST(ModelStatsSamplerTest, NodeSummaries) {
+  FakeClockEnv env(Env::Default());
+  auto model = std::make_shared<model::Model>();
+  std::shared_ptr<model::Node> root;
+  model->AddNode(
+      [](model::Node::Args args) {
+        return model::MakeAsyncKnownRatioNode(
+            std::move(args), /*ratio=*/1,
+            {model::MakeParameter(model::kParallelism, /*state=*/nullptr,
+                                  /*min=*/1, /*max=*/8, /*value=*/4)});
+      },
+      "ParallelMapV2", /*parent=*/nullptr, &root);
+  std::shared_ptr<model::Node> input;
+  model->AddNode(
+      [](model::Node::Args args) {
+        return model::MakeSourceNode(std::move(args));
+      },
+      "TFRecordDataset", root, &input);
+  TfDatazMetricsCollector collector(env, /*iterator=*/nullptr, model);
+
+  collector.RecordGetNextLatency(1);
+  root->add_processing_time(3000);
+  input->add_processing_time(5000);
+  root->record_buffer_event(/*bytes_delta=*/0, /*elements_delta=*/2);
+  // Not sampled, because less than a second has passed.
+  collector.RecordGetNextLatency(1);
+  env.AdvanceByMicroseconds(k1MinutesInMicros / 60);
+  collector.RecordGetNextLatency(1);
+
+  std::vector<ModelStatsSampler::NodeSummary> summaries =
+      collector.GetNodeSummaries();
+  ASSERT_EQ(summaries.size(), 2);
+  EXPECT_EQ(summaries[0].stack, "ParallelMapV2(id:0)");
+  EXPECT_EQ(summaries[0].self_time, absl::Microseconds(3));
+  EXPECT_EQ(summaries[0].buffered_elements.num(), 2);
+  EXPECT_EQ(summaries[0].buffered_elements.max(), 2);
+  EXPECT_EQ(summaries[0].parallelism.num(), 2);
+  EXPECT_EQ(summaries[0].parallelism.max(), 4);
+  EXPECT_EQ(summaries[1].stack, "ParallelMapV2(id:0);TFRecordDataset(id:1)");
+  EXPECT_EQ(summaries[1].self_time, absl::Microseconds(5));
+  EXPECT_EQ(summaries[1].parallelism.num(), 0);
+  EXPECT_EQ(collector.GetFlameProfile(),
+            "ParallelMapV2(id:0) 3\n"
+            "ParallelMapV2(id:0);TFRecordDataset(id:1) 5\n");
+}
+
 class ScopedTfDataMetricsRegistration {
  public:
   explicit ScopedTfDataMetricsRegistration(
@@ -23,7 +23,9 @@ limitations under the License.
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/numa.h"
 #include "tensorflow/core/platform/resource.h"
+#include "tensorflow/core/platform/strcat.h"
 #include "tensorflow/core/platform/unbounded_work_queue.h"
 
 namespace tensorflow {
@@ -69,6 +71,21 @@ class UnboundedThreadPool::LogicalThreadFactory : public ThreadFactory {
   UnboundedThreadPool* const pool_;  // Not owned.
 };
 
+UnboundedThreadPool::UnboundedThreadPool(Env* env, const string& thread_name,
+                                         const ThreadOptions& thread_options,
+                                         bool numa_aware)
+    : unbounded_work_queue_(env, thread_name, thread_options) {
+  if (!numa_aware || !port::NUMAEnabled() || port::NUMANumNodes() <= 1) {
+    return;
+  }
+  for (int node = 0; node < port::NUMANumNodes(); ++node) {
+    ThreadOptions node_thread_options = thread_options;
+    node_thread_options.numa_node = node;
+    numa_work_queues_.push_back(std::make_unique<UnboundedWorkQueue>(
+        env, strings::StrCat(thread_name, "_numa", node), node_thread_options));
+  }
+}
+
 std::shared_ptr<ThreadFactory> UnboundedThreadPool::get_thread_factory() {
   return std::make_shared<LogicalThreadFactory>(this);
 }
@@ -97,8 +114,17 @@ void WorkQueueFunc(const std::function<void()>& fn,
 
 void UnboundedThreadPool::ScheduleOnWorkQueue(
     std::function<void()> fn, std::shared_ptr<Notification> done) {
-  unbounded_work_queue_.Schedule(
-      std::bind(&WorkQueueFunc, std::move(fn), std::move(done)));
+  auto work = std::bind(&WorkQueueFunc, std::move(fn), std::move(done));
+  if (numa_work_queues_.empty()) {
+    unbounded_work_queue_.Schedule(std::move(work));
+    return;
+  }
+  const int num_nodes = numa_work_queues_.size();
+  int node = port::NUMAGetThreadNodeAffinity();
+  if (node < 0 || node >= num_nodes) {
+    node = next_numa_node_.fetch_add(1, std::memory_order_relaxed) % num_nodes;
+  }
+  numa_work_queues_[node]->Schedule(std::move(work));
 }
 
 }  // namespace data
@@ -15,6 +15,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DATA_UNBOUNDED_THREAD_POOL_H_
 #define TENSORFLOW_CORE_DATA_UNBOUNDED_THREAD_POOL_H_
 
+#include <atomic>
+#include <cstdint>
 #include <deque>
 #include <functional>
 #include <memory>
@@ -40,6 +42,13 @@ class UnboundedThreadPool : public thread::ThreadPoolInterface {
   UnboundedThreadPool(Env* env, const string& thread_name,
                       const ThreadOptions& thread_options)
       : unbounded_work_queue_(env, thread_name, thread_options) {}
+  // If `numa_aware` is true and NUMA is enabled on a host with more than one
+  // node, the pool keeps separate physical threads for each node, pinned to
+  // it. Work scheduled from a thread with a NUMA affinity runs on the threads
+  // of that node, so that the buffers it produces are local to its consumer.
+  // Other work is spread across the nodes.
+  UnboundedThreadPool(Env* env, const string& thread_name,
+                      const ThreadOptions& thread_options, bool numa_aware);
   ~UnboundedThreadPool() override = default;
 
   // Returns an implementation of `ThreadFactory` that can be used to create
@@ -58,6 +67,10 @@ class UnboundedThreadPool : public thread::ThreadPoolInterface {
                            std::shared_ptr<Notification> done);
 
   UnboundedWorkQueue unbounded_work_queue_;
+  // One work queue per NUMA node, or empty if the pool is not NUMA-aware.
+  std::vector<std::unique_ptr<UnboundedWorkQueue>> numa_work_queues_;
+  // The node for the next work item scheduled by a thread without affinity.
+  std::atomic<uint64_t> next_numa_node_{0};
 };
 
 }  // namespace data
@@ -83,6 +83,24 @@ TEST(UnboundedThreadPool, MultipleBlockingThreads) {
   }
 }
 
+TEST(UnboundedThreadPool, NumaAwareRunsAllWork) {
+  // On hosts with a single NUMA node this is equivalent to a pool that is not
+  // NUMA-aware.
+  UnboundedThreadPool pool(Env::Default(), "test", ThreadOptions(),
+                           /*numa_aware=*/true);
+  const int kNumWorkItems = 100;
+  BlockingCounter bc(kNumWorkItems);
+  std::atomic<int> i(0);
+  for (int j = 0; j < kNumWorkItems; ++j) {
+    pool.Schedule([&bc, &i]() {
+      ++i;
+      bc.DecrementCount();
+    });
+  }
+  bc.Wait();
+  EXPECT_EQ(i, kNumWorkItems);
+}
+
 }  // namespace
 }  // namespace data
 }  // namespace tensorflow
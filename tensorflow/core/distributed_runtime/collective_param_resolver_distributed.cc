@@ -372,32 +372,69 @@ void CollectiveParamResolverDistributed::CompleteInstanceDistributed(
   } else if (InstanceIsCached(cp->group.group_key, cp->instance)) {
     return CompleteInstanceLocal(device, cp, done);
   } else {
-    CompleteInstanceCall* call = new CompleteInstanceCall(
-        cp->group, cp->instance, cp->name, device, cp->is_source, cancel_mgr,
-        group_leader_, worker_cache_);
-    CancellationToken abortion_token =
-        abortion_cancel_mgr_.get_cancellation_token();
-    bool already_aborted = !abortion_cancel_mgr_.RegisterCallback(
-        abortion_token, [call] { call->Cancel(); });
-    if (already_aborted) {
-      done(errors::Cancelled("collective ops already aborted"));
-      delete call;
+    return CompleteInstanceRemote(
+        device, cp, cancel_mgr, [this, device, cp, done](absl::Status s) {
+          if (s.ok()) {
+            CompleteInstanceLocal(device, cp, done);
+          } else {
+            done(s);
+          }
+        });
+  }
+}
+
+void CollectiveParamResolverDistributed::CompleteInstanceRemote(
+    const string& device, CollectiveParams* cp, CancellationManager* cancel_mgr,
+    const StatusCallback& done) {
+  const bool share_call = cp->instance.type != BROADCAST_COLLECTIVE;
+  const auto key = std::make_tuple(
+      cp->group.group_key, cp->instance.step_id, cp->instance.instance_key);
+  if (share_call) {
+    mutex_lock l(pending_instance_mu_);
+    auto it = pending_instance_calls_.find(key);
+    if (it != pending_instance_calls_.end()) {
+      VLOG(2) << "CompleteInstanceRemote: device " << device
+              << " waits for the pending call for instance "
+              << cp->instance.instance_key;
+      it->second.push_back(done);
       return;
     }
-    call->Start([this, device, cp, call, abortion_token, done](absl::Status s) {
-      abortion_cancel_mgr_.DeregisterCallback(abortion_token);
-      if (s.ok()) {
-        s = UpdateInstanceCache(cp, call->resp_);
-      }
-      if (s.ok()) {
-        CompleteInstanceLocal(device, cp, done);
-      } else {
-        done(s);
-      }
-      delete call;
-    });
+    pending_instance_calls_[key];
+  }
+  // Runs `done` and the callbacks of the devices that shared the call.
+  auto done_all = [this, share_call, key, done](const absl::Status& s) {
+    std::vector<StatusCallback> waiters;
+    if (share_call) {
+      mutex_lock l(pending_instance_mu_);
+      auto it = pending_instance_calls_.find(key);
+      waiters = std::move(it->second);
+      pending_instance_calls_.erase(it);
+    }
+    done(s);
+    for (const StatusCallback& waiter : waiters) {
+      waiter(s);
+    }
+  };
+  CompleteInstanceCall* call = new CompleteInstanceCall(
+      cp->group, cp->instance, cp->name, device, cp->is_source, cancel_mgr,
+      group_leader_, worker_cache_);
+  CancellationToken abortion_token =
+      abortion_cancel_mgr_.get_cancellation_token();
+  bool already_aborted = !abortion_cancel_mgr_.RegisterCallback(
+      abortion_token, [call] { call->Cancel(); });
+  if (already_aborted) {
+    done_all(errors::Cancelled("collective ops already aborted"));
+    delete call;
     return;
   }
+  call->Start([this, cp, call, abortion_token, done_all](absl::Status s) {
+    abortion_cancel_mgr_.DeregisterCallback(abortion_token);
+    if (s.ok()) {
+      s = UpdateInstanceCache(cp, call->resp_);
+    }
+    done_all(s);
+    delete call;
+  });
 }
 
 void CollectiveParamResolverDistributed::StartAbort(const absl::Status& s) {
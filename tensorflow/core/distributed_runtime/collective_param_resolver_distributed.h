@@ -15,6 +15,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_COLLECTIVE_PARAM_RESOLVER_DISTRIBUTED_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_COLLECTIVE_PARAM_RESOLVER_DISTRIBUTED_H_
 
+#include <tuple>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/common_runtime/collective_param_resolver_local.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
@@ -87,9 +91,27 @@ class CollectiveParamResolverDistributed : public CollectiveParamResolverLocal {
                                    const StatusCallback& done)
       TF_LOCKS_EXCLUDED(instance_mu_, group_mu_);
 
+  // Issues a CompleteInstanceCall for *cp to the group leader and calls
+  // `done` once the instance cache is updated from its response.
+  //
+  // Only broadcasts need every member to check in with the leader, which
+  // then learns the source rank.  For other collectives the devices of
+  // this task that resolve the same instance share a single call.
+  void CompleteInstanceRemote(const string& device, CollectiveParams* cp,
+                              CancellationManager* cancel_mgr,
+                              const StatusCallback& done)
+      TF_LOCKS_EXCLUDED(pending_instance_mu_);
+
   WorkerCacheInterface* worker_cache_;  // Not owned
   const string group_leader_;
   CancellationManager abortion_cancel_mgr_;
+
+  // Callbacks waiting for a CompleteInstanceCall in flight, keyed by group
+  // key, step id and instance key.
+  mutex pending_instance_mu_;
+  absl::flat_hash_map<std::tuple<int32_t, int64_t, int32_t>,
+                      std::vector<StatusCallback>>
+      pending_instance_calls_ TF_GUARDED_BY(pending_instance_mu_);
 };
 
 }  // namespace tensorflow
@@ -1734,6 +1734,8 @@ absl::Status MasterSession::BuildAndRegisterPartitions(ReffedClientGraph* rcg) {
     popts.scheduling_for_recvs = true;
     popts.need_to_record_start_times = true;
   }
+  popts.coalesce_send_recv =
+      session_opts_.config.graph_options().coalesce_cross_task_sendrecv();
 
   TF_RETURN_IF_ERROR(rcg->RegisterPartitions(std::move(popts)));
 
@@ -0,0 +1,64 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/common_shape_fns.h"
+#include "tensorflow/core/framework/op.h"
+
+namespace tensorflow {
+namespace {
+
+REGISTER_OP("PublishPreemptionHandoff")
+    .Input("key: string")
+    .Input("tensor: T")
+    .Attr("T: type")
+    .Attr("chunk_bytes: int = 4194304")
+    .SetIsStateful()  // side-effective op
+    .SetIsDistributedCommunication()
+    .SetShapeFn(shape_inference::NoOutputs)
+    .Doc(R"doc(
+Publishes a tensor in the coordination service key-value store.
+
+Used by a task that received a preemption notice to hand its variable values
+directly to a peer or replacement task, which reads them back with
+`ReceivePreemptionHandoff` instead of restoring a checkpoint. The value is
+written as chunks under `<key>/chunk/<i>`, and a header under `key` is written
+last, so readers never observe a partially written tensor.
+
+key: Scalar key under which the tensor is published.
+tensor: The tensor to publish. Its type must be copyable with memcpy.
+chunk_bytes: Maximum size of a single key-value entry.
+)doc");
+
+REGISTER_OP("ReceivePreemptionHandoff")
+    .Input("key: string")
+    .Output("tensor: dtype")
+    .Attr("dtype: type")
+    .Attr("timeout_in_ms: int = 0")
+    .SetIsStateful()  // side-effective op
+    .SetIsDistributedCommunication()
+    .SetShapeFn(shape_inference::UnknownShape)
+    .Doc(R"doc(
+Receives a tensor published with `PublishPreemptionHandoff`.
+
+Blocks until the tensor under `key` has been completely published.
+
+key: Scalar key under which the tensor was published.
+tensor: The received tensor.
+dtype: Expected type of the tensor.
+timeout_in_ms: Time to wait for the tensor. Waits forever if not positive.
+)doc");
+
+}  // namespace
+}  // namespace tensorflow
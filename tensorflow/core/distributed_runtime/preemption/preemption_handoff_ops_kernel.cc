@@ -0,0 +1,174 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "xla/tsl/distributed_runtime/coordination/coordination_service_agent.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/op_requires.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor.pb.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+namespace {
+
+std::string ChunkKey(absl::string_view key, int64_t index) {
+  return absl::StrCat(key, "/chunk/", index);
+}
+
+absl::Status GetAgent(OpKernelContext* ctx,
+                      tsl::CoordinationServiceAgent** agent) {
+  *agent = ctx->coordination_service_agent();
+  if (*agent == nullptr) {
+    return errors::FailedPrecondition(
+        "Preemption handoff requires the coordination service to be enabled.");
+  }
+  return absl::OkStatus();
+}
+
+absl::Status GetKey(OpKernelContext* ctx, std::string* key) {
+  const Tensor& key_t = ctx->input(0);
+  if (!TensorShapeUtils::IsScalar(key_t.shape())) {
+    return errors::InvalidArgument("key must be a scalar, got shape ",
+                                   key_t.shape().DebugString());
+  }
+  *key = key_t.scalar<tstring>()();
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+// Kernel that publishes a tensor for a peer task through the coordination
+// service key-value store.
+class PublishPreemptionHandoffOp : public OpKernel {
+ public:
+  explicit PublishPreemptionHandoffOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("chunk_bytes", &chunk_bytes_));
+    OP_REQUIRES(ctx, chunk_bytes_ > 0,
+                errors::InvalidArgument("chunk_bytes must be positive, got ",
+                                        chunk_bytes_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    tsl::CoordinationServiceAgent* agent;
+    OP_REQUIRES_OK(ctx, GetAgent(ctx, &agent));
+    std::string key;
+    OP_REQUIRES_OK(ctx, GetKey(ctx, &key));
+    const Tensor& value = ctx->input(1);
+    OP_REQUIRES(ctx, DataTypeCanUseMemcpy(value.dtype()),
+                errors::InvalidArgument("Cannot hand off tensors of type ",
+                                        DataTypeString(value.dtype())));
+
+    // Remove the previous header first, so that a reader cannot combine it
+    // with the chunks being overwritten below.
+    absl::Status s = agent->DeleteKeyValue(key);
+    OP_REQUIRES(ctx, s.ok() || errors::IsNotFound(s), s);
+
+    const absl::string_view data = value.tensor_data();
+    int64_t num_chunks = 0;
+    for (size_t offset = 0; offset < data.size(); offset += chunk_bytes_) {
+      OP_REQUIRES_OK(
+          ctx, agent->InsertKeyValue(ChunkKey(key, num_chunks++),
+                                     data.substr(offset, chunk_bytes_),
+                                     /*allow_overwrite=*/true));
+    }
+
+    TensorProto header;
+    header.set_dtype(value.dtype());
+    value.shape().AsProto(header.mutable_tensor_shape());
+    OP_REQUIRES_OK(ctx, agent->InsertKeyValue(key, header.SerializeAsString(),
+                                              /*allow_overwrite=*/true));
+    VLOG(1) << "Published preemption handoff " << key << " in " << num_chunks
+            << " chunks";
+  }
+
+ private:
+  int64_t chunk_bytes_;
+};
+
+// Kernel that receives a tensor published by `PublishPreemptionHandoffOp`.
+class ReceivePreemptionHandoffOp : public OpKernel {
+ public:
+  explicit ReceivePreemptionHandoffOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("dtype", &dtype_));
+    OP_REQUIRES(ctx, DataTypeCanUseMemcpy(dtype_),
+                errors::InvalidArgument("Cannot hand off tensors of type ",
+                                        DataTypeString(dtype_)));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("timeout_in_ms", &timeout_in_ms_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    tsl::CoordinationServiceAgent* agent;
+    OP_REQUIRES_OK(ctx, GetAgent(ctx, &agent));
+    std::string key;
+    OP_REQUIRES_OK(ctx, GetKey(ctx, &key));
+
+    // The header is written last, so once it is visible all chunks are too.
+    absl::StatusOr<std::string> serialized =
+        timeout_in_ms_ > 0
+            ? agent->GetKeyValue(key, absl::Milliseconds(timeout_in_ms_))
+            : agent->GetKeyValue(key);
+    OP_REQUIRES_OK(ctx, serialized.status());
+    TensorProto header;
+    OP_REQUIRES(ctx, header.ParseFromString(*serialized),
+                errors::DataLoss("Malformed preemption handoff header for ",
+                                 key));
+    OP_REQUIRES(ctx, header.dtype() == dtype_,
+                errors::InvalidArgument(
+                    "Preemption handoff ", key, " has type ",
+                    DataTypeString(header.dtype()), ", expected ",
+                    DataTypeString(dtype_)));
+    TensorShape shape;
+    OP_REQUIRES_OK(
+        ctx, TensorShape::BuildTensorShape(header.tensor_shape(), &shape));
+
+    Tensor* output;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, shape, &output));
+    char* dst = const_cast<char*>(output->tensor_data().data());
+    const size_t total_bytes = output->tensor_data().size();
+    size_t offset = 0;
+    for (int64_t i = 0; offset < total_bytes; ++i) {
+      absl::StatusOr<std::string> chunk =
+          agent->TryGetKeyValue(ChunkKey(key, i));
+      OP_REQUIRES_OK(ctx, chunk.status());
+      OP_REQUIRES(ctx, !chunk->empty() && chunk->size() <= total_bytes - offset,
+                  errors::DataLoss("Malformed chunk ", i,
+                                   " of preemption handoff ", key));
+      std::memcpy(dst + offset, chunk->data(), chunk->size());
+      offset += chunk->size();
+    }
+  }
+
+ private:
+  DataType dtype_;
+  int64_t timeout_in_ms_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("PublishPreemptionHandoff").Device(DEVICE_CPU),
+                        PublishPreemptionHandoffOp);
+REGISTER_KERNEL_BUILDER(Name("ReceivePreemptionHandoff").Device(DEVICE_CPU),
+                        ReceivePreemptionHandoffOp);
+
+}  // namespace tensorflow
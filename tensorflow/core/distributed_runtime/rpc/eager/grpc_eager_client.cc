@@ -15,8 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/eager/grpc_eager_client.h"
 
+#include <atomic>
 #include <cstdint>
+#include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "grpcpp/generic/generic_stub.h"
 #include "xla/tsl/distributed_runtime/call_options.h"
@@ -29,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/error_payloads.h"
 #include "tensorflow/core/platform/macros.h"
 #include "tensorflow/core/protobuf/core_platform_payloads.pb.h"
@@ -74,6 +79,158 @@ bool EnableStreaming() {
   return result;
 }
 
+/* Setting environment variable
+ * "TF_ENABLE_EAGER_CLIENT_STREAMING_ENQUEUE_BATCHING" to true makes streaming
+ * enqueue requests that are issued while many earlier ones are still
+ * outstanding wait, and be merged into a single request. See EnqueueBatcher
+ * below.
+ */
+bool EnableStreamingEnqueueBatching() {
+  bool result;
+  TF_CHECK_OK(ReadBoolFromEnvVar(
+      "TF_ENABLE_EAGER_CLIENT_STREAMING_ENQUEUE_BATCHING", false, &result));
+  return result;
+}
+
+// The number of streaming enqueue requests of one context that may be
+// outstanding before further requests are batched.
+constexpr int kMaxInFlightEnqueueRequests = 4;
+
+// Batches the streaming enqueue requests of one remote context. Up to
+// kMaxInFlightEnqueueRequests requests are sent as they come. Requests issued
+// beyond that are merged into one EnqueueRequest, which is sent once an
+// outstanding request completes. The server runs the queue items of a request
+// in order and answers each with one queue response, so later items can still
+// use the handles produced by earlier ones, and the merged response is split
+// back by item counts. If a merged request fails, all requests in it fail.
+class EnqueueBatcher {
+ public:
+  EnqueueBatcher(::grpc::GenericStub* stub, ::grpc::CompletionQueue* cq)
+      : dispatcher_(stub, cq,
+                    "/tensorflow.eager.EagerService/StreamingEnqueue") {}
+
+  static void Send(const std::shared_ptr<EnqueueBatcher>& batcher,
+                   const EnqueueRequest& request, EnqueueResponse* response,
+                   StatusCallback done) {
+    {
+      mutex_lock l(batcher->mu_);
+      if (!batcher->closed_) {
+        if (batcher->pending_batch_ == nullptr &&
+            batcher->num_in_flight_ < kMaxInFlightEnqueueRequests) {
+          ++batcher->num_in_flight_;
+          batcher->dispatcher_.SendNextRequest(
+              request, response,
+              [batcher, done = std::move(done)](const absl::Status& status) {
+                done(status);
+                RequestDone(batcher);
+              });
+          return;
+        }
+        AddToPendingBatchLocked(*batcher, request, response, std::move(done));
+        if (batcher->num_in_flight_ < kMaxInFlightEnqueueRequests) {
+          FlushLocked(batcher);
+        }
+        return;
+      }
+    }
+    done(errors::Cancelled("The remote eager context is closed."));
+  }
+
+  // Cancels the streaming call and fails all requests not sent yet.
+  void Close() {
+    std::shared_ptr<Batch> pending_batch;
+    {
+      mutex_lock l(mu_);
+      closed_ = true;
+      pending_batch = std::move(pending_batch_);
+      has_pending_batch_ = false;
+      dispatcher_.CancelCall();
+    }
+    if (pending_batch == nullptr) return;
+    for (PendingRequest& pending : pending_batch->requests) {
+      pending.done(errors::Cancelled("The remote eager context is closed."));
+    }
+  }
+
+ private:
+  struct PendingRequest {
+    int num_items;
+    EnqueueResponse* response;
+    StatusCallback done;
+  };
+  struct Batch {
+    EnqueueRequest request;
+    EnqueueResponse response;
+    std::vector<PendingRequest> requests;
+  };
+
+  static void AddToPendingBatchLocked(EnqueueBatcher& batcher,
+                                      const EnqueueRequest& request,
+                                      EnqueueResponse* response,
+                                      StatusCallback done)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(batcher.mu_) {
+    if (batcher.pending_batch_ == nullptr) {
+      batcher.pending_batch_ = std::make_shared<Batch>();
+      batcher.pending_batch_->request.set_context_id(request.context_id());
+      batcher.has_pending_batch_ = true;
+    }
+    Batch& batch = *batcher.pending_batch_;
+    for (const QueueItem& item : request.queue()) {
+      *batch.request.add_queue() = item;
+    }
+    batch.requests.push_back(
+        {request.queue_size(), response, std::move(done)});
+  }
+
+  static void FlushLocked(const std::shared_ptr<EnqueueBatcher>& batcher)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(batcher->mu_) {
+    std::shared_ptr<Batch> batch = std::move(batcher->pending_batch_);
+    batcher->has_pending_batch_ = false;
+    ++batcher->num_in_flight_;
+    VLOG(3) << "Sending " << batch->requests.size()
+            << " batched enqueue requests with " << batch->request.queue_size()
+            << " queue items";
+    batcher->dispatcher_.SendNextRequest(
+        batch->request, &batch->response,
+        [batcher, batch](const absl::Status& status) {
+          int offset = 0;
+          for (PendingRequest& pending : batch->requests) {
+            if (status.ok()) {
+              for (int i = 0; i < pending.num_items; ++i) {
+                pending.response->add_queue_response()->Swap(
+                    batch->response.mutable_queue_response(offset + i));
+              }
+            }
+            offset += pending.num_items;
+            pending.done(status);
+          }
+          RequestDone(batcher);
+        });
+  }
+
+  // May run inside `SendNextRequest()`, and so must not take `mu_`. Requests
+  // batched meanwhile are flushed on another thread.
+  static void RequestDone(const std::shared_ptr<EnqueueBatcher>& batcher) {
+    --batcher->num_in_flight_;
+    if (!batcher->has_pending_batch_) return;
+    Env::Default()->SchedClosure([batcher]() {
+      mutex_lock l(batcher->mu_);
+      if (batcher->pending_batch_ != nullptr &&
+          batcher->num_in_flight_ < kMaxInFlightEnqueueRequests) {
+        FlushLocked(batcher);
+      }
+    });
+  }
+
+  mutex mu_;
+  bool closed_ TF_GUARDED_BY(mu_) = false;
+  std::shared_ptr<Batch> pending_batch_ TF_GUARDED_BY(mu_);
+  // Read without `mu_` when requests complete.
+  std::atomic<int> num_in_flight_ = 0;
+  std::atomic<bool> has_pending_batch_ = false;
+  StreamingRPCDispatcher<EnqueueResponse> dispatcher_;
+};
+
 // Ref-counted thread to handle callbacks for completed requests a GRPC
 // completion queue. The thread might be shared by multiple eager clients, and
 // each one of them should hold a reference count to ensure that the thread
@@ -207,6 +364,12 @@ class GrpcEagerClient : public EagerClient {
             << request->DebugString();
 
     mutex_lock l(mu_);
+    const auto& batcher_it = enqueue_batchers_.find(request->context_id());
+    if (batcher_it != enqueue_batchers_.end()) {
+      batcher_it->second->Close();
+      enqueue_batchers_.erase(batcher_it);
+      return;
+    }
     const auto& it = enqueue_dispatchers_.find(request->context_id());
     if (it != enqueue_dispatchers_.end()) {
       it->second.CancelCall();
@@ -227,7 +390,21 @@ class GrpcEagerClient : public EagerClient {
     // 1. The global env variable, as checked in EnableStreaming().
     // 2. The flag set in the eager executor.
     // Streaming enqueue is allowed only when the both are enabled.
-    if (EnableStreaming() && enable_streaming_enqueue) {
+    if (EnableStreaming() && enable_streaming_enqueue &&
+        EnableStreamingEnqueueBatching()) {
+      std::shared_ptr<EnqueueBatcher> batcher;
+      {
+        mutex_lock l(mu_);
+        std::shared_ptr<EnqueueBatcher>& context_batcher =
+            enqueue_batchers_[request->context_id()];
+        if (context_batcher == nullptr) {
+          context_batcher = std::make_shared<EnqueueBatcher>(&stub_, cq_);
+        }
+        batcher = context_batcher;
+      }
+      EnqueueBatcher::Send(batcher, *request, response,
+                           std::move(done_wrapped));
+    } else if (EnableStreaming() && enable_streaming_enqueue) {
       mutex_lock l(mu_);
       auto it = enqueue_dispatchers_.find(request->context_id());
       if (it == enqueue_dispatchers_.end()) {
@@ -265,6 +442,9 @@ class GrpcEagerClient : public EagerClient {
 
   std::unordered_map<uint64, StreamingRPCDispatcher<EnqueueResponse>>
       enqueue_dispatchers_ TF_GUARDED_BY(mu_);
+  // Used instead of `enqueue_dispatchers_` if enqueue batching is enabled.
+  std::unordered_map<uint64, std::shared_ptr<EnqueueBatcher>>
+      enqueue_batchers_ TF_GUARDED_BY(mu_);
 
   StatusCallback callback_wrapper(StatusCallback done) {
     Ref();
@@ -92,8 +92,14 @@ class ReusePortOption : public ::grpc::ServerBuilderOption {
 };
 
 // static utility function
-RendezvousMgrInterface* NewRpcRendezvousMgr(const WorkerEnv* env) {
-  return new RpcRendezvousMgr(env);
+RendezvousMgrInterface* NewRpcRendezvousMgr(const WorkerEnv* env,
+                                            const ConfigProto& config) {
+  RpcRendezvousMgr::Options options;
+  options.recv_tensor_chunk_bytes =
+      config.experimental().recv_tensor_chunk_bytes();
+  options.recv_tensor_max_chunks =
+      config.rpc_options().num_channels_per_target();
+  return new RpcRendezvousMgr(env, std::move(options));
 }
 
 }  // namespace
@@ -229,9 +235,11 @@ absl::Status GrpcServer::Init(const GrpcServerOptions& opts) {
   master_env_.experimental_num_shards = std::max(1, num_tasks);
   worker_env_.experimental_num_shards = master_env_.experimental_num_shards;
 
-  worker_env_.rendezvous_mgr = opts.rendezvous_mgr_func == nullptr
-                                   ? new RpcRendezvousMgr(&worker_env_)
-                                   : opts.rendezvous_mgr_func(&worker_env_);
+  worker_env_.rendezvous_mgr =
+      opts.rendezvous_mgr_func == nullptr
+          ? NewRpcRendezvousMgr(&worker_env_,
+                                server_def_.default_session_config())
+          : opts.rendezvous_mgr_func(&worker_env_);
   string unused;
   string default_worker_name;
   if (!DeviceNameUtils::SplitDeviceName(master_env_.local_devices[0]->name(),
@@ -609,7 +617,10 @@ absl::Status GrpcServer::Create(const ServerDef& server_def, Env* env,
   std::unique_ptr<GrpcServer> ret(
       new GrpcServer(server_def, env == nullptr ? Env::Default() : env));
   GrpcServerOptions options;
-  options.rendezvous_mgr_func = NewRpcRendezvousMgr;
+  options.rendezvous_mgr_func =
+      [config = server_def.default_session_config()](const WorkerEnv* env) {
+        return NewRpcRendezvousMgr(env, config);
+      };
   options.local_device_mgr = local_device_mgr;
   absl::Status s = ret->Init(options);
   if (!s.ok()) {
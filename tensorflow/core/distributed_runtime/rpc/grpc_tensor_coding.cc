@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/grpc_tensor_coding.h"
 
+#include <algorithm>
+#include <cstdint>
+
 #include "grpcpp/support/byte_buffer.h"
 #include "grpcpp/support/slice.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
@@ -24,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/io/proto_encode_helper.h"
+#include "tensorflow/core/lib/math/math_util.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/protobuf/worker.pb.h"
 
@@ -134,8 +138,10 @@ static void EncodeSkeleton(const Tensor& val, io::ProtoEncodeHelper* e) {
 #endif
 }
 
-void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
-                              ::grpc::ByteBuffer* result) {
+// Encodes "response" with "val" as its tensor() field into "*result".
+static void EncodeTensorWithResponseToByteBuffer(RecvTensorResponse response,
+                                                 const Tensor& val,
+                                                 ::grpc::ByteBuffer* result) {
   const int kLargeTensorBytes = 1024;
   const int64_t kProtoBufLimitBytes = 1LL << 31;
 
@@ -147,11 +153,6 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
                << ", tensor shape: " << val.shape().AsProto().DebugString();
   }
 
-  RecvTensorResponse response;
-  if (is_dead) {
-    response.set_is_dead(is_dead);
-  }
-  response.set_require_ack(require_ack);
   response.set_send_start_micros(Env::Default()->NowMicros());
   if (!DataTypeCanUseMemcpy(val.dtype())) {
     // Straightforward but slow path for complicated kinds of tensor data
@@ -251,5 +252,46 @@ void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
   }
 }
 
+void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
+                              ::grpc::ByteBuffer* result) {
+  RecvTensorResponse response;
+  if (is_dead) {
+    response.set_is_dead(is_dead);
+  }
+  response.set_require_ack(require_ack);
+  EncodeTensorWithResponseToByteBuffer(response, val, result);
+}
+
+int64_t RecvTensorChunkElements(const Tensor& val, int64_t min_chunk_bytes,
+                                int max_chunks) {
+  if (min_chunk_bytes <= 0 || max_chunks <= 1 ||
+      !DataTypeCanUseMemcpy(val.dtype()) ||
+      val.TotalBytes() <= static_cast<size_t>(min_chunk_bytes)) {
+    return 0;
+  }
+  const int64_t num_chunks =
+      std::min<int64_t>(max_chunks, MathUtil::CeilOfRatio<int64_t>(
+                                        val.TotalBytes(), min_chunk_bytes));
+  return MathUtil::CeilOfRatio<int64_t>(val.NumElements(), num_chunks);
+}
+
+void EncodeTensorChunkToByteBuffer(const Tensor& val, int64_t chunk_elements,
+                                   int64_t chunk_index,
+                                   ::grpc::ByteBuffer* result) {
+  const int64_t num_elements = val.NumElements();
+  RecvTensorResponse response;
+  response.set_num_chunks(
+      MathUtil::CeilOfRatio<int64_t>(num_elements, chunk_elements));
+  val.shape().AsProto(response.mutable_chunked_tensor_shape());
+
+  // The chunk shares the backing store of "val".
+  Tensor flat;
+  CHECK(flat.CopyFrom(val, TensorShape({num_elements})));
+  const int64_t begin = chunk_index * chunk_elements;
+  const int64_t end = std::min(begin + chunk_elements, num_elements);
+  EncodeTensorWithResponseToByteBuffer(response, flat.Slice(begin, end),
+                                       result);
+}
+
 }  // namespace grpc
 }  // namespace tensorflow
@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_CODING_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_GRPC_TENSOR_CODING_H_
 
+#include <cstdint>
+
 #include "grpcpp/impl/codegen/byte_buffer.h"
 
 namespace tensorflow {
@@ -49,6 +51,21 @@ void EncodeRecvTensorResponseToByteBuffer(const RecvTensorResponse& proto,
 void EncodeTensorToByteBuffer(bool is_dead, const Tensor& val, bool require_ack,
                               ::grpc::ByteBuffer* result);
 
+// Returns the number of elements in each chunk (but the last) if "val" should
+// be sent in chunks for a RecvTensorRequest with "min_chunk_bytes" and
+// "max_chunks", or 0 if it should be sent in one piece.
+int64_t RecvTensorChunkElements(const Tensor& val, int64_t min_chunk_bytes,
+                                int max_chunks);
+
+// Encode the chunk "chunk_index" of the flattened elements of "val", with
+// "chunk_elements" elements per chunk, into a byte buffer in a format that is
+// parseable as a RecvTensorResponse protocol buffer with "num_chunks" set.
+//
+// Discards original contents of *result.
+void EncodeTensorChunkToByteBuffer(const Tensor& val, int64_t chunk_elements,
+                                   int64_t chunk_index,
+                                   ::grpc::ByteBuffer* result);
+
 }  // namespace grpc
 }  // namespace tensorflow
 
@@ -17,6 +17,10 @@ limitations under the License.
 
 #include "grpcpp/support/byte_buffer.h"
 #include "grpcpp/support/slice.h"
+#include "tensorflow/core/distributed_runtime/rpc/grpc_util.h"
+#include "tensorflow/core/distributed_runtime/tensor_coding.h"
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
@@ -100,4 +104,58 @@ TEST_F(GrpcTensorCodingTest, Simple) {
 
 TEST_F(GrpcTensorCodingTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+class DummyDevice : public DeviceBase {
+ public:
+  explicit DummyDevice(Env* env) : DeviceBase(env) {
+    attr_.set_device_type("CPU");
+  }
+
+  const DeviceAttributes& attributes() const override { return attr_; }
+
+  Allocator* GetAllocator(AllocatorAttributes attr) override {
+    return cpu_allocator();
+  }
+
+ private:
+  DeviceAttributes attr_;
+};
+
+TEST_F(GrpcTensorCodingTest, RecvTensorChunkElements) {
+  Tensor t(DT_FLOAT, TensorShape({10, 10}));
+  // Chunking is disabled, or the tensor is too small to be chunked.
+  EXPECT_EQ(0, grpc::RecvTensorChunkElements(t, 0, 4));
+  EXPECT_EQ(0, grpc::RecvTensorChunkElements(t, 100, 1));
+  EXPECT_EQ(0, grpc::RecvTensorChunkElements(t, 400, 4));
+  // 400 bytes in chunks of at least 100 bytes.
+  EXPECT_EQ(25, grpc::RecvTensorChunkElements(t, 100, 4));
+  // No more than "max_chunks" chunks.
+  EXPECT_EQ(34, grpc::RecvTensorChunkElements(t, 10, 3));
+  EXPECT_EQ(0, grpc::RecvTensorChunkElements(Tensor(DT_STRING, {100}), 1, 4));
+}
+
+TEST_F(GrpcTensorCodingTest, ChunkRoundTrip) {
+  Tensor t(DT_INT32, TensorShape({5, 7}));
+  test::FillIota<int32>(&t, 0);
+  const int64_t chunk_elements = grpc::RecvTensorChunkElements(t, 16, 3);
+  ASSERT_EQ(12, chunk_elements);
+
+  DummyDevice cpu_device(Env::Default());
+  Tensor destination;
+  for (int64_t i = 0; i < 3; ++i) {
+    ::grpc::ByteBuffer buf;
+    grpc::EncodeTensorChunkToByteBuffer(t, chunk_elements, i, &buf);
+
+    TensorResponse response;
+    response.InitAlloc(&cpu_device, AllocatorAttributes());
+    // The first chunk allocates the destination for the others.
+    if (i > 0) {
+      response.InitChunk(destination, i * chunk_elements * sizeof(int32));
+    }
+    ASSERT_TRUE(GrpcMaybeParseTensorResponse(&buf, &response));
+    EXPECT_EQ(3, response.metadata().num_chunks());
+    destination = response.tensor();
+  }
+  test::ExpectTensorEqual<int32>(t, destination);
+}
+
 }  // namespace tensorflow
@@ -49,6 +49,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/math/math_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/lib/strings/stringprintf.h"
 #include "tensorflow/core/platform/logging.h"
@@ -433,13 +434,23 @@ GrpcWorker::GrpcWorker(WorkerEnv* worker_env, const ConfigProto& config)
               ? config.experimental().recv_buf_max_chunk()
               : (config.experimental().recv_buf_max_chunk() < 0 ? 0 : 4096)) {
   if (config.rpc_options().cache_rpc_response()) {
-    EnableResponseCache();
+    RpcResponseCache::Options options;
+    options.max_bytes = config.rpc_options().cache_rpc_response_max_bytes();
+    options.ttl_micros =
+        config.rpc_options().cache_rpc_response_ttl_ms() * 1000;
+    EnableResponseCache(options);
   }
 }
 
 void GrpcWorker::EnableResponseCache() {
-  VLOG(3) << "Enabling gRPC tensor response cache.";
-  response_cache_ = std::make_unique<RpcResponseCache>();
+  EnableResponseCache(RpcResponseCache::Options());
+}
+
+void GrpcWorker::EnableResponseCache(
+    const RpcResponseCache::Options& options) {
+  VLOG(3) << "Enabling gRPC tensor response cache, max_bytes="
+          << options.max_bytes << " ttl_micros=" << options.ttl_micros;
+  response_cache_ = std::make_unique<RpcResponseCache>(options);
 }
 
 // GrpcRecvTensorAsync: unlike the other Worker methods, which use protocol
@@ -455,12 +466,38 @@ void GrpcWorker::GrpcRecvTensorAsync(CallOptions* opts,
 
   bool cache_enabled = (response_cache_ != nullptr && request_id != 0);
 
-  auto do_response = [response, done, cache_enabled](
+  // Chunks are sent from the response cache, which holds the tensor until all
+  // of them have been requested.
+  auto do_response = [this, response, done, cache_enabled, request_id,
+                       min_chunk_bytes = request->min_chunk_bytes(),
+                       max_chunks = request->max_chunks(),
+                       chunk_index = request->chunk_index()](
                          const Tensor& tensor, bool is_dead,
                          const absl::Status& status) {
-    if (status.ok()) {
+    if (!status.ok()) {
+      done(status);
+      return;
+    }
+    const int64_t chunk_elements =
+        cache_enabled && !is_dead
+            ? grpc::RecvTensorChunkElements(tensor, min_chunk_bytes, max_chunks)
+            : 0;
+    if (chunk_elements == 0) {
       grpc::EncodeTensorToByteBuffer(is_dead, tensor, cache_enabled, response);
+      done(status);
+      return;
+    }
+    const int64_t num_chunks =
+        MathUtil::CeilOfRatio<int64_t>(tensor.NumElements(), chunk_elements);
+    if (chunk_index < 0 || chunk_index >= num_chunks) {
+      done(errors::InvalidArgument("RecvTensor chunk ", chunk_index,
+                                   " is out of range for a tensor sent in ",
+                                   num_chunks, " chunks"));
+      return;
     }
+    grpc::EncodeTensorChunkToByteBuffer(tensor, chunk_elements, chunk_index,
+                                        response);
+    response_cache_->ChunkSent(request_id, chunk_index, num_chunks);
     done(status);
   };
 
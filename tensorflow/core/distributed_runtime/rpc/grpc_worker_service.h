@@ -64,6 +64,7 @@ class GrpcWorker : public Worker {
   WorkerEnv* env();
 
   void EnableResponseCache();
+  void EnableResponseCache(const RpcResponseCache::Options& options);
 
   void RemoveCacheEntryForId(int64_t request_id);
 
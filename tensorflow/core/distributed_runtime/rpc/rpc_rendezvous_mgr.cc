@@ -15,6 +15,10 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <atomic>
+#include <memory>
+#include <vector>
+
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
 #include "tensorflow/core/common_runtime/dma_helper.h"
@@ -38,8 +42,9 @@ namespace {
 
 class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  public:
-  RpcRemoteRendezvous(const WorkerEnv* env, int64_t step_id)
-      : BaseRemoteRendezvous(env, step_id) {}
+  RpcRemoteRendezvous(const WorkerEnv* env, int64_t step_id,
+                      const RpcRendezvousMgr::Options& options)
+      : BaseRemoteRendezvous(env, step_id), options_(options) {}
 
  protected:
   void RecvFromRemoteAsync(const Rendezvous::ParsedKey& parsed,
@@ -49,6 +54,8 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
  private:
   ~RpcRemoteRendezvous() override {}
 
+  const RpcRendezvousMgr::Options options_;
+
   RpcRemoteRendezvous(const RpcRemoteRendezvous&) = delete;
   void operator=(const RpcRemoteRendezvous&) = delete;
 };
@@ -56,12 +63,17 @@ class RpcRemoteRendezvous : public BaseRemoteRendezvous {
 // Used only to retrieve tensors from remote processes.
 class RpcRecvTensorCall : public BaseRecvTensorCall {
  public:
-  RpcRecvTensorCall() : wi_(nullptr), dst_device_(nullptr) {}
-
-  void Init(WorkerInterface* wi, int64_t step_id, StringPiece key,
-            AllocatorAttributes alloc_attrs, Device* dst_device,
-            const Rendezvous::Args& recv_args, Rendezvous::DoneCallback done) {
+  RpcRecvTensorCall()
+      : wi_(nullptr), transport_(nullptr), dst_device_(nullptr) {}
+
+  // If `transport` is not null, the tensor is received with it instead of the
+  // RecvTensor RPC.
+  void Init(WorkerInterface* wi, RemoteTensorTransport* transport,
+            int64_t step_id, StringPiece key, AllocatorAttributes alloc_attrs,
+            Device* dst_device, const Rendezvous::Args& recv_args,
+            Rendezvous::DoneCallback done) {
     wi_ = wi;
+    transport_ = transport;
     alloc_attrs_ = alloc_attrs;
     dst_device_ = dst_device;
     recv_args_ = recv_args;
@@ -71,12 +83,24 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     req_.set_request_id(GetUniqueRequestId());
   }
 
+  // Receives a tensor with more than `min_chunk_bytes` bytes of content in up
+  // to `max_chunks` chunks, which are fetched in parallel from workers created
+  // by `worker_cache`. The tensor must be received into host memory.
+  void EnableChunks(std::shared_ptr<WorkerCacheInterface> worker_cache,
+                    int64_t min_chunk_bytes, int max_chunks) {
+    worker_cache_ = std::move(worker_cache);
+    req_.set_min_chunk_bytes(min_chunk_bytes);
+    req_.set_max_chunks(max_chunks);
+  }
+
   void Reset() {
     // The RpcRemoteRendezvous using this object is responsible for calling
     // ReleaseWorker() before Reset().
     DCHECK_EQ(static_cast<WorkerInterface*>(nullptr), wi_)
         << "Leaking WorkerInterface in RpcRecvTensorCall::Reset().";
 
+    transport_ = nullptr;
+    worker_cache_.reset();
     alloc_attrs_ = AllocatorAttributes();
     dst_device_ = nullptr;
     // We don't clear opts_ and assume that Init will set up the state for
@@ -86,6 +110,8 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     {
       mutex_lock l(mu_);
       status_ = absl::OkStatus();
+      // The chunk calls have released their workers when they finished.
+      chunks_.clear();
     }
     done_ = nullptr;
   }
@@ -106,6 +132,9 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     {
       mutex_lock l(mu_);
       status_.Update(s);
+      for (const auto& chunk : chunks_) {
+        chunk->opts.StartCancel();
+      }
     }
     opts_.StartCancel();
   }
@@ -146,9 +175,19 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
         mutex_lock l(mu_);
         status_.Update(s);
       }
+      // The sender returns the first chunk of a tensor sent in chunks, with
+      // which `resp_` allocates the whole tensor.
+      if (resp_.metadata().num_chunks() > 1 && status().ok()) {
+        StartChunkCalls(recv_done);
+        return;
+      }
       recv_done();
     };
-    wi_->RecvTensorAsync(&opts_, &req_, &resp_, std::move(cb));
+    if (transport_ != nullptr) {
+      transport_->RecvTensorAsync(wi_, &opts_, &req_, &resp_, std::move(cb));
+    } else {
+      wi_->RecvTensorAsync(&opts_, &req_, &resp_, std::move(cb));
+    }
 
     // NOTE: Check if the rendezvous was aborted after sending out the RPC. The
     // ordering is important because `StartAbort` could be called right before
@@ -167,9 +206,97 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
     abort_checked->Notify();
   }
 
+  // Start the RecvTensor calls for the remaining chunks of the tensor, which
+  // are read directly into the tensor allocated for the first chunk, and call
+  // `recv_done` once all of them have finished.
+  void StartChunkCalls(std::function<void()> recv_done) {
+    const RecvTensorResponse& metadata = resp_.metadata();
+    if (metadata.tensor().tensor_shape().dim_size() != 1 ||
+        worker_cache_ == nullptr) {
+      {
+        mutex_lock l(mu_);
+        status_.Update(errors::Internal(
+            "Unexpected chunked RecvTensor response for ",
+            req_.rendezvous_key()));
+      }
+      recv_done();
+      return;
+    }
+    const int64_t chunk_bytes = metadata.tensor().tensor_shape().dim(0).size() *
+                                DataTypeSize(resp_.tensor().dtype());
+    std::vector<Chunk*> chunks;
+    {
+      mutex_lock l(mu_);
+      for (int64_t i = 1; i < metadata.num_chunks(); ++i) {
+        auto chunk = std::make_unique<Chunk>();
+        // Every worker interface uses the next channel to the sender.
+        chunk->wi = worker_cache_->GetOrCreateWorker(src_worker_);
+        if (chunk->wi == nullptr) {
+          status_.Update(errors::Internal("No worker known as ", src_worker_));
+          break;
+        }
+        chunk->req = req_;
+        chunk->req.set_chunk_index(i);
+        chunk->resp.InitAlloc(dst_device_, alloc_attrs_);
+        chunk->resp.InitChunk(resp_.tensor(), i * chunk_bytes);
+        chunks.push_back(chunk.get());
+        chunks_.push_back(std::move(chunk));
+      }
+    }
+    if (!status().ok()) {
+      for (Chunk* chunk : chunks) {
+        worker_cache_->ReleaseWorker(src_worker_, chunk->wi);
+        chunk->wi = nullptr;
+      }
+      recv_done();
+      return;
+    }
+
+    auto num_pending = std::make_shared<std::atomic<int64_t>>(chunks.size());
+    auto abort_checked = std::make_shared<Notification>();
+    auto chunk_done = [this, num_pending, abort_checked, recv_done](
+                          Chunk* chunk, const absl::Status& s) {
+      abort_checked->WaitForNotification();
+      if (!s.ok()) {
+        mutex_lock l(mu_);
+        status_.Update(s);
+      }
+      worker_cache_->ReleaseWorker(src_worker_, chunk->wi);
+      chunk->wi = nullptr;
+      if (num_pending->fetch_sub(1) == 1) {
+        recv_done();
+      }
+    };
+    for (Chunk* chunk : chunks) {
+      chunk->wi->RecvTensorAsync(
+          &chunk->opts, &chunk->req, &chunk->resp,
+          [chunk, chunk_done](const absl::Status& s) { chunk_done(chunk, s); });
+    }
+
+    // As in StartRTCall, cancel the calls if the rendezvous was aborted while
+    // they were being started.
+    if (!status().ok()) {
+      for (Chunk* chunk : chunks) {
+        chunk->opts.StartCancel();
+      }
+    }
+    abort_checked->Notify();
+  }
+
+  // A RecvTensor call for a chunk of the tensor, except the first.
+  struct Chunk {
+    WorkerInterface* wi = nullptr;  // Not owned.
+    CallOptions opts;
+    RecvTensorRequest req;
+    TensorResponse resp;
+  };
+
   string src_worker_;
   string src_rel_device_;
-  WorkerInterface* wi_;  // Not owned.
+  WorkerInterface* wi_;               // Not owned.
+  RemoteTensorTransport* transport_;  // Not owned.
+  // Set if the tensor may be received in chunks.
+  std::shared_ptr<WorkerCacheInterface> worker_cache_;
   AllocatorAttributes alloc_attrs_;
   Device* dst_device_;
   CallOptions opts_;
@@ -180,6 +307,7 @@ class RpcRecvTensorCall : public BaseRecvTensorCall {
 
   mutable mutex mu_;
   absl::Status status_ TF_GUARDED_BY(mu_);
+  std::vector<std::unique_ptr<Chunk>> chunks_ TF_GUARDED_BY(mu_);
 
   RpcRecvTensorCall(const RpcRecvTensorCall&) = delete;
   void operator=(const RpcRecvTensorCall&) = delete;
@@ -269,8 +397,21 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
     return;
   }
 
-  call->Init(rwi, step_id_, parsed.FullKey(), recv_args.alloc_attrs, dst_device,
-             recv_args, std::move(done));
+  RemoteTensorTransport* transport = nullptr;
+  if (options_.transport != nullptr &&
+      options_.transport->CanRecv(call->src_worker_, dst_device,
+                                  recv_args.alloc_attrs)) {
+    transport = options_.transport.get();
+  }
+  call->Init(rwi, transport, step_id_, parsed.FullKey(), recv_args.alloc_attrs,
+             dst_device, recv_args, std::move(done));
+  if (transport == nullptr && options_.recv_tensor_max_chunks > 1 &&
+      options_.recv_tensor_chunk_bytes > 0 &&
+      (recv_args.alloc_attrs.on_host() ||
+       dst_device->device_type() == DEVICE_CPU)) {
+    call->EnableChunks(worker_cache, options_.recv_tensor_chunk_bytes,
+                       options_.recv_tensor_max_chunks);
+  }
 
   // Record "call" in calls_ so that it can be aborted cleanly.
   RegisterCall(call, recv_args);
@@ -308,12 +449,15 @@ void RpcRemoteRendezvous::RecvFromRemoteAsync(
 }  // namespace
 
 RpcRendezvousMgr::RpcRendezvousMgr(const WorkerEnv* env)
-    : BaseRendezvousMgr(env) {}
+    : RpcRendezvousMgr(env, Options()) {}
+
+RpcRendezvousMgr::RpcRendezvousMgr(const WorkerEnv* env, Options options)
+    : BaseRendezvousMgr(env), options_(std::move(options)) {}
 
 tsl::core::RefCountPtr<BaseRemoteRendezvous> RpcRendezvousMgr::Create(
     int64_t step_id, const WorkerEnv* worker_env) {
   return tsl::core::RefCountPtr<BaseRemoteRendezvous>(
-      new RpcRemoteRendezvous(worker_env, step_id));
+      new RpcRemoteRendezvous(worker_env, step_id, options_));
 }
 
 }  // end namespace tensorflow
@@ -16,14 +16,47 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RPC_RENDEZVOUS_MGR_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RPC_RENDEZVOUS_MGR_H_
 
+#include <memory>
+
+#include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/distributed_runtime/base_rendezvous_mgr.h"
 #include "tensorflow/core/distributed_runtime/worker_env.h"
+#include "tensorflow/core/distributed_runtime/worker_interface.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/platform/macros.h"
 
 namespace tensorflow {
 
 class DeviceMgr;
 
+// Moves the contents of tensors received by the rendezvous of an
+// RpcRendezvousMgr, e.g. with one-sided RDMA reads from buffers that the
+// source worker has registered with its NIC. The gRPC worker service remains
+// the control channel: a transport is usually paired with an extra service on
+// the source worker (see GrpcServer::ExtraServices) which exposes the buffers
+// of sent tensors.
+//
+// Implementations must be thread-safe.
+class RemoteTensorTransport {
+ public:
+  virtual ~RemoteTensorTransport() = default;
+
+  // Returns true if this transport can receive tensors sent by `src_worker`
+  // into `dst_device` with `alloc_attrs`. Tensors it cannot receive are
+  // received with WorkerInterface::RecvTensorAsync.
+  virtual bool CanRecv(const string& src_worker, const Device* dst_device,
+                       const AllocatorAttributes& alloc_attrs) = 0;
+
+  // Receives the tensor for `request` from `worker` into `response`, which
+  // allocates on the destination device, and calls `done`. The transfer must
+  // be cancelled when `opts` is. `done` must not be called before this method
+  // returns.
+  virtual void RecvTensorAsync(WorkerInterface* worker, CallOptions* opts,
+                               const RecvTensorRequest* request,
+                               TensorResponse* response,
+                               StatusCallback done) = 0;
+};
+
 // RendezvousMgr keeps track of a set of local rendezvous instances.
 // All tensors sent by this worker are buffered in a RendezvousMgr
 // until the tensor is received.  Each global unique "step_id"
@@ -44,13 +77,32 @@ class DeviceMgr;
 // RendezvousMgr must have keys generated by Rendezvous::CreateKey.
 class RpcRendezvousMgr : public BaseRendezvousMgr {
  public:
+  struct Options {
+    // If set, remote tensors are received with `transport` when it can, and
+    // with the RecvTensor RPC otherwise. Shared with the rendezvous, which may
+    // outlive the manager.
+    std::shared_ptr<RemoteTensorTransport> transport;
+
+    // If `recv_tensor_max_chunks` is greater than 1, tensors with more than
+    // `recv_tensor_chunk_bytes` bytes of content which are received into host
+    // memory with RecvTensor are received in up to `recv_tensor_max_chunks`
+    // chunks. The chunks are fetched in parallel from separate
+    // WorkerInterfaces for the sender, which use separate channels if the
+    // worker cache has several channels per target.
+    int64_t recv_tensor_chunk_bytes = 0;
+    int recv_tensor_max_chunks = 1;
+  };
+
   explicit RpcRendezvousMgr(const WorkerEnv* env);
+  RpcRendezvousMgr(const WorkerEnv* env, Options options);
 
  protected:
   tsl::core::RefCountPtr<BaseRemoteRendezvous> Create(
       int64_t step_id, const WorkerEnv* worker_env) override;
 
  private:
+  const Options options_;
+
   RpcRendezvousMgr(const RpcRendezvousMgr&) = delete;
   void operator=(const RpcRendezvousMgr&) = delete;
 };
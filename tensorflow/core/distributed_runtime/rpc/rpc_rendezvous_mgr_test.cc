@@ -15,6 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/rpc/rpc_rendezvous_mgr.h"
 
+#include <atomic>
+#include <memory>
+
 #include "tensorflow/core/common_runtime/process_util.h"
 #include "tensorflow/core/distributed_runtime/test_utils.h"
 #include "tensorflow/core/framework/cancellation.h"
@@ -99,6 +102,28 @@ class DummyWorkerCache : public WorkerCacheInterface {
   DummyWorker* dummy_remote_worker_ = nullptr;
 };
 
+// A transport which receives tensors sent by "/job:worker/replica:1/task:2".
+class FakeTransport : public RemoteTensorTransport {
+ public:
+  bool CanRecv(const string& src_worker, const Device* dst_device,
+               const AllocatorAttributes& alloc_attrs) override {
+    return src_worker == "/job:worker/replica:1/task:2";
+  }
+
+  void RecvTensorAsync(WorkerInterface* worker, CallOptions* opts,
+                       const RecvTensorRequest* request,
+                       TensorResponse* response, StatusCallback done) override {
+    num_recvs_.fetch_add(1);
+    // Like RPCs, the transport must not call `done` synchronously.
+    SchedClosure([done = std::move(done)]() { done(absl::OkStatus()); });
+  }
+
+  int num_recvs() const { return num_recvs_.load(); }
+
+ private:
+  std::atomic<int> num_recvs_{0};
+};
+
 static Device* CreateDevice(const char* type, const char* name) {
   class FakeDevice : public Device {
    public:
@@ -305,6 +330,37 @@ TEST_F(RpcRendezvousMgrTest, RemoteRecvOne) {
   rmgr_.Cleanup(step_id);
 }
 
+TEST_F(RpcRendezvousMgrTest, RemoteRecvWithTransport) {
+  auto transport = std::make_shared<FakeTransport>();
+  RpcRendezvousMgr::Options options;
+  options.transport = transport;
+  RpcRendezvousMgr rmgr(&env, options);
+  const int64_t step_id = 123;
+  {
+    tsl::core::RefCountPtr<RemoteRendezvous> rendez = rmgr.Find(step_id);
+    TF_ASSERT_OK(rendez->Initialize(&worker_session_));
+    Rendezvous::Args args;
+    Tensor val(DT_STRING);
+    bool val_dead = false;
+
+    TF_ASSERT_OK(rendez->Recv(
+        MakeKey(Rendezvous::CreateKey("/job:worker/replica:1/task:2/cpu:0",
+                                      7890, "/job:mnist/replica:1/task:2/cpu:1",
+                                      "foo", FrameAndIter(0, 0))),
+        args, &val, &val_dead));
+    EXPECT_EQ(transport->num_recvs(), 1);
+
+    // Tensors the transport cannot receive are received with RecvTensor.
+    TF_ASSERT_OK(rendez->Recv(
+        MakeKey(Rendezvous::CreateKey("/job:worker/replica:1/task:3/cpu:0",
+                                      7890, "/job:mnist/replica:1/task:2/cpu:1",
+                                      "bar", FrameAndIter(0, 0))),
+        args, &val, &val_dead));
+    EXPECT_EQ(transport->num_recvs(), 1);
+  }
+  rmgr.Cleanup(step_id);
+}
+
 TEST_F(RpcRendezvousMgrTest, RemoteRecvAsyncMany) {
   const int64_t step_id = 123;
   const Rendezvous::ParsedKey key = MakeKey(Rendezvous::CreateKey(
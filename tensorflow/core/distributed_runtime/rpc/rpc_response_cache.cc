@@ -26,13 +26,22 @@ auto* tf_response_cache_hits = monitoring::Counter<0>::New(
     "/tensorflow/rpc/service/response_cache_hits",
     "Number of times the tensor response cache was used.");
 
+auto* tf_response_cache_evictions = monitoring::Counter<0>::New(
+    "/tensorflow/rpc/service/response_cache_evictions",
+    "Number of responses evicted from the tensor response cache to stay "
+    "within its byte bound.");
+
 bool RpcResponseCache::QueueRequest(int64_t request_id, int64_t step_id,
                                     const FinishResponseCB& cb) {
   VLOG(1) << "RpcResponseCache Lookup " << request_id;
 
-  mu_.lock();
+  Shard& shard = ShardFor(request_id);
+  shard.mu.lock();
 
-  ResponseCacheEntry& entry = response_cache_[request_id];
+  if (options_.ttl_micros > 0) {
+    ExpireLocked(&shard, Env::Default()->NowMicros());
+  }
+  ResponseCacheEntry& entry = shard.entries[request_id];
 
   if (entry.state == ResponseCacheEntry::State::FINISHED) {
     VLOG(1) << "Reuse cached response for " << request_id;
@@ -42,7 +51,7 @@ bool RpcResponseCache::QueueRequest(int64_t request_id, int64_t step_id,
     // expensive.
     auto entry_copy = entry;
 
-    mu_.unlock();
+    shard.mu.unlock();
 
     tf_response_cache_hits->GetCell()->IncrementBy(1);
     LOG_EVERY_N_SEC(INFO, 60)
@@ -57,7 +66,7 @@ bool RpcResponseCache::QueueRequest(int64_t request_id, int64_t step_id,
   if (entry.state == ResponseCacheEntry::State::ACTIVE) {
     VLOG(1) << "Found active request for " << request_id
             << ".  Adding entry to response queue.";
-    mu_.unlock();
+    shard.mu.unlock();
 
     tf_response_cache_hits->GetCell()->IncrementBy(1);
     LOG_EVERY_N_SEC(INFO, 60)
@@ -69,7 +78,7 @@ bool RpcResponseCache::QueueRequest(int64_t request_id, int64_t step_id,
             << ", running user computation.";
     entry.step_id = step_id;
     entry.state = ResponseCacheEntry::State::ACTIVE;
-    mu_.unlock();
+    shard.mu.unlock();
     return false;
   }
 }
@@ -80,10 +89,11 @@ void RpcResponseCache::RequestFinished(int64_t request_id, const Tensor& tensor,
   ResponseCacheEntry entry_copy;
 
   {
-    mutex_lock m(mu_);
+    Shard& shard = ShardFor(request_id);
+    mutex_lock m(shard.mu);
 
-    auto it = response_cache_.find(request_id);
-    if (it == response_cache_.end()) {
+    auto it = shard.entries.find(request_id);
+    if (it == shard.entries.end()) {
       LOG(ERROR) << "Unexpected missing response cache entry for request "
                  << request_id;
       return;
@@ -98,6 +108,12 @@ void RpcResponseCache::RequestFinished(int64_t request_id, const Tensor& tensor,
     entry.is_dead = is_dead;
     entry.response_status = status;
     entry.state = ResponseCacheEntry::State::FINISHED;
+    entry.bytes = status.ok() ? tensor.TotalBytes() : 0;
+    bytes_.fetch_add(entry.bytes, std::memory_order_relaxed);
+    if (bounded()) {
+      entry.finish_micros = Env::Default()->NowMicros();
+      shard.finished.emplace_back(request_id, entry.finish_micros);
+    }
 
     // We copy the extra work out of the critical section in order to avoid
     // serializing the work for sending response.
@@ -109,30 +125,156 @@ void RpcResponseCache::RequestFinished(int64_t request_id, const Tensor& tensor,
   for (auto& cb : entry_copy.callbacks) {
     entry_copy.FinishResponse(cb);
   }
+  // Evict after responding, so that the first chunk of a chunked response
+  // is recorded as sent and the entry is kept for the remaining chunks.
+  if (options_.max_bytes > 0 && bytes() > options_.max_bytes) {
+    EvictToLimit();
+  }
 }
 
 void RpcResponseCache::EraseRequestId(int64_t request_id) {
-  mutex_lock m(mu_);
-  response_cache_.erase(request_id);
+  Shard& shard = ShardFor(request_id);
+  mutex_lock m(shard.mu);
+  auto it = shard.entries.find(request_id);
+  if (it != shard.entries.end()) {
+    EraseLocked(&shard, it);
+  }
+}
+
+void RpcResponseCache::ChunkSent(int64_t request_id, int64_t chunk_index,
+                                 int64_t num_chunks) {
+  Shard& shard = ShardFor(request_id);
+  mutex_lock m(shard.mu);
+  auto it = shard.entries.find(request_id);
+  if (it == shard.entries.end()) {
+    return;
+  }
+  it->second.sent_chunks.insert(chunk_index);
+  if (static_cast<int64_t>(it->second.sent_chunks.size()) >= num_chunks) {
+    VLOG(1) << "Sent all " << num_chunks << " chunks for " << request_id;
+    EraseLocked(&shard, it);
+  }
 }
 
 void RpcResponseCache::CleanEntriesForStep(int64_t step_id) {
-  mutex_lock m(mu_);
-  // Remove all cache entries whose step id is the given step_id
-  for (auto it = response_cache_.begin(), last = response_cache_.end();
-       it != last;) {
-    if (it->second.step_id == step_id) {
-      VLOG(1) << "Erase stale RpcResponseCache entry " << it->first;
-      it = response_cache_.erase(it);
-    } else {
-      ++it;
+  for (Shard& shard : shards_) {
+    mutex_lock m(shard.mu);
+    // Remove all cache entries whose step id is the given step_id
+    for (auto it = shard.entries.begin(), last = shard.entries.end();
+         it != last;) {
+      if (it->second.step_id == step_id) {
+        VLOG(1) << "Erase stale RpcResponseCache entry " << it->first;
+        bytes_.fetch_sub(it->second.bytes, std::memory_order_relaxed);
+        it = shard.entries.erase(it);
+      } else {
+        ++it;
+      }
     }
   }
 }
 
 int64_t RpcResponseCache::size() {
-  mutex_lock m(mu_);
-  return response_cache_.size();
+  int64_t size = 0;
+  for (Shard& shard : shards_) {
+    mutex_lock m(shard.mu);
+    size += shard.entries.size();
+  }
+  return size;
+}
+
+void RpcResponseCache::EraseLocked(Shard* shard, EntryMap::iterator it) {
+  bytes_.fetch_sub(it->second.bytes, std::memory_order_relaxed);
+  shard->entries.erase(it);
+  // Acked entries leave stale records behind; drop them once they are the
+  // majority, so that `finished` stays proportional to `entries`.
+  if (shard->finished.size() > 2 * shard->entries.size() + kNumShards) {
+    std::deque<std::pair<int64_t, int64_t>> live;
+    for (const auto& record : shard->finished) {
+      if (FindFinishedLocked(shard, record) != shard->entries.end()) {
+        live.push_back(record);
+      }
+    }
+    shard->finished.swap(live);
+  }
+}
+
+RpcResponseCache::EntryMap::iterator RpcResponseCache::FindFinishedLocked(
+    Shard* shard, const std::pair<int64_t, int64_t>& record) {
+  auto it = shard->entries.find(record.first);
+  if (it == shard->entries.end() ||
+      it->second.state != ResponseCacheEntry::State::FINISHED ||
+      it->second.finish_micros != record.second) {
+    return shard->entries.end();
+  }
+  return it;
+}
+
+void RpcResponseCache::ExpireLocked(Shard* shard, int64_t now_micros) {
+  while (!shard->finished.empty()) {
+    const std::pair<int64_t, int64_t> record = shard->finished.front();
+    auto it = FindFinishedLocked(shard, record);
+    if (it != shard->entries.end()) {
+      if (options_.ttl_micros <= 0 ||
+          now_micros - record.second < options_.ttl_micros) {
+        return;
+      }
+      VLOG(1) << "Expire RpcResponseCache entry " << record.first;
+      shard->finished.pop_front();
+      EraseLocked(shard, it);
+    } else {
+      shard->finished.pop_front();
+    }
+  }
+}
+
+bool RpcResponseCache::OldestEvictableLocked(
+    Shard* shard, std::pair<int64_t, int64_t>* record) {
+  // Records of partially sent chunked responses are moved to the back, as
+  // the receiver is still fetching the remaining chunks.
+  for (size_t n = shard->finished.size(); n > 0; --n) {
+    auto it = FindFinishedLocked(shard, shard->finished.front());
+    if (it == shard->entries.end()) {
+      shard->finished.pop_front();
+    } else if (!it->second.sent_chunks.empty()) {
+      shard->finished.push_back(shard->finished.front());
+      shard->finished.pop_front();
+    } else {
+      *record = shard->finished.front();
+      return true;
+    }
+  }
+  return false;
+}
+
+void RpcResponseCache::EvictToLimit() {
+  while (bytes() > options_.max_bytes) {
+    // Find the shard with the oldest evictable entry, taking one shard lock
+    // at a time.
+    Shard* oldest_shard = nullptr;
+    std::pair<int64_t, int64_t> oldest;
+    for (Shard& shard : shards_) {
+      mutex_lock m(shard.mu);
+      std::pair<int64_t, int64_t> record;
+      if (OldestEvictableLocked(&shard, &record) &&
+          (oldest_shard == nullptr || record.second < oldest.second)) {
+        oldest_shard = &shard;
+        oldest = record;
+      }
+    }
+    if (oldest_shard == nullptr) return;
+    mutex_lock m(oldest_shard->mu);
+    std::pair<int64_t, int64_t> record;
+    if (!OldestEvictableLocked(oldest_shard, &record) || record != oldest) {
+      // The shard changed in the meantime.
+      continue;
+    }
+    auto it = FindFinishedLocked(oldest_shard, record);
+    VLOG(1) << "Evict RpcResponseCache entry " << record.first << " of "
+            << it->second.bytes << " bytes";
+    tf_response_cache_evictions->GetCell()->IncrementBy(1);
+    oldest_shard->finished.pop_front();
+    EraseLocked(oldest_shard, it);
+  }
 }
 
 }  // namespace tensorflow
@@ -15,14 +15,19 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RPC_RESPONSE_CACHE_H_
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_RPC_RPC_RESPONSE_CACHE_H_
 
+#include <array>
+#include <atomic>
+#include <deque>
 #include <memory>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/flatmap.h"
+#include "tensorflow/core/lib/gtl/flatset.h"
 #include "tensorflow/core/platform/mutex.h"
 
 // gRPC response caching.  Most WorkerService methods cannot be retried directly
@@ -38,11 +43,28 @@ namespace tensorflow {
 // * ACTIVE: another thread is active processing this RPC
 // * FINISHED: the worker has finished processing the method
 
+//
+// Finished entries hold a reference to the response tensor rather than a
+// serialized copy.  They can be bounded by the total bytes of these tensors
+// and by their age, see Options.
 class RpcResponseCache {
  public:
   using FinishResponseCB = std::function<void(
       const Tensor& tensor, bool is_dead, const absl::Status& status)>;
 
+  struct Options {
+    // If positive, finished entries are evicted, oldest first, to keep the
+    // bytes of the cached tensors within this bound.  Entries of chunked
+    // responses that are partially sent are not evicted.
+    int64_t max_bytes = 0;
+    // If positive, finished entries are erased this long after they
+    // finished, even if the receiver never acknowledged them.
+    int64_t ttl_micros = 0;
+  };
+
+  RpcResponseCache() : RpcResponseCache(Options()) {}
+  explicit RpcResponseCache(const Options& options) : options_(options) {}
+
   // Add the given request to the cache.
   // If the request is in the cache,
   //    If it is finished, invoke `cb` immediately
@@ -61,11 +83,19 @@ class RpcResponseCache {
   // Erase the cache entry with the given request_id
   void EraseRequestId(int64_t request_id);
 
+  // Record that chunk `chunk_index` of the tensor for the given request_id has
+  // been sent, and erase the cache entry once all `num_chunks` chunks have.
+  // Chunked responses are not acked by the receiver.
+  void ChunkSent(int64_t request_id, int64_t chunk_index, int64_t num_chunks);
+
   // Erase cache entries with the given step_id
   void CleanEntriesForStep(int64_t step_id);
 
   int64_t size();
 
+  // Returns the bytes of the tensors held by finished entries.
+  int64_t bytes() const { return bytes_.load(std::memory_order_relaxed); }
+
  private:
   struct ResponseCacheEntry {
     enum class State {
@@ -79,6 +109,11 @@ class RpcResponseCache {
     Tensor tensor;
     bool is_dead = false;
     absl::Status response_status;
+    // The chunks of `tensor` that have been sent.
+    gtl::FlatSet<int64_t> sent_chunks;
+    // When the entry finished, and the bytes of `tensor` it accounts for.
+    int64_t finish_micros = 0;
+    int64_t bytes = 0;
 
     void FinishResponse(const FinishResponseCB& cb) const {
       cb(tensor, is_dead, response_status);
@@ -86,10 +121,57 @@ class RpcResponseCache {
     std::vector<FinishResponseCB> callbacks;
   };
 
-  mutex mu_;
-  // response_cache_ is expected to be small, as entries are cleared immediately
-  // on ack from the receiver.
-  gtl::FlatMap<int64_t, ResponseCacheEntry> response_cache_ TF_GUARDED_BY(mu_);
+  using EntryMap = gtl::FlatMap<int64_t, ResponseCacheEntry>;
+
+  // Requests are spread over shards by id, so that concurrent RPCs rarely
+  // contend for the same lock.
+  static constexpr int kNumShards = 16;
+  struct Shard {
+    mutex mu;
+    // `entries` is expected to be small, as entries are cleared immediately
+    // on ack from the receiver.
+    EntryMap entries TF_GUARDED_BY(mu);
+    // The (request id, finish time) of finished entries, oldest first.  Only
+    // kept if the cache is bounded.  Records of entries that were erased
+    // since are skipped.
+    std::deque<std::pair<int64_t, int64_t>> finished TF_GUARDED_BY(mu);
+  };
+
+  Shard& ShardFor(int64_t request_id) {
+    return shards_[static_cast<uint64_t>(request_id) % kNumShards];
+  }
+
+  bool bounded() const {
+    return options_.max_bytes > 0 || options_.ttl_micros > 0;
+  }
+
+  void EraseLocked(Shard* shard, EntryMap::iterator it)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(shard->mu);
+
+  // Returns the entry of `record` in `shard`, or end() if the record is
+  // stale.
+  EntryMap::iterator FindFinishedLocked(
+      Shard* shard, const std::pair<int64_t, int64_t>& record)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(shard->mu);
+
+  // Erases the entries of `shard` that outlived the TTL, and drops stale
+  // records from the front of `shard->finished`.
+  void ExpireLocked(Shard* shard, int64_t now_micros)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(shard->mu);
+
+  // Finds the oldest finished entry of `shard` that can be evicted, and
+  // stores its record in `*record`. Returns false if there is none.
+  bool OldestEvictableLocked(Shard* shard,
+                             std::pair<int64_t, int64_t>* record)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(shard->mu);
+
+  // Evicts finished entries, oldest first, until the cached bytes are within
+  // Options::max_bytes.
+  void EvictToLimit();
+
+  const Options options_;
+  std::array<Shard, kNumShards> shards_;
+  std::atomic<int64_t> bytes_{0};
 };
 
 }  // namespace tensorflow
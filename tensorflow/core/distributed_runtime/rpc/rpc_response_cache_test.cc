@@ -0,0 +1,105 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/distributed_runtime/rpc/rpc_response_cache.h"
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+// Runs a request with `request_id` through `cache`, finishing it with
+// `tensor`.
+void RunRequest(RpcResponseCache* cache, int64_t request_id,
+                const Tensor& tensor) {
+  ASSERT_FALSE(cache->QueueRequest(
+      request_id, /*step_id=*/1,
+      [](const Tensor&, bool, const absl::Status&) {}));
+  cache->RequestFinished(request_id, tensor, /*is_dead=*/false,
+                         absl::OkStatus());
+}
+
+// Returns true if a retry of `request_id` is answered from `cache`.
+bool IsCached(RpcResponseCache* cache, int64_t request_id) {
+  bool answered = false;
+  const bool queued = cache->QueueRequest(
+      request_id, /*step_id=*/1,
+      [&answered](const Tensor&, bool, const absl::Status&) {
+        answered = true;
+      });
+  if (!queued) cache->EraseRequestId(request_id);
+  return queued && answered;
+}
+
+TEST(RpcResponseCacheTest, ReplaysFinishedRequest) {
+  RpcResponseCache cache;
+  const Tensor value = test::AsTensor<float>({1, 2, 3});
+  RunRequest(&cache, 7, value);
+  Tensor replayed;
+  EXPECT_TRUE(cache.QueueRequest(
+      7, 1, [&replayed](const Tensor& t, bool, const absl::Status&) {
+        replayed = t;
+      }));
+  test::ExpectTensorEqual<float>(value, replayed);
+  EXPECT_EQ(value.TotalBytes(), cache.bytes());
+  cache.EraseRequestId(7);
+  EXPECT_EQ(0, cache.size());
+  EXPECT_EQ(0, cache.bytes());
+}
+
+TEST(RpcResponseCacheTest, EvictsOldestToStayWithinMaxBytes) {
+  RpcResponseCache::Options options;
+  options.max_bytes = 2 * 4 * sizeof(float);
+  RpcResponseCache cache(options);
+  for (int64_t id = 1; id <= 3; ++id) {
+    RunRequest(&cache, id, test::AsTensor<float>({1, 2, 3, 4}));
+  }
+  EXPECT_EQ(options.max_bytes, cache.bytes());
+  EXPECT_FALSE(IsCached(&cache, 1));
+  EXPECT_TRUE(IsCached(&cache, 2));
+  EXPECT_TRUE(IsCached(&cache, 3));
+}
+
+TEST(RpcResponseCacheTest, KeepsPartiallySentChunks) {
+  RpcResponseCache::Options options;
+  options.max_bytes = 1;
+  RpcResponseCache cache(options);
+  ASSERT_FALSE(cache.QueueRequest(
+      5, 1, [&cache](const Tensor&, bool, const absl::Status&) {
+        cache.ChunkSent(5, /*chunk_index=*/0, /*num_chunks=*/2);
+      }));
+  cache.RequestFinished(5, test::AsTensor<float>({1, 2}), false,
+                        absl::OkStatus());
+  EXPECT_EQ(1, cache.size());
+  cache.ChunkSent(5, /*chunk_index=*/1, /*num_chunks=*/2);
+  EXPECT_EQ(0, cache.size());
+  EXPECT_EQ(0, cache.bytes());
+}
+
+TEST(RpcResponseCacheTest, ExpiresAfterTtl) {
+  RpcResponseCache::Options options;
+  options.ttl_micros = 1000;
+  RpcResponseCache cache(options);
+  RunRequest(&cache, 3, test::AsTensor<float>({1}));
+  Env::Default()->SleepForMicroseconds(2 * options.ttl_micros);
+  EXPECT_FALSE(IsCached(&cache, 3));
+  EXPECT_EQ(0, cache.bytes());
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -31,6 +31,8 @@ void TensorResponse::Clear() {
   alloc_attrs_ = AllocatorAttributes();
   allocator_ = nullptr;
   already_used_ = false;
+  chunk_destination_ = Tensor();
+  chunk_offset_bytes_ = 0;
   ClearTensor();
 }
 
@@ -50,6 +52,12 @@ void TensorResponse::InitAlloc(DeviceBase* d, const AllocatorAttributes& aa) {
   allocator_ = device_->GetAllocator(alloc_attrs_);
 }
 
+void TensorResponse::InitChunk(const Tensor& destination,
+                               int64_t offset_bytes) {
+  chunk_destination_ = destination;
+  chunk_offset_bytes_ = offset_bytes;
+}
+
 absl::Status TensorResponse::InitFrom(RecvTensorResponse* response) {
   absl::Status s;
   meta_.Swap(response);
@@ -81,6 +89,8 @@ void TensorResponse::InitPartial(const RecvTensorResponse& response,
 
 absl::Status TensorResponse::ParseFrom(Source* source) {
   if (!on_host_) {
+    absl::Status copy_status;
+    if (ParseFastToDevice(source, &copy_status)) return copy_status;
     protobuf::io::CodedInputStream input(source->contents());
 
     // Pre-parse into local storage, then delegate to device.
@@ -194,6 +204,10 @@ bool TensorResponse::ParseTensorSubmessage(
         int num_bytes;
         if (!ReadVarintSizeAsInt(input, &num_bytes)) return false;
         seen_tensor_content = true;
+        if (meta_.num_chunks() > 0) {
+          if (!ReadChunkContent(input, *tensor_meta, num_bytes)) return false;
+          break;
+        }
         TensorShape shape(tensor_meta->tensor_shape());
         Tensor t(allocator_, tensor_meta->dtype(), shape);
         StringPiece buf = t.tensor_data();
@@ -215,6 +229,32 @@ bool TensorResponse::ParseTensorSubmessage(
   }
 }
 
+bool TensorResponse::ReadChunkContent(protobuf::io::CodedInputStream* input,
+                                      const TensorProto& tensor_meta,
+                                      int num_bytes) {
+  if (!chunk_destination_.IsInitialized()) {
+    TensorShape shape;
+    if (!TensorShape::BuildTensorShape(meta_.chunked_tensor_shape(), &shape)
+             .ok()) {
+      return false;
+    }
+    chunk_destination_ = Tensor(allocator_, tensor_meta.dtype(), shape);
+    chunk_offset_bytes_ = 0;
+  }
+  if (chunk_destination_.dtype() != tensor_meta.dtype()) return false;
+  StringPiece buf = chunk_destination_.tensor_data();
+  if (chunk_offset_bytes_ < 0 ||
+      chunk_offset_bytes_ + num_bytes > static_cast<int64_t>(buf.size())) {
+    return false;
+  }
+  if (!input->ReadRaw(const_cast<char*>(buf.data()) + chunk_offset_bytes_,
+                      num_bytes)) {
+    return false;
+  }
+  tensor_ = chunk_destination_;
+  return true;
+}
+
 bool TensorResponse::ParseFast(Source* source) {
   protobuf::io::CodedInputStream input(source->contents());
   while (true) {
@@ -265,6 +305,18 @@ bool TensorResponse::ParseFast(Source* source) {
         meta_.set_require_ack(v != 0);
         break;
       }
+      case RecvTensorResponse::kNumChunksFieldNumber: {
+        protobuf_uint64 v;
+        if ((wt != WIRETYPE_VARINT) || !input.ReadVarint64(&v)) return false;
+        meta_.set_num_chunks(static_cast<int64_t>(v));
+        break;
+      }
+      case RecvTensorResponse::kChunkedTensorShapeFieldNumber: {
+        if ((wt != WIRETYPE_LENGTH_DELIMITED) ||
+            !ReadNestedMessage(&input, meta_.mutable_chunked_tensor_shape()))
+          return false;
+        break;
+      }
       default: {
         // Unknown tag, so don't handle we can't handle on the fast path
         return false;
@@ -275,10 +327,47 @@ bool TensorResponse::ParseFast(Source* source) {
   return false;
 }
 
+bool TensorResponse::ParseFastToDevice(Source* source, absl::Status* status) {
+  const DeviceBase::AcceleratorDeviceInfo* device_info =
+      device_->tensorflow_accelerator_device_info();
+  if (device_info == nullptr || device_info->default_context == nullptr) {
+    return false;
+  }
+  // Parse the tensor content straight into a host staging tensor that the
+  // device can copy from, instead of into a TensorProto that
+  // MakeTensorFromProto would copy into the staging tensor again.
+  AllocatorAttributes host_alloc_attrs;
+  host_alloc_attrs.set_on_host(true);
+  host_alloc_attrs.set_gpu_compatible(true);
+  Allocator* device_allocator = allocator_;
+  allocator_ = device_->GetAllocator(host_alloc_attrs);
+  ClearTensor();
+  const bool parsed = ParseFast(source);
+  allocator_ = device_allocator;
+  if (!parsed) {
+    ClearTensor();
+    return false;
+  }
+
+  Tensor host_tensor = std::move(tensor_);
+  tensor_ = Tensor(allocator_, host_tensor.dtype(), host_tensor.shape());
+  if (host_tensor.TotalBytes() > 0) {
+    // The destination device of a rendezvous is a Device.
+    *status = device_info->default_context->CopyCPUTensorToDeviceSync(
+        &host_tensor, static_cast<Device*>(device_), &tensor_);
+  }
+  return true;
+}
+
 bool TensorResponse::ParseSlow(Source* source) {
   if (!meta_.ParseFromZeroCopyStream(source->contents())) {
     return false;
   }
+  // Chunks of tensors are only parsed by the fast path, which reads them into
+  // their destination.
+  if (meta_.num_chunks() > 0) {
+    return false;
+  }
 
   Tensor parsed(meta_.tensor().dtype());
   if (!parsed.FromProto(allocator_, meta_.tensor())) {
@@ -45,6 +45,16 @@ class TensorResponse {
   // Initialize memory allocation related members.
   void InitAlloc(DeviceBase* d, const AllocatorAttributes& aa);
 
+  // Makes ParseFrom read a response holding a chunk of a tensor (see
+  // RecvTensorResponse.num_chunks) directly into `destination`, starting at
+  // `offset_bytes`, instead of allocating a tensor for the chunk. tensor() is
+  // then `destination`. Must be called after InitAlloc.
+  //
+  // Without a destination, the first chunk of a tensor is read into a new
+  // tensor with the shape of the whole tensor, which is then the destination
+  // for the other chunks.
+  void InitChunk(const Tensor& destination, int64_t offset_bytes);
+
   // Source provides a way for a particular RPC implementation to provide
   // received data to ParseFrom.
   class Source {
@@ -94,6 +104,12 @@ class TensorResponse {
   bool ParseTensorSubmessage(protobuf::io::CodedInputStream* input,
                              TensorProto* tensor_meta);
   bool ParseFast(Source* source);
+  bool ReadChunkContent(protobuf::io::CodedInputStream* input,
+                        const TensorProto& tensor_meta, int num_bytes);
+  // Parses a tensor for an accelerator device through a host staging tensor.
+  // Returns false if the fast path cannot be used, otherwise sets `*status`
+  // to the result of copying the tensor to the device.
+  bool ParseFastToDevice(Source* source, absl::Status* status);
   bool ParseSlow(Source* source);
 
   bool on_host_ = false;
@@ -101,6 +117,9 @@ class TensorResponse {
   AllocatorAttributes alloc_attrs_;
   Allocator* allocator_ = nullptr;
   bool already_used_ = false;
+  // The tensor that chunks are read into, and the offset of the chunk.
+  Tensor chunk_destination_;
+  int64_t chunk_offset_bytes_ = 0;
   Tensor tensor_;
   RecvTensorResponse meta_;
 };
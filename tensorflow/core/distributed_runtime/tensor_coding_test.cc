@@ -15,10 +15,12 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/tensor_coding.h"
 
+#include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/device_attributes.pb.h"
 #include "tensorflow/core/framework/device_base.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/env.h"
@@ -46,6 +48,50 @@ class DummyDevice : public DeviceBase {
   DeviceAttributes attr_;
 };
 
+// A device context which copies host tensors to a fake accelerator device
+// whose memory is host memory.
+class FakeAcceleratorDeviceContext : public DeviceContext {
+ public:
+  void CopyCPUTensorToDevice(const Tensor* cpu_tensor, Device* device,
+                             Tensor* device_tensor, StatusCallback done,
+                             bool sync_dst_compute) const override {
+    ++num_copies_;
+    memcpy(const_cast<char*>(device_tensor->tensor_data().data()),
+           cpu_tensor->tensor_data().data(), cpu_tensor->TotalBytes());
+    done(absl::OkStatus());
+  }
+
+  int num_copies() const { return num_copies_; }
+
+ private:
+  mutable int num_copies_ = 0;
+};
+
+class FakeAcceleratorDevice : public Device {
+ public:
+  explicit FakeAcceleratorDevice(DeviceContext* device_context)
+      : Device(Env::Default(), Attributes()) {
+    device_info_.default_context = device_context;
+    set_tensorflow_accelerator_device_info(&device_info_);
+  }
+
+  absl::Status Sync() override { return absl::OkStatus(); }
+
+  Allocator* GetAllocator(AllocatorAttributes attr) override {
+    return cpu_allocator();
+  }
+
+ private:
+  static DeviceAttributes Attributes() {
+    DeviceAttributes attr;
+    attr.set_name("/job:a/replica:0/task:0/device:FAKE_GPU:0");
+    attr.set_device_type("FAKE_GPU");
+    return attr;
+  }
+
+  AcceleratorDeviceInfo device_info_;
+};
+
 class StringSource : public TensorResponse::Source {
  public:
   explicit StringSource(const string* s, int block_size)
@@ -156,6 +202,29 @@ TEST_F(TensorResponseTest, Simple) {
 
 TEST_F(TensorResponseTest, StringTensor) { DoTestForStrings(DT_STRING); }
 
+TEST_F(TensorResponseTest, AcceleratorDevice) {
+  Tensor src(DT_FLOAT, TensorShape({2, 3}));
+  test::FillValues<float>(&src, {1, 2, 3, 4, 5, 6});
+  RecvTensorResponse proto;
+  proto.set_send_start_micros(123456);
+  src.AsProtoTensorContent(proto.mutable_tensor());
+  string encoded;
+  proto.AppendToString(&encoded);
+  StringSource source(&encoded, 1024);
+
+  core::RefCountPtr<FakeAcceleratorDeviceContext> device_context(
+      new FakeAcceleratorDeviceContext);
+  FakeAcceleratorDevice device(device_context.get());
+  TensorResponse response;
+  response.InitAlloc(&device, AllocatorAttributes());
+  TF_ASSERT_OK(response.ParseFrom(&source));
+  EXPECT_EQ(response.metadata().send_start_micros(), 123456);
+  test::ExpectTensorEqual<float>(src, response.tensor());
+  // The tensor is parsed into a staging tensor, and copied to the device
+  // without going through MakeTensorFromProto.
+  EXPECT_EQ(device_context->num_copies(), 1);
+}
+
 string MakeFloatTensorTestCase(int num_elems) {
   std::vector<int8> v(num_elems);
   for (int i = 0; i < num_elems; i++) {
@@ -116,6 +116,17 @@ struct CollImplDetails {
                               // e.g. ring or nccl
   float timeout_seconds;      // If non zero, set a completion timeout for the
                               // collective op to detect staleness.
+  // If bucket_size > 1, this reduction is packed with the other reductions of
+  // its group and device that have the same bucket_key into one flat buffer,
+  // which is reduced by a single collective once all bucket_size of them
+  // have been issued. The reductions in a bucket must not depend on each
+  // other, and every participant must use the same buckets.
+  int32 bucket_key = 0;
+  int32 bucket_size = 0;
+  // If DT_HALF or DT_BFLOAT16, the values of a DT_FLOAT reduction on host
+  // memory are sent between devices as this type, and converted back to
+  // DT_FLOAT to be reduced.  Every participant must use the same wire_dtype.
+  DataType wire_dtype = DT_INVALID;
 };
 
 // Data common to all members of a collective instance.
@@ -31,6 +31,7 @@ limitations under the License.
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/control_flow.h"
@@ -156,6 +157,18 @@ class Device : public DeviceBase {
     return absl::OkStatus();
   }
 
+  // Fills in `device_context_map` with the DeviceContext each node of `graph`
+  // should run with, indexed by node id. Nodes whose entry is missing or
+  // nullptr run with the context returned by TryGetDeviceContext(). Leaves
+  // the map empty by default.
+  //
+  // The caller takes ownership of one reference on each non-null entry, and
+  // should call Unref().
+  virtual Status FillContextMap(
+      const Graph* graph, std::vector<DeviceContext*>* device_context_map) {
+    return absl::OkStatus();
+  }
+
   // Returns the op segment of this device.  The caller can reuse op
   // kernels registered for the same session running on this device.
   OpSegment* op_segment() { return &op_seg_; }
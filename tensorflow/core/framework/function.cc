@@ -17,12 +17,14 @@ limitations under the License.
 
 #include <ctype.h>
 
+#include <algorithm>
 #include <map>
 #include <string>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
 #include "absl/strings/escaping.h"
@@ -40,9 +42,12 @@ limitations under the License.
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_debug_info_builder.h"
 #include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
 #include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/refcount.h"
 #include "tensorflow/core/util/device_name_utils.h"
@@ -1340,23 +1345,67 @@ FunctionLibraryDefinition::CreateStackTracesForFunctionDefLibrary(
   return library_traces;
 }
 
+namespace {
+
+// Libraries with at least this many functions build their records in
+// parallel when constructed from a FunctionDefLibrary.
+constexpr int kMinFunctionsForParallelInitialize = 256;
+constexpr int kMaxInitializeThreads = 16;
+// Rough cost, in cycles, of copying one function body into a record.
+constexpr int64_t kInitializeCostPerFunction = 100000;
+
+}  // namespace
+
 void FunctionLibraryDefinition::Initialize(
     const FunctionDefLibrary& library,
     const FunctionDefLibraryStackTraces& library_traces) {
   tf_shared_lock lock(mu_);
-  for (const auto& fdef : library.function()) {
-    // The latter function definition wins.
-    auto iter = records_.find(fdef.signature().name());
+  // The latter function definition wins, so only the last definition of each
+  // name is turned into a record.
+  absl::flat_hash_map<absl::string_view, int> last_definition;
+  last_definition.reserve(library.function_size());
+  for (int i = 0; i < library.function_size(); ++i) {
+    last_definition[library.function(i).signature().name()] = i;
+  }
+  std::vector<int> indices;
+  indices.reserve(last_definition.size());
+  for (int i = 0; i < library.function_size(); ++i) {
+    if (last_definition[library.function(i).signature().name()] == i) {
+      indices.push_back(i);
+    }
+  }
+
+  // Copying the function bodies dominates the cost for the large libraries
+  // found in SavedModels, so build the records concurrently in that case.
+  std::vector<FunctionRecord*> new_records(indices.size());
+  auto build_records = [&](int64_t start, int64_t limit) {
+    for (int64_t i = start; i < limit; ++i) {
+      const FunctionDef& fdef = library.function(indices[i]);
+      const auto& it = library_traces.find(fdef.signature().name());
+      new_records[i] = new FunctionRecord(
+          fdef, it != library_traces.end() ? it->second : StackTracesMap(),
+          true);
+    }
+  };
+  const int num_threads =
+      std::min<int>(port::MaxParallelism(), kMaxInitializeThreads);
+  if (indices.size() >= kMinFunctionsForParallelInitialize &&
+      num_threads > 1) {
+    thread::ThreadPool pool(Env::Default(), "function_library_init",
+                            num_threads);
+    pool.ParallelFor(indices.size(), kInitializeCostPerFunction,
+                     build_records);
+  } else {
+    build_records(0, indices.size());
+  }
+
+  for (FunctionRecord* record : new_records) {
+    auto iter = records_.find(record->fdef().signature().name());
     if (iter != records_.end()) {
       iter->second->Unref();
       records_.erase(iter);
     }
-    const auto& it = library_traces.find(fdef.signature().name());
-    records_.insert(
-        {fdef.signature().name(),
-         new FunctionRecord(
-             fdef, it != library_traces.end() ? it->second : StackTracesMap(),
-             true)});
+    records_.insert({record->fdef().signature().name(), record});
   }
   for (const auto& grad : library.gradient()) {
     func_grad_[grad.function_name()] = grad.gradient_func();
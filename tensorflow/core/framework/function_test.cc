@@ -1551,6 +1551,29 @@ TEST(FunctionLibraryDefinitionTest, MoveTest) {
   EXPECT_TRUE(copy_lib_def.FindOptimizedFunctionGraph("test").value().ok());
 }
 
+TEST(FunctionLibraryDefinitionTest, ConstructFromLargeLibrary) {
+  // Large enough to build the records in parallel; every name is defined
+  // twice and the latter definition must win.
+  FunctionDefLibrary library;
+  for (int i = 0; i < 1000; ++i) {
+    FunctionDef* fdef = library.add_function();
+    *fdef = test::function::XTimesTwo();
+    fdef->mutable_signature()->set_name(strings::StrCat("F", i % 500));
+    (*fdef->mutable_attr())["index"].set_i(i);
+  }
+  FunctionLibraryDefinition lib_def(OpRegistry::Global(), library);
+
+  EXPECT_EQ(lib_def.num_functions(), 500);
+  for (int i = 0; i < 500; ++i) {
+    const FunctionDef* fdef = lib_def.Find(strings::StrCat("F", i));
+    ASSERT_NE(fdef, nullptr);
+    EXPECT_EQ(fdef->attr().at("index").i(), i + 500);
+    const OpDef* op_def = nullptr;
+    TF_EXPECT_OK(lib_def.LookUpOpDef(strings::StrCat("F", i), &op_def));
+    EXPECT_EQ(op_def->name(), strings::StrCat("F", i));
+  }
+}
+
 TEST(FunctionLibraryDefinitionTest, ConstructFromGraphDef) {
   // Prepare GraphDef with FunctionDefLibrary and associated stackt traces.
   FunctionDefLibrary library;
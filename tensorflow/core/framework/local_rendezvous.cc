@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/local_rendezvous.h"
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <utility>
@@ -140,14 +141,10 @@ LocalRendezvous::~LocalRendezvous() {
   }
 }
 
-namespace {
-uint64 KeyHash(const StringPiece& k) { return Hash64(k.data(), k.size()); }
-}  // namespace
-
 Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
                              const Rendezvous::Args& send_args,
                              const Tensor& val, const bool is_dead) {
-  uint64 key_hash = KeyHash(key.FullKey());
+  const uint64 key_hash = key.FullKeyHash();
   DVLOG(2) << "Send " << this << " " << key_hash << " " << key.FullKey();
 
   if (is_dead) {
@@ -160,7 +157,9 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
         ->IncrementBy(1);
   }
 
-  TF_RETURN_IF_ERROR(status());
+  if (TF_PREDICT_FALSE(aborted_.load(std::memory_order_acquire))) {
+    return status();
+  }
 
   int bucket_index = key_hash % num_buckets_;
   auto& bucket = table_buckets_[bucket_index];
@@ -227,14 +226,13 @@ Status LocalRendezvous::Send(const Rendezvous::ParsedKey& key,
 void LocalRendezvous::RecvAsync(const Rendezvous::ParsedKey& key,
                                 const Rendezvous::Args& recv_args,
                                 Rendezvous::DoneCallback done) {
-  uint64 key_hash = KeyHash(key.FullKey());
+  const uint64 key_hash = key.FullKeyHash();
   DVLOG(2) << "Recv " << this << " " << key_hash << " " << key.FullKey();
   tsl::core::RefCountPtr<Rendezvous> rc_keep_alive;
 
-  auto s = status();
-  if (!s.ok()) {
+  if (TF_PREDICT_FALSE(aborted_.load(std::memory_order_acquire))) {
     // Rendezvous has been aborted.
-    done(s, Rendezvous::Args(), recv_args, Tensor(), false);
+    done(status(), Rendezvous::Args(), recv_args, Tensor(), false);
     return;
   }
 
@@ -401,6 +399,7 @@ void LocalRendezvous::DoAbort(const Status& status) {
   {
     mutex_lock l(mu_);
     status_.Update(status);
+    aborted_.store(true, std::memory_order_release);
   }
   LOG_EVERY_POW_2(INFO) << "Local rendezvous is aborting with status: "
                         << status;
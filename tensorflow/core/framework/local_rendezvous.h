@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 #define TENSORFLOW_CORE_FRAMEWORK_LOCAL_RENDEZVOUS_H_
 
+#include <atomic>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -102,6 +103,9 @@ class LocalRendezvous {
   const std::unique_ptr<TableBucket[]> table_buckets_;
   mutex mu_;
   absl::Status status_ TF_GUARDED_BY(mu_);
+  // Whether `status_` is an error, so that Send and RecvAsync do not take
+  // `mu_`, which all keys share, unless the rendezvous has been aborted.
+  std::atomic<bool> aborted_ = false;
 
   // We deliberately leak one reference of the aborted rendezvous here, so that
   // they won't be destructed, and lose the status_.
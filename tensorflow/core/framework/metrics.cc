@@ -75,6 +75,29 @@ auto* graph_run_output_tensor_bytes = tsl::monitoring::Sampler<0>::New(
     // Power of 2 with bucket count 14 (256MB)
     {tsl::monitoring::Buckets::Exponential(1, 4, 14)});
 
+auto* graph_run_forwarded_input_bytes = tsl::monitoring::Sampler<0>::New(
+    {"/tensorflow/core/graph_run_forwarded_input_bytes",
+     "The size of the input buffers forwarded to outputs by the kernels of "
+     "one graph execution, in bytes."},
+    // Power of 4 with bucket count 16 (4GB)
+    {tsl::monitoring::Buckets::Exponential(1, 4, 16)});
+
+auto* allocator_free_bytes = tsl::monitoring::Gauge<int64_t, 1>::New(
+    "/tensorflow/core/allocator_free_bytes",
+    "The number of bytes held by an allocator but not in use.", "allocator");
+
+auto* allocator_largest_free_block_bytes =
+    tsl::monitoring::Gauge<int64_t, 1>::New(
+        "/tensorflow/core/allocator_largest_free_block_bytes",
+        "The size of the largest free block of an allocator in bytes.",
+        "allocator");
+
+auto* allocator_fragmentation = tsl::monitoring::Gauge<double, 1>::New(
+    "/tensorflow/core/allocator_fragmentation",
+    "The fraction of the free bytes of an allocator that are outside its "
+    "largest free block.",
+    "allocator");
+
 auto* graph_unused_outputs = tsl::monitoring::Counter<1>::New(
     "/tensorflow/core/graph_unused_outputs",
     "The number of unused outputs for ops of a given type.", "name");
@@ -177,6 +200,15 @@ auto* tf_data_buffered_vs_budget_ratio_histogram =
         {tsl::monitoring::Buckets::Explicit(
             {0.0, 0.2, 0.4, 0.6, 0.8, 1.0, 1.2, 1.4, 1.6, 1.8, 2.0})});
 
+auto* tf_data_parallelism_vs_budget_ratio_histogram =
+    tsl::monitoring::Sampler<0>::New(
+        {"/tensorflow/data/parallelism_vs_budget_ratio",
+         "Ratio of the tf.data total parallelism chosen by optimization over "
+         "cpu budget."},
+        // Uniform linear buckets with count 10 from 0 to 2
+        {tsl::monitoring::Buckets::Explicit(
+            {0.0, 0.2, 0.4, 0.6, 0.8, 1.0, 1.2, 1.4, 1.6, 1.8, 2.0})});
+
 auto* tf_data_iterator_busy_counter = tsl::monitoring::Counter<0>::New(
     "/tensorflow/data/iterator_busy",
     "The time (in microseconds) during which a "
@@ -330,6 +362,12 @@ auto* tf_data_autotune_stopping_criteria_counter =
         "algorithm stopping criterion is met.",
         "name");
 
+auto* tf_data_rewrite_suggestion_counter = tsl::monitoring::Counter<1>::New(
+    "/tensorflow/data/rewrite_suggestion",
+    "The number of times the statistics of a tf.data pipeline suggested a "
+    "static optimization that it does not apply.",
+    "name");
+
 auto* tf_data_debug = tsl::monitoring::Counter<1>::New(
     "/tensorflow/data/debug",
     "The number of times this event occured, for debugging.", "event");
@@ -586,6 +624,12 @@ void RecordTFDataAutotuneMaxBufferBudgetRatio(const double ratio) {
   tf_data_buffered_vs_budget_ratio_histogram_cell->Add(ratio);
 }
 
+void RecordTFDataAutotuneParallelismBudgetRatio(const double ratio) {
+  static auto* tf_data_parallelism_vs_budget_ratio_histogram_cell =
+      tf_data_parallelism_vs_budget_ratio_histogram->GetCell();
+  tf_data_parallelism_vs_budget_ratio_histogram_cell->Add(ratio);
+}
+
 void RecordTFDataIteratorBusy(uint64 duration_us) {
   static auto* tf_data_iterator_busy_cell =
       tf_data_iterator_busy_counter->GetCell();
@@ -738,6 +782,10 @@ void RecordTFDataAutotuneStoppingCriteria(const string& name) {
   tf_data_autotune_stopping_criteria_counter->GetCell(name)->IncrementBy(1);
 }
 
+void RecordTFDataRewriteSuggestion(const string& name) {
+  tf_data_rewrite_suggestion_counter->GetCell(name)->IncrementBy(1);
+}
+
 void RecordTFDataDebug(const string& event) {
   tf_data_debug->GetCell(event)->IncrementBy(1);
 }
@@ -809,6 +857,25 @@ void UpdateGraphExecTime(const uint64 running_time_usecs) {
   }
 }
 
+void UpdateAllocatorFragmentation(const string& allocator_name,
+                                  int64_t free_bytes,
+                                  int64_t largest_free_block_bytes) {
+  allocator_free_bytes->GetCell(allocator_name)->Set(free_bytes);
+  allocator_largest_free_block_bytes->GetCell(allocator_name)
+      ->Set(largest_free_block_bytes);
+  allocator_fragmentation->GetCell(allocator_name)
+      ->Set(free_bytes > 0 ? static_cast<double>(free_bytes -
+                                                 largest_free_block_bytes) /
+                                 free_bytes
+                           : 0.0);
+}
+
+void RecordGraphForwardedInputBytes(int64_t num_bytes) {
+  static auto* graph_run_forwarded_input_bytes_cell =
+      graph_run_forwarded_input_bytes->GetCell();
+  graph_run_forwarded_input_bytes_cell->Add(num_bytes);
+}
+
 void UpdateGraphPendingQueueLength(uint64 len) {
   static auto* graph_pending_queue_length_cell =
       graph_pending_queue_length_histogram->GetCell();
@@ -110,6 +110,10 @@ void RecordTFDataAutotuneUsedRamBudgetRatio(const double ratio);
 // bytes over the ram budget.
 void RecordTFDataAutotuneMaxBufferBudgetRatio(const double ratio);
 
+// Records the histogram of ratios of the total parallelism chosen by the
+// tf.data autotune algorithm over the cpu budget.
+void RecordTFDataAutotuneParallelismBudgetRatio(const double ratio);
+
 // Records the number of times each tf.data fingerprint is used
 // to measure duplicate pre-processing.
 //
@@ -235,6 +239,10 @@ void RecordTFDataAutoShardRewriteBatchSize(
 // criterion is met.
 void RecordTFDataAutotuneStoppingCriteria(const string& name);
 
+// Records the number of times the statistics of a tf.data pipeline suggested
+// the static optimization `name`.
+void RecordTFDataRewriteSuggestion(const string& name);
+
 // Records the number of times this event occured, for debugging.
 void RecordTFDataDebug(const string& event);
 
@@ -269,6 +277,18 @@ void RecordTPUXlaSpmdCoresPerReplica(int64_t cores_per_replica);
 void UpdateGraphExecTime(const uint64 running_time_usecs);
 void UpdateGraphPendingQueueLength(uint64 len);
 
+// Records the free memory of the allocator named `allocator_name`, namely the
+// bytes it holds but are not in use, and the size of the largest of its free
+// blocks. Free memory outside the largest block is fragmented: it cannot
+// serve a request of the largest block's size.
+void UpdateAllocatorFragmentation(const string& allocator_name,
+                                  int64_t free_bytes,
+                                  int64_t largest_free_block_bytes);
+
+// Records the number of bytes of input buffers that kernels reused as output
+// buffers during one graph execution.
+void RecordGraphForwardedInputBytes(int64_t num_bytes);
+
 // Records that one output of an op of type `op_name` was unused.
 void RecordUnusedOutput(const string& op_name);
 
@@ -66,8 +66,10 @@ constexpr double kBufferDownsizeMultipliter = 0.9;
 constexpr int64_t kBufferLowWatermarkThreshold = 2;
 
 constexpr char kDataService[] = "DataService";
+constexpr char kFilter[] = "Filter";
 constexpr char kFlatMap[] = "FlatMap";
 constexpr char kInterleave[] = "Interleave";
+constexpr char kMap[] = "Map";
 constexpr char kParallelInterleave[] = "ParallelInterleave";
 
 // A class to prune outliers given a set of points. To use it, instantiate an
@@ -280,6 +282,17 @@ inline bool IsAsyncInterleaveManyNode(const Node* node) {
   return absl::StartsWith(node->name(), kParallelInterleave);
 }
 
+// Returns the sum of the values of the parallelism parameters in `parameters`.
+inline int64_t TotalParallelism(const Node::ModelParameters& parameters) {
+  int64_t total_parallelism = 0;
+  for (const auto& pair : parameters) {
+    if (pair.second->name == kParallelism) {
+      total_parallelism += std::round(pair.second->value);
+    }
+  }
+  return total_parallelism;
+}
+
 // Wrapper for the square function to reduce verbosity.
 inline double Square(double x) { return x * x; }
 
@@ -2555,6 +2568,8 @@ Status Model::OptimizeLoop(AutotuneAlgorithm algorithm,
 
   int64_t last_optimization_ms = 0;
   int64_t current_time_ms = EnvTime::NowMicros() / EnvTime::kMillisToMicros;
+  const int64_t loop_start_ms = current_time_ms;
+  bool rewrites_suggested = false;
   while (true) {
     {
       mutex_lock l(mu_);
@@ -2595,7 +2610,58 @@ Status Model::OptimizeLoop(AutotuneAlgorithm algorithm,
     current_time_ms = EnvTime::NowMicros() / EnvTime::kMillisToMicros;
     last_optimization_ms = current_time_ms;
     FlushMetrics();
+    if (!rewrites_suggested &&
+        current_time_ms - loop_start_ms >= kRewriteSuggestionDelayMs) {
+      rewrites_suggested = true;
+      for (const auto& [node_name, rewrite] : SuggestRewrites()) {
+        metrics::RecordTFDataRewriteSuggestion(rewrite);
+        LOG(INFO) << "The statistics of the tf.data pipeline suggest that the "
+                  << "`" << rewrite << "` optimization would speed up "
+                  << node_name << ".";
+      }
+    }
+  }
+}
+
+std::vector<std::pair<std::string, std::string>> Model::SuggestRewrites() {
+  std::shared_ptr<Node> snapshot;
+  {
+    tf_shared_lock l(mu_);
+    if (output_ == nullptr) return {};
+    snapshot = output_->Snapshot();
   }
+  // A synchronous transformation that accounts for at least this share of the
+  // per-element CPU time of the pipeline is considered its bottleneck.
+  constexpr double kBottleneckShare = 0.5;
+
+  std::vector<std::pair<std::string, std::string>> rewrites;
+  Node::NodeValues processing_times;
+  const double total_processing_time =
+      snapshot->TotalProcessingTime(&processing_times);
+  if (total_processing_time <= 0) return rewrites;
+  Node::NodeVector nodes =
+      snapshot->CollectNodes(TraversalOrder::BFS, IsAutotuneNode);
+  nodes.insert(nodes.begin(), snapshot);
+  bool has_async_node = false;
+  for (const auto& node : nodes) {
+    if (node->IsAsync()) {
+      has_async_node = true;
+      continue;
+    }
+    if (processing_times[node->long_name()] <
+        kBottleneckShare * total_processing_time) {
+      continue;
+    }
+    if (node->name() == kMap) {
+      rewrites.emplace_back(node->long_name(), "map_parallelization");
+    } else if (node->name() == kFilter) {
+      rewrites.emplace_back(node->long_name(), "filter_parallelization");
+    }
+  }
+  if (!has_async_node) {
+    rewrites.emplace_back(snapshot->long_name(), "inject_prefetch");
+  }
+  return rewrites;
 }
 
 void Model::OptimizeGradientDescent(
@@ -2701,12 +2767,19 @@ void Model::OptimizeHillClimbHelper(
     }
     pair.second->value = pair.second->min;
   }
+  // Under the "autotune_cpu_budget" experiment, the total parallelism of the
+  // pipeline is capped at the CPU budget, so that once it is reached the
+  // remaining steps only grow buffer sizes, which are capped by the RAM budget.
+  const bool cap_parallelism = experiments_.contains("autotune_cpu_budget");
+  const int64_t cpu_budget = optimization_params.cpu_budget();
   Parameter* best_parameter = nullptr;
   while (!cancellation_manager->IsCancelled()) {
     const double output_time =
         OutputTime(snapshot, optimization_params.model_input_time(),
                    /*gradients=*/nullptr);
     const double new_buffered_bytes = TotalMaximumBufferedBytes(snapshot);
+    const bool cpu_budget_reached =
+        cap_parallelism && TotalParallelism(parameters) >= cpu_budget;
     if (should_stop(parameters, processing_time, output_time,
                     new_buffered_bytes)) {
       if (best_parameter && new_buffered_bytes > ram_budget) {
@@ -2722,7 +2795,8 @@ void Model::OptimizeHillClimbHelper(
     best_parameter = nullptr;
     for (auto& pair : parameters) {
       if (pair.second->value >= pair.second->max ||
-          (skip_buffer_sizes && (pair.second->name == kBufferSize))) {
+          (skip_buffer_sizes && (pair.second->name == kBufferSize)) ||
+          (cpu_budget_reached && (pair.second->name == kParallelism))) {
         continue;
       }
       pair.second->value++;
@@ -2738,6 +2812,13 @@ void Model::OptimizeHillClimbHelper(
       pair.second->value--;
     }
     if (!best_parameter) {
+      if (cpu_budget_reached) {
+        metrics::RecordTFDataAutotuneStoppingCriteria("cpu_budget");
+        VLOG(2) << "The total parallelism reached the CPU budget of "
+                << cpu_budget << " and no buffer size would further decrease "
+                << "the output time. The optimization attempt will stop now.";
+        break;
+      }
       metrics::RecordTFDataAutotuneStoppingCriteria("local_maximum_reached");
       VLOG(2) << "Failed to find a tunable parameter that would further "
                  "decrease the output time. This suggests that the hill-climb "
@@ -2755,6 +2836,10 @@ void Model::OptimizeHillClimbHelper(
     // that is why we still need to invoke RequestModelAllocation
     // as `ram_budget` might be outdated
     UpdateStateValues(&parameters);
+    if (cpu_budget > 0) {
+      metrics::RecordTFDataAutotuneParallelismBudgetRatio(
+          TotalParallelism(parameters) / static_cast<double>(cpu_budget));
+    }
   }
 }
 void Model::RecordIteratorGapTime(uint64_t duration_usec) {
@@ -1041,6 +1041,19 @@ class Model {
   // having executed an optimization round before.
   double ComputeSnapshotProcessingTimeNsec() const;
 
+  // Returns the static tf.data graph rewrites that the statistics collected so
+  // far suggest for this pipeline, as pairs of the long name of a node and the
+  // name of the optimization that would rewrite it:
+  //
+  // * "map_parallelization" or "filter_parallelization" for a synchronous
+  //   `Map` or `Filter` that accounts for most of the per-element CPU time.
+  // * "inject_prefetch" for the output node if the pipeline has no
+  //   asynchronous node, so that no work overlaps with its consumer.
+  //
+  // `OptimizeLoop()` reports the suggestions once, after the model collected
+  // statistics for `kRewriteSuggestionDelayMs`.
+  std::vector<std::pair<std::string, std::string>> SuggestRewrites();
+
  private:
   // Determines whether optimization should stop given total processing time,
   // estimated output time, and estimated number of buffers bytes.
@@ -1050,6 +1063,8 @@ class Model {
   static constexpr int64_t kOptimizationPeriodMinMs = 10;
   static constexpr int64_t kOptimizationPeriodMaxMs =
       60 * EnvTime::kSecondsToMillis;
+  static constexpr int64_t kRewriteSuggestionDelayMs =
+      120 * EnvTime::kSecondsToMillis;
 
   // Collects tunable parameters in the tree rooted in the given node, returning
   // a vector which contains pairs of node names and tunable parameters.
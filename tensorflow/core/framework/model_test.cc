@@ -1386,6 +1386,75 @@ TEST_P(OptimizeZeroRamBudgetTest, Model) {
 INSTANTIATE_TEST_SUITE_P(Test, OptimizeZeroRamBudgetTest,
                          ::testing::Values(0, 1, 2, 3));
 
+class OptimizeCpuBudgetTest : public ::testing::TestWithParam<bool> {};
+
+TEST_P(OptimizeCpuBudgetTest, Model) {
+  const bool cap_parallelism = GetParam();
+
+  std::shared_ptr<mutex> mutex1 = std::make_shared<mutex>();
+  std::shared_ptr<condition_variable> cv1 =
+      std::make_shared<condition_variable>();
+  std::shared_ptr<Node> node1 = model::MakeAsyncKnownRatioNode(
+      {1, "1", nullptr}, 2,
+      {model::MakeParameter("parallelism",
+                            std::make_shared<SharedState>(
+                                /*value=*/model::kAutotune, mutex1, cv1),
+                            /*min=*/1, /*max=*/8)});
+  node1->record_element();
+
+  std::shared_ptr<mutex> mutex2 = std::make_shared<mutex>();
+  std::shared_ptr<condition_variable> cv2 =
+      std::make_shared<condition_variable>();
+  std::shared_ptr<Node> node2 = model::MakeAsyncKnownRatioNode(
+      {2, "2", node1}, 2,
+      {model::MakeParameter("parallelism",
+                            std::make_shared<SharedState>(
+                                /*value=*/model::kAutotune, mutex2, cv2),
+                            /*min=*/1, /*max=*/8)});
+  node2->record_element();
+
+  model::Model model;
+  if (cap_parallelism) model.AddExperiment("autotune_cpu_budget");
+  model.AddNode([&node1](model::Node::Args args) { return node1; }, "1",
+                nullptr, &node1);
+  model.AddNode([&node2](model::Node::Args args) { return node2; }, "2", node1,
+                &node2);
+
+  CancellationManager cancellation_manager;
+  RamBudgetManager ram_budget_manager(1LL << 30);
+  model.Optimize(model::AutotuneAlgorithm::MAX_PARALLELISM, CpuBudgetFunc(5),
+                 /*ram_budget_share=*/1.0,
+                 /*fixed_ram_budget=*/1LL << 30,
+                 /*model_input_time=*/0, ram_budget_manager,
+                 &cancellation_manager);
+  const int64_t total_parallelism = node1->parameter_value("parallelism") +
+                                    node2->parameter_value("parallelism");
+  EXPECT_EQ(total_parallelism, cap_parallelism ? 5 : 16);
+}
+
+INSTANTIATE_TEST_SUITE_P(Test, OptimizeCpuBudgetTest, ::testing::Bool());
+
+TEST(ModelTest, SuggestRewrites) {
+  std::shared_ptr<Node> map =
+      model::MakeKnownRatioNode({1, "Map", nullptr}, /*ratio=*/1);
+  std::shared_ptr<Node> source = model::MakeSourceNode({2, "TFRecord", map});
+  model::Model model;
+  model.AddNode([&map](model::Node::Args args) { return map; }, "Map", nullptr,
+                &map);
+  model.AddNode([&source](model::Node::Args args) { return source; },
+                "TFRecord", map, &source);
+  map->add_processing_time(900);
+  map->record_element();
+  source->add_processing_time(100);
+  source->record_element();
+
+  using Rewrite = std::pair<std::string, std::string>;
+  EXPECT_THAT(model.SuggestRewrites(),
+              ::testing::UnorderedElementsAre(
+                  Rewrite(map->long_name(), "map_parallelization"),
+                  Rewrite(map->long_name(), "inject_prefetch")));
+}
+
 TEST(RecordTimeTest, RecordTimeTest) {
   std::shared_ptr<Node> source = model::MakeSourceNode({});
   EXPECT_FALSE(source->is_recording());
@@ -379,6 +379,11 @@ Allocator* OpKernelContext::get_allocator(AllocatorAttributes attr) {
   if (TF_PREDICT_FALSE(attr.scope_id > 0)) {
     allocator = params_->device->GetScopedAllocator(attr, step_id());
     CHECK(allocator);
+  } else if (params_->step_allocator != nullptr && !attr.gpu_compatible() &&
+             !attr.nic_compatible()) {
+    allocator = params_->step_allocator;
+  } else if (params_->device_allocator != nullptr && !attr.on_host()) {
+    allocator = params_->device_allocator;
   } else {
     allocator = params_->device->GetAllocator(attr);
   }
@@ -585,6 +590,7 @@ std::unique_ptr<Tensor> OpKernelContext::forward_input(
 
   auto output_tensor = std::make_unique<Tensor>();
   CHECK(output_tensor->CopyFrom(*input.tensor, output_shape));
+  forwarded_input_bytes_ += output_tensor->TotalBytes();
   return output_tensor;
 }
 
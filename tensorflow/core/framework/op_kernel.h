@@ -634,6 +634,15 @@ class OpKernelContext {
     // stored in this container..
     ScopedStepContainer* step_container = nullptr;
 
+    // If not null, serves the default host allocations of this op kernel
+    // invocation. Set by the executor only for kernels whose outputs are not
+    // expected to outlive the step.
+    Allocator* step_allocator = nullptr;
+
+    // If not null, serves the device memory allocations of this op kernel
+    // invocation in place of the device's allocator.
+    Allocator* device_allocator = nullptr;
+
     // Mechanism used by this op kernel invocation to communicate with
     // computations running on other devices.
     RendezvousInterface* rendezvous = nullptr;
@@ -901,6 +910,10 @@ class OpKernelContext {
       const TensorShape& output_shape, MemoryType output_memory_type,
       const AllocatorAttributes& output_attr) TF_MUST_USE_RESULT;
 
+  // Returns the total size of the input buffers that forward_input() has
+  // reused, instead of allocating and writing new buffers.
+  int64_t forwarded_input_bytes() const { return forwarded_input_bytes_; }
+
   // Tries to forward one of the inputs given in input_indices to
   // output[output_index]. If none of the given inputs can be forwarded, calls
   // allocate_output() to allocate a new output buffer. The index of the
@@ -1304,6 +1317,7 @@ class OpKernelContext {
   void maybe_initialize_scope_id_set();
 
   absl::Status status_;
+  int64_t forwarded_input_bytes_ = 0;
   friend class CollectiveExecutor;  // for access to params_
   Params* params_;                  // not owned
   absl::InlinedVector<TensorValue, 4UL> outputs_;
@@ -533,6 +533,37 @@ TEST_F(OpKernelTest, AllocateOutput) {
   EXPECT_THAT(s.message(), ::testing::ContainsRegex("bad index=1"));
 }
 
+TEST_F(OpKernelTest, ForwardedInputBytes) {
+  Env* env = Env::Default();
+  OpKernelContext::Params params;
+  DummyDevice device(env);
+  params.device = &device;
+  Status status;
+  std::unique_ptr<OpKernel> op(CreateOpKernel(
+      DEVICE_CPU, params.device, cpu_allocator(), CreateNodeDef("Test4", {}),
+      TF_GRAPH_DEF_VERSION, &status));
+  EXPECT_TRUE(status.ok());
+  params.op_kernel = op.get();
+  Tensor a(DT_FLOAT, TensorShape({4}));
+  absl::InlinedVector<TensorValue, 4> inputs{TensorValue(&a)};
+  params.inputs = inputs;
+  auto ctx = std::make_unique<OpKernelContext>(&params);
+  EXPECT_EQ(0, ctx->forwarded_input_bytes());
+
+  std::unique_ptr<Tensor> forwarded =
+      ctx->forward_input(0, 0, DT_FLOAT, TensorShape({2, 2}),
+                         ctx->input_memory_type(0), AllocatorAttributes());
+  ASSERT_NE(nullptr, forwarded);
+  EXPECT_EQ(4 * sizeof(float), ctx->forwarded_input_bytes());
+
+  // The input buffer is now shared with `forwarded`, so it cannot be
+  // forwarded again.
+  EXPECT_EQ(nullptr, ctx->forward_input(0, 0, DT_FLOAT, TensorShape({4}),
+                                        ctx->input_memory_type(0),
+                                        AllocatorAttributes()));
+  EXPECT_EQ(4 * sizeof(float), ctx->forwarded_input_bytes());
+}
+
 // A mock device that mimics the behavior of scoped allocator upon calling
 // GetAllocator with a positive scope_id.
 class ScopedAllocatorDevice : public DeviceBase {
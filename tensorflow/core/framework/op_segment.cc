@@ -15,10 +15,16 @@ limitations under the License.
 
 #include "tensorflow/core/framework/op_segment.h"
 
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/types.h"
@@ -108,4 +114,97 @@ bool OpSegment::ShouldOwnKernel(FunctionLibraryRuntime* lib,
          node_op != "PartitionedCall" && node_op != "StatefulPartitionedCall";
 }
 
+namespace {
+
+bool RefersToFunction(const AttrValue& attr) {
+  return attr.has_func() || (attr.has_list() && attr.list().func_size() > 0);
+}
+
+}  // namespace
+
+SharedKernelCache::SharedKernelCache() {}
+
+SharedKernelCache::~SharedKernelCache() {
+  for (const auto& kv : kernels_) delete kv.second.kernel;
+}
+
+SharedKernelCache* SharedKernelCache::Global() {
+  static SharedKernelCache* cache = new SharedKernelCache;
+  return cache;
+}
+
+bool SharedKernelCache::ShouldShareKernel(FunctionLibraryRuntime* lib,
+                                          const NodeDef& node_def) {
+  const string& node_op = node_def.op();
+  if (lib->IsStateful(node_op) ||
+      lib->GetFunctionLibraryDefinition()->Find(node_op) != nullptr ||
+      node_op == "PartitionedCall" || node_op == "StatefulPartitionedCall") {
+    return false;
+  }
+  for (const auto& attr : node_def.attr()) {
+    if (RefersToFunction(attr.second)) return false;
+  }
+  return true;
+}
+
+Status SharedKernelCache::FindOrCreate(const DeviceBase* device,
+                                       int graph_def_version,
+                                       const NodeDef& node_def,
+                                       OpKernel** kernel,
+                                       OpSegment::CreateKernelFn create_fn) {
+  string serialized;
+  if (!SerializeToStringDeterministic(node_def, &serialized)) {
+    return errors::Internal("Failed to serialize node ", node_def.name());
+  }
+  const Fprint128 fingerprint = Fingerprint128(serialized);
+  const string key = absl::StrCat(device->device_type(), "|", device->name(),
+                                  "|", graph_def_version, "|",
+                                  fingerprint.low64, ":", fingerprint.high64);
+  {
+    mutex_lock l(mu_);
+    auto it = kernels_.find(key);
+    if (it != kernels_.end()) {
+      ++it->second.refs;
+      *kernel = it->second.kernel;
+      return absl::OkStatus();
+    }
+  }
+  TF_RETURN_IF_ERROR(create_fn(kernel));
+  OpKernel* duplicate = nullptr;
+  {
+    mutex_lock l(mu_);
+    Entry& entry = kernels_[key];
+    if (entry.kernel == nullptr) {
+      entry.kernel = *kernel;  // Inserts 'kernel' in the cache.
+      keys_[*kernel] = key;
+    } else {
+      duplicate = *kernel;
+      *kernel = entry.kernel;
+    }
+    ++entry.refs;
+  }
+  delete duplicate;
+  return absl::OkStatus();
+}
+
+bool SharedKernelCache::Release(OpKernel* kernel) {
+  OpKernel* unused = nullptr;
+  {
+    mutex_lock l(mu_);
+    auto key_it = keys_.find(kernel);
+    if (key_it == keys_.end()) return false;
+    auto it = kernels_.find(key_it->second);
+    DCHECK(it != kernels_.end());
+    if (--it->second.refs == 0) {
+      unused = it->second.kernel;
+      kernels_.erase(it);
+      keys_.erase(key_it);
+    }
+  }
+  // Deletes the kernel outside of the lock, in case its destructor releases
+  // other kernels.
+  delete unused;
+  return true;
+}
+
 }  // end namespace tensorflow
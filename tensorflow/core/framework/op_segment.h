@@ -19,6 +19,8 @@ limitations under the License.
 #include <string>
 #include <unordered_map>
 
+#include "absl/container/flat_hash_map.h"
+#include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/platform/macros.h"
@@ -85,6 +87,55 @@ class OpSegment {
   void operator=(const OpSegment&) = delete;
 };
 
+// SharedKernelCache shares the kernels of stateless nodes between sessions
+// and function instantiations that place identical nodes on identically named
+// devices, e.g. when the same graph is loaded several times in a process.
+//
+// Kernels are keyed by the device name and type, the graph def version and a
+// fingerprint of the NodeDef. Each successful FindOrCreate takes a reference
+// on the returned kernel, which is deleted when its last reference is
+// released.
+class SharedKernelCache {
+ public:
+  SharedKernelCache();
+  ~SharedKernelCache();
+
+  // Returns the process-wide cache.
+  static SharedKernelCache* Global();
+
+  // Returns true if the kernel for "node_def" may be shared, i.e. it is a
+  // stateless primitive op that does not refer to any function: such
+  // kernels depend only on their NodeDef and device.
+  static bool ShouldShareKernel(FunctionLibraryRuntime* lib,
+                                const NodeDef& node_def);
+
+  // If a kernel for "node_def" on "device" has been cached, returns it in
+  // "*kernel". Otherwise, creates it by calling create_fn(), caches it and
+  // returns it in "*kernel". The caller must pass "*kernel" to Release()
+  // when done with it.
+  absl::Status FindOrCreate(const DeviceBase* device, int graph_def_version,
+                            const NodeDef& node_def, OpKernel** kernel,
+                            OpSegment::CreateKernelFn create_fn);
+
+  // If "kernel" was returned by FindOrCreate(), releases one reference on it
+  // and returns true. Otherwise returns false, and the caller still owns
+  // "kernel".
+  bool Release(OpKernel* kernel);
+
+ private:
+  struct Entry {
+    OpKernel* kernel = nullptr;
+    int refs = 0;
+  };
+
+  mutex mu_;
+  absl::flat_hash_map<string, Entry> kernels_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<const OpKernel*, string> keys_ TF_GUARDED_BY(mu_);
+
+  SharedKernelCache(const SharedKernelCache&) = delete;
+  void operator=(const SharedKernelCache&) = delete;
+};
+
 }  // end namespace tensorflow
 
 #endif  // TENSORFLOW_CORE_FRAMEWORK_OP_SEGMENT_H_
@@ -156,4 +156,87 @@ TEST_F(OpSegmentTest, AddRemoveHolds) {
   opseg.RemoveHold("foo");
 }
 
+class NamedDevice : public DeviceBase {
+ public:
+  explicit NamedDevice(const string& name)
+      : DeviceBase(Env::Default()), name_(name) {}
+
+  const string& name() const override { return name_; }
+  const std::string& device_type() const override { return type_; }
+
+ private:
+  const string name_;
+  const string type_ = DEVICE_CPU;
+};
+
+TEST_F(OpSegmentTest, SharedKernelCache) {
+  SharedKernelCache cache;
+  NamedDevice device0("/device:CPU:0");
+  NamedDevice device1("/device:CPU:1");
+  int num_created = 0;
+  auto create_fn = [this, &num_created](const NodeDef* ndef) {
+    return [this, ndef, &num_created](OpKernel** kernel) {
+      ++num_created;
+      return GetFn(ndef)(kernel);
+    };
+  };
+  const NodeDef& ndef = float_nodedefs_[0];
+
+  OpKernel* op0;
+  TF_EXPECT_OK(cache.FindOrCreate(&device0, TF_GRAPH_DEF_VERSION, ndef, &op0,
+                                  create_fn(&ndef)));
+  ValidateOpAndTypes(op0, ndef, DT_FLOAT);
+  OpKernel* op1;
+  TF_EXPECT_OK(cache.FindOrCreate(&device0, TF_GRAPH_DEF_VERSION, ndef, &op1,
+                                  create_fn(&ndef)));
+  EXPECT_EQ(op0, op1);
+  EXPECT_EQ(1, num_created);
+
+  // Nodes that differ, or are placed on another device, are not shared.
+  OpKernel* int32_op;
+  TF_EXPECT_OK(cache.FindOrCreate(&device0, TF_GRAPH_DEF_VERSION,
+                                  int32_nodedefs_[0], &int32_op,
+                                  create_fn(&int32_nodedefs_[0])));
+  ValidateOpAndTypes(int32_op, int32_nodedefs_[0], DT_INT32);
+  OpKernel* other_device_op;
+  TF_EXPECT_OK(cache.FindOrCreate(&device1, TF_GRAPH_DEF_VERSION, ndef,
+                                  &other_device_op, create_fn(&ndef)));
+  EXPECT_NE(op0, other_device_op);
+  EXPECT_EQ(3, num_created);
+
+  EXPECT_TRUE(cache.Release(op0));
+  EXPECT_TRUE(cache.Release(int32_op));
+  EXPECT_TRUE(cache.Release(other_device_op));
+  // op1 still holds the kernel.
+  TF_EXPECT_OK(cache.FindOrCreate(&device0, TF_GRAPH_DEF_VERSION, ndef, &op0,
+                                  create_fn(&ndef)));
+  EXPECT_EQ(op0, op1);
+  EXPECT_EQ(3, num_created);
+  EXPECT_TRUE(cache.Release(op0));
+  EXPECT_TRUE(cache.Release(op1));
+
+  // Kernels that did not come from the cache are left to the caller.
+  OpKernel* uncached = nullptr;
+  TF_EXPECT_OK(GetFn(&ndef)(&uncached));
+  EXPECT_FALSE(cache.Release(uncached));
+  delete uncached;
+
+  // The last release deleted the kernel, so it is created again.
+  TF_EXPECT_OK(cache.FindOrCreate(&device0, TF_GRAPH_DEF_VERSION, ndef, &op0,
+                                  create_fn(&ndef)));
+  EXPECT_EQ(4, num_created);
+  EXPECT_TRUE(cache.Release(op0));
+}
+
+TEST_F(OpSegmentTest, SharedKernelCacheCreateFailure) {
+  SharedKernelCache cache;
+  NamedDevice device("/device:CPU:0");
+  NodeDef def = float_nodedefs_[0];
+  def.set_op("nonexistop");
+  OpKernel* op = nullptr;
+  absl::Status s = cache.FindOrCreate(&device, TF_GRAPH_DEF_VERSION, def, &op,
+                                      GetFn(&def));
+  EXPECT_TRUE(errors::IsNotFound(s)) << s;
+}
+
 }  // namespace tensorflow
@@ -46,6 +46,44 @@ std::string DtypeAndShapesToString(
 }
 }  // namespace
 
+ResourceBase* ResourceLookupCache::Lookup(const void* owner, uint64 generation,
+                                          uint64 type_hash_code) {
+  Entry* entry = entry_.exchange(nullptr, std::memory_order_acquire);
+  if (entry == nullptr) {
+    return nullptr;
+  }
+  if (entry->owner != owner || entry->generation != generation ||
+      entry->type_hash_code != type_hash_code) {
+    delete entry;
+    return nullptr;
+  }
+  ResourceBase* resource = entry->resource.get();
+  resource->Ref();
+  Release(entry);
+  return resource;
+}
+
+void ResourceLookupCache::Insert(const void* owner, uint64 generation,
+                                 uint64 type_hash_code,
+                                 ResourceBase* resource) {
+  resource->Ref();
+  Release(new Entry{owner, generation, type_hash_code,
+                    core::RefCountPtr<ResourceBase>(resource)});
+}
+
+void ResourceLookupCache::Clear() {
+  delete entry_.exchange(nullptr, std::memory_order_acquire);
+}
+
+void ResourceLookupCache::Release(Entry* entry) {
+  Entry* expected = nullptr;
+  if (!entry_.compare_exchange_strong(expected, entry,
+                                      std::memory_order_release,
+                                      std::memory_order_relaxed)) {
+    delete entry;
+  }
+}
+
 // Must be declared here for pre-C++17 compatibility.
 /* static */ constexpr const char* ResourceHandle::ANONYMOUS_NAME;
 
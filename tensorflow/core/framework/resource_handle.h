@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_RESOURCE_HANDLE_H_
 #define TENSORFLOW_CORE_FRAMEWORK_RESOURCE_HANDLE_H_
 
+#include <atomic>
 #include <optional>
 #include <string>
 
@@ -34,6 +35,53 @@ namespace tensorflow {
 
 class ResourceHandleProto;
 
+// Caches the resource that a weak-ref ResourceHandle last resolved to in a
+// ResourceMgr, so that repeated lookups through the same handle skip the
+// manager's lock and hash map. The cached entry holds a reference on the
+// resource and is only returned while the manager's generation, which changes
+// whenever a resource is removed from it, is the one it was cached at.
+//
+// Copies start out empty. Thread-safe: a lookup takes the entry out of the
+// cache while it uses it, so concurrent lookups through one handle fall back
+// to the manager instead of waiting for each other.
+class ResourceLookupCache {
+ public:
+  ResourceLookupCache() = default;
+  ResourceLookupCache(const ResourceLookupCache&) {}
+  ResourceLookupCache& operator=(const ResourceLookupCache&) {
+    Clear();
+    return *this;
+  }
+  ~ResourceLookupCache() { Clear(); }
+
+  // Returns a new reference to the resource cached from `owner` at
+  // `generation` with type `type_hash_code`, or nullptr on a miss.
+  ResourceBase* Lookup(const void* owner, uint64 generation,
+                       uint64 type_hash_code);
+
+  // Caches `resource` as found in `owner` at `generation`. Takes a new
+  // reference on `resource`.
+  void Insert(const void* owner, uint64 generation, uint64 type_hash_code,
+              ResourceBase* resource);
+
+  // Drops the cached entry, if any.
+  void Clear();
+
+ private:
+  struct Entry {
+    const void* owner;
+    uint64 generation;
+    uint64 type_hash_code;
+    core::RefCountPtr<ResourceBase> resource;
+  };
+
+  // Puts `entry` back into the cache, or deletes it if the cache was filled
+  // in the meantime.
+  void Release(Entry* entry);
+
+  std::atomic<Entry*> entry_{nullptr};
+};
+
 // Class representing a handle to a tensorflow resource. Handles are
 // not valid across executions, but can be serialized back and forth from within
 // a single run (except for those created from MakeRefCountingHandle i.e. whose
@@ -59,16 +107,25 @@ class ResourceHandle {
 
   // Container in which this resource is placed.
   const std::string& container() const { return container_; }
-  void set_container(const std::string& container) { container_ = container; }
+  void set_container(const std::string& container) {
+    container_ = container;
+    lookup_cache_.Clear();
+  }
 
   // Unique name of this resource.
   const std::string& name() const { return name_; }
-  void set_name(const std::string& name) { name_ = name; }
+  void set_name(const std::string& name) {
+    name_ = name;
+    lookup_cache_.Clear();
+  }
 
   // Hash code for the type of the resource. Is only valid in the same device
   // and in the same execution.
   uint64 hash_code() const { return hash_code_; }
-  void set_hash_code(uint64 hash_code) { hash_code_ = hash_code; }
+  void set_hash_code(uint64 hash_code) {
+    hash_code_ = hash_code;
+    lookup_cache_.Clear();
+  }
 
   // For debug-only, the name of the type pointed to by this handle, if
   // available.
@@ -95,6 +152,10 @@ class ResourceHandle {
     return definition_stack_trace_;
   }
 
+  // Cache of the resource this weak-ref handle resolved to. Used by
+  // ResourceMgr::LookupCached.
+  ResourceLookupCache& lookup_cache() const { return lookup_cache_; }
+
   // Conversion to and from ResourceHandleProto
   void AsProto(ResourceHandleProto* proto) const;
   absl::Status FromProto(const ResourceHandleProto& proto);
@@ -187,6 +248,7 @@ class ResourceHandle {
   // a "weak-ref" mode, only containing the name of the resource (conceptually a
   // weak reference).
   core::IntrusivePtr<ResourceBase> resource_;
+  mutable ResourceLookupCache lookup_cache_;
   static std::atomic<int64_t> current_id_;
 };
 
@@ -130,10 +130,20 @@ ResourceMgr::ResourceAndName& ResourceMgr::ResourceAndName::operator=(
   return *this;
 }
 
-ResourceMgr::ResourceMgr() : default_container_("localhost") {}
+namespace {
+
+uint64 NextResourceMgrGeneration() {
+  static std::atomic<uint64> next_generation{0};
+  return next_generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace
+
+ResourceMgr::ResourceMgr() : ResourceMgr("localhost") {}
 
 ResourceMgr::ResourceMgr(const string& default_container)
-    : default_container_(default_container) {}
+    : default_container_(default_container),
+      generation_(NextResourceMgrGeneration()) {}
 
 ResourceMgr::~ResourceMgr() { Clear(); }
 
@@ -145,6 +155,7 @@ void ResourceMgr::Clear() {
     mutex_lock l(mu_);
     tmp_containers = std::move(containers_);
     containers_.clear();  // reinitialize after move.
+    BumpGeneration();
   }
   for (const auto& p : tmp_containers) {
     delete p.second;
@@ -241,7 +252,7 @@ Status ResourceMgr::DoLookup(const string& container, TypeIndex type,
 Status ResourceMgr::DoLookup(const string& container, uint64 type_hash_code,
                              const string& type_name,
                              const string& resource_name,
-                             ResourceBase** resource) const {
+                             ResourceBase** resource, bool* owned) const {
   const Container* b = gtl::FindPtrOrNull(containers_, container);
   if (b == nullptr) {
     return errors::NotFound("Container ", container,
@@ -259,9 +270,17 @@ Status ResourceMgr::DoLookup(const string& container, uint64 type_hash_code,
                             type_name, " has been destroyed.");
   }
   *resource = ptr;
+  if (owned != nullptr) {
+    *owned = std::holds_alternative<core::RefCountPtr<ResourceBase>>(
+        iter->second.resource);
+  }
   return absl::OkStatus();
 }
 
+void ResourceMgr::BumpGeneration() {
+  generation_.store(NextResourceMgrGeneration(), std::memory_order_release);
+}
+
 Status ResourceMgr::PopResourceAndName(const string& container,
                                        uint64 type_hash_code,
                                        const string& resource_name,
@@ -279,6 +298,7 @@ Status ResourceMgr::PopResourceAndName(const string& container,
   }
   std::swap(resource_and_name, iter->second);
   b->erase(iter);
+  BumpGeneration();
   return absl::OkStatus();
 }
 
@@ -306,6 +326,9 @@ Status ResourceMgr::DoDelete(const string& container, TypeIndex type,
 }
 
 Status ResourceMgr::Delete(const ResourceHandle& handle) {
+  // Drops the handle's reference before the manager's, so that deleting the
+  // resource through the handle that looked it up destroys it right away.
+  handle.lookup_cache().Clear();
   return DoDelete(handle.container(), handle.hash_code(), handle.name(),
                   "<unknown>");
 }
@@ -328,6 +351,7 @@ Status ResourceMgr::Cleanup(const string& container) {
     }
     b = iter->second;
     containers_.erase(iter);
+    BumpGeneration();
   }
   CHECK(b != nullptr);
   delete b;
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_RESOURCE_MGR_H_
 #define TENSORFLOW_CORE_FRAMEWORK_RESOURCE_MGR_H_
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <typeindex>
@@ -195,6 +196,18 @@ class ResourceMgr {
   Status Lookup(const ResourceHandle& handle,
                 ResourceBase** resource) const TF_MUST_USE_RESULT;
 
+  // Like Lookup(handle.container(), handle.name(), resource), but first
+  // consults the lookup cache of the weak-ref "handle", and fills it on a
+  // miss. Hits take no lock. The cache keeps a reference on the resource
+  // until the handle is destroyed or used again after the resource has been
+  // removed from *this.
+  //
+  // REQUIRES: std::is_base_of<ResourceBase, T>
+  // REQUIRES: resource != nullptr
+  template <typename T, bool use_dynamic_cast = false>
+  Status LookupCached(const ResourceHandle& handle,
+                      T** resource) const TF_MUST_USE_RESULT;
+
   // Similar to Lookup, but looks up multiple resources at once, with only a
   // single lock acquisition.  If containers_and_names[i] is uninitialized
   // then this function does not modify resources[i].
@@ -276,6 +289,10 @@ class ResourceMgr {
   const std::string default_container_;
   mutable mutex mu_;
   absl::flat_hash_map<string, Container*> containers_ TF_GUARDED_BY(mu_);
+  // Changes, under an exclusive lock on mu_, whenever a resource is removed.
+  // Values are unique across all managers, so a handle's lookup cache can't
+  // confuse two managers that were allocated at the same address.
+  std::atomic<uint64> generation_;
 
   template <typename T, bool use_dynamic_cast = false>
   Status LookupInternal(const std::string& container, const std::string& name,
@@ -293,12 +310,17 @@ class ResourceMgr {
   Status DoLookup(const std::string& container, TypeIndex type,
                   const std::string& name, ResourceBase** resource) const
       TF_SHARED_LOCKS_REQUIRED(mu_) TF_MUST_USE_RESULT;
+  // If "owned" is not null, sets it to whether *this holds a strong reference
+  // on the resource found.
   Status DoLookup(const std::string& container, uint64 type_hash_code,
                   const std::string& type_name,
-                  const std::string& resource_name,
-                  ResourceBase** resource) const
+                  const std::string& resource_name, ResourceBase** resource,
+                  bool* owned = nullptr) const
       TF_SHARED_LOCKS_REQUIRED(mu_) TF_MUST_USE_RESULT;
 
+  // Moves generation_ to a new value.
+  void BumpGeneration() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   Status DoDelete(const std::string& container, uint64 type_hash_code,
                   const std::string& resource_name,
                   const std::string& type_name) TF_MUST_USE_RESULT;
@@ -708,6 +730,33 @@ Status ResourceMgr::LookupInternal(const std::string& container,
   return s;
 }
 
+template <typename T, bool use_dynamic_cast>
+Status ResourceMgr::LookupCached(const ResourceHandle& handle,
+                                 T** resource) const {
+  CheckDeriveFromResourceBase<T>();
+  const TypeIndex type = TypeIndex::Make<T>();
+  ResourceBase* found = handle.lookup_cache().Lookup(
+      this, generation_.load(std::memory_order_acquire), type.hash_code());
+  if (found == nullptr) {
+    bool owned = false;
+    uint64 generation;
+    {
+      tf_shared_lock l(mu_);
+      TF_RETURN_IF_ERROR(DoLookup(handle.container(), type.hash_code(),
+                                  type.name(), handle.name(), &found, &owned));
+      generation = generation_.load(std::memory_order_relaxed);
+    }
+    // Unowned resources may be destroyed without going through *this, so
+    // only owned ones are cached. Filling the cache outside of the lock lets
+    // it drop an old entry, and maybe the last reference on its resource.
+    if (owned) {
+      handle.lookup_cache().Insert(this, generation, type.hash_code(), found);
+    }
+  }
+  *resource = TypeCastFunctor<T, use_dynamic_cast>::Cast(found);
+  return absl::OkStatus();
+}
+
 template <typename T, bool use_dynamic_cast>
 Status ResourceMgr::LookupOrCreate(const std::string& container,
                                    const std::string& name, T** resource,
@@ -807,8 +856,7 @@ Status LookupResource(OpKernelContext* ctx, const ResourceHandle& p,
     return absl::OkStatus();
   }
 
-  return ctx->resource_manager()->Lookup<T, use_dynamic_cast>(p.container(),
-                                                              p.name(), value);
+  return ctx->resource_manager()->LookupCached<T, use_dynamic_cast>(p, value);
 }
 
 // Finds the resource as "*value" from the handle. This is a type-erased
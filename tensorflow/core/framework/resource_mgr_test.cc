@@ -268,6 +268,83 @@ Status ComputePolicy(const string& attr_container,
   return absl::OkStatus();
 }
 
+ResourceHandle MakeHandle(const string& container, const string& name) {
+  ResourceHandle handle;
+  handle.set_container(container);
+  handle.set_name(name);
+  handle.set_hash_code(TypeIndex::Make<Resource>().hash_code());
+  return handle;
+}
+
+TEST(ResourceMgrTest, LookupCached) {
+  ResourceMgr rm;
+  Resource* cat = new Resource("cat");
+  TF_CHECK_OK(rm.Create("foo", "bar", cat));
+  const ResourceHandle handle = MakeHandle("foo", "bar");
+
+  for (int i = 0; i < 2; ++i) {
+    Resource* r = nullptr;
+    TF_ASSERT_OK(rm.LookupCached(handle, &r));
+    EXPECT_EQ(r, cat);
+    r->Unref();
+  }
+  // Copies of a handle do not share its cache.
+  const ResourceHandle copy = handle;
+  {
+    Resource* r = nullptr;
+    TF_ASSERT_OK(rm.LookupCached(copy, &r));
+    EXPECT_EQ(r, cat);
+    r->Unref();
+  }
+
+  // Removing any resource invalidates the cached entries.
+  TF_CHECK_OK(rm.Delete<Resource>("foo", "bar"));
+  Resource* unused = nullptr;
+  HasError(rm.LookupCached(handle, &unused), error::NOT_FOUND,
+           "Resource foo/bar");
+  Resource* kitty = new Resource("kitty");
+  TF_CHECK_OK(rm.Create("foo", "bar", kitty));
+  {
+    Resource* r = nullptr;
+    TF_ASSERT_OK(rm.LookupCached(copy, &r));
+    EXPECT_EQ(r, kitty);
+    r->Unref();
+  }
+  TF_CHECK_OK(rm.Cleanup("foo"));
+  HasError(rm.LookupCached(copy, &unused), error::NOT_FOUND, "Container foo");
+}
+
+TEST(ResourceMgrTest, LookupCachedDoesNotKeepUnownedResources) {
+  ResourceMgr rm;
+  const ResourceHandle handle = MakeHandle("foo", "bar");
+  {
+    core::RefCountPtr<Resource> cat{new Resource("cat")};
+    TF_CHECK_OK(rm.CreateUnowned("foo", "bar", cat.get()));
+    Resource* r = nullptr;
+    TF_ASSERT_OK(rm.LookupCached(handle, &r));
+    EXPECT_EQ(r, cat.get());
+    r->Unref();
+    EXPECT_TRUE(cat->RefCountIsOne());
+  }
+  Resource* unused = nullptr;
+  HasError(rm.LookupCached(handle, &unused), error::NOT_FOUND,
+           "Resource foo/bar");
+}
+
+TEST(ResourceMgrTest, DeleteThroughHandleDropsCachedReference) {
+  ResourceMgr rm;
+  core::RefCountPtr<Resource> cat{new Resource("cat")};
+  cat->Ref();
+  TF_CHECK_OK(rm.Create("foo", "bar", cat.get()));
+  const ResourceHandle handle = MakeHandle("foo", "bar");
+  Resource* r = nullptr;
+  TF_ASSERT_OK(rm.LookupCached(handle, &r));
+  r->Unref();
+  EXPECT_FALSE(cat->RefCountIsOne());
+  TF_CHECK_OK(rm.Delete(handle));
+  EXPECT_TRUE(cat->RefCountIsOne());
+}
+
 string Policy(const string& attr_container, const string& attr_shared_name,
               bool use_node_name_as_default) {
   string ret;
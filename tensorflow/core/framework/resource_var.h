@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_RESOURCE_VAR_H_
 #define TENSORFLOW_CORE_FRAMEWORK_RESOURCE_VAR_H_
 
+#include <atomic>
+#include <cstdint>
 #include <string>
 
 #include "tensorflow/core/framework/resource_base.h"
@@ -110,8 +112,17 @@ class Var : public ResourceBase {
   // so desired.
   std::atomic<bool> copy_on_read_mode{false};
 
+  // Counts the writes to the variable's value, so that checkpointing can tell
+  // which variables changed since they were last saved.  The assign, scatter
+  // and training kernels call MarkModified() after writing, while still
+  // holding mu(); a saver must read version() before copying the value out.
+  // Kernels that write through tensor() by other means must call it too.
+  int64_t version() const { return version_.load(std::memory_order_acquire); }
+  void MarkModified() { version_.fetch_add(1, std::memory_order_acq_rel); }
+
  private:
   mutex mu_;
+  std::atomic<int64_t> version_{0};
   Tensor tensor_;
   std::string debug_name_;
 
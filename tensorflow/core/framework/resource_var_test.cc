@@ -34,5 +34,13 @@ TEST(ResourceVarTest, Uninitialize) {
   EXPECT_FALSE(var->is_initialized);
   EXPECT_TRUE(var->tensor()->data() == nullptr);
 }
+
+TEST(ResourceVarTest, MarkModified) {
+  RefCountPtr<Var> var{new Var(DT_INT32)};
+  EXPECT_EQ(var->version(), 0);
+  var->MarkModified();
+  var->MarkModified();
+  EXPECT_EQ(var->version(), 2);
+}
 }  // namespace core
 }  // namespace tensorflow
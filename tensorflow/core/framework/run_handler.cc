@@ -736,18 +736,27 @@ class RunHandler::Impl {
   // Stores now time (in microseconds) since unix epoch when the handler is
   // requested via RunHandlerPool::Get().
   uint64 start_time_us() const { return start_time_us_; }
+  // Returns the time (in microseconds since unix epoch) by which the request
+  // is expected to complete, or 0 if the request has no deadline.
+  uint64 deadline_us() const { return deadline_us_; }
   int64_t step_id() const { return step_id_; }
   void ScheduleInterOpClosure(std::function<void()> fn);
   void ScheduleIntraOpClosure(std::function<void()> fn);
 
-  void Reset(int64_t step_id,
+  void Reset(int64_t step_id, int64_t timeout_in_ms,
              const RunOptions::Experimental::RunHandlerPoolOptions& options);
 
+  // Returns true if the work of this request should be scheduled ahead of the
+  // work of `other`: requests are ordered by decreasing priority, then, for
+  // requests that opted into deadline scheduling, by earliest deadline, and
+  // otherwise by the order of the Get() calls.
+  bool RunsBefore(const Impl& other) const;
+
   RunHandlerPool::Impl* pool_impl() { return pool_impl_; }
 
   internal::ThreadWorkSource* tws() { return &tws_; }
 
-  int64_t priority() { return options_.priority(); }
+  int64_t priority() const { return options_.priority(); }
 
  private:
   class ThreadPoolInterfaceWrapper : public thread::ThreadPoolInterface {
@@ -765,6 +774,7 @@ class RunHandler::Impl {
 
   RunHandlerPool::Impl* pool_impl_;  // NOT OWNED.
   uint64 start_time_us_;
+  uint64 deadline_us_;
   int64_t step_id_;
   std::unique_ptr<thread::ThreadPoolInterface> thread_pool_interface_;
   internal::ThreadWorkSource tws_;
@@ -845,8 +855,15 @@ class RunHandlerPool::Impl {
     uint64 version;
     int num_active_requests;
     RunHandler::Impl* handler_impl;
+    const bool schedule_by_deadline =
+        options.schedule_by_deadline() && timeout_in_ms > 0;
+    const uint64 deadline_us =
+        timeout_in_ms > 0 ? EnvTime::NowMicros() + timeout_in_ms * 1000 : 0;
     {
       mutex_lock l(mu_);
+      if (schedule_by_deadline && !CanMeetDeadline(deadline_us)) {
+        return nullptr;
+      }
       if (!has_free_handler()) {
         tsl::profiler::TraceMe activity(
             [&] {
@@ -865,21 +882,25 @@ class RunHandlerPool::Impl {
                        EnvTime::NowNanos() + timeout_in_ms * 1000 * 1000)) {
           return nullptr;
         }
+        // Shed the request if the wait for a handler used up the time it
+        // needs to complete.
+        if (schedule_by_deadline && !CanMeetDeadline(deadline_us)) {
+          return nullptr;
+        }
       }
-      // Remove the last entry from free_handlers_ and add to the end of
+      // Remove the last entry from free_handlers_ and insert it into
       // sorted_active_handlers_.
       handler_impl = free_handlers_.back();
-      handler_impl->Reset(step_id, options);
+      handler_impl->Reset(step_id, timeout_in_ms, options);
       free_handlers_.pop_back();
 
       num_active_requests = sorted_active_handlers_.size() + 1;
       thread_work_sources->resize(num_active_requests);
-      int priority = options.priority();
       auto it = sorted_active_handlers_.cbegin();
       bool new_handler_inserted = false;
       for (int i = 0; i < num_active_requests; ++i) {
         if (!new_handler_inserted && (it == sorted_active_handlers_.cend() ||
-                                      priority > (*it)->priority())) {
+                                      handler_impl->RunsBefore(**it))) {
           sorted_active_handlers_.insert(it, handler_impl);
           new_handler_inserted = true;
           // Point to the newly added handler.
@@ -904,6 +925,7 @@ class RunHandlerPool::Impl {
     uint64 now = tensorflow::EnvTime::NowMicros();
     double elapsed = (now - handler->start_time_us()) / 1000.0;
     time_hist_.Add(elapsed);
+    ++num_released_handlers_;
 
     // Erase from and update sorted_active_handlers_. Add it to the end of
     // free_handlers_.
@@ -935,6 +957,16 @@ class RunHandlerPool::Impl {
     return ret;
   }
 
+  std::vector<int64_t> GetActiveHandlerStepIdsForTesting()
+      TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    std::vector<int64_t> ret;
+    for (const auto& handler_impl : sorted_active_handlers_) {
+      ret.push_back(handler_impl->step_id());
+    }
+    return ret;
+  }
+
  private:
   void RecomputePoolStats(
       int num_active_requests, uint64 version,
@@ -943,6 +975,14 @@ class RunHandlerPool::Impl {
 
   void LogInfo() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Returns false if a request that has to complete by `deadline_us` is
+  // unlikely to do so, based on the latency of previous requests.
+  bool CanMeetDeadline(uint64 deadline_us) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Minimum number of completed requests before the latency histogram is used
+  // to shed requests that cannot meet their deadline.
+  static constexpr int64_t kMinRequestsForLatencyEstimate = 100;
+
   // Maximum number of handlers pre-created during pool construction time. The
   // number has been chosen expecting each handler might at least want 1
   // inter-op thread for execution (during compute intensive workloads like
@@ -954,8 +994,8 @@ class RunHandlerPool::Impl {
 
   std::unique_ptr<internal::RunHandlerThreadPool> run_handler_thread_pool_;
   // Thread compatible part used only by lock under RunHandlerPool.
-  // Handlers are sorted by start time.
-  // TODO(azaks): sort by the remaining latency budget.
+  // Handlers are sorted by priority, then by deadline for requests that use
+  // deadline scheduling, then by start time.
   // TODO(chaox): Consider other data structure for maintaining the sorted
   // active handlers if the searching overhead(currently O(n)) becomes the
   // bottleneck.
@@ -965,6 +1005,7 @@ class RunHandlerPool::Impl {
 
   // Histogram of elapsed runtime of every handler (in ms).
   histogram::Histogram time_hist_ TF_GUARDED_BY(mu_);
+  int64_t num_released_handlers_ TF_GUARDED_BY(mu_) = 0;
 
   int64_t iterations_ TF_GUARDED_BY(mu_);
   mutex mu_;
@@ -1016,6 +1057,14 @@ void RunHandlerPool::Impl::RecomputePoolStats(
   }
 }
 
+bool RunHandlerPool::Impl::CanMeetDeadline(uint64 deadline_us) {
+  if (num_released_handlers_ < kMinRequestsForLatencyEstimate) return true;
+  const uint64 now = tensorflow::EnvTime::NowMicros();
+  if (now >= deadline_us) return false;
+  const double remaining_ms = (deadline_us - now) / 1000.0;
+  return remaining_ms >= time_hist_.Median();
+}
+
 void RunHandlerPool::Impl::LogInfo() {
   if (iterations_++ % 50000 == 10 && VLOG_IS_ON(1)) {
     int num_active_requests = sorted_active_handlers_.size();
@@ -1060,7 +1109,13 @@ void RunHandler::Impl::ThreadPoolInterfaceWrapper::Schedule(
 RunHandler::Impl::Impl(RunHandlerPool::Impl* pool_impl)
     : pool_impl_(pool_impl) {
   thread_pool_interface_ = std::make_unique<ThreadPoolInterfaceWrapper>(this);
-  Reset(0, RunOptions::Experimental::RunHandlerPoolOptions());
+  Reset(0, 0, RunOptions::Experimental::RunHandlerPoolOptions());
+}
+
+bool RunHandler::Impl::RunsBefore(const Impl& other) const {
+  if (priority() != other.priority()) return priority() > other.priority();
+  if (!options_.schedule_by_deadline() || deadline_us_ == 0) return false;
+  return other.deadline_us_ == 0 || deadline_us_ < other.deadline_us_;
 }
 
 void RunHandler::Impl::ScheduleInterOpClosure(std::function<void()> fn) {
@@ -1076,9 +1131,10 @@ void RunHandler::Impl::ScheduleIntraOpClosure(std::function<void()> fn) {
 }
 
 void RunHandler::Impl::Reset(
-    int64_t step_id,
+    int64_t step_id, int64_t timeout_in_ms,
     const RunOptions::Experimental::RunHandlerPoolOptions& options) {
   start_time_us_ = tensorflow::Env::Default()->NowMicros();
+  deadline_us_ = timeout_in_ms > 0 ? start_time_us_ + timeout_in_ms * 1000 : 0;
   step_id_ = step_id;
   options_ = options;
   tws_.SetTracemeId(step_id);
@@ -1104,6 +1160,10 @@ std::vector<int64_t> RunHandlerPool::GetActiveHandlerPrioritiesForTesting()
   return impl_->GetActiveHandlerPrioritiesForTesting();
 }
 
+std::vector<int64_t> RunHandlerPool::GetActiveHandlerStepIdsForTesting() const {
+  return impl_->GetActiveHandlerStepIdsForTesting();
+}
+
 RunHandler::RunHandler(Impl* impl) : impl_(impl) {}
 
 void RunHandler::ScheduleInterOpClosure(std::function<void()> fn) {
@@ -62,7 +62,10 @@ class RunHandlerPool {
   // and is being used by a client.  It becomes 'inactive' once more when the
   // unique_ptr is destroyed.
   //
-  // Will block unless there is an inactive handler.
+  // Will block unless there is an inactive handler. Returns nullptr if no
+  // handler becomes inactive within `timeout_in_ms` (if positive), or if
+  // `options.schedule_by_deadline()` is set and the request is unlikely to
+  // complete within `timeout_in_ms`.
   std::unique_ptr<RunHandler> Get(
       int64_t step_id = 0, int64_t timeout_in_ms = 0,
       const RunOptions::Experimental::RunHandlerPoolOptions& options =
@@ -72,6 +75,10 @@ class RunHandlerPool {
   // order of the active handler list.
   std::vector<int64_t> GetActiveHandlerPrioritiesForTesting() const;
 
+  // Get the step ids for active handlers, in the same order as
+  // GetActiveHandlerPrioritiesForTesting().
+  std::vector<int64_t> GetActiveHandlerStepIdsForTesting() const;
+
  private:
   class Impl;
   friend class RunHandler;
@@ -82,7 +89,8 @@ class RunHandlerPool {
 // RunHandler can be used to schedule inter/intra-op closures to run on a global
 // pool shared across all Session::Run(s). The closures are enqueued to a
 // handler specific queue, from which the work is stolen in a priority order
-// (time of the Get() call).
+// (priority of the request, then its deadline if it uses deadline scheduling,
+// then time of the Get() call).
 //
 // It can only be created via RunHandlerPool::Get().
 //
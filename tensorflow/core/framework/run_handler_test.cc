@@ -113,6 +113,50 @@ TEST(RunHandlerUtilTest, PrioritySchedulingTest) {
   EXPECT_EQ(sorted_active_list[3], 1);
 }
 
+TEST(RunHandlerUtilTest, DeadlineSchedulingTest) {
+  int num_threads = 2;
+  std::unique_ptr<RunHandlerPool> pool(
+      new RunHandlerPool(num_threads, num_threads));
+
+  RunOptions::Experimental::RunHandlerPoolOptions options;
+  options.set_priority(1);
+  options.set_schedule_by_deadline(true);
+  auto handler1 = pool->Get(/*step_id=*/1, /*timeout_in_ms=*/0, options);
+  auto handler2 = pool->Get(/*step_id=*/2, /*timeout_in_ms=*/60000, options);
+  auto handler3 = pool->Get(/*step_id=*/3, /*timeout_in_ms=*/30000, options);
+  options.set_schedule_by_deadline(false);
+  auto handler4 = pool->Get(/*step_id=*/4, /*timeout_in_ms=*/10000, options);
+  options.set_priority(2);
+  options.set_schedule_by_deadline(true);
+  auto handler5 = pool->Get(/*step_id=*/5, /*timeout_in_ms=*/90000, options);
+
+  // Requests are ordered by priority, then by deadline for the requests that
+  // opted into deadline scheduling, and then by arrival.
+  std::vector<int64_t> sorted_step_ids =
+      pool->GetActiveHandlerStepIdsForTesting();
+  EXPECT_EQ(sorted_step_ids, std::vector<int64_t>({5, 3, 2, 1, 4}));
+}
+
+TEST(RunHandlerUtilTest, ShedsRequestsThatCannotMeetDeadline) {
+  int num_threads = 2;
+  std::unique_ptr<RunHandlerPool> pool(
+      new RunHandlerPool(num_threads, num_threads));
+  RunOptions::Experimental::RunHandlerPoolOptions options;
+  options.set_schedule_by_deadline(true);
+  // Build a latency history of ~10ms per request.
+  for (int i = 0; i < 100; ++i) {
+    auto handler = pool->Get(/*step_id=*/i, /*timeout_in_ms=*/0, options);
+    ASSERT_NE(handler, nullptr);
+    Env::Default()->SleepForMicroseconds(10 * 1000);
+  }
+  EXPECT_EQ(pool->Get(/*step_id=*/100, /*timeout_in_ms=*/1, options),
+            nullptr);
+  EXPECT_NE(pool->Get(/*step_id=*/101, /*timeout_in_ms=*/60000, options),
+            nullptr);
+  options.set_schedule_by_deadline(false);
+  EXPECT_NE(pool->Get(/*step_id=*/102, /*timeout_in_ms=*/1, options), nullptr);
+}
+
 TEST(RunHandlerThreadPool, EnqueueTask) {
   Eigen::MaxSizeVector<mutex> waiters_mu(2);
   waiters_mu.resize(2);
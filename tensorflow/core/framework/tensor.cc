@@ -63,6 +63,7 @@ limitations under the License.
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
+#include "tensorflow/core/platform/mem.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/tensor_coding.h"
 #include "tensorflow/core/platform/types.h"
@@ -159,6 +160,55 @@ class Buffer : public BufferBase {
   void operator=(const Buffer&) = delete;
 };
 
+// A ref-counted buffer of at most kMaxBytes of host memory, which shares one
+// allocation with the buffer object. This halves the number of heap
+// allocations for the many scalars and tiny vectors in a typical graph.
+class InlineHostBuffer : public TensorBuffer {
+ public:
+  static constexpr size_t kMaxBytes = 16;
+
+  // Returns a buffer of `num_bytes` <= kMaxBytes uninitialized bytes.
+  static InlineHostBuffer* New(size_t num_bytes) {
+    DCHECK_LE(num_bytes, kMaxBytes);
+    void* data = port::AlignedMalloc(kHeaderOffset + sizeof(InlineHostBuffer),
+                                     kAlignment);
+    return new (static_cast<char*>(data) + kHeaderOffset)
+        InlineHostBuffer(data, num_bytes);
+  }
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  bool GetAllocatedBytes(size_t* out_bytes) const override { return false; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("InlineHostBuffer");
+    proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+  }
+  AllocatorMemoryType GetMemoryType() const override {
+    return AllocatorMemoryType::kHostPageable;
+  }
+
+  // Frees the allocation shared with the data when `Unref()` deletes this.
+  static void operator delete(void* ptr) {
+    port::AlignedFree(static_cast<char*>(ptr) - kHeaderOffset);
+  }
+  static void operator delete(void*, void*) {}
+
+ private:
+  // The data comes first, so that it is aligned as Eigen expects.
+  static constexpr size_t kAlignment =
+      EIGEN_MAX_ALIGN_BYTES > alignof(std::max_align_t)
+          ? EIGEN_MAX_ALIGN_BYTES
+          : alignof(std::max_align_t);
+  static constexpr size_t kHeaderOffset =
+      (kMaxBytes + alignof(TensorBuffer) - 1) & ~(alignof(TensorBuffer) - 1);
+
+  InlineHostBuffer(void* data, size_t size) : TensorBuffer(data), size_(size) {}
+  ~InlineHostBuffer() override = default;
+
+  const size_t size_;
+};
+
 void LogUnexpectedSize(int64_t actual, int64_t expected) {
   LOG(ERROR) << "Input size was " << actual << " and expected " << expected;
 }
@@ -964,11 +1014,35 @@ int Tensor::RefCount() const {
   CASES_WITH_DEFAULT(TYPE_ENUM, STMTS, LOG(FATAL) << "Type not set"; \
                      , LOG(FATAL) << "Unexpected type: " << TYPE_ENUM;)
 
+static Allocator* get_default_cpu_allocator();
+
+// Returns an InlineHostBuffer for a tensor of `type` and `shape` allocated by
+// `a`, or nullptr if the tensor is too large or `a` may be observed, i.e. it is
+// not the default CPU allocator or allocations are being accounted for.
+static TensorBuffer* MaybeNewInlineBuffer(Allocator* a, DataType type,
+                                          const TensorShape& shape) {
+  if (a != get_default_cpu_allocator() || !DataTypeCanUseMemcpy(type)) {
+    return nullptr;
+  }
+  const int64_t num_elements = shape.num_elements();
+  if (num_elements <= 0 || num_elements * DataTypeSize(type) >
+                               InlineHostBuffer::kMaxBytes) {
+    return nullptr;
+  }
+  if (MemoryLoggingEnabled() || CPUAllocatorStatsEnabled() ||
+      CPUAllocatorFullStatsEnabled()) {
+    return nullptr;
+  }
+  return InlineHostBuffer::New(num_elements * DataTypeSize(type));
+}
+
 Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape)
     : shape_(shape), buf_(nullptr) {
   set_dtype(type);
   CHECK_NOTNULL(a);
-  if (shape_.num_elements() > 0 || a->AllocatesOpaqueHandle()) {
+  buf_ = MaybeNewInlineBuffer(a, type, shape);
+  if (buf_ == nullptr &&
+      (shape_.num_elements() > 0 || a->AllocatesOpaqueHandle())) {
     CASES(type, buf_ = new Buffer<T>(a, shape.num_elements()));
   }
   if (MemoryLoggingEnabled() && buf_ != nullptr && buf_->data() != nullptr) {
@@ -982,7 +1056,9 @@ Tensor::Tensor(Allocator* a, DataType type, const TensorShape& shape,
     : shape_(shape), buf_(nullptr) {
   set_dtype(type);
   CHECK_NOTNULL(a);
-  if (shape_.num_elements() > 0 || a->AllocatesOpaqueHandle()) {
+  buf_ = MaybeNewInlineBuffer(a, type, shape);
+  if (buf_ == nullptr &&
+      (shape_.num_elements() > 0 || a->AllocatesOpaqueHandle())) {
     CASES(type, buf_ = new Buffer<T>(a, shape.num_elements(), allocation_attr));
   }
   if (MemoryLoggingEnabled() && !allocation_attr.allocation_will_be_logged &&
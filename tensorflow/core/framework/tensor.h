@@ -674,6 +674,11 @@ class Tensor {
   // buffer is one.
   bool RefCountIsOne() const;
 
+  // Returns false if the buffer is a view of memory it does not own, such as a
+  // memory-mapped file. Such a tensor is never modified in place: its refcount
+  // never counts as one (see RefCountIsOne()), so writers copy it first.
+  bool OwnsMemory() const { return buf_ == nullptr || buf_->OwnsMemory(); }
+
   // Experimental. Returns the refcount on buf_ if it points to a regular
   // TensorBuffer. If buf_ points to a SubBuffer, returns -1.
   int RefCount() const;
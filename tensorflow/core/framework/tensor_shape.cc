@@ -326,13 +326,13 @@ TensorShapeBase<Shape>::TensorShapeBase() {
 
 void TensorShapeRep::DestructorOutOfLine() {
   DCHECK(tag() == REP_OUT_OF_LINE);
-  delete as64()->dims_;
+  as64()->dims_->Unref();
 }
 
 void TensorShapeRep::SlowCopyFrom(const TensorShapeRep& b) {
   if (b.tag() != REP_OUT_OF_LINE) {
     if (tag() == REP_OUT_OF_LINE) {
-      delete as64()->dims_;
+      as64()->dims_->Unref();
     }
     memcpy(buf(), b.buf(), sizeof(u_.buf));
     // memcpy above implicitly also does:
@@ -342,16 +342,28 @@ void TensorShapeRep::SlowCopyFrom(const TensorShapeRep& b) {
   } else {
     set_ndims_byte(b.ndims_byte());
     set_data_type(b.data_type());
+    // Share the dimensions of `b`. Take the reference first, in case `b` is
+    // this shape.
+    b.as64()->dims_->Ref();
     if (tag() == REP_OUT_OF_LINE) {
-      // vector already allocated
-      *(as64()->dims_) = *(b.as64()->dims_);
+      as64()->dims_->Unref();
     } else {
       set_tag(REP_OUT_OF_LINE);
-      as64()->dims_ = new absl::InlinedVector<int64_t, 4UL>(*(b.as64()->dims_));
     }
+    as64()->dims_ = b.as64()->dims_;
   }
 }
 
+absl::InlinedVector<int64_t, 4UL>* TensorShapeRep::mutable_out_of_line_dims() {
+  DCHECK(tag() == REP_OUT_OF_LINE);
+  SharedDims* dims = as64()->dims_;
+  if (!dims->RefCountIsOne()) {
+    as64()->dims_ = new SharedDims(dims->dims);
+    dims->Unref();
+  }
+  return &as64()->dims_->dims;
+}
+
 template <class Shape>
 int64_t TensorShapeBase<Shape>::dim_size(int d) const {
   if (unknown_rank()) return -1;
@@ -366,7 +378,7 @@ int64_t TensorShapeBase<Shape>::dim_size(int d) const {
     if (kIsPartial && dim == kUnknownRep32) return -1;
     return dim;
   } else {
-    return (*as64()->dims_)[d];
+    return as64()->dims_->dims[d];
   }
 }
 
@@ -377,7 +389,7 @@ void TensorShapeRep::Clear() {
 
 void TensorShapeRep::ClearAllButDataType() {
   if (tag() == REP_OUT_OF_LINE) {
-    delete as64()->dims_;
+    as64()->dims_->Unref();
   }
   set_tag(REP16);
   set_ndims_byte(0);
@@ -467,7 +479,7 @@ void TensorShapeBase<Shape>::UnsafeAddDim(int64_t size,
     as32()->dims_[nd] =
         kIsPartial && size < 0 ? kUnknownRep32 : static_cast<uint32>(size);
   } else if (tag() == REP_OUT_OF_LINE) {
-    as64()->dims_->push_back(size);
+    mutable_out_of_line_dims()->push_back(size);
   } else {
     // Need to change representation
     absl::InlinedVector<int64_t, 8UL> vals;
@@ -494,8 +506,7 @@ void TensorShapeBase<Shape>::UnsafeAddDim(int64_t size,
       }
     } else {
       set_tag(REP_OUT_OF_LINE);
-      as64()->dims_ =
-          new absl::InlinedVector<int64_t, 4UL>(vals.begin(), vals.end());
+      as64()->dims_ = new SharedDims(vals);
     }
   }
   set_ndims_byte(nd + 1);
@@ -595,7 +606,7 @@ void TensorShapeBase<Shape>::set_dim(int d, int64_t size) {
     as32()->dims_[d] =
         kIsPartial && size < 0 ? kUnknownRep32 : static_cast<uint32>(size);
   } else if (tag() == REP_OUT_OF_LINE) {
-    (*as64()->dims_)[d] = size;
+    (*mutable_out_of_line_dims())[d] = size;
   } else {
     // Must upgrade
     absl::InlinedVector<int64_t, 8UL> vals;
@@ -629,7 +640,7 @@ absl::Status TensorShapeBase<Shape>::SetDimWithStatus(int d, int64_t size) {
     as32()->dims_[d] =
         kIsPartial && size < 0 ? kUnknownRep32 : static_cast<uint32>(size);
   } else if (tag() == REP_OUT_OF_LINE) {
-    (*as64()->dims_)[d] = size;
+    (*mutable_out_of_line_dims())[d] = size;
   } else {
     // Must upgrade
     absl::InlinedVector<int64_t, 8UL> vals;
@@ -20,6 +20,7 @@ limitations under the License.
 
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/types.pb.h"
+#include "tensorflow/core/lib/core/refcount.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/lib/strings/str_util.h"
@@ -87,7 +88,8 @@ class TensorShapeRep {
   // Rep16: Supports up to 6 dimensions where each dimension is < 2^16 - 1
   // Rep32: Supports up to 3 dimensions where each dimension is < 2^32 - 1
   // Rep64: Supports arbitrary dimensionality, 64-bit dimensions using
-  //        an out of line vector.
+  //        an out of line vector, which copies of the shape share until
+  //        one of them is modified.
   // For PartialTensorShape, a dimension of static_cast<uint??>(-1) is unknown.
   // This value is not allowed in TensorShape either for format compatibility.
   struct Rep16 {
@@ -96,8 +98,13 @@ class TensorShapeRep {
   struct Rep32 {
     uint32 dims_[3];
   };
+  struct SharedDims : public core::RefCounted {
+    explicit SharedDims(absl::Span<const int64_t> d)
+        : dims(d.begin(), d.end()) {}
+    absl::InlinedVector<int64_t, 4UL> dims;
+  };
   struct Rep64 {
-    absl::InlinedVector<int64_t, 4UL>* dims_;
+    SharedDims* dims_;
   };
 
   // We use the max value of uint16 or uint32 to represent unknown shapes, so
@@ -142,6 +149,10 @@ class TensorShapeRep {
 
   void set_num_elements(int64_t n) { num_elements_ = n; }
 
+  // Returns the out of line dimensions, after copying them if they are shared
+  // with another shape. REQUIRES: tag() == REP_OUT_OF_LINE.
+  absl::InlinedVector<int64_t, 4UL>* mutable_out_of_line_dims();
+
  private:
   void DestructorOutOfLine();
   void SlowCopyFrom(const TensorShapeRep& b);
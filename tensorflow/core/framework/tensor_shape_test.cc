@@ -1005,6 +1005,25 @@ TEST(TensorShapeUtilsTest, NumElements) {
               "Can't compute total size of shape.*product would overflow")));
 }
 
+TEST(TensorShapeTest, CopiesOfLargeShapesAreIndependent) {
+  TensorShape a({1, 2, 1ll << 34, 1, 1, 1, 3});
+  TensorShape b = a;
+  TensorShape c;
+  c = a;
+  b.set_dim(0, 5);
+  c.AddDim(7);
+  EXPECT_EQ(a, TensorShape({1, 2, 1ll << 34, 1, 1, 1, 3}));
+  EXPECT_EQ(b, TensorShape({5, 2, 1ll << 34, 1, 1, 1, 3}));
+  EXPECT_EQ(c, TensorShape({1, 2, 1ll << 34, 1, 1, 1, 3, 7}));
+  EXPECT_EQ(5 * 2 * (1ll << 34) * 3, b.num_elements());
+
+  const TensorShape& alias = a;
+  a = alias;
+  a.set_dim(6, 4);
+  EXPECT_EQ(a, TensorShape({1, 2, 1ll << 34, 1, 1, 1, 4}));
+  EXPECT_EQ(b.dim_size(6), 3);
+}
+
 // A few different test cases for tensor sizes for benchmarks
 static std::vector<int64_t> MakeSizes(int arg) {
   std::vector<int64_t> sizes;
@@ -1024,6 +1043,9 @@ static std::vector<int64_t> MakeSizes(int arg) {
     case 4:
       sizes = {1, 2, 1ll << 34, 1, 1, 1};
       break;
+    case 5:
+      sizes = {32, 7, 5, 3, 2, 2, 4};
+      break;
   }
   return sizes;
 }
@@ -1037,7 +1059,13 @@ void BM_TensorShape_Init(::testing::benchmark::State& state) {
     tensorflow::testing::DoNotOptimize(shape.num_elements());
   }
 }
-BENCHMARK(BM_TensorShape_Init)->Arg(0)->Arg(1)->Arg(2)->Arg(3)->Arg(4);
+BENCHMARK(BM_TensorShape_Init)
+    ->Arg(0)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(3)
+    ->Arg(4)
+    ->Arg(5);
 
 void BM_TensorShape_Assign(::testing::benchmark::State& state) {
   const int arg = state.range(0);
@@ -1048,7 +1076,13 @@ void BM_TensorShape_Assign(::testing::benchmark::State& state) {
     tensorflow::testing::DoNotOptimize(s2);
   }
 }
-BENCHMARK(BM_TensorShape_Assign)->Arg(0)->Arg(1)->Arg(2)->Arg(3)->Arg(4);
+BENCHMARK(BM_TensorShape_Assign)
+    ->Arg(0)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(3)
+    ->Arg(4)
+    ->Arg(5);
 
 void BM_TensorShape_SetDim(::testing::benchmark::State& state) {
   const int arg = state.range(0);
@@ -1059,7 +1093,13 @@ void BM_TensorShape_SetDim(::testing::benchmark::State& state) {
     shape.set_dim(0, 8);
   }
 }
-BENCHMARK(BM_TensorShape_SetDim)->Arg(0)->Arg(1)->Arg(2)->Arg(3)->Arg(4);
+BENCHMARK(BM_TensorShape_SetDim)
+    ->Arg(0)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(3)
+    ->Arg(4)
+    ->Arg(5);
 
 }  // namespace
 }  // namespace tensorflow
@@ -1401,6 +1401,45 @@ TEST(Tensor, SharesBufferWith) {
   EXPECT_TRUE(a.SharesBufferWith(copy));
 }
 
+TEST(Tensor, OwnsMemory) {
+  EXPECT_TRUE(Tensor().OwnsMemory());
+  EXPECT_TRUE(Tensor(DT_FLOAT, TensorShape({4})).OwnsMemory());
+
+  class UnownedBuffer : public TensorBuffer {
+   public:
+    explicit UnownedBuffer(float* data) : TensorBuffer(data) {}
+    size_t size() const override { return 4 * sizeof(float); }
+    TensorBuffer* root_buffer() override { return this; }
+    void FillAllocationDescription(
+        AllocationDescription* proto) const override {}
+    bool OwnsMemory() const override { return false; }
+  };
+  float data[4] = {1, 2, 3, 4};
+  core::RefCountPtr<TensorBuffer> buf(new UnownedBuffer(data));
+  Tensor t(DT_FLOAT, TensorShape({4}), std::move(buf));
+  EXPECT_FALSE(t.OwnsMemory());
+  EXPECT_FALSE(t.RefCountIsOne());
+}
+
+TEST(Tensor, SmallTensorsUseInlineBuffer) {
+  if (CPUAllocatorStatsEnabled() || CPUAllocatorFullStatsEnabled()) {
+    GTEST_SKIP() << "Small tensors use the CPU allocator to be accounted for.";
+  }
+  Tensor small(DT_INT32, TensorShape({4}));
+  TensorDescription desc;
+  small.FillDescription(&desc);
+  EXPECT_EQ("InlineHostBuffer", desc.allocation_description().allocator_name());
+  EXPECT_TRUE(small.IsAligned());
+  small.flat<int32>().setConstant(7);
+  Tensor copy(small);
+  EXPECT_TRUE(copy.SharesBufferWith(small));
+  test::ExpectTensorEqual<int32>(copy, test::AsTensor<int32>({7, 7, 7, 7}));
+
+  Tensor large(DT_INT32, TensorShape({5}));
+  large.FillDescription(&desc);
+  EXPECT_NE("InlineHostBuffer", desc.allocation_description().allocator_name());
+}
+
 TEST(TensorFromProto, CompressedTensorProto) {
   int size = 100;
   TensorShape shape({size});
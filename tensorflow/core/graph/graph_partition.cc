@@ -16,6 +16,7 @@ limitations under the License.
 #include "tensorflow/core/graph/graph_partition.h"
 
 #include <deque>
+#include <map>
 #include <memory>
 #include <queue>
 #include <unordered_map>
@@ -168,17 +169,32 @@ void AddReadControl(const std::vector<NodeDef*>& recvs,
   }
 }
 
-void SetSendRecvAttrs(const PartitionOptions& opts, const Edge* edge,
-                      const string& tensor_name_attr, NodeDefBuilder* builder) {
+void SetSendRecvAttrs(const PartitionOptions& opts, const string& send_device,
+                      const string& recv_device, const string& src_name,
+                      const string& dst_name, const string& tensor_name_attr,
+                      NodeDefBuilder* builder) {
   builder->Attr("tensor_name", tensor_name_attr);
-  builder->Attr("send_device", edge->src()->assigned_device_name());
+  builder->Attr("send_device", send_device);
   builder->Attr("send_device_incarnation",
-                static_cast<int64_t>(
-                    opts.get_incarnation(edge->src()->assigned_device_name())));
-  builder->Attr("recv_device", edge->dst()->assigned_device_name());
+                static_cast<int64_t>(opts.get_incarnation(send_device)));
+  builder->Attr("recv_device", recv_device);
   builder->Attr("client_terminated", false);
-  builder->Attr("_src", edge->src()->name());
-  builder->Attr("_dst", edge->dst()->name());
+  builder->Attr("_src", src_name);
+  builder->Attr("_dst", dst_name);
+}
+
+void SetSendRecvAttrs(const PartitionOptions& opts, const Edge* edge,
+                      const string& tensor_name_attr, NodeDefBuilder* builder) {
+  SetSendRecvAttrs(opts, edge->src()->assigned_device_name(),
+                   edge->dst()->assigned_device_name(), edge->src()->name(),
+                   edge->dst()->name(), tensor_name_attr, builder);
+}
+
+string TensorNameAttr(const PartitionOptions& opts, const Edge* edge) {
+  if (opts.get_tensor_name_attr) {
+    return opts.get_tensor_name_attr(edge);
+  }
+  return strings::StrCat("edge_", edge->id(), "_", edge->src()->name());
 }
 
 NodeDef* AddSend(const PartitionOptions& opts, const GraphInfo& g_info,
@@ -323,6 +339,159 @@ NodeDef* AddRecv(const PartitionOptions& opts, const GraphInfo& g_info,
   }
 }
 
+// The data edges from one device to another partition that share a single
+// Send/Recv pair (see PartitionOptions::coalesce_send_recv). Like the recvs
+// reused through DupRecvTable, the recv is placed on the device of the first
+// consumer.
+struct CoalescedTransfer {
+  GraphDef* src_graph = nullptr;
+  GraphDef* dst_graph = nullptr;
+  // One edge per distinct tensor, in the order they are packed.
+  std::vector<const Edge*> edges;
+  // Maps the (node id, output slot) of each tensor to its index in `edges`.
+  absl::flat_hash_map<std::pair<int, int>, int> tensor_index;
+  // The consumers of the transferred tensors: the input at `input_index` of
+  // `node` is the tensor at `tensor_index` in `edges`.
+  struct Consumer {
+    NodeDef* node;
+    int input_index;
+    int tensor_index;
+  };
+  std::vector<Consumer> consumers;
+};
+
+// Keyed by the name of the sending device and the receiving partition.
+// Ordered so that the added nodes do not depend on hashing.
+typedef std::map<std::pair<string, string>, CoalescedTransfer>
+    CoalescedTransferTable;
+
+// Returns, for each node id, whether the node only depends on nodes at its
+// own location and cannot block on another location. A transfer that waits
+// for several outputs of such nodes cannot introduce a deadlock.
+//
+// Nodes in control flow constructs are excluded, since their outputs may be
+// dead, as are stateful nodes with inputs, which may block on other
+// locations through shared state, e.g. a queue.
+std::vector<bool> FindLocallyComputedNodes(const PartitionOptions& opts,
+                                           const Graph& g) {
+  std::vector<bool> local(g.num_node_ids(), false);
+  std::vector<Node*> order;
+  GetReversePostOrder(g, &order);
+  for (const Node* n : order) {
+    if (!n->IsOp() || n->IsControlFlow() || n->IsRecv() ||
+        n->IsDistributedCommunication() ||
+        (n->op_def().is_stateful() && n->num_inputs() > 0)) {
+      continue;
+    }
+    const string loc = opts.node_to_loc(n);
+    bool is_local = true;
+    for (const Edge* e : n->in_edges()) {
+      if (e->src()->IsSource()) continue;
+      if (!local[e->src()->id()] || opts.node_to_loc(e->src()) != loc) {
+        is_local = false;
+        break;
+      }
+    }
+    local[n->id()] = is_local;
+  }
+  return local;
+}
+
+// Returns true iff 'edge' into 'dst_graph' can share a Send/Recv pair with
+// the other edges from its source device into 'dst_graph'.
+bool CanCoalesce(const PartitionOptions& opts, const GraphInfo& g_info,
+                 const std::vector<bool>& locally_computed, const Edge* edge,
+                 const GraphDef* src_graph, const GraphDef* dst_graph) {
+  if (edge->IsControlEdge() || src_graph == dst_graph) return false;
+  const Node* src = edge->src();
+  const Node* dst = edge->dst();
+  const DataType dtype = EdgeType(edge);
+  return locally_computed[src->id()] &&
+         g_info.device_types[src->id()] == DEVICE_CPU &&
+         g_info.device_types[dst->id()] == DEVICE_CPU &&
+         !IsRefType(src->output_type(edge->src_output())) &&
+         DataTypeCanUseMemcpy(dtype) &&
+         (!opts.should_cast || opts.should_cast(edge) == dtype);
+}
+
+// Adds the Send/Recv pair of 'transfer' and sets the inputs of its
+// consumers.
+absl::Status AddCoalescedSendRecv(const PartitionOptions& opts,
+                                  const GraphInfo& g_info,
+                                  const CoalescedTransfer& transfer) {
+  const Edge* first = transfer.edges[0];
+  std::vector<string> outputs;
+  if (transfer.edges.size() == 1) {
+    // Nothing to pack.
+    absl::Status status;
+    const string tensor_name_attr = TensorNameAttr(opts, first);
+    NodeDefBuilder::NodeOut send_from(first->src()->name(),
+                                      first->src_output(), EdgeType(first));
+    AddSend(opts, g_info, transfer.src_graph, first, send_from,
+            /*start_time=*/0, tensor_name_attr, &status);
+    TF_RETURN_IF_ERROR(status);
+    NodeDef* real_recv = nullptr;
+    NodeDef* recv = AddRecv(opts, g_info, transfer.dst_graph, first,
+                            &real_recv, tensor_name_attr, &status);
+    TF_RETURN_IF_ERROR(status);
+    outputs.push_back(recv->name());
+  } else {
+    const string& send_device = first->src()->assigned_device_name();
+    const string& recv_device = first->dst()->assigned_device_name();
+    std::vector<NodeDefBuilder::NodeOut> values;
+    DataTypeVector dtypes;
+    for (const Edge* edge : transfer.edges) {
+      values.emplace_back(edge->src()->name(), edge->src_output(),
+                          EdgeType(edge));
+      dtypes.push_back(EdgeType(edge));
+    }
+    const string pack_name =
+        opts.new_name(strings::StrCat(first->src()->name(), "/pack"));
+    const string unpack_name =
+        opts.new_name(strings::StrCat(first->src()->name(), "/unpack"));
+    const string tensor_name_attr =
+        strings::StrCat("coalesced_", TensorNameAttr(opts, first));
+    VLOG(1) << "Coalescing " << values.size() << " tensors sent from "
+            << send_device << " to " << recv_device;
+
+    TF_RETURN_IF_ERROR(NodeDefBuilder(pack_name, "_PackTensors")
+                           .Device(send_device)
+                           .Input(values)
+                           .Finalize(transfer.src_graph->add_node(),
+                                     /*consume=*/true));
+    NodeDefBuilder send_builder(opts.new_name(pack_name), "_Send");
+    SetSendRecvAttrs(opts, send_device, recv_device, pack_name, unpack_name,
+                     tensor_name_attr, &send_builder);
+    TF_RETURN_IF_ERROR(send_builder.Device(send_device)
+                           .Input(pack_name, 0, DT_UINT8)
+                           .Finalize(transfer.src_graph->add_node(),
+                                     /*consume=*/true));
+
+    NodeDefBuilder recv_builder(opts.new_name(pack_name), "_Recv");
+    SetSendRecvAttrs(opts, send_device, recv_device, pack_name, unpack_name,
+                     tensor_name_attr, &recv_builder);
+    NodeDef* recv = transfer.dst_graph->add_node();
+    TF_RETURN_IF_ERROR(recv_builder.Device(recv_device)
+                           .Attr("tensor_type", DT_UINT8)
+                           .Finalize(recv, /*consume=*/true));
+    TF_RETURN_IF_ERROR(NodeDefBuilder(unpack_name, "_UnpackTensors")
+                           .Device(recv_device)
+                           .Input(recv->name(), 0, DT_UINT8)
+                           .Attr("T", dtypes)
+                           .Finalize(transfer.dst_graph->add_node(),
+                                     /*consume=*/true));
+    for (int i = 0; i < static_cast<int>(transfer.edges.size()); ++i) {
+      outputs.push_back(i == 0 ? unpack_name
+                               : strings::StrCat(unpack_name, ":", i));
+    }
+  }
+  for (const CoalescedTransfer::Consumer& consumer : transfer.consumers) {
+    consumer.node->set_input(consumer.input_index,
+                             outputs[consumer.tensor_index]);
+  }
+  return absl::OkStatus();
+}
+
 NodeDef* AddDummyConst(const PartitionOptions& opts, GraphDef* gdef,
                        const Edge* edge, absl::Status* status) {
   const Node* src = edge->src();
@@ -1002,6 +1171,13 @@ absl::Status Partition(const PartitionOptions& opts, Graph* g,
   std::vector<NodeDef*> ref_recvs;
   std::vector<string> ref_control_inputs;
 
+  const bool coalesce = opts.coalesce_send_recv && !opts.scheduling_for_recvs;
+  std::vector<bool> locally_computed;
+  CoalescedTransferTable coalesced;
+  if (coalesce) {
+    locally_computed = FindLocallyComputedNodes(opts, *g);
+  }
+
   int32_t num_data = 0;
   int32_t num_control = 0;
   for (Node* dst : g->op_nodes()) {
@@ -1080,6 +1256,13 @@ absl::Status Partition(const PartitionOptions& opts, Graph* g,
                                      " inputs for ", dst->name());
     }
 
+    // The reads of a ref input must wait for the recvs of the other inputs
+    // (see AddReadControl below), so those recvs are not deferred.
+    bool dst_can_coalesce = coalesce && control_flow_edge == nullptr;
+    for (int i = 0; dst_can_coalesce && i < dst->num_inputs(); ++i) {
+      dst_can_coalesce = !IsRefType(dst->input_type(i));
+    }
+
     // Process in order so that all data edges are added as inputs to
     // dst in Edge::dst_input() order.
     for (const Edge* edge : inputs) {
@@ -1115,6 +1298,26 @@ absl::Status Partition(const PartitionOptions& opts, Graph* g,
         }
       }
 
+      if (dst_can_coalesce && CanCoalesce(opts, g_info, locally_computed,
+                                          edge, src_graph, dst_graph)) {
+        // Defer the send/recv pair and leave a placeholder for the input,
+        // which is set once the transfer is added.
+        CoalescedTransfer& transfer =
+            coalesced[{src->assigned_device_name(), dstp}];
+        transfer.src_graph = src_graph;
+        transfer.dst_graph = dst_graph;
+        auto inserted = transfer.tensor_index.insert(
+            {{src->id(), edge->src_output()}, transfer.edges.size()});
+        if (inserted.second) {
+          transfer.edges.push_back(edge);
+          ++num_data;
+        }
+        transfer.consumers.push_back(
+            {dst_def, dst_def->input_size(), inserted.first->second});
+        dst_def->add_input();
+        continue;
+      }
+
       // Check whether there is already a send/recv pair transferring
       // the same tensor/control from the src to dst partition.
       const bool on_host = IsDstInputOnHost(edge, g_info);
@@ -1158,13 +1361,7 @@ absl::Status Partition(const PartitionOptions& opts, Graph* g,
         send_from.Reset(src->name(), edge->src_output(), EdgeType(edge));
       }
 
-      string tensor_name_attr;
-      if (opts.get_tensor_name_attr) {
-        tensor_name_attr = opts.get_tensor_name_attr(edge);
-      } else {
-        tensor_name_attr =
-            strings::StrCat("edge_", edge->id(), "_", edge->src()->name());
-      }
+      const string tensor_name_attr = TensorNameAttr(opts, edge);
 
       if (VLOG_IS_ON(1) && IsConstant(edge->src())) {
         LOG(WARNING) << "Send/Recv constant: " << edge->src()->name() << " ["
@@ -1256,6 +1453,10 @@ absl::Status Partition(const PartitionOptions& opts, Graph* g,
     }
   }
 
+  for (const auto& it : coalesced) {
+    TF_RETURN_IF_ERROR(AddCoalescedSendRecv(opts, g_info, it.second));
+  }
+
   const FunctionLibraryDefinition* flib_def = opts.flib_def;
   if (flib_def == nullptr) {
     flib_def = &g->flib_def();
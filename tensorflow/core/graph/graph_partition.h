@@ -77,6 +77,14 @@ struct PartitionOptions {
   bool need_to_record_start_times = false;
   std::vector<Microseconds> start_times;
 
+  // If true, the data edges from one device to a device in another partition
+  // are transferred with a single Send/Recv pair per pair of devices. The
+  // sender packs the tensors with _PackTensors and the receiver unpacks them
+  // with _UnpackTensors. Only edges between CPU devices whose source node
+  // cannot wait on another partition are coalesced, so that no deadlock is
+  // introduced. Ignored if `scheduling_for_recvs` is true.
+  bool coalesce_send_recv = false;
+
   // Optional customized function to compute the "tensor_name" attr value of
   // Send/Recv ops inserted during partitioning.
   std::function<string(const Edge*)> get_tensor_name_attr = nullptr;
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/graph/graph_partition.h"
 
+#include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -83,7 +84,8 @@ string DeviceName(const Node* node) {
 }
 
 void Partition(const GraphDef& graph_def,
-               std::unordered_map<string, GraphDef>* partitions) {
+               std::unordered_map<string, GraphDef>* partitions,
+               bool coalesce_send_recv = false) {
   Graph g(OpRegistry::Global());
   GraphConstructorOptions opts;
   TF_CHECK_OK(ConvertGraphDefToGraph(opts, graph_def, &g));
@@ -103,6 +105,7 @@ void Partition(const GraphDef& graph_def,
   popts.get_incarnation = [](const string& name) {
     return (name[0] - 'A') + 100;
   };
+  popts.coalesce_send_recv = coalesce_send_recv;
   absl::Status s = Partition(popts, &g, partitions);
   CHECK(s.ok()) << s;
 
@@ -395,6 +398,60 @@ TEST_F(GraphPartitionTest, CrossDevice_DataControl) {
   ExpectMatchB();
 }
 
+TEST_F(GraphPartitionTest, CoalesceSendRecv) {
+  auto a1 = FloatInput(in_.WithOpName("A1"));
+  auto a2 = FloatInput(in_.WithOpName("A2"));
+  auto b1 = FloatInput(in_.WithOpName("B1"));
+  Combine(in_.WithOpName("B2"), a1, a2);
+  Combine(in_.WithOpName("B3"), a1, b1);
+  // A3 depends on cpu:1, so its transfer must not wait for A1 and A2.
+  auto a3 = Combine(in_.WithOpName("A3"), a1, b1);
+  Combine(in_.WithOpName("B4"), a3, b1);
+
+  Partition(ToGraphDef(), &partitions_, /*coalesce_send_recv=*/true);
+  EXPECT_EQ(2, partitions_.size());
+
+  std::map<string, const NodeDef*> a_nodes;
+  for (const NodeDef& ndef :
+       partitions_["/job:a/replica:0/task:0/cpu:0"].node()) {
+    a_nodes[ndef.op()] = &ndef;
+  }
+  ASSERT_TRUE(a_nodes.count("_PackTensors"));
+  EXPECT_THAT(a_nodes["_PackTensors"]->input(),
+              ::testing::ElementsAre("A1", "A2"));
+  int num_sends = 0;
+  for (const NodeDef& ndef :
+       partitions_["/job:a/replica:0/task:0/cpu:0"].node()) {
+    if (ndef.op() == "_Send") ++num_sends;
+  }
+  // One send for the packed A1 and A2, and one for A3.
+  EXPECT_EQ(2, num_sends);
+
+  std::map<string, const NodeDef*> b_nodes;
+  int num_recvs = 0;
+  for (const NodeDef& ndef :
+       partitions_["/job:a/replica:0/task:0/cpu:1"].node()) {
+    b_nodes[ndef.name()] = &ndef;
+    if (ndef.op() == "_Recv") ++num_recvs;
+  }
+  EXPECT_EQ(2, num_recvs);
+  const NodeDef* b2 = b_nodes["B2"];
+  const NodeDef* b3 = b_nodes["B3"];
+  ASSERT_EQ(2, b2->input_size());
+  const NodeDef* unpack = b_nodes[b2->input(0)];
+  ASSERT_NE(nullptr, unpack);
+  EXPECT_EQ("_UnpackTensors", unpack->op());
+  EXPECT_EQ(strings::StrCat(unpack->name(), ":1"), b2->input(1));
+  // A1 is transferred once for both consumers.
+  EXPECT_EQ(b2->input(0), b3->input(0));
+  EXPECT_EQ("B1", b3->input(1));
+  const NodeDef* recv = b_nodes[unpack->input(0)];
+  ASSERT_NE(nullptr, recv);
+  EXPECT_EQ("_Recv", recv->op());
+  EXPECT_EQ(DT_UINT8, recv->attr().at("tensor_type").type());
+  EXPECT_EQ("_Recv", b_nodes[b_nodes["B4"]->input(0)]->op());
+}
+
 TEST_F(GraphPartitionTest, CrossDeviceLoopSimple) {
   auto a1 = BoolInput(in_.WithOpName("A1"));
   auto a2 = ::tensorflow::ops::internal::Enter(in_.WithOpName("A2"), a1, "foo");
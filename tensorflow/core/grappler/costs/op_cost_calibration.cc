@@ -0,0 +1,168 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/op_cost_calibration.h"
+
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "absl/log/log.h"
+#include "absl/status/statusor.h"
+#include "tensorflow/core/grappler/costs/robust_stats.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr int kAnyTimeBucket = -1;
+
+Costs::Duration ScaleDuration(Costs::Duration duration, double scale) {
+  if (duration <= Costs::Duration::zero() ||
+      duration == Costs::Duration::infinity()) {
+    return duration;
+  }
+  return Costs::Duration(std::round(duration.count() * scale));
+}
+
+}  // namespace
+
+OpCostCalibration::OpCostCalibration(
+    const OpCostCalibrationProfile& profile) {
+  for (const auto& entry : profile.entry()) {
+    if (entry.scale() <= 0.0 || !std::isfinite(entry.scale())) {
+      LOG(WARNING) << "Ignoring invalid op cost calibration entry: "
+                   << entry.ShortDebugString();
+      continue;
+    }
+    scales_[Key(entry.op(), entry.device_type(), entry.time_bucket())] =
+        entry.scale();
+  }
+}
+
+absl::StatusOr<std::shared_ptr<const OpCostCalibration>>
+OpCostCalibration::Load(const string& path) {
+  OpCostCalibrationProfile profile;
+  TF_RETURN_IF_ERROR(ReadTextOrBinaryProto(Env::Default(), path, &profile));
+  return std::make_shared<const OpCostCalibration>(profile);
+}
+
+std::shared_ptr<const OpCostCalibration> OpCostCalibration::FromEnvironment() {
+  static const auto* calibration = []() {
+    auto* calibration = new std::shared_ptr<const OpCostCalibration>();
+    string path;
+    absl::Status s =
+        ReadStringFromEnvVar(kOpCostCalibrationEnvVar, "", &path);
+    if (!s.ok() || path.empty()) {
+      return calibration;
+    }
+    absl::StatusOr<std::shared_ptr<const OpCostCalibration>> loaded =
+        Load(path);
+    if (!loaded.ok()) {
+      LOG(WARNING) << "Failed to load the op cost calibration from " << path
+                   << ": " << loaded.status();
+      return calibration;
+    }
+    VLOG(1) << "Loaded " << (*loaded)->num_entries()
+            << " op cost calibration entries from " << path;
+    *calibration = *std::move(loaded);
+    return calibration;
+  }();
+  return *calibration;
+}
+
+int OpCostCalibration::TimeBucket(Costs::Duration analytical_time) {
+  if (analytical_time.count() <= 1) {
+    return 0;
+  }
+  return static_cast<int>(
+      std::floor(std::log2(static_cast<double>(analytical_time.count()))));
+}
+
+double OpCostCalibration::Scale(const OpInfo& op_info,
+                                Costs::Duration analytical_time) const {
+  const string& device_type = op_info.device().type();
+  auto it = scales_.find(
+      Key(op_info.op(), device_type, TimeBucket(analytical_time)));
+  if (it != scales_.end()) {
+    return it->second;
+  }
+  it = scales_.find(Key(op_info.op(), device_type, kAnyTimeBucket));
+  if (it != scales_.end()) {
+    return it->second;
+  }
+  return 1.0;
+}
+
+void OpCostCalibration::Apply(const OpInfo& op_info, Costs* costs) const {
+  const double scale = Scale(op_info, costs->execution_time);
+  if (scale == 1.0) {
+    return;
+  }
+  costs->execution_time = ScaleDuration(costs->execution_time, scale);
+  costs->compute_time = ScaleDuration(costs->compute_time, scale);
+  costs->memory_time = ScaleDuration(costs->memory_time, scale);
+  costs->intermediate_memory_time =
+      ScaleDuration(costs->intermediate_memory_time, scale);
+  costs->intermediate_memory_read_time =
+      ScaleDuration(costs->intermediate_memory_read_time, scale);
+  costs->intermediate_memory_write_time =
+      ScaleDuration(costs->intermediate_memory_write_time, scale);
+}
+
+OpCostCalibrator::OpCostCalibrator(int min_samples)
+    : min_samples_(min_samples) {}
+
+void OpCostCalibrator::AddSample(const OpInfo& op_info,
+                                 Costs::Duration analytical_time,
+                                 Costs::Duration measured_time) {
+  if (analytical_time <= Costs::Duration::zero() ||
+      measured_time <= Costs::Duration::zero() ||
+      analytical_time == Costs::Duration::infinity()) {
+    return;
+  }
+  const double log_ratio =
+      std::log(static_cast<double>(measured_time.count()) /
+               static_cast<double>(analytical_time.count()));
+  const string& device_type = op_info.device().type();
+  log_ratios_[Key(op_info.op(), device_type,
+                  OpCostCalibration::TimeBucket(analytical_time))]
+      .push_back(log_ratio);
+  log_ratios_[Key(op_info.op(), device_type, kAnyTimeBucket)].push_back(
+      log_ratio);
+}
+
+OpCostCalibrationProfile OpCostCalibrator::Fit() const {
+  OpCostCalibrationProfile profile;
+  for (const auto& samples : log_ratios_) {
+    const std::vector<double>& log_ratios = samples.second;
+    if (static_cast<int>(log_ratios.size()) < min_samples_) {
+      continue;
+    }
+    auto* entry = profile.add_entry();
+    entry->set_op(std::get<0>(samples.first));
+    entry->set_device_type(std::get<1>(samples.first));
+    entry->set_time_bucket(std::get<2>(samples.first));
+    entry->set_scale(std::exp(RobustStats(log_ratios).mean()));
+    entry->set_num_samples(log_ratios.size());
+  }
+  return profile;
+}
+
+}  // end namespace grappler
+}  // end namespace tensorflow
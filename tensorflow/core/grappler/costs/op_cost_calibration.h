@@ -0,0 +1,99 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_COSTS_OP_COST_CALIBRATION_H_
+#define TENSORFLOW_CORE_GRAPPLER_COSTS_OP_COST_CALIBRATION_H_
+
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "tensorflow/core/grappler/costs/cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// Environment variable holding the path of a (text or binary)
+// OpCostCalibrationProfile that the OpLevelCostEstimator applies by default.
+inline constexpr char kOpCostCalibrationEnvVar[] =
+    "TF_GRAPPLER_OP_COST_CALIBRATION";
+
+// Multiplicative corrections to analytical op execution times, keyed by op
+// type, device type and the order of magnitude of the analytical time. The
+// latter lets a single op type be corrected differently for small and large
+// shapes, since analytical models tend to be most wrong for tiny ops.
+class OpCostCalibration {
+ public:
+  explicit OpCostCalibration(const OpCostCalibrationProfile& profile);
+
+  // Reads the profile stored at `path`.
+  static absl::StatusOr<std::shared_ptr<const OpCostCalibration>> Load(
+      const string& path);
+
+  // Returns the calibration named by kOpCostCalibrationEnvVar, or nullptr if
+  // the variable isn't set or the profile can't be read. The profile is only
+  // read once per process.
+  static std::shared_ptr<const OpCostCalibration> FromEnvironment();
+
+  // Returns the bucket of an analytical execution time, i.e. floor(log2()) of
+  // its value in nanoseconds.
+  static int TimeBucket(Costs::Duration analytical_time);
+
+  // Returns the ratio of the measured to the analytical execution time for the
+  // op, or 1 if the profile has no data for it. Entries fitted for the time
+  // bucket of the op take precedence over the ones fitted for all sizes.
+  double Scale(const OpInfo& op_info, Costs::Duration analytical_time) const;
+
+  // Scales the time components of `costs`, as predicted for `op_info`.
+  void Apply(const OpInfo& op_info, Costs* costs) const;
+
+  int num_entries() const { return scales_.size(); }
+
+ private:
+  // op type, device type, time bucket.
+  using Key = std::tuple<string, string, int>;
+  std::map<Key, double> scales_;
+};
+
+// Accumulates pairs of analytical and measured execution times and fits an
+// OpCostCalibrationProfile from them. The fitted scale of a key is a robust
+// estimate of the mean of log(measured / analytical) over its samples, so a
+// few outlier measurements don't skew it.
+class OpCostCalibrator {
+ public:
+  // Keys with fewer than `min_samples` samples are left out of the profile.
+  explicit OpCostCalibrator(int min_samples = 1);
+
+  // Records one execution of the op. Samples with a non-positive time are
+  // ignored.
+  void AddSample(const OpInfo& op_info, Costs::Duration analytical_time,
+                 Costs::Duration measured_time);
+
+  OpCostCalibrationProfile Fit() const;
+
+ private:
+  using Key = std::tuple<string, string, int>;
+  const int min_samples_;
+  std::map<Key, std::vector<double>> log_ratios_;
+};
+
+}  // end namespace grappler
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_COSTS_OP_COST_CALIBRATION_H_
@@ -0,0 +1,139 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/costs/op_cost_calibration.h"
+
+#include <memory>
+
+#include "tensorflow/core/grappler/costs/cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+OpInfo DescribeOp(const string& op, const string& device_type) {
+  OpInfo op_info;
+  op_info.set_op(op);
+  op_info.mutable_device()->set_type(device_type);
+  return op_info;
+}
+
+TEST(OpCostCalibrationTest, TimeBucket) {
+  EXPECT_EQ(0, OpCostCalibration::TimeBucket(Costs::Duration(0)));
+  EXPECT_EQ(0, OpCostCalibration::TimeBucket(Costs::Duration(1)));
+  EXPECT_EQ(1, OpCostCalibration::TimeBucket(Costs::Duration(3)));
+  EXPECT_EQ(10, OpCostCalibration::TimeBucket(Costs::Duration(1024)));
+  EXPECT_EQ(10, OpCostCalibration::TimeBucket(Costs::Duration(2047)));
+}
+
+TEST(OpCostCalibrationTest, FitAndScale) {
+  const OpInfo matmul = DescribeOp("MatMul", "CPU");
+  OpCostCalibrator calibrator;
+  calibrator.AddSample(matmul, Costs::Duration(1000), Costs::Duration(3000));
+  calibrator.AddSample(matmul, Costs::Duration(1000), Costs::Duration(3000));
+  // Outliers and invalid samples don't skew the fit.
+  calibrator.AddSample(matmul, Costs::Duration(1000), Costs::Duration(90000));
+  calibrator.AddSample(matmul, Costs::Duration(1000), Costs::Duration(0));
+  calibrator.AddSample(matmul, Costs::Duration(1 << 20),
+                       Costs::Duration(1 << 19));
+
+  const OpCostCalibrationProfile profile = calibrator.Fit();
+  ASSERT_EQ(3, profile.entry_size());
+  const OpCostCalibration calibration(profile);
+
+  EXPECT_NEAR(3.0, calibration.Scale(matmul, Costs::Duration(1000)), 1e-6);
+  EXPECT_NEAR(0.5, calibration.Scale(matmul, Costs::Duration(1 << 20)), 1e-6);
+  // Sizes without measurements of their own use the op-wide correction.
+  double any_size_scale = 0.0;
+  for (const auto& entry : profile.entry()) {
+    if (entry.time_bucket() == -1) {
+      any_size_scale = entry.scale();
+      EXPECT_EQ(4, entry.num_samples());
+    }
+  }
+  EXPECT_EQ(any_size_scale,
+            calibration.Scale(matmul, Costs::Duration(1 << 15)));
+  // So do op types and devices without any measurements.
+  EXPECT_EQ(1.0, calibration.Scale(DescribeOp("MatMul", "GPU"),
+                                   Costs::Duration(1000)));
+  EXPECT_EQ(1.0, calibration.Scale(DescribeOp("Conv2D", "CPU"),
+                                   Costs::Duration(1000)));
+}
+
+TEST(OpCostCalibrationTest, MinSamples) {
+  const OpInfo matmul = DescribeOp("MatMul", "CPU");
+  OpCostCalibrator calibrator(/*min_samples=*/2);
+  calibrator.AddSample(matmul, Costs::Duration(1000), Costs::Duration(2000));
+  calibrator.AddSample(matmul, Costs::Duration(1 << 20),
+                       Costs::Duration(1 << 21));
+
+  // Only the op-wide entry has enough samples.
+  const OpCostCalibrationProfile profile = calibrator.Fit();
+  ASSERT_EQ(1, profile.entry_size());
+  EXPECT_EQ("MatMul", profile.entry(0).op());
+  EXPECT_EQ("CPU", profile.entry(0).device_type());
+  EXPECT_EQ(-1, profile.entry(0).time_bucket());
+  EXPECT_NEAR(2.0, profile.entry(0).scale(), 1e-6);
+  EXPECT_EQ(2, profile.entry(0).num_samples());
+}
+
+TEST(OpCostCalibrationTest, Apply) {
+  OpCostCalibrationProfile profile;
+  auto* entry = profile.add_entry();
+  entry->set_op("MatMul");
+  entry->set_device_type("CPU");
+  entry->set_time_bucket(-1);
+  entry->set_scale(1.5);
+  const OpCostCalibration calibration(profile);
+
+  Costs costs = Costs::ZeroCosts();
+  costs.compute_time = Costs::Duration(600);
+  costs.memory_time = Costs::Duration(400);
+  costs.execution_time = Costs::Duration(1000);
+  calibration.Apply(DescribeOp("MatMul", "CPU"), &costs);
+  EXPECT_EQ(Costs::Duration(900), costs.compute_time);
+  EXPECT_EQ(Costs::Duration(600), costs.memory_time);
+  EXPECT_EQ(Costs::Duration(1500), costs.execution_time);
+  EXPECT_EQ(Costs::Duration(0), costs.intermediate_memory_time);
+}
+
+TEST(OpCostCalibrationTest, Load) {
+  OpCostCalibrator calibrator;
+  calibrator.AddSample(DescribeOp("MatMul", "CPU"), Costs::Duration(1000),
+                       Costs::Duration(2000));
+  const string path = io::JoinPath(testing::TmpDir(), "calibration.pbtxt");
+  TF_ASSERT_OK(WriteTextProto(Env::Default(), path, calibrator.Fit()));
+
+  auto calibration = OpCostCalibration::Load(path);
+  TF_ASSERT_OK(calibration.status());
+  EXPECT_EQ(2, (*calibration)->num_entries());
+  EXPECT_NEAR(2.0,
+              (*calibration)->Scale(DescribeOp("MatMul", "CPU"),
+                                    Costs::Duration(1000)),
+              1e-6);
+
+  EXPECT_FALSE(
+      OpCostCalibration::Load(io::JoinPath(testing::TmpDir(), "missing"))
+          .ok());
+}
+
+}  // namespace
+}  // end namespace grappler
+}  // end namespace tensorflow
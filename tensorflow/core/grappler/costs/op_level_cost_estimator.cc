@@ -655,9 +655,36 @@ OpLevelCostEstimator::OpLevelCostEstimator() {
 
   // By default, use sum of memory_time and compute_time for execution_time.
   compute_memory_overlap_ = false;
+  calibration_ = OpCostCalibration::FromEnvironment();
 }
 
 Costs OpLevelCostEstimator::PredictCosts(const OpContext& op_context) const {
+  Costs costs = PredictAnalyticalCosts(op_context);
+  if (calibration_ != nullptr && !costs.inaccurate) {
+    calibration_->Apply(op_context.op_info, &costs);
+  }
+  return costs;
+}
+
+OpCostCalibrationProfile OpLevelCostEstimator::Calibrate(
+    const OpPerformanceList& data, int min_samples) const {
+  OpCostCalibrator calibrator(min_samples);
+  for (const auto& op_perf : data.op_performance()) {
+    OpContext op_context;
+    op_context.name = op_perf.node();
+    op_context.op_info = op_perf.op();
+    const Costs costs = PredictAnalyticalCosts(op_context);
+    if (costs.inaccurate) {
+      continue;
+    }
+    calibrator.AddSample(op_context.op_info, costs.execution_time,
+                         Costs::Duration(op_perf.compute_cost()));
+  }
+  return calibrator.Fit();
+}
+
+Costs OpLevelCostEstimator::PredictAnalyticalCosts(
+    const OpContext& op_context) const {
   Costs costs;
   NodeCosts node_costs;
   if (PredictNodeCosts(op_context, &node_costs).ok()) {
@@ -19,13 +19,16 @@ limitations under the License.
 #include <cstdint>
 #include <functional>
 #include <map>
+#include <memory>
 #include <numeric>
 #include <set>
+#include <utility>
 #include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "tensorflow/core/grappler/costs/cost_estimator.h"
+#include "tensorflow/core/grappler/costs/op_cost_calibration.h"
 #include "tensorflow/core/grappler/costs/op_context.h"
 #include "tensorflow/core/grappler/costs/op_performance_data.pb.h"
 #include "tensorflow/core/platform/types.h"
@@ -106,6 +109,20 @@ class OpLevelCostEstimator {
   // Returns basic device performance info.
   virtual DeviceInfo GetDeviceInfo(const DeviceProperties& device) const;
 
+  // Fits corrections of the analytical costs predicted by this estimator to
+  // the measured execution times (compute_cost) of the ops in `data`, e.g. as
+  // returned by CostGraphToOpPerformanceData(). Op types with fewer than
+  // `min_samples` measurements are left uncorrected.
+  OpCostCalibrationProfile Calibrate(const OpPerformanceList& data,
+                                     int min_samples = 1) const;
+
+  // Sets the corrections PredictCosts() applies to the analytical costs, or
+  // disables them if `calibration` is null. Defaults to the calibration named
+  // by the TF_GRAPPLER_OP_COST_CALIBRATION environment variable, if any.
+  void set_calibration(std::shared_ptr<const OpCostCalibration> calibration) {
+    calibration_ = std::move(calibration);
+  }
+
  protected:
   // TODO(dyoon): Consider to remove PredictOpCountBasedCosts() with OpInfo.
   // Naive cost estimate based on the given operations count and total
@@ -119,6 +136,10 @@ class OpLevelCostEstimator {
                                 double output_io_bytes,
                                 const OpInfo& op_info) const;
 
+  // Predicts the costs of the op from the analytical models only, ignoring the
+  // calibration.
+  Costs PredictAnalyticalCosts(const OpContext& op_context) const;
+
   // Top-level method cost function (PredictCosts calls this method to get
   // NodeCosts, and then converts it to Costs). PredictNodeCosts() calls other
   // Predict methods depending on op types.
@@ -335,6 +356,7 @@ class OpLevelCostEstimator {
   // compute_time and memory_time, instead of sum of those two.
   bool compute_memory_overlap_;
   std::set<string> persistent_ops_;
+  std::shared_ptr<const OpCostCalibration> calibration_;
 
  private:
   friend class OpLevelCostEstimatorTest;
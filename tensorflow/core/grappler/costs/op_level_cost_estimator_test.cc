@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
 
+#include <memory>
 #include <unordered_set>
 
 #include "tensorflow/core/framework/attr_value.pb.h"
@@ -2365,5 +2366,42 @@ TEST_F(OpLevelCostEstimatorTest, CropAndResizeExecutionTime) {
   }
 }
 
+TEST_F(OpLevelCostEstimatorTest, Calibration) {
+  const OpContext small = DescribeMatMul(16, 16, 16, 16);
+  const OpContext large = DescribeMatMul(512, 512, 512, 512);
+  const OpContext medium = DescribeMatMul(128, 128, 128, 128);
+  const Costs small_cost = PredictCosts(small);
+  const Costs large_cost = PredictCosts(large);
+  const Costs medium_cost = PredictCosts(medium);
+
+  // Small MatMuls were measured 4x slower than predicted, large ones 2x.
+  OpPerformanceList data;
+  auto add_measurement = [&data](const OpContext& op_context,
+                                 const Costs& cost, int64_t slowdown) {
+    OpPerformance* op_perf = data.add_op_performance();
+    *op_perf->mutable_op() = op_context.op_info;
+    op_perf->set_compute_cost(cost.execution_time.count() * slowdown);
+  };
+  add_measurement(small, small_cost, 4);
+  add_measurement(small, small_cost, 4);
+  add_measurement(large, large_cost, 2);
+
+  const OpCostCalibrationProfile profile = estimator_.Calibrate(data);
+  // One entry per size bucket, plus one for MatMuls of any size.
+  EXPECT_EQ(3, profile.entry_size());
+  estimator_.set_calibration(std::make_shared<OpCostCalibration>(profile));
+
+  EXPECT_EQ(Costs::Duration(small_cost.execution_time.count() * 4),
+            PredictCosts(small).execution_time);
+  EXPECT_EQ(Costs::Duration(large_cost.execution_time.count() * 2),
+            PredictCosts(large).execution_time);
+  EXPECT_GT(PredictCosts(medium).execution_time, medium_cost.execution_time);
+  // Calibrating against calibrated predictions must not compound.
+  EXPECT_EQ(profile.DebugString(), estimator_.Calibrate(data).DebugString());
+
+  estimator_.set_calibration(nullptr);
+  EXPECT_EQ(small_cost.execution_time, PredictCosts(small).execution_time);
+}
+
 }  // end namespace grappler
 }  // end namespace tensorflow
@@ -31,6 +31,8 @@ limitations under the License.
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/costs/graph_properties.h"
+#include "tensorflow/core/grappler/costs/op_level_cost_estimator.h"
 #include "tensorflow/core/grappler/costs/virtual_placer.h"
 #include "tensorflow/core/grappler/devices.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -67,6 +69,23 @@ bool ShouldSimulateGpu() {
   return is_enabled;
 }
 
+bool ShouldUseCostModel() {
+  bool ret = false;
+  TF_CHECK_OK(
+      ReadBoolFromEnvVar("TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_COST_MODEL",
+                         /*default_val=*/false, &ret));
+  return ret;
+}
+
+// Returns the expected speedup of compute bound ops when run in bfloat16 on
+// this CPU rather than in float32. CPUs without native bfloat16 instructions
+// emulate them through conversions and are not expected to speed up.
+float GetBf16ComputeSpeedup() {
+  if (IsAMXDataTypeSupportedByOneDNNOnThisCPU(DT_BFLOAT16)) return 8.0f;
+  if (port::TestCPUFeature(port::CPUFeature::AVX512_BF16)) return 2.0f;
+  return 1.0f;
+}
+
 #if GOOGLE_CUDA
 const std::pair<int, int> kMinGPUArch = {7, 0};
 #else
@@ -1037,10 +1056,13 @@ class AutoMixedPrecisionImpl {
   //   FP32: cast to float32
   //   AUTO: cast to a data type that matches the required data type at fanouts
   enum class CastType { FP16, FP32, AUTO };
+  // If 'properties' is not null, allow clusters whose estimated savings do not
+  // cover the cost of their boundary casts are left in float32.
   AutoMixedPrecisionImpl(Cluster* cluster,
                          const std::unordered_set<string>& nodes_to_preserve,
                          GraphDef* graph, string id,
-                         AutoMixedPrecisionMode mode)
+                         AutoMixedPrecisionMode mode,
+                         const GraphProperties* properties)
       : devices_(GetDevices(cluster)),
         virtual_placer_(devices_),
         nodes_to_preserve_(nodes_to_preserve),
@@ -1056,7 +1078,9 @@ class AutoMixedPrecisionImpl {
                        mode_ == AutoMixedPrecisionMode::CPU ||
                        mode_ == AutoMixedPrecisionMode::FP16_CPU)
                           ? DT_HALF
-                          : DT_BFLOAT16) {}
+                          : DT_BFLOAT16),
+        properties_(properties),
+        compute_speedup_(GetBf16ComputeSpeedup()) {}
 
   absl::Status Optimize();
 
@@ -1102,6 +1126,11 @@ class AutoMixedPrecisionImpl {
       std::vector<NodeTypeIdEdge>* implicit_fp32_edges) const;
   void AddAllowlistOps(absl::flat_hash_set<int>* allow_set) const;
   void RemoveAllowsetWithFp32(absl::flat_hash_set<int>* allow_set) const;
+  OpContext BuildOpContext(const NodeDef& node) const;
+  double EstimateCastTime(const OpLevelCostEstimator& estimator,
+                          const NodeDef& src, int port) const;
+  void RemoveUnprofitableAllowClusters(
+      absl::flat_hash_set<int>* allow_set) const;
   void PropagateDenyFwdThroughClearAndInfer(
       absl::flat_hash_set<int>* deny_set) const;
   void ForceColorMatchBetweenTensorListOps(
@@ -1153,6 +1182,8 @@ class AutoMixedPrecisionImpl {
   gtl::FlatSet<string> f16_clearlist_;
   absl::flat_hash_set<const NodeDef*> should_process_nodes_;
   DataType target_dtype_;  // Either DT_HALF or DT_BFLOAT16
+  const GraphProperties* properties_;  // Not owned, may be null.
+  float compute_speedup_;
 };
 
 NodeDef AutoMixedPrecisionImpl::BuildCastNode(
@@ -1501,6 +1532,11 @@ absl::Status AutoMixedPrecisionImpl::Optimize() {
   //    connected to a node in the allow_set via other clearlist nodes.
   //    This is done to increase the number of ops in the allow_set without
   //    affecting numerical stability.
+  // 6) Remove nodes whose type attributes cannot be changed from the
+  //    allow_set.
+  // 7) If a cost model is in use, remove connected allow clusters whose
+  //    estimated savings do not exceed the cost of the casts that would be
+  //    inserted at their boundaries.
 
   absl::flat_hash_set<int> allow_set;
   VLOG(2) << "Beginning pass 1 to add allowlist ops";
@@ -1543,6 +1579,13 @@ absl::Status AutoMixedPrecisionImpl::Optimize() {
   RemoveAllowsetWithFp32(&allow_set);
   VLOG(2) << "Finished pass 6";
 
+  if (properties_ != nullptr) {
+    VLOG(2) << "Beginning pass 7 to remove allow clusters that are not "
+               "profitable according to the cost model";
+    RemoveUnprofitableAllowClusters(&allow_set);
+    VLOG(2) << "Finished pass 7";
+  }
+
   VLOG(2) << "Forcing color match between data structure ops";
   for (const auto& cluster : tensor_list_clusters) {
     ForceColorMatchBetweenTensorListOps(cluster, &allow_set, &deny_set);
@@ -1917,6 +1960,119 @@ void AutoMixedPrecisionImpl::RemoveAllowsetWithFp32(
   }
 }
 
+OpContext AutoMixedPrecisionImpl::BuildOpContext(const NodeDef& node) const {
+  OpContext op_context;
+  op_context.name = node.name();
+  op_context.op_info.set_op(node.op());
+  *op_context.op_info.mutable_attr() = node.attr();
+  for (const auto& input : properties_->GetInputProperties(node.name())) {
+    *op_context.op_info.add_inputs() = input;
+  }
+  for (const auto& output : properties_->GetOutputProperties(node.name())) {
+    *op_context.op_info.add_outputs() = output;
+  }
+  *op_context.op_info.mutable_device() = virtual_placer_.get_device(node);
+  return op_context;
+}
+
+// Returns the estimated time, in nanoseconds, of a Cast op converting output
+// 'port' of 'src' to the target data type.
+double AutoMixedPrecisionImpl::EstimateCastTime(
+    const OpLevelCostEstimator& estimator, const NodeDef& src,
+    int port) const {
+  const auto& outputs = properties_->GetOutputProperties(src.name());
+  if (port >= static_cast<int>(outputs.size())) return 0;
+  OpContext op_context;
+  op_context.op_info.set_op("Cast");
+  auto* attr = op_context.op_info.mutable_attr();
+  (*attr)["SrcT"].set_type(DT_FLOAT);
+  (*attr)["DstT"].set_type(target_dtype_);
+  *op_context.op_info.add_inputs() = outputs[port];
+  OpInfo::TensorProperties* output = op_context.op_info.add_outputs();
+  *output = outputs[port];
+  output->set_dtype(target_dtype_);
+  *op_context.op_info.mutable_device() = virtual_placer_.get_device(src);
+  return estimator.PredictCosts(op_context).execution_time.count();
+}
+
+// Groups the allow_set into clusters of connected nodes and removes those for
+// which the estimated time saved by running in reduced precision does not
+// exceed the estimated time of the Cast ops inserted at the cluster boundary.
+// Reduced precision halves the memory traffic of every node in a cluster, and
+// additionally speeds up the compute of allowlist ops by the factor the CPU
+// provides for them. Nodes with unknown shapes are estimated to save nothing.
+void AutoMixedPrecisionImpl::RemoveUnprofitableAllowClusters(
+    absl::flat_hash_set<int>* allow_set) const {
+  OpLevelCostEstimator estimator;
+  absl::flat_hash_set<int> visited;
+  for (int root_idx = 0; root_idx < graph_type_view_.num_nodes(); ++root_idx) {
+    if (!allow_set->count(root_idx) || visited.count(root_idx)) continue;
+    std::vector<int> cluster;
+    const NodeTypeId& root = *graph_type_view_.GetNode(root_idx);
+    DfsTypeTraversal(graph_type_view_, {&root},
+                     TypeTraversalDirection::kFollowInputsAndOutputs,
+                     DfsTypePredicates::Enter([&](int idx) -> bool {
+                       return allow_set->count(idx) && !visited.count(idx);
+                     }),
+                     DfsTypeCallbacks::PreOrder([&](int idx) {
+                       visited.insert(idx);
+                       cluster.push_back(idx);
+                     }));
+
+    double saved_time = 0;
+    absl::flat_hash_set<const NodeDef*> estimated_nodes;
+    absl::flat_hash_set<std::pair<const NodeDef*, int>> boundary_ports;
+    for (int idx : cluster) {
+      const NodeTypeId& item = *graph_type_view_.GetNode(idx);
+      const NodeDef& node = *item.node;
+      if (estimated_nodes.insert(&node).second) {
+        Costs costs = estimator.PredictCosts(BuildOpContext(node));
+        saved_time += costs.memory_time.count() / 2.0;
+        if (f16_allowlist_.count(node.op())) {
+          saved_time +=
+              costs.compute_time.count() * (1.0 - 1.0 / compute_speedup_);
+        }
+      }
+      // Inputs produced outside the cluster are cast to the target type,
+      // except for constants, which constant folding takes care of.
+      for (int port : node_type_map_.GetInputPorts(node, item.type_attr)) {
+        const TensorId input = ParseTensorName(node.input(port));
+        const NodeDef* src = graph_view_.GetNode(input.node());
+        if (src == nullptr || IsConstant(*src)) continue;
+        const absl::optional<int> src_idx = graph_type_view_.GetNodeIndex(
+            src->name(), node_type_map_.GetOutputTypeAttr(*src, input.index()));
+        if (src_idx.has_value() && !allow_set->count(src_idx.value())) {
+          boundary_ports.insert({src, input.index()});
+        }
+      }
+      // Outputs consumed outside the cluster are cast back to float32.
+      bool has_external_fanout = false;
+      for (int fanout_idx : graph_type_view_.GetFanout(idx)) {
+        if (!allow_set->count(fanout_idx)) has_external_fanout = true;
+      }
+      if (has_external_fanout) {
+        for (int port : node_type_map_.GetOutputPorts(node, item.type_attr)) {
+          boundary_ports.insert({&node, port});
+        }
+      }
+    }
+
+    double cast_time = 0;
+    for (const auto& port : boundary_ports) {
+      cast_time += EstimateCastTime(estimator, *port.first, port.second);
+    }
+    if (saved_time > cast_time) continue;
+    VLOG(1) << "Keeping cluster of " << cluster.size()
+            << " type attribute(s) rooted at " << root.node->op() << " node "
+            << root.node->name() << " in float32: estimated saving "
+            << saved_time << "ns does not exceed " << boundary_ports.size()
+            << " cast(s) of " << cast_time << "ns";
+    for (int idx : cluster) {
+      allow_set->erase(idx);
+    }
+  }
+}
+
 // Forces NextIteration nodes and their output Merge node(s) to have the same
 // color. Specifically, it removes them all from allow_set if any of the Merge
 // nodes is not in allow_set, otherwise it adds the NextIteration node to
@@ -2328,9 +2484,28 @@ absl::Status AutoMixedPrecision::Optimize(Cluster* cluster,
                  << " graph optimizer configured for BFloat16 on CPUs";
   }
 
+  // With the cost model, only clusters expected to run faster in bfloat16 on
+  // this CPU are converted.
+  std::unique_ptr<GraphProperties> properties;
+  if (mode_ == AutoMixedPrecisionMode::BF16 && ShouldUseCostModel()) {
+    if (GetBf16ComputeSpeedup() <= 1.0f) {
+      VLOG(1) << "No native bfloat16 support on this CPU, skipping " << name()
+              << " graph optimizer";
+      return absl::OkStatus();
+    }
+    properties = std::make_unique<GraphProperties>(item);
+    absl::Status status =
+        properties->InferStatically(/*assume_valid_feeds=*/false);
+    if (!status.ok()) {
+      VLOG(1) << "Shape inference failed, running " << name()
+              << " graph optimizer without cost model: " << status;
+      properties.reset();
+    }
+  }
+
   // Optimize the output graph in-place.
   AutoMixedPrecisionImpl optimizer(cluster, item.NodesToPreserve(), output,
-                                   item.id, mode_);
+                                   item.id, mode_, properties.get());
   if (item.id == "tf_graph") {
     LOG(INFO) << "Running " << name() << " graph optimizer";
   } else {
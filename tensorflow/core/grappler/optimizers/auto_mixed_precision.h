@@ -36,6 +36,11 @@ class AutoMixedPrecision : public GraphOptimizer {
   // If 'mode' is CUDA, converts nodes to float16 on Nvidia GPUs. If BF16 or
   // FP16_CPU, converts nodes to bfloat16/fp16 on CPUs in order to take
   // advantage of oneDNN performance improvements with bfloat16/fp16.
+  //
+  // In BF16 mode, setting TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_COST_MODEL
+  // enables a cost model that takes the bfloat16 capabilities of the CPU
+  // (AMX, AVX512-BF16) into account, and leaves clusters of ops in float32
+  // when the casts around them are estimated to cost more than they save.
   explicit AutoMixedPrecision(
       AutoMixedPrecisionMode mode = AutoMixedPrecisionMode::CUDA)
       : mode_(mode) {}
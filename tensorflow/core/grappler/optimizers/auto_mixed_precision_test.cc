@@ -1604,6 +1604,49 @@ TEST_F(AutoMixedPrecisionMklTest, Simple) {
   }
 }
 
+TEST_F(AutoMixedPrecisionMklTest, CostModelKeepsUnprofitableClustersFp32) {
+  if (!IsAMXDataTypeSupportedByOneDNNOnThisCPU(DT_BFLOAT16) &&
+      !port::TestCPUFeature(port::CPUFeature::AVX512_BF16)) {
+    GTEST_SKIP() << "CPU does not support bfloat16 natively";
+  }
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(
+      "/job:localhost/replica:0/task:0/device:CPU:0");
+  // A memory bound MatMul, for which the casts cost more than bfloat16 saves.
+  Output input1 = ops::Const(s.WithOpName("input1"), 1.f / 32, {4096, 1});
+  Output input2 = ops::Const(s.WithOpName("input2"), 1.f / 32, {1, 1});
+  Output deny1 = ops::Exp(s.WithOpName("deny1"), input1);
+  Output deny2 = ops::Exp(s.WithOpName("deny2"), input2);
+  Output allow1 = ops::MatMul(s.WithOpName("allow1"), deny1, deny2);
+  Output deny3 = ops::Log(s.WithOpName("deny3"), allow1);
+  // A compute bound MatMul, which is worth converting.
+  Output input3 = ops::Const(s.WithOpName("input3"), 1.f / 32, {512, 512});
+  Output deny4 = ops::Exp(s.WithOpName("deny4"), input3);
+  Output allow2 = ops::MatMul(s.WithOpName("allow2"), deny4, deny4);
+  Output deny5 = ops::Log(s.WithOpName("deny5"), allow2);
+  Output fetch1 = ops::Identity(s.WithOpName("fetch1"), deny3);
+  Output fetch2 = ops::Identity(s.WithOpName("fetch2"), deny5);
+
+  GrapplerItem item;
+  item.fetch = {"fetch1", "fetch2"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  setenv("TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_COST_MODEL", "true",
+         1 /* replace */);
+  AutoMixedPrecision optimizer{AutoMixedPrecisionMode::BF16};
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(virtual_cluster_.get(), item, &output));
+  unsetenv("TF_AUTO_MIXED_PRECISION_GRAPH_REWRITE_COST_MODEL");
+
+  VLOG(1) << output.DebugString();
+
+  GraphView output_view(&output);
+  EXPECT_EQ(output.node_size(), item.graph.node_size() + 2);
+  EXPECT_EQ(output_view.GetNode("allow1")->attr().at("T").type(), DT_FLOAT);
+  EXPECT_EQ(output_view.GetNode("allow2")->attr().at("T").type(), DT_BFLOAT16);
+  EXPECT_EQ(output_view.GetNode("deny4")->attr().at("T").type(), DT_FLOAT);
+  EXPECT_EQ(output_view.GetNode("deny5")->attr().at("T").type(), DT_FLOAT);
+}
+
 TEST_F(AutoMixedPrecisionMklTest, TensorListSetGet) {
   tensorflow::Scope s = tensorflow::Scope::NewRootScope().WithDevice(
       "/job:localhost/replica:0/task:0/device:CPU:0");
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/grappler/optimizers/common_subgraph_elimination.h"
 
+#include <algorithm>
 #include <set>
 #include <string>
 #include <unordered_set>
@@ -24,6 +25,8 @@ limitations under the License.
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function.pb.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/graph/tensor_id.h"
@@ -290,5 +293,135 @@ absl::Status CommonSubgraphElimination::Optimize(Cluster* /*cluster*/,
   return DedupComputations(optimized_graph);
 }
 
+namespace {
+
+// FunctionDefsEqual() doesn't look at the attributes of the arguments.
+bool SameArgAttrs(const FunctionDef& f1, const FunctionDef& f2) {
+  if (f1.arg_attr_size() != f2.arg_attr_size() ||
+      f1.resource_arg_unique_id_size() != f2.resource_arg_unique_id_size()) {
+    return false;
+  }
+  for (const auto& arg_attr1 : f1.arg_attr()) {
+    auto arg_attr2 = f2.arg_attr().find(arg_attr1.first);
+    if (arg_attr2 == f2.arg_attr().end() ||
+        arg_attr1.second.attr_size() != arg_attr2->second.attr_size()) {
+      return false;
+    }
+    for (const auto& attr1 : arg_attr1.second.attr()) {
+      auto attr2 = arg_attr2->second.attr().find(attr1.first);
+      if (attr2 == arg_attr2->second.attr().end() ||
+          !AreAttrValuesEqual(attr1.second, attr2->second)) {
+        return false;
+      }
+    }
+  }
+  for (const auto& unique_id1 : f1.resource_arg_unique_id()) {
+    auto unique_id2 = f2.resource_arg_unique_id().find(unique_id1.first);
+    if (unique_id2 == f2.resource_arg_unique_id().end() ||
+        unique_id1.second != unique_id2->second) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void RenameFunctions(const absl::flat_hash_map<string, string>& renames,
+                     AttrValue* attr) {
+  if (attr->has_func()) {
+    auto it = renames.find(attr->func().name());
+    if (it != renames.end()) attr->mutable_func()->set_name(it->second);
+    for (auto& func_attr : *attr->mutable_func()->mutable_attr()) {
+      RenameFunctions(renames, &func_attr.second);
+    }
+  } else if (attr->has_list()) {
+    for (NameAttrList& func : *attr->mutable_list()->mutable_func()) {
+      auto it = renames.find(func.name());
+      if (it != renames.end()) func.set_name(it->second);
+    }
+  }
+}
+
+void RenameFunctions(const absl::flat_hash_map<string, string>& renames,
+                     protobuf::RepeatedPtrField<NodeDef>* nodes) {
+  for (NodeDef& node : *nodes) {
+    auto it = renames.find(node.op());
+    if (it != renames.end()) node.set_op(it->second);
+    for (auto& attr : *node.mutable_attr()) {
+      RenameFunctions(renames, &attr.second);
+    }
+  }
+}
+
+}  // namespace
+
+int DedupFunctionLibrary(GraphDef* graph) {
+  FunctionDefLibrary* library = graph->mutable_library();
+  absl::flat_hash_set<string> has_gradient;
+  for (const GradientDef& gradient : library->gradient()) {
+    has_gradient.insert(gradient.function_name());
+  }
+
+  // Redirecting the calls to a duplicate can make the callers identical, so
+  // iterate until no more duplicates are found.
+  int num_deduped = 0;
+  while (true) {
+    std::vector<const FunctionDef*> functions;
+    for (const FunctionDef& function : library->function()) {
+      if (!has_gradient.contains(function.signature().name())) {
+        functions.push_back(&function);
+      }
+    }
+    std::sort(functions.begin(), functions.end(),
+              [](const FunctionDef* f1, const FunctionDef* f2) {
+                return f1->signature().name() < f2->signature().name();
+              });
+
+    // Compare the functions without their names.
+    std::vector<FunctionDef> anonymous(functions.size());
+    absl::flat_hash_map<uint64, std::vector<int>> representatives;
+    absl::flat_hash_map<string, string> renames;
+    for (int i = 0, end = functions.size(); i < end; ++i) {
+      anonymous[i] = *functions[i];
+      anonymous[i].mutable_signature()->clear_name();
+      std::vector<int>& candidates =
+          representatives[FunctionDefHash(anonymous[i])];
+      for (int candidate : candidates) {
+        if (FunctionDefsEqual(anonymous[candidate], anonymous[i]) &&
+            SameArgAttrs(anonymous[candidate], anonymous[i])) {
+          renames.emplace(functions[i]->signature().name(),
+                          functions[candidate]->signature().name());
+          break;
+        }
+      }
+      if (!renames.contains(functions[i]->signature().name())) {
+        candidates.push_back(i);
+      }
+    }
+    if (renames.empty()) break;
+
+    for (const auto& rename : renames) {
+      VLOG(2) << "Replacing function " << rename.first << " by "
+              << rename.second;
+    }
+    RenameFunctions(renames, graph->mutable_node());
+    for (FunctionDef& function : *library->mutable_function()) {
+      RenameFunctions(renames, function.mutable_node_def());
+    }
+    for (GradientDef& gradient : *library->mutable_gradient()) {
+      auto it = renames.find(gradient.gradient_func());
+      if (it != renames.end()) gradient.set_gradient_func(it->second);
+    }
+    auto* library_functions = library->mutable_function();
+    library_functions->erase(
+        std::remove_if(library_functions->begin(), library_functions->end(),
+                       [&](const FunctionDef& function) {
+                         return renames.contains(function.signature().name());
+                       }),
+        library_functions->end());
+    num_deduped += renames.size();
+  }
+  return num_deduped;
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
@@ -64,6 +64,15 @@ class CommonSubgraphElimination : public GraphOptimizer {
   std::unordered_set<string> nodes_to_preserve_;
 };
 
+// Dedups the functions of the library of `graph` that have the same body,
+// signature and attributes as another function under a different name, like
+// the copies of a function traced for several signatures of a SavedModel.
+// Calls to a duplicate, in the graph and in the library, are redirected to the
+// first function by name with the same definition, and the duplicate is
+// removed from the library. Functions with a registered gradient are kept as
+// is. Returns the number of functions removed.
+int DedupFunctionLibrary(GraphDef* graph);
+
 }  // end namespace grappler
 }  // end namespace tensorflow
 
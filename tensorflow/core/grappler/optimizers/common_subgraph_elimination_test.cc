@@ -19,6 +19,7 @@ limitations under the License.
 #include "tensorflow/cc/ops/array_ops.h"
 #include "tensorflow/cc/ops/math_ops.h"
 #include "tensorflow/cc/ops/standard_ops.h"
+#include "tensorflow/core/framework/function_testlib.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -174,5 +175,51 @@ TEST_F(CommonSubgraphEliminationTest, OpDedupCommutative) {
   test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
 }
 
+TEST_F(CommonSubgraphEliminationTest, DedupFunctionLibrary) {
+  using test::function::NDef;
+
+  // Copies of XTimesTwo and XTimesFour, with the copy of XTimesFour calling
+  // the copy of XTimesTwo.
+  FunctionDef x_times_two_copy = test::function::XTimesTwo();
+  x_times_two_copy.mutable_signature()->set_name("XTimesTwoCopy");
+  FunctionDef x_times_four_copy = test::function::XTimesFour();
+  x_times_four_copy.mutable_signature()->set_name("XTimesFourCopy");
+  for (NodeDef& node : *x_times_four_copy.mutable_node_def()) {
+    node.set_op("XTimesTwoCopy");
+  }
+  // Same body as XTimesTwo, but with a registered gradient.
+  FunctionDef x_times_two_with_gradient = test::function::XTimesTwo();
+  x_times_two_with_gradient.mutable_signature()->set_name("XTimesTwoGrad");
+
+  GraphDef graph = test::function::GDef(
+      {NDef("x", "Placeholder", {}, {{"dtype", DT_FLOAT}}),
+       NDef("y1", "XTimesFour", {"x"}, {{"T", DT_FLOAT}}),
+       NDef("y2", "XTimesFourCopy", {"x"}, {{"T", DT_FLOAT}}),
+       NDef("y3", "XTimesTwoGrad", {"x"}, {{"T", DT_FLOAT}})},
+      {test::function::XTimesTwo(), test::function::XTimesFour(),
+       x_times_two_copy, x_times_four_copy, x_times_two_with_gradient});
+  GradientDef* gradient = graph.mutable_library()->add_gradient();
+  gradient->set_function_name("XTimesTwoGrad");
+  gradient->set_gradient_func("XTimesTwoCopy");
+
+  EXPECT_EQ(DedupFunctionLibrary(&graph), 2);
+
+  std::vector<string> functions;
+  for (const FunctionDef& function : graph.library().function()) {
+    functions.push_back(function.signature().name());
+  }
+  EXPECT_THAT(functions, ::testing::UnorderedElementsAre(
+                             "XTimesTwo", "XTimesFour", "XTimesTwoGrad"));
+  NodeMap node_map(&graph);
+  EXPECT_EQ(node_map.GetNode("y1")->op(), "XTimesFour");
+  EXPECT_EQ(node_map.GetNode("y2")->op(), "XTimesFour");
+  EXPECT_EQ(node_map.GetNode("y3")->op(), "XTimesTwoGrad");
+  ASSERT_EQ(graph.library().gradient_size(), 1);
+  EXPECT_EQ(graph.library().gradient(0).gradient_func(), "XTimesTwo");
+
+  // Nothing left to dedup.
+  EXPECT_EQ(DedupFunctionLibrary(&graph), 0);
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
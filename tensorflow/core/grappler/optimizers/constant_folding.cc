@@ -18,6 +18,8 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
 
 #include <cmath>
+#include <functional>
+#include <set>
 
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
@@ -569,6 +571,680 @@ absl::Status ConstantFolding::MaterializeShapes(
   return absl::OkStatus();
 }
 
+namespace {
+
+// Ops that commonly appear in the host-side arithmetic computing shapes from
+// the output of Shape ops.
+bool IsShapeArithmetic(const NodeDef& node) {
+  static const auto* const kShapeArithmeticOps =
+      new absl::flat_hash_set<string>{"Add",      "AddV2",    "Cast",
+                                      "ConcatV2", "ExpandDims", "FloorDiv",
+                                      "GatherV2", "Identity", "Maximum",
+                                      "Minimum",  "Mul",      "Pack",
+                                      "Reshape",  "Slice",    "Squeeze",
+                                      "StridedSlice", "Sub"};
+  return kShapeArithmeticOps->contains(node.op());
+}
+
+// An element of an integer tensor computed by shape arithmetic: either a known
+// value, or the size of dimension `dim` of the input of `shape_node`.
+struct ShapeElement {
+  int64_t value = 0;
+  const NodeDef* shape_node = nullptr;
+  int dim = 0;
+
+  bool known() const { return shape_node == nullptr; }
+  bool operator==(const ShapeElement& other) const {
+    return known() ? other.known() && value == other.value
+                   : shape_node == other.shape_node && dim == other.dim;
+  }
+};
+
+// The value of a scalar or vector integer tensor computed by shape arithmetic.
+struct ShapeValue {
+  bool is_scalar = false;
+  std::vector<ShapeElement> elements;
+};
+
+// Symbolically evaluates chains of shape arithmetic, tracking which elements
+// are sizes of dimensions that aren't known statically.
+class ShapeArithmeticEvaluator {
+ public:
+  ShapeArithmeticEvaluator(
+      const NodeMap& node_map, const GraphProperties& properties,
+      const absl::flat_hash_set<string>& feed_nodes,
+      std::function<bool(const string&, Tensor*)> get_constant, int max_ops)
+      : node_map_(node_map),
+        properties_(properties),
+        feed_nodes_(feed_nodes),
+        get_constant_(std::move(get_constant)),
+        max_ops_(max_ops) {}
+
+  // Evaluates the output of `node`. The control dependencies of `node` are
+  // ignored, but the chain it is computed from must not have any.
+  bool EvaluateNode(const NodeDef& node, ShapeValue* value) {
+    root_ = &node;
+    return Evaluate(node.name(), value);
+  }
+
+  // Number of shape arithmetic ops the evaluated value depends on.
+  int num_ops() const { return num_ops_; }
+
+  // The Shape ops the evaluated value depends on.
+  const std::set<const NodeDef*>& shape_nodes() const { return shape_nodes_; }
+
+ private:
+  bool Evaluate(const string& input, ShapeValue* value) {
+    if (IsControlInput(input)) {
+      return false;
+    }
+    int port;
+    const string node_name = ParseNodeName(input, &port);
+    const NodeDef* node = node_map_.GetNode(node_name);
+    if (node == nullptr || port != 0) {
+      return false;
+    }
+    auto it = values_.find(node);
+    if (it == values_.end()) {
+      ShapeValue node_value;
+      const bool valid = EvaluateUncached(*node, &node_value);
+      it = values_.emplace(node, std::move(node_value)).first;
+      if (!valid) {
+        it->second.elements.clear();
+        it->second.is_scalar = false;
+        invalid_.insert(node);
+      }
+    }
+    if (invalid_.contains(node)) {
+      return false;
+    }
+    *value = it->second;
+    return true;
+  }
+
+  bool EvaluateKnown(const string& input, std::vector<int64_t>* values) {
+    ShapeValue value;
+    if (!Evaluate(input, &value)) {
+      return false;
+    }
+    values->clear();
+    for (const ShapeElement& element : value.elements) {
+      if (!element.known()) {
+        return false;
+      }
+      values->push_back(element.value);
+    }
+    return true;
+  }
+
+  bool EvaluateUncached(const NodeDef& node, ShapeValue* value) {
+    Tensor tensor;
+    if (get_constant_(node.name(), &tensor)) {
+      if ((tensor.dtype() != DT_INT32 && tensor.dtype() != DT_INT64) ||
+          tensor.dims() > 1) {
+        return false;
+      }
+      value->is_scalar = tensor.dims() == 0;
+      for (int64_t i = 0; i < tensor.NumElements(); ++i) {
+        ShapeElement element;
+        element.value = tensor.dtype() == DT_INT32 ? tensor.flat<int32>()(i)
+                                                   : tensor.flat<int64_t>()(i);
+        value->elements.push_back(element);
+      }
+      return true;
+    }
+    if (feed_nodes_.contains(node.name())) {
+      return false;
+    }
+    if (node.op() == "Shape") {
+      const std::vector<OpInfo::TensorProperties>& input =
+          properties_.GetInputProperties(node.name());
+      if (input.size() != 1 || input[0].shape().unknown_rank()) {
+        return false;
+      }
+      shape_nodes_.insert(&node);
+      for (int i = 0; i < input[0].shape().dim_size(); ++i) {
+        ShapeElement element;
+        const int64_t size = input[0].shape().dim(i).size();
+        if (size >= 0) {
+          element.value = size;
+        } else {
+          element.shape_node = &node;
+          element.dim = i;
+        }
+        value->elements.push_back(element);
+      }
+      return true;
+    }
+    if (!IsShapeArithmetic(node) || ++num_ops_ > max_ops_) {
+      return false;
+    }
+    for (const string& input : node.input()) {
+      if (IsControlInput(input) && &node != root_) {
+        return false;
+      }
+    }
+
+    const string& op = node.op();
+    if (op == "Identity") {
+      return Evaluate(node.input(0), value);
+    }
+    if (op == "Cast") {
+      return EvaluateCast(node, value);
+    }
+    if (op == "Pack") {
+      return EvaluatePack(node, value);
+    }
+    if (op == "ConcatV2") {
+      return EvaluateConcat(node, value);
+    }
+    if (op == "StridedSlice") {
+      return EvaluateStridedSlice(node, value);
+    }
+    if (op == "Slice") {
+      return EvaluateSlice(node, value);
+    }
+    if (op == "GatherV2") {
+      return EvaluateGather(node, value);
+    }
+    if (op == "Reshape" || op == "ExpandDims" || op == "Squeeze") {
+      return EvaluateReshape(node, value);
+    }
+    return EvaluateBinaryOp(node, value);
+  }
+
+  bool EvaluateCast(const NodeDef& node, ShapeValue* value) {
+    DataType src_type;
+    DataType dst_type;
+    if (!GetNodeAttr(node, "SrcT", &src_type).ok() ||
+        !GetNodeAttr(node, "DstT", &dst_type).ok() ||
+        (src_type != DT_INT32 && src_type != DT_INT64) ||
+        (dst_type != DT_INT32 && dst_type != DT_INT64) ||
+        !Evaluate(node.input(0), value)) {
+      return false;
+    }
+    if (dst_type == DT_INT32) {
+      for (ShapeElement& element : value->elements) {
+        element.value = static_cast<int32>(element.value);
+      }
+    }
+    return true;
+  }
+
+  bool EvaluatePack(const NodeDef& node, ShapeValue* value) {
+    int axis;
+    if (!GetNodeAttr(node, "axis", &axis).ok() || (axis != 0 && axis != -1)) {
+      return false;
+    }
+    for (const string& input : node.input()) {
+      if (IsControlInput(input)) {
+        continue;
+      }
+      ShapeValue input_value;
+      if (!Evaluate(input, &input_value) || !input_value.is_scalar) {
+        return false;
+      }
+      value->elements.push_back(input_value.elements[0]);
+    }
+    return true;
+  }
+
+  bool EvaluateConcat(const NodeDef& node, ShapeValue* value) {
+    int num_inputs;
+    std::vector<int64_t> axis;
+    if (!GetNodeAttr(node, "N", &num_inputs).ok() ||
+        !EvaluateKnown(node.input(num_inputs), &axis) || axis.size() != 1 ||
+        (axis[0] != 0 && axis[0] != -1)) {
+      return false;
+    }
+    for (int i = 0; i < num_inputs; ++i) {
+      ShapeValue input_value;
+      if (!Evaluate(node.input(i), &input_value) || input_value.is_scalar) {
+        return false;
+      }
+      value->elements.insert(value->elements.end(),
+                             input_value.elements.begin(),
+                             input_value.elements.end());
+    }
+    return true;
+  }
+
+  bool EvaluateStridedSlice(const NodeDef& node, ShapeValue* value) {
+    int begin_mask = 0;
+    int end_mask = 0;
+    int ellipsis_mask = 0;
+    int new_axis_mask = 0;
+    int shrink_axis_mask = 0;
+    GetNodeAttr(node, "begin_mask", &begin_mask).IgnoreError();
+    GetNodeAttr(node, "end_mask", &end_mask).IgnoreError();
+    GetNodeAttr(node, "ellipsis_mask", &ellipsis_mask).IgnoreError();
+    GetNodeAttr(node, "new_axis_mask", &new_axis_mask).IgnoreError();
+    GetNodeAttr(node, "shrink_axis_mask", &shrink_axis_mask).IgnoreError();
+    ShapeValue input;
+    std::vector<int64_t> begin;
+    std::vector<int64_t> end;
+    std::vector<int64_t> strides;
+    if (ellipsis_mask != 0 || new_axis_mask != 0 ||
+        !Evaluate(node.input(0), &input) || input.is_scalar ||
+        !EvaluateKnown(node.input(1), &begin) || begin.size() != 1 ||
+        !EvaluateKnown(node.input(2), &end) || end.size() != 1 ||
+        !EvaluateKnown(node.input(3), &strides) || strides.size() != 1 ||
+        strides[0] == 0) {
+      return false;
+    }
+    const int64_t size = input.elements.size();
+    if (shrink_axis_mask & 1) {
+      const int64_t index = begin[0] < 0 ? begin[0] + size : begin[0];
+      if (index < 0 || index >= size) {
+        return false;
+      }
+      value->is_scalar = true;
+      value->elements.push_back(input.elements[index]);
+      return true;
+    }
+    // Canonicalize the bounds the same way as ValidateStridedSliceOp().
+    const int64_t stride = strides[0];
+    const int64_t lower = stride > 0 ? 0 : -1;
+    const int64_t upper = stride > 0 ? size : size - 1;
+    auto canonicalize = [&](int64_t bound, bool masked, bool is_begin) {
+      if (masked) {
+        return (stride > 0) == is_begin ? lower : upper;
+      }
+      const int64_t index = bound < 0 ? bound + size : bound;
+      return std::min(std::max(index, lower), upper);
+    };
+    const int64_t start = canonicalize(begin[0], begin_mask & 1, true);
+    const int64_t stop = canonicalize(end[0], end_mask & 1, false);
+    for (int64_t i = start; stride > 0 ? i < stop : i > stop; i += stride) {
+      value->elements.push_back(input.elements[i]);
+    }
+    return true;
+  }
+
+  bool EvaluateSlice(const NodeDef& node, ShapeValue* value) {
+    ShapeValue input;
+    std::vector<int64_t> begin;
+    std::vector<int64_t> size;
+    if (!Evaluate(node.input(0), &input) || input.is_scalar ||
+        !EvaluateKnown(node.input(1), &begin) || begin.size() != 1 ||
+        !EvaluateKnown(node.input(2), &size) || size.size() != 1) {
+      return false;
+    }
+    const int64_t num_elements = input.elements.size();
+    const int64_t end = size[0] == -1 ? num_elements : begin[0] + size[0];
+    if (begin[0] < 0 || end < begin[0] || end > num_elements) {
+      return false;
+    }
+    value->elements.assign(input.elements.begin() + begin[0],
+                           input.elements.begin() + end);
+    return true;
+  }
+
+  bool EvaluateGather(const NodeDef& node, ShapeValue* value) {
+    int batch_dims = 0;
+    GetNodeAttr(node, "batch_dims", &batch_dims).IgnoreError();
+    ShapeValue params;
+    ShapeValue indices;
+    std::vector<int64_t> axis;
+    if (batch_dims != 0 || !Evaluate(node.input(0), &params) ||
+        params.is_scalar || !Evaluate(node.input(1), &indices) ||
+        !EvaluateKnown(node.input(2), &axis) || axis.size() != 1 ||
+        (axis[0] != 0 && axis[0] != -1)) {
+      return false;
+    }
+    value->is_scalar = indices.is_scalar;
+    for (const ShapeElement& index : indices.elements) {
+      if (!index.known() || index.value < 0 ||
+          index.value >= static_cast<int64_t>(params.elements.size())) {
+        return false;
+      }
+      value->elements.push_back(params.elements[index.value]);
+    }
+    return true;
+  }
+
+  bool EvaluateReshape(const NodeDef& node, ShapeValue* value) {
+    const std::vector<OpInfo::TensorProperties>& output =
+        properties_.GetOutputProperties(node.name());
+    if (output.empty() || output[0].shape().unknown_rank() ||
+        output[0].shape().dim_size() > 1 || !Evaluate(node.input(0), value)) {
+      return false;
+    }
+    value->is_scalar = output[0].shape().dim_size() == 0;
+    return !value->is_scalar || value->elements.size() == 1;
+  }
+
+  bool EvaluateBinaryOp(const NodeDef& node, ShapeValue* value) {
+    ShapeValue x;
+    ShapeValue y;
+    if (!Evaluate(node.input(0), &x) || !Evaluate(node.input(1), &y)) {
+      return false;
+    }
+    if (!x.is_scalar && !y.is_scalar &&
+        x.elements.size() != y.elements.size()) {
+      return false;
+    }
+    value->is_scalar = x.is_scalar && y.is_scalar;
+    const size_t size = std::max(x.elements.size(), y.elements.size());
+    for (size_t i = 0; i < size; ++i) {
+      ShapeElement result;
+      if (!EvaluateBinaryOp(node.op(), x.elements[x.is_scalar ? 0 : i],
+                            y.elements[y.is_scalar ? 0 : i], &result)) {
+        return false;
+      }
+      value->elements.push_back(result);
+    }
+    return true;
+  }
+
+  static bool EvaluateBinaryOp(const string& op, const ShapeElement& x,
+                               const ShapeElement& y, ShapeElement* result) {
+    if (x.known() && y.known()) {
+      if (op == "Add" || op == "AddV2") {
+        result->value = x.value + y.value;
+      } else if (op == "Sub") {
+        result->value = x.value - y.value;
+      } else if (op == "Mul") {
+        result->value = x.value * y.value;
+      } else if (op == "FloorDiv") {
+        if (y.value == 0) {
+          return false;
+        }
+        result->value = x.value / y.value;
+        if ((x.value % y.value != 0) && ((x.value < 0) != (y.value < 0))) {
+          --result->value;
+        }
+      } else if (op == "Maximum") {
+        result->value = std::max(x.value, y.value);
+      } else if (op == "Minimum") {
+        result->value = std::min(x.value, y.value);
+      } else {
+        return false;
+      }
+      return true;
+    }
+    // Only simplifications that keep the size of a dimension as is.
+    auto is = [](const ShapeElement& element, int64_t value) {
+      return element.known() && element.value == value;
+    };
+    if (((op == "Add" || op == "AddV2") && is(x, 0)) ||
+        (op == "Mul" && is(x, 1))) {
+      *result = y;
+    } else if (((op == "Add" || op == "AddV2" || op == "Sub") && is(y, 0)) ||
+               ((op == "Mul" || op == "FloorDiv") && is(y, 1)) ||
+               ((op == "Maximum" || op == "Minimum") && x == y)) {
+      *result = x;
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  const NodeMap& node_map_;
+  const GraphProperties& properties_;
+  const absl::flat_hash_set<string>& feed_nodes_;
+  const std::function<bool(const string&, Tensor*)> get_constant_;
+  const int max_ops_;
+  const NodeDef* root_ = nullptr;
+  int num_ops_ = 0;
+  absl::flat_hash_map<const NodeDef*, ShapeValue> values_;
+  absl::flat_hash_set<const NodeDef*> invalid_;
+  std::set<const NodeDef*> shape_nodes_;
+};
+
+}  // namespace
+
+absl::Status ConstantFolding::MaterializePartiallyKnownShapes(
+    const GraphProperties& properties) {
+  // Bound the size of the chains we look at to keep the cost of the pass
+  // linear in practice.
+  constexpr int kMaxShapeChainSize = 64;
+
+  const int node_count = graph_->node_size();
+  for (int node_idx = 0; node_idx < node_count; ++node_idx) {
+    NodeDef* node = graph_->mutable_node(node_idx);
+    if (!IsShapeArithmetic(*node) || nodes_to_preserve_.count(node->name()) ||
+        feed_nodes_.contains(node->name())) {
+      continue;
+    }
+    const std::vector<OpInfo::TensorProperties>& output =
+        properties.GetOutputProperties(node->name());
+    if (output.empty() ||
+        (output[0].dtype() != DT_INT32 && output[0].dtype() != DT_INT64)) {
+      continue;
+    }
+    const DataType type = output[0].dtype();
+
+    // Only rewrite the last node of a chain, i.e. the one whose value is
+    // consumed by something else than more shape arithmetic.
+    bool feeds_other_ops = false;
+    for (const NodeDef* fanout : node_map_->GetOutputs(node->name())) {
+      feeds_other_ops |= !IsShapeArithmetic(*fanout);
+    }
+    if (!feeds_other_ops) {
+      continue;
+    }
+
+    ShapeArithmeticEvaluator evaluator(
+        *node_map_, properties, feed_nodes_,
+        [this](const string& name, Tensor* tensor) {
+          return GetTensorFromConstNode(name, tensor);
+        },
+        kMaxShapeChainSize);
+    ShapeValue value;
+    if (!evaluator.EvaluateNode(*node, &value) ||
+        evaluator.shape_nodes().empty()) {
+      continue;
+    }
+
+    // Sort the Shape ops by name to make the rewrite deterministic, and read
+    // dimensions that shape inference proved equal from the same one.
+    std::vector<const NodeDef*> shape_nodes(evaluator.shape_nodes().begin(),
+                                            evaluator.shape_nodes().end());
+    std::sort(shape_nodes.begin(), shape_nodes.end(),
+              [](const NodeDef* a, const NodeDef* b) {
+                return a->name() < b->name();
+              });
+    absl::flat_hash_map<int64_t, ShapeElement> symbolic_dims;
+    for (const NodeDef* shape_node : shape_nodes) {
+      const TensorShapeProto& shape =
+          properties.GetInputProperties(shape_node->name())[0].shape();
+      for (int i = 0; i < shape.dim_size(); ++i) {
+        ShapeElement element;
+        element.shape_node = shape_node;
+        element.dim = i;
+        if (shape.dim(i).size() < -1) {
+          symbolic_dims.emplace(shape.dim(i).size(), element);
+        }
+      }
+    }
+    std::vector<const NodeDef*> sources;
+    bool has_known_values = false;
+    for (ShapeElement& element : value.elements) {
+      if (element.known()) {
+        has_known_values = true;
+        continue;
+      }
+      const int64_t size = properties.GetInputProperties(
+          element.shape_node->name())[0].shape().dim(element.dim).size();
+      if (size < -1) {
+        element = symbolic_dims.at(size);
+      }
+      if (std::find(sources.begin(), sources.end(), element.shape_node) ==
+          sources.end()) {
+        sources.push_back(element.shape_node);
+      }
+    }
+    std::sort(sources.begin(), sources.end(),
+              [](const NodeDef* a, const NodeDef* b) {
+                return a->name() < b->name();
+              });
+    bool valid_sources = true;
+    for (const NodeDef* source : sources) {
+      DataType source_type;
+      valid_sources &= GetNodeAttr(*source, "out_type", &source_type).ok() &&
+                       source_type == type;
+    }
+    if (!valid_sources) {
+      continue;
+    }
+
+    // Element i of the concatenation of the sources that holds each symbolic
+    // element of the value.
+    const int num_elements = value.elements.size();
+    const TensorShape value_shape =
+        value.is_scalar ? TensorShape({}) : TensorShape({num_elements});
+    Tensor indices(DT_INT32, value_shape);
+    Tensor mask(DT_BOOL, value_shape);
+    Tensor known_values(type, value_shape);
+    int num_source_dims = 0;
+    for (const NodeDef* source : sources) {
+      num_source_dims +=
+          properties.GetInputProperties(source->name())[0].shape().dim_size();
+    }
+    bool is_whole_source = !value.is_scalar && num_elements == num_source_dims;
+    for (int i = 0; i < num_elements; ++i) {
+      const ShapeElement& element = value.elements[i];
+      int index = 0;
+      if (!element.known()) {
+        for (const NodeDef* source : sources) {
+          if (source == element.shape_node) {
+            break;
+          }
+          index += properties.GetInputProperties(source->name())[0]
+                       .shape()
+                       .dim_size();
+        }
+        index += element.dim;
+      }
+      is_whole_source &= !element.known() && index == i;
+      indices.flat<int32>()(i) = index;
+      mask.flat<bool>()(i) = !element.known();
+      if (type == DT_INT32) {
+        known_values.flat<int32>()(i) = static_cast<int32>(element.value);
+      } else {
+        known_values.flat<int64_t>()(i) = element.value;
+      }
+    }
+
+    // Only rewrite if the chain gets shorter.
+    const bool needs_concat = sources.size() > 1;
+    const bool needs_gather = !sources.empty() && !is_whole_source;
+    const bool needs_select = !sources.empty() && has_known_values;
+    int num_new_ops = needs_concat + needs_gather + needs_select;
+    if (!sources.empty()) {
+      num_new_ops = std::max(num_new_ops, 1);
+    }
+    if (evaluator.num_ops() <= num_new_ops ||
+        OptimizedNodeExists(*node, "-partial-shape-indices") ||
+        OptimizedNodeExists(*node, "-partial-shape-values")) {
+      continue;
+    }
+    VLOG(1) << "Rewriting the shape arithmetic computing " << node->name()
+            << " out of " << evaluator.num_ops() << " ops into "
+            << num_new_ops;
+
+    auto add_input = [&](NodeDef* consumer, const string& input) {
+      *consumer->add_input() = input;
+      node_map_->AddOutput(NodeName(input), consumer->name());
+    };
+    // Anchor the new constants on the Shape ops to make sure they only run
+    // when the chain would have, and in the same frame.
+    auto add_node = [&](const string& suffix, const string& op) {
+      NodeDef* added_node = graph_->add_node();
+      added_node->set_name(OptimizedNodeName(*node, suffix));
+      added_node->set_op(op);
+      added_node->set_device(node->device());
+      node_map_->AddNode(added_node->name(), added_node);
+      return added_node;
+    };
+    auto add_const = [&](const string& suffix, const Tensor& tensor) {
+      NodeDef* added_node = add_node(suffix, "Const");
+      (*added_node->mutable_attr())["dtype"].set_type(tensor.dtype());
+      tensor.AsProtoTensorContent(
+          (*added_node->mutable_attr())["value"].mutable_tensor());
+      add_input(added_node, AsControlDependency(*shape_nodes.front()));
+      return added_node->name();
+    };
+
+    // Turn the node into the last op of the new chain, keeping its control
+    // dependencies.
+    std::vector<string> control_inputs;
+    for (const string& input : node->input()) {
+      node_map_->RemoveOutput(NodeName(input), node->name());
+      if (IsControlInput(input)) {
+        control_inputs.push_back(input);
+      }
+    }
+    node->clear_input();
+    EraseRegularNodeAttributes(node);
+    graph_modified_ = true;
+
+    if (sources.empty()) {
+      // The value is fully known.
+      node->set_op("Const");
+      (*node->mutable_attr())["dtype"].set_type(type);
+      known_values.AsProtoTensorContent(
+          (*node->mutable_attr())["value"].mutable_tensor());
+      for (const NodeDef* shape_node : shape_nodes) {
+        add_input(node, AsControlDependency(*shape_node));
+      }
+      for (const string& control_input : control_inputs) {
+        add_input(node, control_input);
+      }
+      continue;
+    }
+
+    string source = sources.front()->name();
+    string axis;
+    if (needs_concat || needs_gather) {
+      Tensor axis_value(DT_INT32, TensorShape({}));
+      axis_value.scalar<int32>()() = 0;
+      axis = add_const("-partial-shape-axis", axis_value);
+    }
+    if (needs_concat) {
+      NodeDef* concat = add_node("-partial-shape-source", "ConcatV2");
+      for (const NodeDef* shape_node : sources) {
+        add_input(concat, shape_node->name());
+      }
+      add_input(concat, axis);
+      (*concat->mutable_attr())["N"].set_i(sources.size());
+      (*concat->mutable_attr())["T"].set_type(type);
+      (*concat->mutable_attr())["Tidx"].set_type(DT_INT32);
+      source = concat->name();
+    }
+    string symbolic_values = source;
+    if (needs_gather) {
+      NodeDef* gather =
+          needs_select ? add_node("-partial-shape-gather", "GatherV2") : node;
+      gather->set_op("GatherV2");
+      add_input(gather, source);
+      add_input(gather, add_const("-partial-shape-indices", indices));
+      add_input(gather, axis);
+      (*gather->mutable_attr())["Tparams"].set_type(type);
+      (*gather->mutable_attr())["Tindices"].set_type(DT_INT32);
+      (*gather->mutable_attr())["Taxis"].set_type(DT_INT32);
+      (*gather->mutable_attr())["batch_dims"].set_i(0);
+      symbolic_values = gather->name();
+    }
+    if (needs_select) {
+      node->set_op("SelectV2");
+      add_input(node, add_const("-partial-shape-mask", mask));
+      add_input(node, symbolic_values);
+      add_input(node, add_const("-partial-shape-values", known_values));
+      (*node->mutable_attr())["T"].set_type(type);
+    } else if (!needs_gather) {
+      node->set_op("Identity");
+      add_input(node, source);
+      (*node->mutable_attr())["T"].set_type(type);
+    }
+    for (const string& control_input : control_inputs) {
+      add_input(node, control_input);
+    }
+  }
+  return absl::OkStatus();
+}
+
 namespace {
 bool ExtractShape(const NodeDef& shape_node, const GraphProperties& properties,
                   BCast::Vec* shape, int64_t* min_id) {
@@ -4050,6 +4726,7 @@ absl::Status ConstantFolding::RunOptimizationPass(Cluster* cluster,
   if (properties->has_properties()) {
     TF_RETURN_IF_ERROR(MaterializeShapes(*properties));
     TF_RETURN_IF_ERROR(MaterializeConstants(*properties));
+    TF_RETURN_IF_ERROR(MaterializePartiallyKnownShapes(*properties));
     TF_RETURN_IF_ERROR(
         FoldGraph(*properties, optimized_graph, &nodes_to_not_simplify));
   } else {
@@ -82,6 +82,11 @@ class ConstantFolding : public GraphOptimizer {
   absl::Status MaterializeOutputValues(NodeDef* node,
                                        const GraphProperties& properties);
   absl::Status MaterializeConstants(const GraphProperties& properties);
+  // Rewrites chains of shape arithmetic whose value is known except for some
+  // symbolic dimensions, like the batch size, to gather these dimensions from
+  // the Shape ops the chain starts from.
+  absl::Status MaterializePartiallyKnownShapes(
+      const GraphProperties& properties);
 
   bool IsFoldable(const NodeDef& node, const GraphProperties* properties);
   bool IsFoldableUncached(const NodeDef& node,
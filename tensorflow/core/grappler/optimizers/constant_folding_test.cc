@@ -1648,6 +1648,63 @@ TEST_F(ConstantFoldingTest, ShapeMaterializationEmptyFetch) {
   test::ExpectTensorEqual<int>(tensors_expected[0], tensors[0]);
 }
 
+TEST_F(ConstantFoldingTest, PartiallyKnownShapeMaterialization) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output x = ops::Placeholder(
+      s.WithOpName("x"), DT_FLOAT,
+      ops::Placeholder::Shape(PartialTensorShape({-1, -1, 16})));
+  Output shape = ops::Shape(s.WithOpName("shape"), x);
+  auto slice = [&](const string& name, int dim) {
+    return ops::StridedSlice(s.WithOpName(name), shape, {dim}, {dim + 1}, {1},
+                             ops::StridedSlice::ShrinkAxisMask(1));
+  };
+  Output batch = slice("batch", 0);
+  Output time = slice("time", 1);
+  Output depth = ops::Mul(s.WithOpName("depth"), slice("features", 2), 2);
+  Output target = ops::Stack(s.WithOpName("target"), {batch, time, depth});
+  Output tiled = ops::Tile(s.WithOpName("tiled"), x, {1, 1, 2});
+  Output reshape = ops::Reshape(s.WithOpName("reshape"), tiled, target);
+
+  GrapplerItem item;
+  item.fetch = {"reshape"};
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+
+  ConstantFolding optimizer(/*cpu_device=*/nullptr);
+  GraphDef output;
+  TF_EXPECT_OK(optimizer.Optimize(/*cluster=*/nullptr, item, &output));
+
+  int found = 0;
+  for (const auto& node : output.node()) {
+    if (node.name() == "target") {
+      ++found;
+      // Only the symbolic batch and time dimensions are read from the shape.
+      EXPECT_EQ("SelectV2", node.op());
+      ASSERT_EQ(3, node.input_size());
+      EXPECT_EQ("ConstantFolding/target-partial-shape-gather", node.input(1));
+    } else if (node.name() == "ConstantFolding/target-partial-shape-gather") {
+      ++found;
+      EXPECT_EQ("GatherV2", node.op());
+      ASSERT_EQ(3, node.input_size());
+      EXPECT_EQ("shape", node.input(0));
+    } else if (node.name() == "ConstantFolding/target-partial-shape-values") {
+      ++found;
+      Tensor value;
+      CHECK(value.FromProto(node.attr().at("value").tensor()));
+      test::ExpectTensorEqual<int>(test::AsTensor<int>({0, 0, 32}), value);
+    } else if (node.name() == "reshape") {
+      ++found;
+      EXPECT_EQ("target", node.input(1));
+    }
+  }
+  EXPECT_EQ(4, found);
+
+  auto x_t = GenerateRandomTensor<DT_FLOAT>(TensorShape({3, 5, 16}));
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, {{"x", x_t}});
+  auto tensors = EvaluateNodes(output, item.fetch, {{"x", x_t}});
+  ASSERT_EQ(1, tensors.size());
+  test::ExpectTensorEqual<float>(tensors_expected[0], tensors[0]);
+}
+
 TEST_F(ConstantFoldingTest, ShapeMaterializationShapeN) {
   tensorflow::Scope scope = tensorflow::Scope::NewRootScope();
   Output v1 = ops::Variable(scope.WithOpName("v1"), {3, -1}, DT_FLOAT);
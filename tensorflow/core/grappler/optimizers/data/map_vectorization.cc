@@ -0,0 +1,252 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/attr_value.pb.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/tensor_shape.pb.h"
+#include "tensorflow/core/grappler/clusters/cluster.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/mutable_graph_view.h"
+#include "tensorflow/core/grappler/optimizers/custom_graph_optimizer_registry.h"
+#include "tensorflow/core/grappler/optimizers/data/function_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/grappler/utils.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+constexpr char kBatchDataset[] = "BatchDataset";
+constexpr char kBatchDatasetV2[] = "BatchDatasetV2";
+constexpr char kMapDataset[] = "MapDataset";
+constexpr char kParallelMapDataset[] = "ParallelMapDataset";
+constexpr char kParallelMapDatasetV2[] = "ParallelMapDatasetV2";
+constexpr char kOutputShapes[] = "output_shapes";
+constexpr char kOutputTypes[] = "output_types";
+
+// Ops that compute each element of their output from the elements at the same
+// position in their inputs. Binary ops broadcast scalars.
+const auto* kUnaryElementwiseOps = new absl::flat_hash_set<string>{
+    "Abs", "Cast", "Ceil", "Cos", "Erf", "Exp", "Floor", "Identity",
+    "Log", "Log1p", "Neg", "Reciprocal", "Relu", "Relu6", "Round", "Rsqrt",
+    "Sigmoid", "Sign", "Sin", "Sqrt", "Square", "Tanh"};
+const auto* kBinaryElementwiseOps = new absl::flat_hash_set<string>{
+    "Add", "AddV2", "Div", "DivNoNan", "FloorDiv", "FloorMod", "Maximum",
+    "Minimum", "Mul", "Pow", "RealDiv", "SquaredDifference", "Sub"};
+
+// Marks values that are computed from scalar constants only.
+constexpr int kScalarConstant = -1;
+
+bool IsScalarConst(const NodeDef& node) {
+  if (node.op() != "Const") return false;
+  const auto* value = gtl::FindOrNull(node.attr(), "value");
+  return value != nullptr && value->tensor().tensor_shape().dim_size() == 0;
+}
+
+// Returns the name of the function argument or node that produces `input`,
+// which is in the `FunctionDef` input format.
+absl::string_view InputSource(absl::string_view input) {
+  return input.substr(0, input.find(':'));
+}
+
+// Returns true if every output of `function` is computed by element-wise ops
+// from a single one of its arguments and scalar constants. Applying such a
+// function to stacked arguments then yields the stack of its per-element
+// outputs, because every intermediate value has the shape of the argument it
+// is computed from.
+bool IsVectorizable(const FunctionDef& function) {
+  // Maps each argument and node to the index of the argument it is computed
+  // from, or to `kScalarConstant`.
+  absl::flat_hash_map<string, int> origins;
+  for (int i = 0; i < function.signature().input_arg_size(); ++i) {
+    origins[function.signature().input_arg(i).name()] = i;
+  }
+  // Resolves the nodes in dependency order, since the nodes of a function are
+  // not sorted.
+  std::vector<const NodeDef*> pending;
+  for (const NodeDef& node : function.node_def()) {
+    if (IsScalarConst(node)) {
+      origins[node.name()] = kScalarConstant;
+    } else if (kUnaryElementwiseOps->contains(node.op()) ||
+               kBinaryElementwiseOps->contains(node.op())) {
+      pending.push_back(&node);
+    } else {
+      return false;
+    }
+  }
+  while (!pending.empty()) {
+    std::vector<const NodeDef*> unresolved;
+    for (const NodeDef* node : pending) {
+      int origin = kScalarConstant;
+      int num_data_inputs = 0;
+      bool resolved = true;
+      for (const string& input : node->input()) {
+        if (IsControlInput(input)) continue;
+        ++num_data_inputs;
+        auto it = origins.find(InputSource(input));
+        if (it == origins.end()) {
+          resolved = false;
+          break;
+        }
+        if (it->second == kScalarConstant) continue;
+        if (origin != kScalarConstant && origin != it->second) {
+          // Combining two arguments may broadcast them against each other.
+          return false;
+        }
+        origin = it->second;
+      }
+      if (!resolved) {
+        unresolved.push_back(node);
+        continue;
+      }
+      const int expected_inputs =
+          kBinaryElementwiseOps->contains(node->op()) ? 2 : 1;
+      if (num_data_inputs != expected_inputs) return false;
+      origins[node->name()] = origin;
+    }
+    // Gives up on cycles and inputs that do not exist.
+    if (unresolved.size() == pending.size()) return false;
+    pending = std::move(unresolved);
+  }
+  // Every output must carry the leading dimension of an argument.
+  for (const auto& ret : function.ret()) {
+    auto it = origins.find(InputSource(ret.second));
+    if (it == origins.end() || it->second == kScalarConstant) return false;
+  }
+  return true;
+}
+
+bool IsMap(const NodeDef& node) {
+  return node.op() == kMapDataset || node.op() == kParallelMapDataset ||
+         node.op() == kParallelMapDatasetV2;
+}
+
+// Returns the output shapes of batching the elements of `input_node`.
+AttrValue BatchedShapes(const NodeDef& input_node, int num_components) {
+  AttrValue shapes;
+  auto* list = shapes.mutable_list();
+  const auto* input_shapes = gtl::FindOrNull(input_node.attr(), kOutputShapes);
+  if (input_shapes == nullptr ||
+      input_shapes->list().shape_size() != num_components) {
+    for (int i = 0; i < num_components; ++i) {
+      list->add_shape()->set_unknown_rank(true);
+    }
+    return shapes;
+  }
+  for (const TensorShapeProto& input_shape : input_shapes->list().shape()) {
+    TensorShapeProto* shape = list->add_shape();
+    if (input_shape.unknown_rank()) {
+      shape->set_unknown_rank(true);
+      continue;
+    }
+    shape->add_dim()->set_size(-1);
+    for (const auto& dim : input_shape.dim()) {
+      *shape->add_dim() = dim;
+    }
+  }
+  return shapes;
+}
+
+}  // namespace
+
+Status MapVectorization::OptimizeAndCollectStats(Cluster* cluster,
+                                                 const GrapplerItem& item,
+                                                 GraphDef* output,
+                                                 OptimizationStats* stats) {
+  *output = item.graph;
+  MutableGraphView graph(output);
+  absl::flat_hash_set<string> nodes_to_delete;
+  FunctionLibraryDefinition function_library(OpRegistry::Global(),
+                                             item.graph.library());
+
+  for (const NodeDef& node : item.graph.node()) {
+    if (node.op() != kBatchDataset && node.op() != kBatchDatasetV2) continue;
+    const NodeDef& batch_node = node;
+    NodeDef* map_node = graph_utils::GetInputNode(batch_node, graph);
+    if (map_node == nullptr || !IsMap(*map_node) ||
+        nodes_to_delete.contains(map_node->name())) {
+      continue;
+    }
+    // The map is removed, so it must not have other consumers.
+    if (graph.GetFanouts(*map_node, /*include_controlled_nodes=*/true).size() !=
+        1) {
+      continue;
+    }
+    // Captured inputs are not batched, so they could not be combined with the
+    // batched arguments element-wise.
+    if (map_node->attr().at("Targuments").list().type_size() != 0) continue;
+
+    const FunctionDef* function =
+        function_library.Find(map_node->attr().at("f").func().name());
+    if (function == nullptr ||
+        function_utils::IsFunctionStateful(function_library, *function,
+                                           /*skip_assert=*/true) ||
+        !IsVectorizable(*function)) {
+      continue;
+    }
+
+    NodeDef* input_node = graph_utils::GetInputNode(*map_node, graph);
+    DataTypeVector input_types;
+    if (input_node == nullptr ||
+        !graph_utils::GetDatasetOutputTypesAttr(*input_node, &input_types)
+             .ok() ||
+        input_types.size() != function->signature().input_arg_size()) {
+      continue;
+    }
+
+    NodeDef new_batch_node = batch_node;
+    graph_utils::SetUniqueGraphNodeName(batch_node.op(), graph.graph(),
+                                        &new_batch_node);
+    new_batch_node.set_input(0, map_node->input(0));
+    AddNodeAttr(kOutputTypes, input_types, &new_batch_node);
+    (*new_batch_node.mutable_attr())[kOutputShapes] =
+        BatchedShapes(*input_node, input_types.size());
+    NodeDef* new_batch = graph.AddNode(std::move(new_batch_node));
+
+    NodeDef new_map_node = *map_node;
+    graph_utils::SetUniqueGraphNodeName(map_node->op(), graph.graph(),
+                                        &new_map_node);
+    new_map_node.set_input(0, new_batch->name());
+    graph_utils::CopyShapesAndTypesAttrs(batch_node, &new_map_node);
+    graph_utils::MaybeSetFusedMetadata(*map_node, batch_node, &new_map_node);
+    NodeDef* new_map = graph.AddNode(std::move(new_map_node));
+
+    TF_RETURN_IF_ERROR(graph.UpdateFanouts(batch_node.name(), new_map->name()));
+    nodes_to_delete.insert(map_node->name());
+    nodes_to_delete.insert(batch_node.name());
+    stats->num_changes++;
+  }
+
+  TF_RETURN_IF_ERROR(graph.DeleteNodes(nodes_to_delete));
+  return absl::OkStatus();
+}
+
+REGISTER_GRAPH_OPTIMIZER_AS(MapVectorization, "map_vectorization");
+
+}  // namespace grappler
+}  // namespace tensorflow
@@ -0,0 +1,128 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+
+#include "tensorflow/core/grappler/optimizers/data/map_vectorization.h"
+
+#include <vector>
+
+#include "tensorflow/core/framework/attr_value_util.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/grappler/grappler_item.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_test_utils.h"
+#include "tensorflow/core/grappler/optimizers/data/graph_utils.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+using graph_tests_utils::MakeBatchV2Node;
+using graph_tests_utils::MakeMapNode;
+using test::function::NDef;
+
+// Returns a graph that batches the output of the map `map_node`.
+GrapplerItem MakeItem(const NodeDef& map_node,
+                      const std::vector<FunctionDef>& functions) {
+  const std::vector<TensorShape> shapes = {TensorShape({})};
+  const DataTypeVector types = {DT_INT64};
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("start", "Const", {}, {{"value", 0}, {"dtype", DT_INT64}}),
+       NDef("stop", "Const", {}, {{"value", 10}, {"dtype", DT_INT64}}),
+       NDef("step", "Const", {}, {{"value", 1}, {"dtype", DT_INT64}}),
+       NDef("range", "RangeDataset", {"start", "stop", "step"},
+            {{"output_shapes", absl::Span<const TensorShape>(shapes)},
+             {"output_types", absl::Span<const DataType>(types)}}),
+       map_node,
+       NDef("batch_size", "Const", {}, {{"value", 4}, {"dtype", DT_INT64}}),
+       NDef("drop_remainder", "Const", {},
+            {{"value", false}, {"dtype", DT_BOOL}}),
+       MakeBatchV2Node("batch", "map", "batch_size", "drop_remainder",
+                       /*parallel_copy=*/false),
+       NDef("Sink", "Identity", {"batch"}, {})},
+      functions);
+  item.fetch.push_back("Sink");
+  return item;
+}
+
+TEST(MapVectorizationTest, VectorizesElementwiseFunction) {
+  GrapplerItem item =
+      MakeItem(MakeMapNode("map", "range", "XTimesTwo"),
+               {test::function::XTimesTwo()});
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_FALSE(graph_utils::ContainsGraphNodeWithName("batch", output));
+  const NodeDef& sink =
+      output.node(graph_utils::FindGraphNodeWithName("Sink", output));
+  const NodeDef& new_map =
+      output.node(graph_utils::FindGraphNodeWithName(sink.input(0), output));
+  EXPECT_EQ(new_map.op(), "MapDataset");
+  EXPECT_EQ(new_map.attr().at("f").func().name(), "XTimesTwo");
+  const NodeDef& new_batch =
+      output.node(graph_utils::FindGraphNodeWithName(new_map.input(0), output));
+  EXPECT_EQ(new_batch.op(), "BatchDatasetV2");
+  EXPECT_EQ(new_batch.input(0), "range");
+  EXPECT_EQ(new_batch.input(1), "batch_size");
+  EXPECT_EQ(new_batch.input(2), "drop_remainder");
+  ASSERT_EQ(new_batch.attr().at("output_types").list().type_size(), 1);
+  EXPECT_EQ(new_batch.attr().at("output_types").list().type(0), DT_INT64);
+  ASSERT_EQ(new_batch.attr().at("output_shapes").list().shape_size(), 1);
+  EXPECT_EQ(new_batch.attr().at("output_shapes").list().shape(0).dim_size(),
+            1);
+}
+
+TEST(MapVectorizationTest, SkipsStatefulFunction) {
+  GrapplerItem item =
+      MakeItem(MakeMapNode("map", "range", "RandomUniformFn"),
+               {test::function::RandomUniform()});
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+}
+
+TEST(MapVectorizationTest, SkipsNonElementwiseFunction) {
+  GrapplerItem item = MakeItem(MakeMapNode("map", "range", "IsZero"),
+                               {test::function::IsZero()});
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+}
+
+TEST(MapVectorizationTest, SkipsMapWithOtherConsumers) {
+  GrapplerItem item =
+      MakeItem(MakeMapNode("map", "range", "XTimesTwo"),
+               {test::function::XTimesTwo()});
+  *item.graph.add_node() = NDef("other_sink", "Identity", {"map"}, {});
+  MapVectorization optimizer;
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("map", output));
+  EXPECT_TRUE(graph_utils::ContainsGraphNodeWithName("batch", output));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -17,18 +17,25 @@ limitations under the License.
 
 #include <algorithm>
 #include <deque>
+#include <functional>
 #include <limits>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include "absl/algorithm/container.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/full_type.pb.h"
+#include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/framework/node_def_util.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/types.h"
@@ -39,6 +46,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/constant_folding.h"
 #include "tensorflow/core/grappler/optimizers/evaluation_utils.h"
 #include "tensorflow/core/grappler/utils/frame.h"
+#include "tensorflow/core/grappler/utils/functions.h"
 #include "tensorflow/core/grappler/utils/traversal.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
@@ -453,6 +461,372 @@ absl::Status LoopInvariantNodeMotionOptimizer::Optimize() {
   return absl::OkStatus();
 }
 
+// Moves the loop invariant computations out of the bodies of functional While
+// loops, as created by while_v2, into the graph of the loop. The values they
+// compute are passed to the body as new loop variables, which the body returns
+// unchanged.
+//
+// A value is loop invariant if it only depends on loop variables that the body
+// returns unchanged, through ops without side effects. Reads of variables are
+// invariant too, if the only use of resources in the body are reads, so that
+// no op of the body can write the variables.
+class FunctionalLoopInvariantMotion {
+ public:
+  explicit FunctionalLoopInvariantMotion(GraphDef* graph)
+      : graph_(graph), flib_(OpRegistry::Global(), graph->library()) {}
+
+  absl::Status Optimize() {
+    const int num_nodes = graph_->node_size();
+    for (int i = 0; i < num_nodes; ++i) {
+      if (IsWhile(graph_->node(i))) {
+        TF_RETURN_IF_ERROR(HoistInvariants(i));
+      }
+    }
+    return absl::OkStatus();
+  }
+
+ private:
+  // An output of a node of a function body.
+  struct BodyTensor {
+    string node;
+    int index;
+    DataType dtype;
+  };
+
+  // Parses an input of a function body node, in the "node:output:index"
+  // format, into the node and the flat index of the output. Returns false if
+  // the input is a function argument.
+  bool ParseBodyInput(const absl::flat_hash_map<string, const NodeDef*>& nodes,
+                      const string& input, BodyTensor* tensor) const {
+    const std::vector<string> parts = absl::StrSplit(input, ':');
+    auto it = nodes.find(parts[0]);
+    if (parts.size() < 2 || it == nodes.end()) return false;
+    const NodeDef& node = *it->second;
+    const OpDef* op_def = nullptr;
+    NameRangeMap input_ranges;
+    NameRangeMap output_ranges;
+    DataTypeVector input_types;
+    DataTypeVector output_types;
+    if (!flib_.LookUpOpDef(node.op(), &op_def).ok() ||
+        !NameRangesForNode(node, *op_def, &input_ranges, &output_ranges)
+             .ok() ||
+        !InOutTypesForNode(node, *op_def, &input_types, &output_types).ok()) {
+      return false;
+    }
+    auto range = output_ranges.find(parts[1]);
+    int index = 0;
+    if (range == output_ranges.end() ||
+        (parts.size() > 2 && !absl::SimpleAtoi(parts[2], &index)) ||
+        range->second.first + index >= range->second.second) {
+      return false;
+    }
+    tensor->node = node.name();
+    tensor->index = range->second.first + index;
+    tensor->dtype = output_types[tensor->index];
+    return true;
+  }
+
+  // Returns a name for a new argument of `func` that doesn't clash with its
+  // arguments and nodes.
+  static string UniqueArgName(const FunctionDef& func, int id) {
+    absl::flat_hash_set<string> names;
+    for (const auto& arg : func.signature().input_arg()) {
+      names.insert(arg.name());
+    }
+    for (const auto& arg : func.signature().output_arg()) {
+      names.insert(arg.name());
+    }
+    for (const NodeDef& node : func.node_def()) names.insert(node.name());
+    string name = StrCat("loop_invariant_", id);
+    while (names.contains(name)) name = StrCat(name, "_");
+    return name;
+  }
+
+  absl::Status HoistInvariants(int loop_index) {
+    NodeDef* loop = graph_->mutable_node(loop_index);
+    NameAttrList cond_attr;
+    NameAttrList body_attr;
+    DataTypeVector types;
+    if (!GetNodeAttr(*loop, "cond", &cond_attr).ok() ||
+        !GetNodeAttr(*loop, "body", &body_attr).ok() ||
+        !GetNodeAttr(*loop, "T", &types).ok() ||
+        !body_attr.attr().empty() || !cond_attr.attr().empty()) {
+      return absl::OkStatus();
+    }
+    const FunctionDef* body = flib_.Find(body_attr.name());
+    const FunctionDef* cond = flib_.Find(cond_attr.name());
+    if (body == nullptr || cond == nullptr || IsParametrized(*body) ||
+        IsParametrized(*cond) ||
+        body->signature().input_arg_size() != types.size() ||
+        body->signature().output_arg_size() != types.size() ||
+        cond->signature().input_arg_size() != types.size() ||
+        NumNonControlInputs(*loop) != types.size()) {
+      return absl::OkStatus();
+    }
+
+    absl::flat_hash_map<string, const NodeDef*> nodes;
+    for (const NodeDef& node : body->node_def()) {
+      nodes.emplace(node.name(), &node);
+    }
+    absl::flat_hash_map<string, int> args;
+    for (int i = 0; i < body->signature().input_arg_size(); ++i) {
+      args.emplace(body->signature().input_arg(i).name(), i);
+    }
+
+    // Loop variables the body returns unchanged, directly or through
+    // Identity ops.
+    absl::flat_hash_set<string> invariant_args;
+    for (int i = 0; i < body->signature().output_arg_size(); ++i) {
+      auto ret = body->ret().find(body->signature().output_arg(i).name());
+      if (ret == body->ret().end()) continue;
+      string value = ret->second;
+      BodyTensor tensor;
+      while (ParseBodyInput(nodes, value, &tensor) &&
+             IsIdentity(*nodes.at(tensor.node)) &&
+             nodes.at(tensor.node)->input_size() == 1) {
+        value = nodes.at(tensor.node)->input(0);
+      }
+      if (value == body->signature().input_arg(i).name()) {
+        invariant_args.insert(value);
+      }
+    }
+    if (invariant_args.empty()) return absl::OkStatus();
+
+    // Variable reads are invariant if nothing else in the body uses a
+    // resource.
+    bool resources_are_read_only = true;
+    for (const NodeDef& node : body->node_def()) {
+      const OpDef* op_def = nullptr;
+      DataTypeVector input_types;
+      DataTypeVector output_types;
+      if (!flib_.LookUpOpDef(node.op(), &op_def).ok() ||
+          !InOutTypesForNode(node, *op_def, &input_types, &output_types)
+               .ok()) {
+        resources_are_read_only = false;
+        break;
+      }
+      if (!IsReadVariableOp(node) &&
+          absl::c_linear_search(input_types, DT_RESOURCE)) {
+        resources_are_read_only = false;
+        break;
+      }
+    }
+
+    const auto is_invariant_input =
+        [&](const absl::flat_hash_set<string>& invariant_nodes,
+            const string& input) {
+          if (IsControlInput(input)) return false;
+          if (args.contains(input)) return invariant_args.contains(input);
+          BodyTensor tensor;
+          return ParseBodyInput(nodes, input, &tensor) &&
+                 invariant_nodes.contains(tensor.node);
+        };
+    absl::flat_hash_set<string> invariant_nodes;
+    bool changed = true;
+    while (changed) {
+      changed = false;
+      for (const NodeDef& node : body->node_def()) {
+        if (invariant_nodes.contains(node.name())) continue;
+        const bool can_move =
+            flib_.Find(node.op()) == nullptr &&
+            (IsFreeOfSideEffect(node) ||
+             (IsReadVariableOp(node) && resources_are_read_only)) &&
+            !IsControlFlow(node);
+        if (!can_move) continue;
+        bool is_invariant = true;
+        for (const string& input : node.input()) {
+          is_invariant &= is_invariant_input(invariant_nodes, input);
+        }
+        if (is_invariant) {
+          invariant_nodes.insert(node.name());
+          changed = true;
+        }
+      }
+    }
+
+    // Invariant values used by the rest of the body, or returned by it. Moving
+    // a constant or an Identity out of the loop doesn't save anything.
+    std::vector<BodyTensor> hoisted_values;
+    absl::flat_hash_map<string, int> hoisted_value_ids;
+    const auto add_hoisted_value = [&](const string& input) {
+      BodyTensor tensor;
+      if (IsControlInput(input) || !ParseBodyInput(nodes, input, &tensor) ||
+          !invariant_nodes.contains(tensor.node)) {
+        return;
+      }
+      const NodeDef& producer = *nodes.at(tensor.node);
+      if (IsConstant(producer) || IsIdentity(producer) ||
+          tensor.dtype == DT_RESOURCE || tensor.dtype == DT_VARIANT) {
+        return;
+      }
+      const string key = StrCat(tensor.node, ":", tensor.index);
+      if (hoisted_value_ids.emplace(key, hoisted_values.size()).second) {
+        hoisted_values.push_back(tensor);
+      }
+    };
+    for (const NodeDef& node : body->node_def()) {
+      if (invariant_nodes.contains(node.name())) continue;
+      for (const string& input : node.input()) add_hoisted_value(input);
+    }
+    for (const auto& ret : body->ret()) add_hoisted_value(ret.second);
+    if (hoisted_values.empty()) return absl::OkStatus();
+
+    // The invariant nodes the hoisted values depend on, in topological order.
+    std::vector<const NodeDef*> hoisted_nodes;
+    absl::flat_hash_set<string> visited;
+    std::function<void(const string&)> visit = [&](const string& name) {
+      if (!visited.insert(name).second) return;
+      const NodeDef* node = nodes.at(name);
+      for (const string& input : node->input()) {
+        BodyTensor tensor;
+        if (ParseBodyInput(nodes, input, &tensor)) visit(tensor.node);
+      }
+      hoisted_nodes.push_back(node);
+    };
+    for (const BodyTensor& value : hoisted_values) visit(value.node);
+
+    absl::flat_hash_set<string> graph_nodes;
+    for (const NodeDef& node : graph_->node()) graph_nodes.insert(node.name());
+    const auto hoisted_name = [&](const string& name) {
+      return AddPrefixToNodeName(StrCat(loop->name(), "/", name),
+                                 kLoopOptimizer);
+    };
+    for (const NodeDef* node : hoisted_nodes) {
+      if (graph_nodes.contains(hoisted_name(node->name()))) {
+        return absl::OkStatus();
+      }
+    }
+    VLOG(1) << "Moving " << hoisted_nodes.size() << " loop invariant nodes out"
+            << " of the body of " << loop->name();
+
+    // Copy the invariant nodes to the graph of the loop.
+    std::vector<string> loop_inputs;
+    std::vector<string> control_inputs;
+    for (const string& input : loop->input()) {
+      (IsControlInput(input) ? control_inputs : loop_inputs).push_back(input);
+    }
+    for (const NodeDef* node : hoisted_nodes) {
+      NodeDef* hoisted = graph_->add_node();
+      *hoisted = *node;
+      hoisted->set_name(hoisted_name(node->name()));
+      if (hoisted->device().empty()) hoisted->set_device(loop->device());
+      for (string& input : *hoisted->mutable_input()) {
+        BodyTensor tensor;
+        if (ParseBodyInput(nodes, input, &tensor)) {
+          input = tensor.index == 0
+                      ? hoisted_name(tensor.node)
+                      : StrCat(hoisted_name(tensor.node), ":", tensor.index);
+        } else {
+          input = loop_inputs[args.at(input)];
+        }
+      }
+    }
+
+    // Pass the hoisted values to new copies of the body and the condition as
+    // extra loop variables, which the body returns unchanged.
+    FunctionDef new_body = *body;
+    FunctionDef new_cond = *cond;
+    new_body.mutable_signature()->set_name(
+        flib_.UniqueFunctionName(StrCat(body_attr.name(), "_licm_")));
+    new_cond.mutable_signature()->set_name(
+        flib_.UniqueFunctionName(StrCat(cond_attr.name(), "_licm_")));
+    std::vector<string> body_arg_names;
+    for (int id = 0, end = hoisted_values.size(); id < end; ++id) {
+      const BodyTensor& value = hoisted_values[id];
+      const string body_arg = UniqueArgName(new_body, id);
+      OpDef::ArgDef* input_arg = new_body.mutable_signature()->add_input_arg();
+      input_arg->set_name(body_arg);
+      input_arg->set_type(value.dtype);
+      OpDef::ArgDef* output_arg =
+          new_body.mutable_signature()->add_output_arg();
+      *output_arg = *input_arg;
+      output_arg->set_name(StrCat(body_arg, "_output"));
+      (*new_body.mutable_ret())[output_arg->name()] = body_arg;
+      body_arg_names.push_back(body_arg);
+
+      OpDef::ArgDef* cond_arg = new_cond.mutable_signature()->add_input_arg();
+      cond_arg->set_name(UniqueArgName(new_cond, id));
+      cond_arg->set_type(value.dtype);
+
+      loop_inputs.push_back(value.index == 0
+                                ? hoisted_name(value.node)
+                                : StrCat(hoisted_name(value.node), ":",
+                                         value.index));
+      types.push_back(value.dtype);
+    }
+    const auto replace_hoisted_value = [&](string* input) {
+      BodyTensor tensor;
+      if (IsControlInput(*input) || !ParseBodyInput(nodes, *input, &tensor)) {
+        return;
+      }
+      auto it = hoisted_value_ids.find(StrCat(tensor.node, ":", tensor.index));
+      if (it != hoisted_value_ids.end()) *input = body_arg_names[it->second];
+    };
+    for (NodeDef& node : *new_body.mutable_node_def()) {
+      if (invariant_nodes.contains(node.name())) continue;
+      for (string& input : *node.mutable_input()) replace_hoisted_value(&input);
+    }
+    for (auto& ret : *new_body.mutable_ret()) {
+      replace_hoisted_value(&ret.second);
+    }
+
+    // Remove the invariant nodes that are no longer used from the body.
+    changed = true;
+    while (changed) {
+      changed = false;
+      absl::flat_hash_set<string> used;
+      for (const NodeDef& node : new_body.node_def()) {
+        for (const string& input : node.input()) {
+          used.insert(string(absl::StripPrefix(
+              absl::string_view(input).substr(0, input.find(':')), "^")));
+        }
+      }
+      for (const auto& ret : new_body.ret()) {
+        used.insert(ret.second.substr(0, ret.second.find(':')));
+      }
+      for (const auto& control_ret : new_body.control_ret()) {
+        used.insert(control_ret.second);
+      }
+      auto* body_nodes = new_body.mutable_node_def();
+      for (int i = body_nodes->size() - 1; i >= 0; --i) {
+        const string& name = body_nodes->Get(i).name();
+        if (invariant_nodes.contains(name) && !used.contains(name)) {
+          body_nodes->DeleteSubrange(i, 1);
+          changed = true;
+        }
+      }
+    }
+
+    // Update the loop.
+    loop->clear_input();
+    for (const string& input : loop_inputs) loop->add_input(input);
+    for (const string& input : control_inputs) loop->add_input(input);
+    auto* attr = loop->mutable_attr();
+    (*attr)["body"].mutable_func()->set_name(new_body.signature().name());
+    (*attr)["cond"].mutable_func()->set_name(new_cond.signature().name());
+    (*attr)["T"].mutable_list()->clear_type();
+    for (DataType type : types) (*attr)["T"].mutable_list()->add_type(type);
+    auto output_shapes = attr->find("output_shapes");
+    if (output_shapes != attr->end() &&
+        output_shapes->second.list().shape_size() > 0) {
+      for (int i = 0, end = hoisted_values.size(); i < end; ++i) {
+        output_shapes->second.mutable_list()->add_shape()->set_unknown_rank(
+            true);
+      }
+    }
+    attr->erase("_output_shapes");
+
+    TF_RETURN_IF_ERROR(flib_.AddFunctionDef(new_body));
+    TF_RETURN_IF_ERROR(flib_.AddFunctionDef(new_cond));
+    *graph_->mutable_library()->add_function() = std::move(new_body);
+    *graph_->mutable_library()->add_function() = std::move(new_cond);
+    return absl::OkStatus();
+  }
+
+  GraphDef* graph_;  // Not owned.
+  FunctionLibraryDefinition flib_;
+};
+
 std::vector<int> GetStackPushNodesToConvert(
     const GraphTopologyView& graph_view,
     const std::unordered_set<string>& nodes_to_preserve, int stack_node_idx) {
@@ -727,13 +1101,14 @@ LoopOptimizer::LoopOptimizer(RewriterConfig::Toggle opt_level,
                              DeviceBase* cpu_device)
     : opt_level_(opt_level),
       cpu_device_(cpu_device),
-      options_(LoopOptimizerOptions::Default(RewriterConfig::ON)) {
+      options_(LoopOptimizerOptions::Default(opt_level)) {
   resource_mgr_.reset(new ResourceMgr());
 }
 
 absl::Status LoopOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
                                      GraphDef* optimized_graph) {
   if (!options_.enable_loop_invariant_node_motion &&
+      !options_.enable_functional_loop_invariant_motion &&
       !options_.enable_stack_push_removal &&
       !options_.enable_dead_branch_removal) {
     return errors::Aborted("Nothing to do.");
@@ -744,6 +1119,10 @@ absl::Status LoopOptimizer::Optimize(Cluster* cluster, const GrapplerItem& item,
     LoopInvariantNodeMotionOptimizer linm_optimizer(optimized_graph);
     TF_RETURN_IF_ERROR(linm_optimizer.Optimize());
   }
+  if (options_.enable_functional_loop_invariant_motion) {
+    FunctionalLoopInvariantMotion licm_optimizer(optimized_graph);
+    TF_RETURN_IF_ERROR(licm_optimizer.Optimize());
+  }
   if (options_.enable_stack_push_removal) {
     TF_RETURN_IF_ERROR(RemoveStackOps(item.NodesToPreserve(), optimized_graph));
   }
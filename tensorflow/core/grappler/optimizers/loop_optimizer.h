@@ -40,7 +40,9 @@ class LoopOptimizer : public GraphOptimizer {
 
   string name() const override { return "loop_optimizer"; };
 
-  bool UsesFunctionLibrary() const override { return false; }
+  bool UsesFunctionLibrary() const override {
+    return options_.enable_functional_loop_invariant_motion;
+  }
 
   absl::Status Optimize(Cluster* cluster, const GrapplerItem& item,
                         GraphDef* optimized_graph) override;
@@ -51,11 +53,17 @@ class LoopOptimizer : public GraphOptimizer {
   // Granular control for loop optimizer stages.
   struct LoopOptimizerOptions {
     bool enable_loop_invariant_node_motion = false;
+    // Hoisting computations out of functional While loops runs them even if
+    // the loop has no iteration, so it may surface errors the original graph
+    // doesn't have.
+    bool enable_functional_loop_invariant_motion = false;
     bool enable_stack_push_removal = true;
     bool enable_dead_branch_removal = true;
 
     static LoopOptimizerOptions Default(RewriterConfig::Toggle opt_level) {
       LoopOptimizerOptions options;
+      options.enable_functional_loop_invariant_motion =
+          opt_level == RewriterConfig::AGGRESSIVE;
       return options;
     }
   };
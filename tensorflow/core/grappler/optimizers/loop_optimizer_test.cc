@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "tensorflow/cc/ops/standard_ops.h"
 #include "tensorflow/core/framework/full_type.pb.h"
+#include "tensorflow/core/framework/function_testlib.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/grappler/grappler_item.h"
@@ -66,6 +67,11 @@ class LoopOptimizerTest : public GrapplerTest {
     optimizer->options_.enable_loop_invariant_node_motion = true;
   }
 
+  void EnableOnlyFunctionalLoopInvariantMotion(LoopOptimizer* optimizer) {
+    DisableAllStages(optimizer);
+    optimizer->options_.enable_functional_loop_invariant_motion = true;
+  }
+
   void EnableOnlyStackPushRemoval(LoopOptimizer* optimizer) {
     DisableAllStages(optimizer);
     optimizer->options_.enable_stack_push_removal = true;
@@ -1802,5 +1808,153 @@ versions {
   EXPECT_TRUE(found);
 }
 
+TEST_F(LoopOptimizerTest, FunctionalLoopInvariantMotion) {
+  using test::function::NDef;
+  using FDH = FunctionDefHelper;
+
+  // The loop multiplies `x` by Square(a) on every iteration, and returns `a`
+  // unchanged.
+  FunctionDef body = FDH::Create(
+      "Body", {"i: int32", "a: float", "x: float"},
+      {"i_out: int32", "a_out: float", "x_out: float"}, {},
+      {{{"one"},
+        "Const",
+        {},
+        {{"dtype", DT_INT32}, {"value", test::AsScalar<int32>(1)}}},
+       {{"next_i"}, "AddV2", {"i", "one:output:0"}, {{"T", DT_INT32}}},
+       {{"square"}, "Square", {"a"}, {{"T", DT_FLOAT}}},
+       {{"next_x"}, "Mul", {"x", "square:y:0"}, {{"T", DT_FLOAT}}}},
+      {{"i_out", "next_i:z:0"}, {"a_out", "a"}, {"x_out", "next_x:z:0"}});
+  FunctionDef cond = FDH::Create(
+      "Cond", {"i: int32", "a: float", "x: float"}, {"done: bool"}, {},
+      {{{"limit"},
+        "Const",
+        {},
+        {{"dtype", DT_INT32}, {"value", test::AsScalar<int32>(3)}}},
+       {{"less"}, "Less", {"i", "limit:output:0"}, {{"T", DT_INT32}}}},
+      {{"done", "less:z:0"}});
+
+  NameAttrList body_attr;
+  body_attr.set_name("Body");
+  NameAttrList cond_attr;
+  cond_attr.set_name("Cond");
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("i", "Const", {},
+            {{"dtype", DT_INT32}, {"value", test::AsScalar<int32>(0)}}),
+       NDef("a", "Placeholder", {}, {{"dtype", DT_FLOAT}}),
+       NDef("x", "Placeholder", {}, {{"dtype", DT_FLOAT}}),
+       NDef("while", "StatelessWhile", {"i", "a", "x"},
+            {{"T", DataTypeSlice{DT_INT32, DT_FLOAT, DT_FLOAT}},
+             {"body", body_attr},
+             {"cond", cond_attr},
+             {"parallel_iterations", 10}}),
+       NDef("out", "Identity", {"while:2"}, {{"T", DT_FLOAT}})},
+      {body, cond});
+  item.fetch = {"out"};
+  auto a_t = GenerateRandomTensor<DT_FLOAT>(TensorShape({4}));
+  auto x_t = GenerateRandomTensor<DT_FLOAT>(TensorShape({4}));
+  item.feed = {{"a", a_t}, {"x", x_t}};
+
+  LoopOptimizer optimizer;
+  EnableOnlyFunctionalLoopInvariantMotion(&optimizer);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  NodeMap node_map(&output);
+  const NodeDef* square = node_map.GetNode("LoopOptimizer/while/square");
+  ASSERT_NE(square, nullptr);
+  EXPECT_EQ(square->op(), "Square");
+  ASSERT_EQ(square->input_size(), 1);
+  EXPECT_EQ(square->input(0), "a");
+
+  const NodeDef* loop = node_map.GetNode("while");
+  ASSERT_NE(loop, nullptr);
+  ASSERT_EQ(loop->input_size(), 4);
+  EXPECT_EQ(loop->input(3), "LoopOptimizer/while/square");
+  EXPECT_EQ(loop->attr().at("T").list().type_size(), 4);
+
+  const string& new_body_name = loop->attr().at("body").func().name();
+  EXPECT_NE(new_body_name, "Body");
+  const FunctionDef* new_body = nullptr;
+  for (const FunctionDef& func : output.library().function()) {
+    if (func.signature().name() == new_body_name) new_body = &func;
+  }
+  ASSERT_NE(new_body, nullptr);
+  EXPECT_EQ(new_body->signature().input_arg_size(), 4);
+  for (const NodeDef& node : new_body->node_def()) {
+    EXPECT_NE(node.name(), "square");
+    if (node.name() == "next_x") {
+      EXPECT_EQ(node.input(1), "loop_invariant_0");
+    }
+  }
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 1);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 1);
+  test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-6);
+}
+
+TEST_F(LoopOptimizerTest, FunctionalLoopInvariantMotionKeepsStatefulOps) {
+  using test::function::NDef;
+  using FDH = FunctionDefHelper;
+
+  // The random values depend only on the invariant shape, but must be drawn
+  // again on every iteration.
+  FunctionDef body = FDH::Create(
+      "Body", {"i: int32", "shape: int32", "x: float"},
+      {"i_out: int32", "shape_out: int32", "x_out: float"}, {},
+      {{{"one"},
+        "Const",
+        {},
+        {{"dtype", DT_INT32}, {"value", test::AsScalar<int32>(1)}}},
+       {{"next_i"}, "AddV2", {"i", "one:output:0"}, {{"T", DT_INT32}}},
+       {{"noise"},
+        "RandomUniform",
+        {"shape"},
+        {{"T", DT_INT32}, {"dtype", DT_FLOAT}}},
+       {{"next_x"}, "AddV2", {"x", "noise:output:0"}, {{"T", DT_FLOAT}}}},
+      {{"i_out", "next_i:z:0"},
+       {"shape_out", "shape"},
+       {"x_out", "next_x:z:0"}});
+  FunctionDef cond = FDH::Create(
+      "Cond", {"i: int32", "shape: int32", "x: float"}, {"done: bool"}, {},
+      {{{"limit"},
+        "Const",
+        {},
+        {{"dtype", DT_INT32}, {"value", test::AsScalar<int32>(3)}}},
+       {{"less"}, "Less", {"i", "limit:output:0"}, {{"T", DT_INT32}}}},
+      {{"done", "less:z:0"}});
+
+  NameAttrList body_attr;
+  body_attr.set_name("Body");
+  NameAttrList cond_attr;
+  cond_attr.set_name("Cond");
+  GrapplerItem item;
+  item.graph = test::function::GDef(
+      {NDef("i", "Placeholder", {}, {{"dtype", DT_INT32}}),
+       NDef("shape", "Placeholder", {}, {{"dtype", DT_INT32}}),
+       NDef("x", "Placeholder", {}, {{"dtype", DT_FLOAT}}),
+       NDef("while", "While", {"i", "shape", "x"},
+            {{"T", DataTypeSlice{DT_INT32, DT_INT32, DT_FLOAT}},
+             {"body", body_attr},
+             {"cond", cond_attr},
+             {"parallel_iterations", 10}})},
+      {body, cond});
+
+  LoopOptimizer optimizer;
+  EnableOnlyFunctionalLoopInvariantMotion(&optimizer);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  NodeMap node_map(&output);
+  EXPECT_EQ(node_map.GetNode("LoopOptimizer/while/noise"), nullptr);
+  const NodeDef* loop = node_map.GetNode("while");
+  ASSERT_NE(loop, nullptr);
+  EXPECT_EQ(loop->input_size(), 3);
+  EXPECT_EQ(loop->attr().at("body").func().name(), "Body");
+}
+
 }  // namespace grappler
 }  // namespace tensorflow
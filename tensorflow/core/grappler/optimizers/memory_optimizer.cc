@@ -1273,6 +1273,275 @@ bool SwappingPass(RewriterConfig::MemOptType optimization_level,
   return updated_graph;
 }
 
+// Data and control edges of a graph, indexed by node position, together with
+// the number of bytes each node keeps alive once it has run.
+struct OrderingGraph {
+  // Distinct nodes feeding data or control inputs to every node.
+  std::vector<std::vector<int>> fanins;
+  // Distinct nodes feeding data inputs to every node.
+  std::vector<std::vector<int>> data_fanins;
+  // Distinct nodes consuming data or control outputs of every node.
+  std::vector<std::vector<int>> fanouts;
+  // Number of distinct nodes consuming data outputs of every node.
+  std::vector<int> num_data_fanouts;
+  // Total size of the outputs of every node.
+  std::vector<int64_t> output_bytes;
+  // False for nodes whose outputs stay alive until the end of the step, such
+  // as the fetch nodes and the persistent ones.
+  std::vector<bool> releasable;
+};
+
+bool BuildOrderingGraph(const GrapplerItem& item,
+                        const GraphProperties& properties,
+                        OrderingGraph* graph) {
+  const int num_nodes = item.graph.node_size();
+  std::unordered_map<string, int> node_index;
+  for (int i = 0; i < num_nodes; ++i) {
+    node_index[item.graph.node(i).name()] = i;
+  }
+  const std::unordered_set<string> nodes_to_preserve = item.NodesToPreserve();
+
+  graph->fanins.assign(num_nodes, {});
+  graph->data_fanins.assign(num_nodes, {});
+  graph->fanouts.assign(num_nodes, {});
+  graph->num_data_fanouts.assign(num_nodes, 0);
+  graph->output_bytes.assign(num_nodes, 0);
+  graph->releasable.assign(num_nodes, true);
+  for (int i = 0; i < num_nodes; ++i) {
+    const NodeDef& node = item.graph.node(i);
+    for (const string& input : node.input()) {
+      auto it = node_index.find(NodeName(input));
+      if (it == node_index.end()) {
+        VLOG(1) << "Unknown input " << input << " of node " << node.name();
+        return false;
+      }
+      graph->fanins[i].push_back(it->second);
+      if (!IsControlInput(input)) {
+        graph->data_fanins[i].push_back(it->second);
+      }
+    }
+    for (std::vector<int>* fanins :
+         {&graph->fanins[i], &graph->data_fanins[i]}) {
+      std::sort(fanins->begin(), fanins->end());
+      fanins->erase(std::unique(fanins->begin(), fanins->end()),
+                    fanins->end());
+    }
+    for (int fanin : graph->fanins[i]) {
+      graph->fanouts[fanin].push_back(i);
+    }
+    for (int fanin : graph->data_fanins[i]) {
+      ++graph->num_data_fanouts[fanin];
+    }
+
+    if (properties.HasOutputProperties(node.name())) {
+      for (const auto& output :
+           properties.GetOutputProperties(node.name())) {
+        graph->output_bytes[i] += CalculateTensorSize(output);
+      }
+    }
+    graph->releasable[i] = !IsPersistent(node) &&
+                           nodes_to_preserve.find(node.name()) ==
+                               nodes_to_preserve.end();
+  }
+  return true;
+}
+
+// Computes a topological order of the graph that greedily keeps the number of
+// live bytes low: among the ready nodes, it runs the one that grows the live
+// set the least, looking one step ahead at the consumers that node makes
+// ready. Ties are broken by the position of the nodes in the graph. Returns
+// false if the graph has a cycle.
+bool ComputeMemoryAwareOrder(const OrderingGraph& graph,
+                             std::vector<int>* order) {
+  const int num_nodes = graph.fanins.size();
+  std::vector<int> num_pending_fanins(num_nodes);
+  std::vector<int> num_remaining_uses = graph.num_data_fanouts;
+  std::set<int> ready;
+  for (int i = 0; i < num_nodes; ++i) {
+    num_pending_fanins[i] = graph.fanins[i].size();
+    if (num_pending_fanins[i] == 0) {
+      ready.insert(i);
+    }
+  }
+
+  // Change in the number of live bytes caused by running `node` next.
+  auto live_bytes_delta = [&](int node) {
+    int64_t delta = 0;
+    // Outputs that nobody consumes are released right away.
+    if (!graph.releasable[node] || graph.num_data_fanouts[node] > 0) {
+      delta += graph.output_bytes[node];
+    }
+    for (int fanin : graph.data_fanins[node]) {
+      if (graph.releasable[fanin] && num_remaining_uses[fanin] == 1) {
+        delta -= graph.output_bytes[fanin];
+      }
+    }
+    return delta;
+  };
+
+  order->clear();
+  order->reserve(num_nodes);
+  while (!ready.empty()) {
+    int best_node = -1;
+    int64_t best_score = 0;
+    for (int node : ready) {
+      int64_t score = live_bytes_delta(node);
+      // Simulate running `node` to evaluate the consumers it makes ready.
+      for (int fanin : graph.data_fanins[node]) {
+        --num_remaining_uses[fanin];
+      }
+      int64_t best_lookahead = 0;
+      for (int fanout : graph.fanouts[node]) {
+        if (num_pending_fanins[fanout] == 1) {
+          best_lookahead = std::min(best_lookahead, live_bytes_delta(fanout));
+        }
+      }
+      for (int fanin : graph.data_fanins[node]) {
+        ++num_remaining_uses[fanin];
+      }
+      score += best_lookahead;
+      if (best_node < 0 || score < best_score) {
+        best_node = node;
+        best_score = score;
+      }
+    }
+
+    ready.erase(best_node);
+    order->push_back(best_node);
+    for (int fanin : graph.data_fanins[best_node]) {
+      --num_remaining_uses[fanin];
+    }
+    for (int fanout : graph.fanouts[best_node]) {
+      if (--num_pending_fanins[fanout] == 0) {
+        ready.insert(fanout);
+      }
+    }
+  }
+  return static_cast<int>(order->size()) == num_nodes;
+}
+
+// Enforces a memory-aware execution order on the devices whose estimated peak
+// memory usage is close to their capacity by chaining their nodes with
+// control dependencies. The rewrite is kept only if it lowers the estimated
+// peak memory usage of these devices.
+bool MemoryAwareOrderingPass(Cluster* cluster,
+                             std::unique_ptr<GraphMemory>* memory_ptr,
+                             GrapplerItem* item) {
+  for (const NodeDef& node : item->graph.node()) {
+    // Control dependencies can't cross the frames of a while loop.
+    if (IsControlFlow(node)) {
+      VLOG(1) << "Skipping memory-aware ordering of a graph with control flow";
+      return false;
+    }
+  }
+
+  if ((*memory_ptr) == nullptr) {
+    memory_ptr->reset(new GraphMemory(*item));
+    absl::Status s = (*memory_ptr)->InferStatically(cluster->GetDevices());
+    if (!s.ok()) {
+      memory_ptr->reset();
+      VLOG(1) << "Failed to infer memory usage: " << s.message();
+      return false;
+    }
+  }
+  const GraphMemory& memory = **memory_ptr;
+
+  std::vector<std::pair<string, DeviceNameUtils::ParsedName>> devices;
+  for (const auto& device : cluster->GetDevices()) {
+    const string& name = device.first;
+    const DeviceProperties& prop = device.second;
+    if (prop.memory_size() <= 0) {
+      VLOG(1) << "Available memory unknown for device " << name;
+      continue;
+    }
+    const GraphMemory::MemoryUsage& mem_usage = memory.GetPeakMemoryUsage(name);
+    DeviceNameUtils::ParsedName parsed_name;
+    if (mem_usage.used_memory <= prop.memory_size() * 0.8 ||
+        !DeviceNameUtils::ParseFullName(name, &parsed_name)) {
+      continue;
+    }
+    devices.emplace_back(name, parsed_name);
+  }
+  if (devices.empty()) {
+    return false;
+  }
+
+  GraphProperties properties(*item);
+  absl::Status s =
+      properties.InferStatically(/*assume_valid_feeds=*/false,
+                                 /*aggressive_shape_inference=*/false,
+                                 /*include_tensor_values=*/false);
+  if (!s.ok()) {
+    VLOG(1) << "Failed to infer shapes: " << s.message();
+    return false;
+  }
+  OrderingGraph graph;
+  std::vector<int> order;
+  if (!BuildOrderingGraph(*item, properties, &graph) ||
+      !ComputeMemoryAwareOrder(graph, &order)) {
+    return false;
+  }
+
+  std::unordered_set<string> feeds;
+  for (const auto& feed : item->feed) {
+    feeds.insert(NodeName(feed.first));
+  }
+  GrapplerItem ordered_item(*item);
+  int num_new_dependencies = 0;
+  for (const auto& device : devices) {
+    // Chain the nodes placed on the device in the computed order. Source nodes
+    // and fed nodes are left alone since they don't wait on anything, and each
+    // node only gets a control dependency if it doesn't already consume the
+    // output of its predecessor.
+    int previous = -1;
+    for (int node_id : order) {
+      NodeDef* node = ordered_item.graph.mutable_node(node_id);
+      DeviceNameUtils::ParsedName node_device;
+      if (graph.fanins[node_id].empty() || feeds.count(node->name()) > 0 ||
+          node->device().empty() ||
+          !DeviceNameUtils::ParseFullName(node->device(), &node_device) ||
+          !DeviceNameUtils::IsSpecification(node_device, device.second)) {
+        continue;
+      }
+      if (previous >= 0 &&
+          !std::binary_search(graph.fanins[node_id].begin(),
+                              graph.fanins[node_id].end(), previous)) {
+        node->add_input(AsControlDependency(
+            ordered_item.graph.node(previous).name()));
+        ++num_new_dependencies;
+      }
+      previous = node_id;
+    }
+  }
+  if (num_new_dependencies == 0) {
+    return false;
+  }
+
+  GraphMemory ordered_memory(ordered_item);
+  s = ordered_memory.InferStatically(cluster->GetDevices());
+  if (!s.ok()) {
+    VLOG(1) << "Failed to infer memory usage: " << s.message();
+    return false;
+  }
+  bool lowered_peak = false;
+  for (const auto& device : devices) {
+    const int64_t peak = memory.GetPeakMemoryUsage(device.first).used_memory;
+    const int64_t ordered_peak =
+        ordered_memory.GetPeakMemoryUsage(device.first).used_memory;
+    if (ordered_peak > peak) {
+      return false;
+    }
+    lowered_peak |= ordered_peak < peak;
+  }
+  if (!lowered_peak) {
+    return false;
+  }
+  VLOG(1) << "Added " << num_new_dependencies
+          << " control dependencies to enforce a memory-aware order";
+  item->graph.Swap(&ordered_item.graph);
+  return true;
+}
+
 bool CrossesTaskOrCpuGpuBoundary(const NodeDef& node1, const NodeDef& node2) {
   string task1;
   string device1;
@@ -1440,6 +1709,11 @@ absl::Status MemoryOptimizer::Optimize(Cluster* cluster,
         }
       }
     }
+
+    GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+    if (optimization_level_ == RewriterConfig::ORDERING_HEURISTICS) {
+      MemoryAwareOrderingPass(cluster, &memory, &optimized_item);
+    }
   }
 
   optimized_graph->Swap(&optimized_item.graph);
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/grappler/clusters/virtual_cluster.h"
+#include "tensorflow/core/grappler/costs/graph_memory.h"
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/utils.h"
 #include "tensorflow/core/grappler/utils/grappler_test.h"
@@ -448,6 +449,86 @@ TEST_F(MemoryOptimizerTest, AccumulationRewrites) {
   }
 }
 
+TEST_F(MemoryOptimizerTest, MemoryAwareOrdering) {
+  // Two independent branches that each materialize a 512KB tensor: running
+  // both producers before either reduction exceeds the device memory.
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output a = ops::RandomNormal(s.WithOpName("a").WithDevice("/cpu:0"),
+                               {128, 128, 8}, DT_FLOAT);
+  Output b = ops::RandomNormal(s.WithOpName("b").WithDevice("/cpu:0"),
+                               {128, 128, 8}, DT_FLOAT);
+  Output axes = ops::Const(s.WithOpName("axes").WithDevice("/cpu:0"),
+                           {0, 1, 2}, {3});
+  Output c = ops::Sum(s.WithOpName("c").WithDevice("/cpu:0"), a, axes);
+  Output d = ops::Sum(s.WithOpName("d").WithDevice("/cpu:0"), b, axes);
+  Output e = ops::AddN(s.WithOpName("e").WithDevice("/cpu:0"), {c, d});
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"e"};
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+  MemoryOptimizer optimizer(RewriterConfig::ORDERING_HEURISTICS);
+  GraphDef output;
+  absl::Status status = optimizer.Optimize(cluster.get(), item, &output);
+  TF_EXPECT_OK(status);
+  EXPECT_EQ(item.graph.node_size(), output.node_size());
+
+  // The rewrite must never make the estimated peak memory usage worse.
+  const string device = "/job:localhost/replica:0/task:0/cpu:0";
+  GraphMemory memory(item);
+  TF_ASSERT_OK(memory.InferStatically(cluster->GetDevices()));
+  GrapplerItem optimized = item.WithGraph(std::move(output));
+  GraphMemory optimized_memory(optimized);
+  TF_ASSERT_OK(optimized_memory.InferStatically(cluster->GetDevices()));
+  EXPECT_LE(optimized_memory.GetPeakMemoryUsage(device).used_memory,
+            memory.GetPeakMemoryUsage(device).used_memory);
+
+  // Only control dependencies may have been added.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    const NodeDef& node = item.graph.node(i);
+    const NodeDef& new_node = optimized.graph.node(i);
+    EXPECT_EQ(node.name(), new_node.name());
+    ASSERT_GE(new_node.input_size(), node.input_size());
+    for (int j = 0; j < new_node.input_size(); ++j) {
+      if (j < node.input_size()) {
+        EXPECT_EQ(node.input(j), new_node.input(j));
+      } else {
+        EXPECT_TRUE(IsControlInput(new_node.input(j)));
+      }
+    }
+  }
+
+  auto tensors = EvaluateNodes(optimized.graph, {"c", "d", "e"}, {});
+  ASSERT_EQ(3, tensors.size());
+  EXPECT_NEAR(tensors[0].scalar<float>()() + tensors[1].scalar<float>()(),
+              tensors[2].scalar<float>()(), 1e-1);
+}
+
+TEST_F(MemoryOptimizerTest, MemoryAwareOrderingFitsInMemory) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+  Output a = ops::RandomNormal(s.WithOpName("a").WithDevice("/cpu:0"),
+                               {16, 16}, DT_FLOAT);
+  Output b = ops::RandomNormal(s.WithOpName("b").WithDevice("/cpu:0"),
+                               {16, 16}, DT_FLOAT);
+  Output c = ops::Square(s.WithOpName("c").WithDevice("/cpu:0"), a);
+  Output d = ops::Square(s.WithOpName("d").WithDevice("/cpu:0"), b);
+  Output e = ops::AddN(s.WithOpName("e").WithDevice("/cpu:0"), {c, d});
+
+  GrapplerItem item;
+  TF_CHECK_OK(s.ToGraphDef(&item.graph));
+  item.fetch = {"e"};
+
+  std::unique_ptr<VirtualCluster> cluster(CreateVirtualCluster());
+  MemoryOptimizer optimizer(RewriterConfig::ORDERING_HEURISTICS);
+  GraphDef output;
+  absl::Status status = optimizer.Optimize(cluster.get(), item, &output);
+  TF_EXPECT_OK(status);
+
+  // The graph fits comfortably in memory: its order is left to the executor.
+  CompareGraphs(item.graph, output);
+}
+
 class RelaxAllocatorConstraintsTest : public GrapplerTest {};
 
 TEST_F(RelaxAllocatorConstraintsTest, SameDevice) {
@@ -50,6 +50,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/loop_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/memory_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/model_pruner.h"
+#include "tensorflow/core/grappler/optimizers/optimized_function_cache.h"
 #include "tensorflow/core/grappler/optimizers/pin_to_host_optimizer.h"
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 #include "tensorflow/core/grappler/optimizers/scoped_allocator_optimizer.h"
@@ -62,7 +63,11 @@ limitations under the License.
 #include "tensorflow/core/grappler/verifiers/structure_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/map_util.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/util/dump_graph.h"
 #include "tensorflow/core/util/util.h"
 #include "tensorflow/core/util/xla_config_registry.h"
@@ -889,7 +894,10 @@ absl::Status MetaOptimizer::OptimizeGraph(
                                    }) != optimization_result.results.end();
 
   // Record graph optimization result.
-  optimization_results_.push_back(optimization_result);
+  {
+    mutex_lock l(optimization_results_mu_);
+    optimization_results_.push_back(optimization_result);
+  }
 
   if (is_optimized) {
     TF_RETURN_IF_ERROR(TopologicalSort(optimized_graph));
@@ -1166,11 +1174,169 @@ absl::Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster,
   // True if this is a TPU graph using the old bridge.
   bool is_tpu_graph = IsLegacyTPUBridgeGraphDef(*optimized_graph);
 
+  // Function bodies are optimized based on the function library, the config
+  // and the devices of the cluster, so unchanged functions can reuse the
+  // results of earlier runs.
+  const bool use_function_cache =
+      cfg_.experimental_cache_optimized_functions() && !is_tpu_graph;
+  std::string function_cache_context;
+  if (use_function_cache) {
+    SerializeToStringDeterministic(config_proto_, &function_cache_context);
+    absl::StrAppend(&function_cache_context, "|", producer, "|",
+                    xla_auto_clustering_on_);
+    if (cluster != nullptr) {
+      std::vector<string> device_names = cluster->GetDeviceNames();
+      std::sort(device_names.begin(), device_names.end());
+      absl::StrAppend(&function_cache_context, "|",
+                      absl::StrJoin(device_names, ","));
+    }
+  }
+
+  // The result of optimizing one function body, applied to `flib` in library
+  // order.
+  struct OptimizedFunction {
+    const FunctionDef* func = nullptr;
+    std::string cache_key;
+    bool from_cache = false;
+    FunctionDef optimized_func;
+    // Specialized functions created by the optimization.
+    std::vector<FunctionDef> new_funcs;
+  };
+
+  // Optimizes `func` against `lib`, which is only read.
+  const auto optimize_function = [&](const FunctionDef& func,
+                                     const FunctionLibraryDefinition& lib,
+                                     OptimizedFunction* result)
+      -> absl::Status {
+    const string& func_name = func.signature().name();
+    result->func = &func;
+
+    // If we need to compute the gradient of optimized function at runtime, we
+    // can't perform non-differentiable rewrites.
+    const bool allow_non_differentiable_rewrites =
+        !differentiable_functions.contains(func_name);
+
+    if (use_function_cache) {
+      result->cache_key = OptimizedFunctionCache::Key(
+          func, lib,
+          absl::StrCat(function_cache_context, "|",
+                       allow_non_differentiable_rewrites));
+      if (OptimizedFunctionCache::Global()->Lookup(result->cache_key,
+                                                   &result->optimized_func,
+                                                   &result->new_funcs)) {
+        VLOG(3) << "Reuse cached optimized function: function=" << func_name;
+        result->from_cache = true;
+        return absl::OkStatus();
+      }
+    }
+
+    // Make a GrapplerItem from a FunctionDef.
+    GrapplerFunctionItem func_item;
+    TF_RETURN_IF_ERROR(
+        MakeGrapplerFunctionItem(func, lib, producer, &func_item));
+
+    func_item.optimization_options().allow_non_differentiable_rewrites =
+        allow_non_differentiable_rewrites;
+
+    // Device set available to the function is defined only by the runtime,
+    // when we instantiate and execute the function. We can't use all devices
+    // available to the main graph, because after partitioning the function
+    // call node might execute on a remote worker.
+    if (!func_item.devices().empty()) {
+      return errors::Internal("GrapplerFunctionItem devices must be empty.");
+    }
+
+    // We are not allowed to prune certain types of ops from the graph
+    // instantiated by the function definition, because we must guarantee
+    // function execution semantics wrt side effects (see
+    // function_optimizer.cc).
+    func_item.optimization_options().allow_pruning_stateful_and_dataset_ops =
+        false;
+
+    // Optimize function body graph.
+    GraphDef optimized_func_graph;
+    if (is_tpu_graph) {
+      // Skip optimizing functions if this is a TPU graph. Currently, Grappler
+      // passes do not handle TPU functions correctly in a variety of ways
+      // (Note that due to the pre-placement TPU graph rewriting passes, the
+      // TPU-related ops are encapsulated away into functions). For example,
+      // TPU graphs contain TPUReplicateMetadata node that carries relevant
+      // TPU metadata and Grappler passes could prune that away. Grappler
+      // passes could also cause issues around shape inference. Since the
+      // desired and existing behavior is to not optimize TPU functions with
+      // Grappler, this check preserves that. The only exception is
+      // implementation selector what is required to swap in some TPU specific
+      // lowering code and is verified the work correctly on TPUs.
+      ImplementationSelector implementation_selector;
+
+      // Implementation selector needs to have access to valid function
+      // signature and attributes, and it doesn't need actual function body.
+      std::unique_ptr<FunctionDefLibrary> func_item_function_library(
+          func_item.graph.release_library());
+      *func_item.graph.mutable_library() =
+          GetFunctionDefLibraryStub(*func_item_function_library);
+
+      TF_RETURN_IF_ERROR(implementation_selector.Optimize(
+          cluster, func_item, &optimized_func_graph));
+    } else {
+      GrapplerFunctionItem func_item_copy = func_item;
+      TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
+                                       &optimized_func_graph));
+    }
+
+    // Function body optimization might have created new specialized
+    // functions for each instantiation context. They are added to the library
+    // when the result is applied.
+    FunctionDefLibrary new_funcs;
+    for (const FunctionDef& func_def :
+         optimized_func_graph.library().function()) {
+      if (lib.Find(func_def.signature().name()) == nullptr) {
+        *new_funcs.add_function() = func_def;
+        result->new_funcs.push_back(func_def);
+      }
+    }
+
+    // Convert optimized graph back to FunctionDef. The new functions are
+    // looked up first, then everything else in `lib`.
+    const FunctionLibraryDefinition func_lib(&lib, new_funcs);
+    func_item.SwapFunctionBody(std::move(optimized_func_graph));
+    return MakeFunctionDef(func_item, func_lib, &result->optimized_func);
+  };
+
+  // Adds the specialized functions of `result` to `flib` and replaces the
+  // optimized function with its new body.
+  const auto apply_optimized_function =
+      [&](const OptimizedFunction& result) -> absl::Status {
+    for (const FunctionDef& func_def : result.new_funcs) {
+      if (flib.Find(func_def.signature().name()) == nullptr) {
+        TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
+      }
+    }
+    if (use_function_cache && !result.from_cache) {
+      OptimizedFunctionCache::Global()->Insert(
+          result.cache_key, result.optimized_func, result.new_funcs);
+    }
+    return flib.ReplaceFunction(result.func->signature().name(),
+                                result.optimized_func);
+  };
+
+  // Function bodies of one pass over the library may be optimized
+  // concurrently. They then all see the library from the start of the pass,
+  // and their results are applied in library order.
+  const int num_function_threads =
+      cfg_.experimental_function_optimization_threads();
+  std::unique_ptr<thread::ThreadPool> function_thread_pool;
+  if (num_function_threads > 1) {
+    function_thread_pool = std::make_unique<thread::ThreadPool>(
+        Env::Default(), "grappler_function_optimizer", num_function_threads);
+  }
+
   // Optimize each function only once.
   absl::flat_hash_set<string> optimized_funcs;
   while (optimize_function_library) {
     optimize_function_library = false;
 
+    std::vector<const FunctionDef*> funcs_to_optimize;
     int function_idx = 0;
     for (const FunctionDef& func : optimized_graph->library().function()) {
       GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
@@ -1203,78 +1369,32 @@ absl::Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster,
       optimize_function_library = true;
       optimized_funcs.insert(func_name);
 
-      // Make a GrapplerItem from a FunctionDef.
-      GrapplerFunctionItem func_item;
-      TF_RETURN_IF_ERROR(
-          MakeGrapplerFunctionItem(func, flib, producer, &func_item));
-
-      // If we need to compute the gradient of optimized function at runtime, we
-      // can't perform non-differentiable rewrites.
-      func_item.optimization_options().allow_non_differentiable_rewrites =
-          !differentiable_functions.contains(func_name);
-
-      // Device set available to the function is defined only by the runtime,
-      // when we instantiate and execute the function. We can't use all devices
-      // available to the main graph, because after partitioning the function
-      // call node might execute on a remote worker.
-      if (!func_item.devices().empty()) {
-        return errors::Internal("GrapplerFunctionItem devices must be empty.");
-      }
-
-      // We are not allowed to prune certain types of ops from the graph
-      // instantiated by the function definition, because we must guarantee
-      // function execution semantics wrt side effects (see
-      // function_optimizer.cc).
-      func_item.optimization_options().allow_pruning_stateful_and_dataset_ops =
-          false;
-
-      // Optimize function body graph.
-      GraphDef optimized_func_graph;
-      if (is_tpu_graph) {
-        // Skip optimizing functions if this is a TPU graph. Currently, Grappler
-        // passes do not handle TPU functions correctly in a variety of ways
-        // (Note that due to the pre-placement TPU graph rewriting passes, the
-        // TPU-related ops are encapsulated away into functions). For example,
-        // TPU graphs contain TPUReplicateMetadata node that carries relevant
-        // TPU metadata and Grappler passes could prune that away. Grappler
-        // passes could also cause issues around shape inference. Since the
-        // desired and existing behavior is to not optimize TPU functions with
-        // Grappler, this check preserves that. The only exception is
-        // implementation selector what is required to swap in some TPU specific
-        // lowering code and is verified the work correctly on TPUs.
-        ImplementationSelector implementation_selector;
-
-        // Implementation selector needs to have access to valid function
-        // signature and attributes, and it doesn't need actual function body.
-        std::unique_ptr<FunctionDefLibrary> func_item_function_library(
-            func_item.graph.release_library());
-        *func_item.graph.mutable_library() =
-            GetFunctionDefLibraryStub(*func_item_function_library);
-
-        TF_RETURN_IF_ERROR(implementation_selector.Optimize(
-            cluster, func_item, &optimized_func_graph));
+      if (function_thread_pool == nullptr) {
+        OptimizedFunction result;
+        TF_RETURN_IF_ERROR(optimize_function(func, flib, &result));
+        TF_RETURN_IF_ERROR(apply_optimized_function(result));
       } else {
-        GrapplerFunctionItem func_item_copy = func_item;
-        TF_RETURN_IF_ERROR(OptimizeGraph(cluster, std::move(func_item_copy),
-                                         &optimized_func_graph));
+        funcs_to_optimize.push_back(&func);
       }
+    }
 
-      // Function body optimization might have created new specialized
-      // functions for each instantiation context. Add them to the library.
-      for (const FunctionDef& func_def :
-           optimized_func_graph.library().function()) {
-        if (flib.Find(func_def.signature().name()) == nullptr) {
-          TF_RETURN_IF_ERROR(flib.AddFunctionDef(func_def));
-        }
+    if (!funcs_to_optimize.empty()) {
+      std::vector<OptimizedFunction> results(funcs_to_optimize.size());
+      std::vector<absl::Status> statuses(funcs_to_optimize.size());
+      BlockingCounter counter(funcs_to_optimize.size());
+      for (int i = 0; i < funcs_to_optimize.size(); ++i) {
+        function_thread_pool->Schedule([&, i]() {
+          statuses[i] = optimize_function(*funcs_to_optimize[i], flib,
+                                          &results[i]);
+          counter.DecrementCount();
+        });
+      }
+      counter.Wait();
+      GRAPPLER_RETURN_IF_DEADLINE_EXCEEDED();
+      for (int i = 0; i < funcs_to_optimize.size(); ++i) {
+        TF_RETURN_IF_ERROR(statuses[i]);
+        TF_RETURN_IF_ERROR(apply_optimized_function(results[i]));
       }
-
-      // Convert optimized graph back to FunctionDef.
-      FunctionDef optimized_func;
-      func_item.SwapFunctionBody(std::move(optimized_func_graph));
-      TF_RETURN_IF_ERROR(MakeFunctionDef(func_item, flib, &optimized_func));
-
-      // Replace optimized function with a new FunctionDef.
-      TF_RETURN_IF_ERROR(flib.ReplaceFunction(func_name, optimized_func));
     }
 
     // If optimized at least one function, update the graph library.
@@ -1283,6 +1403,15 @@ absl::Status MetaOptimizer::OptimizeConsumeItem(Cluster* cluster,
     }
   }
 
+  // Functions traced separately, e.g. for several signatures of a SavedModel,
+  // often end up with identical bodies. Keep a single copy of each, so that
+  // it's only instantiated and compiled once.
+  if (item.optimization_options().optimize_function_library &&
+      cfg_.common_subgraph_elimination() != RewriterConfig::OFF) {
+    const int num_deduped = DedupFunctionLibrary(optimized_graph);
+    VLOG(1) << "Deduped " << num_deduped << " functions of the library.";
+  }
+
   // Run module-level TFG optimizations at the end of the meta-optimizer.
   // TODO(jeffniu): None of the TFG optimizations are meant to create new
   // opportunities for other optimizers; they could, but it's unclear whether
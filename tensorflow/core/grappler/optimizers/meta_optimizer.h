@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/graph_optimizer.h"
 #include "tensorflow/core/grappler/verifiers/graph_verifier.h"
 #include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/protobuf/rewriter_config.pb.h"
 #include "tensorflow/core/protobuf/verifier_config.pb.h"
@@ -119,6 +120,9 @@ class MetaOptimizer : public GraphOptimizer {
                             GraphDef* optimized_graph,
                             GraphOptimizationResult* optimization_result);
 
+  // Function bodies may be optimized concurrently, see
+  // RewriterConfig.experimental_function_optimization_threads.
+  mutex optimization_results_mu_;
   std::vector<GraphOptimizationResult> optimization_results_;
 };
 
@@ -0,0 +1,116 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/optimized_function_cache.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "tensorflow/core/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/fingerprint.h"
+
+namespace tensorflow {
+namespace grappler {
+
+namespace {
+
+constexpr int64_t kGlobalCapacityBytes = 256 << 20;
+
+}  // namespace
+
+OptimizedFunctionCache::OptimizedFunctionCache(int64_t capacity_bytes)
+    : capacity_bytes_(capacity_bytes) {}
+
+OptimizedFunctionCache* OptimizedFunctionCache::Global() {
+  static OptimizedFunctionCache* cache =
+      new OptimizedFunctionCache(kGlobalCapacityBytes);
+  return cache;
+}
+
+std::string OptimizedFunctionCache::Key(
+    const FunctionDef& function, const FunctionLibraryDefinition& library,
+    absl::string_view context) {
+  std::string serialized;
+  std::string key_material;
+  // Length-prefix every component, so that different inputs cannot produce
+  // the same key material.
+  auto append = [&key_material](absl::string_view component) {
+    absl::StrAppend(&key_material, component.size(), ":", component);
+  };
+  append(context);
+  SerializeToStringDeterministic(function, &serialized);
+  append(serialized);
+  // The library is a hash map, so sort the reachable functions by name.
+  const FunctionLibraryDefinition reachable =
+      library.ReachableDefinitions(function);
+  std::vector<std::string> names = reachable.ListFunctionNames();
+  std::sort(names.begin(), names.end());
+  for (const std::string& name : names) {
+    SerializeToStringDeterministic(*reachable.Find(name), &serialized);
+    append(serialized);
+  }
+
+  const Fprint128 fingerprint = Fingerprint128(key_material);
+  return absl::StrFormat("%016x%016x", fingerprint.high64, fingerprint.low64);
+}
+
+bool OptimizedFunctionCache::Lookup(const std::string& key,
+                                    FunctionDef* function,
+                                    std::vector<FunctionDef>* new_functions) {
+  mutex_lock l(mu_);
+  auto it = entries_.find(key);
+  if (it == entries_.end()) return false;
+  Entry* entry = it->second.get();
+  lru_.splice(lru_.begin(), lru_, entry->lru_position);
+  *function = entry->function;
+  *new_functions = entry->new_functions;
+  return true;
+}
+
+void OptimizedFunctionCache::Insert(
+    const std::string& key, const FunctionDef& function,
+    const std::vector<FunctionDef>& new_functions) {
+  auto entry = std::make_unique<Entry>();
+  entry->function = function;
+  entry->new_functions = new_functions;
+  entry->bytes = key.size() + function.ByteSizeLong();
+  for (const FunctionDef& new_function : new_functions) {
+    entry->bytes += new_function.ByteSizeLong();
+  }
+  if (entry->bytes > capacity_bytes_) return;
+
+  mutex_lock l(mu_);
+  if (entries_.contains(key)) return;
+  bytes_ += entry->bytes;
+  lru_.push_front(key);
+  entry->lru_position = lru_.begin();
+  entries_.emplace(key, std::move(entry));
+  while (bytes_ > capacity_bytes_) {
+    auto evicted = entries_.find(lru_.back());
+    bytes_ -= evicted->second->bytes;
+    entries_.erase(evicted);
+    lru_.pop_back();
+  }
+}
+
+size_t OptimizedFunctionCache::size() const {
+  mutex_lock l(mu_);
+  return entries_.size();
+}
+
+}  // namespace grappler
+}  // namespace tensorflow
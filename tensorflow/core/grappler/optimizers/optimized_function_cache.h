@@ -0,0 +1,89 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_OPTIMIZED_FUNCTION_CACHE_H_
+#define TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_OPTIMIZED_FUNCTION_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function.pb.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace grappler {
+
+// An in-memory cache of function bodies optimized by the MetaOptimizer, shared
+// by all MetaOptimizer runs in the process.
+//
+// Functions are keyed by their definition, the definitions of all functions
+// reachable from them and a caller-provided context that holds the optimizer
+// configuration. A function shared by several signatures, or reloaded with an
+// unchanged body, is then optimized only once. Least recently used entries are
+// evicted once the cached definitions exceed the byte capacity.
+class OptimizedFunctionCache {
+ public:
+  explicit OptimizedFunctionCache(int64_t capacity_bytes);
+
+  // Returns the process-wide cache.
+  static OptimizedFunctionCache* Global();
+
+  // Returns the cache key of optimizing `function` with the functions it calls
+  // looked up in `library`, under `context`.
+  static std::string Key(const FunctionDef& function,
+                         const FunctionLibraryDefinition& library,
+                         absl::string_view context);
+
+  // Returns true and sets `*function` to the optimized function and
+  // `*new_functions` to the functions the optimization added to the library,
+  // if there is an entry for `key`.
+  bool Lookup(const std::string& key, FunctionDef* function,
+              std::vector<FunctionDef>* new_functions);
+
+  // Stores the result of an optimization as the entry for `key`.
+  void Insert(const std::string& key, const FunctionDef& function,
+              const std::vector<FunctionDef>& new_functions);
+
+  // Returns the number of cached entries.
+  size_t size() const;
+
+ private:
+  struct Entry {
+    FunctionDef function;
+    std::vector<FunctionDef> new_functions;
+    int64_t bytes = 0;
+    std::list<std::string>::iterator lru_position;
+  };
+
+  const int64_t capacity_bytes_;
+  mutable mutex mu_;
+  int64_t bytes_ TF_GUARDED_BY(mu_) = 0;
+  // Most recently used keys first.
+  std::list<std::string> lru_ TF_GUARDED_BY(mu_);
+  absl::flat_hash_map<std::string, std::unique_ptr<Entry>> entries_
+      TF_GUARDED_BY(mu_);
+};
+
+}  // namespace grappler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_GRAPPLER_OPTIMIZERS_OPTIMIZED_FUNCTION_CACHE_H_
@@ -0,0 +1,96 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/grappler/optimizers/optimized_function_cache.h"
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/framework/function.h"
+#include "tensorflow/core/framework/function_testlib.h"
+#include "tensorflow/core/framework/op.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace grappler {
+namespace {
+
+FunctionLibraryDefinition MakeLibrary(const FunctionDef& x_times_two) {
+  FunctionDefLibrary proto;
+  *proto.add_function() = x_times_two;
+  *proto.add_function() = test::function::XTimesFour();
+  return FunctionLibraryDefinition(OpRegistry::Global(), proto);
+}
+
+TEST(OptimizedFunctionCacheTest, KeyDependsOnFunctionCalleesAndContext) {
+  const FunctionDef x_times_four = test::function::XTimesFour();
+  const FunctionLibraryDefinition library =
+      MakeLibrary(test::function::XTimesTwo());
+  const std::string key =
+      OptimizedFunctionCache::Key(x_times_four, library, "config");
+
+  // Equal definitions in another library produce the same key.
+  EXPECT_EQ(key, OptimizedFunctionCache::Key(
+                     x_times_four, MakeLibrary(test::function::XTimesTwo()),
+                     "config"));
+  EXPECT_NE(key,
+            OptimizedFunctionCache::Key(x_times_four, library, "other config"));
+
+  FunctionDef changed = x_times_four;
+  (*changed.mutable_attr())["_noinline"].set_b(true);
+  EXPECT_NE(key, OptimizedFunctionCache::Key(changed, library, "config"));
+
+  // A change to a called function changes the key of its callers.
+  FunctionDef changed_callee = test::function::XTimesTwo();
+  (*changed_callee.mutable_attr())["_noinline"].set_b(true);
+  EXPECT_NE(key, OptimizedFunctionCache::Key(
+                     x_times_four, MakeLibrary(changed_callee), "config"));
+}
+
+TEST(OptimizedFunctionCacheTest, LookupReturnsInsertedEntry) {
+  OptimizedFunctionCache cache(1 << 20);
+  FunctionDef function;
+  std::vector<FunctionDef> new_functions;
+  EXPECT_FALSE(cache.Lookup("key", &function, &new_functions));
+
+  cache.Insert("key", test::function::XTimesFour(),
+               {test::function::XTimesTwo()});
+  ASSERT_TRUE(cache.Lookup("key", &function, &new_functions));
+  EXPECT_EQ(function.signature().name(), "XTimesFour");
+  ASSERT_EQ(new_functions.size(), 1);
+  EXPECT_EQ(new_functions[0].signature().name(), "XTimesTwo");
+}
+
+TEST(OptimizedFunctionCacheTest, EvictsLeastRecentlyUsed) {
+  const FunctionDef function = test::function::XTimesTwo();
+  const int64_t entry_bytes = std::string("a").size() + function.ByteSizeLong();
+  OptimizedFunctionCache cache(2 * entry_bytes);
+  cache.Insert("a", function, {});
+  cache.Insert("b", function, {});
+  FunctionDef result;
+  std::vector<FunctionDef> new_functions;
+  // Touch `a`, so that `b` is evicted next.
+  EXPECT_TRUE(cache.Lookup("a", &result, &new_functions));
+  cache.Insert("c", function, {});
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_TRUE(cache.Lookup("a", &result, &new_functions));
+  EXPECT_FALSE(cache.Lookup("b", &result, &new_functions));
+  EXPECT_TRUE(cache.Lookup("c", &result, &new_functions));
+}
+
+}  // namespace
+}  // namespace grappler
+}  // namespace tensorflow
@@ -16,7 +16,10 @@ limitations under the License.
 #include "tensorflow/core/grappler/optimizers/remapper.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstdlib>
+#include <deque>
+#include <limits>
 #include <map>
 #include <set>
 #include <string>
@@ -24,7 +27,9 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_join.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/versions.pb.h"
 #include "tensorflow/core/grappler/costs/graph_properties.h"
@@ -74,6 +79,16 @@ namespace grappler {
 //
 // Sigmoid + Mul -> _MklSwish  // This fusion only works on Intel CPU.
 //
+// GatherV2 + Mul + SegmentSum -> _FusedWeightedSparseSegmentSum  // CPU only.
+//
+// BatchMatMul + <Mul> + Softmax + BatchMatMul
+//   -> _FusedScaledDotProductAttention  // CPU only.
+//
+// Chain of element-wise ops (Mul, AddV2, Tanh, ...) -> _FusedElementwise
+//   // CPU only, tried after all other patterns.
+//
+// MatMul + QuantizeAndDequantize{V2,V4} of constant weights
+//   -> WeightOnlyQuantizedMatMul  // CPU only, tried before all other patterns.
 //
 // In all cases, the supported activation functions are Relu, Relu6, and Elu.
 //
@@ -92,6 +107,13 @@ constexpr char kFusedDepthwiseConv2dNative[] = "_FusedDepthwiseConv2dNative";
 constexpr char kFusedBatchNormEx[] = "_FusedBatchNormEx";
 constexpr char kFusedBatchNormGradEx[] = "_FusedBatchNormGradEx";
 constexpr char kTensorToHashBucket[] = "_TensorToHashBucketFast";
+constexpr char kStringSplitToHashBucket[] = "_StringSplitToHashBucketFast";
+constexpr char kFusedWeightedSparseSegmentSum[] =
+    "_FusedWeightedSparseSegmentSum";
+constexpr char kFusedScaledDotProductAttention[] =
+    "_FusedScaledDotProductAttention";
+constexpr char kFusedElementwise[] = "_FusedElementwise";
+constexpr char kWeightOnlyQuantizedMatMul[] = "WeightOnlyQuantizedMatMul";
 constexpr char kLeakyRelu[] = "LeakyRelu";
 constexpr char kMklFusedMish[] = "_MklFusedMish";
 constexpr char kRelu[] = "Relu";
@@ -170,6 +192,85 @@ struct TensorToHashBucket {
   int string_to_hash_bucket = kMissingIndex;
 };
 
+// StringSplitV2 + StringToHashBucketFast of the split values that can be
+// replaced with _StringSplitToHashBucketFast.
+struct StringSplitToHashBucket {
+  StringSplitToHashBucket() = default;
+  StringSplitToHashBucket(int string_split, int string_to_hash_bucket)
+      : string_split(string_split),
+        string_to_hash_bucket(string_to_hash_bucket) {}
+
+  int string_split = kMissingIndex;
+  int string_to_hash_bucket = kMissingIndex;
+};
+
+// GatherV2 + Mul + SegmentSum that can be replaced with
+// _FusedWeightedSparseSegmentSum, as in the weighted embedding_lookup_sparse.
+struct WeightedSparseSegmentSum {
+  WeightedSparseSegmentSum() = default;
+  WeightedSparseSegmentSum(int gather, int mul, int segment_sum,
+                           int weights_port)
+      : gather(gather),
+        mul(mul),
+        segment_sum(segment_sum),
+        weights_port(weights_port) {}
+
+  int gather = kMissingIndex;
+  int mul = kMissingIndex;
+  int segment_sum = kMissingIndex;
+  int weights_port = 1;
+};
+
+// BatchMatMul(query, key^T) + <Mul(scale)> + Softmax + BatchMatMul(value) that
+// can be replaced with _FusedScaledDotProductAttention.
+struct ScaledDotProductAttention {
+  ScaledDotProductAttention() = default;
+  ScaledDotProductAttention(int query_key, int mul, int softmax,
+                            int probs_value, float scale)
+      : query_key(query_key),
+        mul(mul),
+        softmax(softmax),
+        probs_value(probs_value),
+        scale(scale) {}
+
+  int query_key = kMissingIndex;
+  int mul = kMissingIndex;
+  int softmax = kMissingIndex;
+  int probs_value = kMissingIndex;
+  float scale = 1.0f;
+};
+
+// MatMul whose weights are constant and go through a quantization emulation
+// op, as in quantization-aware trained models, that can be replaced with
+// WeightOnlyQuantizedMatMul of the quantized weights.
+struct QuantizedWeightsMatMul {
+  int matmul = kMissingIndex;
+  int quantize = kMissingIndex;
+  // The quantized weights, as a [K, N] (or [ceil(K / 2), N] with 4 bits)
+  // int8 tensor, and their [1, N] scales.
+  Tensor weights;
+  Tensor scales;
+  int weight_bits = 8;
+};
+
+// Chain of element-wise ops, each consuming the output of the previous one,
+// that can be replaced with _FusedElementwise.
+struct ElementwiseChain {
+  // Nodes of the chain from the first to the last one (the root).
+  std::vector<int> nodes;
+  // For every node, the input port that receives the running value.
+  std::vector<int> value_ports;
+};
+
+// Independent MatMuls with the same attributes and input shapes, each
+// optionally followed by the same BiasAdd of a constant and activation, that
+// can be computed by one BatchMatMulV2 of their stacked inputs.
+struct HorizontalMatMulFusion {
+  // For every MatMul, the MatMul followed by the ops fused with it. All chains
+  // have the same length and the same ops.
+  std::vector<std::vector<int>> chains;
+};
+
 // Pad followed by Conv3D/FusedConv3D
 struct PadWithConv3D {
   PadWithConv3D() = default;
@@ -2746,6 +2847,766 @@ bool FindTensorToHashBucket(const RemapperContext& ctx, int node_index,
   return true;
 }
 
+bool FindStringSplitToHashBucket(const RemapperContext& ctx, int node_index,
+                                 StringSplitToHashBucket* matched) {
+  // Root of the pattern must be a StringToHashBucketFast on CPU.
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if (!IsStringToHashBucketFast(*node_def) || !NodeIsOnCpu(node_def) ||
+      HasControlFaninOrFanout(*node_view) ||
+      IsInPreserveSet(ctx, node_def) || node_view->NumRegularFanins() < 1) {
+    return false;
+  }
+
+  // Input to the StringToHashBucketFast must be the values of a StringSplitV2
+  // that are not used elsewhere. Its indices and shape are left as they are.
+  const auto& regular_fanin_0 = node_view->GetRegularFanin(0);
+  const auto* split_node_view = regular_fanin_0.node_view();
+  const auto* split_node_def = split_node_view->node();
+  if (split_node_def->op() != "StringSplitV2" ||
+      regular_fanin_0.index() != 1 || !NodeIsOnCpu(split_node_def) ||
+      HasControlFaninOrFanout(*split_node_view) ||
+      split_node_view->GetRegularFanout(1).size() != 1 ||
+      IsInPreserveSet(ctx, split_node_def)) {
+    return false;
+  }
+
+  *matched = StringSplitToHashBucket(split_node_view->node_index(), node_index);
+  return true;
+}
+
+bool FindWeightedSparseSegmentSum(RemapperContext* ctx, int node_index,
+                                  WeightedSparseSegmentSum* matched) {
+  // Root of the pattern must be a SegmentSum on CPU.
+  const auto* node_view = ctx->graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if (node_def->op() != "SegmentSum" || !NodeIsOnCpu(node_def) ||
+      HasControlFaninOrFanout(*node_view) ||
+      node_view->NumRegularFanins() != 2) {
+    return false;
+  }
+  if (!HasDataType(node_def, DT_FLOAT) && !HasDataType(node_def, DT_DOUBLE)) {
+    return false;
+  }
+
+  // Input to the SegmentSum must be a Mul that is not used elsewhere.
+  const auto* mul_node_view = node_view->GetRegularFanin(0).node_view();
+  const auto* mul_node_def = mul_node_view->node();
+  if (!IsMul(*mul_node_def) || HasControlFaninOrFanout(*mul_node_view) ||
+      !HasAtMostOneFanoutAtPort0(*mul_node_view) ||
+      IsInPreserveSet(*ctx, mul_node_def) ||
+      mul_node_view->NumRegularFanins() != 2) {
+    return false;
+  }
+
+  for (int gather_port = 0; gather_port < 2; ++gather_port) {
+    // One input to the Mul must be a GatherV2 of rows.
+    const auto* gather_node_view =
+        mul_node_view->GetRegularFanin(gather_port).node_view();
+    const auto* gather_node_def = gather_node_view->node();
+    if (gather_node_def->op() != "GatherV2" || !NodeIsOnCpu(gather_node_def) ||
+        HasControlFaninOrFanout(*gather_node_view) ||
+        !HasAtMostOneFanoutAtPort0(*gather_node_view) ||
+        IsInPreserveSet(*ctx, gather_node_def) ||
+        gather_node_view->NumRegularFanins() != 3 ||
+        GetDataTypeFromAttr(*gather_node_def, "Tparams") !=
+            GetDataTypeFromAttr(*node_def, "T")) {
+      continue;
+    }
+    int batch_dims = 0;
+    if (TryGetNodeAttr(*gather_node_def, "batch_dims", &batch_dims) &&
+        batch_dims != 0) {
+      continue;
+    }
+    const auto* axis_node_def =
+        gather_node_view->GetRegularFanin(2).node_view()->node();
+    Tensor axis;
+    if (!IsConstant(*axis_node_def) ||
+        !axis.FromProto(axis_node_def->attr().at("value").tensor()) ||
+        axis.NumElements() != 1) {
+      continue;
+    }
+    const int64_t axis_value = axis.dtype() == DT_INT32
+                                   ? axis.flat<int32>()(0)
+                                   : axis.flat<int64_t>()(0);
+    if (axis_value != 0) continue;
+
+    if (!ctx->inferred_graph_properties) {
+      absl::Status s = ctx->graph_properties.InferStatically(
+          /*assume_valid_feeds=*/false,
+          /*aggressive_shape_inference=*/false,
+          /*include_input_tensor_values=*/false,
+          /*include_output_tensor_values=*/false);
+      if (!s.ok()) return false;
+      ctx->inferred_graph_properties = true;
+    }
+
+    // The indices must be a vector, so that the gathered rows line up with
+    // the segment ids.
+    const auto& gather_props =
+        ctx->graph_properties.GetInputProperties(gather_node_def->name());
+    if (gather_props.size() != 3 || gather_props[1].shape().unknown_rank() ||
+        gather_props[1].shape().dim_size() != 1) {
+      continue;
+    }
+
+    // The other input to the Mul must have shape [N, 1, ..., 1], so that it
+    // scales whole rows without broadcasting the gathered rows.
+    const auto& mul_props =
+        ctx->graph_properties.GetInputProperties(mul_node_def->name());
+    if (mul_props.size() != 2) continue;
+    const TensorShapeProto& rows_shape = mul_props[gather_port].shape();
+    const TensorShapeProto& weights_shape = mul_props[1 - gather_port].shape();
+    if (rows_shape.unknown_rank() || weights_shape.unknown_rank() ||
+        rows_shape.dim_size() < 1 ||
+        rows_shape.dim_size() != weights_shape.dim_size()) {
+      continue;
+    }
+    const int64_t num_rows = rows_shape.dim(0).size();
+    const int64_t num_weights = weights_shape.dim(0).size();
+    bool scales_rows =
+        num_weights == 1 ||
+        (num_rows != 1 &&
+         (num_rows < 0 || num_weights < 0 || num_rows == num_weights));
+    for (int d = 1; d < weights_shape.dim_size(); ++d) {
+      if (weights_shape.dim(d).size() != 1) scales_rows = false;
+    }
+    if (!scales_rows) continue;
+
+    *matched = WeightedSparseSegmentSum(gather_node_view->node_index(),
+                                        mul_node_view->node_index(),
+                                        node_index, 1 - gather_port);
+    return true;
+  }
+  return false;
+}
+
+bool FindScaledDotProductAttention(RemapperContext* ctx, int node_index,
+                                   ScaledDotProductAttention* matched) {
+  if (ctx->xla_cpu_jit_disable_fusion) return false;
+
+  const auto is_batch_matmul = [](const NodeDef& node, bool adj_y) {
+    if (node.op() != "BatchMatMul" && node.op() != "BatchMatMulV2") {
+      return false;
+    }
+    bool node_adj_x = false;
+    bool node_adj_y = false;
+    TryGetNodeAttr(node, "adj_x", &node_adj_x);
+    TryGetNodeAttr(node, "adj_y", &node_adj_y);
+    return !node_adj_x && node_adj_y == adj_y;
+  };
+  // The intermediate nodes are removed, so they must not be used elsewhere.
+  const auto is_intermediate = [ctx](const utils::MutableNodeView& node_view,
+                                     int num_inputs) {
+    return !HasControlFaninOrFanout(node_view) &&
+           HasAtMostOneFanoutAtPort0(node_view) &&
+           !IsInPreserveSet(*ctx, node_view.node()) &&
+           node_view.NumRegularFanins() == num_inputs;
+  };
+
+  // Root of the pattern must be a BatchMatMul of the probabilities with the
+  // values on CPU.
+  const auto* node_view = ctx->graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if (!is_batch_matmul(*node_def, /*adj_y=*/false) || !NodeIsOnCpu(node_def) ||
+      HasControlFaninOrFanout(*node_view) ||
+      node_view->NumRegularFanins() != 2) {
+    return false;
+  }
+  const DataType dtype = GetDataTypeFromAttr(*node_def, "T");
+  if (dtype != DT_FLOAT && dtype != DT_DOUBLE) return false;
+
+  // The probabilities must be a Softmax of the scores.
+  const auto* softmax_node_view = node_view->GetRegularFanin(0).node_view();
+  const auto* softmax_node_def = softmax_node_view->node();
+  if (!IsSoftmax(*softmax_node_def) ||
+      !is_intermediate(*softmax_node_view, 1) ||
+      GetDataTypeFromAttr(*softmax_node_def, "T") != dtype) {
+    return false;
+  }
+
+  // The scores may be scaled by a scalar constant.
+  const auto* scores_node_view =
+      softmax_node_view->GetRegularFanin(0).node_view();
+  int mul_index = kMissingIndex;
+  float scale = 1.0f;
+  int scale_rank = 0;
+  if (IsMul(*scores_node_view->node())) {
+    const auto* mul_node_view = scores_node_view;
+    if (!is_intermediate(*mul_node_view, 2) ||
+        GetDataTypeFromAttr(*mul_node_view->node(), "T") != dtype) {
+      return false;
+    }
+    scores_node_view = nullptr;
+    for (int port = 0; port < 2; ++port) {
+      const auto* scale_node_def =
+          mul_node_view->GetRegularFanin(1 - port).node_view()->node();
+      Tensor scale_tensor;
+      if (!IsConstant(*scale_node_def) ||
+          !scale_tensor.FromProto(
+              scale_node_def->attr().at("value").tensor()) ||
+          scale_tensor.NumElements() != 1 || scale_tensor.dtype() != dtype) {
+        continue;
+      }
+      scale = dtype == DT_FLOAT
+                  ? scale_tensor.flat<float>()(0)
+                  : static_cast<float>(scale_tensor.flat<double>()(0));
+      scale_rank = scale_tensor.dims();
+      scores_node_view = mul_node_view->GetRegularFanin(port).node_view();
+      mul_index = mul_node_view->node_index();
+      break;
+    }
+    if (scores_node_view == nullptr) return false;
+  }
+
+  // The scores must be a BatchMatMul of the queries with the transposed keys.
+  const auto* query_key_node_def = scores_node_view->node();
+  if (!is_batch_matmul(*query_key_node_def, /*adj_y=*/true) ||
+      !NodeIsOnCpu(query_key_node_def) ||
+      !is_intermediate(*scores_node_view, 2) ||
+      GetDataTypeFromAttr(*query_key_node_def, "T") != dtype) {
+    return false;
+  }
+
+  if (!ctx->inferred_graph_properties) {
+    absl::Status s = ctx->graph_properties.InferStatically(
+        /*assume_valid_feeds=*/false,
+        /*aggressive_shape_inference=*/false,
+        /*include_input_tensor_values=*/false,
+        /*include_output_tensor_values=*/false);
+    if (!s.ok()) return false;
+    ctx->inferred_graph_properties = true;
+  }
+
+  // The fused kernel does not broadcast, so query, key and value must have the
+  // same rank and batch dimensions. Unknown dimensions only match when shape
+  // inference proved them equal.
+  const auto& query_key_props =
+      ctx->graph_properties.GetInputProperties(query_key_node_def->name());
+  const auto& probs_value_props =
+      ctx->graph_properties.GetInputProperties(node_def->name());
+  if (query_key_props.size() != 2 || probs_value_props.size() != 2) {
+    return false;
+  }
+  const TensorShapeProto& query_shape = query_key_props[0].shape();
+  const TensorShapeProto& key_shape = query_key_props[1].shape();
+  const TensorShapeProto& value_shape = probs_value_props[1].shape();
+  if (query_shape.unknown_rank() || key_shape.unknown_rank() ||
+      value_shape.unknown_rank()) {
+    return false;
+  }
+  const int rank = query_shape.dim_size();
+  if (rank < 3 || key_shape.dim_size() != rank ||
+      value_shape.dim_size() != rank || scale_rank > rank) {
+    return false;
+  }
+  for (int d = 0; d < rank - 2; ++d) {
+    const int64_t size = query_shape.dim(d).size();
+    if (size == -1 || key_shape.dim(d).size() != size ||
+        value_shape.dim(d).size() != size) {
+      return false;
+    }
+  }
+
+  *matched = ScaledDotProductAttention(
+      scores_node_view->node_index(), mul_index,
+      softmax_node_view->node_index(), node_index, scale);
+  return true;
+}
+
+// How an op supported by _FusedElementwise combines its inputs.
+enum class ElementwiseKind { kUnary, kBinary, kCommutative };
+
+// Ops supported by _FusedElementwise. Keep in sync with FusedElementwiseFns in
+// kernels/fused_elementwise_op.cc.
+const absl::flat_hash_map<string, ElementwiseKind>& FusableElementwiseOps() {
+  static const auto* ops = new absl::flat_hash_map<string, ElementwiseKind>({
+      {"Abs", ElementwiseKind::kUnary},
+      {"Exp", ElementwiseKind::kUnary},
+      {"Log", ElementwiseKind::kUnary},
+      {"Neg", ElementwiseKind::kUnary},
+      {"Relu", ElementwiseKind::kUnary},
+      {"Rsqrt", ElementwiseKind::kUnary},
+      {"Sigmoid", ElementwiseKind::kUnary},
+      {"Sqrt", ElementwiseKind::kUnary},
+      {"Square", ElementwiseKind::kUnary},
+      {"Tanh", ElementwiseKind::kUnary},
+      {"Div", ElementwiseKind::kBinary},
+      {"RealDiv", ElementwiseKind::kBinary},
+      {"Sub", ElementwiseKind::kBinary},
+      {"Add", ElementwiseKind::kCommutative},
+      {"AddV2", ElementwiseKind::kCommutative},
+      {"Maximum", ElementwiseKind::kCommutative},
+      {"Minimum", ElementwiseKind::kCommutative},
+      {"Mul", ElementwiseKind::kCommutative},
+      {"SquaredDifference", ElementwiseKind::kCommutative},
+  });
+  return *ops;
+}
+// Quantizes the [K, N] `weights` the same way as QuantizeAndDequantizeV4 with
+// the given attributes. Each channel of `num_channels` (1 or N) gets the
+// integer values and the scale they dequantize with, so that dequantizing
+// reproduces the output of the op exactly.
+bool QuantizeMatMulWeights(const Tensor& weights, int num_bits,
+                           bool narrow_range, bool range_given,
+                           bool round_half_up, const Tensor& input_min,
+                           const Tensor& input_max, int num_channels,
+                           Tensor* quantized, Tensor* scales) {
+  const int64_t k = weights.dim_size(0);
+  const int64_t n = weights.dim_size(1);
+  auto w = weights.matrix<float>();
+  const int64_t min_quantized =
+      narrow_range ? -(int64_t{1} << (num_bits - 1)) + 1
+                   : -(int64_t{1} << (num_bits - 1));
+  const int64_t max_quantized = (int64_t{1} << (num_bits - 1)) - 1;
+
+  *quantized = Tensor(DT_INT8, TensorShape({k, n}));
+  *scales = Tensor(DT_FLOAT, TensorShape({1, n}));
+  auto q = quantized->matrix<int8>();
+  for (int channel = 0; channel < num_channels; ++channel) {
+    const int64_t begin = num_channels == 1 ? 0 : channel;
+    const int64_t end = num_channels == 1 ? n : channel + 1;
+    float min_range;
+    float max_range;
+    if (range_given) {
+      min_range = input_min.flat<float>()(channel);
+      max_range = input_max.flat<float>()(channel);
+    } else {
+      min_range = std::numeric_limits<float>::max();
+      max_range = std::numeric_limits<float>::lowest();
+      for (int64_t i = 0; i < k; ++i) {
+        for (int64_t j = begin; j < end; ++j) {
+          min_range = std::min(min_range, w(i, j));
+          max_range = std::max(max_range, w(i, j));
+        }
+      }
+    }
+    if (!(min_range <= max_range)) return false;
+
+    // Same as ComputeQuantizationRange() in quantize_and_dequantize_op.h.
+    const float scale_from_min_side = (min_quantized * min_range > 0)
+                                          ? min_quantized / min_range
+                                          : std::numeric_limits<float>::max();
+    const float scale_from_max_side = (max_quantized * max_range > 0)
+                                          ? max_quantized / max_range
+                                          : std::numeric_limits<float>::max();
+    float scale;
+    float inverse_scale;
+    if (scale_from_min_side < scale_from_max_side) {
+      scale = scale_from_min_side;
+      inverse_scale = min_range / min_quantized;
+      max_range = max_quantized * inverse_scale;
+    } else {
+      scale = scale_from_max_side;
+      inverse_scale = max_range / max_quantized;
+      min_range = min_quantized * inverse_scale;
+    }
+
+    for (int64_t i = 0; i < k; ++i) {
+      for (int64_t j = begin; j < end; ++j) {
+        float value = w(i, j);
+        if (range_given) {
+          value = std::min(std::max(value, min_range), max_range);
+        }
+        value *= scale;
+        value =
+            round_half_up ? std::floor(value + 0.5f) : std::nearbyint(value);
+        q(i, j) = static_cast<int8>(std::min<float>(
+            std::max<float>(value, min_quantized), max_quantized));
+      }
+    }
+    for (int64_t j = begin; j < end; ++j) {
+      scales->matrix<float>()(0, j) = inverse_scale;
+    }
+  }
+  return true;
+}
+
+// Packs two rows of 4-bit weights per byte, the low nibble holding the even
+// row, as WeightOnlyQuantizedMatMul expects them.
+Tensor PackInt4Weights(const Tensor& weights) {
+  const int64_t k = weights.dim_size(0);
+  const int64_t n = weights.dim_size(1);
+  Tensor packed(DT_INT8, TensorShape({(k + 1) / 2, n}));
+  auto w = weights.matrix<int8>();
+  auto p = packed.matrix<int8>();
+  for (int64_t i = 0; i < k; i += 2) {
+    for (int64_t j = 0; j < n; ++j) {
+      const uint8 low = static_cast<uint8>(w(i, j)) & 0xF;
+      const uint8 high =
+          i + 1 < k ? static_cast<uint8>(w(i + 1, j)) & 0xF : uint8{0};
+      p(i / 2, j) = static_cast<int8>(low | (high << 4));
+    }
+  }
+  return packed;
+}
+
+// Largest number of multiply-adds of a MatMul fused horizontally. Larger
+// MatMuls already keep the device busy on their own, and stacking their inputs
+// would only add copies.
+constexpr int64_t kMaxHorizontalMatMulMacs = 1 << 24;
+
+bool IsHorizontalFusionActivation(const NodeDef& node) {
+  return IsRelu(node) || IsRelu6(node) || IsElu(node) || IsTanh(node) ||
+         IsSigmoid(node) || IsLeakyRelu(node);
+}
+
+// Returns the MatMul at 'node_index' followed by the BiasAdd of a constant and
+// the activation that consume it, as far as they can be applied to the stacked
+// MatMul outputs instead.
+std::vector<int> GetHorizontalFusionChain(const RemapperContext& ctx,
+                                          int node_index) {
+  std::vector<int> chain = {node_index};
+  // Returns the only consumer of 'node_view' if it can join the chain.
+  const auto next = [&ctx](const utils::MutableNodeView& node_view)
+      -> const utils::MutableNodeView* {
+    if (node_view.NumControlledFanouts() > 0 ||
+        node_view.NumRegularFanouts() != 1 ||
+        IsInPreserveSet(ctx, node_view.node())) {
+      return nullptr;
+    }
+    const auto* fanout = node_view.GetRegularFanout(0)[0].node_view();
+    if (HasControlFaninOrFanout(*fanout) ||
+        fanout->node()->device() != node_view.node()->device()) {
+      return nullptr;
+    }
+    return fanout;
+  };
+
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* fanout = next(*node_view);
+  if (fanout != nullptr && IsBiasAdd(*fanout->node()) &&
+      fanout->GetRegularFanin(0).node_index() == node_index) {
+    // The bias must not depend on anything, so that stacking the biases of
+    // all MatMuls does not make them depend on each other.
+    const auto* bias = fanout->GetRegularFanin(1).node_view();
+    if (IsConstant(*bias->node()) && bias->NumControllingFanins() == 0) {
+      chain.push_back(fanout->node_index());
+      node_view = fanout;
+      fanout = next(*node_view);
+    }
+  }
+  if (fanout != nullptr && IsHorizontalFusionActivation(*fanout->node())) {
+    chain.push_back(fanout->node_index());
+  }
+  return chain;
+}
+
+// Returns true if any of 'nodes' is an ancestor of the node at 'node_index'.
+// The graph view is sorted topologically, so that nodes before 'min_index'
+// cannot be reached from any of 'nodes'.
+bool HasAncestorIn(const RemapperContext& ctx, int node_index,
+                   const absl::flat_hash_set<int>& nodes, int min_index) {
+  std::vector<int> stack = {node_index};
+  absl::flat_hash_set<int> visited = {node_index};
+  while (!stack.empty()) {
+    const auto* node_view = ctx.graph_view.GetNode(stack.back());
+    stack.pop_back();
+    const auto visit = [&](int fanin) {
+      if (fanin < min_index || !visited.insert(fanin).second) return false;
+      if (nodes.contains(fanin)) return true;
+      stack.push_back(fanin);
+      return false;
+    };
+    for (const auto& fanin : node_view->GetRegularFanins()) {
+      if (visit(fanin.node_index())) return true;
+    }
+    for (const auto& fanin : node_view->GetControllingFanins()) {
+      if (visit(fanin.node_index())) return true;
+    }
+  }
+  return false;
+}
+
+// Groups small MatMuls that have the same device, attributes and input shapes,
+// such as the ones of the towers of multi-tower models, into sets of MatMuls
+// that do not depend on each other.
+std::vector<HorizontalMatMulFusion> FindHorizontalMatMulFusions(
+    const RemapperContext& ctx, const std::vector<bool>& invalidated_nodes,
+    const std::vector<bool>& nodes_to_delete) {
+  const auto is_known_matrix = [](const TensorShapeProto& shape) {
+    return !shape.unknown_rank() && shape.dim_size() == 2 &&
+           shape.dim(0).size() >= 0 && shape.dim(1).size() >= 0;
+  };
+  std::map<string, std::vector<int>> groups;
+  for (int i = 0; i < static_cast<int>(invalidated_nodes.size()); ++i) {
+    if (invalidated_nodes[i] || nodes_to_delete[i]) continue;
+    const auto* node_view = ctx.graph_view.GetNode(i);
+    const auto* node_def = node_view->node();
+    const DataType dtype = GetDataTypeFromAttr(*node_def, "T");
+    if (!IsMatMul(*node_def) || node_view->NumControllingFanins() > 0 ||
+        IsInPreserveSet(ctx, node_def) ||
+        (dtype != DT_FLOAT && dtype != DT_DOUBLE && dtype != DT_HALF &&
+         dtype != DT_BFLOAT16)) {
+      continue;
+    }
+    const auto& props =
+        ctx.graph_properties.GetInputProperties(node_def->name());
+    if (props.size() != 2 || !is_known_matrix(props[0].shape()) ||
+        !is_known_matrix(props[1].shape())) {
+      continue;
+    }
+    bool transpose_a = false;
+    bool transpose_b = false;
+    TryGetNodeAttr(*node_def, "transpose_a", &transpose_a);
+    TryGetNodeAttr(*node_def, "transpose_b", &transpose_b);
+    const auto& a = props[0].shape();
+    const auto& b = props[1].shape();
+    const int64_t n = b.dim(transpose_b ? 0 : 1).size();
+    if (a.dim(0).size() * a.dim(1).size() * n > kMaxHorizontalMatMulMacs) {
+      continue;
+    }
+    groups[absl::StrCat(node_def->device(), "|", DataTypeString(dtype), "|",
+                        transpose_a ? "T" : "N", transpose_b ? "T" : "N", "|",
+                        a.dim(0).size(), "x", a.dim(1).size(), "|",
+                        b.dim(0).size(), "x", b.dim(1).size())]
+        .push_back(i);
+  }
+
+  std::vector<HorizontalMatMulFusion> fusions;
+  for (const auto& group : groups) {
+    if (group.second.size() < 2) continue;
+    // Members are in topological order, so a MatMul can only depend on the
+    // ones selected before it.
+    absl::flat_hash_set<int> selected;
+    HorizontalMatMulFusion fusion;
+    for (int matmul : group.second) {
+      if (!selected.empty() &&
+          HasAncestorIn(ctx, matmul, selected, group.second.front())) {
+        continue;
+      }
+      selected.insert(matmul);
+      fusion.chains.push_back(GetHorizontalFusionChain(ctx, matmul));
+    }
+    if (fusion.chains.size() < 2) continue;
+
+    // Only fuse the ops that follow every MatMul in the same way.
+    const GraphDef* graph = ctx.graph_view.graph();
+    size_t length = 1;
+    const std::vector<int>& first_chain = fusion.chains.front();
+    for (; length < first_chain.size(); ++length) {
+      const NodeDef& expected = graph->node(first_chain[length]);
+      const bool matches = absl::c_all_of(
+          fusion.chains, [&](const std::vector<int>& chain) {
+            if (chain.size() <= length) return false;
+            const NodeDef& node = graph->node(chain[length]);
+            return node.op() == expected.op() &&
+                   AreAttrValuesEqual(node.attr().at("T"),
+                                      expected.attr().at("T")) &&
+                   (!IsLeakyRelu(node) ||
+                    AreAttrValuesEqual(node.attr().at("alpha"),
+                                       expected.attr().at("alpha")));
+          });
+      if (!matches) break;
+    }
+    for (auto& chain : fusion.chains) chain.resize(length);
+    fusions.push_back(std::move(fusion));
+  }
+  return fusions;
+}
+
+bool FindQuantizedWeightsMatMul(const RemapperContext& ctx, int node_index,
+                                QuantizedWeightsMatMul* matched) {
+  // Root of the pattern must be a float MatMul on CPU.
+  const auto* node_view = ctx.graph_view.GetNode(node_index);
+  const auto* node_def = node_view->node();
+  if (!IsMatMul(*node_def) || !NodeIsOnCpu(node_def) ||
+      !HasDataType(node_def, DT_FLOAT) ||
+      node_view->NumRegularFanins() != 2 || IsInPreserveSet(ctx, node_def)) {
+    return false;
+  }
+  bool transpose_a = false;
+  bool transpose_b = false;
+  TryGetNodeAttr(*node_def, "transpose_a", &transpose_a);
+  TryGetNodeAttr(*node_def, "transpose_b", &transpose_b);
+  if (transpose_a) return false;
+
+  // The weights must be quantized by a QuantizeAndDequantize op that is not
+  // used elsewhere.
+  const auto* quantize_node_view = node_view->GetRegularFanin(1).node_view();
+  const auto* quantize_node_def = quantize_node_view->node();
+  if ((quantize_node_def->op() != "QuantizeAndDequantizeV2" &&
+       quantize_node_def->op() != "QuantizeAndDequantizeV4") ||
+      !HasDataType(quantize_node_def, DT_FLOAT) ||
+      HasControlFaninOrFanout(*quantize_node_view) ||
+      !HasAtMostOneFanoutAtPort0(*quantize_node_view) ||
+      IsInPreserveSet(ctx, quantize_node_def) ||
+      quantize_node_view->NumRegularFanins() != 3) {
+    return false;
+  }
+  bool signed_input = true;
+  int num_bits = 8;
+  bool range_given = false;
+  string round_mode = "HALF_TO_EVEN";
+  bool narrow_range = false;
+  int axis = -1;
+  TryGetNodeAttr(*quantize_node_def, "signed_input", &signed_input);
+  TryGetNodeAttr(*quantize_node_def, "num_bits", &num_bits);
+  TryGetNodeAttr(*quantize_node_def, "range_given", &range_given);
+  TryGetNodeAttr(*quantize_node_def, "round_mode", &round_mode);
+  TryGetNodeAttr(*quantize_node_def, "narrow_range", &narrow_range);
+  TryGetNodeAttr(*quantize_node_def, "axis", &axis);
+  // Only symmetric quantization fits in the signed weights of the kernel.
+  if (!signed_input || num_bits < 2 || num_bits > 8 ||
+      (round_mode != "HALF_TO_EVEN" && round_mode != "HALF_UP")) {
+    return false;
+  }
+
+  // The weights and their range must be constants.
+  Tensor inputs[3];
+  for (int i = 0; i < 3; ++i) {
+    const auto* input_node_def =
+        quantize_node_view->GetRegularFanin(i).node_view()->node();
+    if (!IsConstant(*input_node_def) ||
+        !inputs[i].FromProto(input_node_def->attr().at("value").tensor()) ||
+        inputs[i].dtype() != DT_FLOAT) {
+      return false;
+    }
+  }
+  Tensor weights = inputs[0];
+  if (weights.dims() != 2) return false;
+  // Per-channel quantization must be along the output channels.
+  const int channel_dim = transpose_b ? 0 : 1;
+  if (axis != -1 && axis != channel_dim) return false;
+  const int num_channels = axis == -1 ? 1 : weights.dim_size(channel_dim);
+  if (range_given && (inputs[1].NumElements() != num_channels ||
+                      inputs[2].NumElements() != num_channels)) {
+    return false;
+  }
+  if (transpose_b) {
+    Tensor transposed(DT_FLOAT,
+                      TensorShape({weights.dim_size(1), weights.dim_size(0)}));
+    transposed.matrix<float>() =
+        weights.matrix<float>().shuffle(Eigen::array<int, 2>{1, 0});
+    weights = transposed;
+  }
+
+  QuantizedWeightsMatMul result;
+  if (!QuantizeMatMulWeights(weights, num_bits, narrow_range, range_given,
+                             round_mode == "HALF_UP", inputs[1], inputs[2],
+                             num_channels, &result.weights, &result.scales)) {
+    return false;
+  }
+  result.matmul = node_index;
+  result.quantize = quantize_node_view->node_index();
+  if (num_bits <= 4) {
+    result.weights = PackInt4Weights(result.weights);
+    result.weight_bits = 4;
+  }
+  *matched = std::move(result);
+  return true;
+}
+
+
+// Finds the longest chain of element-wise ops ending at `node_index`. This runs
+// after all other patterns were tried, so `invalidated_nodes` and
+// `nodes_to_delete` exclude nodes that are already fused, and nodes added by
+// the rewrites (past the end of these vectors) are never part of a chain.
+// Requires inferred graph properties.
+bool FindElementwiseChain(RemapperContext* ctx, int node_index,
+                          const std::vector<bool>& invalidated_nodes,
+                          const std::vector<bool>& nodes_to_delete,
+                          ElementwiseChain* matched) {
+  if (ctx->xla_cpu_jit_disable_fusion) return false;
+
+  const auto& ops = FusableElementwiseOps();
+  const auto* root_view = ctx->graph_view.GetNode(node_index);
+  const auto* root_def = root_view->node();
+  if (!ops.contains(root_def->op()) || !NodeIsOnCpu(root_def)) return false;
+  const DataType dtype = GetDataTypeFromAttr(*root_def, "T");
+  if (dtype != DT_FLOAT && dtype != DT_DOUBLE) return false;
+  if (!ctx->inferred_graph_properties) return false;
+
+  // The running value keeps the shape of the root output. The fused kernel
+  // only broadcasts second operands with a single element.
+  const auto& root_props =
+      ctx->graph_properties.GetOutputProperties(root_def->name());
+  if (root_props.size() != 1) return false;
+  const TensorShapeProto& shape = root_props[0].shape();
+  const auto is_single_element = [&shape](const TensorShapeProto& other) {
+    if (other.unknown_rank() || other.dim_size() > shape.dim_size()) {
+      return false;
+    }
+    for (const auto& dim : other.dim()) {
+      if (dim.size() != 1) return false;
+    }
+    return true;
+  };
+
+  // Returns the input ports that can carry the running value into a node, or
+  // none if the node can not be part of the chain. Non-commutative ops must
+  // take the running value as their first operand.
+  const auto value_ports = [&](const utils::MutableNodeView& node_view) {
+    std::vector<int> ports;
+    const NodeDef* node_def = node_view.node();
+    auto it = ops.find(node_def->op());
+    if (it == ops.end() || node_def->device() != root_def->device() ||
+        !NodeIsOnCpu(node_def) || HasControlFaninOrFanout(node_view) ||
+        GetDataTypeFromAttr(*node_def, "T") != dtype) {
+      return ports;
+    }
+    const int num_inputs = it->second == ElementwiseKind::kUnary ? 1 : 2;
+    const auto& props =
+        ctx->graph_properties.GetInputProperties(node_def->name());
+    if (node_view.NumRegularFanins() != num_inputs ||
+        props.size() != num_inputs) {
+      return ports;
+    }
+    const int last_port = it->second == ElementwiseKind::kCommutative ? 1 : 0;
+    for (int port = 0; port <= last_port; ++port) {
+      if (!ShapesSymbolicallyEqual(props[port].shape(), shape)) continue;
+      if (num_inputs == 2 &&
+          !ShapesSymbolicallyEqual(props[1 - port].shape(), shape) &&
+          !is_single_element(props[1 - port].shape())) {
+        continue;
+      }
+      ports.push_back(port);
+    }
+    return ports;
+  };
+
+  std::vector<int> ports = value_ports(*root_view);
+  if (ports.empty()) return false;
+
+  // Walk up the running value while it is produced by another element-wise op
+  // that is only used by the chain.
+  ElementwiseChain chain;
+  chain.nodes.push_back(node_index);
+  const utils::MutableNodeView* node_view = root_view;
+  while (true) {
+    const utils::MutableNodeView* producer = nullptr;
+    std::vector<int> producer_ports;
+    for (int port : ports) {
+      const auto* fanin = node_view->GetRegularFanin(port).node_view();
+      const int fanin_index = fanin->node_index();
+      if (fanin_index >= static_cast<int>(invalidated_nodes.size()) ||
+          invalidated_nodes[fanin_index] || nodes_to_delete[fanin_index] ||
+          !HasAtMostOneFanoutAtPort0(*fanin) ||
+          IsInPreserveSet(*ctx, fanin->node())) {
+        continue;
+      }
+      producer_ports = value_ports(*fanin);
+      if (producer_ports.empty()) continue;
+      producer = fanin;
+      chain.value_ports.push_back(port);
+      break;
+    }
+    if (producer == nullptr) {
+      chain.value_ports.push_back(ports[0]);
+      break;
+    }
+    chain.nodes.push_back(producer->node_index());
+    node_view = producer;
+    ports = std::move(producer_ports);
+  }
+  if (chain.nodes.size() < 2) return false;
+
+  std::reverse(chain.nodes.begin(), chain.nodes.end());
+  std::reverse(chain.value_ports.begin(), chain.value_ports.end());
+  *matched = std::move(chain);
+  return true;
+}
+
 // clang-format off
 // HardSwish pattern
 //                        input     Const (value: 3)
@@ -4377,6 +5238,360 @@ absl::Status AddTensorToHashBucketNode(RemapperContext* ctx,
   return absl::OkStatus();
 }
 
+absl::Status AddStringSplitToHashBucketNode(
+    RemapperContext* ctx, const StringSplitToHashBucket& matched,
+    std::vector<bool>* invalidated_nodes, std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& string_split = graph->node(matched.string_split);
+  const NodeDef& string_to_hash_bucket =
+      graph->node(matched.string_to_hash_bucket);
+  VLOG(2) << "Fuse StringSplitV2 with StringToHashBucketFast:"
+          << " string_split=" << string_split.name()
+          << " string_to_hash_bucket=" << string_to_hash_bucket.name();
+
+  // The fused node takes the place of the StringSplitV2, whose indices and
+  // shape outputs keep their ports. The hash buckets replace its values.
+  NodeDef fused_op;
+  fused_op.set_name(string_split.name());
+  fused_op.set_device(string_split.device());
+  fused_op.add_input(string_split.input(0));  // 0: input
+  fused_op.add_input(string_split.input(1));  // 1: sep
+  fused_op.set_op(kStringSplitToHashBucket);
+
+  auto* attr = fused_op.mutable_attr();
+  (*attr)["maxsplit"] = string_split.attr().at("maxsplit");
+  (*attr)["num_buckets"] = string_to_hash_bucket.attr().at("num_buckets");
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  absl::Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+
+  // Redirect the consumers of the hash buckets to the fused node.
+  auto* hash_node_view = ctx->graph_view.GetNode(matched.string_to_hash_bucket);
+  for (const auto& fanout : hash_node_view->GetRegularFanout(0)) {
+    mutation->AddOrUpdateRegularFanin(fanout.node_view(), fanout.index(),
+                                      {string_split.name(), 1});
+  }
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.string_split] = true;
+  (*nodes_to_delete)[matched.string_to_hash_bucket] = true;
+
+  return absl::OkStatus();
+}
+
+absl::Status AddWeightedSparseSegmentSumNode(
+    RemapperContext* ctx, const WeightedSparseSegmentSum& matched,
+    std::vector<bool>* invalidated_nodes, std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& gather = graph->node(matched.gather);
+  const NodeDef& mul = graph->node(matched.mul);
+  const NodeDef& segment_sum = graph->node(matched.segment_sum);
+  VLOG(2) << "Fuse GatherV2 with Mul and SegmentSum:"
+          << " gather=" << gather.name() << " mul=" << mul.name()
+          << " segment_sum=" << segment_sum.name();
+
+  NodeDef fused_op;
+  fused_op.set_name(segment_sum.name());
+  fused_op.set_device(segment_sum.device());
+  fused_op.add_input(gather.input(0));                   // 0: data
+  fused_op.add_input(gather.input(1));                   // 1: indices
+  fused_op.add_input(mul.input(matched.weights_port));  // 2: weights
+  fused_op.add_input(segment_sum.input(1));              // 3: segment_ids
+  fused_op.set_op(kFusedWeightedSparseSegmentSum);
+
+  auto* attr = fused_op.mutable_attr();
+  (*attr)["T"] = segment_sum.attr().at("T");
+  (*attr)["Tidx"] = gather.attr().at("Tindices");
+  (*attr)["Tsegmentids"] = segment_sum.attr().at("Tindices");
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  absl::Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.segment_sum] = true;
+  (*nodes_to_delete)[matched.mul] = true;
+  (*nodes_to_delete)[matched.gather] = true;
+
+  return absl::OkStatus();
+}
+
+absl::Status AddScaledDotProductAttentionNode(
+    RemapperContext* ctx, const ScaledDotProductAttention& matched,
+    std::vector<bool>* invalidated_nodes, std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& query_key = graph->node(matched.query_key);
+  const NodeDef& softmax = graph->node(matched.softmax);
+  const NodeDef& probs_value = graph->node(matched.probs_value);
+  VLOG(2) << "Fuse BatchMatMul with Softmax and BatchMatMul:"
+          << " query_key=" << query_key.name() << " softmax=" << softmax.name()
+          << " probs_value=" << probs_value.name();
+
+  NodeDef fused_op;
+  fused_op.set_name(probs_value.name());
+  fused_op.set_device(probs_value.device());
+  fused_op.add_input(query_key.input(0));    // 0: query
+  fused_op.add_input(query_key.input(1));    // 1: key
+  fused_op.add_input(probs_value.input(1));  // 2: value
+  fused_op.set_op(kFusedScaledDotProductAttention);
+
+  auto* attr = fused_op.mutable_attr();
+  (*attr)["T"] = probs_value.attr().at("T");
+  SetAttrValue(matched.scale, &(*attr)["scale"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  absl::Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.probs_value] = true;
+  (*nodes_to_delete)[matched.softmax] = true;
+  if (matched.mul != kMissingIndex) (*nodes_to_delete)[matched.mul] = true;
+  (*nodes_to_delete)[matched.query_key] = true;
+
+  return absl::OkStatus();
+}
+absl::Status AddQuantizedWeightsMatMulNode(
+    RemapperContext* ctx, const QuantizedWeightsMatMul& matched,
+    std::vector<bool>* invalidated_nodes, std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& matmul = graph->node(matched.matmul);
+  const NodeDef& quantize = graph->node(matched.quantize);
+  VLOG(2) << "Fuse MatMul with quantized weights:"
+          << " matmul=" << matmul.name() << " quantize=" << quantize.name()
+          << " weight_bits=" << matched.weight_bits;
+
+  // The quantized weights replace the QuantizeAndDequantize op, and still run
+  // after the control dependencies of the original weights.
+  const auto* quantize_view = ctx->graph_view.GetNode(matched.quantize);
+  const NodeDef& original_weights =
+      *quantize_view->GetRegularFanin(0).node_view()->node();
+  std::vector<int> quantize_inputs;
+  for (int i = 0; i < 3; ++i) {
+    quantize_inputs.push_back(
+        quantize_view->GetRegularFanin(i).node_view()->node_index());
+  }
+  const auto add_const = [&](const string& name, const Tensor& value) {
+    NodeDef node;
+    node.set_name(name);
+    node.set_op("Const");
+    node.set_device(quantize.device());
+    for (const string& input : original_weights.input()) {
+      if (IsControlInput(input)) node.add_input(input);
+    }
+    auto* attr = node.mutable_attr();
+    (*attr)["dtype"].set_type(value.dtype());
+    value.AsProtoTensorContent((*attr)["value"].mutable_tensor());
+    return node;
+  };
+  NodeDef weights = add_const(quantize.name(), matched.weights);
+  NodeDef scales =
+      add_const(AddPrefixToNodeName("scales", quantize.name()), matched.scales);
+
+  NodeDef fused_op;
+  fused_op.set_name(matmul.name());
+  fused_op.set_device(matmul.device());
+  fused_op.set_op(kWeightOnlyQuantizedMatMul);
+  fused_op.add_input(matmul.input(0));   // 0: a
+  fused_op.add_input(weights.name());    // 1: b
+  fused_op.add_input(scales.name());     // 2: scales
+  for (const string& input : matmul.input()) {
+    if (IsControlInput(input)) fused_op.add_input(input);
+  }
+  auto* attr = fused_op.mutable_attr();
+  (*attr)["T"] = matmul.attr().at("T");
+  (*attr)["weight_bits"].set_i(matched.weight_bits);
+  (*attr)["group_size"].set_i(0);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  absl::Status status;
+  mutation->AddNode(std::move(weights), &status);
+  TF_RETURN_IF_ERROR(status);
+  mutation->AddNode(std::move(scales), &status);
+  TF_RETURN_IF_ERROR(status);
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.matmul] = true;
+  (*invalidated_nodes)[matched.quantize] = true;
+  // Don't keep the float weights and their range around if nothing else uses
+  // them.
+  for (int input : quantize_inputs) {
+    const auto* input_view = ctx->graph_view.GetNode(input);
+    if (input_view->NumRegularFanouts() == 0 &&
+        input_view->NumControlledFanouts() == 0 &&
+        !IsInPreserveSet(*ctx, input_view->node())) {
+      (*nodes_to_delete)[input] = true;
+    }
+  }
+
+  return absl::OkStatus();
+}
+
+
+absl::Status AddHorizontalMatMulFusionNodes(
+    RemapperContext* ctx, const HorizontalMatMulFusion& matched,
+    std::vector<bool>* invalidated_nodes, std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& first = graph->node(matched.chains[0][0]);
+  const int num_chains = matched.chains.size();
+  const string prefix = AddPrefixToNodeName("horizontal_fusion", first.name());
+  const AttrValue& dtype = first.attr().at("T");
+  VLOG(2) << "Fuse " << num_chains << " MatMuls horizontally: first="
+          << first.name() << " ops_per_matmul=" << matched.chains[0].size();
+
+  // A deque, so that references to the added nodes stay valid.
+  std::deque<NodeDef> new_nodes;
+  const auto add_node = [&](const string& name, const string& op,
+                            std::vector<string> inputs) -> NodeDef& {
+    NodeDef& node = new_nodes.emplace_back();
+    node.set_name(name);
+    node.set_op(op);
+    node.set_device(first.device());
+    for (string& input : inputs) node.add_input(std::move(input));
+    return node;
+  };
+  // Stacks input 'port' of the nodes at 'position' of every chain.
+  const auto add_pack = [&](const string& name, int position, int port) {
+    std::vector<string> inputs;
+    for (const auto& chain : matched.chains) {
+      inputs.push_back(graph->node(chain[position]).input(port));
+    }
+    NodeDef& pack = add_node(name, "Pack", std::move(inputs));
+    auto* attr = pack.mutable_attr();
+    (*attr)["T"] = dtype;
+    SetAttrValue(num_chains, &(*attr)["N"]);
+    SetAttrValue(0, &(*attr)["axis"]);
+    return pack.name();
+  };
+
+  bool transpose_a = false;
+  bool transpose_b = false;
+  TryGetNodeAttr(first, "transpose_a", &transpose_a);
+  TryGetNodeAttr(first, "transpose_b", &transpose_b);
+  NodeDef& batch_matmul =
+      add_node(prefix, "BatchMatMulV2",
+               {add_pack(absl::StrCat(prefix, "/a"), 0, 0),
+                add_pack(absl::StrCat(prefix, "/b"), 0, 1)});
+  (*batch_matmul.mutable_attr())["T"] = dtype;
+  SetAttrValue(transpose_a, &(*batch_matmul.mutable_attr())["adj_x"]);
+  SetAttrValue(transpose_b, &(*batch_matmul.mutable_attr())["adj_y"]);
+  string value = batch_matmul.name();
+
+  const int chain_length = matched.chains[0].size();
+  for (int position = 1; position < chain_length; ++position) {
+    const NodeDef& node = graph->node(matched.chains[0][position]);
+    if (IsBiasAdd(node)) {
+      // Broadcast the [num_chains, n] stacked biases over the rows of every
+      // MatMul output.
+      const string biases =
+          add_pack(absl::StrCat(prefix, "/bias"), position, /*port=*/1);
+      NodeDef& dim = add_node(absl::StrCat(prefix, "/bias_dim"), "Const", {});
+      Tensor dim_value(DT_INT32, TensorShape({}));
+      dim_value.scalar<int32>()() = 1;
+      (*dim.mutable_attr())["dtype"].set_type(DT_INT32);
+      dim_value.AsProtoTensorContent(
+          (*dim.mutable_attr())["value"].mutable_tensor());
+      NodeDef& expand_dims = add_node(absl::StrCat(prefix, "/bias_expanded"),
+                                      "ExpandDims", {biases, dim.name()});
+      (*expand_dims.mutable_attr())["T"] = dtype;
+      (*expand_dims.mutable_attr())["Tdim"].set_type(DT_INT32);
+      NodeDef& add = add_node(absl::StrCat(prefix, "/bias_add"), "AddV2",
+                              {value, expand_dims.name()});
+      (*add.mutable_attr())["T"] = dtype;
+      value = add.name();
+    } else {
+      NodeDef& activation =
+          add_node(absl::StrCat(prefix, "/", node.op()), node.op(), {value});
+      *activation.mutable_attr() = node.attr();
+      value = activation.name();
+    }
+  }
+
+  NodeDef& unpack =
+      add_node(absl::StrCat(prefix, "/unpack"), "Unpack", {value});
+  (*unpack.mutable_attr())["T"] = dtype;
+  SetAttrValue(num_chains, &(*unpack.mutable_attr())["num"]);
+  SetAttrValue(0, &(*unpack.mutable_attr())["axis"]);
+
+  // The last node of every chain forwards its slice of the result.
+  for (int i = 0; i < num_chains; ++i) {
+    const NodeDef& last = graph->node(matched.chains[i].back());
+    NodeDef& identity = add_node(last.name(), "Identity",
+                                 {absl::StrCat(unpack.name(), ":", i)});
+    identity.set_device(last.device());
+    (*identity.mutable_attr())["T"] = dtype;
+  }
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  absl::Status status;
+  for (NodeDef& node : new_nodes) {
+    mutation->AddNode(std::move(node), &status);
+    TF_RETURN_IF_ERROR(status);
+  }
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  for (const auto& chain : matched.chains) {
+    (*invalidated_nodes)[chain.back()] = true;
+    for (int i = 0; i + 1 < chain.size(); ++i) {
+      (*nodes_to_delete)[chain[i]] = true;
+    }
+  }
+
+  return absl::OkStatus();
+}
+
+absl::Status AddElementwiseChainNode(RemapperContext* ctx,
+                                     const ElementwiseChain& matched,
+                                     std::vector<bool>* invalidated_nodes,
+                                     std::vector<bool>* nodes_to_delete) {
+  const GraphDef* graph = ctx->graph_view.graph();
+  const NodeDef& root = graph->node(matched.nodes.back());
+
+  NodeDef fused_op;
+  fused_op.set_name(root.name());
+  fused_op.set_device(root.device());
+  fused_op.set_op(kFusedElementwise);
+
+  // The first node contributes the initial running value, every binary node
+  // its other operand.
+  std::vector<string> op_names;
+  std::vector<string> node_names;
+  for (int i = 0; i < matched.nodes.size(); ++i) {
+    const NodeDef& node = graph->node(matched.nodes[i]);
+    const int port = matched.value_ports[i];
+    if (i == 0) fused_op.add_input(node.input(port));
+    if (node.input_size() == 2) fused_op.add_input(node.input(1 - port));
+    op_names.push_back(node.op());
+    node_names.push_back(node.name());
+  }
+  VLOG(2) << "Fuse element-wise ops: nodes=[" << absl::StrJoin(node_names, ", ")
+          << "] ops=[" << absl::StrJoin(op_names, ", ") << "]";
+
+  auto* attr = fused_op.mutable_attr();
+  (*attr)["T"] = root.attr().at("T");
+  SetAttrValue(fused_op.input_size(), &(*attr)["num_args"]);
+  SetAttrValue(op_names, &(*attr)["op_names"]);
+
+  utils::Mutation* mutation = ctx->graph_view.GetMutationBuilder();
+  absl::Status status;
+  mutation->AddNode(std::move(fused_op), &status);
+  TF_RETURN_IF_ERROR(status);
+  TF_RETURN_IF_ERROR(mutation->Apply());
+
+  (*invalidated_nodes)[matched.nodes.back()] = true;
+  for (int i = 0; i + 1 < matched.nodes.size(); ++i) {
+    (*nodes_to_delete)[matched.nodes[i]] = true;
+  }
+
+  return absl::OkStatus();
+}
+
 absl::Status AddFusedBatchMatMul(RemapperContext* ctx,
                                  const std::map<string, int>& matched_nodes_map,
                                  const std::set<int>& remove_node_indices,
@@ -4850,17 +6065,39 @@ bool RequiresInferredShapes(const RemapperContext& ctx, int node_index,
     return true;
   };
 
+  // Candidate for a _FusedWeightedSparseSegmentSum fusion.
+  const auto is_weighted_sparse_segment_sum_candidate = [&]() -> bool {
+    if (node_def->op() != "SegmentSum" || !NodeIsOnCpu(node_def)) return false;
+    if (node_view->NumRegularFanins() < 1) return false;
+    return IsMul(*node_view->GetRegularFanin(0).node_view()->node());
+  };
+
+  // Candidate for a _FusedScaledDotProductAttention fusion.
+  const auto is_scaled_dot_product_attention_candidate = [&]() -> bool {
+    if (node_def->op() != "BatchMatMul" && node_def->op() != "BatchMatMulV2") {
+      return false;
+    }
+    if (!NodeIsOnCpu(node_def) || node_view->NumRegularFanins() < 1) {
+      return false;
+    }
+    return IsSoftmax(*node_view->GetRegularFanin(0).node_view()->node());
+  };
+
   if (IsMKLEnabled())
     return is_batch_norm_candidate() || is_batch_norm_fusion_candidate() ||
            IsContractionWithAdd(ctx, node_index) ||
            is_act_biasadd_conv_candidate() || IsBiasAdd(*node_def) ||
-           IsTranspose(*node_def);
+           IsTranspose(*node_def) ||
+           is_weighted_sparse_segment_sum_candidate() ||
+           is_scaled_dot_product_attention_candidate();
 
   return is_act_biasadd_conv_candidate() || is_batch_norm_candidate() ||
          is_batch_norm_fusion_candidate() ||
          is_batch_norm_grad_fusion_candidate() ||
          is_matmul_gelu_exact_fusion_candidate() ||
-         is_act_biasadd_matmul_candidate();
+         is_act_biasadd_matmul_candidate() ||
+         is_weighted_sparse_segment_sum_candidate() ||
+         is_scaled_dot_product_attention_candidate();
 }
 
 inline bool IsXlaCpuGlobalJitOn() {
@@ -4901,6 +6138,44 @@ absl::Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
   bool allow_non_differentiable_rewrites =
       item.optimization_options().allow_non_differentiable_rewrites;
 
+  // Remap MatMuls of quantized constant weights into
+  // WeightOnlyQuantizedMatMul first, so that the contraction patterns below
+  // don't take the MatMuls away. The int8 weights are a quarter of the size of
+  // the dequantized ones, which matters more than fusing the BiasAdd when the
+  // MatMul is bound by the memory traffic of the weights.
+  if (allow_non_differentiable_rewrites && !ctx.xla_cpu_jit_disable_fusion) {
+    for (int i = 0; i < num_nodes; ++i) {
+      QuantizedWeightsMatMul quantized_weights_matmul;
+      if (FindQuantizedWeightsMatMul(ctx, i, &quantized_weights_matmul)) {
+        TF_RETURN_IF_ERROR(AddQuantizedWeightsMatMulNode(
+            &ctx, quantized_weights_matmul, &invalidated_nodes,
+            &nodes_to_delete));
+      }
+    }
+  }
+
+  // Stack independent MatMuls of the same shapes, e.g. of the towers of
+  // multi-tower models, into one BatchMatMulV2, so that many small kernels
+  // become one large one. Stacking the inputs costs extra copies, so it is
+  // only done at the aggressive level.
+  if (opt_level_ == RewriterConfig::AGGRESSIVE &&
+      !ctx.xla_cpu_jit_disable_fusion) {
+    if (!ctx.inferred_graph_properties) {
+      TF_RETURN_IF_ERROR(ctx.graph_properties.InferStatically(
+          /*assume_valid_feeds=*/true,
+          /*aggressive_shape_inference=*/false,
+          /*include_input_tensor_values=*/true,
+          /*include_output_tensor_values=*/false));
+      ctx.inferred_graph_properties = true;
+    }
+    for (const HorizontalMatMulFusion& horizontal_fusion :
+         FindHorizontalMatMulFusions(ctx, invalidated_nodes,
+                                     nodes_to_delete)) {
+      TF_RETURN_IF_ERROR(AddHorizontalMatMulFusionNodes(
+          &ctx, horizontal_fusion, &invalidated_nodes, &nodes_to_delete));
+    }
+  }
+
   for (int i = num_nodes - 1; i >= 0; --i) {
     // Check if node was invalidated by one of the previous remaps.
     if (invalidated_nodes[i] || nodes_to_delete[i]) {
@@ -5223,6 +6498,39 @@ absl::Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
       continue;
     }
 
+    // Remap StringSplitV2+StringToHashBucketFast into the
+    // _StringSplitToHashBucketFast.
+    StringSplitToHashBucket string_split_to_hash_bucket;
+    if (allow_non_differentiable_rewrites &&
+        FindStringSplitToHashBucket(ctx, i, &string_split_to_hash_bucket)) {
+      TF_RETURN_IF_ERROR(AddStringSplitToHashBucketNode(
+          &ctx, string_split_to_hash_bucket, &invalidated_nodes,
+          &nodes_to_delete));
+      continue;
+    }
+
+    // Remap GatherV2+Mul+SegmentSum into the _FusedWeightedSparseSegmentSum.
+    WeightedSparseSegmentSum weighted_sparse_segment_sum;
+    if (allow_non_differentiable_rewrites &&
+        FindWeightedSparseSegmentSum(&ctx, i, &weighted_sparse_segment_sum)) {
+      TF_RETURN_IF_ERROR(AddWeightedSparseSegmentSumNode(
+          &ctx, weighted_sparse_segment_sum, &invalidated_nodes,
+          &nodes_to_delete));
+      continue;
+    }
+
+    // Remap BatchMatMul+Mul+Softmax+BatchMatMul into the
+    // _FusedScaledDotProductAttention.
+    ScaledDotProductAttention scaled_dot_product_attention;
+    if (allow_non_differentiable_rewrites &&
+        FindScaledDotProductAttention(&ctx, i,
+                                      &scaled_dot_product_attention)) {
+      TF_RETURN_IF_ERROR(AddScaledDotProductAttentionNode(
+          &ctx, scaled_dot_product_attention, &invalidated_nodes,
+          &nodes_to_delete));
+      continue;
+    }
+
     // During inference, most of the inputs to FusedBatchNorm are constant, and
     // we can therefore replace the op with a much cheaper set of primitives.
     FusedBatchNorm fused_batch_norm;
@@ -5232,6 +6540,33 @@ absl::Status Remapper::Optimize(Cluster* cluster, const GrapplerItem& item,
     }
   }
 
+  // Remap the remaining chains of element-wise ops into _FusedElementwise. This
+  // runs as a separate pass, so that it never takes nodes away from the
+  // patterns above, whose roots may come later in the chain.
+  if (allow_non_differentiable_rewrites) {
+    for (int i = num_nodes - 1; i >= 0; --i) {
+      if (invalidated_nodes[i] || nodes_to_delete[i]) continue;
+      if (!ctx.inferred_graph_properties &&
+          FusableElementwiseOps().contains(
+              ctx.graph_view.GetNode(i)->node()->op())) {
+        const bool assume_valid_feeds =
+            opt_level_ == RewriterConfig::AGGRESSIVE;
+        TF_RETURN_IF_ERROR(ctx.graph_properties.InferStatically(
+            assume_valid_feeds,
+            /*aggressive_shape_inference=*/false,
+            /*include_input_tensor_values=*/true,
+            /*include_output_tensor_values=*/false));
+        ctx.inferred_graph_properties = true;
+      }
+      ElementwiseChain elementwise_chain;
+      if (FindElementwiseChain(&ctx, i, invalidated_nodes, nodes_to_delete,
+                               &elementwise_chain)) {
+        TF_RETURN_IF_ERROR(AddElementwiseChainNode(
+            &ctx, elementwise_chain, &invalidated_nodes, &nodes_to_delete));
+      }
+    }
+  }
+
   // Remove invalidated nodes.
   utils::Mutation* mutation = ctx.graph_view.GetMutationBuilder();
   for (int i = 0; i < num_nodes; ++i) {
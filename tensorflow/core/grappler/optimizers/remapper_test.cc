@@ -1767,6 +1767,463 @@ TEST_F(RemapperTensorToHashBucketTest, I32) { RunTest<DT_INT32>(); }
 
 TEST_F(RemapperTensorToHashBucketTest, I64) { RunTest<DT_INT64>(); }
 
+TEST_F(RemapperTest, StringSplitToHashBucket) {
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  auto input = ops::Placeholder(s.WithOpName("input"), DT_STRING,
+                                ops::Placeholder::Shape({3}));
+  auto sep = ops::Const(s.WithOpName("sep"), tstring(","), {});
+  auto split = ops::StringSplitV2(s.WithOpName("split"), input, sep);
+  int num_buckets = 100;
+  auto to_bucket = ops::StringToHashBucketFast(s.WithOpName("to_bucket"),
+                                               split.values, num_buckets);
+  auto indices = ops::Identity(s.WithOpName("indices"), split.indices);
+  auto values = ops::Identity(s.WithOpName("values"), to_bucket);
+  auto shape = ops::Identity(s.WithOpName("shape"), split.shape);
+
+  auto input_t = test::AsTensor<tstring>({"a,b,c", "", "d,,e"});
+
+  GrapplerItem item;
+  item.fetch = {"indices", "values", "shape"};
+  item.feed = {{"input", input_t}};
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::ON);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "to_bucket");
+    if (node.name() == "split") {
+      EXPECT_EQ(node.op(), "_StringSplitToHashBucketFast");
+      ASSERT_EQ(node.input_size(), 2);
+      EXPECT_EQ(node.input(0), "input");
+      EXPECT_EQ(node.input(1), "sep");
+      EXPECT_EQ(node.attr().at("num_buckets").i(), num_buckets);
+      found++;
+    }
+    if (node.name() == "values") {
+      ASSERT_EQ(node.input_size(), 1);
+      EXPECT_EQ(node.input(0), "split:1");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 2);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), 3);
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), 3);
+  for (int i = 0; i < 3; ++i) {
+    test::ExpectTensorEqual<int64_t>(tensors[i], tensors_expected[i]);
+  }
+}
+
+class RemapperWeightedSparseSegmentSumTest : public RemapperTest {
+ public:
+  template <DataType DTYPE>
+  void RunTest() {
+    using ::tensorflow::ops::Placeholder;
+
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+    auto data = Placeholder(s.WithOpName("data"), DTYPE,
+                            ops::Placeholder::Shape({10, 4}));
+    auto weights = Placeholder(s.WithOpName("weights"), DTYPE,
+                               ops::Placeholder::Shape({6, 1}));
+    auto indices = ops::Const(s.WithOpName("indices"), {7, 1, 7, 0, 9, 3});
+    auto segment_ids =
+        ops::Const(s.WithOpName("segment_ids"), {0, 0, 1, 1, 1, 3});
+    auto axis = ops::Const(s.WithOpName("axis"), 0);
+    auto gather = ops::GatherV2(s.WithOpName("gather"), data, indices, axis);
+    auto mul = ops::Mul(s.WithOpName("mul"), gather, weights);
+    auto segment_sum =
+        ops::SegmentSum(s.WithOpName("segment_sum"), mul, segment_ids);
+    auto fetch = ops::Identity(s.WithOpName("fetch"), segment_sum);
+
+    auto data_t = GenerateRandomTensor<DTYPE>({10, 4});
+    auto weights_t = GenerateRandomTensor<DTYPE>({6, 1});
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    item.feed = {{"data", data_t}, {"weights", weights_t}};
+    TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+    // Place all nodes on CPU.
+    for (int i = 0; i < item.graph.node_size(); ++i) {
+      item.graph.mutable_node(i)->set_device("/device:CPU:0");
+    }
+
+    Remapper optimizer(RewriterConfig::AGGRESSIVE);  // trust placeholders shape
+    GraphDef output;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+    int found = 0;
+    for (const NodeDef& node : output.node()) {
+      EXPECT_NE(node.name(), "gather");
+      EXPECT_NE(node.name(), "mul");
+      if (node.name() == "segment_sum") {
+        EXPECT_EQ(node.op(), "_FusedWeightedSparseSegmentSum");
+        ASSERT_EQ(node.input_size(), 4);
+        EXPECT_EQ(node.input(0), "data");
+        EXPECT_EQ(node.input(1), "indices");
+        EXPECT_EQ(node.input(2), "weights");
+        EXPECT_EQ(node.input(3), "segment_ids");
+        found++;
+      }
+    }
+    EXPECT_EQ(found, 1);
+
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+    ASSERT_EQ(tensors_expected.size(), 1);
+    auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+    ASSERT_EQ(tensors.size(), 1);
+    test::ExpectTensorNear<typename EnumToDataType<DTYPE>::Type>(
+        tensors[0], tensors_expected[0], 1e-6);
+  }
+};
+
+TEST_F(RemapperWeightedSparseSegmentSumTest, F32) { RunTest<DT_FLOAT>(); }
+
+TEST_F(RemapperWeightedSparseSegmentSumTest, F64) { RunTest<DT_DOUBLE>(); }
+
+class RemapperScaledDotProductAttentionTest : public RemapperTest {
+ public:
+  template <DataType DTYPE>
+  void RunTest() {
+    using ::tensorflow::ops::Placeholder;
+    using T = typename EnumToDataType<DTYPE>::Type;
+
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+    // More queries and keys than fit in one block of the fused kernel.
+    auto query = Placeholder(s.WithOpName("query"), DTYPE,
+                             ops::Placeholder::Shape({2, 70, 8}));
+    auto key = Placeholder(s.WithOpName("key"), DTYPE,
+                           ops::Placeholder::Shape({2, 300, 8}));
+    auto value = Placeholder(s.WithOpName("value"), DTYPE,
+                             ops::Placeholder::Shape({2, 300, 4}));
+    auto scores = ops::BatchMatMulV2(s.WithOpName("scores"), query, key,
+                                     ops::BatchMatMulV2::AdjY(true));
+    auto scale = ops::Const(s.WithOpName("scale"), static_cast<T>(0.25));
+    auto scaled = ops::Mul(s.WithOpName("scaled"), scores, scale);
+    auto probs = ops::Softmax(s.WithOpName("probs"), scaled);
+    auto attention =
+        ops::BatchMatMulV2(s.WithOpName("attention"), probs, value);
+    auto fetch = ops::Identity(s.WithOpName("fetch"), attention);
+
+    auto query_t = GenerateRandomTensor<DTYPE>({2, 70, 8});
+    auto key_t = GenerateRandomTensor<DTYPE>({2, 300, 8});
+    auto value_t = GenerateRandomTensor<DTYPE>({2, 300, 4});
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    item.feed = {{"query", query_t}, {"key", key_t}, {"value", value_t}};
+    TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+    // Place all nodes on CPU.
+    for (int i = 0; i < item.graph.node_size(); ++i) {
+      item.graph.mutable_node(i)->set_device("/device:CPU:0");
+    }
+
+    Remapper optimizer(RewriterConfig::AGGRESSIVE);  // trust placeholders shape
+    GraphDef output;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+    int found = 0;
+    for (const NodeDef& node : output.node()) {
+      EXPECT_NE(node.name(), "scores");
+      EXPECT_NE(node.name(), "scaled");
+      EXPECT_NE(node.name(), "probs");
+      if (node.name() == "attention") {
+        EXPECT_EQ(node.op(), "_FusedScaledDotProductAttention");
+        ASSERT_EQ(node.input_size(), 3);
+        EXPECT_EQ(node.input(0), "query");
+        EXPECT_EQ(node.input(1), "key");
+        EXPECT_EQ(node.input(2), "value");
+        EXPECT_EQ(node.attr().at("scale").f(), 0.25f);
+        found++;
+      }
+    }
+    EXPECT_EQ(found, 1);
+
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+    ASSERT_EQ(tensors_expected.size(), 1);
+    auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+    ASSERT_EQ(tensors.size(), 1);
+    test::ExpectTensorNear<T>(tensors[0], tensors_expected[0], 1e-5);
+  }
+};
+
+TEST_F(RemapperScaledDotProductAttentionTest, F32) { RunTest<DT_FLOAT>(); }
+
+TEST_F(RemapperScaledDotProductAttentionTest, F64) { RunTest<DT_DOUBLE>(); }
+
+class RemapperQuantizedWeightsMatMulTest : public RemapperTest {
+ public:
+  void RunTest(int num_bits, bool range_given, int axis, bool transpose_b) {
+    using ::tensorflow::ops::Placeholder;
+
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+    // An odd number of rows of weights, so that 4-bit packing has a partially
+    // filled byte.
+    const int k = 15;
+    const int n = 6;
+    const TensorShape weights_shape =
+        transpose_b ? TensorShape({n, k}) : TensorShape({k, n});
+    auto x = Placeholder(s.WithOpName("x"), DT_FLOAT,
+                         ops::Placeholder::Shape({3, k}));
+    auto weights = ops::Const(s.WithOpName("weights"),
+                              GenerateRandomTensor<DT_FLOAT>(weights_shape));
+    auto range = [&](const string& name, float value) {
+      return ops::Const(s.WithOpName(name),
+                        Input::Initializer(value, axis == -1
+                                                      ? TensorShape({})
+                                                      : TensorShape({n})));
+    };
+    auto quantize = ops::QuantizeAndDequantizeV4(
+        s.WithOpName("quantize"), weights, range("min", -0.5f),
+        range("max", 0.5f),
+        ops::QuantizeAndDequantizeV4::NumBits(num_bits)
+            .RangeGiven(range_given)
+            .NarrowRange(true)
+            .Axis(axis));
+    auto matmul = ops::MatMul(s.WithOpName("matmul"), x, quantize,
+                              ops::MatMul::TransposeB(transpose_b));
+    auto fetch = ops::Identity(s.WithOpName("fetch"), matmul);
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    item.feed = {{"x", GenerateRandomTensor<DT_FLOAT>({3, k})}};
+    TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+    // Place all nodes on CPU.
+    for (int i = 0; i < item.graph.node_size(); ++i) {
+      item.graph.mutable_node(i)->set_device("/device:CPU:0");
+    }
+
+    Remapper optimizer(RewriterConfig::ON);
+    GraphDef output;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+    int found = 0;
+    for (const NodeDef& node : output.node()) {
+      EXPECT_NE(node.name(), "weights");
+      if (node.name() == "matmul") {
+        EXPECT_EQ(node.op(), "WeightOnlyQuantizedMatMul");
+        ASSERT_EQ(node.input_size(), 3);
+        EXPECT_EQ(node.input(0), "x");
+        EXPECT_EQ(node.input(1), "quantize");
+        EXPECT_EQ(node.input(2), "scales/quantize");
+        EXPECT_EQ(node.attr().at("weight_bits").i(), num_bits <= 4 ? 4 : 8);
+        found++;
+      } else if (node.name() == "quantize") {
+        EXPECT_EQ(node.op(), "Const");
+        EXPECT_EQ(node.attr().at("dtype").type(), DT_INT8);
+        found++;
+      } else if (node.name() == "scales/quantize") {
+        Tensor scales;
+        ASSERT_TRUE(scales.FromProto(node.attr().at("value").tensor()));
+        EXPECT_EQ(scales.shape(), TensorShape({1, n}));
+        found++;
+      }
+    }
+    EXPECT_EQ(found, 3);
+
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+    ASSERT_EQ(tensors_expected.size(), 1);
+    auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+    ASSERT_EQ(tensors.size(), 1);
+    test::ExpectTensorNear<float>(tensors[0], tensors_expected[0], 1e-5);
+  }
+};
+
+TEST_F(RemapperQuantizedWeightsMatMulTest, PerTensor) {
+  RunTest(/*num_bits=*/8, /*range_given=*/false, /*axis=*/-1,
+          /*transpose_b=*/false);
+}
+
+TEST_F(RemapperQuantizedWeightsMatMulTest, PerChannelRangeGiven) {
+  RunTest(/*num_bits=*/8, /*range_given=*/true, /*axis=*/1,
+          /*transpose_b=*/false);
+}
+
+TEST_F(RemapperQuantizedWeightsMatMulTest, PerChannelTransposed) {
+  RunTest(/*num_bits=*/8, /*range_given=*/false, /*axis=*/0,
+          /*transpose_b=*/true);
+}
+
+TEST_F(RemapperQuantizedWeightsMatMulTest, FourBits) {
+  RunTest(/*num_bits=*/4, /*range_given=*/true, /*axis=*/-1,
+          /*transpose_b=*/false);
+}
+
+TEST_F(RemapperTest, HorizontalMatMulFusion) {
+  using ::tensorflow::ops::Placeholder;
+
+  tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+  // Three identical towers of MatMul + BiasAdd + Relu.
+  const int num_towers = 3;
+  std::vector<Output> relus;
+  std::vector<string> fetch;
+  GrapplerItem item;
+  for (int i = 0; i < num_towers; ++i) {
+    const string x_name = absl::StrCat("x", i);
+    auto x = Placeholder(s.WithOpName(x_name), DT_FLOAT,
+                         ops::Placeholder::Shape({4, 8}));
+    auto w = ops::Const(s.WithOpName(absl::StrCat("w", i)),
+                        GenerateRandomTensor<DT_FLOAT>({8, 16}));
+    auto bias = ops::Const(s.WithOpName(absl::StrCat("bias", i)),
+                           GenerateRandomTensor<DT_FLOAT>({16}));
+    auto matmul = ops::MatMul(s.WithOpName(absl::StrCat("matmul", i)), x, w);
+    auto bias_add =
+        ops::BiasAdd(s.WithOpName(absl::StrCat("bias_add", i)), matmul, bias);
+    relus.push_back(ops::Relu(s.WithOpName(absl::StrCat("relu", i)), bias_add));
+    fetch.push_back(absl::StrCat("fetch", i));
+    ops::Identity(s.WithOpName(fetch.back()), relus.back());
+    item.feed.emplace_back(x_name, GenerateRandomTensor<DT_FLOAT>({4, 8}));
+  }
+  // A MatMul of the same shapes that depends on the first tower can not be
+  // fused with it.
+  auto sliced = ops::Slice(s.WithOpName("sliced"), relus[0], {0, 0}, {4, 8});
+  auto w = ops::Const(s.WithOpName("w"),
+                      GenerateRandomTensor<DT_FLOAT>({8, 16}));
+  auto dependent = ops::MatMul(s.WithOpName("dependent"), sliced, w);
+  fetch.push_back("fetch");
+  ops::Identity(s.WithOpName(fetch.back()), dependent);
+
+  item.fetch = fetch;
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+  // Place all nodes on CPU.
+  for (int i = 0; i < item.graph.node_size(); ++i) {
+    item.graph.mutable_node(i)->set_device("/device:CPU:0");
+  }
+
+  Remapper optimizer(RewriterConfig::AGGRESSIVE);
+  GraphDef output;
+  TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+  int found = 0;
+  for (const NodeDef& node : output.node()) {
+    EXPECT_NE(node.name(), "matmul1");
+    EXPECT_NE(node.name(), "bias_add1");
+    if (node.name() == "horizontal_fusion/matmul0") {
+      EXPECT_EQ(node.op(), "BatchMatMulV2");
+      found++;
+    } else if (node.name() == "relu1") {
+      EXPECT_EQ(node.op(), "Identity");
+      ASSERT_EQ(node.input_size(), 1);
+      EXPECT_EQ(node.input(0), "horizontal_fusion/matmul0/unpack:1");
+      found++;
+    } else if (node.name() == "dependent") {
+      EXPECT_EQ(node.op(), "MatMul");
+      found++;
+    }
+  }
+  EXPECT_EQ(found, 3);
+
+  auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+  ASSERT_EQ(tensors_expected.size(), fetch.size());
+  auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+  ASSERT_EQ(tensors.size(), fetch.size());
+  for (int i = 0; i < fetch.size(); ++i) {
+    test::ExpectTensorNear<float>(tensors[i], tensors_expected[i], 1e-5);
+  }
+}
+
+class RemapperFusedElementwiseTest : public RemapperTest {
+ public:
+  template <DataType DTYPE>
+  void RunTest() {
+    using ::tensorflow::ops::Placeholder;
+    using T = typename EnumToDataType<DTYPE>::Type;
+
+    tensorflow::Scope s = tensorflow::Scope::NewRootScope();
+
+    auto shape = ops::Placeholder::Shape({4, 37});
+    auto x = Placeholder(s.WithOpName("x"), DTYPE, shape);
+    auto y = Placeholder(s.WithOpName("y"), DTYPE, shape);
+    auto z = Placeholder(s.WithOpName("z"), DTYPE, shape);
+    auto w = Placeholder(s.WithOpName("w"), DTYPE, shape);
+    auto one = ops::Const(s.WithOpName("one"), static_cast<T>(1));
+    auto mul = ops::Mul(s.WithOpName("mul"), x, y);
+    // The running value is the second operand of the commutative AddV2.
+    auto add = ops::AddV2(s.WithOpName("add"), z, mul);
+    auto tanh = ops::Tanh(s.WithOpName("tanh"), add);
+    auto sub = ops::Sub(s.WithOpName("sub"), tanh, one);
+    // The running value is the second operand of Sub, which ends the chain
+    // starting at `mul`, and `square` is used twice and can not be fused.
+    auto square = ops::Square(s.WithOpName("square"), w);
+    auto sub2 = ops::Sub(s.WithOpName("sub2"), sub, square);
+    auto div = ops::RealDiv(s.WithOpName("div"), square, sub2);
+    auto fetch = ops::Identity(s.WithOpName("fetch"), div);
+
+    auto x_t = GenerateRandomTensor<DTYPE>({4, 37});
+    auto y_t = GenerateRandomTensor<DTYPE>({4, 37});
+    auto z_t = GenerateRandomTensor<DTYPE>({4, 37});
+    auto w_t = GenerateRandomTensor<DTYPE>({4, 37});
+
+    GrapplerItem item;
+    item.fetch = {"fetch"};
+    item.feed = {{"x", x_t}, {"y", y_t}, {"z", z_t}, {"w", w_t}};
+    TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+
+    // Place all nodes on CPU.
+    for (int i = 0; i < item.graph.node_size(); ++i) {
+      item.graph.mutable_node(i)->set_device("/device:CPU:0");
+    }
+
+    Remapper optimizer(RewriterConfig::AGGRESSIVE);  // trust placeholders shape
+    GraphDef output;
+    TF_ASSERT_OK(optimizer.Optimize(nullptr, item, &output));
+
+    int found = 0;
+    for (const NodeDef& node : output.node()) {
+      EXPECT_NE(node.name(), "mul");
+      EXPECT_NE(node.name(), "add");
+      EXPECT_NE(node.name(), "tanh");
+      EXPECT_NE(node.name(), "sub");
+      if (node.name() == "sub2") {
+        EXPECT_EQ(node.op(), "_FusedElementwise");
+        ASSERT_EQ(node.input_size(), 5);
+        EXPECT_EQ(node.input(0), "x");
+        EXPECT_EQ(node.input(1), "y");
+        EXPECT_EQ(node.input(2), "z");
+        EXPECT_EQ(node.input(3), "one");
+        EXPECT_EQ(node.input(4), "square");
+        EXPECT_EQ(node.attr().at("num_args").i(), 5);
+        const auto& op_names = node.attr().at("op_names").list().s();
+        EXPECT_EQ(std::vector<string>(op_names.begin(), op_names.end()),
+                  std::vector<string>({"Mul", "AddV2", "Tanh", "Sub", "Sub"}));
+        found++;
+      }
+      if (node.name() == "square" || node.name() == "div") {
+        EXPECT_NE(node.op(), "_FusedElementwise");
+        found++;
+      }
+    }
+    EXPECT_EQ(found, 3);
+
+    auto tensors_expected = EvaluateNodes(item.graph, item.fetch, item.feed);
+    ASSERT_EQ(tensors_expected.size(), 1);
+    auto tensors = EvaluateNodes(output, item.fetch, item.feed);
+    ASSERT_EQ(tensors.size(), 1);
+    test::ExpectTensorNear<T>(tensors[0], tensors_expected[0], 1e-5);
+  }
+};
+
+TEST_F(RemapperFusedElementwiseTest, F32) { RunTest<DT_FLOAT>(); }
+
+TEST_F(RemapperFusedElementwiseTest, F64) { RunTest<DT_DOUBLE>(); }
+
 class RemapperFuseMatMulWithBiasTest : public RemapperTest {
  public:
   template <DataType DTYPE>
@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/grappler/grappler_item.h"
 #include "tensorflow/core/grappler/op_types.h"
 #include "tensorflow/core/grappler/utils/frame.h"
+#include "tensorflow/core/grappler/utils/topological_sort.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 
 // Like TF_RETURN_IF_ERROR, but also logs a WARNING.
@@ -896,7 +897,7 @@ class UnaryElementwiseRewriter : public ScopedAllocatorOptimizer::Rewriter {
 
 ScopedAllocatorOptimizer::ScopedAllocatorOptimizer(
     RewriterConfig::Toggle opt_level, const ScopedAllocatorOptions& opts)
-    : opt_level_(opt_level) {
+    : opt_level_(opt_level), max_bucket_bytes_(opts.max_bucket_bytes()) {
   VLOG(1) << "ScopedAllocatorOptimizer::ScopedAllocatorOptimizer";
   Rewriter* r = new UnaryElementwiseRewriter();
   to_delete_.push_back(r);
@@ -1069,6 +1070,44 @@ void PartitionByLoopStructure(const FrameView& frame_view,
   }
 }
 
+// Returns the number of bytes of the first input of `node`, or 0 if its shape
+// is not fully known.
+int64_t InputBytes(const GraphProperties& graph_properties,
+                   const NodeDef& node) {
+  const std::vector<OpInfo::TensorProperties>& props =
+      graph_properties.GetInputProperties(node.name());
+  if (props.empty()) return 0;
+  const PartialTensorShape shape(props[0].shape());
+  if (!shape.IsFullyDefined()) return 0;
+  return shape.num_elements() * DataTypeSize(props[0].dtype());
+}
+
+// Splits `nodes` into buckets whose inputs take at most `max_bucket_bytes`
+// bytes in total, in the order given by `topo_index`, which is the order in
+// which the nodes become ready to run.  A node larger than the limit gets a
+// bucket of its own.
+void PartitionBySize(const GraphProperties& graph_properties,
+                     const absl::flat_hash_map<const NodeDef*, int>& topo_index,
+                     int64_t max_bucket_bytes, std::vector<NodeDef*> nodes,
+                     std::vector<std::vector<NodeDef*>>* buckets) {
+  std::stable_sort(nodes.begin(), nodes.end(),
+                   [&topo_index](const NodeDef* a, const NodeDef* b) {
+                     return topo_index.at(a) < topo_index.at(b);
+                   });
+  if (nodes.empty()) return;
+  buckets->emplace_back();
+  int64_t bucket_bytes = 0;
+  for (NodeDef* nd : nodes) {
+    const int64_t bytes = InputBytes(graph_properties, *nd);
+    if (!buckets->back().empty() && bucket_bytes + bytes > max_bucket_bytes) {
+      buckets->emplace_back();
+      bucket_bytes = 0;
+    }
+    buckets->back().push_back(nd);
+    bucket_bytes += bytes;
+  }
+}
+
 // Identify outputs that are inputs to multiple sets of nodes.
 void IdentifyRepeatedInputs(const std::vector<NodeDef*>& nodes,
                             absl::flat_hash_set<string>* seen_outputs,
@@ -1102,6 +1141,17 @@ absl::Status ScopedAllocatorOptimizer::ProcessGraphDef(
     // TODO(ezhulenev): Pass a GraphView when this optimizer will be migrated
     // from NodeMap.
     LOG_WARNING_AND_RETURN_IF_ERROR(frame_view.InferFromGraph(*graph));
+    // Position of every node in a topological order of the graph, used to cut
+    // the op groups into buckets.  Empty if bucketing is off.
+    absl::flat_hash_map<const NodeDef*, int> topo_index;
+    if (max_bucket_bytes_ > 0) {
+      std::vector<const NodeDef*> topo_order;
+      LOG_WARNING_AND_RETURN_IF_ERROR(
+          ComputeTopologicalOrder(*graph, &topo_order));
+      for (int i = 0; i < static_cast<int>(topo_order.size()); ++i) {
+        topo_index[topo_order[i]] = i;
+      }
+    }
 
     for (auto& dt : occ) {
       VLOG(2) << "Processing device " << dt.first;
@@ -1130,12 +1180,23 @@ absl::Status ScopedAllocatorOptimizer::ProcessGraphDef(
         // in the same Tree struct.  Split those groups into subgroups that
         // share identical loop nesting.
         status = ApplyToAll(root.get(), [this, rewriter, graph, &frame_view,
+                                         &graph_properties, &topo_index,
                                          &op_name, invocation_count](Tree* t) {
           VLOG(2) << "applied to tree node " << t->edge_ << " at depth "
                   << t->depth_ << " of size " << t->nodes_.size();
           if (t->nodes_.size() > 1) {
             std::vector<std::vector<NodeDef*>> loop_groups;
             PartitionByLoopStructure(frame_view, t->nodes_, &loop_groups);
+            if (max_bucket_bytes_ > 0) {
+              std::vector<std::vector<NodeDef*>> buckets;
+              for (auto& lg : loop_groups) {
+                PartitionBySize(graph_properties, topo_index, max_bucket_bytes_,
+                                std::move(lg), &buckets);
+              }
+              VLOG(1) << "Split " << loop_groups.size() << " groups into "
+                      << buckets.size() << " buckets";
+              loop_groups = std::move(buckets);
+            }
             for (auto& lg : loop_groups) {
               if (lg.size() > 1) {
                 bool applied = false;
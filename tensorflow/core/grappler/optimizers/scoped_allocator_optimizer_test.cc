@@ -414,6 +414,51 @@ TEST_F(ScopedAllocatorOptimizerTest, UnaryRewriteOnly) {
   }
 }
 
+TEST_F(ScopedAllocatorOptimizerTest, MaxBucketBytes) {
+  // Tests that a limit on the bucket size splits the parallel unary ops into
+  // groups that are rewritten separately.
+  Scope s = Scope::NewRootScope();
+  s = s.WithDevice("/job:localhost/replica:0/task:0/device:CPU:0");
+  Output a =
+      ops::Const<float>(s.WithOpName("a"), {1.0, 0.0, 0.0, -1.0}, {2, 2});
+  Output b =
+      ops::Const<float>(s.WithOpName("b"), {1.0, -2.0, 3.0, 4.0}, {2, 2});
+  Output s1 = ops::Add(s.WithOpName("s1"), a, b);
+  Output s2 = ops::Add(s.WithOpName("s2"), s1, b);
+  Output s3 = ops::Add(s.WithOpName("s3"), s2, b);
+  ops::Abs(s.WithOpName("a1"), s1);
+  ops::Abs(s.WithOpName("a2"), s2);
+  ops::Abs(s.WithOpName("a3"), s3);
+  GrapplerItem item;
+  TF_ASSERT_OK(s.ToGraphDef(&item.graph));
+  SetShapes(&item.graph);
+
+  // Each Abs input takes 16 bytes, so a1 and a2 share a bucket and a3, which
+  // becomes ready last, is left alone.
+  ScopedAllocatorOptions opts;
+  opts.add_enable_op("Abs");
+  opts.set_max_bucket_bytes(32);
+  ScopedAllocatorOptimizer sao(RewriterConfig::ON, opts);
+  GraphDef optimized_graph;
+  TF_ASSERT_OK(sao.Optimize(nullptr /*cluster*/, item, &optimized_graph));
+
+  NodeMap node_map(&optimized_graph);
+  std::vector<string> scoped_allocators;
+  for (const NodeDef& node : optimized_graph.node()) {
+    if (node.op() == "_ScopedAllocator") {
+      scoped_allocators.push_back(node.name());
+    }
+  }
+  ASSERT_EQ(scoped_allocators.size(), 1);
+  std::unordered_set<string> outputs;
+  for (auto it : node_map.GetOutputs(scoped_allocators[0])) {
+    if (it->op() != "_ScopedAllocatorConcat") outputs.insert(it->name());
+  }
+  EXPECT_EQ(outputs, std::unordered_set<string>({"s1", "s2"}));
+  EXPECT_NE(node_map.GetNode("a3"), nullptr);
+  EXPECT_EQ(node_map.GetNode("a1"), nullptr);
+}
+
 TEST_F(ScopedAllocatorOptimizerTest, UnaryExecute) {
   // Builds the same graph as UnaryRewriteOnly but also executes it and
   // validates the output.
@@ -234,8 +234,23 @@ class BatchResource : public serving::BatchResourceBase {
     return absl::OkStatus();
   }
 
+  ~BatchResource() override {
+    // Pipelined batches may still be running after their batch thread has
+    // returned.
+    mutex_lock l(pipeline_mu_);
+    while (num_in_flight_batches_ > 0) {
+      pipeline_cv_.wait(l);
+    }
+  }
+
   string DebugString() const final { return "BatchResource"; }
 
+  // Sets the number of batches whose function may run concurrently, see the
+  // `pipeline_depth` attr of BatchFunction.
+  void set_pipeline_depth(int64_t pipeline_depth) {
+    pipeline_depth_ = pipeline_depth;
+  }
+
  private:
   BatchResource(bool has_process_batch_function,
                 std::shared_ptr<BatcherT> batcher,
@@ -269,22 +284,51 @@ class BatchResource : public serving::BatchResourceBase {
     // times in parallel with the same rendezvous, a _Send node from one run
     // might be matched with a _Recv node of a different run. Not setting the
     // rendezvous causes a new rendezvous to be used for each run.
-    Notification done_notif;
+    const bool pipelined = pipeline_depth_ > 1;
+    auto done_notif = std::make_shared<Notification>();
+    if (pipelined) {
+      mutex_lock l(pipeline_mu_);
+      while (num_in_flight_batches_ >= pipeline_depth_) {
+        pipeline_cv_.wait(l);
+      }
+      ++num_in_flight_batches_;
+    }
 
     auto* flib = last_task_context->function_library();
     FunctionLibraryRuntime::Handle fhandle =
         down_cast<const BatchTask&>(last_task).fhandle;
     flib->Run(opts, fhandle, inputs, combined_outputs,
-              [&](const absl::Status& run_status) {
+              [this, pipelined, done = std::move(done),
+               done_notif](const absl::Status& run_status) {
+                if (pipelined) {
+                  mutex_lock l(pipeline_mu_);
+                  --num_in_flight_batches_;
+                  pipeline_cv_.notify_all();
+                }
                 done(run_status);
-                done_notif.Notify();
+                done_notif->Notify();
               });
+    if (pipelined) {
+      // Return as soon as the function has been started, so that this thread
+      // can concatenate the inputs of the next batch while this one runs. The
+      // wait above bounds the number of batches running concurrently.
+      return;
+    }
     // By waiting for the notification we are ensuring that this thread isn't
     // used for processing other batches, which gives the batches time to
     // coalesce upstream. So overall the number of batches going through the
     // devices goes down, improving latency and throughput in most cases.
-    done_notif.WaitForNotification();
+    done_notif->WaitForNotification();
   }
+
+  // If greater than 1, the batch thread returns as soon as the function of
+  // its batch has started, and at most this many batch functions run at once.
+  int64_t pipeline_depth_ = 1;
+
+  mutable mutex pipeline_mu_;
+  mutable condition_variable pipeline_cv_;
+  // The number of batches whose function has been started but not finished.
+  mutable int64_t num_in_flight_batches_ TF_GUARDED_BY(pipeline_mu_) = 0;
 };
 
 BatchFunctionKernel::BatchFunctionKernel(OpKernelConstruction* c)
@@ -317,6 +361,15 @@ BatchFunctionKernel::BatchFunctionKernel(OpKernelConstruction* c)
     has_attribute_enable_large_batch_splitting_ = true;
   }
 
+  if (c->HasAttr("length_bucket_boundaries")) {
+    OP_REQUIRES_OK(c, c->GetAttr("length_bucket_boundaries",
+                                 &length_bucket_boundaries_));
+  }
+
+  if (c->HasAttr("pipeline_depth")) {
+    OP_REQUIRES_OK(c, c->GetAttr("pipeline_depth", &pipeline_depth_));
+  }
+
   // Helper function `SetAdaptiveBatchSchedulerOptions` calls
   // `OP_REQUIRES_OK`, which exits the current function upon error.
   // So validate status of `op-kernel-construction`.
@@ -341,6 +394,7 @@ BatchFunctionKernel::BatchFunctionKernel(OpKernelConstruction* c)
   }
 
   OP_REQUIRES_OK(c, ValidateAllowedBatchSizes());
+  OP_REQUIRES_OK(c, ValidateLengthBucketBoundaries());
 }
 
 bool BatchFunctionKernel::IsExpensive() { return false; }
@@ -423,6 +477,7 @@ void BatchFunctionKernel::ComputeAsync(OpKernelContext* c, DoneCallback done) {
       if (session_metadata) {
         new_resource->set_session_metadata(*session_metadata);
       }
+      new_resource->set_pipeline_depth(pipeline_depth_);
       *r = new_resource.release();
       return absl::OkStatus();
     };
@@ -445,6 +500,8 @@ void BatchFunctionKernel::ComputeAsync(OpKernelContext* c, DoneCallback done) {
       if (session_metadata) {
         new_resource->set_session_metadata(*session_metadata);
       }
+      new_resource->set_length_bucket_boundaries(length_bucket_boundaries_);
+      new_resource->set_pipeline_depth(pipeline_depth_);
       *r = new_resource.release();
       return absl::OkStatus();
     };
@@ -575,6 +632,26 @@ absl::Status BatchFunctionKernel::ValidateAllowedBatchSizes() const {
   return absl::OkStatus();
 }
 
+absl::Status BatchFunctionKernel::ValidateLengthBucketBoundaries() const {
+  if (length_bucket_boundaries_.empty()) {
+    return absl::OkStatus();
+  }
+  // Splitting an input could pad its pieces to different lengths.
+  if (enable_large_batch_splitting_ ||
+      adaptive_batch_scheduler_options_ != std::nullopt) {
+    return errors::InvalidArgument(
+        "length_bucket_boundaries is not supported with large batch splitting "
+        "or the adaptive batch scheduler");
+  }
+  for (size_t i = 1; i < length_bucket_boundaries_.size(); ++i) {
+    if (length_bucket_boundaries_[i] <= length_bucket_boundaries_[i - 1]) {
+      return errors::InvalidArgument(
+          "length_bucket_boundaries entries must be monotonically increasing");
+    }
+  }
+  return absl::OkStatus();
+}
+
 // Initialize vars by reading from op-kernel-construction.
 // Vars
 // - enable_adaptive_batch_threads_
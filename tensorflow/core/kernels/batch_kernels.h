@@ -80,6 +80,11 @@ class BatchFunctionKernel : public AsyncOpKernel {
   // to `max_batch_size_`.
   absl::Status ValidateAllowedBatchSizes() const;
 
+  // Validates 'length_bucket_boundaries_'. The entries must increase
+  // monotonically, and neither large batch split nor the adaptive batch
+  // scheduler may be enabled.
+  absl::Status ValidateLengthBucketBoundaries() const;
+
   // Creates the function handle if it isn't initialized yet; and re-use it
   // afterwards.
   absl::Status GetOrCreateFunctionHandle(
@@ -112,6 +117,8 @@ class BatchFunctionKernel : public AsyncOpKernel {
   std::vector<int32> low_priority_allowed_batch_sizes_;
   std::string mixed_priority_policy_;
   std::string batch_padding_policy_;
+  std::vector<int64_t> length_bucket_boundaries_;
+  int64_t pipeline_depth_ = 1;
   NameAttrList func_;
   absl::optional<FunctionLibraryRuntime::Handle> fhandle_ TF_GUARDED_BY(mu_);
   bool enable_large_batch_splitting_ = false;
@@ -746,5 +746,80 @@ INSTANTIATE_TEST_SUITE_P(BatchFunctionKernelPaddingTestSuite,
                          ::testing::Values("PAD_UP", "BATCH_DOWN",
                                            "MINIMIZE_TPU_COST_PER_REQUEST"));
 
+class BatchFunctionKernelLengthBucketTestState
+    : public SharedBatchFunctionTestState {
+ public:
+  absl::Status Init(const std::vector<int> &length_bucket_boundaries) {
+    TF_ASSIGN_OR_RETURN(NodeDefBuilder builder,
+                        CreateBatchFunctionBuilder({4, 8}, 8, "PAD_UP",
+                                                   TensorShape({8, 2})));
+    TF_RETURN_IF_ERROR(
+        builder.Attr("length_bucket_boundaries", length_bucket_boundaries)
+            .Finalize(node_def()));
+    return OpsTestBase::InitOp();
+  }
+
+  void TestBody() override {}
+};
+
+TEST(BatchFunctionKernelLengthBucketTest, RejectsLargeBatchSplitting) {
+  // The test op enables large batch splitting, which could pad the pieces of
+  // a split input to different lengths.
+  BatchFunctionKernelLengthBucketTestState test_state;
+  EXPECT_FALSE(test_state.Init({8, 16}).ok());
+}
+
+class BatchFunctionKernelPipelineTestState
+    : public SharedBatchFunctionTestState {
+ public:
+  absl::Status Init(int pipeline_depth) {
+    static auto *const cpu_device = []() {
+      auto device =
+          DeviceFactory::NewDevice("CPU", {}, "/job:a/replica:0/task:0");
+      return device.release();
+    }();
+
+    // Override the per-test/per-op device with a global device so that it can
+    // be shared between ops.
+    device_ = cpu_device;
+
+    TF_ASSIGN_OR_RETURN(NodeDefBuilder builder,
+                        CreateBatchFunctionBuilder({4, 8}, 8, "PAD_UP",
+                                                   TensorShape({8, 2})));
+    TF_RETURN_IF_ERROR(builder.Attr("shared_name", "pipelined_batch_function")
+                           .Attr("pipeline_depth", pipeline_depth)
+                           .Finalize(node_def()));
+    return OpsTestBase::InitOp();
+  }
+
+  void TestBody() override {}
+};
+
+TEST(BatchFunctionKernelPipelineTest, RejectsNonPositiveDepth) {
+  BatchFunctionKernelPipelineTestState test_state;
+  EXPECT_FALSE(test_state.Init(0).ok());
+}
+
+TEST(BatchFunctionKernelPipelineTest, ProcessesBatches) {
+  // Send two full batches worth of requests in parallel, so that the second
+  // batch is started while the first one may still be running.
+  const int num_requests = 16;
+  tsl::BlockingCounter blocking_counter(num_requests);
+  for (int i = 0; i < num_requests; ++i) {
+    Env::Default()->SchedClosure([&]() {
+      BatchFunctionKernelPipelineTestState test_state;
+      TF_CHECK_OK(test_state.Init(/*pipeline_depth=*/2));
+      test_state.AddInputFromList<int64_t>(TensorShape({1, 2}), {123, 456});
+      TF_EXPECT_OK(test_state.RunOpKernel());
+
+      test::ExpectTensorEqual<int64_t>(
+          *test_state.GetOutput(0),
+          test::AsTensor<int64_t>({123, 456}, TensorShape({1, 2})));
+      blocking_counter.DecrementCount();
+    });
+  }
+  blocking_counter.Wait();
+}
+
 }  // namespace
 }  // namespace tensorflow
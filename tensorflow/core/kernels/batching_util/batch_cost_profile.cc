@@ -0,0 +1,114 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_cost_profile.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/kernels/batching_util/batch_stats.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+constexpr absl::string_view kHardwareKey = "hardware";
+
+}  // namespace
+
+absl::Status WriteBatchCostProfile(BatchStatsRegistry& registry,
+                                   absl::string_view model_name,
+                                   absl::string_view hardware_id,
+                                   const std::string& path, Env* env) {
+  std::string contents = absl::StrCat(kHardwareKey, "\t", hardware_id, "\n");
+  for (const auto& [model, op] : registry.ModelAndOpNames()) {
+    if (model != model_name) continue;
+    ModelBatchStats& model_stats = registry.model(model, op);
+    for (int32 batch_size : model_stats.BatchSizes()) {
+      std::optional<absl::Duration> cost =
+          model_stats.batch_size(batch_size).tpu_cost().mean();
+      if (!cost.has_value()) continue;
+      absl::StrAppend(&contents, model, "\t", op, "\t", batch_size, "\t",
+                      absl::ToDoubleMicroseconds(*cost), "\n");
+    }
+  }
+  return WriteStringToFile(env, path, contents);
+}
+
+absl::Status LoadBatchCostProfile(const std::string& path,
+                                  absl::string_view hardware_id,
+                                  BatchStatsRegistry& registry, Env* env) {
+  std::string contents;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, path, &contents));
+  std::vector<absl::string_view> lines =
+      absl::StrSplit(contents, '\n', absl::SkipEmpty());
+  if (lines.empty()) {
+    return errors::InvalidArgument("Empty batch cost profile: ", path);
+  }
+  std::vector<absl::string_view> header = absl::StrSplit(lines[0], '\t');
+  if (header.size() != 2 || header[0] != kHardwareKey) {
+    return errors::InvalidArgument("Malformed batch cost profile header in ",
+                                   path, ": ", lines[0]);
+  }
+  if (header[1] != hardware_id) {
+    VLOG(1) << "Ignoring batch cost profile " << path << " recorded on "
+            << header[1] << " (running on " << hardware_id << ")";
+    return absl::OkStatus();
+  }
+  struct Entry {
+    absl::string_view model_name;
+    absl::string_view op_name;
+    int32 batch_size;
+    double cost_micros;
+  };
+  // Parse everything before registering so that a malformed profile doesn't
+  // leave the registry partially populated.
+  std::vector<Entry> entries;
+  entries.reserve(lines.size() - 1);
+  for (int i = 1; i < lines.size(); ++i) {
+    std::vector<absl::string_view> fields = absl::StrSplit(lines[i], '\t');
+    int32 batch_size;
+    double cost_micros;
+    if (fields.size() != 4 || !absl::SimpleAtoi(fields[2], &batch_size) ||
+        !absl::SimpleAtod(fields[3], &cost_micros) || batch_size <= 0 ||
+        cost_micros <= 0) {
+      return errors::InvalidArgument("Malformed batch cost profile line in ",
+                                     path, ": ", lines[i]);
+    }
+    entries.push_back({fields[0], fields[1], batch_size, cost_micros});
+  }
+  for (const Entry& entry : entries) {
+    registry
+        .model(std::string(entry.model_name), std::string(entry.op_name))
+        .batch_size(entry.batch_size)
+        .tpu_cost()
+        .Register(absl::Microseconds(entry.cost_micros));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace serving
+}  // namespace tensorflow
@@ -0,0 +1,58 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_COST_PROFILE_H_
+#define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_COST_PROFILE_H_
+
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/kernels/batching_util/batch_stats.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace serving {
+
+// A batch cost profile is a small text artifact holding the mean per batch
+// size costs a model measured on a given kind of hardware, e.g. during warmup.
+// It is meant to be stored next to the SavedModel so that new replicas can
+// preload their BatchStatsRegistry and make informed batching decisions from
+// the first request instead of starting cold.
+//
+// The first line of the file is "hardware\t<hardware_id>". Every following
+// line is "<model_name>\t<op_name>\t<batch_size>\t<tpu_cost_micros>".
+
+// Writes the mean costs that `registry` has recorded for `model_name` (all of
+// its ops and batch sizes) to `path`, tagged with `hardware_id`.
+absl::Status WriteBatchCostProfile(BatchStatsRegistry& registry,
+                                   absl::string_view model_name,
+                                   absl::string_view hardware_id,
+                                   const std::string& path,
+                                   Env* env = Env::Default());
+
+// Registers the costs stored at `path` into `registry`, each as a single
+// sample so that costs measured later quickly take over. Profiles recorded on
+// hardware other than `hardware_id` are ignored. Fails if the file can't be
+// read or parsed.
+absl::Status LoadBatchCostProfile(const std::string& path,
+                                  absl::string_view hardware_id,
+                                  BatchStatsRegistry& registry,
+                                  Env* env = Env::Default());
+
+}  // namespace serving
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_COST_PROFILE_H_
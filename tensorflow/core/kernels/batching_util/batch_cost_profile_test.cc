@@ -0,0 +1,89 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/batching_util/batch_cost_profile.h"
+
+#include <optional>
+#include <string>
+
+#include "absl/time/time.h"
+#include "tensorflow/core/kernels/batching_util/batch_stats.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace serving {
+namespace {
+
+std::string ProfilePath(const std::string& name) {
+  return io::JoinPath(testing::TmpDir(), name);
+}
+
+TEST(BatchCostProfileTest, RoundTrip) {
+  BatchStatsRegistry recorded;
+  recorded.model("m", "o").batch_size(4).tpu_cost().Register(
+      absl::Microseconds(100));
+  recorded.model("m", "o").batch_size(4).tpu_cost().Register(
+      absl::Microseconds(300));
+  recorded.model("m", "o2").batch_size(8).tpu_cost().Register(
+      absl::Microseconds(50));
+  recorded.model("other", "o").batch_size(4).tpu_cost().Register(
+      absl::Microseconds(7));
+  const std::string path = ProfilePath("round_trip");
+  TF_ASSERT_OK(WriteBatchCostProfile(recorded, "m", "gpu_a", path));
+
+  BatchStatsRegistry loaded;
+  TF_ASSERT_OK(LoadBatchCostProfile(path, "gpu_a", loaded));
+  EXPECT_EQ(loaded.model("m", "o").batch_size(4).tpu_cost().mean(),
+            absl::Microseconds(200));
+  EXPECT_EQ(loaded.model("m", "o2").batch_size(8).tpu_cost().mean(),
+            absl::Microseconds(50));
+  // Only the requested model is persisted.
+  EXPECT_EQ(loaded.model("other", "o").batch_size(4).tpu_cost().mean(),
+            std::nullopt);
+}
+
+TEST(BatchCostProfileTest, IgnoresOtherHardware) {
+  BatchStatsRegistry recorded;
+  recorded.model("m", "o").batch_size(4).tpu_cost().Register(
+      absl::Microseconds(100));
+  const std::string path = ProfilePath("other_hardware");
+  TF_ASSERT_OK(WriteBatchCostProfile(recorded, "m", "gpu_a", path));
+
+  BatchStatsRegistry loaded;
+  TF_ASSERT_OK(LoadBatchCostProfile(path, "gpu_b", loaded));
+  EXPECT_EQ(loaded.model("m", "o").batch_size(4).tpu_cost().mean(),
+            std::nullopt);
+}
+
+TEST(BatchCostProfileTest, MalformedProfile) {
+  const std::string path = ProfilePath("malformed");
+  TF_ASSERT_OK(WriteStringToFile(
+      Env::Default(), path, "hardware\tgpu_a\nm\to\t4\t100\nm\to\tx\t1\n"));
+  BatchStatsRegistry loaded;
+  EXPECT_FALSE(LoadBatchCostProfile(path, "gpu_a", loaded).ok());
+  // Nothing is registered from a partially valid profile.
+  EXPECT_EQ(loaded.model("m", "o").batch_size(4).tpu_cost().mean(),
+            std::nullopt);
+
+  EXPECT_FALSE(
+      LoadBatchCostProfile(ProfilePath("missing"), "gpu_a", loaded).ok());
+}
+
+}  // namespace
+}  // namespace serving
+}  // namespace tensorflow
@@ -18,6 +18,7 @@ limitations under the License.
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <functional>
 #include <iterator>
 #include <memory>
@@ -27,6 +28,7 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/algorithm/container.h"
 #include "absl/container/fixed_array.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/functional/bind_front.h"
@@ -37,6 +39,7 @@ limitations under the License.
 #include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
+#include "absl/types/span.h"
 #include "tensorflow/core/common_runtime/cost_constants.h"
 #include "tensorflow/core/common_runtime/cost_measurement.h"
 #include "tensorflow/core/common_runtime/cost_measurement_registry.h"
@@ -51,6 +54,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler_utils.h"
 #include "tensorflow/core/kernels/batching_util/batch_stats.h"
@@ -298,6 +302,128 @@ int GetTotalTaskSize(
   return tasks_size;
 }
 
+// Splits `tensor` into `sizes.size()` tensors along the 0th dimension, like
+// tensor::Split. The results alias `tensor` rather than copy it, except for
+// the ones that would not be suitably aligned.
+absl::Status SplitIntoSlices(const Tensor& tensor,
+                             absl::Span<const int64_t> sizes,
+                             std::vector<Tensor>* result) {
+  if (tensor.dims() == 0) {
+    return errors::InvalidArgument("Cannot split a zero-dimensional tensor");
+  }
+  int64_t total_size = 0;
+  for (int64_t size : sizes) {
+    total_size += size;
+  }
+  if (total_size != tensor.dim_size(0)) {
+    return errors::InvalidArgument(
+        "The values in 'sizes' do not sum to the zeroth-dimension size of "
+        "'tensor'");
+  }
+
+  result->reserve(result->size() + sizes.size());
+  int64_t start = 0;
+  for (int64_t size : sizes) {
+    Tensor slice = tensor.Slice(start, start + size);
+    if (slice.IsAligned()) {
+      result->push_back(std::move(slice));
+    } else {
+      result->push_back(tensor::DeepCopy(slice));
+    }
+    start += size;
+  }
+  return absl::OkStatus();
+}
+
+// Returns the sequence length of `tensors`, i.e. the largest size of dimension
+// 1 among them, or 0 if none of them has rank >= 2.
+int64_t GetSequenceLength(absl::Span<const Tensor> tensors) {
+  int64_t length = 0;
+  for (const Tensor& tensor : tensors) {
+    if (tensor.dims() >= 2) length = std::max(length, tensor.dim_size(1));
+  }
+  return length;
+}
+
+// Pads each of `tensors` of rank >= 2 with zeros along dimension 1 to the
+// sequence length of all of them.
+absl::Status PadToSequenceLength(OpKernelContext* context,
+                                 std::vector<Tensor>& tensors) {
+  const int64_t length = GetSequenceLength(tensors);
+  for (Tensor& tensor : tensors) {
+    if (tensor.dims() < 2 || tensor.dim_size(1) == length) continue;
+    if (!DataTypeCanUseMemcpy(tensor.dtype())) {
+      return errors::InvalidArgument(
+          "Cannot pad tensors of type ", DataTypeString(tensor.dtype()),
+          " to the longest sequence length in the batch.");
+    }
+    TensorShape padded_shape = tensor.shape();
+    padded_shape.set_dim(1, length);
+    Tensor padded;
+    AllocatorAttributes attr;
+    attr.set_on_host(true);
+    TF_RETURN_IF_ERROR(
+        context->allocate_temp(tensor.dtype(), padded_shape, &padded, attr));
+
+    // Copy each row of `tensor` to the start of the corresponding row of
+    // `padded`, and zero the rest of the row.
+    const int64_t num_rows = tensor.dim_size(0);
+    absl::string_view from = tensor.tensor_data();
+    char* to = const_cast<char*>(padded.tensor_data().data());
+    const size_t from_row_size = num_rows == 0 ? 0 : from.size() / num_rows;
+    const size_t to_row_size =
+        num_rows == 0 ? 0 : padded.tensor_data().size() / num_rows;
+    for (int64_t row = 0; row < num_rows; ++row) {
+      memcpy(to + row * to_row_size, from.data() + row * from_row_size,
+             from_row_size);
+      memset(to + row * to_row_size + from_row_size, 0,
+             to_row_size - from_row_size);
+    }
+    tensor = std::move(padded);
+  }
+  return absl::OkStatus();
+}
+
+// Copies `split`, the `output_index`-th output of a split `task`, into the
+// corresponding slice of the merged output, allocating the merged output if
+// this is the first split to complete.
+absl::Status MergeSplitOutput(BatchResourceBase::BatchTask& task,
+                              int output_index, const Tensor& split) {
+  BatchResourceBase::MergedOutputs& merged = *task.merged_outputs;
+  Tensor output;
+  {
+    mutex_lock l(merged.mu);
+    Tensor& merged_output = merged.outputs[output_index];
+    if (!merged_output.IsInitialized()) {
+      TensorShape shape = split.shape();
+      shape.set_dim(0, merged.split_offsets.back());
+      TF_RETURN_IF_ERROR(
+          task.context->allocate_temp(split.dtype(), shape, &merged_output));
+    }
+    // Shares the buffer, which each split writes to a disjoint slice of.
+    output = merged_output;
+  }
+
+  const int64_t start = merged.split_offsets[task.split_index];
+  const int64_t limit = merged.split_offsets[task.split_index + 1];
+  TensorShape expected_shape = output.shape();
+  expected_shape.set_dim(0, limit - start);
+  if (output.dtype() != split.dtype() || expected_shape != split.shape()) {
+    return errors::InvalidArgument(
+        "Splits of a batched op invocation produced incompatible output ",
+        output_index, ": expected ", DataTypeString(output.dtype()),
+        expected_shape.DebugString(), ", got ", DataTypeString(split.dtype()),
+        split.shape().DebugString());
+  }
+  const absl::string_view from = split.tensor_data();
+  if (!from.empty()) {
+    Tensor slice = output.Slice(start, limit);
+    std::memcpy(const_cast<char*>(slice.tensor_data().data()), from.data(),
+                from.size());
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace
 
 std::unique_ptr<BatchResourceBase::BatchTask>
@@ -313,6 +439,7 @@ BatchResourceBase::BatchTask::CreateSplitTask(
   task->done_callback = done_callback;
   task->split_index = split_index;
   task->output = this->output;
+  task->merged_outputs = this->merged_outputs;
   task->status = this->status;
   task->is_partial = true;
   task->start_time = this->start_time;
@@ -323,7 +450,6 @@ BatchResourceBase::BatchTask::CreateSplitTask(
 }
 
 using ::tensorflow::concat_split_util::Concat;
-using ::tensorflow::concat_split_util::Split;
 using TensorMatrix = std::vector<std::vector<Tensor>>;
 
 string GetTensorNamesAndShapesString(const OpKernelContext* context,
@@ -484,9 +610,20 @@ absl::Status BatchResourceBase::RegisterInput(
     batch_components->request_cost = request_cost_accessor->GetRequestCost();
   }
 
+  // Inputs of different sequence length buckets use separate queues of the
+  // same batcher.
+  std::string queue_name = batcher_queue_name;
+  if (!length_bucket_boundaries_.empty()) {
+    const int64_t bucket =
+        absl::c_upper_bound(length_bucket_boundaries_,
+                            GetSequenceLength(batch_components->inputs)) -
+        length_bucket_boundaries_.begin();
+    absl::StrAppend(&queue_name, "/length_bucket_", bucket);
+  }
+
   BatcherQueueT* batcher_queue;
   TF_RETURN_IF_ERROR(LookupOrCreateBatcherQueue(
-      /* queue_name= */ batcher_queue_name,
+      /* queue_name= */ queue_name,
       /* model_name= */ GetModelName(context),
       /* op_name= */ context->op_kernel().name(), /* queue= */ &batcher_queue));
 
@@ -752,6 +889,16 @@ absl::Status BatchResourceBase::ConcatInputTensors(
       }
     }
 
+    if (!length_bucket_boundaries_.empty()) {
+      TF_RETURN_IF_ERROR(PadToSequenceLength(context, to_concatenate));
+    }
+
+    // A batch made of a single task needs no copy.
+    if (to_concatenate.size() == 1) {
+      concatenated_tensors->push_back(std::move(to_concatenate[0]));
+      continue;
+    }
+
     Tensor concatenated_tensor;
     absl::Status concat_status =
         Concat(context, to_concatenate, &concatenated_tensor);
@@ -771,16 +918,42 @@ absl::Status BatchResourceBase::ConcatInputTensors(
 
   std::shared_ptr<ThreadSafeStatus> shared_status = input_task.status;
 
+  const internal::InputSplitMetadata input_split_metadata(
+      input_task_size, open_batch_remaining_slot, max_batch_size);
+  const absl::FixedArray<int>& task_sizes = input_split_metadata.task_sizes();
+  const int num_batches = task_sizes.size();
+
+  std::vector<int64_t> split_offsets;
+  split_offsets.reserve(num_batches + 1);
+  split_offsets.push_back(0);
+  for (int i = 0; i < num_batches; ++i) {
+    split_offsets.push_back(split_offsets.back() + task_sizes[i]);
+  }
+  input_task.merged_outputs = std::make_shared<MergedOutputs>(
+      std::move(split_offsets), input_task.context->num_outputs());
+
   // `split_task_done_callback` runs only after all splitted tasks are
   // complete.
   std::function<void()> split_task_done_callback =
       [done_callback = input_task.done_callback, output = input_task.output,
+       merged_outputs = input_task.merged_outputs,
        forced_warmup_batch_size = input_task.forced_warmup_batch_size,
        op_kernel_context = input_task.context,
        status = shared_status]() mutable {
         const int num_output = op_kernel_context->num_outputs();
         for (int i = 0; i < num_output; ++i) {
           Tensor output_tensor;
+          {
+            mutex_lock l(merged_outputs->mu);
+            output_tensor = merged_outputs->outputs[i];
+          }
+          if (output_tensor.IsInitialized()) {
+            // Every split already copied its slice into place.
+            if (forced_warmup_batch_size == 0) {
+              op_kernel_context->set_output(i, std::move(output_tensor));
+            }
+            continue;
+          }
 
           // Concat would memcpy each input tensor to one output tensor.
           // In this context, Concat can be further optimized to get rid of
@@ -804,11 +977,6 @@ absl::Status BatchResourceBase::ConcatInputTensors(
       };
   IncrementalBarrier barrier(split_task_done_callback);
 
-  const internal::InputSplitMetadata input_split_metadata(
-      input_task_size, open_batch_remaining_slot, max_batch_size);
-
-  const absl::FixedArray<int>& task_sizes = input_split_metadata.task_sizes();
-  const int num_batches = task_sizes.size();
   std::vector<int64_t> output_task_sizes;
   output_task_sizes.resize(num_batches);
   for (int i = 0; i < num_batches; i++) {
@@ -832,11 +1000,9 @@ absl::Status BatchResourceBase::ConcatInputTensors(
   for (int i = 0; i < num_input_tensors; ++i) {
     std::vector<Tensor> split_tensors;
     const Tensor& input_tensor = input_task.inputs[i];
-    // TODO(b/154140947):
-    // Figure out the optimal implementation of Split, by using
-    // 'Tensor::Slice' and eliminating unnecessary memcpy as much as possible.
-    const absl::Status split_status = Split(input_task.context, input_tensor,
-                                            output_task_sizes, &split_tensors);
+    // Aligned slices share the input buffer; only unaligned ones are copied.
+    const absl::Status split_status =
+        SplitIntoSlices(input_tensor, output_task_sizes, &split_tensors);
     if (!split_status.ok()) {
       return errors::Internal(
           "When splitting input, Tensor split operation failed: ",
@@ -914,8 +1080,10 @@ absl::Status BatchResourceBase::SplitOutputTensors(
           "; padding size: ", padding_size);
     }
 
+    // The outputs of the tasks alias the batched output, which stays alive
+    // until the last of them is released.
     std::vector<Tensor> split_tensor;
-    const absl::Status split_status = tensor::Split(
+    const absl::Status split_status = SplitIntoSlices(
         output_tensor, task_sizes_plus_optional_padding, &split_tensor);
     DCHECK(split_status.ok()) << split_status;
     if (!split_status.ok()) {
@@ -933,7 +1101,10 @@ absl::Status BatchResourceBase::SplitOutputTensors(
     // Ignore a possible final split_tensors entry containing the padding.
     for (int j = 0; j < batch->num_tasks(); ++j) {
       BatchTask& task = *(batch->mutable_task(j));
-      if (task.is_partial) {
+      if (task.is_partial && task.merged_outputs != nullptr &&
+          DataTypeCanUseMemcpy(split_tensor[j].dtype())) {
+        TF_RETURN_IF_ERROR(MergeSplitOutput(task, i, split_tensor[j]));
+      } else if (task.is_partial) {
         std::vector<Tensor>& tensor_vector = (*task.output)[task.split_index];
         tensor_vector[i] = std::move(split_tensor[j]);
       } else {
@@ -978,25 +1149,41 @@ void BatchResourceBase::ProcessFuncBatch(
   // which are running this Session, of which this BatchOp is a part.
   WithContext wc(batch->task(batch->num_tasks() - 1).propagated_context);
 
+  // The state of the batch lives on the heap, since ProcessFuncBatchImpl may
+  // return before the function has finished running, e.g. to let the next
+  // batch be prepared while this one executes on the device.
+  struct FuncBatchState {
+    std::unique_ptr<BatchT> batch;
+    std::vector<std::unique_ptr<BatchTask>> unbatched_tasks;
+    std::vector<std::unique_ptr<CostMeasurement>> batch_cost_measurements;
+    std::vector<Tensor> args;
+    std::vector<Tensor> combined_outputs;
+    int64_t processed_size = 0;
+    bool cleanup_done = false;
+  };
+  auto state = std::make_shared<FuncBatchState>();
+  state->batch = std::move(batch);
+  state->unbatched_tasks = std::move(unbatched_tasks);
+
   // TODO(b/185852990): Add a unit test to check the context is correctly set.
   // Creates the CostMeasurements within the same context that runs the Session.
   const CostMeasurement::Context batching_context{/*is_per_query=*/false};
-  std::vector<std::unique_ptr<CostMeasurement>> batch_cost_measurements =
-      CreateCostMeasurements(batching_context);
+  state->batch_cost_measurements = CreateCostMeasurements(batching_context);
 
-  auto& last_task = batch->task(batch->num_tasks() - 1);
+  auto& last_task = state->batch->task(state->batch->num_tasks() - 1);
   OpKernelContext* last_task_context = last_task.context;
   const std::string& model_name = GetModelName(last_task_context);
   const std::string& op_name = last_task_context->op_kernel().name();
 
   // Regardless of the outcome, we need to propagate the status to the
   // individual tasks and signal that they are done. We use MakeCleanup() to
-  // ensure that this happens no matter how we exit the method below.
+  // ensure that this happens no matter how we exit the method below. The
+  // model and op names outlive the tasks, which are only done after cleanup.
   absl::Status status;
-  bool cleanup_done = false;
-  int64_t processed_size = batch->size();
-  auto cleanup_fn = [&](const absl::Status& status) {
-    if (cleanup_done) {
+  state->processed_size = state->batch->size();
+  auto cleanup_fn = [this, state, &model_name,
+                     &op_name](const absl::Status& status) {
+    if (state->cleanup_done) {
       return;
     }
     // TODO(b/316379576): Update this to take the unbatch task cost into
@@ -1004,56 +1191,57 @@ void BatchResourceBase::ProcessFuncBatch(
     // unbatched tasks.
     SplitBatchCostsAndRecordMetrics(
         /* model_name= */ model_name, /* op_name= */ op_name,
-        batch_cost_measurements, processed_size, *batch);
+        state->batch_cost_measurements, state->processed_size, *state->batch);
     // Clear the measurements before unblocking the batch task, as measurements
     // are associated with the task's thread context.
-    batch_cost_measurements.clear();
-    for (int i = 0; i < batch->num_tasks(); ++i) {
-      CleanUpFunctionHelper(*batch->mutable_task(i), status);
+    state->batch_cost_measurements.clear();
+    for (int i = 0; i < state->batch->num_tasks(); ++i) {
+      CleanUpFunctionHelper(*state->batch->mutable_task(i), status);
     }
-    for (int i = 0; i < unbatched_tasks.size(); ++i) {
-      CleanUpFunctionHelper(*unbatched_tasks[i], status);
+    for (int i = 0; i < state->unbatched_tasks.size(); ++i) {
+      CleanUpFunctionHelper(*state->unbatched_tasks[i], status);
     }
-    cleanup_done = true;
+    state->cleanup_done = true;
   };
 
   auto finally =
       gtl::MakeCleanup([&cleanup_fn, &status] { cleanup_fn(status); });
 
-  status = ValidateBatch(*batch);
+  status = ValidateBatch(*state->batch);
   if (!status.ok()) {
     return;
   }
 
   std::vector<Tensor> concatenated_tensors;
-  status = ConcatInputTensors(*batch, unbatched_tasks, last_task_context,
-                              &concatenated_tensors);
-  processed_size = RoundToLowestAllowedBatchSize(batch->size());
+  status = ConcatInputTensors(*state->batch, state->unbatched_tasks,
+                              last_task_context, &concatenated_tensors);
+  state->processed_size = RoundToLowestAllowedBatchSize(state->batch->size());
   if (!status.ok()) {
     return;
   }
 
-  std::vector<Tensor> combined_outputs;
-  std::vector<Tensor> args(concatenated_tensors.begin(),
-                           concatenated_tensors.end());
-  const auto& captured_inputs =
-      batch->task(batch->num_tasks() - 1).captured_inputs;
-  args.insert(args.end(), captured_inputs.begin(), captured_inputs.end());
+  state->args.assign(concatenated_tensors.begin(), concatenated_tensors.end());
+  const auto& captured_inputs = last_task.captured_inputs;
+  state->args.insert(state->args.end(), captured_inputs.begin(),
+                     captured_inputs.end());
 
   uint64 current_time = EnvTime::NowNanos();
-  for (int i = 0; i < batch->num_tasks(); ++i) {
-    RecordBatchDelayUs((current_time - batch->task(i).start_time) * 1e-3,
-                       model_name, last_task_context->op_kernel().name(),
-                       processed_size);
-    RecordBatchDelayUsV2((current_time - batch->task(i).start_time) * 1e-3,
-                         model_name, last_task_context->op_kernel().name(),
-                         processed_size);
+  for (int i = 0; i < state->batch->num_tasks(); ++i) {
+    state->batch->mutable_task(i)->queueing_delay = absl::Nanoseconds(
+        current_time - state->batch->task(i).start_time);
+    RecordBatchDelayUs(
+        (current_time - state->batch->task(i).start_time) * 1e-3, model_name,
+        last_task_context->op_kernel().name(), state->processed_size);
+    RecordBatchDelayUsV2(
+        (current_time - state->batch->task(i).start_time) * 1e-3, model_name,
+        last_task_context->op_kernel().name(), state->processed_size);
   }
   // Releases the cleanup method here, because the callback of the function
   // library runtime will handle it now.
   finally.release();
   ProcessFuncBatchImpl(
-      last_task, args, &combined_outputs, [&](const absl::Status& run_status) {
+      last_task, state->args, &state->combined_outputs,
+      [this, state, cleanup_fn](const absl::Status& run_status) {
         absl::Status final_status;
         auto run_finally = gtl::MakeCleanup([&]() {
           // We do the cleanup here as an optimization, so that
@@ -1068,9 +1256,11 @@ void BatchResourceBase::ProcessFuncBatch(
         if (!final_status.ok()) {
           return;
         }
-        if (last_task.forced_warmup_batch_size == 0) {
-          final_status = SplitOutputTensors(combined_outputs, batch.get(),
-                                            unbatched_tasks);
+        const auto& task = state->batch->task(state->batch->num_tasks() - 1);
+        if (task.forced_warmup_batch_size == 0) {
+          final_status = SplitOutputTensors(
+              state->combined_outputs, state->batch.get(),
+              state->unbatched_tasks);
         }
       });
 }
@@ -1101,6 +1291,12 @@ void BatchResourceBase::ProcessBatch(std::unique_ptr<BatchT> batch) const {
   const std::string& model_name = GetModelName(last_task_context);
   const std::string& op_name = last_task_context->op_kernel().name();
 
+  const uint64 current_time = EnvTime::NowNanos();
+  for (int i = 0; i < batch->num_tasks(); ++i) {
+    batch->mutable_task(i)->queueing_delay =
+        absl::Nanoseconds(current_time - batch->task(i).start_time);
+  }
+
   auto batch_cost_cleanup = gtl::MakeCleanup([&] {
     SplitBatchCostsAndRecordMetrics(
         /* model_name= */ model_name, /* op_name= */ op_name,
@@ -1306,7 +1502,7 @@ void BatchResourceBase::SplitBatchCostsAndRecordMetrics(
 
     request_cost->RecordBatchMetrics(RequestCost::BatchMetrics{
         processed_size, static_cast<int64_t>(batch.task(i).size()),
-        padding_size, batch_costs});
+        padding_size, batch_costs, batch.task(i).queueing_delay});
   }
 }
 
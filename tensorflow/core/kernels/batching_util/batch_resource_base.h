@@ -27,6 +27,7 @@ limitations under the License.
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/blocking_counter.h"
+#include "absl/time/time.h"
 #include "tensorflow/core/common_runtime/cost_measurement_registry.h"
 #include "tensorflow/core/common_runtime/request_cost.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -72,6 +73,23 @@ class BatchResourceBase : public ResourceBase {
   // concatenating tensors along the 2nd dimension gives a output tensor.
   typedef std::vector<std::vector<Tensor>> TensorMatrix;
 
+  // Outputs of an op invocation whose BatchTask was split, allocated to their
+  // full size by the first split that completes. Each split copies its slice
+  // of the outputs into place as soon as its batch is processed, so no
+  // concatenation is left once the last split completes. Outputs whose dtype
+  // cannot be copied with memcpy are concatenated from `TensorMatrix` instead.
+  struct MergedOutputs {
+    MergedOutputs(std::vector<int64_t> split_offsets, int num_outputs)
+        : split_offsets(std::move(split_offsets)), outputs(num_outputs) {}
+
+    // The offset of each split along the 0-th dimension; the last entry is
+    // the size of the op invocation.
+    const std::vector<int64_t> split_offsets;
+
+    mutex mu;
+    std::vector<Tensor> outputs TF_GUARDED_BY(mu);
+  };
+
   // One task to be batched, corresponds to a `slice` of input from one batch-op
   // invocation.
   //
@@ -105,6 +123,9 @@ class BatchResourceBase : public ResourceBase {
     // invocation, after all splits complete.
     std::shared_ptr<TensorMatrix> output;
 
+    // Set for split tasks only; ownership shared like `output`.
+    std::shared_ptr<MergedOutputs> merged_outputs;
+
     // 'status' records error (could be from any split) if at least one split
     // returns error, OK otherwise.
     // Ownership is shared by individual splits and callback.
@@ -114,6 +135,10 @@ class BatchResourceBase : public ResourceBase {
 
     uint64 start_time;
 
+    // Time between `start_time` and the start of processing of the batch this
+    // task was scheduled in. Set once the batch is dequeued.
+    absl::Duration queueing_delay = absl::ZeroDuration();
+
     size_t size() const override { return inputs[0].shape().dim_size(0); }
 
     // Create a split task from this one. The caller needs to setup the inputs
@@ -186,6 +211,17 @@ class BatchResourceBase : public ResourceBase {
 
   const SessionMetadata& session_metadata() const { return session_metadata_; }
 
+  // Makes inputs be batched separately per sequence length bucket, where the
+  // length of an input is the size of dimension 1 of its tensors of rank >= 2.
+  // A length `l` falls into bucket `i` if `boundaries[i - 1] <= l <
+  // boundaries[i]`. Within a batch, tensors shorter than the longest one are
+  // padded with zeros along dimension 1.
+  //
+  // `boundaries` must increase monotonically.
+  void set_length_bucket_boundaries(std::vector<int64_t> boundaries) {
+    length_bucket_boundaries_ = std::move(boundaries);
+  }
+
   using CreateBatchTaskFn =
       std::function<StatusOr<std::unique_ptr<BatchTask>>()>;
 
@@ -267,7 +303,8 @@ class BatchResourceBase : public ResourceBase {
   //   including:
   //   1) the batch size;
   //   2) the input size from this task;
-  //   3) the padding amount.
+  //   3) the padding amount;
+  //   4) the time this task spent queued before the batch was processed.
   static void SplitBatchCostsAndRecordMetrics(
       const std::string& model_name, const std::string& op_name,
       const std::vector<std::unique_ptr<CostMeasurement>>&
@@ -276,6 +313,9 @@ class BatchResourceBase : public ResourceBase {
 
  private:
   // Implementation of calling the process batch function.
+  //
+  // `done` may be invoked after this method returns; `inputs` and
+  // `combined_outputs` stay valid until `done` has been invoked or destroyed.
   virtual void ProcessFuncBatchImpl(
       const BatchResourceBase::BatchTask& last_task,
       absl::Span<const Tensor> inputs, std::vector<Tensor>* combined_outputs,
@@ -372,6 +412,9 @@ class BatchResourceBase : public ResourceBase {
   // A concatenated string of <allowed_batch_sizes_>, separated by ",". This is
   // used to record batching parameter.
   string allowed_batch_sizes_str_;
+
+  // See set_length_bucket_boundaries().
+  std::vector<int64_t> length_bucket_boundaries_;
 };
 
 }  // namespace serving
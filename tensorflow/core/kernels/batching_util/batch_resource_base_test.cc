@@ -150,7 +150,8 @@ TEST(SplitBatchCostsAndRecordMetricsTest, SkipOnNoCostMeasurement) {
   EXPECT_THAT(batch.task(0).request_cost->GetBatchMetrics(),
               ::testing::ElementsAre(::testing::FieldsAre(
                   /*processed_size=*/16, /*input_size=*/1, /*padding_size=*/15,
-                  ::testing::IsEmpty())));
+                  ::testing::IsEmpty(),
+                  /*queueing_delay=*/absl::ZeroDuration())));
 }
 
 TEST(SplitBatchCostsAndRecordMetricsTest, SkipOnZeroCost) {
@@ -170,7 +171,8 @@ TEST(SplitBatchCostsAndRecordMetricsTest, SkipOnZeroCost) {
   EXPECT_THAT(batch.task(0).request_cost->GetBatchMetrics(),
               ::testing::ElementsAre(::testing::FieldsAre(
                   /*processed_size=*/16, /*input_size=*/1, /*padding_size=*/15,
-                  ::testing::IsEmpty())));
+                  ::testing::IsEmpty(),
+                  /*queueing_delay=*/absl::ZeroDuration())));
 }
 
 TEST(SplitBatchCostsAndRecordMetricsTest, SkipOnZeroBatchSize) {
@@ -227,7 +229,8 @@ TEST(SplitBatchCostsAndRecordMetricsTest, SplitSingleCostType) {
       batch.task(0).request_cost->GetBatchMetrics(),
       ::testing::ElementsAre(::testing::FieldsAre(
           /*processed_size=*/20, /*input_size=*/1, /*padding_size=*/10,
-          UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100))))));
+          UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100))),
+          /*queueing_delay=*/absl::ZeroDuration())));
   EXPECT_THAT(
       batch.task(1).request_cost->GetCosts(),
       UnorderedElementsAre(Pair("test_tpu_with_smear", absl::Milliseconds(90)),
@@ -236,7 +239,8 @@ TEST(SplitBatchCostsAndRecordMetricsTest, SplitSingleCostType) {
       batch.task(1).request_cost->GetBatchMetrics(),
       ::testing::ElementsAre(::testing::FieldsAre(
           /*processed_size=*/20, /*input_size=*/9, /*padding_size=*/10,
-          UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100))))));
+          UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100))),
+          /*queueing_delay=*/absl::ZeroDuration())));
 }
 
 TEST(SplitBatchCostsAndRecordMetricsTest, SplitMultiCostTypes) {
@@ -267,7 +271,8 @@ TEST(SplitBatchCostsAndRecordMetricsTest, SplitMultiCostTypes) {
       ::testing::ElementsAre(::testing::FieldsAre(
           /*processed_size=*/20, /*input_size=*/1, /*padding_size=*/10,
           UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100)),
-                               Pair("test_gcu", absl::Milliseconds(200))))));
+                               Pair("test_gcu", absl::Milliseconds(200))),
+                               /*queueing_delay=*/absl::ZeroDuration())));
 
   EXPECT_THAT(
       batch.task(1).request_cost->GetCosts(),
@@ -280,7 +285,8 @@ TEST(SplitBatchCostsAndRecordMetricsTest, SplitMultiCostTypes) {
       ::testing::ElementsAre(::testing::FieldsAre(
           /*processed_size=*/20, /*input_size=*/9, /*padding_size=*/10,
           UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100)),
-                               Pair("test_gcu", absl::Milliseconds(200))))));
+                               Pair("test_gcu", absl::Milliseconds(200))),
+                               /*queueing_delay=*/absl::ZeroDuration())));
 }
 
 TEST(SplitBatchCostsAndRecordMetricsTest, SplitOnlyNonZeroCostTypes) {
@@ -308,7 +314,8 @@ TEST(SplitBatchCostsAndRecordMetricsTest, SplitOnlyNonZeroCostTypes) {
       batch.task(0).request_cost->GetBatchMetrics(),
       ::testing::ElementsAre(::testing::FieldsAre(
           /*processed_size=*/20, /*input_size=*/1, /*padding_size=*/10,
-          UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100))))));
+          UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100))),
+          /*queueing_delay=*/absl::ZeroDuration())));
 
   EXPECT_THAT(
       batch.task(1).request_cost->GetCosts(),
@@ -318,7 +325,34 @@ TEST(SplitBatchCostsAndRecordMetricsTest, SplitOnlyNonZeroCostTypes) {
       batch.task(1).request_cost->GetBatchMetrics(),
       ::testing::ElementsAre(::testing::FieldsAre(
           /*processed_size=*/20, /*input_size=*/9, /*padding_size=*/10,
-          UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100))))));
+          UnorderedElementsAre(Pair("test_tpu", absl::Milliseconds(100))),
+          /*queueing_delay=*/absl::ZeroDuration())));
+}
+
+TEST(SplitBatchCostsAndRecordMetricsTest, RecordsQueueingDelay) {
+  BatchResourceBase::BatchT batch;
+  RequestCost cost1, cost2;
+  batch.AddTask(MakeBatchTask(/*task_size=*/1, &cost1));
+  batch.AddTask(MakeBatchTask(/*task_size=*/9, &cost2));
+  batch.mutable_task(0)->queueing_delay = absl::Milliseconds(7);
+  batch.mutable_task(1)->queueing_delay = absl::Milliseconds(3);
+  batch.Close();
+
+  std::vector<std::unique_ptr<CostMeasurement>> batch_cost_measurements;
+  BatchResourceBase::SplitBatchCostsAndRecordMetrics(
+      "model_name", "op_name", batch_cost_measurements, /*processed_size=*/16,
+      batch);
+
+  EXPECT_THAT(batch.task(0).request_cost->GetBatchMetrics(),
+              ::testing::ElementsAre(::testing::FieldsAre(
+                  /*processed_size=*/16, /*input_size=*/1, /*padding_size=*/6,
+                  ::testing::IsEmpty(),
+                  /*queueing_delay=*/absl::Milliseconds(7))));
+  EXPECT_THAT(batch.task(1).request_cost->GetBatchMetrics(),
+              ::testing::ElementsAre(::testing::FieldsAre(
+                  /*processed_size=*/16, /*input_size=*/9, /*padding_size=*/6,
+                  ::testing::IsEmpty(),
+                  /*queueing_delay=*/absl::Milliseconds(3))));
 }
 
 TEST(SplitBatchCostsAndRecordMetricsTest, UpdatesGlobalBatchStats) {
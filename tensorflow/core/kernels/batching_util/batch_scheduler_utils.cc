@@ -16,9 +16,14 @@ limitations under the License.
 #include "tensorflow/core/kernels/batching_util/batch_scheduler_utils.h"
 
 #include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
 #include <vector>
 
 #include "absl/algorithm/container.h"
+#include "absl/time/time.h"
+#include "tensorflow/core/kernels/batching_util/batch_stats.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
 
@@ -67,5 +72,33 @@ int32 GetPrevAllowedBatchSize(int batch_size,
   return *result;
 }
 
+std::optional<SloBatchingParams> GetSloBatchingParams(
+    absl::Duration latency_slo, size_t max_execution_batch_size,
+    ModelBatchStats& model_batch_stats) {
+  std::vector<int32> batch_sizes = model_batch_stats.BatchSizes();
+  absl::c_sort(batch_sizes);
+
+  std::optional<SloBatchingParams> result;
+  std::optional<absl::Duration> target_cost;
+  bool largest_fits = false;
+  for (int32 batch_size : batch_sizes) {
+    if (batch_size > max_execution_batch_size) break;
+    std::optional<absl::Duration> cost =
+        model_batch_stats.batch_size(batch_size).tpu_cost().mean();
+    if (!cost.has_value()) continue;
+    largest_fits = 2 * *cost <= latency_slo;
+    if (result.has_value() && !largest_fits) break;
+    // Fall back on the smallest batch size if none of them fits.
+    result = SloBatchingParams{0, static_cast<size_t>(batch_size)};
+    target_cost = cost;
+  }
+  if (!result.has_value()) return std::nullopt;
+
+  if (largest_fits) result->target_batch_size = max_execution_batch_size;
+  result->batch_timeout_micros = std::max<int64_t>(
+      0, absl::ToInt64Microseconds(latency_slo - 2 * *target_cost));
+  return result;
+}
+
 }  // namespace serving
 }  // namespace tensorflow
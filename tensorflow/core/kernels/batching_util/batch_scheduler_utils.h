@@ -16,6 +16,8 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_SCHEDULER_UTILS_H_
 #define TENSORFLOW_CORE_KERNELS_BATCHING_UTIL_BATCH_SCHEDULER_UTILS_H_
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <vector>
@@ -43,6 +45,29 @@ int GetPrevAllowedBatchSize(int batch_size,
                             const std::vector<int32>& allowed_batch_sizes,
                             bool disable_padding);
 
+// The batch timeout and the batch size at which a batch is scheduled without
+// waiting for the timeout, as chosen by GetSloBatchingParams.
+struct SloBatchingParams {
+  int64_t batch_timeout_micros;
+  size_t target_batch_size;
+};
+
+// Returns the batching parameters that maximize throughput while keeping the
+// latency of tasks within `latency_slo`, based on the batch costs recorded in
+// `model_batch_stats`.
+//
+// A task may wait for the batch timeout in the open batch, then for a batch
+// already being processed, and then for its own batch to be processed. So the
+// target batch size is the largest recorded batch size whose mean cost fits
+// into half of the SLO, and the batch timeout is the rest of the budget. If
+// even the largest recorded batch size fits, the target batch size is
+// `max_execution_batch_size` so that larger batches still get explored.
+//
+// Returns std::nullopt if no batch costs have been recorded yet.
+std::optional<SloBatchingParams> GetSloBatchingParams(
+    absl::Duration latency_slo, size_t max_execution_batch_size,
+    ModelBatchStats& model_batch_stats);
+
 // Constants containing possible values for the batch_padding_policy argument
 // of MaybeBatchDown. This argument specifies the policy that a batch scheduler
 // is using when deciding what to do when, say, 18 requests need to be batched,
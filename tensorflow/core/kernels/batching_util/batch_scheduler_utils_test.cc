@@ -17,6 +17,7 @@ limitations under the License.
 
 #include <cstddef>
 #include <memory>
+#include <optional>
 #include <vector>
 
 #include <gtest/gtest.h>
@@ -275,6 +276,61 @@ TEST(MaybeBatchDownTest, MinimizeTpuCostPerRequestDoesPadUpWhenNoModelStats) {
   EXPECT_EQ(batch.size(), 3);
 }
 
+TEST(GetSloBatchingParamsTest, NoCosts) {
+  ModelBatchStats model_batch_stats;
+  EXPECT_FALSE(GetSloBatchingParams(
+                   /* latency_slo= */ absl::Milliseconds(10),
+                   /* max_execution_batch_size= */ 16,
+                   /* model_batch_stats= */ model_batch_stats)
+                   .has_value());
+}
+
+TEST(GetSloBatchingParamsTest, PicksLargestBatchSizeWithinSlo) {
+  ModelBatchStats model_batch_stats;
+  model_batch_stats.batch_size(2).tpu_cost().Register(absl::Milliseconds(1));
+  model_batch_stats.batch_size(4).tpu_cost().Register(absl::Milliseconds(3));
+  model_batch_stats.batch_size(8).tpu_cost().Register(absl::Milliseconds(6));
+
+  std::optional<SloBatchingParams> params = GetSloBatchingParams(
+      /* latency_slo= */ absl::Milliseconds(10),
+      /* max_execution_batch_size= */ 16,
+      /* model_batch_stats= */ model_batch_stats);
+
+  ASSERT_TRUE(params.has_value());
+  EXPECT_EQ(params->target_batch_size, 4);
+  EXPECT_EQ(params->batch_timeout_micros, 4000);
+}
+
+TEST(GetSloBatchingParamsTest, ExploresLargerBatchesWhenAllFit) {
+  ModelBatchStats model_batch_stats;
+  model_batch_stats.batch_size(2).tpu_cost().Register(absl::Milliseconds(1));
+  model_batch_stats.batch_size(4).tpu_cost().Register(absl::Milliseconds(2));
+
+  std::optional<SloBatchingParams> params = GetSloBatchingParams(
+      /* latency_slo= */ absl::Milliseconds(10),
+      /* max_execution_batch_size= */ 16,
+      /* model_batch_stats= */ model_batch_stats);
+
+  ASSERT_TRUE(params.has_value());
+  EXPECT_EQ(params->target_batch_size, 16);
+  EXPECT_EQ(params->batch_timeout_micros, 6000);
+}
+
+TEST(GetSloBatchingParamsTest, FallsBackOnSmallestBatchSize) {
+  ModelBatchStats model_batch_stats;
+  model_batch_stats.batch_size(2).tpu_cost().Register(absl::Milliseconds(8));
+  model_batch_stats.batch_size(4).tpu_cost().Register(absl::Milliseconds(9));
+
+  std::optional<SloBatchingParams> params = GetSloBatchingParams(
+      /* latency_slo= */ absl::Milliseconds(10),
+      /* max_execution_batch_size= */ 16,
+      /* model_batch_stats= */ model_batch_stats);
+
+  ASSERT_TRUE(params.has_value());
+  EXPECT_EQ(params->target_batch_size, 2);
+  EXPECT_EQ(params->batch_timeout_micros, 0);
+}
+
 }  // namespace
 
 }  // namespace serving
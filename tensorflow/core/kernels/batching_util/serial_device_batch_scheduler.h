@@ -61,6 +61,13 @@ class SDBSQueue;
 // processing thread becomes available. SDBS prioritizes batches primarily by
 // age (i.e. the batch's oldest request) along with a configurable preference
 // for scheduling larger batches first.
+//
+// When several models share the device, enabling Options::fair_sharing makes
+// SDBS arbitrate between their queues with weighted fair queueing: each queue
+// is charged the measured processing cost of its batches divided by its
+// QueueOptions::weight, and the queue with the least accumulated charge is
+// served first. Options::max_in_flight_cost_micros additionally bounds the
+// estimated device time of all batches being processed concurrently.
 
 
 template <typename TaskType>
@@ -95,6 +102,16 @@ class SerialDeviceBatchScheduler : public std::enable_shared_from_this<
     // in_flight_batches_limit.  Larger numbers will reduce noise, but will be
     // less responsive to sudden changes in workload.
     int64_t batches_to_average_over = 1000;
+    // If true, batches are selected across queues by weighted fair queueing on
+    // the measured per-batch processing cost (see QueueOptions::weight), and
+    // age and full_batch_scheduling_boost_micros only order batches of queues
+    // which are equally far behind their fair share.
+    bool fair_sharing = false;
+    // If positive, a batch is not started while the estimated processing cost
+    // of the batches already in flight, plus its own, exceeds this value. The
+    // estimate is a per queue moving average of measured batch latencies. At
+    // least one batch is always allowed in flight. Zero disables the bound.
+    int64_t max_in_flight_cost_micros = 0;
   };
 
   // Ownership is shared between the caller of Create() and any queues created
@@ -108,6 +125,9 @@ class SerialDeviceBatchScheduler : public std::enable_shared_from_this<
     int max_batch_size = 1000;
     // Maximum number of enqueued (i.e. non-scheduled) batches.
     int max_enqueued_batches = 10;
+    // Relative share of device time granted to this queue when
+    // Options::fair_sharing is enabled. Must be positive.
+    double weight = 1.0;
   };
 
   using BatchProcessor = std::function<void(std::unique_ptr<Batch<TaskType>>)>;
@@ -142,6 +162,23 @@ class SerialDeviceBatchScheduler : public std::enable_shared_from_this<
   // Removes queue from scheduler.
   void RemoveQueue(const internal::SDBSQueue<TaskType>* queue);
 
+  // Per queue bookkeeping used for fair sharing and the in-flight cost bound.
+  struct QueueState {
+    double weight = 1.0;
+    // Device time charged to the queue so far, divided by its weight.
+    double virtual_time_micros = 0;
+    // Moving average of the queue's measured batch processing latency.
+    double avg_batch_cost_micros = 0;
+  };
+
+  // Returns the virtual time at which the next batch of 'state' would start,
+  // i.e. its charge, but no earlier than the current virtual clock so that
+  // idle queues don't accumulate credit.
+  double VirtualStartTime(const QueueState& state) const
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return std::max(state.virtual_time_micros, virtual_clock_micros_);
+  }
+
   Env* env() const { return options_.env; }
 
   const Options options_;
@@ -154,6 +191,16 @@ class SerialDeviceBatchScheduler : public std::enable_shared_from_this<
   std::unordered_map<const internal::SDBSQueue<TaskType>*, BatchProcessor>
       queues_and_callbacks_ TF_GUARDED_BY(mu_);
 
+  // Fair sharing and cost state of the queues added by AddQueue.
+  std::unordered_map<const internal::SDBSQueue<TaskType>*, QueueState>
+      queue_states_ TF_GUARDED_BY(mu_);
+
+  // Virtual start time of the most recently scheduled batch.
+  double virtual_clock_micros_ TF_GUARDED_BY(mu_) = 0;
+
+  // Sum of the estimated costs of the batches currently being processed.
+  double in_flight_cost_micros_ TF_GUARDED_BY(mu_) = 0;
+
   // Responsible for running the batch processing callbacks.
   std::unique_ptr<thread::ThreadPool> batch_thread_pool_;
 
@@ -297,6 +344,11 @@ absl::Status SerialDeviceBatchScheduler<TaskType>::Create(
         "target_pending should be larger than zero; was ",
         options.target_pending);
   }
+  if (options.max_in_flight_cost_micros < 0) {
+    return errors::InvalidArgument(
+        "max_in_flight_cost_micros can't be negative; was ",
+        options.max_in_flight_cost_micros);
+  }
   if (!options.get_pending_on_serial_device) {
     return errors::InvalidArgument(
         "get_pending_on_serial_device must be "
@@ -344,11 +396,18 @@ absl::Status SerialDeviceBatchScheduler<TaskType>::AddQueue(
         "max_enqueued_batches must be positive; was ",
         options.max_enqueued_batches);
   }
+  if (options.weight <= 0) {
+    return errors::InvalidArgument("weight must be positive; was ",
+                                   options.weight);
+  }
   internal::SDBSQueue<TaskType>* SDBS_queue_raw;
   queue->reset(SDBS_queue_raw = new internal::SDBSQueue<TaskType>(
                    this->shared_from_this(), options));
   mutex_lock l(mu_);
   queues_and_callbacks_[SDBS_queue_raw] = process_batch_callback;
+  QueueState& state = queue_states_[SDBS_queue_raw];
+  state.weight = options.weight;
+  state.virtual_time_micros = virtual_clock_micros_;
   return absl::OkStatus();
 }
 
@@ -364,6 +423,7 @@ void SerialDeviceBatchScheduler<TaskType>::RemoveQueue(
     const internal::SDBSQueue<TaskType>* queue) {
   mutex_lock l(mu_);
   queues_and_callbacks_.erase(queue);
+  queue_states_.erase(queue);
 }
 
 template <typename TaskType>
@@ -371,6 +431,7 @@ void SerialDeviceBatchScheduler<TaskType>::ProcessBatches() {
   const int64_t kIdleThreadSleepTimeMicros = 1000;
   const double kMaxNoBatchRatio = .1;
   const double kLowTrafficMovingAverageFactor = .1;
+  const double kBatchCostMovingAverageFactor = .1;
   for (;;) {
     mu_.lock();
     if (processing_threads_ < 1 ||
@@ -387,32 +448,72 @@ void SerialDeviceBatchScheduler<TaskType>::ProcessBatches() {
       env()->SleepForMicroseconds(sleep_time);
       continue;
     }
-    auto best_it = batches_.begin();
-    double best_score =
-        (*best_it)->creation_time_micros() -
-        options_.full_batch_scheduling_boost_micros * (*best_it)->size() /
-            static_cast<double>((*best_it)->queue()->max_task_size());
-    for (auto it = batches_.begin() + 1; it != batches_.end(); it++) {
+    auto best_it = batches_.end();
+    double best_start = 0;
+    double best_score = 0;
+    for (auto it = batches_.begin(); it != batches_.end(); it++) {
+      const double start =
+          options_.fair_sharing
+              ? VirtualStartTime(queue_states_[(*it)->queue()])
+              : 0;
       const double score =
           (*it)->creation_time_micros() -
           options_.full_batch_scheduling_boost_micros * (*it)->size() /
               static_cast<double>((*it)->queue()->max_task_size());
-      if (score < best_score) {
+      if (best_it == batches_.end() || start < best_start ||
+          (start == best_start && score < best_score)) {
+        best_start = start;
         best_score = score;
         best_it = it;
       }
     }
+    const internal::SDBSQueue<TaskType>* queue = (*best_it)->queue();
+    const double estimated_cost = queue_states_[queue].avg_batch_cost_micros;
+    if (options_.max_in_flight_cost_micros > 0 && in_flight_cost_micros_ > 0 &&
+        in_flight_cost_micros_ + estimated_cost >
+            options_.max_in_flight_cost_micros) {
+      no_batch_count_++;
+      int64_t sleep_time = batch_period_micros_ ? batch_period_micros_
+                                                : kIdleThreadSleepTimeMicros;
+      mu_.unlock();
+      env()->SleepForMicroseconds(sleep_time);
+      continue;
+    }
     const internal::SDBSBatch<TaskType>* batch = *best_it;
     batches_.erase(best_it);
+    if (options_.fair_sharing) {
+      virtual_clock_micros_ = best_start;
+      QueueState& state = queue_states_[queue];
+      state.virtual_time_micros = best_start + estimated_cost / state.weight;
+    }
+    in_flight_cost_micros_ += estimated_cost;
     // Queue may destroy itself after ReleaseBatch is called.
     batch->queue()->ReleaseBatch(batch);
-    auto callback = queues_and_callbacks_[batch->queue()];
+    auto callback = queues_and_callbacks_[queue];
     mu_.unlock();
     int64_t start_time = env()->NowMicros();
     callback(std::unique_ptr<Batch<TaskType>>(
         const_cast<internal::SDBSBatch<TaskType>*>(batch)));
     int64_t end_time = env()->NowMicros();
     mu_.lock();
+    in_flight_cost_micros_ -= estimated_cost;
+    // The queue may have been removed while its last batch was processed.
+    auto state_it = queue_states_.find(queue);
+    if (state_it != queue_states_.end()) {
+      QueueState& state = state_it->second;
+      const double cost = end_time - start_time;
+      if (options_.fair_sharing) {
+        // Replace the estimate charged when the batch was scheduled by the
+        // measured cost.
+        state.virtual_time_micros += (cost - estimated_cost) / state.weight;
+      }
+      state.avg_batch_cost_micros =
+          state.avg_batch_cost_micros == 0
+              ? cost
+              : (1 - kBatchCostMovingAverageFactor) *
+                        state.avg_batch_cost_micros +
+                    kBatchCostMovingAverageFactor * cost;
+    }
     batch_count_++;
     batch_latency_sum_ += end_time - start_time;
     pending_sum_ += options_.get_pending_on_serial_device();
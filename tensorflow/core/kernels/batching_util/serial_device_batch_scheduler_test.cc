@@ -87,6 +87,14 @@ TEST(SerialDeviceBatchSchedulerTest, BadOptions) {
   options = default_options;
   options.target_pending = 0;
   EXPECT_FALSE(Scheduler::Create(options, &scheduler).ok());
+  options = default_options;
+  options.max_in_flight_cost_micros = -1;
+  EXPECT_FALSE(Scheduler::Create(options, &scheduler).ok());
+  TF_ASSERT_OK(Scheduler::Create(default_options, &scheduler));
+  Scheduler::QueueOptions queue_options;
+  queue_options.weight = 0;
+  std::unique_ptr<BatchScheduler<FakeTask>> queue;
+  EXPECT_FALSE(scheduler->AddQueue(queue_options, nullptr, &queue).ok());
   options = Scheduler::Options();
   EXPECT_FALSE(Scheduler::Create(options, &scheduler).ok());
 }
@@ -259,6 +267,64 @@ TEST(SerialDeviceBatchSchedulerTest, FullBatchSchedulingBoostMicros) {
   stop_teardown.Notify();
 }
 
+TEST(SerialDeviceBatchSchedulerTest, FairSharing) {
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+  {
+    SerialDeviceBatchScheduler<FakeTask>::Options options;
+    options.env = &env;
+    options.initial_in_flight_batches_limit = 1;
+    options.batches_to_average_over = 1000;
+    options.fair_sharing = true;
+    options.get_pending_on_serial_device = []() { return 0; };
+    mutex mu;
+    std::vector<int> processed_queues;
+    Notification all_processed;
+    auto make_callback = [&](int queue_id) {
+      return [&, queue_id](std::unique_ptr<Batch<FakeTask>> batch) {
+        ASSERT_TRUE(batch->IsClosed());
+        // Every batch costs 100 micros of device time.
+        env.AdvanceByMicroseconds(100);
+        mutex_lock l(mu);
+        processed_queues.push_back(queue_id);
+        if (processed_queues.size() == 20) all_processed.Notify();
+      };
+    };
+    std::shared_ptr<SerialDeviceBatchScheduler<FakeTask>> scheduler;
+    TF_ASSERT_OK(
+        SerialDeviceBatchScheduler<FakeTask>::Create(options, &scheduler));
+    // Make sure batch processing thread has gone to sleep.
+    Env::Default()->SleepForMicroseconds(1000);
+    SerialDeviceBatchScheduler<FakeTask>::QueueOptions queue_options;
+    queue_options.max_batch_size = 10;
+    std::unique_ptr<BatchScheduler<FakeTask>> queue1;
+    std::unique_ptr<BatchScheduler<FakeTask>> queue2;
+    queue_options.weight = 1;
+    TF_ASSERT_OK(scheduler->AddQueue(queue_options, make_callback(1), &queue1));
+    queue_options.weight = 4;
+    TF_ASSERT_OK(scheduler->AddQueue(queue_options, make_callback(2), &queue2));
+    for (int i = 0; i < 10; i++) {
+      TF_ASSERT_OK(ScheduleTask(10, queue1.get()));
+      TF_ASSERT_OK(ScheduleTask(10, queue2.get()));
+    }
+    // Release the batch processing thread.
+    env.AdvanceByMicroseconds(1000);
+    all_processed.WaitForNotification();
+    {
+      mutex_lock l(mu);
+      // While both queues are backlogged, queue2 gets 4x the device time.
+      EXPECT_EQ(2, std::count(processed_queues.begin(),
+                              processed_queues.begin() + 10, 1));
+      EXPECT_EQ(8, std::count(processed_queues.begin(),
+                              processed_queues.begin() + 10, 2));
+    }
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
 TEST(SerialDeviceBatchSchedulerTest, DeleteQueue) {
   SerialDeviceBatchScheduler<FakeTask>::Options options;
   options.initial_in_flight_batches_limit = 1;
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <stddef.h>
 
+#include <algorithm>
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
@@ -25,6 +26,7 @@ limitations under the License.
 #include <functional>
 #include <list>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <variant>
 #include <vector>
@@ -136,6 +138,12 @@ class SharedBatchScheduler
     // Must be >= 1, and should be tuned carefully.
     int num_batch_threads = port::MaxParallelism();
 
+    // The number of batch threads that never process batches made only of low
+    // priority tasks (see QueueOptions::enable_priority_queue), so that high
+    // priority batches don't wait for low priority ones to finish. Must be
+    // less than `num_batch_threads`.
+    int num_batch_threads_reserved_for_high_priority = 0;
+
     // The environment to use.
     // (Typically only overridden by test code.)
     Env* env = Env::Default();
@@ -238,6 +246,16 @@ class SharedBatchScheduler
     // requested.
     ModelBatchStats* model_batch_stats = nullptr;
 
+    // If positive, the latency budget (in microseconds) of a task, from being
+    // enqueued until its batch has been processed. The queue then adapts
+    // the batch timeout and the size at which it schedules a batch to the
+    // batch costs recorded in `model_batch_stats`, favoring large batches as
+    // long as the budget allows (see GetSloBatchingParams). Until costs are
+    // recorded, `batch_timeout_micros` and `max_execution_batch_size` are used.
+    //
+    // Only applies to high priority batches, and requires `model_batch_stats`.
+    int64_t latency_slo_micros = 0;
+
     // If true, queue implementation would split high priority and low priority
     // inputs into two sub queues.
     bool enable_priority_queue = false;
@@ -267,6 +285,24 @@ class SharedBatchScheduler
     // effective only when enable_priority_queue is true.
     MixedPriorityBatchingPolicy mixed_priority_batching_policy =
         MixedPriorityBatchingPolicy::kLowPriorityPaddingWithMaxBatchSize;
+
+    // If positive, Schedule() rejects low priority tasks with an UNAVAILABLE
+    // error while at least this many non-empty high priority batches
+    // (including the open one) are enqueued, shedding low priority load under
+    // overload. Effective only when enable_priority_queue is true.
+    size_t low_priority_shedding_enqueued_batches = 0;
+
+    // If true, Schedule() doesn't take the queue's lock: tasks are pushed onto
+    // a lock-free list and moved into batches by the batch threads when they
+    // look for work. A batch thread is woken up only when a task arrives at an
+    // empty queue or completes a batch's worth of tasks; timeouts are observed
+    // by the batch threads' periodic polling, measured from the time each
+    // task was enqueued.
+    //
+    // Capacity is checked against the total size of the enqueued tasks, i.e.
+    // `max_enqueued_batches * max_execution_batch_size`. Can't be combined
+    // with `enable_large_batch_splitting` or `enable_priority_queue`.
+    bool enable_lock_free_enqueue = false;
   };
   // This method is marked virtual for testing purposes only.
   virtual absl::Status AddQueue(
@@ -278,7 +314,8 @@ class SharedBatchScheduler
 
  private:
   void GetNextWorkItem_Locked(internal::Queue<TaskType>** queue_for_batch_out,
-                              BatchTaskUniquePtr* batch_to_process_out)
+                              BatchTaskUniquePtr* batch_to_process_out,
+                              bool* is_low_priority_batch_out)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
   // The code executed in 'batch_threads_'. Obtains a batch to process from the
@@ -319,6 +356,10 @@ class SharedBatchScheduler
   // Threads that process batches obtained from the queues.
   std::vector<std::unique_ptr<PeriodicFunction>> batch_threads_;
 
+  // The number of batches made only of low priority tasks that are being
+  // processed by batch threads.
+  int num_low_priority_batches_being_processed_ TF_GUARDED_BY(mu_) = 0;
+
   SharedBatchScheduler(const SharedBatchScheduler&) = delete;
   void operator=(const SharedBatchScheduler&) = delete;
 };
@@ -394,7 +435,13 @@ class Queue {
   // this queue. Either returns a batch that is ready to be processed, or
   // nullptr if the queue declines to schedule a batch at this time. If it
   // returns a batch, the batch is guaranteed to be closed.
-  typename SharedBatchScheduler<TaskType>::BatchTaskUniquePtr ScheduleBatch();
+  //
+  // Batches made only of low priority tasks are returned only if
+  // `allow_low_priority_batch` is true, in which case `is_low_priority_batch`
+  // (if not null) is set to whether the returned batch is one of them.
+  typename SharedBatchScheduler<TaskType>::BatchTaskUniquePtr ScheduleBatch(
+      bool allow_low_priority_batch = true,
+      bool* is_low_priority_batch = nullptr);
 
   // Retrieves the low priority tasks that can be padded to a high priority
   // batch of the specified size.
@@ -443,10 +490,23 @@ class Queue {
   absl::Status ScheduleWithoutOrEagerSplitImpl(std::unique_ptr<TaskType>* task)
       TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Implementation of Schedule above when `options_.enable_lock_free_enqueue`
+  // is set. Pushes `task` onto `staged_tasks_` without taking `mu_`.
+  absl::Status ScheduleLockFree(std::unique_ptr<TaskType>* task)
+      TF_LOCKS_EXCLUDED(mu_);
+
+  // Moves the tasks pushed by ScheduleLockFree() into batches, in the order in
+  // which they were enqueued.
+  void DrainStagedTasks() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // Closes the open batch residing at the back of std::deque, and inserts a
   // fresh open batch behind it.
   void StartNewBatch() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
+  // Updates `batch_timeout_micros_` and `target_batch_size_` from the batch
+  // costs recorded so far, if `options_.latency_slo_micros` is set.
+  void UpdateSloBatchingParams() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
   // Split `input task` into `output_tasks` according to 'task_sizes'.
   absl::Status SplitInputBatchIntoSubtasks(
       std::unique_ptr<TaskType>* input_task,
@@ -543,6 +603,25 @@ class Queue {
   std::deque<std::unique_ptr<Batch<TaskType>>> high_priority_batches_
       TF_GUARDED_BY(mu_);
 
+  // A task enqueued by ScheduleLockFree() but not yet moved into a batch.
+  struct StagedTask {
+    std::unique_ptr<TaskType> task;
+    uint64 enqueue_time_micros;
+    StagedTask* next;
+  };
+
+  // Lock-free list of staged tasks, most recently enqueued first. Owned by the
+  // queue; pushed to by ScheduleLockFree() and drained by DrainStagedTasks().
+  std::atomic<StagedTask*> staged_tasks_{nullptr};
+
+  // The number of tasks in `staged_tasks_`. Incremented before a task is
+  // pushed, so it may transiently overcount but never undercounts.
+  std::atomic<int64_t> num_staged_tasks_{0};
+
+  // Total size of the tasks accepted by ScheduleLockFree() that are not yet
+  // being processed, whether staged or in batches.
+  std::atomic<int64_t> lock_free_enqueued_size_{0};
+
   // The counter of the TraceMe context ids.
   uint64 traceme_context_id_counter_ TF_GUARDED_BY(mu_) = 0;
 
@@ -558,6 +637,12 @@ class Queue {
   // Used to keep track of when to call 'schedulable_batch_callback_'.
   bool schedulable_batch_ TF_GUARDED_BY(mu_) = false;
 
+  // The timeout of the open batch, and the size at which it is scheduled
+  // without waiting for the timeout. Differ from the queue options only when
+  // `options_.latency_slo_micros` is set.
+  int64_t batch_timeout_micros_ TF_GUARDED_BY(mu_);
+  size_t target_batch_size_ TF_GUARDED_BY(mu_);
+
   // The number of batches currently being processed by batch threads.
   // Incremented in ScheduleBatch() and decremented in ProcessBatch().
   int num_batches_being_processed_ TF_GUARDED_BY(mu_) = 0;
@@ -610,6 +695,14 @@ absl::Status SharedBatchScheduler<TaskType>::Create(
     return errors::InvalidArgument("num_batch_threads must be positive; was ",
                                    options.num_batch_threads);
   }
+  if (options.num_batch_threads_reserved_for_high_priority < 0 ||
+      options.num_batch_threads_reserved_for_high_priority >=
+          options.num_batch_threads) {
+    return errors::InvalidArgument(
+        "num_batch_threads_reserved_for_high_priority must be non-negative and "
+        "less than num_batch_threads; was ",
+        options.num_batch_threads_reserved_for_high_priority);
+  }
   scheduler->reset(new SharedBatchScheduler<TaskType>(options));
   return absl::OkStatus();
 }
@@ -671,6 +764,22 @@ absl::Status SharedBatchScheduler<TaskType>::AddQueueAfterRewritingOptions(
         "max_enqueued_batches must be positive; was ",
         options.max_enqueued_batches);
   }
+  if (options.latency_slo_micros < 0) {
+    return errors::InvalidArgument(
+        "latency_slo_micros must be non-negative; was ",
+        options.latency_slo_micros);
+  }
+  if (options.latency_slo_micros > 0 && options.model_batch_stats == nullptr) {
+    return errors::InvalidArgument(
+        "model_batch_stats must be specified when latency_slo_micros is set");
+  }
+
+  if (options.enable_lock_free_enqueue &&
+      (options.enable_large_batch_splitting || options.enable_priority_queue)) {
+    return errors::InvalidArgument(
+        "enable_lock_free_enqueue can't be combined with "
+        "enable_large_batch_splitting or enable_priority_queue");
+  }
 
   if (options.enable_large_batch_splitting &&
       options.split_input_task_func == nullptr) {
@@ -736,9 +845,15 @@ bool SharedBatchScheduler<TaskType>::BatchExists(
 template <typename TaskType>
 void SharedBatchScheduler<TaskType>::GetNextWorkItem_Locked(
     internal::Queue<TaskType>** queue_for_batch_out,
-    BatchTaskUniquePtr* batch_to_process_out) {
+    BatchTaskUniquePtr* batch_to_process_out, bool* is_low_priority_batch_out) {
   BatchTaskUniquePtr batch_to_process;
   internal::Queue<TaskType>* queue_for_batch = nullptr;
+  bool is_low_priority_batch = false;
+  // Keep the reserved threads free for high priority batches.
+  const bool allow_low_priority_batch =
+      num_low_priority_batches_being_processed_ <
+      options_.num_batch_threads -
+          options_.num_batch_threads_reserved_for_high_priority;
   const int num_queues = queues_.size();
   for (int num_queues_tried = 0;
        !BatchExists(batch_to_process) && num_queues_tried < num_queues;
@@ -752,7 +867,8 @@ void SharedBatchScheduler<TaskType>::GetNextWorkItem_Locked(
     const bool queue_closed = (*next_queue_to_schedule_)->closed();
 
     // Ask '*next_queue_to_schedule_' if it wants us to process a batch.
-    batch_to_process = (*next_queue_to_schedule_)->ScheduleBatch();
+    batch_to_process = (*next_queue_to_schedule_)->ScheduleBatch(
+        allow_low_priority_batch, &is_low_priority_batch);
 
     if (BatchExists(batch_to_process)) {
       queue_for_batch = next_queue_to_schedule_->get();
@@ -772,8 +888,12 @@ void SharedBatchScheduler<TaskType>::GetNextWorkItem_Locked(
       next_queue_to_schedule_ = queues_.begin();
     }
   }
+  if (BatchExists(batch_to_process) && is_low_priority_batch) {
+    ++num_low_priority_batches_being_processed_;
+  }
   *queue_for_batch_out = queue_for_batch;
   *batch_to_process_out = std::move(batch_to_process);
+  *is_low_priority_batch_out = is_low_priority_batch;
 }
 
 template <typename TaskType>
@@ -782,10 +902,13 @@ void SharedBatchScheduler<TaskType>::ThreadLogic() {
   BatchTaskUniquePtr batch_to_process;
   // The queue with which 'batch_to_process' is associated.
   internal::Queue<TaskType>* queue_for_batch = nullptr;
+  // Whether 'batch_to_process' is made only of low priority tasks.
+  bool is_low_priority_batch = false;
   {
     mutex_lock l(mu_);
     while (true) {
-      GetNextWorkItem_Locked(&queue_for_batch, &batch_to_process);
+      GetNextWorkItem_Locked(&queue_for_batch, &batch_to_process,
+                             &is_low_priority_batch);
       if (BatchExists(batch_to_process)) break;
       // We couldn't find any work to do. Wait until a new batch becomes
       // schedulable, or some time has elapsed, before checking again.
@@ -800,6 +923,11 @@ void SharedBatchScheduler<TaskType>::ThreadLogic() {
   queue_for_batch->ProcessBatch(
       std::move(batch_to_process),
       queue_for_batch->GetLowPriorityTasksForPadding(batch_size_to_schedule));
+
+  if (is_low_priority_batch) {
+    mutex_lock l(mu_);
+    --num_low_priority_batches_being_processed_;
+  }
 }
 
 namespace internal {
@@ -813,13 +941,16 @@ Queue<TaskType>::Queue(
       env_(env),
       max_execution_batch_size_(GetMaxExecutionBatchSize(options_)),
       process_batch_callback_(process_batch_callback),
-      schedulable_batch_callback_(schedulable_batch_callback) {
+      schedulable_batch_callback_(schedulable_batch_callback),
+      batch_timeout_micros_(options_.batch_timeout_micros),
+      target_batch_size_(max_execution_batch_size_) {
   // Set the higher 32 bits of traceme_context_id_counter_ to be the creation
   // time of the queue. This prevents the batches in different queues to have
   // the same traceme_context_id_counter_.
   traceme_context_id_counter_ = (absl::GetCurrentTimeNanos() & 0xFFFFFFFF)
                                 << 32;
   GetBatches().emplace_back(new Batch<TaskType>);
+  UpdateSloBatchingParams();
 }
 
 template <typename TaskType>
@@ -905,6 +1036,10 @@ absl::Status Queue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
         {{"batching_input_task_size", (*task)->size()}});
   });
 
+  if (options_.enable_lock_free_enqueue) {
+    return ScheduleLockFree(task);
+  }
+
   bool notify_of_schedulable_batch = false;
   {
     mutex_lock l(mu_);
@@ -914,6 +1049,18 @@ absl::Status Queue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
     if (IsLowPriorityTask(task)) {
       // Insert the task to the low priority task queue instead of the high
       // priority batch queue below.
+      const int64_t num_high_priority_batches =
+          num_enqueued_batches() - (GetBatches().back()->empty() ? 1 : 0);
+      if (options_.low_priority_shedding_enqueued_batches > 0 &&
+          num_high_priority_batches >=
+              options_.low_priority_shedding_enqueued_batches) {
+        return absl::UnavailableError(absl::StrFormat(
+            "The queue to which this low priority task was submitted is "
+            "overloaded; it has %d enqueued high priority batches while "
+            "low_priority_shedding_enqueued_batches=%d",
+            num_high_priority_batches,
+            options_.low_priority_shedding_enqueued_batches));
+      }
       TF_RETURN_IF_ERROR(ValidateLowPriorityTaskQueueCapacity(**task));
       low_priority_tasks_.AddTask(std::move(*task), env_->NowMicros());
     } else {
@@ -937,9 +1084,82 @@ absl::Status Queue<TaskType>::Schedule(std::unique_ptr<TaskType>* task) {
   return absl::OkStatus();
 }
 
+template <typename TaskType>
+absl::Status Queue<TaskType>::ScheduleLockFree(
+    std::unique_ptr<TaskType>* task) {
+  DCHECK(!closed());
+  const int64_t task_size = (*task)->size();
+  if (task_size > options_.input_batch_size_limit) {
+    return absl::InvalidArgumentError(absl::StrFormat(
+        "Task size %d is larger than maximum input batch size %d", task_size,
+        options_.input_batch_size_limit));
+  }
+  const int64_t batch_size = max_execution_batch_size();
+  const int64_t capacity = options_.max_enqueued_batches * batch_size;
+  const int64_t enqueued_size_before = lock_free_enqueued_size_.fetch_add(
+      task_size, std::memory_order_relaxed);
+  const int64_t enqueued_size = enqueued_size_before + task_size;
+  if (enqueued_size > capacity) {
+    lock_free_enqueued_size_.fetch_sub(task_size, std::memory_order_relaxed);
+    return errors::Unavailable(
+        "The batch scheduling queue to which this task was submitted is "
+        "full; task size is ",
+        task_size, " but ", enqueued_size_before,
+        " is already enqueued and the capacity is ", capacity,
+        " (max_enqueued_batches=", options_.max_enqueued_batches,
+        ", max_execution_batch_size=", batch_size, ")");
+  }
+
+  num_staged_tasks_.fetch_add(1, std::memory_order_relaxed);
+  auto* staged = new StagedTask{std::move(*task), env_->NowMicros(),
+                                staged_tasks_.load(std::memory_order_relaxed)};
+  while (!staged_tasks_.compare_exchange_weak(staged->next, staged,
+                                              std::memory_order_release,
+                                              std::memory_order_relaxed)) {
+  }
+
+  // Only wake up a batch thread when its work may have become schedulable
+  // right away; the open batch's timeout is picked up by polling.
+  if (enqueued_size_before == 0 ||
+      enqueued_size / batch_size > enqueued_size_before / batch_size) {
+    schedulable_batch_callback_();
+  }
+  return absl::OkStatus();
+}
+
+template <typename TaskType>
+void Queue<TaskType>::DrainStagedTasks() {
+  StagedTask* head = staged_tasks_.exchange(nullptr, std::memory_order_acquire);
+  if (head == nullptr) return;
+  // Reverse the list to process tasks in enqueue order.
+  StagedTask* oldest = nullptr;
+  while (head != nullptr) {
+    StagedTask* next = head->next;
+    head->next = oldest;
+    oldest = head;
+    head = next;
+  }
+  std::deque<std::unique_ptr<Batch<TaskType>>>& batches = GetBatches();
+  int64_t num_drained = 0;
+  while (oldest != nullptr) {
+    std::unique_ptr<StagedTask> staged(oldest);
+    oldest = staged->next;
+    if (batches.back()->size() + staged->task->size() >
+        max_execution_batch_size()) {
+      StartNewBatch();
+    }
+    if (batches.back()->empty()) {
+      open_batch_start_time_micros_ = staged->enqueue_time_micros;
+    }
+    batches.back()->AddTask(std::move(staged->task));
+    ++num_drained;
+  }
+  num_staged_tasks_.fetch_sub(num_drained, std::memory_order_relaxed);
+}
+
 template <typename TaskType>
 size_t Queue<TaskType>::NumEnqueuedTasks() const {
-  size_t num_enqueued_tasks = 0;
+  size_t num_enqueued_tasks = num_staged_tasks_.load(std::memory_order_relaxed);
   mutex_lock l(mu_);
   for (const auto& batch : GetBatches()) {
     num_enqueued_tasks += batch->num_tasks();
@@ -949,6 +1169,12 @@ size_t Queue<TaskType>::NumEnqueuedTasks() const {
 
 template <typename TaskType>
 size_t Queue<TaskType>::SchedulingCapacity() const {
+  if (options_.enable_lock_free_enqueue) {
+    const int64_t capacity =
+        options_.max_enqueued_batches * max_execution_batch_size();
+    return std::max<int64_t>(
+        0, capacity - lock_free_enqueued_size_.load(std::memory_order_relaxed));
+  }
   mutex_lock l(mu_);
   return SchedulingCapacityInternal();
 }
@@ -1046,7 +1272,8 @@ absl::Status Queue<TaskType>::ValidateLowPriorityTaskQueueCapacity(
 
 template <typename TaskType>
 typename SharedBatchScheduler<TaskType>::BatchTaskUniquePtr
-Queue<TaskType>::ScheduleBatch() {
+Queue<TaskType>::ScheduleBatch(bool allow_low_priority_batch,
+                               bool* is_low_priority_batch) {
   // The batch to schedule, which we may populate below. (If left as nullptr,
   // that means we are electing not to schedule a batch at this time.)
   std::unique_ptr<Batch<TaskType>> batch_to_schedule;
@@ -1054,6 +1281,7 @@ Queue<TaskType>::ScheduleBatch() {
   {
     mutex_lock l(mu_);
 
+    DrainStagedTasks();
     std::deque<std::unique_ptr<Batch<TaskType>>>& batches = GetBatches();
     // Consider closing the open batch at this time, to schedule it.
     if (batches.size() == 1 && IsOpenBatchSchedulable()) {
@@ -1106,10 +1334,15 @@ Queue<TaskType>::ScheduleBatch() {
       batches.pop_front();
     }
 
-    if (batch_to_schedule == nullptr) {
+    if (batch_to_schedule == nullptr && allow_low_priority_batch) {
       // If there was no schedulable batch in the batch queue, try to schedule
       // from the low priority task queue.
       batch_to_schedule = ScheduleLowPriorityBatch();
+      if (is_low_priority_batch != nullptr) {
+        *is_low_priority_batch = batch_to_schedule != nullptr;
+      }
+    } else if (is_low_priority_batch != nullptr) {
+      *is_low_priority_batch = false;
     }
 
     if (batch_to_schedule == nullptr) {
@@ -1121,6 +1354,10 @@ Queue<TaskType>::ScheduleBatch() {
 
     // Otherwise, increment the counter and return the batch.
     ++num_batches_being_processed_;
+    if (options_.enable_lock_free_enqueue) {
+      lock_free_enqueued_size_.fetch_sub(batch_to_schedule->size(),
+                                         std::memory_order_relaxed);
+    }
   }
   return batch_to_schedule;
 }
@@ -1221,7 +1458,8 @@ template <typename TaskType>
 bool Queue<TaskType>::IsEmptyInternal() const {
   const std::deque<std::unique_ptr<Batch<TaskType>>>& batches = GetBatches();
   return num_batches_being_processed_ == 0 && batches.size() == 1 &&
-         batches.back()->empty() && low_priority_tasks_.empty();
+         batches.back()->empty() && low_priority_tasks_.empty() &&
+         num_staged_tasks_.load(std::memory_order_relaxed) == 0;
 }
 
 template <typename TaskType>
@@ -1229,6 +1467,18 @@ void Queue<TaskType>::StartNewBatch() {
   std::deque<std::unique_ptr<Batch<TaskType>>>& batches = GetBatches();
   batches.back()->Close();
   batches.emplace_back(new Batch<TaskType>(++traceme_context_id_counter_));
+  UpdateSloBatchingParams();
+}
+
+template <typename TaskType>
+void Queue<TaskType>::UpdateSloBatchingParams() {
+  if (options_.latency_slo_micros <= 0) return;
+  std::optional<SloBatchingParams> params = GetSloBatchingParams(
+      absl::Microseconds(options_.latency_slo_micros),
+      max_execution_batch_size(), *options_.model_batch_stats);
+  if (!params.has_value()) return;
+  batch_timeout_micros_ = params->batch_timeout_micros;
+  target_batch_size_ = params->target_batch_size;
 }
 
 template <typename TaskType>
@@ -1248,9 +1498,9 @@ bool Queue<TaskType>::IsOpenBatchSchedulable() const {
   if (open_batch->empty()) {
     return false;
   }
-  return closed_ || open_batch->size() >= max_execution_batch_size() ||
+  return closed_ || open_batch->size() >= target_batch_size_ ||
          env_->NowMicros() >=
-             open_batch_start_time_micros_ + options_.batch_timeout_micros;
+             open_batch_start_time_micros_ + batch_timeout_micros_;
 }
 
 template <typename TaskType>
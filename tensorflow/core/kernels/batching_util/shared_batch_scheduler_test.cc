@@ -31,6 +31,7 @@ limitations under the License.
 #include "xla/tsl/lib/core/status_test_util.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler.h"
 #include "tensorflow/core/kernels/batching_util/batch_scheduler_utils.h"
+#include "tensorflow/core/kernels/batching_util/batch_stats.h"
 #include "tensorflow/core/kernels/batching_util/fake_clock_env.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
@@ -1090,11 +1091,186 @@ TEST_P(SharedBatchSchedulerTest, BatchPaddingPolicyBatchDown) {
   stop_teardown.Notify();
 }
 
+TEST_P(SharedBatchSchedulerTest, LatencySloAdaptsBatching) {
+  // Set up a fake clock, which only advances when we explicitly tell it to.
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    Notification first_batch_processed;
+    Notification second_batch_processed;
+    auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+      if (!first_batch_processed.HasBeenNotified()) {
+        // Size 4 is the largest batch size whose cost fits into the SLO.
+        EXPECT_EQ(batch->size(), 4);
+        first_batch_processed.Notify();
+        return;
+      }
+
+      if (!second_batch_processed.HasBeenNotified()) {
+        EXPECT_EQ(batch->size(), 1);
+        second_batch_processed.Notify();
+        return;
+      }
+
+      ADD_FAILURE() << "Batch callback must not be invoked more than expected";
+    };
+
+    auto scheduler = CreateSharedBatchScheduler(1, &env);
+
+    QueueOptions options =
+        CreateQueueOptions(/* max_execution_batch_size= */ 10,
+                           /* input_batch_size_limit= */ 10,
+                           /* batch_timeout_micros= */ 1000 * 1000,
+                           /* max_enqueued_batches= */ 10);
+
+    ModelBatchStats model_batch_stats;
+    model_batch_stats.batch_size(2).tpu_cost().Register(absl::Milliseconds(1));
+    model_batch_stats.batch_size(4).tpu_cost().Register(absl::Milliseconds(3));
+    model_batch_stats.batch_size(8).tpu_cost().Register(absl::Milliseconds(6));
+    options.model_batch_stats = &model_batch_stats;
+    options.latency_slo_micros = 10 * 1000;
+
+    auto queue = CreateQueue(scheduler, options, callback);
+
+    // The batch is scheduled as soon as it reaches the target size.
+    for (int i = 0; i < 4; ++i) {
+      TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    }
+    first_batch_processed.WaitForNotification();
+
+    // The timeout leaves room for a batch of size 4 to be processed twice
+    // within the SLO.
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    env.AdvanceByMicroseconds(4000 - 1);
+    EXPECT_FALSE(second_batch_processed.WaitForNotificationWithTimeout(
+        absl::Milliseconds(10)));
+    env.AdvanceByMicroseconds(1);
+    second_batch_processed.WaitForNotification();
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
 // TODO(b/161857471):
 // Add test coverage when input-split and no-split returns differently.
 INSTANTIATE_TEST_SUITE_P(Parameter, SharedBatchSchedulerTest,
                          ::testing::Bool());
 
+TEST(SharedBatchSchedulerLockFreeEnqueueTest, RejectsIncompatibleOptions) {
+  auto scheduler = CreateSharedBatchScheduler(1);
+  QueueOptions options = CreateQueueOptions(
+      /* max_execution_batch_size= */ 4, /* input_batch_size_limit= */ 8,
+      /* batch_timeout_micros= */ 0, /* max_enqueued_batches= */ 2,
+      /* enable_large_batch_splitting= */ true, /* split_func= */
+      [](std::unique_ptr<FakeTask>* input_task, int open_batch_remaining_slot,
+         int max_batch_size,
+         std::vector<std::unique_ptr<FakeTask>>* output_tasks) {
+        return absl::OkStatus();
+      });
+  options.enable_lock_free_enqueue = true;
+  std::unique_ptr<BatchScheduler<FakeTask>> queue;
+  EXPECT_FALSE(
+      scheduler
+          ->AddQueue(options,
+                     [](std::unique_ptr<Batch<FakeTask>> batch) {}, &queue)
+          .ok());
+}
+
+TEST(SharedBatchSchedulerLockFreeEnqueueTest, ConcurrentEnqueue) {
+  constexpr int kNumThreads = 4;
+  constexpr int kTasksPerThread = 250;
+  mutex mu;
+  int num_processed_tasks = 0;
+  auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+    ASSERT_TRUE(batch->IsClosed());
+    EXPECT_LE(batch->size(), 10);
+    mutex_lock l(mu);
+    num_processed_tasks += batch->num_tasks();
+  };
+  {
+    auto scheduler = CreateSharedBatchScheduler(2);
+    QueueOptions options = CreateQueueOptions(
+        /* max_execution_batch_size= */ 10, /* input_batch_size_limit= */ 10,
+        /* batch_timeout_micros= */ 1000,
+        /* max_enqueued_batches= */ kNumThreads * kTasksPerThread,
+        /* enable_large_batch_splitting= */ false, /* split_func= */ nullptr);
+    options.enable_lock_free_enqueue = true;
+    auto queue = CreateQueue(scheduler, options, callback);
+    {
+      std::vector<std::unique_ptr<Thread>> threads;
+      for (int i = 0; i < kNumThreads; ++i) {
+        threads.emplace_back(Env::Default()->StartThread(
+            {}, "EnqueueThread", [&queue] {
+              for (int j = 0; j < kTasksPerThread; ++j) {
+                TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+              }
+            }));
+      }
+    }
+    // The queue's destructor waits until all tasks have been processed.
+  }
+  EXPECT_EQ(num_processed_tasks, kNumThreads * kTasksPerThread);
+}
+
+TEST(SharedBatchSchedulerLockFreeEnqueueTest, ObeysTimeoutAndCapacity) {
+  // Set up a fake clock, which only advances when we explicitly tell it to.
+  test_util::FakeClockEnv env(Env::Default());
+  Notification start_teardown, stop_teardown;
+  std::unique_ptr<Thread> teardown_thread =
+      CreateFakeClockAdvancerThread(&env, &start_teardown, &stop_teardown);
+
+  {
+    Notification first_batch_processed, second_batch_processed;
+    auto callback = [&](std::unique_ptr<Batch<FakeTask>> batch) {
+      ASSERT_TRUE(batch->IsClosed());
+      if (!first_batch_processed.HasBeenNotified()) {
+        EXPECT_EQ(batch->size(), 1);
+        first_batch_processed.Notify();
+        return;
+      }
+      if (!second_batch_processed.HasBeenNotified()) {
+        EXPECT_EQ(batch->size(), 4);
+        second_batch_processed.Notify();
+        return;
+      }
+      ADD_FAILURE() << "Batch callback must not be invoked more than expected";
+    };
+
+    auto scheduler = CreateSharedBatchScheduler(1, &env);
+    QueueOptions options = CreateQueueOptions(
+        /* max_execution_batch_size= */ 4, /* input_batch_size_limit= */ 4,
+        /* batch_timeout_micros= */ 10, /* max_enqueued_batches= */ 1,
+        /* enable_large_batch_splitting= */ false, /* split_func= */ nullptr);
+    options.enable_lock_free_enqueue = true;
+    auto queue = CreateQueue(scheduler, options, callback);
+
+    // An underfull batch is processed when the clock hits the timeout.
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    env.AdvanceByMicroseconds(9);
+    EXPECT_FALSE(first_batch_processed.WaitForNotificationWithTimeout(
+        absl::Milliseconds(10)));
+    env.AdvanceByMicroseconds(1);
+    first_batch_processed.WaitForNotification();
+
+    // Tasks beyond the queue's capacity are rejected, and a full batch is
+    // processed without waiting for the timeout.
+    TF_ASSERT_OK(ScheduleTask(3, queue.get()));
+    EXPECT_EQ(queue->NumEnqueuedTasks(), 1);
+    EXPECT_EQ(queue->SchedulingCapacity(), 1);
+    EXPECT_THAT(ScheduleTask(2, queue.get()),
+                testing::StatusIs(error::UNAVAILABLE));
+    TF_ASSERT_OK(ScheduleTask(1, queue.get()));
+    second_batch_processed.WaitForNotification();
+
+    start_teardown.Notify();
+  }
+  stop_teardown.Notify();
+}
+
 class SharedBatchSchedulerPriorityTest
     : public ::testing::TestWithParam<
           std::tuple<bool, MixedPriorityBatchingPolicy>>,
@@ -1148,6 +1324,93 @@ TEST_P(SharedBatchSchedulerPriorityTest,
   EXPECT_FALSE(queue_callback_called);
 }
 
+TEST_P(SharedBatchSchedulerPriorityTest,
+       LowPriorityTaskShedWhenHighPriorityBatchesEnqueued) {
+  bool queue_callback_called = false;
+  auto queue_callback = [&queue_callback_called](
+                            std::unique_ptr<Batch<FakeTask>> batch,
+                            std::vector<std::unique_ptr<FakeTask>> tasks) {
+    queue_callback_called = true;
+  };
+
+  {
+    std::shared_ptr<Scheduler> scheduler =
+        CreateSharedBatchScheduler(/*num_batch_threads=*/1);
+
+    QueueOptions queue_options = CreateQueueOptions(
+        /*max_execution_batch_size=*/10, /*input_batch_size_limit=*/10,
+        /*batch_timeout_micros=*/1 * 1000 * 1000, /*max_enqueued_batches=*/2,
+        /*enable_priority_queue=*/true);
+    queue_options.low_priority_queue_options.max_execution_batch_size = 10;
+    queue_options.low_priority_queue_options.batch_timeout_micros =
+        1 * 1000 * 1000;
+    queue_options.low_priority_queue_options.input_batch_size_limit = 10;
+    queue_options.low_priority_queue_options.max_enqueued_batches = 2;
+    queue_options.mixed_priority_batching_policy =
+        mixed_priority_batching_policy();
+    queue_options.low_priority_shedding_enqueued_batches = 1;
+    std::unique_ptr<Queue> queue =
+        CreateQueue(scheduler, queue_options, queue_callback);
+
+    TF_ASSERT_OK(ScheduleTask(1, queue.get(),
+                              tsl::criticality::Criticality::kSheddablePlus));
+    TF_ASSERT_OK(ScheduleTask(1, queue.get(),
+                              tsl::criticality::Criticality::kCritical));
+    EXPECT_THAT(
+        ScheduleTask(1, queue.get(),
+                     tsl::criticality::Criticality::kSheddablePlus),
+        testing::StatusIs(
+            absl::StatusCode::kUnavailable,
+            HasSubstr("low_priority_shedding_enqueued_batches=1")));
+  }
+  EXPECT_TRUE(queue_callback_called);
+}
+
+TEST_P(SharedBatchSchedulerPriorityTest,
+       ReservedBatchThreadProcessesHighPriorityBatch) {
+  Notification high_priority_batch_processed, proceed;
+  auto queue_callback = [&](std::unique_ptr<Batch<FakeTask>> batch,
+                            std::vector<std::unique_ptr<FakeTask>> tasks) {
+    if (batch->task(0).criticality() ==
+        tsl::criticality::Criticality::kCritical) {
+      high_priority_batch_processed.Notify();
+      return;
+    }
+    proceed.WaitForNotification();
+  };
+
+  Scheduler::Options options;
+  options.num_batch_threads = 2;
+  options.num_batch_threads_reserved_for_high_priority = 1;
+  std::shared_ptr<Scheduler> scheduler;
+  TF_ASSERT_OK(Scheduler::Create(options, &scheduler));
+
+  QueueOptions queue_options = CreateQueueOptions(
+      /*max_execution_batch_size=*/10, /*input_batch_size_limit=*/10,
+      /*batch_timeout_micros=*/0, /*max_enqueued_batches=*/2,
+      /*enable_priority_queue=*/true);
+  queue_options.low_priority_queue_options.max_execution_batch_size = 1;
+  queue_options.low_priority_queue_options.batch_timeout_micros = 0;
+  queue_options.low_priority_queue_options.input_batch_size_limit = 1;
+  queue_options.low_priority_queue_options.max_enqueued_batches = 2;
+  queue_options.mixed_priority_batching_policy =
+      mixed_priority_batching_policy();
+  std::unique_ptr<Queue> queue =
+      CreateQueue(scheduler, queue_options, queue_callback);
+
+  // Without the reservation, the two low priority batches would occupy both
+  // batch threads until `proceed` is notified.
+  TF_ASSERT_OK(ScheduleTask(1, queue.get(),
+                            tsl::criticality::Criticality::kSheddablePlus));
+  TF_ASSERT_OK(ScheduleTask(1, queue.get(),
+                            tsl::criticality::Criticality::kSheddablePlus));
+  TF_ASSERT_OK(
+      ScheduleTask(1, queue.get(), tsl::criticality::Criticality::kCritical));
+  EXPECT_TRUE(high_priority_batch_processed.WaitForNotificationWithTimeout(
+      absl::Seconds(10)));
+  proceed.Notify();
+}
+
 TEST_P(SharedBatchSchedulerPriorityTest,
        InvalidLowPriorityTaskWithQueueFullWithPriorityQueueEnabledNew) {
   Notification processing, proceed;
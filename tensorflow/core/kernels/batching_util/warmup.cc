@@ -22,6 +22,9 @@ limitations under the License.
 #include "absl/strings/str_cat.h"
 #include "absl/synchronization/mutex.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/kernels/batching_util/batch_cost_profile.h"
+#include "tensorflow/core/kernels/batching_util/batch_stats.h"
+#include "tensorflow/core/platform/env.h"
 #include "tsl/platform/logging.h"
 
 namespace tensorflow {
@@ -38,6 +41,19 @@ void WarmupStateRegistry::Handle::Release() {
 
 absl::StatusOr<WarmupStateRegistry::Handle> WarmupStateRegistry::Register(
     const Key& model_key, std::unique_ptr<PerModelData> per_model_data) {
+  // Preload the costs a previous warm-up of this model persisted, if any.
+  if (per_model_data && !per_model_data->batch_cost_profile_path.empty() &&
+      Env::Default()->FileExists(per_model_data->batch_cost_profile_path)
+          .ok()) {
+    absl::Status status = LoadBatchCostProfile(
+        per_model_data->batch_cost_profile_path, per_model_data->hardware_id,
+        GlobalBatchStatsRegistry());
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to preload batch cost profile for model "
+                   << model_key.name << ":" << model_key.version << ": "
+                   << status;
+    }
+  }
   absl::MutexLock l(&mu_);
   VLOG(1) << "Registering model " << model_key.name << ":" << model_key.version
           << " to warm-up registry";
@@ -50,11 +66,28 @@ absl::StatusOr<WarmupStateRegistry::Handle> WarmupStateRegistry::Register(
 }
 
 void WarmupStateRegistry::Unregister(const Key& model_key) {
-  absl::MutexLock l(&mu_);
+  std::unique_ptr<PerModelData> per_model_data;
+  {
+    absl::MutexLock l(&mu_);
 
-  VLOG(1) << "Unregistering model " << model_key.name << ":"
-          << model_key.version << " from warm-up registry";
-  states_.erase(model_key);
+    VLOG(1) << "Unregistering model " << model_key.name << ":"
+            << model_key.version << " from warm-up registry";
+    auto it = states_.find(model_key);
+    if (it == states_.end()) return;
+    per_model_data = std::move(it->second);
+    states_.erase(it);
+  }
+  // Persist the costs measured during warm-up outside of the lock.
+  if (per_model_data && !per_model_data->batch_cost_profile_path.empty()) {
+    absl::Status status = WriteBatchCostProfile(
+        GlobalBatchStatsRegistry(), model_key.name, per_model_data->hardware_id,
+        per_model_data->batch_cost_profile_path);
+    if (!status.ok()) {
+      LOG(WARNING) << "Failed to write batch cost profile for model "
+                   << model_key.name << ":" << model_key.version << ": "
+                   << status;
+    }
+  }
 }
 
 const WarmupStateRegistry::PerModelData* WarmupStateRegistry::Lookup(
@@ -59,6 +59,13 @@ class WarmupStateRegistry {
     // for all `allowed_batch_sizes` of that batch op. This removes the
     // need to issue separate warmup requests for each batch size.
     bool warmup_all_batch_sizes = false;
+    // If non-empty, the batch costs this model measures are preloaded from
+    // this batch cost profile (see batch_cost_profile.h) when the model is
+    // registered, and written back to it when the warm-up finishes.
+    std::string batch_cost_profile_path;
+    // Identifies the hardware the model runs on; profiles recorded on other
+    // hardware are not preloaded.
+    std::string hardware_id;
   };
 
   // RAII handle for registered models.
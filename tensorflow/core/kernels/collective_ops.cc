@@ -783,6 +783,21 @@ class CollectiveReduceV2OpKernel : public CollectiveOpV2Kernel {
     OP_REQUIRES_OK(c, c->GetAttr("final_op", &final_op_name));
     OP_REQUIRES_OK(
         c, c->GetAttr("max_subdivs_per_device", &max_subdivs_per_device_));
+    // Small reductions can be packed into buckets (see
+    // CollImplDetails::bucket_size) with these private attributes.
+    if (c->HasAttr("_collective_bucket_size")) {
+      OP_REQUIRES_OK(c, c->GetAttr("_collective_bucket_size", &bucket_size_));
+      OP_REQUIRES_OK(c, c->GetAttr("_collective_bucket_key", &bucket_key_));
+    }
+    // Float reductions can be sent in a reduced precision wire type (see
+    // CollImplDetails::wire_dtype).
+    if (c->HasAttr("_collective_wire_dtype")) {
+      OP_REQUIRES_OK(c, c->GetAttr("_collective_wire_dtype", &wire_dtype_));
+      OP_REQUIRES(c, wire_dtype_ == DT_HALF || wire_dtype_ == DT_BFLOAT16,
+                  errors::InvalidArgument(
+                      "_collective_wire_dtype must be half or bfloat16, got ",
+                      DataTypeString(wire_dtype_)));
+    }
     // Prepare OpKernels for reduction and final operations.
     // The merge_op takes two inputs
     NodeDef sub_node;
@@ -813,6 +828,9 @@ class CollectiveReduceV2OpKernel : public CollectiveOpV2Kernel {
         done_with_cleanup);
     col_params->instance.impl_details.max_subdivs_per_device =
         max_subdivs_per_device_;
+    col_params->instance.impl_details.bucket_key = bucket_key_;
+    col_params->instance.impl_details.bucket_size = bucket_size_;
+    col_params->instance.impl_details.wire_dtype = wire_dtype_;
     col_params->instance.shape = c->input(0).shape();
     col_params->merge_op = merge_op_.get();
     col_params->final_op = final_op_.get();
@@ -833,6 +851,9 @@ class CollectiveReduceV2OpKernel : public CollectiveOpV2Kernel {
 
  private:
   int max_subdivs_per_device_;
+  int32 bucket_key_ = 0;
+  int32 bucket_size_ = 0;
+  DataType wire_dtype_ = DT_INVALID;
   std::unique_ptr<OpKernel> merge_op_;
   std::unique_ptr<OpKernel> final_op_;
 };
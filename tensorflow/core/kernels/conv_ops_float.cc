@@ -15,14 +15,44 @@ limitations under the License.
 
 // See docs in ../ops/nn_ops.cc.
 
+#include <algorithm>
+#include <limits>
+
 #include "tensorflow/core/kernels/conv_ops_impl.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/util/autotune_maps/conv_parameters.pb.h"
+#include "tensorflow/core/util/autotune_maps/cpu_conv_autotune_map.h"
 
 namespace tensorflow {
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
 
+namespace {
+
+// Number of times each candidate runs while autotuning. Only the fastest run
+// counts, so that one-off costs of the first run (e.g. page faults in freshly
+// allocated buffers) do not bias the choice.
+constexpr int kAutotuneRuns = 2;
+
+// Runs `fn` kAutotuneRuns times and returns the fastest run in microseconds.
+template <typename Fn>
+uint64 FastestRunMicros(const Fn& fn) {
+  uint64 fastest = std::numeric_limits<uint64>::max();
+  for (int i = 0; i < kAutotuneRuns; ++i) {
+    const uint64 start = Env::Default()->NowMicros();
+    fn();
+    fastest = std::min(fastest, Env::Default()->NowMicros() - start);
+  }
+  return fastest;
+}
+
+}  // namespace
+
 // Conditionally launches DeepConv operation based on convolution parameters.
+// With TF_CPU_CONV_USE_AUTOTUNE, the choice between DeepConv2D and the Eigen
+// convolution is measured the first time a shape is seen and kept in the
+// CpuConvAutotuneMap, instead of following the static cost model.
 template <>
 class LaunchDeepConvOp<CPUDevice, float> {
  public:
@@ -32,9 +62,16 @@ class LaunchDeepConvOp<CPUDevice, float> {
                   int filter_cols, int pad_rows, int pad_cols, int out_rows,
                   int out_cols, int out_depth, int dilation_rows,
                   int dilation_cols, int stride_rows, int stride_cols,
-                  Tensor* output, TensorFormat data_format) {
+                  const Padding& padding, Tensor* output,
+                  TensorFormat data_format) {
     if (data_format != FORMAT_NHWC || dilation_rows != 1 ||
         dilation_cols != 1 ||
+        !IsDeepConv2DSupported(stride_rows, stride_cols, filter_rows,
+                               filter_cols)) {
+      return false;
+    }
+    const bool use_autotune = CpuConvUseAutotune();
+    if (!use_autotune &&
         !CanUseDeepConv2D(stride_rows, stride_cols, filter_rows, filter_cols,
                           in_depth, out_depth, out_rows, out_cols)) {
       return false;
@@ -56,9 +93,62 @@ class LaunchDeepConvOp<CPUDevice, float> {
     auto input_ptr = input.template flat<float>().data();
     auto filter_ptr = filter.template flat<float>().data();
     auto output_ptr = output->template flat<float>().data();
+    auto run_deep_conv = [&]() {
+      functor::DeepConv2D<CPUDevice, float>()(ctx, args, input_ptr, filter_ptr,
+                                              output_ptr);
+    };
+    if (!use_autotune) {
+      run_deep_conv();
+      return true;
+    }
+
+    ConvParametersProto params;
+    params.set_batch(batch);
+    params.set_in_depths(in_depth);
+    params.set_out_depths(out_depth);
+    params.add_in(input_rows);
+    params.add_in(input_cols);
+    params.set_data_format(data_format);
+    params.add_filter(filter_rows);
+    params.add_filter(filter_cols);
+    params.add_dilation(dilation_rows);
+    params.add_dilation(dilation_cols);
+    params.add_stride(stride_rows);
+    params.add_stride(stride_cols);
+    params.add_padding(pad_rows);
+    params.add_padding(pad_cols);
+    params.set_dtype(DT_FLOAT);
+    params.set_group_count(1);
+    params.set_device_identifier(CpuConvAutotuneMap::DeviceIdentifier(
+        ctx->device()->tensorflow_cpu_worker_threads()->num_threads));
+    params.set_version(CpuConvAutotuneMap::kVersion);
+
+    CpuConvAutotuneMap* autotune_map = CpuConvAutotuneMap::GetInstance();
+    CpuConvAlgorithm algorithm;
+    if (autotune_map->Find(params, &algorithm)) {
+      if (algorithm != CpuConvAlgorithm::kDeepConv2D) return false;
+      run_deep_conv();
+      return true;
+    }
 
-    functor::DeepConv2D<CPUDevice, float>()(ctx, args, input_ptr, filter_ptr,
-                                            output_ptr);
+    // Both candidates write the same convolution to `output`, so it holds
+    // the result whichever of them wins.
+    const uint64 deep_conv_micros = FastestRunMicros(run_deep_conv);
+    if (!ctx->status().ok()) return true;
+    const uint64 eigen_micros = FastestRunMicros([&]() {
+      LaunchConv2DOp<CPUDevice, float>()(
+          ctx, /*use_cudnn=*/false, /*cudnn_use_autotune=*/false, input,
+          filter, dilation_rows, dilation_cols, stride_rows, stride_cols,
+          padding, /*explicit_paddings=*/{}, output, data_format);
+    });
+    if (!ctx->status().ok()) return true;
+
+    algorithm = deep_conv_micros < eigen_micros ? CpuConvAlgorithm::kDeepConv2D
+                                                : CpuConvAlgorithm::kEigen;
+    VLOG(1) << "Conv2D autotune: deep_conv_micros = " << deep_conv_micros
+            << ", eigen_micros = " << eigen_micros
+            << ", params = " << params.ShortDebugString();
+    autotune_map->Insert(params, algorithm);
     return true;
   }
 };
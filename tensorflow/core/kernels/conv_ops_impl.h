@@ -638,8 +638,8 @@ class LaunchDeepConvOp {
                   int filter_cols, int pad_rows, int pad_cols, int out_rows,
                   int /*out_cols*/, int /*out_depth*/, int /*dilation_rows*/,
                   int /*dilation_cols*/, int /*stride_rows*/,
-                  int /*stride_cols*/, Tensor* /*output*/,
-                  TensorFormat /*data_format*/) {
+                  int /*stride_cols*/, const Padding& /*padding*/,
+                  Tensor* /*output*/, TensorFormat /*data_format*/) {
     return false;
   }
 };
@@ -712,7 +712,8 @@ class Conv2DOp : public BinaryOp<T> {
             dimensions.pad_cols_before, dimensions.out_rows,
             dimensions.out_cols, dimensions.out_depth, dimensions.dilation_rows,
             dimensions.dilation_cols, dimensions.stride_rows,
-            dimensions.stride_cols, output, params_.data_format)) {
+            dimensions.stride_cols, params_.padding, output,
+            params_.data_format)) {
       return;
     }
 
@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/data/global_shuffle_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/serialization_utils.h"
+#include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/dataset.h"
 #include "tensorflow/core/framework/dataset_options.pb.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
@@ -76,6 +77,21 @@ constexpr char kIncompleteCacheErrorMessage[] =
     "contents of the dataset  will be discarded. This can happen if you have "
     "an input pipeline similar to `dataset.cache().take(k).repeat()`. You "
     "should use `dataset.take(k).cache().repeat()` instead.";
+
+// Cache files align tensor data to the allocator alignment so that, on file
+// systems that support memory mapping, elements of memcpy-able types are read
+// back as views of the (page cached) file instead of being copied.
+BundleWriter::Options CacheWriterOptions() {
+  BundleWriter::Options options;
+  options.data_alignment = Allocator::kAllocatorAlignment;
+  return options;
+}
+
+BundleReader::Options CacheReaderOptions() {
+  BundleReader::Options options;
+  options.use_memory_mapped_data = true;
+  return options;
+}
 }  // namespace
 
 class DatasetRandomAccessCache {
@@ -475,7 +491,8 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         }
         filename_ = strings::StrCat(dataset()->filename_, "_", shard_id_);
         lockfile_ = strings::StrCat(filename_, kLockFileSuffix);
-        writer_ = std::make_unique<BundleWriter>(dataset()->env_, filename_);
+        writer_ = std::make_unique<BundleWriter>(dataset()->env_, filename_,
+                                                 CacheWriterOptions());
         return absl::OkStatus();
       }
 
@@ -537,7 +554,8 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
         // conditions are not met since BundleWriter's constructor creates
         // new temp files which can delete the temp files created by a
         // BundleWriter in another Session.
-        writer_ = std::make_unique<BundleWriter>(dataset()->env_, filename_);
+        writer_ = std::make_unique<BundleWriter>(dataset()->env_, filename_,
+                                                 CacheWriterOptions());
         lockfile_created_ = true;
         return absl::OkStatus();
       }
@@ -591,7 +609,8 @@ class CacheDatasetOp::FileDatasetBase : public DatasetBase {
       explicit FileReaderIterator(const Params& params)
           : DatasetIterator<FileDatasetBase>(params),
             cur_index_(0),
-            reader_(dataset()->env_, dataset()->filename_),
+            reader_(dataset()->env_, dataset()->filename_,
+                    CacheReaderOptions()),
             iterator_restored_(false) {}
 
       absl::Status GetNextInternal(IteratorContext* ctx,
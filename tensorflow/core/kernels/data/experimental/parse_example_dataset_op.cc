@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 #include <deque>
+#include <memory>
 
 #include "tensorflow/core/common_runtime/device.h"
 #include "tensorflow/core/data/dataset_utils.h"
@@ -197,10 +198,14 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
          it++) {
       it->second = i++;
     }
+    std::unique_ptr<const example::FastParseExampleConfigIndex> config_index;
+    OP_REQUIRES_OK(ctx, example::FastParseExampleConfigIndex::Create(
+                            config, &config_index));
 
     *output = new Dataset(
         ctx, input, dense_defaults, sparse_keys_, dense_keys_,
-        std::move(key_to_output_index), std::move(config), num_parallel_calls,
+        std::move(key_to_output_index), std::move(config),
+        std::move(config_index), num_parallel_calls,
         sparse_types_, dense_types_, dense_shapes_, output_types_,
         output_shapes_, deterministic_, has_ragged_keys_, ragged_keys_,
         ragged_value_types_, ragged_split_types_, op_version_);
@@ -213,7 +218,10 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
             std::vector<Tensor> dense_defaults, std::vector<string> sparse_keys,
             std::vector<string> dense_keys,
             std::map<string, int> key_to_output_index,
-            example::FastParseExampleConfig config, int32_t num_parallel_calls,
+            example::FastParseExampleConfig config,
+            std::unique_ptr<const example::FastParseExampleConfigIndex>
+                config_index,
+            int32_t num_parallel_calls,
             const DataTypeVector& sparse_types,
             const DataTypeVector& dense_types,
             const std::vector<PartialTensorShape>& dense_shapes,
@@ -231,6 +239,7 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
           ragged_keys_(std::move(ragged_keys)),
           key_to_output_index_(std::move(key_to_output_index)),
           config_(std::move(config)),
+          config_index_(std::move(config_index)),
           num_parallel_calls_(num_parallel_calls),
           sparse_types_(sparse_types),
           dense_types_(dense_types),
@@ -665,8 +674,9 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
           config.collect_feature_stats = true;
         }
         example::Result example_result;
-        TF_RETURN_IF_ERROR(FastParseExample(
-            config, slice_vec, {}, device_threadpool, &example_result));
+        TF_RETURN_IF_ERROR(FastParseExample(config, *dataset()->config_index_,
+                                            slice_vec, {}, device_threadpool,
+                                            &example_result));
         (*output).resize(dataset()->key_to_output_index_.size());
         for (int d = 0; d < dataset()->dense_keys_.size(); ++d) {
           int output_index =
@@ -923,6 +933,8 @@ class ParseExampleDatasetOp : public UnaryDatasetOpKernel {
     const std::vector<string> ragged_keys_;
     const std::map<string, int> key_to_output_index_;
     const example::FastParseExampleConfig config_;
+    const std::unique_ptr<const example::FastParseExampleConfigIndex>
+        config_index_;
     const int64_t num_parallel_calls_;
     const DataTypeVector sparse_types_;
     const DataTypeVector dense_types_;
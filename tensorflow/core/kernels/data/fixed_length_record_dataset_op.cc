@@ -14,14 +14,16 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/fixed_length_record_dataset_op.h"
 
+#include "tensorflow/core/data/dataset_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
-#include "tensorflow/core/lib/io/inputbuffer.h"
+#include "tensorflow/core/lib/io/inputstream_interface.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
+#include "tensorflow/core/lib/io/readahead_inputstream.h"
 #include "tensorflow/core/lib/io/zlib_compression_options.h"
 #include "tensorflow/core/lib/io/zlib_inputstream.h"
 
@@ -47,6 +49,9 @@ constexpr char kCurrentFileIndex[] = "current_file_index";
 constexpr char kCurrentPos[] = "current_pos";
 constexpr char kZLIB[] = "ZLIB";
 constexpr char kGZIP[] = "GZIP";
+// Number of `buffer_size` reads kept in flight under the "async_file_reads"
+// experiment.
+constexpr int kAsyncReadsInFlight = 4;
 
 class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
  public:
@@ -61,6 +66,7 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
         footer_bytes_(footer_bytes),
         buffer_size_(buffer_size),
         compression_type_(compression_type),
+        use_async_reads_(GetExperiments().contains("async_file_reads")),
         op_version_(op_version) {}
 
   std::unique_ptr<IteratorBase> MakeIteratorInternal(
@@ -137,20 +143,20 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
       mutex_lock l(mu_);
       do {
         // We are currently processing a file, so try to read the next record.
-        if (input_buffer_) {
-          const int64_t current_pos = input_buffer_->Tell();
+        if (input_stream_) {
+          const int64_t current_pos = input_stream_->Tell();
           DCHECK_GE(file_pos_limit_, 0);
           if (current_pos < file_pos_limit_) {
-            string record;
+            tstring record;
             TF_RETURN_IF_ERROR(
-                input_buffer_->ReadNBytes(dataset()->record_bytes_, &record));
+                input_stream_->ReadNBytes(dataset()->record_bytes_, &record));
             static monitoring::CounterCell* bytes_counter =
                 metrics::GetTFDataBytesReadCounter(kDatasetType);
             bytes_counter->IncrementBy(dataset()->record_bytes_);
 
             // Produce the record as output.
             Tensor record_tensor(ctx->allocator({}), DT_STRING, {});
-            record_tensor.scalar<tstring>()() = record;
+            record_tensor.scalar<tstring>()() = std::move(record);
             out_tensors->emplace_back(std::move(record_tensor));
             *end_of_sequence = false;
             return absl::OkStatus();
@@ -158,7 +164,7 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
 
           // We have reached the end of the current file, so maybe move on to
           // next file.
-          input_buffer_.reset();
+          input_stream_.reset();
           file_.reset();
           ++current_file_index_;
         }
@@ -190,9 +196,8 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
         }
         TF_RETURN_IF_ERROR(ctx->env()->NewRandomAccessFile(
             TranslateFileName(next_filename), &file_));
-        input_buffer_ = std::make_unique<io::InputBuffer>(
-            file_.get(), dataset()->buffer_size_);
-        TF_RETURN_IF_ERROR(input_buffer_->SkipNBytes(dataset()->header_bytes_));
+        input_stream_ = MakeInputStream();
+        TF_RETURN_IF_ERROR(input_stream_->SkipNBytes(dataset()->header_bytes_));
       } while (true);
     }
 
@@ -203,10 +208,10 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
       TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kCurrentFileIndex,
                                              current_file_index_));
 
-      // `input_buffer_` is empty if
+      // `input_stream_` is empty if
       // 1. GetNext has not been called even once.
       // 2. All files have been read and iterator has been exhausted.
-      int64_t current_pos = input_buffer_ ? input_buffer_->Tell() : -1;
+      int64_t current_pos = input_stream_ ? input_stream_->Tell() : -1;
       TF_RETURN_IF_ERROR(
           writer->WriteScalar(prefix(), kCurrentPos, current_pos));
       return absl::OkStatus();
@@ -224,9 +229,9 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
           reader->ReadScalar(prefix(), kCurrentPos, &current_pos));
 
       // Seek to current_pos.
-      input_buffer_.reset();
+      input_stream_.reset();
       file_.reset();
-      if (current_pos >= 0) {  // There was an active input_buffer_.
+      if (current_pos >= 0) {  // There was an active input_stream_.
         uint64 file_size;
         const std::string& current_filename =
             dataset()->filenames_[current_file_index_];
@@ -235,20 +240,31 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
         file_pos_limit_ = file_size - dataset()->footer_bytes_;
         TF_RETURN_IF_ERROR(ctx->env()->NewRandomAccessFile(
             TranslateFileName(current_filename), &file_));
-        input_buffer_ = std::make_unique<io::InputBuffer>(
-            file_.get(), dataset()->buffer_size_);
-        TF_RETURN_IF_ERROR(input_buffer_->Seek(current_pos));
+        input_stream_ = MakeInputStream();
+        TF_RETURN_IF_ERROR(input_stream_->SkipNBytes(current_pos));
       }
 
       return absl::OkStatus();
     }
 
    private:
+    // Returns a stream over `file_` that keeps several reads in flight under
+    // the "async_file_reads" experiment, and reads synchronously otherwise.
+    std::unique_ptr<io::InputStreamInterface> MakeInputStream()
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (dataset()->use_async_reads_) {
+        return std::make_unique<io::ReadaheadInputStream>(
+            file_.get(), dataset()->buffer_size_, kAsyncReadsInFlight);
+      }
+      return std::make_unique<io::BufferedInputStream>(file_.get(),
+                                                       dataset()->buffer_size_);
+    }
+
     mutex mu_;
     size_t current_file_index_ TF_GUARDED_BY(mu_) = 0;
     std::unique_ptr<RandomAccessFile> file_
-        TF_GUARDED_BY(mu_);  // must outlive input_buffer_
-    std::unique_ptr<io::InputBuffer> input_buffer_ TF_GUARDED_BY(mu_);
+        TF_GUARDED_BY(mu_);  // must outlive input_stream_
+    std::unique_ptr<io::InputStreamInterface> input_stream_ TF_GUARDED_BY(mu_);
     int64_t file_pos_limit_ TF_GUARDED_BY(mu_) = -1;
   };
 
@@ -457,6 +473,7 @@ class FixedLengthRecordDatasetOp::Dataset : public DatasetBase {
   const int64_t footer_bytes_;
   const int64_t buffer_size_;
   const tstring compression_type_;
+  const bool use_async_reads_;
   const int op_version_;
 };
 
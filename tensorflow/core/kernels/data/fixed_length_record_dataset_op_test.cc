@@ -244,6 +244,21 @@ TEST_F(FixedLengthRecordDatasetOpTest, IteratorPrefix) {
       dataset_params.iterator_prefix(), iterator_prefix_params)));
 }
 
+TEST_F(FixedLengthRecordDatasetOpTest, AsyncFileReads) {
+  setenv("TF_JOB_NAME", "test_job", /*overwrite=*/1);
+  setenv("TF_TASK_ID", "0", /*overwrite=*/1);
+  setenv("TF_DATA_EXPERIMENT_OPT_IN", "async_file_reads", /*overwrite=*/1);
+  auto dataset_params = FixedLengthRecordDatasetParams3();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_EXPECT_OK(CheckIteratorGetNext(
+      CreateTensors<tstring>(TensorShape({}),
+                             {{"111"}, {"222"}, {"333"}, {"aaa"}, {"bbb"}}),
+      /*compare_order=*/true));
+  unsetenv("TF_JOB_NAME");
+  unsetenv("TF_TASK_ID");
+  unsetenv("TF_DATA_EXPERIMENT_OPT_IN");
+}
+
 std::vector<IteratorSaveAndRestoreTestCase<FixedLengthRecordDatasetParams>>
 IteratorSaveAndRestoreTestCases() {
   return {
@@ -213,6 +213,8 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
             ComputeBufferOutputElements(buffer_output_elements, block_length)),
         prefetch_input_elements_(ComputePrefetchInputElements(
             prefetch_input_elements, cycle_length_)),
+        autotune_prefetch_input_elements_(prefetch_input_elements ==
+                                          model::kAutotune),
         num_parallel_calls_(num_parallel_calls),
         deterministic_(deterministic),
         output_types_(output_types),
@@ -379,6 +381,16 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     absl::Status Initialize(IteratorContext* ctx) override {
       mutex_lock l(*mu_);
       interleave_depth_ = ctx->interleave_depth();
+      if (dataset()->autotune_prefetch_input_elements_ &&
+          GetExperiments().contains("adaptive_interleave_prefetch")) {
+        // Start with a single prefetched input element and let
+        // `MaybeIncreasePrefetchInputElements()` grow the target when input
+        // elements are not ready in time.
+        prefetch_input_elements_ =
+            std::min<int64_t>(1, dataset()->prefetch_input_elements_);
+      } else {
+        prefetch_input_elements_ = dataset()->prefetch_input_elements_;
+      }
 
       // Note that if `ctx->thread_pool()` is non-null, then instead of creating
       // a dedicated thread pool of size `num_threads`, computation will be
@@ -820,6 +832,9 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
           std::shared_ptr<Element> future_element =
               std::move(future_elements_.front());
           future_elements_.pop_front();
+          if (!future_element->initialized) {
+            MaybeIncreasePrefetchInputElements();
+          }
           if (future_element->iterator) {
             EnableAutotune(ctx, future_element->iterator.get());
           }
@@ -832,6 +847,7 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
         } else {
           current_elements_[cycle_index_] = MakeElement(ctx);
           if (current_elements_[cycle_index_]) {
+            MaybeIncreasePrefetchInputElements();
             current_elements_[cycle_index_]->cycle_index = cycle_index_;
             elements_to_process_.push_back(cycle_index_);
             element->cycle_index = cycle_index_;
@@ -853,6 +869,22 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
       }
     }
 
+    // Called when the interleave cycle needed an input element that the future
+    // workers had not prepared yet, i.e. opening input elements takes longer
+    // than consuming them. Doubles the number of input elements to prefetch,
+    // up to the limit that the future worker threads were sized for.
+    void MaybeIncreasePrefetchInputElements() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (prefetch_input_elements_ >= dataset()->prefetch_input_elements_) {
+        return;
+      }
+      prefetch_input_elements_ =
+          std::min(dataset()->prefetch_input_elements_,
+                   std::max<int64_t>(1, 2 * prefetch_input_elements_));
+      VLOG(2) << "Increased the number of prefetched input elements to "
+              << prefetch_input_elements_;
+      future_workers_cond_var_.notify_all();
+    }
+
     // Creates a new element.
     std::shared_ptr<Element> MakeElement(IteratorContext* ctx)
         TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
@@ -1037,9 +1069,9 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
               current_workers_cond_var_.notify_one();
             }
           }
-          while (!cancelled_ && (future_elements_.size() >=
-                                     dataset()->prefetch_input_elements_ ||
-                                 wait_for_checkpoint_)) {
+          while (!cancelled_ &&
+                 (future_elements_.size() >= prefetch_input_elements_ ||
+                  wait_for_checkpoint_)) {
             WaitWorkerThread(ctx.get(), &future_workers_cond_var_, &l);
           }
           if (cancelled_) {
@@ -1696,6 +1728,10 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
     // current element is exhausted.
     std::deque<std::shared_ptr<Element>> future_elements_ TF_GUARDED_BY(mu_);
 
+    // The number of input elements the future workers keep in
+    // `future_elements_`. At most `dataset()->prefetch_input_elements_`.
+    int64_t prefetch_input_elements_ TF_GUARDED_BY(mu_) = 0;
+
     // Identifies whether the global end of input has been reached.
     bool end_of_input_ TF_GUARDED_BY(mu_) = false;
 
@@ -1748,6 +1784,10 @@ class ParallelInterleaveDatasetOp::Dataset : public DatasetBase {
   const int64_t block_length_;
   const int64_t buffer_output_elements_;
   const int64_t prefetch_input_elements_;
+  // Whether `prefetch_input_elements` was set to `model::kAutotune`, in which
+  // case `prefetch_input_elements_` is only an upper bound that the
+  // `adaptive_interleave_prefetch` experiment can adapt within.
+  const bool autotune_prefetch_input_elements_;
   const int64_t num_parallel_calls_;
   const DeterminismPolicy deterministic_;
   const DataTypeVector output_types_;
@@ -333,13 +333,15 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
         }
       }
       RecordStop(ctx);
-      result->notification.WaitForNotification();
+      result->notification->WaitForNotification();
       RecordStart(ctx);
       tsl::profiler::TraceMe traceme([&] {
         return tsl::profiler::TraceMeEncode("ParallelMapConsume",
                                             {{"element_id", result->uid}});
       });
-      return ProcessResult(ctx, result, out_tensors, end_of_sequence);
+      absl::Status s = ProcessResult(ctx, result, out_tensors, end_of_sequence);
+      RecycleResult(ctx, std::move(result));
+      return s;
     }
 
    protected:
@@ -461,7 +463,7 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
             reader->ReadScalar(element_prefix, kEndOfInput, &end_of_input));
         result.end_of_input = static_cast<bool>(end_of_input);
         RecordBufferEnqueue(ctx, result.return_values);
-        result.notification.Notify();
+        result.notification->Notify();
       }
       return absl::OkStatus();
     }
@@ -496,15 +498,28 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
    private:
     struct InvocationResult {
       explicit InvocationResult(IteratorContext* ctx)
-          : uid(tensorflow::EnvTime::NowNanos()),
-            checkpoint(MemoryCheckpoint{ctx->id_registry()}) {}
+          : uid(tensorflow::EnvTime::NowNanos()) {
+        notification.emplace();
+        checkpoint.emplace(ctx->id_registry());
+      }
+
+      // Prepares a consumed result for reuse by another invocation.
+      void Reset(IteratorContext* ctx) {
+        notification.emplace();
+        status = absl::OkStatus();
+        return_values.clear();
+        end_of_input = false;
+        uid = tensorflow::EnvTime::NowNanos();
+        checkpoint.emplace(ctx->id_registry());
+      }
 
-      Notification notification;
+      // Neither member can be reassigned, so `Reset()` re-creates them.
+      std::optional<Notification> notification;
       absl::Status status;
       std::vector<Tensor> return_values;
       bool end_of_input = false;
-      const int64_t uid;
-      MemoryCheckpoint checkpoint;
+      int64_t uid;
+      std::optional<MemoryCheckpoint> checkpoint;
     };
 
     void CancelThreads(bool wait) TF_LOCKS_EXCLUDED(mu_) {
@@ -538,7 +553,7 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
         TF_LOCKS_EXCLUDED(*mu_) {
       mutex_lock l(*mu_);
       num_calls_--;
-      result->notification.Notify();
+      result->notification->Notify();
       cond_var_->notify_all();
     }
 
@@ -553,7 +568,7 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
       std::vector<Tensor> input_element;
       result->status = input_impl_->GetNext(ctx.get(), &input_element,
                                             &result->end_of_input);
-      result->checkpoint.Merge(ctx->checkpoint());
+      result->checkpoint->Merge(ctx->checkpoint());
       if (result->end_of_input || !result->status.ok()) {
         CallCompleted(ctx, result);
         return;
@@ -613,7 +628,7 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
                                const std::shared_ptr<InvocationResult>& result,
                                std::vector<Tensor>* out_tensors,
                                bool* end_of_sequence) TF_LOCKS_EXCLUDED(*mu_) {
-      ctx->MergeCheckpoint(&result->checkpoint);
+      ctx->MergeCheckpoint(&*result->checkpoint);
       if (!result->end_of_input && result->status.ok()) {
         *out_tensors = std::move(result->return_values);
         RecordBufferDequeue(ctx, *out_tensors);
@@ -665,8 +680,14 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
             return;
           }
           while (!busy()) {
-            invocation_results_.push_back(
-                std::make_shared<InvocationResult>(ctx.get()));
+            if (recycled_results_.empty()) {
+              invocation_results_.push_back(
+                  std::make_shared<InvocationResult>(ctx.get()));
+            } else {
+              invocation_results_.push_back(
+                  std::move(recycled_results_.back()));
+              recycled_results_.pop_back();
+            }
             new_calls.push_back(invocation_results_.back());
             num_calls_++;
           }
@@ -679,6 +700,19 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
       }
     }
 
+    // Keeps the consumed `result` for reuse by a later invocation, unless a
+    // completed call still holds a reference to it.
+    void RecycleResult(IteratorContext* ctx,
+                       std::shared_ptr<InvocationResult> result)
+        TF_LOCKS_EXCLUDED(*mu_) {
+      if (result == nullptr || result.use_count() != 1) return;
+      result->Reset(ctx);
+      mutex_lock l(*mu_);
+      if (recycled_results_.size() < num_parallel_calls_->value) {
+        recycled_results_.push_back(std::move(result));
+      }
+    }
+
     // Determines whether the caller needs to wait for a result. Upon returning
     // false, `result` will point to the result.
     bool ShouldWait(std::shared_ptr<InvocationResult>* result)
@@ -694,7 +728,7 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
         // caller to process end of iteration.
         for (auto it = invocation_results_.begin();
              it != invocation_results_.end(); ++it) {
-          if ((*it)->notification.HasBeenNotified() &&
+          if ((*it)->notification->HasBeenNotified() &&
               (it == invocation_results_.begin() || !(*it)->end_of_input)) {
             std::swap(*result, *it);
             invocation_results_.erase(it);
@@ -801,6 +835,10 @@ class ParallelMapDatasetOp::Dataset : public DatasetBase {
     // Buffer for storing the invocation results.
     std::deque<std::shared_ptr<InvocationResult>> invocation_results_
         TF_GUARDED_BY(*mu_);
+    // Consumed invocation results, which the runner thread reuses instead of
+    // allocating new ones. At most `num_parallel_calls_` are kept.
+    std::vector<std::shared_ptr<InvocationResult>> recycled_results_
+        TF_GUARDED_BY(*mu_);
     bool cancelled_ TF_GUARDED_BY(*mu_) = false;
     std::unique_ptr<Thread> runner_thread_ TF_GUARDED_BY(*mu_);
     std::unique_ptr<Thread> stats_thread_ TF_GUARDED_BY(*mu_);
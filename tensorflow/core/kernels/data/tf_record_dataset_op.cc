@@ -14,13 +14,26 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/tf_record_dataset_op.h"
 
+#include <algorithm>
 #include <cstdint>
-
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "tensorflow/core/data/dataset_utils.h"
+#include "tensorflow/core/data/global_shuffle_utils.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/data/utils.h"
 #include "tensorflow/core/framework/metrics.h"
 #include "tensorflow/core/framework/partial_tensor_shape.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/hash/crc32c.h"
 #include "tensorflow/core/lib/io/buffered_inputstream.h"
 #include "tensorflow/core/lib/io/inputbuffer.h"
 #include "tensorflow/core/lib/io/random_inputstream.h"
@@ -51,6 +64,15 @@ constexpr int64_t kUnspecifiedBufferSize = -1;
 constexpr int64_t kDefaultBufferSize = 256LL << 10;  // 256KB
 constexpr int64_t kCloudTpuBlockSize = 127LL << 20;  // 127MB.
 constexpr int64_t kS3BlockSize = kCloudTpuBlockSize;
+// Number of `buffer_size` reads kept in flight under the "async_file_reads"
+// experiment.
+constexpr int kAsyncReadsInFlight = 4;
+constexpr char kIndexFileSuffix[] = ".index";
+constexpr char kTempIndexFileSuffix[] = ".index.tmp";
+// "TFRECIDX" in ASCII.
+constexpr uint64 kIndexFileMagic = 0x5846444943455254ULL;
+// Magic number and data file size.
+constexpr size_t kIndexFileHeaderSize = 2 * sizeof(uint64);
 
 bool is_cloud_tpu_gcs_fs() {
 #if (defined(PLATFORM_CLOUD_TPU) && defined(TPU_GCS_FS)) || \
@@ -60,20 +82,192 @@ bool is_cloud_tpu_gcs_fs() {
   return false;
 }
 
+namespace {
+
+// The record index of a TFRecord file is stored in a sidecar file named
+// "<filename>.index", which contains the fixed64 encoded magic number, the size
+// of the data file it was built for, and the offset of each record.
+std::string IndexFilename(const std::string& filename) {
+  return absl::StrCat(filename, kIndexFileSuffix);
+}
+
+// Reads the record offsets of `filename` from its sidecar index. Returns
+// NotFound if there is no index, and FailedPrecondition if the index does not
+// match the data file.
+absl::StatusOr<std::vector<uint64>> ReadRecordIndex(Env* env,
+                                                    const std::string& filename,
+                                                    uint64 file_size) {
+  const std::string index_filename = IndexFilename(filename);
+  std::string contents;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, index_filename, &contents));
+  if (contents.size() < kIndexFileHeaderSize ||
+      (contents.size() - kIndexFileHeaderSize) % sizeof(uint64) != 0 ||
+      core::DecodeFixed64(contents.data()) != kIndexFileMagic) {
+    return absl::FailedPreconditionError(
+        absl::StrCat("Invalid TFRecord index file ", index_filename));
+  }
+  if (core::DecodeFixed64(contents.data() + sizeof(uint64)) != file_size) {
+    return absl::FailedPreconditionError(absl::StrCat(
+        "TFRecord index file ", index_filename, " is stale: ", filename,
+        " has changed since the index was built"));
+  }
+  std::vector<uint64> offsets(
+      (contents.size() - kIndexFileHeaderSize) / sizeof(uint64));
+  for (size_t i = 0; i < offsets.size(); ++i) {
+    offsets[i] = core::DecodeFixed64(contents.data() + kIndexFileHeaderSize +
+                                     i * sizeof(uint64));
+  }
+  return offsets;
+}
+
+// Builds the record offsets of `filename` by scanning its record headers.
+absl::StatusOr<std::vector<uint64>> BuildRecordIndex(
+    Env* env, const std::string& filename,
+    const io::RecordReaderOptions& options) {
+  tsl::profiler::TraceMe traceme(
+      [&] {
+        return tsl::profiler::TraceMeEncode("TFRecordDatasetOp::BuildIndex",
+                                            {{"filename", filename}});
+      },
+      tsl::profiler::kInfo);
+  std::unique_ptr<RandomAccessFile> file;
+  TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file));
+  io::RecordReader reader(file.get(), options);
+  std::vector<uint64> offsets;
+  uint64 offset = 0;
+  while (true) {
+    const uint64 record_offset = offset;
+    int num_skipped = 0;
+    absl::Status s = reader.SkipRecords(&offset, 1, &num_skipped);
+    if (errors::IsOutOfRange(s)) break;
+    TF_RETURN_IF_ERROR(s);
+    offsets.push_back(record_offset);
+  }
+  return offsets;
+}
+
+// Writes the sidecar index of `filename`. The index is written to a temporary
+// file first, so that concurrent readers never observe a partial index.
+absl::Status WriteRecordIndex(Env* env, const std::string& filename,
+                              uint64 file_size,
+                              const std::vector<uint64>& offsets) {
+  std::string contents;
+  contents.reserve(kIndexFileHeaderSize + offsets.size() * sizeof(uint64));
+  core::PutFixed64(&contents, kIndexFileMagic);
+  core::PutFixed64(&contents, file_size);
+  for (uint64 offset : offsets) {
+    core::PutFixed64(&contents, offset);
+  }
+  const std::string temp_filename = absl::StrCat(
+      filename, kTempIndexFileSuffix, ".", env->NowMicros());
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, temp_filename, contents));
+  return env->RenameFile(temp_filename, IndexFilename(filename));
+}
+
+// Reads the records of an uncompressed TFRecord file from a memory-mapped
+// region. Each record is copied straight out of the mapping, which saves the
+// read into an intermediate buffer that `io::SequentialRecordReader` makes.
+//
+// Note: this class is not thread safe; external synchronization required.
+class MappedRecordReader {
+ public:
+  explicit MappedRecordReader(std::unique_ptr<ReadOnlyMemoryRegion> region)
+      : region_(std::move(region)) {}
+
+  // Reads the record at the current offset into `*record`. Returns OutOfRange
+  // at the end of the file.
+  absl::Status ReadRecord(tstring* record) {
+    absl::string_view data;
+    TF_RETURN_IF_ERROR(NextRecord(/*verify_data=*/true, &data));
+    record->assign(data.data(), data.size());
+    return absl::OkStatus();
+  }
+
+  // Skips up to `num_to_skip` records, setting `*num_skipped` to the number
+  // of records skipped. Like `io::RecordReader`, only the checksums of the
+  // record headers are verified.
+  absl::Status SkipRecords(int num_to_skip, int* num_skipped) {
+    *num_skipped = 0;
+    absl::string_view data;
+    while (*num_skipped < num_to_skip) {
+      TF_RETURN_IF_ERROR(NextRecord(/*verify_data=*/false, &data));
+      ++*num_skipped;
+    }
+    return absl::OkStatus();
+  }
+
+  int64_t TellOffset() const { return offset_; }
+
+  absl::Status SeekOffset(int64_t offset) {
+    if (offset < 0 || offset > region_->length()) {
+      return errors::OutOfRange("Seek offset ", offset,
+                                " is out of range of a file of ",
+                                region_->length(), " bytes");
+    }
+    offset_ = offset;
+    return absl::OkStatus();
+  }
+
+ private:
+  absl::Status NextRecord(bool verify_data, absl::string_view* data) {
+    const uint64 remaining = region_->length() - offset_;
+    if (remaining == 0) {
+      return errors::OutOfRange("eof");
+    }
+    const char* header = static_cast<const char*>(region_->data()) + offset_;
+    if (remaining < io::RecordReader::kHeaderSize) {
+      return errors::DataLoss("truncated record at ", offset_);
+    }
+    if (crc32c::Unmask(core::DecodeFixed32(header + sizeof(uint64))) !=
+        crc32c::Value(header, sizeof(uint64))) {
+      return errors::DataLoss("corrupted record at ", offset_);
+    }
+    const uint64 length = core::DecodeFixed64(header);
+    if (remaining - io::RecordReader::kHeaderSize <
+            io::RecordReader::kFooterSize ||
+        length > remaining - io::RecordReader::kHeaderSize -
+                     io::RecordReader::kFooterSize) {
+      return errors::DataLoss("truncated record at ", offset_);
+    }
+    const char* payload = header + io::RecordReader::kHeaderSize;
+    if (verify_data &&
+        crc32c::Unmask(core::DecodeFixed32(payload + length)) !=
+            crc32c::Value(payload, length)) {
+      return errors::DataLoss("corrupted record at ", offset_);
+    }
+    *data = absl::string_view(payload, length);
+    offset_ += io::RecordReader::kHeaderSize + length +
+               io::RecordReader::kFooterSize;
+    return absl::OkStatus();
+  }
+
+  const std::unique_ptr<ReadOnlyMemoryRegion> region_;
+  uint64 offset_ = 0;
+};
+
+}  // namespace
+
 class TFRecordDatasetOp::Dataset : public DatasetBase {
  public:
   explicit Dataset(OpKernelContext* ctx, std::vector<string> filenames,
                    const string& compression_type, int64_t buffer_size,
                    std::vector<int64_t> byte_offsets, int op_version)
       : DatasetBase(DatasetContext(ctx)),
+        env_(ctx->env()),
         filenames_(std::move(filenames)),
         compression_type_(compression_type),
         options_(io::RecordReaderOptions::CreateRecordReaderOptions(
             compression_type)),
         byte_offsets_(std::move(byte_offsets)),
+        use_memory_mapped_reads_(
+            options_.compression_type == io::RecordReaderOptions::NONE &&
+            GetExperiments().contains("memory_mapped_tfrecord_reads")),
         op_version_(op_version) {
     if (buffer_size > 0) {
       options_.buffer_size = buffer_size;
+      if (GetExperiments().contains("async_file_reads")) {
+        options_.max_reads_in_flight = kAsyncReadsInFlight;
+      }
     }
   }
 
@@ -109,6 +303,66 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
 
   absl::Status CheckExternalState() const override { return absl::OkStatus(); }
 
+  // Computing the cardinality requires the record index, which is read from
+  // the sidecar index files, or built and written to them if they are missing.
+  int64_t CardinalityInternal(CardinalityOptions options) const override {
+    if (options.compute_level() <
+        CardinalityOptions::CARDINALITY_COMPUTE_MODERATE) {
+      return kUnknownCardinality;
+    }
+    absl::StatusOr<const RecordIndex*> index = GetRecordIndex();
+    if (!index.ok()) {
+      LOG(ERROR) << "Unable to compute cardinality for dataset "
+                 << DebugString() << " due to error: " << index.status();
+      return kUnknownCardinality;
+    }
+    return (*index)->first_record.back();
+  }
+
+  absl::Status Get(OpKernelContext* ctx, int64 index,
+                   std::vector<Tensor>* out_tensors) const override {
+    return Get(AnyContext(ctx), index, out_tensors);
+  }
+
+  absl::Status Get(AnyContext ctx, int64 index,
+                   std::vector<Tensor>* out_tensors) const override {
+    TF_RETURN_IF_ERROR(CheckRandomAccessCompatible(index));
+    TF_ASSIGN_OR_RETURN(const RecordIndex* record_index, GetRecordIndex());
+    const size_t file_index =
+        std::upper_bound(record_index->first_record.begin(),
+                         record_index->first_record.end(), index) -
+        record_index->first_record.begin() - 1;
+    uint64 offset =
+        record_index->offsets[file_index]
+                             [index - record_index->first_record[file_index]];
+    RandomAccessFile* file;
+    TF_RETURN_IF_ERROR(GetFile(file_index, &file));
+
+    io::RecordReaderOptions options = options_;
+    // Random reads only fetch one record, so buffering would only waste I/O.
+    options.buffer_size = 0;
+    io::RecordReader reader(file, options);
+    out_tensors->clear();
+    out_tensors->emplace_back(ctx.allocator, DT_STRING, TensorShape({}));
+    TF_RETURN_IF_ERROR(
+        reader.ReadRecord(&offset, &out_tensors->back().scalar<tstring>()()));
+    static monitoring::CounterCell* bytes_counter =
+        metrics::GetTFDataBytesReadCounter(kDatasetType);
+    bytes_counter->IncrementBy(out_tensors->back().scalar<tstring>()().size());
+    return absl::OkStatus();
+  }
+
+  absl::Status RandomIndexingCompatible() const override {
+    if (options_.compression_type != io::RecordReaderOptions::NONE) {
+      return absl::FailedPreconditionError(
+          absl::StrCat("Random access is not supported for compressed TFRecord "
+                       "files, but the compression type of ",
+                       DebugString(), " is ",
+                       absl::string_view(compression_type_), "."));
+    }
+    return absl::OkStatus();
+  }
+
  protected:
   absl::Status AsGraphDefInternal(SerializationContext* ctx,
                                   DatasetGraphDefBuilder* b,
@@ -130,22 +384,27 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
   class Iterator : public DatasetIterator<Dataset> {
    public:
     explicit Iterator(const Params& params)
-        : DatasetIterator<Dataset>(params) {}
+        : DatasetIterator<Dataset>(params),
+          global_shuffle_iterator_(dataset()) {}
 
     bool SymbolicCheckpointCompatible() const override { return true; }
 
     absl::Status GetNextInternal(IteratorContext* ctx,
                                  std::vector<Tensor>* out_tensors,
                                  bool* end_of_sequence) override {
+      if (ctx->index_mapper() != nullptr) {
+        return global_shuffle_iterator_.GetNext(ctx, out_tensors,
+                                                end_of_sequence);
+      }
       out_tensors->reserve(1);
       mutex_lock l(mu_);
       do {
         // We are currently processing a file, so try to read the next record.
-        if (reader_) {
+        if (reader_ || mapped_reader_) {
           out_tensors->emplace_back(ctx->allocator({}), DT_STRING,
                                     TensorShape({}));
           absl::Status s =
-              reader_->ReadRecord(&out_tensors->back().scalar<tstring>()());
+              ReadRecordLocked(&out_tensors->back().scalar<tstring>()());
           if (s.ok()) {
             static monitoring::CounterCell* bytes_counter =
                 metrics::GetTFDataBytesReadCounter(kDatasetType);
@@ -188,10 +447,10 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       do {
         // We are currently processing a file, so try to skip reading
         // the next (num_to_skip - *num_skipped) record.
-        if (reader_) {
+        if (reader_ || mapped_reader_) {
           int last_num_skipped;
-          absl::Status s = reader_->SkipRecords(num_to_skip - *num_skipped,
-                                                &last_num_skipped);
+          absl::Status s =
+              SkipRecordsLocked(num_to_skip - *num_skipped, &last_num_skipped);
           *num_skipped += last_num_skipped;
           if (s.ok()) {
             *end_of_sequence = false;
@@ -234,15 +493,19 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
       TF_RETURN_IF_ERROR(writer->WriteScalar(prefix(), kCurrentFileIndex,
                                              current_file_index_));
 
-      if (reader_) {
+      if (reader_ || mapped_reader_) {
         TF_RETURN_IF_ERROR(
-            writer->WriteScalar(prefix(), kOffset, reader_->TellOffset()));
+            writer->WriteScalar(prefix(), kOffset, TellOffsetLocked()));
       }
+      TF_RETURN_IF_ERROR(global_shuffle_iterator_.Save(prefix(), ctx, writer));
       return absl::OkStatus();
     }
 
     absl::Status RestoreInternal(IteratorContext* ctx,
                                  IteratorStateReader* reader) override {
+      if (ctx->restored_element_count().has_value()) {
+        return global_shuffle_iterator_.Restore(prefix(), ctx, reader);
+      }
       mutex_lock l(mu_);
       ResetStreamsLocked();
       int64_t current_file_index;
@@ -253,7 +516,7 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
         int64_t offset;
         TF_RETURN_IF_ERROR(reader->ReadScalar(prefix(), kOffset, &offset));
         TF_RETURN_IF_ERROR(SetupStreamsLocked(ctx->env()));
-        TF_RETURN_IF_ERROR(reader_->SeekOffset(offset));
+        TF_RETURN_IF_ERROR(SeekOffsetLocked(offset));
       }
       return absl::OkStatus();
     }
@@ -276,14 +539,30 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
           },
           tsl::profiler::kInfo);
 
-      TF_RETURN_IF_ERROR(env->NewRandomAccessFile(
-          TranslateFileName(dataset()->filenames_[current_file_index_]),
-          &file_));
-      reader_ = std::make_unique<io::SequentialRecordReader>(
-          file_.get(), dataset()->options_);
+      const std::string filename =
+          TranslateFileName(dataset()->filenames_[current_file_index_]);
+      if (dataset()->use_memory_mapped_reads_) {
+        std::unique_ptr<ReadOnlyMemoryRegion> region;
+        absl::Status s =
+            env->NewReadOnlyMemoryRegionFromFile(filename, &region);
+        if (s.ok()) {
+          mapped_reader_ =
+              std::make_unique<MappedRecordReader>(std::move(region));
+        } else {
+          // File systems without memory mapping support, such as remote file
+          // systems, fall back to buffered reads.
+          VLOG(2) << "Failed to memory-map " << filename
+                  << ", falling back to buffered reads: " << s;
+        }
+      }
+      if (!mapped_reader_) {
+        TF_RETURN_IF_ERROR(env->NewRandomAccessFile(filename, &file_));
+        reader_ = std::make_unique<io::SequentialRecordReader>(
+            file_.get(), dataset()->options_);
+      }
       if (!dataset()->byte_offsets_.empty()) {
         TF_RETURN_IF_ERROR(
-            reader_->SeekOffset(dataset()->byte_offsets_[current_file_index_]));
+            SeekOffsetLocked(dataset()->byte_offsets_[current_file_index_]));
       }
       return absl::OkStatus();
     }
@@ -292,6 +571,40 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     void ResetStreamsLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
       reader_.reset();
       file_.reset();
+      mapped_reader_.reset();
+    }
+
+    // The following methods forward to whichever of `mapped_reader_` and
+    // `reader_` reads the current file.
+    absl::Status ReadRecordLocked(tstring* record)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (mapped_reader_) {
+        return mapped_reader_->ReadRecord(record);
+      }
+      return reader_->ReadRecord(record);
+    }
+
+    absl::Status SkipRecordsLocked(int num_to_skip, int* num_skipped)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (mapped_reader_) {
+        return mapped_reader_->SkipRecords(num_to_skip, num_skipped);
+      }
+      return reader_->SkipRecords(num_to_skip, num_skipped);
+    }
+
+    int64_t TellOffsetLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (mapped_reader_) {
+        return mapped_reader_->TellOffset();
+      }
+      return reader_->TellOffset();
+    }
+
+    absl::Status SeekOffsetLocked(int64_t offset)
+        TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+      if (mapped_reader_) {
+        return mapped_reader_->SeekOffset(offset);
+      }
+      return reader_->SeekOffset(offset);
     }
 
     mutex mu_;
@@ -301,13 +614,96 @@ class TFRecordDatasetOp::Dataset : public DatasetBase {
     // we must destroy `reader_` before `file_`.
     std::unique_ptr<RandomAccessFile> file_ TF_GUARDED_BY(mu_);
     std::unique_ptr<io::SequentialRecordReader> reader_ TF_GUARDED_BY(mu_);
+    // Set instead of `file_` and `reader_` when the current file is read
+    // through a memory mapping.
+    std::unique_ptr<MappedRecordReader> mapped_reader_ TF_GUARDED_BY(mu_);
+
+    GlobalShuffleIterator global_shuffle_iterator_;
   };
 
+  // The offsets of the records of all files, used for random access.
+  struct RecordIndex {
+    // The offsets of the records of each file.
+    std::vector<std::vector<uint64>> offsets;
+    // The index of the first record of each file, followed by the total number
+    // of records.
+    std::vector<int64_t> first_record;
+  };
+
+  // Returns the record index, loading it on first use. The index is immutable
+  // once loaded.
+  absl::StatusOr<const RecordIndex*> GetRecordIndex() const {
+    mutex_lock l(index_mu_);
+    if (record_index_ != nullptr) return record_index_.get();
+
+    auto record_index = std::make_unique<RecordIndex>();
+    record_index->offsets.reserve(filenames_.size());
+    record_index->first_record.reserve(filenames_.size() + 1);
+    record_index->first_record.push_back(0);
+    for (size_t i = 0; i < filenames_.size(); ++i) {
+      const std::string filename = TranslateFileName(filenames_[i]);
+      uint64 file_size;
+      TF_RETURN_IF_ERROR(env_->GetFileSize(filename, &file_size));
+      absl::StatusOr<std::vector<uint64>> offsets =
+          ReadRecordIndex(env_, filename, file_size);
+      if (!offsets.ok()) {
+        VLOG(1) << "Building the record index of " << filename << ": "
+                << offsets.status();
+        offsets = BuildRecordIndex(env_, filename, options_);
+        TF_RETURN_IF_ERROR(offsets.status());
+        // The index is an optimization for later runs, so failing to write it
+        // (e.g. to a read-only file system) is not an error.
+        absl::Status s = WriteRecordIndex(env_, filename, file_size, *offsets);
+        if (!s.ok()) {
+          LOG_FIRST_N(WARNING, 1) << "Failed to write TFRecord index file "
+                                  << IndexFilename(filename) << ": " << s;
+        }
+      }
+      if (!byte_offsets_.empty()) {
+        // Drops the records before the requested byte offset.
+        auto it = std::lower_bound(offsets->begin(), offsets->end(),
+                                   byte_offsets_[i]);
+        if (it != offsets->end() && *it != byte_offsets_[i]) {
+          return absl::DataLossError(
+              absl::StrCat("Byte offset ", byte_offsets_[i], " of ", filename,
+                           " is not at the start of a record."));
+        }
+        offsets->erase(offsets->begin(), it);
+      }
+      record_index->first_record.push_back(record_index->first_record.back() +
+                                           offsets->size());
+      record_index->offsets.push_back(*std::move(offsets));
+    }
+    record_index_ = std::move(record_index);
+    files_.resize(filenames_.size());
+    return record_index_.get();
+  }
+
+  // Returns the file at `file_index`, opening it on first use.
+  absl::Status GetFile(size_t file_index, RandomAccessFile** file) const {
+    mutex_lock l(index_mu_);
+    if (files_[file_index] == nullptr) {
+      TF_RETURN_IF_ERROR(env_->NewRandomAccessFile(
+          TranslateFileName(filenames_[file_index]), &files_[file_index]));
+    }
+    *file = files_[file_index].get();
+    return absl::OkStatus();
+  }
+
+  Env* const env_;
   const std::vector<string> filenames_;
   const tstring compression_type_;
   io::RecordReaderOptions options_;
   const std::vector<int64_t> byte_offsets_;
+  // Whether sequential reads of local files go through a memory mapping.
+  const bool use_memory_mapped_reads_;
   const int op_version_;
+
+  mutable mutex index_mu_;
+  mutable std::unique_ptr<RecordIndex> record_index_ TF_GUARDED_BY(index_mu_);
+  // Files opened for random access. `RandomAccessFile::Read` is thread safe.
+  mutable std::vector<std::unique_ptr<RandomAccessFile>> files_
+      TF_GUARDED_BY(index_mu_);
 };
 
 TFRecordDatasetOp::TFRecordDatasetOp(OpKernelConstruction* ctx)
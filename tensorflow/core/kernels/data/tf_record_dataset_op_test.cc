@@ -24,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/data/dataset_test_base.h"
 #include "tensorflow/core/data/name_utils.h"
 #include "tensorflow/core/framework/dataset.h"
+#include "tensorflow/core/framework/dataset_options.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/framework/types.pb.h"
@@ -352,6 +353,93 @@ TEST_F(TFRecordDatasetOpTest, InvalidByteOffsetsToSeek) {
       absl::StatusCode::kDataLoss);
 }
 
+int64_t ModerateCardinality(const DatasetBase* dataset) {
+  CardinalityOptions options;
+  options.set_compute_level(CardinalityOptions::CARDINALITY_COMPUTE_MODERATE);
+  return dataset->Cardinality(std::move(options));
+}
+
+TEST_F(TFRecordDatasetOpTest, RandomAccess) {
+  auto dataset_params = TFRecordDatasetParams3();
+  for (const char* filename :
+       {"/tf_record_UNCOMPRESSED_1", "/tf_record_UNCOMPRESSED_2"}) {
+    Env::Default()
+        ->DeleteFile(absl::StrCat(testing::TmpDir(), filename, ".index"))
+        .IgnoreError();
+  }
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_ASSERT_OK(dataset_->RandomIndexingCompatible());
+  EXPECT_EQ(ModerateCardinality(dataset_), 6);
+  // The record index is written next to the data files.
+  TF_EXPECT_OK(Env::Default()->FileExists(
+      absl::StrCat(testing::TmpDir(), "/tf_record_UNCOMPRESSED_2.index")));
+
+  const std::vector<tstring> expected = {"ccc", "1", "bb", "333", "a", "22"};
+  const std::vector<int64_t> indices = {5, 0, 4, 2, 3, 1};
+  for (int i = 0; i < indices.size(); ++i) {
+    std::vector<Tensor> out_tensors;
+    TF_ASSERT_OK(dataset_->Get(AnyContext(iterator_ctx_.get()), indices[i],
+                               &out_tensors));
+    ASSERT_EQ(out_tensors.size(), 1);
+    EXPECT_EQ(out_tensors[0].scalar<tstring>()(), expected[i]);
+  }
+  std::vector<Tensor> out_tensors;
+  EXPECT_EQ(
+      dataset_->Get(AnyContext(iterator_ctx_.get()), 6, &out_tensors).code(),
+      absl::StatusCode::kOutOfRange);
+}
+
+TEST_F(TFRecordDatasetOpTest, RandomAccessWithByteOffsets) {
+  auto dataset_params = TFRecordDatasetParams4();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  ASSERT_EQ(ModerateCardinality(dataset_), 6);
+  const std::vector<tstring> expected = {"1", "22", "333", "bb", "ccc", "zzz"};
+  for (int i = 0; i < expected.size(); ++i) {
+    std::vector<Tensor> out_tensors;
+    TF_ASSERT_OK(
+        dataset_->Get(AnyContext(iterator_ctx_.get()), i, &out_tensors));
+    EXPECT_EQ(out_tensors[0].scalar<tstring>()(), expected[i]);
+  }
+}
+
+TEST_F(TFRecordDatasetOpTest, RandomAccessCompressed) {
+  auto dataset_params = TFRecordDatasetParams1();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  EXPECT_EQ(dataset_->RandomIndexingCompatible().code(),
+            absl::StatusCode::kFailedPrecondition);
+}
+
+TEST_F(TFRecordDatasetOpTest, MemoryMappedReads) {
+  setenv("TF_JOB_NAME", "test_job", /*overwrite=*/1);
+  setenv("TF_TASK_ID", "0", /*overwrite=*/1);
+  setenv("TF_DATA_EXPERIMENT_OPT_IN", "memory_mapped_tfrecord_reads",
+         /*overwrite=*/1);
+  auto dataset_params = TFRecordDatasetParams4();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_EXPECT_OK(CheckIteratorGetNext(
+      CreateTensors<tstring>(
+          TensorShape({}), {{"1"}, {"22"}, {"333"}, {"bb"}, {"ccc"}, {"zzz"}}),
+      /*compare_order=*/true));
+  unsetenv("TF_JOB_NAME");
+  unsetenv("TF_TASK_ID");
+  unsetenv("TF_DATA_EXPERIMENT_OPT_IN");
+}
+
+TEST_F(TFRecordDatasetOpTest, AsyncFileReads) {
+  setenv("TF_JOB_NAME", "test_job", /*overwrite=*/1);
+  setenv("TF_TASK_ID", "0", /*overwrite=*/1);
+  setenv("TF_DATA_EXPERIMENT_OPT_IN", "async_file_reads", /*overwrite=*/1);
+  auto dataset_params = TFRecordDatasetParams4();
+  TF_ASSERT_OK(Initialize(dataset_params));
+  TF_EXPECT_OK(CheckIteratorGetNext(
+      CreateTensors<tstring>(
+          TensorShape({}), {{"1"}, {"22"}, {"333"}, {"bb"}, {"ccc"}, {"zzz"}}),
+      /*compare_order=*/true));
+  unsetenv("TF_JOB_NAME");
+  unsetenv("TF_TASK_ID");
+  unsetenv("TF_DATA_EXPERIMENT_OPT_IN");
+}
+
 std::vector<IteratorSaveAndRestoreTestCase<TFRecordDatasetParams>>
 IteratorSaveAndRestoreTestCases() {
   return {
@@ -295,6 +295,68 @@ ExtractGlimpses(
   return input.customOp(op);
 }
 
+/** ScaledDotProductAttention
+ * \ingroup CXX11_NeuralNetworks_Module
+ *
+ * \brief Computes softmax(scale * query * key^T) * value for a single head.
+ *
+ * The query, key and value parameters are expected to be row-major matrices of
+ * shape [query_len, depth], [key_len, depth] and [key_len, value_depth], and
+ * the [query_len, value_depth] result is written to output. The keys are
+ * visited in blocks of block_size rows, keeping a running maximum and sum of
+ * the exponentiated scores for each query row (the "online" softmax), so the
+ * scratch memory is O(query_len * block_size) rather than
+ * O(query_len * key_len).
+ */
+template <typename Scalar, typename Index>
+void ScaledDotProductAttention(const Scalar* query, const Scalar* key,
+                               const Scalar* value, const Index query_len,
+                               const Index key_len, const Index depth,
+                               const Index value_depth, const Scalar scale,
+                               const Index block_size, Scalar* output) {
+  typedef TensorMap<const Tensor<Scalar, 2, RowMajor, Index> > ConstMatrix;
+  typedef Tensor<Scalar, 1, RowMajor, Index> Vector;
+
+  const array<IndexPair<Index>, 1> contract_depth = {IndexPair<Index>(1, 1)};
+  const array<IndexPair<Index>, 1> contract_keys = {IndexPair<Index>(1, 0)};
+  const array<Index, 1> reduce_keys = {1};
+
+  ConstMatrix q(query, query_len, depth);
+  TensorMap<Tensor<Scalar, 2, RowMajor, Index> > out(output, query_len,
+                                                      value_depth);
+  Vector row_max(query_len);
+  Vector row_sum(query_len);
+  Vector block_max(query_len);
+  Vector correction(query_len);
+  Tensor<Scalar, 2, RowMajor, Index> scores;
+  row_max.setConstant(NumTraits<Scalar>::lowest());
+  row_sum.setZero();
+  out.setZero();
+  if (key_len == 0) return;
+
+  for (Index start = 0; start < key_len; start += block_size) {
+    const Index size = numext::mini(block_size, key_len - start);
+    ConstMatrix k(key + start * depth, size, depth);
+    ConstMatrix v(value + start * value_depth, size, value_depth);
+    const array<Index, 2> column = {query_len, 1};
+    const array<Index, 2> across_keys = {1, size};
+    const array<Index, 2> across_values = {1, value_depth};
+
+    scores.resize(query_len, size);
+    scores = q.contract(k, contract_depth) * scale;
+    block_max = row_max.cwiseMax(scores.maximum(reduce_keys));
+    correction = (row_max - block_max).exp();
+    scores =
+        (scores - block_max.reshape(column).broadcast(across_keys)).exp();
+    row_sum = row_sum * correction + scores.sum(reduce_keys);
+    out = out * correction.reshape(column).broadcast(across_values) +
+          scores.contract(v, contract_keys);
+    row_max = block_max;
+  }
+  out = out / row_sum.reshape(array<Index, 2>{query_len, 1})
+                  .broadcast(array<Index, 2>{1, value_depth});
+}
+
 }  // end namespace Eigen
 
 #endif  // TENSORFLOW_CORE_KERNELS_EIGEN_ATTENTION_H_
@@ -14,6 +14,11 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/kernels/eigen_attention.h"
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
 #include "tensorflow/core/platform/test.h"
 
 namespace Eigen {
@@ -103,4 +108,53 @@ TEST(EigenAttentionTest, OutOfBoundsGlimpse) {
   }
 }
 
+TEST(EigenAttentionTest, ScaledDotProductAttention) {
+  const ptrdiff_t query_len = 7;
+  const ptrdiff_t key_len = 37;
+  const ptrdiff_t depth = 5;
+  const ptrdiff_t value_depth = 3;
+  const float scale = 0.5f;
+
+  Tensor<float, 2, RowMajor> query(query_len, depth);
+  Tensor<float, 2, RowMajor> key(key_len, depth);
+  Tensor<float, 2, RowMajor> value(key_len, value_depth);
+  query.setRandom();
+  key.setRandom();
+  value.setRandom();
+  // Large scores check that the running maximum keeps exp() from overflowing.
+  query = query * 100.0f;
+
+  // Block sizes that divide the keys evenly, leave a remainder, and cover all
+  // the keys at once.
+  for (const ptrdiff_t block_size : {1, 8, 37, 64}) {
+    Tensor<float, 2, RowMajor> result(query_len, value_depth);
+    ScaledDotProductAttention(query.data(), key.data(), value.data(),
+                              query_len, key_len, depth, value_depth, scale,
+                              block_size, result.data());
+
+    for (int i = 0; i < query_len; ++i) {
+      std::vector<double> scores(key_len);
+      double max_score = -std::numeric_limits<double>::infinity();
+      for (int j = 0; j < key_len; ++j) {
+        double score = 0;
+        for (int d = 0; d < depth; ++d) score += query(i, d) * key(j, d);
+        scores[j] = score * scale;
+        max_score = std::max(max_score, scores[j]);
+      }
+      double sum = 0;
+      for (int j = 0; j < key_len; ++j) {
+        scores[j] = std::exp(scores[j] - max_score);
+        sum += scores[j];
+      }
+      for (int d = 0; d < value_depth; ++d) {
+        double expected = 0;
+        for (int j = 0; j < key_len; ++j) {
+          expected += scores[j] / sum * value(j, d);
+        }
+        ASSERT_NEAR(result(i, d), expected, 1e-4);
+      }
+    }
+  }
+}
+
 }  // namespace Eigen
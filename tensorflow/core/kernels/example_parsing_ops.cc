@@ -15,6 +15,7 @@ limitations under the License.
 
 // See docs in ../ops/parsing_ops.cc.
 
+#include <memory>
 #include <numeric>
 #include <unordered_set>
 #include <vector>
@@ -30,6 +31,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 #include "tensorflow/core/util/example_proto_helper.h"
@@ -89,13 +91,16 @@ class ParseExampleOp : public OpKernel {
 
     example::FastParseExampleConfig config =
         MakeConfig(dense_keys_t, sparse_keys_t, ragged_keys_t, dense_defaults);
+    std::shared_ptr<const example::FastParseExampleConfigIndex> config_index;
+    OP_REQUIRES_OK(ctx, GetConfigIndex(config, &config_index));
 
     example::Result result;
     if (TensorShapeUtils::IsVector(serialized->shape())) {
-      OP_REQUIRES_OK(
-          ctx, ParseExampleVector(config, serialized, names, ctx, &result));
+      OP_REQUIRES_OK(ctx, ParseExampleVector(config, *config_index, serialized,
+                                             names, ctx, &result));
     } else {
-      OP_REQUIRES_OK(ctx, ParseExampleScalar(config, serialized, ctx, &result));
+      OP_REQUIRES_OK(ctx, ParseExampleScalar(config, *config_index, serialized,
+                                             ctx, &result));
     }
     OP_REQUIRES_OK(ctx, WriteOutput(result, ctx));
   }
@@ -235,26 +240,50 @@ class ParseExampleOp : public OpKernel {
     return config;
   }
 
+  // Returns the index of the feature names in `config`. The keys are usually
+  // constants, so the index of the previous call is reused while they match.
+  absl::Status GetConfigIndex(
+      const example::FastParseExampleConfig& config,
+      std::shared_ptr<const example::FastParseExampleConfigIndex>* index) {
+    {
+      tf_shared_lock l(mu_);
+      if (config_index_ != nullptr && config_index_->Matches(config)) {
+        *index = config_index_;
+        return absl::OkStatus();
+      }
+    }
+    std::unique_ptr<const example::FastParseExampleConfigIndex> new_index;
+    TF_RETURN_IF_ERROR(
+        example::FastParseExampleConfigIndex::Create(config, &new_index));
+    *index = std::move(new_index);
+    mutex_lock l(mu_);
+    config_index_ = *index;
+    return absl::OkStatus();
+  }
+
   // Parses a single example.
-  absl::Status ParseExampleScalar(const example::FastParseExampleConfig& config,
-                                  const Tensor* serialized,
-                                  OpKernelContext* ctx,
-                                  example::Result* result) const {
+  absl::Status ParseExampleScalar(
+      const example::FastParseExampleConfig& config,
+      const example::FastParseExampleConfigIndex& config_index,
+      const Tensor* serialized, OpKernelContext* ctx,
+      example::Result* result) const {
     const tstring& serialized_proto = serialized->scalar<tstring>()();
-    return FastParseSingleExample(config, serialized_proto, result);
+    return FastParseSingleExample(config, config_index, serialized_proto,
+                                  result);
   }
 
   // Parses a vector of examples.
-  absl::Status ParseExampleVector(const example::FastParseExampleConfig& config,
-                                  const Tensor* serialized, const Tensor* names,
-                                  OpKernelContext* ctx,
-                                  example::Result* result) const {
+  absl::Status ParseExampleVector(
+      const example::FastParseExampleConfig& config,
+      const example::FastParseExampleConfigIndex& config_index,
+      const Tensor* serialized, const Tensor* names, OpKernelContext* ctx,
+      example::Result* result) const {
     auto serialized_t = serialized->flat<tstring>();
     auto names_t = names->flat<tstring>();
     absl::Span<const tstring> slice(serialized_t.data(), serialized_t.size());
     absl::Span<const tstring> names_slice(names_t.data(), names_t.size());
     return FastParseExample(
-        config, slice, names_slice,
+        config, config_index, slice, names_slice,
         ctx->device()->tensorflow_cpu_worker_threads()->workers, result);
   }
 
@@ -292,6 +321,9 @@ class ParseExampleOp : public OpKernel {
   ParseExampleAttrs attrs_;
   int op_version_;
   absl::once_flag flag_;
+  mutex mu_;
+  std::shared_ptr<const example::FastParseExampleConfigIndex> config_index_
+      TF_GUARDED_BY(mu_);
 };
 
 REGISTER_KERNEL_BUILDER(Name("ParseExample").Device(DEVICE_CPU),
@@ -305,6 +337,10 @@ class ParseSingleExampleOp : public OpKernel {
     OP_REQUIRES_OK(ctx, attrs_.Init(ctx));
     metrics::RecordParseDenseFeature(attrs_.dense_keys.size());
     metrics::RecordParseSparseFeature(attrs_.sparse_keys.size());
+    // The keys are attrs, so the index of the feature names is built once.
+    OP_REQUIRES_OK(ctx, example::FastParseExampleConfigIndex::Create(
+                            MakeConfig(/*dense_defaults=*/nullptr),
+                            &config_index_));
   }
 
   void Compute(OpKernelContext* ctx) override {
@@ -356,21 +392,12 @@ class ParseSingleExampleOp : public OpKernel {
     example::Result result;
 
     // TODO(mrry): Build the configuration once and cache it.
-    example::FastParseExampleConfig config;
-    for (int d = 0; d < attrs_.dense_keys.size(); ++d) {
-      config.dense.push_back({attrs_.dense_keys[d], attrs_.dense_types[d],
-                              attrs_.dense_shapes[d], dense_defaults[d],
-                              attrs_.variable_length[d],
-                              attrs_.elements_per_stride[d]});
-    }
-    for (int d = 0; d < attrs_.sparse_keys.size(); ++d) {
-      config.sparse.push_back({attrs_.sparse_keys[d], attrs_.sparse_types[d]});
-    }
+    example::FastParseExampleConfig config = MakeConfig(&dense_defaults);
 
     const tstring& serialized_proto = serialized->scalar<tstring>()();
 
-    OP_REQUIRES_OK(ctx,
-                   FastParseSingleExample(config, serialized_proto, &result));
+    OP_REQUIRES_OK(ctx, FastParseSingleExample(config, *config_index_,
+                                               serialized_proto, &result));
 
     OpOutputList dense_values;
     OpOutputList sparse_indices;
@@ -391,7 +418,25 @@ class ParseSingleExampleOp : public OpKernel {
   }
 
  protected:
+  // Populates the FastParseExampleConfig from the attrs and, if given, the
+  // dense defaults.
+  example::FastParseExampleConfig MakeConfig(
+      const OpInputList* dense_defaults) const {
+    example::FastParseExampleConfig config;
+    for (int d = 0; d < attrs_.dense_keys.size(); ++d) {
+      config.dense.push_back(
+          {attrs_.dense_keys[d], attrs_.dense_types[d], attrs_.dense_shapes[d],
+           dense_defaults != nullptr ? (*dense_defaults)[d] : Tensor(),
+           attrs_.variable_length[d], attrs_.elements_per_stride[d]});
+    }
+    for (int d = 0; d < attrs_.sparse_keys.size(); ++d) {
+      config.sparse.push_back({attrs_.sparse_keys[d], attrs_.sparse_types[d]});
+    }
+    return config;
+  }
+
   ParseSingleExampleAttrs attrs_;
+  std::unique_ptr<const example::FastParseExampleConfigIndex> config_index_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("ParseSingleExample").Device(DEVICE_CPU),
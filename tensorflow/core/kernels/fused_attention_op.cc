@@ -0,0 +1,148 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/nn_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cstdint>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/op_requires.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/eigen_attention.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+// Number of query rows computed together by one unit of work. Every query
+// block is independent, so blocks of all batch entries are sharded together.
+constexpr int64_t kQueryBlockSize = 64;
+// Number of keys visited at a time by the online softmax. Together with
+// kQueryBlockSize this bounds the scores kept live by each unit of work.
+constexpr int64_t kKeyBlockSize = 256;
+
+// Computes Softmax(scale * query * key^T) * value, keeping only a
+// [kQueryBlockSize, kKeyBlockSize] block of the attention scores at a time
+// instead of the whole [query_len, key_len] matrix.
+template <typename T>
+class FusedScaledDotProductAttentionOp : public OpKernel {
+ public:
+  explicit FusedScaledDotProductAttentionOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    float scale;
+    OP_REQUIRES_OK(context, context->GetAttr("scale", &scale));
+    scale_ = static_cast<T>(scale);
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& query = context->input(0);
+    const Tensor& key = context->input(1);
+    const Tensor& value = context->input(2);
+
+    const int dims = query.dims();
+    OP_REQUIRES(context, dims >= 3,
+                errors::InvalidArgument("query must be at least rank 3, got ",
+                                        query.shape().DebugString()));
+    OP_REQUIRES(context, key.dims() == dims && value.dims() == dims,
+                errors::InvalidArgument(
+                    "query, key and value must have the same rank, got ",
+                    query.shape().DebugString(), ", ",
+                    key.shape().DebugString(), " and ",
+                    value.shape().DebugString()));
+    TensorShape output_shape;
+    for (int d = 0; d < dims - 2; ++d) {
+      OP_REQUIRES(context,
+                  key.dim_size(d) == query.dim_size(d) &&
+                      value.dim_size(d) == query.dim_size(d),
+                  errors::InvalidArgument(
+                      "query, key and value must have the same batch "
+                      "dimensions, got ",
+                      query.shape().DebugString(), ", ",
+                      key.shape().DebugString(), " and ",
+                      value.shape().DebugString()));
+      OP_REQUIRES_OK(context, output_shape.AddDimWithStatus(query.dim_size(d)));
+    }
+    const int64_t query_len = query.dim_size(dims - 2);
+    const int64_t depth = query.dim_size(dims - 1);
+    const int64_t key_len = key.dim_size(dims - 2);
+    const int64_t value_depth = value.dim_size(dims - 1);
+    OP_REQUIRES(context, key.dim_size(dims - 1) == depth,
+                errors::InvalidArgument(
+                    "query and key must have the same depth, got ",
+                    query.shape().DebugString(), " and ",
+                    key.shape().DebugString()));
+    OP_REQUIRES(context, value.dim_size(dims - 2) == key_len,
+                errors::InvalidArgument(
+                    "key and value must have the same length, got ",
+                    key.shape().DebugString(), " and ",
+                    value.shape().DebugString()));
+    OP_REQUIRES_OK(context, output_shape.AddDimWithStatus(query_len));
+    OP_REQUIRES_OK(context, output_shape.AddDimWithStatus(value_depth));
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    if (output->NumElements() == 0) return;
+
+    const T* query_data = query.flat<T>().data();
+    const T* key_data = key.flat<T>().data();
+    const T* value_data = value.flat<T>().data();
+    T* output_data = output->flat<T>().data();
+    const int64_t num_blocks =
+        (query_len + kQueryBlockSize - 1) / kQueryBlockSize;
+    const T scale = scale_;
+
+    auto work = [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        const int64_t batch = i / num_blocks;
+        const int64_t start = (i % num_blocks) * kQueryBlockSize;
+        const int64_t rows = std::min(kQueryBlockSize, query_len - start);
+        Eigen::ScaledDotProductAttention(
+            query_data + (batch * query_len + start) * depth,
+            key_data + batch * key_len * depth,
+            value_data + batch * key_len * value_depth, rows, key_len, depth,
+            value_depth, scale, kKeyBlockSize,
+            output_data + (batch * query_len + start) * value_depth);
+      }
+    };
+    const int64_t batch_size =
+        output_shape.num_elements() / (query_len * value_depth);
+    const int64_t cost_per_block =
+        kQueryBlockSize * key_len * (depth + value_depth + 10);
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          batch_size * num_blocks, cost_per_block, work);
+  }
+
+ private:
+  T scale_;
+};
+
+#define REGISTER_CPU_KERNEL(type)                                   \
+  REGISTER_KERNEL_BUILDER(Name("_FusedScaledDotProductAttention")   \
+                              .Device(DEVICE_CPU)                   \
+                              .TypeConstraint<type>("T"),           \
+                          FusedScaledDotProductAttentionOp<type>);
+
+REGISTER_CPU_KERNEL(float);
+REGISTER_CPU_KERNEL(double);
+
+#undef REGISTER_CPU_KERNEL
+
+}  // namespace tensorflow
@@ -0,0 +1,263 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "absl/strings/str_join.h"
+#include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/op_requires.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/kernels/cwise_ops.h"
+#include "tensorflow/core/platform/errors.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+template <typename T>
+struct FusedElementwiseFn {
+  using InputBuffer = typename TTypes<T>::ConstFlat;
+  using OutputBuffer = typename TTypes<T>::Flat;
+
+  using UnaryFn = void (*)(const InputBuffer&, OutputBuffer*);
+  using BinaryFn = void (*)(const InputBuffer&, const InputBuffer&,
+                            OutputBuffer*);
+  using BinaryScalarFn = void (*)(const InputBuffer&, T, OutputBuffer*);
+
+  // Exactly one of `unary` and `binary` is set. Binary ops also have
+  // `binary_scalar`, used when their second operand has a single element.
+  UnaryFn unary = nullptr;
+  BinaryFn binary = nullptr;
+  BinaryScalarFn binary_scalar = nullptr;
+  int cost = 0;
+};
+
+template <typename T, typename Functor>
+FusedElementwiseFn<T> UnaryFn() {
+  using Fn = FusedElementwiseFn<T>;
+  Fn fn;
+  fn.unary = [](const typename Fn::InputBuffer& in,
+                typename Fn::OutputBuffer* out) {
+    *out = in.unaryExpr(typename Functor::func());
+  };
+  fn.cost = Eigen::internal::functor_traits<typename Functor::func>::Cost;
+  return fn;
+}
+
+template <typename T, typename Functor>
+FusedElementwiseFn<T> BinaryFn() {
+  using Fn = FusedElementwiseFn<T>;
+  Fn fn;
+  fn.binary = [](const typename Fn::InputBuffer& lhs,
+                 const typename Fn::InputBuffer& rhs,
+                 typename Fn::OutputBuffer* out) {
+    *out = lhs.binaryExpr(rhs, typename Functor::func());
+  };
+  fn.binary_scalar = [](const typename Fn::InputBuffer& lhs, T rhs,
+                        typename Fn::OutputBuffer* out) {
+    *out = lhs.binaryExpr(lhs.constant(rhs), typename Functor::func());
+  };
+  fn.cost = Eigen::internal::functor_traits<typename Functor::func>::Cost;
+  return fn;
+}
+
+template <typename T>
+FusedElementwiseFn<T> ReluFn() {
+  using Fn = FusedElementwiseFn<T>;
+  Fn fn;
+  fn.unary = [](const typename Fn::InputBuffer& in,
+                typename Fn::OutputBuffer* out) {
+    *out = in.cwiseMax(static_cast<T>(0));
+  };
+  fn.cost = Eigen::internal::functor_traits<
+      Eigen::internal::scalar_max_op<T>>::Cost;
+  return fn;
+}
+
+// Returns the compute functions of the ops that may appear in a
+// _FusedElementwise program, keyed by op name. Keep in sync with the ops
+// fused by the remapper.
+template <typename T>
+const std::unordered_map<string, FusedElementwiseFn<T>>& FusedElementwiseFns() {
+  static const auto* fns =
+      new std::unordered_map<string, FusedElementwiseFn<T>>({
+          // clang-format off
+          {"Abs",               UnaryFn<T, functor::abs<T>>()},
+          {"Exp",               UnaryFn<T, functor::exp<T>>()},
+          {"Log",               UnaryFn<T, functor::log<T>>()},
+          {"Neg",               UnaryFn<T, functor::neg<T>>()},
+          {"Relu",              ReluFn<T>()},
+          {"Rsqrt",             UnaryFn<T, functor::rsqrt<T>>()},
+          {"Sigmoid",           UnaryFn<T, functor::sigmoid<T>>()},
+          {"Sqrt",              UnaryFn<T, functor::sqrt<T>>()},
+          {"Square",            UnaryFn<T, functor::square<T>>()},
+          {"Tanh",              UnaryFn<T, functor::tanh<T>>()},
+          {"Add",               BinaryFn<T, functor::add<T>>()},
+          {"AddV2",             BinaryFn<T, functor::add<T>>()},
+          {"Div",               BinaryFn<T, functor::div<T>>()},
+          {"Maximum",           BinaryFn<T, functor::maximum<T>>()},
+          {"Minimum",           BinaryFn<T, functor::minimum<T>>()},
+          {"Mul",               BinaryFn<T, functor::mul<T>>()},
+          {"RealDiv",           BinaryFn<T, functor::div<T>>()},
+          {"SquaredDifference", BinaryFn<T, functor::squared_difference<T>>()},
+          {"Sub",               BinaryFn<T, functor::sub<T>>()},
+          // clang-format on
+      });
+  return *fns;
+}
+
+// Evaluates the whole op chain on one cache-sized block of the inputs before
+// moving on to the next, so the intermediate values never leave the cache.
+// The running value is kept in the output block.
+template <typename T>
+class FusedElementwiseOp : public OpKernel {
+ public:
+  using Fn = FusedElementwiseFn<T>;
+  using InputBuffer = typename Fn::InputBuffer;
+  using OutputBuffer = typename Fn::OutputBuffer;
+  using Packet = typename Eigen::internal::packet_traits<T>::type;
+
+  explicit FusedElementwiseOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("op_names", &op_names_));
+    OP_REQUIRES(context, !op_names_.empty(),
+                errors::InvalidArgument(
+                    "Fused element-wise op must have at least one op"));
+    int num_args;
+    OP_REQUIRES_OK(context, context->GetAttr("num_args", &num_args));
+
+    const auto& fns = FusedElementwiseFns<T>();
+    int num_binary = 0;
+    for (const string& op_name : op_names_) {
+      auto it = fns.find(op_name);
+      OP_REQUIRES(context, it != fns.end(),
+                  errors::InvalidArgument(
+                      "Do not have a compute function registered for op: ",
+                      op_name));
+      fns_.push_back(&it->second);
+      cost_ += it->second.cost;
+      if (it->second.binary != nullptr) ++num_binary;
+    }
+    OP_REQUIRES(context, num_binary == num_args - 1,
+                errors::InvalidArgument(
+                    "Fused element-wise op with ", num_binary,
+                    " binary ops expects ", num_binary + 1, " args, got ",
+                    num_args));
+
+    VLOG(2) << "Fused element-wise op: [" << absl::StrJoin(op_names_, ", ")
+            << "]; cost=" << cost_;
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& in = ctx->input(0);
+    const int num_args = ctx->num_inputs();
+    // Args with a single element are broadcast; all others must match the
+    // shape of the first arg.
+    std::vector<const T*> arg_data(num_args);
+    std::vector<bool> arg_is_scalar(num_args, false);
+    for (int i = 0; i < num_args; ++i) {
+      const Tensor& arg = ctx->input(i);
+      arg_is_scalar[i] = i > 0 && arg.NumElements() == 1 &&
+                         arg.dims() <= in.dims() &&
+                         arg.shape() != in.shape();
+      OP_REQUIRES(
+          ctx, arg_is_scalar[i] || arg.shape() == in.shape(),
+          errors::InvalidArgument("Arg ", i, " of shape ",
+                                  arg.shape().DebugString(),
+                                  " can not be broadcast to the shape ",
+                                  in.shape().DebugString()));
+      arg_data[i] = arg.flat<T>().data();
+    }
+
+    // Only the first arg can share the buffer with the output: the running
+    // value overwrites the output block before any other arg is read.
+    Tensor* out = nullptr;
+    OP_REQUIRES_OK(
+        ctx, ctx->forward_input_or_allocate_output({0}, 0, in.shape(), &out));
+    T* out_data = out->flat<T>().data();
+
+    auto compute_fn = [&](int64_t begin, int64_t end) {
+      for (int64_t start = begin; start < end; start += kBlockSize) {
+        const int64_t len = std::min(kBlockSize, end - start);
+        const InputBuffer in_block(arg_data[0] + start, len);
+        const InputBuffer scratch_block(out_data + start, len);
+        OutputBuffer out_block(out_data + start, len);
+
+        int arg = 1;
+        for (size_t i = 0; i < fns_.size(); ++i) {
+          const Fn& fn = *fns_[i];
+          const InputBuffer& value = i == 0 ? in_block : scratch_block;
+          if (fn.unary != nullptr) {
+            fn.unary(value, &out_block);
+          } else if (arg_is_scalar[arg]) {
+            fn.binary_scalar(value, *arg_data[arg++], &out_block);
+          } else {
+            fn.binary(value, InputBuffer(arg_data[arg++] + start, len),
+                      &out_block);
+          }
+        }
+      }
+    };
+
+    const CPUDevice& device = ctx->eigen_device<CPUDevice>();
+    const int kOverheadCycles = static_cast<int>(fns_.size()) * 10;
+    Eigen::TensorOpCost cost(/*bytes_loaded=*/sizeof(T) * num_args,
+                             /*bytes_stored=*/sizeof(T),
+                             kOverheadCycles + cost_);
+    device.parallelFor(in.NumElements(), cost, AlignBlockSize,
+                       std::move(compute_fn));
+  }
+
+ private:
+  static constexpr int kPacketSize =
+      Eigen::internal::unpacket_traits<Packet>::size;
+  // Number of elements of each arg processed together by the whole chain.
+  // Small enough for the blocks of a few args and the output to stay in L1.
+  static constexpr int64_t kBlockSize = 4096 / sizeof(T);
+
+  static inline int64_t AlignBlockSize(int64_t block_size) {
+    // Align shards to whole cache blocks when that does not grow them much.
+    if (block_size >= 4 * kBlockSize) {
+      return (block_size + kBlockSize - 1) & ~(kBlockSize - 1);
+    }
+    return (block_size + kPacketSize - 1) & ~(kPacketSize - 1);
+  }
+
+  std::vector<string> op_names_;
+  std::vector<const Fn*> fns_;
+  int cost_ = 0;
+};
+
+#define REGISTER_CPU(T)                                                     \
+  REGISTER_KERNEL_BUILDER(                                                  \
+      Name("_FusedElementwise").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      FusedElementwiseOp<T>);
+
+REGISTER_CPU(float);
+REGISTER_CPU(double);
+
+#undef REGISTER_CPU
+
+}  // namespace tensorflow
@@ -0,0 +1,112 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class FusedElementwiseOpTest : public OpsTestBase {
+ protected:
+  template <typename T>
+  absl::Status BuildOp(const std::vector<string>& op_names, int num_args) {
+    TF_RETURN_IF_ERROR(NodeDefBuilder("fused_elementwise", "_FusedElementwise")
+                           .Input(FakeInput(num_args, DataTypeToEnum<T>::v()))
+                           .Attr("T", DataTypeToEnum<T>::v())
+                           .Attr("op_names", op_names)
+                           .Finalize(node_def()));
+    return InitOp();
+  }
+};
+
+TEST_F(FusedElementwiseOpTest, MulAddTanh) {
+  // Large enough to span several cache blocks, with a partial last block.
+  const int n = 10007;
+  std::vector<float> x(n), y(n), z(n), expected(n);
+  for (int i = 0; i < n; ++i) {
+    x[i] = (i % 17) * 0.1f - 0.8f;
+    y[i] = (i % 5) * 0.3f;
+    z[i] = (i % 11) * -0.05f;
+    expected[i] = std::tanh(x[i] * y[i] + z[i]);
+  }
+  TF_ASSERT_OK(BuildOp<float>({"Mul", "AddV2", "Tanh"}, 3));
+  AddInputFromArray<float>(TensorShape({n}), x);
+  AddInputFromArray<float>(TensorShape({n}), y);
+  AddInputFromArray<float>(TensorShape({n}), z);
+  TF_ASSERT_OK(RunOpKernel());
+
+  test::ExpectClose(test::AsTensor<float>(expected), *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseOpTest, UnaryFirstAndNonCommutative) {
+  // Sub and RealDiv take the running value as their first operand.
+  TF_ASSERT_OK(BuildOp<double>({"Square", "Sub", "RealDiv"}, 3));
+  AddInputFromArray<double>(TensorShape({2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<double>(TensorShape({2, 2}), {1, 1, 1, 1});
+  AddInputFromArray<double>(TensorShape({2, 2}), {2, 3, 4, 5});
+  TF_ASSERT_OK(RunOpKernel());
+
+  test::ExpectClose(
+      test::AsTensor<double>({0.0, 1.0, 2.0, 3.0}, TensorShape({2, 2})),
+      *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseOpTest, BroadcastsSingleElementArgs) {
+  TF_ASSERT_OK(BuildOp<float>({"Mul", "Sigmoid", "Maximum"}, 3));
+  AddInputFromArray<float>(TensorShape({2, 3}), {-3, -2, -1, 0, 1, 2});
+  AddInputFromArray<float>(TensorShape({}), {2});
+  AddInputFromArray<float>(TensorShape({1, 1}), {0.25});
+  TF_ASSERT_OK(RunOpKernel());
+
+  std::vector<float> expected;
+  for (float x : {-3, -2, -1, 0, 1, 2}) {
+    expected.push_back(std::max(0.25f, 1.0f / (1.0f + std::exp(-2 * x))));
+  }
+  test::ExpectClose(test::AsTensor<float>(expected, TensorShape({2, 3})),
+                    *GetOutput(0));
+}
+
+TEST_F(FusedElementwiseOpTest, RejectsMismatchedShapes) {
+  TF_ASSERT_OK(BuildOp<float>({"Mul"}, 2));
+  AddInputFromArray<float>(TensorShape({2, 2}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({2}), {1, 2});
+  absl::Status s = RunOpKernel();
+  EXPECT_TRUE(absl::StrContains(s.message(), "can not be broadcast")) << s;
+}
+
+TEST_F(FusedElementwiseOpTest, RejectsWrongNumberOfArgs) {
+  absl::Status s = BuildOp<float>({"Mul", "Tanh"}, 3);
+  EXPECT_TRUE(absl::StrContains(s.message(), "expects 2 args")) << s;
+}
+
+TEST_F(FusedElementwiseOpTest, RejectsUnknownOp) {
+  absl::Status s = BuildOp<float>({"BiasAdd"}, 2);
+  EXPECT_TRUE(absl::StrContains(s.message(), "BiasAdd")) << s;
+}
+
+}  // namespace
+}  // namespace tensorflow
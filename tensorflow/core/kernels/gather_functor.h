@@ -16,6 +16,10 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_KERNELS_GATHER_FUNCTOR_H_
 #define TENSORFLOW_CORE_KERNELS_GATHER_FUNCTOR_H_
 
+#include <algorithm>
+#include <cstdint>
+
+#include "absl/base/optimization.h"
 #include "absl/base/prefetch.h"
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/bounds_check.h"
@@ -32,6 +36,15 @@ typedef Eigen::GpuDevice GPUDevice;
 
 namespace functor {
 
+// Params at least this large can't stay cached, so gathers from them are
+// bound by DRAM latency and rows are prefetched several indices ahead.
+constexpr int64_t kGatherPrefetchAheadMinBytes = 64 << 20;
+// Number of slices the prefetches run ahead of the copies.
+constexpr int64_t kGatherPrefetchDistance = 8;
+// Number of bytes prefetched per slice. The hardware prefetcher follows the
+// remainder of longer slices.
+constexpr int64_t kGatherPrefetchMaxBytes = 256;
+
 // Helper method to copy using memcpy.
 template <typename T, typename Index, typename SliceIndex,
           SliceIndex static_slice_elems>
@@ -56,7 +69,81 @@ SliceIndex HandleCopies(OpKernelContext* ctx,
   // Store the value of invalidate index for printing error information, it's a
   // shared variable.
   SliceIndex result = -1;
+  const bool prefetch_ahead =
+      params.size() * sizeof(T) >= kGatherPrefetchAheadMinBytes;
+  auto copy_slice = [&](SliceIndex batch_idx, SliceIndex indices_idx,
+                        Index index) {
+    // Copy using memcpy if possible, otherwise an Eigen loop
+    // TODO(cwhipkey): avoid linking to framework to get Allocator (to improve
+    // ahead-of-time compilation binary size).
+    if (is_simple_type<T>::value) {
+      // Avoid auto-promotion to Index from SliceIndex by casting.
+      memcpy(out_base + (batch_idx * indices_size + indices_idx) * slice_elems,
+             params_base + (batch_idx * static_cast<SliceIndex>(limit) +
+                            static_cast<SliceIndex>(index)) *
+                               slice_elems,
+             slice_bytes);
+    } else {
+      // For non-"simple" types (e.g. strings).
+      out.template chip<0>(batch_idx).template chip<0>(indices_idx) =
+          params.template chip<0>(batch_idx).template chip<0>(index);
+    }
+  };
+  auto prefetch_slice = [&](SliceIndex batch_idx, SliceIndex indices_idx) {
+    const Index index = indices(indices_idx);
+    if (!FastBoundsCheck(index, limit)) return;
+    const char* slice = reinterpret_cast<const char*>(
+        params_base + (batch_idx * static_cast<SliceIndex>(limit) +
+                       static_cast<SliceIndex>(index)) *
+                          slice_elems);
+    const int64_t prefetch_bytes = std::min<int64_t>(
+        slice_bytes, kGatherPrefetchMaxBytes);
+    for (int64_t offset = 0; offset < prefetch_bytes;
+         offset += ABSL_CACHELINE_SIZE) {
+      absl::PrefetchToLocalCache(slice + offset);
+    }
+  };
+  auto work_prefetch_ahead = [&](int64_t start, int64_t end) {
+    SliceIndex batch_idx = static_cast<SliceIndex>(start / indices_size);
+    SliceIndex indices_idx = static_cast<SliceIndex>(start % indices_size);
+    // Position of the next slice to prefetch, which runs
+    // kGatherPrefetchDistance slices ahead of the copies.
+    int64_t ahead = start;
+    SliceIndex ahead_batch_idx = batch_idx;
+    SliceIndex ahead_indices_idx = indices_idx;
+    auto prefetch_next = [&]() {
+      if (ahead >= end) return;
+      prefetch_slice(ahead_batch_idx, ahead_indices_idx);
+      ++ahead;
+      if (++ahead_indices_idx == indices_size) {
+        ahead_indices_idx = 0;
+        ++ahead_batch_idx;
+      }
+    };
+    for (int64_t i = 0; i < kGatherPrefetchDistance; ++i) {
+      prefetch_next();
+    }
+
+    for (int64_t i = start; i < end; ++i) {
+      prefetch_next();
+      const Index index = internal::SubtleMustCopy(indices(indices_idx));
+      if (!FastBoundsCheck(index, limit)) {
+        mutex_lock l(mu);
+        result = indices_idx;
+        return;
+      }
+      copy_slice(batch_idx, indices_idx, index);
+      if (++indices_idx == indices_size) {
+        indices_idx = 0;
+        ++batch_idx;
+      }
+    }
+  };
   auto work = [&](int64_t start, int64_t end) {
+    if (prefetch_ahead) {
+      work_prefetch_ahead(start, end);
+      return;
+    }
     SliceIndex batch_idx = static_cast<SliceIndex>(start / indices_size);
     SliceIndex indices_idx = static_cast<SliceIndex>(start % indices_size);
     SliceIndex batch_idx_end = static_cast<SliceIndex>(end / indices_size);
@@ -82,22 +169,7 @@ SliceIndex HandleCopies(OpKernelContext* ctx,
         absl::PrefetchToLocalCache(&out(b_next, 0, 0));
         i_next = 0;
       }
-      // Copy using memcpy if possible, otherwise an Eigen loop
-      // TODO(cwhipkey): avoid linking to framework to get Allocator (to improve
-      // ahead-of-time compilation binary size).
-      if (is_simple_type<T>::value) {
-        // Avoid auto-promotion to Index from SliceIndex by casting.
-        memcpy(
-            out_base + (batch_idx * indices_size + indices_idx) * slice_elems,
-            params_base + (batch_idx * static_cast<SliceIndex>(limit) +
-                           static_cast<SliceIndex>(index)) *
-                              slice_elems,
-            slice_bytes);
-      } else {
-        // For non-"simple" types (e.g. strings).
-        out.template chip<0>(batch_idx).template chip<0>(indices_idx) =
-            params.template chip<0>(batch_idx).template chip<0>(index);
-      }
+      copy_slice(batch_idx, indices_idx, index);
       indices_idx = i_next;
       batch_idx = b_next;
     }
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <cmath>
 #include <functional>
 #include <memory>
 #include <vector>
@@ -206,8 +207,11 @@ TEST_F(GatherOpTest, Error_BatchDimsOutOfRange) {
 
 constexpr int kLookups = 2000;
 
+// If `power_law` is set, the lookups follow a power-law distribution over the
+// rows, as the ids of embedding lookups typically do. The hot rows are spread
+// over the whole buffer rather than clustered at its start.
 template <typename Index>
-static Graph* Gather(int dim) {
+static Graph* Gather(int dim, bool power_law = false) {
   Graph* g = new Graph(OpRegistry::Global());
   // Always use a 512MB buffer.
   const int kRows = ((512 << 20) / sizeof(float)) / dim;
@@ -219,7 +223,13 @@ static Graph* Gather(int dim) {
   std::vector<Index> indices_vec;
   indices_vec.reserve(kLookups);
   for (int i = 0; i < kLookups; i++) {
-    indices_vec.push_back(rnd.Uniform(kRows));
+    if (power_law) {
+      const int64_t rank =
+          static_cast<int64_t>(std::pow(kRows, rnd.RandDouble())) - 1;
+      indices_vec.push_back((rank * 2654435761LL) % kRows);
+    } else {
+      indices_vec.push_back(rnd.Uniform(kRows));
+    }
   }
   Tensor indices(DataTypeToEnum<Index>::value, TensorShape({kLookups}));
   for (int i = 0; i < indices_vec.size(); i++) {
@@ -261,5 +271,21 @@ BM_GATHER(gpu, int32);
 BM_GATHER(cpu, int64_t);
 BM_GATHER(gpu, int64_t);
 
+static void BM_cpu_gather_power_law(::testing::benchmark::State& state) {
+  const int dim = state.range(0);
+  test::Benchmark("cpu", Gather<int64_t>(dim, /*power_law=*/true),
+                  /*old_benchmark_api=*/false)
+      .Run(state);
+  const int64_t tot = static_cast<int64_t>(state.iterations()) * kLookups * dim;
+  state.SetItemsProcessed(tot);
+  state.SetBytesProcessed(tot * sizeof(float));
+}
+BENCHMARK(BM_cpu_gather_power_law)
+    ->UseRealTime()
+    ->Arg(10)
+    ->Arg(64)
+    ->Arg(200)
+    ->Arg(1000);
+
 }  // namespace
 }  // namespace tensorflow
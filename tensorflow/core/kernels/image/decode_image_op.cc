@@ -15,11 +15,13 @@ limitations under the License.
 
 // See docs in ../ops/image_ops.cc
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <cstdlib>
 #include <limits>
 #include <memory>
+#include <vector>
 
 #define EIGEN_USE_THREADS
 
@@ -43,6 +45,7 @@ limitations under the License.
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/stringpiece.h"
 #include "tensorflow/core/platform/tstring.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -749,5 +752,325 @@ void DecodeImageV2Op::DecodeBMP(const uint8* input, const int row_size,
   }
 }
 
+// Decodes a batch of JPEG or PNG images and resizes a crop window of each one
+// to a common size with bilinear interpolation (half pixel centers). Images
+// are decoded in parallel; each shard reuses one buffer for the decoded pixels
+// of all its images. With `use_dct_scaling`, libjpeg decodes JPEGs at 1/2,
+// 1/4 or 1/8 scale whenever the scaled crop window still covers the output.
+class BatchDecodeAndResizeImageOp : public OpKernel {
+ public:
+  explicit BatchDecodeAndResizeImageOp(OpKernelConstruction* context)
+      : OpKernel(context) {
+    OP_REQUIRES_OK(context, context->GetAttr("channels", &channels_));
+    OP_REQUIRES(context, channels_ == 1 || channels_ == 3,
+                errors::InvalidArgument("`channels` must be 1 or 3 but got ",
+                                        channels_));
+    OP_REQUIRES_OK(context,
+                   context->GetAttr("use_dct_scaling", &use_dct_scaling_));
+    OP_REQUIRES_OK(context, context->GetAttr("fancy_upscaling",
+                                             &flags_.fancy_upscaling));
+    string dct_method;
+    OP_REQUIRES_OK(context, context->GetAttr("dct_method", &dct_method));
+    OP_REQUIRES(
+        context,
+        (dct_method.empty() || dct_method == "INTEGER_FAST" ||
+         dct_method == "INTEGER_ACCURATE"),
+        errors::InvalidArgument("dct_method must be one of "
+                                "{'', 'INTEGER_FAST', 'INTEGER_ACCURATE'}"));
+    flags_.dct_method =
+        dct_method == "INTEGER_ACCURATE" ? JDCT_ISLOW : JDCT_IFAST;
+    flags_.components = channels_;
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& contents = context->input(0);
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(contents.shape()),
+                errors::InvalidArgument("`contents` must be 1-D but got shape ",
+                                        contents.shape().DebugString()));
+    const int64_t batch_size = contents.dim_size(0);
+    const Tensor& crop_windows = context->input(1);
+    OP_REQUIRES(
+        context,
+        TensorShapeUtils::IsMatrix(crop_windows.shape()) &&
+            crop_windows.dim_size(0) == batch_size &&
+            crop_windows.dim_size(1) == 4,
+        errors::InvalidArgument("`crop_windows` must have shape [", batch_size,
+                                ", 4] but got ",
+                                crop_windows.shape().DebugString()));
+    const Tensor& size = context->input(2);
+    OP_REQUIRES(context,
+                TensorShapeUtils::IsVector(size.shape()) &&
+                    size.NumElements() == 2,
+                errors::InvalidArgument("`size` must have two elements but "
+                                        "got shape ",
+                                        size.shape().DebugString()));
+    const int32_t out_height = size.vec<int32>()(0);
+    const int32_t out_width = size.vec<int32>()(1);
+    OP_REQUIRES(context, out_height > 0 && out_width > 0,
+                errors::InvalidArgument("`size` must be positive but got [",
+                                        out_height, ", ", out_width, "]"));
+
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(
+                       0,
+                       TensorShape({batch_size, out_height, out_width,
+                                    static_cast<int64_t>(channels_)}),
+                       &output));
+    if (batch_size == 0) return;
+
+    const auto contents_vec = contents.vec<tstring>();
+    const auto crop_windows_mat = crop_windows.matrix<int32>();
+    float* output_data = output->flat<float>().data();
+    const int64_t image_size =
+        static_cast<int64_t>(out_height) * out_width * channels_;
+    int64_t total_input_bytes = 0;
+    for (int64_t i = 0; i < batch_size; ++i) {
+      total_input_bytes += contents_vec(i).size();
+    }
+
+    std::vector<absl::Status> statuses(batch_size);
+    auto decode_range = [&](int64_t start, int64_t limit) {
+      // Decoded pixels of every image in the shard go to the same buffer, so
+      // it only grows to the size of the largest image.
+      std::vector<uint8> decoded;
+      for (int64_t i = start; i < limit; ++i) {
+        const int32 window[4] = {crop_windows_mat(i, 0), crop_windows_mat(i, 1),
+                                 crop_windows_mat(i, 2),
+                                 crop_windows_mat(i, 3)};
+        statuses[i] = DecodeAndResize(contents_vec(i), window, out_height,
+                                      out_width, &decoded,
+                                      output_data + i * image_size);
+      }
+    };
+    // Decoding dominates, and its cost grows with the size of the encoded
+    // image.
+    const int64_t cost_per_image =
+        kCyclesPerEncodedByte * (total_input_bytes / batch_size) +
+        kCyclesPerOutputValue * image_size;
+    auto* worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, batch_size,
+          cost_per_image, decode_range);
+    for (const absl::Status& status : statuses) {
+      OP_REQUIRES_OK(context, status);
+    }
+  }
+
+ private:
+  static constexpr int64_t kCyclesPerEncodedByte = 500;
+  static constexpr int64_t kCyclesPerOutputValue = 20;
+
+  // Checks the crop window [y, x, height, width] against an image of the given
+  // size. A window with zero height or width selects the whole image.
+  static absl::Status ResolveCropWindow(const int32 window[4], int height,
+                                        int width, int* crop_y, int* crop_x,
+                                        int* crop_height, int* crop_width) {
+    if (window[2] == 0 || window[3] == 0) {
+      *crop_y = 0;
+      *crop_x = 0;
+      *crop_height = height;
+      *crop_width = width;
+      return absl::OkStatus();
+    }
+    if (window[0] < 0 || window[1] < 0 || window[2] < 0 || window[3] < 0 ||
+        window[0] > height - window[2] || window[1] > width - window[3]) {
+      return errors::InvalidArgument(
+          "Invalid crop window [", window[0], ", ", window[1], ", ", window[2],
+          ", ", window[3], "] for an image of size ", height, "x", width);
+    }
+    *crop_y = window[0];
+    *crop_x = window[1];
+    *crop_height = window[2];
+    *crop_width = window[3];
+    return absl::OkStatus();
+  }
+
+  absl::Status DecodeAndResize(StringPiece input, const int32 window[4],
+                               int out_height, int out_width,
+                               std::vector<uint8>* decoded,
+                               float* output) const {
+    if (input.empty()) {
+      return errors::InvalidArgument("Input is empty.");
+    }
+    if (input.size() > std::numeric_limits<int>::max()) {
+      return errors::InvalidArgument("Input contents are too large for int: ",
+                                     input.size());
+    }
+    switch (ClassifyFileFormat(input)) {
+      case kJpgFormat:
+        return DecodeAndResizeJpeg(input, window, out_height, out_width,
+                                   decoded, output);
+      case kPngFormat:
+        return DecodeAndResizePng(input, window, out_height, out_width,
+                                  decoded, output);
+      default:
+        return errors::InvalidArgument(
+            "BatchDecodeAndResizeImage supports JPEG and PNG images only.");
+    }
+  }
+
+  absl::Status DecodeAndResizeJpeg(StringPiece input, const int32 window[4],
+                                   int out_height, int out_width,
+                                   std::vector<uint8>* decoded,
+                                   float* output) const {
+    int height = 0;
+    int width = 0;
+    if (!jpeg::GetImageInfo(input.data(), input.size(), &width, &height,
+                            nullptr)) {
+      return errors::InvalidArgument("Invalid JPEG data.");
+    }
+    int crop_y, crop_x, crop_height, crop_width;
+    TF_RETURN_IF_ERROR(ResolveCropWindow(window, height, width, &crop_y,
+                                         &crop_x, &crop_height, &crop_width));
+
+    jpeg::UncompressFlags flags = flags_;
+    if (use_dct_scaling_) {
+      for (int ratio : {8, 4, 2}) {
+        if (crop_height >= ratio * out_height &&
+            crop_width >= ratio * out_width) {
+          flags.ratio = ratio;
+          break;
+        }
+      }
+    }
+    // libjpeg rounds the scaled image size up. Map the crop window to the
+    // smallest window of the scaled image that covers it.
+    const int ratio = flags.ratio;
+    const int scaled_height = (height + ratio - 1) / ratio;
+    const int scaled_width = (width + ratio - 1) / ratio;
+    flags.crop_y = crop_y / ratio;
+    flags.crop_x = crop_x / ratio;
+    flags.crop_height =
+        std::min((crop_y + crop_height + ratio - 1) / ratio, scaled_height) -
+        flags.crop_y;
+    flags.crop_width =
+        std::min((crop_x + crop_width + ratio - 1) / ratio, scaled_width) -
+        flags.crop_x;
+    flags.crop = flags.crop_height != scaled_height ||
+                 flags.crop_width != scaled_width;
+
+    int decoded_height = 0;
+    int decoded_width = 0;
+    uint8* buffer = jpeg::Uncompress(
+        input.data(), input.size(), flags, nullptr /* nwarn */,
+        [&](int w, int h, int c) -> uint8* {
+          decoded_height = h;
+          decoded_width = w;
+          decoded->resize(static_cast<size_t>(h) * w * c);
+          return decoded->data();
+        });
+    if (buffer == nullptr) {
+      return errors::InvalidArgument(
+          "jpeg::Uncompress failed. Invalid JPEG data or crop window.");
+    }
+    ResizeBilinear(buffer, decoded_width, 0, 0, decoded_height, decoded_width,
+                   out_height, out_width, output);
+    return absl::OkStatus();
+  }
+
+  absl::Status DecodeAndResizePng(StringPiece input, const int32 window[4],
+                                  int out_height, int out_width,
+                                  std::vector<uint8>* decoded,
+                                  float* output) const {
+    png::DecodeContext decode;
+    if (!png::CommonInitDecode(input, channels_, 8, &decode)) {
+      return errors::InvalidArgument(
+          "Invalid PNG. Failed to initialize decoder.");
+    }
+    auto cleanup =
+        gtl::MakeCleanup([&decode]() { png::CommonFreeDecode(&decode); });
+
+    const int width = static_cast<int>(decode.width);
+    const int height = static_cast<int>(decode.height);
+    const int64_t total_size =
+        static_cast<int64_t>(width) * static_cast<int64_t>(height);
+    if (width != static_cast<int64_t>(decode.width) || width <= 0 ||
+        width >= (1LL << 27) || height != static_cast<int64_t>(decode.height) ||
+        height <= 0 || height >= (1LL << 27) || total_size >= (1LL << 29)) {
+      return errors::InvalidArgument("PNG size too large for int: ",
+                                     decode.width, " by ", decode.height);
+    }
+    if (decode.channels != channels_) {
+      return errors::Internal("PNG decoder produced ", decode.channels,
+                              " channels instead of ", channels_);
+    }
+    int crop_y, crop_x, crop_height, crop_width;
+    TF_RETURN_IF_ERROR(ResolveCropWindow(window, height, width, &crop_y,
+                                         &crop_x, &crop_height, &crop_width));
+
+    decoded->resize(total_size * channels_);
+    if (!png::CommonFinishDecode(reinterpret_cast<png_bytep>(decoded->data()),
+                                 channels_ * width, &decode)) {
+      return errors::InvalidArgument("Invalid PNG data, size ", input.size());
+    }
+    ResizeBilinear(decoded->data(), width, crop_y, crop_x, crop_height,
+                   crop_width, out_height, out_width, output);
+    return absl::OkStatus();
+  }
+
+  // Resizes the window of `image` (with rows of `image_width` pixels) that
+  // starts at (`crop_y`, `crop_x`), using the same interpolation weights as
+  // ResizeBilinear with `half_pixel_centers`.
+  void ResizeBilinear(const uint8* image, int image_width, int crop_y,
+                      int crop_x, int crop_height, int crop_width,
+                      int out_height, int out_width, float* output) const {
+    struct Interpolation {
+      int64_t lower;
+      int64_t upper;
+      float lerp;
+    };
+    auto compute_weights = [](int out_size, int in_size, int offset,
+                              int64_t stride) {
+      const float scale = static_cast<float>(in_size) / out_size;
+      std::vector<Interpolation> weights(out_size);
+      for (int i = 0; i < out_size; ++i) {
+        const float in = (static_cast<float>(i) + 0.5f) * scale - 0.5f;
+        const float in_f = std::floor(in);
+        const int64_t lower =
+            std::max(static_cast<int64_t>(in_f), static_cast<int64_t>(0));
+        const int64_t upper =
+            std::min(static_cast<int64_t>(std::ceil(in)),
+                     static_cast<int64_t>(in_size) - 1);
+        weights[i] = {(offset + lower) * stride, (offset + upper) * stride,
+                      in - in_f};
+      }
+      return weights;
+    };
+    const int64_t row_size = static_cast<int64_t>(image_width) * channels_;
+    const std::vector<Interpolation> ys =
+        compute_weights(out_height, crop_height, crop_y, row_size);
+    const std::vector<Interpolation> xs =
+        compute_weights(out_width, crop_width, crop_x, channels_);
+
+    for (int y = 0; y < out_height; ++y) {
+      const uint8* top_row = image + ys[y].lower;
+      const uint8* bottom_row = image + ys[y].upper;
+      const float y_lerp = ys[y].lerp;
+      for (int x = 0; x < out_width; ++x) {
+        const int64_t left = xs[x].lower;
+        const int64_t right = xs[x].upper;
+        const float x_lerp = xs[x].lerp;
+        for (int c = 0; c < channels_; ++c) {
+          const float top_left(top_row[left + c]);
+          const float top_right(top_row[right + c]);
+          const float bottom_left(bottom_row[left + c]);
+          const float bottom_right(bottom_row[right + c]);
+          const float top = top_left + (top_right - top_left) * x_lerp;
+          const float bottom =
+              bottom_left + (bottom_right - bottom_left) * x_lerp;
+          *output++ = top + (bottom - top) * y_lerp;
+        }
+      }
+    }
+  }
+
+  int channels_;
+  bool use_dct_scaling_;
+  jpeg::UncompressFlags flags_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("BatchDecodeAndResizeImage").Device(DEVICE_CPU),
+                        BatchDecodeAndResizeImageOp);
+
 }  // namespace
 }  // namespace tensorflow
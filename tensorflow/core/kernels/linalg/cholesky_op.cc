@@ -15,6 +15,8 @@ limitations under the License.
 
 // See docs in ../ops/linalg_ops.cc.
 
+#include <type_traits>
+
 #include "Eigen/Cholesky"  // from @eigen_archive
 #include "Eigen/Core"  // from @eigen_archive
 #include "tensorflow/core/framework/kernel_def_builder.h"
@@ -22,6 +24,7 @@ limitations under the License.
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/kernels/linalg/linalg_ops_common.h"
+#include "tensorflow/core/kernels/linalg/small_matrix_batch.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/types.h"
@@ -33,8 +36,49 @@ class CholeskyOp : public LinearAlgebraOp<Scalar> {
  public:
   INHERIT_LINALG_TYPEDEFS(Scalar);
 
+  using InputMatrixBatch = typename Base::InputMatrixBatch;
+  using OutputMatrixBatch = typename Base::OutputMatrixBatch;
+
   explicit CholeskyOp(OpKernelConstruction* context) : Base(context) {}
 
+  bool SupportsMatrixBatch(
+      const TensorShapes& input_matrix_shapes) const final {
+    const int64_t rows = input_matrix_shapes[0].dim_size(0);
+    return std::is_floating_point<Scalar>::value && rows > 0 &&
+           rows <= small_matrix::kMaxSmallMatrixOrder;
+  }
+
+  void ComputeMatrixBatch(OpKernelContext* context,
+                          const TensorShapes& input_matrix_shapes,
+                          const InputMatrixBatch& inputs,
+                          const OutputMatrixBatch& outputs, int num_matrices,
+                          bool* done) final {
+    if constexpr (std::is_floating_point<Scalar>::value) {
+      static_assert(Base::kMatrixBatchSize == small_matrix::kSmallMatrixLanes);
+      const int64_t size = input_matrix_shapes[0].num_elements();
+      const Scalar* matrices[small_matrix::kSmallMatrixLanes];
+      Scalar* factors[small_matrix::kSmallMatrixLanes];
+      for (int i = 0; i < num_matrices; ++i) {
+        matrices[i] = inputs[0] + i * size;
+        factors[i] = outputs[0] + i * size;
+      }
+      // Matrices that are not positive definite are left to ComputeMatrix,
+      // which fills their factors with NaNs.
+      switch (input_matrix_shapes[0].dim_size(0)) {
+#define CHOLESKY_BATCH(N)                                                   \
+  case N:                                                                   \
+    small_matrix::CholeskyBatch<Scalar, N>(matrices, factors, num_matrices, \
+                                           done);                           \
+    break;
+        CHOLESKY_BATCH(1);
+        CHOLESKY_BATCH(2);
+        CHOLESKY_BATCH(3);
+        CHOLESKY_BATCH(4);
+#undef CHOLESKY_BATCH
+      }
+    }
+  }
+
   void ComputeMatrix(OpKernelContext* context, const ConstMatrixMaps& inputs,
                      MatrixMaps* outputs) final {
     const ConstMatrixMap& input = inputs[0];
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/linalg/linalg_ops_common.h"
 
+#include <algorithm>
 #include <initializer_list>
 #include <utility>
 
@@ -104,8 +105,16 @@ void LinearAlgebraOp<InputScalar, OutputScalar>::Compute(
   if (!context->status().ok()) return;
 
   // Process the individual matrix problems in parallel using a threadpool.
+  const bool use_matrix_batch = SupportsMatrixBatch(input_matrix_shapes);
   auto shard = [this, &inputs, &input_matrix_shapes, &outputs,
-                &output_matrix_shapes, context](int64_t begin, int64_t end) {
+                &output_matrix_shapes, use_matrix_batch,
+                context](int64_t begin, int64_t end) {
+    if (use_matrix_batch) {
+      ComputeTensorSliceBatches(context, begin, end, inputs,
+                                input_matrix_shapes, outputs,
+                                output_matrix_shapes);
+      return;
+    }
     for (int64_t i = begin; i < end; ++i) {
       ComputeTensorSlice(context, i, inputs, input_matrix_shapes, outputs,
                          output_matrix_shapes);
@@ -263,6 +272,36 @@ void LinearAlgebraOp<InputScalar, OutputScalar>::ComputeTensorSlice(
   ComputeMatrix(context, matrix_inputs, &matrix_outputs);
 }
 
+template <class InputScalar, class OutputScalar>
+void LinearAlgebraOp<InputScalar, OutputScalar>::ComputeTensorSliceBatches(
+    OpKernelContext* context, int64_t begin, int64_t end,
+    const TensorInputs& inputs, const TensorShapes& input_matrix_shapes,
+    const TensorOutputs& outputs, const TensorShapes& output_matrix_shapes) {
+  for (int64_t start = begin; start < end; start += kMatrixBatchSize) {
+    const int num_matrices =
+        static_cast<int>(std::min<int64_t>(kMatrixBatchSize, end - start));
+    InputMatrixBatch batch_inputs;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      batch_inputs.push_back(inputs[i]->flat<InputScalar>().data() +
+                             start * input_matrix_shapes[i].num_elements());
+    }
+    OutputMatrixBatch batch_outputs;
+    for (size_t i = 0; i < output_matrix_shapes.size(); ++i) {
+      batch_outputs.push_back(outputs[i]->flat<OutputScalar>().data() +
+                              start * output_matrix_shapes[i].num_elements());
+    }
+    bool done[kMatrixBatchSize] = {};
+    ComputeMatrixBatch(context, input_matrix_shapes, batch_inputs,
+                       batch_outputs, num_matrices, done);
+    for (int i = 0; i < num_matrices; ++i) {
+      if (!done[i]) {
+        ComputeTensorSlice(context, start + i, inputs, input_matrix_shapes,
+                           outputs, output_matrix_shapes);
+      }
+    }
+  }
+}
+
 // Explicitly instantiate LinearAlgebraOp for the scalar types we expect to use.
 template class LinearAlgebraOp<Eigen::half>;
 template class LinearAlgebraOp<float>;
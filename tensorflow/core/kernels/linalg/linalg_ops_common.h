@@ -151,6 +151,33 @@ class LinearAlgebraOp : public OpKernel {
                              const InputConstMatrixMaps& inputs,
                              OutputMatrixMaps* outputs) = 0;
 
+  // Pointers to the first matrix of a batch of consecutive matrices in each
+  // input or output tensor.
+  using InputMatrixBatch = absl::InlinedVector<const InputScalar*, 4UL>;
+  using OutputMatrixBatch = absl::InlinedVector<OutputScalar*, 4UL>;
+
+  // Maximum number of matrices passed to a single call to ComputeMatrixBatch.
+  static constexpr int kMatrixBatchSize = 8;
+
+  // Returns true if ComputeMatrixBatch handles matrices of the given shapes.
+  // By default it handles none, and ComputeMatrix is called for every matrix.
+  virtual bool SupportsMatrixBatch(
+      const TensorShapes& input_matrix_shapes) const {
+    return false;
+  }
+
+  // Performs up to kMatrixBatchSize consecutive matrix computations at once,
+  // e.g. with kernels specialized for small matrices, where the per-matrix
+  // overhead of ComputeMatrix dominates. The matrices of each input and output
+  // are stored contiguously in row major order, starting at the given
+  // pointers. Sets done[i] for every matrix i that was computed; ComputeMatrix
+  // is called for the others, e.g. to report errors.
+  virtual void ComputeMatrixBatch(OpKernelContext* context,
+                                  const TensorShapes& input_matrix_shapes,
+                                  const InputMatrixBatch& inputs,
+                                  const OutputMatrixBatch& outputs,
+                                  int num_matrices, bool* done) {}
+
  private:
   using TensorInputs = absl::InlinedVector<const Tensor*, 4UL>;
   using TensorOutputs = absl::InlinedVector<Tensor*, 4UL>;
@@ -177,6 +204,14 @@ class LinearAlgebraOp : public OpKernel {
                           const TensorOutputs& outputs,
                           const TensorShapes& output_matrix_shapes);
 
+  // Computes the matrices [begin, end) with ComputeMatrixBatch, falling back
+  // to ComputeTensorSlice for the ones it did not compute.
+  void ComputeTensorSliceBatches(OpKernelContext* context, int64_t begin,
+                                 int64_t end, const TensorInputs& inputs,
+                                 const TensorShapes& input_matrix_shapes,
+                                 const TensorOutputs& outputs,
+                                 const TensorShapes& output_matrix_shapes);
+
   void AnalyzeInputs(OpKernelContext* context, TensorInputs* inputs,
                      TensorShapes* input_matrix_shapes,
                      TensorShape* batch_shape);
@@ -19,12 +19,15 @@ limitations under the License.
 #define EIGEN_USE_GPU
 #endif
 
+#include <type_traits>
+
 #include "Eigen/Core"  // from @eigen_archive
 #include "Eigen/LU"  // from @eigen_archive
 #include "tensorflow/core/framework/kernel_def_builder.h"
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/kernels/linalg/linalg_ops_common.h"
+#include "tensorflow/core/kernels/linalg/small_matrix_batch.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
@@ -43,11 +46,51 @@ template <class Scalar>
 class MatrixInverseOp : public LinearAlgebraOp<Scalar> {
  public:
   INHERIT_LINALG_TYPEDEFS(Scalar);
+  using InputMatrixBatch = typename Base::InputMatrixBatch;
+  using OutputMatrixBatch = typename Base::OutputMatrixBatch;
 
   explicit MatrixInverseOp(OpKernelConstruction* context) : Base(context) {
     OP_REQUIRES_OK(context, context->GetAttr("adjoint", &adjoint_));
   }
 
+  bool SupportsMatrixBatch(
+      const TensorShapes& input_matrix_shapes) const final {
+    const int64_t rows = input_matrix_shapes[0].dim_size(0);
+    return std::is_floating_point<Scalar>::value && rows > 0 &&
+           rows <= small_matrix::kMaxSmallMatrixOrder;
+  }
+
+  void ComputeMatrixBatch(OpKernelContext* context,
+                          const TensorShapes& input_matrix_shapes,
+                          const InputMatrixBatch& inputs,
+                          const OutputMatrixBatch& outputs, int num_matrices,
+                          bool* done) final {
+    if constexpr (std::is_floating_point<Scalar>::value) {
+      static_assert(Base::kMatrixBatchSize == small_matrix::kSmallMatrixLanes);
+      const int64_t size = input_matrix_shapes[0].num_elements();
+      const Scalar* matrices[small_matrix::kSmallMatrixLanes];
+      Scalar* inverses[small_matrix::kSmallMatrixLanes];
+      for (int i = 0; i < num_matrices; ++i) {
+        matrices[i] = inputs[0] + i * size;
+        inverses[i] = outputs[0] + i * size;
+      }
+      // Matrices with a zero pivot are left to ComputeMatrix, which reports
+      // the error.
+      switch (input_matrix_shapes[0].dim_size(0)) {
+#define INVERSE_BATCH(N)                                                    \
+  case N:                                                                   \
+    small_matrix::InverseBatch<Scalar, N>(matrices, inverses, num_matrices, \
+                                          adjoint_, done);                  \
+    break;
+        INVERSE_BATCH(1);
+        INVERSE_BATCH(2);
+        INVERSE_BATCH(3);
+        INVERSE_BATCH(4);
+#undef INVERSE_BATCH
+      }
+    }
+  }
+
   void ComputeMatrix(OpKernelContext* context, const ConstMatrixMaps& inputs,
                      MatrixMaps* outputs) final {
     const ConstMatrixMap& input = inputs[0];
@@ -19,6 +19,7 @@ limitations under the License.
 #endif
 
 #include <numeric>
+#include <type_traits>
 
 #include "Eigen/Core"  // from @eigen_archive
 #include "Eigen/LU"  // from @eigen_archive
@@ -26,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/kernels/linalg/linalg_ops_common.h"
+#include "tensorflow/core/kernels/linalg/small_matrix_batch.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/macros.h"
@@ -45,6 +47,8 @@ template <class Scalar>
 class MatrixSolveOp : public LinearAlgebraOp<Scalar> {
  public:
   INHERIT_LINALG_TYPEDEFS(Scalar);
+  using InputMatrixBatch = typename Base::InputMatrixBatch;
+  using OutputMatrixBatch = typename Base::OutputMatrixBatch;
 
   explicit MatrixSolveOp(OpKernelConstruction* context) : Base(context) {
     OP_REQUIRES_OK(context, context->GetAttr("adjoint", &adjoint_));
@@ -72,6 +76,49 @@ class MatrixSolveOp : public LinearAlgebraOp<Scalar> {
 
   bool EnableInputForwarding() const final { return false; }
 
+  bool SupportsMatrixBatch(
+      const TensorShapes& input_matrix_shapes) const final {
+    const int64_t rows = input_matrix_shapes[0].dim_size(0);
+    return std::is_floating_point<Scalar>::value && rows > 0 &&
+           rows <= small_matrix::kMaxSmallMatrixOrder;
+  }
+
+  void ComputeMatrixBatch(OpKernelContext* context,
+                          const TensorShapes& input_matrix_shapes,
+                          const InputMatrixBatch& inputs,
+                          const OutputMatrixBatch& outputs, int num_matrices,
+                          bool* done) final {
+    if constexpr (std::is_floating_point<Scalar>::value) {
+      static_assert(Base::kMatrixBatchSize == small_matrix::kSmallMatrixLanes);
+      const int64_t size = input_matrix_shapes[0].num_elements();
+      const int64_t num_rhss = input_matrix_shapes[1].dim_size(1);
+      const int64_t rhs_size = input_matrix_shapes[1].num_elements();
+      const Scalar* matrices[small_matrix::kSmallMatrixLanes];
+      const Scalar* rhss[small_matrix::kSmallMatrixLanes];
+      Scalar* solutions[small_matrix::kSmallMatrixLanes];
+      for (int i = 0; i < num_matrices; ++i) {
+        matrices[i] = inputs[0] + i * size;
+        rhss[i] = inputs[1] + i * rhs_size;
+        solutions[i] = outputs[0] + i * rhs_size;
+      }
+      // Matrices with a zero pivot are left to ComputeMatrix, which reports
+      // the error.
+      switch (input_matrix_shapes[0].dim_size(0)) {
+#define SOLVE_BATCH(N)                                                       \
+  case N:                                                                    \
+    small_matrix::SolveBatch<Scalar, N>(matrices, rhss, solutions,           \
+                                        num_matrices, num_rhss, adjoint_,    \
+                                        done);                               \
+    break;
+        SOLVE_BATCH(1);
+        SOLVE_BATCH(2);
+        SOLVE_BATCH(3);
+        SOLVE_BATCH(4);
+#undef SOLVE_BATCH
+      }
+    }
+  }
+
   void ComputeMatrix(OpKernelContext* context, const ConstMatrixMaps& inputs,
                      MatrixMaps* outputs) final {
     const ConstMatrixMap& matrix = inputs[0];
@@ -0,0 +1,233 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_KERNELS_LINALG_SMALL_MATRIX_BATCH_H_
+#define TENSORFLOW_CORE_KERNELS_LINALG_SMALL_MATRIX_BATCH_H_
+
+// Kernels for batches of small matrices of a compile-time order N. A group of
+// kSmallMatrixLanes matrices is transposed into a structure-of-arrays layout,
+// where element (i, j) of all matrices of the group is contiguous, so that
+// every scalar step of the factorization is one SIMD operation across the
+// group and the loops over the matrix dimensions are fully unrolled.
+
+#include <cmath>
+#include <cstdint>
+
+namespace tensorflow {
+namespace small_matrix {
+
+// Number of matrices processed together, one per SIMD lane.
+constexpr int kSmallMatrixLanes = 8;
+// Largest matrix order with a specialized kernel.
+constexpr int kMaxSmallMatrixOrder = 4;
+
+// LU decomposition with partial pivoting, as in Eigen::PartialPivLU, of a
+// group of N x N matrices.
+template <typename Scalar, int N>
+class LuBatch {
+ public:
+  static constexpr int kLanes = kSmallMatrixLanes;
+
+  // Factors the row-major matrices `matrices[0..count)`, or their transposes
+  // if `transpose` is true. Lanes past `count` are set to identity matrices.
+  // Returns per lane in `ok` whether all pivots are finite and non-zero; the
+  // results of the other lanes must not be used.
+  void Factor(const Scalar* const* matrices, int count, bool transpose,
+              bool ok[kLanes]) {
+    for (int i = 0; i < N; ++i) {
+      for (int j = 0; j < N; ++j) {
+        for (int l = 0; l < kLanes; ++l) {
+          lu_[i][j][l] = l < count
+                             ? matrices[l][transpose ? j * N + i : i * N + j]
+                             : static_cast<Scalar>(i == j ? 1 : 0);
+        }
+      }
+    }
+    for (int l = 0; l < kLanes; ++l) ok[l] = true;
+
+    for (int k = 0; k < N; ++k) {
+      // Select the row with the largest magnitude in column k, the first one
+      // on ties.
+      Scalar best[kLanes];
+      for (int l = 0; l < kLanes; ++l) {
+        best[l] = std::abs(lu_[k][k][l]);
+        pivots_[k][l] = k;
+      }
+      for (int i = k + 1; i < N; ++i) {
+        for (int l = 0; l < kLanes; ++l) {
+          const Scalar value = std::abs(lu_[i][k][l]);
+          const bool larger = value > best[l];
+          best[l] = larger ? value : best[l];
+          pivots_[k][l] = larger ? i : pivots_[k][l];
+        }
+      }
+      for (int l = 0; l < kLanes; ++l) {
+        ok[l] = ok[l] && best[l] > Scalar(0) && std::isfinite(best[l]);
+      }
+      // Swap row k with the pivot row in every lane.
+      for (int i = k + 1; i < N; ++i) {
+        for (int j = 0; j < N; ++j) {
+          for (int l = 0; l < kLanes; ++l) {
+            const bool swap = pivots_[k][l] == i;
+            const Scalar pivot_row = lu_[i][j][l];
+            lu_[i][j][l] = swap ? lu_[k][j][l] : pivot_row;
+            lu_[k][j][l] = swap ? pivot_row : lu_[k][j][l];
+          }
+        }
+      }
+      // Eliminate column k below the diagonal.
+      for (int i = k + 1; i < N; ++i) {
+        for (int l = 0; l < kLanes; ++l) {
+          const Scalar factor = lu_[i][k][l] / lu_[k][k][l];
+          lu_[i][k][l] = factor;
+          for (int j = k + 1; j < N; ++j) {
+            lu_[i][j][l] -= factor * lu_[k][j][l];
+          }
+        }
+      }
+    }
+  }
+
+  // Overwrites the right-hand side column `x` of every lane with the solution
+  // of A * x = b, where A is the factored matrix of the lane.
+  void SolveColumn(Scalar x[N][kLanes]) const {
+    for (int k = 0; k < N; ++k) {
+      for (int i = k + 1; i < N; ++i) {
+        for (int l = 0; l < kLanes; ++l) {
+          const bool swap = pivots_[k][l] == i;
+          const Scalar pivot_row = x[i][l];
+          x[i][l] = swap ? x[k][l] : pivot_row;
+          x[k][l] = swap ? pivot_row : x[k][l];
+        }
+      }
+    }
+    for (int i = 1; i < N; ++i) {
+      for (int k = 0; k < i; ++k) {
+        for (int l = 0; l < kLanes; ++l) x[i][l] -= lu_[i][k][l] * x[k][l];
+      }
+    }
+    for (int i = N - 1; i >= 0; --i) {
+      for (int k = i + 1; k < N; ++k) {
+        for (int l = 0; l < kLanes; ++l) x[i][l] -= lu_[i][k][l] * x[k][l];
+      }
+      for (int l = 0; l < kLanes; ++l) x[i][l] /= lu_[i][i][l];
+    }
+  }
+
+ private:
+  Scalar lu_[N][N][kLanes];
+  int pivots_[N][kLanes];
+};
+
+// Computes the inverses of the row-major N x N matrices `matrices[0..count)`,
+// or of their transposes if `adjoint` is true, into `inverses`. Sets `ok` as
+// LuBatch::Factor; the inverses of the other lanes are not written.
+template <typename Scalar, int N>
+void InverseBatch(const Scalar* const* matrices, Scalar* const* inverses,
+                  int count, bool adjoint, bool ok[kSmallMatrixLanes]) {
+  constexpr int kLanes = kSmallMatrixLanes;
+  LuBatch<Scalar, N> lu;
+  lu.Factor(matrices, count, adjoint, ok);
+  for (int c = 0; c < N; ++c) {
+    Scalar x[N][kLanes];
+    for (int i = 0; i < N; ++i) {
+      for (int l = 0; l < kLanes; ++l) x[i][l] = static_cast<Scalar>(i == c);
+    }
+    lu.SolveColumn(x);
+    for (int l = 0; l < count; ++l) {
+      if (!ok[l]) continue;
+      for (int i = 0; i < N; ++i) inverses[l][i * N + c] = x[i][l];
+    }
+  }
+}
+
+// Solves A * X = B for the row-major N x N matrices `matrices[0..count)`, or
+// their transposes if `adjoint` is true, and the row-major N x num_rhss
+// matrices `rhss`, into `solutions`. The solutions must not alias the inputs.
+// Sets `ok` as LuBatch::Factor; the solutions of the other lanes are not
+// written.
+template <typename Scalar, int N>
+void SolveBatch(const Scalar* const* matrices, const Scalar* const* rhss,
+                Scalar* const* solutions, int count, int64_t num_rhss,
+                bool adjoint, bool ok[kSmallMatrixLanes]) {
+  constexpr int kLanes = kSmallMatrixLanes;
+  LuBatch<Scalar, N> lu;
+  lu.Factor(matrices, count, adjoint, ok);
+  for (int64_t c = 0; c < num_rhss; ++c) {
+    Scalar x[N][kLanes];
+    for (int i = 0; i < N; ++i) {
+      for (int l = 0; l < kLanes; ++l) {
+        x[i][l] = l < count ? rhss[l][i * num_rhss + c] : Scalar(0);
+      }
+    }
+    lu.SolveColumn(x);
+    for (int l = 0; l < count; ++l) {
+      if (!ok[l]) continue;
+      for (int i = 0; i < N; ++i) solutions[l][i * num_rhss + c] = x[i][l];
+    }
+  }
+}
+
+// Computes the lower triangular Cholesky factors, as in Eigen::LLT, of the
+// row-major N x N matrices `matrices[0..count)` into `factors`, with zeros
+// above the diagonal. Only the lower triangle of the inputs is read, and the
+// factors may alias the inputs. Returns per lane in `ok` whether the matrix was
+// found to be positive definite; the factors of the other lanes are not
+// written.
+template <typename Scalar, int N>
+void CholeskyBatch(const Scalar* const* matrices, Scalar* const* factors,
+                   int count, bool ok[kSmallMatrixLanes]) {
+  constexpr int kLanes = kSmallMatrixLanes;
+  Scalar a[N][N][kLanes];
+  for (int i = 0; i < N; ++i) {
+    for (int j = 0; j <= i; ++j) {
+      for (int l = 0; l < kLanes; ++l) {
+        a[i][j][l] = l < count ? matrices[l][i * N + j]
+                               : static_cast<Scalar>(i == j ? 1 : 0);
+      }
+    }
+  }
+  for (int l = 0; l < kLanes; ++l) ok[l] = true;
+
+  for (int j = 0; j < N; ++j) {
+    for (int l = 0; l < kLanes; ++l) {
+      Scalar diagonal = a[j][j][l];
+      for (int k = 0; k < j; ++k) diagonal -= a[j][k][l] * a[j][k][l];
+      ok[l] = ok[l] && diagonal > Scalar(0) && std::isfinite(diagonal);
+      a[j][j][l] = std::sqrt(diagonal);
+    }
+    for (int i = j + 1; i < N; ++i) {
+      for (int l = 0; l < kLanes; ++l) {
+        Scalar value = a[i][j][l];
+        for (int k = 0; k < j; ++k) value -= a[i][k][l] * a[j][k][l];
+        a[i][j][l] = value / a[j][j][l];
+      }
+    }
+  }
+
+  for (int l = 0; l < count; ++l) {
+    if (!ok[l]) continue;
+    for (int i = 0; i < N; ++i) {
+      for (int j = 0; j < N; ++j) {
+        factors[l][i * N + j] = j <= i ? a[i][j][l] : Scalar(0);
+      }
+    }
+  }
+}
+
+}  // namespace small_matrix
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_KERNELS_LINALG_SMALL_MATRIX_BATCH_H_
@@ -0,0 +1,185 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/kernels/linalg/small_matrix_batch.h"
+
+#include <random>
+#include <vector>
+
+#include "Eigen/Cholesky"  // from @eigen_archive
+#include "Eigen/Core"  // from @eigen_archive
+#include "Eigen/LU"  // from @eigen_archive
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace small_matrix {
+namespace {
+
+template <int N>
+using Matrix = Eigen::Matrix<double, N, N, Eigen::RowMajor>;
+
+template <int N>
+std::vector<Matrix<N>> RandomMatrices(int count, bool positive_definite) {
+  std::mt19937 rng(count * 10 + N);
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  std::vector<Matrix<N>> matrices(count);
+  for (auto& matrix : matrices) {
+    for (int i = 0; i < N * N; ++i) matrix.data()[i] = dist(rng);
+    if (positive_definite) {
+      matrix = matrix * matrix.transpose() + Matrix<N>::Identity();
+    }
+  }
+  return matrices;
+}
+
+template <int N>
+void TestInverse(int count, bool adjoint) {
+  std::vector<Matrix<N>> matrices = RandomMatrices<N>(count, false);
+  std::vector<Matrix<N>> inverses(count);
+  const double* in[kSmallMatrixLanes];
+  double* out[kSmallMatrixLanes];
+  for (int l = 0; l < count; ++l) {
+    in[l] = matrices[l].data();
+    out[l] = inverses[l].data();
+  }
+  bool ok[kSmallMatrixLanes];
+  InverseBatch<double, N>(in, out, count, adjoint, ok);
+  for (int l = 0; l < count; ++l) {
+    ASSERT_TRUE(ok[l]);
+    const Matrix<N> lhs =
+        adjoint ? Matrix<N>(matrices[l].transpose()) : matrices[l];
+    const Matrix<N> expected = lhs.inverse();
+    EXPECT_TRUE(inverses[l].isApprox(expected, 1e-9))
+        << "N=" << N << " lane=" << l << "\n"
+        << inverses[l] << "\nvs\n"
+        << expected;
+  }
+}
+
+template <int N>
+void TestSolve(int count, bool adjoint) {
+  constexpr int kNumRhss = 3;
+  using Rhs = Eigen::Matrix<double, N, kNumRhss, Eigen::RowMajor>;
+  std::vector<Matrix<N>> matrices = RandomMatrices<N>(count, false);
+  std::vector<Rhs> rhss(count, Rhs::Random());
+  std::vector<Rhs> solutions(count);
+  const double* a[kSmallMatrixLanes];
+  const double* b[kSmallMatrixLanes];
+  double* x[kSmallMatrixLanes];
+  for (int l = 0; l < count; ++l) {
+    a[l] = matrices[l].data();
+    b[l] = rhss[l].data();
+    x[l] = solutions[l].data();
+  }
+  bool ok[kSmallMatrixLanes];
+  SolveBatch<double, N>(a, b, x, count, kNumRhss, adjoint, ok);
+  for (int l = 0; l < count; ++l) {
+    ASSERT_TRUE(ok[l]);
+    const Matrix<N> lhs =
+        adjoint ? Matrix<N>(matrices[l].transpose()) : matrices[l];
+    const Rhs expected = lhs.partialPivLu().solve(rhss[l]);
+    EXPECT_TRUE(solutions[l].isApprox(expected, 1e-9))
+        << "N=" << N << " lane=" << l;
+  }
+}
+
+template <int N>
+void TestCholesky(int count) {
+  std::vector<Matrix<N>> matrices = RandomMatrices<N>(count, true);
+  // Garbage in the upper triangle must not be read.
+  for (auto& matrix : matrices) {
+    matrix.template triangularView<Eigen::StrictlyUpper>().setConstant(7.0);
+  }
+  const double* in[kSmallMatrixLanes];
+  double* out[kSmallMatrixLanes];
+  for (int l = 0; l < count; ++l) {
+    in[l] = matrices[l].data();
+    out[l] = matrices[l].data();  // In place.
+  }
+  const std::vector<Matrix<N>> original = matrices;
+  bool ok[kSmallMatrixLanes];
+  CholeskyBatch<double, N>(in, out, count, ok);
+  for (int l = 0; l < count; ++l) {
+    ASSERT_TRUE(ok[l]);
+    const Matrix<N> expected = Eigen::LLT<Matrix<N>>(original[l]).matrixL();
+    EXPECT_TRUE(matrices[l].isApprox(expected, 1e-9))
+        << "N=" << N << " lane=" << l;
+  }
+}
+
+TEST(SmallMatrixBatchTest, Inverse) {
+  for (int count : {1, 5, kSmallMatrixLanes}) {
+    for (bool adjoint : {false, true}) {
+      TestInverse<1>(count, adjoint);
+      TestInverse<2>(count, adjoint);
+      TestInverse<3>(count, adjoint);
+      TestInverse<4>(count, adjoint);
+    }
+  }
+}
+
+TEST(SmallMatrixBatchTest, Solve) {
+  for (int count : {1, 5, kSmallMatrixLanes}) {
+    for (bool adjoint : {false, true}) {
+      TestSolve<1>(count, adjoint);
+      TestSolve<2>(count, adjoint);
+      TestSolve<3>(count, adjoint);
+      TestSolve<4>(count, adjoint);
+    }
+  }
+}
+
+TEST(SmallMatrixBatchTest, Cholesky) {
+  for (int count : {1, 5, kSmallMatrixLanes}) {
+    TestCholesky<1>(count);
+    TestCholesky<2>(count);
+    TestCholesky<3>(count);
+    TestCholesky<4>(count);
+  }
+}
+
+TEST(SmallMatrixBatchTest, FailedLanesAreNotWritten) {
+  // The second matrix is singular, the third one is not positive definite.
+  Matrix<2> matrices[3];
+  matrices[0] << 2, 1, 1, 2;
+  matrices[1] << 1, 2, 2, 4;
+  matrices[2] << -1, 0, 0, 1;
+  const double* in[kSmallMatrixLanes];
+  double* out[kSmallMatrixLanes];
+  Matrix<2> results[3];
+  for (int l = 0; l < 3; ++l) {
+    in[l] = matrices[l].data();
+    results[l].setConstant(-5.0);
+    out[l] = results[l].data();
+  }
+
+  bool ok[kSmallMatrixLanes];
+  InverseBatch<double, 2>(in, out, 3, /*adjoint=*/false, ok);
+  EXPECT_TRUE(ok[0]);
+  EXPECT_FALSE(ok[1]);
+  EXPECT_TRUE(ok[2]);
+  EXPECT_TRUE(results[1].isApprox(Matrix<2>::Constant(-5.0)));
+
+  results[2].setConstant(-5.0);
+  CholeskyBatch<double, 2>(in, out, 3, ok);
+  EXPECT_TRUE(ok[0]);
+  EXPECT_FALSE(ok[1]);
+  EXPECT_FALSE(ok[2]);
+  EXPECT_TRUE(results[2].isApprox(Matrix<2>::Constant(-5.0)));
+}
+
+}  // namespace
+}  // namespace small_matrix
+}  // namespace tensorflow
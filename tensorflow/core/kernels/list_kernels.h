@@ -22,6 +22,7 @@ limitations under the License.
 
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/ops_util.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_types.h"
@@ -163,6 +164,33 @@ void ConcatPluggableDevice(
 #endif  // PLUGGABLE_DEVICE_SUPPORTED
 }
 
+// Returns true if the elements of `l` are, in order, views of consecutive rows
+// of `l.buffer()` with shape `element_shape`, i.e. the buffer already holds the
+// stacked list.
+inline bool IsStackedBufferView(const TensorList& l,
+                                const TensorShape& element_shape) {
+  const Tensor& buffer = l.buffer();
+  if (buffer.dtype() != l.element_dtype ||
+      !DataTypeCanUseMemcpy(buffer.dtype()) || buffer.dims() == 0 ||
+      buffer.dim_size(0) != l.tensors().size() ||
+      buffer.NumElements() == 0) {
+    return false;
+  }
+  TensorShape buffer_element_shape = buffer.shape();
+  buffer_element_shape.RemoveDim(0);
+  if (buffer_element_shape != element_shape) return false;
+  const char* row = buffer.tensor_data().data();
+  const int64_t row_bytes = buffer.TotalBytes() / buffer.dim_size(0);
+  for (const Tensor& t : l.tensors()) {
+    if (t.dtype() != buffer.dtype() || t.shape() != element_shape ||
+        !t.SharesBufferWith(buffer) || t.tensor_data().data() != row) {
+      return false;
+    }
+    row += row_bytes;
+  }
+  return true;
+}
+
 template <typename Device, typename T>
 class TensorListStack : public OpKernel {
  public:
@@ -219,6 +247,12 @@ class TensorListStack : public OpKernel {
                     "Tried to stack list which only contains uninitialized ",
                     "tensors and has a non-fully-defined element_shape: ",
                     partial_element_shape.DebugString()));
+    // A list that is still an unmodified view of a contiguous buffer, e.g. the
+    // result of TensorListFromTensor, is stacked by returning the buffer.
+    if (IsStackedBufferView(*tensor_list, element_shape)) {
+      c->set_output(0, tensor_list->buffer());
+      return;
+    }
     TensorShape output_shape = element_shape;
     output_shape.InsertDim(0, tensor_list->tensors().size());
     Tensor* output;
@@ -804,6 +838,20 @@ class TensorListFromTensor : public OpKernel {
     output_list.element_shape = element_shape;
     output_list.tensors().reserve(t.shape().dim_size(0));
 
+    // When every row of `t` is aligned the elements can share its buffer, as
+    // in Unpack, which also lets TensorListStack return `t` unchanged.
+    if (IsInnerDimsSizeAligned<T>(t.shape())) {
+      for (int i = 0; i < t.shape().dim_size(0); ++i) {
+        Tensor element;
+        OP_REQUIRES(c, element.CopyFrom(t.Slice(i, i + 1), output_shape),
+                    errors::Unknown("Unexpected shape error."));
+        output_list.tensors().push_back(std::move(element));
+      }
+      output_list.set_buffer(t);
+      output_tensor->scalar<Variant>()() = std::move(output_list);
+      return;
+    }
+
     const auto copy_tensor = IsPluggableDevice(c)
                                  ? &CopyTensorPluggableDevice<T>
                                  : &CopyTensor<Device, T>;
@@ -831,6 +879,7 @@ absl::Status Scatter(OpKernelContext* c, const Tensor& value,
                      const Tensor& indices, TensorList* list) {
   const auto copy_tensor = IsPluggableDevice(c) ? &CopyTensorPluggableDevice<T>
                                                 : &CopyTensor<Device, T>;
+  const bool aligned_rows = IsInnerDimsSizeAligned<T>(value.shape());
   for (int index = 0; index < indices.NumElements(); ++index) {
     const int i = indices.flat<int32>()(index);
     Tensor tmp = value.Slice(index, index + 1);
@@ -839,6 +888,11 @@ absl::Status Scatter(OpKernelContext* c, const Tensor& value,
     if (!tmp.CopyFrom(tmp, tmp_shape)) {
       return errors::Unknown("Unexpected shape error.");
     }
+    if (aligned_rows) {
+      // Aligned rows can be stored as views of `value` without a copy.
+      list->tensors()[i] = std::move(tmp);
+      continue;
+    }
     // TODO(apassos) maybe not always align; but weird compiler bugs seem to
     // prevent this.
     Tensor aligned;
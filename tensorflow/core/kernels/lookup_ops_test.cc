@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/shape_inference_testutil.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/kernels/lookup_table_op.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
@@ -100,5 +101,62 @@ TEST_F(LookupOpsTest, AnonymousHashTable_RefCounting) {
   EXPECT_FALSE(alive);
 }
 
+class ShardedMutableDenseHashTableTest : public OpsTestBase {
+ protected:
+  absl::Status CreateTable(int64_t num_shards,
+                           core::RefCountPtr<lookup::LookupInterface>* table) {
+    TF_RETURN_IF_ERROR(
+        NodeDefBuilder("table", "ShardedMutableDenseHashTable")
+            .Input(FakeInput(DT_INT64))
+            .Input(FakeInput(DT_INT64))
+            .Attr("value_dtype", DT_INT64)
+            .Attr("initial_num_buckets", 16)
+            .Attr("num_shards", num_shards)
+            .Finalize(node_def()));
+    TF_RETURN_IF_ERROR(InitOp());
+    AddInputFromArray<int64_t>(TensorShape({}), {-1});
+    AddInputFromArray<int64_t>(TensorShape({}), {-2});
+    TF_RETURN_IF_ERROR(RunOpKernel());
+    return LookupResource(context_.get(),
+                          GetOutput(0)->scalar<ResourceHandle>()(), table);
+  }
+};
+
+TEST_F(ShardedMutableDenseHashTableTest, InsertFindRemove) {
+  core::RefCountPtr<lookup::LookupInterface> table;
+  TF_ASSERT_OK(CreateTable(4, &table));
+
+  // Insert enough keys to grow the initial 4 buckets of every shard.
+  const int64_t num_keys = 1000;
+  Tensor keys(DT_INT64, TensorShape({num_keys}));
+  Tensor values(DT_INT64, TensorShape({num_keys}));
+  for (int64_t i = 0; i < num_keys; ++i) {
+    keys.vec<int64_t>()(i) = i;
+    values.vec<int64_t>()(i) = 10 * i;
+  }
+  TF_ASSERT_OK(table->Insert(context_.get(), keys, values));
+  EXPECT_EQ(num_keys, table->size());
+
+  TF_ASSERT_OK(table->Remove(context_.get(), test::AsTensor<int64_t>({3, 7})));
+  EXPECT_EQ(num_keys - 2, table->size());
+
+  const Tensor find_keys = test::AsTensor<int64_t>({0, 3, 999, 1000, 7, 42});
+  Tensor found(DT_INT64, TensorShape({6}));
+  TF_ASSERT_OK(table->Find(context_.get(), find_keys, &found,
+                           test::AsScalar<int64_t>(-5)));
+  test::ExpectTensorEqual<int64_t>(
+      test::AsTensor<int64_t>({0, -5, 9990, -5, -5, 420}), found);
+
+  EXPECT_FALSE(
+      table->Insert(context_.get(), test::AsTensor<int64_t>({1, -1}),
+                    test::AsTensor<int64_t>({1, 1}))
+          .ok());
+}
+
+TEST_F(ShardedMutableDenseHashTableTest, RejectsInvalidNumShards) {
+  core::RefCountPtr<lookup::LookupInterface> table;
+  EXPECT_FALSE(CreateTable(3, &table).ok());
+}
+
 }  // namespace
 }  // namespace tensorflow
@@ -19,6 +19,7 @@ limitations under the License.
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/types.h"
@@ -431,7 +432,10 @@ TensorShape MaybeVectorizeShape(const TensorShape& shape) {
 template <class K, class V>
 class MutableDenseHashTable final : public LookupInterface {
  public:
-  MutableDenseHashTable(OpKernelContext* ctx, OpKernel* kernel) {
+  // `num_shards` is the number of tables the `initial_num_buckets` attr is
+  // split among, see ShardedMutableDenseHashTable.
+  MutableDenseHashTable(OpKernelContext* ctx, OpKernel* kernel,
+                        int64_t num_shards = 1) {
     OP_REQUIRES_OK(
         ctx, GetNodeAttr(kernel->def(), "max_load_factor", &max_load_factor_));
     OP_REQUIRES(ctx, max_load_factor_ > 0 && max_load_factor_ < 1,
@@ -488,7 +492,7 @@ class MutableDenseHashTable final : public LookupInterface {
     int64_t initial_num_buckets;
     OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "initial_num_buckets",
                                     &initial_num_buckets));
-    OP_REQUIRES_OK(ctx, AllocateBuckets(ctx, initial_num_buckets));
+    OP_REQUIRES_OK(ctx, AllocateBuckets(ctx, initial_num_buckets / num_shards));
   }
 
   size_t size() const override TF_LOCKS_EXCLUDED(mu_) {
@@ -636,6 +640,28 @@ class MutableDenseHashTable final : public LookupInterface {
     return absl::OkStatus();
   }
 
+  // Returns the key and value buckets, including the empty and deleted ones.
+  void GetBuckets(Tensor* keys, Tensor* values) const TF_LOCKS_EXCLUDED(mu_) {
+    tf_shared_lock l(mu_);
+    *keys = key_buckets_;
+    *values = value_buckets_;
+  }
+
+  // Replaces the contents of the table with the given keys and values. Unlike
+  // ImportValues, the keys don't need to be laid out as buckets of this
+  // table. Rows holding the empty or deleted key are skipped.
+  absl::Status Reinsert(OpKernelContext* ctx, const Tensor& keys,
+                        const Tensor& values) TF_LOCKS_EXCLUDED(mu_) {
+    mutex_lock l(mu_);
+    const int64_t num_keys = keys.dim_size(0);
+    int64_t new_num_buckets = 4;
+    while (num_keys > new_num_buckets * max_load_factor_) {
+      new_num_buckets <<= 1;
+    }
+    TF_RETURN_IF_ERROR(AllocateBuckets(ctx, new_num_buckets));
+    return DoInsert(ctx, keys, values, true);
+  }
+
   absl::Status CheckKeyAndValueTensorsForImport(const Tensor& keys,
                                                 const Tensor& values) override {
     TF_RETURN_IF_ERROR(CheckKeyAndValueTypes(keys, values));
@@ -881,6 +907,309 @@ class MutableDenseHashTable final : public LookupInterface {
   uint64 deleted_key_hash_;
 };
 
+namespace {
+
+// Copies the given rows of `src` into a new tensor of shape
+// [rows.size()] + row_shape.
+template <typename T>
+absl::Status GatherRows(OpKernelContext* ctx,
+                        typename TTypes<T>::ConstMatrix src,
+                        const std::vector<int64_t>& rows,
+                        const TensorShape& row_shape, Tensor* out) {
+  TensorShape shape({static_cast<int64_t>(rows.size())});
+  shape.AppendShape(row_shape);
+  TF_RETURN_IF_ERROR(ctx->allocate_temp(DataTypeToEnum<T>::v(), shape, out));
+  const int64_t row_size = src.dimension(1);
+  auto dst = out->shaped<T, 2>({static_cast<int64_t>(rows.size()), row_size});
+  for (size_t i = 0; i < rows.size(); ++i) {
+    for (int64_t j = 0; j < row_size; ++j) {
+      dst(i, j) = src(rows[i], j);
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+// A MutableDenseHashTable split by key hash into shards that are locked
+// independently. Concurrent lookups and inserts only contend when they touch
+// the same shard, and a shard that grows only blocks the keys it holds rather
+// than the whole table.
+template <class K, class V>
+class ShardedMutableDenseHashTable final : public LookupInterface {
+ public:
+  ShardedMutableDenseHashTable(OpKernelContext* ctx, OpKernel* kernel) {
+    int64_t num_shards;
+    OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "num_shards", &num_shards));
+    OP_REQUIRES(
+        ctx, num_shards >= 1 && (num_shards & (num_shards - 1)) == 0,
+        errors::InvalidArgument("num_shards must be a power of 2, got: ",
+                                num_shards));
+    int64_t initial_num_buckets;
+    OP_REQUIRES_OK(ctx, GetNodeAttr(kernel->def(), "initial_num_buckets",
+                                    &initial_num_buckets));
+    OP_REQUIRES(ctx, initial_num_buckets >= 4 * num_shards,
+                errors::InvalidArgument("initial_num_buckets must be at "
+                                        "least 4 * num_shards, got: ",
+                                        initial_num_buckets, " and ",
+                                        num_shards));
+    while ((int64_t{1} << shard_bits_) < num_shards) {
+      ++shard_bits_;
+    }
+
+    shards_.reserve(num_shards);
+    for (int64_t i = 0; i < num_shards; ++i) {
+      shards_.emplace_back(
+          new MutableDenseHashTable<K, V>(ctx, kernel, num_shards));
+      if (!ctx->status().ok()) return;
+    }
+    key_shape_ = shards_[0]->key_shape();
+    value_shape_ = shards_[0]->value_shape();
+
+    const Tensor* empty_key_input;
+    OP_REQUIRES_OK(ctx, ctx->input("empty_key", &empty_key_input));
+    empty_key_ = *empty_key_input;
+    const Tensor* deleted_key_input;
+    OP_REQUIRES_OK(ctx, ctx->input("deleted_key", &deleted_key_input));
+    deleted_key_ = *deleted_key_input;
+  }
+
+  size_t size() const override {
+    size_t result = 0;
+    for (const auto& shard : shards_) {
+      result += shard->size();
+    }
+    return result;
+  }
+
+  absl::Status Find(OpKernelContext* ctx, const Tensor& key, Tensor* value,
+                    const Tensor& default_value) override {
+    if (shards_.size() == 1) {
+      return shards_[0]->Find(ctx, key, value, default_value);
+    }
+    const int64_t num_elements = (key.dims() == 0) ? 1 : key.dim_size(0);
+    TF_RETURN_IF_ERROR(CheckKeyRows(key, num_elements));
+    const int64_t value_size = value_shape_.num_elements();
+    const auto key_matrix =
+        key.shaped<K, 2>({num_elements, key_shape_.num_elements()});
+    auto value_matrix = value->shaped<V, 2>({num_elements, value_size});
+
+    const std::vector<std::vector<int64_t>> partitions =
+        PartitionKeys(key_matrix);
+    for (size_t s = 0; s < shards_.size(); ++s) {
+      const std::vector<int64_t>& rows = partitions[s];
+      if (rows.empty()) continue;
+      Tensor shard_keys;
+      TF_RETURN_IF_ERROR(
+          GatherRows<K>(ctx, key_matrix, rows, key_shape_, &shard_keys));
+      TensorShape shard_value_shape({static_cast<int64_t>(rows.size())});
+      shard_value_shape.AppendShape(value_shape_);
+      Tensor shard_values;
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_temp(value_dtype(), shard_value_shape, &shard_values));
+      TF_RETURN_IF_ERROR(
+          shards_[s]->Find(ctx, shard_keys, &shard_values, default_value));
+      const auto shard_value_matrix = shard_values.shaped<V, 2>(
+          {static_cast<int64_t>(rows.size()), value_size});
+      for (size_t i = 0; i < rows.size(); ++i) {
+        for (int64_t j = 0; j < value_size; ++j) {
+          value_matrix(rows[i], j) = shard_value_matrix(i, j);
+        }
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status Insert(OpKernelContext* ctx, const Tensor& key,
+                      const Tensor& value) override {
+    if (shards_.size() == 1) {
+      return shards_[0]->Insert(ctx, key, value);
+    }
+    const int64_t batch_size = (key.dims() == 0) ? 1 : key.dim_size(0);
+    TF_RETURN_IF_ERROR(CheckKeyRows(key, batch_size));
+    const auto key_matrix =
+        key.shaped<K, 2>({batch_size, key_shape_.num_elements()});
+    const auto value_matrix =
+        value.shaped<V, 2>({batch_size, value_shape_.num_elements()});
+    return InsertPartitioned(ctx, key_matrix, value_matrix,
+                             PartitionKeys(key_matrix), /*reinsert=*/false);
+  }
+
+  absl::Status Remove(OpKernelContext* ctx, const Tensor& key) override {
+    if (shards_.size() == 1) {
+      return shards_[0]->Remove(ctx, key);
+    }
+    const int64_t num_elements = key.dim_size(0);
+    TF_RETURN_IF_ERROR(CheckKeyRows(key, num_elements));
+    const auto key_matrix =
+        key.shaped<K, 2>({num_elements, key_shape_.num_elements()});
+    const std::vector<std::vector<int64_t>> partitions =
+        PartitionKeys(key_matrix);
+    for (size_t s = 0; s < shards_.size(); ++s) {
+      if (partitions[s].empty()) continue;
+      Tensor shard_keys;
+      TF_RETURN_IF_ERROR(GatherRows<K>(ctx, key_matrix, partitions[s],
+                                       key_shape_, &shard_keys));
+      TF_RETURN_IF_ERROR(shards_[s]->Remove(ctx, shard_keys));
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status ImportValues(OpKernelContext* ctx, const Tensor& keys,
+                            const Tensor& values) override {
+    // The exported buckets of all shards are concatenated, so the keys are
+    // redistributed rather than imported as buckets.
+    const int64_t num_keys = keys.dim_size(0);
+    const int64_t key_size = key_shape_.num_elements();
+    const auto key_matrix = keys.shaped<K, 2>({num_keys, key_size});
+    const auto value_matrix =
+        values.shaped<V, 2>({num_keys, value_shape_.num_elements()});
+    const auto empty_key_matrix =
+        empty_key_.template shaped<K, 2>({1, key_size});
+    const auto deleted_key_matrix =
+        deleted_key_.template shaped<K, 2>({1, key_size});
+    std::vector<std::vector<int64_t>> partitions(shards_.size());
+    for (int64_t i = 0; i < num_keys; ++i) {
+      if (IsEqualKey(key_matrix, i, empty_key_matrix) ||
+          IsEqualKey(key_matrix, i, deleted_key_matrix)) {
+        continue;
+      }
+      partitions[ShardIndex(key_matrix, i)].push_back(i);
+    }
+    return InsertPartitioned(ctx, key_matrix, value_matrix, partitions,
+                             /*reinsert=*/true);
+  }
+
+  absl::Status ExportValues(OpKernelContext* ctx) override {
+    std::vector<Tensor> key_buckets(shards_.size());
+    std::vector<Tensor> value_buckets(shards_.size());
+    int64_t num_buckets = 0;
+    for (size_t s = 0; s < shards_.size(); ++s) {
+      shards_[s]->GetBuckets(&key_buckets[s], &value_buckets[s]);
+      num_buckets += key_buckets[s].dim_size(0);
+    }
+    const int64_t key_size = key_buckets[0].dim_size(1);
+    const int64_t value_size = value_buckets[0].dim_size(1);
+    Tensor* keys;
+    TF_RETURN_IF_ERROR(ctx->allocate_output(
+        "keys", TensorShape({num_buckets, key_size}), &keys));
+    Tensor* values;
+    TF_RETURN_IF_ERROR(ctx->allocate_output(
+        "values", TensorShape({num_buckets, value_size}), &values));
+    auto keys_matrix = keys->matrix<K>();
+    auto values_matrix = values->matrix<V>();
+    int64_t offset = 0;
+    for (size_t s = 0; s < shards_.size(); ++s) {
+      const auto shard_keys = key_buckets[s].matrix<K>();
+      const auto shard_values = value_buckets[s].matrix<V>();
+      for (int64_t i = 0; i < key_buckets[s].dim_size(0); ++i, ++offset) {
+        for (int64_t j = 0; j < key_size; ++j) {
+          keys_matrix(offset, j) = shard_keys(i, j);
+        }
+        for (int64_t j = 0; j < value_size; ++j) {
+          values_matrix(offset, j) = shard_values(i, j);
+        }
+      }
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status CheckKeyAndValueTensorsForImport(const Tensor& keys,
+                                                const Tensor& values) override {
+    return shards_[0]->CheckKeyAndValueTensorsForImport(keys, values);
+  }
+
+  DataType key_dtype() const override { return DataTypeToEnum<K>::v(); }
+
+  DataType value_dtype() const override { return DataTypeToEnum<V>::v(); }
+
+  TensorShape key_shape() const override { return key_shape_; }
+
+  TensorShape value_shape() const override { return value_shape_; }
+
+  int64_t MemoryUsed() const override {
+    int64_t result = sizeof(ShardedMutableDenseHashTable);
+    for (const auto& shard : shards_) {
+      result += shard->MemoryUsed();
+    }
+    return result;
+  }
+
+ private:
+  absl::Status CheckKeyRows(const Tensor& key, int64_t num_rows) const {
+    if (key.NumElements() != num_rows * key_shape_.num_elements()) {
+      TensorShape expected_shape({num_rows});
+      expected_shape.AppendShape(key_shape_);
+      return errors::InvalidArgument("Expected key shape ",
+                                     expected_shape.DebugString(), " got ",
+                                     key.shape().DebugString());
+    }
+    return absl::OkStatus();
+  }
+
+  // Shards take the high bits of a multiplicative hash, as the shards
+  // themselves pick buckets with the low bits of the key hash.
+  int64_t ShardIndex(typename TTypes<K>::ConstMatrix key, int64_t row) const {
+    if (shard_bits_ == 0) return 0;
+    uint64 hash = 0;
+    for (int64_t i = 0; i < key.dimension(1); ++i) {
+      hash = Hash64Combine(hash, HashScalar(key(row, i)));
+    }
+    return (hash * 0x9E3779B97F4A7C15ULL) >> (64 - shard_bits_);
+  }
+
+  std::vector<std::vector<int64_t>> PartitionKeys(
+      typename TTypes<K>::ConstMatrix key) const {
+    std::vector<std::vector<int64_t>> partitions(shards_.size());
+    for (int64_t i = 0; i < key.dimension(0); ++i) {
+      partitions[ShardIndex(key, i)].push_back(i);
+    }
+    return partitions;
+  }
+
+  // Inserts the rows of each partition into its shard. If `reinsert` is set,
+  // the previous contents of all shards are discarded first.
+  absl::Status InsertPartitioned(
+      OpKernelContext* ctx, typename TTypes<K>::ConstMatrix key,
+      typename TTypes<V>::ConstMatrix value,
+      const std::vector<std::vector<int64_t>>& partitions, bool reinsert) {
+    const TensorShape key_row_shape({key.dimension(1)});
+    const TensorShape value_row_shape({value.dimension(1)});
+    for (size_t s = 0; s < shards_.size(); ++s) {
+      const std::vector<int64_t>& rows = partitions[s];
+      if (rows.empty() && !reinsert) continue;
+      Tensor shard_keys;
+      TF_RETURN_IF_ERROR(
+          GatherRows<K>(ctx, key, rows, key_row_shape, &shard_keys));
+      Tensor shard_values;
+      TF_RETURN_IF_ERROR(
+          GatherRows<V>(ctx, value, rows, value_row_shape, &shard_values));
+      TF_RETURN_IF_ERROR(
+          reinsert ? shards_[s]->Reinsert(ctx, shard_keys, shard_values)
+                   : shards_[s]->Insert(ctx, shard_keys, shard_values));
+    }
+    return absl::OkStatus();
+  }
+
+  template <typename MT2>
+  bool IsEqualKey(typename TTypes<K>::ConstMatrix tensor1, int64_t index1,
+                  MT2 tensor2) const {
+    for (int64_t i = 0; i < tensor1.dimension(1); ++i) {
+      if (tensor1(index1, i) != tensor2(0, i)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  TensorShape key_shape_;
+  TensorShape value_shape_;
+  Tensor empty_key_;
+  Tensor deleted_key_;
+  int shard_bits_ = 0;
+  std::vector<core::RefCountPtr<MutableDenseHashTable<K, V>>> shards_;
+};
+
 }  // namespace lookup
 
 // Base class for kernels that take a LookupTable handle as the 0th input.
@@ -1247,4 +1576,33 @@ REGISTER_KERNEL(tstring, ResourceHandle);
 
 #undef REGISTER_KERNEL
 
+// Register the ShardedMutableDenseHashTable op.
+#define REGISTER_KERNEL(key_dtype, value_dtype)                                \
+  REGISTER_KERNEL_BUILDER(                                                     \
+      Name("ShardedMutableDenseHashTable")                                     \
+          .Device(DEVICE_CPU)                                                  \
+          .TypeConstraint<key_dtype>("key_dtype")                              \
+          .TypeConstraint<value_dtype>("value_dtype"),                         \
+      LookupTableOp<                                                           \
+          lookup::ShardedMutableDenseHashTable<key_dtype, value_dtype>,        \
+          key_dtype, value_dtype>)
+
+REGISTER_KERNEL(int32, double);
+REGISTER_KERNEL(int32, float);
+REGISTER_KERNEL(int32, int32);
+REGISTER_KERNEL(int64_t, bool);
+REGISTER_KERNEL(int64_t, double);
+REGISTER_KERNEL(int64_t, float);
+REGISTER_KERNEL(int64_t, int32);
+REGISTER_KERNEL(int64_t, int64_t);
+REGISTER_KERNEL(int64_t, Variant);
+REGISTER_KERNEL(tstring, bool);
+REGISTER_KERNEL(tstring, double);
+REGISTER_KERNEL(tstring, float);
+REGISTER_KERNEL(tstring, int32);
+REGISTER_KERNEL(tstring, int64_t);
+REGISTER_KERNEL(tstring, ResourceHandle);
+
+#undef REGISTER_KERNEL
+
 }  // namespace tensorflow
@@ -185,6 +185,7 @@ void OpsTestBase::CreateContext() {
   params_->function_library = pflr_->GetFLR(device_->name());
   params_->runner = GetDefaultRunner();
   params_->session_metadata = &session_metadata();
+  params_->session_config = session_config_.get();
 
   context_.reset(new OpKernelContext(params_.get()));
 }
@@ -159,6 +159,12 @@ class OpsTestBase : public ::testing::Test {
 
   const SessionMetadata& session_metadata() const { return session_metadata_; }
 
+  // Makes the kernel see "session_config" as its session's ConfigProto. By
+  // default kernels run without a session config.
+  void set_session_config(ConfigProto session_config) {
+    session_config_ = std::make_unique<ConfigProto>(std::move(session_config));
+  }
+
  protected:
   void CreateContext();
   Tensor* AddInput(DataType dtype, const TensorShape& shape);
@@ -201,6 +207,7 @@ class OpsTestBase : public ::testing::Test {
   std::unique_ptr<thread::ThreadPool> thread_pool_;
 
   SessionMetadata session_metadata_;
+  std::unique_ptr<ConfigProto> session_config_;
 
  private:
   OpsTestBase(const OpsTestBase&) = delete;
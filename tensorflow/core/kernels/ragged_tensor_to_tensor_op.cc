@@ -40,6 +40,7 @@ limitations under the License.
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/util/bcast.h"
 #include "tensorflow/core/util/ragged_to_dense_util.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -398,7 +399,14 @@ class RaggedTensorToTensorBaseOp : public OpKernel {
     OP_REQUIRES_OK(context,
                    context->allocate_output(0, output_shape, &output_tensor));
     const INDEX_TYPE full_size = multiplier[0] * output_size[0];
-    if (full_size > 0) {
+    if (full_size > 0 && ragged_rank_ == 1 &&
+        row_partition_types_[0] == RowPartitionType::ROW_SPLITS) {
+      // A single level of row splits, as produced by most text pipelines,
+      // maps each row to one contiguous output row, so no per-value output
+      // index is needed.
+      SetOutputFromRowSplits(context, GetRowPartitionTensor(context, 0),
+                             output_size[1], output_tensor);
+    } else if (full_size > 0) {
       vector<INDEX_TYPE> output_index, new_output_index;
       int nvals = context->input(kValueInputIndex).shape().dim_size(0);
       output_index.reserve(nvals);
@@ -421,6 +429,13 @@ class RaggedTensorToTensorBaseOp : public OpKernel {
                          const vector<INDEX_TYPE>& output_index,
                          Tensor* output_tensor) = 0;
 
+  // Copies the rows of a ragged tensor with `row_splits` into the rows of
+  // `output_tensor`, which have `output_width` elements.
+  virtual void SetOutputFromRowSplits(OpKernelContext* context,
+                                      const RowPartitionTensor& row_splits,
+                                      INDEX_TYPE output_width,
+                                      Tensor* output_tensor) = 0;
+
  private:
   vector<RowPartitionType> row_partition_types_;
   int ragged_rank_;
@@ -468,9 +483,107 @@ void copy_array<Eigen::half, int32>(Eigen::half* dst, const Eigen::half* src,
 template <typename VALUE_TYPE, typename INDEX_TYPE>
 class RaggedTensorToTensorOp : public RaggedTensorToTensorBaseOp<INDEX_TYPE> {
  public:
+  using RowPartitionTensor =
+      typename RaggedTensorToTensorBaseOp<INDEX_TYPE>::RowPartitionTensor;
+
   explicit RaggedTensorToTensorOp(OpKernelConstruction* context)
       : RaggedTensorToTensorBaseOp<INDEX_TYPE>(context) {}
 
+  // Broadcasts the default value to `element_shape`, using `bcast_default` for
+  // storage if needed.  (We can skip this if the default value has a single
+  // element, since we use std::fill when that's true.)
+  absl::Status BroadcastDefaultValue(OpKernelContext* context,
+                                     const TensorShape& element_shape,
+                                     Tensor* bcast_default,
+                                     const VALUE_TYPE** default_value) {
+    const auto& default_value_tensor = context->input(kDefaultValueInputIndex);
+    *default_value = default_value_tensor.flat<VALUE_TYPE>().data();
+    if (default_value_tensor.NumElements() != element_shape.num_elements() &&
+        default_value_tensor.NumElements() != 1) {
+      const auto& src_shape = default_value_tensor.shape();
+      BCast bcast(BCast::FromShape(src_shape), BCast::FromShape(element_shape),
+                  /*fewer_dims_optimization=*/true);
+      // Note: bcast should always be valid, since we rejected any incompatible
+      // shapes when we called ValidateDefaultValueShape().
+      if (!bcast.IsValid()) {
+        return errors::InvalidArgument("Error broadcasting default_value");
+      }
+      TF_RETURN_IF_ERROR(context->allocate_temp(default_value_tensor.dtype(),
+                                                element_shape, bcast_default));
+      const CPUDevice& device = context->eigen_device<CPUDevice>();
+      functor::BroadcastTo<CPUDevice, VALUE_TYPE>()(
+          device, context, *bcast_default, element_shape, default_value_tensor,
+          src_shape, bcast);
+      *default_value = bcast_default->flat<VALUE_TYPE>().data();
+    }
+    return absl::OkStatus();
+  }
+
+  void SetOutputFromRowSplits(OpKernelContext* context,
+                              const RowPartitionTensor& row_splits,
+                              INDEX_TYPE output_width,
+                              Tensor* output_tensor) override {
+    if (output_tensor->NumElements() == 0) return;
+
+    const auto& values_tensor = context->input(kValueInputIndex);
+    const int64_t num_values = values_tensor.dim_size(0);
+    const INDEX_TYPE num_rows = row_splits.size() - 1;
+    OP_REQUIRES(context, row_splits(0) == 0,
+                errors::InvalidArgument("Invalid row split size."));
+    for (INDEX_TYPE i = 0; i < num_rows; ++i) {
+      OP_REQUIRES(context, row_splits(i) <= row_splits(i + 1),
+                  errors::InvalidArgument("Invalid row split size."));
+    }
+    OP_REQUIRES(context, row_splits(num_rows) <= num_values,
+                errors::InvalidArgument("Row splits end at ",
+                                        row_splits(num_rows), " but there are ",
+                                        num_values, " values."));
+
+    TensorShape element_shape = output_tensor->shape();
+    element_shape.RemoveDimRange(0, 2);
+    const int64_t element_size = element_shape.num_elements();
+    const Tensor& default_value_tensor =
+        context->input(kDefaultValueInputIndex);
+    const VALUE_TYPE* default_value = nullptr;
+    Tensor bcast_default;
+    OP_REQUIRES_OK(context, BroadcastDefaultValue(context, element_shape,
+                                                  &bcast_default,
+                                                  &default_value));
+    const bool scalar_default = default_value_tensor.NumElements() == 1;
+
+    const VALUE_TYPE* values_base = values_tensor.flat<VALUE_TYPE>().data();
+    VALUE_TYPE* output_base = output_tensor->flat<VALUE_TYPE>().data();
+    const int64_t output_row_size = output_width * element_size;
+    const int64_t num_output_rows = output_tensor->dim_size(0);
+
+    // Each output row is one contiguous copy followed by the padding.
+    auto copy_rows = [&](int64_t begin, int64_t end) {
+      for (int64_t row = begin; row < end; ++row) {
+        VALUE_TYPE* dst = output_base + row * output_row_size;
+        int64_t row_length = 0;
+        if (row < num_rows) {
+          row_length = std::min<int64_t>(
+              row_splits(row + 1) - row_splits(row), output_width);
+          copy_array<VALUE_TYPE, INDEX_TYPE>(
+              dst, values_base + row_splits(row) * element_size,
+              row_length * element_size);
+        }
+        if (scalar_default) {
+          std::fill(dst + row_length * element_size, dst + output_row_size,
+                    *default_value);
+        } else {
+          for (int64_t j = row_length; j < output_width; ++j) {
+            copy_array<VALUE_TYPE, INDEX_TYPE>(dst + j * element_size,
+                                               default_value, element_size);
+          }
+        }
+      }
+    };
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          num_output_rows, output_row_size * sizeof(VALUE_TYPE), copy_rows);
+  }
+
   void SetOutput(OpKernelContext* context, int ragged_rank,
                  const vector<INDEX_TYPE>& output_index,
                  Tensor* output_tensor) override {
@@ -490,30 +603,11 @@ class RaggedTensorToTensorOp : public RaggedTensorToTensorBaseOp<INDEX_TYPE> {
     int value_element_size = element_shape.num_elements();
     size_t output_index_size = output_index.size();
 
-    // Broadcast the default value to value_element_size.  (We can skip this
-    // if default_value_tensor.NumElements() == 1, since we use std::fill
-    // when that's true.)
-    const VALUE_TYPE* default_value =
-        default_value_tensor.flat<VALUE_TYPE>().data();
+    const VALUE_TYPE* default_value = nullptr;
     Tensor bcast_default;  // Temporary tensor for result of broadcast
-    if (default_value_tensor.NumElements() != value_element_size &&
-        default_value_tensor.NumElements() != 1) {
-      const auto& src_shape = default_value_tensor.shape();
-      BCast bcast(BCast::FromShape(src_shape), BCast::FromShape(element_shape),
-                  /*fewer_dims_optimization=*/true);
-      // Note: bcast should always be valid, since we rejected any incompatible
-      // shapes when we called ValidateDefaultValueShape().
-      OP_REQUIRES(context, bcast.IsValid(),
-                  errors::InvalidArgument("Error broadcasting default_value"));
-      OP_REQUIRES_OK(context,
-                     context->allocate_temp(default_value_tensor.dtype(),
-                                            element_shape, &bcast_default));
-      const CPUDevice& device = context->eigen_device<CPUDevice>();
-      functor::BroadcastTo<CPUDevice, VALUE_TYPE>()(
-          device, context, bcast_default, element_shape, default_value_tensor,
-          src_shape, bcast);
-      default_value = bcast_default.flat<VALUE_TYPE>().data();
-    }
+    OP_REQUIRES_OK(context, BroadcastDefaultValue(context, element_shape,
+                                                  &bcast_default,
+                                                  &default_value));
 
     // Loop through the output_index vector, finding contiguous regions that
     // should be copied.  Once we find the end of a contiguous region, copy it
@@ -135,6 +135,84 @@ TEST_F(RaggedTensorToTensorOpTest, RaggedTensorToTensorRowSplits) {
       0.01);
 }
 
+TEST_F(RaggedTensorToTensorOpTest, RaggedTensorToTensorRowSplitsConstrained) {
+  // params = [[.1, .2, .3], [], [.4, .5, .6, .7], [.8, .9]]
+  // constrained to (5, 3)
+  BuildRaggedTensorToTensorGraph<float, int32>(
+      TensorShape({5, 3}),  // shape
+      {"ROW_SPLITS"},       // row_partition_types
+      createVector<float>({.1, .2, .3, .4, .5, .6, .7, .8, .9}),  // values
+      createScalar<float>(1.5),               // default_value
+      {createVector<int32>({0, 3, 3, 7, 9})}  // row_partition_tensors
+  );
+
+  TF_ASSERT_OK(RunOpKernel());
+
+  test::ExpectTensorNear<float>(*GetOutput(0),
+                                test::AsTensor<float>(
+                                    {
+                                        .1, .2, .3,     //
+                                        1.5, 1.5, 1.5,  //
+                                        .4, .5, .6,     //
+                                        .8, .9, 1.5,    //
+                                        1.5, 1.5, 1.5   //
+                                    },
+                                    TensorShape({5, 3})),
+                                0.01);
+}
+
+TEST_F(RaggedTensorToTensorOpTest, RaggedTensorToTensorRowSplitsDefaultVector) {
+  // params = [[[1, 2], [3, 4]], [], [[5, 6]]]
+  BuildRaggedTensorToTensorGraph<int64_t, int64_t>(
+      TensorShape({3, 2, 2}),  // shape
+      {"ROW_SPLITS"},          // row_partition_types
+      ShapeAndValues<int64_t>{TensorShape({3, 2}), {1, 2, 3, 4, 5, 6}},
+      createVector<int64_t>({-1, -2}),        // default_value
+      {createVector<int64_t>({0, 2, 2, 3})}  // row_partition_tensors
+  );
+
+  TF_ASSERT_OK(RunOpKernel());
+
+  test::ExpectTensorEqual<int64_t>(
+      *GetOutput(0), test::AsTensor<int64_t>({1, 2, 3, 4,      //
+                                              -1, -2, -1, -2,  //
+                                              5, 6, -1, -2},
+                                             TensorShape({3, 2, 2})));
+}
+
+TEST_F(RaggedTensorToTensorOpTest, RowSplitsNotStartingAtZero) {
+  BuildRaggedTensorToTensorGraph<float, int32>(
+      TensorShape({3, 4}),                    // shape
+      {"ROW_SPLITS"},                         // row_partition_types
+      createVector<float>({.1, .2, .3, .4}),  // values
+      createScalar<float>(1.5),               // default_value
+      {createVector<int32>({1, 3, 4})}        // row_partition_tensors
+  );
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+TEST_F(RaggedTensorToTensorOpTest, RowSplitsDecreasing) {
+  BuildRaggedTensorToTensorGraph<float, int32>(
+      TensorShape({3, 4}),                    // shape
+      {"ROW_SPLITS"},                         // row_partition_types
+      createVector<float>({.1, .2, .3, .4}),  // values
+      createScalar<float>(1.5),               // default_value
+      {createVector<int32>({0, 3, 2, 4})}     // row_partition_tensors
+  );
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+TEST_F(RaggedTensorToTensorOpTest, RowSplitsBeyondValues) {
+  BuildRaggedTensorToTensorGraph<float, int32>(
+      TensorShape({3, 4}),                    // shape
+      {"ROW_SPLITS"},                         // row_partition_types
+      createVector<float>({.1, .2, .3, .4}),  // values
+      createScalar<float>(1.5),               // default_value
+      {createVector<int32>({0, 3, 5})}        // row_partition_tensors
+  );
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
 TEST_F(RaggedTensorToTensorOpTest, RaggedTensorToTensor_3DParams) {
   // params = [
   //           [[]],
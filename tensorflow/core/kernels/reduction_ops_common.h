@@ -23,6 +23,9 @@ limitations under the License.
 
 #define EIGEN_USE_THREADS
 
+#include <algorithm>
+#include <type_traits>
+
 #include "Eigen/Core"  // from @eigen_archive
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/framework/numeric_op.h"
@@ -35,6 +38,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 
@@ -269,9 +273,202 @@ struct ReduceFunctorBase {
   }
 };
 
+// Reducers and scalar types that BlockedReduction handles. Their partial
+// results over blocks of the input are combined with PartialReducer::reduce,
+// and finalizing the partial results must not change them.
+template <typename Reducer>
+struct BlockedReducerTraits {
+  static constexpr bool kSupported = false;
+};
+
+template <typename T, typename Partial, bool IsMean = false>
+struct BlockedReducerTraitsImpl {
+  static constexpr bool kSupported =
+      std::is_same<T, float>::value || std::is_same<T, double>::value ||
+      (!IsMean &&
+       (std::is_same<T, int32>::value || std::is_same<T, int64_t>::value));
+  static constexpr bool kIsMean = IsMean;
+  using Scalar = T;
+  using PartialReducer = Partial;
+};
+
+template <typename T>
+struct BlockedReducerTraits<Eigen::internal::SumReducer<T>>
+    : BlockedReducerTraitsImpl<T, Eigen::internal::SumReducer<T>> {};
+template <typename T>
+struct BlockedReducerTraits<Eigen::internal::ProdReducer<T>>
+    : BlockedReducerTraitsImpl<T, Eigen::internal::ProdReducer<T>> {};
+template <typename T, int NaNPropagation>
+struct BlockedReducerTraits<Eigen::internal::MaxReducer<T, NaNPropagation>>
+    : BlockedReducerTraitsImpl<
+          T, Eigen::internal::MaxReducer<T, NaNPropagation>> {};
+template <typename T, int NaNPropagation>
+struct BlockedReducerTraits<Eigen::internal::MinReducer<T, NaNPropagation>>
+    : BlockedReducerTraitsImpl<
+          T, Eigen::internal::MinReducer<T, NaNPropagation>> {};
+// The mean is the blocked sum divided by the number of reduced elements,
+// which is not exact for integers, so these use the Eigen implementation.
+template <typename T>
+struct BlockedReducerTraits<MeanReducer<T>>
+    : BlockedReducerTraitsImpl<T, Eigen::internal::SumReducer<T>,
+                               /*IsMean=*/true> {};
+
+// Eigen parallelizes reductions over their outputs, so a matrix with only a
+// few outputs per thread, like a tall [1e8, 4] matrix reduced along its rows
+// or a wide [4, 1e8] matrix reduced along its columns, leaves most threads
+// idle. BlockedReduction splits the reduced dimension of such matrices into
+// cache-sized blocks instead, reduces the blocks in parallel into partial
+// results, and combines those pairwise.
+template <typename Reducer, typename Enable = void>
+struct BlockedReduction {
+  template <typename OUT_T, typename IN_T, typename ReductionAxes>
+  static bool Run(OpKernelContext* ctx, OUT_T out, IN_T in,
+                  const ReductionAxes& reduction_axes) {
+    return false;
+  }
+};
+
+template <typename Reducer>
+struct BlockedReduction<
+    Reducer, std::enable_if_t<BlockedReducerTraits<Reducer>::kSupported>> {
+  using Traits = BlockedReducerTraits<Reducer>;
+  using T = typename Traits::Scalar;
+  using PartialReducer = typename Traits::PartialReducer;
+
+  // Number of input elements reduced by one unit of work.
+  static constexpr int64_t kBlockSize = 1 << 15;
+  // Outputs per thread above which Eigen's reduction keeps all threads busy.
+  static constexpr int64_t kMaxOutputsPerThread = 4;
+
+  template <typename OUT_T, typename IN_T, typename ReductionAxes>
+  static bool Run(OpKernelContext* ctx, OUT_T out, IN_T in,
+                  const ReductionAxes& reduction_axes) {
+    return false;
+  }
+
+  // Reduces a tall and skinny [rows, cols] matrix along its rows.
+  static bool Run(OpKernelContext* ctx, typename TTypes<T>::Vec out,
+                  typename TTypes<T>::ConstMatrix in,
+                  const Eigen::IndexList<Eigen::type2index<0>>& rows_axis) {
+    const int64_t rows = in.dimension(0);
+    const int64_t cols = in.dimension(1);
+    if (!UseBlocks(ctx, /*num_outputs=*/cols, /*reduced_size=*/rows)) {
+      return false;
+    }
+    // Each block is a run of whole rows, so it is contiguous in memory.
+    const int64_t block_rows = std::max<int64_t>(1, kBlockSize / cols);
+    const int64_t num_blocks = (rows + block_rows - 1) / block_rows;
+    Tensor partials;
+    if (!ctx->allocate_temp(DataTypeToEnum<T>::value,
+                            TensorShape({num_blocks, cols}), &partials)
+             .ok()) {
+      return false;
+    }
+    T* partials_data = partials.flat<T>().data();
+
+    auto work = [&](int64_t begin, int64_t end) {
+      for (int64_t b = begin; b < end; ++b) {
+        const int64_t start = b * block_rows;
+        typename TTypes<T>::UnalignedConstMatrix block(
+            &in(start, 0), std::min(block_rows, rows - start), cols);
+        typename TTypes<T>::UnalignedVec partial(partials_data + b * cols,
+                                                 cols);
+        partial = block.reduce(rows_axis, PartialReducer());
+      }
+    };
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, num_blocks,
+          block_rows * cols, work);
+
+    Combine(num_blocks, /*partial_stride=*/cols, cols, /*output_stride=*/1,
+            rows, partials_data, out);
+    return true;
+  }
+
+  // Reduces a short and wide [rows, cols] matrix along its columns.
+  static bool Run(OpKernelContext* ctx, typename TTypes<T>::Vec out,
+                  typename TTypes<T>::ConstMatrix in,
+                  const Eigen::IndexList<Eigen::type2index<1>>& cols_axis) {
+    const int64_t rows = in.dimension(0);
+    const int64_t cols = in.dimension(1);
+    if (!UseBlocks(ctx, /*num_outputs=*/rows, /*reduced_size=*/cols)) {
+      return false;
+    }
+    const int64_t blocks_per_row = (cols + kBlockSize - 1) / kBlockSize;
+    Tensor partials;
+    if (!ctx->allocate_temp(DataTypeToEnum<T>::value,
+                            TensorShape({rows, blocks_per_row}), &partials)
+             .ok()) {
+      return false;
+    }
+    T* partials_data = partials.flat<T>().data();
+
+    auto work = [&](int64_t begin, int64_t end) {
+      const Eigen::IndexList<Eigen::type2index<0>> vec_axis;
+      for (int64_t i = begin; i < end; ++i) {
+        const int64_t row = i / blocks_per_row;
+        const int64_t start = (i % blocks_per_row) * kBlockSize;
+        typename TTypes<T>::UnalignedConstVec block(
+            &in(row, start), std::min(kBlockSize, cols - start));
+        typename TTypes<T>::UnalignedScalar partial(partials_data + i);
+        partial = block.reduce(vec_axis, PartialReducer());
+      }
+    };
+    auto worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers,
+          rows * blocks_per_row, kBlockSize, work);
+
+    Combine(blocks_per_row, /*partial_stride=*/1, rows,
+            /*output_stride=*/blocks_per_row, cols, partials_data, out);
+    return true;
+  }
+
+ private:
+  static bool UseBlocks(OpKernelContext* ctx, int64_t num_outputs,
+                        int64_t reduced_size) {
+    const int num_threads =
+        ctx->device()->tensorflow_cpu_worker_threads()->num_threads;
+    return num_threads > 1 &&
+           num_outputs < kMaxOutputsPerThread * num_threads &&
+           reduced_size >= kBlockSize &&
+           num_outputs * reduced_size >= 4 * kBlockSize;
+  }
+
+  // Combines the `num_partials` partial results of each output pairwise, so
+  // that rounding errors grow with the log of the number of partial results.
+  static void Combine(int64_t num_partials, int64_t partial_stride,
+                      int64_t num_outputs, int64_t output_stride,
+                      int64_t reduced_size, T* partials,
+                      typename TTypes<T>::Vec out) {
+    const PartialReducer reducer;
+    for (int64_t step = 1; step < num_partials; step *= 2) {
+      for (int64_t p = 0; p + step < num_partials; p += 2 * step) {
+        T* accum = partials + p * partial_stride;
+        const T* other = partials + (p + step) * partial_stride;
+        for (int64_t o = 0; o < num_outputs; ++o) {
+          reducer.reduce(other[o * output_stride], &accum[o * output_stride]);
+        }
+      }
+    }
+    for (int64_t o = 0; o < num_outputs; ++o) {
+      out(o) = partials[o * output_stride];
+      if (Traits::kIsMean) out(o) /= static_cast<T>(reduced_size);
+    }
+  }
+};
+
 template <typename Reducer>
 struct ReduceFunctor<CPUDevice, Reducer>
-    : ReduceFunctorBase<CPUDevice, Reducer> {};
+    : ReduceFunctorBase<CPUDevice, Reducer> {
+  template <typename OUT_T, typename IN_T, typename ReductionAxes>
+  static void Reduce(OpKernelContext* ctx, OUT_T out, IN_T in,
+                     const ReductionAxes& reduction_axes,
+                     const Reducer& reducer) {
+    if (BlockedReduction<Reducer>::Run(ctx, out, in, reduction_axes)) return;
+    ReduceFunctorBase<CPUDevice, Reducer>::Reduce(ctx, out, in, reduction_axes,
+                                                  reducer);
+  }
+};
 
 }  // namespace functor
 }  // namespace tensorflow
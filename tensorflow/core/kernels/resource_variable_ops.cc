@@ -476,6 +476,7 @@ class AssignVariableOp : public OpKernel {
       *variable->tensor() = value;
     }
     variable->is_initialized = true;
+    variable->MarkModified();
   }
 
  private:
@@ -534,6 +535,7 @@ class AssignVariableOp<Device, Variant> : public OpKernel {
 
     if (input_alias) {
       *variable->tensor() = *input_alias;
+      variable->MarkModified();
       return;
     }
 
@@ -551,6 +553,7 @@ class AssignVariableOp<Device, Variant> : public OpKernel {
     for (int64_t i = 0; i < elements_in.size(); ++i) {
       elements_out(i) = elements_in(i);
     }
+    variable->MarkModified();
   }
 
  private:
@@ -628,6 +631,7 @@ class AssignUpdateVariableOp : public OpKernel {
     functor::DenseUpdate<Device, T, Op> update_functor;
     update_functor(context->eigen_device<Device>(), var_tensor->flat<T>(),
                    value.flat<T>());
+    variable->MarkModified();
   }
 };
 
@@ -722,7 +726,7 @@ class ResourceGatherOp : public OpKernel {
   void Compute(OpKernelContext* c) override {
     core::RefCountPtr<Var> v;
     OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
-    OP_REQUIRES_OK(c, EnsureSparseVariableAccess<Device, T>(c, v.get()));
+    OP_REQUIRES_OK(c, EnsureSparseVariableReadAccess<Device, T>(c, v.get()));
     // NOTE: We hold the lock for the whole gather operation instead
     // of increasing the reference count of v->tensor() to avoid a
     // situation where a write to the same variable will see a
@@ -900,7 +904,7 @@ class ResourceGatherNdOp : public OpKernel {
   void Compute(OpKernelContext* c) override {
     core::RefCountPtr<Var> v;
     OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &v));
-    OP_REQUIRES_OK(c, EnsureSparseVariableAccess<Device, T>(c, v.get()));
+    OP_REQUIRES_OK(c, EnsureSparseVariableReadAccess<Device, T>(c, v.get()));
     // NOTE: We hold the lock for the whole gather operation instead
     // of increasing the reference count of v->tensor() to avoid a
     // situation where a write to the same variable will see a
@@ -1134,10 +1138,12 @@ class ResourceScatterUpdateOp : public OpKernel {
     if (is_non_pod_dtype || use_exclusive_lock_) {
       mutex_lock ml(*v->mu());
       DoCompute(c, v.get());
+      v->MarkModified();
     } else {
       // For POD dtypes, we can safely run the update without the mutex.
       tf_shared_lock ml(*v->mu());
       DoCompute(c, v.get());
+      v->MarkModified();
     }
   }
 
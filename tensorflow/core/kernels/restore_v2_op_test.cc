@@ -25,15 +25,18 @@ limitations under the License.
 #include "tensorflow/core/framework/fake_input.h"
 #include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/tensor_description.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/kernels/ops_testutil.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/public/session_options.h"
 #include "tensorflow/core/public/version.h"
+#include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
 namespace tensorflow {
 namespace {
@@ -356,5 +359,109 @@ TEST_F(RestoreV2OpTest, RestoreAfterSaveV2) { RunTest("SaveV2"); }
 TEST_F(RestoreV2OpTest, RestoreAfterSaveSlicesV1) { RunTest("SaveSlices"); }
 TEST_F(RestoreV2OpTest, RestoreAfterSaveV1) { RunTest("Save"); }
 
+// A lazy restore serves the tensors saved by SaveV2 from the mapped data file.
+TEST_F(RestoreV2OpTest, LazyRestore) {
+  const string prefix = io::JoinPath(testing::TmpDir(), "tensor_lazy");
+  {
+    TF_ASSERT_OK(NodeDefBuilder("save", "SaveV2")
+                     .Input(FakeInput())  // prefix
+                     .Input(FakeInput())  // tensor_names
+                     .Input(FakeInput())  // shape_and_slices
+                     .Input(FakeInput({DT_FLOAT, DT_INT64, DT_STRING}))
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    AddInput<tstring>(TensorShape({}),
+                      [&prefix](int x) -> tstring { return prefix; });
+    AddInputFromArray<tstring>(TensorShape({3}), {"float", "int64", "string"});
+    AddInputFromArray<tstring>(TensorShape({3}), {"", "", ""});
+    AddInput<float>(TensorShape({2, 3}), [](int x) -> float { return x; });
+    AddInput<int64_t>(TensorShape({5}), [](int x) -> int64 { return -x; });
+    AddInputFromArray<tstring>(TensorShape({2}), {"a", "b"});
+    TF_ASSERT_OK(RunOpKernel());
+  }
+
+  inputs_.clear();
+  TF_ASSERT_OK(NodeDefBuilder("restore", "RestoreV2")
+                   .Input(FakeInput())  // prefix
+                   .Input(FakeInput())  // tensor_names
+                   .Input(FakeInput())  // shape_and_slices
+                   .Attr("dtypes", {DT_FLOAT, DT_INT64, DT_STRING})
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  ConfigProto config;
+  config.mutable_experimental()->set_lazy_variable_restore(true);
+  set_session_config(config);
+  AddInput<tstring>(TensorShape({}),
+                    [&prefix](int x) -> tstring { return prefix; });
+  AddInputFromArray<tstring>(TensorShape({3}), {"float", "int64", "string"});
+  AddInputFromArray<tstring>(TensorShape({3}), {"", "", ""});
+  TF_ASSERT_OK(RunOpKernel());
+
+  test::ExpectTensorEqual<float>(
+      *GetOutput(0),
+      test::AsTensor<float>({0, 1, 2, 3, 4, 5}, TensorShape({2, 3})));
+  test::ExpectTensorEqual<int64_t>(
+      *GetOutput(1), test::AsTensor<int64_t>({0, -1, -2, -3, -4}));
+  test::ExpectTensorEqual<tstring>(*GetOutput(2),
+                                   test::AsTensor<tstring>({"a", "b"}));
+  // The numeric tensors are views of the data file; strings are copied out.
+  for (int i = 0; i < 3; ++i) {
+    TensorDescription description;
+    GetOutput(i)->FillDescription(&description);
+    EXPECT_EQ(i < 2, description.allocation_description().allocator_name() ==
+                         "BundleMappedData");
+  }
+}
+
+// Small tensors spread over several data files are restored shard by shard.
+TEST_F(RestoreV2OpTest, RestoreFromShardedBundle) {
+  Env* env = Env::Default();
+  const string prefix = io::JoinPath(testing::TmpDir(), "tensor_sharded");
+  std::vector<tstring> shard_prefixes;
+  std::vector<string> tensor_names;
+  for (int shard = 0; shard < 3; ++shard) {
+    shard_prefixes.push_back(strings::StrCat(prefix, "_part", shard));
+    BundleWriter writer(env, shard_prefixes.back());
+    for (int i = 0; i < 2; ++i) {
+      tensor_names.push_back(strings::StrCat("tensor-", shard, "-", i));
+      TF_ASSERT_OK(writer.Add(
+          tensor_names.back(),
+          MakeInput<float>(TensorShape({4}), [shard, i](int x) -> float {
+            return 100 * shard + 10 * i + x;
+          })));
+    }
+    TF_ASSERT_OK(writer.Finish());
+  }
+  TF_ASSERT_OK(MergeBundles(env, shard_prefixes, prefix));
+
+  const int num_tensors = tensor_names.size();
+  TF_ASSERT_OK(NodeDefBuilder("myop", "RestoreV2")
+                   .Input(FakeInput())  // prefix
+                   .Input(FakeInput())  // tensor_names
+                   .Input(FakeInput())  // shape_and_slices
+                   .Attr("dtypes", DataTypeVector(num_tensors, DT_FLOAT))
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  AddInput<tstring>(TensorShape({}),
+                    [&prefix](int x) -> tstring { return prefix; });
+  // Request the tensors in reverse so the op has to reorder them.
+  AddInput<tstring>(TensorShape({num_tensors}), [&](int x) -> tstring {
+    return tensor_names[num_tensors - 1 - x];
+  });
+  AddInput<tstring>(TensorShape({num_tensors}),
+                    [](int x) -> tstring { return ""; });
+  TF_ASSERT_OK(RunOpKernel());
+
+  for (int idx = 0; idx < num_tensors; ++idx) {
+    const int shard = (num_tensors - 1 - idx) / 2;
+    const int i = (num_tensors - 1 - idx) % 2;
+    Tensor* output = GetOutput(idx);
+    EXPECT_TRUE(output->shape().IsSameSize(TensorShape({4})));
+    for (int x = 0; x < 4; ++x) {
+      EXPECT_EQ(100 * shard + 10 * i + x, output->flat<float>()(x));
+    }
+  }
+}
+
 }  // namespace
 }  // namespace tensorflow
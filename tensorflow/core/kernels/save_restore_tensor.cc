@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/save_restore_tensor.h"
 
+#include <map>
 #include <memory>
 #include <numeric>
 #include <unordered_map>
@@ -255,16 +256,29 @@ const int64_t kLargeShapeThreshold = 16 << 20;  // 16M
 // directly from the op thread to improve read locality.  Large tensors can be
 // restored from a thread pool: this requires creating a separate BundleReader
 // for each restore.
+// Returns the options for a reader restoring with "cache". A lazy restore maps
+// the data files and skips verifying the mapped tensors, so that their pages
+// are only read when first accessed.
+BundleReader::Options RestoreReaderOptions(BundleCache* cache,
+                                           bool lazy_restore) {
+  BundleReader::Options options;
+  options.cache = cache;
+  options.use_memory_mapped_data = lazy_restore;
+  options.verify_memory_mapped_data = !lazy_restore;
+  return options;
+}
+
 struct RestoreOp {
   RestoreOp(OpKernelContext* context, int idx, const string& tensor_name,
             const string& shape_and_slice, const string& reader_prefix,
-            DataType dtype)
+            DataType dtype, bool lazy_restore)
       : context(context),
         idx(idx),
         tensor_name(tensor_name),
         shape_and_slice(shape_and_slice),
         reader_prefix(reader_prefix),
-        dtype(dtype) {}
+        dtype(dtype),
+        lazy_restore(lazy_restore) {}
 
   // Move-only. It does not make sense to "run()" a copied RestoreOp.
   RestoreOp(const RestoreOp&) = delete;
@@ -285,7 +299,8 @@ struct RestoreOp {
 
   // Run this restore operation using a new BundleReader.
   void run_with_new_reader(BundleCache* cache) {
-    BundleReader reader(tsl::Env::Default(), reader_prefix, {cache, false});
+    BundleReader reader(tsl::Env::Default(), reader_prefix,
+                        RestoreReaderOptions(cache, lazy_restore));
     if (!reader.status().ok()) {
       status = reader.status();
       return;
@@ -294,6 +309,18 @@ struct RestoreOp {
     status = run(&reader);
   }
 
+  // Run a group of restore operations, in order, sharing one new
+  // BundleReader. Each op records its own status.
+  static void run_all_with_new_reader(const std::vector<RestoreOp*>& ops,
+                                      BundleCache* cache) {
+    BundleReader reader(
+        tsl::Env::Default(), ops.front()->reader_prefix,
+        RestoreReaderOptions(cache, ops.front()->lazy_restore));
+    for (RestoreOp* op : ops) {
+      op->status = reader.status().ok() ? op->run(&reader) : reader.status();
+    }
+  }
+
   absl::Status run(BundleReader* reader) {
     TensorShape restored_full_shape;
     TF_RETURN_IF_ERROR(
@@ -302,7 +329,18 @@ struct RestoreOp {
     VLOG(1) << "Restoring tensor " << idx << " : " << tensor_name << " : "
             << restored_full_shape.num_elements();
     Tensor* restored_tensor;
-    if (shape_and_slice.empty()) {
+    int32_t shard_id = -1;
+    if (lazy_restore && shape_and_slice.empty()) {
+      TF_RETURN_IF_ERROR(reader->LookupShardId(tensor_name, &shard_id));
+    }
+    if (shard_id >= 0) {
+      // Lookup the full tensor without an output buffer, so that the reader
+      // can return a view of its memory-mapped data.
+      Tensor restored;
+      TF_RETURN_IF_ERROR(reader->Lookup(tensor_name, &restored));
+      context->set_output(idx, restored);
+      restored_tensor = context->mutable_output(idx);
+    } else if (shape_and_slice.empty()) {
       // Lookup the full tensor.
       TF_RETURN_IF_ERROR(
           context->allocate_output(idx, restored_full_shape, &restored_tensor));
@@ -356,6 +394,7 @@ struct RestoreOp {
   string shape_and_slice;
   string reader_prefix;
   DataType dtype;
+  bool lazy_restore;
 
   absl::Status status;
 };
@@ -371,16 +410,22 @@ absl::Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
   const auto& tensor_names_flat = tensor_names.flat<tstring>();
   const auto& shape_and_slices_flat = shape_and_slices.flat<tstring>();
 
+  const bool lazy_restore =
+      context->session_config() != nullptr &&
+      context->session_config()->experimental().lazy_variable_restore();
+
   std::vector<RestoreOp> restore_ops;
   restore_ops.reserve(tensor_names_flat.size());
   for (int i = 0; i < tensor_names_flat.size(); ++i) {
     restore_ops.push_back({context, i, tensor_names_flat(i),
-                           shape_and_slices_flat(i), prefix_string, dtypes[i]});
+                           shape_and_slices_flat(i), prefix_string, dtypes[i],
+                           lazy_restore});
   }
 
   tsl::Env* const env = tsl::Env::Default();
   BundleCache cache(env);
-  BundleReader default_reader(env, prefix_string, {&cache, false});
+  BundleReader default_reader(env, prefix_string,
+                              RestoreReaderOptions(&cache, lazy_restore));
   TF_RETURN_IF_ERROR(default_reader.status());
 
   TF_RETURN_IF_ERROR(default_reader.SortForSequentialAccess<RestoreOp>(
@@ -443,21 +488,52 @@ absl::Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
     }
   } else {
     // If no restore parallelism is specified, we run large restore ops with
-    // a modest parallelism, and small restore ops serially.
+    // a modest parallelism, and small restore ops serially per data file.
+
+    // Reads from different data files are independent, so small tensors are
+    // grouped by the shard they live in. The op thread reads the first shard
+    // and each remaining shard is read, still sequentially, by its own reader
+    // in the pool. Slices and partitioned tensors stay on the op thread.
+    std::vector<RestoreOp*> serial_restore_ops;
+    std::map<int32_t, std::vector<RestoreOp*>> sharded_restore_ops;
+    for (auto* op : small_restore_ops) {
+      int32_t shard_id = -1;
+      if (default_reader.num_shards() > 1 && op->shape_and_slice.empty()) {
+        TF_RETURN_IF_ERROR(
+            default_reader.LookupShardId(op->tensor_name, &shard_id));
+      }
+      if (shard_id < 0) {
+        serial_restore_ops.push_back(op);
+      } else {
+        sharded_restore_ops[shard_id].push_back(op);
+      }
+    }
+    if (!sharded_restore_ops.empty()) {
+      auto first_shard = sharded_restore_ops.begin();
+      serial_restore_ops.insert(serial_restore_ops.end(),
+                                first_shard->second.begin(),
+                                first_shard->second.end());
+      sharded_restore_ops.erase(first_shard);
+    }
 
-    // Avoid creating a pool if there are no large restore ops.
+    // Avoid creating a pool if there is nothing to run in it.
     std::unique_ptr<thread::ThreadPool> reader_pool;
-    if (!large_restore_ops.empty()) {
+    if (!large_restore_ops.empty() || !sharded_restore_ops.empty()) {
       reader_pool.reset(
           new thread::ThreadPool(Env::Default(), "restore_tensors", 8));
       for (auto* op : large_restore_ops) {
         reader_pool->Schedule(
             [op, &cache]() { op->run_with_new_reader(&cache); });
       }
+      for (const auto& [shard_id, ops] : sharded_restore_ops) {
+        reader_pool->Schedule([&ops = ops, &cache]() {
+          RestoreOp::run_all_with_new_reader(ops, &cache);
+        });
+      }
     }
 
-    // Read small tensors from the op thread.
-    for (auto* op : small_restore_ops) {
+    // Read the remaining small tensors from the op thread.
+    for (auto* op : serial_restore_ops) {
       TF_RETURN_IF_ERROR(op->run(&default_reader));
     }
 
@@ -467,6 +543,11 @@ absl::Status RestoreTensorsV2(OpKernelContext* context, const Tensor& prefix,
     for (auto* op : large_restore_ops) {
       TF_RETURN_IF_ERROR(op->status);
     }
+    for (const auto& [shard_id, ops] : sharded_restore_ops) {
+      for (auto* op : ops) {
+        TF_RETURN_IF_ERROR(op->status);
+      }
+    }
   }
 
   for (const RestoreOp& restore_op : restore_ops) {
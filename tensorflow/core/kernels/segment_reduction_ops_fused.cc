@@ -0,0 +1,160 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// See docs in ../ops/math_ops.cc.
+
+#define EIGEN_USE_THREADS
+
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/core/framework/bounds_check.h"
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/op_requires.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/tensor_types.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/prefetch.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+// Computes SegmentSum(Gather(data, indices) * weights, segment_ids) by
+// accumulating the scaled rows of `data` directly into the output. Segments
+// are independent output rows, so they are sharded across threads.
+template <typename T, typename Index, typename SegmentId>
+class FusedWeightedSparseSegmentSumOp : public OpKernel {
+ public:
+  explicit FusedWeightedSparseSegmentSumOp(OpKernelConstruction* context)
+      : OpKernel(context) {}
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& data = context->input(0);
+    const Tensor& indices = context->input(1);
+    const Tensor& weights = context->input(2);
+    const Tensor& segment_ids = context->input(3);
+
+    OP_REQUIRES(context, TensorShapeUtils::IsVectorOrHigher(data.shape()),
+                errors::InvalidArgument("data must be at least rank 1"));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(indices.shape()),
+                errors::InvalidArgument("indices should be a vector."));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(segment_ids.shape()),
+                errors::InvalidArgument("segment_ids should be a vector."));
+    const int64_t num_indices = indices.NumElements();
+    OP_REQUIRES(context, num_indices == segment_ids.NumElements(),
+                errors::InvalidArgument(
+                    "segment_ids and indices should have same size."));
+    // A single weight is broadcast to all rows, as it would be by Mul.
+    const bool broadcast_weight = weights.NumElements() == 1;
+    OP_REQUIRES(
+        context,
+        weights.dims() >= 1 &&
+            (broadcast_weight || (weights.dim_size(0) == num_indices &&
+                                  weights.NumElements() == num_indices)),
+        errors::InvalidArgument("weights must have shape [", num_indices,
+                                ", 1, ..., 1], got ",
+                                weights.shape().DebugString()));
+
+    const auto indices_vec = indices.vec<Index>();
+    const auto segment_vec = segment_ids.vec<SegmentId>();
+    const int64_t num_rows = data.dim_size(0);
+
+    // Validate the ids and find the range of indices of each segment.
+    std::vector<int64_t> segment_starts;
+    std::vector<SegmentId> segment_rows;
+    for (int64_t i = 0; i < num_indices; ++i) {
+      const SegmentId segment = internal::SubtleMustCopy(segment_vec(i));
+      if (segment_rows.empty() || segment != segment_rows.back()) {
+        OP_REQUIRES(
+            context, segment_rows.empty() ? segment >= 0
+                                          : segment > segment_rows.back(),
+            errors::InvalidArgument(segment_rows.empty()
+                                        ? "segment ids must be >= 0"
+                                        : "segment ids are not increasing"));
+        segment_starts.push_back(i);
+        segment_rows.push_back(segment);
+      }
+      const Index index = internal::SubtleMustCopy(indices_vec(i));
+      OP_REQUIRES(context, FastBoundsCheck(index, num_rows),
+                  errors::InvalidArgument("indices[", i, "] == ", index,
+                                          " out of range [0, ", num_rows,
+                                          ")"));
+    }
+    const int64_t num_segments = segment_rows.size();
+    segment_starts.push_back(num_indices);
+
+    const int64_t output_rows =
+        num_segments > 0 ? static_cast<int64_t>(segment_rows.back()) + 1 : 0;
+    TensorShape output_shape = data.shape();
+    OP_REQUIRES_OK(context, output_shape.SetDimWithStatus(0, output_rows));
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context, context->allocate_output(0, output_shape, &output));
+    auto output_flat = output->flat_outer_dims<T>();
+    output_flat.setZero();
+    if (num_indices == 0) return;
+
+    const auto data_flat = data.flat_outer_dims<T>();
+    const auto weights_flat = weights.flat<T>();
+    const int64_t num_cols = data_flat.dimension(1);
+    if (num_cols == 0) return;
+    using ConstRow = typename TTypes<T>::UnalignedConstVec;
+    using Row = typename TTypes<T>::UnalignedVec;
+
+    auto work = [&](int64_t begin, int64_t end) {
+      for (int64_t s = begin; s < end; ++s) {
+        Row out(&output_flat(segment_rows[s], 0), num_cols);
+        for (int64_t i = segment_starts[s]; i < segment_starts[s + 1]; ++i) {
+          // The rows are scattered in `data`, so fetch the next one while the
+          // current one is accumulated.
+          if (i + 1 < num_indices) {
+            port::prefetch<port::PREFETCH_HINT_T0>(
+                &data_flat(indices_vec(i + 1), 0));
+          }
+          ConstRow row(&data_flat(indices_vec(i), 0), num_cols);
+          out += row * weights_flat(broadcast_weight ? 0 : i);
+        }
+      }
+    };
+    auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+    const int64_t cost_per_segment = num_indices / num_segments * num_cols;
+    Shard(worker_threads->num_threads, worker_threads->workers, num_segments,
+          cost_per_segment, work);
+  }
+};
+
+#define REGISTER_CPU_KERNEL(type, index_type, segment_ids_type)   \
+  REGISTER_KERNEL_BUILDER(                                        \
+      Name("_FusedWeightedSparseSegmentSum")                      \
+          .Device(DEVICE_CPU)                                     \
+          .TypeConstraint<type>("T")                              \
+          .TypeConstraint<index_type>("Tidx")                     \
+          .TypeConstraint<segment_ids_type>("Tsegmentids"),       \
+      FusedWeightedSparseSegmentSumOp<type, index_type, segment_ids_type>);
+
+#define REGISTER_CPU_KERNELS(type)               \
+  REGISTER_CPU_KERNEL(type, int32, int32);       \
+  REGISTER_CPU_KERNEL(type, int32, int64_t);     \
+  REGISTER_CPU_KERNEL(type, int64_t, int32);     \
+  REGISTER_CPU_KERNEL(type, int64_t, int64_t);
+
+REGISTER_CPU_KERNELS(float);
+REGISTER_CPU_KERNELS(double);
+
+#undef REGISTER_CPU_KERNELS
+#undef REGISTER_CPU_KERNEL
+
+}  // namespace tensorflow
@@ -398,6 +398,12 @@ struct UnsortedSegmentFunctor<CPUDevice, T, Index, InitialValueF, ReductionF> {
     // Nothing to reduce. All output values equal to `InitialValueF()`.
     if (num_reductions == 0) return;
 
+    const int64_t num_partials = NumPartials(ctx, N, num_segments, inner_dim);
+    if (num_partials > 1) {
+      ReduceWithPartials(ctx, num_partials, segment_ids, data, output);
+      return;
+    }
+
     // Parallelize by `num_segments`. It's simple, efficient and safe
     // (no data dependency):
     //
@@ -408,23 +414,35 @@ struct UnsortedSegmentFunctor<CPUDevice, T, Index, InitialValueF, ReductionF> {
     //   | b1 |  | 1 |
     //   | a1 |  | 0 |
     //
-    // TODO(intel-tf): Balance workload in `row_counter` to make parallelism
-    //                 more efficient.
-    auto reductionWorker = [&](int64_t begin, int64_t end) -> void {
-      for (int64_t i = 0; i < N; i++) {
+    // The input rows are first bucketed by segment with a counting sort, so
+    // that each worker only visits the rows of its own segments. The sort is
+    // stable, so every segment is still reduced in input order.
+    std::vector<int64_t> row_offsets(num_segments + 1, 0);
+    for (int64_t j = 0; j < num_segments; ++j) {
+      row_offsets[j + 1] = row_offsets[j] + row_counter[j];
+    }
+    std::vector<int64_t> sorted_rows(num_real_segment);
+    {
+      std::vector<int64_t> cursor(row_offsets.begin(), row_offsets.end() - 1);
+      for (int64_t i = 0; i < N; ++i) {
         Index j = internal::SubtleMustCopy(segment_ids(i));
-        // If `j` is in work scope of this worker, do the reduction.
-        if (j >= begin && j < end) {
-          reduction(data.template chip<0>(i), output.template chip<0>(j));
+        if (j < 0 || j >= num_segments) continue;
+        if (cursor[j] == row_offsets[j + 1]) continue;
+        sorted_rows[cursor[j]++] = i;
+      }
+    }
+    auto reductionWorker = [&](int64_t begin, int64_t end) -> void {
+      for (int64_t j = begin; j < end; ++j) {
+        auto out_row = output.template chip<0>(j);
+        for (int64_t k = row_offsets[j]; k < row_offsets[j + 1]; ++k) {
+          reduction(data.template chip<0>(sorted_rows[k]), out_row);
         }
       }
     };
     auto reductionWorker1D = [&](int64_t begin, int64_t end) -> void {
-      for (int64_t i = 0; i < N; i++) {
-        Index j = internal::SubtleMustCopy(segment_ids(i));
-        // If `j` is in work scope of this worker, do the reduction.
-        if (j >= begin && j < end) {
-          reduction(data_ptr[i], out_ptr[j]);
+      for (int64_t j = begin; j < end; ++j) {
+        for (int64_t k = row_offsets[j]; k < row_offsets[j + 1]; ++k) {
+          reduction(data_ptr[sorted_rows[k]], out_ptr[j]);
         }
       }
     };
@@ -433,7 +451,7 @@ struct UnsortedSegmentFunctor<CPUDevice, T, Index, InitialValueF, ReductionF> {
     const int64_t kAverTaskSize = num_real_segment / num_segments;
     const int64_t compute_cycles = 5 * inner_dim * kAverTaskSize;
     const int64_t input_bytes = sizeof(T) * inner_dim * kAverTaskSize;
-    const int64_t output_bytes = sizeof(T) * inner_dim * kAverTaskSize;
+    const int64_t output_bytes = sizeof(T) * inner_dim;
     const Eigen::TensorOpCost cost(input_bytes, output_bytes, compute_cycles);
     if (is_inner_dim_1d) {
       cpu_device.parallelFor(num_segments, cost, reductionWorker1D);
@@ -441,6 +459,96 @@ struct UnsortedSegmentFunctor<CPUDevice, T, Index, InitialValueF, ReductionF> {
       cpu_device.parallelFor(num_segments, cost, reductionWorker);
     }
   }
+
+ private:
+  // Below this many input elements, the per-thread partials are not worth
+  // the extra pass that combines them.
+  static constexpr int64_t kMinPartialsInputSize = 1 << 16;
+  // Each partial must reduce at least this many input rows per output row,
+  // which bounds the partials buffer to a fraction of the input size.
+  static constexpr int64_t kMinRowsPerPartialSegment = 4;
+
+  // Returns the number of row-partitioned partials to reduce into, or 1 to
+  // partition the work by output segment instead.
+  //
+  // Partitioning by segment does no redundant work, but the rows of a hot
+  // segment are all reduced by one worker. When there are few segments
+  // compared to input rows, each of several workers instead reduces a
+  // contiguous block of rows into its own copy of the output, and the copies
+  // are combined at the end. The copies are private, so no atomics are
+  // needed, and the number of blocks only depends on the thread count, so
+  // the result is deterministic for a fixed configuration.
+  static int64_t NumPartials(OpKernelContext* ctx, int64_t N,
+                             int64_t num_segments, int64_t inner_dim) {
+    if (N * inner_dim < kMinPartialsInputSize) return 1;
+    const int64_t num_threads =
+        ctx->device()->tensorflow_cpu_worker_threads()->num_threads;
+    const int64_t max_partials =
+        N / (kMinRowsPerPartialSegment * num_segments);
+    return std::max<int64_t>(1, std::min(num_threads, max_partials));
+  }
+
+  static void ReduceWithPartials(OpKernelContext* ctx, int64_t num_partials,
+                                 typename TTypes<Index>::ConstFlat segment_ids,
+                                 typename TTypes<T, 2>::ConstTensor data,
+                                 typename TTypes<T, 2>::Tensor output) {
+    auto cpu_device = ctx->eigen_cpu_device();
+    const int64_t N = segment_ids.dimension(0);
+    const int64_t num_segments = output.dimension(0);
+    const int64_t inner_dim = data.dimension(1);
+    ReductionF reduction;
+
+    // The first partial is the output itself.
+    Tensor partials;
+    OP_REQUIRES_OK(
+        ctx, ctx->allocate_temp(
+                 DataTypeToEnum<T>::value,
+                 TensorShape({(num_partials - 1) * num_segments, inner_dim}),
+                 &partials));
+    auto partials_t = partials.matrix<T>();
+    partials_t.device(cpu_device) = partials_t.constant(InitialValueF()());
+
+    auto partialWorker = [&](int64_t begin, int64_t end) -> void {
+      for (int64_t p = begin; p < end; ++p) {
+        T* partial = p == 0 ? output.data()
+                            : partials_t.data() +
+                                  (p - 1) * num_segments * inner_dim;
+        typename TTypes<T, 2>::Tensor partial_t(partial, num_segments,
+                                                inner_dim);
+        const int64_t row_begin = N * p / num_partials;
+        const int64_t row_end = N * (p + 1) / num_partials;
+        for (int64_t i = row_begin; i < row_end; ++i) {
+          Index j = internal::SubtleMustCopy(segment_ids(i));
+          if (j < 0 || j >= num_segments) continue;
+          reduction(data.template chip<0>(i), partial_t.template chip<0>(j));
+        }
+      }
+    };
+    // One block of rows per partial.
+    const int64_t rows_per_partial = N / num_partials;
+    const Eigen::TensorOpCost partial_cost(
+        sizeof(T) * inner_dim * rows_per_partial,
+        sizeof(T) * inner_dim * rows_per_partial,
+        5 * inner_dim * rows_per_partial);
+    cpu_device.parallelFor(num_partials, partial_cost, partialWorker);
+
+    const Tensor& const_partials = partials;
+    auto const_partials_t = const_partials.matrix<T>();
+    auto combineWorker = [&](int64_t begin, int64_t end) -> void {
+      for (int64_t j = begin; j < end; ++j) {
+        auto out_row = output.template chip<0>(j);
+        for (int64_t p = 1; p < num_partials; ++p) {
+          reduction(const_partials_t.template chip<0>((p - 1) * num_segments +
+                                                      j),
+                    out_row);
+        }
+      }
+    };
+    const Eigen::TensorOpCost combine_cost(
+        sizeof(T) * inner_dim * (num_partials - 1), sizeof(T) * inner_dim,
+        5 * inner_dim * (num_partials - 1));
+    cpu_device.parallelFor(num_segments, combine_cost, combineWorker);
+  }
 };
 
 template <typename T>
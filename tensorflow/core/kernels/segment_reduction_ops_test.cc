@@ -105,6 +105,8 @@ static void BM_UnsortedSegmentReduction(::testing::benchmark::State& state,
 
 BM_UnsortedReduce_Arg(4096, 1024, 1);
 BM_UnsortedReduce_Arg(4096, 1024, 128);
+BM_UnsortedReduce_Arg(65536, 64, 16);
+BM_UnsortedReduce_Arg(65536, 64, 32768);
 
 template <typename Index>
 static void BM_SegmentReduction(::testing::benchmark::State& state,
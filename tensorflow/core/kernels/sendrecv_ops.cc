@@ -15,7 +15,9 @@ limitations under the License.
 
 #include "tensorflow/core/kernels/sendrecv_ops.h"
 
+#include <cstring>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/core/framework/attr_value.pb.h"
 #include "tensorflow/core/framework/op.h"
@@ -234,6 +236,117 @@ REGISTER_KERNEL_BUILDER(Name("Recv").Device(DEVICE_DEFAULT), RecvOp);
 REGISTER_KERNEL_BUILDER(
     Name("_HostRecv").Device(DEVICE_DEFAULT).HostMemory("tensor"), RecvOp);
 
+namespace {
+
+// Rounds `bytes` up to keep the packed payloads 8-byte aligned.
+int64_t PaddedBytes(int64_t bytes) { return (bytes + 7) & ~int64_t{7}; }
+
+// The packed tensor starts with a header of int64 words: the number of
+// tensors, followed by the rank, the dimensions and the size in bytes of
+// each tensor.  The contents of the tensors follow, each padded to a
+// multiple of 8 bytes.
+class PackTensorsOp : public OpKernel {
+ public:
+  explicit PackTensorsOp(OpKernelConstruction* ctx) : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    OpInputList values;
+    OP_REQUIRES_OK(ctx, ctx->input_list("values", &values));
+    std::vector<int64_t> header = {values.size()};
+    int64_t payload_bytes = 0;
+    for (const Tensor& value : values) {
+      OP_REQUIRES(ctx, DataTypeCanUseMemcpy(value.dtype()),
+                  errors::InvalidArgument("_PackTensors cannot pack ",
+                                          DataTypeString(value.dtype())));
+      header.push_back(value.dims());
+      for (int64_t dim : value.shape().dim_sizes()) {
+        header.push_back(dim);
+      }
+      header.push_back(value.TotalBytes());
+      payload_bytes += PaddedBytes(value.TotalBytes());
+    }
+    const int64_t header_bytes = header.size() * sizeof(int64_t);
+    Tensor* packed = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(
+                            0, TensorShape({header_bytes + payload_bytes}),
+                            &packed));
+    char* dst = reinterpret_cast<char*>(packed->flat<uint8>().data());
+    memcpy(dst, header.data(), header_bytes);
+    dst += header_bytes;
+    for (const Tensor& value : values) {
+      const absl::string_view data = value.tensor_data();
+      memcpy(dst, data.data(), data.size());
+      memset(dst + data.size(), 0, PaddedBytes(data.size()) - data.size());
+      dst += PaddedBytes(data.size());
+    }
+  }
+};
+
+class UnpackTensorsOp : public OpKernel {
+ public:
+  explicit UnpackTensorsOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("T", &dtypes_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    absl::string_view data = ctx->input(0).tensor_data();
+    auto read_word = [&data](int64_t* word) {
+      if (data.size() < sizeof(int64_t)) return false;
+      memcpy(word, data.data(), sizeof(int64_t));
+      data.remove_prefix(sizeof(int64_t));
+      return true;
+    };
+    int64_t num_values;
+    OP_REQUIRES(ctx, read_word(&num_values) &&
+                    num_values == static_cast<int64_t>(dtypes_.size()),
+                errors::InvalidArgument("_UnpackTensors expected ",
+                                        dtypes_.size(), " packed tensors"));
+    std::vector<TensorShape> shapes(num_values);
+    for (int i = 0; i < num_values; ++i) {
+      int64_t rank;
+      OP_REQUIRES(ctx,
+                  read_word(&rank) && rank >= 0 &&
+                      rank <= TensorShape::MaxDimensions(),
+                  errors::InvalidArgument("Malformed packed tensor ", i));
+      std::vector<int64_t> dims(rank);
+      for (int64_t& dim : dims) {
+        OP_REQUIRES(ctx, read_word(&dim),
+                    errors::InvalidArgument("Malformed packed tensor ", i));
+      }
+      OP_REQUIRES_OK(ctx, TensorShape::BuildTensorShape(dims, &shapes[i]));
+      int64_t bytes;
+      OP_REQUIRES(ctx,
+                  read_word(&bytes) &&
+                      bytes == shapes[i].num_elements() *
+                                   DataTypeSize(dtypes_[i]),
+                  errors::InvalidArgument("Malformed packed tensor ", i));
+    }
+    OpOutputList values;
+    OP_REQUIRES_OK(ctx, ctx->output_list("values", &values));
+    for (int i = 0; i < num_values; ++i) {
+      Tensor* value = nullptr;
+      OP_REQUIRES_OK(ctx, values.allocate(i, shapes[i], &value));
+      const int64_t bytes = value->TotalBytes();
+      OP_REQUIRES(
+          ctx, static_cast<int64_t>(data.size()) >= PaddedBytes(bytes),
+          errors::InvalidArgument("Truncated packed tensor ", i));
+      memcpy(const_cast<char*>(value->tensor_data().data()), data.data(),
+             bytes);
+      data.remove_prefix(PaddedBytes(bytes));
+    }
+  }
+
+ private:
+  DataTypeVector dtypes_;
+};
+
+}  // namespace
+
+REGISTER_KERNEL_BUILDER(Name("_PackTensors").Device(DEVICE_CPU),
+                        PackTensorsOp);
+REGISTER_KERNEL_BUILDER(Name("_UnpackTensors").Device(DEVICE_CPU),
+                        UnpackTensorsOp);
+
 // Environment variable `DISABLE_HOST_SEND_RECV_REGISTRATION` is used to disable
 // hostSend and hostRecv registration on CPU device in the mock environment.
 static bool InitModule() {
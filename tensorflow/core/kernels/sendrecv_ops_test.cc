@@ -14,7 +14,13 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/test.h"
 #include "tensorflow/core/platform/test_benchmark.h"
 
@@ -39,6 +45,69 @@ class DummyRendezvous : public Rendezvous {
   void StartAbort(const absl::Status& status) override {}
 };
 
+class PackTensorsOpTest : public OpsTestBase {
+ protected:
+  // Packs `values` with _PackTensors and returns the packed tensor.
+  Tensor Pack(std::vector<Tensor>* values) {
+    DataTypeVector dtypes;
+    std::vector<NodeDefBuilder::NodeOut> inputs;
+    for (const Tensor& value : *values) {
+      dtypes.push_back(value.dtype());
+      inputs.emplace_back("input", inputs.size(), value.dtype());
+    }
+    TF_CHECK_OK(NodeDefBuilder("pack", "_PackTensors")
+                    .Input(inputs)
+                    .Finalize(node_def()));
+    TF_CHECK_OK(InitOp());
+    inputs_.clear();
+    for (Tensor& value : *values) {
+      inputs_.push_back(TensorValue(&value));
+    }
+    TF_CHECK_OK(RunOpKernel());
+    return *GetOutput(0);
+  }
+
+  // Runs _UnpackTensors with the attr `T` set to `dtypes` on `packed`.
+  absl::Status Unpack(const DataTypeVector& dtypes, Tensor* packed) {
+    TF_RETURN_IF_ERROR(NodeDefBuilder("unpack", "_UnpackTensors")
+                           .Input(FakeInput(DT_UINT8))
+                           .Attr("T", dtypes)
+                           .Finalize(node_def()));
+    TF_RETURN_IF_ERROR(InitOp());
+    inputs_.clear();
+    inputs_.push_back(TensorValue(packed));
+    return RunOpKernel();
+  }
+};
+
+TEST_F(PackTensorsOpTest, RoundTrip) {
+  std::vector<Tensor> values = {
+      test::AsTensor<float>({1, 2, 3, 4, 5, 6}, TensorShape({2, 3})),
+      test::AsScalar<int64_t>(7), test::AsTensor<int8>({1, 2, 3}),
+      Tensor(DT_DOUBLE, TensorShape({0, 4}))};
+  Tensor packed = Pack(&values);
+  TF_ASSERT_OK(Unpack({DT_FLOAT, DT_INT64, DT_INT8, DT_DOUBLE}, &packed));
+  test::ExpectTensorEqual<float>(values[0], *GetOutput(0));
+  test::ExpectTensorEqual<int64_t>(values[1], *GetOutput(1));
+  test::ExpectTensorEqual<int8>(values[2], *GetOutput(2));
+  EXPECT_EQ(TensorShape({0, 4}), GetOutput(3)->shape());
+}
+
+TEST_F(PackTensorsOpTest, UnpackRejectsMismatchedTypes) {
+  std::vector<Tensor> values = {test::AsTensor<float>({1, 2})};
+  Tensor packed = Pack(&values);
+  EXPECT_FALSE(Unpack({DT_FLOAT, DT_FLOAT}, &packed).ok());
+  EXPECT_FALSE(Unpack({DT_DOUBLE}, &packed).ok());
+}
+
+TEST_F(PackTensorsOpTest, UnpackRejectsTruncatedInput) {
+  std::vector<Tensor> values = {test::AsTensor<float>({1, 2, 3})};
+  Tensor packed = Pack(&values);
+  Tensor truncated = tensor::DeepCopy(
+      packed.Slice(0, packed.NumElements() - sizeof(int64_t)));
+  EXPECT_FALSE(Unpack({DT_FLOAT}, &truncated).ok());
+}
+
 static Graph* Send() {
   Graph* g = new Graph(OpRegistry::Global());
   Tensor in0(DT_FLOAT, TensorShape({0}));
@@ -60,6 +60,10 @@ namespace tensorflow {
 static constexpr int32_t kMaxShards = 20;
 // Number of shards allocated to each thread.
 static constexpr int32_t kNumShardsPerThread = 3;
+// Maximum number of consecutive rows with the same sparsity pattern that the
+// CPU kernel multiplies together, as they arise from block-sparse (e.g.
+// block-pruned) matrices with block heights of 4, 8 or 16.
+static constexpr int32_t kMaxBlockRows = 16;
 
 typedef Eigen::ThreadPoolDevice CPUDevice;
 typedef Eigen::GpuDevice GPUDevice;
@@ -307,8 +311,13 @@ class CSRMatMulCPUOp : public CSRMatMulOp<CPUDevice, T> {
     // rows in each batch.
     auto worker_threads = *(ctx->device()->tensorflow_cpu_worker_threads());
     const int32_t num_threads = worker_threads.num_threads;
-    const int64_t block_size =
+    int64_t block_size =
         num_lhs_rows / std::max(kMaxShards, kNumShardsPerThread * num_threads);
+    // Keep shards aligned to row blocks, so that they are not split up.
+    if (block_size >= kMaxBlockRows) {
+      block_size = (block_size + kMaxBlockRows - 1) / kMaxBlockRows *
+                   kMaxBlockRows;
+    }
     const int64_t num_rhs_rows = rhs.dim_size(rhs.dims() - 2);
     const int64_t num_rhs_cols = rhs.dim_size(rhs.dims() - 1);
     worker_threads.workers->ParallelFor(
@@ -323,12 +332,6 @@ class CSRMatMulCPUOp : public CSRMatMulOp<CPUDevice, T> {
               [&](int64_t batch_idx, int64_t row_begin, int64_t row_end) {
                 const int64_t num_shard_rows = row_end - row_begin;
 
-                // Define an Eigen::SparseMatrix over the row range:
-                // [row_begin, row_end) of the CSR SparseMatrix A.
-                std::vector<int32> row_ptrs;
-                auto sparse_matrix = GetSparseMatrixRef(
-                    lhs, batch_idx, row_begin, num_shard_rows, &row_ptrs);
-
                 // Map the corresponding rows of the rhs.
                 ConstMatrixMap rhs_map(rhs.flat<T>().data() + batch_idx *
                                                                   num_rhs_rows *
@@ -341,11 +344,52 @@ class CSRMatMulCPUOp : public CSRMatMulOp<CPUDevice, T> {
                         batch_idx * num_lhs_rows * num_rhs_cols +
                         row_begin * num_rhs_cols,
                     num_shard_rows, num_rhs_cols);
-                output_map.noalias() = sparse_matrix * rhs_map;
+                BlockRowSparseDenseMatMul(lhs, batch_idx, row_begin, row_end,
+                                          rhs_map, &output_map);
               });
         });
   }
 
+  // Computes rows [row_begin, row_end) of the product of the CSR matrix
+  // `lhs` and `rhs` into `output`, whose first row is `row_begin`.
+  //
+  // Consecutive rows that have the same column indices, as the rows of a
+  // block-sparse matrix do, are multiplied together: each row of `rhs` that
+  // they use is then read once for all of them rather than once per row.
+  void BlockRowSparseDenseMatMul(const CSRSparseMatrix& lhs,
+                                 const int batch_idx, const int64_t row_begin,
+                                 const int64_t row_end,
+                                 const ConstMatrixMap& rhs,
+                                 MatrixMap* output) {
+    const auto row_ptrs = lhs.row_pointers_vec(batch_idx);
+    const int32* col_indices = lhs.col_indices_vec(batch_idx).data();
+    const T* values = lhs.values_vec<T>(batch_idx).data();
+    output->setZero();
+    for (int64_t row = row_begin; row < row_end;) {
+      const int32 row_offset = row_ptrs(row);
+      const int32 row_nnz = row_ptrs(row + 1) - row_offset;
+      const int32* row_cols = col_indices + row_offset;
+      int64_t block_rows = 1;
+      while (block_rows < kMaxBlockRows && row + block_rows < row_end) {
+        const int32 next_offset = row_ptrs(row + block_rows);
+        if (row_ptrs(row + block_rows + 1) - next_offset != row_nnz ||
+            !std::equal(row_cols, row_cols + row_nnz,
+                        col_indices + next_offset)) {
+          break;
+        }
+        ++block_rows;
+      }
+      for (int32 k = 0; k < row_nnz; ++k) {
+        const auto rhs_row = rhs.row(row_cols[k]);
+        for (int64_t i = 0; i < block_rows; ++i) {
+          const T value = values[row_ptrs(row + i) + k];
+          output->row(row - row_begin + i).noalias() += value * rhs_row;
+        }
+      }
+      row += block_rows;
+    }
+  }
+
   // Sparse-Dense Matrix Multiplication assuming the CSRSparseMatrix (LHS) is
   // to be transposed before the operation.
   void SparseDenseMatMulWithTransposedLHS(OpKernelContext* ctx,
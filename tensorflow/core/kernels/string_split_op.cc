@@ -24,6 +24,8 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/stringpiece.h"
 #include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/platform/fingerprint.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -309,8 +311,107 @@ class StringSplitV2Op : public OpKernel {
   int maxsplit_;
 };
 
+// Splits like StringSplitV2, but outputs the Fingerprint64 hash bucket of each
+// token, as StringToHashBucketFast would, instead of the token itself. The
+// tokens are only ever views into the input, so no intermediate string tensor
+// is materialized.
+class StringSplitToHashBucketFastOp : public OpKernel {
+ public:
+  explicit StringSplitToHashBucketFastOp(OpKernelConstruction* context)
+      : OpKernel(context), maxsplit_(-1) {
+    OP_REQUIRES_OK(context, context->GetAttr("maxsplit", &maxsplit_));
+    OP_REQUIRES_OK(context, context->GetAttr("num_buckets", &num_buckets_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor* input_tensor;
+    OP_REQUIRES_OK(ctx, ctx->input("input", &input_tensor));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(input_tensor->shape()),
+                errors::InvalidArgument("input must be a vector, got shape: ",
+                                        input_tensor->shape().DebugString()));
+
+    const auto input_vec = input_tensor->vec<tstring>();
+    const int64_t batch_size = input_vec.dimension(0);
+
+    const Tensor* sep_tensor;
+    OP_REQUIRES_OK(ctx, ctx->input("sep", &sep_tensor));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsScalar(sep_tensor->shape()),
+                errors::InvalidArgument("sep must be a scalar, got shape: ",
+                                        sep_tensor->shape().DebugString()));
+    const auto sep_vec = sep_tensor->flat<tstring>();
+    StringPiece sep(sep_vec(0));
+    std::vector<StringPiece> tokens;
+    // Guess that we'll be unpacking a handful of tokens per example.
+    static constexpr int kReserveSize = 4;
+    tokens.reserve(batch_size * kReserveSize);
+
+    int64_t output_size = 0;
+    int64_t max_num_entries = 0;
+    int64_t input_bytes = 0;
+    std::vector<int64_t> num_indices(batch_size);
+    for (int64_t i = 0; i < batch_size; ++i) {
+      std::vector<StringPiece> parts = SplitV2(input_vec(i), sep, maxsplit_);
+      int64_t n_entries = parts.size();
+      num_indices[i] = n_entries;
+      output_size += n_entries;
+      max_num_entries = std::max(max_num_entries, n_entries);
+      input_bytes += input_vec(i).size();
+      tokens.insert(tokens.end(), parts.begin(), parts.end());
+    }
+
+    Tensor* sp_indices_t;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({output_size, 2}),
+                                             &sp_indices_t));
+    Tensor* sp_buckets_t;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(1, TensorShape({output_size}),
+                                             &sp_buckets_t));
+    Tensor* sp_shape_t;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(2, TensorShape({2}), &sp_shape_t));
+
+    auto sp_indices = sp_indices_t->matrix<int64_t>();
+    auto sp_buckets = sp_buckets_t->vec<int64_t>();
+    auto sp_shape = sp_shape_t->vec<int64_t>();
+    sp_shape(0) = batch_size;
+    sp_shape(1) = max_num_entries;
+    size_t c = 0;
+    for (size_t i = 0; i < batch_size; ++i) {
+      for (size_t j = 0; j < num_indices[i]; ++j) {
+        sp_indices(c, 0) = i;
+        sp_indices(c, 1) = j;
+        ++c;
+      }
+    }
+
+    auto hash = [&](int64_t begin, int64_t end) {
+      for (int64_t k = begin; k < end; ++k) {
+        // The number of buckets is always in the positive range of int64, so
+        // the cast is safe.
+        sp_buckets(k) =
+            static_cast<int64_t>(Fingerprint64(tokens[k]) % num_buckets_);
+      }
+    };
+    // Estimate the cost per token from the average input length.
+    const int64_t cost_per_token =
+        kHashCyclesPerToken +
+        (output_size > 0 ? input_bytes / output_size : 0);
+    auto* worker_threads = ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads->num_threads, worker_threads->workers, output_size,
+          cost_per_token, hash);
+  }
+
+ private:
+  // Fixed cost of hashing one token and reducing it to a bucket.
+  static constexpr int64_t kHashCyclesPerToken = 64;
+
+  int maxsplit_;
+  int64_t num_buckets_;
+};
+
 REGISTER_KERNEL_BUILDER(Name("StringSplit").Device(DEVICE_CPU), StringSplitOp);
 REGISTER_KERNEL_BUILDER(Name("StringSplitV2").Device(DEVICE_CPU),
                         StringSplitV2Op);
+REGISTER_KERNEL_BUILDER(
+    Name("_StringSplitToHashBucketFast").Device(DEVICE_CPU),
+    StringSplitToHashBucketFastOp);
 
 }  // namespace tensorflow
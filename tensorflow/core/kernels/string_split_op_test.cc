@@ -126,4 +126,52 @@ BENCHMARK(BM_StringSplitV2)
     ->Arg(128)
     ->Arg(256);
 
+// With `fused`, splits and hashes with _StringSplitToHashBucketFast, which is
+// what the remapper rewrites the unfused StringSplitV2 and
+// StringToHashBucketFast into.
+Graph* SetupStringSplitToHashBucketGraph(const Tensor& input, bool fused) {
+  Graph* g = new Graph(OpRegistry::Global());
+  Tensor sep(DT_STRING, TensorShape({}));
+  sep.flat<tstring>().setConstant(" ");
+  const int64_t num_buckets = 1 << 20;
+
+  if (fused) {
+    TF_CHECK_OK(NodeBuilder("string_split_op", "_StringSplitToHashBucketFast")
+                    .Input(test::graph::Constant(g, input))
+                    .Input(test::graph::Constant(g, sep))
+                    .Attr("num_buckets", num_buckets)
+                    .Finalize(g, nullptr /* node */));
+    return g;
+  }
+  Node* split;
+  TF_CHECK_OK(NodeBuilder("string_split_op", "StringSplitV2")
+                  .Input(test::graph::Constant(g, input))
+                  .Input(test::graph::Constant(g, sep))
+                  .Finalize(g, &split));
+  TF_CHECK_OK(NodeBuilder("string_to_hash_bucket_op", "StringToHashBucketFast")
+                  .Input(split, 1)
+                  .Attr("num_buckets", num_buckets)
+                  .Finalize(g, nullptr /* node */));
+  return g;
+}
+
+static void BM_StringSplitToHashBucket(::testing::benchmark::State& state) {
+  const int batch_size = state.range(0);
+  const bool fused = state.range(1);
+
+  Tensor input = GetTestTensor(batch_size);
+  Graph* g = SetupStringSplitToHashBucketGraph(input, fused);
+  test::Benchmark("cpu", g, /*old_benchmark_api*/ false).Run(state);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+BENCHMARK(BM_StringSplitToHashBucket)
+    ->UseRealTime()
+    ->ArgPair(32, 0)
+    ->ArgPair(32, 1)
+    ->ArgPair(256, 0)
+    ->ArgPair(256, 1)
+    ->ArgPair(4096, 0)
+    ->ArgPair(4096, 1);
+
 }  // end namespace tensorflow
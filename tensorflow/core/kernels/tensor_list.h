@@ -134,9 +134,17 @@ class TensorList {
     out.max_num_elements = max_num_elements;
     // This performs a copy of the std::vector.
     out.tensors_->values_ = tensors_->values_;
+    out.tensors_->buffer_ = tensors_->buffer_;
     return out;
   }
 
+  // Optional contiguous tensor of shape [N] + element shape whose rows back
+  // the list elements, e.g. the input of TensorListFromTensor. Elements that
+  // are still views of consecutive rows of the buffer can be stacked without a
+  // copy. The buffer is never written to, so it is safe to share.
+  const Tensor& buffer() const { return tensors_->buffer_; }
+  void set_buffer(const Tensor& buffer) { tensors_->buffer_ = buffer; }
+
   // Is this TensorList the only one with a reference to the underlying
   // container?
   bool RefCountIsOne() const { return tensors_->RefCountIsOne(); }
@@ -145,6 +153,7 @@ class TensorList {
   class Tensors : public core::RefCounted {
    public:
     std::vector<Tensor> values_;
+    Tensor buffer_;
   };
   Tensors* tensors_;
 };
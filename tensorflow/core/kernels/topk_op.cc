@@ -20,6 +20,7 @@ limitations under the License.
 #include "tensorflow/core/kernels/topk_op.h"
 
 #include <algorithm>
+#include <memory>
 #include <numeric>
 #include <vector>
 
@@ -161,6 +162,21 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
       return absl::OkStatus();
     }
 
+    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
+    // A few long rows would leave most threads idle, so split each of them
+    // into column chunks instead.
+    if (k < num_cols && num_cols >= kMinColsForColumnChunks &&
+        num_rows < worker_threads.num_threads) {
+      const int64_t num_chunks = std::min<int64_t>(
+          (worker_threads.num_threads + num_rows - 1) / num_rows,
+          num_cols / (kMinChunkColsPerK * k));
+      if (num_chunks >= 2) {
+        ComputeByColumnChunks(worker_threads, sorted, k, input, num_rows,
+                              num_cols, num_chunks, values, indices);
+        return absl::OkStatus();
+      }
+    }
+
     auto SortIndices = [&](int64_t start_batch, int64_t limit_batch) {
       for (int32_t b = start_batch; b < limit_batch; ++b) {
         const T* input_data = &input(b, 0);
@@ -247,12 +263,96 @@ struct TopKFunctor<CPUDevice, T, Tidx> {
     const int64_t final_cost = (total_cost >= static_cast<double>(kint64max))
                                    ? kint64max
                                    : static_cast<int64_t>(total_cost);
-    auto worker_threads = *(context->device()->tensorflow_cpu_worker_threads());
     Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
           final_cost, SortIndices);
 
     return absl::OkStatus();
   }
+
+ private:
+  // Rows with at least this many columns may be split into column chunks.
+  static constexpr int64_t kMinColsForColumnChunks = 1 << 16;
+  // Each column chunk holds at least this many columns per selected element,
+  // so that the candidates of all chunks stay small compared to the row.
+  static constexpr int64_t kMinChunkColsPerK = 8;
+
+  // Orders indices into a row by descending value, breaking ties by
+  // ascending index, as the TopN path of `Compute` does.
+  struct StableGreater {
+    const T* input_data;
+    bool operator()(const Tidx a, const Tidx b) const {
+      if (input_data[b] < input_data[a]) {
+        return true;
+      } else if (input_data[b] > input_data[a]) {
+        return false;
+      } else {
+        return a < b;
+      }
+    }
+  };
+
+  // Selects the top `k` of each row in two passes: each of `num_chunks`
+  // column chunks of a row selects its own top `k` candidates in parallel,
+  // then the candidates of each row are reduced to the final top `k`. The
+  // order is total, so the result is the same as selecting from the whole
+  // row at once.
+  static void ComputeByColumnChunks(
+      const DeviceBase::CpuWorkerThreads& worker_threads, bool sorted, int k,
+      const typename TTypes<T, 2>::ConstTensor& input, const int64_t num_rows,
+      const int64_t num_cols, const int64_t num_chunks,
+      typename TTypes<T, 2>::Tensor values,
+      typename TTypes<Tidx, 2>::Tensor indices) {
+    const int64_t num_candidates = num_chunks * k;
+    std::vector<Tidx> candidates(num_rows * num_candidates);
+    const double cmp_cost = 3 * Eigen::TensorOpCost::AddCost<Tidx>() +
+                            Eigen::TensorOpCost::AddCost<T>();
+    const double log_k = Eigen::numext::log2(static_cast<float>(k + 1));
+
+    auto SelectChunk = [&](int64_t start, int64_t limit) {
+      for (int64_t task = start; task < limit; ++task) {
+        const int64_t b = task / num_chunks;
+        const int64_t chunk = task % num_chunks;
+        const Tidx col_begin = num_cols * chunk / num_chunks;
+        const Tidx col_end = num_cols * (chunk + 1) / num_chunks;
+        gtl::TopN<Tidx, StableGreater> filter(k, StableGreater{&input(b, 0)});
+        for (Tidx c = col_begin; c < col_end; ++c) {
+          filter.push(c);
+        }
+        // Each chunk has at least `k` columns, so it yields `k` candidates.
+        std::copy(filter.unsorted_begin(), filter.unsorted_end(),
+                  &candidates[task * k]);
+      }
+    };
+    const double chunk_cost =
+        4 * cmp_cost * static_cast<double>(num_cols / num_chunks) * log_k;
+    Shard(worker_threads.num_threads, worker_threads.workers,
+          num_rows * num_chunks, static_cast<int64_t>(chunk_cost),
+          SelectChunk);
+
+    auto MergeCandidates = [&](int64_t start_batch, int64_t limit_batch) {
+      for (int64_t b = start_batch; b < limit_batch; ++b) {
+        gtl::TopN<Tidx, StableGreater> filter(k, StableGreater{&input(b, 0)});
+        filter.reserve(num_candidates);
+        const Tidx* row_candidates = &candidates[b * num_candidates];
+        for (int64_t c = 0; c < num_candidates; ++c) {
+          filter.push(row_candidates[c]);
+        }
+        if (sorted) {
+          std::unique_ptr<std::vector<Tidx>> top_k(filter.Extract());
+          std::copy(top_k->begin(), top_k->end(), &indices(b, 0));
+        } else {
+          std::copy(filter.unsorted_begin(), filter.unsorted_end(),
+                    &indices(b, 0));
+        }
+        std::transform(&indices(b, 0), &indices(b, k), &values(b, 0),
+                       [b, &input](const Tidx loc) { return input(b, loc); });
+      }
+    };
+    const double merge_cost =
+        4 * cmp_cost * static_cast<double>(num_candidates) * log_k;
+    Shard(worker_threads.num_threads, worker_threads.workers, num_rows,
+          static_cast<int64_t>(merge_cost), MergeCandidates);
+  }
 };
 
 }  // namespace functor
@@ -102,6 +102,24 @@ absl::Status EnsureSparseVariableAccess(OpKernelContext* ctx, Var* var) {
   return absl::OkStatus();
 }
 
+// Like `EnsureSparseVariableAccess()`, for sparse operations that only read the
+// variable. A variable whose buffer is not owned, such as a view of a
+// memory-mapped checkpoint, is read without the private copy that
+// `EnsureSparseVariableAccess()` would make: every write copies such a buffer
+// before modifying it anyway. Copying up front would also read a lazily
+// restored variable in full and stop sharing its pages with other processes.
+template <typename Device, typename T>
+absl::Status EnsureSparseVariableReadAccess(OpKernelContext* ctx, Var* var) {
+  if (var->copy_on_read_mode.load()) {
+    return absl::OkStatus();
+  }
+  {
+    tsl::tf_shared_lock ml(*var->mu());
+    if (!var->tensor()->OwnsMemory()) return absl::OkStatus();
+  }
+  return EnsureSparseVariableAccess<Device, T>(ctx, var);
+}
+
 // Utility structure that releases a sequence of borrowed mutexes when it is
 // deleted.
 class VariableInputLockHolder {
@@ -120,6 +138,10 @@ class VariableInputLockHolder {
         shared_locks_(std::move(other.shared_locks_)) {}
 
   ~VariableInputLockHolder() {
+    // The holder is only taken around updates, which are done by now.
+    for (Var* var : vars_) {
+      var->MarkModified();
+    }
     // Release the locks before unrefing the Vars, because each lock
     // is potentially borrowed from a Var in vars_.
     locks_.reset();
@@ -17,6 +17,10 @@ limitations under the License.
 #include "tensorflow/core/kernels/training_ops.h"
 
 #include <algorithm>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
 
 #include "tensorflow/core/framework/bounds_check.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -1879,12 +1883,109 @@ REGISTER_KERNELS(GPU, double);
 #undef REGISTER_CPU_KERNELS
 #undef REGISTER_KERNELS
 
+namespace {
+
+// Below this many indices, duplicate indices are grouped with a hash map.
+// Above it, they are grouped by sorting, which avoids the random accesses
+// into a large map.
+constexpr int64_t kDeduplicateSortMinIndices = 1 << 16;
+
+// Sums the rows of `grad` whose `indices` are equal, so that a sparse update
+// touches each row of the variable once. On success `unique_indices` holds
+// each distinct index once, and row `i` of `summed_grad` is the sum of the
+// rows of `grad` for `unique_indices(i)`. The indices are not bounds checked.
+template <typename T, typename Tindex>
+absl::Status DeduplicateSparseGrad(OpKernelContext* ctx, const Tensor& grad,
+                                   const Tensor& indices,
+                                   Tensor* unique_indices,
+                                   Tensor* summed_grad) {
+  const int64_t N = indices.dim_size(0);
+  auto indices_vec = indices.vec<Tindex>();
+  std::vector<Tindex> uniques;
+  // The rows of `grad` for `uniques[u]` are `rows[offsets[u]:offsets[u+1]]`.
+  std::vector<int64_t> rows(N);
+  std::vector<int64_t> offsets;
+  if (N < kDeduplicateSortMinIndices) {
+    absl::flat_hash_map<Tindex, int64_t> unique_of;
+    unique_of.reserve(N);
+    std::vector<int64_t> unique_of_row(N);
+    offsets.push_back(0);
+    for (int64_t i = 0; i < N; ++i) {
+      const Tindex index = internal::SubtleMustCopy(indices_vec(i));
+      const int64_t next_unique = uniques.size();
+      auto it = unique_of.try_emplace(index, next_unique).first;
+      if (it->second == next_unique) {
+        uniques.push_back(index);
+        offsets.push_back(0);
+      }
+      unique_of_row[i] = it->second;
+      ++offsets[it->second + 1];
+    }
+    for (size_t u = 1; u < offsets.size(); ++u) offsets[u] += offsets[u - 1];
+    std::vector<int64_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (int64_t i = 0; i < N; ++i) rows[cursor[unique_of_row[i]]++] = i;
+  } else {
+    std::vector<std::pair<Tindex, int64_t>> sorted(N);
+    for (int64_t i = 0; i < N; ++i) {
+      sorted[i] = {internal::SubtleMustCopy(indices_vec(i)), i};
+    }
+    std::sort(sorted.begin(), sorted.end());
+    for (int64_t i = 0; i < N; ++i) {
+      if (i == 0 || sorted[i].first != sorted[i - 1].first) {
+        uniques.push_back(sorted[i].first);
+        offsets.push_back(i);
+      }
+      rows[i] = sorted[i].second;
+    }
+    offsets.push_back(N);
+  }
+
+  const int64_t num_unique = uniques.size();
+  TF_RETURN_IF_ERROR(ctx->allocate_temp(DataTypeToEnum<Tindex>::value,
+                                        TensorShape({num_unique}),
+                                        unique_indices));
+  std::copy(uniques.begin(), uniques.end(),
+            unique_indices->vec<Tindex>().data());
+  TensorShape summed_shape = grad.shape();
+  TF_RETURN_IF_ERROR(summed_shape.SetDimWithStatus(0, num_unique));
+  TF_RETURN_IF_ERROR(ctx->allocate_temp(DataTypeToEnum<T>::value,
+                                        summed_shape, summed_grad));
+  if (num_unique == 0) return absl::OkStatus();
+
+  auto grad_flat = grad.flat_outer_dims<T>();
+  auto summed_flat = summed_grad->flat_outer_dims<T>();
+  const int64_t inner_dim = grad_flat.dimension(1);
+  const int64_t rows_per_unique = N / num_unique;
+  const Eigen::TensorOpCost cost(
+      rows_per_unique * inner_dim * sizeof(T), inner_dim * sizeof(T),
+      rows_per_unique * inner_dim * Eigen::TensorOpCost::AddCost<T>());
+  ctx->eigen_cpu_device().parallelFor(
+      num_unique, cost, [&](int64_t begin, int64_t end) {
+        for (int64_t u = begin; u < end; ++u) {
+          auto out = summed_flat.template chip<0>(u);
+          out = grad_flat.template chip<0>(rows[offsets[u]]);
+          for (int64_t k = offsets[u] + 1; k < offsets[u + 1]; ++k) {
+            out += grad_flat.template chip<0>(rows[k]);
+          }
+        }
+      });
+  return absl::OkStatus();
+}
+
+}  // namespace
+
 template <typename Device, typename T, typename Tindex>
 class SparseApplyAdagradOp : public OpKernel {
  public:
   explicit SparseApplyAdagradOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
     OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("update_slots", &update_slots_));
+    OP_REQUIRES_OK(
+        ctx, ctx->GetAttr("deduplicate_indices", &deduplicate_indices_));
+    OP_REQUIRES(ctx,
+                !deduplicate_indices_ || ctx->device_type() == DEVICE_CPU,
+                errors::Unimplemented(
+                    "deduplicate_indices is only supported on CPU"));
   }
 
   void Compute(OpKernelContext* ctx) override TF_NO_THREAD_SAFETY_ANALYSIS {
@@ -1939,14 +2040,26 @@ class SparseApplyAdagradOp : public OpKernel {
                 errors::InvalidArgument(
                     "Inner dimension should be greater than zero."));
 
+    const Tensor* grad_in = &grad;
+    const Tensor* indices_in = &indices;
+    Tensor summed_grad;
+    Tensor unique_indices;
+    if (deduplicate_indices_) {
+      OP_REQUIRES_OK(ctx, DeduplicateSparseGrad<T, Tindex>(
+                              ctx, grad, indices, &unique_indices,
+                              &summed_grad));
+      grad_in = &summed_grad;
+      indices_in = &unique_indices;
+    }
+
     const Device& device = ctx->template eigen_device<Device>();
     OP_REQUIRES_OK(
         ctx, functor::SparseApplyAdagrad<Device, T, Tindex,
                                          /*has_epsilon = */ false>()(
                  device, var.flat_outer_dims<T>(), accum.flat_outer_dims<T>(),
                  // Note: Passing lr as a placeholder for unused epsilon.
-                 lr.scalar<T>(), lr.scalar<T>(), grad.flat_outer_dims<T>(),
-                 indices.vec<Tindex>(), inner_dim, update_slots_));
+                 lr.scalar<T>(), lr.scalar<T>(), grad_in->flat_outer_dims<T>(),
+                 indices_in->vec<Tindex>(), inner_dim, update_slots_));
 
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
@@ -1954,6 +2067,7 @@ class SparseApplyAdagradOp : public OpKernel {
  private:
   bool use_exclusive_lock_;
   bool update_slots_;
+  bool deduplicate_indices_;
 };
 
 #define REGISTER_KERNELS(D, T, Tindices)                                 \
@@ -2015,6 +2129,12 @@ class SparseApplyAdagradV2Op : public OpKernel {
   explicit SparseApplyAdagradV2Op(OpKernelConstruction* ctx) : OpKernel(ctx) {
     OP_REQUIRES_OK(ctx, ctx->GetAttr("use_locking", &use_exclusive_lock_));
     OP_REQUIRES_OK(ctx, ctx->GetAttr("update_slots", &update_slots_));
+    OP_REQUIRES_OK(
+        ctx, ctx->GetAttr("deduplicate_indices", &deduplicate_indices_));
+    OP_REQUIRES(ctx,
+                !deduplicate_indices_ || ctx->device_type() == DEVICE_CPU,
+                errors::Unimplemented(
+                    "deduplicate_indices is only supported on CPU"));
   }
 
   void Compute(OpKernelContext* ctx) override TF_NO_THREAD_SAFETY_ANALYSIS {
@@ -2073,13 +2193,26 @@ class SparseApplyAdagradV2Op : public OpKernel {
                 errors::InvalidArgument(
                     "Inner dimension should be greater than zero."));
 
+    const Tensor* grad_in = &grad;
+    const Tensor* indices_in = &indices;
+    Tensor summed_grad;
+    Tensor unique_indices;
+    if (deduplicate_indices_) {
+      OP_REQUIRES_OK(ctx, DeduplicateSparseGrad<T, Tindex>(
+                              ctx, grad, indices, &unique_indices,
+                              &summed_grad));
+      grad_in = &summed_grad;
+      indices_in = &unique_indices;
+    }
+
     const Device& device = ctx->template eigen_device<Device>();
     OP_REQUIRES_OK(
         ctx, functor::SparseApplyAdagrad<Device, T, Tindex,
                                          /*has_epsilon = */ true>()(
                  device, var.flat_outer_dims<T>(), accum.flat_outer_dims<T>(),
-                 lr.scalar<T>(), epsilon.scalar<T>(), grad.flat_outer_dims<T>(),
-                 indices.vec<Tindex>(), inner_dim, update_slots_));
+                 lr.scalar<T>(), epsilon.scalar<T>(),
+                 grad_in->flat_outer_dims<T>(), indices_in->vec<Tindex>(),
+                 inner_dim, update_slots_));
 
     MaybeForwardRefInputToRefOutput(ctx, 0, 0);
   }
@@ -2087,6 +2220,7 @@ class SparseApplyAdagradV2Op : public OpKernel {
  private:
   bool use_exclusive_lock_;
   bool update_slots_;
+  bool deduplicate_indices_;
 };
 
 #define REGISTER_KERNELS(D, T, Tindices)                                   \
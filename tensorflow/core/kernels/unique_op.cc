@@ -13,9 +13,13 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
+#include <cstdint>
 #include <functional>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "tensorflow/core/framework/bounds_check.h"
@@ -26,6 +30,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/bfloat16.h"
+#include "tensorflow/core/util/work_sharder.h"
 
 namespace tensorflow {
 namespace {
@@ -78,6 +83,12 @@ class UniqueOp : public OpKernel {
  public:
   explicit UniqueOp(OpKernelConstruction* context) : OpKernel(context) {}
 
+  // Inputs of integer keys with at least this many elements are uniquified
+  // in parallel by `ParallelUnique`.
+  static constexpr int64_t kParallelUniqueMinElements = 1 << 18;
+  // Upper bound on the number of hash partitions of `ParallelUnique`.
+  static constexpr int kMaxParallelUniquePartitions = 64;
+
   void Compute(OpKernelContext* context) override {
     const Tensor& input = context->input(0);
     // TODO(dga):  Make unique polymorphic for returning int32 and int64
@@ -150,6 +161,15 @@ class UniqueOp : public OpKernel {
       auto Tin = input.flat<T>();
       const int64_t N = static_cast<int64_t>(Tin.size());
 
+      if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
+        const int num_threads =
+            context->device()->tensorflow_cpu_worker_threads()->num_threads;
+        if (N >= kParallelUniqueMinElements && num_threads > 1) {
+          ParallelUnique(context, input, axis, idx_vec, num_threads);
+          return;
+        }
+      }
+
       typename UniqueOpHashMap<T, TIndex>::map_type uniq;
       uniq.reserve(2 * N);
       for (Eigen::Index i = 0, j = 0; i < N; ++i) {
@@ -237,6 +257,163 @@ class UniqueOp : public OpKernel {
       }
     }
   }
+
+ private:
+  // Uniquifies the integer vector `input` like the sequential hash map above,
+  // numbering the unique elements in order of first occurrence, but using
+  // all the worker threads:
+  //
+  //  1. The input is cut into blocks, and the positions of each block are
+  //     bucketed into hash partitions. Within a partition the positions stay
+  //     in input order.
+  //  2. Each partition is uniquified with its own hash map, which finds the
+  //     first occurrence of each of its elements.
+  //  3. The first occurrences are numbered by a prefix count over the input
+  //     blocks, which gives every unique element its final index.
+  void ParallelUnique(OpKernelContext* context, const Tensor& input,
+                      int64_t axis, typename TTypes<TIndex>::Vec idx_vec,
+                      int num_threads) {
+    auto Tin = input.flat<T>();
+    const int64_t N = static_cast<int64_t>(Tin.size());
+    auto* worker_threads = context->device()->tensorflow_cpu_worker_threads();
+
+    int log2_partitions = 1;
+    while ((1 << log2_partitions) < num_threads &&
+           (1 << log2_partitions) < kMaxParallelUniquePartitions) {
+      ++log2_partitions;
+    }
+    const int num_partitions = 1 << log2_partitions;
+    // Take the partition from the high bits of a multiplicative hash, which
+    // leaves the low bits used by the per-partition hash maps well mixed.
+    auto partition_of = [log2_partitions](T value) -> int {
+      return (static_cast<uint64_t>(value) * 0x9E3779B97F4A7C15ull) >>
+             (64 - log2_partitions);
+    };
+    const int64_t num_blocks = 4 * num_partitions;
+    auto block_begin = [N, num_blocks](int64_t block) {
+      return N * block / num_blocks;
+    };
+    const int64_t block_cost = 8 * N / num_blocks;
+
+    // 1. Bucket the input positions by partition, in input order.
+    std::vector<int64_t> cursors(num_blocks * num_partitions, 0);
+    Shard(num_threads, worker_threads->workers, num_blocks, block_cost,
+          [&](int64_t begin, int64_t end) {
+            for (int64_t b = begin; b < end; ++b) {
+              int64_t* counts = &cursors[b * num_partitions];
+              for (int64_t i = block_begin(b); i < block_begin(b + 1); ++i) {
+                ++counts[partition_of(Tin(i))];
+              }
+            }
+          });
+    std::vector<int64_t> partition_begin(num_partitions + 1, 0);
+    int64_t offset = 0;
+    for (int p = 0; p < num_partitions; ++p) {
+      partition_begin[p] = offset;
+      for (int64_t b = 0; b < num_blocks; ++b) {
+        const int64_t count = cursors[b * num_partitions + p];
+        cursors[b * num_partitions + p] = offset;
+        offset += count;
+      }
+    }
+    partition_begin[num_partitions] = N;
+    std::vector<int64_t> positions(N);
+    Shard(num_threads, worker_threads->workers, num_blocks, block_cost,
+          [&](int64_t begin, int64_t end) {
+            for (int64_t b = begin; b < end; ++b) {
+              int64_t* cursor = &cursors[b * num_partitions];
+              for (int64_t i = block_begin(b); i < block_begin(b + 1); ++i) {
+                positions[cursor[partition_of(Tin(i))]++] = i;
+              }
+            }
+          });
+
+    // 2. Uniquify each partition. `local_ids` parallels `positions`.
+    std::vector<int64_t> local_ids(N);
+    std::vector<std::vector<int64_t>> first_positions(num_partitions);
+    std::vector<std::vector<TIndex>> local_counts(num_partitions);
+    std::vector<uint8_t> is_first(N, 0);
+    const bool with_counts = num_outputs() > 2;
+    Shard(num_threads, worker_threads->workers, num_partitions,
+          32 * N / num_partitions, [&](int64_t begin, int64_t end) {
+            for (int64_t p = begin; p < end; ++p) {
+              absl::flat_hash_map<T, int64_t> uniq;
+              std::vector<int64_t>& firsts = first_positions[p];
+              for (int64_t k = partition_begin[p]; k < partition_begin[p + 1];
+                   ++k) {
+                const int64_t i = positions[k];
+                auto it = uniq.emplace(Tin(i), firsts.size());
+                if (it.second) {
+                  firsts.push_back(i);
+                  is_first[i] = 1;
+                  if (with_counts) local_counts[p].push_back(0);
+                }
+                local_ids[k] = it.first->second;
+                if (with_counts) ++local_counts[p][it.first->second];
+              }
+            }
+          });
+
+    // 3. Number the first occurrences in input order. The index of each
+    // unique element is stored at its first occurrence in `idx_vec`.
+    std::vector<int64_t> block_firsts(num_blocks + 1, 0);
+    Shard(num_threads, worker_threads->workers, num_blocks, N / num_blocks,
+          [&](int64_t begin, int64_t end) {
+            for (int64_t b = begin; b < end; ++b) {
+              int64_t count = 0;
+              for (int64_t i = block_begin(b); i < block_begin(b + 1); ++i) {
+                count += is_first[i];
+              }
+              block_firsts[b + 1] = count;
+            }
+          });
+    for (int64_t b = 0; b < num_blocks; ++b) {
+      block_firsts[b + 1] += block_firsts[b];
+    }
+    Shard(num_threads, worker_threads->workers, num_blocks, N / num_blocks,
+          [&](int64_t begin, int64_t end) {
+            for (int64_t b = begin; b < end; ++b) {
+              int64_t next_id = block_firsts[b];
+              for (int64_t i = block_begin(b); i < block_begin(b + 1); ++i) {
+                if (is_first[i]) idx_vec(i) = next_id++;
+              }
+            }
+          });
+
+    const int64_t uniq_size = block_firsts[num_blocks];
+    TensorShape output_shape(input.shape());
+    output_shape.set_dim(axis, uniq_size);
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, output_shape, &output));
+    auto Tout = output->flat<T>();
+    typename TTypes<TIndex>::Vec count_output_vec(nullptr, 0);
+    if (with_counts) {
+      Tensor* count_output = nullptr;
+      OP_REQUIRES_OK(context,
+                     context->allocate_output(2, TensorShape({uniq_size}),
+                                              &count_output));
+      count_output_vec = count_output->template vec<TIndex>();
+    }
+
+    // Every position takes the index of its element's first occurrence.
+    Shard(num_threads, worker_threads->workers, num_partitions,
+          8 * N / num_partitions, [&](int64_t begin, int64_t end) {
+            for (int64_t p = begin; p < end; ++p) {
+              const std::vector<int64_t>& firsts = first_positions[p];
+              std::vector<TIndex> ids(firsts.size());
+              for (size_t u = 0; u < firsts.size(); ++u) {
+                ids[u] = idx_vec(firsts[u]);
+                Tout(ids[u]) = Tin(firsts[u]);
+                if (with_counts) count_output_vec(ids[u]) = local_counts[p][u];
+              }
+              for (int64_t k = partition_begin[p]; k < partition_begin[p + 1];
+                   ++k) {
+                idx_vec(positions[k]) = ids[local_ids[k]];
+              }
+            }
+          });
+  }
 };
 
 #define REGISTER_UNIQUE(type)                                      \
@@ -0,0 +1,184 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+// CPU kernel for MatMul with float or bfloat16 activations and int8 or packed
+// int4 weights. Weights are dequantized tile by tile inside the kernel, so the
+// full precision weight matrix is never materialized.
+
+#define EIGEN_USE_THREADS
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/util/work_sharder.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Columns of `b` handled by one shard and rows of `b` dequantized at a time.
+// A float tile of kBlockK x kBlockN is 16KB and stays in L1 while every row of
+// `a` is multiplied with it.
+constexpr int64_t kBlockN = 64;
+constexpr int64_t kBlockK = 64;
+
+// Returns the signed 4-bit value stored in the low or high nibble of `byte`.
+inline int8_t UnpackInt4(int8_t byte, bool high) {
+  return high ? static_cast<int8_t>(byte >> 4)
+              : static_cast<int8_t>(static_cast<int8_t>(byte << 4) >> 4);
+}
+
+}  // namespace
+
+template <typename T>
+class WeightOnlyQuantizedMatMulOp : public OpKernel {
+ public:
+  explicit WeightOnlyQuantizedMatMulOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("weight_bits", &weight_bits_));
+    OP_REQUIRES(ctx, weight_bits_ == 4 || weight_bits_ == 8,
+                errors::InvalidArgument("weight_bits must be 4 or 8, got ",
+                                        weight_bits_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("group_size", &group_size_));
+    OP_REQUIRES(ctx, group_size_ >= 0,
+                errors::InvalidArgument("group_size must be non-negative, got ",
+                                        group_size_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& a = ctx->input(0);
+    const Tensor& b = ctx->input(1);
+    const Tensor& scales = ctx->input(2);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsMatrix(a.shape()),
+                errors::InvalidArgument("a must be a matrix, got shape ",
+                                        a.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsMatrix(b.shape()),
+                errors::InvalidArgument("b must be a matrix, got shape ",
+                                        b.shape().DebugString()));
+    OP_REQUIRES(ctx, TensorShapeUtils::IsMatrix(scales.shape()),
+                errors::InvalidArgument("scales must be a matrix, got shape ",
+                                        scales.shape().DebugString()));
+
+    const int64_t m = a.dim_size(0);
+    const int64_t k = a.dim_size(1);
+    const int64_t n = b.dim_size(1);
+    const int64_t b_rows = weight_bits_ == 8 ? k : (k + 1) / 2;
+    OP_REQUIRES(
+        ctx, b.dim_size(0) == b_rows,
+        errors::InvalidArgument("b must have ", b_rows, " rows for ",
+                                weight_bits_, "-bit weights and a with ", k,
+                                " columns, got shape ",
+                                b.shape().DebugString()));
+    const int64_t group_size = group_size_ == 0 ? std::max<int64_t>(k, 1)
+                                                : group_size_;
+    const int64_t num_groups =
+        std::max<int64_t>((k + group_size - 1) / group_size, 1);
+    OP_REQUIRES(
+        ctx, scales.dim_size(0) == num_groups && scales.dim_size(1) == n,
+        errors::InvalidArgument("scales must have shape [", num_groups, ", ",
+                                n, "], got ", scales.shape().DebugString()));
+
+    Tensor* product = nullptr;
+    OP_REQUIRES_OK(ctx,
+                   ctx->allocate_output(0, TensorShape({m, n}), &product));
+    if (product->NumElements() == 0) return;
+
+    const T* a_data = a.flat<T>().data();
+    const int8_t* b_data = b.flat<int8>().data();
+    const float* scales_data = scales.flat<float>().data();
+    T* product_data = product->flat<T>().data();
+    const int weight_bits = weight_bits_;
+
+    // Each shard owns a range of column blocks, dequantizes the kBlockK rows
+    // of a block into `tile` and accumulates all rows of `a` into `acc`.
+    auto compute_blocks = [&](int64_t begin, int64_t end) {
+      std::vector<float> tile(kBlockK * kBlockN);
+      std::vector<float> acc(m * kBlockN);
+      for (int64_t block = begin; block < end; ++block) {
+        const int64_t n0 = block * kBlockN;
+        const int64_t nc = std::min(kBlockN, n - n0);
+        std::fill(acc.begin(), acc.end(), 0.0f);
+        for (int64_t k0 = 0; k0 < k; k0 += kBlockK) {
+          const int64_t kc = std::min(kBlockK, k - k0);
+          for (int64_t kk = 0; kk < kc; ++kk) {
+            const int64_t row = k0 + kk;
+            const float* scale = scales_data + (row / group_size) * n + n0;
+            float* tile_row = tile.data() + kk * kBlockN;
+            if (weight_bits == 8) {
+              const int8_t* q = b_data + row * n + n0;
+              for (int64_t j = 0; j < nc; ++j) {
+                tile_row[j] = static_cast<float>(q[j]) * scale[j];
+              }
+            } else {
+              const int8_t* q = b_data + (row / 2) * n + n0;
+              const bool high = row % 2 == 1;
+              for (int64_t j = 0; j < nc; ++j) {
+                tile_row[j] =
+                    static_cast<float>(UnpackInt4(q[j], high)) * scale[j];
+              }
+            }
+          }
+          for (int64_t i = 0; i < m; ++i) {
+            const T* a_row = a_data + i * k + k0;
+            float* acc_row = acc.data() + i * kBlockN;
+            for (int64_t kk = 0; kk < kc; ++kk) {
+              const float a_value = static_cast<float>(a_row[kk]);
+              const float* tile_row = tile.data() + kk * kBlockN;
+              for (int64_t j = 0; j < nc; ++j) {
+                acc_row[j] += a_value * tile_row[j];
+              }
+            }
+          }
+        }
+        for (int64_t i = 0; i < m; ++i) {
+          const float* acc_row = acc.data() + i * kBlockN;
+          T* out_row = product_data + i * n + n0;
+          for (int64_t j = 0; j < nc; ++j) {
+            out_row[j] = static_cast<T>(acc_row[j]);
+          }
+        }
+      }
+    };
+
+    const int64_t num_blocks = (n + kBlockN - 1) / kBlockN;
+    const int64_t cost_per_block = std::max<int64_t>(2 * m * k * kBlockN, 1);
+    auto worker_threads = *ctx->device()->tensorflow_cpu_worker_threads();
+    Shard(worker_threads.num_threads, worker_threads.workers, num_blocks,
+          cost_per_block, compute_blocks);
+  }
+
+ private:
+  int32 weight_bits_;
+  int64_t group_size_;
+};
+
+#define REGISTER_CPU(T)                                         \
+  REGISTER_KERNEL_BUILDER(Name("WeightOnlyQuantizedMatMul")     \
+                              .Device(DEVICE_CPU)               \
+                              .TypeConstraint<T>("T"),          \
+                          WeightOnlyQuantizedMatMulOp<T>);
+
+TF_CALL_float(REGISTER_CPU);
+TF_CALL_bfloat16(REGISTER_CPU);
+#undef REGISTER_CPU
+
+}  // namespace tensorflow
@@ -0,0 +1,132 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class WeightOnlyQuantizedMatMulOpTest : public OpsTestBase {
+ protected:
+  template <typename T>
+  absl::Status BuildOp(int weight_bits, int group_size) {
+    TF_RETURN_IF_ERROR(
+        NodeDefBuilder("matmul", "WeightOnlyQuantizedMatMul")
+            .Input(FakeInput(DataTypeToEnum<T>::v()))
+            .Input(FakeInput(DT_INT8))
+            .Input(FakeInput(DT_FLOAT))
+            .Attr("T", DataTypeToEnum<T>::v())
+            .Attr("weight_bits", weight_bits)
+            .Attr("group_size", group_size)
+            .Finalize(node_def()));
+    return InitOp();
+  }
+
+  // Runs the op on deterministic [m, k] activations and [k, n] weights in
+  // [-8, 7], and checks it against a float MatMul with the dequantized weights.
+  template <typename T>
+  void RunAndCheck(int64_t m, int64_t k, int64_t n, int weight_bits,
+                   int group_size, float tolerance) {
+    TF_ASSERT_OK(BuildOp<T>(weight_bits, group_size));
+    std::vector<float> a(m * k);
+    for (int64_t i = 0; i < m * k; ++i) {
+      a[i] = static_cast<float>(static_cast<T>((i % 13) * 0.25f - 1.5f));
+    }
+    std::vector<int8> weights(k * n);
+    for (int64_t i = 0; i < k * n; ++i) weights[i] = (i * 7) % 16 - 8;
+    const int64_t group = group_size == 0 ? k : group_size;
+    const int64_t num_groups = (k + group - 1) / group;
+    std::vector<float> scales(num_groups * n);
+    for (int64_t i = 0; i < num_groups * n; ++i) {
+      scales[i] = 0.01f * (1 + i % 9);
+    }
+
+    std::vector<int8> b;
+    if (weight_bits == 8) {
+      b = weights;
+    } else {
+      b.assign(((k + 1) / 2) * n, 0);
+      for (int64_t row = 0; row < k; ++row) {
+        for (int64_t col = 0; col < n; ++col) {
+          const uint8_t nibble = weights[row * n + col] & 0xf;
+          b[(row / 2) * n + col] |= row % 2 ? nibble << 4 : nibble;
+        }
+      }
+    }
+
+    std::vector<T> a_t(a.begin(), a.end());
+    AddInputFromArray<T>(TensorShape({m, k}), a_t);
+    const int64_t b_rows = b.size() / n;
+    AddInputFromArray<int8>(TensorShape({b_rows, n}), b);
+    AddInputFromArray<float>(TensorShape({num_groups, n}), scales);
+    TF_ASSERT_OK(RunOpKernel());
+
+    Tensor expected(DT_FLOAT, TensorShape({m, n}));
+    auto expected_matrix = expected.matrix<float>();
+    for (int64_t i = 0; i < m; ++i) {
+      for (int64_t j = 0; j < n; ++j) {
+        float sum = 0;
+        for (int64_t l = 0; l < k; ++l) {
+          const float scale = scales[(l / group) * n + j];
+          sum += a[i * k + l] * weights[l * n + j] * scale;
+        }
+        expected_matrix(i, j) = sum;
+      }
+    }
+    Tensor output(DT_FLOAT, TensorShape({m, n}));
+    output.flat<float>() = GetOutput(0)->flat<T>().template cast<float>();
+    test::ExpectClose(expected, output, tolerance, tolerance);
+  }
+};
+
+TEST_F(WeightOnlyQuantizedMatMulOpTest, Int8PerChannel) {
+  // Spans several column and row blocks, with partial last blocks.
+  RunAndCheck<float>(3, 150, 130, /*weight_bits=*/8, /*group_size=*/0, 1e-4);
+}
+
+TEST_F(WeightOnlyQuantizedMatMulOpTest, Int8Grouped) {
+  RunAndCheck<float>(5, 128, 64, /*weight_bits=*/8, /*group_size=*/32, 1e-4);
+}
+
+TEST_F(WeightOnlyQuantizedMatMulOpTest, PackedInt4GroupedOddRows) {
+  RunAndCheck<float>(2, 77, 70, /*weight_bits=*/4, /*group_size=*/16, 1e-4);
+}
+
+TEST_F(WeightOnlyQuantizedMatMulOpTest, Bfloat16Activations) {
+  RunAndCheck<bfloat16>(4, 96, 80, /*weight_bits=*/4, /*group_size=*/0, 5e-2);
+}
+
+TEST_F(WeightOnlyQuantizedMatMulOpTest, RejectsMismatchedScales) {
+  TF_ASSERT_OK(BuildOp<float>(/*weight_bits=*/8, /*group_size=*/2));
+  AddInputFromArray<float>(TensorShape({1, 4}), {1, 2, 3, 4});
+  AddInputFromArray<int8>(TensorShape({4, 1}), {1, 2, 3, 4});
+  AddInputFromArray<float>(TensorShape({1, 1}), {1});
+  const absl::Status status = RunOpKernel();
+  EXPECT_TRUE(absl::StrContains(status.message(), "scales must have shape"))
+      << status;
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -96,6 +96,16 @@ REGISTER_OP("BatchFunction")
     // NOTE: Support for `enable_large_batch_splitting == true` is still
     // developed in progress.
     .Attr("enable_large_batch_splitting: bool = false")
+    // If non-empty, inputs are batched separately per sequence length bucket.
+    // The sequence length of an input is the size of dimension 1 of its
+    // tensors, and the boundaries split lengths into buckets like
+    // `tf.data.experimental.bucket_by_sequence_length` does. Within a batch,
+    // tensors are padded with zeros along dimension 1 to the longest input.
+    .Attr("length_bucket_boundaries: list(int) = []")
+    // The maximum number of batches whose function runs concurrently. If
+    // greater than 1, the inputs of the next batch are concatenated while the
+    // previous batches run, instead of after they have finished.
+    .Attr("pipeline_depth: int >= 1 = 1")
     // TODO(apassos): Fix this shape inference function. It requires shape
     // inference of function calls.
     .SetShapeFn(shape_inference::UnknownShape)
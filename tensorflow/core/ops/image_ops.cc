@@ -528,6 +528,47 @@ REGISTER_OP("DecodeAndCropJpeg")
       return absl::OkStatus();
     });
 
+// --------------------------------------------------------------------------
+REGISTER_OP("BatchDecodeAndResizeImage")
+    .Input("contents: string")
+    .Input("crop_windows: int32")
+    .Input("size: int32")
+    .Attr("channels: int = 3")
+    .Attr("use_dct_scaling: bool = false")
+    .Attr("fancy_upscaling: bool = true")
+    .Attr("dct_method: string = ''")
+    .Output("images: float")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle contents;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 1, &contents));
+      DimensionHandle batch = c->Dim(contents, 0);
+
+      ShapeHandle crop_windows;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &crop_windows));
+      TF_RETURN_IF_ERROR(c->Merge(batch, c->Dim(crop_windows, 0), &batch));
+      DimensionHandle unused_dim;
+      TF_RETURN_IF_ERROR(
+          c->WithValue(c->Dim(crop_windows, 1), 4, &unused_dim));
+
+      int32_t channels;
+      TF_RETURN_IF_ERROR(c->GetAttr("channels", &channels));
+      if (channels != 1 && channels != 3) {
+        return errors::InvalidArgument("channels must be 1 or 3, got ",
+                                       channels);
+      }
+
+      ShapeHandle size;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 1, &size));
+      TF_RETURN_IF_ERROR(c->WithValue(c->Dim(size, 0), 2, &unused_dim));
+      ShapeHandle height_width;
+      TF_RETURN_IF_ERROR(c->MakeShapeFromShapeTensor(2, &height_width));
+
+      c->set_output(0, c->MakeShape({batch, c->Dim(height_width, 0),
+                                     c->Dim(height_width, 1),
+                                     c->MakeDim(channels)}));
+      return absl::OkStatus();
+    });
+
 // --------------------------------------------------------------------------
 REGISTER_OP("EncodeJpeg")
     .Input("image: uint8")
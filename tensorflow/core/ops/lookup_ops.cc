@@ -483,6 +483,22 @@ REGISTER_OP("AnonymousMutableDenseHashTable")
     .SetIsStateful()
     .SetShapeFn(MutableDenseHashTableShapeFn);
 
+REGISTER_OP("ShardedMutableDenseHashTable")
+    .Input("empty_key: key_dtype")
+    .Input("deleted_key: key_dtype")
+    .Output("table_handle: resource")
+    .Attr("container: string = ''")
+    .Attr("shared_name: string = ''")
+    .Attr("use_node_name_sharing: bool = false")
+    .Attr("key_dtype: type")
+    .Attr("value_dtype: type")
+    .Attr("value_shape: shape = {}")
+    .Attr("initial_num_buckets: int = 131072")  // 2^17
+    .Attr("max_load_factor: float = 0.8")
+    .Attr("num_shards: int = 16")
+    .SetIsStateful()
+    .SetShapeFn(MutableDenseHashTableShapeFn);
+
 REGISTER_OP("InitializeTable")
     .Input("table_handle: Ref(string)")
     .Input("keys: Tkey")
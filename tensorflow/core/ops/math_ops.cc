@@ -352,6 +352,25 @@ REGISTER_OP("_UnaryOpsComposition")
 expected to create these operators.
 )doc");
 
+REGISTER_OP("_FusedElementwise")
+    .Input("args: num_args * T")
+    .Output("y: T")
+    .Attr("T: {float, double}")
+    .Attr("num_args: int >= 1")
+    .Attr("op_names: list(string)")
+    .SetShapeFn(shape_inference::UnchangedShape)
+    .Doc(R"doc(
+Evaluates a chain of element-wise ops in a single pass over its inputs.
+
+Starting from `args[0]`, each op in `op_names` is applied in turn to the
+running value. Unary ops take only the running value, binary ops take the
+running value as their first operand and the next unused arg as the second.
+Every arg after the first must have the shape of `args[0]` or a single element.
+
+*NOTE*: Do not invoke this operator directly in Python. Graph rewrite pass is
+expected to create these operators.
+)doc");
+
 #undef UNARY
 #undef UNARY_REAL
 #undef UNARY_COMPLEX
@@ -899,6 +918,43 @@ REGISTER_OP("SparseMatMul")
     .Attr("Tb: {float, bfloat16} = DT_FLOAT")
     .SetShapeFn(shape_inference::MatMulShape);
 
+REGISTER_OP("WeightOnlyQuantizedMatMul")
+    .Input("a: T")
+    .Input("b: int8")
+    .Input("scales: float")
+    .Output("product: T")
+    .Attr("T: {float, bfloat16}")
+    .Attr("weight_bits: int = 8")
+    .Attr("group_size: int = 0")
+    .SetShapeFn([](InferenceContext* c) {
+      int32_t weight_bits;
+      TF_RETURN_IF_ERROR(c->GetAttr("weight_bits", &weight_bits));
+      if (weight_bits != 4 && weight_bits != 8) {
+        return errors::InvalidArgument("weight_bits must be 4 or 8, got ",
+                                       weight_bits);
+      }
+      ShapeHandle a;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 2, &a));
+      ShapeHandle b;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 2, &b));
+      ShapeHandle scales;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), 2, &scales));
+
+      // Packed int4 weights hold two rows of `b` per byte.
+      DimensionHandle k = c->Dim(a, 1);
+      if (weight_bits == 4 && c->ValueKnown(k)) {
+        k = c->MakeDim((c->Value(k) + 1) / 2);
+      } else if (weight_bits == 4) {
+        k = c->UnknownDim();
+      }
+      DimensionHandle unused;
+      TF_RETURN_IF_ERROR(c->Merge(k, c->Dim(b, 0), &unused));
+      DimensionHandle n;
+      TF_RETURN_IF_ERROR(c->Merge(c->Dim(b, 1), c->Dim(scales, 1), &n));
+      c->set_output(0, c->Matrix(c->Dim(a, 0), n));
+      return absl::OkStatus();
+    });
+
 REGISTER_OP("_FusedMatMul")
     .Input("a: T")
     .Input("b: T")
@@ -1354,6 +1410,43 @@ REGISTER_OP("SparseSegmentSumWithNumSegments")
     .Attr("sparse_gradient: bool = false")
     .SetShapeFn(SparseSegmentReductionWithNumSegmentsShapeFn);
 
+REGISTER_OP("_FusedWeightedSparseSegmentSum")
+    .Input("data: T")
+    .Input("indices: Tidx")
+    .Input("weights: T")
+    .Input("segment_ids: Tsegmentids")
+    .Output("output: T")
+    .Attr("T: {float, double}")
+    .Attr("Tidx: {int32, int64} = DT_INT32")
+    .Attr("Tsegmentids: {int32, int64} = DT_INT32")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle data_shape;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 1, &data_shape));
+      ShapeHandle indices_shape;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &indices_shape));
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(2), 1, &unused));
+      ShapeHandle segment_ids_shape;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(3), 1, &segment_ids_shape));
+      TF_RETURN_IF_ERROR(c->Merge(indices_shape, segment_ids_shape, &unused));
+
+      ShapeHandle subshape;
+      TF_RETURN_IF_ERROR(c->Subshape(data_shape, 1, &subshape));
+      ShapeHandle out;
+      TF_RETURN_IF_ERROR(c->Concatenate(
+          c->Vector(InferenceContext::kUnknownDim), subshape, &out));
+      c->set_output(0, out);
+      return absl::OkStatus();
+    })
+    .Doc(R"doc(
+Computes SegmentSum(Gather(data, indices) * weights, segment_ids).
+
+The gathered rows are scaled and accumulated directly into the output, without
+materializing the gathered and weighted intermediates. `weights` must have shape
+`[N, 1, ..., 1]` or `[1, ..., 1]`, where N is the number of indices, and
+`segment_ids` must be sorted as for SegmentSum.
+)doc");
+
 REGISTER_OP("SparseSegmentSumGrad")
     .Input("grad: T")
     .Input("indices: Tidx")
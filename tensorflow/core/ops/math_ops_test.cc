@@ -448,6 +448,34 @@ TEST(MathOpsTest, BatchMatMul_ShapeFn) {
   INFER_ERROR("are 2 and 3", op, "[?,2,1];[?,1,3]");  // inner dim mismatch
 }
 
+TEST(MathOpsTest, WeightOnlyQuantizedMatMul_ShapeFn) {
+  ShapeInferenceTestOp op("WeightOnlyQuantizedMatMul");
+  auto set_weight_bits = [&op](int weight_bits) {
+    TF_ASSERT_OK(NodeDefBuilder("test", "WeightOnlyQuantizedMatMul")
+                     .Input({"a", 0, DT_FLOAT})
+                     .Input({"b", 0, DT_INT8})
+                     .Input({"scales", 0, DT_FLOAT})
+                     .Attr("weight_bits", weight_bits)
+                     .Finalize(&op.node_def));
+  };
+
+  set_weight_bits(8);
+  INFER_ERROR("must be rank 2", op, "[1];?;?");
+  INFER_OK(op, "?;?;?", "[?,?]");
+  INFER_OK(op, "[3,4];[4,5];[1,5]", "[d0_0,d1_1]");
+  INFER_OK(op, "[3,4];[4,?];[2,5]", "[d0_0,d2_1]");
+  INFER_ERROR("must be equal", op, "[3,4];[2,5];?");
+  INFER_ERROR("must be equal", op, "?;[4,5];[1,6]");
+
+  // Packed int4 weights hold two rows per byte.
+  set_weight_bits(4);
+  INFER_OK(op, "[3,5];[3,6];[1,6]", "[d0_0,d1_1]");
+  INFER_ERROR("must be equal", op, "[3,4];[4,6];?");
+
+  set_weight_bits(3);
+  INFER_ERROR("weight_bits must be 4 or 8", op, "?;?;?");
+}
+
 TEST(MathOpsTest, ArgOps_ShapeFn) {
   ShapeInferenceTestOp op("ArgMax");
   op.input_tensors.resize(2);
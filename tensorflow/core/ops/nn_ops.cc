@@ -1289,6 +1289,53 @@ REGISTER_OP("Softmax")
       return shape_inference::UnchangedShapeWithRankAtLeast(c, 1);
     });
 
+REGISTER_OP("_FusedScaledDotProductAttention")
+    .Input("query: T")
+    .Input("key: T")
+    .Input("value: T")
+    .Output("output: T")
+    .Attr("T: {float, double}")
+    .Attr("scale: float = 1.0")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle query;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 3, &query));
+      ShapeHandle key;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), c->Rank(query), &key));
+      ShapeHandle value;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(2), c->Rank(query), &value));
+
+      // query, key and value share their batch dimensions, key and value
+      // share their sequence length, and query and key share their depth.
+      ShapeHandle batch;
+      TF_RETURN_IF_ERROR(c->Subshape(query, 0, -2, &batch));
+      ShapeHandle other_batch;
+      TF_RETURN_IF_ERROR(c->Subshape(key, 0, -2, &other_batch));
+      TF_RETURN_IF_ERROR(c->Merge(batch, other_batch, &batch));
+      TF_RETURN_IF_ERROR(c->Subshape(value, 0, -2, &other_batch));
+      TF_RETURN_IF_ERROR(c->Merge(batch, other_batch, &batch));
+      DimensionHandle unused;
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(key, -2), c->Dim(value, -2), &unused));
+      TF_RETURN_IF_ERROR(
+          c->Merge(c->Dim(query, -1), c->Dim(key, -1), &unused));
+
+      ShapeHandle out;
+      TF_RETURN_IF_ERROR(c->Concatenate(
+          batch, c->Matrix(c->Dim(query, -2), c->Dim(value, -1)), &out));
+      c->set_output(0, out);
+      return absl::OkStatus();
+    })
+    .Doc(R"doc(
+Computes `Softmax(scale * query * key^T) * value` over the last two dimensions.
+
+The keys are visited in blocks while a running maximum and sum are kept for
+each query row, so the `[query_len, key_len]` attention matrix is never
+materialized.
+
+*NOTE*: Do not invoke this operator directly in Python. Graph rewrite pass is
+expected to create these operators.
+)doc");
+
 // --------------------------------------------------------------------------
 
 REGISTER_OP("LogSoftmax")
@@ -145,4 +145,34 @@ client_terminated: If set to true, this indicates that the node was added
   locally by the caller.
 )doc");
 
+REGISTER_OP("_PackTensors")
+    .Input("values: T")
+    .Output("packed: uint8")
+    .Attr("T: list(type) >= 1")
+    .SetShapeFn(shape_inference::UnknownShape)
+    .Doc(R"doc(
+Packs several tensors into one, so that they can be sent between devices
+with a single _Send. The inverse of _UnpackTensors.
+
+Added by graph partitioning only.
+
+values: The tensors to pack. Their types must be copyable with memcpy.
+packed: A header describing the shapes of `values`, followed by their
+  contents.
+)doc");
+
+REGISTER_OP("_UnpackTensors")
+    .Input("packed: uint8")
+    .Output("values: T")
+    .Attr("T: list(type) >= 1")
+    .SetShapeFn(shape_inference::UnknownShape)
+    .Doc(R"doc(
+Unpacks the tensors packed by _PackTensors.
+
+Added by graph partitioning only.
+
+packed: The output of a _PackTensors with the same `T`.
+values: The unpacked tensors.
+)doc");
+
 }  // end namespace tensorflow
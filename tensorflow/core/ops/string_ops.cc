@@ -95,6 +95,33 @@ Do not invoke this operator directly in Python. A fusion optimization is
 expected to create these operators.
 )doc");
 
+REGISTER_OP("_StringSplitToHashBucketFast")
+    .Input("input: string")
+    .Input("sep: string")
+    .Output("indices: int64")
+    .Output("values: int64")
+    .Output("shape: int64")
+    .Attr("maxsplit: int = -1")
+    .Attr("num_buckets: int >= 1")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 1, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 0, &unused));
+
+      c->set_output(0, c->Matrix(InferenceContext::kUnknownDim, 2));
+      c->set_output(1, c->Vector(InferenceContext::kUnknownDim));
+      c->set_output(2, c->Vector(2));
+      return absl::OkStatus();
+    })
+    .Doc(R"doc(
+Internal operation which is a composition of splitting strings (StringSplitV2)
+and then hashing the tokens (StringToHashBucketFast): reserved for internal
+use.
+
+Do not invoke this operator directly in Python. A fusion optimization is
+expected to create these operators.
+)doc");
+
 REGISTER_OP("StringToHashBucketStrong")
     .Input("input: string")
     .Output("output: int64")
@@ -18,10 +18,13 @@ limitations under the License.
 #include <sys/stat.h>
 
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "xla/tsl/lib/core/status_test_util.h"
 #include "tensorflow/core/framework/graph.pb.h"
 #include "tensorflow/core/framework/node_def.pb.h"
+#include "tensorflow/core/platform/blocking_counter.h"
 #include "tensorflow/core/platform/cord.h"
 #include "tensorflow/core/platform/null_file_system.h"
 #include "tensorflow/core/platform/path.h"
@@ -92,6 +95,41 @@ TEST_F(DefaultEnvTest, IncompleteReadOutOfRange) {
   EXPECT_EQ(input, result);
 }
 
+TEST_F(DefaultEnvTest, ReadAsync) {
+  const string filename = io::JoinPath(BaseDir(), "read_async");
+  const int kLength = 1 << 20;
+  const string input = CreateTestFile(env_, filename, kLength);
+  std::unique_ptr<RandomAccessFile> f;
+  TF_ASSERT_OK(env_->NewRandomAccessFile(filename, &f));
+
+  // Keeps many reads in flight, the last one past EOF.
+  const int kNumReads = 64;
+  const size_t kReadSize = kLength / kNumReads;
+  std::vector<std::unique_ptr<char[]>> scratch(kNumReads);
+  std::vector<absl::Status> statuses(kNumReads);
+  std::vector<string> results(kNumReads);
+  BlockingCounter counter(kNumReads);
+  for (int i = 0; i < kNumReads; ++i) {
+    scratch[i].reset(new char[kReadSize + 1]);
+    const size_t n = i == kNumReads - 1 ? kReadSize + 1 : kReadSize;
+    f->ReadAsync(i * kReadSize, n, scratch[i].get(),
+                 [&, i](absl::Status s, absl::string_view result) {
+                   statuses[i] = std::move(s);
+                   results[i] = string(result);
+                   counter.DecrementCount();
+                 });
+  }
+  counter.Wait();
+  for (int i = 0; i < kNumReads; ++i) {
+    if (i == kNumReads - 1) {
+      EXPECT_EQ(error::OUT_OF_RANGE, statuses[i].code());
+    } else {
+      TF_EXPECT_OK(statuses[i]);
+    }
+    EXPECT_EQ(input.substr(i * kReadSize, kReadSize), results[i]);
+  }
+}
+
 TEST_F(DefaultEnvTest, ReadFileToString) {
   for (const int length : {0, 1, 1212, 2553, 4928, 8196, 9000, (1 << 20) - 1,
                            1 << 20, (1 << 20) + 1, (256 << 20) + 100}) {
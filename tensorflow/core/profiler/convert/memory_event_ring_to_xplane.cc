@@ -0,0 +1,109 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/convert/memory_event_ring_to_xplane.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+#include "absl/types/span.h"
+#include "xla/tsl/framework/memory_event_ring.h"
+#include "xla/tsl/profiler/utils/xplane_builder.h"
+#include "xla/tsl/profiler/utils/xplane_schema.h"
+#include "tsl/profiler/protobuf/xplane.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+using tsl::profiler::GetStatTypeStr;
+using tsl::profiler::StatType;
+using tsl::profiler::XEventBuilder;
+using tsl::profiler::XLineBuilder;
+using tsl::profiler::XPlaneBuilder;
+using tsl::profiler::XStatMetadata;
+
+// Keeps the allocator lines clear of thread ids, which are 32 bits.
+constexpr int64_t kFirstMemoryEventLineId = int64_t{1} << 40;
+
+}  // namespace
+
+void ConvertMemoryEventRingsToXPlane(
+    absl::Span<const tsl::MemoryEventRing::Snapshot> snapshots,
+    XPlane* host_plane) {
+  // All lines share one timestamp, since the memory profile orders events
+  // across allocators by their offset.
+  int64_t start_ns = std::numeric_limits<int64_t>::max();
+  for (const auto& snapshot : snapshots) {
+    if (!snapshot.events.empty()) {
+      start_ns = std::min(start_ns, snapshot.events.front().timestamp_ns);
+    }
+  }
+  if (start_ns == std::numeric_limits<int64_t>::max()) return;
+
+  XPlaneBuilder plane(host_plane);
+  const auto& allocation_metadata =
+      *plane.GetOrCreateEventMetadata("MemoryAllocation");
+  const auto& deallocation_metadata =
+      *plane.GetOrCreateEventMetadata("MemoryDeallocation");
+  auto stat = [&plane](StatType type) -> const XStatMetadata& {
+    return *plane.GetOrCreateStatMetadata(GetStatTypeStr(type));
+  };
+  const XStatMetadata& allocator_name_stat = stat(StatType::kAllocatorName);
+  const XStatMetadata& bytes_reserved_stat = stat(StatType::kBytesReserved);
+  const XStatMetadata& bytes_allocated_stat = stat(StatType::kBytesAllocated);
+  const XStatMetadata& bytes_available_stat = stat(StatType::kBytesAvailable);
+  const XStatMetadata& peak_bytes_stat = stat(StatType::kPeakBytesInUse);
+  const XStatMetadata& requested_bytes_stat = stat(StatType::kRequestedBytes);
+  const XStatMetadata& allocation_bytes_stat = stat(StatType::kAllocationBytes);
+  const XStatMetadata& address_stat = stat(StatType::kAddress);
+  const XStatMetadata& tf_op_stat = stat(StatType::kTfOp);
+  const XStatMetadata& step_id_stat = stat(StatType::kStepId);
+
+  int64_t line_id = kFirstMemoryEventLineId;
+  for (const auto& snapshot : snapshots) {
+    if (snapshot.events.empty()) continue;
+    XLineBuilder line = plane.GetOrCreateLine(line_id++);
+    line.SetName(snapshot.allocator_name);
+    line.SetTimestampNs(start_ns);
+    line.ReserveEvents(snapshot.events.size());
+    const XStatMetadata& allocator_name =
+        *plane.GetOrCreateStatMetadata(snapshot.allocator_name);
+    for (const tsl::MemoryEvent& event : snapshot.events) {
+      XEventBuilder xevent = line.AddEvent(
+          event.is_allocation ? allocation_metadata : deallocation_metadata);
+      xevent.SetTimestampNs(event.timestamp_ns);
+      xevent.AddStatValue(allocator_name_stat, allocator_name);
+      xevent.AddStatValue(bytes_reserved_stat, event.bytes_reserved);
+      xevent.AddStatValue(bytes_allocated_stat, event.bytes_in_use);
+      xevent.AddStatValue(bytes_available_stat,
+                          snapshot.memory_limit - event.bytes_reserved -
+                              event.bytes_in_use);
+      xevent.AddStatValue(peak_bytes_stat, event.peak_bytes_in_use);
+      xevent.AddStatValue(requested_bytes_stat, event.requested_bytes);
+      xevent.AddStatValue(allocation_bytes_stat, event.allocation_bytes);
+      xevent.AddStatValue(address_stat, static_cast<int64_t>(event.address));
+      xevent.AddStatValue(step_id_stat, event.step_id);
+      auto op_name = snapshot.op_names.find(event.op_name_hash);
+      if (op_name != snapshot.op_names.end()) {
+        xevent.AddStatValue(tf_op_stat, op_name->second);
+      }
+    }
+  }
+}
+
+}  // namespace profiler
+}  // namespace tensorflow
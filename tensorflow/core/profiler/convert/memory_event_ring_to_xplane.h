@@ -0,0 +1,38 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_PROFILER_CONVERT_MEMORY_EVENT_RING_TO_XPLANE_H_
+#define TENSORFLOW_CORE_PROFILER_CONVERT_MEMORY_EVENT_RING_TO_XPLANE_H_
+
+#include "absl/types/span.h"
+#include "xla/tsl/framework/memory_event_ring.h"
+#include "tsl/profiler/protobuf/xplane.pb.h"
+
+namespace tensorflow {
+namespace profiler {
+
+// Adds the events of `snapshots` to `host_plane` as MemoryAllocation and
+// MemoryDeallocation events, on one line per allocator, with the same stats
+// as the allocator TraceMes. The result can be passed to
+// ConvertXPlaneToMemoryProfile to build a memory timeline without having had
+// host tracing enabled.
+void ConvertMemoryEventRingsToXPlane(
+    absl::Span<const tsl::MemoryEventRing::Snapshot> snapshots,
+    XPlane* host_plane);
+
+}  // namespace profiler
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_PROFILER_CONVERT_MEMORY_EVENT_RING_TO_XPLANE_H_
@@ -0,0 +1,85 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/profiler/convert/memory_event_ring_to_xplane.h"
+
+#include <vector>
+
+#include "xla/tsl/framework/memory_event_ring.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/profiler/convert/xplane_to_memory_profile.h"
+#include "tensorflow/core/profiler/protobuf/memory_profile.pb.h"
+#include "tensorflow/core/profiler/protobuf/xplane.pb.h"
+#include "tensorflow/core/profiler/utils/xplane_test_utils.h"
+
+namespace tensorflow {
+namespace profiler {
+namespace {
+
+tsl::MemoryEvent MakeEvent(int64_t timestamp_ns, bool is_allocation,
+                           uint64_t address, int64_t bytes,
+                           int64_t bytes_in_use, int64_t peak_bytes_in_use) {
+  tsl::MemoryEvent event;
+  event.timestamp_ns = timestamp_ns;
+  event.is_allocation = is_allocation;
+  event.address = address;
+  event.requested_bytes = bytes;
+  event.allocation_bytes = bytes;
+  event.bytes_in_use = bytes_in_use;
+  event.bytes_reserved = 0;
+  event.peak_bytes_in_use = peak_bytes_in_use;
+  event.step_id = 1;
+  return event;
+}
+
+TEST(ConvertMemoryEventRingsToXPlane, BuildsMemoryProfile) {
+  tsl::MemoryEventRing ring("GPU_0_bfc", /*memory_limit=*/10000,
+                            /*capacity=*/16);
+  ring.Record(MakeEvent(1000, true, 1, 256, 256, 256), "foo/bar");
+  ring.Record(MakeEvent(2000, true, 2, 512, 768, 768), "mul_grad/Sum");
+  ring.Record(MakeEvent(3000, false, 1, 256, 512, 768), nullptr);
+
+  XSpace space;
+  XPlane* host_plane = GetOrCreateHostXPlane(&space);
+  std::vector<tsl::MemoryEventRing::Snapshot> snapshots = {ring.GetSnapshot()};
+  ConvertMemoryEventRingsToXPlane(snapshots, host_plane);
+
+  MemoryProfile memory_profile = ConvertXPlaneToMemoryProfile(*host_plane);
+  ASSERT_EQ(memory_profile.memory_profile_per_allocator_size(), 1);
+  const PerAllocatorMemoryProfile& profile =
+      memory_profile.memory_profile_per_allocator().at("GPU_0_bfc");
+  EXPECT_EQ(profile.profile_summary().peak_bytes_usage_lifetime(), 768);
+  EXPECT_EQ(profile.profile_summary().peak_stats().peak_bytes_in_use(), 768);
+  EXPECT_EQ(profile.profile_summary().peak_stats_time_ps(), 1000000);
+  EXPECT_EQ(profile.profile_summary().memory_capacity(), 10000);
+}
+
+TEST(ConvertMemoryEventRingsToXPlane, RingKeepsNewestEvents) {
+  tsl::MemoryEventRing ring("CPU_0_bfc", /*memory_limit=*/10000,
+                            /*capacity=*/2);
+  ring.Record(MakeEvent(1000, true, 1, 256, 256, 256), "a");
+  ring.Record(MakeEvent(2000, true, 2, 256, 512, 512), "b");
+  ring.Record(MakeEvent(3000, true, 3, 256, 768, 768), "c");
+
+  tsl::MemoryEventRing::Snapshot snapshot = ring.GetSnapshot();
+  ASSERT_EQ(snapshot.events.size(), 2);
+  EXPECT_EQ(snapshot.events[0].timestamp_ns, 2000);
+  EXPECT_EQ(snapshot.events[1].timestamp_ns, 3000);
+  EXPECT_EQ(snapshot.op_names.at(snapshot.events[1].op_name_hash), "c");
+}
+
+}  // namespace
+}  // namespace profiler
+}  // namespace tensorflow
@@ -21,14 +21,19 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
 #include "absl/strings/strip.h"
+#include "xla/service/hlo.pb.h"
 #include "xla/tsl/profiler/utils/tf_xplane_visitor.h"
 #include "tensorflow/core/framework/step_stats.pb.h"
 #include "tensorflow/core/platform/types.h"
 #include "tensorflow/core/profiler/protobuf/xplane.pb.h"
 #include "tensorflow/core/profiler/utils/gpu_event_stats.h"
+#include "tensorflow/core/profiler/utils/hlo_proto_map.h"
 #include "tensorflow/core/profiler/utils/math_utils.h"
 #include "tensorflow/core/profiler/utils/xplane_schema.h"
 #include "tensorflow/core/profiler/utils/xplane_utils.h"
@@ -62,6 +67,72 @@ GpuEventType ParseMemcpyName(absl::string_view memcpy_name) {
   return GpuEventType::kUnknown;
 }
 
+// Names of the TF ops an HLO instruction was lowered from, by program id and
+// HLO instruction name.
+using TfOpNamesByHloOp = absl::flat_hash_map<
+    uint64_t, absl::flat_hash_map<std::string, std::vector<std::string>>>;
+
+// Maps the HLO instructions of the programs in xspace to the TF ops in their
+// op metadata. For fusions, these include the ops of the fused instructions.
+TfOpNamesByHloOp GetTfOpNamesByHloOp(const XSpace& xspace) {
+  TfOpNamesByHloOp tf_op_names_by_hlo_op;
+  for (const auto& [program_id, hlo_proto] : ParseHloProtosFromXSpace(xspace)) {
+    const xla::HloModuleProto& module = hlo_proto->hlo_module();
+    absl::flat_hash_map<int64_t, const xla::HloComputationProto*> computations;
+    for (const xla::HloComputationProto& computation : module.computations()) {
+      computations[computation.id()] = &computation;
+    }
+    auto& tf_op_names = tf_op_names_by_hlo_op[program_id];
+    for (const xla::HloComputationProto& computation : module.computations()) {
+      for (const xla::HloInstructionProto& instruction :
+           computation.instructions()) {
+        std::vector<std::string>& names = tf_op_names[instruction.name()];
+        absl::flat_hash_set<absl::string_view> seen;
+        auto add_op_name = [&](const xla::HloInstructionProto& instr) {
+          const std::string& op_name = instr.metadata().op_name();
+          if (!op_name.empty() && seen.insert(op_name).second) {
+            names.push_back(op_name);
+          }
+        };
+        add_op_name(instruction);
+        if (instruction.opcode() != "fusion") continue;
+        std::vector<int64_t> pending(
+            instruction.called_computation_ids().begin(),
+            instruction.called_computation_ids().end());
+        while (!pending.empty()) {
+          auto it = computations.find(pending.back());
+          pending.pop_back();
+          if (it == computations.end()) continue;
+          for (const xla::HloInstructionProto& fused :
+               it->second->instructions()) {
+            add_op_name(fused);
+            pending.insert(pending.end(),
+                           fused.called_computation_ids().begin(),
+                           fused.called_computation_ids().end());
+          }
+        }
+      }
+    }
+  }
+  return tf_op_names_by_hlo_op;
+}
+
+// Returns the names of the TF ops that an XLA kernel executes.
+std::vector<std::string> GetTfOpNames(
+    const GpuEventStats& stats, const TfOpNamesByHloOp& tf_op_names_by_hlo_op) {
+  std::vector<std::string> tf_op_names;
+  if (!stats.program_id.has_value()) return tf_op_names;
+  auto program = tf_op_names_by_hlo_op.find(*stats.program_id);
+  if (program == tf_op_names_by_hlo_op.end()) return tf_op_names;
+  for (absl::string_view hlo_op_name : stats.hlo_op_names) {
+    auto hlo_op = program->second.find(hlo_op_name);
+    if (hlo_op == program->second.end()) continue;
+    tf_op_names.insert(tf_op_names.end(), hlo_op->second.begin(),
+                       hlo_op->second.end());
+  }
+  return tf_op_names;
+}
+
 void SetNodeTimes(const XEventVisitor& event, NodeExecStats* ns) {
   ns->set_all_start_micros(tsl::profiler::NanoToMicro(event.TimestampNs()));
   ns->set_op_start_rel_micros(0);
@@ -83,6 +154,7 @@ void ConvertGpuXSpaceToStepStats(const XSpace& xspace, StepStats* step_stats) {
 
   absl::flat_hash_map<int64_t /*correlation_id*/, CorrelationInfo>
       correlation_info_map;
+  const TfOpNamesByHloOp tf_op_names_by_hlo_op = GetTfOpNamesByHloOp(xspace);
 
   absl::flat_hash_map<uint32_t /*device_id*/, DeviceStepStats*>
       sync_dev_stats_map;
@@ -120,6 +192,8 @@ void ConvertGpuXSpaceToStepStats(const XSpace& xspace, StepStats* step_stats) {
     DeviceStepStats* unknown_stream_dev_stats = nullptr;
     DeviceStepStats* all_streams_dev_stats = nullptr;
     DeviceStepStats* memcpy_dev_stats = nullptr;
+    absl::flat_hash_map<absl::string_view /*hlo_module_name*/, DeviceStepStats*>
+        xla_module_dev_stats_map;
     XPlaneVisitor plane = tsl::profiler::CreateTfXPlaneVisitor(device_plane);
     uint32_t device_ordinal = plane.Id();
     plane.ForEachLine([&](const XLineVisitor& line) {
@@ -143,12 +217,34 @@ void ConvertGpuXSpaceToStepStats(const XSpace& xspace, StepStats* step_stats) {
 
         absl::string_view node_name =
             stats.IsTfOp() ? stats.tf_op_fullname : event.Name();
+        // Attribute XLA kernels to the TF ops they were compiled from.
+        std::vector<std::string> tf_op_names;
+        if (!stats.IsTfOp() && stats.IsXlaOp()) {
+          tf_op_names = GetTfOpNames(stats, tf_op_names_by_hlo_op);
+          if (!tf_op_names.empty()) node_name = tf_op_names.front();
+        }
         ns->set_node_name(std::string(node_name));
 
         if (stats.IsKernel()) {
           absl::string_view kernel_name = event.Name();
           ns->set_timeline_label(
               absl::StrCat(kernel_name, " ", stats.kernel_details));
+          if (!tf_op_names.empty()) {
+            absl::StrAppend(ns->mutable_timeline_label(), " tf_ops:",
+                            absl::StrJoin(tf_op_names, ","));
+          }
+          // Break the time of each XLA cluster down by kernel.
+          if (stats.IsXlaOp() && !stats.hlo_module_name.empty()) {
+            DeviceStepStats*& xla_module_dev_stats =
+                xla_module_dev_stats_map[stats.hlo_module_name];
+            if (xla_module_dev_stats == nullptr) {
+              xla_module_dev_stats = step_stats->add_dev_stats();
+              xla_module_dev_stats->set_device(
+                  absl::StrCat("/device:GPU:", device_ordinal,
+                               "/xla_module:", stats.hlo_module_name));
+            }
+            *xla_module_dev_stats->add_node_stats() = *ns;
+          }
           DeviceStepStats*& stream_dev_stats =
               stream_dev_stats_map[{stream_id, GpuEventType::kKernel}];
           if (stream_dev_stats == nullptr) {
@@ -172,6 +172,15 @@ class KernelFallbackCompatRequestState {
     client_graph_resource_context_ = client_graph_resource_context;
   }
 
+  // Nullable. If set, serves the host allocations of kernels that
+  // `OpKernelRunner::may_use_request_arena()` in this request.
+  tensorflow::Allocator* request_allocator() const {
+    return request_allocator_;
+  }
+  void set_request_allocator(tensorflow::Allocator* request_allocator) {
+    request_allocator_ = request_allocator;
+  }
+
   void set_runtime_config(
       const tensorflow::tfrt_stub::RuntimeConfig* runtime_config) {
     runtime_config_ = runtime_config;
@@ -223,6 +232,9 @@ class KernelFallbackCompatRequestState {
   tfrt::ResourceContext* client_graph_resource_context_ = nullptr;
 
   const tensorflow::tfrt_stub::RuntimeConfig* runtime_config_ = nullptr;
+
+  // Not owned.
+  tensorflow::Allocator* request_allocator_ = nullptr;
 };
 
 // Set up fallback context with common tensorflow states such as devices,
@@ -54,6 +54,9 @@ void SetUpParams(const tfrt_stub::OpKernelRunner& runner,
   params.rendezvous = fallback_request_state.rendezvous();
   params.session_metadata = &fallback_request_state.session_metadata();
   params.cancellation_manager = fallback_request_state.cancellation_manager();
+  params.step_allocator = runner.may_use_request_arena()
+                              ? fallback_request_state.request_allocator()
+                              : nullptr;
 }
 
 // Return the device to be used for the fallback kernel execution. The device is
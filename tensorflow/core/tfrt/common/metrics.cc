@@ -45,5 +45,17 @@ tsl::monitoring::SamplerCell* GetTfrtDeviceExecutionLatency(
   return cell->GetCell(model_name, absl::StrCat(model_version));
 }
 
+tsl::monitoring::SamplerCell* GetTfrtRequestArenaAllocationsSampler(
+    const std::string& model_name, int64_t model_version,
+    const std::string& source) {
+  static auto* cell = tsl::monitoring::Sampler<3>::New(
+      {"/tfrt/graph_executor/request_arena_allocations",
+       "Tracks the number of host allocations of a request served by the "
+       "request arena or forwarded to the CPU allocator.",
+       "model_name", "model_version", "source"},
+      tsl::monitoring::Buckets::Exponential(1, 2, 20));
+  return cell->GetCell(model_name, absl::StrCat(model_version), source);
+}
+
 }  // namespace tfrt_metrics
 }  // namespace tensorflow
@@ -31,6 +31,13 @@ tsl::monitoring::SamplerCell* GetTfrtGraphExecutorLatencySampler(
 tsl::monitoring::SamplerCell* GetTfrtDeviceExecutionLatency(
     const std::string& model_name, int64_t model_version);
 
+// Tracks the number of host allocations per request that were served by the
+// request arena (`source` is "arena") or forwarded to the CPU allocator because
+// the arena was full (`source` is "fallback").
+tsl::monitoring::SamplerCell* GetTfrtRequestArenaAllocationsSampler(
+    const std::string& model_name, int64_t model_version,
+    const std::string& source);
+
 }  // namespace tfrt_metrics
 }  // namespace tensorflow
 
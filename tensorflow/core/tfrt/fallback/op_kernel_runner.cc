@@ -154,6 +154,13 @@ OpKernelRunner::OpKernelRunner(
   info_->resource_manager = device->resource_manager();
   info_->is_async = (op_kernel_->AsAsync() != nullptr);
 
+  const OpDef* op_def = nullptr;
+  info_->may_use_request_arena =
+      device->device_type() == DEVICE_CPU && !info_->is_async &&
+      OpRegistry::Global()->LookUpOpDef(op_kernel_->type_string(), &op_def)
+          .ok() &&
+      !op_def->is_stateful();
+
   const auto& input_memory_types = op_kernel_->input_memory_types();
 
   auto& input_alloc_attrs = info_->input_alloc_attrs;
@@ -99,6 +99,11 @@ class OpKernelRunner {
 
   bool IsAsync() const { return info_->is_async; }
 
+  // Returns true if the host allocations of this kernel may be served from a
+  // per-request host arena, i.e. the kernel runs synchronously on a CPU device
+  // and is stateless, so its outputs are unlikely to outlive the request.
+  bool may_use_request_arena() const { return info_->may_use_request_arena; }
+
   tensorflow::OpKernel* op_kernel() const { return op_kernel_.get(); }
   tensorflow::Device* device() const { return info_->device; }
   tensorflow::FunctionLibraryRuntime* function_library_runtime() const {
@@ -130,6 +135,7 @@ class OpKernelRunner {
     tensorflow::FunctionLibraryRuntime* function_library_runtime = nullptr;
     tensorflow::ResourceMgr* resource_manager = nullptr;
     bool is_async = false;
+    bool may_use_request_arena = false;
     absl::InlinedVector<AllocatorAttributes, 4UL> input_alloc_attrs;
     absl::InlinedVector<AllocatorAttributes, 1UL> output_alloc_attrs;
   };
@@ -60,6 +60,14 @@ REGISTER_KERNEL_BUILDER(Name("TestOp").Device(DEVICE_CPU), TestOpKernel);
 // not have `f` attribute. Users will not invoke this op directly.
 REGISTER_OP("TestOp").Input("x: int32").Output("y: int32");
 
+REGISTER_KERNEL_BUILDER(Name("TestStatefulOp").Device(DEVICE_CPU),
+                        TestOpKernel);
+
+REGISTER_OP("TestStatefulOp")
+    .Input("x: int32")
+    .Output("y: int32")
+    .SetIsStateful();
+
 TEST(OpKernelRunnerTest, Create) {
   tensorflow::SessionOptions session_options;
   tensorflow::FunctionDefLibrary fdef_lib;
@@ -83,6 +91,31 @@ TEST(OpKernelRunnerTest, Create) {
   EXPECT_EQ(runner.op_kernel()->name(), "TestOp_node_name");
 }
 
+TEST(OpKernelRunnerTest, MayUseRequestArena) {
+  tensorflow::SessionOptions session_options;
+  tensorflow::FunctionDefLibrary fdef_lib;
+  TF_ASSERT_OK_AND_ASSIGN(auto fallback_state,
+                          FallbackState::Create(session_options, fdef_lib));
+
+  auto create_runner = [&](absl::string_view op_name) {
+    return OpKernelRunner::Create(
+        op_name, /*node_name=*/op_name,
+        /*device_name=*/"/job:localhost/replica:0/task:0/device:CPU:0",
+        /*num_args=*/1,
+        /*attr_builder=*/
+        [](tensorflow::AttrValueMap*) { return absl::OkStatus(); },
+        fallback_state->device_manager(),
+        fallback_state->process_function_library_runtime());
+  };
+
+  TF_ASSERT_OK_AND_ASSIGN(auto stateless_runner, create_runner("TestOp"));
+  EXPECT_TRUE(stateless_runner.may_use_request_arena());
+
+  TF_ASSERT_OK_AND_ASSIGN(auto stateful_runner,
+                          create_runner("TestStatefulOp"));
+  EXPECT_FALSE(stateful_runner.may_use_request_arena());
+}
+
 TEST(OpKernelRunnerTest, OpKernelRunnerCache) {
   tensorflow::SessionOptions session_options;
   tensorflow::FunctionDefLibrary fdef_lib;
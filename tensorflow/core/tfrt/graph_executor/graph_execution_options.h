@@ -96,10 +96,23 @@ struct GraphExecutionOptions {
     // Number of times to record costs before resetting Op cost estimates.
     // However, a reset always occurs after the first execution.
     int updates_per_interval = 1;
+
+    // If true, the executable is recompiled with the recorded costs on a
+    // background thread and swapped in once ready, instead of on the thread of
+    // the request that completed the measurement cycle. Requests keep running
+    // the previous executable in the meantime.
+    bool recompile_in_background = false;
   };
 
   CostAnalysisOptions cost_analysis_options;
 
+  // If true, each request serves the host allocations of synchronous,
+  // stateless fallback kernels from its own arena, which is returned to the
+  // CPU allocator in one shot once the request and the tensors allocated from
+  // it are gone. Tensors that outlive the request, such as its outputs, keep
+  // the arena alive until they are released.
+  bool enable_request_arena_allocator = false;
+
   // If true, the MLRT interpreter will be used instead of the BEF executor.
   // This option is experimental.
   bool enable_mlrt = false;
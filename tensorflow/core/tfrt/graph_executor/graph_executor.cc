@@ -65,6 +65,7 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/lib/gtl/cleanup.h"
 #include "tensorflow/core/lib/monitoring/gauge.h"
+#include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
@@ -286,6 +287,13 @@ absl::StatusOr<std::unique_ptr<RequestInfo>> CreateRequestInfo(
   fallback_request_state.set_runtime_config(&options.runtime_config);
   fallback_request_state.set_cancellation_manager(
       &request_info->cancellation_manager);
+  if (options.enable_request_arena_allocator) {
+    request_info->request_arena.reset(
+        new StepArenaAllocator(fallback_state.device_manager().HostCPU()
+                                   ->GetAllocator(AllocatorAttributes())));
+    fallback_request_state.set_request_allocator(
+        request_info->request_arena.get());
+  }
 
   // Set priority in the builder.
   tfrt::RequestOptions request_options;
@@ -325,6 +333,16 @@ absl::Status GraphExecutionRunOnFunction(
                         resource_context, client_graph_resource_context,
                         runner_table, resource_array, fallback_state,
                         process_function_library_runtime, cost_recorder));
+  auto record_request_arena_stats = tensorflow::gtl::MakeCleanup([&]() {
+    if (request_info->request_arena == nullptr) return;
+    const auto& model_metadata = options.model_metadata;
+    tensorflow::tfrt_metrics::GetTfrtRequestArenaAllocationsSampler(
+        model_metadata.name(), model_metadata.version(), "arena")
+        ->Add(request_info->request_arena->GetStats()->num_allocs);
+    tensorflow::tfrt_metrics::GetTfrtRequestArenaAllocationsSampler(
+        model_metadata.name(), model_metadata.version(), "fallback")
+        ->Add(request_info->request_arena->num_fallback_allocs());
+  });
 
   int64_t request_id = request_info->tfrt_request_context->id();
   // The top level traceme root for this request. The thread pool used later
@@ -499,6 +517,14 @@ GraphExecutor::GraphExecutor(
       kernel_registry_(std::move(kernel_registry)),
       resource_context_(std::move(resource_context)) {
   DCHECK(resource_context_);
+  if (options_.cost_analysis_options.version !=
+          Options::CostAnalysisOptions::kDisabled &&
+      options_.cost_analysis_options.recompile_in_background) {
+    recompilation_thread_pool_ =
+        std::make_unique<tensorflow::thread::ThreadPool>(
+            tensorflow::Env::Default(), "tfrt_cost_recompilation",
+            /*num_threads=*/1);
+  }
   SetSessionCreatedMetric();
 }
 
@@ -654,14 +680,20 @@ absl::Status GraphExecutor::Run(
       &req_deadline_tracker_, loaded_client_graph.stream_callback_id(),
       cost_recorder));
 
-  if (do_recompilation) {
-    TF_RETURN_IF_ERROR(
-        loaded_client_graph.UpdateCost(*cost_recorder, runtime()));
-    tensorflow::mutex_lock l(num_recompilations_mu_);
-    num_recompilations_ += 1;
-  }
-  if (cost_recorder != nullptr) {
-    loaded_client_graph.UpdateCostAnalysisData(now, do_recompilation);
+  if (do_recompilation && recompilation_thread_pool_ != nullptr) {
+    // The background task takes over updating `cost_analysis_data_`.
+    loaded_client_graph.UpdateCostInBackground(now,
+                                               *recompilation_thread_pool_);
+  } else {
+    if (do_recompilation) {
+      TF_RETURN_IF_ERROR(
+          loaded_client_graph.UpdateCost(*cost_recorder, runtime()));
+      tensorflow::mutex_lock l(num_recompilations_mu_);
+      num_recompilations_ += 1;
+    }
+    if (cost_recorder != nullptr) {
+      loaded_client_graph.UpdateCostAnalysisData(now, do_recompilation);
+    }
   }
   // Create the outputs from the actual function results, which are sorted
   // according to the output tensor names.
@@ -1110,6 +1142,24 @@ absl::Status GraphExecutor::LoadedClientGraph::UpdateCost(
   return absl::OkStatus();
 }
 
+void GraphExecutor::LoadedClientGraph::UpdateCostInBackground(
+    absl::Time now, tensorflow::thread::ThreadPool& thread_pool) {
+  thread_pool.Schedule([this, now]() {
+    // `cost_recorder` stays alive until `UpdateCostAnalysisData()`, as no
+    // other thread can obtain it before then.
+    absl::Status status = UpdateCost(*cost_analysis_data_.cost_recorder,
+                                     graph_executor_->runtime());
+    if (status.ok()) {
+      tensorflow::mutex_lock l(graph_executor_->num_recompilations_mu_);
+      graph_executor_->num_recompilations_ += 1;
+    } else {
+      LOG(ERROR) << "TFRT failed to recompile loaded client graph (" << this
+                 << ") " << name_ << " with recorded costs: " << status;
+    }
+    UpdateCostAnalysisData(now, /*do_recompilation=*/true);
+  });
+}
+
 GraphExecutor::LoadedClientGraph::LoadedClientGraph(
     std::string name, SymbolUids symbol_uids, GraphExecutor* graph_executor,
     std::unique_ptr<mlir::MLIRContext> mlir_context,
@@ -37,12 +37,14 @@ limitations under the License.
 #include "xla/tsl/concurrency/ref_count.h"
 #include "xla/tsl/lib/monitoring/sampler.h"
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
+#include "tensorflow/core/common_runtime/step_arena_allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/status.h"
 #include "tensorflow/core/platform/statusor.h"
+#include "tensorflow/core/platform/threadpool.h"
 #include "tensorflow/core/protobuf/config.pb.h"
 #include "tensorflow/core/runtime_fallback/kernel/kernel_fallback_compat_request_state.h"
 #include "tensorflow/core/tfrt/fallback/cost_recorder.h"
@@ -85,6 +87,9 @@ struct RequestInfo {
   std::function<void(std::function<void()>)> runner;
 
   tensorflow::CancellationManager cancellation_manager;
+  // Serves the host allocations of this request's kernels if
+  // `GraphExecutionOptions::enable_request_arena_allocator` is set.
+  core::RefCountPtr<StepArenaAllocator> request_arena;
 };
 
 struct SymbolUids {
@@ -170,6 +175,11 @@ class GraphExecutor {
     // `cost_recorder`.
     absl::Status UpdateCost(const CostRecorder& cost_recorder,
                             const Runtime& runtime);
+    // Schedules `UpdateCost()` with this instance's CostRecorder, followed by
+    // `UpdateCostAnalysisData()`, on `thread_pool`. Costs are not recorded
+    // again until the update finishes.
+    void UpdateCostInBackground(absl::Time now,
+                                tensorflow::thread::ThreadPool& thread_pool);
     // Updates `cost_analysis_data_` to make it accurate for the next execution.
     // Assumes a cost update occurred this cycle.
     void UpdateCostAnalysisData(absl::Time now, bool do_recompilation);
@@ -381,6 +391,12 @@ class GraphExecutor {
   absl::Duration simulated_duration_ = absl::ZeroDuration();
   tensorflow::mutex num_recompilations_mu_;
   int num_recompilations_ TF_GUARDED_BY(num_recompilations_mu_) = 0;
+
+ private:
+  // Runs recompilations with recorded costs if
+  // `CostAnalysisOptions::recompile_in_background` is set. Declared last so
+  // that pending recompilations finish before the state they use is destroyed.
+  std::unique_ptr<tensorflow::thread::ThreadPool> recompilation_thread_pool_;
 };
 
 void RegisterMlirDialect(mlir::DialectRegistry& registry,
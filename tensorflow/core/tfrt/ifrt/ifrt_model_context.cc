@@ -16,13 +16,25 @@ limitations under the License.
 
 #include "tensorflow/core/tfrt/ifrt/ifrt_model_context.h"
 
+#include <algorithm>
+#include <vector>
 
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/types/span.h"
+#include "tensorflow/core/tfrt/ifrt/ifrt_executable_registry.h"
+#include "tensorflow/core/tfrt/ifrt/ifrt_serving_executable.h"
+#include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
 #include "tsl/platform/threadpool.h"
 
 namespace tensorflow {
 namespace ifrt_serving {
+namespace {
+
+constexpr int kMaxWarmupThreads = 16;
+
+}  // namespace
 
 tsl::thread::ThreadPool& IfrtModelContext::GetThreadPool() const {
   return thread_pool_;
@@ -37,5 +49,41 @@ absl::Status IfrtModelContext::Freeze() {
   return absl::OkStatus();
 }
 
+absl::Status IfrtModelContext::Warmup(
+    absl::Span<const IfrtWarmupSignature> signatures) {
+  if (frozen_) {
+    return absl::FailedPreconditionError(
+        "Cannot warm up a model that is already frozen.");
+  }
+  if (signatures.empty()) return absl::OkStatus();
+
+  std::vector<absl::Status> statuses(signatures.size());
+  {
+    // A dedicated pool, since warming up blocks on variable loading that may
+    // itself need `thread_pool_`. Its destructor waits for all warmups.
+    tsl::thread::ThreadPool warmup_thread_pool(
+        tsl::Env::Default(), "ifrt_warmup",
+        std::min<int>(signatures.size(), kMaxWarmupThreads));
+    for (int i = 0; i < signatures.size(); ++i) {
+      warmup_thread_pool.Schedule([&signature = signatures[i],
+                                   &status = statuses[i]]() {
+        IfrtServingExecutable* executable =
+            ServingExecutableRegistry::Lookup(signature.program_id);
+        if (executable == nullptr) {
+          status = absl::NotFoundError(absl::StrCat(
+              "No IFRT program registered under id ", signature.program_id));
+          return;
+        }
+        status = executable->Warmup(signature.inputs,
+                                    signature.variable_arg_indices);
+      });
+    }
+  }
+  for (const absl::Status& status : statuses) {
+    TF_RETURN_IF_ERROR(status);
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace ifrt_serving
 }  // namespace tensorflow
@@ -17,18 +17,21 @@ limitations under the License.
 #define TENSORFLOW_CORE_TFRT_IFRT_IFRT_MODEL_CONTEXT_H_
 
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <utility>
 #include <vector>
 
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "tensorflow/compiler/tf2xla/xla_helpers.h"
 #include "xla/python/ifrt/array.h"
 #include "xla/python/ifrt/client.h"
 #include "xla/python/ifrt/executable.h"
 #include "xla/python/ifrt/topology.h"
 #include "tensorflow/core/common_runtime/device_mgr.h"
+#include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_executable_registry.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_loaded_variable_registry.h"
 #include "tensorflow/core/tfrt/ifrt/ifrt_persistent_compilation_cache.h"
@@ -50,6 +53,14 @@ struct DeviceConfig {
       tensorflow::IdentityShapeRepresentationFn();
 };
 
+// An input signature expected at serving time for a registered program. See
+// `IfrtServingExecutable::Warmup()`.
+struct IfrtWarmupSignature {
+  int64_t program_id;
+  std::vector<tensorflow::Tensor> inputs;
+  std::vector<int> variable_arg_indices;
+};
+
 // The runtime context for ifrt to be used in TFRT serving.
 //
 // This class is thread compatible.
@@ -138,6 +149,13 @@ class IfrtModelContext {
   // leads to an error.
   absl::Status Freeze();
 
+  // Compiles the registered programs for `signatures` in parallel, through the
+  // persistent compilation cache if there is one, and loads the variables they
+  // use onto their devices. Meant to run at model load, before `Freeze()`, so
+  // that first requests with these signatures do not stall on compilation or
+  // variable loading.
+  absl::Status Warmup(absl::Span<const IfrtWarmupSignature> signatures);
+
   bool IsFrozen() const { return frozen_; }
 
  private:
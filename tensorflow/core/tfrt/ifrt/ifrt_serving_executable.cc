@@ -218,6 +218,39 @@ GetHostCallbackModulesAndRemoveHostFuncs(mlir::ModuleOp module) {
   return host_callback_modules;
 }
 
+absl::Status ValidateVariableArgs(absl::Span<const tensorflow::Tensor> inputs,
+                                  absl::Span<const int> variable_arg_indices) {
+  for (int i = 1; i < variable_arg_indices.size(); i++) {
+    if (variable_arg_indices[i] <= variable_arg_indices[i - 1]) {
+      return absl::FailedPreconditionError(absl::StrCat(
+          "Expected variable_arg_indices in ascending order. But subsequence "
+          "starting at ",
+          i - 1, ": (", variable_arg_indices[i - 1], ", ",
+          variable_arg_indices[i], ")", " is not in ascending order"));
+    }
+  }
+
+  if (!variable_arg_indices.empty() &&
+      inputs.size() <= variable_arg_indices.back()) {
+    return absl::FailedPreconditionError(absl::StrCat(
+        "Expected at most ", inputs.size(), " inputs, but got up to ",
+        variable_arg_indices.back(), " variables."));
+  }
+
+  // Ensure the variable tensor holds a valid key: a scalar string tensor.
+  for (const int i : variable_arg_indices) {
+    if (inputs[i].dtype() != tensorflow::DT_STRING ||
+        !tensorflow::TensorShapeUtils::IsScalar(inputs[i].shape())) {
+      return absl::FailedPreconditionError(
+          absl::StrCat("Expected a scalar tensor as loaded variable array key, "
+                       "but got type ",
+                       inputs[i].dtype(), " and shape ",
+                       inputs[i].shape().DebugString(), " at index ", i));
+    }
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace
 
 absl::StatusOr<std::unique_ptr<IfrtServingExecutable>>
@@ -261,14 +294,12 @@ absl::StatusOr<tsl::RCReference<xla::ifrt::Array>>
 IfrtServingExecutable::ConvertTensorToArray(
     const tensorflow::Tensor& tensor,
     const tsl::RCReference<xla::ifrt::DeviceList>& device_list,
-    const xla::OpSharding& sharding) {
+    const xla::HloSharding& hlo_sharding) {
   xla::ifrt::Shape input_shape = ToIfrtShape(tensor.shape());
   VLOG(2) << "Converting tensor of shape " << input_shape;
 
-  TF_ASSIGN_OR_RETURN(auto hlo_sharding, xla::HloSharding::FromProto(sharding));
-
-  return MakeArrayFromTensor(*ifrt_client_, tensor, device_list,
-                             std::move(hlo_sharding), thread_pool_);
+  return MakeArrayFromTensor(*ifrt_client_, tensor, device_list, hlo_sharding,
+                             thread_pool_);
 }
 
 absl::StatusOr<std::vector<tensorflow::FunctionDef>> BuildFunctionDef(
@@ -523,6 +554,13 @@ IfrtServingExecutable::CreateExecutableSynchronously(
   executable_bundle->ifrt_executable = std::move(ifrt_executable);
   executable_bundle->compile_metadata =
       std::move(tf2hlo_result.compile_metadata);
+  executable_bundle->arg_hlo_shardings.reserve(
+      executable_bundle->compile_metadata.args_size());
+  for (const auto& arg : executable_bundle->compile_metadata.args()) {
+    TF_ASSIGN_OR_RETURN(xla::HloSharding hlo_sharding,
+                        xla::HloSharding::FromProto(arg.sharding()));
+    executable_bundle->arg_hlo_shardings.push_back(std::move(hlo_sharding));
+  }
   executable_bundle->host_callbacks = std::move(tf_host_callbacks);
 
   return executable_bundle;
@@ -592,34 +630,7 @@ bool IfrtServingExecutable::UsePortableExecution(
 absl::StatusOr<std::vector<tensorflow::Tensor>> IfrtServingExecutable::Execute(
     absl::Span<const tensorflow::Tensor> inputs,
     absl::Span<const int> variable_arg_indices) {
-  for (int i = 1; i < variable_arg_indices.size(); i++) {
-    if (variable_arg_indices[i] <= variable_arg_indices[i - 1]) {
-      return absl::FailedPreconditionError(absl::StrCat(
-          "Expected variable_arg_indices in ascending order. But subsequence "
-          "starting at ",
-          i - 1, ": (", variable_arg_indices[i - 1], ", ",
-          variable_arg_indices[i], ")", " is not in ascending order"));
-    }
-  }
-
-  if (!variable_arg_indices.empty() &&
-      inputs.size() <= variable_arg_indices.back()) {
-    return absl::FailedPreconditionError(absl::StrCat(
-        "Expected at most ", inputs.size(), " inputs, but got up to ",
-        variable_arg_indices.back(), " variables."));
-  }
-
-  // Ensure the variable tensor holds a valid key: a scalar string tensor.
-  for (const int i : variable_arg_indices) {
-    if (inputs[i].dtype() != tensorflow::DT_STRING ||
-        !tensorflow::TensorShapeUtils::IsScalar(inputs[i].shape())) {
-      return absl::FailedPreconditionError(
-          absl::StrCat("Expected a scalar tensor as loaded variable array key, "
-                       "but got type ",
-                       inputs[i].dtype(), " and shape ",
-                       inputs[i].shape().DebugString(), " at index ", i));
-    }
-  }
+  TF_RETURN_IF_ERROR(ValidateVariableArgs(inputs, variable_arg_indices));
 
   TF_ASSIGN_OR_RETURN(std::vector<DtypeAndShape> dtypes_and_shapes,
                       BuildDtypeAndShape(inputs, variable_arg_indices,
@@ -665,42 +676,44 @@ absl::StatusOr<std::vector<tensorflow::Tensor>> IfrtServingExecutable::Execute(
 
   VLOG(2) << "Completed AsyncLoadIfrtArray";
 
-  std::vector<tsl::RCReference<xla::ifrt::Array>> args;
-  args.reserve(inputs.size());
+  std::vector<int> device_ids;
+  device_ids.reserve(device_list->size());
+  for (xla::ifrt::Device* device : device_list->devices()) {
+    device_ids.push_back(device->Id().value());
+  }
+
+  // Start the host-to-device transfers of all non-variable inputs before
+  // waiting on any loaded variable, so that the transfers are issued back to
+  // back instead of each one stalling behind a variable that is still loading.
+  std::vector<tsl::RCReference<xla::ifrt::Array>> args(inputs.size());
+  std::vector<xla::ifrt::Future<tsl::RCReference<xla::ifrt::Array>>>
+      variable_arrays;
+  variable_arrays.reserve(variable_arg_indices.size());
   int variable_index = 0;
   for (int i = 0; i < inputs.size(); i++) {
     if (variable_index < variable_arg_indices.size() &&
         i == variable_arg_indices[variable_index]) {
-      std::vector<int> device_ids;
-      device_ids.reserve(device_list->size());
-      for (xla::ifrt::Device* device : device_list->devices()) {
-        device_ids.push_back(device->Id().value());
-      }
-      TF_ASSIGN_OR_RETURN(
-          xla::HloSharding hlo_sharding,
-          xla::HloSharding::FromProto(
-              executable_bundle->compile_metadata.args()[i].sharding()));
       IfrtLoadedVariableRegistry::Key key{
-          .device_ids = std::move(device_ids),
+          .device_ids = device_ids,
           .input_name = inputs[i].scalar<tsl::tstring>()(),
-          .hlo_sharding = std::move(hlo_sharding),
+          .hlo_sharding = executable_bundle->arg_hlo_shardings[i],
       };
       TF_ASSIGN_OR_RETURN(
           auto loaded_variable,
           ifrt_loaded_variable_registry_.GetLoadedVariable(key));
-      TF_ASSIGN_OR_RETURN(tsl::RCReference<xla::ifrt::Array> single_array,
-                          loaded_variable.array.Await());
-      args.push_back(std::move(single_array));
+      variable_arrays.push_back(std::move(loaded_variable.array));
       variable_index++;
     } else {
       TF_ASSIGN_OR_RETURN(
-          auto single_array,
-          ConvertTensorToArray(
-              inputs[i], device_list,
-              executable_bundle->compile_metadata.args()[i].sharding()));
-      args.push_back(single_array);
+          args[i],
+          ConvertTensorToArray(inputs[i], device_list,
+                               executable_bundle->arg_hlo_shardings[i]));
     }
   }
+  for (int j = 0; j < variable_arrays.size(); ++j) {
+    TF_ASSIGN_OR_RETURN(args[variable_arg_indices[j]],
+                        variable_arrays[j].Await());
+  }
   DCHECK_EQ(args.size(), dtypes_and_shapes.size());
 
   VLOG(2) << "Start Execution";
@@ -754,6 +767,64 @@ absl::StatusOr<std::vector<tensorflow::Tensor>> IfrtServingExecutable::Execute(
   return outputs;
 }
 
+absl::Status IfrtServingExecutable::Warmup(
+    absl::Span<const tensorflow::Tensor> inputs,
+    absl::Span<const int> variable_arg_indices) {
+  TF_RETURN_IF_ERROR(ValidateVariableArgs(inputs, variable_arg_indices));
+
+  TF_ASSIGN_OR_RETURN(std::vector<DtypeAndShape> dtypes_and_shapes,
+                      BuildDtypeAndShape(inputs, variable_arg_indices,
+                                         ifrt_restore_tensor_registry_));
+
+  tensorflow::tpu::TPUCompileMetadataProto compile_metadata =
+      original_compile_metadata_;
+  TF_RETURN_IF_ERROR(
+      UpdateCompileMetadata(compile_metadata, dtypes_and_shapes));
+  const bool use_portable_execution = UsePortableExecution(compile_metadata);
+  if (use_portable_execution) {
+    // Must match the compile metadata `Execute()` looks the executable up
+    // with.
+    compile_metadata.clear_device_assignment();
+  }
+
+  TF_ASSIGN_OR_RETURN(SharedCachedExecutableBundle executable_bundle,
+                      LookUpOrCreateExecutable(
+                          compile_metadata, absl::MakeSpan(dtypes_and_shapes))
+                          .Await());
+  if (executable_bundle->compile_metadata.args().size() !=
+      dtypes_and_shapes.size()) {
+    return absl::InternalError(absl::StrCat(
+        "Expected ", executable_bundle->compile_metadata.args().size(),
+        " but got ", dtypes_and_shapes.size(), " arguments"));
+  }
+
+  // The device of a portable execution is only picked per request, so its
+  // variables cannot be placed ahead of time.
+  if (use_portable_execution || variable_arg_indices.empty()) {
+    return absl::OkStatus();
+  }
+
+  TF_RETURN_IF_ERROR(AsyncLoadIfrtArray(inputs, variable_arg_indices,
+                                        *executable_bundle,
+                                        assigned_device_list_));
+  std::vector<int> device_ids;
+  device_ids.reserve(assigned_device_list_->size());
+  for (xla::ifrt::Device* device : assigned_device_list_->devices()) {
+    device_ids.push_back(device->Id().value());
+  }
+  for (const int i : variable_arg_indices) {
+    IfrtLoadedVariableRegistry::Key key{
+        .device_ids = device_ids,
+        .input_name = inputs[i].scalar<tsl::tstring>()(),
+        .hlo_sharding = executable_bundle->arg_hlo_shardings[i],
+    };
+    TF_ASSIGN_OR_RETURN(auto loaded_variable,
+                        ifrt_loaded_variable_registry_.GetLoadedVariable(key));
+    TF_RETURN_IF_ERROR(loaded_variable.array.Await().status());
+  }
+  return absl::OkStatus();
+}
+
 absl::Status IfrtServingExecutable::AsyncLoadIfrtArray(
     absl::Span<const tensorflow::Tensor> inputs,
     absl::Span<const int> variable_arg_indices,
@@ -770,12 +841,8 @@ absl::Status IfrtServingExecutable::AsyncLoadIfrtArray(
     }
     std::string runtime_name = inputs[i].scalar<tsl::tstring>()();
     // TODO(b/339521818): Add test cases for OpSharding on variables.
-    TF_ASSIGN_OR_RETURN(
-        xla::HloSharding hlo_sharding,
-        xla::HloSharding::FromProto(
-            executable_bundle.compile_metadata.args()[i].sharding()));
     VariableDeviceShardingConfig sharding_config{
-        .hlo_sharding = std::move(hlo_sharding),
+        .hlo_sharding = executable_bundle.arg_hlo_shardings[i],
     };
     for (xla::ifrt::Device* device : devices->devices()) {
       sharding_config.device_ids.push_back(device->Id().value());
@@ -28,6 +28,7 @@ limitations under the License.
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/log.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
@@ -36,6 +37,7 @@ limitations under the License.
 #include "mlir/IR/OwningOpRef.h"  // from @llvm-project
 #include "tensorflow/compiler/mlir/tfrt/transforms/ifrt/ifrt_types.h"
 #include "tensorflow/compiler/tf2xla/xla_helpers.h"
+#include "xla/hlo/ir/hlo_sharding.h"
 #include "xla/python/ifrt/array.h"
 #include "xla/python/ifrt/client.h"
 #include "xla/python/ifrt/device.h"
@@ -93,6 +95,15 @@ class IfrtServingExecutable {
       absl::Span<const tensorflow::Tensor> inputs,
       absl::Span<const int> variable_arg_indices);
 
+  // Compiles the executable for the shapes of `inputs` and, unless the
+  // execution is portable, loads the variables named by the keys at
+  // `variable_arg_indices` onto the assigned devices. `inputs` and
+  // `variable_arg_indices` are what a later `Execute()` would be called with,
+  // though only the shapes of non-variable inputs matter. Returns once both are
+  // done, so that the first matching `Execute()` does neither.
+  absl::Status Warmup(absl::Span<const tensorflow::Tensor> inputs,
+                      absl::Span<const int> variable_arg_indices);
+
   // Freezes the model. After the Freeze(), JIT compile is not supported and
   // Execute() will return error if inputs contain uncompiled shapes.
   void Freeze();
@@ -125,6 +136,9 @@ class IfrtServingExecutable {
   struct CachedExecutableBundle {
     std::unique_ptr<xla::ifrt::LoadedExecutable> ifrt_executable;
     tensorflow::tpu::TPUCompileMetadataProto compile_metadata;
+    // Parsed from `compile_metadata.args()` once so that executions need not
+    // convert the sharding protos of every argument again.
+    std::vector<xla::HloSharding> arg_hlo_shardings;
     std::vector<std::unique_ptr<TfHostCallback>> host_callbacks;
 
     CachedExecutableBundle() = default;
@@ -216,7 +230,7 @@ class IfrtServingExecutable {
   absl::StatusOr<tsl::RCReference<xla::ifrt::Array>> ConvertTensorToArray(
       const tensorflow::Tensor& tensor,
       const tsl::RCReference<xla::ifrt::DeviceList>& device_list,
-      const xla::OpSharding& sharding);
+      const xla::HloSharding& hlo_sharding);
 
   xla::ifrt::Future<SharedCachedExecutableBundle> LookUpOrCreateExecutable(
       const tensorflow::tpu::TPUCompileMetadataProto& compile_metadata,
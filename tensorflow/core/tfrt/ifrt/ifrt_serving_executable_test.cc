@@ -181,6 +181,30 @@ TEST_F(IfrtServingExecutableTest, ReturnFailOnUncompiledShapeAfterFrozen) {
   EXPECT_THAT(status, StatusIs(absl::StatusCode::kFailedPrecondition));
 }
 
+TEST_F(IfrtServingExecutableTest, WarmupCompilesBeforeFreeze) {
+  int64_t program_id = 123456;
+  EXPECT_CALL(selector_, ReserveDevice(absl::StrCat(program_id)))
+      .Times(1)
+      .WillOnce(Return(tsl::DeviceReservation(0, /*selector=*/nullptr)));
+  auto executable =
+      helper_->MakeExecutable(program_id, GetMlirModulePath("executable.mlir"));
+
+  auto x = AsTensor<int32_t>({1, 2, 3}, tensorflow::TensorShape({1, 3}));
+  auto y = AsTensor<int32_t>({1, 2, 3}, tensorflow::TensorShape({3, 1}));
+  std::vector<tensorflow::Tensor> inputs{x, y};
+  TF_ASSERT_OK(executable->Warmup(absl::MakeSpan(inputs), {}));
+  TF_ASSERT_OK(executable->Warmup(absl::MakeSpan(inputs), {}));
+  EXPECT_EQ(executable->num_executables(), 1);
+
+  // The warmed up shape still runs after the freeze.
+  executable->Freeze();
+  TF_ASSERT_OK_AND_ASSIGN(auto result,
+                          executable->Execute(absl::MakeSpan(inputs), {}));
+  const auto expected_out =
+      AsTensor<int32_t>({14}, tensorflow::TensorShape({1, 1}));
+  EXPECT_THAT(result, ElementsAre(TensorEq(expected_out)));
+}
+
 TEST_F(IfrtServingExecutableTest, Spmd) {
   int64_t program_id = 111111;
   EXPECT_CALL(selector_, ReserveDevice(absl::StrCat(program_id))).Times(0);
@@ -48,8 +48,18 @@ LoadedExecutable::LoadedExecutable(bc::Executable executable,
   }
 
   functions_.reserve(executable_.functions().size());
+  threaded_kernels_.reserve(executable_.functions().size());
   for (auto function : executable_.functions()) {
     functions_[function.name().Get()] = function;
+
+    // Functions without kernels cannot be executed and their kernel addresses
+    // may alias another function's.
+    if (function.kernels().empty()) continue;
+    auto& threaded_kernels = threaded_kernels_[function.kernels().data()];
+    threaded_kernels.reserve(function.kernels().size());
+    for (bc::Kernel kernel : function.kernels()) {
+      threaded_kernels.push_back(kernels_[kernel.code()]);
+    }
   }
 }
 
@@ -83,6 +83,19 @@ class LoadedExecutable {
 
   absl::Span<const KernelImplementation> kernels() const { return kernels_; }
 
+  // Returns the implementations of the kernels in `function` in program order,
+  // resolved at load time so that the interpreter dispatches by program
+  // counter without decoding kernel codes. Returns an empty span if `function`
+  // does not belong to this executable.
+  absl::Span<const KernelImplementation> GetThreadedKernels(
+      bc::Function function) const {
+    if (auto iter = threaded_kernels_.find(function.kernels().data());
+        iter != threaded_kernels_.end()) {
+      return iter->second;
+    }
+    return {};
+  }
+
   bc::Function GetFunction(absl::string_view name) const {
     if (auto iter = functions_.find(name); iter != functions_.end()) {
       return iter->second;
@@ -98,6 +111,9 @@ class LoadedExecutable {
 
   absl::flat_hash_map<std::string, bc::Function> functions_;
   std::vector<KernelImplementation> kernels_;
+  // Keyed by the address of the kernels in each function.
+  absl::flat_hash_map<const char*, std::vector<KernelImplementation>>
+      threaded_kernels_;
 };
 
 // A helper structure that holds states for a kernel. Typical usuage is that a
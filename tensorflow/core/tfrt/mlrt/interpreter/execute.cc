@@ -92,10 +92,12 @@ void Execute(ExecutionContext& ctx) {
     FunctionContext* current_function = &context.function_stack_.back();
     int64_t pc = current_function->pc_;
 
-    auto kernels = context.loaded_executable().kernels();
+    auto kernel_objects = current_function->function_object().kernels();
+    auto threaded_kernels = context.loaded_executable().GetThreadedKernels(
+        current_function->function_object());
+    DCHECK_EQ(threaded_kernels.size(), kernel_objects.size());
 
-    auto kernel_object_iter =
-        current_function->function_object().kernels().begin();
+    auto kernel_object_iter = kernel_objects.begin();
     kernel_object_iter += pc;
 
     KernelFrame::State kstate(current_function);
@@ -105,11 +107,9 @@ void Execute(ExecutionContext& ctx) {
     // the execution state to break this loop for context-switching or error
     // handling.
     for (; context.state_ == ExecutionContext::State::kRunning; ++pc) {
-      DCHECK(kernel_object_iter <
-             current_function->function_object().kernels().end());
-      bc::Kernel kernel_object = *kernel_object_iter;
-      frame.set_kernel(kernel_object);
-      kernels[kernel_object.code()](frame);
+      DCHECK(kernel_object_iter < kernel_objects.end());
+      frame.set_kernel(*kernel_object_iter);
+      threaded_kernels[pc](frame);
       ++kernel_object_iter;
     }
 
@@ -202,6 +202,28 @@ TEST(InterpreterTest, SequentialAdd) {
   EXPECT_EQ(result.Get<int32_t>(), 100);
 }
 
+TEST(InterpreterTest, ThreadedKernels) {
+  auto buffer = CreateSequentialAddExecutable(3);
+
+  bc::Executable executable(buffer.data());
+
+  KernelRegistry kernel_registry;
+  RegisterBuiltinKernels(kernel_registry);
+  kernel_registry.Register<AddI32Kernel>();
+
+  LoadedExecutable loaded_executable(executable, kernel_registry);
+
+  auto function = loaded_executable.GetFunction("main");
+  ASSERT_TRUE(function);
+
+  auto threaded_kernels = loaded_executable.GetThreadedKernels(function);
+  ASSERT_EQ(threaded_kernels.size(), 4);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(threaded_kernels[i], kernel_registry.Get("add"));
+  }
+  EXPECT_EQ(threaded_kernels[3], kernel_registry.Get("return"));
+}
+
 TEST(InterpreterTest, SequentialAddAttributes) {
   auto buffer = CreateSequentialAddAttributesExecutable(99);
 
@@ -3109,7 +3131,8 @@ TEST(KernelTest, PromiseReturnNotScheduleImmediately) {
 }
 
 void BM_SequentialAdd(::testing::benchmark::State& state) {
-  auto buffer = CreateSequentialAddExecutable(99);
+  const int num_add = state.range(0);
+  auto buffer = CreateSequentialAddExecutable(num_add);
 
   bc::Executable executable(buffer.data());
 
@@ -3137,7 +3160,7 @@ void BM_SequentialAdd(::testing::benchmark::State& state) {
 
   Execute(execution_context);
   notification.WaitForNotification();
-  CHECK_EQ(result.Get<int32_t>(), 100);
+  CHECK_EQ(result.Get<int32_t>(), num_add + 1);
 
   for (auto s : state) {
     absl::Notification notification;
@@ -3151,7 +3174,7 @@ void BM_SequentialAdd(::testing::benchmark::State& state) {
     notification.WaitForNotification();
   }
 }
-BENCHMARK(BM_SequentialAdd);
+BENCHMARK(BM_SequentialAdd)->Arg(9)->Arg(99)->Arg(999);
 
 void BM_SequentialAddAttributes(::testing::benchmark::State& state) {
   auto buffer = CreateSequentialAddAttributesExecutable(99);
@@ -93,6 +93,9 @@ void ExecuteKernelRunner(
 
   auto& params = context.params();
   SetUpParams(kernel_runner, input_tf_tensor_values, params);
+  params.step_allocator = kernel_runner.may_use_request_arena()
+                              ? fallback_request_state.request_allocator()
+                              : nullptr;
 
   auto results = frame.results();
 
@@ -34,6 +34,8 @@ limitations under the License.
 
 #include "unsupported/Eigen/CXX11/Tensor"  // from @eigen_archive
 #include "tensorflow/core/lib/core/threadpool_interface.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/lib/strings/strcat.h"
 #include "tensorflow/core/platform/context.h"
 #include "tensorflow/core/platform/denormal.h"
@@ -55,6 +57,18 @@ namespace {
 typedef typename internal::RunHandlerEnvironment::Task Task;
 typedef Eigen::RunQueue<Task, 1024> Queue;
 
+auto* run_handler_steals = tensorflow::monitoring::Counter<1>::New(
+    "/tfrt/run_handler/steals",
+    "The number of tasks run handler threads took from handlers outside their "
+    "sub thread pool or by work stealing.",
+    "pool_name");
+
+auto* run_handler_queueing_delay = tensorflow::monitoring::Sampler<1>::New(
+    {"/tfrt/run_handler/queueing_delay",
+     "The time between enqueuing a task and starting it, in microseconds.",
+     "pool_name"},
+    tensorflow::monitoring::Buckets::Exponential(1, 2, 24));
+
 }  // namespace
 
 namespace internal {
@@ -370,7 +384,11 @@ RunHandlerThreadPool::RunHandlerThreadPool(
       queue_waiters_(queue_waiters),
       num_threads_in_sub_thread_pool_(options.num_threads_in_sub_thread_pool),
       sub_thread_pool_end_request_percentage_(
-          options.sub_thread_request_percentage) {
+          options.sub_thread_request_percentage),
+      enable_work_stealing_(options.enable_work_stealing),
+      record_queueing_delay_(options.record_queueing_delay),
+      steals_cell_(run_handler_steals->GetCell(name)),
+      queueing_delay_cell_(run_handler_queueing_delay->GetCell(name)) {
   thread_data_.resize(num_threads_);
   for (int i = 0; i < num_threads_; ++i) {
     thread_data_[i].new_thread_work_sources =
@@ -427,6 +445,9 @@ void RunHandlerThreadPool::StartOneThreadForTesting() {
 void RunHandlerThreadPool::AddWorkToQueue(ThreadWorkSource* tws,
                                           bool is_blocking, TaskFunction fn) {
   Task t = env_.CreateTask(std::move(fn));
+  if (record_queueing_delay_) {
+    t.f->enqueue_time_micros = env_.env_->NowMicros();
+  }
   t = tws->EnqueueTask(std::move(t), is_blocking, enable_wake_up_);
   if (t.f) {
     VLOG(3) << "Running " << (is_blocking ? "inter" : "intra") << " work for "
@@ -522,6 +543,44 @@ Task RunHandlerThreadPool::FindTask(
   return t;
 }
 
+Task RunHandlerThreadPool::StealTask(
+    int thread_id, bool may_steal_blocking_work,
+    const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
+    bool* task_from_blocking_queue, ThreadWorkSource** tws) {
+  *task_from_blocking_queue = false;
+  ThreadWorkSource* victim = nullptr;
+  bool victim_is_blocking = false;
+  int victim_queue_size = 0;
+  // Sources are sorted by priority, so only a strictly longer queue replaces
+  // the current victim.
+  for (int i = 0; i < thread_work_sources.size(); ++i) {
+    ThreadWorkSource* source = thread_work_sources[i];
+    if (may_steal_blocking_work) {
+      int queue_size = source->TaskQueueSize(/*is_blocking=*/true);
+      if (queue_size > victim_queue_size) {
+        victim = source;
+        victim_is_blocking = true;
+        victim_queue_size = queue_size;
+      }
+    }
+    int queue_size = source->TaskQueueSize(/*is_blocking=*/false);
+    if (queue_size > victim_queue_size) {
+      victim = source;
+      victim_is_blocking = false;
+      victim_queue_size = queue_size;
+    }
+  }
+  if (victim == nullptr) return Task();
+
+  Task t = victim_is_blocking ? victim->PopBlockingTask()
+                              : victim->PopNonBlockingTask(thread_id, true);
+  if (t.f) {
+    *task_from_blocking_queue = victim_is_blocking;
+    *tws = victim;
+  }
+  return t;
+}
+
 // Main worker thread loop.
 void RunHandlerThreadPool::WorkerLoop(int thread_id,
                                       bool may_steal_blocking_work) {
@@ -576,6 +635,16 @@ void RunHandlerThreadPool::WorkerLoop(int thread_id,
                      kMaxBlockingInflight,
                      /*may_steal_blocking_work=*/true, *thread_work_sources,
                      &task_from_blocking_queue, &tws);
+        if (!t.f && enable_work_stealing_) {
+          // Every handler with queued work is at its inflight limit, so
+          // rather than going idle, help the one with the longest queue.
+          t = StealTask(thread_id, /*may_steal_blocking_work=*/true,
+                        *thread_work_sources, &task_from_blocking_queue, &tws);
+        }
+        if (t.f) {
+          num_steals_.fetch_add(1, std::memory_order_relaxed);
+          steals_cell_->IncrementBy(1);
+        }
       }
     } else {
       // For non-blocking threads, it will always search from all pending
@@ -588,6 +657,10 @@ void RunHandlerThreadPool::WorkerLoop(int thread_id,
     if (t.f) {
       VLOG(2) << "Running " << (task_from_blocking_queue ? "inter" : "intra")
               << " work from " << tws->GetTracemeId();
+      if (t.f->enqueue_time_micros != 0) {
+        queueing_delay_cell_->Add(env_.env_->NowMicros() -
+                                  t.f->enqueue_time_micros);
+      }
       tws->IncrementInflightTaskCount(task_from_blocking_queue);
       env_.ExecuteTask(t);
       tws->DecrementInflightTaskCount(task_from_blocking_queue);
@@ -726,21 +799,28 @@ class RunHandler::Impl {
 // This class is thread safe.
 class RunHandlerPool::Impl {
  public:
+  static internal::RunHandlerThreadPool::Options ThreadPoolOptions(
+      const Options& options) {
+    internal::RunHandlerThreadPool::Options thread_pool_options(
+        options.num_inter_op_threads, options.num_intra_op_threads,
+        options.wait_if_no_active_request,
+        options.non_blocking_threads_sleep_time_micro_sec,
+        options.blocking_threads_max_sleep_time_micro_sec,
+        options.use_adaptive_waiting_time, options.enable_wake_up,
+        options.max_concurrent_handler, options.num_threads_in_sub_thread_pool,
+        options.sub_thread_request_percentage);
+    thread_pool_options.enable_work_stealing = options.enable_work_stealing;
+    thread_pool_options.record_queueing_delay = options.record_queueing_delay;
+    return thread_pool_options;
+  }
+
   explicit Impl(Options options)
       : max_handlers_(options.max_concurrent_handler),
         waiters_mu_(options.num_sub_thread_pool),
         queue_waiters_(options.num_sub_thread_pool),
         run_handler_thread_pool_(new internal::RunHandlerThreadPool(
-            internal::RunHandlerThreadPool::Options(
-                options.num_inter_op_threads, options.num_intra_op_threads,
-                options.wait_if_no_active_request,
-                options.non_blocking_threads_sleep_time_micro_sec,
-                options.blocking_threads_max_sleep_time_micro_sec,
-                options.use_adaptive_waiting_time, options.enable_wake_up,
-                options.max_concurrent_handler,
-                options.num_threads_in_sub_thread_pool,
-                options.sub_thread_request_percentage),
-            tensorflow::Env::Default(), tensorflow::ThreadOptions(),
+            ThreadPoolOptions(options), tensorflow::Env::Default(),
+            tensorflow::ThreadOptions(),
             "tf_run_handler_pool", &waiters_mu_, &queue_waiters_)),
         iterations_(0),
         version_(0),
@@ -30,6 +30,8 @@ limitations under the License.
 #include "absl/log/log.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/histogram/histogram.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/lib/monitoring/sampler.h"
 #include "tensorflow/core/platform/context.h"
 #include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/thread_annotations.h"
@@ -111,6 +113,16 @@ class RunHandlerPool {
 
     // If true, threads will be waken up by new tasks.
     bool enable_wake_up = true;
+
+    // If true, an inter-op thread that finds no task in its regular sweep
+    // steals one from the handler with the most queued work, preferring higher
+    // priority handlers on ties and ignoring the per-handler inflight limit.
+    // Intra-op threads never take inter-op work.
+    bool enable_work_stealing = false;
+
+    // If true, the time between enqueuing each task and starting it is
+    // recorded in /tfrt/run_handler/queueing_delay.
+    bool record_queueing_delay = false;
   };
   explicit RunHandlerPool(Options options);
   ~RunHandlerPool();
@@ -185,6 +197,8 @@ class RunHandlerEnvironment {
     TaskFunction f;
     tensorflow::Context context;
     uint64_t trace_id;
+    // Set only if queueing delay is recorded.
+    uint64_t enqueue_time_micros = 0;
   };
   tensorflow::Env* const env_;
   const tensorflow::ThreadOptions thread_options_;
@@ -304,6 +318,9 @@ class RunHandlerThreadPool {
     int max_concurrent_handler;
     std::vector<int> num_threads_in_sub_thread_pool;
     std::vector<double> sub_thread_request_percentage;
+    // See `RunHandlerPool::Options`.
+    bool enable_work_stealing = false;
+    bool record_queueing_delay = false;
     Options(int num_blocking_threads, int num_non_blocking_threads,
             bool wait_if_no_active_request,
             int non_blocking_threads_sleep_time_micro_sec,
@@ -372,9 +389,23 @@ class RunHandlerThreadPool {
       const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
       bool* task_from_blocking_queue, ThreadWorkSource** tws);
 
+  // Takes a task from the handler with the most queued work among
+  // `thread_work_sources`, preferring earlier (higher priority) handlers on
+  // ties. Inter-op work is only considered if `may_steal_blocking_work`.
+  Task StealTask(
+      int thread_id, bool may_steal_blocking_work,
+      const Eigen::MaxSizeVector<ThreadWorkSource*>& thread_work_sources,
+      bool* task_from_blocking_queue, ThreadWorkSource** tws);
+
   void WaitForWorkInSubThreadPool(int thread_id, bool is_blocking,
                                   int sub_thread_pool_id);
 
+  // The number of tasks taken from handlers outside a thread's sub thread pool
+  // or by `StealTask()`.
+  int64_t NumSteals() const {
+    return num_steals_.load(std::memory_order_relaxed);
+  }
+
  private:
   struct ThreadData {
     ThreadData();
@@ -415,6 +446,12 @@ class RunHandlerThreadPool {
   // the end_request_percentage of previous sub thread pool to its own
   // end_request_percentage in a round robin fashion.
   std::vector<double> sub_thread_pool_end_request_percentage_;
+
+  const bool enable_work_stealing_;
+  const bool record_queueing_delay_;
+  std::atomic<int64_t> num_steals_{0};
+  tensorflow::monitoring::CounterCell* const steals_cell_;
+  tensorflow::monitoring::SamplerCell* const queueing_delay_cell_;
 };
 
 }  // namespace internal
@@ -483,6 +483,98 @@ TEST_P(RunHandlerThreadPoolTest, FindTask) {
   }
 }
 
+TEST_P(RunHandlerThreadPoolTest, StealTask) {
+  Eigen::MaxSizeVector<tensorflow::mutex> waiters_mu(1);
+  waiters_mu.resize(1);
+  Eigen::MaxSizeVector<internal::Waiter> waiters(1);
+  waiters.resize(1);
+  internal::RunHandlerThreadPool::Options options(
+      /*num_blocking_threads=*/0, /*num_non_blocking_threads=*/0,
+      /*wait_if_no_active_request=*/true,
+      /*non_blocking_threads_sleep_time_micro_sec=*/250,
+      /*blocking_threads_max_sleep_time_micro_sec=*/250,
+      /*use_adaptive_waiting_time=*/true, /*enable_wake_up=*/true,
+      /*max_concurrent_handler=*/128,
+      /*num_threads_in_sub_thread_pool=*/{0},
+      /*sub_thread_request_percentage=*/{1});
+  options.enable_work_stealing = true;
+  internal::RunHandlerThreadPool run_handler_thread_pool(
+      options, tensorflow::Env::Default(), tensorflow::ThreadOptions(),
+      "tf_run_handler_pool", &waiters_mu, &waiters);
+
+  Eigen::MaxSizeVector<internal::ThreadWorkSource*> thread_work_sources(3);
+  thread_work_sources.resize(3);
+  internal::ThreadWorkSource tws[3];
+  for (int i = 0; i < 3; ++i) {
+    tws[i].SetWaiter(1, &waiters[0], &waiters_mu[0]);
+    thread_work_sources[i] = &tws[i];
+  }
+
+  int result = -1;
+  run_handler_thread_pool.AddWorkToQueue(
+      &tws[0], /*is_blocking=*/true, TaskFunction([&result] { result = 0; }));
+  for (int i = 0; i < 2; ++i) {
+    run_handler_thread_pool.AddWorkToQueue(
+        &tws[1], /*is_blocking=*/true, TaskFunction([&result] { result = 1; }));
+    run_handler_thread_pool.AddWorkToQueue(
+        &tws[2], /*is_blocking=*/false,
+        TaskFunction([&result] { result = 2; }));
+  }
+
+  const auto steal_task = [&](bool may_steal_blocking_work,
+                              bool* task_from_blocking_queue,
+                              internal::ThreadWorkSource** victim) {
+    return run_handler_thread_pool.StealTask(
+        /*thread_id=*/0, may_steal_blocking_work, thread_work_sources,
+        task_from_blocking_queue, victim);
+  };
+
+  bool task_from_blocking_queue;
+  internal::ThreadWorkSource* victim = nullptr;
+  // The longest queues tie, so the higher priority handler wins.
+  internal::Task t = steal_task(/*may_steal_blocking_work=*/true,
+                                &task_from_blocking_queue, &victim);
+  ASSERT_NE(t.f, nullptr);
+  t.f->f();
+  EXPECT_EQ(result, 1);
+  EXPECT_TRUE(task_from_blocking_queue);
+  EXPECT_EQ(victim, &tws[1]);
+
+  // Now the non-blocking queue of the last handler is the longest.
+  t = steal_task(/*may_steal_blocking_work=*/true, &task_from_blocking_queue,
+                 &victim);
+  ASSERT_NE(t.f, nullptr);
+  t.f->f();
+  EXPECT_EQ(result, 2);
+  EXPECT_FALSE(task_from_blocking_queue);
+  EXPECT_EQ(victim, &tws[2]);
+
+  // Intra-op threads only take non-blocking work.
+  t = steal_task(/*may_steal_blocking_work=*/false, &task_from_blocking_queue,
+                 &victim);
+  ASSERT_NE(t.f, nullptr);
+  t.f->f();
+  EXPECT_EQ(result, 2);
+  t = steal_task(/*may_steal_blocking_work=*/false, &task_from_blocking_queue,
+                 &victim);
+  EXPECT_EQ(t.f, nullptr);
+
+  // Drain the remaining inter-op work in priority order.
+  t = steal_task(/*may_steal_blocking_work=*/true, &task_from_blocking_queue,
+                 &victim);
+  ASSERT_NE(t.f, nullptr);
+  t.f->f();
+  EXPECT_EQ(result, 0);
+  t = steal_task(/*may_steal_blocking_work=*/true, &task_from_blocking_queue,
+                 &victim);
+  ASSERT_NE(t.f, nullptr);
+  t.f->f();
+  EXPECT_EQ(result, 1);
+  t = steal_task(/*may_steal_blocking_work=*/true, &task_from_blocking_queue,
+                 &victim);
+  EXPECT_EQ(t.f, nullptr);
+}
+
 TEST_P(RunHandlerThreadPoolTest, RoundRobinExecution) {
   Eigen::MaxSizeVector<tensorflow::mutex> waiters_mu(1);
   waiters_mu.resize(1);
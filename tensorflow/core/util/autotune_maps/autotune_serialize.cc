@@ -27,12 +27,14 @@ limitations under the License.
 #include "xla/stream_executor/platform_manager.h"
 #include "xla/tsl/lib/strings/proto_serialization.h"
 #include "xla/tsl/protobuf/dnn.pb.h"
+#include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/str_util.h"
 #include "tensorflow/core/util/activation_mode.h"
 #include "tensorflow/core/util/autotune_maps/autotune_map.pb.h"
 #include "tensorflow/core/util/autotune_maps/conv_autotune_maps.h"
 #include "tensorflow/core/util/autotune_maps/conv_parameters.h"
 #include "tensorflow/core/util/autotune_maps/conv_parameters.pb.h"
+#include "tensorflow/core/util/autotune_maps/cpu_conv_autotune_map.h"
 
 namespace tensorflow {
 
@@ -181,12 +183,12 @@ absl::Status SerializeAutotuneMaps(std::string *output) {
   TF_ASSIGN_OR_RETURN(*proto.mutable_fused_conv_map(),
                       ConvMapToProto(*FusedConvAutotuneMap::GetInstance()));
 #endif  // GOOGLE_CUDA || TENSORFLOW_USE_ROCM
+  *proto.mutable_cpu_conv_map() = CpuConvAutotuneMap::GetInstance()->ToProto();
   TF_RET_CHECK(tsl::SerializeToStringDeterministic(proto, output));
   return absl::OkStatus();
 }
 
 absl::Status LoadSerializedAutotuneMaps(absl::string_view s) {
-#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
   AutotuneMapsProto proto;
   // The explicit string conversion here is a workaround for
   // resolving the issue that OSS proto library's ParseFromString only accepts
@@ -195,6 +197,9 @@ absl::Status LoadSerializedAutotuneMaps(absl::string_view s) {
     return errors::InvalidArgument(
         "Failed to parse the autotune maps from string.");
   }
+  TF_RETURN_IF_ERROR(
+      CpuConvAutotuneMap::GetInstance()->FromProto(proto.cpu_conv_map()));
+#if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
   TF_RETURN_IF_ERROR(
       PopulateConvMap(proto.conv_map(), ConvAutotuneMap::GetInstance()));
   TF_RETURN_IF_ERROR(PopulateConvMap(proto.fused_conv_map(),
@@ -205,6 +210,7 @@ absl::Status LoadSerializedAutotuneMaps(absl::string_view s) {
 }
 
 void ResetAutotuneMaps() {
+  CpuConvAutotuneMap::GetInstance()->ClearMap();
 #if GOOGLE_CUDA || TENSORFLOW_USE_ROCM
   ConvAutotuneMap::GetInstance()->ClearMap();
   FusedConvAutotuneMap::GetInstance()->ClearMap();
@@ -0,0 +1,124 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/autotune_maps/cpu_conv_autotune_map.h"
+
+#include <string>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "xla/tsl/lib/strings/proto_serialization.h"
+#include "tensorflow/core/platform/cpu_info.h"
+#include "tensorflow/core/platform/errors.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/util/autotune_maps/autotune_map.pb.h"
+#include "tensorflow/core/util/autotune_maps/conv_parameters.pb.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+std::string SerializeKey(const ConvParametersProto& params) {
+  std::string key;
+  CHECK(tsl::SerializeToStringDeterministic(params, &key));
+  return key;
+}
+
+}  // namespace
+
+bool CpuConvUseAutotune() {
+  static const bool use_autotune = [] {
+    bool value = false;
+    TF_CHECK_OK(
+        ReadBoolFromEnvVar("TF_CPU_CONV_USE_AUTOTUNE", /*default_val=*/false,
+                           &value));
+    return value;
+  }();
+  return use_autotune;
+}
+
+CpuConvAutotuneMap* CpuConvAutotuneMap::GetInstance() {
+  static CpuConvAutotuneMap* map = new CpuConvAutotuneMap();
+  return map;
+}
+
+std::string CpuConvAutotuneMap::DeviceIdentifier(int num_threads) {
+  return absl::StrCat("CPU ", port::CPUVendorIDString(), " family ",
+                      port::CPUFamily(), " model ", port::CPUModelNum(),
+                      " threads ", num_threads);
+}
+
+bool CpuConvAutotuneMap::Find(const ConvParametersProto& params,
+                              CpuConvAlgorithm* algorithm) const {
+  const std::string key = SerializeKey(params);
+  tf_shared_lock lock(mu_);
+  auto it = map_.find(key);
+  if (it == map_.end()) return false;
+  *algorithm = it->second.second;
+  return true;
+}
+
+void CpuConvAutotuneMap::Insert(const ConvParametersProto& params,
+                                CpuConvAlgorithm algorithm) {
+  std::string key = SerializeKey(params);
+  VLOG(1) << "Cpu conv autotune: " << params.ShortDebugString()
+          << " -> algorithm " << static_cast<int>(algorithm);
+  mutex_lock lock(mu_);
+  map_[std::move(key)] = {params, algorithm};
+}
+
+void CpuConvAutotuneMap::ClearMap() {
+  mutex_lock lock(mu_);
+  map_.clear();
+}
+
+ConvMapProto CpuConvAutotuneMap::ToProto() const {
+  ConvMapProto proto;
+  tf_shared_lock lock(mu_);
+  for (const auto& p : map_) {
+    ConvMapProto::Entry* kv = proto.add_kv_pairs();
+    *kv->mutable_key() = p.second.first;
+    kv->mutable_value()->mutable_algorithm()->set_algo_id(
+        static_cast<int>(p.second.second));
+  }
+  return proto;
+}
+
+absl::Status CpuConvAutotuneMap::FromProto(const ConvMapProto& proto) {
+  for (const ConvMapProto::Entry& kv : proto.kv_pairs()) {
+    if (kv.key().version() != kVersion) {
+      return errors::Aborted(
+          "Aborted because the loaded autotune results for CPU convolution "
+          "operations have a version different from runtime's version. "
+          "Expected version: ",
+          kVersion, ". Actual version: ", kv.key().version());
+    }
+    const int64_t algo_id = kv.value().algorithm().algo_id();
+    if (algo_id != static_cast<int>(CpuConvAlgorithm::kEigen) &&
+        algo_id != static_cast<int>(CpuConvAlgorithm::kDeepConv2D)) {
+      return errors::InvalidArgument(
+          "Unknown CPU convolution algorithm in autotune results: ", algo_id);
+    }
+  }
+  for (const ConvMapProto::Entry& kv : proto.kv_pairs()) {
+    Insert(kv.key(),
+           static_cast<CpuConvAlgorithm>(kv.value().algorithm().algo_id()));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace tensorflow
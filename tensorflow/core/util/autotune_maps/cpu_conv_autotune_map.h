@@ -0,0 +1,87 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_UTIL_AUTOTUNE_MAPS_CPU_CONV_AUTOTUNE_MAP_H_
+#define TENSORFLOW_CORE_UTIL_AUTOTUNE_MAPS_CPU_CONV_AUTOTUNE_MAP_H_
+
+#include <map>
+#include <string>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/util/autotune_maps/autotune_map.pb.h"
+#include "tensorflow/core/util/autotune_maps/conv_parameters.pb.h"
+
+namespace tensorflow {
+
+// Convolution implementations that the CPU Conv2D kernel may pick between.
+// The values are stored in serialized autotune maps, so they must not change.
+enum class CpuConvAlgorithm : int {
+  // Eigen spatial convolution (or the equivalent MatMul for 1x1 filters).
+  kEigen = 0,
+  // Winograd-based convolution in deep_conv2d.h.
+  kDeepConv2D = 1,
+};
+
+// Returns true if CPU convolutions should benchmark the applicable algorithms
+// the first time they see a shape, instead of using static heuristics. Set
+// with the TF_CPU_CONV_USE_AUTOTUNE environment variable (default false).
+bool CpuConvUseAutotune();
+
+// Maps convolution parameters to the fastest CPU algorithm measured for them.
+//
+// The keys are ConvParametersProto, as for the GPU autotune maps, with the
+// device_identifier naming the CPU model and the number of threads running
+// the convolution. The values are ConvMapProto entries whose algorithm id is a
+// CpuConvAlgorithm. This lets the CPU results be serialized alongside the GPU
+// ones with SerializeAutotuneMaps.
+class CpuConvAutotuneMap {
+ public:
+  // A positive number that denotes the version of the CPU keys. Serialized
+  // results with a different version are rejected.
+  static constexpr int kVersion = 1;
+
+  static CpuConvAutotuneMap* GetInstance();
+
+  // Returns the device_identifier of the keys measured on this CPU with
+  // `num_threads` threads.
+  static std::string DeviceIdentifier(int num_threads);
+
+  bool Find(const ConvParametersProto& params,
+            CpuConvAlgorithm* algorithm) const;
+  void Insert(const ConvParametersProto& params, CpuConvAlgorithm algorithm);
+  void ClearMap();
+
+  // Returns the entries sorted by their serialized keys, so that the
+  // serialization is deterministic.
+  ConvMapProto ToProto() const;
+  // Adds the entries of `proto` to the map, or fails without changing the map
+  // if any of them has a different version.
+  absl::Status FromProto(const ConvMapProto& proto);
+
+ private:
+  CpuConvAutotuneMap() = default;
+
+  mutable mutex mu_;
+  // Keyed by the deterministically serialized ConvParametersProto.
+  std::map<std::string, std::pair<ConvParametersProto, CpuConvAlgorithm>> map_
+      TF_GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_UTIL_AUTOTUNE_MAPS_CPU_CONV_AUTOTUNE_MAP_H_
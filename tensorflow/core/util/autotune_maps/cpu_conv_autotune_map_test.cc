@@ -0,0 +1,110 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/util/autotune_maps/cpu_conv_autotune_map.h"
+
+#include <string>
+
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/util/autotune_maps/autotune_map.pb.h"
+#include "tensorflow/core/util/autotune_maps/autotune_serialize.h"
+#include "tensorflow/core/util/autotune_maps/conv_parameters.pb.h"
+
+namespace tensorflow {
+namespace {
+
+ConvParametersProto MakeParams(int64_t batch) {
+  ConvParametersProto params;
+  params.set_batch(batch);
+  params.set_in_depths(16);
+  params.set_out_depths(32);
+  params.add_in(28);
+  params.add_in(28);
+  params.add_filter(3);
+  params.add_filter(3);
+  params.set_dtype(DT_FLOAT);
+  params.set_device_identifier(CpuConvAutotuneMap::DeviceIdentifier(4));
+  params.set_version(CpuConvAutotuneMap::kVersion);
+  return params;
+}
+
+class CpuConvAutotuneMapTest : public ::testing::Test {
+ protected:
+  void SetUp() override { ResetAutotuneMaps(); }
+  void TearDown() override { ResetAutotuneMaps(); }
+};
+
+TEST_F(CpuConvAutotuneMapTest, FindsInsertedAlgorithm) {
+  CpuConvAutotuneMap* map = CpuConvAutotuneMap::GetInstance();
+  CpuConvAlgorithm algorithm;
+  EXPECT_FALSE(map->Find(MakeParams(1), &algorithm));
+
+  map->Insert(MakeParams(1), CpuConvAlgorithm::kDeepConv2D);
+  map->Insert(MakeParams(2), CpuConvAlgorithm::kEigen);
+  ASSERT_TRUE(map->Find(MakeParams(1), &algorithm));
+  EXPECT_EQ(algorithm, CpuConvAlgorithm::kDeepConv2D);
+  ASSERT_TRUE(map->Find(MakeParams(2), &algorithm));
+  EXPECT_EQ(algorithm, CpuConvAlgorithm::kEigen);
+
+  // Results measured with a different number of threads do not apply.
+  ConvParametersProto other_threads = MakeParams(1);
+  other_threads.set_device_identifier(CpuConvAutotuneMap::DeviceIdentifier(8));
+  EXPECT_FALSE(map->Find(other_threads, &algorithm));
+}
+
+TEST_F(CpuConvAutotuneMapTest, SerializationRoundTrip) {
+  CpuConvAutotuneMap* map = CpuConvAutotuneMap::GetInstance();
+  map->Insert(MakeParams(2), CpuConvAlgorithm::kEigen);
+  map->Insert(MakeParams(1), CpuConvAlgorithm::kDeepConv2D);
+
+  std::string serialized;
+  TF_ASSERT_OK(SerializeAutotuneMaps(&serialized));
+  AutotuneMapsProto proto;
+  ASSERT_TRUE(proto.ParseFromString(serialized));
+  EXPECT_EQ(proto.cpu_conv_map().kv_pairs_size(), 2);
+
+  ResetAutotuneMaps();
+  CpuConvAlgorithm algorithm;
+  EXPECT_FALSE(map->Find(MakeParams(1), &algorithm));
+
+  TF_ASSERT_OK(LoadSerializedAutotuneMaps(serialized));
+  ASSERT_TRUE(map->Find(MakeParams(1), &algorithm));
+  EXPECT_EQ(algorithm, CpuConvAlgorithm::kDeepConv2D);
+  ASSERT_TRUE(map->Find(MakeParams(2), &algorithm));
+  EXPECT_EQ(algorithm, CpuConvAlgorithm::kEigen);
+
+  // The serialization is deterministic.
+  std::string reserialized;
+  TF_ASSERT_OK(SerializeAutotuneMaps(&reserialized));
+  EXPECT_EQ(serialized, reserialized);
+}
+
+TEST_F(CpuConvAutotuneMapTest, RejectsOtherVersions) {
+  ConvMapProto proto;
+  ConvMapProto::Entry* kv = proto.add_kv_pairs();
+  *kv->mutable_key() = MakeParams(1);
+  kv->mutable_key()->set_version(CpuConvAutotuneMap::kVersion + 1);
+  kv->mutable_value()->mutable_algorithm()->set_algo_id(
+      static_cast<int>(CpuConvAlgorithm::kDeepConv2D));
+
+  CpuConvAutotuneMap* map = CpuConvAutotuneMap::GetInstance();
+  EXPECT_FALSE(map->FromProto(proto).ok());
+  CpuConvAlgorithm algorithm;
+  EXPECT_FALSE(map->Find(MakeParams(1), &algorithm));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -544,7 +544,7 @@ void ParallelFor(const std::function<void(size_t)>& f, size_t n,
 // Enumeration for distinguishing feature types.
 // Note: FastParseSequenceExample constructs a map that includes Type values,
 // and relies on the fact that they are default-initialized to Dense.
-enum class Type { Dense, Sparse, Ragged };
+using Type = FastParseExampleConfigIndex::Type;
 
 // Note: We use SparseBuffer for sparse, ragged, and dense_varlen features.
 struct SparseBuffer {
@@ -560,13 +560,6 @@ struct SparseBuffer {
   std::vector<size_t> example_end_indices;
 };
 
-struct SeededHasher {
-  uint64 operator()(StringPiece s) const {
-    return Hash64(s.data(), s.size(), seed);
-  }
-  uint64 seed{0xDECAFCAFFE};
-};
-
 void LogDenseFeatureDataLoss(StringPiece feature_name) {
   LOG(WARNING) << "Data loss! Feature '" << feature_name
                << "' is present in multiple concatenated "
@@ -592,8 +585,8 @@ void LogSparseFeatureDataLoss(StringPiece feature_name) {
 absl::Status FastParseSerializedExample(
     const tstring& serialized_example, const tstring& example_name,
     const size_t example_index, const Config& config,
-    const PresizedCuckooMap<std::pair<size_t, Type>>& config_index,
-    SeededHasher hasher, std::vector<Tensor>* output_dense,
+    const FastParseExampleConfigIndex& config_index,
+    std::vector<Tensor>* output_dense,
     std::vector<SparseBuffer>* output_varlen_dense,
     std::vector<SparseBuffer>* output_sparse,
     std::vector<SparseBuffer>* output_ragged,
@@ -630,23 +623,12 @@ absl::Status FastParseSerializedExample(
     parsed::Feature& feature = name_and_feature.second;
 
     std::pair<size_t, Type> d_and_type;
-    uint64 h = hasher(feature_name);
-    if (!config_index.Find(h, &d_and_type)) continue;
+    if (!config_index.Find(feature_name, &d_and_type)) continue;
 
     size_t d = d_and_type.first;
     bool is_dense = d_and_type.second == Type::Dense;
     bool is_ragged = d_and_type.second == Type::Ragged;
 
-    {
-      // Testing for PresizedCuckooMap collision.
-      // TODO(lew): Use dense_hash_map and avoid this and hasher creation.
-      const tstring& config_feature_name =
-          is_dense ? config.dense[d].feature_name
-                   : (is_ragged ? config.ragged[d].feature_name
-                                : config.sparse[d].feature_name);
-      if (feature_name != config_feature_name) continue;
-    }
-
     auto example_error = [&](StringPiece suffix) {
       return errors::InvalidArgument("Name: ", example_name,
                                      ", Key: ", feature_name,
@@ -989,37 +971,39 @@ absl::Status CheckConfigDataTypes(const Config& config) {
 }
 
 template <typename T>
-const SmallVector<T>& GetListFromBuffer(const SparseBuffer& buffer);
+SmallVector<T>& GetListFromBuffer(SparseBuffer& buffer);
 
 template <>
-const SmallVector<int64_t>& GetListFromBuffer<int64_t>(
-    const SparseBuffer& buffer) {
+SmallVector<int64_t>& GetListFromBuffer<int64_t>(SparseBuffer& buffer) {
   return buffer.int64_list;
 }
 template <>
-const SmallVector<float>& GetListFromBuffer<float>(const SparseBuffer& buffer) {
+SmallVector<float>& GetListFromBuffer<float>(SparseBuffer& buffer) {
   return buffer.float_list;
 }
 template <>
-const SmallVector<tstring>& GetListFromBuffer<tstring>(
-    const SparseBuffer& buffer) {
+SmallVector<tstring>& GetListFromBuffer<tstring>(SparseBuffer& buffer) {
   return buffer.bytes_list;
 }
 
+// Strings are moved rather than copied, so that bytes features are only
+// copied once, from the serialized example. The source must not be const:
+// std::move on const elements silently falls back to copying them.
 template <typename T>
-void CopyOrMoveBlock(const T* b, const T* e, T* t) {
+void CopyOrMoveBlock(T* b, T* e, T* t) {
   std::copy(b, e, t);
 }
 template <>
-void CopyOrMoveBlock(const tstring* b, const tstring* e, tstring* t) {
+void CopyOrMoveBlock(tstring* b, tstring* e, tstring* t) {
   std::move(b, e, t);
 }
 
+// Moves strings out of `varlen_dense_buffers`.
 template <typename T>
 void FillAndCopyVarLen(
     const int d, const size_t num_elements,
     const size_t num_elements_per_minibatch, const Config& config,
-    const std::vector<std::vector<SparseBuffer>>& varlen_dense_buffers,
+    std::vector<std::vector<SparseBuffer>>& varlen_dense_buffers,
     Tensor* values) {
   const Tensor& default_value = config.dense[d].default_value;
 
@@ -1033,13 +1017,13 @@ void FillAndCopyVarLen(
 
   // Iterate over minibatch elements
   for (size_t i = 0; i < varlen_dense_buffers.size(); ++i) {
-    const SparseBuffer& buffer = varlen_dense_buffers[i][d];
+    SparseBuffer& buffer = varlen_dense_buffers[i][d];
     // Number of examples being stored in this buffer
     const auto& end_indices = buffer.example_end_indices;
     const size_t examples_in_buffer = end_indices.size();
     // const size_t stride_size = config.dense[d].elements_per_stride;
 
-    const auto& list = GetListFromBuffer<T>(buffer);
+    auto& list = GetListFromBuffer<T>(buffer);
     auto list_ptr = list.begin();
 
     size_t elements_tally = 0;
@@ -1133,47 +1117,90 @@ void CopySparseBufferToTensor(DataType dtype, size_t offset, SparseBuffer* src,
 
 }  // namespace
 
-absl::Status FastParseExample(const Config& config,
-                              absl::Span<const tstring> serialized,
-                              absl::Span<const tstring> example_names,
-                              thread::ThreadPool* thread_pool, Result* result) {
-  DCHECK(result != nullptr);
-  // Check config so we can safely CHECK(false) in switches on config.*.dtype
-  TF_RETURN_IF_ERROR(CheckConfigDataTypes(config));
-
-  if (config.collect_feature_stats) {
-    result->feature_stats.resize(serialized.size());
-  }
-
-  size_t config_size =
+absl::Status FastParseExampleConfigIndex::Create(
+    const FastParseExampleConfig& config,
+    std::unique_ptr<const FastParseExampleConfigIndex>* index) {
+  std::unique_ptr<FastParseExampleConfigIndex> new_index(
+      new FastParseExampleConfigIndex(config));
+  const size_t config_size =
       config.dense.size() + config.sparse.size() + config.ragged.size();
-  SeededHasher hasher;
-  // Build config index.
-  PresizedCuckooMap<std::pair<size_t, Type>> config_index(config_size);
   bool ok = true;
   for (size_t i = 0; i < 1000; ++i) {
+    auto insert = [&](const tstring& feature_name, size_t d, Type type) {
+      ok &= new_index->map_.InsertUnique(
+          Hash64(feature_name.data(), feature_name.size(), new_index->seed_),
+          {d, type});
+    };
     for (size_t d = 0; d < config.dense.size(); ++d) {
-      ok &= config_index.InsertUnique(hasher(config.dense[d].feature_name),
-                                      {d, Type::Dense});
+      insert(config.dense[d].feature_name, d, Type::Dense);
     }
     for (size_t d = 0; d < config.sparse.size(); ++d) {
-      ok &= config_index.InsertUnique(hasher(config.sparse[d].feature_name),
-                                      {d, Type::Sparse});
+      insert(config.sparse[d].feature_name, d, Type::Sparse);
     }
     for (size_t d = 0; d < config.ragged.size(); ++d) {
-      ok &= config_index.InsertUnique(hasher(config.ragged[d].feature_name),
-                                      {d, Type::Ragged});
+      insert(config.ragged[d].feature_name, d, Type::Ragged);
+    }
+    if (ok) {
+      *index = std::move(new_index);
+      return absl::OkStatus();
     }
-    if (ok) break;
     LOG(WARNING) << "Collision found. This should happen only if you have "
                     "around 2^32 entries in your config.";
-    hasher.seed++;
-    config_index.Clear(config_size);
+    new_index->seed_++;
+    new_index->map_.Clear(config_size);
     ok = true;
   }
-  if (!ok) {
-    return errors::Internal(
-        "Could not avoid collision. This should not happen.");
+  return errors::Internal("Could not avoid collision. This should not happen.");
+}
+
+FastParseExampleConfigIndex::FastParseExampleConfigIndex(
+    const FastParseExampleConfig& config)
+    : map_(config.dense.size() + config.sparse.size() + config.ragged.size()) {
+  dense_names_.reserve(config.dense.size());
+  for (const auto& c : config.dense) dense_names_.push_back(c.feature_name);
+  sparse_names_.reserve(config.sparse.size());
+  for (const auto& c : config.sparse) sparse_names_.push_back(c.feature_name);
+  ragged_names_.reserve(config.ragged.size());
+  for (const auto& c : config.ragged) ragged_names_.push_back(c.feature_name);
+}
+
+bool FastParseExampleConfigIndex::Matches(
+    const FastParseExampleConfig& config) const {
+  auto matches = [](const std::vector<tstring>& names, const auto& configs) {
+    if (names.size() != configs.size()) return false;
+    for (size_t d = 0; d < names.size(); ++d) {
+      if (names[d] != configs[d].feature_name) return false;
+    }
+    return true;
+  };
+  return matches(dense_names_, config.dense) &&
+         matches(sparse_names_, config.sparse) &&
+         matches(ragged_names_, config.ragged);
+}
+
+absl::Status FastParseExample(const Config& config,
+                              absl::Span<const tstring> serialized,
+                              absl::Span<const tstring> example_names,
+                              thread::ThreadPool* thread_pool, Result* result) {
+  std::unique_ptr<const FastParseExampleConfigIndex> config_index;
+  TF_RETURN_IF_ERROR(
+      FastParseExampleConfigIndex::Create(config, &config_index));
+  return FastParseExample(config, *config_index, serialized, example_names,
+                          thread_pool, result);
+}
+
+absl::Status FastParseExample(const Config& config,
+                              const FastParseExampleConfigIndex& config_index,
+                              absl::Span<const tstring> serialized,
+                              absl::Span<const tstring> example_names,
+                              thread::ThreadPool* thread_pool, Result* result) {
+  DCHECK(result != nullptr);
+  DCHECK(config_index.Matches(config));
+  // Check config so we can safely CHECK(false) in switches on config.*.dtype
+  TF_RETURN_IF_ERROR(CheckConfigDataTypes(config));
+
+  if (config.collect_feature_stats) {
+    result->feature_stats.resize(serialized.size());
   }
 
   // Allocate dense output for fixed length dense values
@@ -1245,7 +1272,7 @@ absl::Status FastParseExample(const Config& config,
       status_of_minibatch[minibatch] = FastParseSerializedExample(
           serialized[e],
           (!example_names.empty() ? example_names[e] : "<unknown>"), e, config,
-          config_index, hasher, &fixed_dense_values,
+          config_index, &fixed_dense_values,
           &varlen_dense_buffers[minibatch], &sparse_buffers[minibatch],
           &ragged_buffers[minibatch], stats);
       if (!status_of_minibatch[minibatch].ok()) break;
@@ -1449,7 +1476,17 @@ absl::Status FastParseExample(const Config& config,
 
 absl::Status FastParseSingleExample(const Config& config,
                                     StringPiece serialized, Result* result) {
+  std::unique_ptr<const FastParseExampleConfigIndex> config_index;
+  TF_RETURN_IF_ERROR(
+      FastParseExampleConfigIndex::Create(config, &config_index));
+  return FastParseSingleExample(config, *config_index, serialized, result);
+}
+
+absl::Status FastParseSingleExample(
+    const Config& config, const FastParseExampleConfigIndex& config_index,
+    StringPiece serialized, Result* result) {
   DCHECK(result != nullptr);
+  DCHECK(config_index.Matches(config));
   // Check config so we can safely CHECK(false) in switches on config.*.dtype
   TF_RETURN_IF_ERROR(CheckConfigDataTypes(config));
 
@@ -1459,38 +1496,6 @@ absl::Status FastParseSingleExample(const Config& config,
     stats = &result->feature_stats.back();
   }
 
-  // TODO(mrry): Cache the construction of this map at Op construction time.
-  size_t config_size =
-      config.dense.size() + config.sparse.size() + config.ragged.size();
-  SeededHasher hasher;
-  // Build config index.
-  PresizedCuckooMap<std::pair<size_t, Type>> config_index(config_size);
-  bool ok = true;
-  for (size_t i = 0; i < 1000; ++i) {
-    for (size_t d = 0; d < config.dense.size(); ++d) {
-      ok &= config_index.InsertUnique(hasher(config.dense[d].feature_name),
-                                      {d, Type::Dense});
-    }
-    for (size_t d = 0; d < config.sparse.size(); ++d) {
-      ok &= config_index.InsertUnique(hasher(config.sparse[d].feature_name),
-                                      {d, Type::Sparse});
-    }
-    for (size_t d = 0; d < config.ragged.size(); ++d) {
-      ok &= config_index.InsertUnique(hasher(config.ragged[d].feature_name),
-                                      {d, Type::Ragged});
-    }
-    if (ok) break;
-    LOG(WARNING) << "Collision found. This should happen only if you have "
-                    "around 2^32 entries in your config.";
-    hasher.seed++;
-    config_index.Clear(config_size);
-    ok = true;
-  }
-  if (!ok) {
-    return errors::Internal(
-        "Could not avoid collision. This should not happen.");
-  }
-
   result->sparse_indices.reserve(config.sparse.size());
   result->sparse_values.reserve(config.sparse.size());
   result->sparse_shapes.reserve(config.sparse.size());
@@ -1559,23 +1564,12 @@ absl::Status FastParseSingleExample(const Config& config,
     parsed::Feature& feature = name_and_feature.second;
 
     std::pair<size_t, Type> d_and_type;
-    uint64 h = hasher(feature_name);
-    if (!config_index.Find(h, &d_and_type)) continue;
+    if (!config_index.Find(feature_name, &d_and_type)) continue;
 
     size_t d = d_and_type.first;
     bool is_dense = d_and_type.second == Type::Dense;
     bool is_sparse = d_and_type.second == Type::Sparse;
 
-    {
-      // Testing for PresizedCuckooMap collision.
-      // TODO(lew): Use dense_hash_map and avoid this and hasher creation.
-      const tstring& config_feature_name =
-          is_dense ? config.dense[d].feature_name
-                   : (is_sparse ? config.sparse[d].feature_name
-                                : config.ragged[d].feature_name);
-      if (feature_name != config_feature_name) continue;
-    }
-
     auto example_error = [feature_name](StringPiece suffix) {
       return errors::InvalidArgument("Key: ", feature_name, ".  ", suffix);
     };
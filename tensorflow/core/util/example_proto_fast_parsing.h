@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_UTIL_EXAMPLE_PROTO_FAST_PARSING_H_
 #define TENSORFLOW_CORE_UTIL_EXAMPLE_PROTO_FAST_PARSING_H_
 
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -29,7 +30,9 @@ limitations under the License.
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/types.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
+#include "tensorflow/core/platform/hash.h"
 #include "tensorflow/core/platform/types.h"
+#include "tensorflow/core/util/presized_cuckoo_map.h"
 #include "tensorflow/core/util/sparse/sparse_tensor.h"
 
 namespace tensorflow {
@@ -130,6 +133,56 @@ struct Result {
   std::vector<PerExampleFeatureStats> feature_stats;
 };
 
+// Maps the feature names of a FastParseExampleConfig to its sub-configs.
+// Building the index hashes every feature name, so callers that parse many
+// batches with the same feature names should build it once and reuse it.
+class FastParseExampleConfigIndex {
+ public:
+  enum class Type { Dense, Sparse, Ragged };
+
+  // Builds the index of the feature names in `config`.
+  static absl::Status Create(
+      const FastParseExampleConfig& config,
+      std::unique_ptr<const FastParseExampleConfigIndex>* index);
+
+  // Returns true if `config` has the feature names of the config this index
+  // was built from, in the same order.
+  bool Matches(const FastParseExampleConfig& config) const;
+
+  // Finds the sub-config of `feature_name`, returning its position in the
+  // list of its type.
+  bool Find(StringPiece feature_name,
+            std::pair<size_t, Type>* index_and_type) const {
+    if (!map_.Find(Hash64(feature_name.data(), feature_name.size(), seed_),
+                   index_and_type)) {
+      return false;
+    }
+    // Names outside the config may collide with a name in it.
+    return feature_name == FeatureName(*index_and_type);
+  }
+
+ private:
+  explicit FastParseExampleConfigIndex(const FastParseExampleConfig& config);
+
+  const tstring& FeatureName(const std::pair<size_t, Type>& slot) const {
+    switch (slot.second) {
+      case Type::Dense:
+        return dense_names_[slot.first];
+      case Type::Sparse:
+        return sparse_names_[slot.first];
+      case Type::Ragged:
+        return ragged_names_[slot.first];
+    }
+    return dense_names_[slot.first];
+  }
+
+  std::vector<tstring> dense_names_;
+  std::vector<tstring> sparse_names_;
+  std::vector<tstring> ragged_names_;
+  uint64 seed_ = 0xDECAFCAFFE;
+  PresizedCuckooMap<std::pair<size_t, Type>> map_;
+};
+
 // Parses a batch of serialized Example protos and converts them into result
 // according to given config.
 // Given example names have to either be empty or the same size as serialized.
@@ -139,12 +192,25 @@ absl::Status FastParseExample(const FastParseExampleConfig& config,
                               absl::Span<const tstring> example_names,
                               thread::ThreadPool* thread_pool, Result* result);
 
-// TODO(mrry): Move the hash table construction into the config object.
+// As above, but looks up feature names in `config_index`, which must have been
+// built from a config with the same feature names.
+absl::Status FastParseExample(const FastParseExampleConfig& config,
+                              const FastParseExampleConfigIndex& config_index,
+                              absl::Span<const tstring> serialized,
+                              absl::Span<const tstring> example_names,
+                              thread::ThreadPool* thread_pool, Result* result);
+
 typedef FastParseExampleConfig FastParseSingleExampleConfig;
 
 absl::Status FastParseSingleExample(const FastParseSingleExampleConfig& config,
                                     StringPiece serialized, Result* result);
 
+// As above, but looks up feature names in `config_index`.
+absl::Status FastParseSingleExample(
+    const FastParseSingleExampleConfig& config,
+    const FastParseExampleConfigIndex& config_index, StringPiece serialized,
+    Result* result);
+
 // Parses a batch of serialized SequenceExample protos and converts them into
 // result according to given config.
 // Given example names have to either be empty or the same size as serialized.
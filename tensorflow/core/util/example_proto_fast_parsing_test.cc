@@ -15,12 +15,15 @@ limitations under the License.
 
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 
+#include <memory>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -327,6 +330,86 @@ TEST(FastParse, StatsCollection) {
   }
 }
 
+TEST(FastParse, ReusesConfigIndex) {
+  const size_t kNumExamples = 5;
+  std::vector<tstring> serialized(kNumExamples, ExampleWithSomeFeatures());
+
+  FastParseExampleConfig config;
+  AddDenseFeature("float_list", DT_FLOAT, {2}, false, 2, &config);
+  AddSparseFeature("int64_list", DT_INT64, &config);
+  AddSparseFeature("missing", DT_STRING, &config);
+  std::unique_ptr<const FastParseExampleConfigIndex> config_index;
+  TF_ASSERT_OK(FastParseExampleConfigIndex::Create(config, &config_index));
+  EXPECT_TRUE(config_index->Matches(config));
+
+  // The same index serves every call, and gives the same result as building
+  // it for each call.
+  for (int i = 0; i < 2; ++i) {
+    Result with_index;
+    TF_ASSERT_OK(FastParseExample(config, *config_index, serialized, {},
+                                  nullptr, &with_index));
+    Result without_index;
+    TF_ASSERT_OK(
+        FastParseExample(config, serialized, {}, nullptr, &without_index));
+    test::ExpectTensorEqual<float>(without_index.dense_values[0],
+                                   with_index.dense_values[0]);
+    test::ExpectTensorEqual<int64_t>(without_index.sparse_values[0],
+                                     with_index.sparse_values[0]);
+    EXPECT_EQ(0, with_index.sparse_values[1].NumElements());
+
+    Result single;
+    TF_ASSERT_OK(
+        FastParseSingleExample(config, *config_index, serialized[0], &single));
+    EXPECT_EQ(3, single.sparse_values[0].NumElements());
+  }
+
+  FastParseExampleConfig other_config;
+  AddDenseFeature("float_list", DT_FLOAT, {2}, false, 2, &other_config);
+  AddSparseFeature("bytes_list", DT_STRING, &other_config);
+  AddSparseFeature("missing", DT_STRING, &other_config);
+  EXPECT_FALSE(config_index->Matches(other_config));
+}
+
+TEST(FastParse, LargeBytesValues) {
+  // Values longer than the inline capacity of tstring are moved, not copied,
+  // out of the intermediate buffers.
+  const string kLarge1(1000, 'a');
+  const string kLarge2(2000, 'b');
+  Example example;
+  BytesList* bytes_list =
+      (*example.mutable_features()->mutable_feature())["bytes_list"]
+          .mutable_bytes_list();
+  bytes_list->add_value(kLarge1);
+  bytes_list->add_value(kLarge2);
+  std::vector<tstring> serialized(3, Serialize(example));
+
+  FastParseExampleConfig config_varlen;
+  AddDenseFeature("bytes_list", DT_STRING, {-1}, true, 1, &config_varlen);
+  FastParseExampleConfig config_sparse;
+  AddSparseFeature("bytes_list", DT_STRING, &config_sparse);
+
+  for (const FastParseExampleConfig& config : {config_varlen, config_sparse}) {
+    const bool is_sparse = !config.sparse.empty();
+    Result result;
+    TF_ASSERT_OK(FastParseExample(config, serialized, {}, nullptr, &result));
+    const Tensor& values =
+        is_sparse ? result.sparse_values[0] : result.dense_values[0];
+    ASSERT_EQ(6, values.NumElements());
+    for (int i = 0; i < 6; i += 2) {
+      EXPECT_EQ(kLarge1, values.flat<tstring>()(i));
+      EXPECT_EQ(kLarge2, values.flat<tstring>()(i + 1));
+    }
+
+    Result single;
+    TF_ASSERT_OK(FastParseSingleExample(config, serialized[0], &single));
+    const Tensor& single_values =
+        is_sparse ? single.sparse_values[0] : single.dense_values[0];
+    ASSERT_EQ(2, single_values.NumElements());
+    EXPECT_EQ(kLarge1, single_values.flat<tstring>()(0));
+    EXPECT_EQ(kLarge2, single_values.flat<tstring>()(1));
+  }
+}
+
 string RandStr(random::SimplePhilox* rng) {
   static const char key_char_lookup[] =
       "0123456789{}~`!@#$%^&*()"
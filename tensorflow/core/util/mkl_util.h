@@ -2064,6 +2064,21 @@ class MklPrimitiveFactory {
     return is_primitive_mem_opt_enabled;
   }
 
+  /// Function to get the capacity of the primitive caches. The oneDNN
+  /// primitive cache, which is shared by all threads and keyed by primitive
+  /// descriptor, is grown to at least the same capacity, so that a primitive
+  /// that is missing from the cache of one thread is not JIT-compiled again.
+  static inline int GetCacheCapacity() {
+    static const int capacity = [] {
+      const int value = PrimitiveCacheCapacity();
+      if (value > dnnl::get_primitive_cache_capacity()) {
+        dnnl::set_primitive_cache_capacity(value);
+      }
+      return value;
+    }();
+    return capacity;
+  }
+
 #ifdef DNNL_AARCH64_USE_ACL
   static int IncrementCounter() {
     static std::atomic_int counter{1};
@@ -2073,11 +2088,10 @@ class MklPrimitiveFactory {
 
  private:
   static inline LRUCache<MklPrimitive>& GetLRUCache() {
-    static const int kCapacity = 1024;  // cache capacity
 #if !defined(DNNL_AARCH64_USE_ACL) || !defined(ENABLE_ONEDNN_OPENMP)
-    static thread_local LRUCache<MklPrimitive> lru_cache_(kCapacity);
+    static thread_local LRUCache<MklPrimitive> lru_cache_(GetCacheCapacity());
 #else
-    static LRUCache<MklPrimitive> lru_cache_(kCapacity);
+    static LRUCache<MklPrimitive> lru_cache_(GetCacheCapacity());
 #endif
     return lru_cache_;
   }
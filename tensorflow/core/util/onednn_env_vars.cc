@@ -17,7 +17,11 @@ limitations under the License.
 
 #include "tensorflow/core/util/onednn_env_vars.h"
 
+#include <cstdint>
+#include <limits>
+
 #include "absl/base/call_once.h"
+#include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/util/env_var.h"
 
 namespace tensorflow {
@@ -64,6 +68,24 @@ bool UseOnednnSpmm() {
   return use_onednn_spmm;
 }
 
+int PrimitiveCacheCapacity() {
+  static int primitive_cache_capacity = [] {
+    constexpr int64_t kDefaultCapacity = 1024;
+    int64_t setting;
+    TF_CHECK_OK(ReadInt64FromEnvVar("TF_ONEDNN_PRIMITIVE_CACHE_CAPACITY",
+                                    /*default_value*/ kDefaultCapacity,
+                                    &setting));
+    if (setting < 1 || setting > std::numeric_limits<int>::max()) {
+      LOG(WARNING) << "Ignoring invalid TF_ONEDNN_PRIMITIVE_CACHE_CAPACITY "
+                   << setting;
+      setting = kDefaultCapacity;
+    }
+    return static_cast<int>(setting);
+  }();
+
+  return primitive_cache_capacity;
+}
+
 std::string FPMathModeSetting() {
   static std::string math_mode_setting = [] {
     std::string setting = "";
@@ -29,6 +29,10 @@ bool ThreadPoolUseCallerThread();
 
 bool UseOnednnSpmm();
 
+// Returns the capacity of the primitive cache of the oneDNN kernels, which is
+// 1024 unless TF_ONEDNN_PRIMITIVE_CACHE_CAPACITY is set.
+int PrimitiveCacheCapacity();
+
 std::string FPMathModeSetting();
 }  // namespace tensorflow
 #endif  // INTEL_MKL
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
 #include <memory>
@@ -24,6 +25,7 @@ limitations under the License.
 #include "absl/synchronization/mutex.h"
 #include "xla/tsl/lib/io/buffered_file.h"
 #include "xla/tsl/util/byte_swap_array.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/tensor.pb.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
@@ -65,7 +67,10 @@ namespace tensorflow {
 // Versioning of the tensor bundle format.
 const int kTensorBundleMinProducer = 0;
 const int kTensorBundleMinConsumer = 0;
-const int kTensorBundleVersion = 1;
+const int kTensorBundleVersion = 2;
+// Readers older than version 2 do not know how to follow the base prefix of a
+// delta bundle, so they must reject it.
+const int kTensorBundleMinDeltaConsumer = 2;
 
 // Size of our input buffer for streaming reads
 static const int kBufferSize = 1024 * 1024;
@@ -424,6 +429,31 @@ Status PadAlignment(tsl::BufferedWritableFile* out, int alignment,
   return status;
 }
 
+// A read-only view of tensor data in a memory-mapped data file. Keeps the
+// mapping alive for as long as the tensor is referenced.
+class MappedTensorBuffer : public TensorBuffer {
+ public:
+  MappedTensorBuffer(std::shared_ptr<ReadOnlyMemoryRegion> region,
+                     const char* data, size_t size)
+      : TensorBuffer(const_cast<char*>(data)),
+        region_(std::move(region)),
+        size_(size) {}
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocator_name("BundleMappedData");
+  }
+  // The mapping is read-only, so the buffer must never be forwarded to an
+  // output that is modified in place.
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  const std::shared_ptr<ReadOnlyMemoryRegion> region_;
+  const size_t size_;
+};
+
 }  // namespace
 
 BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
@@ -444,6 +474,25 @@ BundleWriter::BundleWriter(Env* env, StringPiece prefix, const Options& options)
     return;
   }
 
+  if (!options_.base_prefix.empty()) {
+    base_ = std::make_unique<BundleReader>(env_, options_.base_prefix);
+    status_ = base_->status();
+    if (!status_.ok()) return;
+    if (!base_->base_prefix_.empty()) {
+      status_ = errors::InvalidArgument(
+          "The base of a delta bundle must be a full bundle, but ",
+          options_.base_prefix, " is itself a delta bundle");
+      return;
+    }
+    if (base_->need_to_swap_bytes_) {
+      status_ = errors::InvalidArgument(
+          "The base of a delta bundle must have the endianness of this "
+          "machine: ",
+          options_.base_prefix);
+      return;
+    }
+  }
+
   std::unique_ptr<WritableFile> wrapper;
   status_ = env_->NewWritableFile(data_path_, &wrapper);
   if (!status_.ok()) return;
@@ -531,6 +580,44 @@ Status BundleWriter::AddSlice(StringPiece full_tensor_key,
   return status_;
 }
 
+Status BundleWriter::AddFromBase(StringPiece key) {
+  if (!status_.ok()) return status_;
+  CHECK_NE(key, kHeaderEntryKey);
+  if (base_ == nullptr) {
+    return errors::FailedPrecondition(
+        "Carrying over tensor ", key,
+        " requires a BundleWriter with a base bundle");
+  }
+  const string key_string(key);
+  BundleEntryProto entry;
+  TF_RETURN_IF_ERROR(base_->GetBundleEntryProto(key, &entry));
+
+  // Collects the full entry and, for a partitioned tensor, its slice entries.
+  // Shard 0 is the delta's own data file, so the base's shards move up by 1.
+  std::vector<std::pair<string, BundleEntryProto>> carried;
+  for (const TensorSliceProto& slice_proto : entry.slices()) {
+    const string slice_name = checkpoint::EncodeTensorNameSlice(
+        key_string, TensorSlice(slice_proto));
+    BundleEntryProto slice_entry;
+    TF_RETURN_IF_ERROR(base_->GetBundleEntryProto(slice_name, &slice_entry));
+    slice_entry.set_shard_id(slice_entry.shard_id() + 1);
+    carried.emplace_back(slice_name, std::move(slice_entry));
+  }
+  if (entry.slices().empty()) entry.set_shard_id(entry.shard_id() + 1);
+  carried.emplace_back(key_string, std::move(entry));
+
+  for (const auto& [name, unused] : carried) {
+    if (entries_.find(name) != entries_.end()) {
+      status_ = errors::InvalidArgument("Adding duplicate key: ", name);
+      return status_;
+    }
+  }
+  for (auto& [name, carried_entry] : carried) {
+    entries_[name] = std::move(carried_entry);
+  }
+  return absl::OkStatus();
+}
+
 // TODO(zongheng): on metadata write failure or !status_.ok(), consider removing
 // the orphaned data file.
 Status BundleWriter::Finish() {
@@ -565,6 +652,16 @@ Status BundleWriter::Finish() {
     VersionDef* version = header.mutable_version();
     version->set_producer(kTensorBundleVersion);
     version->set_min_consumer(kTensorBundleMinConsumer);
+    if (base_ != nullptr) {
+      // Keeps the link relative when both bundles share a directory, so the
+      // pair can be moved together.
+      const StringPiece base_prefix = options_.base_prefix;
+      header.set_base_prefix(io::Dirname(base_prefix) == io::Dirname(prefix_)
+                                 ? string(io::Basename(base_prefix))
+                                 : string(base_prefix));
+      header.set_base_num_shards(base_->num_shards());
+      version->set_min_consumer(kTensorBundleMinDeltaConsumer);
+    }
 
     builder.Add(kHeaderEntryKey, header.SerializeAsString());
 
@@ -634,6 +731,10 @@ static Status MergeOneBundle(Env* env, StringPiece prefix,
     BundleHeaderProto header;
     Status s = ParseEntryProto(iter->key(), iter->value(), &header);
     if (!s.ok()) return CorruptFileError(s, filename, "unable to parse header");
+    if (!header.base_prefix().empty()) {
+      return errors::Unimplemented("Merging delta bundles is not supported: ",
+                                   prefix);
+    }
 
     merge_state->num_shards += header.num_shards();
     if (!merge_state->seen_first_bundle) {
@@ -785,7 +886,9 @@ BundleReader::BundleReader(Env* env, StringPiece prefix, Options options)
       iter_(nullptr),
       need_to_swap_bytes_(false),
       enable_multi_threading_for_testing_(
-          options.enable_multi_threading_for_testing) {
+          options.enable_multi_threading_for_testing),
+      use_memory_mapped_data_(options.use_memory_mapped_data),
+      verify_memory_mapped_data_(options.verify_memory_mapped_data) {
   if (cache_ == nullptr) {
     // Make a cache for use just by this BundleReader.
     owned_cache_ = std::make_unique<BundleCache>(env);
@@ -830,6 +933,13 @@ BundleReader::BundleReader(Env* env, StringPiece prefix, Options options)
     return;
   }
   num_shards_ = header.num_shards();
+  if (!header.base_prefix().empty()) {
+    base_prefix_ = header.base_prefix();
+    if (io::Basename(base_prefix_) == base_prefix_) {
+      base_prefix_ = io::JoinPath(io::Dirname(prefix_), base_prefix_);
+    }
+    base_num_shards_ = header.base_num_shards();
+  }
   if ((header.endianness() == BundleHeaderProto::BIG && port::kLittleEndian) ||
       (header.endianness() == BundleHeaderProto::LITTLE &&
        !port::kLittleEndian)) {
@@ -877,7 +987,76 @@ Status BundleReader::GetBundleEntryProto(StringPiece key,
   return absl::OkStatus();
 }
 
+std::string BundleReader::ShardFilename(int32_t shard_id) const {
+  if (!base_prefix_.empty() && shard_id >= num_shards_) {
+    return DataFilename(base_prefix_, shard_id - num_shards_,
+                        base_num_shards_);
+  }
+  return DataFilename(prefix_, shard_id, num_shards_);
+}
+
+Status BundleReader::GetMappedValue(const BundleEntryProto& entry,
+                                    Tensor* val, bool* mapped) {
+  *mapped = false;
+  auto it = mapped_data_.find(entry.shard_id());
+  if (it == mapped_data_.end()) {
+    std::unique_ptr<ReadOnlyMemoryRegion> region;
+    Status s = env_->NewReadOnlyMemoryRegionFromFile(
+        ShardFilename(entry.shard_id()), &region);
+    if (!s.ok()) {
+      // Not all file systems support memory mapping; fall back to reads.
+      VLOG(1) << "Unable to memory-map TensorBundle at " << prefix_
+              << " shard " << entry.shard_id() << ": " << s;
+    }
+    it = mapped_data_.emplace(entry.shard_id(), std::move(region)).first;
+  }
+  const std::shared_ptr<ReadOnlyMemoryRegion>& region = it->second;
+  if (region == nullptr) return absl::OkStatus();
+
+  const TensorShape stored_shape(entry.shape());
+  const size_t num_bytes =
+      stored_shape.num_elements() * DataTypeSize(entry.dtype());
+  if (entry.size() != num_bytes) {
+    return errors::DataLoss("Invalid size in bundle entry: key ", key(),
+                            "; stored size ", entry.size(),
+                            "; expected size ", num_bytes);
+  }
+  if (entry.offset() < 0 || entry.offset() + entry.size() > region->length()) {
+    return errors::DataLoss("TensorBundle at ", prefix_, " shard ",
+                            entry.shard_id(), ": entry at offset ",
+                            entry.offset(), " of ", entry.size(),
+                            " bytes is out of range");
+  }
+  const char* data = static_cast<const char*>(region->data()) + entry.offset();
+  if (reinterpret_cast<uintptr_t>(data) % EIGEN_MAX_ALIGN_BYTES != 0) {
+    // The tensor was not written with sufficient alignment to be viewed.
+    return absl::OkStatus();
+  }
+  if (verify_memory_mapped_data_) {
+    const uint32 actual_crc32c = crc32c::Value(data, entry.size());
+    if (crc32c::Unmask(entry.crc32c()) != actual_crc32c) {
+      return errors::DataLoss(
+          "TensorBundle at ", prefix_, " shard ", entry.shard_id(), " (",
+          entry.size(), " bytes): Checksum does not match: stored ",
+          strings::Printf("%08u", crc32c::Unmask(entry.crc32c())),
+          " vs. calculated on the restored bytes ", actual_crc32c);
+    }
+  }
+  core::RefCountPtr<TensorBuffer> buf(
+      new MappedTensorBuffer(region, data, entry.size()));
+  *val = Tensor(entry.dtype(), stored_shape, std::move(buf));
+  *mapped = true;
+  return absl::OkStatus();
+}
+
 Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
+  if (use_memory_mapped_data_ && val->NumElements() == 0 &&
+      DataTypeCanUseMemcpy(entry.dtype()) && !need_to_swap_bytes_) {
+    bool mapped;
+    TF_RETURN_IF_ERROR(GetMappedValue(entry, val, &mapped));
+    if (mapped) return absl::OkStatus();
+  }
+
   Tensor* ret = val;
   const TensorShape stored_shape(TensorShape(entry.shape()));
   if (val->NumElements() == 0) {
@@ -910,8 +1089,7 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
   io::InputBuffer* buffered_file = data_[entry.shard_id()];
   if (buffered_file == nullptr) {
     RandomAccessFile* file = nullptr;
-    TF_RETURN_IF_ERROR(cache_->GetFile(
-        DataFilename(prefix_, entry.shard_id(), num_shards_), &file));
+    TF_RETURN_IF_ERROR(cache_->GetFile(ShardFilename(entry.shard_id()), &file));
     buffered_file = new io::InputBuffer(file, kBufferSize);
     data_[entry.shard_id()] = buffered_file;
   }
@@ -955,8 +1133,7 @@ Status BundleReader::GetValue(const BundleEntryProto& entry, Tensor* val) {
             std::unique_ptr<RandomAccessFile> section_reader = nullptr;
             StringPiece sp;
             if (auto file_status = env_->NewRandomAccessFile(
-                    DataFilename(prefix_, entry.shard_id(), num_shards_),
-                    &section_reader);
+                    ShardFilename(entry.shard_id()), &section_reader);
                 !file_status.ok()) {
               statuses[i] = file_status;
               return;
@@ -1202,6 +1379,13 @@ Status BundleReader::LookupDtypeAndShape(StringPiece key, DataType* dtype,
   return absl::OkStatus();
 }
 
+Status BundleReader::LookupShardId(StringPiece key, int32_t* shard_id) {
+  BundleEntryProto entry;
+  TF_RETURN_IF_ERROR(GetBundleEntryProto(key, &entry));
+  *shard_id = entry.slices_size() > 0 ? -1 : entry.shard_id();
+  return absl::OkStatus();
+}
+
 Status BundleReader::LookupTensorShape(StringPiece key, TensorShape* shape) {
   DataType ignored;
   return LookupDtypeAndShape(key, &ignored, shape);
@@ -98,6 +98,8 @@ namespace tensorflow {
 // History:
 // 0. Any tensor bundles produced before this field was added.
 // 1. Added this field (2016-09-14).
+// 2. Added delta bundles, which refer to the data files of a base bundle for
+//    the tensors they carry over (2026-10-14).
 extern const int kTensorBundleMinProducer;
 extern const int kTensorBundleMinConsumer;
 extern const int kTensorBundleVersion;
@@ -106,6 +108,8 @@ extern const int kTensorBundleVersion;
 // corresponding value is a BundleHeaderProto.
 extern const char* const kHeaderEntryKey;
 
+class BundleReader;
+
 // Builds a string-string table of tensor names to BundleEntryProto (metadata).
 //
 // On construction, attempts to create a directory given by the dirname of
@@ -119,6 +123,10 @@ class BundleWriter {
     // Alignment, in bytes, for tensor data.
     // Must be >= 1. The default size of 1 densely packs tensors.
     int data_alignment{1};
+    // If non-empty, writes a delta bundle on top of the full bundle with this
+    // prefix.  Tensors added with AddFromBase() are not rewritten; the delta
+    // refers to the base's data files for them, so the base must outlive it.
+    std::string base_prefix;
   };
   BundleWriter(Env* env, absl::string_view prefix,
                const Options& options = Options());
@@ -127,6 +135,12 @@ class BundleWriter {
   // Across calls "key" must be unique but can be added in any order.
   Status Add(absl::string_view key, const Tensor& val);
 
+  // Carries the tensor keyed by "key", including all of its slices if it is
+  // partitioned, over from the base bundle without rewriting its data.  Use
+  // it for tensors that have not changed since the base was written.
+  // REQUIRES: Options::base_prefix is set.
+  Status AddFromBase(absl::string_view key);
+
   // Partitioned variables support.
   // A slice of a full tensor is stored in two entries in the metadata table:
   //
@@ -162,6 +176,7 @@ class BundleWriter {
   std::unique_ptr<tsl::BufferedWritableFile> out_;
   int64_t size_;  // Number of bytes written into out_.
   std::map<std::string, BundleEntryProto> entries_;
+  std::unique_ptr<BundleReader> base_;  // Set iff writing a delta bundle.
   Status status_;
 
   BundleWriter(const BundleWriter&) = delete;
@@ -179,6 +194,8 @@ class BundleWriter {
 // query information about a tensor.  In particular, this function does not
 // guarantee not to re-order the input data files.
 //
+// Delta bundles cannot be merged.
+//
 // Once merged, makes a best effort to delete the old metadata files.
 // Returns OK iff all bundles are successfully merged.
 //
@@ -212,6 +229,18 @@ class BundleReader {
 
     // For tests only.
     bool enable_multi_threading_for_testing = false;
+
+    // If true, data files are memory-mapped where the file system supports
+    // it, and tensors of memcpy-able types whose data is suitably aligned in
+    // the file (see `BundleWriter::Options::data_alignment`) are returned as
+    // read-only views of the mapping instead of being copied. This only
+    // applies when the caller does not pass a pre-allocated tensor.
+    bool use_memory_mapped_data = false;
+
+    // If false, tensors returned as views of the mapping are not checksummed,
+    // so their pages are only read from disk when first accessed.  Corrupted
+    // data then goes undetected.
+    bool verify_memory_mapped_data = true;
   };
   BundleReader(Env* env, absl::string_view prefix, Options options);
 
@@ -250,6 +279,17 @@ class BundleReader {
   Status LookupTensorShape(absl::string_view key,
                            TensorShape* shape) TF_MUST_USE_RESULT;
 
+  // Looks up the data file holding the tensor keyed by "key".  Sets
+  // "shard_id" to -1 if "key" refers to a partitioned tensor, whose slices
+  // may be spread over several data files.
+  // REQUIRES: status().ok()
+  Status LookupShardId(absl::string_view key,
+                       int32_t* shard_id) TF_MUST_USE_RESULT;
+
+  // Returns the number of data files in this bundle.
+  // REQUIRES: status().ok()
+  int num_shards() const { return num_shards_; }
+
   // Looks up the tensor keyed by "key".  If "key" refers to a partitioned
   // tensor, attempts to look up the full contents using all stored slices.
   //
@@ -322,6 +362,12 @@ class BundleReader {
   Status GetValue(const BundleEntryProto& entry,
                   Tensor* val) TF_MUST_USE_RESULT;
 
+  // Sets "*val" to a view of the memory-mapped data of "entry" and sets
+  // "*mapped" to true, or sets "*mapped" to false if the entry cannot be served
+  // from a mapping.
+  Status GetMappedValue(const BundleEntryProto& entry, Tensor* val,
+                        bool* mapped) TF_MUST_USE_RESULT;
+
   // Reads the slice described by "slice_spec".  The corresponding full tensor
   // has key "ful_tensor_key" and metadata proto "full_tensor_entry".
   // REQUIRES: full_tensor_entry.slices_size() > 0
@@ -330,6 +376,10 @@ class BundleReader {
                        const TensorSlice& slice_spec,
                        Tensor* val) TF_MUST_USE_RESULT;
 
+  // Returns the name of the data file holding shard "shard_id", which is in
+  // the base bundle for the carried-over tensors of a delta bundle.
+  std::string ShardFilename(int32_t shard_id) const;
+
   Env* env_;  // Not owned.
   const std::string prefix_;
   std::unique_ptr<BundleCache> owned_cache_;  // may be null
@@ -344,6 +394,11 @@ class BundleReader {
   // Owned InputBuffer objects. cache_ owns the underlying RandomAccessFiles.
   std::unordered_map<int32_t, io::InputBuffer*> data_;
 
+  // Memory-mapped data files, shared with the tensors that view them. A null
+  // entry records that the shard could not be mapped.
+  std::unordered_map<int32_t, std::shared_ptr<ReadOnlyMemoryRegion>>
+      mapped_data_;
+
   // Maps each partitioned tensor's key to its stored slices (represented in a
   // TensorSliceSet).  Populated on-demand.
   std::unordered_map<std::string, checkpoint::TensorSliceSet*> tensor_slices_;
@@ -352,13 +407,21 @@ class BundleReader {
   // the header entry in the metadata table.
   int num_shards_;
 
+  // Resolved prefix and number of data files of the base bundle, if this is a
+  // delta bundle.  "base_prefix_" is empty otherwise.
+  std::string base_prefix_;
+  int base_num_shards_ = 0;
+
   // Flag that this class sets to true when the endianness of the target bundle
   // differs from that of the current system's processor architecture.
   bool need_to_swap_bytes_;
 
+  friend class BundleWriter;  // For carrying entries over into a delta.
   friend class TensorBundleAlignmentTest;  // For testing data alignment.
 
   bool enable_multi_threading_for_testing_ = false;
+  bool use_memory_mapped_data_ = false;
+  bool verify_memory_mapped_data_ = true;
 
   BundleReader(const BundleReader&) = delete;
   void operator=(const BundleReader&) = delete;
@@ -24,6 +24,8 @@ limitations under the License.
 #endif  // _WIN32
 
 #include "absl/status/status.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/tensor_description.pb.h"
 #include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/tensor_util.h"
 #include "tensorflow/core/framework/types.pb.h"
@@ -954,6 +956,99 @@ TEST(TensorBundleTest, SortForSequentialAccess) {
                           "tensor-1-2", "tensor-1-1", "tensor-1-0"));
 }
 
+TEST(TensorBundleTest, DeltaBundle) {
+  Env* env = Env::Default();
+  const string kBase = Prefix("delta_base");
+  {
+    BundleWriter writer(env, kBase);
+    TF_EXPECT_OK(writer.Add("changed", Constant_2x3<float>(1.)));
+    TF_EXPECT_OK(writer.Add("unchanged", Constant_2x3<float>(2.)));
+    TF_EXPECT_OK(writer.AddSlice("partitioned", TensorShape({2, 6}),
+                                 TensorSlice::ParseOrDie("-:0,3"),
+                                 Constant_2x3<float>(3.)));
+    TF_EXPECT_OK(writer.AddSlice("partitioned", TensorShape({2, 6}),
+                                 TensorSlice::ParseOrDie("-:3,3"),
+                                 Constant_2x3<float>(4.)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+
+  const string kDelta = Prefix("delta");
+  {
+    BundleWriter::Options options;
+    options.base_prefix = kBase;
+    BundleWriter writer(env, kDelta, options);
+    TF_ASSERT_OK(writer.status());
+    TF_EXPECT_OK(writer.Add("changed", Constant_2x3<float>(5.)));
+    TF_EXPECT_OK(writer.AddFromBase("unchanged"));
+    TF_EXPECT_OK(writer.AddFromBase("partitioned"));
+    EXPECT_TRUE(errors::IsInvalidArgument(writer.AddFromBase("unchanged")));
+    TF_ASSERT_OK(writer.Finish());
+  }
+
+  BundleReader reader(env, kDelta);
+  TF_ASSERT_OK(reader.status());
+  reader.Seek(kHeaderEntryKey);
+  ASSERT_TRUE(reader.Valid());
+  BundleHeaderProto header;
+  ASSERT_TRUE(ParseProtoUnlimited(&header, reader.value().data(),
+                                  reader.value().size()));
+  EXPECT_EQ(io::Basename(kBase), header.base_prefix());
+  EXPECT_EQ(1, header.base_num_shards());
+  EXPECT_EQ(kTensorBundleVersion, header.version().min_consumer());
+
+  Expect<float>(&reader, "changed", Constant_2x3<float>(5.));
+  Tensor partitioned(DT_FLOAT, TensorShape({2, 6}));
+  TF_ASSERT_OK(reader.Lookup("partitioned", &partitioned));
+  test::ExpectTensorEqual<float>(
+      partitioned,
+      test::AsTensor<float>({3, 3, 3, 4, 4, 4, 3, 3, 3, 4, 4, 4},
+                            TensorShape({2, 6})));
+  Expect<float>(&reader, "unchanged", Constant_2x3<float>(2.));
+
+  // Deltas can neither be stacked nor merged.
+  BundleWriter::Options options;
+  options.base_prefix = kDelta;
+  BundleWriter stacked(env, Prefix("stacked"), options);
+  EXPECT_TRUE(errors::IsInvalidArgument(stacked.status()));
+  EXPECT_TRUE(errors::IsUnimplemented(
+      MergeBundles(env, {kDelta}, Prefix("merged_delta"))));
+
+  BundleWriter full(env, Prefix("full"));
+  EXPECT_TRUE(errors::IsFailedPrecondition(full.AddFromBase("unchanged")));
+}
+
+TEST(TensorBundleTest, LookupShardId) {
+  Env* env = Env::Default();
+  const std::vector<string> kBundlePrefixes = {Prefix("shard0"),
+                                               Prefix("shard1")};
+  BundleWriter writer0(env, kBundlePrefixes[0]);
+  TF_EXPECT_OK(writer0.Add("tensor-0", Constant_2x3<float>(0.)));
+  TF_ASSERT_OK(writer0.Finish());
+
+  BundleWriter writer1(env, kBundlePrefixes[1]);
+  TF_EXPECT_OK(writer1.Add("tensor-1", Constant_2x3<float>(1.)));
+  TF_EXPECT_OK(writer1.AddSlice("partitioned", TensorShape({2, 6}),
+                                TensorSlice::ParseOrDie("-:0,3"),
+                                Constant_2x3<float>(2.)));
+  TF_ASSERT_OK(writer1.Finish());
+
+  const string kMerged = Prefix("sharded");
+  TF_ASSERT_OK(
+      MergeBundles(env, {kBundlePrefixes[0], kBundlePrefixes[1]}, kMerged));
+
+  BundleReader reader(env, kMerged);
+  TF_ASSERT_OK(reader.status());
+  EXPECT_EQ(2, reader.num_shards());
+  int32_t shard_id;
+  TF_ASSERT_OK(reader.LookupShardId("tensor-0", &shard_id));
+  EXPECT_EQ(0, shard_id);
+  TF_ASSERT_OK(reader.LookupShardId("tensor-1", &shard_id));
+  EXPECT_EQ(1, shard_id);
+  TF_ASSERT_OK(reader.LookupShardId("partitioned", &shard_id));
+  EXPECT_EQ(-1, shard_id);
+  EXPECT_TRUE(errors::IsNotFound(reader.LookupShardId("missing", &shard_id)));
+}
+
 TEST(TensorBundleTest, Error) {
   {  // Dup keys.
     BundleWriter writer(Env::Default(), Prefix("dup"));
@@ -1151,6 +1246,82 @@ TEST(TensorBundleTest, LargeVariableLoadingTest) {
   }
 }
 
+string AllocatorName(const Tensor& t) {
+  TensorDescription description;
+  t.FillDescription(&description);
+  return description.allocation_description().allocator_name();
+}
+
+TEST(TensorBundleTest, MemoryMappedData) {
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = EIGEN_MAX_ALIGN_BYTES;
+    BundleWriter writer(Env::Default(), Prefix("mapped"), opts);
+    TF_EXPECT_OK(writer.Add("a", Constant_2x3<float>(1)));
+    TF_EXPECT_OK(writer.Add("b", Constant_2x3<tstring>(tstring("x"))));
+    TF_EXPECT_OK(writer.Add("c", Constant_2x3<int64_t>(2)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  Tensor a;
+  {
+    BundleReader::Options opts;
+    opts.use_memory_mapped_data = true;
+    BundleReader reader(Env::Default(), Prefix("mapped"), opts);
+    TF_ASSERT_OK(reader.status());
+    TF_ASSERT_OK(reader.Lookup("a", &a));
+    test::ExpectTensorEqual<float>(a, Constant_2x3<float>(1));
+    EXPECT_EQ(AllocatorName(a), "BundleMappedData");
+
+    // Strings are always copied out of the file.
+    Tensor b;
+    TF_ASSERT_OK(reader.Lookup("b", &b));
+    test::ExpectTensorEqual<tstring>(b, Constant_2x3<tstring>(tstring("x")));
+    EXPECT_NE(AllocatorName(b), "BundleMappedData");
+
+    // Pre-allocated tensors are filled in place.
+    Tensor c(DT_INT64, TensorShape({2, 3}));
+    TF_ASSERT_OK(reader.Lookup("c", &c));
+    test::ExpectTensorEqual<int64_t>(c, Constant_2x3<int64_t>(2));
+    EXPECT_NE(AllocatorName(c), "BundleMappedData");
+  }
+  // The mapping outlives the reader.
+  test::ExpectTensorEqual<float>(a, Constant_2x3<float>(1));
+}
+
+TEST(TensorBundleTest, UnverifiedMemoryMappedData) {
+  {
+    BundleWriter::Options opts;
+    opts.data_alignment = EIGEN_MAX_ALIGN_BYTES;
+    BundleWriter writer(Env::Default(), Prefix("unverified"), opts);
+    TF_EXPECT_OK(writer.Add("a", Constant_2x3<float>(1)));
+    TF_ASSERT_OK(writer.Finish());
+  }
+  // Corrupts the first element.
+  const string datafile = DataFilename(Prefix("unverified"), 0, 1);
+  string data;
+  TF_ASSERT_OK(ReadFileToString(Env::Default(), datafile, &data));
+  data[0] = ~data[0];
+  TF_ASSERT_OK(WriteStringToFile(Env::Default(), datafile, data));
+
+  BundleReader::Options opts;
+  opts.use_memory_mapped_data = true;
+  {
+    BundleReader reader(Env::Default(), Prefix("unverified"), opts);
+    TF_ASSERT_OK(reader.status());
+    Tensor a;
+    EXPECT_TRUE(errors::IsDataLoss(reader.Lookup("a", &a)));
+  }
+  // Without verification the view is returned without reading the data.
+  opts.verify_memory_mapped_data = false;
+  BundleReader reader(Env::Default(), Prefix("unverified"), opts);
+  TF_ASSERT_OK(reader.status());
+  Tensor a;
+  TF_ASSERT_OK(reader.Lookup("a", &a));
+  EXPECT_EQ(AllocatorName(a), "BundleMappedData");
+  EXPECT_NE(a.flat<float>()(0), 1);
+  EXPECT_EQ(a.flat<float>()(1), 1);
+}
+
 absl::Status CreateFile(Env* env, const std::string& fname) {
   std::unique_ptr<WritableFile> file;
   TF_RETURN_IF_ERROR(env->NewWritableFile(fname, &file));
@@ -17,7 +17,9 @@ limitations under the License.
 
 #include <cstdint>
 #include <iterator>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
@@ -164,31 +166,38 @@ StatusOr<const mlir::Value> EmitAllScatter(
   return all_scatter.getOutput();
 }
 
-bool CanUseAllToAll(const dtensor::Layout& src_layout,
-                    const dtensor::Layout& tgt_layout) {
-  // All-to-all can be used for relayout if one dimension is becoming more
-  // sharded while another is becoming less sharded, for example x,unsharded ->
-  // unsharded,x.
-  // TODO(trevor-m): There may be more types of relayouts which can utilize
-  // all-to-all in addition to these which can be supported later.
-  int num_split_dims = 0;
-  int num_concat_dims = 0;
-  std::string split_spec;
-  std::string concat_spec;
-  for (int i = 0; i < src_layout.rank(); ++i) {
-    if (src_layout.sharding_spec(i) == tgt_layout.sharding_spec(i)) continue;
-    if (Layout::IsUnshardedDimension(src_layout.sharding_spec(i)) &&
-        Layout::IsShardedDimension(tgt_layout.sharding_spec(i))) {
-      num_split_dims++;
-      split_spec = tgt_layout.sharding_spec(i);
-    } else if (Layout::IsShardedDimension(src_layout.sharding_spec(i)) &&
-               Layout::IsUnshardedDimension(tgt_layout.sharding_spec(i))) {
-      num_concat_dims++;
-      concat_spec = src_layout.sharding_spec(i);
+// Returns the layout reached from `layout` towards `tgt_layout` by moving a
+// single mesh axis from one tensor dimension to an unsharded one, for example
+// x,unsharded -> unsharded,x, or std::nullopt if there is no such move left.
+// Such a move can be done by an all-to-all, which only exchanges the local
+// shards, instead of an all-gather that materializes the unsharded dimension.
+// TODO(trevor-m): There may be more types of relayouts which can utilize
+// all-to-all in addition to these which can be supported later.
+StatusOr<std::optional<Layout>> NextAllToAllLayout(const Layout& layout,
+                                                   const Layout& tgt_layout) {
+  for (int i = 0; i < layout.rank(); ++i) {
+    const std::string& spec = layout.sharding_spec(i);
+    if (!Layout::IsShardedDimension(spec) ||
+        spec == tgt_layout.sharding_spec(i)) {
+      continue;
+    }
+    for (int j = 0; j < layout.rank(); ++j) {
+      if (tgt_layout.sharding_spec(j) != spec ||
+          !Layout::IsUnshardedDimension(layout.sharding_spec(j))) {
+        continue;
+      }
+      std::vector<std::string> specs = layout.sharding_spec_strs();
+      specs[i] = Layout::kUnshardedDim;
+      specs[j] = spec;
+      if (specs == tgt_layout.sharding_spec_strs()) {
+        return std::optional<Layout>(tgt_layout);
+      }
+      TF_ASSIGN_OR_RETURN(Layout next, Layout::GetLayout(tgt_layout.type(),
+                                                         specs, layout.mesh()));
+      return std::optional<Layout>(std::move(next));
     }
   }
-  return num_split_dims == 1 && num_concat_dims == 1 &&
-         split_spec == concat_spec;
+  return std::optional<Layout>();
 }
 
 StatusOr<mlir::Value> EmitAllToAll(
@@ -336,13 +345,23 @@ StatusOr<mlir::Value> EmitRelayout(
         "Attempted to relayout to a different global shape.");
   }
 
-  if (EnableAllToAllForRelayout() && !is_sparse &&
-      CanUseAllToAll(src_layout, tgt_layout)) {
+  if (EnableAllToAllForRelayout() && !is_sparse) {
     // TODO(tmorris): support sparse case
-    TF_ASSIGN_OR_RETURN(mlir::Value all_to_all_result,
-                        EmitAllToAll(builder, input, src_layout, tgt_layout,
-                                     newly_created_ops));
-    return all_to_all_result;
+    // Move as many mesh axes as possible with all-to-alls, one axis at a time,
+    // and leave the rest of the relayout to the splits and all-gather below.
+    mlir::Value value = input;
+    Layout layout = src_layout;
+    while (true) {
+      TF_ASSIGN_OR_RETURN(std::optional<Layout> next,
+                          NextAllToAllLayout(layout, tgt_layout));
+      if (!next.has_value()) break;
+      TF_ASSIGN_OR_RETURN(value, EmitAllToAll(builder, value, layout, *next,
+                                              newly_created_ops));
+      layout = *std::move(next);
+    }
+    if (layout != src_layout) {
+      return EmitRelayout(value, layout, tgt_layout, newly_created_ops);
+    }
   }
 
   absl::flat_hash_set<std::string> src_sharding_dims;
@@ -1701,6 +1701,7 @@ struct XNNPackSettingsT : public ::flatbuffers::NativeTable {
   int32_t num_threads = 0;
   tflite::XNNPackFlags flags = tflite::XNNPackFlags_TFLITE_XNNPACK_DELEGATE_NO_FLAGS;
   std::string weight_cache_file_path{};
+  std::vector<int32_t> nodes_to_skip{};
 };
 
 struct XNNPackSettings FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
@@ -1709,7 +1710,8 @@ struct XNNPackSettings FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
   enum FlatBuffersVTableOffset FLATBUFFERS_VTABLE_UNDERLYING_TYPE {
     VT_NUM_THREADS = 4,
     VT_FLAGS = 6,
-    VT_WEIGHT_CACHE_FILE_PATH = 8
+    VT_WEIGHT_CACHE_FILE_PATH = 8,
+    VT_NODES_TO_SKIP = 10
   };
   int32_t num_threads() const {
     return GetField<int32_t>(VT_NUM_THREADS, 0);
@@ -1720,12 +1722,17 @@ struct XNNPackSettings FLATBUFFERS_FINAL_CLASS : private ::flatbuffers::Table {
   const ::flatbuffers::String *weight_cache_file_path() const {
     return GetPointer<const ::flatbuffers::String *>(VT_WEIGHT_CACHE_FILE_PATH);
   }
+  const ::flatbuffers::Vector<int32_t> *nodes_to_skip() const {
+    return GetPointer<const ::flatbuffers::Vector<int32_t> *>(VT_NODES_TO_SKIP);
+  }
   bool Verify(::flatbuffers::Verifier &verifier) const {
     return VerifyTableStart(verifier) &&
            VerifyField<int32_t>(verifier, VT_NUM_THREADS, 4) &&
            VerifyField<int32_t>(verifier, VT_FLAGS, 4) &&
            VerifyOffset(verifier, VT_WEIGHT_CACHE_FILE_PATH) &&
            verifier.VerifyString(weight_cache_file_path()) &&
+           VerifyOffset(verifier, VT_NODES_TO_SKIP) &&
+           verifier.VerifyVector(nodes_to_skip()) &&
            verifier.EndTable();
   }
   XNNPackSettingsT *UnPack(const ::flatbuffers::resolver_function_t *_resolver = nullptr) const;
@@ -1746,6 +1753,9 @@ struct XNNPackSettingsBuilder {
   void add_weight_cache_file_path(::flatbuffers::Offset<::flatbuffers::String> weight_cache_file_path) {
     fbb_.AddOffset(XNNPackSettings::VT_WEIGHT_CACHE_FILE_PATH, weight_cache_file_path);
   }
+  void add_nodes_to_skip(::flatbuffers::Offset<::flatbuffers::Vector<int32_t>> nodes_to_skip) {
+    fbb_.AddOffset(XNNPackSettings::VT_NODES_TO_SKIP, nodes_to_skip);
+  }
   explicit XNNPackSettingsBuilder(::flatbuffers::FlatBufferBuilder &_fbb)
         : fbb_(_fbb) {
     start_ = fbb_.StartTable();
@@ -1761,8 +1771,10 @@ inline ::flatbuffers::Offset<XNNPackSettings> CreateXNNPackSettings(
     ::flatbuffers::FlatBufferBuilder &_fbb,
     int32_t num_threads = 0,
     tflite::XNNPackFlags flags = tflite::XNNPackFlags_TFLITE_XNNPACK_DELEGATE_NO_FLAGS,
-    ::flatbuffers::Offset<::flatbuffers::String> weight_cache_file_path = 0) {
+    ::flatbuffers::Offset<::flatbuffers::String> weight_cache_file_path = 0,
+    ::flatbuffers::Offset<::flatbuffers::Vector<int32_t>> nodes_to_skip = 0) {
   XNNPackSettingsBuilder builder_(_fbb);
+  builder_.add_nodes_to_skip(nodes_to_skip);
   builder_.add_weight_cache_file_path(weight_cache_file_path);
   builder_.add_flags(flags);
   builder_.add_num_threads(num_threads);
@@ -1773,13 +1785,16 @@ inline ::flatbuffers::Offset<XNNPackSettings> CreateXNNPackSettingsDirect(
     ::flatbuffers::FlatBufferBuilder &_fbb,
     int32_t num_threads = 0,
     tflite::XNNPackFlags flags = tflite::XNNPackFlags_TFLITE_XNNPACK_DELEGATE_NO_FLAGS,
-    const char *weight_cache_file_path = nullptr) {
+    const char *weight_cache_file_path = nullptr,
+    const std::vector<int32_t> *nodes_to_skip = nullptr) {
   auto weight_cache_file_path__ = weight_cache_file_path ? _fbb.CreateString(weight_cache_file_path) : 0;
+  auto nodes_to_skip__ = nodes_to_skip ? _fbb.CreateVector<int32_t>(*nodes_to_skip) : 0;
   return tflite::CreateXNNPackSettings(
       _fbb,
       num_threads,
       flags,
-      weight_cache_file_path__);
+      weight_cache_file_path__,
+      nodes_to_skip__);
 }
 
 ::flatbuffers::Offset<XNNPackSettings> CreateXNNPackSettings(::flatbuffers::FlatBufferBuilder &_fbb, const XNNPackSettingsT *_o, const ::flatbuffers::rehasher_function_t *_rehasher = nullptr);
@@ -4971,7 +4986,8 @@ inline bool operator==(const XNNPackSettingsT &lhs, const XNNPackSettingsT &rhs)
   return
       (lhs.num_threads == rhs.num_threads) &&
       (lhs.flags == rhs.flags) &&
-      (lhs.weight_cache_file_path == rhs.weight_cache_file_path);
+      (lhs.weight_cache_file_path == rhs.weight_cache_file_path) &&
+      (lhs.nodes_to_skip == rhs.nodes_to_skip);
 }
 
 inline bool operator!=(const XNNPackSettingsT &lhs, const XNNPackSettingsT &rhs) {
@@ -4991,6 +5007,7 @@ inline void XNNPackSettings::UnPackTo(XNNPackSettingsT *_o, const ::flatbuffers:
   { auto _e = num_threads(); _o->num_threads = _e; }
   { auto _e = flags(); _o->flags = _e; }
   { auto _e = weight_cache_file_path(); if (_e) _o->weight_cache_file_path = _e->str(); }
+  { auto _e = nodes_to_skip(); if (_e) { _o->nodes_to_skip.resize(_e->size()); for (::flatbuffers::uoffset_t _i = 0; _i < _e->size(); _i++) { _o->nodes_to_skip[_i] = _e->Get(_i); } } else { _o->nodes_to_skip.resize(0); } }
 }
 
 inline ::flatbuffers::Offset<XNNPackSettings> XNNPackSettings::Pack(::flatbuffers::FlatBufferBuilder &_fbb, const XNNPackSettingsT* _o, const ::flatbuffers::rehasher_function_t *_rehasher) {
@@ -5004,11 +5021,13 @@ inline ::flatbuffers::Offset<XNNPackSettings> CreateXNNPackSettings(::flatbuffer
   auto _num_threads = _o->num_threads;
   auto _flags = _o->flags;
   auto _weight_cache_file_path = _o->weight_cache_file_path.empty() ? 0 : _fbb.CreateString(_o->weight_cache_file_path);
+  auto _nodes_to_skip = _o->nodes_to_skip.size() ? _fbb.CreateVector(_o->nodes_to_skip) : 0;
   return tflite::CreateXNNPackSettings(
       _fbb,
       _num_threads,
       _flags,
-      _weight_cache_file_path);
+      _weight_cache_file_path,
+      _nodes_to_skip);
 }
 
 
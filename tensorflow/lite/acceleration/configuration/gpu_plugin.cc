@@ -128,6 +128,13 @@ GpuPlugin::GpuPlugin(const TFLiteSettings& tflite_settings)
     options_.model_token = model_token_.c_str();
     options_.experimental_flags |=
         TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION;
+  } else if (!cache_dir.empty()) {
+    cache_dir_ = cache_dir;
+    options_.serialization_dir = cache_dir_.c_str();
+  }
+  if (!cache_dir.empty()) {
+    options_.experimental_flags |=
+        TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_PROGRAM_CACHE;
   }
 }
 
@@ -18,14 +18,17 @@ limitations under the License.
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <limits>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/graph_info.h"
 #include "tensorflow/lite/simple_memory_arena.h"
+#include "tensorflow/lite/util.h"
 
 namespace tflite {
 
@@ -34,6 +37,72 @@ constexpr int32_t kLastActiveNodeUndefined =
 constexpr int32_t kNodeNotAssigned = std::numeric_limits<int32_t>::max();
 constexpr int32_t kScalarTensorBytes = 4;
 
+// Bounds the memory held by cached plans when inputs take many shapes; the
+// least recently used plan is evicted first.
+constexpr size_t kMaxCachedArenaPlans = 16;
+
+// Serialized plans: magic, version, tensor alignment and plan count, then for
+// each plan its alloc count and allocs, then a checksum of all of the above.
+constexpr uint32_t kArenaPlansMagic = 0x50414c54;  // "TLAP"
+constexpr uint32_t kArenaPlansVersion = 1;
+
+namespace {
+
+template <typename T>
+void AppendValue(T value, std::string* out) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool ReadValue(const std::string& in, size_t* pos, T* value) {
+  if (in.size() < *pos + sizeof(T)) {
+    return false;
+  }
+  std::memcpy(value, in.data() + *pos, sizeof(T));
+  *pos += sizeof(T);
+  return true;
+}
+
+uint64_t Checksum(const char* data, size_t size) {
+  // FNV-1a.
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ static_cast<uint8_t>(data[i])) * 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+// Hashes the requests (not the offsets) that `allocs` were computed for.
+size_t PlanKey(int tensor_alignment,
+               const std::vector<ArenaAllocWithUsageInterval>& allocs) {
+  size_t key = CombineHashes(
+      {static_cast<size_t>(tensor_alignment), allocs.size()});
+  for (const ArenaAllocWithUsageInterval& alloc : allocs) {
+    key = CombineHashes({key, static_cast<size_t>(alloc.tensor), alloc.size,
+                         static_cast<size_t>(alloc.first_node),
+                         static_cast<size_t>(alloc.last_node)});
+  }
+  return key;
+}
+
+bool SameRequests(const std::vector<ArenaAllocWithUsageInterval>& plan,
+                  const std::vector<ArenaAllocWithUsageInterval>& requests) {
+  if (plan.size() != requests.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < plan.size(); ++i) {
+    if (plan[i].tensor != requests[i].tensor ||
+        plan[i].size != requests[i].size ||
+        plan[i].first_node != requests[i].first_node ||
+        plan[i].last_node != requests[i].last_node) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
 ArenaPlanner::ArenaPlanner(TfLiteContext* context,
                            std::unique_ptr<GraphInfo> graph_info,
                            bool preserve_all_tensors, int tensor_alignment,
@@ -232,7 +301,8 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
       return kTfLiteOk;
     }
     TF_LITE_ENSURE(context_, dealloc_node_[tensor] == kNodeNotAssigned);
-    dealloc_node_[tensor] = node;
+    // Nodes running concurrently with `node` may still use the tensor.
+    dealloc_node_[tensor] = graph_info_->last_concurrent_node(node);
     return kTfLiteOk;
   };
 
@@ -303,14 +373,16 @@ TfLiteStatus ArenaPlanner::PlanAllocations() {
   for (size_t i = 0; i < num_execution_nodes; ++i) {
     const TfLiteNode& node = graph_info_->node(i);
 
-    // First queue output tensors for allocation.
+    // First queue output tensors for allocation. Outputs are allocated before
+    // any node that may run concurrently with this one starts.
+    const int first_concurrent_node = graph_info_->first_concurrent_node(i);
     TfLiteIntArray* node_outputs = node.outputs;
     for (int j = 0; j < node_outputs->size; ++j) {
       int tensor_index = node_outputs->data[j];
       if (tensor_index == kTfLiteOptionalTensor) continue;
       //  Don't allocate output tensors here for shared memory parts.
-      nodes_to_tensors_[i].insert(tensor_index);
-      TF_LITE_ENSURE_STATUS(allocate(i, tensor_index));
+      nodes_to_tensors_[first_concurrent_node].insert(tensor_index);
+      TF_LITE_ENSURE_STATUS(allocate(first_concurrent_node, tensor_index));
     }
 
     // Then update the ref-counts of the node's inputs, and if necessary queue
@@ -344,18 +416,23 @@ TfLiteStatus ArenaPlanner::ExecuteAllocations(int first_node, int last_node) {
   alloc_node_.resize(num_tensors, kNodeNotAssigned);
   dealloc_node_.resize(num_tensors, kNodeNotAssigned);
   allocs_.resize(num_tensors);
-  // Set allocation and deallocation for temporary tensors.
+  // Set allocation and deallocation for temporary tensors. Temporaries live
+  // as long as any node that may run concurrently with their node.
   const int num_execution_nodes = graph_info_->num_execution_nodes();
+  if (first_node < num_execution_nodes) {
+    first_node = graph_info_->first_concurrent_node(first_node);
+  }
   for (size_t i = first_node;
        i <= static_cast<size_t>(last_node) && i < num_execution_nodes; ++i) {
     const TfLiteNode& node = graph_info_->node(i);
     TfLiteIntArray* node_temporaries = node.temporaries;
+    const int first_concurrent_node = graph_info_->first_concurrent_node(i);
     for (int j = 0; j < node_temporaries->size; ++j) {
       int tensor_index = node_temporaries->data[j];
-      alloc_node_[tensor_index] = i;
-      nodes_to_tensors_[i].insert(tensor_index);
+      alloc_node_[tensor_index] = first_concurrent_node;
+      nodes_to_tensors_[first_concurrent_node].insert(tensor_index);
       if (!preserve_all_tensors_) {
-        dealloc_node_[tensor_index] = i;
+        dealloc_node_[tensor_index] = graph_info_->last_concurrent_node(i);
       }
     }
   }
@@ -509,7 +586,8 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
     last_active_node_ = last_node;
     return kTfLiteOk;
   }
-  if (first_node < last_active_node_) {
+  const bool arena_was_empty = first_node < last_active_node_;
+  if (arena_was_empty) {
     arena_.ResetAllocs();
     last_active_node_ = first_node;
   } else {
@@ -518,6 +596,8 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
     arena_.PurgeActiveAllocs(first_node);
   }
   CreateTensorAllocationVector(tensors_allocated);
+  std::vector<int32_t> arena_tensors;
+  arena_tensors.reserve(tensors_allocated->size());
   // Vector of ids of already allocated tensors, ordered by offset.
   for (const auto& tensor_index : *tensors_allocated) {
     TfLiteTensor& tensor = tensors[tensor_index];
@@ -541,10 +621,7 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
       }
     }
     if (tensor.allocation_type == kTfLiteArenaRw) {
-      TF_LITE_ENSURE_STATUS(
-          arena_.Allocate(context_, tensor_alignment_, tensor.bytes,
-                          tensor_index, alloc_node_[tensor_index],
-                          dealloc_node_[tensor_index], &allocs_[tensor_index]));
+      arena_tensors.push_back(tensor_index);
     }
     // Check allocs_[].size to prevent from reallocation of persistent tensors.
     // Only allocate ArenaRwPersistent tensors which own their buffer.
@@ -559,10 +636,147 @@ TfLiteStatus ArenaPlanner::CalculateAllocations(
       }
     }
   }
+  TF_LITE_ENSURE_STATUS(AllocateInArena(arena_tensors, arena_was_empty));
   last_active_node_ = last_node;
   return kTfLiteOk;
 }
 
+TfLiteStatus ArenaPlanner::AllocateInArena(
+    const std::vector<int32_t>& arena_tensors, bool arena_was_empty) {
+  TfLiteTensor* tensors = graph_info_->tensors();
+  if (!arena_was_empty) {
+    for (int32_t tensor_index : arena_tensors) {
+      TF_LITE_ENSURE_STATUS(arena_.Allocate(
+          context_, tensor_alignment_, tensors[tensor_index].bytes,
+          tensor_index, alloc_node_[tensor_index], dealloc_node_[tensor_index],
+          &allocs_[tensor_index]));
+    }
+    return kTfLiteOk;
+  }
+
+  // Starting from an empty arena, the offsets only depend on the sequence of
+  // requests, so a plan computed for the same requests can be replayed.
+  std::vector<ArenaAllocWithUsageInterval> requests(arena_tensors.size());
+  for (size_t i = 0; i < arena_tensors.size(); ++i) {
+    const int32_t tensor_index = arena_tensors[i];
+    requests[i].tensor = tensor_index;
+    requests[i].size = tensors[tensor_index].bytes;
+    requests[i].first_node = alloc_node_[tensor_index];
+    requests[i].last_node = dealloc_node_[tensor_index];
+  }
+  const size_t key = PlanKey(tensor_alignment_, requests);
+  auto cached = cached_plan_index_.find(key);
+  if (cached != cached_plan_index_.end() &&
+      SameRequests(cached->second->second, requests)) {
+    cached_plans_.splice(cached_plans_.begin(), cached_plans_,
+                         cached->second);
+    for (const ArenaAllocWithUsageInterval& alloc : cached->second->second) {
+      arena_.Restore(alloc);
+      allocs_[alloc.tensor] = alloc;
+    }
+    return kTfLiteOk;
+  }
+
+  for (ArenaAllocWithUsageInterval& request : requests) {
+    TF_LITE_ENSURE_STATUS(arena_.Allocate(
+        context_, tensor_alignment_, request.size, request.tensor,
+        request.first_node, request.last_node, &allocs_[request.tensor]));
+    request = allocs_[request.tensor];
+  }
+  CachePlan(key, std::move(requests));
+  return kTfLiteOk;
+}
+
+void ArenaPlanner::CachePlan(size_t key,
+                             std::vector<ArenaAllocWithUsageInterval> plan) {
+  auto cached = cached_plan_index_.find(key);
+  if (cached != cached_plan_index_.end()) {
+    cached_plans_.erase(cached->second);
+  }
+  cached_plans_.emplace_front(key, std::move(plan));
+  cached_plan_index_[key] = cached_plans_.begin();
+  if (cached_plans_.size() > kMaxCachedArenaPlans) {
+    cached_plan_index_.erase(cached_plans_.back().first);
+    cached_plans_.pop_back();
+  }
+}
+
+TfLiteStatus ArenaPlanner::SerializePlans(std::string* plans) const {
+  TF_LITE_ENSURE(context_, plans != nullptr);
+  plans->clear();
+  AppendValue<uint32_t>(kArenaPlansMagic, plans);
+  AppendValue<uint32_t>(kArenaPlansVersion, plans);
+  AppendValue<uint32_t>(tensor_alignment_, plans);
+  AppendValue<uint32_t>(cached_plans_.size(), plans);
+  // Least recently used first, so that loading the plans in order restores
+  // their recency.
+  for (auto plan = cached_plans_.rbegin(); plan != cached_plans_.rend();
+       ++plan) {
+    AppendValue<uint32_t>(plan->second.size(), plans);
+    for (const ArenaAllocWithUsageInterval& alloc : plan->second) {
+      AppendValue<int32_t>(alloc.tensor, plans);
+      AppendValue<int32_t>(alloc.first_node, plans);
+      AppendValue<int32_t>(alloc.last_node, plans);
+      AppendValue<uint64_t>(alloc.offset, plans);
+      AppendValue<uint64_t>(alloc.size, plans);
+    }
+  }
+  AppendValue<uint64_t>(Checksum(plans->data(), plans->size()), plans);
+  return kTfLiteOk;
+}
+
+TfLiteStatus ArenaPlanner::LoadPlans(const std::string& plans) {
+  size_t pos = 0;
+  uint32_t magic, version, tensor_alignment, num_plans;
+  uint64_t checksum;
+  TF_LITE_ENSURE(context_, plans.size() >= sizeof(checksum));
+  const size_t payload_size = plans.size() - sizeof(checksum);
+  size_t checksum_pos = payload_size;
+  TF_LITE_ENSURE(context_, ReadValue(plans, &checksum_pos, &checksum));
+  TF_LITE_ENSURE_MSG(context_,
+                     checksum == Checksum(plans.data(), payload_size),
+                     "Arena plans are corrupted.");
+  TF_LITE_ENSURE(context_, ReadValue(plans, &pos, &magic) &&
+                               ReadValue(plans, &pos, &version) &&
+                               ReadValue(plans, &pos, &tensor_alignment) &&
+                               ReadValue(plans, &pos, &num_plans));
+  TF_LITE_ENSURE_MSG(context_,
+                     magic == kArenaPlansMagic && version == kArenaPlansVersion,
+                     "Unsupported arena plans format.");
+  TF_LITE_ENSURE_MSG(
+      context_, tensor_alignment == static_cast<uint32_t>(tensor_alignment_),
+      "Arena plans were computed for a different tensor alignment.");
+
+  const size_t num_tensors = graph_info_->num_tensors();
+  std::vector<std::vector<ArenaAllocWithUsageInterval>> loaded_plans;
+  for (uint32_t i = 0; i < num_plans; ++i) {
+    uint32_t num_allocs;
+    TF_LITE_ENSURE(context_, ReadValue(plans, &pos, &num_allocs));
+    std::vector<ArenaAllocWithUsageInterval> plan(num_allocs);
+    for (ArenaAllocWithUsageInterval& alloc : plan) {
+      uint64_t offset, size;
+      TF_LITE_ENSURE(context_, ReadValue(plans, &pos, &alloc.tensor) &&
+                                   ReadValue(plans, &pos, &alloc.first_node) &&
+                                   ReadValue(plans, &pos, &alloc.last_node) &&
+                                   ReadValue(plans, &pos, &offset) &&
+                                   ReadValue(plans, &pos, &size));
+      TF_LITE_ENSURE(context_,
+                     alloc.tensor >= 0 &&
+                         static_cast<size_t>(alloc.tensor) < num_tensors &&
+                         offset % tensor_alignment_ == 0);
+      alloc.offset = offset;
+      alloc.size = size;
+    }
+    loaded_plans.push_back(std::move(plan));
+  }
+  TF_LITE_ENSURE(context_, pos == payload_size);
+  for (auto& plan : loaded_plans) {
+    const size_t key = PlanKey(tensor_alignment_, plan);
+    CachePlan(key, std::move(plan));
+  }
+  return kTfLiteOk;
+}
+
 bool AreTensorsAllocatedInSameArena(int32_t root_tensor_index,
                                     int32_t tensor_index,
                                     const TfLiteTensor* tensors) {
@@ -17,9 +17,12 @@ limitations under the License.
 
 #include <cstddef>
 #include <cstdint>
+#include <list>
 #include <memory>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include "tensorflow/lite/core/c/common.h"
@@ -68,6 +71,8 @@ class ArenaPlanner : public MemoryPlanner {
   void DumpDebugInfo(const std::vector<int>& execution_plan) const override;
   void GetAllocInfo(size_t* arena_size,
                     size_t* arena_persist_size) const override;
+  TfLiteStatus SerializePlans(std::string* plans) const override;
+  TfLiteStatus LoadPlans(const std::string& plans) override;
 
   // Returns the base arena location for a given allocation type.
   std::intptr_t BasePointer(TfLiteAllocationType type);
@@ -104,6 +109,16 @@ class ArenaPlanner : public MemoryPlanner {
   TfLiteStatus CalculateAllocations(int first_node, int last_node,
                                     std::vector<int32_t>* tensors_allocated);
 
+  // Reserves space in `arena_` for `arena_tensors`, in order. When the arena
+  // was empty beforehand the offsets are taken from `cached_plans_` if the
+  // same requests were planned before, and recorded there otherwise.
+  TfLiteStatus AllocateInArena(const std::vector<int32_t>& arena_tensors,
+                               bool arena_was_empty);
+
+  // Makes `plan` the most recently used entry of `cached_plans_`, evicting
+  // the least recently used one if the cache is full.
+  void CachePlan(size_t key, std::vector<ArenaAllocWithUsageInterval> plan);
+
   // Assign absolute memory location to a tensor, based on its relative
   // position inside the corresponding arena buffer.
   TfLiteStatus ResolveTensorAllocation(int32_t tensor_index,
@@ -166,6 +181,17 @@ class ArenaPlanner : public MemoryPlanner {
 
   // Store number of references to each tensor.
   std::vector<int> refcounts_;
+
+  // Arena plans computed from an empty arena, most recently used first, with
+  // the hash of the allocation requests (tensor, size and usage interval)
+  // they were made for. Models whose inputs alternate between a few shapes,
+  // and plans loaded with LoadPlans(), skip the offset calculation.
+  using CachedPlan =
+      std::pair<size_t, std::vector<ArenaAllocWithUsageInterval>>;
+  std::list<CachedPlan> cached_plans_;
+  // NOLINTNEXTLINE - absl::flat_hash_map increases binary size by 106kB.
+  std::unordered_map<size_t, std::list<CachedPlan>::iterator>
+      cached_plan_index_;
 };
 
 }  // namespace tflite
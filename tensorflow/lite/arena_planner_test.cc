@@ -19,9 +19,11 @@ limitations under the License.
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <initializer_list>
 #include <memory>
 #include <set>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -370,6 +372,94 @@ TEST_F(ArenaPlannerTest, AllocsCorrectlyReset) {
   EXPECT_EQ(GetOffset(1), 4);
 }
 
+TEST_F(ArenaPlannerTest, ReusesPlanForRepeatedTensorSizes) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  Execute(0, graph.nodes().size() - 1);
+  std::vector<std::ptrdiff_t> offsets;
+  for (int i = 0; i <= 5; ++i) offsets.push_back(GetOffset(i));
+
+  std::vector<TfLiteTensor>& tensors = *graph.tensors();
+  ResetAllocations();
+  tensors[2].bytes *= 10;
+  Execute(0, graph.nodes().size() - 1);
+  EXPECT_NE(GetOffset(4), offsets[4]);
+
+  // Going back to the original sizes replays the first plan.
+  ResetAllocations();
+  tensors[2].bytes /= 10;
+  Execute(0, graph.nodes().size() - 1);
+  for (int i = 0; i <= 5; ++i) EXPECT_EQ(GetOffset(i), offsets[i]) << i;
+}
+
+TEST_F(ArenaPlannerTest, LoadsSerializedPlans) {
+  TestGraph graph({0, 1},
+                  {
+                      /* in, out, tmp */
+                      {{0, 1}, {2}, {}},     // First op
+                      {{2, 0}, {4, 5}, {}},  // Second op
+                      {{4, 5}, {3}, {}}      // Third op
+                  },
+                  {3});
+  SetGraph(&graph);
+  Execute(0, graph.nodes().size() - 1);
+  std::vector<std::ptrdiff_t> offsets;
+  for (int i = 0; i <= 5; ++i) offsets.push_back(GetOffset(i));
+  std::string plans;
+  ASSERT_EQ(planner_->SerializePlans(&plans), kTfLiteOk);
+
+  SetGraph(&graph);
+  ASSERT_EQ(planner_->LoadPlans(plans), kTfLiteOk);
+  Execute(0, graph.nodes().size() - 1);
+  for (int i = 0; i <= 5; ++i) EXPECT_EQ(GetOffset(i), offsets[i]) << i;
+
+  std::string reserialized;
+  ASSERT_EQ(planner_->SerializePlans(&reserialized), kTfLiteOk);
+  EXPECT_EQ(reserialized, plans);
+}
+
+TEST_F(ArenaPlannerTest, KeepsMostRecentlyUsedPlans) {
+  TestGraph graph({0, 1}, {{{0, 1}, {2}, {}}}, {2});
+  SetGraph(&graph);
+  std::vector<TfLiteTensor>& tensors = *graph.tensors();
+  for (int i = 0; i < 20; ++i) {
+    ResetAllocations();
+    tensors[2].bytes = 4 * (i + 1);
+    Execute(0, graph.nodes().size() - 1);
+  }
+  std::string plans;
+  ASSERT_EQ(planner_->SerializePlans(&plans), kTfLiteOk);
+  // The header holds the magic, version, alignment and number of plans.
+  uint32_t num_plans;
+  ASSERT_GE(plans.size(), 4 * sizeof(uint32_t));
+  std::memcpy(&num_plans, plans.data() + 3 * sizeof(uint32_t),
+              sizeof(num_plans));
+  EXPECT_EQ(num_plans, 16);
+}
+
+TEST_F(ArenaPlannerTest, RejectsCorruptedPlans) {
+  TestGraph graph({0, 1}, {{{0, 1}, {2}, {}}}, {2});
+  SetGraph(&graph);
+  Execute(0, graph.nodes().size() - 1);
+  std::string plans;
+  ASSERT_EQ(planner_->SerializePlans(&plans), kTfLiteOk);
+
+  SetGraph(&graph);
+  std::string corrupted = plans;
+  corrupted[corrupted.size() / 2] ^= 1;
+  EXPECT_NE(planner_->LoadPlans(corrupted), kTfLiteOk);
+  EXPECT_NE(planner_->LoadPlans(plans.substr(0, plans.size() - 1)), kTfLiteOk);
+  EXPECT_NE(planner_->LoadPlans(""), kTfLiteOk);
+  EXPECT_EQ(planner_->LoadPlans(plans), kTfLiteOk);
+}
+
 TEST_F(ArenaPlannerTest, SimpleGraphInputsPreserved) {
   TestGraph graph({0, 1},
                   {
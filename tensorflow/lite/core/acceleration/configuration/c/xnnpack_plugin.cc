@@ -44,6 +44,10 @@ static TfLiteDelegate* CreateDelegate(const void* settings) {
       options.weight_cache_file_path =
           xnnpack_settings->weight_cache_file_path()->c_str();
     }
+    if (xnnpack_settings->nodes_to_skip()) {
+      options.nodes_to_skip = xnnpack_settings->nodes_to_skip()->data();
+      options.num_nodes_to_skip = xnnpack_settings->nodes_to_skip()->size();
+    }
   }
   // LINT.ThenChange(../xnnpack_plugin.cc:tflite_settings_to_xnnpack_delegate_options)
   return TfLiteXNNPackDelegateCreate(&options);
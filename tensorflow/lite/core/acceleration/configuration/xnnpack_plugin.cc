@@ -50,6 +50,10 @@ class XNNPackPlugin : public DelegatePluginInterface {
         options_.weight_cache_file_path =
             xnnpack_settings->weight_cache_file_path()->c_str();
       }
+      if (xnnpack_settings->nodes_to_skip()) {
+        options_.nodes_to_skip = xnnpack_settings->nodes_to_skip()->data();
+        options_.num_nodes_to_skip = xnnpack_settings->nodes_to_skip()->size();
+      }
     }
     // LINT.ThenChange(c/xnnpack_plugin.cc:tflite_settings_to_xnnpack_delegate_options)
   }
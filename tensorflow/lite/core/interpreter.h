@@ -497,6 +497,20 @@ class Interpreter {
   /// invocation.
   TfLiteStatus ReleaseNonPersistentMemory();
 
+  /// \warning Experimental interface, subject to change. \n
+  /// \brief Serializes the arena plans computed by every subgraph so far, so
+  /// that they can be stored next to the model (e.g. in an app cache) and
+  /// handed to LoadMemoryPlans() on the next launch. A plan is computed by
+  /// each AllocateTensors() for the current input shapes.
+  TfLiteStatus SerializeMemoryPlans(std::string* plans) const;
+
+  /// \warning Experimental interface, subject to change. \n
+  /// \brief Loads plans produced by SerializeMemoryPlans() for the same model.
+  /// Later calls to AllocateTensors() for tensor sizes matching a loaded plan
+  /// reuse its offsets instead of recomputing them. Must be called before
+  /// AllocateTensors() to speed up the first allocation.
+  TfLiteStatus LoadMemoryPlans(const std::string& plans);
+
   /// Update allocations for all tensors. This will redim dependent tensors
   /// using the input tensor dimensionality as given. This is relatively
   /// expensive. This *must be* called after the interpreter has been created
@@ -758,6 +772,21 @@ class Interpreter {
       int tensor_index, const TfLiteCustomAllocation& allocation,
       int64_t flags = kTfLiteCustomAllocationFlagsNone);
 
+  /// \brief Binds caller-owned memory to the given tensor, like
+  /// SetCustomAllocationForTensor, without requiring AllocateTensors()
+  /// afterwards once the interpreter is invokable.
+  ///
+  /// The allocation is validated when it is bound: an allocation that is too
+  /// small or misaligned is rejected and the previous one is kept. Rebinding
+  /// only swaps the tensor's data pointer and never re-plans the arena, so it
+  /// can be done before every Invoke(), e.g. to feed consecutive windows of a
+  /// ring buffer (pass kTfLiteCustomAllocationFlagsSkipAlignCheck for windows
+  /// that are not aligned to kDefaultTensorAlignment).
+  /// \warning This is an experimental API and subject to change. \n
+  TfLiteStatus BindCustomAllocationForTensor(
+      int tensor_index, const TfLiteCustomAllocation& allocation,
+      int64_t flags = kTfLiteCustomAllocationFlagsNone);
+
   /// \warning This is an experimental API and subject to change. \n
   /// \brief Apply InterpreterOptions which tunes behavior of the interpreter.
   TfLiteStatus ApplyOptions(InterpreterOptions* options);
@@ -18,7 +18,9 @@ limitations under the License.
 
 #include <cstdint>
 #include <functional>
+#include <cstring>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -39,6 +41,12 @@ TfLiteStatus Interpreter::SetCustomAllocationForTensor(
                                                          allocation, flags);
 }
 
+TfLiteStatus Interpreter::BindCustomAllocationForTensor(
+    int tensor_index, const TfLiteCustomAllocation& allocation, int64_t flags) {
+  return primary_subgraph().BindCustomAllocationForTensor(tensor_index,
+                                                          allocation, flags);
+}
+
 TfLiteStatus Interpreter::ReleaseNonPersistentMemory() {
   // TODO(b/138790287): We could do this for all subgraphs whose tensors have
   // been allocated. However, AllocateTensors() relies on Control Flow ops to
@@ -46,6 +54,47 @@ TfLiteStatus Interpreter::ReleaseNonPersistentMemory() {
   return primary_subgraph().ReleaseNonPersistentMemory();
 }
 
+// Memory plans are stored as the number of subgraphs followed by, for each
+// subgraph, the size of its plans and the plans themselves.
+TfLiteStatus Interpreter::SerializeMemoryPlans(std::string* plans) const {
+  if (plans == nullptr) {
+    return kTfLiteError;
+  }
+  plans->clear();
+  const uint32_t num_subgraphs = subgraphs_.size();
+  plans->append(reinterpret_cast<const char*>(&num_subgraphs),
+                sizeof(num_subgraphs));
+  std::string subgraph_plans;
+  for (const auto& subgraph : subgraphs_) {
+    TF_LITE_ENSURE_STATUS(subgraph->SerializeMemoryPlans(&subgraph_plans));
+    const uint64_t size = subgraph_plans.size();
+    plans->append(reinterpret_cast<const char*>(&size), sizeof(size));
+    plans->append(subgraph_plans);
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Interpreter::LoadMemoryPlans(const std::string& plans) {
+  size_t pos = 0;
+  uint32_t num_subgraphs;
+  TF_LITE_ENSURE(context_, plans.size() >= sizeof(num_subgraphs));
+  std::memcpy(&num_subgraphs, plans.data(), sizeof(num_subgraphs));
+  pos += sizeof(num_subgraphs);
+  TF_LITE_ENSURE(context_, num_subgraphs == subgraphs_.size());
+  for (auto& subgraph : subgraphs_) {
+    uint64_t size;
+    TF_LITE_ENSURE(context_, plans.size() - pos >= sizeof(size));
+    std::memcpy(&size, plans.data() + pos, sizeof(size));
+    pos += sizeof(size);
+    TF_LITE_ENSURE(context_, plans.size() - pos >= size);
+    TF_LITE_ENSURE_STATUS(
+        subgraph->LoadMemoryPlans(plans.substr(pos, size)));
+    pos += size;
+  }
+  TF_LITE_ENSURE(context_, pos == plans.size());
+  return kTfLiteOk;
+}
+
 TfLiteStatus Interpreter::ResetVariableTensors() {
   for (auto& subgraph : subgraphs_) {
     TF_LITE_ENSURE_STATUS(subgraph->ResetVariableTensors());
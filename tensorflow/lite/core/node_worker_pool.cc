@@ -0,0 +1,91 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/node_worker_pool.h"
+
+#include <functional>
+#include <mutex>  // NOLINT(build/c++11)
+#include <thread>  // NOLINT(build/c++11)
+
+namespace tflite {
+namespace internal {
+
+NodeWorkerPool::NodeWorkerPool(int num_threads) {
+  for (int i = 1; i < num_threads; ++i) {
+    workers_.emplace_back([this, i] { WorkerLoop(i); });
+  }
+}
+
+NodeWorkerPool::~NodeWorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutdown_ = true;
+  }
+  work_available_.notify_all();
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+void NodeWorkerPool::ParallelFor(int num_tasks,
+                                 const std::function<void(int, int)>& task) {
+  if (num_tasks <= 0) return;
+  if (num_tasks == 1 || workers_.empty()) {
+    for (int i = 0; i < num_tasks; ++i) task(i, /*thread_index=*/0);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = &task;
+    num_tasks_ = num_tasks;
+    next_task_.store(0, std::memory_order_relaxed);
+    active_workers_ = static_cast<int>(workers_.size());
+    ++generation_;
+  }
+  work_available_.notify_all();
+  RunTasks(/*thread_index=*/0);
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  work_done_.wait(lock, [this] { return active_workers_ == 0; });
+  task_ = nullptr;
+}
+
+void NodeWorkerPool::WorkerLoop(int thread_index) {
+  int64_t seen_generation = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_available_.wait(lock, [this, seen_generation] {
+        return shutdown_ || generation_ != seen_generation;
+      });
+      if (shutdown_) return;
+      seen_generation = generation_;
+    }
+    RunTasks(thread_index);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--active_workers_ == 0) work_done_.notify_one();
+    }
+  }
+}
+
+void NodeWorkerPool::RunTasks(int thread_index) {
+  for (int i = next_task_.fetch_add(1, std::memory_order_relaxed);
+       i < num_tasks_; i = next_task_.fetch_add(1, std::memory_order_relaxed)) {
+    (*task_)(i, thread_index);
+  }
+}
+
+}  // namespace internal
+}  // namespace tflite
@@ -0,0 +1,57 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/core/node_worker_pool.h"
+
+#include <atomic>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace internal {
+namespace {
+
+TEST(NodeWorkerPoolTest, RunsEveryTaskOnce) {
+  NodeWorkerPool pool(/*num_threads=*/4);
+  EXPECT_EQ(pool.num_threads(), 4);
+  for (int num_tasks : {0, 1, 3, 100}) {
+    std::vector<std::atomic<int>> runs(num_tasks);
+    std::atomic<bool> bad_thread_index{false};
+    pool.ParallelFor(num_tasks, [&](int task_index, int thread_index) {
+      if (thread_index < 0 || thread_index >= pool.num_threads()) {
+        bad_thread_index = true;
+      }
+      ++runs[task_index];
+    });
+    for (int i = 0; i < num_tasks; ++i) {
+      EXPECT_EQ(runs[i], 1) << "task " << i << " of " << num_tasks;
+    }
+    EXPECT_FALSE(bad_thread_index);
+  }
+}
+
+TEST(NodeWorkerPoolTest, RunsOnCallingThreadWithoutWorkers) {
+  NodeWorkerPool pool(/*num_threads=*/1);
+  int sum = 0;
+  pool.ParallelFor(10, [&sum](int task_index, int thread_index) {
+    EXPECT_EQ(thread_index, 0);
+    sum += task_index;
+  });
+  EXPECT_EQ(sum, 45);
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace tflite
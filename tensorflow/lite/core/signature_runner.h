@@ -207,6 +207,26 @@ class SignatureRunner {
       const char* output_name, const TfLiteCustomAllocation& allocation,
       int64_t flags = kTfLiteCustomAllocationFlagsNone);
 
+  /// \brief Binds caller-owned memory to the given input for the following
+  /// invocations. Unlike SetCustomAllocationForInputTensor, no
+  /// AllocateTensors() call is needed once the runner is invokable: the
+  /// allocation is validated when it is bound (an invalid one is rejected and
+  /// the previous binding kept) and rebinding only swaps the data pointer.
+  /// This makes it suitable for binding a new buffer, or the next window of a
+  /// ring buffer, before every Invoke(). Windows that are not aligned to
+  /// kDefaultTensorAlignment need kTfLiteCustomAllocationFlagsSkipAlignCheck.
+  /// \warning This is an experimental API and subject to change. \n
+  TfLiteStatus BindInputBuffer(
+      const char* input_name, const TfLiteCustomAllocation& allocation,
+      int64_t flags = kTfLiteCustomAllocationFlagsNone);
+
+  /// \brief Binds caller-owned memory to the given output for the following
+  /// invocations. See BindInputBuffer.
+  /// \warning This is an experimental API and subject to change. \n
+  TfLiteStatus BindOutputBuffer(
+      const char* output_name, const TfLiteCustomAllocation& allocation,
+      int64_t flags = kTfLiteCustomAllocationFlagsNone);
+
   /// \brief Set if buffer handle output is allowed.
   ///
   /// When using hardware delegation, Interpreter will make the data of output
@@ -80,6 +80,29 @@ struct TfLiteSparsityDeleter {
 using ScopedTfLiteSparsity =
     std::unique_ptr<TfLiteSparsity, TfLiteSparsityDeleter>;
 
+// Returns a deep copy of `quantization`, to be owned by another tensor.
+TfLiteQuantization CopyQuantization(const TfLiteQuantization& quantization) {
+  TfLiteQuantization copy = {kTfLiteNoQuantization, nullptr};
+  if (quantization.type != kTfLiteAffineQuantization ||
+      quantization.params == nullptr) {
+    return copy;
+  }
+  const auto* params =
+      static_cast<const TfLiteAffineQuantization*>(quantization.params);
+  auto* copy_params = static_cast<TfLiteAffineQuantization*>(
+      malloc(sizeof(TfLiteAffineQuantization)));
+  copy_params->scale = TfLiteFloatArrayCopy(params->scale);
+  copy_params->zero_point = TfLiteIntArrayCopy(params->zero_point);
+  copy_params->quantized_dimension = params->quantized_dimension;
+  copy.type = kTfLiteAffineQuantization;
+  copy.params = copy_params;
+  return copy;
+}
+
+// CPU backend context of the worker thread running a concurrent node, if any.
+// CPU backend contexts aren't thread-safe, so each worker has its own.
+thread_local TfLiteExternalContext* worker_cpu_backend_context = nullptr;
+
 TfLiteStatus ReportOpError(TfLiteContext* context, const TfLiteNode& node,
                            const TfLiteRegistration& registration,
                            int node_index, const char* message) {
@@ -244,6 +267,14 @@ class InterpreterInfo : public GraphInfo {
     return subgraph_->variables();
   }
 
+  size_t first_concurrent_node(size_t index) const override {
+    return subgraph_->FirstConcurrentNode(index);
+  }
+
+  size_t last_concurrent_node(size_t index) const override {
+    return subgraph_->LastConcurrentNode(index);
+  }
+
  public:
   Subgraph* subgraph_;
 };
@@ -567,6 +598,7 @@ TfLiteStatus Subgraph::ReplaceNodeSubsetsWithDelegateKernels(
                   GetDelegateKernalName(registration), node_subsets.size());
 
   execution_plan_.clear();
+  ResetConcurrentNodeGroups();
 
   for (auto& node_subset : node_subsets) {
     // Subsets claimed by the delegate should have a "macro" op created, the
@@ -618,6 +650,10 @@ TfLiteStatus Subgraph::ReplaceNodeSubsetsWithDelegateKernels(
 
 TfLiteExternalContext* Subgraph::GetExternalContext(
     TfLiteExternalContextType type) {
+  if (type == kTfLiteCpuBackendContext &&
+      worker_cpu_backend_context != nullptr) {
+    return worker_cpu_backend_context;
+  }
   if (static_cast<int>(type) >= 0 && type < kTfLiteMaxExternalContexts) {
     return external_contexts_[type];
   }
@@ -1003,6 +1039,8 @@ TfLiteStatus Subgraph::AllocateTensors() {
   // Profile "AllocateTensors" only when memory planning is needed.
   TFLITE_SCOPED_TAGGED_DEFAULT_PROFILE(profiler_.get(), "AllocateTensors");
 
+  // The stages are planned again below from the original tensors.
+  ResetPipelineStages();
   next_execution_plan_index_to_prepare_ = 0;
   next_execution_plan_index_to_plan_allocation_ = 0;
   next_original_execution_plan_index_to_prepare_ = 0;
@@ -1013,6 +1051,7 @@ TfLiteStatus Subgraph::AllocateTensors() {
   TF_LITE_ENSURE_STATUS(PrepareOpsAndTensors());
 
   state_ = kStateInvokable;
+  TF_LITE_ENSURE_STATUS(PlanPipelineStages());
 
   // Reset the variable tensors to zero after (re)allocating the tensors.
   // Developers shouldn't rely on the side effect of this function to reset
@@ -1136,6 +1175,7 @@ TfLiteStatus Subgraph::AddNodeWithParameters(
   // Copying of registration is required to support unresolved custom ops.
   node_and_reg.second = *registration;
   execution_plan_.push_back(new_node_index);
+  ResetConcurrentNodeGroups();
   return kTfLiteOk;
 }
 
@@ -1245,12 +1285,35 @@ TfLiteStatus Subgraph::ResizeInputTensorStrict(int tensor_index,
 
 TfLiteStatus Subgraph::ReleaseNonPersistentMemory() {
   state_ = kStateUninvokable;
+  ResetNodeVersions();
   if (memory_planner_) {
     TF_LITE_ENSURE_STATUS(memory_planner_->ReleaseNonPersistentMemory());
   }
   return kTfLiteOk;
 }
 
+TfLiteStatus Subgraph::SerializeMemoryPlans(std::string* plans) const {
+  if (plans == nullptr) {
+    return kTfLiteError;
+  }
+  plans->clear();
+  if (!memory_planner_) {
+    return kTfLiteOk;
+  }
+  return memory_planner_->SerializePlans(plans);
+}
+
+TfLiteStatus Subgraph::LoadMemoryPlans(const std::string& plans) {
+  if (plans.empty()) {
+    return kTfLiteOk;
+  }
+  if (!memory_planner_) {
+    pending_memory_plans_ = plans;
+    return kTfLiteOk;
+  }
+  return memory_planner_->LoadPlans(plans);
+}
+
 TfLiteStatus Subgraph::ReleaseMemory() {
   state_ = kStateUninvokable;
   ReleaseNonPersistentMemory();
@@ -1528,6 +1591,9 @@ TfLiteStatus Subgraph::PrepareOpsStartingAt(
 }
 
 TfLiteStatus Subgraph::PrepareOpsAndTensors() {
+  // Preparing may resize and reallocate tensors, invalidating node outputs.
+  ResetNodeVersions();
+
   // Prepare original execution plan if any applied delegate wants it.
   // If any of the delegates is immutable, this won't be triggered
   // post-delegation (since we undo/redo delegation). For all other cases, other
@@ -1557,15 +1623,36 @@ TfLiteStatus Subgraph::PrepareOpsAndTensors() {
                            execution_plan_, &last_exec_plan_index_prepared));
   next_execution_plan_index_to_prepare_ = last_exec_plan_index_prepared + 1;
 
+  // Group independent nodes once the whole plan is prepared, before any of
+  // its tensors are allocated.
+  if (ShouldRunNodesConcurrently() && concurrent_group_first_.empty() &&
+      next_execution_plan_index_to_plan_allocation_ == 0) {
+    PlanConcurrentNodeGroups();
+    if (!concurrent_group_first_.empty() && memory_planner_) {
+      TF_LITE_ENSURE_STATUS(memory_planner_->PlanAllocations());
+    }
+  }
+
   if (!memory_planner_) {
 #ifdef TFLITE_USE_SIMPLE_MEMORY_PLANNER
     memory_planner_.reset(new SimplePlanner(&context_, CreateGraphInfo()));
 #else
     memory_planner_ = std::make_unique<ArenaPlanner>(
-        &context_, CreateGraphInfo(), ShouldPreserveAllTensors(),
+        &context_, CreateGraphInfo(),
+        ShouldPreserveAllTensors() || ShouldSkipUnchangedNodes() ||
+            !pipeline_stage_first_.empty(),
         kDefaultTensorAlignment, subgraph_index_);
 #endif
     memory_planner_->PlanAllocations();
+    if (!pending_memory_plans_.empty()) {
+      // Plans that can't be loaded only cost the planning they would have
+      // saved, so they don't fail the allocation.
+      if (memory_planner_->LoadPlans(pending_memory_plans_) != kTfLiteOk) {
+        TFLITE_LOG(tflite::TFLITE_LOG_WARNING,
+                   "Ignoring invalid memory plans.");
+      }
+      pending_memory_plans_.clear();
+    }
   }
 
   // Execute arena allocations.
@@ -1642,6 +1729,28 @@ TfLiteStatus Subgraph::InvokeImpl() {
       tflite::OnTfLiteSubgraphInvoke(name_.c_str(), subgraph_index_);
 #endif  // TF_LITE_TENSORFLOW_PROFILER
 
+  if (!pipeline_stage_first_.empty()) {
+    status = InvokePipelineStages();
+#ifdef TF_LITE_TENSORFLOW_PROFILER
+    tflite::OnTfLiteSubgraphInvokeEnd(trace_subgraph);
+#endif  // TF_LITE_TENSORFLOW_PROFILER
+    return status;
+  }
+
+  const bool skip_unchanged_nodes = ShouldSkipUnchangedNodes();
+  if (!concurrent_group_first_.empty() && !profiler_ &&
+      !has_dynamic_tensors_ && !skip_unchanged_nodes &&
+      next_execution_plan_index_to_prepare_ == execution_plan_.size()) {
+    status = InvokeConcurrentNodeGroups();
+#ifdef TF_LITE_TENSORFLOW_PROFILER
+    tflite::OnTfLiteSubgraphInvokeEnd(trace_subgraph);
+#endif  // TF_LITE_TENSORFLOW_PROFILER
+    return status;
+  }
+  if (skip_unchanged_nodes) {
+    UpdateInputTensorVersions();
+  }
+
   // Invocations are always done in node order.
   // Note that calling Invoke repeatedly will cause the original memory plan to
   // be reused, unless either ResizeInputTensor() or AllocateTensors() has been
@@ -1654,6 +1763,9 @@ TfLiteStatus Subgraph::InvokeImpl() {
                                     execution_plan_index);
     }
     int node_index = execution_plan_[execution_plan_index];
+    if (skip_unchanged_nodes && IsNodeUnchanged(node_index)) {
+      continue;
+    }
     TfLiteNode& node = nodes_and_registration_[node_index].first;
     const TfLiteRegistration& registration =
         nodes_and_registration_[node_index].second;
@@ -1730,6 +1842,9 @@ TfLiteStatus Subgraph::InvokeImpl() {
                                "failed to invoke");
       return s == kTfLiteCancelled ? s : err;
     }
+    if (skip_unchanged_nodes) {
+      RecordNodeInvoked(node_index);
+    }
 
     // Force execution prep for downstream ops if the latest op triggered the
     // resize of a dynamic tensor.
@@ -1763,6 +1878,553 @@ TfLiteStatus Subgraph::InvokeImpl() {
   return status;
 }
 
+bool Subgraph::MustRunNodeSerially(
+    const TfLiteNode& node, const TfLiteRegistration& registration) const {
+  // Delegate kernels, custom ops and ops calling into other subgraphs may
+  // share state with other nodes that isn't visible through their tensors.
+  if (node.delegate != nullptr || node.might_have_side_effect ||
+      registration.builtin_code == kTfLiteBuiltinCustom ||
+      registration.builtin_code == kTfLiteBuiltinStablehloWhile ||
+      registration.builtin_code == kTfLiteBuiltinStablehloComposite) {
+    return true;
+  }
+  // Variable tensors are updated in place, and variants may alias.
+  for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+    if (tensor_index == kTfLiteOptionalTensor) continue;
+    const TfLiteTensor& tensor = tensors_[tensor_index];
+    if (tensor.is_variable || tensor.type == kTfLiteVariant) return true;
+  }
+  for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+    if (tensor_index == kTfLiteOptionalTensor) continue;
+    if (tensors_[tensor_index].type == kTfLiteVariant) return true;
+  }
+  return false;
+}
+
+void Subgraph::UpdateInputTensorVersions() {
+  ++invocation_version_;
+  tensor_versions_.resize(tensors_.size());
+  node_versions_.resize(nodes_and_registration_.size());
+  input_snapshots_.resize(inputs_.size());
+  for (size_t i = 0; i < inputs_.size(); ++i) {
+    const int tensor_index = inputs_[i];
+    if (tensor_index == kTfLiteOptionalTensor) continue;
+    const TfLiteTensor& tensor = tensors_[tensor_index];
+    const size_t bytes = tensor.data.raw != nullptr ? tensor.bytes : 0;
+    std::vector<char>& snapshot = input_snapshots_[i];
+    if (snapshot.size() == bytes &&
+        (bytes == 0 || std::memcmp(snapshot.data(), tensor.data.raw, bytes) ==
+                           0)) {
+      continue;
+    }
+    snapshot.assign(tensor.data.raw, tensor.data.raw + bytes);
+    tensor_versions_[tensor_index] = invocation_version_;
+  }
+}
+
+bool Subgraph::IsNodeUnchanged(int node_index) const {
+  const uint64_t node_version = node_versions_[node_index];
+  if (node_version == 0) return false;
+  const TfLiteNode& node = nodes_and_registration_[node_index].first;
+  for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+    if (tensor_index == kTfLiteOptionalTensor) continue;
+    if (tensor_versions_[tensor_index] > node_version) return false;
+  }
+  return true;
+}
+
+void Subgraph::RecordNodeInvoked(int node_index) {
+  const TfLiteNode& node = nodes_and_registration_[node_index].first;
+  const TfLiteRegistration& registration =
+      nodes_and_registration_[node_index].second;
+  for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+    if (tensor_index == kTfLiteOptionalTensor) continue;
+    tensor_versions_[tensor_index] = invocation_version_;
+  }
+  // Nodes whose outputs don't only depend on their inputs must run every time,
+  // so they are never recorded as having run.
+  if (MustRunNodeSerially(node, registration)) return;
+  switch (registration.builtin_code) {
+    case kTfLiteBuiltinMultinomial:
+    case kTfLiteBuiltinRandomStandardNormal:
+    case kTfLiteBuiltinRandomUniform:
+    case kTfLiteBuiltinStablehloRngBitGenerator:
+      return;
+    default:
+      break;
+  }
+  for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+    if (tensor_index == kTfLiteOptionalTensor) continue;
+    if (tensors_[tensor_index].is_variable) return;
+  }
+  node_versions_[node_index] = invocation_version_;
+}
+
+void Subgraph::ResetNodeVersions() {
+  node_versions_.assign(nodes_and_registration_.size(), 0);
+  tensor_versions_.resize(tensors_.size());
+}
+
+TfLiteStatus Subgraph::PlanPipelineStages() {
+  if (!ShouldPipelinePartitions() || !pipeline_stage_first_.empty() ||
+      has_dynamic_tensors_ || ShouldReleaseDynamicTensors() ||
+      next_execution_plan_index_to_prepare_ != execution_plan_.size()) {
+    return kTfLiteOk;
+  }
+  const int num_nodes = execution_plan_.size();
+  if (num_nodes < 2) return kTfLiteOk;
+  auto node_at = [this](int plan_index) -> TfLiteNode& {
+    return nodes_and_registration_[execution_plan_[plan_index]].first;
+  };
+  // Stages of other invocations would see the side effects out of order.
+  for (int i = 0; i < num_nodes; ++i) {
+    if (node_at(i).might_have_side_effect) return kTfLiteOk;
+  }
+
+  // The nodes reading each tensor, as (execution-plan index, input position),
+  // and the one writing it. Subgraph inputs are written before the first node
+  // and outputs read after the last one, at index `num_nodes`.
+  constexpr int kNotWritten = -2;
+  constexpr int kSubgraphInput = -1;
+  std::vector<int> writers(tensors_.size(), kNotWritten);
+  std::vector<std::vector<std::pair<int, int>>> readers(tensors_.size());
+  for (int tensor_index : inputs_) {
+    if (tensor_index != kTfLiteOptionalTensor) {
+      writers[tensor_index] = kSubgraphInput;
+    }
+  }
+  for (int i = 0; i < num_nodes; ++i) {
+    const TfLiteNode& node = node_at(i);
+    for (int j = 0; j < node.inputs->size; ++j) {
+      const int tensor_index = node.inputs->data[j];
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      readers[tensor_index].emplace_back(i, j);
+    }
+    for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+      if (tensor_index != kTfLiteOptionalTensor) writers[tensor_index] = i;
+    }
+  }
+  for (int tensor_index : outputs_) {
+    if (tensor_index != kTfLiteOptionalTensor) {
+      readers[tensor_index].emplace_back(num_nodes, -1);
+    }
+  }
+  // Only the tensors of CPU nodes can be rewired to delay lines: delegate
+  // kernels keep the tensors they were given, and so do the subgraph inputs
+  // and outputs.
+  auto is_rewirable = [&](int plan_index) {
+    return plan_index >= 0 && plan_index < num_nodes &&
+           node_at(plan_index).delegate == nullptr;
+  };
+
+  // A stage starts wherever the delegate changes, unless a tensor passed
+  // between stages can't be delayed; then the stages it spans are merged.
+  std::vector<bool> starts_stage(num_nodes, false);
+  for (int i = 1; i < num_nodes; ++i) {
+    starts_stage[i] = node_at(i).delegate != node_at(i - 1).delegate;
+  }
+  std::vector<int> stages(num_nodes + 1);
+  auto compute_stages = [&]() {
+    stages[0] = 0;
+    for (int i = 1; i < num_nodes; ++i) {
+      stages[i] = stages[i - 1] + (starts_stage[i] ? 1 : 0);
+    }
+    stages[num_nodes] = stages[num_nodes - 1];
+  };
+  auto stage_of = [&](int plan_index) {
+    return plan_index < 0 ? 0 : stages[plan_index];
+  };
+  bool merged = true;
+  while (merged) {
+    merged = false;
+    compute_stages();
+    auto merge = [&](int first, int last) {
+      for (int i = std::max(first, 0) + 1; i <= std::min(last, num_nodes - 1);
+           ++i) {
+        merged |= starts_stage[i];
+        starts_stage[i] = false;
+      }
+    };
+    for (int tensor_index = 0; tensor_index < tensors_.size();
+         ++tensor_index) {
+      const int writer = writers[tensor_index];
+      const TfLiteTensor& tensor = tensors_[tensor_index];
+      // Constants, including those computed when preparing, need no delay.
+      if (writer == kNotWritten ||
+          tensor.allocation_type == kTfLitePersistentRo) {
+        continue;
+      }
+      const int writer_stage = stage_of(writer);
+      int last_reader = -1;
+      int first_fixed_reader = num_nodes + 1;
+      int last_fixed_reader = -1;
+      for (const auto& [reader, position] : readers[tensor_index]) {
+        if (stage_of(reader) != writer_stage) {
+          last_reader = std::max(last_reader, reader);
+        }
+        if (!is_rewirable(reader)) {
+          first_fixed_reader = std::min(first_fixed_reader, reader);
+          last_fixed_reader = std::max(last_fixed_reader, reader);
+        }
+      }
+      if (last_reader < 0) continue;
+      if (tensor.allocation_type != kTfLiteArenaRw &&
+          tensor.allocation_type != kTfLiteCustom) {
+        merge(writer, last_reader);
+      } else if (last_fixed_reader >= 0 &&
+                 stage_of(first_fixed_reader) != stage_of(last_fixed_reader)) {
+        merge(first_fixed_reader, last_fixed_reader);
+      } else if (last_fixed_reader >= 0 && !is_rewirable(writer) &&
+                 stage_of(last_fixed_reader) != writer_stage) {
+        merge(writer, last_fixed_reader);
+      }
+    }
+  }
+  if (stages[num_nodes] == 0) return kTfLiteOk;
+
+  // Give every tensor passed between stages a delay line. Readers get the
+  // copy delayed by the number of stages between them and the writer. If
+  // readers can't be rewired, the tensor itself becomes that copy and the
+  // writer is rewired to the head of the line instead.
+  for (int tensor_index = 0; tensor_index < writers.size(); ++tensor_index) {
+    const int writer = writers[tensor_index];
+    if (writer == kNotWritten ||
+        tensors_[tensor_index].allocation_type == kTfLitePersistentRo) {
+      continue;
+    }
+    const int writer_stage = stage_of(writer);
+    int max_delay = 0;
+    int fixed_delay = 0;
+    for (const auto& [reader, position] : readers[tensor_index]) {
+      const int delay = stage_of(reader) - writer_stage;
+      max_delay = std::max(max_delay, delay);
+      if (!is_rewirable(reader)) fixed_delay = delay;
+    }
+    if (max_delay == 0) continue;
+    PipelineDelayLine line;
+    line.is_input_line = writer == kSubgraphInput;
+    line.tensors.resize(max_delay + 1);
+    for (int delay = 0; delay <= max_delay; ++delay) {
+      if (delay == fixed_delay) {
+        line.tensors[delay] = tensor_index;
+      } else {
+        TF_LITE_ENSURE_STATUS(
+            AddPipelineTensor(tensor_index, &line.tensors[delay]));
+      }
+    }
+    if (fixed_delay > 0) {
+      TfLiteNode& node = node_at(writer);
+      for (int j = 0; j < node.outputs->size; ++j) {
+        if (node.outputs->data[j] != tensor_index) continue;
+        pipeline_rewirings_.push_back(
+            {execution_plan_[writer], /*is_output=*/true, j, tensor_index});
+        node.outputs->data[j] = line.tensors[0];
+      }
+    }
+    for (const auto& [reader, position] : readers[tensor_index]) {
+      const int delay = stage_of(reader) - writer_stage;
+      if (!is_rewirable(reader) || line.tensors[delay] == tensor_index) {
+        continue;
+      }
+      pipeline_rewirings_.push_back(
+          {execution_plan_[reader], /*is_output=*/false, position,
+           tensor_index});
+      node_at(reader).inputs->data[position] = line.tensors[delay];
+    }
+    pipeline_delay_lines_.push_back(std::move(line));
+  }
+  for (int i = 0; i < num_nodes; ++i) {
+    if (i == 0 || starts_stage[i]) pipeline_stage_first_.push_back(i);
+  }
+
+  // Prepare the rewired nodes and allocate all tensors again, without sharing
+  // memory between tensors which are now used concurrently.
+  memory_planner_.reset();
+  next_execution_plan_index_to_prepare_ = 0;
+  next_execution_plan_index_to_plan_allocation_ = 0;
+  next_original_execution_plan_index_to_prepare_ = 0;
+  return PrepareOpsAndTensors();
+}
+
+void Subgraph::ResetPipelineStages() {
+  if (pipeline_stage_first_.empty()) return;
+  for (auto it = pipeline_rewirings_.rbegin(); it != pipeline_rewirings_.rend();
+       ++it) {
+    TfLiteNode& node = nodes_and_registration_[it->node_index].first;
+    (it->is_output ? node.outputs : node.inputs)->data[it->position] =
+        it->tensor_index;
+  }
+  pipeline_rewirings_.clear();
+  pipeline_delay_lines_.clear();
+  pipeline_stage_first_.clear();
+  num_used_pipeline_tensors_ = 0;
+  // The memory plan doesn't account for the original tensors.
+  memory_planner_.reset();
+  state_ = kStateUninvokable;
+}
+
+TfLiteStatus Subgraph::AddPipelineTensor(int tensor_index,
+                                         int* new_tensor_index) {
+  if (num_used_pipeline_tensors_ == pipeline_tensors_.size()) {
+    int added_tensor_index;
+    TF_LITE_ENSURE_STATUS(AddTensors(1, &added_tensor_index));
+    pipeline_tensors_.push_back(added_tensor_index);
+  }
+  *new_tensor_index = pipeline_tensors_[num_used_pipeline_tensors_++];
+  const TfLiteTensor& tensor = tensors_[tensor_index];
+  const std::vector<int> dims(tensor.dims->data,
+                              tensor.dims->data + tensor.dims->size);
+  return SetTensorParametersReadWrite(*new_tensor_index, tensor.type,
+                                      tensor.name, dims,
+                                      CopyQuantization(tensor.quantization));
+}
+
+TfLiteStatus Subgraph::ShiftPipelineDelayLines(bool input_lines) {
+  for (const PipelineDelayLine& line : pipeline_delay_lines_) {
+    if (line.is_input_line != input_lines) continue;
+    for (int i = line.tensors.size() - 1; i > 0; --i) {
+      const int tensor_index = line.tensors[i - 1];
+      if (tensors_[tensor_index].data_is_stale) {
+        TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
+      }
+      const TfLiteTensor& from = tensors_[tensor_index];
+      TfLiteTensor& to = tensors_[line.tensors[i]];
+      TF_LITE_ENSURE_EQ(&context_, from.bytes, to.bytes);
+      if (from.bytes > 0) std::memcpy(to.data.raw, from.data.raw, from.bytes);
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus Subgraph::InvokePipelineStages() {
+  if (check_cancelled_func_ != nullptr &&
+      check_cancelled_func_(cancellation_data_)) {
+    ReportError("Client requested cancel during Invoke()");
+    return kTfLiteError;
+  }
+  if (continue_invocation_ && !continue_invocation_->test_and_set()) {
+    // `Cancel` is called and cancellation flag is flipped.
+    ReportError("Client requested cancel during Invoke()");
+    return kTfLiteCancelled;
+  }
+
+  // Each stage reads the values its predecessors wrote in earlier
+  // invocations, so the stages don't depend on each other.
+  TF_LITE_ENSURE_STATUS(ShiftPipelineDelayLines(/*input_lines=*/false));
+  const int num_stages = pipeline_stage_first_.size();
+  std::vector<TfLiteStatus> statuses(num_stages, kTfLiteOk);
+  auto invoke_stage = [this, num_stages, &statuses](int stage) {
+    const int last = stage + 1 < num_stages ? pipeline_stage_first_[stage + 1]
+                                            : execution_plan_.size();
+    for (int i = pipeline_stage_first_[stage]; i < last; ++i) {
+      statuses[stage] = InvokeConcurrentNode(execution_plan_[i]);
+      if (statuses[stage] != kTfLiteOk) return;
+    }
+  };
+  if (profiler_) {
+    // Profilers aren't thread-safe.
+    for (int stage = 0; stage < num_stages; ++stage) invoke_stage(stage);
+  } else {
+    EnsureNodeWorkerPool(num_stages);
+    node_worker_pool_->ParallelFor(
+        num_stages, [this, &invoke_stage](int stage, int thread_index) {
+          worker_cpu_backend_context =
+              thread_index == 0
+                  ? nullptr
+                  : worker_cpu_backend_contexts_[thread_index - 1].get();
+          invoke_stage(stage);
+          worker_cpu_backend_context = nullptr;
+        });
+  }
+  for (TfLiteStatus status : statuses) {
+    TF_LITE_ENSURE_STATUS(status);
+  }
+  return ShiftPipelineDelayLines(/*input_lines=*/true);
+}
+
+void Subgraph::ResetConcurrentNodeGroups() {
+  concurrent_group_first_.clear();
+  concurrent_group_last_.clear();
+}
+
+void Subgraph::PlanConcurrentNodeGroups() {
+  ResetConcurrentNodeGroups();
+  if (!delegates_applied_.empty() || has_dynamic_tensors_ ||
+      ShouldReleaseDynamicTensors() ||
+      next_execution_plan_index_to_prepare_ != execution_plan_.size()) {
+    return;
+  }
+
+  // Control edges are given between node indices.
+  std::vector<std::vector<int>> control_predecessors;
+  if (control_edges_ != nullptr) {
+    const int num_total_nodes = nodes_and_registration_.size();
+    control_predecessors.resize(num_total_nodes);
+    for (const auto& [from, to] : *control_edges_) {
+      if (from >= 0 && from < num_total_nodes && to >= 0 &&
+          to < num_total_nodes) {
+        control_predecessors[to].push_back(from);
+      }
+    }
+  }
+
+  // Assign each node the lowest level above all the nodes it depends on: the
+  // writers of its inputs, the readers and writers of its outputs and its
+  // control predecessors. Nodes which must run serially get a level of their
+  // own, above all earlier nodes and below all later ones.
+  const int num_nodes = execution_plan_.size();
+  std::vector<int> levels(num_nodes);
+  std::vector<int> node_levels(nodes_and_registration_.size(), -1);
+  std::vector<int> written_levels(tensors_.size(), -1);
+  std::vector<int> used_levels(tensors_.size(), -1);
+  int max_level = -1;
+  int min_level = 0;
+  for (int i = 0; i < num_nodes; ++i) {
+    const int node_index = execution_plan_[i];
+    const TfLiteNode& node = nodes_and_registration_[node_index].first;
+    int level = min_level;
+    if (MustRunNodeSerially(node, nodes_and_registration_[node_index].second)) {
+      level = max_level + 1;
+      min_level = level + 1;
+    } else {
+      for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+        if (tensor_index == kTfLiteOptionalTensor) continue;
+        level = std::max(level, written_levels[tensor_index] + 1);
+      }
+      for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+        if (tensor_index == kTfLiteOptionalTensor) continue;
+        level = std::max(level, used_levels[tensor_index] + 1);
+      }
+      if (!control_predecessors.empty()) {
+        for (int predecessor : control_predecessors[node_index]) {
+          level = std::max(level, node_levels[predecessor] + 1);
+        }
+      }
+    }
+    levels[i] = level;
+    node_levels[node_index] = level;
+    max_level = std::max(max_level, level);
+    for (int tensor_index : TfLiteIntArrayView(node.inputs)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      used_levels[tensor_index] = std::max(used_levels[tensor_index], level);
+    }
+    for (int tensor_index : TfLiteIntArrayView(node.outputs)) {
+      if (tensor_index == kTfLiteOptionalTensor) continue;
+      written_levels[tensor_index] =
+          std::max(written_levels[tensor_index], level);
+      used_levels[tensor_index] = std::max(used_levels[tensor_index], level);
+    }
+  }
+  if (max_level + 1 == num_nodes) {
+    // No two nodes can run concurrently.
+    return;
+  }
+
+  // Ordering nodes by level keeps the plan topologically sorted.
+  std::vector<int> order(num_nodes);
+  for (int i = 0; i < num_nodes; ++i) order[i] = i;
+  std::stable_sort(order.begin(), order.end(),
+                   [&levels](int a, int b) { return levels[a] < levels[b]; });
+  std::vector<int> new_plan(num_nodes);
+  concurrent_group_first_.resize(num_nodes);
+  concurrent_group_last_.resize(num_nodes);
+  for (int first = 0; first < num_nodes;) {
+    int last = first;
+    while (last + 1 < num_nodes &&
+           levels[order[last + 1]] == levels[order[first]]) {
+      ++last;
+    }
+    for (int i = first; i <= last; ++i) {
+      new_plan[i] = execution_plan_[order[i]];
+      concurrent_group_first_[i] = first;
+      concurrent_group_last_[i] = last;
+    }
+    first = last + 1;
+  }
+  execution_plan_ = std::move(new_plan);
+}
+
+TfLiteStatus Subgraph::InvokeConcurrentNode(int node_index) {
+  TfLiteNode& node = nodes_and_registration_[node_index].first;
+  const TfLiteRegistration& registration =
+      nodes_and_registration_[node_index].second;
+  for (int i = 0; i < node.inputs->size; ++i) {
+    const int tensor_index = node.inputs->data[i];
+    if (tensor_index == kTfLiteOptionalTensor) continue;
+    const TfLiteTensor& tensor = tensors_[tensor_index];
+    if (tensor.delegate && tensor.delegate != node.delegate &&
+        tensor.data_is_stale) {
+      TF_LITE_ENSURE_STATUS(EnsureTensorDataIsReadable(tensor_index));
+    }
+    // As in `InvokeImpl`, the shape input of RESHAPE may have no buffer.
+    if (tensor.data.raw == nullptr && tensor.bytes > 0 &&
+        !(registration.builtin_code == kTfLiteBuiltinReshape && i == 1 &&
+          tensor.dims->size != 1)) {
+      ReportError("Input tensor %d lacks data", tensor_index);
+      return kTfLiteError;
+    }
+  }
+  if (auto s = OpInvoke(registration, &node); s != kTfLiteOk) {
+    auto err = ReportOpError(&context_, node, registration, node_index,
+                             "failed to invoke");
+    return s == kTfLiteCancelled ? s : err;
+  }
+  return kTfLiteOk;
+}
+
+void Subgraph::EnsureNodeWorkerPool(int num_threads) {
+  if (node_worker_pool_ != nullptr &&
+      node_worker_pool_->num_threads() == num_threads) {
+    return;
+  }
+  node_worker_pool_ = std::make_unique<internal::NodeWorkerPool>(num_threads);
+  worker_cpu_backend_contexts_.clear();
+  for (int i = 1; i < num_threads; ++i) {
+    worker_cpu_backend_contexts_.push_back(
+        std::make_unique<ExternalCpuBackendContext>());
+  }
+}
+
+TfLiteStatus Subgraph::InvokeConcurrentNodeGroups() {
+  EnsureNodeWorkerPool(options_->GetInterOpNumThreads());
+
+  const int num_nodes = execution_plan_.size();
+  std::vector<TfLiteStatus> statuses;
+  for (int first = 0; first < num_nodes;
+       first = concurrent_group_last_[first] + 1) {
+    if (check_cancelled_func_ != nullptr &&
+        check_cancelled_func_(cancellation_data_)) {
+      ReportError("Client requested cancel during Invoke()");
+      return kTfLiteError;
+    }
+    if (continue_invocation_ && !continue_invocation_->test_and_set()) {
+      // `Cancel` is called and cancellation flag is flipped.
+      ReportError("Client requested cancel during Invoke()");
+      return kTfLiteCancelled;
+    }
+
+    const int num_group_nodes = concurrent_group_last_[first] - first + 1;
+    if (num_group_nodes == 1) {
+      TF_LITE_ENSURE_STATUS(InvokeConcurrentNode(execution_plan_[first]));
+      continue;
+    }
+    statuses.assign(num_group_nodes, kTfLiteOk);
+    node_worker_pool_->ParallelFor(
+        num_group_nodes, [this, first, &statuses](int i, int thread_index) {
+          worker_cpu_backend_context =
+              thread_index == 0
+                  ? nullptr
+                  : worker_cpu_backend_contexts_[thread_index - 1].get();
+          statuses[i] = InvokeConcurrentNode(execution_plan_[first + i]);
+          worker_cpu_backend_context = nullptr;
+        });
+    for (TfLiteStatus status : statuses) {
+      TF_LITE_ENSURE_STATUS(status);
+    }
+  }
+  return kTfLiteOk;
+}
+
 TfLiteStatus Subgraph::ResizeTensor(TfLiteContext* context,
                                     TfLiteTensor* tensor,
                                     TfLiteIntArray* new_size) {
@@ -1999,6 +2661,7 @@ TfLiteStatus Subgraph::SetExecutionPlan(const std::vector<int>& new_plan) {
                                   node_index < nodes_and_registration_.size());
   }
   execution_plan_ = new_plan;
+  ResetConcurrentNodeGroups();
   return kTfLiteOk;
 }
 
@@ -2122,6 +2785,7 @@ TfLiteStatus Subgraph::SwitchToKernelContext() {
 TfLiteStatus Subgraph::UndoAllDelegates() {
   // Return early if there is nothing to reset to.
   if (pre_delegation_execution_plan_.empty()) return kTfLiteOk;
+  ResetPipelineStages();
 
   // First free all delegate nodes.
   for (int execution_plan_index = 0;
@@ -2137,6 +2801,7 @@ TfLiteStatus Subgraph::UndoAllDelegates() {
   // Reset execution plan.
   execution_plan_ = pre_delegation_execution_plan_;
   pre_delegation_execution_plan_.clear();
+  ResetConcurrentNodeGroups();
 
   // Handling FP16 delegation (if applies).
   //
@@ -2272,6 +2937,8 @@ TfLiteStatus Subgraph::ModifyGraphWithDelegateImpl(TfLiteDelegate* delegate) {
     ReportError("Null delegate.");
     return kTfLiteDelegateError;
   }
+  // Delegates must see the original tensors of the nodes.
+  ResetPipelineStages();
 
   // Resets delegation & leaves graph in consistent state if delegate status is
   // not okay.
@@ -2405,6 +3072,21 @@ TfLiteStatus Subgraph::SetCustomAllocationForTensor(
   return kTfLiteOk;
 }
 
+TfLiteStatus Subgraph::BindCustomAllocationForTensor(
+    int tensor_index, const TfLiteCustomAllocation& allocation, int64_t flags) {
+  TF_LITE_ENSURE(context(),
+                 tensor_index >= 0 && tensor_index < context_.tensors_size);
+  // Tensor sizes are final once the subgraph is invokable; before that the
+  // size is checked by AllocateTensors() as for SetCustomAllocationForTensor.
+  if (state_ != kStateUninvokable &&
+      allocation.bytes < context_.tensors[tensor_index].bytes) {
+    ReportError("Custom allocation is too small for tensor idx: %d",
+                tensor_index);
+    return kTfLiteError;
+  }
+  return SetCustomAllocationForTensor(tensor_index, allocation, flags);
+}
+
 void Subgraph::SetName(const char* name) {
   if (name) {
     name_ = name;
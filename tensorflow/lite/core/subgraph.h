@@ -37,8 +37,10 @@ limitations under the License.
 #include "tensorflow/lite/core/api/profiler.h"
 #include "tensorflow/lite/core/c/common.h"
 #include "tensorflow/lite/core/macros.h"
+#include "tensorflow/lite/core/node_worker_pool.h"
 #include "tensorflow/lite/experimental/resource/initialization_status.h"
 #include "tensorflow/lite/experimental/resource/resource_base.h"
+#include "tensorflow/lite/external_cpu_backend_context.h"
 #include "tensorflow/lite/graph_info.h"
 #include "tensorflow/lite/interpreter_options.h"
 #include "tensorflow/lite/memory_planner.h"
@@ -281,6 +283,19 @@ class Subgraph {
   // AllocateTensors needs to be called before next invocation.
   TfLiteStatus ReleaseNonPersistentMemory();
 
+  // WARNING: Experimental interface, subject to change
+  // Serializes the arena plans computed for this subgraph so far. Loading them
+  // with LoadMemoryPlans() in a later process skips recomputing the tensor
+  // offsets on AllocateTensors() as long as tensor sizes match. `plans` is
+  // left empty when no plan was computed yet.
+  TfLiteStatus SerializeMemoryPlans(std::string* plans) const;
+
+  // WARNING: Experimental interface, subject to change
+  // Loads plans produced by SerializeMemoryPlans(). Plans for other tensor
+  // sizes or lifetimes are never used, so a stale cache only costs the time
+  // to parse it.
+  TfLiteStatus LoadMemoryPlans(const std::string& plans);
+
   // WARNING: Experimental interface, subject to change
   // This API releases memory held by the given subgraph. This method is
   // designed to release memory of control flow subgraphs.
@@ -414,6 +429,18 @@ class Subgraph {
       int tensor_index, const TfLiteCustomAllocation& allocation,
       int64_t flags = kTfLiteCustomAllocationFlagsNone);
 
+  // Like SetCustomAllocationForTensor, but once the subgraph is invokable the
+  // allocation is validated right away (including allocation->bytes) and no
+  // AllocateTensors() call is needed afterwards: binding only swaps the
+  // tensor's data pointer, so it is cheap enough to do before every Invoke(),
+  // e.g. to point an input at the next window of a streaming ring buffer. An
+  // invalid allocation is rejected and the previous one stays in place.
+  //
+  // WARNING: This is an experimental interface that is subject to change.
+  TfLiteStatus BindCustomAllocationForTensor(
+      int tensor_index, const TfLiteCustomAllocation& allocation,
+      int64_t flags = kTfLiteCustomAllocationFlagsNone);
+
   void SetName(const char* name);
   const std::string& GetName() const;
 
@@ -495,6 +522,58 @@ class Subgraph {
     return (options_ && options_->GetDisableDelegateClustering());
   }
 
+  // WARNING: This is an experimental API and subject to change.
+  // True if independent nodes should run concurrently, see
+  // `InterpreterOptions::SetInterOpNumThreads`.
+  bool ShouldRunNodesConcurrently() const {
+    return (options_ && options_->GetInterOpNumThreads() > 1);
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // True if nodes whose inputs didn't change since they last ran are skipped,
+  // see `InterpreterOptions::SetSkipUnchangedNodes`.
+  bool ShouldSkipUnchangedNodes() const {
+#ifdef TFLITE_USE_SIMPLE_MEMORY_PLANNER
+    // The simple planner always frees intermediate tensors after use.
+    return false;
+#else
+    return (options_ && options_->GetSkipUnchangedNodes() &&
+            !ShouldReleaseDynamicTensors());
+#endif
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // True if the partitions of consecutive invocations should run concurrently,
+  // see `InterpreterOptions::SetPipelinePartitions`.
+  bool ShouldPipelinePartitions() const {
+    return (options_ && options_->GetPipelinePartitions() &&
+            subgraph_index_ == 0);
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // Returns the number of pipeline stages the execution plan runs in, which is
+  // 1 unless partitions are pipelined. After `Invoke`, the outputs are those
+  // of the inputs given `num_pipeline_stages() - 1` invocations earlier.
+  int num_pipeline_stages() const {
+    return pipeline_stage_first_.empty()
+               ? 1
+               : static_cast<int>(pipeline_stage_first_.size());
+  }
+
+  // WARNING: This is an experimental API and subject to change.
+  // Returns the execution-plan index of the first (resp. last) node of the
+  // group of nodes that may run concurrently with the node at execution-plan
+  // index `index`. Both are `index` unless nodes run concurrently.
+  size_t FirstConcurrentNode(size_t index) const {
+    return index < concurrent_group_first_.size()
+               ? concurrent_group_first_[index]
+               : index;
+  }
+  size_t LastConcurrentNode(size_t index) const {
+    return index < concurrent_group_last_.size() ? concurrent_group_last_[index]
+                                                 : index;
+  }
+
   // Retrieves the corresponding TfLiteContext of a subgraph given a subgraph
   // index and switches to the delegate context for this subgraph. If an invalid
   // subgraph index is given, returns kTfLiteError.
@@ -939,6 +1018,67 @@ class Subgraph {
   // last operation that uses the tensor as input.
   void InitializeTensorReleaseMap();
 
+  // Reorders the execution plan into the levels of its dependency graph, so
+  // that the nodes of each level, which don't depend on each other, are
+  // adjacent and may run concurrently. Does nothing unless all nodes are
+  // prepared and the subgraph has no delegates or dynamic tensors.
+  void PlanConcurrentNodeGroups();
+
+  // Forgets the groups found by `PlanConcurrentNodeGroups`; called whenever
+  // the execution plan changes.
+  void ResetConcurrentNodeGroups();
+
+  // True if the node must not run concurrently with any other node, e.g.
+  // because it has side effects not expressed by its tensors.
+  bool MustRunNodeSerially(const TfLiteNode& node,
+                           const TfLiteRegistration& registration) const;
+
+  // Invokes the execution plan one group of concurrent nodes at a time.
+  TfLiteStatus InvokeConcurrentNodeGroups();
+
+  // Invokes a single node as part of a group of concurrent nodes.
+  TfLiteStatus InvokeConcurrentNode(int node_index);
+
+  // Bumps the versions of the subgraph inputs whose contents changed since
+  // the previous invocation, at the start of an invocation that skips
+  // unchanged nodes.
+  void UpdateInputTensorVersions();
+
+  // True if the node at `node_index` ran before and none of its inputs changed
+  // since, so that its outputs still hold what it would compute.
+  bool IsNodeUnchanged(int node_index) const;
+
+  // Records that the node at `node_index` ran in the current invocation.
+  void RecordNodeInvoked(int node_index);
+
+  // Forgets which nodes ran; called whenever tensor memory may be reallocated.
+  void ResetNodeVersions();
+
+  // Splits the prepared execution plan into pipeline stages, rewires the
+  // tensors passed between stages to delay lines and prepares the plan again.
+  // Does nothing unless partitions should be pipelined and the subgraph can
+  // be split into several stages.
+  TfLiteStatus PlanPipelineStages();
+
+  // Restores the tensors of the nodes rewired by `PlanPipelineStages`; called
+  // before the execution plan or the tensors are planned again.
+  void ResetPipelineStages();
+
+  // Returns a new tensor with the type, shape and quantization of the tensor
+  // at `tensor_index`, reusing those created for earlier pipeline plans.
+  TfLiteStatus AddPipelineTensor(int tensor_index, int* new_tensor_index);
+
+  // Runs all pipeline stages once, concurrently unless profiling.
+  TfLiteStatus InvokePipelineStages();
+
+  // Moves the values in the delay lines one step further, either those of
+  // the subgraph inputs, after the stages ran, or the others, before.
+  TfLiteStatus ShiftPipelineDelayLines(bool input_lines);
+
+  // Creates the threads running concurrent nodes if there aren't
+  // `num_threads` already, with a CPU backend context for each but the first.
+  void EnsureNodeWorkerPool(int num_threads);
+
   // May allocate dynamic tensor memory of node outputs. It's used when
   // `EnsureDynamicTensorsAreReleased` or`UseDynamicAllocationForLargeTensors`
   // API is used.
@@ -1088,6 +1228,9 @@ class Subgraph {
 
   std::unique_ptr<MemoryPlanner> memory_planner_;
 
+  // Plans passed to LoadMemoryPlans() before `memory_planner_` was created.
+  std::string pending_memory_plans_;
+
   // Maps tensor index to custom allocation for all applicable tensors.
   std::map<int, TfLiteCustomAllocation> custom_allocations_;
 
@@ -1157,6 +1300,51 @@ class Subgraph {
   // `InterpreterOptions` object which is being used and owned by Interpreter.
   InterpreterOptions* options_;
 
+  // For each execution-plan index, the first and last execution-plan index of
+  // its group of concurrent nodes. Empty unless nodes run concurrently.
+  std::vector<int> concurrent_group_first_;
+  std::vector<int> concurrent_group_last_;
+
+  // Threads running groups of concurrent nodes, and the CPU backend context
+  // used by each of them but the calling thread. Created on first use.
+  std::unique_ptr<internal::NodeWorkerPool> node_worker_pool_;
+  std::vector<std::unique_ptr<ExternalCpuBackendContext>>
+      worker_cpu_backend_contexts_;
+
+  // Used to skip unchanged nodes, see `ShouldSkipUnchangedNodes()`. Versions
+  // are invocation counts: each tensor has the version of the invocation which
+  // last changed it and each node that of the invocation which last ran it, or
+  // 0 if it didn't run since the last `ResetNodeVersions()`.
+  uint64_t invocation_version_ = 0;
+  std::vector<uint64_t> tensor_versions_;
+  std::vector<uint64_t> node_versions_;
+  // The contents of `inputs_` at the start of the previous invocation.
+  std::vector<std::vector<char>> input_snapshots_;
+
+  // Pipelined execution, see `ShouldPipelinePartitions()`: the execution-plan
+  // index of the first node of each stage, empty unless pipelined.
+  std::vector<int> pipeline_stage_first_;
+  // A tensor passed between stages and its delayed copies: `tensors[i]` holds
+  // the value the first one had `i` invocations earlier.
+  struct PipelineDelayLine {
+    std::vector<int> tensors;
+    // Lines of subgraph inputs shift after the stages run, others before.
+    bool is_input_line;
+  };
+  std::vector<PipelineDelayLine> pipeline_delay_lines_;
+  // The node input or output (at `position`) rewired to a delay line, and the
+  // tensor it had.
+  struct PipelineRewiring {
+    int node_index;
+    bool is_output;
+    int position;
+    int tensor_index;
+  };
+  std::vector<PipelineRewiring> pipeline_rewirings_;
+  // The tensors added for delay lines, and how many the current plan uses.
+  std::vector<int> pipeline_tensors_;
+  size_t num_used_pipeline_tensors_ = 0;
+
   // Control edges (i.e., dependencies between nodes in addition to their data
   // dependencies); can be nullptr. Will be initialized from metadata associated
   // with the owning interpreter; the pointee is owned by the owning
@@ -25,8 +25,10 @@ limitations under the License.
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include "absl/log/check.h"
+#include "tensorflow/lite/builtin_ops.h"
 #include "tensorflow/lite/c/c_api_types.h"
 #include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/interpreter_options.h"
 #include "tensorflow/lite/stderr_reporter.h"
 #include "tensorflow/lite/util.h"
 
@@ -332,5 +334,255 @@ TEST_F(SubgraphResizeTensorTest,
   std::fill_n(tensor_.dims->data, tensor_.dims->size, 1);
 }
 
+TEST(ConcurrentNodeGroups, RunsIndependentNodesInTheSameGroup) {
+  Interpreter interpreter;
+  InterpreterOptions options;
+  options.SetInterOpNumThreads(2);
+  ASSERT_EQ(interpreter.ApplyOptions(&options), kTfLiteOk);
+  auto& subgraph = interpreter.primary_subgraph();
+  subgraph.AddTensors(6);
+  for (int i = 0; i < 6; ++i) {
+    ASSERT_EQ(subgraph.SetTensorParametersReadWrite(
+                  i, kTfLiteFloat32, "", {4}, TfLiteQuantization()),
+              kTfLiteOk);
+  }
+  subgraph.SetInputs({0, 1});
+  subgraph.SetOutputs({4, 5});
+  // Two independent chains of two nodes each, added one chain after the other.
+  TfLiteRegistration* neg_op = tflite::ops::builtin::Register_NEG();
+  subgraph.AddNodeWithParameters({0}, {2}, {}, nullptr, 0, nullptr, neg_op);
+  subgraph.AddNodeWithParameters({2}, {4}, {}, nullptr, 0, nullptr, neg_op);
+  subgraph.AddNodeWithParameters({1}, {3}, {}, nullptr, 0, nullptr, neg_op);
+  subgraph.AddNodeWithParameters({3}, {5}, {}, nullptr, 0, nullptr, neg_op);
+  ASSERT_EQ(subgraph.AllocateTensors(), kTfLiteOk);
+
+  // The first nodes of both chains form a group, as do the second nodes.
+  EXPECT_THAT(subgraph.execution_plan(), ElementsAreArray({0, 2, 1, 3}));
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(subgraph.FirstConcurrentNode(i), i < 2 ? 0 : 2);
+    EXPECT_EQ(subgraph.LastConcurrentNode(i), i < 2 ? 1 : 3);
+  }
+  // Tensors used by the same group must not share memory.
+  EXPECT_NE(subgraph.tensor(2)->data.raw, subgraph.tensor(3)->data.raw);
+
+  for (int i = 0; i < 4; ++i) {
+    subgraph.tensor(0)->data.f[i] = i;
+    subgraph.tensor(1)->data.f[i] = 10 * i;
+  }
+  ASSERT_EQ(subgraph.Invoke(), kTfLiteOk);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(subgraph.tensor(4)->data.f[i], i);
+    EXPECT_EQ(subgraph.tensor(5)->data.f[i], 10 * i);
+  }
+}
+
+TEST(ConcurrentNodeGroups, KeepsSequentialPlanByDefault) {
+  Interpreter interpreter;
+  auto& subgraph = interpreter.primary_subgraph();
+  subgraph.AddTensors(4);
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_EQ(subgraph.SetTensorParametersReadWrite(
+                  i, kTfLiteFloat32, "", {4}, TfLiteQuantization()),
+              kTfLiteOk);
+  }
+  subgraph.SetInputs({0, 1});
+  subgraph.SetOutputs({2, 3});
+  TfLiteRegistration* neg_op = tflite::ops::builtin::Register_NEG();
+  subgraph.AddNodeWithParameters({0}, {2}, {}, nullptr, 0, nullptr, neg_op);
+  subgraph.AddNodeWithParameters({1}, {3}, {}, nullptr, 0, nullptr, neg_op);
+  ASSERT_EQ(subgraph.AllocateTensors(), kTfLiteOk);
+
+  EXPECT_THAT(subgraph.execution_plan(), ElementsAreArray({0, 1}));
+  EXPECT_EQ(subgraph.FirstConcurrentNode(1), 1);
+  EXPECT_EQ(subgraph.LastConcurrentNode(0), 0);
+}
+
+// A NEG op counting its invocations in `user_data`.
+TfLiteRegistration CountingNegRegistration() {
+  TfLiteRegistration registration = {};
+  registration.builtin_code = kTfLiteBuiltinNeg;
+  registration.init = [](TfLiteContext*, const char* buffer,
+                         size_t) -> void* {
+    return const_cast<char*>(buffer);
+  };
+  registration.prepare = [](TfLiteContext* context, TfLiteNode* node) {
+    const TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    return context->ResizeTensor(context, output,
+                                 TfLiteIntArrayCopy(input->dims));
+  };
+  registration.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+    ++*static_cast<int*>(node->user_data);
+    const TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+    TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+    for (int i = 0; i < input->bytes / sizeof(float); ++i) {
+      output->data.f[i] = -input->data.f[i];
+    }
+    return kTfLiteOk;
+  };
+  return registration;
+}
+
+TEST(SkipUnchangedNodes, SkipsNodesWithUnchangedInputs) {
+  Interpreter interpreter;
+  InterpreterOptions options;
+  options.SetSkipUnchangedNodes(true);
+  ASSERT_EQ(interpreter.ApplyOptions(&options), kTfLiteOk);
+  auto& subgraph = interpreter.primary_subgraph();
+  subgraph.AddTensors(5);
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_EQ(subgraph.SetTensorParametersReadWrite(
+                  i, kTfLiteFloat32, "", {4}, TfLiteQuantization()),
+              kTfLiteOk);
+  }
+  // A streaming input 0 and a static input 1 feeding a chain of two nodes.
+  subgraph.SetInputs({0, 1});
+  subgraph.SetOutputs({2, 4});
+  TfLiteRegistration neg_op = CountingNegRegistration();
+  int counts[3] = {0, 0, 0};
+  const std::vector<std::vector<int>> node_tensors = {{0, 2}, {1, 3}, {3, 4}};
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(subgraph.AddNodeWithParameters(
+                  {node_tensors[i][0]}, {node_tensors[i][1]}, {},
+                  reinterpret_cast<char*>(&counts[i]), 0, nullptr, &neg_op),
+              kTfLiteOk);
+  }
+  ASSERT_EQ(subgraph.AllocateTensors(), kTfLiteOk);
+
+  for (int i = 0; i < 4; ++i) subgraph.tensor(1)->data.f[i] = i;
+  for (int step = 0; step < 3; ++step) {
+    for (int i = 0; i < 4; ++i) subgraph.tensor(0)->data.f[i] = step;
+    ASSERT_EQ(subgraph.Invoke(), kTfLiteOk);
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_EQ(subgraph.tensor(2)->data.f[i], -step);
+      EXPECT_EQ(subgraph.tensor(4)->data.f[i], i);
+    }
+  }
+  EXPECT_THAT(counts, ElementsAreArray({3, 1, 1}));
+
+  // Changing the static input reruns its chain only.
+  subgraph.tensor(1)->data.f[0] = 10;
+  ASSERT_EQ(subgraph.Invoke(), kTfLiteOk);
+  EXPECT_EQ(subgraph.tensor(4)->data.f[0], 10);
+  EXPECT_THAT(counts, ElementsAreArray({3, 2, 2}));
+
+  // Releasing the tensors' memory reruns all nodes.
+  ASSERT_EQ(subgraph.ReleaseNonPersistentMemory(), kTfLiteOk);
+  ASSERT_EQ(subgraph.AllocateTensors(), kTfLiteOk);
+  for (int i = 0; i < 4; ++i) {
+    subgraph.tensor(0)->data.f[i] = 2;
+    subgraph.tensor(1)->data.f[i] = i;
+  }
+  ASSERT_EQ(subgraph.Invoke(), kTfLiteOk);
+  EXPECT_EQ(subgraph.tensor(4)->data.f[3], 3);
+  EXPECT_THAT(counts, ElementsAreArray({4, 3, 3}));
+}
+
+TEST(SkipUnchangedNodes, RunsAllNodesByDefault) {
+  Interpreter interpreter;
+  auto& subgraph = interpreter.primary_subgraph();
+  subgraph.AddTensors(2);
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_EQ(subgraph.SetTensorParametersReadWrite(
+                  i, kTfLiteFloat32, "", {4}, TfLiteQuantization()),
+              kTfLiteOk);
+  }
+  subgraph.SetInputs({0});
+  subgraph.SetOutputs({1});
+  TfLiteRegistration neg_op = CountingNegRegistration();
+  int count = 0;
+  ASSERT_EQ(subgraph.AddNodeWithParameters({0}, {1}, {},
+                                           reinterpret_cast<char*>(&count),
+                                           0, nullptr, &neg_op),
+            kTfLiteOk);
+  ASSERT_EQ(subgraph.AllocateTensors(), kTfLiteOk);
+  std::fill_n(subgraph.tensor(0)->data.f, 4, 1.0f);
+  ASSERT_EQ(subgraph.Invoke(), kTfLiteOk);
+  ASSERT_EQ(subgraph.Invoke(), kTfLiteOk);
+  EXPECT_EQ(count, 2);
+}
+
+// A delegate running the node at index 1 as a NEG kernel.
+TfLiteDelegate NegDelegate() {
+  TfLiteDelegate delegate = TfLiteDelegateCreate();
+  delegate.Prepare = [](TfLiteContext* context, TfLiteDelegate* delegate) {
+    TfLiteRegistration registration = {};
+    registration.custom_name = "NegDelegateKernel";
+    registration.prepare = [](TfLiteContext*, TfLiteNode*) {
+      return kTfLiteOk;
+    };
+    registration.invoke = [](TfLiteContext* context, TfLiteNode* node) {
+      const TfLiteTensor* input = &context->tensors[node->inputs->data[0]];
+      TfLiteTensor* output = &context->tensors[node->outputs->data[0]];
+      for (int i = 0; i < input->bytes / sizeof(float); ++i) {
+        output->data.f[i] = -input->data.f[i];
+      }
+      return kTfLiteOk;
+    };
+    TfLiteIntArray* nodes_to_replace = TfLiteIntArrayCreate(1);
+    nodes_to_replace->data[0] = 1;
+    const TfLiteStatus status = context->ReplaceNodeSubsetsWithDelegateKernels(
+        context, registration, nodes_to_replace, delegate);
+    TfLiteIntArrayFree(nodes_to_replace);
+    return status;
+  };
+  return delegate;
+}
+
+// Builds a chain of three NEG nodes, of which the middle one is delegated.
+void BuildPartitionedNegChain(Interpreter* interpreter,
+                              TfLiteDelegate* delegate) {
+  auto& subgraph = interpreter->primary_subgraph();
+  subgraph.AddTensors(4);
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_EQ(subgraph.SetTensorParametersReadWrite(
+                  i, kTfLiteFloat32, "", {4}, TfLiteQuantization()),
+              kTfLiteOk);
+  }
+  subgraph.SetInputs({0});
+  subgraph.SetOutputs({3});
+  TfLiteRegistration* neg_op = tflite::ops::builtin::Register_NEG();
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(subgraph.AddNodeWithParameters({i}, {i + 1}, {}, nullptr, 0,
+                                             nullptr, neg_op),
+              kTfLiteOk);
+  }
+  ASSERT_EQ(interpreter->ModifyGraphWithDelegate(delegate), kTfLiteOk);
+  ASSERT_EQ(subgraph.AllocateTensors(), kTfLiteOk);
+}
+
+TEST(PipelinePartitions, RunsEachPartitionOnAnEarlierInput) {
+  Interpreter interpreter;
+  InterpreterOptions options;
+  options.SetPipelinePartitions(true);
+  ASSERT_EQ(interpreter.ApplyOptions(&options), kTfLiteOk);
+  TfLiteDelegate delegate = NegDelegate();
+  ASSERT_NO_FATAL_FAILURE(BuildPartitionedNegChain(&interpreter, &delegate));
+  auto& subgraph = interpreter.primary_subgraph();
+
+  // The CPU node, the delegate kernel and the CPU node form three stages.
+  ASSERT_EQ(subgraph.num_pipeline_stages(), 3);
+  for (int step = 0; step < 6; ++step) {
+    std::fill_n(subgraph.tensor(0)->data.f, 4, step);
+    ASSERT_EQ(subgraph.Invoke(), kTfLiteOk);
+    if (step < 2) continue;
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_EQ(subgraph.tensor(3)->data.f[i], 2 - step);
+    }
+  }
+}
+
+TEST(PipelinePartitions, RunsSequentiallyByDefault) {
+  Interpreter interpreter;
+  TfLiteDelegate delegate = NegDelegate();
+  ASSERT_NO_FATAL_FAILURE(BuildPartitionedNegChain(&interpreter, &delegate));
+  auto& subgraph = interpreter.primary_subgraph();
+
+  EXPECT_EQ(subgraph.num_pipeline_stages(), 1);
+  std::fill_n(subgraph.tensor(0)->data.f, 4, 5.0f);
+  ASSERT_EQ(subgraph.Invoke(), kTfLiteOk);
+  EXPECT_EQ(subgraph.tensor(3)->data.f[0], -5);
+}
+
 }  // namespace
 }  // namespace tflite
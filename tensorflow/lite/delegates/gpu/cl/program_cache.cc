@@ -54,7 +54,10 @@ uint64_t GetProgramFingerprint(const std::string& code,
 }
 
 std::string GetDriverVersion(const CLDevice& device) {
-  return device.GetPlatformVersion() + "_jet_version_0";
+  // Binaries are only valid for the device and driver that built them.
+  const OpenClInfo& info = device.GetInfo().opencl_info;
+  return device.GetPlatformVersion() + "_" + info.device_name + "_" +
+         info.driver_version + "_jet_version_1";
 }
 
 }  // namespace
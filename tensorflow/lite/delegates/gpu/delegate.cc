@@ -123,6 +123,10 @@ using delegates::SerializationParams;
 using tflite::TFLITE_LOG_WARNING;
 
 constexpr char kSerializedDataPrefix[] = "gpuv2_data_";
+// The program cache is shared by all models, so its entries are namespaced by
+// this token instead of the model token.
+constexpr char kProgramCacheToken[] = "gpuv2_program_cache";
+constexpr char kProgramCacheKey[] = "gpuv2_programs_";
 
 #if defined(__ANDROID__)
 // Xeno API does not impose alignment or padding requirements.
@@ -252,10 +256,21 @@ class Delegate {
       telemetry_settings_ =
           std::make_unique<TfLiteTelemetryGpuDelegateSettings>();
     }
+    if (options_.experimental_flags &
+            TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_PROGRAM_CACHE &&
+        options_.serialization_dir) {
+      SerializationParams params;
+      params.model_token = kProgramCacheToken;
+      params.cache_dir = options_.serialization_dir;
+      program_cache_serialization_ = std::make_unique<Serialization>(params);
+    }
   }
 
   TfLiteDelegate* tflite_delegate() { return &delegate_; }
   Serialization* serialization() { return serialization_.get(); }
+  Serialization* program_cache_serialization() {
+    return program_cache_serialization_.get();
+  }
   const TfLiteGpuDelegateOptionsV2& options() const { return options_; }
   bool async() const { return async_; }
 
@@ -277,6 +292,7 @@ class Delegate {
   std::atomic<int> num_delegate_kernels_ = 0;
 
   std::unique_ptr<Serialization> serialization_;
+  std::unique_ptr<Serialization> program_cache_serialization_;
 
   std::unique_ptr<TfLiteTelemetryGpuDelegateSettings> telemetry_settings_;
 
@@ -348,10 +364,22 @@ class DelegateKernelCore {
       cl::InferenceOptions* options, Serialization* serialization,
       const std::vector<uint8_t>& serialized_model);
 
+  // Reads the program binaries cached by earlier runs into
+  // program_cache_data_ and points env_options at them.
+  void MaybeLoadProgramCache(TfLiteContext* context,
+                             cl::InferenceEnvironmentOptions* env_options);
+
+  // Writes the programs of cl_environment_ back to disk if this kernel built
+  // any that were not in the loaded cache.
+  void MaybeSaveProgramCache(TfLiteContext* context);
+
   // The Delegate instance that's shared across all DelegateKernel instances.
   Delegate* const delegate_;  // doesn't own the memory.
 
   std::unique_ptr<cl::InferenceEnvironment> cl_environment_;
+  // Backs InferenceEnvironmentOptions::serialized_binary_cache, which must
+  // outlive cl_environment_.
+  std::string program_cache_data_;
 #ifndef CL_DELEGATE_NO_GL
   std::unique_ptr<gl::InferenceEnvironment> gl_environment_;
 #endif
@@ -548,6 +576,8 @@ absl::Status DelegateKernelCore::InitializeOpenClApi(
   options.gpu_invoke_loop_times = delegate_options.gpu_invoke_loop_times;
 #endif
 
+  MaybeLoadProgramCache(context, &env_options);
+
   if (!serialization) {
     // This path is faster when there is no serialization involved.
     RETURN_IF_ERROR(cl::NewInferenceEnvironment(env_options, &cl_environment_,
@@ -576,6 +606,7 @@ absl::Status DelegateKernelCore::InitializeOpenClApi(
     RETURN_IF_ERROR(SaveSerializedOpenCL(context, delegate_params, &options,
                                          serialization, serialized_model));
   }
+  MaybeSaveProgramCache(context);
 
   TFLITE_LOG_PROD_ONCE(tflite::TFLITE_LOG_INFO,
                        "Initialized OpenCL-based API.");
@@ -674,6 +705,43 @@ absl::Status DelegateKernelCore::SaveSerializedOpenCL(
   return absl::OkStatus();
 }
 
+void DelegateKernelCore::MaybeLoadProgramCache(
+    TfLiteContext* context, cl::InferenceEnvironmentOptions* env_options) {
+  Serialization* serialization = delegate_->program_cache_serialization();
+  if (!serialization) return;
+  auto data_key =
+      serialization->GetEntryForDelegate(kProgramCacheKey, /*context=*/nullptr);
+  if (data_key.GetData(context, &program_cache_data_) != kTfLiteOk) {
+    program_cache_data_.clear();
+    return;
+  }
+  // Binaries built by another device or driver are rejected by ProgramCache
+  // and rebuilt from source.
+  env_options->serialized_binary_cache = absl::Span<const uint8_t>{
+      reinterpret_cast<const uint8_t*>(program_cache_data_.data()),
+      program_cache_data_.size()};
+}
+
+void DelegateKernelCore::MaybeSaveProgramCache(TfLiteContext* context) {
+  Serialization* serialization = delegate_->program_cache_serialization();
+  if (!serialization || !cl_environment_) return;
+  // Programs are only ever added to the cache, so an unchanged size means
+  // every kernel was served from disk.
+  const std::vector<uint8_t> serialized_cache =
+      cl_environment_->GetSerializedBinaryCache();
+  if (serialized_cache.empty() ||
+      serialized_cache.size() == program_cache_data_.size()) {
+    return;
+  }
+  auto data_key =
+      serialization->GetEntryForDelegate(kProgramCacheKey, /*context=*/nullptr);
+  if (data_key.SetData(context,
+                       reinterpret_cast<const char*>(serialized_cache.data()),
+                       serialized_cache.size()) != kTfLiteOk) {
+    TFLITE_LOG(TFLITE_LOG_WARNING, "Failed to save the GPU program cache.");
+  }
+}
+
 // Represent the execution of a subset of nodes on GPU.
 class DelegateKernel {
  public:
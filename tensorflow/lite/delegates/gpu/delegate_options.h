@@ -71,6 +71,17 @@ enum TfLiteGpuExperimentalFlags {
   // TfLiteGpuDelegateOptionsV2.
   // Currently works only if CL backend is used.
   TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION = 1 << 3,
+  // Enable an on-disk cache of compiled GPU programs that is shared by all
+  // models using the same serialization_dir. Programs are keyed by their
+  // source and compiler options, and the whole cache is discarded when the
+  // device or driver changes, so a new model only compiles the kernels that
+  // no earlier model has used. Unlike serialization, model_token is not
+  // needed.
+  //
+  // NOTE: User also needs to set serialization_dir in
+  // TfLiteGpuDelegateOptionsV2.
+  // Currently works only if CL backend is used.
+  TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_PROGRAM_CACHE = 1 << 4,
 };
 
 // IMPORTANT: Always use TfLiteGpuDelegateOptionsV2Default() method to create
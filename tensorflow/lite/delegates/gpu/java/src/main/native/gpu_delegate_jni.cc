@@ -146,6 +146,10 @@ JNIEXPORT jlong JNICALL Java_org_tensorflow_lite_gpu_GpuDelegate_createDelegate(
     options.experimental_flags |=
         TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_SERIALIZATION;
   }
+  if (options.serialization_dir) {
+    options.experimental_flags |=
+        TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_PROGRAM_CACHE;
+  }
   if (force_backend == kGpuBackendOpenCl) {
     options.experimental_flags |= TFLITE_GPU_EXPERIMENTAL_FLAGS_CL_ONLY;
   } else if (force_backend == kGpuBackendOpenGl) {
@@ -539,6 +539,14 @@ class Delegate {
 
     options_ =
         options != nullptr ? *options : TfLiteXNNPackDelegateOptionsDefault();
+    if (options_.nodes_to_skip != nullptr) {
+      nodes_to_skip_.insert(
+          options_.nodes_to_skip,
+          options_.nodes_to_skip + std::max(options_.num_nodes_to_skip, 0));
+    }
+    // The caller owns the array, which need not outlive this constructor.
+    options_.nodes_to_skip = nullptr;
+    options_.num_nodes_to_skip = 0;
     delegate_.flags = GetXNNPackDelegateFlags();
     workspace_.reset(workspace);
 
@@ -734,6 +742,9 @@ class Delegate {
   std::unordered_set<int> static_unpack_nodes_;
   // Set of indices of tensors with unpacked static sparse weights.
   std::unordered_set<int> static_sparse_weights_;
+  // Set of indices of nodes left to the builtin kernels regardless of whether
+  // XNNPack supports them, see TfLiteXNNPackDelegateOptions::nodes_to_skip.
+  std::unordered_set<int> nodes_to_skip_;
 #if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
   // Thread pool with smart-pointer for lifetime management.
   std::unique_ptr<pthreadpool, decltype(&pthreadpool_destroy)> threadpool_{
@@ -7231,7 +7242,8 @@ TfLiteIntArray* Delegate::PrepareOpsToDelegate(TfLiteContext* context) {
       variable_handles[node_index] = node->outputs->data[0];
     }
 
-    if (Subgraph::VisitNode(
+    if (nodes_to_skip_.count(node_index) != 0 ||
+        Subgraph::VisitNode(
             /*subgraph=*/nullptr, /*delegate=*/*this, context, registration,
             node, node_index, quasi_static_tensors,
             std::unordered_map<int, uint32_t>()) != kTfLiteOk) {
@@ -76,6 +76,13 @@ typedef struct {
   // To keep backwards compatibility with the previous caching mechanism, the
   // weight cache will only be loaded from this if `weight_cache` is undefined.
   const char* weight_cache_file_path;
+  // Indices of nodes that must stay on the builtin TFLite kernels even though
+  // XNNPack supports them, e.g. a placement plan measured by the benchmark
+  // tool (see lite/tools/benchmark/README.md). The indices apply to every
+  // subgraph the delegate is applied to. The array is copied when the delegate
+  // is created.
+  const int* nodes_to_skip;
+  int num_nodes_to_skip;
 } TfLiteXNNPackDelegateOptions;
 
 // Returns true on systems that support running the in-memory weight cache
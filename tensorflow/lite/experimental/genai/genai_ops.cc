@@ -28,6 +28,10 @@ extern "C" void GenAIOpsRegisterer(::tflite::MutableOpResolver* resolver) {
                       tflite::ops::custom::Register_SDPA());
   resolver->AddCustom("odml.update_external_kv_cache",
                       tflite::ops::custom::Register_EXTERNAL_KV_CACHE());
+  resolver->AddCustom("odml.update_paged_kv_cache",
+                      tflite::ops::custom::Register_PAGED_KV_CACHE());
+  resolver->AddCustom("odml.paged_scaled_dot_product_attention",
+                      tflite::ops::custom::Register_PAGED_SDPA());
 }
 
 }  // namespace custom
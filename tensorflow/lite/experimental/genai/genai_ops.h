@@ -26,6 +26,8 @@ namespace custom {
 TfLiteRegistration* Register_KV_CACHE();
 TfLiteRegistration* Register_EXTERNAL_KV_CACHE();
 TfLiteRegistration* Register_SDPA();
+TfLiteRegistration* Register_PAGED_KV_CACHE();
+TfLiteRegistration* Register_PAGED_SDPA();
 
 extern "C" void GenAIOpsRegisterer(::tflite::MutableOpResolver* resolver);
 
@@ -0,0 +1,165 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/experimental/genai/paged_kv_cache_manager.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace tflite {
+namespace genai {
+
+PagedKVCacheManager::PagedKVCacheManager(int num_blocks, int block_size,
+                                         int max_blocks_per_sequence)
+    : block_size_(block_size),
+      max_blocks_per_sequence_(max_blocks_per_sequence),
+      ref_counts_(num_blocks, 0) {
+  // Hand out low block ids first.
+  free_blocks_.reserve(num_blocks);
+  for (int32_t block = num_blocks - 1; block >= 0; --block) {
+    free_blocks_.push_back(block);
+  }
+}
+
+bool PagedKVCacheManager::AddSequence(int sequence_id) {
+  return sequences_.emplace(sequence_id, Sequence()).second;
+}
+
+bool PagedKVCacheManager::ForkSequence(int parent_id, int child_id,
+                                       int num_tokens) {
+  auto parent = sequences_.find(parent_id);
+  if (parent == sequences_.end() || sequences_.count(child_id) != 0 ||
+      num_tokens < 0 || num_tokens > parent->second.num_tokens) {
+    return false;
+  }
+  Sequence child;
+  const int num_shared_blocks = (num_tokens + block_size_ - 1) / block_size_;
+  child.blocks.assign(parent->second.blocks.begin(),
+                      parent->second.blocks.begin() + num_shared_blocks);
+  child.num_tokens = num_tokens;
+  for (int32_t block : child.blocks) {
+    ++ref_counts_[block];
+  }
+  sequences_.emplace(child_id, std::move(child));
+  return true;
+}
+
+bool PagedKVCacheManager::AppendTokens(int sequence_id, int num_tokens,
+                                       std::vector<BlockCopy>* copies) {
+  auto it = sequences_.find(sequence_id);
+  if (it == sequences_.end() || num_tokens < 0) return false;
+  Sequence& sequence = it->second;
+  const int total_tokens = sequence.num_tokens + num_tokens;
+  const int total_blocks = (total_tokens + block_size_ - 1) / block_size_;
+  if (total_blocks > max_blocks_per_sequence_) return false;
+
+  // Only blocks at or after the first new token are written; those that are
+  // shared with another sequence need a private copy.
+  const int first_written_block = sequence.num_tokens / block_size_;
+  const int num_blocks = sequence.blocks.size();
+  int num_copies = 0;
+  for (int i = first_written_block; i < num_blocks; ++i) {
+    if (ref_counts_[sequence.blocks[i]] > 1) ++num_copies;
+  }
+  if (num_copies + total_blocks - num_blocks > num_free_blocks()) return false;
+
+  for (int i = first_written_block; i < num_blocks; ++i) {
+    const int32_t source = sequence.blocks[i];
+    if (ref_counts_[source] > 1) {
+      const int32_t destination = AllocateBlock();
+      --ref_counts_[source];
+      sequence.blocks[i] = destination;
+      copies->emplace_back(source, destination);
+    }
+  }
+  for (int i = num_blocks; i < total_blocks; ++i) {
+    sequence.blocks.push_back(AllocateBlock());
+  }
+  sequence.num_tokens = total_tokens;
+  return true;
+}
+
+bool PagedKVCacheManager::TruncateSequence(int sequence_id, int num_tokens) {
+  auto it = sequences_.find(sequence_id);
+  if (it == sequences_.end() || num_tokens < 0 ||
+      num_tokens > it->second.num_tokens) {
+    return false;
+  }
+  Sequence& sequence = it->second;
+  const int num_blocks = (num_tokens + block_size_ - 1) / block_size_;
+  const int old_num_blocks = sequence.blocks.size();
+  for (int i = num_blocks; i < old_num_blocks; ++i) {
+    ReleaseBlock(sequence.blocks[i]);
+  }
+  sequence.blocks.resize(num_blocks);
+  sequence.num_tokens = num_tokens;
+  return true;
+}
+
+void PagedKVCacheManager::RemoveSequence(int sequence_id) {
+  auto it = sequences_.find(sequence_id);
+  if (it == sequences_.end()) return;
+  for (int32_t block : it->second.blocks) {
+    ReleaseBlock(block);
+  }
+  sequences_.erase(it);
+}
+
+int PagedKVCacheManager::NumTokens(int sequence_id) const {
+  auto it = sequences_.find(sequence_id);
+  return it == sequences_.end() ? -1 : it->second.num_tokens;
+}
+
+std::pair<int32_t, int32_t> PagedKVCacheManager::Slot(int sequence_id,
+                                                      int position) const {
+  auto it = sequences_.find(sequence_id);
+  if (it == sequences_.end() || position < 0 ||
+      position >= it->second.num_tokens) {
+    return {-1, -1};
+  }
+  return {it->second.blocks[position / block_size_], position % block_size_};
+}
+
+void PagedKVCacheManager::FillBlockTable(int sequence_id,
+                                         int32_t* block_table) const {
+  auto it = sequences_.find(sequence_id);
+  int num_blocks = 0;
+  if (it != sequences_.end()) {
+    num_blocks = it->second.blocks.size();
+    for (int i = 0; i < num_blocks; ++i) {
+      block_table[i] = it->second.blocks[i];
+    }
+  }
+  for (int i = num_blocks; i < max_blocks_per_sequence_; ++i) {
+    block_table[i] = -1;
+  }
+}
+
+int32_t PagedKVCacheManager::AllocateBlock() {
+  const int32_t block = free_blocks_.back();
+  free_blocks_.pop_back();
+  ref_counts_[block] = 1;
+  return block;
+}
+
+void PagedKVCacheManager::ReleaseBlock(int32_t block) {
+  if (--ref_counts_[block] == 0) {
+    free_blocks_.push_back(block);
+  }
+}
+
+}  // namespace genai
+}  // namespace tflite
@@ -0,0 +1,107 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_GENAI_PAGED_KV_CACHE_MANAGER_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_GENAI_PAGED_KV_CACHE_MANAGER_H_
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace tflite {
+namespace genai {
+
+// Host side bookkeeping for the paged KV cache used by
+// "odml.update_paged_kv_cache" and "odml.paged_scaled_dot_product_attention".
+//
+// The K and V pools are split into `num_blocks` fixed-size blocks of
+// `block_size` tokens each. Every sequence owns a block table mapping its
+// logical blocks to physical blocks in the pools, so a sequence only holds as
+// many blocks as it has tokens, and many sequences of different lengths can be
+// batched together. Blocks are reference counted: ForkSequence lets sequences
+// share a common prefix, and a shared block is copied on the first write
+// (copy-on-write). The copies are reported to the caller, who owns the pools.
+//
+// This class is not thread-safe.
+class PagedKVCacheManager {
+ public:
+  // A (source, destination) pair of physical blocks whose K and V contents must
+  // be copied before the next update.
+  using BlockCopy = std::pair<int32_t, int32_t>;
+
+  PagedKVCacheManager(int num_blocks, int block_size,
+                      int max_blocks_per_sequence);
+
+  // Starts an empty sequence. Returns false if `sequence_id` is already in use.
+  bool AddSequence(int sequence_id);
+
+  // Starts `child_id` as a copy of the first `num_tokens` tokens of
+  // `parent_id`, sharing the parent's blocks instead of copying them. Returns
+  // false if the parent does not exist, the child already exists, or the
+  // parent has fewer than `num_tokens` tokens.
+  bool ForkSequence(int parent_id, int child_id, int num_tokens);
+
+  // Reserves cache slots for `num_tokens` more tokens of `sequence_id`. Shared
+  // blocks that would be written are replaced by private copies, recorded in
+  // `copies`. Returns false, leaving the sequence unchanged, if the sequence
+  // does not exist or there are not enough free blocks.
+  bool AppendTokens(int sequence_id, int num_tokens,
+                    std::vector<BlockCopy>* copies);
+
+  // Drops all but the first `num_tokens` tokens of `sequence_id`, e.g. draft
+  // tokens rejected by speculative decoding, and releases the blocks that no
+  // longer hold any of its tokens. Returns false if the sequence does not exist
+  // or has fewer than `num_tokens` tokens.
+  bool TruncateSequence(int sequence_id, int num_tokens);
+
+  // Releases all blocks held by `sequence_id`.
+  void RemoveSequence(int sequence_id);
+
+  // Returns the number of tokens of `sequence_id`, or -1 if it does not exist.
+  int NumTokens(int sequence_id) const;
+
+  // Returns the physical block and the offset within it that hold token
+  // `position` of `sequence_id`, or {-1, -1} if there is no such token.
+  std::pair<int32_t, int32_t> Slot(int sequence_id, int position) const;
+
+  // Writes the block table of `sequence_id` to `block_table`, which must hold
+  // max_blocks_per_sequence() entries. Unused entries are set to -1.
+  void FillBlockTable(int sequence_id, int32_t* block_table) const;
+
+  int num_free_blocks() const { return free_blocks_.size(); }
+  int block_size() const { return block_size_; }
+  int max_blocks_per_sequence() const { return max_blocks_per_sequence_; }
+
+ private:
+  struct Sequence {
+    std::vector<int32_t> blocks;
+    int num_tokens = 0;
+  };
+
+  int32_t AllocateBlock();
+  void ReleaseBlock(int32_t block);
+
+  const int block_size_;
+  const int max_blocks_per_sequence_;
+  std::vector<int32_t> ref_counts_;
+  std::vector<int32_t> free_blocks_;
+  std::unordered_map<int, Sequence> sequences_;
+};
+
+}  // namespace genai
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_GENAI_PAGED_KV_CACHE_MANAGER_H_
@@ -0,0 +1,123 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/experimental/genai/paged_kv_cache_manager.h"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace genai {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+std::vector<int32_t> BlockTable(const PagedKVCacheManager& manager, int id) {
+  std::vector<int32_t> table(manager.max_blocks_per_sequence());
+  manager.FillBlockTable(id, table.data());
+  return table;
+}
+
+TEST(PagedKVCacheManagerTest, AllocatesBlocksOnDemand) {
+  PagedKVCacheManager manager(/*num_blocks=*/4, /*block_size=*/2,
+                              /*max_blocks_per_sequence=*/3);
+  ASSERT_TRUE(manager.AddSequence(0));
+  EXPECT_FALSE(manager.AddSequence(0));
+  std::vector<PagedKVCacheManager::BlockCopy> copies;
+  ASSERT_TRUE(manager.AppendTokens(0, 3, &copies));
+  EXPECT_THAT(copies, IsEmpty());
+  EXPECT_EQ(manager.NumTokens(0), 3);
+  EXPECT_EQ(manager.num_free_blocks(), 2);
+  EXPECT_THAT(BlockTable(manager, 0), ElementsAre(0, 1, -1));
+  EXPECT_EQ(manager.Slot(0, 2), std::make_pair(1, 0));
+  EXPECT_EQ(manager.Slot(0, 3), std::make_pair(-1, -1));
+
+  // The last block still has room for this token.
+  ASSERT_TRUE(manager.AppendTokens(0, 1, &copies));
+  EXPECT_EQ(manager.num_free_blocks(), 2);
+  // But the sequence may not grow past max_blocks_per_sequence.
+  EXPECT_FALSE(manager.AppendTokens(0, 3, &copies));
+  EXPECT_EQ(manager.NumTokens(0), 4);
+}
+
+TEST(PagedKVCacheManagerTest, ForkSharesPrefixAndCopiesOnWrite) {
+  PagedKVCacheManager manager(/*num_blocks=*/4, /*block_size=*/2,
+                              /*max_blocks_per_sequence=*/4);
+  std::vector<PagedKVCacheManager::BlockCopy> copies;
+  ASSERT_TRUE(manager.AddSequence(0));
+  ASSERT_TRUE(manager.AppendTokens(0, 3, &copies));
+  ASSERT_TRUE(manager.ForkSequence(0, 1, 3));
+  EXPECT_FALSE(manager.ForkSequence(0, 2, 4));
+  EXPECT_THAT(BlockTable(manager, 1), ElementsAre(0, 1, -1, -1));
+  EXPECT_EQ(manager.num_free_blocks(), 2);
+
+  // The child writes into the shared partial block, so it gets a copy; the
+  // full block stays shared.
+  ASSERT_TRUE(manager.AppendTokens(1, 1, &copies));
+  EXPECT_THAT(copies, ElementsAre(PagedKVCacheManager::BlockCopy(1, 2)));
+  EXPECT_THAT(BlockTable(manager, 1), ElementsAre(0, 2, -1, -1));
+  EXPECT_THAT(BlockTable(manager, 0), ElementsAre(0, 1, -1, -1));
+
+  // The parent is the only owner of block 1 again and writes in place.
+  copies.clear();
+  ASSERT_TRUE(manager.AppendTokens(0, 1, &copies));
+  EXPECT_THAT(copies, IsEmpty());
+  EXPECT_EQ(manager.num_free_blocks(), 1);
+
+  manager.RemoveSequence(0);
+  EXPECT_EQ(manager.num_free_blocks(), 2);
+  manager.RemoveSequence(1);
+  EXPECT_EQ(manager.num_free_blocks(), 4);
+  EXPECT_EQ(manager.NumTokens(1), -1);
+}
+
+TEST(PagedKVCacheManagerTest, TruncateReleasesTrailingBlocks) {
+  PagedKVCacheManager manager(/*num_blocks=*/4, /*block_size=*/2,
+                              /*max_blocks_per_sequence=*/4);
+  std::vector<PagedKVCacheManager::BlockCopy> copies;
+  ASSERT_TRUE(manager.AddSequence(0));
+  ASSERT_TRUE(manager.AppendTokens(0, 7, &copies));
+  EXPECT_FALSE(manager.TruncateSequence(0, 8));
+  ASSERT_TRUE(manager.TruncateSequence(0, 3));
+  EXPECT_EQ(manager.NumTokens(0), 3);
+  EXPECT_EQ(manager.num_free_blocks(), 2);
+  EXPECT_THAT(BlockTable(manager, 0), ElementsAre(0, 1, -1, -1));
+
+  // New tokens reuse the partial block before taking a free one.
+  ASSERT_TRUE(manager.AppendTokens(0, 2, &copies));
+  EXPECT_THAT(copies, IsEmpty());
+  EXPECT_EQ(manager.num_free_blocks(), 1);
+}
+
+TEST(PagedKVCacheManagerTest, FailsWhenOutOfBlocks) {
+  PagedKVCacheManager manager(/*num_blocks=*/2, /*block_size=*/2,
+                              /*max_blocks_per_sequence=*/4);
+  std::vector<PagedKVCacheManager::BlockCopy> copies;
+  ASSERT_TRUE(manager.AddSequence(0));
+  ASSERT_TRUE(manager.AddSequence(1));
+  ASSERT_TRUE(manager.AppendTokens(0, 3, &copies));
+  EXPECT_FALSE(manager.AppendTokens(1, 1, &copies));
+  EXPECT_EQ(manager.NumTokens(1), 0);
+  EXPECT_EQ(manager.num_free_blocks(), 0);
+}
+
+}  // namespace
+}  // namespace genai
+}  // namespace tflite
@@ -0,0 +1,184 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+#include <cstring>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+
+namespace tflite {
+namespace ops {
+namespace custom {
+namespace llm {
+
+static const int kKeyPoolTensor = 0;
+static const int kValuePoolTensor = 1;
+static const int kBlockTableTensor = 2;
+static const int kPositionTensor = 3;
+static const int kKeySliceTensor = 4;
+static const int kValueSliceTensor = 5;
+
+static const int kRequiredNumDimensions = 4;
+
+TfLiteStatus PagedKVCachePrepare(TfLiteContext* context, TfLiteNode* node) {
+  // k_pool, v_pool, block_table, position, k_slice, v_slice
+  TF_LITE_ENSURE_EQ(context, NumInputs(node), 6);
+  // updated: k_pool, v_pool
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 2);
+
+  const TfLiteTensor* k_pool;
+  const TfLiteTensor* v_pool;
+  const TfLiteTensor* block_table;
+  const TfLiteTensor* position;
+  const TfLiteTensor* k_slice;
+  const TfLiteTensor* v_slice;
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kKeyPoolTensor, &k_pool));
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kValuePoolTensor, &v_pool));
+  TF_LITE_ENSURE_OK(
+      context, GetInputSafe(context, node, kBlockTableTensor, &block_table));
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kPositionTensor, &position));
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kKeySliceTensor, &k_slice));
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kValueSliceTensor, &v_slice));
+
+  TfLiteTensor* updated_k_pool;
+  TfLiteTensor* updated_v_pool;
+  TF_LITE_ENSURE_OK(
+      context, GetOutputSafe(context, node, kKeyPoolTensor, &updated_k_pool));
+  TF_LITE_ENSURE_OK(
+      context, GetOutputSafe(context, node, kValuePoolTensor, &updated_v_pool));
+
+  TF_LITE_ENSURE_EQ(context, k_pool->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, v_pool->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, block_table->type, kTfLiteInt32);
+  TF_LITE_ENSURE_EQ(context, position->type, kTfLiteInt32);
+  TF_LITE_ENSURE_EQ(context, k_slice->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, v_slice->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, updated_k_pool->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, updated_v_pool->type, kTfLiteFloat32);
+
+  TF_LITE_ENSURE(context, HaveSameShapes(k_pool, v_pool));
+  TF_LITE_ENSURE(context, HaveSameShapes(k_slice, v_slice));
+  TF_LITE_ENSURE(context, HaveSameShapes(updated_k_pool, updated_v_pool));
+  TF_LITE_ENSURE(context, HaveSameShapes(k_pool, updated_k_pool));
+
+  // Pools are (num_blocks, block_size, N, H) and slices are (B, S, N, H).
+  TF_LITE_ENSURE(context, NumDimensions(k_pool) == kRequiredNumDimensions);
+  TF_LITE_ENSURE(context, NumDimensions(k_slice) == kRequiredNumDimensions);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(k_pool, 2),
+                    SizeOfDimension(k_slice, 2));
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(k_pool, 3),
+                    SizeOfDimension(k_slice, 3));
+  // One block table row and one position per token of every sequence.
+  TF_LITE_ENSURE(context, NumDimensions(block_table) == 2);
+  TF_LITE_ENSURE(context, NumDimensions(position) == 2);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(block_table, 0),
+                    SizeOfDimension(k_slice, 0));
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(position, 0),
+                    SizeOfDimension(k_slice, 0));
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(position, 1),
+                    SizeOfDimension(k_slice, 1));
+
+  return kTfLiteOk;
+}
+
+TfLiteStatus PagedKVCacheEval(TfLiteContext* context, TfLiteNode* node) {
+  const TfLiteTensor* k_pool;
+  const TfLiteTensor* v_pool;
+  const TfLiteTensor* block_table;
+  const TfLiteTensor* position;
+  const TfLiteTensor* k_slice;
+  const TfLiteTensor* v_slice;
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kKeyPoolTensor, &k_pool));
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kValuePoolTensor, &v_pool));
+  TF_LITE_ENSURE_OK(
+      context, GetInputSafe(context, node, kBlockTableTensor, &block_table));
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kPositionTensor, &position));
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kKeySliceTensor, &k_slice));
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kValueSliceTensor, &v_slice));
+
+  TfLiteTensor* updated_k_pool;
+  TfLiteTensor* updated_v_pool;
+  TF_LITE_ENSURE_OK(
+      context, GetOutputSafe(context, node, kKeyPoolTensor, &updated_k_pool));
+  TF_LITE_ENSURE_OK(
+      context, GetOutputSafe(context, node, kValuePoolTensor, &updated_v_pool));
+
+  // As with the external KV cache, share the input and output buffers through
+  // CustomAllocation to avoid these copies.
+  if (k_pool->data.raw != updated_k_pool->data.raw) {
+    memcpy(updated_k_pool->data.data, k_pool->data.data, k_pool->bytes);
+  }
+  if (v_pool->data.raw != updated_v_pool->data.raw) {
+    memcpy(updated_v_pool->data.data, v_pool->data.data, v_pool->bytes);
+  }
+
+  const int32_t num_blocks = SizeOfDimension(k_pool, 0);
+  const int32_t block_size = SizeOfDimension(k_pool, 1);
+  const int32_t elements_in_one_entry =
+      SizeOfDimension(k_pool, 2) * SizeOfDimension(k_pool, 3);
+  const int32_t batch_size = SizeOfDimension(k_slice, 0);
+  const int32_t seq_len = SizeOfDimension(k_slice, 1);
+  const int32_t max_blocks = SizeOfDimension(block_table, 1);
+  for (int b = 0; b < batch_size; ++b) {
+    const int32_t* blocks = block_table->data.i32 + b * max_blocks;
+    for (int s = 0; s < seq_len; ++s) {
+      const int32_t update_position = position->data.i32[b * seq_len + s];
+      // Negative positions pad sequences that have fewer new tokens than the
+      // longest one in the batch.
+      if (update_position < 0) continue;
+      const int32_t logical_block = update_position / block_size;
+      TF_LITE_ENSURE(context, logical_block < max_blocks);
+      const int32_t block = blocks[logical_block];
+      TF_LITE_ENSURE(context, block >= 0 && block < num_blocks);
+      const int32_t cache_offset =
+          (block * block_size + update_position % block_size) *
+          elements_in_one_entry;
+      const int32_t update_offset = (b * seq_len + s) * elements_in_one_entry;
+      memcpy(updated_k_pool->data.f + cache_offset,
+             k_slice->data.f + update_offset,
+             elements_in_one_entry * sizeof(float));
+      memcpy(updated_v_pool->data.f + cache_offset,
+             v_slice->data.f + update_offset,
+             elements_in_one_entry * sizeof(float));
+    }
+  }
+
+  return kTfLiteOk;
+}
+
+}  // namespace llm
+
+TfLiteRegistration* Register_PAGED_KV_CACHE() {
+  static TfLiteRegistration r = {/*init=*/nullptr, /*free=*/nullptr,
+                                 llm::PagedKVCachePrepare,
+                                 llm::PagedKVCacheEval};
+  return &r;
+}
+
+}  // namespace custom
+}  // namespace ops
+}  // namespace tflite
@@ -0,0 +1,170 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+#include "tensorflow/lite/c/c_api_types.h"
+#include "tensorflow/lite/experimental/genai/genai_ops.h"
+#include "tensorflow/lite/kernels/test_util.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+
+namespace tflite {
+namespace {
+
+using ::testing::ElementsAreArray;
+using ::testing::FloatNear;
+using ::testing::Pointwise;
+
+class PagedKVCacheOpModel : public SingleOpModel {
+ public:
+  PagedKVCacheOpModel(const TensorData& pool, const TensorData& block_table,
+                      const TensorData& position, const TensorData& slice) {
+    k_pool_ = AddInput(pool);
+    v_pool_ = AddInput(pool);
+    block_table_ = AddInput(block_table);
+    position_ = AddInput(position);
+    k_slice_ = AddInput(slice);
+    v_slice_ = AddInput(slice);
+    k_pool_out_ = AddOutput(pool);
+    v_pool_out_ = AddOutput(pool);
+    SetCustomOp("Paged_KV_Cache", {}, ops::custom::Register_PAGED_KV_CACHE);
+    BuildInterpreter({GetShape(k_pool_), GetShape(v_pool_),
+                      GetShape(block_table_), GetShape(position_),
+                      GetShape(k_slice_), GetShape(v_slice_)});
+  }
+
+  TfLiteStatus Run(const std::vector<int32_t>& block_table,
+                   const std::vector<int32_t>& position,
+                   const std::vector<float>& k_slice,
+                   const std::vector<float>& v_slice) {
+    PopulateTensor(block_table_, block_table);
+    PopulateTensor(position_, position);
+    PopulateTensor(k_slice_, k_slice);
+    PopulateTensor(v_slice_, v_slice);
+    return Invoke();
+  }
+
+  std::vector<float> GetKPool() { return ExtractVector<float>(k_pool_out_); }
+  std::vector<float> GetVPool() { return ExtractVector<float>(v_pool_out_); }
+
+ private:
+  int k_pool_;
+  int v_pool_;
+  int block_table_;
+  int position_;
+  int k_slice_;
+  int v_slice_;
+  int k_pool_out_;
+  int v_pool_out_;
+};
+
+TEST(PagedKVCacheTest, WritesThroughBlockTable) {
+  // 3 blocks of 2 tokens, 1 head of size 2, two sequences of 2 new tokens.
+  PagedKVCacheOpModel m({TensorType_FLOAT32, {3, 2, 1, 2}},
+                        {TensorType_INT32, {2, 2}},
+                        {TensorType_INT32, {2, 2}},
+                        {TensorType_FLOAT32, {2, 2, 1, 2}});
+  // Sequence 0 owns blocks {2, 0}; sequence 1 owns block {1} and only has
+  // one new token, so its second position is padding.
+  ASSERT_EQ(m.Run({2, 0, 1, -1}, {1, 2, 0, -1}, {1, 2, 3, 4, 5, 6, 7, 8},
+                  {-1, -2, -3, -4, -5, -6, -7, -8}),
+            kTfLiteOk);
+  EXPECT_THAT(m.GetKPool(),
+              ElementsAreArray({3, 4, 0, 0, 5, 6, 0, 0, 0, 0, 1, 2}));
+  EXPECT_THAT(m.GetVPool(),
+              ElementsAreArray({-3, -4, 0, 0, -5, -6, 0, 0, 0, 0, -1, -2}));
+}
+
+TEST(PagedKVCacheTest, FailsOnUnassignedBlock) {
+  PagedKVCacheOpModel m({TensorType_FLOAT32, {2, 2, 1, 1}},
+                        {TensorType_INT32, {1, 2}},
+                        {TensorType_INT32, {1, 1}},
+                        {TensorType_FLOAT32, {1, 1, 1, 1}});
+  EXPECT_EQ(m.Run({0, -1}, {2}, {1}, {1}), kTfLiteError);
+}
+
+class PagedSDPAOpModel : public SingleOpModel {
+ public:
+  PagedSDPAOpModel(const TensorData& query, const TensorData& pool,
+                   const TensorData& block_table, const TensorData& mask) {
+    query_ = AddInput(query);
+    k_pool_ = AddInput(pool);
+    v_pool_ = AddInput(pool);
+    block_table_ = AddInput(block_table);
+    mask_ = AddInput(mask);
+    output_ = AddOutput(query.type);
+    SetCustomOp("Paged_SDPA", {}, ops::custom::Register_PAGED_SDPA);
+    BuildInterpreter({GetShape(query_), GetShape(k_pool_), GetShape(v_pool_),
+                      GetShape(block_table_), GetShape(mask_)});
+  }
+
+  TfLiteStatus Run(const std::vector<float>& query,
+                   const std::vector<float>& k_pool,
+                   const std::vector<float>& v_pool,
+                   const std::vector<int32_t>& block_table,
+                   const std::vector<float>& mask) {
+    PopulateTensor(query_, query);
+    PopulateTensor(k_pool_, k_pool);
+    PopulateTensor(v_pool_, v_pool);
+    PopulateTensor(block_table_, block_table);
+    PopulateTensor(mask_, mask);
+    return Invoke();
+  }
+
+  std::vector<float> GetOutput() { return ExtractVector<float>(output_); }
+
+ private:
+  int query_;
+  int k_pool_;
+  int v_pool_;
+  int block_table_;
+  int mask_;
+  int output_;
+};
+
+// Two blocks of 2 tokens with one kv head of size 2. The sequence owns blocks
+// {1, 0}, so its slots are, in order: block 1 (two tokens) then block 0.
+const std::vector<float> kKeyPool = {1, 0, 0, 1, 1, 1, 0, 0};
+const std::vector<float> kValuePool = {5, 6, 100, 100, 1, 2, 3, 4};
+
+TEST(PagedSDPATest, AttendsThroughBlockTable) {
+  // Two query heads share the kv head. A zero query attends uniformly to the
+  // unmasked slots; the last slot is masked out.
+  PagedSDPAOpModel m({TensorType_FLOAT32, {1, 1, 2, 2}},
+                     {TensorType_FLOAT32, {2, 2, 1, 2}},
+                     {TensorType_INT32, {1, 2}},
+                     {TensorType_FLOAT32, {1, 1, 1, 4}});
+  const float inf = std::numeric_limits<float>::infinity();
+  ASSERT_EQ(m.Run({0, 0, 0, 0}, kKeyPool, kValuePool, {1, 0}, {0, 0, 0, -inf}),
+            kTfLiteOk);
+  EXPECT_THAT(m.GetOutput(), Pointwise(FloatNear(1e-5), {3, 4, 3, 4}));
+}
+
+TEST(PagedSDPATest, SkipsUnassignedBlocks) {
+  PagedSDPAOpModel m({TensorType_FLOAT32, {1, 1, 2, 2}},
+                     {TensorType_FLOAT32, {2, 2, 1, 2}},
+                     {TensorType_INT32, {1, 2}},
+                     {TensorType_FLOAT32, {1, 1, 1, 4}});
+  ASSERT_EQ(m.Run({0, 0, 0, 0}, kKeyPool, kValuePool, {1, -1}, {0, 0, 0, 0}),
+            kTfLiteOk);
+  EXPECT_THAT(m.GetOutput(), Pointwise(FloatNear(1e-5), {2, 3, 2, 3}));
+}
+
+}  // namespace
+}  // namespace tflite
@@ -0,0 +1,274 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <math.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#include "flatbuffers/flexbuffers.h"
+#include "tensorflow/lite/c/c_api_types.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/kernels/internal/tensor_ctypes.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+
+namespace tflite {
+namespace ops {
+namespace custom {
+namespace llm {
+
+static const int kQueryTensor = 0;
+static const int kKeyPoolTensor = 1;
+static const int kValuePoolTensor = 2;
+static const int kBlockTableTensor = 3;
+static const int kAttentionMaskTensor = 4;
+static const int kOutputTensor = 0;
+
+static const int kScoresTempTensorIndex = 0;
+
+struct PagedSDPAOpData {
+  float scale;
+  int scratch_tensor_index;
+};
+
+void* PagedSDPAInit(TfLiteContext* context, const char* buffer,
+                    size_t length) {
+  PagedSDPAOpData* op_data = new PagedSDPAOpData();
+  op_data->scale = 0.0f;
+  context->AddTensors(context, 1, &op_data->scratch_tensor_index);
+  return op_data;
+}
+
+void PagedSDPAFree(TfLiteContext* context, void* buffer) {
+  delete static_cast<PagedSDPAOpData*>(buffer);
+}
+
+TfLiteStatus PagedSDPAPrepare(TfLiteContext* context, TfLiteNode* node) {
+  // query, k_pool, v_pool, block_table, mask
+  TF_LITE_ENSURE_EQ(context, NumInputs(node), 5);
+  TF_LITE_ENSURE_EQ(context, NumOutputs(node), 1);
+  PagedSDPAOpData* op_data =
+      reinterpret_cast<PagedSDPAOpData*>(node->user_data);
+
+  const TfLiteTensor* q_tensor;
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kQueryTensor, &q_tensor));
+  const TfLiteTensor* k_pool;
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kKeyPoolTensor, &k_pool));
+  const TfLiteTensor* v_pool;
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kValuePoolTensor, &v_pool));
+  const TfLiteTensor* block_table;
+  TF_LITE_ENSURE_OK(
+      context, GetInputSafe(context, node, kBlockTableTensor, &block_table));
+  const TfLiteTensor* mask_tensor;
+  TF_LITE_ENSURE_OK(
+      context, GetInputSafe(context, node, kAttentionMaskTensor, &mask_tensor));
+  TfLiteTensor* output_tensor;
+  TF_LITE_ENSURE_OK(
+      context, GetOutputSafe(context, node, kOutputTensor, &output_tensor));
+
+  TF_LITE_ENSURE_EQ(context, q_tensor->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, k_pool->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, v_pool->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, block_table->type, kTfLiteInt32);
+  TF_LITE_ENSURE_EQ(context, mask_tensor->type, kTfLiteFloat32);
+  TF_LITE_ENSURE_EQ(context, output_tensor->type, kTfLiteFloat32);
+
+  // query is (B, S, N, H), the pools are (num_blocks, block_size, N_kv, H),
+  // the block table is (B, max_blocks) and the mask is
+  // (B or 1, 1, S, max_blocks * block_size).
+  TF_LITE_ENSURE_EQ(context, NumDimensions(q_tensor), 4);
+  TF_LITE_ENSURE_EQ(context, NumDimensions(k_pool), 4);
+  TF_LITE_ENSURE_EQ(context, NumDimensions(block_table), 2);
+  TF_LITE_ENSURE_EQ(context, NumDimensions(mask_tensor), 4);
+  TF_LITE_ENSURE(context, HaveSameShapes(k_pool, v_pool));
+  const int batch_size = SizeOfDimension(q_tensor, 0);
+  const int seq_len = SizeOfDimension(q_tensor, 1);
+  const int num_heads = SizeOfDimension(q_tensor, 2);
+  const int num_kv_heads = SizeOfDimension(k_pool, 2);
+  const int max_tokens =
+      SizeOfDimension(block_table, 1) * SizeOfDimension(k_pool, 1);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(k_pool, 3),
+                    SizeOfDimension(q_tensor, 3));
+  TF_LITE_ENSURE(context, num_kv_heads > 0 && num_heads % num_kv_heads == 0);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(block_table, 0), batch_size);
+  TF_LITE_ENSURE(context, SizeOfDimension(mask_tensor, 0) == 1 ||
+                              SizeOfDimension(mask_tensor, 0) == batch_size);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(mask_tensor, 1), 1);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(mask_tensor, 2), seq_len);
+  TF_LITE_ENSURE_EQ(context, SizeOfDimension(mask_tensor, 3), max_tokens);
+
+  // Get custom op params
+  const uint8_t* buffer =
+      reinterpret_cast<const uint8_t*>(node->custom_initial_data);
+  const size_t length = node->custom_initial_data_size;
+  float scale = 0.0f;
+  if (buffer != nullptr && length > 0) {
+    auto flexbuffer_map = flexbuffers::GetRoot(buffer, length).AsMap();
+    scale = flexbuffer_map["scale"].AsFloat();
+  }
+  // If scale is not set, use 1 / sqrt(head_dim).
+  op_data->scale =
+      scale > 0.0f ? scale : 1 / sqrt(SizeOfDimension(q_tensor, 3));
+
+  // Scores of one query row against every slot the block table can address.
+  TfLiteIntArrayFree(node->temporaries);
+  node->temporaries = TfLiteIntArrayCreate(1);
+  node->temporaries->data[kScoresTempTensorIndex] =
+      op_data->scratch_tensor_index + kScoresTempTensorIndex;
+  TfLiteTensor* scores;
+  TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node,
+                                              kScoresTempTensorIndex, &scores));
+  scores->type = kTfLiteFloat32;
+  scores->allocation_type = kTfLiteArenaRw;
+  TfLiteIntArray* scores_size = TfLiteIntArrayCreate(1);
+  scores_size->data[0] = max_tokens;
+  TF_LITE_ENSURE_OK(context,
+                    context->ResizeTensor(context, scores, scores_size));
+
+  return context->ResizeTensor(context, output_tensor,
+                               TfLiteIntArrayCopy(q_tensor->dims));
+}
+
+TfLiteStatus PagedSDPAEval(TfLiteContext* context, TfLiteNode* node) {
+  /*
+  Scaled Dot Product Attention over a paged KV cache.
+  Keys and values of sequence b live in the pool blocks listed in row b of the
+  block table; slot j of the sequence is at offset j % block_size of block
+  block_table[b][j / block_size]. Slots in unassigned (negative) blocks are
+  skipped, the others are masked by the additive attention mask.
+  Query heads are mapped onto key/value heads in groups (MQA / GQA).
+  */
+  PagedSDPAOpData* op_data =
+      reinterpret_cast<PagedSDPAOpData*>(node->user_data);
+  const TfLiteTensor* q_tensor;
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kQueryTensor, &q_tensor));
+  const TfLiteTensor* k_pool;
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kKeyPoolTensor, &k_pool));
+  const TfLiteTensor* v_pool;
+  TF_LITE_ENSURE_OK(context,
+                    GetInputSafe(context, node, kValuePoolTensor, &v_pool));
+  const TfLiteTensor* block_table;
+  TF_LITE_ENSURE_OK(
+      context, GetInputSafe(context, node, kBlockTableTensor, &block_table));
+  const TfLiteTensor* mask_tensor;
+  TF_LITE_ENSURE_OK(
+      context, GetInputSafe(context, node, kAttentionMaskTensor, &mask_tensor));
+  TfLiteTensor* output_tensor;
+  TF_LITE_ENSURE_OK(
+      context, GetOutputSafe(context, node, kOutputTensor, &output_tensor));
+  TfLiteTensor* scores_tensor;
+  TF_LITE_ENSURE_OK(context, GetTemporarySafe(context, node,
+                                              kScoresTempTensorIndex,
+                                              &scores_tensor));
+
+  const int batch_size = SizeOfDimension(q_tensor, 0);
+  const int seq_len = SizeOfDimension(q_tensor, 1);
+  const int num_heads = SizeOfDimension(q_tensor, 2);
+  const int head_dim = SizeOfDimension(q_tensor, 3);
+  const int num_blocks = SizeOfDimension(k_pool, 0);
+  const int block_size = SizeOfDimension(k_pool, 1);
+  const int num_kv_heads = SizeOfDimension(k_pool, 2);
+  const int max_blocks = SizeOfDimension(block_table, 1);
+  const int max_tokens = max_blocks * block_size;
+  const int heads_per_kv_head = num_heads / num_kv_heads;
+  const bool broadcast_mask = SizeOfDimension(mask_tensor, 0) == 1;
+
+  const float* query = GetTensorData<float>(q_tensor);
+  const float* keys = GetTensorData<float>(k_pool);
+  const float* values = GetTensorData<float>(v_pool);
+  const int32_t* blocks = GetTensorData<int32_t>(block_table);
+  const float* mask = GetTensorData<float>(mask_tensor);
+  float* output = GetTensorData<float>(output_tensor);
+  float* scores = GetTensorData<float>(scores_tensor);
+
+  for (int i = 0; i < batch_size * max_blocks; ++i) {
+    TF_LITE_ENSURE(context, blocks[i] < num_blocks);
+  }
+
+  const float lowest = std::numeric_limits<float>::lowest();
+  for (int b = 0; b < batch_size; ++b) {
+    const int32_t* sequence_blocks = blocks + b * max_blocks;
+    for (int s = 0; s < seq_len; ++s) {
+      const float* mask_row =
+          mask + ((broadcast_mask ? 0 : b) * seq_len + s) * max_tokens;
+      for (int h = 0; h < num_heads; ++h) {
+        const int kv_head = h / heads_per_kv_head;
+        const float* q = query + ((b * seq_len + s) * num_heads + h) * head_dim;
+        float* out = output + ((b * seq_len + s) * num_heads + h) * head_dim;
+
+        float max_score = lowest;
+        for (int j = 0; j < max_tokens; ++j) {
+          const int32_t block = sequence_blocks[j / block_size];
+          if (block < 0) {
+            scores[j] = lowest;
+            continue;
+          }
+          const float* k =
+              keys + ((block * block_size + j % block_size) * num_kv_heads +
+                      kv_head) *
+                         head_dim;
+          float dot = 0.0f;
+          for (int d = 0; d < head_dim; ++d) {
+            dot += q[d] * k[d];
+          }
+          scores[j] = dot * op_data->scale + mask_row[j];
+          max_score = std::max(max_score, scores[j]);
+        }
+
+        std::fill(out, out + head_dim, 0.0f);
+        if (max_score == lowest) continue;
+        float sum = 0.0f;
+        for (int j = 0; j < max_tokens; ++j) {
+          if (scores[j] == lowest) continue;
+          const float weight = expf(scores[j] - max_score);
+          const int32_t block = sequence_blocks[j / block_size];
+          const float* v =
+              values + ((block * block_size + j % block_size) * num_kv_heads +
+                        kv_head) *
+                           head_dim;
+          for (int d = 0; d < head_dim; ++d) {
+            out[d] += weight * v[d];
+          }
+          sum += weight;
+        }
+        for (int d = 0; d < head_dim; ++d) {
+          out[d] /= sum;
+        }
+      }
+    }
+  }
+
+  return kTfLiteOk;
+}
+
+}  // namespace llm
+
+TfLiteRegistration* Register_PAGED_SDPA() {
+  static TfLiteRegistration r = {llm::PagedSDPAInit, llm::PagedSDPAFree,
+                                 llm::PagedSDPAPrepare, llm::PagedSDPAEval};
+  return &r;
+}
+
+}  // namespace custom
+}  // namespace ops
+}  // namespace tflite
@@ -0,0 +1,167 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/experimental/genai/speculative_decoder.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/minimal_logging.h"
+#include "tensorflow/lite/signature_runner.h"
+
+namespace tflite {
+namespace genai {
+namespace {
+
+int32_t ArgMax(const float* logits, int vocab_size) {
+  return std::max_element(logits, logits + vocab_size) - logits;
+}
+
+// Writes `values` to an int32 or int64 tensor.
+TfLiteStatus FillIndices(TfLiteTensor* tensor, const int32_t* values,
+                         int count) {
+  if (tensor->type == kTfLiteInt32) {
+    std::copy(values, values + count, tensor->data.i32);
+  } else if (tensor->type == kTfLiteInt64) {
+    std::copy(values, values + count, tensor->data.i64);
+  } else {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR, "Input %s must be int32 or int64.",
+                    tensor->name ? tensor->name : "");
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+}  // namespace
+
+int VerifyDraftTokens(const std::vector<int32_t>& draft_tokens,
+                      const float* target_logits, int vocab_size,
+                      int32_t* next_token) {
+  const int num_draft_tokens = draft_tokens.size();
+  int num_accepted = 0;
+  for (; num_accepted < num_draft_tokens; ++num_accepted) {
+    const int32_t target_token =
+        ArgMax(target_logits + num_accepted * vocab_size, vocab_size);
+    if (target_token != draft_tokens[num_accepted]) {
+      *next_token = target_token;
+      return num_accepted;
+    }
+  }
+  *next_token = ArgMax(target_logits + num_accepted * vocab_size, vocab_size);
+  return num_accepted;
+}
+
+SpeculativeDecoder::SpeculativeDecoder(SignatureRunner* draft,
+                                       SignatureRunner* target,
+                                       const Options& options)
+    : draft_(draft), target_(target), options_(options) {}
+
+TfLiteStatus SpeculativeDecoder::Step(int32_t token, int position,
+                                      std::vector<int32_t>* tokens) {
+  const int num_draft_tokens = std::max(options_.num_draft_tokens, 1);
+  const float* logits;
+  int vocab_size;
+
+  // Every draft token is the input of the next draft invocation, so
+  // draft_tokens[i] ends up in the draft cache at position + i + 1.
+  std::vector<int32_t> verify_tokens(num_draft_tokens + 1);
+  verify_tokens[0] = token;
+  for (int i = 0; i < num_draft_tokens; ++i) {
+    TF_LITE_ENSURE_STATUS(Run(draft_, &verify_tokens[i], 1, position + i,
+                              &logits, &vocab_size));
+    verify_tokens[i + 1] = ArgMax(logits, vocab_size);
+  }
+  const std::vector<int32_t> draft_tokens(verify_tokens.begin() + 1,
+                                          verify_tokens.end());
+
+  TF_LITE_ENSURE_STATUS(Run(target_, verify_tokens.data(),
+                            verify_tokens.size(), position, &logits,
+                            &vocab_size));
+  int32_t next_token;
+  const int num_accepted =
+      VerifyDraftTokens(draft_tokens, logits, vocab_size, &next_token);
+
+  // When every draft token is accepted, the last one has not been written to
+  // the draft cache yet, but the next step attends to it.
+  if (num_accepted == num_draft_tokens) {
+    TF_LITE_ENSURE_STATUS(Run(draft_, &draft_tokens.back(), 1,
+                              position + num_draft_tokens, &logits,
+                              &vocab_size));
+  }
+
+  tokens->insert(tokens->end(), draft_tokens.begin(),
+                 draft_tokens.begin() + num_accepted);
+  tokens->push_back(next_token);
+  return kTfLiteOk;
+}
+
+TfLiteStatus SpeculativeDecoder::Run(SignatureRunner* runner,
+                                     const int32_t* tokens, int num_tokens,
+                                     int position, const float** logits,
+                                     int* vocab_size) {
+  const char* tokens_name = options_.tokens_input.c_str();
+  const char* positions_name = options_.positions_input.c_str();
+  TfLiteTensor* tokens_tensor = runner->input_tensor(tokens_name);
+  TfLiteTensor* positions_tensor = runner->input_tensor(positions_name);
+  if (tokens_tensor == nullptr || positions_tensor == nullptr) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                    "Signature %s has no %s or %s input.",
+                    runner->signature_key().c_str(), tokens_name,
+                    positions_name);
+    return kTfLiteError;
+  }
+  if (NumElements(tokens_tensor) != num_tokens ||
+      NumElements(positions_tensor) != num_tokens) {
+    TF_LITE_ENSURE_STATUS(
+        runner->ResizeInputTensor(tokens_name, {1, num_tokens}));
+    TF_LITE_ENSURE_STATUS(
+        runner->ResizeInputTensor(positions_name, {num_tokens}));
+    TF_LITE_ENSURE_STATUS(runner->AllocateTensors());
+    tokens_tensor = runner->input_tensor(tokens_name);
+    positions_tensor = runner->input_tensor(positions_name);
+  }
+
+  std::vector<int32_t> positions(num_tokens);
+  for (int i = 0; i < num_tokens; ++i) {
+    positions[i] = position + i;
+  }
+  TF_LITE_ENSURE_STATUS(FillIndices(tokens_tensor, tokens, num_tokens));
+  TF_LITE_ENSURE_STATUS(
+      FillIndices(positions_tensor, positions.data(), num_tokens));
+  TF_LITE_ENSURE_STATUS(runner->Invoke());
+
+  const TfLiteTensor* logits_tensor =
+      runner->output_tensor(options_.logits_output.c_str());
+  if (logits_tensor == nullptr || logits_tensor->type != kTfLiteFloat32 ||
+      NumDimensions(logits_tensor) < 1 ||
+      NumElements(logits_tensor) !=
+          num_tokens * SizeOfDimension(logits_tensor,
+                                       NumDimensions(logits_tensor) - 1)) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                    "Signature %s must output float32 logits for %d tokens.",
+                    runner->signature_key().c_str(), num_tokens);
+    return kTfLiteError;
+  }
+  *vocab_size =
+      SizeOfDimension(logits_tensor, NumDimensions(logits_tensor) - 1);
+  *logits = logits_tensor->data.f;
+  return kTfLiteOk;
+}
+
+}  // namespace genai
+}  // namespace tflite
@@ -0,0 +1,91 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_EXPERIMENTAL_GENAI_SPECULATIVE_DECODER_H_
+#define TENSORFLOW_LITE_EXPERIMENTAL_GENAI_SPECULATIVE_DECODER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/signature_runner.h"
+
+namespace tflite {
+namespace genai {
+
+// Greedily verifies `draft_tokens` against the logits the target model
+// produced for them. `target_logits` holds draft_tokens.size() + 1 rows of
+// `vocab_size` logits; row i scores the token following the first i draft
+// tokens. Returns the number of draft tokens that match the target's argmax
+// and writes the target's own token at the first mismatch (or after the last
+// draft token, if they all match) to `next_token`.
+int VerifyDraftTokens(const std::vector<int32_t>& draft_tokens,
+                      const float* target_logits, int vocab_size,
+                      int32_t* next_token);
+
+// Speculative decoding with two decode signatures: a cheap draft model
+// proposes `num_draft_tokens` tokens one at a time and the target model scores
+// all of them in a single batched invocation. Every step emits between 1 and
+// num_draft_tokens + 1 tokens, exactly the ones greedy decoding of the target
+// alone would produce.
+//
+// Both signatures take `tokens` (1, S) and `positions` (S) and produce
+// `logits` (1, S, vocab_size); token and position inputs may be int32 or int64.
+// The draft signature is invoked with S = 1 and the target signature with
+// S = num_draft_tokens + 1; inputs are resized when their shape differs.
+//
+// The KV caches of both models must be the ones maintained by the genai cache
+// ops, which treat a write at an already filled position as an overwrite. That
+// is what rolls back rejected tokens: the next step writes its own tokens over
+// them. Callers using a PagedKVCacheManager should truncate the sequence to
+// the accepted length instead.
+//
+// The prompt has to be prefilled in both models beforehand. This class is not
+// thread-safe.
+class SpeculativeDecoder {
+ public:
+  struct Options {
+    int num_draft_tokens = 4;
+    std::string tokens_input = "tokens";
+    std::string positions_input = "input_pos";
+    std::string logits_output = "logits";
+  };
+
+  // `draft` and `target` must outlive this object.
+  SpeculativeDecoder(SignatureRunner* draft, SignatureRunner* target,
+                     const Options& options);
+
+  // Runs one step given the last emitted `token`, which is at `position`, and
+  // appends the newly emitted tokens to `tokens`. The next step continues from
+  // tokens->back() at `position` plus the number of appended tokens.
+  TfLiteStatus Step(int32_t token, int position, std::vector<int32_t>* tokens);
+
+ private:
+  // Feeds `num_tokens` tokens starting at `position` to `runner`, invokes it
+  // and returns its logits.
+  TfLiteStatus Run(SignatureRunner* runner, const int32_t* tokens,
+                   int num_tokens, int position, const float** logits,
+                   int* vocab_size);
+
+  SignatureRunner* const draft_;
+  SignatureRunner* const target_;
+  const Options options_;
+};
+
+}  // namespace genai
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_EXPERIMENTAL_GENAI_SPECULATIVE_DECODER_H_
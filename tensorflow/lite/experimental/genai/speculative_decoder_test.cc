@@ -0,0 +1,60 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/experimental/genai/speculative_decoder.h"
+
+#include <cstdint>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace genai {
+namespace {
+
+// Logits over a vocabulary of 4 whose argmax rows are `tokens`.
+std::vector<float> OneHotLogits(const std::vector<int32_t>& tokens) {
+  std::vector<float> logits(tokens.size() * 4, 0.0f);
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    logits[i * 4 + tokens[i]] = 1.0f;
+  }
+  return logits;
+}
+
+TEST(VerifyDraftTokensTest, AcceptsAllMatchingTokens) {
+  const std::vector<float> logits = OneHotLogits({2, 1, 3});
+  int32_t next_token = -1;
+  EXPECT_EQ(VerifyDraftTokens({2, 1}, logits.data(), 4, &next_token), 2);
+  // The target's prediction after the last draft token comes for free.
+  EXPECT_EQ(next_token, 3);
+}
+
+TEST(VerifyDraftTokensTest, StopsAtFirstMismatch) {
+  const std::vector<float> logits = OneHotLogits({2, 0, 3, 1});
+  int32_t next_token = -1;
+  EXPECT_EQ(VerifyDraftTokens({2, 1, 3}, logits.data(), 4, &next_token), 1);
+  EXPECT_EQ(next_token, 0);
+}
+
+TEST(VerifyDraftTokensTest, RejectsFirstToken) {
+  const std::vector<float> logits = OneHotLogits({1, 1});
+  int32_t next_token = -1;
+  EXPECT_EQ(VerifyDraftTokens({0}, logits.data(), 4, &next_token), 0);
+  EXPECT_EQ(next_token, 1);
+}
+
+}  // namespace
+}  // namespace genai
+}  // namespace tflite
@@ -70,6 +70,12 @@ class GraphInfo {
 
   // Returns the indices of the variable tensors.
   virtual const std::vector<int>& variables() const = 0;
+
+  // Returns the execution-plan indices of the first and the last node of the
+  // group of consecutive nodes that may run concurrently with the node at
+  // `index`. By default nodes run one at a time, in execution order.
+  virtual size_t first_concurrent_node(size_t index) const { return index; }
+  virtual size_t last_concurrent_node(size_t index) const { return index; }
 };
 
 // Represents a subset of nodes in a TensorFlow Lite graph.
@@ -103,12 +103,83 @@ class InterpreterOptions {
     return experimental_cache_constant_cast_op_;
   }
 
+  /// Sets the number of threads used to run independent nodes of a subgraph
+  /// concurrently. The execution plan is reordered into levels of its
+  /// dependency graph, and the nodes of each level run in parallel. Values
+  /// <= 1 keep the default, strictly sequential execution. Subgraphs with
+  /// delegates or dynamic tensors, and invocations with a profiler, still run
+  /// sequentially. Each node may additionally use the intra-op threads set by
+  /// `Interpreter::SetNumThreads`.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetInterOpNumThreads(int num_threads) {
+    experimental_inter_op_num_threads_ = num_threads;
+  }
+
+  /// Returns the number of threads used to run independent nodes concurrently.
+  /// WARNING: This is an experimental API and subject to change.
+  int GetInterOpNumThreads() const {
+    return experimental_inter_op_num_threads_;
+  }
+
+  /// If set to `true`, `Invoke` skips the nodes none of whose inputs changed
+  /// since they last ran, e.g. the static conditioning branch of a streaming
+  /// model. The contents of the subgraph inputs are compared with those of the
+  /// previous invocation; intermediate tensors change when the node writing
+  /// them runs. Nodes with side effects or state, e.g. variable, resource or
+  /// control flow ops, custom ops, random ops and delegate kernels, always
+  /// run.
+  ///
+  /// To keep the outputs of skipped nodes valid, intermediate tensors no
+  /// longer share arena memory, as with `SetPreserveAllTensors`. Independent
+  /// nodes run sequentially, and nodes are never skipped when dynamic tensors
+  /// are released.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetSkipUnchangedNodes(bool value = true) {
+    experimental_skip_unchanged_nodes_ = value;
+  }
+
+  /// Returns whether nodes whose inputs didn't change are skipped.
+  /// WARNING: This is an experimental API and subject to change.
+  bool GetSkipUnchangedNodes() const {
+    return experimental_skip_unchanged_nodes_;
+  }
+
+  /// If set to `true`, the primary subgraph is split into pipeline stages at
+  /// the boundaries between its delegate partitions and runs of CPU nodes, and
+  /// each `Invoke` runs all stages concurrently on consecutive inputs: stage
+  /// `i` processes the inputs given `i` invocations earlier. The outputs after
+  /// an invocation are thus those of the inputs given
+  /// `Subgraph::num_pipeline_stages() - 1` invocations earlier, and undefined
+  /// for the first ones. This raises the throughput of e.g. camera pipelines
+  /// when partitions run on different accelerators or the CPU.
+  ///
+  /// Tensors passed between stages are delayed by copies made between
+  /// invocations. A partition can only be pipelined with the next one if one
+  /// of them runs on the CPU without a delegate; otherwise they form a single
+  /// stage. Subgraphs with dynamic tensors, control flow or resource
+  /// variables aren't pipelined. Delegates must support being invoked from
+  /// any thread. Intermediate tensors don't share arena memory.
+  /// WARNING: This is an experimental API and subject to change.
+  void SetPipelinePartitions(bool value = true) {
+    experimental_pipeline_partitions_ = value;
+  }
+
+  /// Returns whether delegate partitions of consecutive invocations run
+  /// concurrently.
+  /// WARNING: This is an experimental API and subject to change.
+  bool GetPipelinePartitions() const {
+    return experimental_pipeline_partitions_;
+  }
+
  private:
   bool experimental_preserve_all_tensors_ = false;
   bool experimental_ensure_dynamic_tensors_are_released_ = false;
   int experimental_optimize_memory_for_large_tensors_ = 0;
   bool experimental_disable_delegate_clustering_ = false;
   bool experimental_cache_constant_cast_op_ = false;
+  int experimental_inter_op_num_threads_ = 0;
+  bool experimental_skip_unchanged_nodes_ = false;
+  bool experimental_pipeline_partitions_ = false;
 };
 
 }  // namespace tflite
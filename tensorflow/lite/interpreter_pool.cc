@@ -0,0 +1,208 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/interpreter_pool.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/core/interpreter_builder.h"
+#include "tensorflow/lite/minimal_logging.h"
+#include "tensorflow/lite/util.h"
+
+namespace tflite {
+namespace {
+
+bool HasInputShapes(const Interpreter& interpreter,
+                    const std::vector<std::vector<int>>& input_shapes) {
+  if (interpreter.inputs().size() != input_shapes.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < input_shapes.size(); ++i) {
+    const TfLiteTensor* input = interpreter.input_tensor(i);
+    if (!EqualArrayAndTfLiteIntArray(input->dims, input_shapes[i].size(),
+                                     input_shapes[i].data())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+TfLiteStatus ResizeInputs(Interpreter* interpreter,
+                          const std::vector<std::vector<int>>& input_shapes) {
+  if (interpreter->inputs().size() != input_shapes.size()) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                    "InterpreterPool got %d input shapes for %d inputs.",
+                    static_cast<int>(input_shapes.size()),
+                    static_cast<int>(interpreter->inputs().size()));
+    return kTfLiteError;
+  }
+  for (size_t i = 0; i < input_shapes.size(); ++i) {
+    TF_LITE_ENSURE_STATUS(interpreter->ResizeInputTensor(
+        interpreter->inputs()[i], input_shapes[i]));
+  }
+  return interpreter->AllocateTensors();
+}
+
+}  // namespace
+
+InterpreterPool::Lease::Lease(Lease&& other) noexcept
+    : pool_(other.pool_), interpreter_(std::move(other.interpreter_)) {
+  other.pool_ = nullptr;
+}
+
+InterpreterPool::Lease& InterpreterPool::Lease::operator=(
+    Lease&& other) noexcept {
+  if (this != &other) {
+    Release();
+    pool_ = other.pool_;
+    interpreter_ = std::move(other.interpreter_);
+    other.pool_ = nullptr;
+  }
+  return *this;
+}
+
+InterpreterPool::Lease::~Lease() { Release(); }
+
+void InterpreterPool::Lease::Release() {
+  if (pool_ != nullptr && interpreter_ != nullptr) {
+    pool_->Return(std::move(interpreter_));
+  }
+  pool_ = nullptr;
+}
+
+InterpreterPool::InterpreterPool(const FlatBufferModel& model,
+                                 const OpResolver& op_resolver,
+                                 const Options& options)
+    : model_(model), op_resolver_(op_resolver), options_(options) {}
+
+InterpreterPool::~InterpreterPool() {
+  std::lock_guard<std::mutex> lock(mu_);
+  if (static_cast<int>(idle_.size()) != num_contexts_) {
+    TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                    "InterpreterPool destroyed with %d leased contexts.",
+                    num_contexts_ - static_cast<int>(idle_.size()));
+  }
+}
+
+InterpreterPool::Lease InterpreterPool::Acquire() {
+  {
+    std::unique_lock<std::mutex> lock(mu_);
+    idle_cv_.wait(lock, [this] {
+      return !idle_.empty() || num_contexts_ < options_.max_contexts;
+    });
+    if (!idle_.empty()) {
+      std::unique_ptr<Interpreter> interpreter = std::move(idle_.back());
+      idle_.pop_back();
+      return Lease(this, std::move(interpreter));
+    }
+    // Reserve the slot so that other callers wait for this context instead of
+    // building one beyond `max_contexts`.
+    ++num_contexts_;
+  }
+
+  std::unique_ptr<Interpreter> interpreter;
+  if (BuildContext(&interpreter) != kTfLiteOk) {
+    Discard(nullptr);
+    return Lease();
+  }
+  return Lease(this, std::move(interpreter));
+}
+
+InterpreterPool::Lease InterpreterPool::Acquire(
+    const std::vector<std::vector<int>>& input_shapes) {
+  std::unique_ptr<Interpreter> interpreter;
+  {
+    std::unique_lock<std::mutex> lock(mu_);
+    idle_cv_.wait(lock, [this] {
+      return !idle_.empty() || num_contexts_ < options_.max_contexts;
+    });
+    auto prepared = std::find_if(
+        idle_.rbegin(), idle_.rend(),
+        [&input_shapes](const std::unique_ptr<Interpreter>& idle) {
+          return HasInputShapes(*idle, input_shapes);
+        });
+    if (prepared != idle_.rend()) {
+      interpreter = std::move(*prepared);
+      idle_.erase(std::next(prepared).base());
+    } else if (num_contexts_ < options_.max_contexts) {
+      ++num_contexts_;
+    } else {
+      interpreter = std::move(idle_.front());
+      idle_.erase(idle_.begin());
+    }
+  }
+
+  if (interpreter == nullptr && BuildContext(&interpreter) != kTfLiteOk) {
+    Discard(nullptr);
+    return Lease();
+  }
+  if (!HasInputShapes(*interpreter, input_shapes) &&
+      ResizeInputs(interpreter.get(), input_shapes) != kTfLiteOk) {
+    Discard(std::move(interpreter));
+    return Lease();
+  }
+  return Lease(this, std::move(interpreter));
+}
+
+int InterpreterPool::num_contexts() const {
+  std::lock_guard<std::mutex> lock(mu_);
+  return num_contexts_;
+}
+
+TfLiteStatus InterpreterPool::BuildContext(
+    std::unique_ptr<Interpreter>* interpreter) {
+  std::lock_guard<std::mutex> lock(build_mu_);
+  InterpreterBuilder builder(model_, op_resolver_,
+                             &options_.interpreter_options);
+  TF_LITE_ENSURE_STATUS(builder.SetNumThreads(options_.num_threads));
+  std::unique_ptr<Interpreter> result;
+  TF_LITE_ENSURE_STATUS(builder(&result));
+  for (const DelegateFactory& factory : options_.delegate_factories) {
+    Interpreter::TfLiteDelegatePtr delegate = factory();
+    if (delegate == nullptr) {
+      TFLITE_LOG_PROD(TFLITE_LOG_ERROR,
+                      "InterpreterPool delegate factory returned null.");
+      return kTfLiteError;
+    }
+    TF_LITE_ENSURE_STATUS(result->ModifyGraphWithDelegate(std::move(delegate)));
+  }
+  TF_LITE_ENSURE_STATUS(result->AllocateTensors());
+  *interpreter = std::move(result);
+  return kTfLiteOk;
+}
+
+void InterpreterPool::Return(std::unique_ptr<Interpreter> interpreter) {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    idle_.push_back(std::move(interpreter));
+  }
+  idle_cv_.notify_one();
+}
+
+void InterpreterPool::Discard(std::unique_ptr<Interpreter> interpreter) {
+  interpreter.reset();
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    --num_contexts_;
+  }
+  idle_cv_.notify_one();
+}
+
+}  // namespace tflite
@@ -0,0 +1,141 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_INTERPRETER_POOL_H_
+#define TENSORFLOW_LITE_INTERPRETER_POOL_H_
+
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/core/model_builder.h"
+#include "tensorflow/lite/interpreter_options.h"
+#include "tensorflow/lite/op_resolver.h"
+
+namespace tflite {
+
+/// Shares one model between a bounded set of interpreters ("execution
+/// contexts") so that the same model can be invoked from many threads at once.
+///
+/// An Interpreter is not re-entrant, so each concurrent request needs a
+/// context of its own. Contexts created by the pool never copy the constant
+/// tensors of the model: they all read them from the buffer owned by the
+/// FlatBufferModel. What each context owns is its activation arena, the state
+/// of its kernels and its delegate instances.
+///
+/// Delegates that repack weights should be given a cache shared by every
+/// context through `Options::delegate_factories`, e.g. by pointing all
+/// XNNPACK delegates at the same `TfLiteXNNPackDelegateOptions::weights_cache`
+/// or `weight_cache_file_path`. Contexts are created one at a time, so the
+/// first context builds the cache and the others load it.
+///
+/// `model` and `op_resolver` must outlive the pool. Use
+/// `ops::builtin::BuiltinOpResolverWithoutDefaultDelegates` when delegates are
+/// provided through `delegate_factories`, otherwise every context also gets
+/// its own default delegate.
+///
+/// WARNING: This is an experimental API and subject to change.
+class InterpreterPool {
+ public:
+  using DelegateFactory = std::function<Interpreter::TfLiteDelegatePtr()>;
+
+  struct Options {
+    // Maximum number of contexts alive at once. Acquire() blocks when all of
+    // them are leased.
+    int max_contexts = 1;
+    // Number of CPU threads given to each context.
+    int num_threads = 1;
+    // Options forwarded to the InterpreterBuilder of each context.
+    InterpreterOptions interpreter_options;
+    // Optional. Called once per context to create the delegates applied to
+    // it; the context takes ownership of them.
+    std::vector<DelegateFactory> delegate_factories;
+  };
+
+  /// Exclusive use of one context. The context goes back to the pool when the
+  /// lease is destroyed.
+  class Lease {
+   public:
+    Lease() = default;
+    Lease(Lease&& other) noexcept;
+    Lease& operator=(Lease&& other) noexcept;
+    ~Lease();
+
+    Interpreter* get() const { return interpreter_.get(); }
+    Interpreter* operator->() const { return interpreter_.get(); }
+    explicit operator bool() const { return interpreter_ != nullptr; }
+
+   private:
+    friend class InterpreterPool;
+    Lease(InterpreterPool* pool, std::unique_ptr<Interpreter> interpreter)
+        : pool_(pool), interpreter_(std::move(interpreter)) {}
+    void Release();
+
+    InterpreterPool* pool_ = nullptr;
+    std::unique_ptr<Interpreter> interpreter_;
+  };
+
+  InterpreterPool(const FlatBufferModel& model, const OpResolver& op_resolver,
+                  const Options& options);
+  InterpreterPool(const InterpreterPool&) = delete;
+  InterpreterPool& operator=(const InterpreterPool&) = delete;
+
+  /// All leases must have been released before the pool is destroyed.
+  ~InterpreterPool();
+
+  /// Returns a context with its tensors allocated, creating it if fewer than
+  /// `max_contexts` exist and none is idle, and otherwise blocking until one
+  /// is released. Returns an empty lease if the context could not be built.
+  Lease Acquire();
+
+  /// Same as Acquire(), but the context's inputs have `input_shapes`, one
+  /// entry per model input. Idle contexts keep the shapes they were last
+  /// prepared for, so one already prepared for `input_shapes` is preferred.
+  /// Otherwise a new context is created or, once `max_contexts` exist, the
+  /// least recently used idle context is resized and prepared again. Models
+  /// served with a few recurring input shapes thus switch between prepared
+  /// contexts instead of re-running Prepare on every shape change.
+  Lease Acquire(const std::vector<std::vector<int>>& input_shapes);
+
+  /// Number of contexts created so far, leased or idle.
+  int num_contexts() const;
+
+ private:
+  TfLiteStatus BuildContext(std::unique_ptr<Interpreter>* interpreter);
+  void Return(std::unique_ptr<Interpreter> interpreter);
+  // Gives up on a context that could not be prepared, freeing its slot.
+  void Discard(std::unique_ptr<Interpreter> interpreter);
+
+  const FlatBufferModel& model_;
+  const OpResolver& op_resolver_;
+  const Options options_;
+
+  // Serializes context creation so that delegates sharing a weight cache
+  // build it once instead of racing on it.
+  std::mutex build_mu_;
+
+  mutable std::mutex mu_;
+  std::condition_variable idle_cv_;
+  // Idle contexts, least recently released first.
+  std::vector<std::unique_ptr<Interpreter>> idle_;
+  int num_contexts_ = 0;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_INTERPRETER_POOL_H_
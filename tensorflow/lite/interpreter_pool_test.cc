@@ -0,0 +1,192 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/interpreter_pool.h"
+
+#include <algorithm>
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/core/interpreter.h"
+#include "tensorflow/lite/core/kernels/register.h"
+#include "tensorflow/lite/core/model_builder.h"
+
+namespace tflite {
+namespace {
+
+// testdata/add.bin computes output = input + input + input.
+constexpr char kAddModel[] = "tensorflow/lite/testdata/add.bin";
+
+void InvokeAndCheck(Interpreter* interpreter, float value) {
+  TfLiteTensor* input = interpreter->input_tensor(0);
+  ASSERT_EQ(input->type, kTfLiteFloat32);
+  const int num_elements = input->bytes / sizeof(float);
+  std::fill_n(interpreter->typed_input_tensor<float>(0), num_elements, value);
+  ASSERT_EQ(interpreter->Invoke(), kTfLiteOk);
+  const float* output = interpreter->typed_output_tensor<float>(0);
+  for (int i = 0; i < num_elements; ++i) {
+    ASSERT_EQ(output[i], 3 * value);
+  }
+}
+
+TEST(InterpreterPoolTest, ReusesReleasedContexts) {
+  auto model = FlatBufferModel::BuildFromFile(kAddModel);
+  ASSERT_TRUE(model);
+  ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+  InterpreterPool::Options options;
+  options.max_contexts = 2;
+  InterpreterPool pool(*model, resolver, options);
+
+  Interpreter* first = nullptr;
+  {
+    InterpreterPool::Lease lease = pool.Acquire();
+    ASSERT_TRUE(lease);
+    first = lease.get();
+    InvokeAndCheck(lease.get(), 1.0f);
+  }
+  InterpreterPool::Lease lease = pool.Acquire();
+  ASSERT_TRUE(lease);
+  EXPECT_EQ(lease.get(), first);
+  EXPECT_EQ(pool.num_contexts(), 1);
+
+  InterpreterPool::Lease other = pool.Acquire();
+  ASSERT_TRUE(other);
+  EXPECT_NE(other.get(), first);
+  EXPECT_EQ(pool.num_contexts(), 2);
+}
+
+TEST(InterpreterPoolTest, SharesConstantBuffersBetweenContexts) {
+  auto model = FlatBufferModel::BuildFromFile(kAddModel);
+  ASSERT_TRUE(model);
+  ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+  InterpreterPool::Options options;
+  options.max_contexts = 2;
+  InterpreterPool pool(*model, resolver, options);
+
+  InterpreterPool::Lease a = pool.Acquire();
+  InterpreterPool::Lease b = pool.Acquire();
+  ASSERT_TRUE(a);
+  ASSERT_TRUE(b);
+  // Activations are private to each context.
+  EXPECT_NE(a->input_tensor(0)->data.raw, b->input_tensor(0)->data.raw);
+  EXPECT_NE(a->output_tensor(0)->data.raw, b->output_tensor(0)->data.raw);
+}
+
+TEST(InterpreterPoolTest, InvokesConcurrentlyWithinTheContextLimit) {
+  auto model = FlatBufferModel::BuildFromFile(kAddModel);
+  ASSERT_TRUE(model);
+  ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+  InterpreterPool::Options options;
+  options.max_contexts = 3;
+  InterpreterPool pool(*model, resolver, options);
+
+  constexpr int kNumThreads = 8;
+  constexpr int kNumInvocations = 20;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&pool, t] {
+      for (int i = 0; i < kNumInvocations; ++i) {
+        InterpreterPool::Lease lease = pool.Acquire();
+        ASSERT_TRUE(lease);
+        InvokeAndCheck(lease.get(), static_cast<float>(t * 100 + i));
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  EXPECT_LE(pool.num_contexts(), options.max_contexts);
+}
+
+TEST(InterpreterPoolTest, KeepsContextsPreparedForRecentShapes) {
+  auto model = FlatBufferModel::BuildFromFile(kAddModel);
+  ASSERT_TRUE(model);
+  ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+  InterpreterPool::Options options;
+  options.max_contexts = 2;
+  InterpreterPool pool(*model, resolver, options);
+  const std::vector<std::vector<int>> short_input = {{1, 8, 8, 3}};
+  const std::vector<std::vector<int>> long_input = {{4, 8, 8, 3}};
+  const std::vector<std::vector<int>> longer_input = {{9, 8, 8, 3}};
+
+  Interpreter* short_context = pool.Acquire(short_input).get();
+  Interpreter* long_context = nullptr;
+  {
+    InterpreterPool::Lease lease = pool.Acquire(long_input);
+    ASSERT_TRUE(lease);
+    long_context = lease.get();
+    EXPECT_EQ(lease->input_tensor(0)->dims->data[0], 4);
+    InvokeAndCheck(lease.get(), 1.0f);
+  }
+  EXPECT_NE(long_context, short_context);
+  EXPECT_EQ(pool.num_contexts(), 2);
+
+  // Each shape goes back to the context already prepared for it.
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(pool.Acquire(short_input).get(), short_context);
+    EXPECT_EQ(pool.Acquire(long_input).get(), long_context);
+  }
+
+  // A new shape re-prepares the least recently used context.
+  InterpreterPool::Lease lease = pool.Acquire(longer_input);
+  ASSERT_TRUE(lease);
+  EXPECT_EQ(lease.get(), short_context);
+  EXPECT_EQ(lease->input_tensor(0)->dims->data[0], 9);
+  InvokeAndCheck(lease.get(), 2.0f);
+  EXPECT_EQ(pool.num_contexts(), 2);
+}
+
+TEST(InterpreterPoolTest, RejectsWrongNumberOfInputShapes) {
+  auto model = FlatBufferModel::BuildFromFile(kAddModel);
+  ASSERT_TRUE(model);
+  ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+  InterpreterPool::Options options;
+  InterpreterPool pool(*model, resolver, options);
+
+  EXPECT_FALSE(pool.Acquire({{1, 8, 8, 3}, {1, 8, 8, 3}}));
+  EXPECT_EQ(pool.num_contexts(), 0);
+  EXPECT_TRUE(pool.Acquire({{1, 8, 8, 3}}));
+}
+
+TEST(InterpreterPoolTest, AppliesDelegateFactoryToEachContext) {
+  auto model = FlatBufferModel::BuildFromFile(kAddModel);
+  ASSERT_TRUE(model);
+  ops::builtin::BuiltinOpResolverWithoutDefaultDelegates resolver;
+  InterpreterPool::Options options;
+  options.max_contexts = 2;
+  int num_delegates = 0;
+  options.delegate_factories.push_back([&num_delegates] {
+    ++num_delegates;
+    auto* delegate = new TfLiteDelegate(TfLiteDelegateCreate());
+    delegate->Prepare = [](TfLiteContext*, TfLiteDelegate*) -> TfLiteStatus {
+      return kTfLiteOk;
+    };
+    return Interpreter::TfLiteDelegatePtr(
+        delegate, [](TfLiteDelegate* delegate) { delete delegate; });
+  });
+  InterpreterPool pool(*model, resolver, options);
+
+  InterpreterPool::Lease a = pool.Acquire();
+  InterpreterPool::Lease b = pool.Acquire();
+  ASSERT_TRUE(a);
+  ASSERT_TRUE(b);
+  EXPECT_EQ(num_delegates, 2);
+  InvokeAndCheck(a.get(), 2.0f);
+}
+
+}  // namespace
+}  // namespace tflite
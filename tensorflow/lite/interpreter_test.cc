@@ -1923,6 +1923,46 @@ TEST_F(TestCustomAllocation, CustomInputAlloc_MultipleAssigns) {
   VerifyInvoke();
 }
 
+TEST_F(TestCustomAllocation, BindBuffersBeforeEveryInvoke) {
+  ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  std::vector<float> variable = {0.0f, 1.0f, 2.0f};
+  memcpy(interpreter_->typed_tensor<float>(interpreter_->variables()[0]),
+         variable.data(), 3 * sizeof(float));
+  memset(interpreter_->typed_tensor<float>(0), 0, 3 * sizeof(float));
+
+  // Feed consecutive, unaligned windows of a ring buffer to input 1 and
+  // collect output 0 (input 1 doubled) in a caller-owned buffer.
+  std::vector<float> ring = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f};
+  auto output_alloc =
+      NewCustomAlloc(3 * sizeof(float), kDefaultTensorAlignment);
+  ASSERT_EQ(interpreter_->BindCustomAllocationForTensor(
+                interpreter_->outputs()[0], output_alloc),
+            kTfLiteOk);
+  for (int offset = 0; offset < 4; ++offset) {
+    TfLiteCustomAllocation window{ring.data() + offset, 3 * sizeof(float)};
+    ASSERT_EQ(interpreter_->BindCustomAllocationForTensor(
+                  interpreter_->inputs()[1], window,
+                  kTfLiteCustomAllocationFlagsSkipAlignCheck),
+              kTfLiteOk);
+    ASSERT_EQ(interpreter_->Invoke(), kTfLiteOk);
+    const float* output = static_cast<const float*>(output_alloc.data);
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_EQ(output[i], 2 * ring[offset + i]) << offset << ", " << i;
+    }
+  }
+}
+
+TEST_F(TestCustomAllocation, BindRejectsInsufficientBytes) {
+  ASSERT_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  auto input_alloc = NewCustomAlloc(4, kDefaultTensorAlignment);
+
+  // The binding is validated right away and the arena buffer stays in use.
+  ASSERT_EQ(interpreter_->BindCustomAllocationForTensor(
+                interpreter_->inputs()[0], input_alloc),
+            kTfLiteError);
+  VerifyInvoke();
+}
+
 TEST_F(TestCustomAllocation, CustomInputAlloc_AllocateTensorsBefore) {
   // Allocate tensors.
   // Allocating now will cause TFLite to reserve some extra memory, but nothing
@@ -33,6 +33,8 @@ limitations under the License.
 
 namespace tflite {
 
+class PackedWeightCache;
+
 class CpuBackendContext final : public TfLiteInternalBackendContext {
  public:
   static CpuBackendContext* GetFromContext(TfLiteContext* context);
@@ -56,6 +58,16 @@ class CpuBackendContext final : public TfLiteInternalBackendContext {
 
   bool use_caching() const { return use_caching_; }
 
+  // Lets kernels store the constant weights they repack in a persistent
+  // cache instead of repacking them into memory on every load. Doesn't take
+  // ownership; the cache must outlive the interpreters using this context.
+  void SetPackedWeightCache(PackedWeightCache* cache) {
+    packed_weight_cache_ = cache;
+  }
+  PackedWeightCache* packed_weight_cache() const {
+    return packed_weight_cache_;
+  }
+
 #ifdef TFLITE_KERNEL_USE_XNNPACK
   pthreadpool_t get_xnnpack_threadpool();
 #endif
@@ -122,6 +134,8 @@ class CpuBackendContext final : public TfLiteInternalBackendContext {
   // (currently the Ruy library only).
   bool use_caching_;
 
+  PackedWeightCache* packed_weight_cache_ = nullptr;
+
 #ifdef TFLITE_KERNEL_USE_XNNPACK
   // A smart pointer for the xnnpack threadpool. Is created by a call from the
   // interpreter, and then consumed by xnnpack, possibly via a TFLite kernel.
@@ -36,6 +36,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/internal/tensor_utils.h"
 #include "tensorflow/lite/kernels/internal/types.h"
 #include "tensorflow/lite/kernels/kernel_util.h"
+#include "tensorflow/lite/kernels/packed_weight_cache.h"
 #include "tensorflow/lite/minimal_logging.h"
 
 #ifdef TFLITE_HAVE_CPUINFO
@@ -159,6 +160,10 @@ struct OpData {
   bool ledger_initialized;
   // Used for 4bit hybrid
   std::unique_ptr<optimized_4bit::OpData4Bit> op_data_4bit = nullptr;
+  // Used for int8 inputs with a constant, dense int4 filter that is multiplied
+  // in its packed form instead of being unpacked on every invocation.
+  bool use_int4_filter_kernel = false;
+  std::vector<int32_t> int4_filter_row_sums;
   TfLiteType quantized_bias_type = kTfLiteNoType;
 };
 
@@ -174,6 +179,20 @@ constexpr int kScalingFactorsTensor = 1;
 constexpr int kAccumulatorTensor = 2;
 constexpr int kInputOffsetsTensor = 3;
 
+// Batches up to this size are bound by reading the filter, so int4 filters are
+// consumed packed by a matrix-vector kernel rather than unpacked for a GEMM.
+constexpr int kMaxBatchSizeForInt4FilterKernel = 4;
+
+// Names the layout of 4bit filters prepacked by the optimized_4bit backend
+// this is built with, for PackedWeightCache keys.
+#if defined(FC_4BIT_SSE) && defined(__SSSE3__)
+constexpr char kPacked4BitFilterTag[] = "fully_connected_4bit_sse_v1";
+#elif defined(FC_4BIT_NEON) && (defined(__ARM_NEON__) || defined(__ARM_NEON))
+constexpr char kPacked4BitFilterTag[] = "fully_connected_4bit_neon_v1";
+#else
+constexpr char kPacked4BitFilterTag[] = "fully_connected_4bit_v1";
+#endif
+
 inline TfLiteStatus CheckTypes(TfLiteContext* context,
                                const TfLiteTensor* input,
                                const TfLiteTensor* filter,
@@ -490,6 +509,28 @@ TfLiteStatus PrepareImpl(TfLiteContext* context, TfLiteNode* node,
         context, params->activation, output, &data->output_activation_min,
         &data->output_activation_max));
   }
+
+  data->use_int4_filter_kernel =
+      kernel_type == kGenericOptimized && input->type == kTfLiteInt8 &&
+      output->type == kTfLiteInt8 && filter->type == kTfLiteInt4 &&
+      filter->sparsity == nullptr && IsConstantTensor(filter) &&
+      filter->params.zero_point == 0 && filter->dims->data[1] % 2 == 0 &&
+      batch_size <= kMaxBatchSizeForInt4FilterKernel;
+  if (data->use_int4_filter_kernel && data->int4_filter_row_sums.empty()) {
+    // The filter is constant, so the row sums that apply the input offset are
+    // computed once.
+    const int cols = filter->dims->data[1];
+    std::vector<int8_t> unpacked_row(cols);
+    data->int4_filter_row_sums.resize(num_units);
+    for (int row = 0; row < num_units; ++row) {
+      tensor_utils::UnpackDenseInt4IntoInt8(
+          GetTensorData<int8_t>(filter) + row * cols / 2, cols,
+          unpacked_row.data());
+      int32_t row_sum = 0;
+      for (const int8_t value : unpacked_row) row_sum += value;
+      data->int4_filter_row_sums[row] = row_sum;
+    }
+  }
   if (input->type == kTfLiteInt16 && output->type == kTfLiteInt16) {
     TF_LITE_ENSURE_EQ(context, input->params.zero_point, 0);
     TF_LITE_ENSURE_EQ(context, output->params.zero_point, 0);
@@ -972,13 +1013,36 @@ TfLiteStatus EvalHybridDense4Bit(
   const int dst_layout_cols = lhs_layout_rows;
   if (data->op_data_4bit->needs_prepack) {
     const int weight_size = lhs_layout_rows * lhs_layout_cols / 2;
-    const int required_size =
-        optimized_4bit::kDefaultAlignmentPadding + weight_size;
-    data->op_data_4bit->AllocatePackedRegion(required_size);
     const int8_t* weight_ptr = GetTensorData<int8_t>(filter);
-    optimized_4bit::api::Prepack(data->op_data_4bit->prepacked_cache,
-                                 weight_ptr, lhs_layout_rows, lhs_layout_cols,
-                                 output_depth, cols, lhs_width, depth);
+    PackedWeightCache* weight_cache =
+        CpuBackendContext::GetFromContext(context)->packed_weight_cache();
+    if (weight_cache != nullptr) {
+      // The packed layout only depends on the weights and these dimensions.
+      const int32_t layout[] = {lhs_layout_rows, lhs_layout_cols, output_depth,
+                                cols,            lhs_width,       depth};
+      const uint64_t key = PackedWeightCache::Fingerprint(
+          layout, sizeof(layout),
+          PackedWeightCache::Fingerprint(
+              weight_ptr, filter->bytes,
+              PackedWeightCache::Fingerprint(
+                  kPacked4BitFilterTag, sizeof(kPacked4BitFilterTag))));
+      data->op_data_4bit->prepacked_cache =
+          weight_cache->Find(key, weight_size);
+      if (data->op_data_4bit->prepacked_cache == nullptr) {
+        uint8_t* packed = weight_cache->Reserve(key, weight_size);
+        optimized_4bit::api::Prepack(packed, weight_ptr, lhs_layout_rows,
+                                     lhs_layout_cols, output_depth, cols,
+                                     lhs_width, depth);
+        data->op_data_4bit->prepacked_cache = packed;
+      }
+    } else {
+      const int required_size =
+          optimized_4bit::kDefaultAlignmentPadding + weight_size;
+      uint8_t* packed = data->op_data_4bit->AllocatePackedRegion(required_size);
+      optimized_4bit::api::Prepack(packed, weight_ptr, lhs_layout_rows,
+                                   lhs_layout_cols, output_depth, cols,
+                                   lhs_width, depth);
+    }
     data->op_data_4bit->needs_prepack = false;
 #ifdef MADV_PAGEOUT
     // After prepacking, we will never use the weights from the model file. Mark
@@ -1373,6 +1437,19 @@ TfLiteStatus EvalQuantized(TfLiteContext* context, TfLiteNode* node,
                 context, "Unsupported sparse fully-connected weight format.");
             return kTfLiteError;
           }
+        } else if (data->use_int4_filter_kernel) {
+          const int num_units = filter->dims->data[0];
+          const int input_depth = filter->dims->data[1];
+          tensor_utils::Int4MatrixBatchVectorMultiplyAccumulate(
+              GetTensorData<int8_t>(filter), data->int4_filter_row_sums.data(),
+              num_units, input_depth, GetTensorData<int8_t>(input),
+              GetTensorData<int32_t>(bias), NumElements(input) / input_depth,
+              input_offset, data->output_multiplier, data->output_shift,
+              is_per_channel ? data->per_channel_output_multiplier.data()
+                             : nullptr,
+              is_per_channel ? data->per_channel_output_shift.data() : nullptr,
+              output_offset, data->output_activation_min,
+              data->output_activation_max, GetTensorData<int8_t>(output));
         } else {
           const int8_t* filter_data;
           std::unique_ptr<int8_t[]> unpacked_filter_data = nullptr;
@@ -59,11 +59,14 @@ struct OpData4Bit {
   int rows_right = 1;
   int batch_size = 0;
   bool needs_prepack = true;
-  uint8_t* prepacked_cache = nullptr;
+  // Either points into prepacked_cache_buffer or into a PackedWeightCache.
+  const uint8_t* prepacked_cache = nullptr;
   std::unique_ptr<uint8_t[], Deleter> prepacked_cache_buffer;
   size_t prepacked_cache_buffer_size = 0;
 
-  void AllocatePackedRegion(size_t required_size) {
+  // Allocates prepacked_cache_buffer and returns its aligned start, which
+  // prepacked_cache is also set to.
+  uint8_t* AllocatePackedRegion(size_t required_size) {
 #ifdef TFLITE_MMAP_DISABLED
     uint8_t* region = new uint8_t[required_size];
     prepacked_cache_buffer =
@@ -78,11 +81,13 @@ struct OpData4Bit {
     madvise(region, required_size, MADV_MERGEABLE);
 #endif
 #endif
-    prepacked_cache = reinterpret_cast<uint8_t*>(
+    uint8_t* aligned_region = reinterpret_cast<uint8_t*>(
         (reinterpret_cast<uintptr_t>(prepacked_cache_buffer.get()) +
          kDefaultAlignmentPadding) &
         ~kDefaultAlignmentPadding);
+    prepacked_cache = aligned_region;
     prepacked_cache_buffer_size = required_size;
+    return aligned_region;
   }
 };
 
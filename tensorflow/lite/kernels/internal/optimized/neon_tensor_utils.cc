@@ -1961,6 +1961,67 @@ void NeonSparseMatrixBatchVectorMultiplyAccumulate1x4(
   }
 }
 
+void NeonInt4MatrixBatchVectorMultiplyAccumulate(
+    const int8_t* __restrict__ packed_matrix,
+    const int32_t* __restrict__ row_sums, int m_rows, int m_cols,
+    const int8_t* __restrict__ vector, const int32_t* __restrict__ bias_vector,
+    int n_batch, const int32_t input_offset, const int32_t output_multiplier,
+    int32_t output_shift, const int32_t* per_channel_scale,
+    const int32_t* per_channel_shift, int32_t output_offset,
+    const int32_t output_activation_min, const int32_t output_activation_max,
+    int8_t* __restrict__ result) {
+  // Each iteration consumes 16 packed bytes, i.e. 32 4-bit values.
+  constexpr int kBlockSize = 2 * kInt8ValuesPerNeonVector;
+  TFLITE_DCHECK_EQ(m_cols % 2, 0);
+  const int packed_cols = m_cols / 2;
+
+  for (int batch = 0; batch < n_batch; ++batch) {
+    const int8_t* vector_in_batch = vector + batch * m_cols;
+    for (int row = 0; row < m_rows; ++row) {
+      const int8_t* matrix_ptr = packed_matrix + row * packed_cols;
+      int32x4_t acc_i32x4 = vmovq_n_s32(0);
+      int col = 0;
+      for (; col < (m_cols & ~(kBlockSize - 1)); col += kBlockSize) {
+        const int8x16_t packed_i8x16 = vld1q_s8(matrix_ptr + col / 2);
+        // Arithmetic shifts sign-extend the low and the high nibbles.
+        const int8x16_t even_i8x16 = vshrq_n_s8(vshlq_n_s8(packed_i8x16, 4), 4);
+        const int8x16_t odd_i8x16 = vshrq_n_s8(packed_i8x16, 4);
+        // Interleave back into column order.
+        const int8x16x2_t matrix_i8x16x2 = vzipq_s8(even_i8x16, odd_i8x16);
+        const int8x16_t vector_lo_i8x16 = vld1q_s8(vector_in_batch + col);
+        const int8x16_t vector_hi_i8x16 = vld1q_s8(vector_in_batch + col + 16);
+
+        // At most 4 products of magnitude 128 * 8 are summed per lane, which
+        // fits in 16 bits.
+        int16x8_t acc_i16x8 = vmull_s8(vget_low_s8(vector_lo_i8x16),
+                                       vget_low_s8(matrix_i8x16x2.val[0]));
+        acc_i16x8 = vmlal_s8(acc_i16x8, vget_high_s8(vector_lo_i8x16),
+                             vget_high_s8(matrix_i8x16x2.val[0]));
+        acc_i16x8 = vmlal_s8(acc_i16x8, vget_low_s8(vector_hi_i8x16),
+                             vget_low_s8(matrix_i8x16x2.val[1]));
+        acc_i16x8 = vmlal_s8(acc_i16x8, vget_high_s8(vector_hi_i8x16),
+                             vget_high_s8(matrix_i8x16x2.val[1]));
+        acc_i32x4 = vpadalq_s16(acc_i32x4, acc_i16x8);
+      }
+      int32_t acc = AccumulateNeonLane(acc_i32x4);
+      for (; col < m_cols; col += 2) {
+        const int8_t packed = matrix_ptr[col / 2];
+        acc += (static_cast<int8_t>(packed << 4) >> 4) * vector_in_batch[col] +
+               (packed >> 4) * vector_in_batch[col + 1];
+      }
+      const int32_t bias_value = bias_vector != nullptr ? bias_vector[row] : 0;
+      acc = acc + bias_value + input_offset * row_sums[row];
+      acc = MultiplyByQuantizedMultiplier(
+          acc, per_channel_scale ? per_channel_scale[row] : output_multiplier,
+          per_channel_shift ? per_channel_shift[row] : output_shift);
+      acc += output_offset;
+      result[batch * m_rows + row] =
+          static_cast<int8_t>(ActivationFunctionWithMinMax(
+              acc, output_activation_min, output_activation_max));
+    }
+  }
+}
+
 void NeonSparseMatrixBatchVectorMultiplyAccumulate1x16(
     const int8_t* __restrict__ matrix, const int32_t* __restrict__ segments,
     const int32_t* __restrict__ indices, int m_rows, int m_cols,
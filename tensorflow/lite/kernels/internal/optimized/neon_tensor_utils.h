@@ -79,6 +79,22 @@ void SparseMatrixBatchVectorMultiplyAccumulate(
                    m_rows, m_cols, vector, n_batch, result);
 }
 
+void Int4MatrixBatchVectorMultiplyAccumulate(
+    const int8_t* __restrict__ packed_matrix,
+    const int32_t* __restrict__ row_sums, int m_rows, int m_cols,
+    const int8_t* __restrict__ vector, const int32_t* __restrict__ bias_vector,
+    int n_batch, const int32_t input_offset, const int32_t output_multiplier,
+    int32_t output_shift, const int32_t* per_channel_scale,
+    const int32_t* per_channel_shift, int32_t output_offset,
+    const int32_t output_activation_min, const int32_t output_activation_max,
+    int8_t* __restrict__ result) {
+  NEON_OR_PORTABLE(Int4MatrixBatchVectorMultiplyAccumulate, packed_matrix,
+                   row_sums, m_rows, m_cols, vector, bias_vector, n_batch,
+                   input_offset, output_multiplier, output_shift,
+                   per_channel_scale, per_channel_shift, output_offset,
+                   output_activation_min, output_activation_max, result);
+}
+
 void SparseMatrixBatchVectorMultiplyAccumulate1x16(
     const int8_t* __restrict__ matrix, const int32_t* __restrict__ segments,
     const int32_t* __restrict__ indices, int m_rows, int m_cols,
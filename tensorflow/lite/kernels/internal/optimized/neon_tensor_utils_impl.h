@@ -115,6 +115,18 @@ void NeonSparseMatrixBatchVectorMultiplyAccumulate(
     int m_rows, int m_cols, const float* __restrict__ vector, int n_batch,
     float* __restrict__ result);
 
+// Multiplies a symmetric quantized matrix by a quantized batch vector. The
+// matrix holds int4 values packed two per byte.
+void NeonInt4MatrixBatchVectorMultiplyAccumulate(
+    const int8_t* __restrict__ packed_matrix,
+    const int32_t* __restrict__ row_sums, int m_rows, int m_cols,
+    const int8_t* __restrict__ vector, const int32_t* __restrict__ bias_vector,
+    int n_batch, const int32_t input_offset, const int32_t output_multiplier,
+    int32_t output_shift, const int32_t* per_channel_scale,
+    const int32_t* per_channel_shift, int32_t output_offset,
+    const int32_t output_activation_min, const int32_t output_activation_max,
+    int8_t* __restrict__ result);
+
 // Multiplies a symmetric quantized matrix by a quantized batch vector. The
 // matrix is stored in sparse format.
 void NeonSparseMatrixBatchVectorMultiplyAccumulate1x16(
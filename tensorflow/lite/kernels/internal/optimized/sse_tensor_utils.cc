@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/lite/kernels/cpu_backend_context.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm.h"
 #include "tensorflow/lite/kernels/cpu_backend_gemm_params.h"
+#include "tensorflow/lite/kernels/internal/common.h"
 #include "tensorflow/lite/kernels/internal/compatibility.h"
 
 namespace tflite {
@@ -632,6 +633,125 @@ void SseSparseMatrixBatchVectorMultiplyAccumulate(
   }  // for batch
 }
 
+namespace {
+
+// Sign-extends 4-bit values held in the low nibble of each byte.
+static inline __m128i SignExtendInt4x16(__m128i nibbles_8x16) {
+  const __m128i mask_8x16 = _mm_set1_epi8(0x0F);
+  const __m128i sign_8x16 = _mm_set1_epi8(0x08);
+  // (x ^ 8) - 8 maps [0, 16) to [-8, 8).
+  return _mm_sub_epi8(
+      _mm_xor_si128(_mm_and_si128(nibbles_8x16, mask_8x16), sign_8x16),
+      sign_8x16);
+}
+
+#ifdef __AVX2__
+static inline __m256i SignExtendInt4x32(__m256i nibbles_8x32) {
+  const __m256i mask_8x32 = _mm256_set1_epi8(0x0F);
+  const __m256i sign_8x32 = _mm256_set1_epi8(0x08);
+  return _mm256_sub_epi8(
+      _mm256_xor_si256(_mm256_and_si256(nibbles_8x32, mask_8x32), sign_8x32),
+      sign_8x32);
+}
+#endif  // __AVX2__
+
+// Dot product of a row of m_cols int4 values packed two per byte, low nibble
+// first, with m_cols int8 values.
+int32_t Int4RowVectorDotProduct(const int8_t* __restrict__ packed_row,
+                                const int8_t* __restrict__ vector,
+                                const int m_cols) {
+  std::intptr_t col = 0;
+  int32_t sum = 0;
+#ifdef __AVX2__
+  __m256i dotprod_32x8 = _mm256_setzero_si256();
+  // For every block of 64 4-bit values.
+  for (; col < (m_cols & ~63); col += 64) {
+    const __m256i packed_8x32 = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(packed_row + col / 2));
+    const __m256i even_8x32 = SignExtendInt4x32(packed_8x32);
+    const __m256i odd_8x32 =
+        SignExtendInt4x32(_mm256_srli_epi16(packed_8x32, 4));
+    // Interleaving works within 128-bit lanes, so 'row_lo' holds columns
+    // [0, 16) and [32, 48), and 'row_hi' holds [16, 32) and [48, 64).
+    const __m256i row_lo_8x32 = _mm256_unpacklo_epi8(even_8x32, odd_8x32);
+    const __m256i row_hi_8x32 = _mm256_unpackhi_epi8(even_8x32, odd_8x32);
+    const __m256i vec_0_8x32 =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(vector + col));
+    const __m256i vec_1_8x32 = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i*>(vector + col + 32));
+    const __m256i vec_lo_8x32 =
+        _mm256_permute2x128_si256(vec_0_8x32, vec_1_8x32, 0x20);
+    const __m256i vec_hi_8x32 =
+        _mm256_permute2x128_si256(vec_0_8x32, vec_1_8x32, 0x31);
+    dotprod_32x8 = _mm256_add_epi32(dotprod_32x8,
+                                    DotProdInt8x4x8(vec_lo_8x32, row_lo_8x32));
+    dotprod_32x8 = _mm256_add_epi32(dotprod_32x8,
+                                    DotProdInt8x4x8(vec_hi_8x32, row_hi_8x32));
+  }
+  sum += ReduceInt32x4(
+      _mm_add_epi32(_mm256_castsi256_si128(dotprod_32x8),
+                    _mm256_extracti128_si256(dotprod_32x8, 1)));
+#endif  // __AVX2__
+  __m128i dotprod_32x4 = _mm_setzero_si128();
+  // For every block of 32 4-bit values.
+  for (; col < (m_cols & ~31); col += 32) {
+    const __m128i packed_8x16 = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(packed_row + col / 2));
+    const __m128i even_8x16 = SignExtendInt4x16(packed_8x16);
+    const __m128i odd_8x16 = SignExtendInt4x16(_mm_srli_epi16(packed_8x16, 4));
+    const __m128i row_lo_8x16 = _mm_unpacklo_epi8(even_8x16, odd_8x16);
+    const __m128i row_hi_8x16 = _mm_unpackhi_epi8(even_8x16, odd_8x16);
+    const __m128i vec_lo_8x16 =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(vector + col));
+    const __m128i vec_hi_8x16 =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(vector + col + 16));
+    dotprod_32x4 =
+        _mm_add_epi32(dotprod_32x4, DotProdInt8x4x4(vec_lo_8x16, row_lo_8x16));
+    dotprod_32x4 =
+        _mm_add_epi32(dotprod_32x4, DotProdInt8x4x4(vec_hi_8x16, row_hi_8x16));
+  }
+  sum += ReduceInt32x4(dotprod_32x4);
+  // Postamble loop for <32x remaining 4-bit values.
+  for (; col < m_cols; col += 2) {
+    const int8_t packed = packed_row[col / 2];
+    sum += (static_cast<int8_t>(packed << 4) >> 4) * vector[col] +
+           (packed >> 4) * vector[col + 1];
+  }
+  return sum;
+}
+
+}  // namespace
+
+void SseInt4MatrixBatchVectorMultiplyAccumulate(
+    const int8_t* __restrict__ packed_matrix,
+    const int32_t* __restrict__ row_sums, int m_rows, int m_cols,
+    const int8_t* __restrict__ vector, const int32_t* __restrict__ bias_vector,
+    int n_batch, const int32_t input_offset, const int32_t output_multiplier,
+    int32_t output_shift, const int32_t* per_channel_scale,
+    const int32_t* per_channel_shift, int32_t output_offset,
+    const int32_t output_activation_min, const int32_t output_activation_max,
+    int8_t* __restrict__ result) {
+  TFLITE_DCHECK_EQ(m_cols % 2, 0);
+  const int packed_cols = m_cols / 2;
+  for (std::intptr_t batch = 0; batch < n_batch; ++batch) {
+    const int8_t* __restrict__ vector_in_batch = vector + batch * m_cols;
+    for (std::intptr_t row = 0; row < m_rows; ++row) {
+      int32_t dot_prod = Int4RowVectorDotProduct(
+          packed_matrix + row * packed_cols, vector_in_batch, m_cols);
+      dot_prod += row_sums[row] * input_offset;
+      const int32_t bias_value = bias_vector != nullptr ? bias_vector[row] : 0;
+      dot_prod = MultiplyByQuantizedMultiplier(
+          dot_prod + bias_value,
+          per_channel_scale ? per_channel_scale[row] : output_multiplier,
+          per_channel_shift ? per_channel_shift[row] : output_shift);
+      dot_prod += output_offset;
+      result[batch * m_rows + row] =
+          static_cast<int8_t>(ActivationFunctionWithMinMax(
+              dot_prod, output_activation_min, output_activation_max));
+    }
+  }
+}
+
 void SseReductionSumVector(const int8_t* input_vector, int32_t* output_vector,
                            const int output_size, const int reduction_size) {
   static constexpr std::intptr_t kBlockSize = 16;
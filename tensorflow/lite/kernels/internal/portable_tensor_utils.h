@@ -262,6 +262,23 @@ void SparseMatrixBatchVectorMultiplyAccumulate(
     const float* __restrict__ scaling_factors, int n_batch,
     float* __restrict__ result, const float* per_channel_scale = nullptr);
 
+// Same as SparseMatrixBatchVectorMultiplyAccumulate1x16, but the matrix is
+// dense and holds int4 values packed two per byte, low nibble first, as in
+// kTfLiteInt4 tensors. The packed values are consumed directly, so only half
+// the bytes of an int8 matrix are read. `row_sums` holds the sum of each
+// unpacked matrix row and is used to apply `input_offset`.
+// This function assumes that m_cols is even so that every row starts on a byte
+// boundary. Also, it assumes the filter offset is zero.
+void Int4MatrixBatchVectorMultiplyAccumulate(
+    const int8_t* __restrict__ packed_matrix,
+    const int32_t* __restrict__ row_sums, int m_rows, int m_cols,
+    const int8_t* __restrict__ vector, const int32_t* __restrict__ bias_vector,
+    int n_batch, const int32_t input_offset, const int32_t output_multiplier,
+    int32_t output_shift, const int32_t* per_channel_scale,
+    const int32_t* per_channel_shift, int32_t output_offset,
+    const int32_t output_activation_min, const int32_t output_activation_max,
+    int8_t* __restrict__ result);
+
 // Same as the above 8, 8, 8 integer matmul except for the presence of zero
 // point and non-accumulative.
 // TODO(b/148688698): remove this function by folding zero point calculation in
@@ -267,6 +267,43 @@ void PortableSparseMatrixBatchVectorMultiplyAccumulate1x16(
   }
 }
 
+void PortableInt4MatrixBatchVectorMultiplyAccumulate(
+    const int8_t* __restrict__ packed_matrix,
+    const int32_t* __restrict__ row_sums, int m_rows, int m_cols,
+    const int8_t* __restrict__ vector, const int32_t* __restrict__ bias_vector,
+    int n_batch, const int32_t input_offset, const int32_t output_multiplier,
+    int32_t output_shift, const int32_t* per_channel_scale,
+    const int32_t* per_channel_shift, int32_t output_offset,
+    const int32_t output_activation_min, const int32_t output_activation_max,
+    int8_t* __restrict__ result) {
+  TFLITE_DCHECK_EQ(m_cols % 2, 0);
+  for (int batch = 0; batch < n_batch; ++batch) {
+    const int8_t* matrix_ptr = packed_matrix;
+    const int8_t* vector_in_batch = vector + batch * m_cols;
+    for (int row = 0; row < m_rows; ++row) {
+      int32_t dot_prod = 0;
+      for (int col = 0; col < m_cols; col += 2) {
+        const int8_t packed = *matrix_ptr++;
+        // Sign-extend the low and the high nibble.
+        const int8_t low = static_cast<int8_t>(packed << 4) >> 4;
+        const int8_t high = packed >> 4;
+        dot_prod +=
+            low * vector_in_batch[col] + high * vector_in_batch[col + 1];
+      }
+      dot_prod += row_sums[row] * input_offset;
+      const int32_t bias_value = bias_vector != nullptr ? bias_vector[row] : 0;
+      dot_prod = MultiplyByQuantizedMultiplier(
+          dot_prod + bias_value,
+          per_channel_scale ? per_channel_scale[row] : output_multiplier,
+          per_channel_shift ? per_channel_shift[row] : output_shift);
+      dot_prod += output_offset;
+      result[batch * m_rows + row] =
+          static_cast<int8_t>(ActivationFunctionWithMinMax(
+              dot_prod, output_activation_min, output_activation_max));
+    }
+  }
+}
+
 void PortableSparseMatrixBatchVectorMultiplyAccumulate(
     const float* __restrict__ matrix, const uint8_t* __restrict__ ledger,
     int m_rows, int m_cols, const float* __restrict__ vector, int n_batch,
@@ -1643,6 +1643,61 @@ TEST(uKernels,
 }
 #endif  // __ANDROID__
 
+TEST(uKernels, Int4MatrixBatchVectorMultiplyAccumulateTest) {
+  // 70 columns cover both the vectorized blocks and the scalar postamble.
+  const int kRow = 5;
+  const int kCol = 70;
+  const int kBatch = 2;
+  const int32_t kInputOffset = 3;
+  const int32_t kOutputOffset = -2;
+  std::vector<int8_t> matrix(kRow * kCol);
+  std::vector<int8_t> packed_matrix(kRow * kCol / 2);
+  std::vector<int32_t> row_sums(kRow, 0);
+  for (int i = 0; i < kRow * kCol; ++i) {
+    matrix[i] = static_cast<int8_t>((i * 7 + i / kCol) % 16 - 8);
+    row_sums[i / kCol] += matrix[i];
+  }
+  for (int i = 0; i < kRow * kCol; i += 2) {
+    packed_matrix[i / 2] =
+        static_cast<int8_t>((matrix[i] & 0x0F) | (matrix[i + 1] << 4));
+  }
+  std::vector<int8_t> vector(kBatch * kCol);
+  for (int i = 0; i < kBatch * kCol; ++i) {
+    vector[i] = static_cast<int8_t>((i * 37) % 256 - 128);
+  }
+  const int32_t bias[kRow] = {10, -20, 30, -40, 50};
+  std::vector<int32_t> multipliers(kRow);
+  std::vector<int32_t> shifts(kRow);
+  for (int row = 0; row < kRow; ++row) {
+    int shift;
+    QuantizeMultiplier(0.001 * (row + 1), &multipliers[row], &shift);
+    shifts[row] = shift;
+  }
+
+  std::vector<int8_t> expected(kBatch * kRow);
+  for (int batch = 0; batch < kBatch; ++batch) {
+    for (int row = 0; row < kRow; ++row) {
+      int32_t acc = bias[row];
+      for (int col = 0; col < kCol; ++col) {
+        acc += matrix[row * kCol + col] *
+               (vector[batch * kCol + col] + kInputOffset);
+      }
+      acc = MultiplyByQuantizedMultiplier(acc, multipliers[row], shifts[row]);
+      acc = std::min(std::max(acc + kOutputOffset, -128), 127);
+      expected[batch * kRow + row] = static_cast<int8_t>(acc);
+    }
+  }
+
+  std::vector<int8_t> output(kBatch * kRow);
+  Int4MatrixBatchVectorMultiplyAccumulate(
+      packed_matrix.data(), row_sums.data(), kRow, kCol, vector.data(), bias,
+      kBatch, kInputOffset, /*output_multiplier=*/0, /*output_shift=*/0,
+      multipliers.data(), shifts.data(), kOutputOffset,
+      /*output_activation_min=*/-128, /*output_activation_max=*/127,
+      output.data());
+  EXPECT_THAT(output, ElementsAreArray(expected));
+}
+
 TEST(uKernels, VectorVectorCwiseProductTest) {
   constexpr int kVectorSize = 10;
   static float input1[kVectorSize] = {0.0,  -0.5, 1.0,  -1.5, 2.0,
@@ -0,0 +1,235 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/packed_weight_cache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32) && !defined(TFLITE_MMAP_DISABLED)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define TFLITE_PACKED_WEIGHT_CACHE_USE_MMAP
+#endif
+
+namespace tflite {
+namespace {
+
+// The cache file starts with a header, followed by the entries, each aligned
+// to kAlignment, and ends with the index of the entries.
+//
+// When changing the layout, increment kVersion so older files are rejected.
+struct FileHeader {
+  static constexpr uint64_t kMagic = 0x3143575050454C46;  // "FLEPPWC1"
+  static constexpr uint64_t kVersion = 1;
+  uint64_t magic;
+  uint64_t version;
+  uint64_t num_entries;
+  uint64_t index_offset;
+};
+
+struct IndexEntry {
+  uint64_t key;
+  uint64_t offset;
+  uint64_t size;
+};
+
+size_t AlignUp(size_t value) {
+  return (value + PackedWeightCache::kAlignment - 1) &
+         ~(PackedWeightCache::kAlignment - 1);
+}
+
+uint64_t Mix(uint64_t value) {
+  value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+  return value ^ (value >> 31);
+}
+
+}  // namespace
+
+PackedWeightCache::PackedWeightCache() = default;
+
+PackedWeightCache::~PackedWeightCache() { Unmap(); }
+
+void PackedWeightCache::Unmap() {
+#ifdef TFLITE_PACKED_WEIGHT_CACHE_USE_MMAP
+  if (file_data_ != nullptr && file_copy_ == nullptr) {
+    munmap(const_cast<uint8_t*>(file_data_), file_size_);
+  }
+#endif
+  file_copy_.reset();
+  file_data_ = nullptr;
+  file_size_ = 0;
+}
+
+bool PackedWeightCache::Load(const std::string& path) {
+  Unmap();
+  entries_.clear();
+  reserved_buffers_.clear();
+  has_unsaved_entries_ = false;
+  path_ = path;
+
+#ifdef TFLITE_PACKED_WEIGHT_CACHE_USE_MMAP
+  const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return false;
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size <= 0) {
+    close(fd);
+    return false;
+  }
+  file_size_ = static_cast<size_t>(file_stat.st_size);
+  void* mapped = mmap(nullptr, file_size_, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    file_size_ = 0;
+    return false;
+  }
+  file_data_ = static_cast<const uint8_t*>(mapped);
+#else
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file) return false;
+  file_size_ = static_cast<size_t>(file.tellg());
+  // Over-allocate so that entries keep their alignment.
+  file_copy_.reset(new uint8_t[file_size_ + kAlignment]);
+  uint8_t* aligned = reinterpret_cast<uint8_t*>(AlignUp(
+      reinterpret_cast<uintptr_t>(file_copy_.get())));
+  file.seekg(0);
+  if (!file.read(reinterpret_cast<char*>(aligned), file_size_)) {
+    Unmap();
+    return false;
+  }
+  file_data_ = aligned;
+#endif
+
+  FileHeader header;
+  if (file_size_ < sizeof(header)) {
+    Unmap();
+    return false;
+  }
+  std::memcpy(&header, file_data_, sizeof(header));
+  if (header.magic != FileHeader::kMagic ||
+      header.version != FileHeader::kVersion ||
+      header.index_offset > file_size_ ||
+      header.num_entries >
+          (file_size_ - header.index_offset) / sizeof(IndexEntry)) {
+    Unmap();
+    return false;
+  }
+  for (uint64_t i = 0; i < header.num_entries; ++i) {
+    IndexEntry index_entry;
+    std::memcpy(&index_entry,
+                file_data_ + header.index_offset + i * sizeof(IndexEntry),
+                sizeof(index_entry));
+    if (index_entry.offset % kAlignment != 0 ||
+        index_entry.offset > header.index_offset ||
+        index_entry.size > header.index_offset - index_entry.offset) {
+      entries_.clear();
+      Unmap();
+      return false;
+    }
+    entries_[index_entry.key] = {file_data_ + index_entry.offset,
+                                 static_cast<size_t>(index_entry.size)};
+  }
+  return !entries_.empty();
+}
+
+uint64_t PackedWeightCache::Fingerprint(const void* data, size_t size,
+                                        uint64_t seed) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  uint64_t hash = Mix(seed ^ (size * 0x9e3779b97f4a7c15ULL));
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, bytes + i, sizeof(word));
+    hash = (hash ^ Mix(word)) * 0x9e3779b97f4a7c15ULL;
+  }
+  uint64_t tail = 0;
+  std::memcpy(&tail, bytes + i, size - i);
+  return Mix(hash ^ tail);
+}
+
+const uint8_t* PackedWeightCache::Find(uint64_t key, size_t size) const {
+  auto it = entries_.find(key);
+  if (it == entries_.end() || it->second.size != size) return nullptr;
+  return it->second.data;
+}
+
+uint8_t* PackedWeightCache::Reserve(uint64_t key, size_t size) {
+  reserved_buffers_.emplace_back(new uint8_t[size + kAlignment]);
+  uint8_t* buffer = reinterpret_cast<uint8_t*>(
+      AlignUp(reinterpret_cast<uintptr_t>(reserved_buffers_.back().get())));
+  entries_[key] = {buffer, size};
+  has_unsaved_entries_ = true;
+  return buffer;
+}
+
+bool PackedWeightCache::Save() {
+  if (!has_unsaved_entries_) return true;
+  if (path_.empty()) return false;
+
+  std::vector<IndexEntry> index;
+  index.reserve(entries_.size());
+  size_t offset = AlignUp(sizeof(FileHeader));
+  for (const auto& [key, entry] : entries_) {
+    index.push_back({key, offset, entry.size});
+    offset = AlignUp(offset + entry.size);
+  }
+  const FileHeader header = {FileHeader::kMagic, FileHeader::kVersion,
+                             index.size(), offset};
+
+  // Write to a temporary file first so that readers never see a partial file.
+  const std::string temp_path = path_ + ".tmp";
+  {
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+    const char padding[kAlignment] = {};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    size_t written = sizeof(header);
+    for (const IndexEntry& index_entry : index) {
+      file.write(padding, index_entry.offset - written);
+      file.write(reinterpret_cast<const char*>(entries_[index_entry.key].data),
+                 index_entry.size);
+      written = index_entry.offset + index_entry.size;
+    }
+    file.write(padding, offset - written);
+    file.write(reinterpret_cast<const char*>(index.data()),
+               index.size() * sizeof(IndexEntry));
+    if (!file.flush()) {
+      std::remove(temp_path.c_str());
+      return false;
+    }
+  }
+#if defined(_WIN32)
+  // rename() doesn't replace existing files on Windows.
+  std::remove(path_.c_str());
+#endif
+  // The mapping of a replaced file stays valid, so entries found in it can
+  // still be used.
+  if (std::rename(temp_path.c_str(), path_.c_str()) != 0) {
+    std::remove(temp_path.c_str());
+    return false;
+  }
+  has_unsaved_entries_ = false;
+  return true;
+}
+
+}  // namespace tflite
@@ -0,0 +1,107 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_KERNELS_PACKED_WEIGHT_CACHE_H_
+#define TENSORFLOW_LITE_KERNELS_PACKED_WEIGHT_CACHE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tflite {
+
+// A persistent cache for constant weights that builtin kernels repack, e.g.
+// into a blocked layout, before they can use them.
+//
+// On the first run the repacked weights are kept in memory and `Save()` writes
+// them to the cache file. Later runs map that file read-only and kernels use
+// the repacked weights in place: they are neither recomputed nor held in
+// anonymous memory, and the OS pages them in on first use and may drop them
+// under memory pressure.
+//
+// Entries are keyed by a fingerprint of the source weights and of the kernel's
+// packing parameters, so one cache file can be shared by several models, and
+// the entries of weights that changed are simply not found.
+//
+// Attach a cache to the interpreters' CpuBackendContext with
+// `CpuBackendContext::SetPackedWeightCache`. It is not thread safe: the
+// interpreters sharing it must not be prepared or first invoked concurrently.
+//
+// WARNING: This is an experimental interface that is subject to change.
+class PackedWeightCache {
+ public:
+  // Alignment of the buffers returned by `Find` and `Reserve`.
+  static constexpr size_t kAlignment = 64;
+
+  PackedWeightCache();
+  ~PackedWeightCache();
+
+  PackedWeightCache(const PackedWeightCache&) = delete;
+  PackedWeightCache& operator=(const PackedWeightCache&) = delete;
+
+  // Sets the cache file to `path` and maps it if it exists. A missing,
+  // corrupted or incompatible file is not an error: the cache starts empty
+  // and `Save()` replaces the file. Returns whether entries were loaded.
+  // Call it before the kernels use the cache: it invalidates the buffers
+  // returned by earlier `Find` and `Reserve` calls.
+  bool Load(const std::string& path);
+
+  // Returns a fingerprint of `size` bytes at `data`, chained to `seed`.
+  // Kernels fingerprint a tag naming their packing format, the source weights
+  // and the packing parameters to build a key.
+  static uint64_t Fingerprint(const void* data, size_t size,
+                              uint64_t seed = 0);
+
+  // Returns the entry stored under `key`, or nullptr if there is none or its
+  // size isn't `size`.
+  const uint8_t* Find(uint64_t key, size_t size) const;
+
+  // Returns a buffer of `size` bytes for the caller to fill with the entry
+  // stored under `key`. The buffer is owned by the cache and valid as long as
+  // the cache.
+  uint8_t* Reserve(uint64_t key, size_t size);
+
+  // Writes all entries to the cache file if entries were reserved since the
+  // last save. Buffers returned earlier stay valid. Returns false on a write
+  // error.
+  bool Save();
+
+  size_t num_entries() const { return entries_.size(); }
+
+ private:
+  struct Entry {
+    const uint8_t* data;
+    size_t size;
+  };
+
+  void Unmap();
+
+  std::string path_;
+  std::unordered_map<uint64_t, Entry> entries_;
+  // Buffers returned by `Reserve`.
+  std::vector<std::unique_ptr<uint8_t[]>> reserved_buffers_;
+  bool has_unsaved_entries_ = false;
+
+  // The mapped cache file, or a heap copy of it where mmap isn't available.
+  const uint8_t* file_data_ = nullptr;
+  size_t file_size_ = 0;
+  std::unique_ptr<uint8_t[]> file_copy_;
+};
+
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_KERNELS_PACKED_WEIGHT_CACHE_H_
@@ -0,0 +1,136 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/kernels/packed_weight_cache.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace {
+
+using ::testing::ElementsAreArray;
+
+std::string CachePath(const std::string& name) {
+  const std::string path = ::testing::TempDir() + "/" + name;
+  std::remove(path.c_str());
+  return path;
+}
+
+TEST(PackedWeightCacheTest, FingerprintDependsOnDataAndSeed) {
+  std::vector<int8_t> weights(37);
+  std::iota(weights.begin(), weights.end(), 0);
+  const uint64_t key = PackedWeightCache::Fingerprint(
+      weights.data(), weights.size(), /*seed=*/1);
+  EXPECT_EQ(key, PackedWeightCache::Fingerprint(weights.data(),
+                                                weights.size(), 1));
+  EXPECT_NE(key, PackedWeightCache::Fingerprint(weights.data(),
+                                                weights.size(), 2));
+  EXPECT_NE(key, PackedWeightCache::Fingerprint(weights.data(),
+                                                weights.size() - 1, 1));
+  weights.back() = 100;
+  EXPECT_NE(key, PackedWeightCache::Fingerprint(weights.data(),
+                                                weights.size(), 1));
+}
+
+TEST(PackedWeightCacheTest, SavedEntriesAreFoundAfterLoad) {
+  const std::string path = CachePath("saved_entries.cache");
+  const std::vector<uint8_t> first = {1, 2, 3};
+  std::vector<uint8_t> second(1000);
+  std::iota(second.begin(), second.end(), 0);
+  {
+    PackedWeightCache cache;
+    EXPECT_FALSE(cache.Load(path));
+    EXPECT_EQ(cache.Find(1, first.size()), nullptr);
+    uint8_t* buffer = cache.Reserve(1, first.size());
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(buffer) %
+                  PackedWeightCache::kAlignment,
+              0);
+    std::copy(first.begin(), first.end(), buffer);
+    std::copy(second.begin(), second.end(), cache.Reserve(2, second.size()));
+    EXPECT_EQ(cache.Find(1, first.size()), buffer);
+    EXPECT_TRUE(cache.Save());
+    // The buffers stay valid after saving.
+    EXPECT_EQ(cache.Find(1, first.size()), buffer);
+  }
+
+  PackedWeightCache cache;
+  ASSERT_TRUE(cache.Load(path));
+  EXPECT_EQ(cache.num_entries(), 2);
+  const uint8_t* found = cache.Find(1, first.size());
+  ASSERT_NE(found, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(found) % PackedWeightCache::kAlignment,
+            0);
+  EXPECT_THAT(std::vector<uint8_t>(found, found + first.size()),
+              ElementsAreArray(first));
+  found = cache.Find(2, second.size());
+  ASSERT_NE(found, nullptr);
+  EXPECT_THAT(std::vector<uint8_t>(found, found + second.size()),
+              ElementsAreArray(second));
+  // A size mismatch means the entry is for another layout.
+  EXPECT_EQ(cache.Find(2, second.size() - 1), nullptr);
+}
+
+TEST(PackedWeightCacheTest, NewEntriesAreAddedToLoadedOnes) {
+  const std::string path = CachePath("added_entries.cache");
+  {
+    PackedWeightCache cache;
+    cache.Load(path);
+    *cache.Reserve(1, 1) = 11;
+    EXPECT_TRUE(cache.Save());
+  }
+  {
+    PackedWeightCache cache;
+    ASSERT_TRUE(cache.Load(path));
+    *cache.Reserve(2, 1) = 22;
+    EXPECT_TRUE(cache.Save());
+    // The entry mapped from the replaced file is still readable.
+    EXPECT_EQ(*cache.Find(1, 1), 11);
+  }
+  PackedWeightCache cache;
+  ASSERT_TRUE(cache.Load(path));
+  EXPECT_EQ(*cache.Find(1, 1), 11);
+  EXPECT_EQ(*cache.Find(2, 1), 22);
+}
+
+TEST(PackedWeightCacheTest, CorruptedFileIsIgnored) {
+  const std::string path = CachePath("corrupted.cache");
+  {
+    std::ofstream file(path, std::ios::binary);
+    file << "not a packed weight cache";
+  }
+  PackedWeightCache cache;
+  EXPECT_FALSE(cache.Load(path));
+  EXPECT_EQ(cache.num_entries(), 0);
+  *cache.Reserve(1, 1) = 1;
+  EXPECT_TRUE(cache.Save());
+  PackedWeightCache reloaded;
+  EXPECT_TRUE(reloaded.Load(path));
+}
+
+TEST(PackedWeightCacheTest, SaveWithoutPathFails) {
+  PackedWeightCache cache;
+  cache.Reserve(1, 1);
+  EXPECT_FALSE(cache.Save());
+}
+
+}  // namespace
+}  // namespace tflite
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_LITE_MEMORY_PLANNER_H_
 #define TENSORFLOW_LITE_MEMORY_PLANNER_H_
 
+#include <string>
 #include <vector>
 
 #include "tensorflow/lite/core/c/common.h"
@@ -69,6 +70,19 @@ class MemoryPlanner {
   // Returns a map of allocation information. It's only used for debugging.
   virtual void GetAllocInfo(size_t *arena_size,
                             size_t *arena_persist_size) const = 0;
+
+  // Serializes the allocation plans computed so far, so that a planner for the
+  // same graph in another process can skip recomputing them. Planners that
+  // can't reuse plans return kTfLiteError.
+  virtual TfLiteStatus SerializePlans(std::string* /*plans*/) const {
+    return kTfLiteError;
+  }
+
+  // Loads plans produced by SerializePlans(). They are only used for tensor
+  // sizes and lifetimes identical to the ones they were computed for.
+  virtual TfLiteStatus LoadPlans(const std::string& /*plans*/) {
+    return kTfLiteError;
+  }
 };
 
 }  // namespace tflite
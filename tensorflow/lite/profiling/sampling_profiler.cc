@@ -0,0 +1,282 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/sampling_profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/core/api/profiler.h"
+#include "tensorflow/lite/profiling/time.h"
+
+namespace tflite {
+namespace profiling {
+namespace {
+
+constexpr uint64_t kEmptyKey = ~static_cast<uint64_t>(0);
+constexpr uint64_t kDelegateKeyBit = static_cast<uint64_t>(1) << 63;
+
+uint64_t MakeKey(bool is_delegate_op, int64_t node_index,
+                 int64_t subgraph_index) {
+  uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(subgraph_index))
+                  << 32) |
+                 static_cast<uint32_t>(node_index);
+  return is_delegate_op ? key ^ kDelegateKeyBit : key;
+}
+
+// SplitMix64 finalizer, spreads consecutive node indices over the table.
+size_t HashKey(uint64_t key) {
+  key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+  return static_cast<size_t>(key ^ (key >> 31));
+}
+
+int HistogramBucket(uint64_t elapsed_us) {
+  int bucket = 0;
+  while (elapsed_us != 0 &&
+         bucket < SamplingProfiler::kNumHistogramBuckets - 1) {
+    elapsed_us >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+size_t TableSize(size_t max_num_ops) {
+  size_t size = 1;
+  while (size < 2 * max_num_ops) size <<= 1;
+  return size;
+}
+
+// Counters have a single writer, so a relaxed load and store is enough and
+// avoids a locked read-modify-write on the invocation thread.
+void Increment(std::atomic<uint64_t>* counter, uint64_t value) {
+  counter->store(counter->load(std::memory_order_relaxed) + value,
+                 std::memory_order_relaxed);
+}
+
+}  // namespace
+
+struct SamplingProfiler::OpEntry {
+  OpEntry() {
+    for (auto& bucket : histogram) bucket.store(0, std::memory_order_relaxed);
+  }
+
+  // Published last with release semantics; the fields below are immutable
+  // once a reader observes a key other than kEmptyKey.
+  std::atomic<uint64_t> key{kEmptyKey};
+  char tag[kMaxTagLength + 1] = {};
+  bool is_delegate_op = false;
+  int64_t node_index = 0;
+  int64_t subgraph_index = 0;
+
+  std::atomic<uint64_t> count{0};
+  std::atomic<uint64_t> total_us{0};
+  std::atomic<uint64_t> max_us{0};
+  std::array<std::atomic<uint64_t>, kNumHistogramBuckets> histogram;
+};
+
+uint64_t SamplingProfiler::OpSummary::ApproximatePercentileUs(
+    double percentile) const {
+  if (count == 0) return 0;
+  percentile = std::min(std::max(percentile, 0.0), 100.0);
+  const uint64_t target = std::max<uint64_t>(
+      1, static_cast<uint64_t>(std::ceil(count * percentile / 100.0)));
+  uint64_t seen = 0;
+  for (int bucket = 0; bucket < kNumHistogramBuckets - 1; ++bucket) {
+    seen += histogram[bucket];
+    if (seen >= target) {
+      const uint64_t upper_bound =
+          bucket == 0 ? 0 : (static_cast<uint64_t>(1) << bucket) - 1;
+      return std::min(upper_bound, max_us);
+    }
+  }
+  return max_us;
+}
+
+SamplingProfiler::SamplingProfiler(const Options& options)
+    : sampling_interval_(std::max(options.sampling_interval, 1)),
+      max_num_ops_(std::max(options.max_num_ops, 1)),
+      table_mask_(TableSize(max_num_ops_) - 1),
+      ops_(new OpEntry[table_mask_ + 1]) {}
+
+SamplingProfiler::~SamplingProfiler() = default;
+
+bool SamplingProfiler::IsInvocationEvent(const char* tag,
+                                         EventType event_type) {
+  // Interpreter::Invoke reports a runtime instrumentation event, and every
+  // Subgraph::Invoke (reached directly by signature runners) reports a
+  // default "Invoke" event.
+  return event_type == EventType::GENERAL_RUNTIME_INSTRUMENTATION_EVENT ||
+         (event_type == EventType::DEFAULT && tag != nullptr &&
+          std::strcmp(tag, "Invoke") == 0);
+}
+
+bool SamplingProfiler::IsOperatorEvent(EventType event_type) {
+  return event_type == EventType::OPERATOR_INVOKE_EVENT ||
+         event_type == EventType::DELEGATE_OPERATOR_INVOKE_EVENT ||
+         event_type == EventType::DELEGATE_PROFILED_OPERATOR_INVOKE_EVENT;
+}
+
+uint32_t SamplingProfiler::BeginEvent(const char* tag, EventType event_type,
+                                      int64_t event_metadata1,
+                                      int64_t event_metadata2) {
+  if (IsInvocationEvent(tag, event_type)) {
+    // Nested invocations, e.g. of control flow subgraphs, share the sampling
+    // decision of the outermost one.
+    if (invocation_depth_++ == 0) BeginInvocation();
+    return kInvocationHandleBit;
+  }
+  if (!sampling_ || !IsOperatorEvent(event_type)) return 0;
+  OpEntry* op =
+      FindOrInsertOp(tag, event_type, event_metadata1, event_metadata2);
+  if (op == nullptr) return 0;
+  const uint32_t slot = next_event_++ % kMaxEventsInFlight;
+  events_in_flight_[slot] = {time::NowMicros(), op};
+  return slot + 1;
+}
+
+void SamplingProfiler::EndEvent(uint32_t event_handle) {
+  if (event_handle & kInvocationHandleBit) {
+    if (invocation_depth_ > 0 && --invocation_depth_ == 0) sampling_ = false;
+    return;
+  }
+  if (event_handle == 0 || event_handle > kMaxEventsInFlight) return;
+  EventInFlight& event = events_in_flight_[event_handle - 1];
+  if (event.op == nullptr) return;
+  const uint64_t end_us = time::NowMicros();
+  Record(event.op, end_us > event.begin_us ? end_us - event.begin_us : 0);
+  event.op = nullptr;
+}
+
+void SamplingProfiler::AddEvent(const char* tag, EventType event_type,
+                                uint64_t elapsed_time, int64_t event_metadata1,
+                                int64_t event_metadata2) {
+  if (!sampling_ || !IsOperatorEvent(event_type)) return;
+  OpEntry* op =
+      FindOrInsertOp(tag, event_type, event_metadata1, event_metadata2);
+  if (op != nullptr) Record(op, elapsed_time);
+}
+
+void SamplingProfiler::BeginInvocation() {
+  if (reset_requested_.exchange(false, std::memory_order_acquire)) {
+    ClearStats();
+  }
+  const uint64_t invocation =
+      num_invocations_.load(std::memory_order_relaxed);
+  num_invocations_.store(invocation + 1, std::memory_order_relaxed);
+  sampling_ = invocation % sampling_interval_ == 0;
+  if (sampling_) Increment(&num_sampled_invocations_, 1);
+}
+
+SamplingProfiler::OpEntry* SamplingProfiler::FindOrInsertOp(
+    const char* tag, EventType event_type, int64_t event_metadata1,
+    int64_t event_metadata2) {
+  const bool is_delegate_op =
+      event_type == EventType::DELEGATE_OPERATOR_INVOKE_EVENT;
+  const uint64_t key =
+      MakeKey(is_delegate_op, event_metadata1, event_metadata2);
+  // The table is never more than half full, so the probe always ends.
+  for (size_t index = HashKey(key) & table_mask_;;
+       index = (index + 1) & table_mask_) {
+    OpEntry& entry = ops_[index];
+    const uint64_t entry_key = entry.key.load(std::memory_order_relaxed);
+    if (entry_key == key) return &entry;
+    if (entry_key != kEmptyKey) continue;
+    if (num_ops_ == max_num_ops_) {
+      Increment(&num_dropped_events_, 1);
+      return nullptr;
+    }
+    if (tag != nullptr) {
+      std::strncpy(entry.tag, tag, kMaxTagLength);
+      entry.tag[kMaxTagLength] = '\0';
+    }
+    entry.is_delegate_op = is_delegate_op;
+    entry.node_index = event_metadata1;
+    entry.subgraph_index = event_metadata2;
+    entry.key.store(key, std::memory_order_release);
+    ++num_ops_;
+    return &entry;
+  }
+}
+
+void SamplingProfiler::Record(OpEntry* op, uint64_t elapsed_us) {
+  Increment(&op->count, 1);
+  Increment(&op->total_us, elapsed_us);
+  if (elapsed_us > op->max_us.load(std::memory_order_relaxed)) {
+    op->max_us.store(elapsed_us, std::memory_order_relaxed);
+  }
+  Increment(&op->histogram[HistogramBucket(elapsed_us)], 1);
+}
+
+void SamplingProfiler::ClearStats() {
+  // Entries stay in the table so that readers never see a slot change owner.
+  for (size_t i = 0; i <= table_mask_; ++i) {
+    OpEntry& entry = ops_[i];
+    entry.count.store(0, std::memory_order_relaxed);
+    entry.total_us.store(0, std::memory_order_relaxed);
+    entry.max_us.store(0, std::memory_order_relaxed);
+    for (auto& bucket : entry.histogram) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+  }
+  num_invocations_.store(0, std::memory_order_relaxed);
+  num_sampled_invocations_.store(0, std::memory_order_relaxed);
+  num_dropped_events_.store(0, std::memory_order_relaxed);
+}
+
+void SamplingProfiler::Reset() {
+  reset_requested_.store(true, std::memory_order_release);
+}
+
+SamplingProfiler::Summary SamplingProfiler::GetSummary() const {
+  Summary summary;
+  summary.num_invocations = num_invocations_.load(std::memory_order_relaxed);
+  summary.num_sampled_invocations =
+      num_sampled_invocations_.load(std::memory_order_relaxed);
+  summary.num_dropped_events =
+      num_dropped_events_.load(std::memory_order_relaxed);
+  for (size_t i = 0; i <= table_mask_; ++i) {
+    const OpEntry& entry = ops_[i];
+    if (entry.key.load(std::memory_order_acquire) == kEmptyKey) continue;
+    OpSummary op;
+    op.count = entry.count.load(std::memory_order_relaxed);
+    if (op.count == 0) continue;
+    op.tag = entry.tag;
+    op.is_delegate_op = entry.is_delegate_op;
+    op.node_index = entry.node_index;
+    op.subgraph_index = entry.subgraph_index;
+    op.total_us = entry.total_us.load(std::memory_order_relaxed);
+    op.max_us = entry.max_us.load(std::memory_order_relaxed);
+    for (int bucket = 0; bucket < kNumHistogramBuckets; ++bucket) {
+      op.histogram[bucket] =
+          entry.histogram[bucket].load(std::memory_order_relaxed);
+    }
+    summary.ops.push_back(std::move(op));
+  }
+  std::sort(summary.ops.begin(), summary.ops.end(),
+            [](const OpSummary& a, const OpSummary& b) {
+              return a.total_us > b.total_us;
+            });
+  return summary;
+}
+
+}  // namespace profiling
+}  // namespace tflite
@@ -0,0 +1,159 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_PROFILING_SAMPLING_PROFILER_H_
+#define TENSORFLOW_LITE_PROFILING_SAMPLING_PROFILER_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/core/api/profiler.h"
+
+namespace tflite {
+namespace profiling {
+
+/// A profiler cheap enough to stay attached in production.
+///
+/// Only one in every `sampling_interval` invocations is profiled; the
+/// operators of all other invocations cost a counter check. Durations of the
+/// sampled operators are folded into fixed-size per-op histograms, so memory
+/// does not grow with the number of invocations and nothing is dropped when an
+/// app runs for a long time.
+///
+/// Events must be reported from one thread at a time, as is the case for the
+/// RootProfiler of a single interpreter. `GetSummary` and `Reset` may be called
+/// from any thread while the interpreter is running and never block it.
+///
+/// Usage:
+///   auto profiler = std::make_unique<SamplingProfiler>(options);
+///   SamplingProfiler* sampling_profiler = profiler.get();
+///   interpreter->AddProfiler(std::move(profiler));
+///   ...
+///   SamplingProfiler::Summary summary = sampling_profiler->GetSummary();
+class SamplingProfiler : public Profiler {
+ public:
+  struct Options {
+    // Profiles one in every `sampling_interval` invocations. Values below 1
+    // are treated as 1, which profiles every invocation.
+    int sampling_interval = 100;
+    // Maximum number of distinct operators that are tracked. Operators seen
+    // after the table is full are counted in `Summary::num_dropped_events`.
+    int max_num_ops = 1024;
+  };
+
+  // Bucket 0 holds durations of 0us, and bucket i > 0 holds durations in
+  // [2^(i-1), 2^i) us. The last bucket also holds anything longer.
+  static constexpr int kNumHistogramBuckets = 32;
+  // Longer operator tags are truncated.
+  static constexpr int kMaxTagLength = 63;
+
+  struct OpSummary {
+    std::string tag;
+    // True for DELEGATE_OPERATOR_INVOKE_EVENT, whose indices are specific to
+    // the delegate.
+    bool is_delegate_op = false;
+    int64_t node_index = 0;
+    int64_t subgraph_index = 0;
+    uint64_t count = 0;
+    uint64_t total_us = 0;
+    uint64_t max_us = 0;
+    std::array<uint64_t, kNumHistogramBuckets> histogram = {};
+
+    // Returns an upper bound of the duration below which `percentile` (in
+    // [0, 100]) of the samples fall, with the precision of the histogram.
+    uint64_t ApproximatePercentileUs(double percentile) const;
+  };
+
+  struct Summary {
+    uint64_t num_invocations = 0;
+    uint64_t num_sampled_invocations = 0;
+    uint64_t num_dropped_events = 0;
+    // Sorted by decreasing `total_us`.
+    std::vector<OpSummary> ops;
+  };
+
+  explicit SamplingProfiler(const Options& options);
+  ~SamplingProfiler() override;
+
+  SamplingProfiler(const SamplingProfiler&) = delete;
+  SamplingProfiler& operator=(const SamplingProfiler&) = delete;
+
+  uint32_t BeginEvent(const char* tag, EventType event_type,
+                      int64_t event_metadata1,
+                      int64_t event_metadata2) override;
+
+  void EndEvent(uint32_t event_handle) override;
+
+  void AddEvent(const char* tag, EventType event_type, uint64_t elapsed_time,
+                int64_t event_metadata1, int64_t event_metadata2) override;
+
+  /// Returns the statistics gathered since construction or the last `Reset`.
+  Summary GetSummary() const;
+
+  /// Discards the gathered statistics. Takes effect at the beginning of the
+  /// next invocation so that it never races with an invocation in flight.
+  void Reset();
+
+ private:
+  struct OpEntry;
+
+  // Begin timestamps of events in flight, indexed by event handle. Events
+  // nest, so this only needs to be as deep as the deepest stack of events.
+  static constexpr uint32_t kMaxEventsInFlight = 64;
+  struct EventInFlight {
+    uint64_t begin_us = 0;
+    OpEntry* op = nullptr;
+  };
+
+  // Handles returned for invocation events carry this bit.
+  static constexpr uint32_t kInvocationHandleBit = 1u << 31;
+
+  static bool IsInvocationEvent(const char* tag, EventType event_type);
+  static bool IsOperatorEvent(EventType event_type);
+
+  void BeginInvocation();
+  OpEntry* FindOrInsertOp(const char* tag, EventType event_type,
+                          int64_t event_metadata1, int64_t event_metadata2);
+  void Record(OpEntry* op, uint64_t elapsed_us);
+  void ClearStats();
+
+  const uint32_t sampling_interval_;
+
+  // Only touched by the thread reporting events.
+  int invocation_depth_ = 0;
+  bool sampling_ = false;
+  uint32_t next_event_ = 0;
+  std::array<EventInFlight, kMaxEventsInFlight> events_in_flight_;
+
+  // Open addressing table, its size a power of two of at least twice
+  // `max_num_ops` so probes stay short.
+  const size_t max_num_ops_;
+  const size_t table_mask_;
+  std::unique_ptr<OpEntry[]> ops_;
+  size_t num_ops_ = 0;
+
+  std::atomic<uint64_t> num_invocations_{0};
+  std::atomic<uint64_t> num_sampled_invocations_{0};
+  std::atomic<uint64_t> num_dropped_events_{0};
+  std::atomic<bool> reset_requested_{false};
+};
+
+}  // namespace profiling
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_PROFILING_SAMPLING_PROFILER_H_
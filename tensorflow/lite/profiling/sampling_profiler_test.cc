@@ -0,0 +1,161 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/profiling/sampling_profiler.h"
+
+#include <cstdint>
+
+#include <gtest/gtest.h>
+#include "tensorflow/lite/core/api/profiler.h"
+#include "tensorflow/lite/profiling/root_profiler.h"
+
+namespace tflite {
+namespace profiling {
+namespace {
+
+using EventType = Profiler::EventType;
+
+// Reports one invocation of the primary subgraph running `num_nodes` ops the
+// way Interpreter::Invoke does.
+void Invoke(Profiler* profiler, int num_nodes) {
+  const uint32_t runtime_handle = profiler->BeginEvent(
+      "invoke", EventType::GENERAL_RUNTIME_INSTRUMENTATION_EVENT, 0, 0);
+  const uint32_t subgraph_handle =
+      profiler->BeginEvent("Invoke", EventType::DEFAULT, 0, 0);
+  for (int node = 0; node < num_nodes; ++node) {
+    const uint32_t handle = profiler->BeginEvent(
+        node % 2 ? "CONV_2D" : "ADD", EventType::OPERATOR_INVOKE_EVENT, node,
+        /*event_metadata2=*/0);
+    profiler->EndEvent(handle);
+  }
+  profiler->EndEvent(subgraph_handle);
+  profiler->EndEvent(runtime_handle, 0, 0);
+}
+
+TEST(SamplingProfilerTest, ProfilesOneInEveryInterval) {
+  SamplingProfiler::Options options;
+  options.sampling_interval = 4;
+  SamplingProfiler profiler(options);
+  for (int i = 0; i < 10; ++i) Invoke(&profiler, 3);
+
+  const SamplingProfiler::Summary summary = profiler.GetSummary();
+  EXPECT_EQ(summary.num_invocations, 10);
+  // Invocations 0, 4 and 8.
+  EXPECT_EQ(summary.num_sampled_invocations, 3);
+  EXPECT_EQ(summary.num_dropped_events, 0);
+  ASSERT_EQ(summary.ops.size(), 3);
+  for (const auto& op : summary.ops) {
+    EXPECT_EQ(op.count, 3);
+    EXPECT_EQ(op.tag, op.node_index % 2 ? "CONV_2D" : "ADD");
+    EXPECT_EQ(op.subgraph_index, 0);
+    EXPECT_FALSE(op.is_delegate_op);
+    uint64_t histogram_count = 0;
+    for (uint64_t bucket : op.histogram) histogram_count += bucket;
+    EXPECT_EQ(histogram_count, op.count);
+  }
+}
+
+TEST(SamplingProfilerTest, IgnoresOperatorsOutsideSampledInvocations) {
+  SamplingProfiler::Options options;
+  options.sampling_interval = 2;
+  SamplingProfiler profiler(options);
+  Invoke(&profiler, 1);
+  // Second invocation is not sampled.
+  Invoke(&profiler, 2);
+  // Operators reported outside any invocation are ignored too.
+  profiler.EndEvent(
+      profiler.BeginEvent("ADD", EventType::OPERATOR_INVOKE_EVENT, 5, 0));
+
+  const SamplingProfiler::Summary summary = profiler.GetSummary();
+  ASSERT_EQ(summary.ops.size(), 1);
+  EXPECT_EQ(summary.ops[0].node_index, 0);
+  EXPECT_EQ(summary.ops[0].count, 1);
+}
+
+TEST(SamplingProfilerTest, AggregatesAddedEventsIntoHistogram) {
+  SamplingProfiler::Options options;
+  options.sampling_interval = 1;
+  SamplingProfiler profiler(options);
+  const uint32_t handle =
+      profiler.BeginEvent("Invoke", EventType::DEFAULT, 0, 0);
+  for (uint64_t elapsed_us : {0, 1, 3, 100, 1000}) {
+    profiler.AddEvent("DelegateOp",
+                      EventType::DELEGATE_OPERATOR_INVOKE_EVENT, elapsed_us,
+                      /*event_metadata1=*/7, /*event_metadata2=*/1);
+  }
+  profiler.EndEvent(handle);
+
+  const SamplingProfiler::Summary summary = profiler.GetSummary();
+  ASSERT_EQ(summary.ops.size(), 1);
+  const SamplingProfiler::OpSummary& op = summary.ops[0];
+  EXPECT_TRUE(op.is_delegate_op);
+  EXPECT_EQ(op.node_index, 7);
+  EXPECT_EQ(op.subgraph_index, 1);
+  EXPECT_EQ(op.count, 5);
+  EXPECT_EQ(op.total_us, 1104);
+  EXPECT_EQ(op.max_us, 1000);
+  EXPECT_EQ(op.histogram[0], 1);
+  EXPECT_EQ(op.histogram[1], 1);
+  EXPECT_EQ(op.histogram[2], 1);
+  EXPECT_EQ(op.histogram[7], 1);
+  EXPECT_EQ(op.histogram[10], 1);
+  EXPECT_EQ(op.ApproximatePercentileUs(0), 0);
+  EXPECT_EQ(op.ApproximatePercentileUs(50), 3);
+  EXPECT_EQ(op.ApproximatePercentileUs(80), 127);
+  EXPECT_EQ(op.ApproximatePercentileUs(100), 1000);
+}
+
+TEST(SamplingProfilerTest, DropsOperatorsBeyondCapacity) {
+  SamplingProfiler::Options options;
+  options.sampling_interval = 1;
+  options.max_num_ops = 2;
+  SamplingProfiler profiler(options);
+  Invoke(&profiler, 3);
+
+  const SamplingProfiler::Summary summary = profiler.GetSummary();
+  EXPECT_EQ(summary.ops.size(), 2);
+  EXPECT_EQ(summary.num_dropped_events, 1);
+}
+
+TEST(SamplingProfilerTest, ResetTakesEffectAtNextInvocation) {
+  SamplingProfiler::Options options;
+  options.sampling_interval = 1;
+  SamplingProfiler profiler(options);
+  Invoke(&profiler, 2);
+  profiler.Reset();
+  EXPECT_EQ(profiler.GetSummary().num_invocations, 1);
+
+  Invoke(&profiler, 1);
+  const SamplingProfiler::Summary summary = profiler.GetSummary();
+  EXPECT_EQ(summary.num_invocations, 1);
+  ASSERT_EQ(summary.ops.size(), 1);
+  EXPECT_EQ(summary.ops[0].count, 1);
+}
+
+TEST(SamplingProfilerTest, WorksAsChildOfRootProfiler) {
+  SamplingProfiler::Options options;
+  options.sampling_interval = 1;
+  SamplingProfiler sampling_profiler(options);
+  RootProfiler root;
+  root.AddProfiler(&sampling_profiler);
+  Invoke(&root, 2);
+
+  const SamplingProfiler::Summary summary = sampling_profiler.GetSummary();
+  EXPECT_EQ(summary.num_sampled_invocations, 1);
+  EXPECT_EQ(summary.ops.size(), 2);
+}
+
+}  // namespace
+}  // namespace profiling
+}  // namespace tflite
@@ -284,6 +284,16 @@ TfLiteStatus SimpleMemoryArena::Allocate(
   return kTfLiteOk;
 }
 
+void SimpleMemoryArena::Restore(const ArenaAllocWithUsageInterval& alloc) {
+  if (alloc.size == 0) {
+    return;
+  }
+  high_water_mark_ = std::max(high_water_mark_, alloc.offset + alloc.size);
+  auto insertion_it =
+      std::upper_bound(active_allocs_.begin(), active_allocs_.end(), alloc);
+  active_allocs_.insert(insertion_it, alloc);
+}
+
 TfLiteStatus SimpleMemoryArena::Commit(bool* arena_reallocated) {
   // Resize the arena to the high water mark (calculated by Allocate), retaining
   // old contents and alignment in the process. Since Alloc pointers are offset
@@ -142,6 +142,10 @@ class SimpleMemoryArena {
                         int32_t tensor, int32_t first_node, int32_t last_node,
                         ArenaAllocWithUsageInterval* new_alloc);
 
+  // Reinstates `alloc`, previously returned by Allocate() for the same
+  // sequence of requests on an empty arena, without searching for a gap.
+  void Restore(const ArenaAllocWithUsageInterval& alloc);
+
   TfLiteStatus Commit(bool* arena_reallocated);
 
   TfLiteStatus ResolveAlloc(TfLiteContext* context,
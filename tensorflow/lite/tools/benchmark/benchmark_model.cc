@@ -361,6 +361,17 @@ TfLiteStatus BenchmarkModel::Run() {
   return status;
 }
 
+TfLiteStatus BenchmarkModel::InitForExternalRuns() {
+  TF_LITE_ENSURE_STATUS(ValidateParams());
+  TF_LITE_ENSURE_STATUS(Init());
+  return PrepareInputData();
+}
+
+TfLiteStatus BenchmarkModel::RunOnce() {
+  TF_LITE_ENSURE_STATUS(ResetInputsAndOutputs());
+  return RunImpl();
+}
+
 TfLiteStatus BenchmarkModel::ParseFlags(int* argc, char** argv) {
   auto flag_list = GetFlags();
   const bool parse_result =
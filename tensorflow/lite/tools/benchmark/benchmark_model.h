@@ -204,6 +204,15 @@ class BenchmarkModel {
   // will be updated accordingly.
   TfLiteStatus ParseFlags(int* argc, char** argv);
 
+  // Validates the params, initializes the model and prepares its input data
+  // without running it, for drivers that schedule invocations themselves
+  // through RunOnce().
+  TfLiteStatus InitForExternalRuns();
+
+  // Resets the inputs and outputs, then runs a single invocation. Listeners
+  // are not notified.
+  TfLiteStatus RunOnce();
+
  protected:
   virtual void LogParams();
   virtual TfLiteStatus ValidateParams();
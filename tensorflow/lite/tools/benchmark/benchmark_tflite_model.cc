@@ -611,6 +611,8 @@ BenchmarkParams BenchmarkTfLiteModel::DefaultParams() {
                           BenchmarkParam::Create<bool>(false));
   default_params.AddParam("enable_builtin_cast_constant_cache",
                           BenchmarkParam::Create<bool>(false));
+  default_params.AddParam("packed_weight_cache_path",
+                          BenchmarkParam::Create<std::string>(""));
   default_params.AddParam("output_filepath",
                           BenchmarkParam::Create<std::string>(""));
   default_params.AddParam("output_proto_filepath",
@@ -720,6 +722,10 @@ std::vector<Flag> BenchmarkTfLiteModel::GetFlags() {
           "enable_builtin_cast_constant_cache", &params_,
           "Cache the output of the builtin cast operation when its input "
           "is a constant tensor."),
+      CreateFlag<std::string>(
+          "packed_weight_cache_path", &params_,
+          "File to load the constant weights repacked by builtin kernels from, "
+          "and to save them to after the first run."),
       CreateFlag<std::string>(
           "output_filepath", &params_,
           "File path to export outputs layer as binary data."),
@@ -806,6 +812,8 @@ void BenchmarkTfLiteModel::LogParams() {
                       "Disable delegate clustering", verbose);
   LOG_BENCHMARK_PARAM(bool, "enable_builtin_cast_constant_cache",
                       "Constant CAST output cache", verbose);
+  LOG_BENCHMARK_PARAM(std::string, "packed_weight_cache_path",
+                      "Packed weight cache path", verbose);
   LOG_BENCHMARK_PARAM(std::string, "output_filepath",
                       "File path to export outputs layer to", verbose);
   LOG_BENCHMARK_PARAM(std::string, "output_proto_filepath",
@@ -1047,13 +1055,24 @@ TfLiteStatus BenchmarkTfLiteModel::InitInterpreter() {
     TFLITE_LOG(ERROR) << "Failed to initialize the interpreter";
     return kTfLiteError;
   }
+  const std::string packed_weight_cache_path =
+      params_.Get<std::string>("packed_weight_cache_path");
   // Manually enable caching behavior in TF Lite interpreter.
-  if (use_caching) {
+  if (use_caching || !packed_weight_cache_path.empty()) {
     external_context_ = std::make_unique<tflite::ExternalCpuBackendContext>();
     std::unique_ptr<tflite::CpuBackendContext> cpu_backend_context(
         new tflite::CpuBackendContext());
-    cpu_backend_context->SetUseCaching(true);
+    cpu_backend_context->SetUseCaching(use_caching);
     cpu_backend_context->SetMaxNumThreads(num_threads);
+    if (!packed_weight_cache_path.empty()) {
+      packed_weight_cache_ = std::make_unique<tflite::PackedWeightCache>();
+      if (packed_weight_cache_->Load(packed_weight_cache_path)) {
+        TFLITE_LOG(INFO) << "Loaded " << packed_weight_cache_->num_entries()
+                         << " packed weights from "
+                         << packed_weight_cache_path;
+      }
+      cpu_backend_context->SetPackedWeightCache(packed_weight_cache_.get());
+    }
     external_context_->set_internal_backend_context(
         std::move(cpu_backend_context));
     interpreter_->SetExternalContext(kTfLiteCpuBackendContext,
@@ -1299,7 +1318,12 @@ BenchmarkTfLiteModel::MayCreateProfilingListener() const {
 }
 
 TfLiteStatus BenchmarkTfLiteModel::RunImpl() {
-  return interpreter_runner_->Invoke();
+  TF_LITE_ENSURE_STATUS(interpreter_runner_->Invoke());
+  // Kernels repack their weights on the first run; this is a no-op afterwards.
+  if (packed_weight_cache_ && !packed_weight_cache_->Save()) {
+    TFLITE_LOG(WARN) << "Failed to save the packed weight cache.";
+  }
+  return kTfLiteOk;
 }
 
 }  // namespace benchmark
@@ -26,6 +26,7 @@ limitations under the License.
 
 #include "tensorflow/lite/core/model.h"
 #include "tensorflow/lite/core/subgraph.h"
+#include "tensorflow/lite/kernels/packed_weight_cache.h"
 #include "tensorflow/lite/profiling/profiler.h"
 #include "tensorflow/lite/signature_runner.h"
 #include "tensorflow/lite/tools/benchmark/benchmark_model.h"
@@ -195,6 +196,8 @@ class BenchmarkTfLiteModel : public BenchmarkModel {
   std::vector<InputLayerInfo> inputs_;
   std::vector<utils::InputTensorData> inputs_data_;
   std::unique_ptr<tflite::FlatBufferModel> model_;
+  // Declared before the interpreter, whose kernels use its buffers.
+  std::unique_ptr<tflite::PackedWeightCache> packed_weight_cache_;
   std::unique_ptr<tflite::Interpreter> interpreter_;
   std::unique_ptr<BenchmarkInterpreterRunner> interpreter_runner_;
   std::unique_ptr<tflite::ExternalCpuBackendContext> external_context_;
@@ -0,0 +1,364 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#include "tensorflow/lite/tools/benchmark/benchmark_throughput.h"
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
+#include <random>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/core/c/common.h"
+#include "tensorflow/lite/profiling/memory_info.h"
+#include "tensorflow/lite/profiling/time.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_params.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
+#include "tensorflow/lite/tools/command_line_flags.h"
+#include "tensorflow/lite/tools/logging.h"
+
+namespace tflite {
+namespace benchmark {
+namespace {
+
+// Returns the user plus system CPU time of the process in microseconds, or -1
+// if unsupported.
+int64_t ProcessCpuTimeUs() {
+#if !defined(_WIN32)
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+  return (static_cast<int64_t>(usage.ru_utime.tv_sec) +
+          usage.ru_stime.tv_sec) *
+             1000000 +
+         usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+#else
+  return -1;
+#endif
+}
+
+int64_t Percentile(const std::vector<int64_t>& sorted_values,
+                   double percentile) {
+  if (sorted_values.empty()) return 0;
+  const size_t rank = static_cast<size_t>(
+      std::ceil(percentile / 100.0 * sorted_values.size()));
+  return sorted_values[std::min(std::max<size_t>(rank, 1),
+                                sorted_values.size()) -
+                       1];
+}
+
+// Latencies and failures recorded by one context's thread.
+struct ContextRecord {
+  std::vector<int64_t> latencies_us;
+  int64_t num_failed = 0;
+  int64_t last_end_us = 0;
+};
+
+// Merges the records into 'results'. The measured wall time runs from
+// 'start_us' to the last completion, but at least to 'min_end_us'.
+void CollectRecords(const std::vector<ContextRecord>& records,
+                    int64_t start_us, int64_t min_end_us, int64_t cpu_us,
+                    BenchmarkThroughput::Results* results) {
+  int64_t last_end_us = min_end_us;
+  for (const auto& record : records) {
+    results->num_failed += record.num_failed;
+    results->latencies_us.insert(results->latencies_us.end(),
+                                 record.latencies_us.begin(),
+                                 record.latencies_us.end());
+    last_end_us = std::max(last_end_us, record.last_end_us);
+  }
+  results->num_completed =
+      static_cast<int64_t>(results->latencies_us.size()) - results->num_failed;
+  const int64_t wall_us = std::max<int64_t>(last_end_us - start_us, 1);
+  results->throughput_per_sec = results->num_completed * 1e6 / wall_us;
+  if (cpu_us >= 0) {
+    results->cpu_utilization_percent = 100.0 * cpu_us / wall_us;
+  }
+}
+
+}  // namespace
+
+BenchmarkThroughput::BenchmarkThroughput(ModelFactory model_factory)
+    : params_(DefaultParams()), model_factory_(std::move(model_factory)) {}
+
+BenchmarkParams BenchmarkThroughput::DefaultParams() {
+  BenchmarkParams params;
+  params.AddParam("throughput_num_contexts",
+                  BenchmarkParam::Create<int32_t>(2));
+  params.AddParam("throughput_duration_secs",
+                  BenchmarkParam::Create<float>(10.0f));
+  params.AddParam("throughput_arrival_rate",
+                  BenchmarkParam::Create<float>(0.0f));
+  params.AddParam("throughput_arrival_process",
+                  BenchmarkParam::Create<std::string>("poisson"));
+  params.AddParam("throughput_max_queue_size",
+                  BenchmarkParam::Create<int32_t>(1000));
+  params.AddParam("throughput_warmup_runs",
+                  BenchmarkParam::Create<int32_t>(1));
+  return params;
+}
+
+std::vector<Flag> BenchmarkThroughput::GetFlags() {
+  return {
+      CreateFlag<int32_t>("throughput_num_contexts", &params_,
+                          "The number of interpreters that serve requests "
+                          "concurrently, each on its own thread."),
+      CreateFlag<float>("throughput_duration_secs", &params_,
+                        "How long requests are issued for, in seconds."),
+      CreateFlag<float>(
+          "throughput_arrival_rate", &params_,
+          "The total number of requests per second issued open-loop. When "
+          "0, every interpreter runs back to back instead."),
+      CreateFlag<std::string>(
+          "throughput_arrival_process", &params_,
+          "How open-loop arrivals are spaced: 'poisson' or 'uniform'."),
+      CreateFlag<int32_t>("throughput_max_queue_size", &params_,
+                          "Open-loop requests arriving while this many are "
+                          "waiting are dropped."),
+      CreateFlag<int32_t>("throughput_warmup_runs", &params_,
+                          "The number of unmeasured runs of each interpreter "
+                          "before the measurement starts.")};
+}
+
+TfLiteStatus BenchmarkThroughput::ParseFlags(int* argc, char** argv) {
+  auto flag_list = GetFlags();
+  const bool parse_result =
+      Flags::Parse(argc, const_cast<const char**>(argv), flag_list);
+  if (!parse_result) {
+    std::string usage = Flags::Usage(argv[0], flag_list);
+    TFLITE_LOG(ERROR) << usage;
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus BenchmarkThroughput::InitContexts(
+    const BenchmarkParams& model_params) {
+  const int num_contexts = params_.Get<int32_t>("throughput_num_contexts");
+  const auto start_mem_usage = profiling::memory::GetMemoryUsage();
+  for (int i = 0; i < num_contexts; ++i) {
+    std::unique_ptr<BenchmarkModel> context = model_factory_();
+    context->mutable_params()->Set(model_params);
+    if (context->InitForExternalRuns() != kTfLiteOk) {
+      TFLITE_LOG(ERROR) << "Failed to initialize context " << i;
+      return kTfLiteError;
+    }
+    contexts_.push_back(std::move(context));
+  }
+  const auto mem_usage =
+      profiling::memory::GetMemoryUsage() - start_mem_usage;
+  results_.memory_per_context_kb = mem_usage.mem_footprint_kb / num_contexts;
+  results_.heap_per_context_bytes =
+      static_cast<int64_t>(mem_usage.in_use_allocated_bytes) / num_contexts;
+
+  const int warmup_runs = params_.Get<int32_t>("throughput_warmup_runs");
+  for (auto& context : contexts_) {
+    for (int run = 0; run < warmup_runs; ++run) {
+      TF_LITE_ENSURE_STATUS(context->RunOnce());
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus BenchmarkThroughput::RunClosedLoop() {
+  const int64_t start_us = profiling::time::NowMicros();
+  const int64_t end_us =
+      start_us + static_cast<int64_t>(
+                     params_.Get<float>("throughput_duration_secs") * 1e6);
+  std::vector<ContextRecord> records(contexts_.size());
+  std::vector<std::thread> threads;
+  const int64_t start_cpu_us = ProcessCpuTimeUs();
+  for (size_t i = 0; i < contexts_.size(); ++i) {
+    threads.emplace_back([&, i]() {
+      BenchmarkModel* context = contexts_[i].get();
+      ContextRecord& record = records[i];
+      for (int64_t now_us = profiling::time::NowMicros(); now_us < end_us;
+           now_us = record.last_end_us) {
+        if (context->RunOnce() != kTfLiteOk) ++record.num_failed;
+        record.last_end_us = profiling::time::NowMicros();
+        record.latencies_us.push_back(record.last_end_us - now_us);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  const int64_t end_cpu_us = ProcessCpuTimeUs();
+
+  CollectRecords(records, start_us, start_us,
+                 start_cpu_us >= 0 && end_cpu_us >= 0
+                     ? end_cpu_us - start_cpu_us
+                     : -1,
+                 &results_);
+  return kTfLiteOk;
+}
+
+TfLiteStatus BenchmarkThroughput::RunOpenLoop() {
+  const float arrival_rate = params_.Get<float>("throughput_arrival_rate");
+  const std::string arrival_process =
+      params_.Get<std::string>("throughput_arrival_process");
+  if (arrival_process != "poisson" && arrival_process != "uniform") {
+    TFLITE_LOG(ERROR) << "Unknown arrival process: " << arrival_process;
+    return kTfLiteError;
+  }
+  const size_t max_queue_size =
+      std::max(params_.Get<int32_t>("throughput_max_queue_size"), 1);
+
+  // Arrival timestamps of the requests waiting for an idle context.
+  std::mutex mutex;
+  std::condition_variable queue_cv;
+  std::deque<int64_t> queue;
+  bool done = false;
+
+  std::vector<ContextRecord> records(contexts_.size());
+  std::vector<std::thread> threads;
+  const int64_t start_cpu_us = ProcessCpuTimeUs();
+  const int64_t start_us = profiling::time::NowMicros();
+  for (size_t i = 0; i < contexts_.size(); ++i) {
+    threads.emplace_back([&, i]() {
+      BenchmarkModel* context = contexts_[i].get();
+      ContextRecord& record = records[i];
+      while (true) {
+        int64_t arrival_us;
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          queue_cv.wait(lock, [&]() { return done || !queue.empty(); });
+          if (queue.empty()) return;
+          arrival_us = queue.front();
+          queue.pop_front();
+        }
+        if (context->RunOnce() != kTfLiteOk) ++record.num_failed;
+        record.last_end_us = profiling::time::NowMicros();
+        record.latencies_us.push_back(record.last_end_us - arrival_us);
+      }
+    });
+  }
+
+  // A fixed seed keeps the arrival pattern identical across runs.
+  std::mt19937 random_engine(0);
+  std::exponential_distribution<double> interarrival_secs(arrival_rate);
+  const int64_t end_us =
+      start_us + static_cast<int64_t>(
+                     params_.Get<float>("throughput_duration_secs") * 1e6);
+  double next_arrival_us = start_us;
+  while (next_arrival_us < end_us) {
+    util::SleepForSeconds((next_arrival_us - profiling::time::NowMicros()) *
+                          1e-6);
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (queue.size() >= max_queue_size) {
+        ++results_.num_dropped;
+      } else {
+        queue.push_back(static_cast<int64_t>(next_arrival_us));
+      }
+    }
+    queue_cv.notify_one();
+    next_arrival_us += arrival_process == "poisson"
+                           ? interarrival_secs(random_engine) * 1e6
+                           : 1e6 / arrival_rate;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    done = true;
+  }
+  queue_cv.notify_all();
+  for (auto& thread : threads) thread.join();
+  const int64_t end_cpu_us = ProcessCpuTimeUs();
+
+  // Idle time at the end of the arrival window counts towards the wall time.
+  CollectRecords(records, start_us, end_us,
+                 start_cpu_us >= 0 && end_cpu_us >= 0
+                     ? end_cpu_us - start_cpu_us
+                     : -1,
+                 &results_);
+  return kTfLiteOk;
+}
+
+void BenchmarkThroughput::LogResults() const {
+  const auto& latencies = results_.latencies_us;
+  int64_t sum_us = 0;
+  for (int64_t latency : latencies) sum_us += latency;
+  TFLITE_LOG(INFO) << "Contexts: " << contexts_.size()
+                   << ", completed: " << results_.num_completed
+                   << ", failed: " << results_.num_failed
+                   << ", dropped: " << results_.num_dropped;
+  TFLITE_LOG(INFO) << "Throughput (requests/s): "
+                   << results_.throughput_per_sec;
+  if (!latencies.empty()) {
+    TFLITE_LOG(INFO) << "Latency (us): avg=" << sum_us / latencies.size()
+                     << " p50=" << Percentile(latencies, 50)
+                     << " p90=" << Percentile(latencies, 90)
+                     << " p95=" << Percentile(latencies, 95)
+                     << " p99=" << Percentile(latencies, 99)
+                     << " max=" << latencies.back();
+  }
+  TFLITE_LOG(INFO) << "Memory per context: footprint="
+                   << results_.memory_per_context_kb
+                   << "KB heap=" << results_.heap_per_context_bytes << "B";
+  if (results_.cpu_utilization_percent >= 0) {
+    TFLITE_LOG(INFO) << "CPU utilization (% of one core): "
+                     << results_.cpu_utilization_percent << " of "
+                     << 100 * std::thread::hardware_concurrency();
+  }
+}
+
+TfLiteStatus BenchmarkThroughput::Run(int argc, char** argv) {
+  // Parse flags that are supported by this particular binary first.
+  if (TfLiteStatus status = ParseFlags(&argc, argv); status != kTfLiteOk) {
+    TFLITE_LOG(ERROR) << "Error while parsing the throughput flags: "
+                      << status;
+    return status;
+  }
+  if (params_.Get<int32_t>("throughput_num_contexts") < 1) {
+    TFLITE_LOG(ERROR) << "throughput_num_contexts must be positive.";
+    return kTfLiteError;
+  }
+  if (params_.Get<float>("throughput_arrival_rate") < 0) {
+    TFLITE_LOG(ERROR) << "throughput_arrival_rate must not be negative.";
+    return kTfLiteError;
+  }
+
+  // Then parse flags for the contexts, which all share the same params.
+  std::unique_ptr<BenchmarkModel> model = model_factory_();
+  if (TfLiteStatus status = model->ParseFlags(&argc, argv);
+      status != kTfLiteOk) {
+    TFLITE_LOG(ERROR) << "Error while parsing the flags for the contexts: "
+                      << status;
+    return status;
+  }
+  for (int i = 1; i < argc; ++i) {
+    TFLITE_LOG(WARN) << "WARNING: unrecognized commandline flag: " << argv[i];
+  }
+
+  TF_LITE_ENSURE_STATUS(InitContexts(*model->mutable_params()));
+  model.reset();
+  TF_LITE_ENSURE_STATUS(params_.Get<float>("throughput_arrival_rate") > 0
+                            ? RunOpenLoop()
+                            : RunClosedLoop());
+  std::sort(results_.latencies_us.begin(), results_.latencies_us.end());
+  LogResults();
+  return results_.num_failed == 0 ? kTfLiteOk : kTfLiteError;
+}
+
+}  // namespace benchmark
+}  // namespace tflite
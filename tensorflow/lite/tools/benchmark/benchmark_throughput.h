@@ -0,0 +1,92 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_THROUGHPUT_H_
+#define TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_THROUGHPUT_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_model.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_params.h"
+#include "tensorflow/lite/tools/command_line_flags.h"
+
+namespace tflite {
+namespace benchmark {
+
+// Measures the serving capacity of a model by running
+// --throughput_num_contexts independent 'BenchmarkModel' instances, each with
+// its own interpreter, on their own threads for --throughput_duration_secs.
+//
+// With --throughput_arrival_rate > 0 the load is open-loop: requests arrive at
+// that total rate, independent of how fast they are served, and wait in a
+// shared queue for the next idle context. Latency is measured from arrival to
+// completion and so includes queueing. Otherwise every context invokes back to
+// back and latency is the service time alone.
+//
+// The report contains throughput, latency percentiles, the memory added per
+// context and the process CPU utilization.
+class BenchmarkThroughput {
+ public:
+  using ModelFactory = std::function<std::unique_ptr<BenchmarkModel>()>;
+
+  struct Results {
+    int64_t num_completed = 0;
+    int64_t num_failed = 0;
+    // Requests dropped because the queue was full, i.e. the arrival rate
+    // exceeds the capacity.
+    int64_t num_dropped = 0;
+    double throughput_per_sec = 0;
+    // Latencies in microseconds, sorted.
+    std::vector<int64_t> latencies_us;
+    int64_t memory_per_context_kb = 0;
+    int64_t heap_per_context_bytes = 0;
+    // Process CPU time over wall time, in percent of one core. Negative if
+    // unsupported on the platform.
+    double cpu_utilization_percent = -1;
+  };
+
+  explicit BenchmarkThroughput(ModelFactory model_factory);
+
+  TfLiteStatus Run(int argc, char** argv);
+
+  const Results& results() const { return results_; }
+
+ private:
+  static BenchmarkParams DefaultParams();
+
+  // Unparsable flags will remain in 'argv' in the original order and 'argc'
+  // will be updated accordingly.
+  TfLiteStatus ParseFlags(int* argc, char** argv);
+  std::vector<Flag> GetFlags();
+
+  // Creates and initializes the contexts and records the memory they take.
+  TfLiteStatus InitContexts(const BenchmarkParams& model_params);
+  TfLiteStatus RunClosedLoop();
+  TfLiteStatus RunOpenLoop();
+  void LogResults() const;
+
+  BenchmarkParams params_;
+  ModelFactory model_factory_;
+  std::vector<std::unique_ptr<BenchmarkModel>> contexts_;
+  Results results_;
+};
+
+}  // namespace benchmark
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_THROUGHPUT_H_
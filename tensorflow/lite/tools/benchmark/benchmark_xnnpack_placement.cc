@@ -0,0 +1,250 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/benchmark/benchmark_xnnpack_placement.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/model_builder.h"
+#include "tensorflow/lite/schema/schema_generated.h"
+#include "tensorflow/lite/schema/schema_utils.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_params.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_utils.h"
+#include "tensorflow/lite/tools/command_line_flags.h"
+#include "tensorflow/lite/tools/delegates/xnnpack_placement_plan.h"
+#include "tensorflow/lite/tools/logging.h"
+
+namespace tflite {
+namespace benchmark {
+
+BenchmarkXnnpackPlacement::BenchmarkXnnpackPlacement(
+    BenchmarkModel* single_run)
+    : params_(DefaultParams()),
+      single_run_(single_run),
+      single_run_params_(single_run->mutable_params()) {
+  single_run_->AddListener(this);
+}
+
+BenchmarkParams BenchmarkXnnpackPlacement::DefaultParams() {
+  BenchmarkParams params;
+  params.AddParam("placement_plan_output",
+                  BenchmarkParam::Create<std::string>(""));
+  params.AddParam("placement_candidate_ops",
+                  BenchmarkParam::Create<std::string>(""));
+  params.AddParam("placement_max_candidates",
+                  BenchmarkParam::Create<int32_t>(64));
+  params.AddParam("placement_min_improvement",
+                  BenchmarkParam::Create<float>(0.02f));
+  return params;
+}
+
+std::vector<Flag> BenchmarkXnnpackPlacement::GetFlags() {
+  return {
+      CreateFlag<std::string>(
+          "placement_plan_output", &params_,
+          "Path of the XNNPack placement plan to write. It always holds the "
+          "best plan found so far and can be passed to "
+          "--xnnpack_placement_plan_file."),
+      CreateFlag<std::string>(
+          "placement_candidate_ops", &params_,
+          "A comma-separated list of builtin operator names, e.g. "
+          "'FULLY_CONNECTED,DEPTHWISE_CONV_2D', whose nodes are tried on the "
+          "builtin kernels. By default, every node is a candidate."),
+      CreateFlag<int32_t>("placement_max_candidates", &params_,
+                          "The maximum number of candidate nodes to try, in "
+                          "execution order."),
+      CreateFlag<float>(
+          "placement_min_improvement", &params_,
+          "The minimum relative latency reduction for a node to be kept on "
+          "the builtin kernels, which guards against benchmark noise.")};
+}
+
+TfLiteStatus BenchmarkXnnpackPlacement::ParseFlags(int* argc, char** argv) {
+  auto flag_list = GetFlags();
+  const bool parse_result =
+      Flags::Parse(argc, const_cast<const char**>(argv), flag_list);
+  if (!parse_result) {
+    std::string usage = Flags::Usage(argv[0], flag_list);
+    TFLITE_LOG(ERROR) << usage;
+    return kTfLiteError;
+  }
+  return kTfLiteOk;
+}
+
+void BenchmarkXnnpackPlacement::OnBenchmarkEnd(
+    const BenchmarkResults& results) {
+  last_latency_us_ = results.inference_time_us().avg();
+}
+
+TfLiteStatus BenchmarkXnnpackPlacement::FindCandidateNodes(
+    std::vector<int>* candidates) const {
+  const std::string& graph = single_run_params_->Get<std::string>("graph");
+  std::unique_ptr<FlatBufferModel> model =
+      FlatBufferModel::BuildFromFile(graph.c_str());
+  if (!model) {
+    TFLITE_LOG(ERROR) << "Failed to mmap model " << graph;
+    return kTfLiteError;
+  }
+  const Model* flatbuffer_model = model->GetModel();
+  if (!flatbuffer_model->subgraphs() || !flatbuffer_model->operator_codes() ||
+      flatbuffer_model->subgraphs()->size() == 0) {
+    TFLITE_LOG(ERROR) << "Model " << graph << " has no operators.";
+    return kTfLiteError;
+  }
+
+  std::vector<std::string> candidate_ops;
+  const std::string& candidate_ops_list =
+      params_.Get<std::string>("placement_candidate_ops");
+  if (!candidate_ops_list.empty() &&
+      !util::SplitAndParse(candidate_ops_list, ',', &candidate_ops)) {
+    TFLITE_LOG(ERROR) << "Cannot parse --placement_candidate_ops: '"
+                      << candidate_ops_list << "'.";
+    return kTfLiteError;
+  }
+
+  // Nodes of the primary subgraph are created in the order of its operators,
+  // so operator indices are also node indices.
+  const auto* operators = flatbuffer_model->subgraphs()->Get(0)->operators();
+  const int num_operators = operators ? operators->size() : 0;
+  const int max_candidates = params_.Get<int32_t>("placement_max_candidates");
+  candidates->clear();
+  for (int i = 0; i < num_operators &&
+                  static_cast<int>(candidates->size()) < max_candidates;
+       ++i) {
+    const uint32_t opcode_index = operators->Get(i)->opcode_index();
+    if (opcode_index >= flatbuffer_model->operator_codes()->size()) continue;
+    const BuiltinOperator op = GetBuiltinCode(
+        flatbuffer_model->operator_codes()->Get(opcode_index));
+    if (candidate_ops.empty() ||
+        std::find(candidate_ops.begin(), candidate_ops.end(),
+                  EnumNameBuiltinOperator(op)) != candidate_ops.end()) {
+      candidates->push_back(i);
+    }
+  }
+  return kTfLiteOk;
+}
+
+TfLiteStatus BenchmarkXnnpackPlacement::Measure(
+    const std::vector<int>& nodes_to_skip, double* latency_us) {
+  const std::string& plan_file =
+      params_.Get<std::string>("placement_plan_output");
+  if (!tools::WriteXnnpackPlacementPlan(plan_file, nodes_to_skip)) {
+    TFLITE_LOG(ERROR) << "Failed to write placement plan to " << plan_file;
+    return kTfLiteError;
+  }
+
+  // Clear the listeners that the single run created internally during its
+  // previous Run(), but keep externally added ones like this one.
+  single_run_->RemoveListeners(num_external_listeners_);
+  last_latency_us_ = -1.0;
+  if (TfLiteStatus status = single_run_->Run(); status != kTfLiteOk) {
+    TFLITE_LOG(ERROR) << "Error while running the benchmark: " << status;
+    return status;
+  }
+  if (last_latency_us_ < 0) return kTfLiteError;
+  *latency_us = last_latency_us_;
+  return kTfLiteOk;
+}
+
+TfLiteStatus BenchmarkXnnpackPlacement::Run() {
+  if (params_.Get<std::string>("placement_plan_output").empty()) {
+    TFLITE_LOG(ERROR) << "--placement_plan_output must be set.";
+    return kTfLiteError;
+  }
+  std::vector<int> candidates;
+  if (TfLiteStatus status = FindCandidateNodes(&candidates);
+      status != kTfLiteOk) {
+    return status;
+  }
+
+  num_external_listeners_ = single_run_->NumListeners();
+  single_run_params_->Set<bool>("use_xnnpack", true);
+  single_run_params_->Set<std::string>(
+      "xnnpack_placement_plan_file",
+      params_.Get<std::string>("placement_plan_output"));
+
+  std::vector<int> best_plan;
+  double best_latency_us;
+  if (TfLiteStatus status = Measure(best_plan, &best_latency_us);
+      status != kTfLiteOk) {
+    return status;
+  }
+  TFLITE_LOG(INFO) << "Full XNNPack delegation: " << best_latency_us << " us, "
+                   << candidates.size() << " candidate node(s).";
+
+  const float min_improvement =
+      params_.Get<float>("placement_min_improvement");
+  for (const int node_index : candidates) {
+    std::vector<int> plan = best_plan;
+    plan.push_back(node_index);
+    double latency_us;
+    if (TfLiteStatus status = Measure(plan, &latency_us);
+        status != kTfLiteOk) {
+      return status;
+    }
+    const bool keep = latency_us < best_latency_us * (1.0 - min_improvement);
+    TFLITE_LOG(INFO) << "Node " << node_index << " on builtin kernels: "
+                     << latency_us << " us" << (keep ? ", kept." : ".");
+    if (keep) {
+      best_plan = std::move(plan);
+      best_latency_us = latency_us;
+    }
+  }
+
+  const std::string& plan_file =
+      params_.Get<std::string>("placement_plan_output");
+  if (!tools::WriteXnnpackPlacementPlan(plan_file, best_plan)) {
+    TFLITE_LOG(ERROR) << "Failed to write placement plan to " << plan_file;
+    return kTfLiteError;
+  }
+  TFLITE_LOG(INFO) << "Wrote a placement plan keeping " << best_plan.size()
+                   << " node(s) on the builtin kernels (" << best_latency_us
+                   << " us) to " << plan_file;
+  return kTfLiteOk;
+}
+
+TfLiteStatus BenchmarkXnnpackPlacement::Run(int argc, char** argv) {
+  // Parse flags that are supported by this particular binary first.
+  if (TfLiteStatus status = ParseFlags(&argc, argv); status != kTfLiteOk) {
+    TFLITE_LOG(ERROR) << "Error while parsing the placement search flags: "
+                      << status;
+    return status;
+  }
+
+  // Then parse flags for single runs to get information like parameters of
+  // the input model etc.
+  if (TfLiteStatus status = single_run_->ParseFlags(&argc, argv);
+      status != kTfLiteOk) {
+    TFLITE_LOG(ERROR) << "Error while parsing the flags for single runs: "
+                      << status;
+    return status;
+  }
+
+  // Now, the remaining are unrecognized flags and we simply print them out.
+  for (int i = 1; i < argc; ++i) {
+    TFLITE_LOG(WARN) << "WARNING: unrecognized commandline flag: " << argv[i];
+  }
+
+  return Run();
+}
+
+}  // namespace benchmark
+}  // namespace tflite
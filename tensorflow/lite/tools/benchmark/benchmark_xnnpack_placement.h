@@ -0,0 +1,84 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_XNNPACK_PLACEMENT_H_
+#define TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_XNNPACK_PLACEMENT_H_
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/lite/core/c/c_api_types.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_model.h"
+#include "tensorflow/lite/tools/benchmark/benchmark_params.h"
+#include "tensorflow/lite/tools/command_line_flags.h"
+
+namespace tflite {
+namespace benchmark {
+
+// Searches for a placement of the model's nodes between the XNNPack delegate
+// and the builtin TFLite kernels by repeatedly invoking the single run on a
+// passed-in 'BenchmarkModel' object with --xnnpack_placement_plan_file set.
+//
+// Starting from full XNNPack delegation, each candidate node is moved back to
+// the builtin kernels in turn and kept there if that lowers the average
+// inference latency by more than --placement_min_improvement. Latency is
+// measured end to end, which also accounts for the cost of splitting the
+// delegated partitions. The best plan found is written to
+// --placement_plan_output.
+class BenchmarkXnnpackPlacement : public BenchmarkListener {
+ public:
+  // Doesn't own the memory of 'single_run'.
+  explicit BenchmarkXnnpackPlacement(BenchmarkModel* single_run);
+
+  TfLiteStatus Run();
+  TfLiteStatus Run(int argc, char** argv);
+
+  void OnBenchmarkEnd(const BenchmarkResults& results) override;
+
+ private:
+  static BenchmarkParams DefaultParams();
+
+  // Unparsable flags will remain in 'argv' in the original order and 'argc'
+  // will be updated accordingly.
+  TfLiteStatus ParseFlags(int* argc, char** argv);
+  std::vector<Flag> GetFlags();
+
+  // Collects the indices of the primary subgraph's nodes whose builtin
+  // operator is listed in --placement_candidate_ops.
+  TfLiteStatus FindCandidateNodes(std::vector<int>* candidates) const;
+
+  // Benchmarks the model with 'nodes_to_skip' kept off XNNPack and returns the
+  // average inference latency in microseconds through 'latency_us'.
+  TfLiteStatus Measure(const std::vector<int>& nodes_to_skip,
+                       double* latency_us);
+
+  BenchmarkParams params_;
+
+  // The object that drives a single benchmark run.
+  BenchmarkModel* const single_run_;          // Doesn't own the memory.
+  BenchmarkParams* const single_run_params_;  // Doesn't own the memory.
+
+  // The number of listeners added to 'single_run_' before the search started.
+  int num_external_listeners_ = 0;
+
+  // The average inference latency of the last completed run, or a negative
+  // value if the run didn't complete.
+  double last_latency_us_ = -1.0;
+};
+
+}  // namespace benchmark
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_BENCHMARK_BENCHMARK_XNNPACK_PLACEMENT_H_
@@ -170,6 +170,14 @@ TfLiteDelegatePtr GpuDelegateProvider::CreateTfLiteDelegate(
       gpu_opts.serialization_dir = serialize_dir.c_str();
       gpu_opts.model_token = serialize_token.c_str();
     }
+    // Compiled programs are shared across models, so only the directory is
+    // needed to cache them.
+    if (!serialize_dir.empty()) {
+      gpu_opts.experimental_flags =
+          gpu_opts.experimental_flags |
+          TFLITE_GPU_EXPERIMENTAL_FLAGS_ENABLE_PROGRAM_CACHE;
+      gpu_opts.serialization_dir = serialize_dir.c_str();
+    }
 
     delegate = evaluation::CreateGPUDelegate(&gpu_opts);
 #elif defined(REAL_IPHONE_DEVICE)
@@ -14,8 +14,10 @@ limitations under the License.
 ==============================================================================*/
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "tensorflow/lite/tools/delegates/delegate_provider.h"
+#include "tensorflow/lite/tools/delegates/xnnpack_placement_plan.h"
 #include "tensorflow/lite/tools/evaluation/utils.h"
 
 namespace tflite {
@@ -29,6 +31,8 @@ class XnnpackDelegateProvider : public DelegateProvider {
                              ToolParam::Create<bool>(false));
     default_params_.AddParam("xnnpack_weight_cache_file_path",
                              ToolParam::Create<std::string>(""));
+    default_params_.AddParam("xnnpack_placement_plan_file",
+                             ToolParam::Create<std::string>(""));
   }
 
   std::vector<Flag> CreateFlags(ToolParams* params) const final;
@@ -58,6 +62,11 @@ std::vector<Flag> XnnpackDelegateProvider::CreateFlags(
                        "enforce float16 inference."),
       CreateFlag<std::string>("xnnpack_weight_cache_file_path", params,
                               "enable file-backed weight caching."),
+      CreateFlag<std::string>(
+          "xnnpack_placement_plan_file", params,
+          "path to a placement plan listing the node indices that should "
+          "stay on the builtin kernels instead of XNNPACK, e.g. as written "
+          "by benchmark_xnnpack_placement."),
   };
   return flags;
 }
@@ -69,15 +78,27 @@ void XnnpackDelegateProvider::LogParams(const ToolParams& params,
                  verbose);
   LOG_TOOL_PARAM(params, std::string, "xnnpack_weight_cache_file_path",
                  "xnnpack_weight_cache_file_path", verbose);
+  LOG_TOOL_PARAM(params, std::string, "xnnpack_placement_plan_file",
+                 "xnnpack_placement_plan_file", verbose);
 }
 
 TfLiteDelegatePtr XnnpackDelegateProvider::CreateTfLiteDelegate(
     const ToolParams& params) const {
   if (params.Get<bool>("use_xnnpack")) {
+    std::vector<int> nodes_to_skip;
+    const std::string plan_file =
+        params.Get<std::string>("xnnpack_placement_plan_file");
+    if (!plan_file.empty() &&
+        !ReadXnnpackPlacementPlan(plan_file, &nodes_to_skip)) {
+      TFLITE_LOG(ERROR) << "Failed to read XNNPACK placement plan from '"
+                        << plan_file << "'.";
+      return CreateNullDelegate();
+    }
     return evaluation::CreateXNNPACKDelegate(
         params.Get<int32_t>("num_threads"),
         params.Get<bool>("xnnpack_force_fp16"),
-        params.Get<std::string>("xnnpack_weight_cache_file_path").c_str());
+        params.Get<std::string>("xnnpack_weight_cache_file_path").c_str(),
+        nodes_to_skip);
   }
   return CreateNullDelegate();
 }
@@ -75,6 +75,16 @@ TEST(XNNPackDelegateProviderTest, Test) {
                 testing::StrEq(kFakeCacheParam));
     EXPECT_TRUE(options->flags & TFLITE_XNNPACK_DELEGATE_FLAG_FORCE_FP16);
   }
+
+  EXPECT_TRUE(params.HasParam("xnnpack_placement_plan_file"));
+  params.Set<std::string>(
+      "xnnpack_placement_plan_file",
+      testing::TempDir() + "/XNNPackDelegateProviderTest.missing_plan",
+      /*position=*/3);
+  {
+    TfLiteDelegatePtr delegate = xnnpack_provider->CreateTfLiteDelegate(params);
+    EXPECT_EQ(delegate, nullptr);
+  }
 }
 
 }  // namespace
@@ -0,0 +1,59 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/delegates/xnnpack_placement_plan.h"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace tflite {
+namespace tools {
+
+bool ReadXnnpackPlacementPlan(const std::string& path,
+                              std::vector<int>* nodes_to_skip) {
+  std::ifstream file(path);
+  if (!file) return false;
+  nodes_to_skip->clear();
+  std::string line;
+  while (std::getline(file, line)) {
+    std::istringstream stream(line);
+    std::string token;
+    if (!(stream >> token) || token[0] == '#') continue;
+    std::istringstream number(token);
+    int node_index;
+    if (!(number >> node_index) || !number.eof() || node_index < 0 ||
+        (stream >> token)) {
+      return false;
+    }
+    nodes_to_skip->push_back(node_index);
+  }
+  return true;
+}
+
+bool WriteXnnpackPlacementPlan(const std::string& path,
+                               const std::vector<int>& nodes_to_skip) {
+  std::ofstream file(path, std::ios::trunc);
+  if (!file) return false;
+  file << "# Nodes to run on the builtin TFLite kernels instead of XNNPack.\n";
+  for (const int node_index : nodes_to_skip) {
+    file << node_index << "\n";
+  }
+  return static_cast<bool>(file);
+}
+
+}  // namespace tools
+}  // namespace tflite
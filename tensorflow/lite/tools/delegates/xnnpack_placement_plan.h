@@ -0,0 +1,42 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_LITE_TOOLS_DELEGATES_XNNPACK_PLACEMENT_PLAN_H_
+#define TENSORFLOW_LITE_TOOLS_DELEGATES_XNNPACK_PLACEMENT_PLAN_H_
+
+#include <string>
+#include <vector>
+
+namespace tflite {
+namespace tools {
+
+// An XNNPack placement plan lists the nodes of a model that should run on the
+// builtin TFLite kernels instead of the XNNPack delegate, as measured by
+// benchmark_xnnpack_placement. It is stored as text with one node index per
+// line; empty lines and lines starting with '#' are ignored.
+
+// Reads the node indices from `path`. Returns false if the file can't be read
+// or contains anything other than node indices.
+bool ReadXnnpackPlacementPlan(const std::string& path,
+                              std::vector<int>* nodes_to_skip);
+
+// Writes `nodes_to_skip` to `path`, replacing its contents.
+bool WriteXnnpackPlacementPlan(const std::string& path,
+                               const std::vector<int>& nodes_to_skip);
+
+}  // namespace tools
+}  // namespace tflite
+
+#endif  // TENSORFLOW_LITE_TOOLS_DELEGATES_XNNPACK_PLACEMENT_PLAN_H_
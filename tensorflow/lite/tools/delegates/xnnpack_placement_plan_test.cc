@@ -0,0 +1,83 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/lite/tools/delegates/xnnpack_placement_plan.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+namespace tflite {
+namespace tools {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+std::string PlanPath(const std::string& name) {
+  return ::testing::TempDir() + "/" + name;
+}
+
+TEST(XnnpackPlacementPlanTest, RoundTrip) {
+  const std::string path = PlanPath("round_trip.plan");
+  ASSERT_TRUE(WriteXnnpackPlacementPlan(path, {3, 0, 17}));
+  std::vector<int> nodes_to_skip = {42};
+  ASSERT_TRUE(ReadXnnpackPlacementPlan(path, &nodes_to_skip));
+  EXPECT_THAT(nodes_to_skip, ElementsAre(3, 0, 17));
+}
+
+TEST(XnnpackPlacementPlanTest, EmptyPlan) {
+  const std::string path = PlanPath("empty.plan");
+  ASSERT_TRUE(WriteXnnpackPlacementPlan(path, {}));
+  std::vector<int> nodes_to_skip;
+  ASSERT_TRUE(ReadXnnpackPlacementPlan(path, &nodes_to_skip));
+  EXPECT_THAT(nodes_to_skip, IsEmpty());
+}
+
+TEST(XnnpackPlacementPlanTest, IgnoresCommentsAndBlankLines) {
+  const std::string path = PlanPath("comments.plan");
+  {
+    std::ofstream file(path);
+    file << "# measured on device\n\n  5\n# 6\n7  \n";
+  }
+  std::vector<int> nodes_to_skip;
+  ASSERT_TRUE(ReadXnnpackPlacementPlan(path, &nodes_to_skip));
+  EXPECT_THAT(nodes_to_skip, ElementsAre(5, 7));
+}
+
+TEST(XnnpackPlacementPlanTest, RejectsMalformedLines) {
+  for (const char* contents : {"1\nfoo\n", "-2\n", "3 4\n", "5x\n"}) {
+    const std::string path = PlanPath("malformed.plan");
+    {
+      std::ofstream file(path);
+      file << contents;
+    }
+    std::vector<int> nodes_to_skip;
+    EXPECT_FALSE(ReadXnnpackPlacementPlan(path, &nodes_to_skip)) << contents;
+  }
+}
+
+TEST(XnnpackPlacementPlanTest, MissingFile) {
+  std::vector<int> nodes_to_skip;
+  EXPECT_FALSE(ReadXnnpackPlacementPlan(PlanPath("does_not_exist.plan"),
+                                        &nodes_to_skip));
+}
+
+}  // namespace
+}  // namespace tools
+}  // namespace tflite
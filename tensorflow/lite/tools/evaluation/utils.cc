@@ -26,6 +26,7 @@ limitations under the License.
 
 #include "flatbuffers/buffer.h"  // from @flatbuffers
 #include "flatbuffers/string.h"  // from @flatbuffers
+#include "flatbuffers/vector.h"  // from @flatbuffers
 #include "tensorflow/lite/tools/delegates/delegate_provider.h"
 
 #if defined(__APPLE__)
@@ -186,7 +187,8 @@ TfLiteDelegatePtr CreateHexagonDelegate(
 
 #ifdef TFLITE_WITHOUT_XNNPACK
 TfLiteDelegatePtr CreateXNNPACKDelegate(int num_threads, bool force_fp16,
-                                        const char* weight_cache_file_path) {
+                                        const char* weight_cache_file_path,
+                                        const std::vector<int>& nodes_to_skip) {
   return tools::CreateNullDelegate();
 }
 #else  // !defined(TFLITE_WITHOUT_XNNPACK)
@@ -226,6 +228,12 @@ TfLiteDelegatePtr CreateXNNPACKDelegate(
     weight_cache_file_path = flatbuffer_builder.CreateString(
         xnnpack_options->weight_cache_file_path);
   }
+  flatbuffers::Offset<flatbuffers::Vector<int32_t>> nodes_to_skip;
+  if (xnnpack_options->nodes_to_skip &&
+      xnnpack_options->num_nodes_to_skip > 0) {
+    nodes_to_skip = flatbuffer_builder.CreateVector<int32_t>(
+        xnnpack_options->nodes_to_skip, xnnpack_options->num_nodes_to_skip);
+  }
 
   tflite::XNNPackSettingsBuilder xnnpack_settings_builder(flatbuffer_builder);
   int num_threads = xnnpack_options->num_threads;
@@ -236,6 +244,7 @@ TfLiteDelegatePtr CreateXNNPACKDelegate(
       XNNPackSettings::VT_FLAGS, static_cast<int32_t>(xnnpack_options->flags),
       0);
   xnnpack_settings_builder.add_weight_cache_file_path(weight_cache_file_path);
+  xnnpack_settings_builder.add_nodes_to_skip(nodes_to_skip);
   flatbuffers::Offset<tflite::XNNPackSettings> xnnpack_settings =
       xnnpack_settings_builder.Finish();
   tflite::TFLiteSettingsBuilder tflite_settings_builder(flatbuffer_builder);
@@ -257,7 +266,8 @@ TfLiteDelegatePtr CreateXNNPACKDelegate(
 }
 
 TfLiteDelegatePtr CreateXNNPACKDelegate(int num_threads, bool force_fp16,
-                                        const char* weight_cache_file_path) {
+                                        const char* weight_cache_file_path,
+                                        const std::vector<int>& nodes_to_skip) {
   auto opts = XNNPackDelegateOptionsDefault();
   // Note that we don't want to use the thread pool for num_threads == 1.
   opts.num_threads = num_threads > 1 ? num_threads : 0;
@@ -269,6 +279,12 @@ TfLiteDelegatePtr CreateXNNPACKDelegate(int num_threads, bool force_fp16,
     TFLITE_LOG(INFO) << "XNNPack file-backed weight cache enabled.";
     opts.weight_cache_file_path = weight_cache_file_path;
   }
+  if (!nodes_to_skip.empty()) {
+    TFLITE_LOG(INFO) << "XNNPack placement plan keeps " << nodes_to_skip.size()
+                     << " node(s) on the builtin kernels.";
+    opts.nodes_to_skip = nodes_to_skip.data();
+    opts.num_nodes_to_skip = static_cast<int>(nodes_to_skip.size());
+  }
   return CreateXNNPACKDelegate(&opts);
 }
 #endif
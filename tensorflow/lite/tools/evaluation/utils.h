@@ -105,9 +105,12 @@ TfLiteDelegatePtr CreateXNNPACKDelegate();
 TfLiteDelegatePtr CreateXNNPACKDelegate(
     const TfLiteXNNPackDelegateOptions* options);
 #endif  // !defined(TFLITE_WITHOUT_XNNPACK)
+// `nodes_to_skip` lists execution-plan node indices that stay on the builtin
+// kernels, e.g. a placement plan produced by benchmark_xnnpack_placement.
 TfLiteDelegatePtr CreateXNNPACKDelegate(
     int num_threads, bool force_fp16,
-    const char* weight_cache_file_path = nullptr);
+    const char* weight_cache_file_path = nullptr,
+    const std::vector<int>& nodes_to_skip = {});
 
 TfLiteDelegatePtr CreateCoreMlDelegate();
 }  // namespace evaluation
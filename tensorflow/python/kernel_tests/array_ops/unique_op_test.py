@@ -313,6 +313,21 @@ class UniqueWithCountsTest(test.TestCase):
     self.assertAllEqual(tf_idx, true_idx)
     self.assertAllEqual(tf_count, true_count)
 
+  def testLargeOrderedByAppearance(self):
+    # Large enough for the CPU kernel to uniquify integers in parallel.
+    for dtype in [np.int32, np.int64]:
+      x = np.random.randint(-50000, high=50000, size=1 << 19).astype(dtype)
+      np_y, first, inverse, np_count = np.unique(
+          x, return_index=True, return_inverse=True, return_counts=True)
+      order = np.argsort(first)
+      rank = np.empty_like(order)
+      rank[order] = np.arange(len(order))
+      y, idx, count = array_ops.unique_with_counts(x)
+      tf_y, tf_idx, tf_count = self.evaluate([y, idx, count])
+      self.assertAllEqual(tf_y, np_y[order])
+      self.assertAllEqual(tf_idx, rank[inverse])
+      self.assertAllEqual(tf_count, np_count[order])
+
 
 if __name__ == '__main__':
   test.main()
@@ -628,6 +628,30 @@ class ListOpsTest(test_util.TensorFlowTestCase, parameterized.TestCase):
     self.assertAllEqual(e, 1.0)
     self.assertAllEqual(list_ops.tensor_list_length(l), 0)
 
+  def testTensorListFromTensorAlignedRows(self):
+    # Rows of 16 floats are aligned, so the list elements are views of `t`.
+    t = constant_op.constant(np.arange(64, dtype=np.float32).reshape([4, 16]))
+    l = list_ops.tensor_list_from_tensor(t, element_shape=[16])
+    e = list_ops.tensor_list_get_item(l, 2, element_dtype=dtypes.float32)
+    self.assertAllEqual(e, np.arange(32, 48))
+    self.assertAllEqual(
+        list_ops.tensor_list_stack(l, element_dtype=dtypes.float32), t)
+    l = list_ops.tensor_list_set_item(l, 1, array_ops.zeros([16]))
+    expected = np.arange(64, dtype=np.float32).reshape([4, 16])
+    expected[1] = 0
+    self.assertAllEqual(
+        list_ops.tensor_list_stack(l, element_dtype=dtypes.float32), expected)
+    l, e = list_ops.tensor_list_pop_back(l, element_dtype=dtypes.float32)
+    self.assertAllEqual(e, np.arange(48, 64))
+    self.assertAllEqual(
+        list_ops.tensor_list_stack(l, element_dtype=dtypes.float32),
+        expected[:3])
+
+  @test_util.run_gpu_only
+  def testTensorListFromTensorAlignedRowsGPU(self):
+    with context.device("gpu:0"):
+      self.testTensorListFromTensorAlignedRows()
+
   def testTensorListFromTensorFailsWhenElementShapeIsNotVector(self):
     t = constant_op.constant([1.0, 2.0])
     # In Eager mode, InvalidArgumentError is generated by the Compute function.
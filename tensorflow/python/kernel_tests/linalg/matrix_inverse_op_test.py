@@ -145,6 +145,25 @@ class InverseOpTest(test.TestCase):
               size=np.prod(shape)).reshape(shape).astype(dtype)
           self._verifyInverseReal(matrix)
 
+  def testSmallBatch(self):
+    # Batches of tiny matrices are inverted in groups; cover partial groups.
+    np.random.seed(42)
+    for size in 1, 2, 3, 4:
+      for batch_size in 1, 8, 11:
+        shape = (batch_size, size, size)
+        matrix = np.random.uniform(
+            low=-1.0, high=1.0, size=np.prod(shape)).reshape(shape)
+        matrix += 2 * size * np.identity(size)
+        self._verifyInverseReal(matrix)
+
+  def testNotInvertibleInSmallBatch(self):
+    matrix = np.tile(np.identity(3), [11, 1, 1])
+    # All rows of the matrix below add to zero.
+    matrix[9] = [[1., 0., -1.], [-1., 1., 0.], [0., -1., 1.]]
+    with self.cached_session():
+      with self.assertRaisesOpError("Input is not invertible."):
+        self.evaluate(linalg_ops.matrix_inverse(matrix))
+
   @test_util.deprecated_graph_mode_only
   def testConcurrentExecutesWithoutError(self):
     with self.session() as sess:
@@ -707,6 +707,25 @@ class CSRSparseMatrixOpsTest(test.TestCase, parameterized.TestCase):
 
     self.assertAllClose(c_t_value, c_dense_t_value, atol=1e-5, rtol=1e-5)
 
+  @test_util.run_in_graph_and_eager_modes
+  def testBlockSparseMatrixMatMul(self):
+    for block_size in [4, 8, 16]:
+      num_block_rows, num_block_cols = 5, 7
+      block_mask = np.random.rand(num_block_rows, num_block_cols) > 0.6
+      mask = np.kron(block_mask, np.ones((block_size, block_size)))
+      # Break the pattern of one row, so that it starts a new row block.
+      mask[1] *= np.random.rand(mask.shape[1]) > 0.5
+      a_dense = (mask * (np.random.randn(*mask.shape) + 3.0)).astype(
+          np.float32)
+      b = np.random.randn(mask.shape[1], 33).astype(np.float32)
+
+      a_sm = dense_to_csr_sparse_matrix(a_dense)
+      c = sparse_csr_matrix_ops.sparse_matrix_mat_mul(a=a_sm, b=b)
+      c_value = self.evaluate(c)
+
+      self.assertAllClose(np.matmul(a_dense, b), c_value, rtol=1e-5,
+                          atol=1e-5)
+
   @test_util.run_in_graph_and_eager_modes
   def testSparseMatrixSparseMatMul(self):
     a_indices = np.array([[0, 0], [2, 3]])
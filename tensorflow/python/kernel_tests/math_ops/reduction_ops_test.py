@@ -459,6 +459,16 @@ class SumReductionTest(BaseReductionTest):
                    np.arange(1, rank, 2)):
         self._compareAll(data, axes)
 
+  @test_util.run_deprecated_v1
+  def testTallSkinnyAndShortWide(self):
+    # Few outputs with many inputs each are reduced in parallel blocks on CPU.
+    np.random.seed(42)
+    for shape, axis in (((100003, 3), 0), ((3, 100003), 1)):
+      data = np.random.randint(-1024, 1024, size=shape)
+      self._compareAll(data.astype(np.int32), [axis])
+      self._compareAll(data.astype(np.int64), [axis])
+      self._compareAll(self._makeRandom(shape, dtypes.float64), [axis])
+
   @test_util.run_deprecated_v1
   def testExpand(self):
     # Reduce an empty tensor to a nonempty tensor
@@ -523,6 +533,14 @@ class MeanReductionTest(BaseReductionTest):
           np_arr = np.array([special_value_x, special_value_y]).astype(dtype)
           self._compareAll(np_arr, None)
 
+  @test_util.run_deprecated_v1
+  def testTallSkinnyAndShortWide(self):
+    np.random.seed(42)
+    for shape, axis in (((100003, 3), 0), ((3, 100003), 1)):
+      self._compareAll(self._makeRandom(shape, dtypes.float64), [axis])
+      self._compareAll(
+          np.random.randint(-1024, 1024, size=shape).astype(np.int32), [axis])
+
   @test_util.run_deprecated_v1
   def testInt32(self):
     for rank in range(1, _MAX_RANK + 1):
@@ -954,6 +972,18 @@ class MaxReductionTest(test.TestCase):
                                      repeat=size):
           self._compareAll(np.array(arr, dtype=dtype), None)
 
+  @test_util.disable_xla("b/168718272")  # XLA handling of NaN is inconsistent
+  def testTallSkinnyAndShortWide(self):
+    np.random.seed(42)
+    for dtype in [np.float32, np.int32]:
+      for shape, axis in (((100003, 3), 0), ((3, 100003), 1)):
+        np_arr = np.random.randint(-1024, 1024, size=shape).astype(dtype)
+        self._compareAll(np_arr, [axis])
+        if dtype == np.float32:
+          # A NaN in a single block propagates through the combine.
+          np_arr.flat[np_arr.size // 2] = np.nan
+          self._compareAll(np_arr, [axis])
+
   def testInt64Reduce3D(self):
     # Create a 3D array of int64s and reduce across all possible
     # dimensions
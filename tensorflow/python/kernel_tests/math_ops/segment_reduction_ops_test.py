@@ -381,6 +381,26 @@ class UnsortedSegmentTest(SegmentReductionHelper, parameterized.TestCase):
               self.assertAllCloseAccordingToType(np_ans, tf_ans)
               self.assertShapeEqual(np_ans, s)
 
+  def testLargeInputFewSegments(self):
+    # Enough rows per segment for the CPU kernel to reduce the rows into
+    # per-thread partials before combining them.
+    num_rows, inner_size, num_segments = 20000, 8, 7
+    np.random.seed(0)
+    indices = np.random.randint(-1, num_segments, size=num_rows)
+    np_x = np.random.rand(num_rows, inner_size).astype(np.float64)
+    valid = indices >= 0
+    np_sum = np.zeros((num_segments, inner_size))
+    np.add.at(np_sum, indices[valid], np_x[valid])
+    np_max = np.full((num_segments, inner_size), np.finfo(np.float64).min)
+    np.maximum.at(np_max, indices[valid], np_x[valid])
+    with self.cached_session(use_gpu=False):
+      tf_sum = math_ops.unsorted_segment_sum(
+          np_x, segment_ids=indices, num_segments=num_segments)
+      tf_max = math_ops.unsorted_segment_max(
+          np_x, segment_ids=indices, num_segments=num_segments)
+      self.assertAllClose(np_sum, self.evaluate(tf_sum))
+      self.assertAllEqual(np_max, self.evaluate(tf_max))
+
   def testNumSegmentsTypes(self):
     dtypes = [dtypes_lib.int32, dtypes_lib.int64]
     indices_flat = np.array([0, 4, 0, 8, 3, 8, 4, 7, 7, 3])
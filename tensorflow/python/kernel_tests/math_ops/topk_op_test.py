@@ -195,6 +195,17 @@ class TopKTest(test.TestCase):
       values = -np.sort(-inputs, axis=1)[:, :k]
       self._validateTopK(inputs, k, values, indices)
 
+  def testStableSortFewLongRows(self):
+    # Few rows with many columns, which the CPU kernel splits into column
+    # chunks. Repeated values check that ties still prefer lower indices.
+    b = 2
+    n = 1 << 17
+    for k in [5, 1000]:
+      inputs = np.random.randint(0, 1000, size=(b, n)).astype(np.int32)
+      indices = np.argsort(-inputs, axis=1, kind="mergesort")[:, :k]
+      values = -np.sort(-inputs, axis=1)[:, :k]
+      self._validateTopK(inputs, k, values, indices)
+
   def testTopAll(self):
     inputs = [[0.1, 0.3, 0.2, 0.4], [0.1, 0.3, 0.3, 0.2]]
     self._validateTopK(inputs, 4, [[0.4, 0.3, 0.2, 0.1], [0.3, 0.3, 0.2, 0.1]],
@@ -35,6 +35,7 @@ from tensorflow.python.ops import math_ops
 from tensorflow.python.ops import random_ops
 from tensorflow.python.ops import resource_variable_ops
 from tensorflow.python.ops import script_ops
+from tensorflow.python.ops import string_ops
 from tensorflow.python.ops import variables
 from tensorflow.python.platform import test
 
@@ -512,6 +513,34 @@ class BatchOpsTest(test.TestCase):
           np.all(
               np.equal(main_results[0], np.array([5, 6, 7], dtype=np.int32))))
 
+  def testBatchFunctionOpWithLargeBatchSplittedMixedOutputs(self):
+    """Tests merging split outputs that can and cannot be memcpy'd."""
+    if context.executing_eagerly():
+      return
+
+    with self.cached_session() as sess:
+
+      @function.Defun(dtypes.int32)
+      def computation(in_t):
+        return in_t + 3, string_ops.as_string(in_t)
+
+      inp = array_ops.placeholder(dtype=dtypes.int32)
+      result = gen_batch_ops.batch_function(
+          [inp],
+          num_batch_threads=2,
+          allowed_batch_sizes=[1, 2],
+          max_batch_size=5,
+          batch_timeout_micros=100000,  # 100ms
+          Tout=[dtypes.int32, dtypes.string],
+          enable_large_batch_splitting=True,
+          f=computation,
+          captured_tensors=computation.captured_inputs)
+
+      int_result, string_result = sess.run(
+          result, feed_dict={inp: [5, 6, 7, 8, 9]})
+      self.assertAllEqual(int_result, [8, 9, 10, 11, 12])
+      self.assertAllEqual(string_result, [b"5", b"6", b"7", b"8", b"9"])
+
   def testBasicUnbatchDecoratedWithReshape(self):
     """Tests that the batch_function decorator works."""
     if context.executing_eagerly():
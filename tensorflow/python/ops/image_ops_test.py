@@ -4727,6 +4727,64 @@ class JpegTest(test_util.TensorFlowTestCase):
       adjusted_image.shape.assert_is_compatible_with([None, None, 3])
 
 
+class BatchDecodeAndResizeImageTest(test_util.TensorFlowTestCase):
+
+  def _decodeCropResize(self, contents, crop_window, size, channels):
+    image = image_ops.decode_image(contents, channels=channels)
+    y, x, h, w = crop_window
+    if h and w:
+      image = image_ops.crop_to_bounding_box(image, y, x, h, w)
+    return gen_image_ops.resize_bilinear(
+        [image], size, half_pixel_centers=True)[0]
+
+  def testMatchesSeparateOps(self):
+    jpeg0 = io_ops.read_file(
+        "tensorflow/core/lib/jpeg/testdata/jpeg_merge_test1.jpg")
+    png0 = io_ops.read_file("tensorflow/core/lib/png/testdata/lena_rgba.png")
+    contents = array_ops_stack.stack([jpeg0, png0, jpeg0, png0])
+    # The JPEG is 256x128 and the PNG is 26x51.
+    crop_windows = [[0, 0, 0, 0], [0, 0, 0, 0], [10, 20, 100, 50],
+                    [3, 4, 20, 40]]
+    size = [37, 29]
+    for channels in 1, 3:
+      images = gen_image_ops.batch_decode_and_resize_image(
+          contents, crop_windows, size, channels=channels)
+      self.assertEqual(images.get_shape().as_list(), [4, 37, 29, channels])
+      expected = [
+          self._decodeCropResize(contents[i], crop_windows[i], size, channels)
+          for i in range(4)
+      ]
+      self.assertAllClose(
+          self.evaluate(array_ops_stack.stack(expected)),
+          self.evaluate(images), atol=1e-3, rtol=1e-5)
+
+  def testDctScaling(self):
+    jpeg0 = io_ops.read_file(
+        "tensorflow/core/lib/jpeg/testdata/jpeg_merge_test1.jpg")
+    # The 256x128 JPEG is decoded at 1/4 scale.
+    size = [60, 30]
+    scaled = gen_image_ops.batch_decode_and_resize_image(
+        [jpeg0], [[0, 0, 0, 0]], size, use_dct_scaling=True)
+    expected = self._decodeCropResize(jpeg0, [0, 0, 0, 0], size, 3)
+    scaled, expected = self.evaluate([scaled, expected])
+    self.assertEqual(scaled.shape, (1, 60, 30, 3))
+    self.assertLess(np.abs(scaled[0] - expected).mean(), 8)
+
+  def testInvalidInputs(self):
+    jpeg0 = io_ops.read_file(
+        "tensorflow/core/lib/jpeg/testdata/jpeg_merge_test1.jpg")
+    with self.assertRaisesRegex((ValueError, errors.InvalidArgumentError),
+                                "Invalid crop window"):
+      self.evaluate(
+          gen_image_ops.batch_decode_and_resize_image(
+              [jpeg0], [[0, 0, 257, 128]], [8, 8]))
+    with self.assertRaisesRegex((ValueError, errors.InvalidArgumentError),
+                                "JPEG and PNG images only"):
+      self.evaluate(
+          gen_image_ops.batch_decode_and_resize_image(
+              ["GIF89a"], [[0, 0, 0, 0]], [8, 8]))
+
+
 class PngTest(test_util.TensorFlowTestCase):
 
   def testExisting(self):
@@ -35,3 +35,4 @@ ops.NotDifferentiable("MutableHashTable")
 ops.NotDifferentiable("MutableHashTableV2")
 ops.NotDifferentiable("MutableHashTableOfTensors")
 ops.NotDifferentiable("MutableHashTableOfTensorsV2")
+ops.NotDifferentiable("ShardedMutableDenseHashTable")
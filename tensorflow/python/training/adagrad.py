@@ -14,6 +14,8 @@
 # ==============================================================================
 
 """Adagrad for TensorFlow."""
+from tensorflow.python.compat import compat
+from tensorflow.python.framework import device as pydev
 from tensorflow.python.framework import ops
 from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import gen_array_ops
@@ -184,6 +186,24 @@ class AdagradOptimizer(optimizer.Optimizer):
         grad.indices,
         use_locking=self._use_locking)
 
+  def _resource_apply_sparse_duplicate_indices(self, grad, handle, indices):
+    # On CPU the kernel sums the gradients of repeated indices itself, which
+    # avoids materializing the Unique and UnsortedSegmentSum outputs.
+    device_type = pydev.DeviceSpec.from_string(handle.device).device_type
+    if device_type != "CPU" or not compat.forward_compatible(2024, 11, 21):
+      return super(AdagradOptimizer,
+                   self)._resource_apply_sparse_duplicate_indices(
+                       grad, handle, indices)
+    acc = self.get_slot(handle, "accumulator")
+    return gen_training_ops.resource_sparse_apply_adagrad(
+        handle.handle,
+        acc.handle,
+        math_ops.cast(self._learning_rate_tensor, grad.dtype),
+        grad,
+        indices,
+        use_locking=self._use_locking,
+        deduplicate_indices=True)
+
   def _resource_apply_sparse(self, grad, var, indices):
     acc = self.get_slot(var, "accumulator")
     return gen_training_ops.resource_sparse_apply_adagrad(
@@ -456,6 +456,31 @@ class TrainingOpsTest(TensorFlowTestCase):
     param_t = param - alpha_t * m_t / (np.sqrt(v_t) + epsilon)
     return param_t, m_t, v_t
 
+  @test_util.run_v2_only
+  def testResourceSparseApplyAdagradDeduplicateIndices(self):
+    for index_type, num_indices in itertools.product([np.int32, np.int64],
+                                                     [6, 70000]):
+      x = np.arange(30).reshape(3, 10).astype(np.float64)
+      y = np.arange(1, 31).reshape(3, 10).astype(np.float64)
+      lr = np.array(2.0, dtype=np.float64)
+      # Enough indices for the kernel to group them by sorting.
+      indices = (np.arange(num_indices) % 2 * 2).astype(index_type)
+      grad = np.random.rand(num_indices, 10)
+      with ops.device("/cpu:0"):
+        var = variables.Variable(x)
+        accum = variables.Variable(y)
+        self.evaluate(
+            gen_training_ops.resource_sparse_apply_adagrad(
+                var.handle, accum.handle, lr, grad, indices,
+                deduplicate_indices=True))
+
+      summed = np.zeros_like(x)
+      np.add.at(summed, indices, grad)
+      expected_accum = y + summed * summed
+      expected_var = x - lr * summed / np.sqrt(expected_accum)
+      self.assertAllClose(expected_accum, self.evaluate(accum))
+      self.assertAllClose(expected_var, self.evaluate(var))
+
   @test_util.run_v2_only
   def testResourceSparseApplyAdagradV2AndDisableCopyOnReadRace(self):
     dtype = np.float32
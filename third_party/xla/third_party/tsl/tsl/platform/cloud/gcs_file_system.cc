@@ -19,6 +19,7 @@ limitations under the License.
 
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 
 #ifndef _WIN32
 #include <unistd.h>
@@ -56,6 +57,7 @@ limitations under the License.
 #include "tsl/platform/str_util.h"
 #include "tsl/platform/stringprintf.h"
 #include "tsl/platform/thread_annotations.h"
+#include "tsl/platform/threadpool.h"
 #include "tsl/profiler/lib/traceme.h"
 
 #ifdef _WIN32
@@ -162,6 +164,8 @@ constexpr char kAppendMode[] = "GCS_APPEND_MODE";
 // default as the multiple API calls required add a risk of stranding temporary
 // objects.
 constexpr char kComposeAppend[] = "compose";
+// The maximum number of source objects of a single compose request.
+constexpr uint64 kMaxComposeComponents = 32;
 
 absl::Status GetTmpFilename(string* filename) {
   *filename = io::GetTempFilename("");
@@ -604,6 +608,18 @@ class GcsWritableFile : public WritableFile {
       return errors::Internal(
           "Could not write to the internal temporary file.");
     }
+    // Appends in compose mode only upload the new data, which need not be
+    // split.
+    if (!compose_append_ || start_offset_ == 0) {
+      uint64 file_size;
+      TF_RETURN_IF_ERROR(GetCurrentFileSize(&file_size));
+      const uint64 chunk_size = GetParallelUploadChunkSize(file_size);
+      if (chunk_size > 0) {
+        TF_RETURN_IF_ERROR(ParallelUpload(file_size, chunk_size));
+        start_offset_ = file_size;
+        return absl::OkStatus();
+      }
+    }
     UploadSessionHandle session_handle;
     uint64 start_offset = 0;
     string object_to_upload = object_;
@@ -731,6 +747,133 @@ class GcsWritableFile : public WritableFile {
         retry_config_);
   }
 
+  /// Returns the chunk size of a parallel composite upload of `file_size`
+  /// bytes, or 0 if the file should be uploaded in one request.
+  uint64 GetParallelUploadChunkSize(uint64 file_size) const {
+    const uint64 chunk_size = filesystem_->parallel_upload_chunk_size();
+    if (chunk_size == 0 || file_size <= chunk_size) {
+      return 0;
+    }
+    // Grow the chunks so that they can be composed with a single request.
+    return std::max(chunk_size, (file_size + kMaxComposeComponents - 1) /
+                                    kMaxComposeComponents);
+  }
+
+  /// \brief Uploads the file as a parallel composite upload.
+  ///
+  /// The chunks of the file are uploaded concurrently into temporary objects,
+  /// which are composed into the object and then deleted. Each chunk is read
+  /// into memory only while it is uploaded.
+  absl::Status ParallelUpload(uint64 file_size, uint64 chunk_size) {
+    VLOG(3) << "ParallelUpload: " << GetGcsPath() << " size " << file_size
+            << " in chunks of " << chunk_size;
+    std::vector<string> components;
+    for (uint64 offset = 0; offset < file_size; offset += chunk_size) {
+      components.push_back(
+          strings::StrCat(io::Dirname(object_), "/.tmpcompose/",
+                          io::Basename(object_), ".part.", offset));
+    }
+    std::vector<absl::Status> statuses(components.size());
+    {
+      thread::ThreadPool pool(
+          Env::Default(), "gcs_parallel_upload",
+          std::max<size_t>(
+              1, std::min(components.size(),
+                          filesystem_->parallel_upload_max_concurrency())));
+      for (size_t i = 0; i < components.size(); ++i) {
+        pool.Schedule([this, &components, &statuses, i, file_size,
+                       chunk_size]() {
+          const uint64 offset = i * chunk_size;
+          statuses[i] = UploadChunk(components[i], offset,
+                                    std::min(chunk_size, file_size - offset));
+        });
+      }
+      // The destructor of `pool` waits for all uploads to finish.
+    }
+    absl::Status status;
+    for (const absl::Status& chunk_status : statuses) {
+      status.Update(chunk_status);
+    }
+    if (status.ok()) {
+      status = ComposeObjects(components);
+    }
+    for (size_t i = 0; i < components.size(); ++i) {
+      if (!statuses[i].ok()) continue;
+      const string component_path = GetGcsPathWithObject(components[i]);
+      absl::Status delete_status = RetryingUtils::DeleteWithRetries(
+          [&component_path, this]() {
+            return filesystem_->DeleteFile(component_path, nullptr);
+          },
+          retry_config_);
+      if (!delete_status.ok()) {
+        LOG(WARNING) << "Could not delete the temporary object "
+                     << component_path << ": " << delete_status;
+      }
+    }
+    if (status.ok()) {
+      // Erase the file from the file cache on every successful write.
+      file_cache_erase_();
+    }
+    return status;
+  }
+
+  /// Uploads `size` bytes of the file at `offset` into the object
+  /// `component`.
+  absl::Status UploadChunk(const string& component, uint64 offset,
+                           uint64 size) {
+    string data(size, '\0');
+    std::ifstream stream(tmp_content_filename_, std::ifstream::binary);
+    stream.seekg(offset);
+    stream.read(&data[0], size);
+    if (!stream.good()) {
+      return errors::Internal(
+          "Could not read from the internal temporary file.");
+    }
+    return RetryingUtils::CallWithRetries(
+        [&component, &data, this]() {
+          std::unique_ptr<HttpRequest> request;
+          TF_RETURN_IF_ERROR(filesystem_->CreateHttpRequest(&request));
+          request->SetUri(strings::StrCat(kGcsUploadUriBase, "b/", bucket_,
+                                          "/o?uploadType=media&name=",
+                                          request->EscapeString(component)));
+          request->SetTimeouts(timeouts_->connect, timeouts_->idle,
+                               timeouts_->write);
+          request->SetPostFromBuffer(data.data(), data.size());
+          TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(), " when uploading ",
+                                          GetGcsPathWithObject(component));
+          return absl::OkStatus();
+        },
+        retry_config_);
+  }
+
+  /// Composes `components`, in order, into the object.
+  absl::Status ComposeObjects(const std::vector<string>& components) {
+    std::vector<string> source_objects;
+    source_objects.reserve(components.size());
+    for (const string& component : components) {
+      source_objects.push_back(strings::StrCat("{'name': '", component, "'}"));
+    }
+    const string request_body =
+        strings::StrCat("{'sourceObjects': [",
+                        absl::StrJoin(source_objects, ","), "]}");
+    return RetryingUtils::CallWithRetries(
+        [&request_body, this]() {
+          std::unique_ptr<HttpRequest> request;
+          TF_RETURN_IF_ERROR(filesystem_->CreateHttpRequest(&request));
+          request->SetUri(strings::StrCat(kGcsUriBase, "b/", bucket_, "/o/",
+                                          request->EscapeString(object_),
+                                          "/compose"));
+          request->SetTimeouts(timeouts_->connect, timeouts_->idle,
+                               timeouts_->metadata);
+          request->AddHeader("content-type", "application/json");
+          request->SetPostFromBuffer(request_body.c_str(), request_body.size());
+          TF_RETURN_WITH_CONTEXT_IF_ERROR(request->Send(),
+                                          " when composing to ", GetGcsPath());
+          return absl::OkStatus();
+        },
+        retry_config_);
+  }
+
   /// \brief Requests status of a previously initiated upload session.
   ///
   /// If the upload has already succeeded, sets 'completed' to true.
@@ -851,12 +994,17 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
   if (GetEnvVar(kMaxStaleness, strings::safe_strtou64, &value)) {
     max_staleness = value;
   }
+
+  if (GetEnvVar(kMaxReadaheadBlocks, strings::safe_strtou64, &value)) {
+    max_readahead_blocks_ = value;
+  }
   if (!make_default_cache) {
     max_bytes = 0;
   }
   VLOG(1) << "GCS cache max size = " << max_bytes << " ; "
           << "block size = " << block_size_ << " ; "
-          << "max staleness = " << max_staleness;
+          << "max staleness = " << max_staleness << " ; "
+          << "max readahead blocks = " << max_readahead_blocks_;
   file_block_cache_ = MakeFileBlockCache(block_size_, max_bytes, max_staleness);
   // Apply overrides for the stat cache max age and max entries, if provided.
   uint64 stat_cache_max_age = kStatCacheDefaultMaxAge;
@@ -978,6 +1126,14 @@ GcsFileSystem::GcsFileSystem(bool make_default_cache) {
     compose_append_ = false;
   }
 
+  if (GetEnvVar(kParallelUploadChunkSize, strings::safe_strtou64, &value)) {
+    parallel_upload_chunk_size_ = value * 1024 * 1024;
+  }
+  if (GetEnvVar(kParallelUploadMaxConcurrency, strings::safe_strtou64,
+                &value)) {
+    parallel_upload_max_concurrency_ = value;
+  }
+
   retry_config_ = GetGcsRetryConfig();
 }
 
@@ -1077,11 +1233,17 @@ void GcsFileSystem::ResetFileBlockCache(size_t block_size_bytes,
   }
 }
 
+void GcsFileSystem::SetParallelUploadOptions(size_t chunk_size_bytes,
+                                             size_t max_concurrency) {
+  parallel_upload_chunk_size_ = chunk_size_bytes;
+  parallel_upload_max_concurrency_ = max_concurrency;
+}
+
 // A helper function to build a FileBlockCache for GcsFileSystem.
 std::unique_ptr<FileBlockCache> GcsFileSystem::MakeFileBlockCache(
     size_t block_size, size_t max_bytes, uint64 max_staleness) {
   std::unique_ptr<FileBlockCache> file_block_cache(new RamFileBlockCache(
-      block_size, max_bytes, max_staleness,
+      block_size, max_bytes, max_staleness, max_readahead_blocks_,
       [this](const string& filename, size_t offset, size_t n, char* buffer,
              size_t* bytes_transferred) {
         return LoadBufferFromGCS(filename, offset, n, buffer,
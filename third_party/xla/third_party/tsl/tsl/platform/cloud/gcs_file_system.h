@@ -62,6 +62,21 @@ constexpr size_t kDefaultMaxCacheSize = 0;
 // will be evicted on the next read.
 constexpr char kMaxStaleness[] = "GCS_READ_CACHE_MAX_STALENESS";
 constexpr uint64 kDefaultMaxStaleness = 0;
+// The environment variable that enables readahead of sequentially read files.
+// Specifies the maximum number of blocks fetched ahead of a read, which are
+// fetched concurrently.
+constexpr char kMaxReadaheadBlocks[] = "GCS_READ_CACHE_MAX_READAHEAD_BLOCKS";
+constexpr size_t kDefaultMaxReadaheadBlocks = 0;
+// The environment variable that enables parallel composite uploads. Files
+// larger than this size (in MB) are uploaded as chunks of at least this size
+// into temporary objects, which are then composed into the final object.
+constexpr char kParallelUploadChunkSize[] = "GCS_PARALLEL_UPLOAD_CHUNK_SIZE_MB";
+constexpr size_t kDefaultParallelUploadChunkSize = 0;
+// The environment variable that overrides the maximum number of chunks of a
+// parallel composite upload that are uploaded concurrently.
+constexpr char kParallelUploadMaxConcurrency[] =
+    "GCS_PARALLEL_UPLOAD_MAX_CONCURRENCY";
+constexpr size_t kDefaultParallelUploadMaxConcurrency = 8;
 
 // Helper function to extract an environment variable and convert it into a
 // value of type T.
@@ -221,6 +236,12 @@ class GcsFileSystem : public FileSystem {
   }
 
   bool compose_append() const { return compose_append_; }
+  size_t parallel_upload_chunk_size() const {
+    return parallel_upload_chunk_size_;
+  }
+  size_t parallel_upload_max_concurrency() const {
+    return parallel_upload_max_concurrency_;
+  }
   string additional_header_name() const {
     return additional_header_ ? additional_header_->first : "";
   }
@@ -290,6 +311,14 @@ class GcsFileSystem : public FileSystem {
   void ResetFileBlockCache(size_t block_size_bytes, size_t max_bytes,
                            uint64 max_staleness_secs);
 
+  /// \brief Configures parallel composite uploads of writable files.
+  ///
+  /// Files larger than `chunk_size_bytes` are uploaded as up to 32 chunks, at
+  /// most `max_concurrency` at a time. A `chunk_size_bytes` of 0 disables
+  /// parallel uploads. Only affects files that are synced afterwards.
+  void SetParallelUploadOptions(size_t chunk_size_bytes,
+                                size_t max_concurrency);
+
  protected:
   virtual std::unique_ptr<FileBlockCache> MakeFileBlockCache(
       size_t block_size, size_t max_bytes, uint64 max_staleness);
@@ -423,6 +452,10 @@ class GcsFileSystem : public FileSystem {
   // Reads smaller than block_size_ will trigger a read of block_size_.
   uint64 block_size_;
 
+  // The maximum number of blocks the file block cache fetches ahead of a
+  // sequential read.
+  size_t max_readahead_blocks_ = kDefaultMaxReadaheadBlocks;
+
   // block_cache_lock_ protects the file_block_cache_ pointer (Note that
   // FileBlockCache instances are themselves threadsafe).
   mutex block_cache_lock_;
@@ -443,6 +476,9 @@ class GcsFileSystem : public FileSystem {
   std::unique_ptr<BucketLocationCache> bucket_location_cache_;
   std::unordered_set<string> allowed_locations_;
   bool compose_append_;
+  size_t parallel_upload_chunk_size_ = kDefaultParallelUploadChunkSize;
+  size_t parallel_upload_max_concurrency_ =
+      kDefaultParallelUploadMaxConcurrency;
 
   GcsStatsInterface* stats_ = nullptr;  // Not owned.
 
@@ -995,6 +995,83 @@ TEST(GcsFileSystemTest, NewWritableFile) {
   TF_EXPECT_OK(wfile->Close());
 }
 
+TEST(GcsFileSystemTest, NewWritableFile_ParallelCompositeUpload) {
+  std::vector<HttpRequest*> requests(
+      {new FakeHttpRequest("Uri: https://www.googleapis.com/upload/storage/v1/"
+                           "b/bucket/o?uploadType=media&name=some%2Fpath%2F."
+                           "tmpcompose%2Fwriteable.part.0\n"
+                           "Auth Token: fake_token\n"
+                           "Timeouts: 5 1 30\n"
+                           "Post body: content1\n",
+                           ""),
+       new FakeHttpRequest("Uri: https://www.googleapis.com/upload/storage/v1/"
+                           "b/bucket/o?uploadType=media&name=some%2Fpath%2F."
+                           "tmpcompose%2Fwriteable.part.8\n"
+                           "Auth Token: fake_token\n"
+                           "Timeouts: 5 1 30\n"
+                           "Post body: ,content\n",
+                           ""),
+       new FakeHttpRequest("Uri: https://www.googleapis.com/upload/storage/v1/"
+                           "b/bucket/o?uploadType=media&name=some%2Fpath%2F."
+                           "tmpcompose%2Fwriteable.part.16\n"
+                           "Auth Token: fake_token\n"
+                           "Timeouts: 5 1 30\n"
+                           "Post body: 2\n",
+                           ""),
+       new FakeHttpRequest("Uri: https://www.googleapis.com/storage/v1/b/"
+                           "bucket/o/some%2Fpath%2Fwriteable/compose\n"
+                           "Auth Token: fake_token\n"
+                           "Timeouts: 5 1 10\n"
+                           "Header content-type: application/json\n"
+                           "Post body: {'sourceObjects': [{'name': "
+                           "'some/path/.tmpcompose/writeable.part.0'},"
+                           "{'name': 'some/path/.tmpcompose/writeable.part.8'},"
+                           "{'name': "
+                           "'some/path/.tmpcompose/writeable.part.16'}]}\n",
+                           ""),
+       new FakeHttpRequest("Uri: https://www.googleapis.com/storage/v1/b/"
+                           "bucket/o/some%2Fpath%2F.tmpcompose%2Fwriteable."
+                           "part.0\n"
+                           "Auth Token: fake_token\n"
+                           "Timeouts: 5 1 10\n"
+                           "Delete: yes\n",
+                           ""),
+       new FakeHttpRequest("Uri: https://www.googleapis.com/storage/v1/b/"
+                           "bucket/o/some%2Fpath%2F.tmpcompose%2Fwriteable."
+                           "part.8\n"
+                           "Auth Token: fake_token\n"
+                           "Timeouts: 5 1 10\n"
+                           "Delete: yes\n",
+                           ""),
+       new FakeHttpRequest("Uri: https://www.googleapis.com/storage/v1/b/"
+                           "bucket/o/some%2Fpath%2F.tmpcompose%2Fwriteable."
+                           "part.16\n"
+                           "Auth Token: fake_token\n"
+                           "Timeouts: 5 1 10\n"
+                           "Delete: yes\n",
+                           "")});
+  GcsFileSystem fs(
+      std::unique_ptr<AuthProvider>(new FakeAuthProvider),
+      std::unique_ptr<HttpRequest::Factory>(
+          new FakeHttpRequestFactory(&requests)),
+      std::unique_ptr<ZoneProvider>(new FakeZoneProvider), 0 /* block size */,
+      0 /* max bytes */, 0 /* max staleness */, 0 /* stat cache max age */,
+      0 /* stat cache max entries */, 0 /* matching paths cache max age */,
+      0 /* matching paths cache max entries */, kTestRetryConfig,
+      kTestTimeoutConfig, *kAllowedLocationsDefault,
+      nullptr /* gcs additional header */, false /* compose append */);
+  // Upload one chunk at a time so that the requests are made in order.
+  fs.SetParallelUploadOptions(8 /* chunk size */, 1 /* max concurrency */);
+
+  std::unique_ptr<WritableFile> file;
+  TF_EXPECT_OK(
+      fs.NewWritableFile("gs://bucket/some/path/writeable", nullptr, &file));
+
+  TF_EXPECT_OK(file->Append("content1,"));
+  TF_EXPECT_OK(file->Append("content2"));
+  TF_EXPECT_OK(file->Close());
+}
+
 TEST(GcsFileSystemTest, NewWritableFile_ResumeUploadSucceeds) {
   std::vector<HttpRequest*> requests(
       {new FakeHttpRequest(
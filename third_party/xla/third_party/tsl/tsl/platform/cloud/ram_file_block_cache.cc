@@ -15,8 +15,11 @@ limitations under the License.
 
 #include "tsl/platform/cloud/ram_file_block_cache.h"
 
+#include <algorithm>
 #include <cstring>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "absl/cleanup/cleanup.h"
 #include "tsl/platform/env.h"
@@ -48,6 +51,11 @@ std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Lookup(
     }
   }
 
+  return Insert_Locked(key);
+}
+
+std::shared_ptr<RamFileBlockCache::Block> RamFileBlockCache::Insert_Locked(
+    const Key& key) {
   // Insert a new empty block, setting the bookkeeping to sentinel values
   // in order to update them as appropriate.
   auto new_entry = std::make_shared<Block>();
@@ -85,12 +93,8 @@ absl::Status RamFileBlockCache::UpdateLRU(const Key& key,
   // in the cache, and our current block is not block size, this likely means
   // we have inconsistent state within the cache. Note: it's possible some
   // incomplete reads may still go undetected.
-  if (block->data.size() < block_size_) {
-    Key fmax = std::make_pair(key.first, std::numeric_limits<size_t>::max());
-    auto fcmp = block_map_.upper_bound(fmax);
-    if (fcmp != block_map_.begin() && key < (--fcmp)->first) {
-      return errors::Internal("Block cache contents are inconsistent.");
-    }
+  if (block->data.size() < block_size_ && HasDataAfter(key)) {
+    return errors::Internal("Block cache contents are inconsistent.");
   }
 
   Trim();
@@ -98,6 +102,84 @@ absl::Status RamFileBlockCache::UpdateLRU(const Key& key,
   return absl::OkStatus();
 }
 
+bool RamFileBlockCache::HasDataAfter(const Key& key) {
+  Key fmax = std::make_pair(key.first, std::numeric_limits<size_t>::max());
+  auto it = block_map_.upper_bound(fmax);
+  while (it != block_map_.begin() && key < (--it)->first) {
+    // Blocks that are still being fetched, or that readahead fetched past the
+    // end of the file, hold no data.
+    mutex_lock l(it->second->mu);
+    if (it->second->state == FetchState::FINISHED &&
+        !it->second->data.empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void RamFileBlockCache::Readahead(const string& filename, size_t offset,
+                                  size_t n, size_t start, size_t finish) {
+  // Leave at least half of the cache to the blocks being read, so that
+  // readahead does not evict them before they are used.
+  const size_t max_window =
+      std::min(max_readahead_blocks_, max_bytes_ / block_size_ / 2);
+  std::vector<std::pair<Key, std::shared_ptr<Block>>> blocks;
+  {
+    mutex_lock lock(mu_);
+    if (readahead_state_.size() >= kMaxReadaheadFiles &&
+        readahead_state_.find(filename) == readahead_state_.end()) {
+      readahead_state_.clear();
+    }
+    ReadaheadState& state = readahead_state_[filename];
+    if (offset == state.next_offset) {
+      state.window = std::min(std::max<size_t>(2 * state.window, 1),
+                              max_window);
+    } else {
+      state.window = 0;
+    }
+    state.next_offset = offset + n;
+    const size_t end = finish + state.window * block_size_;
+    for (size_t pos = start; pos < end; pos += block_size_) {
+      Key key = std::make_pair(filename, pos);
+      auto entry = block_map_.find(key);
+      if (entry == block_map_.end()) {
+        // The first block is fetched by the caller.
+        if (pos != start) {
+          blocks.emplace_back(key, Insert_Locked(key));
+        }
+        continue;
+      }
+      // Do not read ahead past a block that ends the file.
+      mutex_lock l(entry->second->mu);
+      if (entry->second->state == FetchState::FINISHED &&
+          entry->second->data.size() < block_size_) {
+        break;
+      }
+    }
+  }
+  for (auto& [key, block] : blocks) {
+    readahead_pool_->Schedule(
+        [this, key = std::move(key), block = std::move(block)] {
+          FetchReadaheadBlock(key, block);
+        });
+  }
+}
+
+void RamFileBlockCache::FetchReadaheadBlock(
+    const Key& key, const std::shared_ptr<Block>& block) {
+  absl::Status status = MaybeFetch(key, block);
+  if (!status.ok()) {
+    // The block is fetched again when it is read.
+    VLOG(1) << "Readahead of " << key.first << " @ " << key.second
+            << " failed: " << status;
+    return;
+  }
+  mutex_lock lock(mu_);
+  if (block->timestamp != 0) {
+    Trim();
+  }
+}
+
 absl::Status RamFileBlockCache::MaybeFetch(
     const Key& key, const std::shared_ptr<Block>& block) {
   bool downloaded_block = false;
@@ -185,6 +267,9 @@ absl::Status RamFileBlockCache::Read(const string& filename, size_t offset,
   if (finish < offset + n) {
     finish += block_size_;
   }
+  if (readahead_pool_ != nullptr) {
+    Readahead(filename, offset, n, start, finish);
+  }
   size_t total_bytes_transferred = 0;
   // Now iterate through the blocks, reading them one at a time.
   for (size_t pos = start; pos < finish; pos += block_size_) {
@@ -274,6 +359,7 @@ void RamFileBlockCache::Flush() {
   block_map_.clear();
   lru_list_.clear();
   lra_list_.clear();
+  readahead_state_.clear();
   cache_size_ = 0;
 }
 
@@ -283,6 +369,7 @@ void RamFileBlockCache::RemoveFile(const string& filename) {
 }
 
 void RamFileBlockCache::RemoveFile_Locked(const string& filename) {
+  readahead_state_.erase(filename);
   Key begin = std::make_pair(filename, 0);
   auto it = block_map_.lower_bound(begin);
   while (it != block_map_.end() && it->first.first == filename) {
@@ -21,6 +21,7 @@ limitations under the License.
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "tsl/platform/cloud/file_block_cache.h"
@@ -30,6 +31,7 @@ limitations under the License.
 #include "tsl/platform/status.h"
 #include "tsl/platform/stringpiece.h"
 #include "tsl/platform/thread_annotations.h"
+#include "tsl/platform/threadpool.h"
 #include "tsl/platform/types.h"
 
 namespace tsl {
@@ -52,20 +54,40 @@ class RamFileBlockCache : public FileBlockCache {
 
   RamFileBlockCache(size_t block_size, size_t max_bytes, uint64 max_staleness,
                     BlockFetcher block_fetcher, Env* env = Env::Default())
+      : RamFileBlockCache(block_size, max_bytes, max_staleness,
+                          /*max_readahead_blocks=*/0, std::move(block_fetcher),
+                          env) {}
+
+  /// If `max_readahead_blocks` is positive, the blocks following a sequential
+  /// read of a file are fetched in the background, up to
+  /// `max_readahead_blocks` blocks ahead. The readahead window starts at one
+  /// block and doubles on every sequential read. Blocks that are part of a
+  /// single multi-block read are also fetched concurrently.
+  RamFileBlockCache(size_t block_size, size_t max_bytes, uint64 max_staleness,
+                    size_t max_readahead_blocks, BlockFetcher block_fetcher,
+                    Env* env = Env::Default())
       : block_size_(block_size),
         max_bytes_(max_bytes),
         max_staleness_(max_staleness),
+        max_readahead_blocks_(max_readahead_blocks),
         block_fetcher_(block_fetcher),
         env_(env) {
     if (max_staleness_ > 0) {
       pruning_thread_.reset(env_->StartThread(ThreadOptions(), "TF_prune_FBC",
                                               [this] { Prune(); }));
     }
+    if (IsCacheEnabled() && max_readahead_blocks_ > 0) {
+      readahead_pool_ = std::make_unique<thread::ThreadPool>(
+          env_, "TF_readahead_FBC", max_readahead_blocks_);
+    }
     VLOG(1) << "GCS file block cache is "
             << (IsCacheEnabled() ? "enabled" : "disabled");
   }
 
   ~RamFileBlockCache() override {
+    // Destroying readahead_pool_ will block until all pending readahead
+    // fetches return.
+    readahead_pool_.reset();
     if (pruning_thread_) {
       stop_pruning_thread_.Notify();
       // Destroying pruning_thread_ will block until Prune() receives the above
@@ -127,6 +149,8 @@ class RamFileBlockCache : public FileBlockCache {
   const size_t max_bytes_;
   /// The maximum staleness of any block in the LRU cache, in seconds.
   const uint64 max_staleness_;
+  /// The maximum number of blocks fetched ahead of a sequential read.
+  const size_t max_readahead_blocks_;
   /// The callback to read a block from the underlying filesystem.
   const BlockFetcher block_fetcher_;
   /// The Env from which we read timestamps.
@@ -200,6 +224,23 @@ class RamFileBlockCache : public FileBlockCache {
   absl::Status MaybeFetch(const Key& key, const std::shared_ptr<Block>& block)
       TF_LOCKS_EXCLUDED(mu_);
 
+  /// Insert a new empty block for `key`, which must not be in the cache.
+  std::shared_ptr<Block> Insert_Locked(const Key& key)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Returns true if a cached block of the same file after `key` holds data.
+  bool HasDataAfter(const Key& key) TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  /// Update the readahead window of `filename` for a read of `n` bytes at
+  /// `offset`, and schedule background fetches of the missing blocks in
+  /// [`start`, `finish`) and in the readahead window past `finish`.
+  void Readahead(const string& filename, size_t offset, size_t n,
+                 size_t start, size_t finish) TF_LOCKS_EXCLUDED(mu_);
+
+  /// Fetch a block scheduled by Readahead.
+  void FetchReadaheadBlock(const Key& key, const std::shared_ptr<Block>& block)
+      TF_LOCKS_EXCLUDED(mu_);
+
   /// Trim the block cache to make room for another entry.
   void Trim() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_);
 
@@ -221,6 +262,9 @@ class RamFileBlockCache : public FileBlockCache {
   /// Notification for stopping the cache pruning thread.
   Notification stop_pruning_thread_;
 
+  /// The threads fetching readahead blocks, or null if readahead is disabled.
+  std::unique_ptr<thread::ThreadPool> readahead_pool_;
+
   /// Guards access to the block map, LRU list, and cached byte count.
   mutable mutex mu_;
 
@@ -243,6 +287,20 @@ class RamFileBlockCache : public FileBlockCache {
 
   // A filename->file_signature map.
   std::map<string, int64_t> file_signature_map_ TF_GUARDED_BY(mu_);
+
+  /// \brief The sequential access state of a file.
+  struct ReadaheadState {
+    /// The offset at which the next read is sequential.
+    size_t next_offset = 0;
+    /// The number of blocks to fetch past the current read.
+    size_t window = 0;
+  };
+
+  /// The upper bound on the number of files tracked in readahead_state_.
+  static constexpr size_t kMaxReadaheadFiles = 1024;
+
+  // A filename->readahead state map.
+  std::map<string, ReadaheadState> readahead_state_ TF_GUARDED_BY(mu_);
 };
 
 }  // namespace tsl
@@ -15,12 +15,16 @@ limitations under the License.
 
 #include "tsl/platform/cloud/ram_file_block_cache.h"
 
+#include <algorithm>
 #include <cstring>
+#include <map>
+#include <vector>
 
 #include "xla/tsl/lib/core/status_test_util.h"
 #include "tsl/platform/blocking_counter.h"
 #include "tsl/platform/cloud/now_seconds_env.h"
 #include "tsl/platform/env.h"
+#include "tsl/platform/mutex.h"
 #include "tsl/platform/notification.h"
 #include "tsl/platform/test.h"
 
@@ -566,5 +570,96 @@ TEST(RamFileBlockCacheTest, Flush) {
   EXPECT_EQ(calls, 2);
 }
 
+TEST(RamFileBlockCacheTest, SequentialReadahead) {
+  const size_t block_size = 16;
+  const size_t file_size = 9 * block_size + 8;
+  mutex mu;
+  std::map<size_t, int> requests;
+  Notification second_block_requested;
+  auto fetcher = [&](const string& filename, size_t offset, size_t n,
+                     char* buffer, size_t* bytes_transferred) {
+    EXPECT_EQ(n, block_size);
+    {
+      mutex_lock l(mu);
+      requests[offset]++;
+    }
+    if (offset == block_size && !second_block_requested.HasBeenNotified()) {
+      second_block_requested.Notify();
+    }
+    size_t bytes_to_copy = 0;
+    if (offset < file_size) {
+      bytes_to_copy = std::min(n, file_size - offset);
+    }
+    memset(buffer, 'x', bytes_to_copy);
+    *bytes_transferred = bytes_to_copy;
+    return absl::OkStatus();
+  };
+  {
+    RamFileBlockCache cache(block_size, 16 * block_size, 0,
+                            /*max_readahead_blocks=*/4, fetcher);
+    std::vector<char> out;
+    TF_EXPECT_OK(ReadCache(&cache, "", 0, block_size, &out));
+    EXPECT_EQ(out.size(), block_size);
+    // The sequential read fetches the next block in the background.
+    EXPECT_TRUE(WaitForNotificationWithTimeout(&second_block_requested,
+                                               10 * 1000 * 1000));
+    for (size_t pos = block_size; pos < file_size; pos += block_size) {
+      TF_EXPECT_OK(ReadCache(&cache, "", pos, block_size, &out));
+      EXPECT_EQ(out.size(), std::min(block_size, file_size - pos));
+    }
+  }
+  // Every block of the file is fetched exactly once.
+  for (size_t pos = 0; pos < file_size; pos += block_size) {
+    EXPECT_EQ(requests[pos], 1) << "offset " << pos;
+  }
+}
+
+TEST(RamFileBlockCacheTest, RandomReadsDoNotReadahead) {
+  const size_t block_size = 16;
+  int calls = 0;
+  auto fetcher = [&calls](const string& filename, size_t offset, size_t n,
+                          char* buffer, size_t* bytes_transferred) {
+    calls++;
+    memset(buffer, 'x', n);
+    *bytes_transferred = n;
+    return absl::OkStatus();
+  };
+  {
+    RamFileBlockCache cache(block_size, 16 * block_size, 0,
+                            /*max_readahead_blocks=*/4, fetcher);
+    std::vector<char> out;
+    TF_EXPECT_OK(ReadCache(&cache, "", 4 * block_size, block_size, &out));
+    TF_EXPECT_OK(ReadCache(&cache, "", 8 * block_size, block_size, &out));
+    TF_EXPECT_OK(ReadCache(&cache, "", 2 * block_size, block_size, &out));
+  }
+  EXPECT_EQ(calls, 3);
+}
+
+TEST(RamFileBlockCacheTest, ReadaheadFetchesBlocksOfReadConcurrently) {
+  // This fetcher won't respond until `callers` requests are in flight, or 10
+  // seconds have elapsed.
+  const int callers = 4;
+  BlockingCounter counter(callers);
+  auto fetcher = [&counter](const string& filename, size_t offset, size_t n,
+                            char* buffer, size_t* bytes_transferred) {
+    counter.DecrementCount();
+    if (!counter.WaitFor(std::chrono::seconds(10))) {
+      return errors::FailedPrecondition("desired concurrency not reached");
+    }
+    memset(buffer, 'x', n);
+    *bytes_transferred = n;
+    return absl::OkStatus();
+  };
+  const size_t block_size = 8;
+  RamFileBlockCache cache(block_size, 4 * callers * block_size, 0,
+                          /*max_readahead_blocks=*/callers, fetcher);
+  std::vector<char> out;
+  // Start at an offset that is not sequential so that only the blocks of this
+  // read are fetched.
+  TF_EXPECT_OK(
+      ReadCache(&cache, "a", block_size, callers * block_size, &out));
+  EXPECT_EQ(out, std::vector<char>(callers * block_size, 'x'));
+}
+
 }  // namespace
 }  // namespace tsl
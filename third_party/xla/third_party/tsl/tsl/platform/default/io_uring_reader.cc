@@ -0,0 +1,374 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tsl/platform/default/io_uring_reader.h"
+
+#include <memory>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// IORING_FEAT_FAST_POLL was added in Linux 5.7, whose headers also define
+// IORING_OP_READ and IORING_REGISTER_PROBE.
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && \
+    defined(__NR_io_uring_register) && defined(IORING_FEAT_FAST_POLL)
+#define TSL_PLATFORM_HAS_IO_URING 1
+#endif
+#endif
+#endif
+
+#if defined(TSL_PLATFORM_HAS_IO_URING)
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/thread_annotations.h"
+#endif
+
+namespace tsl {
+
+#if defined(TSL_PLATFORM_HAS_IO_URING)
+namespace {
+
+// `user_data` of the no-op that stops the completion thread.
+constexpr uint64_t kStopUserData = 0;
+
+// The largest read submitted at once; longer reads are split like short
+// reads.
+constexpr size_t kMaxReadLength = INT32_MAX;
+
+int IoUringSetup(unsigned entries, io_uring_params* params) {
+  return syscall(__NR_io_uring_setup, entries, params);
+}
+
+int IoUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete,
+                 unsigned flags) {
+  return syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags,
+                 nullptr, 0);
+}
+
+int IoUringRegister(int ring_fd, unsigned opcode, void* arg,
+                    unsigned nr_args) {
+  return syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args);
+}
+
+// Returns whether the kernel behind `ring_fd` supports IORING_OP_READ.
+bool SupportsRead(int ring_fd) {
+  constexpr unsigned kNumProbeOps = 256;
+  const size_t probe_size =
+      sizeof(io_uring_probe) + kNumProbeOps * sizeof(io_uring_probe_op);
+  std::unique_ptr<io_uring_probe, decltype(&free)> probe(
+      static_cast<io_uring_probe*>(calloc(1, probe_size)), &free);
+  if (probe == nullptr ||
+      IoUringRegister(ring_fd, IORING_REGISTER_PROBE, probe.get(),
+                      kNumProbeOps) < 0) {
+    return false;
+  }
+  return probe->last_op >= IORING_OP_READ &&
+         (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED);
+}
+
+class IoUringReaderImpl : public IoUringReader {
+ public:
+  // Takes ownership of `ring_fd`.
+  static std::unique_ptr<IoUringReaderImpl> Create(
+      int ring_fd, const io_uring_params& params) {
+    auto reader = absl::WrapUnique(new IoUringReaderImpl(ring_fd, params));
+    if (!reader->MapRings(params)) return nullptr;
+    reader->completion_thread_.reset(Env::Default()->StartThread(
+        ThreadOptions(), "tsl_io_uring_completions",
+        [reader = reader.get()] { reader->ReapCompletions(); }));
+    return reader;
+  }
+
+  ~IoUringReaderImpl() override {
+    if (completion_thread_ != nullptr) {
+      mutex_lock l(mu_);
+      DCHECK_EQ(in_flight_, 0u) << "IoUringReader destroyed with reads pending";
+      io_uring_sqe* sqe = NextSqeLocked();
+      sqe->opcode = IORING_OP_NOP;
+      sqe->user_data = kStopUserData;
+      if (!SubmitLocked().ok()) {
+        LOG(FATAL) << "Failed to stop the io_uring completion thread";
+      }
+    }
+    // Joins the completion thread.
+    completion_thread_.reset();
+    if (sqes_ != MAP_FAILED) munmap(sqes_, sqes_size_);
+    if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != MAP_FAILED) munmap(sq_ring_, sq_ring_size_);
+    close(ring_fd_);
+  }
+
+  void Read(int fd, absl::string_view filename, uint64_t offset, size_t n,
+            char* scratch, RandomAccessFile::ReadDoneCallback done) override {
+    if (n == 0) {
+      done(absl::OkStatus(), absl::string_view(scratch, 0));
+      return;
+    }
+    auto* request = new Request{fd, filename, offset, scratch, n, 0,
+                                std::move(done)};
+    absl::Status s;
+    {
+      mutex_lock l(mu_);
+      while (in_flight_ >= max_in_flight_) {
+        capacity_cv_.wait(l);
+      }
+      ++in_flight_;
+      s = SubmitReadLocked(request);
+    }
+    if (!s.ok()) Finish(request, s);
+  }
+
+ private:
+  struct Request {
+    int fd;
+    absl::string_view filename;
+    uint64_t offset;
+    char* scratch;
+    size_t length;
+    // Number of bytes of the request that have been read so far.
+    size_t bytes_read;
+    RandomAccessFile::ReadDoneCallback done;
+  };
+
+  struct Completion {
+    Request* request;
+    int32_t result;
+  };
+
+  IoUringReaderImpl(int ring_fd, const io_uring_params& params)
+      : ring_fd_(ring_fd), max_in_flight_(params.cq_entries) {}
+
+  bool MapRings(const io_uring_params& params) {
+    sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_ring_size_ =
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+      sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+    }
+    sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_ring_ == MAP_FAILED) return false;
+    cq_ring_ = single_mmap
+                   ? sq_ring_
+                   : mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, ring_fd_,
+                          IORING_OFF_CQ_RING);
+    if (cq_ring_ == MAP_FAILED) return false;
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+    if (sqes_ == MAP_FAILED) return false;
+
+    char* sq = static_cast<char*>(sq_ring_);
+    sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    char* cq = static_cast<char*>(cq_ring_);
+    cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+    return true;
+  }
+
+  // Returns the zeroed submission queue entry at the tail. Since every entry
+  // is submitted before `mu_` is released, the queue is never full.
+  io_uring_sqe* NextSqeLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const unsigned index = *sq_tail_ & sq_mask_;
+    io_uring_sqe* sqe = static_cast<io_uring_sqe*>(sqes_) + index;
+    memset(sqe, 0, sizeof(*sqe));
+    sq_array_[index] = index;
+    return sqe;
+  }
+
+  // Hands the entry returned by the last NextSqeLocked() to the kernel.
+  absl::Status SubmitLocked() TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    const unsigned tail = *sq_tail_;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    int r;
+    do {
+      r = IoUringEnter(ring_fd_, 1, 0, 0);
+    } while (r < 0 && errno == EINTR);
+    if (r == 1) return absl::OkStatus();
+    // The kernel did not consume the entry, so take it back.
+    const int error = r < 0 ? errno : EAGAIN;
+    __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+    return errors::Internal("io_uring_enter() failed: ", strerror(error));
+  }
+
+  // Submits a read of the rest of `request`.
+  absl::Status SubmitReadLocked(Request* request)
+      TF_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    io_uring_sqe* sqe = NextSqeLocked();
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = request->fd;
+    sqe->off = request->offset + request->bytes_read;
+    sqe->addr = reinterpret_cast<uintptr_t>(request->scratch +
+                                            request->bytes_read);
+    sqe->len = std::min(request->length - request->bytes_read, kMaxReadLength);
+    sqe->user_data = reinterpret_cast<uintptr_t>(request);
+    return SubmitLocked();
+  }
+
+  // Runs on `completion_thread_` until the stop no-op completes.
+  void ReapCompletions() {
+    std::vector<Completion> completions;
+    bool stop = false;
+    while (!stop) {
+      // Only this thread advances the head, so it can be read relaxed.
+      unsigned head = __atomic_load_n(cq_head_, __ATOMIC_RELAXED);
+      const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+      if (head == tail) {
+        const int r = IoUringEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS);
+        if (r < 0 && errno != EINTR) {
+          LOG(FATAL) << "Waiting for io_uring completions failed: "
+                     << strerror(errno);
+        }
+        continue;
+      }
+      // Copy the completions out first, so that the reads submitted by their
+      // callbacks always find room in the completion queue.
+      completions.clear();
+      for (; head != tail; ++head) {
+        const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+        if (cqe.user_data == kStopUserData) {
+          stop = true;
+        } else {
+          completions.push_back(
+              {reinterpret_cast<Request*>(cqe.user_data), cqe.res});
+        }
+      }
+      __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+      for (const Completion& completion : completions) {
+        HandleCompletion(completion.request, completion.result);
+      }
+    }
+  }
+
+  void HandleCompletion(Request* request, int32_t result) {
+    if (result > 0) {
+      request->bytes_read += result;
+      if (request->bytes_read == request->length) {
+        Finish(request, absl::OkStatus());
+        return;
+      }
+    } else if (result == 0) {
+      Finish(request, absl::Status(absl::StatusCode::kOutOfRange,
+                                   "Read less bytes than requested"));
+      return;
+    } else if (result != -EINTR && result != -EAGAIN) {
+      Finish(request,
+             errors::IOError(std::string(request->filename), -result));
+      return;
+    }
+    // Short or interrupted read: read the rest, like the pread() loop in
+    // PosixRandomAccessFile::Read() does.
+    absl::Status s;
+    {
+      mutex_lock l(mu_);
+      s = SubmitReadLocked(request);
+    }
+    if (!s.ok()) Finish(request, s);
+  }
+
+  void Finish(Request* request, absl::Status status) {
+    {
+      mutex_lock l(mu_);
+      --in_flight_;
+    }
+    capacity_cv_.notify_one();
+    request->done(std::move(status),
+                  absl::string_view(request->scratch, request->bytes_read));
+    delete request;
+  }
+
+  const int ring_fd_;
+  // Bounds the reads in flight so that their completions fit into the
+  // completion queue.
+  const unsigned max_in_flight_;
+
+  void* sq_ring_ = MAP_FAILED;
+  size_t sq_ring_size_ = 0;
+  void* cq_ring_ = MAP_FAILED;
+  size_t cq_ring_size_ = 0;
+  void* sqes_ = MAP_FAILED;
+  size_t sqes_size_ = 0;
+
+  unsigned* sq_tail_ = nullptr;
+  unsigned sq_mask_ = 0;
+  unsigned* sq_array_ = nullptr;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned cq_mask_ = 0;
+  io_uring_cqe* cqes_ = nullptr;
+
+  mutex mu_;
+  condition_variable capacity_cv_;
+  unsigned in_flight_ TF_GUARDED_BY(mu_) = 0;
+
+  std::unique_ptr<Thread> completion_thread_;
+};
+
+}  // namespace
+
+std::unique_ptr<IoUringReader> CreateIoUringReader(unsigned entries) {
+  io_uring_params params = {};
+  const int ring_fd = IoUringSetup(entries, &params);
+  if (ring_fd < 0) {
+    VLOG(1) << "io_uring is unavailable: " << strerror(errno);
+    return nullptr;
+  }
+  if (!SupportsRead(ring_fd)) {
+    VLOG(1) << "io_uring does not support IORING_OP_READ";
+    close(ring_fd);
+    return nullptr;
+  }
+  return IoUringReaderImpl::Create(ring_fd, params);
+}
+
+#else
+
+std::unique_ptr<IoUringReader> CreateIoUringReader(unsigned entries) {
+  return nullptr;
+}
+
+#endif  // TSL_PLATFORM_HAS_IO_URING
+
+IoUringReader* DefaultIoUringReader() {
+  static IoUringReader* reader =
+      CreateIoUringReader(/*entries=*/256).release();
+  return reader;
+}
+
+}  // namespace tsl
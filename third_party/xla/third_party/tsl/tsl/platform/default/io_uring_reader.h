@@ -0,0 +1,58 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_TSL_PLATFORM_DEFAULT_IO_URING_READER_H_
+#define TENSORFLOW_TSL_PLATFORM_DEFAULT_IO_URING_READER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "tsl/platform/file_system.h"
+#include "tsl/platform/stringpiece.h"
+
+namespace tsl {
+
+// Reads from file descriptors asynchronously through a Linux io_uring. All
+// reads share one submission queue, and one thread reaps their completions
+// and runs their callbacks.
+//
+// Thread-safe.
+class IoUringReader {
+ public:
+  virtual ~IoUringReader() = default;
+
+  // Reads `n` bytes of `fd` starting at `offset` into `scratch`, with the
+  // semantics of RandomAccessFile::ReadAsync. `filename` is only used for
+  // error messages. `fd`, `filename` and `scratch` must stay valid until
+  // `done` has been called. Blocks while the maximum number of reads is in
+  // flight, so `done` must not call it.
+  virtual void Read(int fd, absl::string_view filename, uint64_t offset,
+                    size_t n, char* scratch,
+                    RandomAccessFile::ReadDoneCallback done) = 0;
+};
+
+// Creates a reader with a submission queue of `entries` entries. Returns
+// nullptr if io_uring is unavailable, e.g. on other platforms, kernels
+// older than 5.7 and sandboxes that block the io_uring syscalls. All reads
+// must have finished before the reader is destroyed.
+std::unique_ptr<IoUringReader> CreateIoUringReader(unsigned entries);
+
+// Returns a process-wide reader, or nullptr if io_uring is unavailable.
+IoUringReader* DefaultIoUringReader();
+
+}  // namespace tsl
+
+#endif  // TENSORFLOW_TSL_PLATFORM_DEFAULT_IO_URING_READER_H_
@@ -29,7 +29,10 @@ limitations under the License.
 #include <time.h>
 #include <unistd.h>
 
+#include <utility>
+
 #include "xla/tsl/protobuf/error_codes.pb.h"
+#include "tsl/platform/default/io_uring_reader.h"
 #include "tsl/platform/default/posix_file_system.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/errors.h"
@@ -97,6 +100,16 @@ class PosixRandomAccessFile : public RandomAccessFile {
     return s;
   }
 
+  void ReadAsync(uint64 offset, size_t n, char* scratch,
+                 ReadDoneCallback done) const override {
+    IoUringReader* reader = DefaultIoUringReader();
+    if (reader == nullptr) {
+      RandomAccessFile::ReadAsync(offset, n, scratch, std::move(done));
+      return;
+    }
+    reader->Read(fd_, filename_, offset, n, scratch, std::move(done));
+  }
+
 #if defined(TF_CORD_SUPPORT)
   absl::Status Read(uint64 offset, size_t n, absl::Cord* cord) const override {
     if (n == 0) {
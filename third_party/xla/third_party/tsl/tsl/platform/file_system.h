@@ -793,6 +793,30 @@ class RandomAccessFile {
   }
 #endif
 
+  /// \brief Called with the outcome of `ReadAsync()`. `status` and `result`
+  /// have the same meaning as the return value and `*result` of `Read()`.
+  using ReadDoneCallback =
+      std::function<void(absl::Status status, absl::string_view result)>;
+
+  /// \brief Starts reading up to `n` bytes from the file starting at
+  /// `offset` into `scratch[0..n-1]`, and calls `done` when the read has
+  /// finished.
+  ///
+  /// Lets a single thread keep many reads in flight. `done` may be called
+  /// before this method returns, and on an arbitrary thread that is shared
+  /// with other reads, so it must not block. This file and `scratch` must
+  /// stay alive until `done` is called.
+  ///
+  /// The default implementation calls `Read()` synchronously.
+  ///
+  /// Safe for concurrent use by multiple threads.
+  virtual void ReadAsync(uint64 offset, size_t n, char* scratch,
+                         ReadDoneCallback done) const {
+    absl::string_view result;
+    absl::Status s = Read(offset, n, &result, scratch);
+    done(std::move(s), result);
+  }
+
  private:
   RandomAccessFile(const RandomAccessFile&) = delete;
   void operator=(const RandomAccessFile&) = delete;
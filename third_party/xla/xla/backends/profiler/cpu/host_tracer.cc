@@ -21,6 +21,7 @@ limitations under the License.
 
 #include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "xla/backends/profiler/cpu/perf_counter_tracer.h"
 #include "xla/tsl/profiler/backends/cpu/host_tracer_utils.h"
 #include "xla/tsl/profiler/backends/cpu/threadpool_listener.h"
 #include "xla/tsl/profiler/backends/cpu/traceme_recorder.h"
@@ -119,6 +120,13 @@ std::unique_ptr<tsl::profiler::ProfilerInterface> CreateHostTracer(
   if (options.trace_level == 0) return nullptr;
   std::vector<std::unique_ptr<tsl::profiler::ProfilerInterface>> profilers;
   profilers.push_back(std::make_unique<HostTracer>(options.trace_level));
+  if (options.enable_perf_counters) {
+    // Must come after the host tracer, whose events it annotates.
+    if (auto perf_counter_tracer =
+            CreatePerfCounterTracer(PerfCounterTracerOptions())) {
+      profilers.push_back(std::move(perf_counter_tracer));
+    }
+  }
   profilers.push_back(
       std::make_unique<tsl::profiler::ThreadpoolProfilerInterface>());
   return std::make_unique<tsl::profiler::ProfilerCollection>(
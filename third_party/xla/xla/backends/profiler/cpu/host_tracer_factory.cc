@@ -14,7 +14,10 @@ limitations under the License.
 ==============================================================================*/
 #include <memory>
 
+#include "absl/log/log.h"
+#include "absl/status/status.h"
 #include "xla/backends/profiler/cpu/host_tracer.h"
+#include "xla/tsl/util/env_var.h"
 #include "tsl/profiler/lib/profiler_factory.h"
 #include "tsl/profiler/lib/profiler_interface.h"
 #include "tsl/profiler/protobuf/profiler_options.pb.h"
@@ -27,6 +30,12 @@ std::unique_ptr<tsl::profiler::ProfilerInterface> CreateHostTracer(
     const tensorflow::ProfileOptions& profile_options) {
   HostTracerOptions options;
   options.trace_level = profile_options.host_tracer_level();
+  absl::Status status = tsl::ReadBoolFromEnvVar(
+      "TF_PROFILER_ENABLE_CPU_PERF_COUNTERS", false,
+      &options.enable_perf_counters);
+  if (!status.ok()) {
+    LOG(ERROR) << status;
+  }
   return CreateHostTracer(options);
 }
 
@@ -229,6 +229,47 @@ TEST(HostTracerTest, CollectEventsFromThreadPool) {
   EXPECT_TRUE(region_timespan.Includes(traceme_timespan));
 }
 
+TEST(HostTracerTest, AttachesPerfCountersToEvents) {
+  HostTracerOptions options;
+  options.enable_perf_counters = true;
+  auto tracer = CreateHostTracer(options);
+
+  TF_ASSERT_OK(tracer->Start());
+  {
+    TraceMe traceme("busy");
+    // Run long enough for the sampler to read the counters during the event.
+    const uint64_t end_us = Env::Default()->NowMicros() + 20000;
+    volatile uint64_t sum = 0;
+    while (Env::Default()->NowMicros() < end_us) {
+      for (int i = 0; i < 1000; ++i) sum += i;
+    }
+  }
+  TF_ASSERT_OK(tracer->Stop());
+  tensorflow::profiler::XSpace space;
+  TF_ASSERT_OK(tracer->CollectData(&space));
+
+  std::optional<uint64_t> cycles, instructions;
+  ASSERT_EQ(space.planes_size(), 1);
+  XPlaneVisitor xplane = tsl::profiler::CreateTfXPlaneVisitor(&space.planes(0));
+  xplane.ForEachLine([&](const XLineVisitor& line) {
+    line.ForEachEvent([&](const XEventVisitor& event) {
+      if (event.Name() != "busy") return;
+      if (auto stat = event.GetStat(StatType::kCpuCycles)) {
+        cycles = stat->IntOrUintValue();
+      }
+      if (auto stat = event.GetStat(StatType::kCpuInstructions)) {
+        instructions = stat->IntOrUintValue();
+      }
+    });
+  });
+  if (!cycles.has_value()) {
+    GTEST_SKIP() << "Hardware performance counters are unavailable.";
+  }
+  EXPECT_GT(*cycles, 0);
+  ASSERT_TRUE(instructions.has_value());
+  EXPECT_GT(*instructions, 0);
+}
+
 }  // namespace
 }  // namespace profiler
 }  // namespace xla
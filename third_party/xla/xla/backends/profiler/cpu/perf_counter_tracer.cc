@@ -0,0 +1,303 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/backends/profiler/cpu/perf_counter_tracer.h"
+
+#include <memory>
+
+#include "tsl/profiler/lib/profiler_interface.h"
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/log/log.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
+#include "xla/tsl/profiler/utils/math_utils.h"
+#include "xla/tsl/profiler/utils/time_utils.h"
+#include "xla/tsl/profiler/utils/xplane_builder.h"
+#include "xla/tsl/profiler/utils/xplane_schema.h"
+#include "xla/tsl/profiler/utils/xplane_utils.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/profiler/protobuf/xplane.pb.h"
+#endif
+
+namespace xla {
+namespace profiler {
+namespace {
+
+#if defined(__linux__)
+
+// The counters opened on each thread, in the order of the read group.
+constexpr std::array<uint64_t, 3> kCounterConfigs = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,
+};
+constexpr std::array<tsl::profiler::StatType, 3> kCounterStatTypes = {
+    tsl::profiler::StatType::kCpuCycles,
+    tsl::profiler::StatType::kCpuInstructions,
+    tsl::profiler::StatType::kCpuCacheMisses,
+};
+constexpr int kNumCounters = kCounterConfigs.size();
+
+using CounterValues = std::array<uint64_t, kNumCounters>;
+
+struct CounterSample {
+  int64_t timestamp_ns;
+  CounterValues values;
+};
+
+int OpenCounter(int64_t tid, uint64_t config, int group_fd) {
+  perf_event_attr attr = {};
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.config = config;
+  attr.read_format = PERF_FORMAT_GROUP;
+  // Only the group leader starts disabled; the followers are scheduled with
+  // it.
+  attr.disabled = group_fd < 0;
+  // Counting user space only works with the default perf_event_paranoid
+  // setting.
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return syscall(__NR_perf_event_open, &attr, static_cast<pid_t>(tid),
+                 /*cpu=*/-1, group_fd, /*flags=*/0);
+}
+
+std::vector<int64_t> ListProcessThreads() {
+  std::vector<int64_t> tids;
+  DIR* dir = opendir("/proc/self/task");
+  if (dir == nullptr) return tids;
+  while (dirent* entry = readdir(dir)) {
+    char* end;
+    int64_t tid = strtoll(entry->d_name, &end, 10);
+    if (*end == '\0' && tid > 0) tids.push_back(tid);
+  }
+  closedir(dir);
+  return tids;
+}
+
+// Linearly interpolates the cumulative counter values at `timestamp_ns`.
+// Returns false if `timestamp_ns` is outside of the sampled range.
+bool InterpolateCounters(const std::vector<CounterSample>& samples,
+                         int64_t timestamp_ns, CounterValues* values) {
+  if (samples.empty() || timestamp_ns < samples.front().timestamp_ns ||
+      timestamp_ns > samples.back().timestamp_ns) {
+    return false;
+  }
+  auto after = std::lower_bound(samples.begin(), samples.end(), timestamp_ns,
+                                [](const CounterSample& sample, int64_t ts) {
+                                  return sample.timestamp_ns < ts;
+                                });
+  if (after == samples.begin() || after->timestamp_ns == timestamp_ns) {
+    *values = after->values;
+    return true;
+  }
+  auto before = std::prev(after);
+  const double fraction =
+      static_cast<double>(timestamp_ns - before->timestamp_ns) /
+      (after->timestamp_ns - before->timestamp_ns);
+  for (int i = 0; i < kNumCounters; ++i) {
+    (*values)[i] = before->values[i] +
+                   fraction * (after->values[i] - before->values[i]);
+  }
+  return true;
+}
+
+// Reads hardware counters of every thread periodically and attributes them to
+// the host events recorded by the host tracer.
+//
+// Thread-safety: This class is go/thread-compatible.
+class PerfCounterTracer : public tsl::profiler::ProfilerInterface {
+ public:
+  explicit PerfCounterTracer(absl::Duration sampling_interval)
+      : sampling_interval_(sampling_interval) {}
+
+  ~PerfCounterTracer() override { Stop().IgnoreError(); }  // NOLINT
+
+  absl::Status Start() override {  // TENSORFLOW_STATUS_OK
+    if (sampler_ != nullptr) {
+      return tsl::errors::Internal("PerfCounterTracer already started");
+    }
+    for (int64_t tid : ListProcessThreads()) {
+      ThreadCounters counters;
+      counters.tid = tid;
+      if (OpenThreadCounters(&counters)) {
+        threads_.push_back(std::move(counters));
+      }
+    }
+    if (threads_.empty()) {
+      LOG(WARNING) << "Hardware performance counters are unavailable; check "
+                      "/proc/sys/kernel/perf_event_paranoid.";
+      return absl::OkStatus();
+    }
+    for (ThreadCounters& counters : threads_) {
+      ioctl(counters.fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+    ReadCounters();
+    stop_ = std::make_unique<absl::Notification>();
+    sampler_.reset(tsl::Env::Default()->StartThread(
+        tsl::ThreadOptions(), "perf_counter_sampler", [this] {
+          while (!stop_->WaitForNotificationWithTimeout(sampling_interval_)) {
+            ReadCounters();
+          }
+        }));
+    return absl::OkStatus();
+  }
+
+  absl::Status Stop() override {  // TENSORFLOW_STATUS_OK
+    if (sampler_ == nullptr) {
+      return absl::OkStatus();
+    }
+    stop_->Notify();
+    sampler_.reset();
+    ReadCounters();
+    for (ThreadCounters& counters : threads_) {
+      CloseThreadCounters(&counters);
+    }
+    return absl::OkStatus();
+  }
+
+  absl::Status CollectData(  // TENSORFLOW_STATUS_OK
+      tensorflow::profiler::XSpace* space) override {
+    if (sampler_ != nullptr) {
+      return tsl::errors::Internal("PerfCounterTracer not stopped");
+    }
+    tensorflow::profiler::XPlane* raw_plane =
+        tsl::profiler::FindMutablePlaneWithName(
+            space, tsl::profiler::kHostThreadsPlaneName);
+    if (raw_plane == nullptr || threads_.empty()) {
+      threads_.clear();
+      return absl::OkStatus();
+    }
+    absl::flat_hash_map<int64_t, const std::vector<CounterSample>*>
+        samples_by_tid;
+    for (const ThreadCounters& counters : threads_) {
+      samples_by_tid[counters.tid] = &counters.samples;
+    }
+    tsl::profiler::XPlaneBuilder plane(raw_plane);
+    std::array<tsl::profiler::XStatMetadata*, kNumCounters> stat_metadata;
+    for (int i = 0; i < kNumCounters; ++i) {
+      stat_metadata[i] = plane.GetOrCreateStatMetadata(
+          tsl::profiler::GetStatTypeStr(kCounterStatTypes[i]));
+    }
+    plane.ForEachLine([&](tsl::profiler::XLineBuilder line) {
+      auto it = samples_by_tid.find(line.Id());
+      if (it == samples_by_tid.end()) return;
+      const std::vector<CounterSample>& samples = *it->second;
+      line.ForEachEvent([&](tsl::profiler::XEventBuilder event) {
+        const int64_t begin_ns = tsl::profiler::PicoToNano(event.TimestampPs());
+        const int64_t end_ns =
+            begin_ns + tsl::profiler::PicoToNano(event.DurationPs());
+        CounterValues begin, end;
+        if (!InterpolateCounters(samples, begin_ns, &begin) ||
+            !InterpolateCounters(samples, end_ns, &end)) {
+          return;
+        }
+        for (int i = 0; i < kNumCounters; ++i) {
+          event.AddStatValue(*stat_metadata[i],
+                             end[i] >= begin[i] ? end[i] - begin[i] : 0);
+        }
+      });
+    });
+    threads_.clear();
+    return absl::OkStatus();
+  }
+
+ private:
+  struct ThreadCounters {
+    int64_t tid;
+    std::array<int, kNumCounters> fds;
+    std::vector<CounterSample> samples;
+  };
+
+  static bool OpenThreadCounters(ThreadCounters* counters) {
+    counters->fds.fill(-1);
+    for (int i = 0; i < kNumCounters; ++i) {
+      counters->fds[i] =
+          OpenCounter(counters->tid, kCounterConfigs[i], counters->fds[0]);
+      if (counters->fds[i] < 0) {
+        CloseThreadCounters(counters);
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static void CloseThreadCounters(ThreadCounters* counters) {
+    for (int& fd : counters->fds) {
+      if (fd >= 0) close(fd);
+      fd = -1;
+    }
+  }
+
+  // Appends one sample per thread. Threads that exited stop producing
+  // samples.
+  void ReadCounters() {
+    struct {
+      uint64_t nr;
+      uint64_t values[kNumCounters];
+    } group;
+    for (ThreadCounters& counters : threads_) {
+      if (counters.fds[0] < 0) continue;
+      const int64_t timestamp_ns = tsl::profiler::GetCurrentTimeNanos();
+      if (read(counters.fds[0], &group, sizeof(group)) != sizeof(group) ||
+          group.nr != kNumCounters) {
+        continue;
+      }
+      CounterSample& sample = counters.samples.emplace_back();
+      sample.timestamp_ns = timestamp_ns;
+      std::copy(std::begin(group.values), std::end(group.values),
+                sample.values.begin());
+    }
+  }
+
+  const absl::Duration sampling_interval_;
+  std::vector<ThreadCounters> threads_;
+  std::unique_ptr<absl::Notification> stop_;
+  std::unique_ptr<tsl::Thread> sampler_;
+};
+
+#endif  // defined(__linux__)
+
+}  // namespace
+
+std::unique_ptr<tsl::profiler::ProfilerInterface> CreatePerfCounterTracer(
+    const PerfCounterTracerOptions& options) {
+#if defined(__linux__)
+  return std::make_unique<PerfCounterTracer>(options.sampling_interval);
+#else
+  return nullptr;
+#endif
+}
+
+}  // namespace profiler
+}  // namespace xla
@@ -0,0 +1,47 @@
+/* Copyright 2024 The OpenXLA Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+#ifndef XLA_BACKENDS_PROFILER_CPU_PERF_COUNTER_TRACER_H_
+#define XLA_BACKENDS_PROFILER_CPU_PERF_COUNTER_TRACER_H_
+
+#include <memory>
+
+#include "absl/time/time.h"
+#include "tsl/profiler/lib/profiler_interface.h"
+
+namespace xla {
+namespace profiler {
+
+struct PerfCounterTracerOptions {
+  // How often the hardware counters of every thread are read. Counter values
+  // for events are interpolated between the two surrounding readings, so
+  // events much shorter than this interval get approximate values.
+  absl::Duration sampling_interval = absl::Milliseconds(1);
+};
+
+// Returns a profiler that counts CPU cycles, retired instructions and last
+// level cache misses on every thread of the process that exists when
+// profiling starts. When collecting data, it attaches the counts observed
+// during each event of the host threads plane as the kCpuCycles,
+// kCpuInstructions and kCpuCacheMisses stats. It must therefore collect data
+// after the host tracer.
+//
+// Returns nullptr if hardware counters are not supported on this platform.
+std::unique_ptr<tsl::profiler::ProfilerInterface> CreatePerfCounterTracer(
+    const PerfCounterTracerOptions& options);
+
+}  // namespace profiler
+}  // namespace xla
+
+#endif  // XLA_BACKENDS_PROFILER_CPU_PERF_COUNTER_TRACER_H_
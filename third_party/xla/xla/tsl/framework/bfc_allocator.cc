@@ -30,10 +30,13 @@ limitations under the License.
 
 #include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
 #include "xla/tsl/framework/allocator.h"
 #include "xla/tsl/framework/allocator_retry.h"
+#include "xla/tsl/framework/memory_event_ring.h"
 #include "xla/tsl/protobuf/bfc_memory_map.pb.h"
 #include "tsl/platform/env.h"
 #include "tsl/platform/file_system.h"
@@ -76,6 +79,20 @@ BFCAllocator::BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator,
   memory_limit_ = total_memory;
   stats_.bytes_limit = static_cast<int64_t>(total_memory);
 
+  size_t memory_event_ring_size = opts.memory_event_ring_size;
+  if (memory_event_ring_size == 0) {
+    const char* ring_size_env = std::getenv("TF_BFC_MEMORY_EVENT_RING_SIZE");
+    if (ring_size_env != nullptr &&
+        !absl::SimpleAtoi(ring_size_env, &memory_event_ring_size)) {
+      LOG(ERROR) << "Invalid TF_BFC_MEMORY_EVENT_RING_SIZE: " << ring_size_env;
+      memory_event_ring_size = 0;
+    }
+  }
+  if (memory_event_ring_size > 0) {
+    memory_events_ = std::make_unique<MemoryEventRing>(name, total_memory,
+                                                       memory_event_ring_size);
+  }
+
   // Create a bunch of bins of various good sizes.
 
   // We create bins to fit all possible ranges that cover the
@@ -534,6 +551,10 @@ void BFCAllocator::AddTraceMe(absl::string_view traceme_name, const void* ptr) {
 void BFCAllocator::AddTraceMe(absl::string_view traceme_name,
                               const void* chunk_ptr, int64_t req_bytes,
                               int64_t alloc_bytes) {
+  if (memory_events_ != nullptr) {
+    RecordMemoryEvent(traceme_name == "MemoryAllocation", chunk_ptr, req_bytes,
+                      alloc_bytes);
+  }
   tsl::profiler::TraceMe::InstantActivity(
       [this, traceme_name, chunk_ptr, req_bytes, alloc_bytes]()
           ABSL_NO_THREAD_SAFETY_ANALYSIS {
@@ -566,6 +587,23 @@ void BFCAllocator::AddTraceMe(absl::string_view traceme_name,
       /*level=*/tsl::profiler::TraceMeLevel::kInfo);
 }
 
+void BFCAllocator::RecordMemoryEvent(bool is_allocation, const void* chunk_ptr,
+                                     int64_t req_bytes, int64_t alloc_bytes) {
+  const auto& annotation =
+      tsl::profiler::ScopedMemoryDebugAnnotation::CurrentAnnotation();
+  MemoryEvent event;
+  event.timestamp_ns = absl::GetCurrentTimeNanos();
+  event.address = reinterpret_cast<uint64_t>(chunk_ptr);
+  event.requested_bytes = req_bytes;
+  event.allocation_bytes = alloc_bytes;
+  event.bytes_in_use = stats_.bytes_in_use;
+  event.bytes_reserved = stats_.bytes_reserved;
+  event.peak_bytes_in_use = stats_.peak_bytes_in_use;
+  event.step_id = annotation.pending_step_id;
+  event.is_allocation = is_allocation;
+  memory_events_->Record(event, annotation.pending_op_name);
+}
+
 void* BFCAllocator::FindChunkPtr(BinNum bin_num, size_t rounded_bytes,
                                  size_t num_bytes, uint64 freed_before) {
   // First identify the first bin that could satisfy rounded_bytes.
@@ -1222,7 +1260,9 @@ MemoryDump BFCAllocator::RecordMemoryMapInternal() {
 
 std::optional<AllocatorStats> BFCAllocator::GetStats() {
   absl::MutexLock l(&mutex_);
-  return stats_;
+  AllocatorStats stats = stats_;
+  stats.largest_free_block_bytes = LargestFreeChunk();
+  return stats;
 }
 
 bool BFCAllocator::ClearStats() {
@@ -32,6 +32,7 @@ limitations under the License.
 #include "absl/synchronization/mutex.h"
 #include "xla/tsl/framework/allocator.h"
 #include "xla/tsl/framework/allocator_retry.h"
+#include "xla/tsl/framework/memory_event_ring.h"
 #include "xla/tsl/framework/shared_counter.h"
 #include "xla/tsl/lib/core/bits.h"
 #include "tsl/platform/logging.h"
@@ -73,6 +74,11 @@ class BFCAllocator : public Allocator {
     // Controls when a chunk should be split, if its size exceeds the requested
     // allocation size.
     double fragmentation_fraction = 0;
+
+    // If positive, the most recent allocations and deallocations are kept in
+    // a MemoryEventRing of this many events. Can also be set with the
+    // TF_BFC_MEMORY_EVENT_RING_SIZE environment variable.
+    size_t memory_event_ring_size = 0;
   };
   BFCAllocator(std::unique_ptr<SubAllocator> sub_allocator, size_t total_memory,
                const string& name, const Options& opts);
@@ -157,6 +163,11 @@ class BFCAllocator : public Allocator {
                   int64_t req_bytes, int64_t alloc_bytes)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
+  // Appends an event to memory_events_, which must not be null.
+  void RecordMemoryEvent(bool is_allocation, const void* chunk_ptr,
+                         int64_t req_bytes, int64_t alloc_bytes)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
   // A ChunkHandle is an index into the chunks_ vector in BFCAllocator
   // kInvalidChunkHandle means an invalid chunk
   typedef size_t ChunkHandle;
@@ -576,6 +587,7 @@ class BFCAllocator : public Allocator {
   string name_;
   SharedCounter* timing_counter_ = nullptr;
   std::deque<ChunkHandle> timestamped_chunks_;
+  std::unique_ptr<MemoryEventRing> memory_events_;
 
   std::atomic<uint64> safe_frontier_ = {0};
 
@@ -0,0 +1,97 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/tsl/framework/memory_event_ring.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/attributes.h"
+#include "absl/base/const_init.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/hash/hash.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+
+namespace tsl {
+namespace {
+
+ABSL_CONST_INIT absl::Mutex registry_mutex(absl::kConstInit);
+
+absl::flat_hash_set<const MemoryEventRing*>& Registry()
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(registry_mutex) {
+  static auto* registry = new absl::flat_hash_set<const MemoryEventRing*>();
+  return *registry;
+}
+
+}  // namespace
+
+MemoryEventRing::MemoryEventRing(std::string allocator_name,
+                                 int64_t memory_limit, size_t capacity)
+    : allocator_name_(std::move(allocator_name)),
+      memory_limit_(memory_limit),
+      events_(std::max<size_t>(capacity, 1)) {
+  absl::MutexLock lock(&registry_mutex);
+  Registry().insert(this);
+}
+
+MemoryEventRing::~MemoryEventRing() {
+  absl::MutexLock lock(&registry_mutex);
+  Registry().erase(this);
+}
+
+void MemoryEventRing::Record(MemoryEvent event, const char* op_name) {
+  absl::string_view name;
+  if (op_name != nullptr) {
+    name = op_name;
+    // Keep zero for events without an op.
+    event.op_name_hash = absl::HashOf(name) | 1;
+  }
+  absl::MutexLock lock(&mutex_);
+  events_[num_recorded_++ % events_.size()] = event;
+  if (event.op_name_hash != 0 && op_names_.size() < kMaxOpNames) {
+    op_names_.try_emplace(event.op_name_hash, name);
+  }
+}
+
+MemoryEventRing::Snapshot MemoryEventRing::GetSnapshot() const {
+  Snapshot snapshot;
+  snapshot.allocator_name = allocator_name_;
+  snapshot.memory_limit = memory_limit_;
+  absl::MutexLock lock(&mutex_);
+  const uint64_t num_events = std::min<uint64_t>(num_recorded_, events_.size());
+  snapshot.events.reserve(num_events);
+  for (uint64_t i = num_recorded_ - num_events; i < num_recorded_; ++i) {
+    snapshot.events.push_back(events_[i % events_.size()]);
+  }
+  snapshot.op_names = op_names_;
+  return snapshot;
+}
+
+/* static */ std::vector<MemoryEventRing::Snapshot>
+MemoryEventRing::SnapshotAll() {
+  std::vector<Snapshot> snapshots;
+  absl::MutexLock lock(&registry_mutex);
+  for (const MemoryEventRing* ring : Registry()) {
+    snapshots.push_back(ring->GetSnapshot());
+  }
+  return snapshots;
+}
+
+}  // namespace tsl
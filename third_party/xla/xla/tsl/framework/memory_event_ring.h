@@ -0,0 +1,98 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_TSL_FRAMEWORK_MEMORY_EVENT_RING_H_
+#define XLA_TSL_FRAMEWORK_MEMORY_EVENT_RING_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+
+namespace tsl {
+
+// A fixed-size record of one allocation or deallocation. Op names are stored
+// as hashes and resolved through MemoryEventRing::Snapshot::op_names.
+struct MemoryEvent {
+  int64_t timestamp_ns = 0;
+  uint64_t address = 0;
+  int64_t requested_bytes = 0;
+  int64_t allocation_bytes = 0;
+  // Allocator state after the event.
+  int64_t bytes_in_use = 0;
+  int64_t bytes_reserved = 0;
+  int64_t peak_bytes_in_use = 0;
+  // Zero if the event was not attributed to an op.
+  uint64_t op_name_hash = 0;
+  int64_t step_id = 0;
+  bool is_allocation = false;
+};
+
+// A preallocated ring buffer of the most recent MemoryEvents of an allocator.
+// Recording an event copies a few words and hashes the op name, which keeps
+// it cheap enough to stay enabled on production jobs, unlike LogMemory or
+// host tracing. All live rings can be snapshotted at any time, e.g. after an
+// OOM, and converted into the profiler's memory profile.
+//
+// Thread-safe.
+class MemoryEventRing {
+ public:
+  struct Snapshot {
+    std::string allocator_name;
+    int64_t memory_limit = 0;
+    // Oldest first.
+    std::vector<MemoryEvent> events;
+    absl::flat_hash_map<uint64_t, std::string> op_names;
+  };
+
+  // Registers the ring so that it is included in SnapshotAll().
+  MemoryEventRing(std::string allocator_name, int64_t memory_limit,
+                  size_t capacity);
+  ~MemoryEventRing();
+
+  MemoryEventRing(const MemoryEventRing&) = delete;
+  MemoryEventRing& operator=(const MemoryEventRing&) = delete;
+
+  // Records `event`. If `op_name` is not null, its hash is stored in the event.
+  // Overwrites the oldest event when the ring is full.
+  void Record(MemoryEvent event, const char* op_name);
+
+  Snapshot GetSnapshot() const;
+
+  // Returns the snapshots of all live rings.
+  static std::vector<Snapshot> SnapshotAll();
+
+ private:
+  // Upper bound on the number of distinct op names remembered per ring.
+  static constexpr size_t kMaxOpNames = 1 << 16;
+
+  const std::string allocator_name_;
+  const int64_t memory_limit_;
+
+  mutable absl::Mutex mutex_;
+  std::vector<MemoryEvent> events_ ABSL_GUARDED_BY(mutex_);
+  // Number of events recorded so far; the next one goes to
+  // events_[num_recorded_ % events_.size()].
+  uint64_t num_recorded_ ABSL_GUARDED_BY(mutex_) = 0;
+  absl::flat_hash_map<uint64_t, std::string> op_names_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace tsl
+
+#endif  // XLA_TSL_FRAMEWORK_MEMORY_EVENT_RING_H_
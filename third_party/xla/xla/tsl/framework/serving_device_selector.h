@@ -133,6 +133,12 @@ class ServingDeviceSelector {
   // Struct of all tracked device states, which will be passed to Policy.
   struct DeviceStates {
     absl::Span<const DeviceState> states;
+    // If not empty, the estimated time in nanoseconds until each device
+    // becomes idle, indexed like `states`.
+    absl::Span<const int64_t> estimated_ns_till_idle;
+    // If not empty, the free memory in bytes of each device, indexed like
+    // `states`. Negative if unknown.
+    absl::Span<const int64_t> free_memory_bytes;
   };
 
   // Policy used to select a device.
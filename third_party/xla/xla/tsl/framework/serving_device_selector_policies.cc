@@ -15,6 +15,7 @@ limitations under the License.
 #include "xla/tsl/framework/serving_device_selector_policies.h"
 
 #include <atomic>
+#include <cstdint>
 
 #include "absl/strings/string_view.h"
 #include "xla/tsl/framework/serving_device_selector.h"
@@ -28,4 +29,39 @@ int RoundRobinPolicy::SelectDevice(
   return ordinal_.fetch_add(1, std::memory_order_relaxed) % num_devices;
 }
 
+int LeastLoadedPolicy::SelectDevice(
+    absl::string_view program_fingerprint,
+    const ServingDeviceSelector::DeviceStates& device_states) {
+  const int num_devices = device_states.states.size();
+  // Starting the scan at a rotating device spreads ties over the devices.
+  const int start =
+      ordinal_.fetch_add(1, std::memory_order_relaxed) % num_devices;
+  if (device_states.estimated_ns_till_idle.size() !=
+      device_states.states.size()) {
+    return start;
+  }
+  const bool has_memory = device_states.free_memory_bytes.size() ==
+                          device_states.states.size();
+  auto short_of_memory = [&](int device) {
+    if (!has_memory) return false;
+    const int64_t free_bytes = device_states.free_memory_bytes[device];
+    return free_bytes >= 0 && free_bytes < min_free_memory_bytes_;
+  };
+
+  int best = -1;
+  bool best_short_of_memory = false;
+  for (int i = 0; i < num_devices; ++i) {
+    const int device = (start + i) % num_devices;
+    const bool device_short_of_memory = short_of_memory(device);
+    if (best < 0 || (best_short_of_memory && !device_short_of_memory) ||
+        (best_short_of_memory == device_short_of_memory &&
+         device_states.estimated_ns_till_idle[device] <
+             device_states.estimated_ns_till_idle[best])) {
+      best = device;
+      best_short_of_memory = device_short_of_memory;
+    }
+  }
+  return best;
+}
+
 }  // namespace tsl
@@ -16,6 +16,7 @@ limitations under the License.
 #define XLA_TSL_FRAMEWORK_SERVING_DEVICE_SELECTOR_POLICIES_H_
 
 #include <atomic>
+#include <cstdint>
 
 #include "xla/tsl/framework/serving_device_selector.h"
 
@@ -23,6 +24,7 @@ namespace tsl {
 
 enum class ServingDeviceSelectorPolicy {
   kRoundRobin,
+  kLeastLoaded,
 };
 
 class RoundRobinPolicy : public ServingDeviceSelector::Policy {
@@ -37,6 +39,25 @@ class RoundRobinPolicy : public ServingDeviceSelector::Policy {
   std::atomic<uint64_t> ordinal_;
 };
 
+// Selects the device that is estimated to become idle first according to
+// `DeviceStates::estimated_ns_till_idle`. Devices with less than
+// `min_free_memory_bytes` of free memory are only selected if all devices are
+// short of memory. Ties are broken round-robin. Behaves like
+// `RoundRobinPolicy` if no estimates are available.
+class LeastLoadedPolicy : public ServingDeviceSelector::Policy {
+ public:
+  explicit LeastLoadedPolicy(int64_t min_free_memory_bytes = 0)
+      : min_free_memory_bytes_(min_free_memory_bytes), ordinal_(0) {}
+
+  int SelectDevice(
+      absl::string_view program_fingerprint,
+      const ServingDeviceSelector::DeviceStates& device_states) override;
+
+ private:
+  const int64_t min_free_memory_bytes_;
+  std::atomic<uint64_t> ordinal_;
+};
+
 }  // namespace tsl
 
 #endif  // XLA_TSL_FRAMEWORK_SERVING_DEVICE_SELECTOR_POLICIES_H_
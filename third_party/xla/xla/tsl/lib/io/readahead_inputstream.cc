@@ -0,0 +1,178 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/tsl/lib/io/readahead_inputstream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <utility>
+
+#include "absl/status/status.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/logging.h"
+
+namespace tsl {
+namespace io {
+
+ReadaheadInputStream::ReadaheadInputStream(RandomAccessFile* file,
+                                           size_t chunk_bytes,
+                                           int max_reads_in_flight)
+    : file_(file),
+      chunk_bytes_(chunk_bytes),
+      max_reads_in_flight_(std::max(max_reads_in_flight, 1)) {
+  DCHECK_GT(chunk_bytes_, 0);
+}
+
+ReadaheadInputStream::~ReadaheadInputStream() {
+  mutex_lock l(mu_);
+  while (reads_in_flight_ > 0) {
+    read_done_cv_.wait(l);
+  }
+}
+
+void ReadaheadInputStream::IssueReads() {
+  while (chunks_.size() < max_reads_in_flight_ && !end_of_file_) {
+    auto chunk = std::make_unique<Chunk>();
+    chunk->offset = next_read_offset_;
+    if (free_buffers_.empty()) {
+      chunk->data.reset(new char[chunk_bytes_]);
+    } else {
+      chunk->data = std::move(free_buffers_.back());
+      free_buffers_.pop_back();
+    }
+    next_read_offset_ += chunk_bytes_;
+    Chunk* raw_chunk = chunk.get();
+    chunks_.push_back(std::move(chunk));
+    {
+      mutex_lock l(mu_);
+      ++reads_in_flight_;
+    }
+    file_->ReadAsync(
+        raw_chunk->offset, chunk_bytes_, raw_chunk->data.get(),
+        [this, raw_chunk](absl::Status status, absl::string_view result) {
+          // Read() may return data that is not in the scratch buffer.
+          if (result.data() != raw_chunk->data.get()) {
+            memmove(raw_chunk->data.get(), result.data(), result.size());
+          }
+          mutex_lock l(mu_);
+          raw_chunk->size = result.size();
+          raw_chunk->status = std::move(status);
+          raw_chunk->done = true;
+          --reads_in_flight_;
+          // Notify under the lock, since *this may be destroyed as soon as
+          // the consumer sees that no reads are in flight.
+          read_done_cv_.notify_all();
+        });
+  }
+}
+
+absl::Status ReadaheadInputStream::FrontChunk(Chunk** chunk) {
+  IssueReads();
+  DCHECK(!chunks_.empty());
+  Chunk* front = chunks_.front().get();
+  {
+    mutex_lock l(mu_);
+    while (!front->done) {
+      read_done_cv_.wait(l);
+    }
+  }
+  if (!front->status.ok()) {
+    if (!errors::IsOutOfRange(front->status)) return front->status;
+    end_of_file_ = true;
+  }
+  *chunk = front;
+  return absl::OkStatus();
+}
+
+void ReadaheadInputStream::PopFrontChunk() {
+  free_buffers_.push_back(std::move(chunks_.front()->data));
+  chunks_.pop_front();
+  front_chunk_pos_ = 0;
+}
+
+void ReadaheadInputStream::RestartAt(uint64 position) {
+  {
+    mutex_lock l(mu_);
+    while (reads_in_flight_ > 0) {
+      read_done_cv_.wait(l);
+    }
+  }
+  while (!chunks_.empty()) {
+    PopFrontChunk();
+  }
+  next_read_offset_ = position;
+  end_of_file_ = false;
+  position_ = position;
+}
+
+absl::Status ReadaheadInputStream::Consume(int64_t bytes, tstring* result) {
+  while (bytes > 0) {
+    Chunk* chunk;
+    TF_RETURN_IF_ERROR(FrontChunk(&chunk));
+    const size_t available = chunk->size - front_chunk_pos_;
+    if (available == 0) {
+      // The chunk at the end of the file is kept, so that later reads keep
+      // failing.
+      if (!chunk->status.ok()) {
+        return errors::OutOfRange("reached end of file");
+      }
+      PopFrontChunk();
+      continue;
+    }
+    const size_t n = std::min<size_t>(available, bytes);
+    if (result != nullptr) {
+      result->append(chunk->data.get() + front_chunk_pos_, n);
+    }
+    front_chunk_pos_ += n;
+    position_ += n;
+    bytes -= n;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ReadaheadInputStream::ReadNBytes(int64_t bytes_to_read,
+                                              tstring* result) {
+  if (bytes_to_read < 0) {
+    return errors::InvalidArgument("Can't read a negative number of bytes: ",
+                                   bytes_to_read);
+  }
+  result->clear();
+  result->reserve(bytes_to_read);
+  return Consume(bytes_to_read, result);
+}
+
+absl::Status ReadaheadInputStream::SkipNBytes(int64_t bytes_to_skip) {
+  if (bytes_to_skip < 0) {
+    return errors::InvalidArgument("Can't skip a negative number of bytes");
+  }
+  const uint64 target = position_ + bytes_to_skip;
+  if (bytes_to_skip == 0 || target <= next_read_offset_ || end_of_file_) {
+    // Skips within the chunks that have been read or are being read.
+    return Consume(bytes_to_skip, /*result=*/nullptr);
+  }
+  // Restarts reading at the last skipped byte, and reads it to find out
+  // whether the file is long enough.
+  RestartAt(target - 1);
+  return Consume(1, /*result=*/nullptr);
+}
+
+absl::Status ReadaheadInputStream::Reset() {
+  RestartAt(0);
+  return absl::OkStatus();
+}
+
+}  // namespace io
+}  // namespace tsl
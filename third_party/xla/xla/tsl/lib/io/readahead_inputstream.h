@@ -0,0 +1,119 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_TSL_LIB_IO_READAHEAD_INPUTSTREAM_H_
+#define XLA_TSL_LIB_IO_READAHEAD_INPUTSTREAM_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "xla/tsl/lib/io/inputstream_interface.h"
+#include "tsl/platform/file_system.h"
+#include "tsl/platform/mutex.h"
+#include "tsl/platform/thread_annotations.h"
+#include "tsl/platform/types.h"
+
+namespace tsl {
+namespace io {
+
+// Reads a file sequentially in chunks, keeping several chunk reads in flight
+// ahead of the consumer through RandomAccessFile::ReadAsync. On file systems
+// with asynchronous reads this keeps the storage busy without dedicating a
+// thread to every read; on others the reads run synchronously when they are
+// issued.
+//
+// A single instance of ReadaheadInputStream is NOT safe for concurrent use by
+// multiple threads.
+class ReadaheadInputStream : public InputStreamInterface {
+ public:
+  // Reads `file` in chunks of `chunk_bytes`, with up to `max_reads_in_flight`
+  // chunks read or buffered at a time. Does not take ownership of `file`,
+  // which must outlive *this.
+  ReadaheadInputStream(RandomAccessFile* file, size_t chunk_bytes,
+                       int max_reads_in_flight);
+
+  // Waits for the reads in flight to finish.
+  ~ReadaheadInputStream() override;
+
+  absl::Status ReadNBytes(int64_t bytes_to_read, tstring* result) override;
+
+  absl::Status SkipNBytes(int64_t bytes_to_skip) override;
+
+  int64_t Tell() const override { return position_; }
+
+  absl::Status Reset() override;
+
+ private:
+  struct Chunk {
+    uint64 offset;
+    std::unique_ptr<char[]> data;
+    // Set by the read callback under `mu_`. The consumer may access them
+    // without holding `mu_` once it has seen `done`.
+    size_t size = 0;
+    absl::Status status;
+    bool done = false;
+  };
+
+  // Starts reading chunks until `max_reads_in_flight_` chunks are buffered or
+  // the end of the file has been found.
+  void IssueReads();
+
+  // Waits for the first buffered chunk and stores it in `*chunk`. Returns the
+  // error of the chunk's read, except for OutOfRange.
+  absl::Status FrontChunk(Chunk** chunk);
+
+  // Consumes `bytes` bytes of the buffered chunks, appending them to
+  // `*result` unless it is null.
+  absl::Status Consume(int64_t bytes, tstring* result);
+
+  // Drops the first buffered chunk and recycles its buffer.
+  void PopFrontChunk();
+
+  // Waits for the reads in flight and drops all buffered chunks, so that the
+  // next read starts at `position`.
+  void RestartAt(uint64 position);
+
+  RandomAccessFile* const file_;  // Not owned.
+  const size_t chunk_bytes_;
+  const size_t max_reads_in_flight_;
+
+  // The chunks being read or not fully consumed yet, in file order.
+  std::deque<std::unique_ptr<Chunk>> chunks_;
+  // Buffers of consumed chunks, reused by the next reads.
+  std::vector<std::unique_ptr<char[]>> free_buffers_;
+  // Offset of the next chunk to read.
+  uint64 next_read_offset_ = 0;
+  // Bytes of the first chunk that have been consumed.
+  size_t front_chunk_pos_ = 0;
+  // Whether a chunk has hit the end of the file, so no more chunks are read.
+  bool end_of_file_ = false;
+  int64_t position_ = 0;
+
+  mutex mu_;
+  condition_variable read_done_cv_;
+  int reads_in_flight_ TF_GUARDED_BY(mu_) = 0;
+
+  ReadaheadInputStream(const ReadaheadInputStream&) = delete;
+  void operator=(const ReadaheadInputStream&) = delete;
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // XLA_TSL_LIB_IO_READAHEAD_INPUTSTREAM_H_
@@ -0,0 +1,177 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/tsl/lib/io/readahead_inputstream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "xla/tsl/lib/core/status_test_util.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/file_system.h"
+#include "tsl/platform/test.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+// An in-memory file. If `async` is set, every ReadAsync() completes on its
+// own thread, in no particular order.
+class StringFile : public RandomAccessFile {
+ public:
+  StringFile(std::string data, bool async)
+      : data_(std::move(data)), async_(async) {}
+
+  ~StringFile() override {
+    for (std::thread& thread : threads_) thread.join();
+  }
+
+  absl::Status Read(uint64 offset, size_t n, absl::string_view* result,
+                    char* scratch) const override {
+    if (offset >= data_.size()) {
+      *result = absl::string_view();
+      return errors::OutOfRange("eof");
+    }
+    const size_t size = std::min(n, data_.size() - offset);
+    memcpy(scratch, data_.data() + offset, size);
+    *result = absl::string_view(scratch, size);
+    return size < n ? errors::OutOfRange("eof") : absl::OkStatus();
+  }
+
+  void ReadAsync(uint64 offset, size_t n, char* scratch,
+                 ReadDoneCallback done) const override {
+    ++num_reads_;
+    if (!async_) {
+      RandomAccessFile::ReadAsync(offset, n, scratch, std::move(done));
+      return;
+    }
+    threads_.emplace_back([this, offset, n, scratch, done = std::move(done)] {
+      absl::string_view result;
+      absl::Status s = Read(offset, n, &result, scratch);
+      done(s, result);
+    });
+  }
+
+  int num_reads() const { return num_reads_; }
+
+ private:
+  const std::string data_;
+  const bool async_;
+  mutable std::vector<std::thread> threads_;
+  mutable int num_reads_ = 0;
+};
+
+std::string TestData(int size) {
+  std::string data(size, 0);
+  for (int i = 0; i < size; ++i) {
+    data[i] = 'a' + i % 23;
+  }
+  return data;
+}
+
+class ReadaheadInputStreamTest : public ::testing::TestWithParam<bool> {};
+
+TEST_P(ReadaheadInputStreamTest, ReadsWholeFile) {
+  for (int file_size : {0, 1, 10, 1000}) {
+    for (int chunk_size : {1, 7, 10, 1000, 4096}) {
+      for (int reads_in_flight : {1, 3}) {
+        const std::string data = TestData(file_size);
+        StringFile file(data, GetParam());
+        ReadaheadInputStream in(&file, chunk_size, reads_in_flight);
+        std::string contents;
+        tstring read;
+        for (int i = 0; i < file_size; i += 3) {
+          TF_ASSERT_OK(in.ReadNBytes(std::min(3, file_size - i), &read));
+          contents.append(read);
+          EXPECT_EQ(in.Tell(), contents.size());
+        }
+        EXPECT_EQ(contents, data);
+        EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &read)));
+        EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &read)));
+      }
+    }
+  }
+}
+
+TEST_P(ReadaheadInputStreamTest, PartialReadAtEndOfFile) {
+  StringFile file(TestData(10), GetParam());
+  ReadaheadInputStream in(&file, 4, 2);
+  tstring read;
+  TF_ASSERT_OK(in.ReadNBytes(7, &read));
+  EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(5, &read)));
+  EXPECT_EQ(read, TestData(10).substr(7));
+  EXPECT_EQ(in.Tell(), 10);
+}
+
+TEST_P(ReadaheadInputStreamTest, KeepsReadsInFlight) {
+  StringFile file(TestData(100), GetParam());
+  ReadaheadInputStream in(&file, 10, 4);
+  tstring read;
+  TF_ASSERT_OK(in.ReadNBytes(1, &read));
+  EXPECT_EQ(file.num_reads(), 4);
+  TF_ASSERT_OK(in.ReadNBytes(10, &read));
+  EXPECT_EQ(file.num_reads(), 5);
+}
+
+TEST_P(ReadaheadInputStreamTest, SkipNBytes) {
+  const std::string data = TestData(1000);
+  StringFile file(data, GetParam());
+  ReadaheadInputStream in(&file, 10, 2);
+  tstring read;
+  // Within the chunks being read.
+  TF_ASSERT_OK(in.SkipNBytes(5));
+  TF_ASSERT_OK(in.ReadNBytes(5, &read));
+  EXPECT_EQ(read, data.substr(5, 5));
+  // Past the chunks being read.
+  TF_ASSERT_OK(in.SkipNBytes(500));
+  EXPECT_EQ(in.Tell(), 510);
+  TF_ASSERT_OK(in.ReadNBytes(5, &read));
+  EXPECT_EQ(read, data.substr(510, 5));
+  // To the end of the file.
+  TF_ASSERT_OK(in.SkipNBytes(485));
+  EXPECT_EQ(in.Tell(), 1000);
+  EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &read)));
+}
+
+TEST_P(ReadaheadInputStreamTest, SkipPastEndOfFile) {
+  StringFile file(TestData(100), GetParam());
+  ReadaheadInputStream in(&file, 10, 2);
+  EXPECT_TRUE(errors::IsOutOfRange(in.SkipNBytes(101)));
+}
+
+TEST_P(ReadaheadInputStreamTest, Reset) {
+  const std::string data = TestData(100);
+  StringFile file(data, GetParam());
+  ReadaheadInputStream in(&file, 10, 2);
+  tstring read;
+  TF_ASSERT_OK(in.ReadNBytes(35, &read));
+  TF_ASSERT_OK(in.Reset());
+  EXPECT_EQ(in.Tell(), 0);
+  TF_ASSERT_OK(in.ReadNBytes(100, &read));
+  EXPECT_EQ(read, data);
+}
+
+INSTANTIATE_TEST_SUITE_P(SyncAndAsync, ReadaheadInputStreamTest,
+                         ::testing::Bool());
+
+}  // namespace
+}  // namespace io
+}  // namespace tsl
@@ -26,6 +26,11 @@ limitations under the License.
 #include "xla/tsl/lib/io/zlib_inputstream.h"
 #endif  // IS_SLIM_BUILD
 #include "tsl/platform/macros.h"
+#include "tsl/platform/platform.h"
+#if !defined(IS_SLIM_BUILD) && !defined(IS_MOBILE_PLATFORM)
+#include "xla/tsl/lib/io/zstd/zstd_compression_options.h"
+#include "xla/tsl/lib/io/zstd/zstd_inputstream.h"
+#endif  // !IS_SLIM_BUILD && !IS_MOBILE_PLATFORM
 #include "tsl/platform/types.h"
 
 namespace tsl {
@@ -37,7 +42,8 @@ struct RecordReaderOptions {
   enum CompressionType {
     NONE = 0,
     ZLIB_COMPRESSION = 1,
-    SNAPPY_COMPRESSION = 2
+    SNAPPY_COMPRESSION = 2,
+    ZSTD_COMPRESSION = 3
   };
   CompressionType compression_type = NONE;
 
@@ -46,6 +52,11 @@ struct RecordReaderOptions {
   // compressed files.) Consider using SequentialRecordReader.
   int64_t buffer_size = 0;
 
+  // If non-zero and buffer_size is non-zero, the file is read through
+  // RandomAccessFile::ReadAsync in buffer_size chunks with up to this many
+  // chunks in flight, overlapping storage latency with record parsing.
+  int max_reads_in_flight = 0;
+
   static RecordReaderOptions CreateRecordReaderOptions(
       const string& compression_type);
 
@@ -54,6 +65,9 @@ struct RecordReaderOptions {
   ZlibCompressionOptions zlib_options;
   SnappyCompressionOptions snappy_options;
 #endif  // IS_SLIM_BUILD
+#if !defined(IS_SLIM_BUILD) && !defined(IS_MOBILE_PLATFORM)
+  ZstdCompressionOptions zstd_options;
+#endif  // !IS_SLIM_BUILD && !IS_MOBILE_PLATFORM
 };
 
 // Low-level interface to read TFRecord files.
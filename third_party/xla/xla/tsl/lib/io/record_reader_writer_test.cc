@@ -30,6 +30,7 @@ limitations under the License.
 #include "tsl/platform/status.h"
 #include "tsl/platform/strcat.h"
 #include "tsl/platform/test.h"
+#include "tsl/platform/test_benchmark.h"
 
 namespace tsl {
 
@@ -45,6 +46,9 @@ io::RecordReaderOptions GetMatchingReaderOptions(
   if (options.compression_type == io::RecordWriterOptions::ZLIB_COMPRESSION) {
     return io::RecordReaderOptions::CreateRecordReaderOptions("ZLIB");
   }
+  if (options.compression_type == io::RecordWriterOptions::ZSTD_COMPRESSION) {
+    return io::RecordReaderOptions::CreateRecordReaderOptions("ZSTD");
+  }
   return io::RecordReaderOptions::CreateRecordReaderOptions("");
 }
 
@@ -121,6 +125,12 @@ TEST(RecordReaderWriterTest, TestZlibSyncFlush) {
   VerifyFlush(options);
 }
 
+TEST(RecordReaderWriterTest, TestZstdFlush) {
+  io::RecordWriterOptions options;
+  options.compression_type = io::RecordWriterOptions::ZSTD_COMPRESSION;
+  VerifyFlush(options);
+}
+
 TEST(RecordReaderWriterTest, TestBasics) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_test";
@@ -343,6 +353,50 @@ TEST(RecordReaderWriterTest, TestZlib) {
   }
 }
 
+TEST(RecordReaderWriterTest, TestZstd) {
+  Env* env = Env::Default();
+  string fname = testing::TmpDir() + "/record_reader_writer_zstd_test";
+
+  for (auto buf_size : BufferSizes()) {
+    {
+      std::unique_ptr<WritableFile> file;
+      TF_CHECK_OK(env->NewWritableFile(fname, &file));
+
+      io::RecordWriterOptions options =
+          io::RecordWriterOptions::CreateRecordWriterOptions("ZSTD");
+      EXPECT_EQ(options.compression_type,
+                io::RecordWriterOptions::ZSTD_COMPRESSION);
+      options.zstd_options.input_buffer_size = buf_size;
+      options.zstd_options.output_buffer_size = buf_size;
+      io::RecordWriter writer(file.get(), options);
+      TF_EXPECT_OK(writer.WriteRecord("abc"));
+      TF_EXPECT_OK(writer.WriteRecord("defg"));
+      TF_CHECK_OK(writer.Flush());
+    }
+
+    {
+      std::unique_ptr<RandomAccessFile> read_file;
+      // Read it back with the RecordReader.
+      TF_CHECK_OK(env->NewRandomAccessFile(fname, &read_file));
+      io::RecordReaderOptions options =
+          io::RecordReaderOptions::CreateRecordReaderOptions("ZSTD");
+      EXPECT_EQ(options.compression_type,
+                io::RecordReaderOptions::ZSTD_COMPRESSION);
+      options.zstd_options.input_buffer_size = buf_size;
+      options.zstd_options.output_buffer_size = buf_size;
+      io::RecordReader reader(read_file.get(), options);
+      uint64 offset = 0;
+      tstring record;
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      EXPECT_EQ("abc", record);
+      TF_CHECK_OK(reader.ReadRecord(&offset, &record));
+      EXPECT_EQ("defg", record);
+      CHECK_EQ(reader.ReadRecord(&offset, &record).code(),
+               error::OUT_OF_RANGE);
+    }
+  }
+}
+
 TEST(RecordReaderWriterTest, TestUseAfterClose) {
   Env* env = Env::Default();
   string fname = testing::TmpDir() + "/record_reader_writer_flush_close_test";
@@ -366,4 +420,62 @@ TEST(RecordReaderWriterTest, TestUseAfterClose) {
   }
 }
 
+// Writes and reads back 64MiB of records of size `state.range(1)` with the
+// compression type `state.range(0)`, one of "", "ZLIB", "SNAPPY" and "ZSTD".
+void BM_WriteAndReadRecords(::testing::benchmark::State& state) {
+  static const char* const kCompressionTypes[] = {"", "ZLIB", "SNAPPY",
+                                                  "ZSTD"};
+  const string compression_type = kCompressionTypes[state.range(0)];
+  const int record_size = state.range(1);
+  const int num_records = (64 << 20) / record_size;
+  Env* env = Env::Default();
+  string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+
+  // Records are compressible but not trivially so, like most real data.
+  string record(record_size, 0);
+  for (int i = 0; i < record_size; ++i) {
+    record[i] = "0123456789abcdef"[(i * 7 + i / 64) % 16];
+  }
+
+  for (auto s : state) {
+    {
+      std::unique_ptr<WritableFile> file;
+      TF_ASSERT_OK(env->NewWritableFile(fname, &file));
+      io::RecordWriter writer(
+          file.get(),
+          io::RecordWriterOptions::CreateRecordWriterOptions(compression_type));
+      for (int i = 0; i < num_records; ++i) {
+        TF_ASSERT_OK(writer.WriteRecord(record));
+      }
+      TF_ASSERT_OK(writer.Close());
+      TF_ASSERT_OK(file->Close());
+    }
+    {
+      std::unique_ptr<RandomAccessFile> file;
+      TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file));
+      io::SequentialRecordReader reader(
+          file.get(),
+          io::RecordReaderOptions::CreateRecordReaderOptions(compression_type));
+      tstring result;
+      for (int i = 0; i < num_records; ++i) {
+        TF_ASSERT_OK(reader.ReadRecord(&result));
+      }
+    }
+  }
+  state.SetLabel(compression_type.empty() ? "NONE" : compression_type);
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          num_records * record_size * 2);
+  TF_ASSERT_OK(env->DeleteFile(fname));
+}
+BENCHMARK(BM_WriteAndReadRecords)
+    ->ArgPair(0, 100)
+    ->ArgPair(1, 100)
+    ->ArgPair(2, 100)
+    ->ArgPair(3, 100)
+    ->ArgPair(0, 64 << 10)
+    ->ArgPair(1, 64 << 10)
+    ->ArgPair(2, 64 << 10)
+    ->ArgPair(3, 64 << 10);
+
 }  // namespace tsl
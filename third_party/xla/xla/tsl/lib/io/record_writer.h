@@ -28,7 +28,12 @@ limitations under the License.
 #endif  // IS_SLIM_BUILD
 #include "tsl/platform/cord.h"
 #include "tsl/platform/macros.h"
+#include "tsl/platform/platform.h"
 #include "tsl/platform/types.h"
+#if !defined(IS_SLIM_BUILD) && !defined(IS_MOBILE_PLATFORM)
+#include "xla/tsl/lib/io/zstd/zstd_compression_options.h"
+#include "xla/tsl/lib/io/zstd/zstd_outputbuffer.h"
+#endif  // !IS_SLIM_BUILD && !IS_MOBILE_PLATFORM
 
 namespace tsl {
 
@@ -41,7 +46,8 @@ struct RecordWriterOptions {
   enum CompressionType {
     NONE = 0,
     ZLIB_COMPRESSION = 1,
-    SNAPPY_COMPRESSION = 2
+    SNAPPY_COMPRESSION = 2,
+    ZSTD_COMPRESSION = 3
   };
   CompressionType compression_type = NONE;
 
@@ -53,6 +59,9 @@ struct RecordWriterOptions {
   io::ZlibCompressionOptions zlib_options;
   io::SnappyCompressionOptions snappy_options;
 #endif  // IS_SLIM_BUILD
+#if !defined(IS_SLIM_BUILD) && !defined(IS_MOBILE_PLATFORM)
+  io::ZstdCompressionOptions zstd_options;
+#endif  // !IS_SLIM_BUILD && !IS_MOBILE_PLATFORM
 };
 
 class RecordWriter {
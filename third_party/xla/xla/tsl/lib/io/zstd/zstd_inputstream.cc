@@ -0,0 +1,140 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/tsl/lib/io/zstd/zstd_inputstream.h"
+
+#include <algorithm>
+
+#include <zstd.h>
+
+#include "tsl/platform/errors.h"
+#include "tsl/platform/logging.h"
+#include "tsl/platform/strcat.h"
+
+namespace tsl {
+namespace io {
+
+ZstdInputStream::ZstdInputStream(InputStreamInterface* input_stream,
+                                 size_t input_buffer_bytes,
+                                 size_t output_buffer_bytes,
+                                 bool owns_input_stream)
+    : input_stream_(input_stream),
+      input_buffer_capacity_(input_buffer_bytes),
+      output_buffer_capacity_(output_buffer_bytes),
+      owns_input_stream_(owns_input_stream),
+      context_(ZSTD_createDCtx()),
+      output_buffer_(new char[output_buffer_bytes]) {
+  CHECK(context_ != nullptr) << "Failed to create zstd decompression context";
+}
+
+ZstdInputStream::ZstdInputStream(InputStreamInterface* input_stream,
+                                 size_t input_buffer_bytes,
+                                 size_t output_buffer_bytes)
+    : ZstdInputStream(input_stream, input_buffer_bytes, output_buffer_bytes,
+                      false) {}
+
+ZstdInputStream::~ZstdInputStream() {
+  ZSTD_freeDCtx(context_);
+  if (owns_input_stream_) {
+    delete input_stream_;
+  }
+}
+
+absl::Status ZstdInputStream::Reset() {
+  TF_RETURN_IF_ERROR(input_stream_->Reset());
+  ZSTD_DCtx_reset(context_, ZSTD_reset_session_only);
+  input_buffer_.clear();
+  input_pos_ = 0;
+  output_pos_ = 0;
+  output_size_ = 0;
+  output_buffer_filled_ = false;
+  bytes_read_ = 0;
+  return absl::OkStatus();
+}
+
+absl::Status ZstdInputStream::ReadFromStream() {
+  DCHECK_EQ(input_pos_, input_buffer_.size());
+  input_pos_ = 0;
+  absl::Status s =
+      input_stream_->ReadNBytes(input_buffer_capacity_, &input_buffer_);
+  // OutOfRange only signals the end of the compressed stream when nothing at
+  // all could be read.
+  if (errors::IsOutOfRange(s) && !input_buffer_.empty()) {
+    return absl::OkStatus();
+  }
+  return s;
+}
+
+absl::Status ZstdInputStream::Decompress() {
+  DCHECK_EQ(output_pos_, output_size_);
+  ZSTD_inBuffer input = {input_buffer_.data(), input_buffer_.size(),
+                         input_pos_};
+  ZSTD_outBuffer output = {output_buffer_.get(), output_buffer_capacity_, 0};
+  const size_t ret = ZSTD_decompressStream(context_, &output, &input);
+  if (ZSTD_isError(ret)) {
+    return errors::DataLoss("ZSTD_decompressStream() failed: ",
+                            ZSTD_getErrorName(ret));
+  }
+  input_pos_ = input.pos;
+  output_pos_ = 0;
+  output_size_ = output.pos;
+  output_buffer_filled_ = output.pos == output.size;
+  return absl::OkStatus();
+}
+
+size_t ZstdInputStream::ReadBytesFromCache(size_t bytes_to_read,
+                                           tstring* result) {
+  size_t can_read_bytes = std::min(bytes_to_read, output_size_ - output_pos_);
+  result->append(output_buffer_.get() + output_pos_, can_read_bytes);
+  output_pos_ += can_read_bytes;
+  bytes_read_ += can_read_bytes;
+  return can_read_bytes;
+}
+
+absl::Status ZstdInputStream::ReadNBytes(int64_t bytes_to_read,
+                                         tstring* result) {
+  result->clear();
+  result->reserve(bytes_to_read);
+  // Read as many bytes as possible from cache.
+  bytes_to_read -= ReadBytesFromCache(bytes_to_read, result);
+
+  while (bytes_to_read > 0) {
+    // At this point we can be sure that cache has been emptied. Unless zstd
+    // may still be holding decompressed data back, it needs more input.
+    if (input_pos_ == input_buffer_.size() && !output_buffer_filled_) {
+      TF_RETURN_IF_ERROR(ReadFromStream());
+    }
+    TF_RETURN_IF_ERROR(Decompress());
+    bytes_to_read -= ReadBytesFromCache(bytes_to_read, result);
+  }
+
+  return absl::OkStatus();
+}
+
+#if defined(TF_CORD_SUPPORT)
+absl::Status ZstdInputStream::ReadNBytes(int64_t bytes_to_read,
+                                         absl::Cord* result) {
+  tstring buf;
+  TF_RETURN_IF_ERROR(ReadNBytes(bytes_to_read, &buf));
+  result->Clear();
+  result->Append(buf.data());
+  return absl::OkStatus();
+}
+#endif
+
+int64_t ZstdInputStream::Tell() const { return bytes_read_; }
+
+}  // namespace io
+}  // namespace tsl
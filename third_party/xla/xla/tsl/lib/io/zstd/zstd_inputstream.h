@@ -0,0 +1,118 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_TSL_LIB_IO_ZSTD_ZSTD_INPUTSTREAM_H_
+#define XLA_TSL_LIB_IO_ZSTD_ZSTD_INPUTSTREAM_H_
+
+#include <memory>
+
+#include "xla/tsl/lib/io/inputstream_interface.h"
+#include "xla/tsl/lib/io/zstd/zstd_compression_options.h"
+
+// Forward declare the zstd decompression context, which is only used in the
+// .cc file.
+struct ZSTD_DCtx_s;
+
+namespace tsl {
+namespace io {
+
+// A ZstdInputStream provides support for reading from a stream compressed
+// using zstd (https://facebook.github.io/zstd/). Buffers the contents of the
+// file.
+//
+// A given instance of a ZstdInputStream is NOT safe for concurrent use by
+// multiple threads.
+class ZstdInputStream : public InputStreamInterface {
+ public:
+  // Creates a ZstdInputStream for `input_stream` with a buffer of size
+  // `input_buffer_bytes` bytes for reading contents from `input_stream` and
+  // another buffer with size `output_buffer_bytes` for caching decompressed
+  // contents.
+  //
+  // Takes ownership of `input_stream` iff `owns_input_stream` is true.
+  ZstdInputStream(InputStreamInterface* input_stream, size_t input_buffer_bytes,
+                  size_t output_buffer_bytes, bool owns_input_stream);
+
+  // Equivalent to the previous constructor with owns_input_stream = false.
+  ZstdInputStream(InputStreamInterface* input_stream, size_t input_buffer_bytes,
+                  size_t output_buffer_bytes);
+
+  ~ZstdInputStream() override;
+
+  // Reads bytes_to_read bytes into *result, overwriting *result.
+  //
+  // Return Status codes:
+  // OK:           If successful.
+  // OUT_OF_RANGE: If there are not enough bytes to read before
+  //               the end of the stream.
+  // DATA_LOSS:    If decompression fails.
+  // others:       If reading from stream failed.
+  absl::Status ReadNBytes(int64_t bytes_to_read, tstring* result) override;
+
+#if defined(TF_CORD_SUPPORT)
+  absl::Status ReadNBytes(int64_t bytes_to_read, absl::Cord* result) override;
+#endif
+
+  int64_t Tell() const override;
+
+  absl::Status Reset() override;
+
+ private:
+  // Reads the next chunk of compressed data from `input_stream_` into
+  // `input_buffer_`, which must have been fully consumed.
+  //
+  // Returns OutOfRange error if NO data could be read from stream.
+  absl::Status ReadFromStream();
+
+  // Decompresses as much of `input_buffer_` as fits into `output_buffer_`,
+  // which must have been fully read.
+  absl::Status Decompress();
+
+  // Attempts to read `bytes_to_read` from the decompressed data cache. Returns
+  // the actual number of bytes read.
+  size_t ReadBytesFromCache(size_t bytes_to_read, tstring* result);
+
+  InputStreamInterface* input_stream_;
+  const size_t input_buffer_capacity_;
+  const size_t output_buffer_capacity_;
+  const bool owns_input_stream_;
+
+  ZSTD_DCtx_s* context_;
+
+  // Compressed data read from `input_stream_`: everything from `input_pos_`
+  // on has not been decompressed yet.
+  tstring input_buffer_;
+  size_t input_pos_ = 0;
+
+  // Decompressed data: [output_pos_, output_size_) has not been read yet.
+  std::unique_ptr<char[]> output_buffer_;
+  size_t output_pos_ = 0;
+  size_t output_size_ = 0;
+
+  // Whether the last call to Decompress() filled `output_buffer_`, in which
+  // case zstd may hold more decompressed data without needing more input.
+  bool output_buffer_filled_ = false;
+
+  // Number of *uncompressed* bytes that have been read from this stream.
+  int64_t bytes_read_ = 0;
+
+  ZstdInputStream(const ZstdInputStream&) = delete;
+  void operator=(const ZstdInputStream&) = delete;
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // XLA_TSL_LIB_IO_ZSTD_ZSTD_INPUTSTREAM_H_
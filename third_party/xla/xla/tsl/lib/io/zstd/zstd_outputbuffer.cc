@@ -0,0 +1,173 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "xla/tsl/lib/io/zstd/zstd_outputbuffer.h"
+
+#include <cstring>
+
+#include <zstd.h>
+
+#include "tsl/platform/errors.h"
+#include "tsl/platform/logging.h"
+
+namespace tsl {
+namespace io {
+
+ZstdOutputBuffer::ZstdOutputBuffer(WritableFile* file,
+                                   int32_t input_buffer_bytes,
+                                   int32_t output_buffer_bytes,
+                                   const ZstdCompressionOptions& zstd_options)
+    : file_(file),
+      input_buffer_capacity_(input_buffer_bytes),
+      output_buffer_capacity_(output_buffer_bytes),
+      zstd_options_(zstd_options),
+      input_buffer_(new char[input_buffer_bytes]),
+      output_buffer_(new char[output_buffer_bytes]) {}
+
+ZstdOutputBuffer::~ZstdOutputBuffer() {
+  if (context_ != nullptr) {
+    LOG(WARNING) << "ZstdOutputBuffer::Close() not called. Possible data loss";
+    ZSTD_freeCCtx(context_);
+  }
+}
+
+absl::Status ZstdOutputBuffer::Init() {
+  context_ = ZSTD_createCCtx();
+  if (context_ == nullptr) {
+    return errors::Internal("Failed to create zstd compression context");
+  }
+  const size_t ret = ZSTD_CCtx_setParameter(context_, ZSTD_c_compressionLevel,
+                                            zstd_options_.compression_level);
+  if (ZSTD_isError(ret)) {
+    return errors::InvalidArgument("Invalid zstd compression level ",
+                                   zstd_options_.compression_level, ": ",
+                                   ZSTD_getErrorName(ret));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ZstdOutputBuffer::CheckOpen() const {
+  if (context_ == nullptr) {
+    return errors::FailedPrecondition("ZstdOutputBuffer is closed");
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ZstdOutputBuffer::Append(absl::string_view data) {
+  TF_RETURN_IF_ERROR(CheckOpen());
+  // If there is sufficient free space in `input_buffer_` to fit `data`, only
+  // copy it there. Otherwise compress what is buffered and, if `data` would
+  // not fit even into an empty buffer, pass it to zstd directly to avoid the
+  // copy.
+  if (data.size() <= input_buffer_capacity_ - input_size_) {
+    memcpy(input_buffer_.get() + input_size_, data.data(), data.size());
+    input_size_ += data.size();
+    return absl::OkStatus();
+  }
+  TF_RETURN_IF_ERROR(CompressInputBuffer(EndDirective::kContinue));
+  if (data.size() > input_buffer_capacity_) {
+    return Compress(data, EndDirective::kContinue);
+  }
+  memcpy(input_buffer_.get(), data.data(), data.size());
+  input_size_ = data.size();
+  return absl::OkStatus();
+}
+
+#if defined(TF_CORD_SUPPORT)
+absl::Status ZstdOutputBuffer::Append(const absl::Cord& cord) {
+  for (absl::string_view fragment : cord.Chunks()) {
+    TF_RETURN_IF_ERROR(Append(fragment));
+  }
+  return absl::OkStatus();
+}
+#endif
+
+absl::Status ZstdOutputBuffer::Flush() {
+  TF_RETURN_IF_ERROR(CheckOpen());
+  TF_RETURN_IF_ERROR(CompressInputBuffer(EndDirective::kFlush));
+  TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
+  return file_->Flush();
+}
+
+absl::Status ZstdOutputBuffer::Name(absl::string_view* result) const {
+  return file_->Name(result);
+}
+
+absl::Status ZstdOutputBuffer::Sync() {
+  TF_RETURN_IF_ERROR(Flush());
+  return file_->Sync();
+}
+
+absl::Status ZstdOutputBuffer::Close() {
+  if (context_ != nullptr) {
+    TF_RETURN_IF_ERROR(CompressInputBuffer(EndDirective::kEnd));
+    TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
+    ZSTD_freeCCtx(context_);
+    context_ = nullptr;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ZstdOutputBuffer::Tell(int64_t* position) {
+  return file_->Tell(position);
+}
+
+absl::Status ZstdOutputBuffer::CompressInputBuffer(EndDirective directive) {
+  TF_RETURN_IF_ERROR(Compress(
+      absl::string_view(input_buffer_.get(), input_size_), directive));
+  input_size_ = 0;
+  return absl::OkStatus();
+}
+
+absl::Status ZstdOutputBuffer::Compress(absl::string_view data,
+                                        EndDirective directive) {
+  ZSTD_inBuffer input = {data.data(), data.size(), 0};
+  static_assert(static_cast<int>(EndDirective::kContinue) == ZSTD_e_continue);
+  static_assert(static_cast<int>(EndDirective::kFlush) == ZSTD_e_flush);
+  static_assert(static_cast<int>(EndDirective::kEnd) == ZSTD_e_end);
+  const auto mode = static_cast<ZSTD_EndDirective>(directive);
+  while (true) {
+    ZSTD_outBuffer output = {output_buffer_.get(), output_buffer_capacity_,
+                             output_size_};
+    const size_t remaining =
+        ZSTD_compressStream2(context_, &output, &input, mode);
+    if (ZSTD_isError(remaining)) {
+      return errors::DataLoss("ZSTD_compressStream2() failed: ",
+                              ZSTD_getErrorName(remaining));
+    }
+    output_size_ = output.pos;
+    if (output_size_ == output_buffer_capacity_) {
+      TF_RETURN_IF_ERROR(FlushOutputBufferToFile());
+    }
+    // With ZSTD_e_continue zstd may keep data in its own buffers; flushing
+    // and ending are only complete once it reports nothing remaining.
+    const bool done = mode == ZSTD_e_continue ? input.pos == input.size
+                                              : remaining == 0;
+    if (done) break;
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ZstdOutputBuffer::FlushOutputBufferToFile() {
+  if (output_size_ > 0) {
+    TF_RETURN_IF_ERROR(
+        file_->Append(absl::string_view(output_buffer_.get(), output_size_)));
+    output_size_ = 0;
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace io
+}  // namespace tsl
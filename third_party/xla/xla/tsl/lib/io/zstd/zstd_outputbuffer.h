@@ -0,0 +1,129 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef XLA_TSL_LIB_IO_ZSTD_ZSTD_OUTPUTBUFFER_H_
+#define XLA_TSL_LIB_IO_ZSTD_ZSTD_OUTPUTBUFFER_H_
+
+#include <memory>
+#include <string>
+
+#include "xla/tsl/lib/io/zstd/zstd_compression_options.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/file_system.h"
+#include "tsl/platform/status.h"
+#include "tsl/platform/stringpiece.h"
+#include "tsl/platform/types.h"
+
+// Forward declare the zstd compression context, which is only used in the .cc
+// file.
+struct ZSTD_CCtx_s;
+
+namespace tsl {
+namespace io {
+
+// Provides support for writing compressed output to file using zstd
+// (https://facebook.github.io/zstd/).
+//
+// A given instance of a ZstdOutputBuffer is NOT safe for concurrent use by
+// multiple threads.
+class ZstdOutputBuffer : public WritableFile {
+ public:
+  // Creates a ZstdOutputBuffer for `file` with two buffers that cache the
+  // 1. input data to be compressed
+  // 2. the compressed output
+  // with sizes `input_buffer_bytes` and `output_buffer_bytes` respectively.
+  // Does not take ownership of `file`.
+  ZstdOutputBuffer(WritableFile* file, int32_t input_buffer_bytes,
+                   int32_t output_buffer_bytes,
+                   const ZstdCompressionOptions& zstd_options);
+
+  ~ZstdOutputBuffer() override;
+
+  // Initializes some state necessary for the output buffer. This call is
+  // required before any other operation on the buffer.
+  absl::Status Init();
+
+  // Adds `data` to the compression pipeline.
+  //
+  // The input data is buffered and is compressed in bulk when the buffer gets
+  // full. The compressed output is buffered as well and gets written to file
+  // when the buffer is full.
+  //
+  // To immediately write contents to file call `Flush()`.
+  absl::Status Append(absl::string_view data) override;
+
+#if defined(TF_CORD_SUPPORT)
+  absl::Status Append(const absl::Cord& cord) override;
+#endif
+
+  // Compresses any cached input and writes all output to file.
+  absl::Status Flush() override;
+
+  // Compresses any cached input, ends the zstd frame and writes all output to
+  // file. This must be called before the destructor to avoid any data loss.
+  //
+  // After calling this, any further calls to `Append()` or `Flush()` will
+  // fail.
+  absl::Status Close() override;
+
+  // Returns the name of the underlying file.
+  absl::Status Name(absl::string_view* result) const override;
+
+  // Compresses any cached input, writes all output to file and syncs it.
+  absl::Status Sync() override;
+
+  // Returns the write position in the underlying file. The position does not
+  // reflect buffered, un-flushed data.
+  absl::Status Tell(int64_t* position) override;
+
+ private:
+  // The end directive passed to zstd. The values match ZSTD_EndDirective.
+  enum class EndDirective { kContinue = 0, kFlush = 1, kEnd = 2 };
+
+  // Compresses all of `data` into `output_buffer_`. The contents of
+  // `output_buffer_` are written to file whenever it is full.
+  absl::Status Compress(absl::string_view data, EndDirective directive);
+
+  // Compresses the contents of `input_buffer_` and empties it.
+  absl::Status CompressInputBuffer(EndDirective directive);
+
+  // Appends the contents of `output_buffer_` to `file_`.
+  absl::Status FlushOutputBufferToFile();
+
+  absl::Status CheckOpen() const;
+
+  WritableFile* file_;  // Not owned
+  const size_t input_buffer_capacity_;
+  const size_t output_buffer_capacity_;
+  ZstdCompressionOptions const zstd_options_;
+
+  ZSTD_CCtx_s* context_ = nullptr;
+
+  // Input data that has not been passed to zstd yet.
+  std::unique_ptr<char[]> input_buffer_;
+  size_t input_size_ = 0;
+
+  // Compressed data that has not been written to file yet.
+  std::unique_ptr<char[]> output_buffer_;
+  size_t output_size_ = 0;
+
+  ZstdOutputBuffer(const ZstdOutputBuffer&) = delete;
+  void operator=(const ZstdOutputBuffer&) = delete;
+};
+
+}  // namespace io
+}  // namespace tsl
+
+#endif  // XLA_TSL_LIB_IO_ZSTD_ZSTD_OUTPUTBUFFER_H_
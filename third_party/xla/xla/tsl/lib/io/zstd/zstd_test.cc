@@ -0,0 +1,171 @@
+/* Copyright 2024 The TensorFlow Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "xla/tsl/lib/core/status_test_util.h"
+#include "xla/tsl/lib/io/random_inputstream.h"
+#include "xla/tsl/lib/io/zstd/zstd_compression_options.h"
+#include "xla/tsl/lib/io/zstd/zstd_inputstream.h"
+#include "xla/tsl/lib/io/zstd/zstd_outputbuffer.h"
+#include "tsl/platform/env.h"
+#include "tsl/platform/errors.h"
+#include "tsl/platform/strcat.h"
+#include "tsl/platform/test.h"
+
+namespace tsl {
+namespace io {
+namespace {
+
+std::vector<int> BufferSizes() { return {10, 100, 1000, 256 << 10}; }
+
+std::string GetRecord() {
+  static const char* const lorem_ipsum =
+      "Lorem ipsum dolor sit amet, consectetur adipiscing elit."
+      " Fusce vehicula tincidunt libero sit amet ultrices. Vestibulum non "
+      "felis augue. Duis vitae augue id lectus lacinia congue et ut purus. "
+      "Donec auctor, nisl at dapibus volutpat, diam ante lacinia dolor, vel"
+      "dignissim lacus nisi sed purus. Duis fringilla nunc ac lacus sagittis"
+      " efficitur. Praesent tincidunt egestas eros, eu vehicula urna ultrices"
+      " et. Aliquam erat volutpat.";
+  return lorem_ipsum;
+}
+
+std::string GenTestString(int copies) {
+  std::string result;
+  for (int i = 0; i < copies; ++i) {
+    strings::StrAppend(&result, GetRecord(), i);
+  }
+  return result;
+}
+
+void WriteCompressed(const std::string& fname,
+                     const std::vector<std::string>& chunks,
+                     int input_buf_size, int output_buf_size,
+                     bool with_flush) {
+  Env* env = Env::Default();
+  std::unique_ptr<WritableFile> file_writer;
+  TF_ASSERT_OK(env->NewWritableFile(fname, &file_writer));
+  ZstdOutputBuffer out(file_writer.get(), input_buf_size, output_buf_size,
+                       ZstdCompressionOptions());
+  TF_ASSERT_OK(out.Init());
+  for (const std::string& chunk : chunks) {
+    TF_ASSERT_OK(out.Append(chunk));
+    if (with_flush) {
+      TF_ASSERT_OK(out.Flush());
+    }
+  }
+  TF_ASSERT_OK(out.Close());
+  TF_ASSERT_OK(file_writer->Close());
+}
+
+void TestRoundTrip(const std::vector<std::string>& chunks, bool with_flush) {
+  Env* env = Env::Default();
+  std::string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  std::string expected;
+  for (const std::string& chunk : chunks) expected += chunk;
+
+  for (int input_buf_size : BufferSizes()) {
+    for (int output_buf_size : BufferSizes()) {
+      WriteCompressed(fname, chunks, input_buf_size, output_buf_size,
+                      with_flush);
+
+      std::unique_ptr<RandomAccessFile> file_reader;
+      TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+      RandomAccessInputStream input_stream(file_reader.get());
+      ZstdInputStream in(&input_stream, input_buf_size, output_buf_size);
+      tstring result;
+      TF_ASSERT_OK(in.ReadNBytes(expected.size(), &result));
+      EXPECT_EQ(result, expected);
+      EXPECT_EQ(in.Tell(), static_cast<int64_t>(expected.size()));
+      // Nothing is left after the end of the data.
+      EXPECT_TRUE(errors::IsOutOfRange(in.ReadNBytes(1, &result)));
+    }
+  }
+}
+
+TEST(ZstdBuffers, SingleWrite) { TestRoundTrip({GenTestString(500)}, false); }
+
+TEST(ZstdBuffers, MultipleWrites) {
+  std::vector<std::string> chunks;
+  for (int i = 0; i < 20; ++i) chunks.push_back(GenTestString(i));
+  TestRoundTrip(chunks, false);
+}
+
+TEST(ZstdBuffers, MultipleWritesWithFlush) {
+  std::vector<std::string> chunks;
+  for (int i = 0; i < 20; ++i) chunks.push_back(GenTestString(i));
+  TestRoundTrip(chunks, true);
+}
+
+TEST(ZstdBuffers, Empty) { TestRoundTrip({}, false); }
+
+TEST(ZstdBuffers, Tell) {
+  Env* env = Env::Default();
+  std::string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  const std::string data = GenTestString(50);
+  WriteCompressed(fname, {data}, 100, 100, false);
+
+  std::unique_ptr<RandomAccessFile> file_reader;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+  RandomAccessInputStream input_stream(file_reader.get());
+  ZstdInputStream in(&input_stream, 100, 100);
+  tstring first, second;
+  TF_ASSERT_OK(in.ReadNBytes(10, &first));
+  EXPECT_EQ(in.Tell(), 10);
+  TF_ASSERT_OK(in.SkipNBytes(100));
+  EXPECT_EQ(in.Tell(), 110);
+  TF_ASSERT_OK(in.ReadNBytes(20, &second));
+  EXPECT_EQ(second, data.substr(110, 20));
+
+  TF_ASSERT_OK(in.Reset());
+  EXPECT_EQ(in.Tell(), 0);
+  TF_ASSERT_OK(in.ReadNBytes(10, &second));
+  EXPECT_EQ(second, first);
+}
+
+TEST(ZstdBuffers, CorruptedInput) {
+  Env* env = Env::Default();
+  std::string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  TF_ASSERT_OK(WriteStringToFile(env, fname, GenTestString(10)));
+
+  std::unique_ptr<RandomAccessFile> file_reader;
+  TF_ASSERT_OK(env->NewRandomAccessFile(fname, &file_reader));
+  RandomAccessInputStream input_stream(file_reader.get());
+  ZstdInputStream in(&input_stream, 100, 100);
+  tstring result;
+  EXPECT_TRUE(errors::IsDataLoss(in.ReadNBytes(10, &result)));
+}
+
+TEST(ZstdBuffers, AppendAfterClose) {
+  Env* env = Env::Default();
+  std::string fname;
+  ASSERT_TRUE(env->LocalTempFilename(&fname));
+  std::unique_ptr<WritableFile> file_writer;
+  TF_ASSERT_OK(env->NewWritableFile(fname, &file_writer));
+  ZstdOutputBuffer out(file_writer.get(), 100, 100, ZstdCompressionOptions());
+  TF_ASSERT_OK(out.Init());
+  TF_ASSERT_OK(out.Close());
+  EXPECT_TRUE(errors::IsFailedPrecondition(out.Append("data")));
+}
+
+}  // namespace
+}  // namespace io
+}  // namespace tsl
@@ -24,7 +24,10 @@ limitations under the License.
 #include <utility>
 #include <vector>
 
+#include "absl/base/attributes.h"
+#include "absl/base/const_init.h"
 #include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
 #include "xla/tsl/profiler/utils/lock_free_queue.h"
 #include "xla/tsl/profiler/utils/per_thread.h"
 #include "tsl/platform/env.h"
@@ -146,6 +149,84 @@ class ThreadLocalRecorder {
   LockFreeQueue<TraceMeRecorder::Event> queue_;
 };
 
+// Fixed-size ring of the most recent events recorded on one thread while in
+// flight recorder mode. The mutex is only contended while the buffer is being
+// dumped or cleared.
+class FlightRecorderBuffer {
+ public:
+  FlightRecorderBuffer() {
+    auto* env = Env::Default();
+    info_.tid = env->GetCurrentThreadId();
+    env->GetCurrentThreadName(&info_.name);
+  }
+
+  const TraceMeRecorder::ThreadInfo& Info() const { return info_; }
+
+  // Record is only called from the producer thread.
+  void Record(TraceMeRecorder::Event&& event, size_t capacity) {
+    absl::MutexLock lock(&mutex_);
+    if (events_.size() < capacity) {
+      events_.push_back(std::move(event));
+    } else if (!events_.empty()) {
+      events_[oldest_] = std::move(event);
+      oldest_ = (oldest_ + 1) % events_.size();
+    }
+  }
+
+  void Clear() {
+    absl::MutexLock lock(&mutex_);
+    events_.clear();
+    oldest_ = 0;
+  }
+
+  // Returns a copy of the buffered events, oldest first.
+  std::vector<TraceMeRecorder::Event> Snapshot() {
+    absl::MutexLock lock(&mutex_);
+    std::vector<TraceMeRecorder::Event> events;
+    events.reserve(events_.size());
+    for (size_t i = 0; i < events_.size(); ++i) {
+      events.push_back(events_[(oldest_ + i) % events_.size()]);
+    }
+    return events;
+  }
+
+ private:
+  TraceMeRecorder::ThreadInfo info_;
+  absl::Mutex mutex_;
+  std::vector<TraceMeRecorder::Event> events_ ABSL_GUARDED_BY(mutex_);
+  size_t oldest_ ABSL_GUARDED_BY(mutex_) = 0;
+};
+
+// Serializes changes of the trace level between profiling sessions and
+// sampled flight recorder steps.
+ABSL_CONST_INIT absl::Mutex g_control_mutex(absl::kConstInit);
+bool g_session_active ABSL_GUARDED_BY(g_control_mutex) = false;
+bool g_flight_recorder_enabled ABSL_GUARDED_BY(g_control_mutex) = false;
+int64_t g_sampled_steps ABSL_GUARDED_BY(g_control_mutex) = 0;
+TraceMeRecorder::FlightRecorderOptions* g_flight_recorder_options
+    ABSL_GUARDED_BY(g_control_mutex) = nullptr;
+
+// Read without holding g_control_mutex on the hot paths.
+std::atomic<bool> g_flight_recorder_active(false);
+std::atomic<bool> g_flight_recording(false);
+std::atomic<int64_t> g_flight_recorder_sample_every(1);
+std::atomic<size_t> g_flight_recorder_capacity(0);
+std::atomic<int64_t> g_flight_recorder_step_count(0);
+
+// Hands the trace level over to sampled flight recorder steps, if any are
+// running, or disables tracing.
+void ReleaseTraceLevel() ABSL_EXCLUSIVE_LOCKS_REQUIRED(g_control_mutex) {
+  if (g_sampled_steps > 0 && g_flight_recorder_enabled) {
+    g_flight_recording.store(true, std::memory_order_release);
+    internal::g_trace_level.store(g_flight_recorder_options->level,
+                                  std::memory_order_release);
+  } else {
+    internal::g_trace_level.store(TraceMeRecorder::kTracingDisabled,
+                                  std::memory_order_release);
+    g_flight_recording.store(false, std::memory_order_release);
+  }
+}
+
 }  // namespace
 
 // This method is performance critical and should be kept fast. It is called
@@ -175,29 +256,168 @@ class ThreadLocalRecorder {
 
 /* static */ bool TraceMeRecorder::Start(int level) {
   level = std::max(0, level);
-  int expected = kTracingDisabled;
-  bool started = internal::g_trace_level.compare_exchange_strong(
-      expected, level, std::memory_order_acq_rel);
-  if (started) {
-    // We may have old events in buffers because Record() raced with Stop().
-    Clear();
-  }
-  return started;
+  absl::MutexLock lock(&g_control_mutex);
+  if (g_session_active) {
+    return false;
+  }
+  g_session_active = true;
+  // Sampled flight recorder steps stop recording until the session ends.
+  g_flight_recording.store(false, std::memory_order_release);
+  internal::g_trace_level.store(level, std::memory_order_release);
+  // We may have old events in buffers because Record() raced with Stop().
+  Clear();
+  return true;
 }
 
 /* static */ void TraceMeRecorder::Record(Event&& event) {
+  if (TF_PREDICT_FALSE(g_flight_recording.load(std::memory_order_acquire))) {
+    PerThread<FlightRecorderBuffer>::Get().Record(
+        std::move(event),
+        g_flight_recorder_capacity.load(std::memory_order_relaxed));
+    return;
+  }
   PerThread<ThreadLocalRecorder>::Get().Record(std::move(event));
 }
 
 /* static */ TraceMeRecorder::Events TraceMeRecorder::Stop() {
   TraceMeRecorder::Events events;
-  if (internal::g_trace_level.exchange(
-          kTracingDisabled, std::memory_order_acq_rel) != kTracingDisabled) {
+  absl::MutexLock lock(&g_control_mutex);
+  if (g_session_active) {
+    g_session_active = false;
+    internal::g_trace_level.store(kTracingDisabled, std::memory_order_release);
     events = Consume();
+    ReleaseTraceLevel();
   }
   return events;
 }
 
+/* static */ bool TraceMeRecorder::StartFlightRecorder(
+    FlightRecorderOptions options) {
+  absl::MutexLock lock(&g_control_mutex);
+  if (g_flight_recorder_enabled) {
+    return false;
+  }
+  options.level = std::max(0, options.level);
+  options.sample_every_n_steps =
+      std::max<int64_t>(1, options.sample_every_n_steps);
+  delete g_flight_recorder_options;
+  g_flight_recorder_options = new FlightRecorderOptions(std::move(options));
+  g_flight_recorder_enabled = true;
+  g_sampled_steps = 0;
+  g_flight_recorder_sample_every.store(
+      g_flight_recorder_options->sample_every_n_steps,
+      std::memory_order_relaxed);
+  g_flight_recorder_capacity.store(
+      g_flight_recorder_options->max_events_per_thread,
+      std::memory_order_relaxed);
+  g_flight_recorder_step_count.store(0, std::memory_order_relaxed);
+  for (auto& buffer : PerThread<FlightRecorderBuffer>::GetAll()) {
+    buffer->Clear();
+  }
+  g_flight_recorder_active.store(true, std::memory_order_release);
+  return true;
+}
+
+/* static */ void TraceMeRecorder::StopFlightRecorder() {
+  absl::MutexLock lock(&g_control_mutex);
+  if (!g_flight_recorder_enabled) {
+    return;
+  }
+  g_flight_recorder_active.store(false, std::memory_order_release);
+  g_flight_recorder_enabled = false;
+  g_sampled_steps = 0;
+  if (!g_session_active) {
+    ReleaseTraceLevel();
+  }
+}
+
+/* static */ bool TraceMeRecorder::FlightRecorderStepStarted() {
+  if (TF_PREDICT_TRUE(
+          !g_flight_recorder_active.load(std::memory_order_acquire))) {
+    return false;
+  }
+  if (g_flight_recorder_step_count.fetch_add(1, std::memory_order_relaxed) %
+          g_flight_recorder_sample_every.load(std::memory_order_relaxed) !=
+      0) {
+    return false;
+  }
+  absl::MutexLock lock(&g_control_mutex);
+  if (!g_flight_recorder_enabled) {
+    return false;
+  }
+  if (g_sampled_steps++ == 0 && !g_session_active) {
+    ReleaseTraceLevel();
+  }
+  return true;
+}
+
+/* static */ void TraceMeRecorder::FlightRecorderStepEnded(
+    bool sampled, int64_t duration_ns) {
+  if (TF_PREDICT_TRUE(!sampled && !g_flight_recorder_active.load(
+                                       std::memory_order_acquire))) {
+    return;
+  }
+  std::function<void(Events)> on_slow_step;
+  int64_t dump_window_ns;
+  {
+    absl::MutexLock lock(&g_control_mutex);
+    // The flight recorder may have been restarted while the step was running.
+    if (sampled && g_sampled_steps > 0 && --g_sampled_steps == 0 &&
+        !g_session_active) {
+      ReleaseTraceLevel();
+    }
+    if (!g_flight_recorder_enabled ||
+        g_flight_recorder_options->slow_step_threshold_ns <= 0 ||
+        duration_ns < g_flight_recorder_options->slow_step_threshold_ns ||
+        !g_flight_recorder_options->on_slow_step) {
+      return;
+    }
+    on_slow_step = g_flight_recorder_options->on_slow_step;
+    dump_window_ns = g_flight_recorder_options->dump_window_ns;
+  }
+  on_slow_step(DumpFlightRecorder(dump_window_ns));
+}
+
+/* static */ TraceMeRecorder::Events TraceMeRecorder::DumpFlightRecorder(
+    int64_t window_ns) {
+  const int64_t cutoff_ns = Env::Default()->NowNanos() - window_ns;
+  TraceMeRecorder::Events result;
+  SplitEventTracker split_event_tracker;
+  for (auto& buffer : PerThread<FlightRecorderBuffer>::GetAll()) {
+    std::deque<Event> events;
+    for (Event& event : buffer->Snapshot()) {
+      if (event.IsStart()) {
+        split_event_tracker.AddStart(std::move(event));
+        continue;
+      }
+      events.push_back(std::move(event));
+      if (events.back().IsEnd()) {
+        split_event_tracker.AddEnd(&events.back());
+      }
+    }
+    if (!events.empty()) {
+      result.push_back({buffer->Info(), std::move(events)});
+    }
+  }
+  split_event_tracker.HandleCrossThreadEvents();
+  // Drop end events whose start was overwritten, and old events.
+  for (auto& thread : result) {
+    auto& events = thread.events;
+    events.erase(std::remove_if(events.begin(), events.end(),
+                                [cutoff_ns](const Event& event) {
+                                  return !event.IsComplete() ||
+                                         event.end_time < cutoff_ns;
+                                }),
+                 events.end());
+  }
+  result.erase(std::remove_if(result.begin(), result.end(),
+                              [](const ThreadEvents& thread) {
+                                return thread.events.empty();
+                              }),
+               result.end());
+  return result;
+}
+
 /*static*/ int64_t TraceMeRecorder::NewActivityId() {
   // Activity IDs: To avoid contention over a counter, the top 32 bits identify
   // the originating thread, the bottom 32 bits name the event within a thread.
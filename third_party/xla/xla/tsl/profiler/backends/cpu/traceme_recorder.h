@@ -18,6 +18,7 @@ limitations under the License.
 #include <atomic>
 #include <cstdint>
 #include <deque>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -100,6 +101,43 @@ class TraceMeRecorder {
   // Returns an activity_id for TraceMe::ActivityStart.
   static int64_t NewActivityId();
 
+  // Flight recorder mode: TraceMe events are recorded for one in every
+  // `sample_every_n_steps` steps into fixed-size per-thread ring buffers, so
+  // that the recent past can be dumped after an unusually slow step without
+  // paying for always-on tracing. Profiling sessions started with Start()
+  // take precedence over sampled steps.
+  struct FlightRecorderOptions {
+    // Only traces <= level are recorded during sampled steps.
+    int level = 1;
+    // Records the events of one in every `sample_every_n_steps` steps.
+    int64_t sample_every_n_steps = 100;
+    // Maximum number of events kept per thread. Older events are overwritten.
+    size_t max_events_per_thread = 4096;
+    // Steps that take at least this long invoke `on_slow_step` with the events
+    // that ended in the last `dump_window_ns`. Zero disables the trigger.
+    int64_t slow_step_threshold_ns = 0;
+    int64_t dump_window_ns = 10'000'000'000;
+    std::function<void(Events)> on_slow_step;
+  };
+
+  // Enables flight recorder mode. Returns false if it is already enabled.
+  static bool StartFlightRecorder(FlightRecorderOptions options);
+
+  // Disables flight recorder mode. Recorded events can still be dumped.
+  static void StopFlightRecorder();
+
+  // Called by the runtime when a step starts. Returns whether the events of
+  // this step are recorded. Cheap when flight recorder mode is disabled.
+  static bool FlightRecorderStepStarted();
+
+  // Called by the runtime when a step ends, with the result of the matching
+  // FlightRecorderStepStarted() and the duration of the step.
+  static void FlightRecorderStepEnded(bool sampled, int64_t duration_ns);
+
+  // Returns the complete events kept by the flight recorder that ended in the
+  // last `window_ns` nanoseconds.
+  static Events DumpFlightRecorder(int64_t window_ns);
+
  private:
   TraceMeRecorder() = delete;
   ~TraceMeRecorder() = delete;
@@ -56,6 +56,71 @@ TEST(RecorderTest, SingleThreaded) {
               ElementsAre(Named("during1"), Named("during2")));
 }
 
+TEST(RecorderTest, FlightRecorderSamplesSteps) {
+  TraceMeRecorder::FlightRecorderOptions options;
+  options.sample_every_n_steps = 2;
+  options.max_events_per_thread = 2;
+  options.slow_step_threshold_ns = MilliToNano(100);
+  std::vector<TraceMeRecorder::Events> dumps;
+  options.on_slow_step = [&dumps](TraceMeRecorder::Events events) {
+    dumps.push_back(std::move(events));
+  };
+  ASSERT_TRUE(TraceMeRecorder::StartFlightRecorder(std::move(options)));
+
+  auto run_step = [](const std::string& name, int64_t duration_ns) {
+    const bool sampled = TraceMeRecorder::FlightRecorderStepStarted();
+    EXPECT_EQ(TraceMeRecorder::Active(), sampled);
+    if (TraceMeRecorder::Active()) {
+      int64_t start_time = GetCurrentTimeNanos();
+      TraceMeRecorder::Record({name, start_time, start_time + UniToNano(1)});
+    }
+    TraceMeRecorder::FlightRecorderStepEnded(sampled, duration_ns);
+  };
+  run_step("step0", /*duration_ns=*/1);
+  run_step("step1", /*duration_ns=*/1);
+  run_step("step2", /*duration_ns=*/1);
+  run_step("step3", /*duration_ns=*/1);
+  run_step("step4", /*duration_ns=*/1);
+  EXPECT_FALSE(TraceMeRecorder::Active());
+  EXPECT_TRUE(dumps.empty());
+
+  // A slow step dumps the ring buffer, which only holds the latest two
+  // sampled steps.
+  run_step("step5", MilliToNano(200));
+  ASSERT_EQ(dumps.size(), 1);
+  ASSERT_EQ(dumps[0].size(), 1);
+  EXPECT_THAT(dumps[0][0].events, ElementsAre(Named("step2"), Named("step4")));
+
+  TraceMeRecorder::StopFlightRecorder();
+  EXPECT_FALSE(TraceMeRecorder::FlightRecorderStepStarted());
+}
+
+TEST(RecorderTest, SessionTakesPrecedenceOverFlightRecorder) {
+  TraceMeRecorder::FlightRecorderOptions options;
+  options.sample_every_n_steps = 1;
+  ASSERT_TRUE(TraceMeRecorder::StartFlightRecorder(std::move(options)));
+  int64_t start_time = GetCurrentTimeNanos();
+  int64_t end_time = start_time + UniToNano(1);
+
+  const bool sampled = TraceMeRecorder::FlightRecorderStepStarted();
+  ASSERT_TRUE(sampled);
+  ASSERT_TRUE(TraceMeRecorder::Start(/*level=*/1));
+  TraceMeRecorder::Record({"session", start_time, end_time});
+  auto results = TraceMeRecorder::Stop();
+  // The sampled step resumes recording into the flight recorder.
+  EXPECT_TRUE(TraceMeRecorder::Active());
+  TraceMeRecorder::Record({"flight", start_time, end_time});
+  TraceMeRecorder::FlightRecorderStepEnded(sampled, /*duration_ns=*/1);
+  EXPECT_FALSE(TraceMeRecorder::Active());
+
+  ASSERT_EQ(results.size(), 1);
+  EXPECT_THAT(results[0].events, ElementsAre(Named("session")));
+  auto dump = TraceMeRecorder::DumpFlightRecorder(UniToNano(10));
+  ASSERT_EQ(dump.size(), 1);
+  EXPECT_THAT(dump[0].events, ElementsAre(Named("flight")));
+  TraceMeRecorder::StopFlightRecorder();
+}
+
 // Checks the functional behavior of the recorder, when used from several
 // unsynchronized threads.
 //
@@ -49,6 +49,12 @@ class PerThread {
     return Registry::Get().StartRecording();
   }
 
+  // Returns all instances of T from live threads, and from destroyed threads
+  // that are kept alive by recording, without changing the recording state.
+  static std::vector<std::shared_ptr<T>> GetAll() {
+    return Registry::Get().GetAll();
+  }
+
   // Stops keeping thread-local instances of T alive.
   // Returns all instances of T from live and destroyed threads.
   static std::vector<std::shared_ptr<T>> StopRecording() {
@@ -79,6 +85,16 @@ class PerThread {
       return threads;
     }
 
+    std::vector<std::shared_ptr<T>> GetAll() {
+      std::vector<std::shared_ptr<T>> threads;
+      absl::MutexLock lock(&mutex_);
+      threads.reserve(threads_.size());
+      for (auto iter = threads_.begin(); iter != threads_.end(); ++iter) {
+        threads.push_back(iter->first);
+      }
+      return threads;
+    }
+
     std::vector<std::shared_ptr<T>> StopRecording() {
       std::vector<std::shared_ptr<T>> threads;
       absl::MutexLock lock(&mutex_);
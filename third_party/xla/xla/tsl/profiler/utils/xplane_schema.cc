@@ -345,7 +345,10 @@ const StatTypeMap& GetStatTypeMap() {
        {"gpu_device_name", kGpuDeviceName},
        {"source_stack", kSourceStack},
        {"device_offset_ps", kDeviceOffsetPs},
-       {"device_duration_ps", kDeviceDurationPs}});
+       {"device_duration_ps", kDeviceDurationPs},
+       {"cpu_cycles", kCpuCycles},
+       {"cpu_instructions", kCpuInstructions},
+       {"cpu_cache_misses", kCpuCacheMisses}});
   DCHECK_EQ(stat_type_map->size(), kNumStatTypes);
   return *stat_type_map;
 }
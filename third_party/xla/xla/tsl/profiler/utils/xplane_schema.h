@@ -335,7 +335,11 @@ enum StatType {
   kSourceStack,
   kDeviceOffsetPs,
   kDeviceDurationPs,
-  kLastStatType = kDeviceDurationPs,
+  // Hardware counters observed on the host thread during the event.
+  kCpuCycles,
+  kCpuInstructions,
+  kCpuCacheMisses,
+  kLastStatType = kCpuCacheMisses,
 };
 
 enum MegaScaleStatType : uint8_t {